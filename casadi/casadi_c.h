@@ -52,20 +52,21 @@ extern "C" {
  * 
  * Pushes to an internal buffer any Functions found
  * 
- * Not thread-safe
+ * Thread-safe, but ids in use by other threads may be invalidated by
+ * casadi_c_pop/casadi_c_clear; open a handle for concurrent evaluation
  * Return 0 when successful
 */
 
 CASADI_EXPORT int casadi_c_push_file(const char *filename);
 
 /** \brief Unloads the last batch of added Functions
-* Not thread-safe
+* Open handles remain valid
 */
 CASADI_EXPORT void casadi_c_pop(void);
 
 /** \brief Unloads all Functions
  * 
- * Not thread-safe
+ * Open handles remain valid
  */
 CASADI_EXPORT void casadi_c_clear(void);
 
@@ -78,6 +79,11 @@ CASADI_EXPORT int casadi_c_n_loaded(void);
  * id is really just a linear index into the loaded Functions vector 
 */
 CASADI_EXPORT int casadi_c_id(const char* funname);
+
+/** \brief Set the Function used by the calls without id
+ *
+ * The active Function is global state, shared by all threads
+*/
 CASADI_EXPORT int casadi_c_activate(int id);
 
 
@@ -128,6 +134,145 @@ CASADI_EXPORT int casadi_c_work_id(int id, casadi_int *sz_arg, casadi_int* sz_re
 CASADI_EXPORT int casadi_c_eval_id(int id, const double** arg, double** res,
   casadi_int* iw, double* w, int mem);
 
+/* ===================================================
+*   Handle-based API, safe for concurrent use
+*  =================================================== */
+
+/** \brief Open a handle to a loaded Function
+ *
+ * The handle holds its own reference to the Function and is unaffected
+ * by casadi_c_activate, casadi_c_pop and casadi_c_clear.
+ * All calls below take the handle explicitly and no global state is
+ * modified, such that several threads may evaluate the same or different
+ * Functions at once, each with a memory object of its own from
+ * casadi_c_handle_checkout and work vectors of its own.
+ *
+ * Thread-safe
+ * Returns a handle >=0 when successful
+*/
+CASADI_EXPORT int casadi_c_open(int id);
+
+/** \brief Open a handle to a Function in a serialized CasADi file
+ *
+ * The loaded Functions are left untouched.
+ *
+ * Thread-safe
+ * Returns a handle >=0 when successful
+*/
+CASADI_EXPORT int casadi_c_open_file(const char* filename, const char* funname);
+
+/** \brief Close a handle
+ *
+ * Thread-safe, but the handle must no longer be in use by other threads
+*/
+CASADI_EXPORT void casadi_c_close(int handle);
+
+CASADI_EXPORT const char* casadi_c_handle_name(int handle);
+CASADI_EXPORT int casadi_c_handle_checkout(int handle);
+CASADI_EXPORT void casadi_c_handle_release(int handle, int mem);
+CASADI_EXPORT double casadi_c_handle_default_in(int handle, casadi_int i);
+CASADI_EXPORT casadi_int casadi_c_handle_n_in(int handle);
+CASADI_EXPORT casadi_int casadi_c_handle_n_out(int handle);
+CASADI_EXPORT const char* casadi_c_handle_name_in(int handle, casadi_int i);
+CASADI_EXPORT const char* casadi_c_handle_name_out(int handle, casadi_int i);
+CASADI_EXPORT const casadi_int* casadi_c_handle_sparsity_in(int handle, casadi_int i);
+CASADI_EXPORT const casadi_int* casadi_c_handle_sparsity_out(int handle, casadi_int i);
+CASADI_EXPORT int casadi_c_handle_work(int handle, casadi_int *sz_arg, casadi_int* sz_res,
+  casadi_int *sz_iw, casadi_int *sz_w);
+CASADI_EXPORT int casadi_c_handle_eval(int handle, const double** arg, double** res,
+  casadi_int* iw, double* w, int mem);
+
+/* ===================================================
+*   Prepared calls
+*  =================================================== */
+
+/** \brief Prepare repeated evaluation of a Function
+ *
+ * Allocates work vectors and checks out memory once.
+ * Input and output buffers are bound with casadi_c_prepared_set_arg/res,
+ * unbound ones are treated as null pointers.
+ * Each casadi_c_prepared_eval then only invokes the evaluation routine,
+ * calling the function pointer of an External/GenericExternal directly.
+ * Handles remain valid after unloading Functions.
+ *
+ * Not thread-safe, but distinct handles may be evaluated concurrently
+ * Returns a handle >=0 when successful
+*/
+CASADI_EXPORT int casadi_c_prepare(void);
+CASADI_EXPORT int casadi_c_prepare_id(int id);
+
+/** \brief Bind input buffer i, which holds the nonzeros of the input */
+CASADI_EXPORT int casadi_c_prepared_set_arg(int handle, casadi_int i, const double* a);
+
+/** \brief Bind output buffer i, which receives the nonzeros of the output */
+CASADI_EXPORT int casadi_c_prepared_set_res(int handle, casadi_int i, double* r);
+
+/** \brief Evaluate with the bound buffers, returns the return value of the call */
+CASADI_EXPORT int casadi_c_prepared_eval(int handle);
+
+/** \brief Release a prepared call
+ *
+ * Not thread-safe
+*/
+CASADI_EXPORT void casadi_c_prepared_release(int handle);
+
+
+/* ===================================================
+*   Shared-memory Function server
+*  =================================================== */
+
+/** \brief Host the loaded Functions for other processes
+ *
+ * Creates a POSIX shared memory segment 'name' holding a table of the
+ * loaded Functions and n_slot client slots, each with room for the
+ * argument and result nonzeros of any of the Functions.
+ * Clients queue evaluation requests for their slot in a ring buffer,
+ * which are evaluated in place by n_thread threads of the server.
+ * The Functions are thus loaded and compiled once, in the server process.
+ *
+ * Blocks until a client calls casadi_c_remote_shutdown.
+ * Not available on Windows
+ * Return 0 when successful
+*/
+CASADI_EXPORT int casadi_c_serve(const char* name, int n_slot, int n_thread);
+
+/** \brief Connect to a server started with casadi_c_serve
+ *
+ * Claims one of its slots, slots of clients that died are reclaimed.
+ * A connection must not be used by several threads at once.
+ * Returns a connection handle >=0 when successful
+*/
+CASADI_EXPORT int casadi_c_connect(const char* name);
+
+/** \brief Release the slot of a connection */
+CASADI_EXPORT void casadi_c_disconnect(int conn);
+
+/** \brief Get the id of a Function on the server by name */
+CASADI_EXPORT int casadi_c_remote_id(int conn, const char* funname);
+CASADI_EXPORT casadi_int casadi_c_remote_n_in(int conn, int id);
+CASADI_EXPORT casadi_int casadi_c_remote_n_out(int conn, int id);
+CASADI_EXPORT casadi_int casadi_c_remote_nnz_in(int conn, int id, casadi_int i);
+CASADI_EXPORT casadi_int casadi_c_remote_nnz_out(int conn, int id, casadi_int i);
+
+/** \brief Buffer for the nonzeros of input i, in shared memory
+ *
+ * Write the arguments here before casadi_c_remote_eval, no copies are made.
+ * The buffers of different Functions overlap.
+*/
+CASADI_EXPORT double* casadi_c_remote_arg(int conn, int id, casadi_int i);
+
+/** \brief Buffer for the nonzeros of output i, in shared memory */
+CASADI_EXPORT const double* casadi_c_remote_res(int conn, int id, casadi_int i);
+
+/** \brief Evaluate a Function on the server, blocking
+ *
+ * Returns the return value of the call
+*/
+CASADI_EXPORT int casadi_c_remote_eval(int conn, int id);
+
+/** \brief Ask the server to stop serving */
+CASADI_EXPORT void casadi_c_remote_shutdown(int conn);
+
 
 #ifdef __cplusplus
 }
@@ -28,6 +28,10 @@
 
 #include "sx_node.hpp"
 #include "serializing_stream.hpp"
+#include "global_options.hpp"
+#include "sparsity.hpp"
+#include <functional>
+#include <unordered_map>
 
 /// \cond INTERNAL
 namespace casadi {
@@ -45,7 +49,36 @@ class BinarySX : public SXNode {
 
         \identifier{116} */
     BinarySX(unsigned char op, const SXElem& dep0, const SXElem& dep1) :
-        op_(op), dep0_(dep0), dep1_(dep1) {}
+        op_(op), hash_consed_(false), dep0_(dep0), dep1_(dep1) {}
+
+    /** \brief  Key of the hash-cons table: operation and dependencies */
+    struct Key {
+      unsigned char op;
+      const SXNode* dep0;
+      const SXNode* dep1;
+      bool operator==(const Key& k) const {
+        return op==k.op && dep0==k.dep0 && dep1==k.dep1;
+      }
+    };
+
+    /** \brief  Hash function for Key */
+    struct KeyHash {
+      std::size_t operator()(const Key& k) const {
+        std::size_t seed = k.op;
+        hash_combine(seed, reinterpret_cast<uintptr_t>(k.dep0));
+        hash_combine(seed, reinterpret_cast<uintptr_t>(k.dep1));
+        return seed;
+      }
+    };
+
+    /** \brief  Get the key, dependencies of commutative operations are ordered */
+    static Key key(unsigned char op, const SXElem& dep0, const SXElem& dep1) {
+      const SXNode *n0 = dep0.get(), *n1 = dep1.get();
+      if (operation_checker<CommChecker>(op) && std::less<const SXNode*>()(n1, n0)) {
+        std::swap(n0, n1);
+      }
+      return {op, n0, n1};
+    }
 
   public:
 
@@ -60,6 +93,27 @@ class BinarySX : public SXNode {
         double ret_val;
         casadi_math<double>::fun(op, dep0_val, dep1_val, ret_val);
         return ret_val;
+      } else if (GlobalOptions::hash_consing) {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+        // Reuse a live node with the same operation and dependencies, if any
+        Key k = key(op, dep0, dep1);
+        auto it = cached_.find(k);
+        if (it!=cached_.end() && it->second->acquire()) {
+          SXElem ret = SXElem::create(it->second);
+          it->second->count--;
+          return ret;
+        }
+        BinarySX* n = new BinarySX(op, dep0, dep1);
+        n->hash_consed_ = true;
+        if (it==cached_.end()) {
+          cached_.insert(it, std::make_pair(k, n));
+        } else {
+          // Replaces a node that is being deleted
+          it->second = n;
+        }
+        return SXElem::create(n);
       } else {
         // Expression containing free variables
         return SXElem::create(new BinarySX(op, dep0, dep1));
@@ -73,6 +127,13 @@ class BinarySX : public SXNode {
 
         \identifier{118} */
     ~BinarySX() override {
+      if (hash_consed_) {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+        auto it = cached_.find(key(op_, dep0_, dep1_));
+        if (it!=cached_.end() && it->second==this) cached_.erase(it);
+      }
       safe_delete(dep0_.assignNoDelete(casadi_limits<SXElem>::nan));
       safe_delete(dep1_.assignNoDelete(casadi_limits<SXElem>::nan));
     }
@@ -127,6 +188,12 @@ class BinarySX : public SXNode {
         \identifier{11e} */
     unsigned char op_;
 
+    /** \brief  Is the node in the hash-cons table? */
+    bool hash_consed_;
+
+    /** \brief  Hash-cons table of live nodes */
+    static std::unordered_map<Key, BinarySX*, KeyHash> cached_;
+
     /** \brief  The dependencies of the node
 
         \identifier{11f} */
@@ -52,13 +52,41 @@ namespace casadi {
   }
 
   size_t BSplineCommon::sz_iw() const {
+    if (batch()>1) return n_iw_batch(degree_, n_chunk());
     return n_iw(degree_);
   }
 
   size_t BSplineCommon::sz_w() const {
+    if (batch()>1) return n_w_batch(degree_, n_chunk());
     return n_w(degree_);
   }
 
+  size_t BSplineCommon::n_iw_batch(const std::vector<casadi_int>& degree, casadi_int n_chunk) {
+    casadi_int n_dims = degree.size();
+    casadi_int sz = 0;
+    sz += n_dims*n_chunk; // starts
+    sz += n_dims; // spans of the previous point
+    sz += n_dims+1; // boor_offset
+    sz += n_dims; // index
+    sz += n_dims+1; // coeff_offset
+    return sz;
+  }
+
+  size_t BSplineCommon::n_w_batch(const std::vector<casadi_int>& degree, casadi_int n_chunk) {
+    casadi_int n_dims = degree.size();
+    casadi_int max_degree = 0;
+    casadi_int sz = 0;
+    for (casadi_int k=0;k<n_dims;++k) {
+      sz += (degree[k]+1)*n_chunk; // boor
+      max_degree = std::max(max_degree, degree[k]);
+    }
+    sz += (2*max_degree+2)*n_chunk; // knots
+    sz += (2*max_degree+1)*n_chunk; // boor recursion
+    sz += n_chunk; // x
+    sz += n_dims+1; // cumprod
+    return sz;
+  }
+
   size_t BSplineCommon::n_iw(const std::vector<casadi_int>& degree) {
     casadi_int n_dims = degree.size();
     casadi_int sz = 0;
@@ -156,9 +184,9 @@ namespace casadi {
           casadi_int m,
           const std::vector<casadi_int>& lookup_mode) :
           BSplineCommon(knots, offset, degree, m, lookup_mode), coeffs_(coeffs) {
-    casadi_assert_dev(x.numel()==degree.size());
+    casadi_assert_dev(x.size1()==degree.size());
     set_dep(x);
-    set_sparsity(Sparsity::dense(m, 1));
+    set_sparsity(Sparsity::dense(m, x.size2()));
   }
 
   BSplineParametric::BSplineParametric(const MX& x,
@@ -171,7 +199,7 @@ namespace casadi {
           BSplineCommon(knots, offset, degree, m, lookup_mode) {
     casadi_assert_dev(x.size1()==degree.size());
     set_dep(x, coeffs);
-    set_sparsity(Sparsity::dense(m, 1));
+    set_sparsity(Sparsity::dense(m, x.size2()));
   }
 
   void get_boor(const MX& x, const MX& knots, casadi_int degree, casadi_int lookup_mode,
@@ -271,9 +299,14 @@ namespace casadi {
           casadi_int m,
           const Dict& opts) {
 
-    casadi_assert(x.is_vector(), "x argument must be a vector, got " + x.dim() + " instead.");
-    casadi_assert(x.numel()==knots.size(), "x argument length (" + str(x.numel()) + ") must match "
-                                           "number knot list length (" + str(knots.size()) + ").");
+    // Batch of points, one per column
+    bool batch = x.size2()>1 && x.size1()==knots.size();
+
+    if (!batch) {
+      casadi_assert(x.is_vector(), "x argument must be a vector, got " + x.dim() + " instead.");
+      casadi_assert(x.numel()==knots.size(), "x argument length (" + str(x.numel()) + ") "
+                    "must match number knot list length (" + str(knots.size()) + ").");
+    }
     casadi_assert(degree.size()==knots.size(), "Degree list length (" + str(degree.size()) + ") "
                   "must match knot list length (" + str(knots.size()) + ").");
 
@@ -298,7 +331,7 @@ namespace casadi {
     if (do_inline_flag) {
       return do_inline(x, knots, coeffs, m, degree, mode);
     } else {
-      return x->get_bspline(stacked, offset, coeffs, degree, m, mode);
+      return (batch ? x : vec(x))->get_bspline(stacked, offset, coeffs, degree, m, mode);
     }
   }
 
@@ -309,9 +342,14 @@ namespace casadi {
           casadi_int m,
           const Dict& opts) {
 
-    casadi_assert(x.is_vector(), "x argument must be a vector, got " + x.dim() + " instead.");
-    casadi_assert(x.numel()==knots.size(), "x argument length (" + str(x.numel()) + ") must match "
-                                           "knot list length (" + str(knots.size()) + ").");
+    // Batch of points, one per column
+    bool batch = x.size2()>1 && x.size1()==knots.size();
+
+    if (!batch) {
+      casadi_assert(x.is_vector(), "x argument must be a vector, got " + x.dim() + " instead.");
+      casadi_assert(x.numel()==knots.size(), "x argument length (" + str(x.numel()) + ") "
+                    "must match knot list length (" + str(knots.size()) + ").");
+    }
     casadi_assert(degree.size()==knots.size(), "Degree list length (" + str(degree.size()) + ") "
                   "must match knot list length (" + str(knots.size()) + ").");
     bool do_inline_flag = false;
@@ -334,7 +372,7 @@ namespace casadi {
     if (do_inline_flag) {
       return do_inline(x, knots, coeffs, m, degree, mode);
     } else {
-      return x->get_bspline(coeffs, stacked, offset, degree, m, mode);
+      return (batch ? x : vec(x))->get_bspline(coeffs, stacked, offset, degree, m, mode);
     }
   }
 
@@ -372,6 +410,19 @@ namespace casadi {
                           std::vector<std::vector<MX> >& fsens) const {
     MX J = jac_cached();
 
+    if (batch()>1) {
+      // Jacobian is block diagonal: one m-by-N block of derivatives per dimension
+      std::vector<MX> J_parts = horzsplit(J, batch());
+      for (casadi_int d=0; d<fsens.size(); ++d) {
+        MX s = MX::zeros(m_, batch());
+        for (casadi_int k=0; k<J_parts.size(); ++k) {
+          s += J_parts[k]*repmat(fseed[d][0](k, Slice()), m_, 1);
+        }
+        fsens[d][0] = s;
+      }
+      return;
+    }
+
     for (casadi_int d=0; d<fsens.size(); ++d) {
       fsens[d][0] = mtimes(J, fseed[d][0]);
     }
@@ -379,29 +430,79 @@ namespace casadi {
 
   void BSplineCommon::ad_reverse(const std::vector<std::vector<MX> >& aseed,
                           std::vector<std::vector<MX> >& asens) const {
+    if (batch()>1) {
+      std::vector<MX> J_parts = horzsplit(jac_cached(), batch());
+      for (casadi_int d=0; d<aseed.size(); ++d) {
+        std::vector<MX> s;
+        for (const MX& Jk : J_parts) s.push_back(sum1(Jk*aseed[d][0]));
+        asens[d][0] += vertcat(s);
+      }
+      return;
+    }
+
     MX JT = jac_cached().T();
     for (casadi_int d=0; d<aseed.size(); ++d) {
       asens[d][0] += mtimes(JT, aseed[d][0]);
     }
   }
 
+  int BSplineCommon::sp_forward(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w) const {
+    // Coefficients affect all points
+    bvec_t c_dep = 0;
+    for (casadi_int k=1; k<n_dep(); ++k) {
+      for (casadi_int i=0; i<dep(k).nnz(); ++i) c_dep |= arg[k][i];
+    }
+    const casadi_int* colind = dep(0).colind();
+    for (casadi_int p=0; p<batch(); ++p) {
+      bvec_t d = c_dep;
+      for (casadi_int i=colind[p]; i<colind[p+1]; ++i) d |= arg[0][i];
+      for (casadi_int i=0; i<m_; ++i) res[0][p*m_+i] = d;
+    }
+    return 0;
+  }
+
+  int BSplineCommon::sp_reverse(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w) const {
+    bvec_t c_dep = 0;
+    const casadi_int* colind = dep(0).colind();
+    for (casadi_int p=0; p<batch(); ++p) {
+      bvec_t d = 0;
+      for (casadi_int i=0; i<m_; ++i) {
+        d |= res[0][p*m_+i];
+        res[0][p*m_+i] = 0;
+      }
+      for (casadi_int i=colind[p]; i<colind[p+1]; ++i) arg[0][i] |= d;
+      c_dep |= d;
+    }
+    for (casadi_int k=1; k<n_dep(); ++k) {
+      for (casadi_int i=0; i<dep(k).nnz(); ++i) arg[k][i] |= c_dep;
+    }
+    return 0;
+  }
+
+  void BSplineCommon::eval_boor(const double* x, const double* c, double* res,
+      casadi_int* iw, double* w) const {
+    casadi_clear(res, m_*batch());
+    if (batch()>1) {
+      casadi_nd_boor_eval_batch(res, degree_.size(), get_ptr(knots_), get_ptr(offset_),
+        get_ptr(degree_), get_ptr(strides_), c, m_, x, batch(), n_chunk(),
+        get_ptr(lookup_mode_), iw, w);
+    } else {
+      casadi_nd_boor_eval(res, degree_.size(), get_ptr(knots_), get_ptr(offset_),
+        get_ptr(degree_), get_ptr(strides_), c, m_, x, get_ptr(lookup_mode_), iw, w);
+    }
+  }
+
   int BSpline::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
     if (!res[0]) return 0;
-
-    casadi_clear(res[0], m_);
-    casadi_nd_boor_eval(res[0], degree_.size(), get_ptr(knots_), get_ptr(offset_),
-      get_ptr(degree_), get_ptr(strides_), get_ptr(coeffs_), m_, arg[0], get_ptr(lookup_mode_),
-      iw, w);
+    eval_boor(arg[0], get_ptr(coeffs_), res[0], iw, w);
     return 0;
   }
 
   int BSplineParametric::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
     if (!res[0]) return 0;
-
-    casadi_clear(res[0], m_);
-    casadi_nd_boor_eval(res[0], degree_.size(), get_ptr(knots_), get_ptr(offset_),
-      get_ptr(degree_), get_ptr(strides_), arg[1], m_, arg[0], get_ptr(lookup_mode_),
-      iw, w);
+    eval_boor(arg[0], arg[1], res[0], iw, w);
     return 0;
   }
 
@@ -412,13 +513,21 @@ namespace casadi {
 
     g.add_auxiliary(CodeGenerator::AUX_ND_BOOR_EVAL);
     g.add_auxiliary(CodeGenerator::AUX_FILL);
-    g << g.clear(g.work(res[0], m_), m_) << "\n";
+    g << g.clear(g.work(res[0], nnz()), nnz()) << "\n";
 
     // Input and output buffers
-    g << "CASADI_PREFIX(nd_boor_eval)(" << g.work(res[0], m_) << "," << n_dims << ","
-      << g.constant(knots_) << "," << g.constant(offset_) << "," <<  g.constant(degree_)
-      << "," << g.constant(strides_) << "," << generate(g, arg) << "," << m_  << ","
-      << g.work(arg[0], n_dims) << "," <<  g.constant(lookup_mode_) << ", iw, w);\n";
+    if (batch()>1) {
+      g << "CASADI_PREFIX(nd_boor_eval_batch)(" << g.work(res[0], nnz()) << "," << n_dims << ","
+        << g.constant(knots_) << "," << g.constant(offset_) << "," <<  g.constant(degree_)
+        << "," << g.constant(strides_) << "," << generate(g, arg) << "," << m_  << ","
+        << g.work(arg[0], dep(0).nnz()) << "," << batch() << "," << n_chunk() << ","
+        << g.constant(lookup_mode_) << ", iw, w);\n";
+    } else {
+      g << "CASADI_PREFIX(nd_boor_eval)(" << g.work(res[0], m_) << "," << n_dims << ","
+        << g.constant(knots_) << "," << g.constant(offset_) << "," <<  g.constant(degree_)
+        << "," << g.constant(strides_) << "," << generate(g, arg) << "," << m_  << ","
+        << g.work(arg[0], n_dims) << "," <<  g.constant(lookup_mode_) << ", iw, w);\n";
+    }
   }
 
   std::string BSpline::generate(CodeGenerator& g, const std::vector<casadi_int>& arg) const {
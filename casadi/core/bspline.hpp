@@ -90,6 +90,22 @@ namespace casadi {
         \identifier{1yg} */
     static size_t n_w(const std::vector<casadi_int> &degree);
 
+    /** \brief Get required length of iw field for batched evaluation in chunks of n_chunk */
+    static size_t n_iw_batch(const std::vector<casadi_int> &degree, casadi_int n_chunk);
+
+    /** \brief Get required length of w field for batched evaluation in chunks of n_chunk */
+    static size_t n_w_batch(const std::vector<casadi_int> &degree, casadi_int n_chunk);
+
+    /// Number of query points, columns of the first dependency
+    casadi_int batch() const { return dep(0).size2();}
+
+    /// Points per chunk of the batched evaluation
+    casadi_int n_chunk() const { return std::min(batch(), static_cast<casadi_int>(8));}
+
+    /// Evaluate numerically for coefficients c
+    void eval_boor(const double* x, const double* c, double* res,
+      casadi_int* iw, double* w) const;
+
     /** \brief Get required length of iw field
 
         \identifier{1yh} */
@@ -105,6 +121,12 @@ namespace casadi {
         \identifier{1yj} */
     casadi_int op() const override { return OP_BSPLINE;}
 
+    /// Propagate sparsity forward: each point depends on its own column of x only
+    int sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
+
+    /// Propagate sparsity backwards
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
+
     /** \brief Calculate forward mode directional derivatives
 
         \identifier{1yk} */
@@ -207,10 +207,13 @@ namespace casadi {
 
     OP_LOGSUMEXP,
 
-    OP_REMAINDER
+    OP_REMAINDER,
+
+    // Kronecker product
+    OP_KRON
 
   };
-  #define NUM_BUILT_IN_OPS (OP_REMAINDER+1)
+  #define NUM_BUILT_IN_OPS (OP_KRON+1)
 
   #define OP_
 
@@ -1113,6 +1116,7 @@ namespace casadi {
     case OP_EXPM1:         return F<OP_EXPM1>::check;
     case OP_HYPOT:         return F<OP_HYPOT>::check;
     case OP_LOGSUMEXP:     return F<OP_LOGSUMEXP>::check;
+    case OP_KRON:          return F<OP_KRON>::check;
     }
     return T();
   }
@@ -1687,6 +1691,7 @@ case OP_HYPOT:     DerBinaryOperation<OP_HYPOT>::derf(X, Y, F, D);      break;
     case OP_EXPM1:          return "expm1";
     case OP_HYPOT:          return "hypot";
     case OP_LOGSUMEXP:      return "logsumexp";
+    case OP_KRON:           return "kron";
     }
     return "<invalid-op>";
   }
@@ -57,6 +57,9 @@ namespace casadi {
   bool Callback::has_eval_buffer() const {
     return false;
   }
+  casadi_int Callback::get_eval_kernel() const {
+    return 0;
+  }
   std::vector<DM> Callback::eval(const std::vector<DM>& arg) const {
     return (*this)->FunctionInternal::eval_dm(arg);
   }
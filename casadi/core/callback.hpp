@@ -121,6 +121,18 @@ namespace casadi {
         \identifier{265} */
     virtual bool has_eval_buffer() const;
 
+    /** \brief Address of a compiled kernel evaluating the Callback
+     *
+     * Return the address of a function with the signature of generated code,
+     * int (const double** arg, double** res, casadi_int* iw, double* w, int mem),
+     * operating on the structural nonzeros, or zero if there is none (default).
+     * The kernel is called directly, without calling back into the host language.
+     * In Python, e.g. the address of a numba cfunc or a ctypes function pointer:
+     * no GIL is needed, and a thread map over the Callback runs in parallel.
+     * The kernel must be thread-safe and outlive the Callback.
+     */
+    virtual casadi_int get_eval_kernel() const;
+
     /** \brief Get the number of inputs
 
      * This function is called during construction.
@@ -72,6 +72,10 @@ namespace casadi {
     TRY_CALL(has_eval_buffer, self_);
   }
 
+  casadi_int CallbackInternal::get_eval_kernel() const {
+    TRY_CALL(get_eval_kernel, self_);
+  }
+
   bool CallbackInternal::has_jac_sparsity(casadi_int oind, casadi_int iind) const {
     TRY_CALL(has_jac_sparsity, self_, oind, iind);
   }
@@ -98,6 +102,10 @@ namespace casadi {
     // Finalize the base classes
     FunctionInternal::finalize();
 
+    // A compiled kernel is evaluated like JIT compiled code
+    casadi_int kernel = get_eval_kernel();
+    if (kernel) eval_ = reinterpret_cast<eval_t>(static_cast<intptr_t>(kernel));
+
     has_eval_buffer_ = has_eval_buffer();
 
     if (has_eval_buffer_) {
@@ -88,7 +88,7 @@ namespace casadi {
 
         \identifier{184} */
     std::vector<DM> eval_dm(const std::vector<DM>& arg) const override;
-    bool has_eval_dm() const override { return !has_eval_buffer_;}
+    bool has_eval_dm() const override { return !has_eval_buffer_ && !eval_;}
     ///@}
 
     /** \brief  Evaluate numerically
@@ -97,6 +97,7 @@ namespace casadi {
     virtual int eval(const double** arg, double** res,
       casadi_int* iw, double* w, void* mem) const override;
     bool has_eval_buffer() const;
+    casadi_int get_eval_kernel() const;
 
     /** \brief Do the derivative functions need nondifferentiated outputs?
 
@@ -27,12 +27,36 @@
 #include "../casadi_c.h"
 #include "serializer.hpp"
 #include <deque>
+#include <memory>
+#include <cstring>
+#ifdef CASADI_WITH_THREAD
+#include <mutex>
+#include <thread>
+#endif // CASADI_WITH_THREAD
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // _WIN32
 
 using namespace casadi;
 
 static std::vector<Function> casadi_c_loaded_functions;
 static std::deque<int> casadi_c_load_stack;
 static int casadi_c_active = -1;
+static std::vector<std::unique_ptr<FunctionBuffer> > casadi_c_prepared;
+static std::vector<std::unique_ptr<Function> > casadi_c_handles;
+
+#ifdef CASADI_WITH_THREAD
+// Protects the tables above and every copy or destruction of the Functions they hold,
+// since reference counting is not atomic
+static std::mutex casadi_c_mtx;
+#endif // CASADI_WITH_THREAD
 
 int casadi_c_int_width() {
   return sizeof(casadi_int);
@@ -41,11 +65,11 @@ int casadi_c_real_width() {
   return sizeof(double);
 }
 
-int casadi_c_id(const char* funname) {
+inline int casadi_c_id_internal(const std::vector<Function>& fs, const char* funname) {
   int ret = -1;
   std::string fname = funname;
-  for (int i=0;i<casadi_c_loaded_functions.size();++i) {
-    if (fname==casadi_c_loaded_functions.at(i).name()) {
+  for (int i=0;i<fs.size();++i) {
+    if (fname==fs.at(i).name()) {
       if (ret!=-1) {
         std::cerr << "Ambiguous function name '" << fname << "'" << std::endl;
         return -2;
@@ -57,7 +81,7 @@ int casadi_c_id(const char* funname) {
   if (ret==-1) {
     std::cerr << "Could not find function named '" << fname << "'." << std::endl;
     std::cerr << "Available functions: ";
-    for (const auto& f : casadi_c_loaded_functions) {
+    for (const auto& f : fs) {
       std::cerr << f.name() << " ";
     }
     std::cerr << std::endl;
@@ -66,19 +90,29 @@ int casadi_c_id(const char* funname) {
   return ret;
 }
 
-int casadi_c_n_loaded() { return casadi_c_loaded_functions.size(); }
+int casadi_c_id(const char* funname) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  return casadi_c_id_internal(casadi_c_loaded_functions, funname);
+}
 
-inline int casadi_c_push_file_internal(const char *filename) {
+int casadi_c_n_loaded() {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  return casadi_c_loaded_functions.size();
+}
+
+inline int casadi_c_read_file(const char *filename, std::vector<Function>& fs) {
   try {
-    FileDeserializer fs(filename);
-    auto type = fs.pop_type();
+    FileDeserializer fs_in(filename);
+    auto type = fs_in.pop_type();
     if (type==SerializerBase::SerializationType::SERIALIZED_FUNCTION) {
-      casadi_c_loaded_functions.push_back(fs.blind_unpack_function());
+      fs.push_back(fs_in.blind_unpack_function());
       return 0;
     } else if (type==SerializerBase::SerializationType::SERIALIZED_FUNCTION_VECTOR) {
-      for (const Function& f : fs.blind_unpack_function_vector()) {
-        casadi_c_loaded_functions.push_back(f);
-      }
+      fs = fs_in.blind_unpack_function_vector();
       return 0;
     } else {
       std::cerr << "Serializer file should contain a 'function' or 'function_vector'. "
@@ -95,20 +129,32 @@ inline int casadi_c_push_file_internal(const char *filename) {
 }
 
 int casadi_c_push_file(const char *filename) {
-  int before = casadi_c_loaded_functions.size();
-  int ret = casadi_c_push_file_internal(filename);
-  int after = casadi_c_loaded_functions.size();
-  casadi_c_load_stack.push_back(after-before);
+  // Deserialize without holding the lock
+  std::vector<Function> fs;
+  int ret = casadi_c_read_file(filename, fs);
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  casadi_c_loaded_functions.insert(casadi_c_loaded_functions.end(), fs.begin(), fs.end());
+  casadi_c_load_stack.push_back(fs.size());
+  fs.clear();
   return ret;
 }
 
 void casadi_c_clear(void) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
   casadi_c_load_stack.clear();
   casadi_c_loaded_functions.clear();
   casadi_c_active = -1;
 }
 
 void casadi_c_pop(void) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  if (casadi_c_load_stack.empty()) return;
   int count = casadi_c_load_stack.back();
   casadi_c_load_stack.pop_back();
   casadi_c_loaded_functions.erase(
@@ -116,6 +162,7 @@ void casadi_c_pop(void) {
     casadi_c_loaded_functions.end());
 }
 
+// Call with the lock held
 inline int sanitize_id(int id) {
   if (id<0 || id>=casadi_c_loaded_functions.size()) {
     std::cerr << "id " << id << " is out of range: must be in [0, ";
@@ -125,24 +172,100 @@ inline int sanitize_id(int id) {
   return 0;
 }
 
+// Loaded Function with a given id, null if out of range
+inline const Function* casadi_c_lookup_id(int id) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  if (sanitize_id(id)) return nullptr;
+  return &casadi_c_loaded_functions[id];
+}
+
+// Loaded Function that is active, null if none
+inline const Function* casadi_c_lookup_active() {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  if (sanitize_id(casadi_c_active)) return nullptr;
+  return &casadi_c_loaded_functions[casadi_c_active];
+}
+
+// Function referred to by a handle, null if none
+inline const Function* casadi_c_lookup_handle(int handle) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  if (handle<0 || handle>=casadi_c_handles.size() || !casadi_c_handles[handle]) {
+    std::cerr << "handle " << handle << " does not refer to an open Function" << std::endl;
+    return nullptr;
+  }
+  return casadi_c_handles[handle].get();
+}
+
 int casadi_c_activate(int id) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
   if (sanitize_id(id)) return -1;
   casadi_c_active = id;
   return 0;
 }
 
+// Register a handle, call with the lock held
+inline int casadi_c_add_handle(const Function& f) {
+  std::unique_ptr<Function> h(new Function(f));
+  // Reuse a closed handle, if any
+  for (int k=0; k<casadi_c_handles.size(); ++k) {
+    if (!casadi_c_handles[k]) {
+      casadi_c_handles[k] = std::move(h);
+      return k;
+    }
+  }
+  casadi_c_handles.push_back(std::move(h));
+  return casadi_c_handles.size()-1;
+}
+
+int casadi_c_open(int id) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  if (sanitize_id(id)) return -1;
+  return casadi_c_add_handle(casadi_c_loaded_functions[id]);
+}
+
+int casadi_c_open_file(const char* filename, const char* funname) {
+  // Deserialize without holding the lock
+  std::vector<Function> fs;
+  int ret = casadi_c_read_file(filename, fs);
+  if (ret==0) ret = casadi_c_id_internal(fs, funname);
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  if (ret>=0) ret = casadi_c_add_handle(fs[ret]);
+  fs.clear();
+  return ret;
+}
+
+void casadi_c_close(int handle) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  if (handle<0 || handle>=casadi_c_handles.size() || !casadi_c_handles[handle]) {
+    std::cerr << "handle " << handle << " does not refer to an open Function" << std::endl;
+    return;
+  }
+  casadi_c_handles[handle].reset();
+}
+
 void casadi_c_incref(void) {}
 void casadi_c_decref(void) {}
 void casadi_c_incref_id(int id) {}
 void casadi_c_decref_id(int id) {}
 
-int casadi_c_checkout(void) {
-  return casadi_c_checkout_id(casadi_c_active);
-}
-int casadi_c_checkout_id(int id) {
-  if (sanitize_id(id)) return -1;
+inline int casadi_c_checkout_internal(const Function* f) {
+  if (!f) return -1;
   try {
-    return casadi_c_loaded_functions.at(id).checkout();
+    return f->checkout();
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return -2;
@@ -151,28 +274,62 @@ int casadi_c_checkout_id(int id) {
     return -3;
   }
 }
+int casadi_c_checkout(void) {
+  return casadi_c_checkout_internal(casadi_c_lookup_active());
+}
+int casadi_c_checkout_id(int id) {
+  return casadi_c_checkout_internal(casadi_c_lookup_id(id));
+}
+int casadi_c_handle_checkout(int handle) {
+  return casadi_c_checkout_internal(casadi_c_lookup_handle(handle));
+}
 
+inline void casadi_c_release_internal(const Function* f, int mem) {
+  if (!f) return;
+  try {
+    f->release(mem);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+  } catch (...) {
+    std::cerr << "Uncaught exception" << std::endl;
+  }
+}
 void casadi_c_release(int mem) {
-  casadi_c_release_id(casadi_c_active, mem);
+  casadi_c_release_internal(casadi_c_lookup_active(), mem);
 }
 void casadi_c_release_id(int id, int mem) {
-  sanitize_id(id);
+  casadi_c_release_internal(casadi_c_lookup_id(id), mem);
+}
+void casadi_c_handle_release(int handle, int mem) {
+  casadi_c_release_internal(casadi_c_lookup_handle(handle), mem);
+}
+
+inline double casadi_c_default_in_internal(const Function* f, casadi_int i) {
+  if (!f) return -1;
   try {
-    casadi_c_loaded_functions.at(id).release(mem);
+    return f->default_in(i);
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
+    return -2;
   } catch (...) {
     std::cerr << "Uncaught exception" << std::endl;
+    return -3;
   }
 }
-
 double casadi_c_default_in(casadi_int i) {
-  return casadi_c_default_in_id(casadi_c_active, i);
+  return casadi_c_default_in_internal(casadi_c_lookup_active(), i);
 }
 double casadi_c_default_in_id(int id, casadi_int i) {
-  if (sanitize_id(id)) return -1;
+  return casadi_c_default_in_internal(casadi_c_lookup_id(id), i);
+}
+double casadi_c_handle_default_in(int handle, casadi_int i) {
+  return casadi_c_default_in_internal(casadi_c_lookup_handle(handle), i);
+}
+
+inline casadi_int casadi_c_n_in_internal(const Function* f) {
+  if (!f) return -1;
   try {
-    return casadi_c_loaded_functions.at(id).default_in(i);
+    return f->n_in();
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return -2;
@@ -181,14 +338,20 @@ double casadi_c_default_in_id(int id, casadi_int i) {
     return -3;
   }
 }
-
 casadi_int casadi_c_n_in(void) {
-  return casadi_c_n_in_id(casadi_c_active);
+  return casadi_c_n_in_internal(casadi_c_lookup_active());
 }
 casadi_int casadi_c_n_in_id(int id) {
-  if (sanitize_id(id)) return -1;
+  return casadi_c_n_in_internal(casadi_c_lookup_id(id));
+}
+casadi_int casadi_c_handle_n_in(int handle) {
+  return casadi_c_n_in_internal(casadi_c_lookup_handle(handle));
+}
+
+inline casadi_int casadi_c_n_out_internal(const Function* f) {
+  if (!f) return -1;
   try {
-    return casadi_c_loaded_functions.at(id).n_in();
+    return f->n_out();
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return -2;
@@ -197,40 +360,57 @@ casadi_int casadi_c_n_in_id(int id) {
     return -3;
   }
 }
-
 casadi_int casadi_c_n_out(void) {
-  return casadi_c_n_out_id(casadi_c_active);
+  return casadi_c_n_out_internal(casadi_c_lookup_active());
 }
 casadi_int casadi_c_n_out_id(int id) {
-  if (sanitize_id(id)) return -1;
-  try {
-    return casadi_c_loaded_functions.at(id).n_out();
-  } catch (const std::exception& e) {
-    std::cerr << e.what() << std::endl;
-    return -2;
-  } catch (...) {
-    std::cerr << "Uncaught exception" << std::endl;
-    return -3;
-  }
+  return casadi_c_n_out_internal(casadi_c_lookup_id(id));
+}
+casadi_int casadi_c_handle_n_out(int handle) {
+  return casadi_c_n_out_internal(casadi_c_lookup_handle(handle));
 }
 
+// The name is owned by the Function, no static buffer is shared between threads
+inline const char* casadi_c_name_internal(const Function* f) {
+  if (!f) return "";
+  return f->name().c_str();
+}
 const char* casadi_c_name() {
-  return casadi_c_name_id(casadi_c_active);
+  return casadi_c_name_internal(casadi_c_lookup_active());
 }
 const char* casadi_c_name_id(int id) {
-  if (sanitize_id(id)) return "";
-  static std::string name;
-  name = casadi_c_loaded_functions.at(id).name();
-  return name.c_str();
+  return casadi_c_name_internal(casadi_c_lookup_id(id));
+}
+const char* casadi_c_handle_name(int handle) {
+  return casadi_c_name_internal(casadi_c_lookup_handle(handle));
 }
 
+inline const char* casadi_c_name_in_internal(const Function* f, casadi_int i) {
+  if (!f) return "";
+  try {
+    return f->name_in(i).c_str();
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return "";
+  } catch (...) {
+    std::cerr << "Uncaught exception" << std::endl;
+    return "";
+  }
+}
 const char* casadi_c_name_in(casadi_int i) {
-  return casadi_c_name_in_id(casadi_c_active, i);
+  return casadi_c_name_in_internal(casadi_c_lookup_active(), i);
 }
 const char* casadi_c_name_in_id(int id, casadi_int i) {
-  if (sanitize_id(id)) return "";
+  return casadi_c_name_in_internal(casadi_c_lookup_id(id), i);
+}
+const char* casadi_c_handle_name_in(int handle, casadi_int i) {
+  return casadi_c_name_in_internal(casadi_c_lookup_handle(handle), i);
+}
+
+inline const char* casadi_c_name_out_internal(const Function* f, casadi_int i) {
+  if (!f) return "";
   try {
-    return casadi_c_loaded_functions.at(id).name_in(i).c_str();
+    return f->name_out(i).c_str();
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return "";
@@ -239,30 +419,42 @@ const char* casadi_c_name_in_id(int id, casadi_int i) {
     return "";
   }
 }
-
 const char* casadi_c_name_out(casadi_int i) {
-  return casadi_c_name_out_id(casadi_c_active, i);
+  return casadi_c_name_out_internal(casadi_c_lookup_active(), i);
 }
 const char* casadi_c_name_out_id(int id, casadi_int i) {
-  if (sanitize_id(id)) return "";
+  return casadi_c_name_out_internal(casadi_c_lookup_id(id), i);
+}
+const char* casadi_c_handle_name_out(int handle, casadi_int i) {
+  return casadi_c_name_out_internal(casadi_c_lookup_handle(handle), i);
+}
+
+inline const casadi_int* casadi_c_sparsity_in_internal(const Function* f, casadi_int i) {
+  if (!f) return nullptr;
   try {
-    return casadi_c_loaded_functions.at(id).name_out(i).c_str();
+    return f->sparsity_in(i);
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
-    return "";
+    return nullptr;
   } catch (...) {
     std::cerr << "Uncaught exception" << std::endl;
-    return "";
+    return nullptr;
   }
 }
-
 const casadi_int* casadi_c_sparsity_in(casadi_int i) {
-  return casadi_c_sparsity_in_id(casadi_c_active, i);
+  return casadi_c_sparsity_in_internal(casadi_c_lookup_active(), i);
 }
 const casadi_int* casadi_c_sparsity_in_id(int id, casadi_int i) {
-  if (sanitize_id(id)) return nullptr;
+  return casadi_c_sparsity_in_internal(casadi_c_lookup_id(id), i);
+}
+const casadi_int* casadi_c_handle_sparsity_in(int handle, casadi_int i) {
+  return casadi_c_sparsity_in_internal(casadi_c_lookup_handle(handle), i);
+}
+
+inline const casadi_int* casadi_c_sparsity_out_internal(const Function* f, casadi_int i) {
+  if (!f) return nullptr;
   try {
-    return casadi_c_loaded_functions.at(id).sparsity_in(i);
+    return f->sparsity_out(i);
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return nullptr;
@@ -271,36 +463,52 @@ const casadi_int* casadi_c_sparsity_in_id(int id, casadi_int i) {
     return nullptr;
   }
 }
-
 const casadi_int* casadi_c_sparsity_out(casadi_int i) {
-  return casadi_c_sparsity_out_id(casadi_c_active, i);
+  return casadi_c_sparsity_out_internal(casadi_c_lookup_active(), i);
 }
 const casadi_int* casadi_c_sparsity_out_id(int id, casadi_int i) {
-  if (sanitize_id(id)) return nullptr;
+  return casadi_c_sparsity_out_internal(casadi_c_lookup_id(id), i);
+}
+const casadi_int* casadi_c_handle_sparsity_out(int handle, casadi_int i) {
+  return casadi_c_sparsity_out_internal(casadi_c_lookup_handle(handle), i);
+}
+
+inline int casadi_c_work_internal(const Function* f, casadi_int *sz_arg, casadi_int* sz_res,
+    casadi_int *sz_iw, casadi_int *sz_w) {
+  if (!f) return -1;
   try {
-    return casadi_c_loaded_functions.at(id).sparsity_out(i);
+    *sz_arg = f->sz_arg();
+    *sz_res = f->sz_res();
+    *sz_iw = f->sz_iw();
+    *sz_w = f->sz_w();
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
-    return nullptr;
+    return -2;
   } catch (...) {
     std::cerr << "Uncaught exception" << std::endl;
-    return nullptr;
+    return -3;
   }
+  return 0;
 }
-
 int casadi_c_work(casadi_int *sz_arg, casadi_int* sz_res,
     casadi_int *sz_iw, casadi_int *sz_w) {
-  return casadi_c_work_id(casadi_c_active, sz_arg, sz_res, sz_iw, sz_w);
+  return casadi_c_work_internal(casadi_c_lookup_active(), sz_arg, sz_res, sz_iw, sz_w);
 }
-
 int casadi_c_work_id(int id, casadi_int *sz_arg, casadi_int* sz_res,
     casadi_int *sz_iw, casadi_int *sz_w) {
-  if (sanitize_id(id)) return -1;
+  return casadi_c_work_internal(casadi_c_lookup_id(id), sz_arg, sz_res, sz_iw, sz_w);
+}
+int casadi_c_handle_work(int handle, casadi_int *sz_arg, casadi_int* sz_res,
+    casadi_int *sz_iw, casadi_int *sz_w) {
+  return casadi_c_work_internal(casadi_c_lookup_handle(handle), sz_arg, sz_res, sz_iw, sz_w);
+}
+
+// Evaluate without holding the lock, distinct memory objects may be used concurrently
+inline int casadi_c_eval_internal(const Function* f, const double** arg, double** res,
+    casadi_int* iw, double* w, int mem) {
+  if (!f) return -1;
   try {
-    *sz_arg = casadi_c_loaded_functions.at(id).sz_arg();
-    *sz_res = casadi_c_loaded_functions.at(id).sz_res();
-    *sz_iw = casadi_c_loaded_functions.at(id).sz_iw();
-    *sz_w = casadi_c_loaded_functions.at(id).sz_w();
+    return (*f)(arg, res, iw, w, mem);
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return -2;
@@ -308,17 +516,38 @@ int casadi_c_work_id(int id, casadi_int *sz_arg, casadi_int* sz_res,
     std::cerr << "Uncaught exception" << std::endl;
     return -3;
   }
-  return 0;
 }
-
 int casadi_c_eval(const double** arg, double** res, casadi_int* iw, double* w, int mem) {
-  return casadi_c_eval_id(casadi_c_active, arg, res, iw, w, mem);
+  return casadi_c_eval_internal(casadi_c_lookup_active(), arg, res, iw, w, mem);
 }
-
 int casadi_c_eval_id(int id, const double** arg, double** res, casadi_int* iw, double* w, int mem) {
+  return casadi_c_eval_internal(casadi_c_lookup_id(id), arg, res, iw, w, mem);
+}
+int casadi_c_handle_eval(int handle, const double** arg, double** res,
+    casadi_int* iw, double* w, int mem) {
+  return casadi_c_eval_internal(casadi_c_lookup_handle(handle), arg, res, iw, w, mem);
+}
+
+int casadi_c_prepare(void) {
+  return casadi_c_prepare_id(casadi_c_active);
+}
+
+int casadi_c_prepare_id(int id) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
   if (sanitize_id(id)) return -1;
   try {
-    return casadi_c_loaded_functions.at(id)(arg, res, iw, w, mem);
+    std::unique_ptr<FunctionBuffer> buf(new FunctionBuffer(casadi_c_loaded_functions.at(id)));
+    // Reuse a released handle, if any
+    for (int h=0; h<casadi_c_prepared.size(); ++h) {
+      if (!casadi_c_prepared[h]) {
+        casadi_c_prepared[h] = std::move(buf);
+        return h;
+      }
+    }
+    casadi_c_prepared.push_back(std::move(buf));
+    return casadi_c_prepared.size()-1;
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return -2;
@@ -326,5 +555,601 @@ int casadi_c_eval_id(int id, const double** arg, double** res, casadi_int* iw, d
     std::cerr << "Uncaught exception" << std::endl;
     return -3;
   }
+}
+
+inline FunctionBuffer* sanitize_handle(int handle) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  if (handle<0 || handle>=casadi_c_prepared.size() || !casadi_c_prepared[handle]) {
+    std::cerr << "handle " << handle << " does not refer to a prepared call" << std::endl;
+    return nullptr;
+  }
+  return casadi_c_prepared[handle].get();
+}
+
+int casadi_c_prepared_set_arg(int handle, casadi_int i, const double* a) {
+  FunctionBuffer* buf = sanitize_handle(handle);
+  if (!buf) return -1;
+  try {
+    buf->bind_arg(i, a);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return -2;
+  }
   return 0;
 }
+
+int casadi_c_prepared_set_res(int handle, casadi_int i, double* r) {
+  FunctionBuffer* buf = sanitize_handle(handle);
+  if (!buf) return -1;
+  try {
+    buf->bind_res(i, r);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return -2;
+  }
+  return 0;
+}
+
+int casadi_c_prepared_eval(int handle) {
+  // Hot path: no diagnostics beyond a bounds check
+  if (handle<0 || handle>=casadi_c_prepared.size() || !casadi_c_prepared[handle]) return -1;
+  try {
+    FunctionBuffer& buf = *casadi_c_prepared[handle];
+    buf._eval();
+    return buf.ret();
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return -2;
+  } catch (...) {
+    std::cerr << "Uncaught exception" << std::endl;
+    return -3;
+  }
+}
+
+void casadi_c_prepared_release(int handle) {
+  if (!sanitize_handle(handle)) return;
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  casadi_c_prepared[handle].reset();
+}
+
+#ifndef _WIN32
+namespace {
+  // Identifies a segment created by casadi_c_serve
+  const casadi_int casadi_c_shm_magic = 0x63617364692d7331;
+
+  // States of a slot
+  enum { SLOT_IDLE, SLOT_PENDING, SLOT_DONE };
+
+  // Start of the shared memory segment, offsets are in bytes from its start
+  struct ShmHeader {
+    casadi_int magic;
+    casadi_int int_width, real_width;
+    // Total size of the segment
+    casadi_int size;
+    // Number of Functions and slots, nonzeros per slot
+    casadi_int n_f, n_slot, slot_size;
+    // Offsets of the Function table, io offset table, slots, ring and slot data
+    casadi_int off_f, off_io, off_slot, off_ring, off_data;
+    // Server process, for detecting a dead server
+    casadi_int server_pid;
+    // Protects all fields below and all slots
+    pthread_mutex_t mtx;
+    // Signalled when a request is queued or the server is to stop
+    pthread_cond_t request;
+    // Ring of slot indices with pending requests
+    casadi_int head, count;
+    // Set by casadi_c_remote_shutdown
+    casadi_int stop;
+  };
+
+  // A Function hosted by the server
+  struct ShmFunction {
+    char name[256];
+    casadi_int n_in, n_out;
+    // Index of the first entry in the io offset table, n_in+n_out+1 entries
+    casadi_int io;
+  };
+
+  // A client slot, owning slot_size doubles of argument and result data
+  struct ShmSlot {
+    pthread_cond_t done;
+    casadi_int state, id, ret;
+    // Connected client process, 0 if free
+    casadi_int owner_pid;
+  };
+
+  // Round up to a multiple of 64 bytes
+  inline casadi_int shm_align(casadi_int n) {
+    return (n + 63) / 64 * 64;
+  }
+
+  inline std::string shm_name(const char* name) {
+    return name[0]=='/' ? std::string(name) : "/" + std::string(name);
+  }
+
+  // Lock the segment, recovering the lock of a process that died holding it
+  inline void shm_lock(ShmHeader* h) {
+#ifdef PTHREAD_MUTEX_ROBUST
+    if (pthread_mutex_lock(&h->mtx)==EOWNERDEAD) pthread_mutex_consistent(&h->mtx);
+#else // PTHREAD_MUTEX_ROBUST
+    pthread_mutex_lock(&h->mtx);
+#endif // PTHREAD_MUTEX_ROBUST
+  }
+
+  // Wait on a condition for at most a second
+  inline void shm_wait(ShmHeader* h, pthread_cond_t* c) {
+    timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    t.tv_sec += 1;
+#ifdef PTHREAD_MUTEX_ROBUST
+    if (pthread_cond_timedwait(c, &h->mtx, &t)==EOWNERDEAD) pthread_mutex_consistent(&h->mtx);
+#else // PTHREAD_MUTEX_ROBUST
+    pthread_cond_timedwait(c, &h->mtx, &t);
+#endif // PTHREAD_MUTEX_ROBUST
+  }
+
+  inline bool shm_alive(casadi_int pid) {
+    return kill(static_cast<pid_t>(pid), 0)==0 || errno!=ESRCH;
+  }
+
+  inline ShmFunction* shm_f(ShmHeader* h, casadi_int id) {
+    return reinterpret_cast<ShmFunction*>(reinterpret_cast<char*>(h) + h->off_f) + id;
+  }
+  inline casadi_int* shm_io(ShmHeader* h, casadi_int id) {
+    return reinterpret_cast<casadi_int*>(reinterpret_cast<char*>(h) + h->off_io)
+      + shm_f(h, id)->io;
+  }
+  inline ShmSlot* shm_slot(ShmHeader* h, casadi_int s) {
+    return reinterpret_cast<ShmSlot*>(reinterpret_cast<char*>(h) + h->off_slot) + s;
+  }
+  inline casadi_int* shm_ring(ShmHeader* h) {
+    return reinterpret_cast<casadi_int*>(reinterpret_cast<char*>(h) + h->off_ring);
+  }
+  inline double* shm_data(ShmHeader* h, casadi_int s) {
+    return reinterpret_cast<double*>(reinterpret_cast<char*>(h) + h->off_data) + s*h->slot_size;
+  }
+
+  // Serve requests until stopped, evaluating with private work vectors
+  void shm_serve(ShmHeader* h, const std::vector<Function>& fs) {
+    // Work vectors and memory objects, sufficient for all Functions
+    size_t sz_arg=0, sz_res=0, sz_iw=0, sz_w=0;
+    std::vector<int> mem;
+    for (const Function& f : fs) {
+      sz_arg = std::max(sz_arg, f.sz_arg());
+      sz_res = std::max(sz_res, f.sz_res());
+      sz_iw = std::max(sz_iw, f.sz_iw());
+      sz_w = std::max(sz_w, f.sz_w());
+      mem.push_back(f.checkout());
+    }
+    std::vector<const double*> arg(sz_arg);
+    std::vector<double*> res(sz_res);
+    std::vector<casadi_int> iw(sz_iw);
+    std::vector<double> w(sz_w);
+    shm_lock(h);
+    while (true) {
+      while (!h->stop && h->count==0) shm_wait(h, &h->request);
+      if (h->stop) break;
+      // Pop a request from the ring
+      casadi_int s = shm_ring(h)[h->head];
+      h->head = (h->head + 1) % h->n_slot;
+      h->count--;
+      ShmSlot* slot = shm_slot(h, s);
+      casadi_int id = slot->id;
+      pthread_mutex_unlock(&h->mtx);
+      // Evaluate in place: arguments and results live in the slot
+      int ret;
+      if (id<0 || id>=fs.size()) {
+        ret = -1;
+      } else {
+        const Function& f = fs[id];
+        const casadi_int* io = shm_io(h, id);
+        double* data = shm_data(h, s);
+        for (casadi_int i=0; i<f.n_in(); ++i) arg[i] = data + io[i];
+        for (casadi_int i=0; i<f.n_out(); ++i) res[i] = data + io[f.n_in()+i];
+        try {
+          ret = f(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), mem[id]);
+        } catch (const std::exception& e) {
+          std::cerr << e.what() << std::endl;
+          ret = -2;
+        }
+      }
+      shm_lock(h);
+      slot->ret = ret;
+      slot->state = SLOT_DONE;
+      pthread_cond_broadcast(&slot->done);
+    }
+    pthread_mutex_unlock(&h->mtx);
+    for (casadi_int id=0; id<fs.size(); ++id) fs[id].release(mem[id]);
+  }
+
+  // A connection of a client to a server
+  struct ShmConnection {
+    ShmHeader* h;
+    casadi_int slot;
+  };
+  std::vector<std::unique_ptr<ShmConnection> > casadi_c_connections;
+
+  inline ShmConnection* sanitize_connection(int conn) {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+    if (conn<0 || conn>=casadi_c_connections.size() || !casadi_c_connections[conn]) {
+      std::cerr << "conn " << conn << " does not refer to a connection" << std::endl;
+      return nullptr;
+    }
+    return casadi_c_connections[conn].get();
+  }
+
+  inline ShmConnection* sanitize_remote(int conn, int id) {
+    ShmConnection* c = sanitize_connection(conn);
+    if (c && (id<0 || id>=c->h->n_f)) {
+      std::cerr << "id " << id << " is out of range: must be in [0, ";
+      std::cerr << c->h->n_f << "[" << std::endl;
+      return nullptr;
+    }
+    return c;
+  }
+} // namespace
+#endif // _WIN32
+
+int casadi_c_serve(const char* name, int n_slot, int n_thread) {
+#ifdef _WIN32
+  std::cerr << "casadi_c_serve is not available on Windows" << std::endl;
+  return -1;
+#else // _WIN32
+  if (n_slot<1 || n_thread<1) {
+    std::cerr << "n_slot and n_thread must be positive" << std::endl;
+    return -1;
+  }
+#ifndef CASADI_WITH_THREAD
+  if (n_thread>1) {
+    std::cerr << "CasADi was not compiled with WITH_THREAD=ON, serving with one thread"
+              << std::endl;
+    n_thread = 1;
+  }
+#endif // CASADI_WITH_THREAD
+  // The hosted Functions, unaffected by later pushes and pops
+  std::vector<Function> fs;
+  {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+    fs = casadi_c_loaded_functions;
+  }
+  int ret;
+  try {
+    // Argument and result nonzeros of every Function, in a single slot
+    std::vector<casadi_int> io;
+    casadi_int slot_size = 0;
+    for (const Function& f : fs) {
+      casadi_assert(f.name().size()<sizeof(ShmFunction::name),
+        "Function name '" + f.name() + "' too long");
+      casadi_int offset = 0;
+      for (casadi_int i=0; i<f.n_in(); ++i) {
+        io.push_back(offset);
+        offset += f.nnz_in(i);
+      }
+      for (casadi_int i=0; i<f.n_out(); ++i) {
+        io.push_back(offset);
+        offset += f.nnz_out(i);
+      }
+      io.push_back(offset);
+      // Keep every slot 64 byte aligned
+      slot_size = std::max(slot_size,
+        shm_align(offset*sizeof(double))/static_cast<casadi_int>(sizeof(double)));
+    }
+
+    // Layout of the segment
+    ShmHeader layout;
+    layout.off_f = shm_align(sizeof(ShmHeader));
+    layout.off_io = layout.off_f + shm_align(fs.size()*sizeof(ShmFunction));
+    layout.off_slot = layout.off_io + shm_align(io.size()*sizeof(casadi_int));
+    layout.off_ring = layout.off_slot + shm_align(n_slot*sizeof(ShmSlot));
+    layout.off_data = layout.off_ring + shm_align(n_slot*sizeof(casadi_int));
+    layout.size = layout.off_data + n_slot*slot_size*sizeof(double);
+
+    // Create the segment, replacing a stale one
+    std::string sname = shm_name(name);
+    int fd = shm_open(sname.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd<0 && errno==EEXIST) {
+      shm_unlink(sname.c_str());
+      fd = shm_open(sname.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    casadi_assert(fd>=0, "Could not create shared memory '" + sname + "': "
+      + std::string(strerror(errno)));
+    if (ftruncate(fd, layout.size)) {
+      close(fd);
+      shm_unlink(sname.c_str());
+      casadi_error("Could not size shared memory: " + std::string(strerror(errno)));
+    }
+    void* base = mmap(nullptr, layout.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base==MAP_FAILED) {
+      shm_unlink(sname.c_str());
+      casadi_error("Could not map shared memory: " + std::string(strerror(errno)));
+    }
+
+    // Fill in the header, the Function table and the slots
+    ShmHeader* h = static_cast<ShmHeader*>(base);
+    h->int_width = sizeof(casadi_int);
+    h->real_width = sizeof(double);
+    h->size = layout.size;
+    h->n_f = fs.size();
+    h->n_slot = n_slot;
+    h->slot_size = slot_size;
+    h->off_f = layout.off_f;
+    h->off_io = layout.off_io;
+    h->off_slot = layout.off_slot;
+    h->off_ring = layout.off_ring;
+    h->off_data = layout.off_data;
+    h->server_pid = getpid();
+    h->head = h->count = h->stop = 0;
+    pthread_mutexattr_t mattr;
+    pthread_mutexattr_init(&mattr);
+    pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+#ifdef PTHREAD_MUTEX_ROBUST
+    pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST);
+#endif // PTHREAD_MUTEX_ROBUST
+    pthread_mutex_init(&h->mtx, &mattr);
+    pthread_mutexattr_destroy(&mattr);
+    pthread_condattr_t cattr;
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&h->request, &cattr);
+    casadi_int n_io = 0;
+    for (casadi_int id=0; id<fs.size(); ++id) {
+      ShmFunction* e = shm_f(h, id);
+      std::strncpy(e->name, fs[id].name().c_str(), sizeof(e->name));
+      e->n_in = fs[id].n_in();
+      e->n_out = fs[id].n_out();
+      e->io = n_io;
+      n_io += e->n_in + e->n_out + 1;
+    }
+    std::copy(io.begin(), io.end(),
+      reinterpret_cast<casadi_int*>(static_cast<char*>(base) + h->off_io));
+    for (casadi_int s=0; s<n_slot; ++s) {
+      ShmSlot* slot = shm_slot(h, s);
+      pthread_cond_init(&slot->done, &cattr);
+      slot->state = SLOT_IDLE;
+      slot->owner_pid = 0;
+    }
+    pthread_condattr_destroy(&cattr);
+    // Clients check the magic number last
+    __sync_synchronize();
+    h->magic = casadi_c_shm_magic;
+
+    // Serve with n_thread threads, including the calling one
+#ifdef CASADI_WITH_THREAD
+    std::vector<std::thread> threads;
+    for (int t=1; t<n_thread; ++t) threads.emplace_back(shm_serve, h, std::cref(fs));
+#endif // CASADI_WITH_THREAD
+    shm_serve(h, fs);
+#ifdef CASADI_WITH_THREAD
+    for (auto& t : threads) t.join();
+#endif // CASADI_WITH_THREAD
+
+    // Clients still mapping the segment keep it alive until they disconnect
+    shm_unlink(sname.c_str());
+    munmap(base, layout.size);
+    ret = 0;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    ret = -2;
+  }
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  fs.clear();
+  return ret;
+#endif // _WIN32
+}
+
+int casadi_c_connect(const char* name) {
+#ifdef _WIN32
+  std::cerr << "casadi_c_connect is not available on Windows" << std::endl;
+  return -1;
+#else // _WIN32
+  std::string sname = shm_name(name);
+  int fd = shm_open(sname.c_str(), O_RDWR, 0);
+  if (fd<0) {
+    std::cerr << "Could not open shared memory '" << sname << "': "
+              << strerror(errno) << std::endl;
+    return -1;
+  }
+  // Map the header to get the size, then the whole segment
+  struct stat st;
+  if (fstat(fd, &st) || st.st_size<sizeof(ShmHeader)) {
+    std::cerr << "Shared memory '" << sname << "' is not ready" << std::endl;
+    close(fd);
+    return -1;
+  }
+  void* base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base==MAP_FAILED) {
+    std::cerr << "Could not map shared memory: " << strerror(errno) << std::endl;
+    return -1;
+  }
+  ShmHeader* h = static_cast<ShmHeader*>(base);
+  if (h->magic!=casadi_c_shm_magic || h->size!=st.st_size
+      || h->int_width!=sizeof(casadi_int) || h->real_width!=sizeof(double)) {
+    std::cerr << "Shared memory '" << sname << "' is not a compatible CasADi server"
+              << std::endl;
+    munmap(base, st.st_size);
+    return -1;
+  }
+  // Claim a free slot, reclaiming those of clients that died
+  casadi_int slot = -1;
+  shm_lock(h);
+  for (casadi_int s=0; s<h->n_slot; ++s) {
+    ShmSlot* e = shm_slot(h, s);
+    if (e->owner_pid!=0 && e->state!=SLOT_PENDING && !shm_alive(e->owner_pid)) {
+      e->owner_pid = 0;
+    }
+    if (e->owner_pid==0) {
+      e->owner_pid = getpid();
+      e->state = SLOT_IDLE;
+      slot = s;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&h->mtx);
+  if (slot<0) {
+    std::cerr << "All " << h->n_slot << " slots of '" << sname << "' are in use" << std::endl;
+    munmap(base, st.st_size);
+    return -2;
+  }
+  std::unique_ptr<ShmConnection> c(new ShmConnection{h, slot});
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  // Reuse a released handle, if any
+  for (int k=0; k<casadi_c_connections.size(); ++k) {
+    if (!casadi_c_connections[k]) {
+      casadi_c_connections[k] = std::move(c);
+      return k;
+    }
+  }
+  casadi_c_connections.push_back(std::move(c));
+  return casadi_c_connections.size()-1;
+#endif // _WIN32
+}
+
+void casadi_c_disconnect(int conn) {
+#ifndef _WIN32
+  ShmConnection* c = sanitize_connection(conn);
+  if (!c) return;
+  shm_lock(c->h);
+  shm_slot(c->h, c->slot)->owner_pid = 0;
+  pthread_mutex_unlock(&c->h->mtx);
+  munmap(c->h, c->h->size);
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_mtx);
+#endif // CASADI_WITH_THREAD
+  casadi_c_connections[conn].reset();
+#endif // _WIN32
+}
+
+int casadi_c_remote_id(int conn, const char* funname) {
+#ifdef _WIN32
+  return -1;
+#else // _WIN32
+  ShmConnection* c = sanitize_connection(conn);
+  if (!c) return -1;
+  for (casadi_int id=0; id<c->h->n_f; ++id) {
+    if (std::strcmp(shm_f(c->h, id)->name, funname)==0) return id;
+  }
+  std::cerr << "Could not find function named '" << funname << "' on server." << std::endl;
+  return -1;
+#endif // _WIN32
+}
+
+casadi_int casadi_c_remote_n_in(int conn, int id) {
+#ifdef _WIN32
+  return -1;
+#else // _WIN32
+  ShmConnection* c = sanitize_remote(conn, id);
+  return c ? shm_f(c->h, id)->n_in : -1;
+#endif // _WIN32
+}
+
+casadi_int casadi_c_remote_n_out(int conn, int id) {
+#ifdef _WIN32
+  return -1;
+#else // _WIN32
+  ShmConnection* c = sanitize_remote(conn, id);
+  return c ? shm_f(c->h, id)->n_out : -1;
+#endif // _WIN32
+}
+
+casadi_int casadi_c_remote_nnz_in(int conn, int id, casadi_int i) {
+#ifdef _WIN32
+  return -1;
+#else // _WIN32
+  ShmConnection* c = sanitize_remote(conn, id);
+  if (!c || i<0 || i>=shm_f(c->h, id)->n_in) return -1;
+  const casadi_int* io = shm_io(c->h, id);
+  return io[i+1] - io[i];
+#endif // _WIN32
+}
+
+casadi_int casadi_c_remote_nnz_out(int conn, int id, casadi_int i) {
+#ifdef _WIN32
+  return -1;
+#else // _WIN32
+  ShmConnection* c = sanitize_remote(conn, id);
+  if (!c || i<0 || i>=shm_f(c->h, id)->n_out) return -1;
+  const casadi_int* io = shm_io(c->h, id) + shm_f(c->h, id)->n_in;
+  return io[i+1] - io[i];
+#endif // _WIN32
+}
+
+double* casadi_c_remote_arg(int conn, int id, casadi_int i) {
+#ifdef _WIN32
+  return nullptr;
+#else // _WIN32
+  ShmConnection* c = sanitize_remote(conn, id);
+  if (!c || i<0 || i>=shm_f(c->h, id)->n_in) return nullptr;
+  return shm_data(c->h, c->slot) + shm_io(c->h, id)[i];
+#endif // _WIN32
+}
+
+const double* casadi_c_remote_res(int conn, int id, casadi_int i) {
+#ifdef _WIN32
+  return nullptr;
+#else // _WIN32
+  ShmConnection* c = sanitize_remote(conn, id);
+  if (!c || i<0 || i>=shm_f(c->h, id)->n_out) return nullptr;
+  return shm_data(c->h, c->slot) + shm_io(c->h, id)[shm_f(c->h, id)->n_in + i];
+#endif // _WIN32
+}
+
+int casadi_c_remote_eval(int conn, int id) {
+#ifdef _WIN32
+  return -1;
+#else // _WIN32
+  ShmConnection* c = sanitize_remote(conn, id);
+  if (!c) return -1;
+  ShmHeader* h = c->h;
+  ShmSlot* slot = shm_slot(h, c->slot);
+  shm_lock(h);
+  if (h->stop) {
+    pthread_mutex_unlock(&h->mtx);
+    std::cerr << "Server has been shut down" << std::endl;
+    return -3;
+  }
+  // Queue the request
+  slot->id = id;
+  slot->state = SLOT_PENDING;
+  shm_ring(h)[(h->head + h->count) % h->n_slot] = c->slot;
+  h->count++;
+  pthread_cond_signal(&h->request);
+  // Wait for completion, giving up if the server died
+  while (slot->state!=SLOT_DONE) {
+    shm_wait(h, &slot->done);
+    if (slot->state!=SLOT_DONE && !shm_alive(h->server_pid)) {
+      pthread_mutex_unlock(&h->mtx);
+      std::cerr << "Server process died" << std::endl;
+      return -3;
+    }
+  }
+  slot->state = SLOT_IDLE;
+  int ret = slot->ret;
+  pthread_mutex_unlock(&h->mtx);
+  return ret;
+#endif // _WIN32
+}
+
+void casadi_c_remote_shutdown(int conn) {
+#ifndef _WIN32
+  ShmConnection* c = sanitize_connection(conn);
+  if (!c) return;
+  shm_lock(c->h);
+  c->h->stop = 1;
+  pthread_cond_broadcast(&c->h->request);
+  pthread_mutex_unlock(&c->h->mtx);
+#endif // _WIN32
+}
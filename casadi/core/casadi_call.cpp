@@ -25,6 +25,7 @@
 
 #include "casadi_call.hpp"
 #include "function_internal.hpp"
+#include "mx_function.hpp"
 #include "casadi_misc.hpp"
 #include "serializing_stream.hpp"
 
@@ -99,6 +100,17 @@ namespace casadi {
   }
 
   int Call::eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const {
+    // Functions defined by an MX graph are expanded once, and the expansion is reused
+    if (fcn_.is_a("MXFunction") && !fcn_.has_free()) {
+      const Function& ex = fcn_.get<MXFunction>()->expansion();
+      std::vector<const SXElem*> arg1(ex.sz_arg());
+      std::vector<SXElem*> res1(ex.sz_res());
+      std::vector<casadi_int> iw1(ex.sz_iw());
+      std::vector<SXElem> w1(ex.sz_w());
+      std::copy_n(arg, n_dep(), arg1.begin());
+      std::copy_n(res, nout(), res1.begin());
+      return ex(get_ptr(arg1), get_ptr(res1), get_ptr(iw1), get_ptr(w1));
+    }
     return fcn_(arg, res, iw, w);
   }
 
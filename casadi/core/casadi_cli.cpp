@@ -24,40 +24,128 @@
 
 
 #include "function.hpp"
+#include "../casadi_c.h"
 #include <iomanip>
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 using namespace casadi;
 
+// Name of a dump file, e.g. name.000012.in.bin
+std::string dump_file(const std::string& name, casadi_int i, const std::string& suffix) {
+    std::stringstream ss;
+    ss << name << "." << std::setfill('0') << std::setw(6) << i << "." << suffix;
+    return ss.str();
+}
+
+// Does a file exist?
+bool file_exists(const std::string& fname) {
+    return std::ifstream(fname).good();
+}
+
+// Extension of the dumped inputs, "bin" or "txt", empty if there are none
+std::string dump_ext(const std::string& name) {
+    if (file_exists(dump_file(name, 0, "in.bin"))) return "bin";
+    if (file_exists(dump_file(name, 0, "in.txt"))) return "txt";
+    return "";
+}
+
 int eval_dump(const std::string& name) {
     // Load function
     Function f = Function::load(name+".casadi");
     f.change_option("dump_in", false);
     f.change_option("dump_out", false);
 
-    // Helper to format filenames 
-    std::stringstream ss;
-    ss << std::setfill('0') << std::setw(6);
+    // Binary or text dump files
+    std::string ext = dump_ext(name);
+    casadi_assert(!ext.empty(), "Could not find a single input file "
+                                "with file name " + name + ".<dddddd>.in.txt or .in.bin");
 
-    std::vector<DM> inputs;
     // Loop over all inputs
     for (int i=0;i<1000000;++i) {
-        ss << i;
-        try {
-            inputs = f.generate_in(name+"."+ss.str()+ ".in.txt");
-        } catch (CasadiException& ex) {
-            if (i==0) {
-                casadi_warning(ex.what());
-                casadi_assert(i>0, "Could not find a single input file "
-                                 "with file name " + name + ".<dddddd>.in.txt");
-            }
-            // No more input files
-            break;
-        }
+        std::string fname = dump_file(name, i, "in." + ext);
+        // No more input files
+        if (!file_exists(fname)) break;
+        std::vector<DM> inputs = f.generate_in(fname);
         // Run function
         std::vector<DM> res = f(inputs);
         // Generate output file
-        f.generate_out(name+"."+ss.str()+ ".out.txt", res);
-        ss.clear();
+        f.generate_out(dump_file(name, i, "out." + ext), res);
+    }
+    return 0;
+}
+
+int bench(const std::string& name, casadi_int repeat) {
+    // Load function
+    Function f = Function::load(name+".casadi");
+    f.change_option("dump_in", false);
+    f.change_option("dump_out", false);
+
+    // Load all recorded inputs, and outputs where available
+    std::string ext = dump_ext(name);
+    casadi_assert(!ext.empty(), "Could not find a single input file "
+                                "with file name " + name + ".<dddddd>.in.txt or .in.bin");
+    std::vector<std::vector<double>> in, out;
+    for (int i=0;i<1000000;++i) {
+        std::string fname = dump_file(name, i, "in." + ext);
+        if (!file_exists(fname)) break;
+        in.push_back(f.nz_from_in(f.generate_in(fname)));
+        fname = dump_file(name, i, "out." + ext);
+        out.push_back(file_exists(fname) ?
+            f.nz_from_out(f.generate_out(fname)) : std::vector<double>());
+    }
+
+    // Work vectors
+    std::vector<const double*> arg(f.sz_arg());
+    std::vector<double*> res(f.sz_res());
+    std::vector<casadi_int> iw(f.sz_iw());
+    std::vector<double> w(f.sz_w()), r(f.nnz_out());
+
+    // Evaluate all recorded inputs, repeatedly
+    double max_dev = 0;
+    casadi_int n_cmp = 0, n_fail = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (casadi_int k=0; k<repeat; ++k) {
+        for (casadi_int i=0; i<in.size(); ++i) {
+            const double* p = in[i].data();
+            for (casadi_int j=0; j<f.n_in(); ++j) {
+                arg[j] = p;
+                p += f.nnz_in(j);
+            }
+            double* q = r.data();
+            for (casadi_int j=0; j<f.n_out(); ++j) {
+                res[j] = q;
+                q += f.nnz_out(j);
+            }
+            if (f(arg.data(), res.data(), iw.data(), w.data())) n_fail++;
+            // Compare with the recorded outputs, once
+            if (k==0 && !out[i].empty()) {
+                n_cmp++;
+                for (casadi_int j=0; j<r.size(); ++j) {
+                    if (r[j]==out[i][j] || (r[j]!=r[j] && out[i][j]!=out[i][j])) continue;
+                    max_dev = std::max(max_dev, std::fabs(r[j]-out[i][j]));
+                }
+            }
+        }
+    }
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+    casadi_int n_call = repeat*in.size();
+
+    uout() << name << ": " << in.size() << " recorded inputs, " << n_call << " calls in "
+           << t << " s, " << 1e6*t/n_call << " us per call";
+    if (n_fail>0) uout() << ", " << n_fail << " failed calls";
+    uout() << std::endl;
+    if (n_cmp>0) {
+        uout() << "Maximum deviation from " << n_cmp << " recorded outputs: " << max_dev
+               << std::endl;
     }
     return 0;
 }
@@ -68,16 +156,165 @@ int eval_dump_parse(const std::vector<std::string>& args) {
     return eval_dump(name);
 }
 
+int bench_parse(const std::vector<std::string>& args) {
+    // casadi-cli bench name [--repeat=n]
+    casadi_assert(args.size()>0, "Usage: $ casadi-cli bench name [--repeat=n]");
+    casadi_int repeat = 1;
+    for (casadi_int i=1; i<args.size(); ++i) {
+        if (args[i].rfind("--repeat=", 0)==0) {
+            repeat = std::stoi(args[i].substr(9));
+        } else {
+            casadi_error("Unrecognised argument '" + args[i] + "'.");
+        }
+    }
+    casadi_assert(repeat>=1, "Number of repetitions must be positive.");
+    return bench(args[0], repeat);
+}
+
+int serve_parse(const std::vector<std::string>& args) {
+    // casadi-cli serve name [--slots=n] [--threads=n] file.casadi ...
+    casadi_assert(args.size()>1,
+        "Usage: $ casadi-cli serve name [--slots=n] [--threads=n] file.casadi ...");
+    int n_slot = 64, n_thread = 1;
+    for (casadi_int i=1; i<args.size(); ++i) {
+        if (args[i].rfind("--slots=", 0)==0) {
+            n_slot = std::stoi(args[i].substr(8));
+        } else if (args[i].rfind("--threads=", 0)==0) {
+            n_thread = std::stoi(args[i].substr(10));
+        } else {
+            casadi_assert(casadi_c_push_file(args[i].c_str())==0,
+                "Could not load '" + args[i] + "'.");
+        }
+    }
+    return casadi_c_serve(args[0].c_str(), n_slot, n_thread);
+}
+
+// Read exactly n bytes from stdin, false on end of stream
+bool read_all(void* buf, size_t n) {
+    return std::fread(buf, 1, n, stdin)==n;
+}
+
+int stream(const std::string& file, casadi_int batch, casadi_int n_thread) {
+    // The binary protocol uses stdout, so all text output goes to stderr
+    Logger::writeFun = [](const char* s, std::streamsize num, bool error) {
+        std::cerr.write(s, num);
+    };
+    Logger::flush = [](bool error) { std::cerr << std::flush; };
+    std::streambuf* cout_buf = std::cout.rdbuf(std::cerr.rdbuf());
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    // Load function, and a mapped version for full batches
+    Function f = Function::load(file);
+    Function fb = batch>1 ? f.map(batch, n_thread>1 ? "thread" : "serial", n_thread) : f;
+    casadi_int n_in = f.n_in(), n_out = f.n_out();
+    casadi_int nnz_in = f.nnz_in(), nnz_out = f.nnz_out();
+
+    // Offsets of the inputs and outputs within one evaluation
+    std::vector<casadi_int> off_in(n_in+1, 0), off_out(n_out+1, 0);
+    for (casadi_int i=0; i<n_in; ++i) off_in[i+1] = off_in[i] + f.nnz_in(i);
+    for (casadi_int i=0; i<n_out; ++i) off_out[i+1] = off_out[i] + f.nnz_out(i);
+
+    // Work vectors, large enough for both functions
+    std::vector<const double*> arg(std::max(f.sz_arg(), fb.sz_arg()));
+    std::vector<double*> res(std::max(f.sz_res(), fb.sz_res()));
+    std::vector<casadi_int> iw(std::max(f.sz_iw(), fb.sz_iw()));
+    std::vector<double> w(std::max(f.sz_w(), fb.sz_w()));
+
+    // Header: number of input and output nonzeros per evaluation
+    int64_t header[2] = {nnz_in, nnz_out};
+    std::fwrite(header, sizeof(int64_t), 2, stdout);
+    std::fflush(stdout);
+
+    // Frames: number of evaluations k, followed by k*nnz_in doubles.
+    // Replies: k*nnz_out doubles. A frame with k=0 or the end of the stream stops
+    std::vector<double> in, out, bin(batch*nnz_in), bout(batch*nnz_out);
+    while (true) {
+        int64_t k;
+        if (!read_all(&k, sizeof(k)) || k<=0) break;
+        in.resize(k*nnz_in);
+        out.resize(k*nnz_out);
+        if (!read_all(in.data(), in.size()*sizeof(double))) {
+            casadi_warning("casadi-cli stream: incomplete frame.");
+            break;
+        }
+        for (int64_t e=0; e<k; ) {
+            // Evaluate a full batch with the mapped function, the remainder one by one
+            bool full = batch>1 && k-e>=batch;
+            casadi_int n = full ? batch : 1;
+            if (full) {
+                // Mapped inputs hold input i of all evaluations contiguously
+                for (casadi_int i=0; i<n_in; ++i) {
+                    double* p = bin.data() + n*off_in[i];
+                    arg[i] = p;
+                    for (casadi_int b=0; b<n; ++b) {
+                        const double* s = in.data() + (e+b)*nnz_in + off_in[i];
+                        p = std::copy(s, s + f.nnz_in(i), p);
+                    }
+                }
+                for (casadi_int i=0; i<n_out; ++i) res[i] = bout.data() + n*off_out[i];
+            } else {
+                for (casadi_int i=0; i<n_in; ++i) arg[i] = in.data() + e*nnz_in + off_in[i];
+                for (casadi_int i=0; i<n_out; ++i) res[i] = out.data() + e*nnz_out + off_out[i];
+            }
+            if ((full ? fb : f)(arg.data(), res.data(), iw.data(), w.data())) {
+                casadi_warning("casadi-cli stream: evaluation failed.");
+            }
+            if (full) {
+                // Back to one record per evaluation
+                for (casadi_int i=0; i<n_out; ++i) {
+                    const double* q = res[i];
+                    for (casadi_int b=0; b<n; ++b) {
+                        std::copy(q, q + f.nnz_out(i), out.data() + (e+b)*nnz_out + off_out[i]);
+                        q += f.nnz_out(i);
+                    }
+                }
+            }
+            e += n;
+        }
+        std::fwrite(out.data(), sizeof(double), out.size(), stdout);
+        std::fflush(stdout);
+    }
+    std::cout.rdbuf(cout_buf);
+    return 0;
+}
+
+int stream_parse(const std::vector<std::string>& args) {
+    // casadi-cli stream file.casadi [--batch=n] [--threads=n]
+    casadi_assert(args.size()>0,
+        "Usage: $ casadi-cli stream file.casadi [--batch=n] [--threads=n]");
+    casadi_int batch = 64, n_thread = 1;
+    for (casadi_int i=1; i<args.size(); ++i) {
+        if (args[i].rfind("--batch=", 0)==0) {
+            batch = std::stoi(args[i].substr(8));
+        } else if (args[i].rfind("--threads=", 0)==0) {
+            n_thread = std::stoi(args[i].substr(10));
+        } else {
+            casadi_error("Unrecognised argument '" + args[i] + "'.");
+        }
+    }
+    casadi_assert(batch>=1 && n_thread>=1, "Batch size and number of threads must be positive.");
+    return stream(args[0], batch, n_thread);
+}
+
 int main(int argc, char* argv[]) {
     // Retrieve all arguments
     std::vector<std::string> args(argv + 1, argv + argc);
 
     // Branch on 'command' (first argument)
-    std::set<std::string> commands = {"eval_dump"};
+    std::set<std::string> commands = {"eval_dump", "bench", "serve", "stream"};
     casadi_assert(args.size()>0, "Must provide a command. Use one of: " + str(commands) + ".");
     std::string cmd = args[0];
     if (cmd=="eval_dump") {
         return eval_dump_parse(std::vector<std::string>(args.begin()+1, args.end()));
+    } else if (cmd=="bench") {
+        return bench_parse(std::vector<std::string>(args.begin()+1, args.end()));
+    } else if (cmd=="serve") {
+        return serve_parse(std::vector<std::string>(args.begin()+1, args.end()));
+    } else if (cmd=="stream") {
+        return stream_parse(std::vector<std::string>(args.begin()+1, args.end()));
     } else {
         casadi_assert(commands.find(cmd)!=commands.end(),
             "Unrecognised command '" + cmd + "'. Use one of: " + str(commands) + ".");
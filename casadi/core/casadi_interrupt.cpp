@@ -41,6 +41,21 @@ namespace casadi {
   void (*InterruptHandler::clearInterrupted)() =
     InterruptHandler::clearInterruptedDefault;
 
+  namespace {
+    // Cancellation flag of the evaluation running in the current thread
+    thread_local const std::atomic<bool>* interrupt_cancel_flag = nullptr;
+  } // namespace
+
+  const std::atomic<bool>* InterruptHandler::set_cancel_flag(const std::atomic<bool>* flag) {
+    const std::atomic<bool>* prev = interrupt_cancel_flag;
+    interrupt_cancel_flag = flag;
+    return prev;
+  }
+
+  bool InterruptHandler::is_cancelled() {
+    return interrupt_cancel_flag && interrupt_cancel_flag->load();
+  }
+
   bool InterruptHandler::is_main_thread() {
 #ifdef CASADI_WITH_THREAD
     static std::thread::id main = std::this_thread::get_id();
@@ -29,6 +29,7 @@
 #include "exception.hpp"
 #include <casadi/core/casadi_export.h>
 
+#include <atomic>
 #include <fstream>
 #include <iostream>
 
@@ -67,12 +68,22 @@ namespace casadi {
     /// Are we in the main thread?
     static bool is_main_thread();
 
-    /// Raises an error if an interrupt was captured.
+    /** \brief Set the cancellation flag of the evaluation in the current thread
+
+        Returns the previous flag, null for none. Used by Function::call_async.
+    */
+    static const std::atomic<bool>* set_cancel_flag(const std::atomic<bool>* flag);
+
+    /// Has the evaluation in the current thread been cancelled?
+    static bool is_cancelled();
+
+    /// Raises an error if an interrupt was captured or the evaluation was cancelled.
     static void check() {
       if (checkInterrupted()) {
         clearInterrupted();
         throw KeyboardInterruptException();
       }
+      if (is_cancelled()) throw KeyboardInterruptException();
     }
   };
 
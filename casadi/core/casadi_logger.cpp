@@ -25,22 +25,114 @@
 #include "casadi_common.hpp"
 #include "casadi_logger.hpp"
 
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
 #ifdef CASADI_WITH_THREAD
 #ifdef CASADI_WITH_THREAD_MINGW
 #include <mingw.mutex.h>
+#include <mingw.thread.h>
+#include <mingw.condition_variable.h>
 #else // CASADI_WITH_THREAD_MINGW
 #include <mutex>
+#include <thread>
+#include <condition_variable>
 #endif // CASADI_WITH_THREAD_MINGW
+#include <atomic>
 #endif //CASADI_WITH_THREAD
 
 namespace casadi {
 
 #ifdef CASADI_WITH_THREAD
   std::mutex mutex_logger;
+
+  /// Output pending for the background writer
+  class AsyncLogger {
+  public:
+    // Maximum number of pending bytes before writers block
+    static const size_t max_pending = 1 << 20;
+
+    // Append output, merged with the previous chunk if it goes to the same stream
+    void write(const char* s, std::streamsize num, bool error) {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_space_.wait(lock, [this] { return pending_size_ < max_pending; });
+      if (pending_.empty() || pending_.back().first != error) {
+        pending_.emplace_back(error, std::string());
+      }
+      pending_.back().second.append(s, num);
+      pending_size_ += num;
+      cv_write_.notify_one();
+    }
+
+    // Start the background writer
+    void start() {
+      stop_ = false;
+      writer_ = std::thread(&AsyncLogger::run, this);
+    }
+
+    // Write out all pending output and stop the background writer
+    void stop() {
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+      }
+      cv_write_.notify_one();
+      writer_.join();
+    }
+
+  private:
+    void run() {
+      std::vector<std::pair<bool, std::string> > writing;
+      std::unique_lock<std::mutex> lock(mtx_);
+      while (true) {
+        cv_write_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+        if (pending_.empty()) break;
+        // Take all pending output, do the I/O without holding the buffer lock
+        writing.swap(pending_);
+        pending_size_ = 0;
+        lock.unlock();
+        cv_space_.notify_all();
+        bool written[2] = {false, false};
+        {
+          std::lock_guard<std::mutex> lock_logger(mutex_logger);
+          for (auto& e : writing) {
+            Logger::writeFun(e.second.data(), e.second.size(), e.first);
+            written[e.first] = true;
+          }
+          for (bool error : {false, true}) {
+            if (written[error]) Logger::flush(error);
+          }
+        }
+        writing.clear();
+        lock.lock();
+      }
+    }
+
+    std::mutex mtx_;
+    std::condition_variable cv_write_, cv_space_;
+    std::vector<std::pair<bool, std::string> > pending_;
+    size_t pending_size_ = 0;
+    bool stop_ = false;
+    std::thread writer_;
+  };
+
+  // Process-wide, never freed, so that output can be drained at exit
+  static AsyncLogger* async_logger = new AsyncLogger();
+  static std::atomic<bool> async_enabled(false);
+
+  static void async_logger_exit() {
+    Logger::set_async(false);
+  }
 #endif //CASADI_WITH_THREAD
 
   void Logger::WriteFunThreadSafe(const char* s, std::streamsize num, bool error) {
 #ifdef CASADI_WITH_THREAD
+    if (async_enabled.load(std::memory_order_relaxed)) {
+      async_logger->write(s, num, error);
+      return;
+    }
     std::lock_guard<std::mutex> lock(mutex_logger);
 #endif //CASADI_WITH_THREAD
     writeFun(s, num, error);
@@ -48,11 +140,39 @@ namespace casadi {
 
   void Logger::FlushThreadSafe(bool error) {
 #ifdef CASADI_WITH_THREAD
+    // The background writer flushes after every batch
+    if (async_enabled.load(std::memory_order_relaxed)) return;
     std::lock_guard<std::mutex> lock(mutex_logger);
 #endif //CASADI_WITH_THREAD
     flush(error);
   }
 
+  void Logger::set_async(bool flag) {
+#ifdef CASADI_WITH_THREAD
+    if (flag == async_enabled) return;
+    if (flag) {
+      static bool exit_registered = false;
+      if (!exit_registered) {
+        std::atexit(async_logger_exit);
+        exit_registered = true;
+      }
+      async_logger->start();
+      async_enabled = true;
+    } else {
+      async_enabled = false;
+      async_logger->stop();
+    }
+#endif //CASADI_WITH_THREAD
+  }
+
+  bool Logger::is_async() {
+#ifdef CASADI_WITH_THREAD
+    return async_enabled;
+#else // CASADI_WITH_THREAD
+    return false;
+#endif //CASADI_WITH_THREAD
+  }
+
   void (*Logger::writeFun)(const char* s, std::streamsize num, bool error) =
     Logger::writeDefault;
 
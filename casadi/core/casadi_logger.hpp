@@ -56,6 +56,22 @@ namespace casadi {
     static void WriteFunThreadSafe(const char* s, std::streamsize num, bool error);
     static void FlushThreadSafe(bool error);
 
+    /** \brief Write output asynchronously
+
+        When enabled, output is appended to an in-memory buffer and handed to writeFun
+        by a background thread, so that a slow console or log sink does not stall the
+        calling thread. Flushing is left to the background thread, which flushes after
+        every batch. Writers block only if more than 1 MB of output is pending.
+        Disabling, or exiting the process, writes out all pending output.
+
+        Without thread support, output remains synchronous.
+        Should not be called while other threads are printing.
+    */
+    static void set_async(bool flag);
+
+    /// Is output written asynchronously?
+    static bool is_async();
+
     /// By default, print to std::cout or std::cerr
     static void writeDefault(const char* s, std::streamsize num, bool error) {
       if (error) {
@@ -37,6 +37,7 @@
 #define CASADI_NEED_UNISTD
 #endif
 #include <random>
+#include <fstream>
 #include <chrono>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -410,6 +411,39 @@ std::string simple_mkstemps(const std::string& prefix, const std::string& suffix
     stream << std::setprecision(std::numeric_limits<double>::digits10 + 1);
   }
 
+  // Magic string at the start of binary nonzero files
+  static const char nz_bin_magic[] = "CASADINZ";
+
+  bool is_nz_bin(const std::string& fname) {
+    return fname.size()>=4 && fname.compare(fname.size()-4, 4, ".bin")==0;
+  }
+
+  void nz_bin_write(const std::string& fname, const std::vector<double>& v) {
+    std::ofstream of(fname, std::ios::binary);
+    casadi_assert(of.good(), "Error opening stream '" + fname + "'.");
+    int64_t n = v.size();
+    of.write(nz_bin_magic, 8);
+    of.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    of.write(reinterpret_cast<const char*>(v.data()), n*sizeof(double));
+    casadi_assert(of.good(), "Error writing to '" + fname + "'.");
+  }
+
+  std::vector<double> nz_bin_read(const std::string& fname) {
+    std::ifstream in(fname, std::ios::binary);
+    casadi_assert(in.good(), "Error opening stream '" + fname + "'.");
+    char magic[8];
+    int64_t n = -1;
+    in.read(magic, 8);
+    in.read(reinterpret_cast<char*>(&n), sizeof(n));
+    casadi_assert(in.good() && std::equal(magic, magic+8, nz_bin_magic) && n>=0,
+      "'" + fname + "' is not a binary nonzero file.");
+    std::vector<double> v(n);
+    in.read(reinterpret_cast<char*>(v.data()), n*sizeof(double));
+    casadi_assert(static_cast<int64_t>(in.gcount())==n*static_cast<int64_t>(sizeof(double)),
+      "'" + fname + "' is truncated.");
+    return v;
+  }
+
 
   std::string str_bvec(bvec_t v) {
     std::stringstream ss;
@@ -404,6 +404,18 @@ private:
   CASADI_EXPORT void normalized_setup(std::istream& stream);
   CASADI_EXPORT void normalized_setup(std::ostream& stream);
 
+  /** \brief Binary files of nonzeros, recognized by the extension ".bin"
+
+      The file holds the 8 characters "CASADINZ", the number of values as a 64-bit
+      integer and the values as doubles, in native byte order. The values are 8-byte
+      aligned, so the file can also be memory mapped.
+  */
+  /// @{
+  CASADI_EXPORT bool is_nz_bin(const std::string& fname);
+  CASADI_EXPORT void nz_bin_write(const std::string& fname, const std::vector<double>& v);
+  CASADI_EXPORT std::vector<double> nz_bin_read(const std::string& fname);
+  /// @}
+
   inline void normalized_out(std::ostream& stream, double val) {
     if (val==std::numeric_limits<double>::infinity()) {
       stream << "inf";
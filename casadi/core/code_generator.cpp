@@ -27,8 +27,11 @@
 #include "code_generator.hpp"
 #include "function_internal.hpp"
 #include "convexify.hpp"
+#include "thread_pool.hpp"
 #include <casadi_runtime_str.h>
+#include <cctype>
 #include <iomanip>
+#include <fstream>
 
 namespace casadi {
 
@@ -39,12 +42,18 @@ namespace casadi {
     this->mex = false;
     this->with_sfunction = false;
     this->cpp = false;
+    this->cpp_template = false;
     this->main = false;
     this->casadi_real_type = "double";
     this->casadi_int_type = CASADI_INT_TYPE_STR;
     this->codegen_scalars = false;
     this->with_header = false;
+    this->split = false;
+    this->batch = 0;
+    this->cuda = false;
     this->with_mem = false;
+    this->static_work = false;
+    this->static_work_align = 0;
     this->with_export = true;
     this->with_import = false;
     this->include_math = true;
@@ -54,6 +63,13 @@ namespace casadi {
     bool prefix_set = false;
     this->prefix = "";
     avoid_stack_ = false;
+    simd_ = false;
+    blas_ = false;
+    unroll_sparse_ = 0;
+    thread_backend_ = "serial";
+    profile_ = false;
+    profile_calls_ = false;
+    float_math_ = false;
     indent_ = 2;
 
     // Read options
@@ -68,6 +84,8 @@ namespace casadi {
         this->with_sfunction = e.second;
       } else if (e.first=="cpp") {
         this->cpp = e.second;
+      } else if (e.first=="cpp_template") {
+        this->cpp_template = e.second;
       } else if (e.first=="main") {
         this->main = e.second;
       } else if (e.first=="casadi_real") {
@@ -78,8 +96,21 @@ namespace casadi {
         this->codegen_scalars = e.second;
       } else if (e.first=="with_header") {
         this->with_header = e.second;
+      } else if (e.first=="split") {
+        this->split = e.second;
+      } else if (e.first=="batch") {
+        this->batch = e.second;
+        casadi_assert(this->batch>=0, "Option 'batch' must be nonnegative");
+      } else if (e.first=="cuda") {
+        this->cuda = e.second;
       } else if (e.first=="with_mem") {
         this->with_mem = e.second;
+      } else if (e.first=="static_work") {
+        this->static_work = e.second;
+      } else if (e.first=="static_work_align") {
+        this->static_work_align = e.second;
+        casadi_assert(this->static_work_align>=0,
+          "Option 'static_work_align' must be nonnegative");
       } else if (e.first=="with_export") {
         this->with_export = e.second;
       } else if (e.first=="with_import") {
@@ -97,6 +128,26 @@ namespace casadi {
         casadi_assert_dev(indent_>=0);
       } else if (e.first=="avoid_stack") {
         avoid_stack_ = e.second;
+      } else if (e.first=="simd") {
+        simd_ = e.second;
+      } else if (e.first=="blas") {
+        blas_ = e.second;
+      } else if (e.first=="unroll_sparse") {
+        unroll_sparse_ = e.second;
+        casadi_assert(unroll_sparse_>=0, "Option 'unroll_sparse' must be nonnegative");
+      } else if (e.first=="thread_backend") {
+        thread_backend_ = e.second.to_string();
+        casadi_assert(thread_backend_=="serial" || thread_backend_=="openmp"
+          || thread_backend_=="pthreads" || thread_backend_=="callback",
+          "Option 'thread_backend' must be 'serial', 'openmp', 'pthreads' or 'callback'");
+      } else if (e.first=="profile") {
+        profile_ = e.second;
+      } else if (e.first=="profile_calls") {
+        profile_calls_ = e.second;
+      } else if (e.first=="float_math") {
+        float_math_ = e.second;
+      } else if (e.first=="input_range") {
+        input_range_ = e.second;
       } else if (e.first=="prefix") {
         this->prefix = e.second.to_string();
         prefix_set = true;
@@ -105,6 +156,37 @@ namespace casadi {
       }
     }
 
+    // All temporaries must live in the static work vector
+    if (this->static_work) avoid_stack_ = true;
+
+    // Header-only C++ class template: no linkage, no separate header
+    if (this->cpp_template) {
+      casadi_assert(!this->split && !this->mex && !this->main && !this->with_sfunction
+        && !this->with_header && !this->with_mem && this->batch==0 && !this->cuda
+        && thread_backend_=="serial",
+        "Option 'cpp_template' cannot be combined with 'split', 'mex', 'main', "
+        "'with_sfunction', 'with_header', 'with_mem', 'batch', 'cuda' or 'thread_backend'");
+      this->cpp = true;
+      this->with_export = false;
+      this->with_import = false;
+      if (this->real_min.empty()) {
+        add_include("limits");
+        this->real_min = "std::numeric_limits<casadi_real>::min()";
+      }
+    }
+
+    // Parallel maps share state between the functions of a translation unit
+    casadi_assert(!this->split || thread_backend_=="serial",
+      "Option 'thread_backend' cannot be combined with 'split'");
+
+    // Single precision math library
+    casadi_assert(!float_math_ || casadi_real_type=="float",
+      "Option 'float_math' requires casadi_real float");
+
+    // BLAS calls assume double precision
+    casadi_assert(!blas_ || casadi_real_type=="double",
+      "Option 'blas' requires casadi_real double");
+
     // If real_min is not specified, make an educated guess
     if (this->real_min.empty()) {
       std::stringstream ss;
@@ -131,7 +213,7 @@ namespace casadi {
     std::string::size_type dotpos = name.rfind('.');
     if (dotpos==std::string::npos) {
       this->name = name;
-      this->suffix = this->cpp ? ".cpp" : ".c";
+      this->suffix = this->cpp_template ? ".hpp" : this->cpp ? ".cpp" : ".c";
     } else {
       this->name = name.substr(0, dotpos);
       this->suffix = name.substr(dotpos);
@@ -204,19 +286,59 @@ namespace casadi {
     }
   }
 
+  std::string CodeGenerator::function_key(const std::string& code, const std::string& fname) {
+    // Skip the leading comment, which contains the name of the function
+    size_t start = 0;
+    if (code.compare(0, 2, "/*")==0) {
+      start = code.find('\n');
+      if (start==std::string::npos) start = code.size();
+    }
+    // Replace the codegen name by a placeholder, whole identifiers only
+    auto is_id = [](char c) { return std::isalnum(c) || c=='_'; };
+    std::string ret;
+    ret.reserve(code.size()-start);
+    for (size_t i=start; i<code.size(); ) {
+      if (code.compare(i, fname.size(), fname)==0 && (i==0 || !is_id(code[i-1]))
+          && (i+fname.size()==code.size() || !is_id(code[i+fname.size()]))) {
+        ret += "@";
+        i += fname.size();
+      } else {
+        ret += code[i++];
+      }
+    }
+    return ret;
+  }
+
   std::string CodeGenerator::add_dependency(const Function& f) {
     // Quick return if it already exists
     for (auto&& e : added_functions_) if (e.f==f) return e.codegen_name;
 
     // Give it a name
-    std::string fname = shorthand("f" + str(added_functions_.size()));
+    casadi_int ind = added_functions_.size();
+    std::string fname = shorthand("f" + str(ind));
 
     // Add to list of functions
     added_functions_.push_back({f, fname});
 
+    // Start of the translation unit, dependencies are moved to their own units
+    size_t unit_start = 0;
+    if (this->split) {
+      flush(this->body);
+      unit_start = this->body.str().size();
+    }
+
+    // File scope definitions before generating, to detect side effects
+    flush(this->body);
+    size_t aux_before = this->auxiliaries.str().size();
+    size_t rom_before = file_scope_double_.size() + file_scope_integer_.size();
+
     // Generate declarations
     f->codegen_declarations(*this);
 
+    // Start of the code of the function itself
+    flush(this->body);
+    size_t fun_start = this->body.str().size();
+
     // Print to file
     f->codegen(*this, fname);
 
@@ -282,6 +404,44 @@ namespace casadi {
     // Flush to body
     flush(this->body);
 
+    // Reuse an identical function generated before, e.g. the same function under another name.
+    // Only if no file scope definitions were added, which would otherwise be left unused
+    if (!fun_needs_mem && aux_before==this->auxiliaries.str().size()
+        && rom_before==file_scope_double_.size() + file_scope_integer_.size()) {
+      std::string b = this->body.str();
+      std::string key = function_key(b.substr(fun_start), fname);
+      auto it = function_code_.find(key);
+      if (it!=function_code_.end()) {
+        // Drop the duplicate definition
+        this->body.str(b.substr(0, fun_start));
+        this->body.seekp(0, std::ios_base::end);
+        added_functions_[ind].codegen_name = it->second;
+        return it->second;
+      }
+      function_code_[key] = fname;
+    }
+
+    // Move function definitions to a separate translation unit
+    if (this->split) {
+      std::string b = this->body.str();
+      units_.push_back(std::make_pair(ind, b.substr(unit_start)));
+      this->body.str(b.substr(0, unit_start));
+      this->body.seekp(0, std::ios_base::end);
+      // Declarations, for use from other translation units
+      unit_declarations_ << f->signature(fname) << ";\n";
+      if (f->has_refcount_) {
+        unit_declarations_ << "void " << fname << "_incref(void);\n"
+                           << "void " << fname << "_decref(void);\n";
+      }
+      if (fun_needs_mem) {
+        unit_declarations_ << "int " << fname << "_alloc_mem(void);\n"
+                           << "int " << fname << "_init_mem(int mem);\n"
+                           << "void " << fname << "_free_mem(int mem);\n"
+                           << "int " << fname << "_checkout(void);\n"
+                           << "void " << fname << "_release(int mem);\n";
+      }
+    }
+
     return fname;
   }
 
@@ -291,12 +451,25 @@ namespace casadi {
 
     // Define function
     *this << declare(f->signature(f.name())) << "{\n"
-          << "return " << codegen_name <<  "(arg, res, iw, w, mem);\n"
+          << "return " << profile_call(f, codegen_name + "(arg, res, iw, w, mem)", true) << ";\n"
           << "}\n\n";
 
     // Generate meta information
     f->codegen_meta(*this);
 
+    // Batched entry point
+    if (this->batch>0 && f->has_codegen_batch()) {
+      f->codegen_batch(*this, f.name() + "_batch", this->batch);
+    }
+
+    // CUDA/HIP kernel with host driver
+    if (this->cuda && f->has_codegen_batch()) {
+      f->codegen_cuda(*this, f.name() + "_cuda");
+    }
+
+    // Statically sized workspace
+    if (this->static_work) add_static_work(f);
+
     // Generate Jacobian sparsity information
     if (with_jac_sparsity) {
       // Generate/get Jacobian sparsity
@@ -315,6 +488,63 @@ namespace casadi {
     this->exposed_fname.push_back(f.name());
   }
 
+  void CodeGenerator::add_static_work(const Function& f) {
+    const std::string& fname = f.name();
+    std::string type = fname + "_work_t";
+
+    // Zero-length arrays are not allowed in C
+    auto len = [](size_t sz) { return std::max(sz, static_cast<size_t>(1)); };
+    std::string align;
+    if (this->static_work_align>0) {
+      align = "casadi_align(" + str(this->static_work_align) + ") ";
+    }
+
+    std::stringstream s;
+    if (!align.empty()) {
+      s << "#ifndef casadi_align\n"
+        << "#if defined(_MSC_VER)\n"
+        << "#define casadi_align(n) __declspec(align(n))\n"
+        << "#elif defined(__GNUC__) || defined(__clang__)\n"
+        << "#define casadi_align(n) __attribute__((aligned(n)))\n"
+        << "#else\n"
+        << "#define casadi_align(n)\n"
+        << "#endif\n"
+        << "#endif\n\n";
+    }
+    // Work vector lengths include all dependencies
+    s << "/* Statically sized workspace of " << fname << " */\n"
+      << "typedef struct {\n"
+      << "  " << align << "casadi_real w[" << len(f.sz_w()) << "];\n"
+      << "  " << align << "casadi_int iw[" << len(f.sz_iw()) << "];\n"
+      << "  const casadi_real* arg[" << len(f.sz_arg()) << "];\n"
+      << "  casadi_real* res[" << len(f.sz_res()) << "];\n"
+      << "  int mem;\n"
+      << "} " << type << ";\n\n";
+    *this << s.str();
+    if (this->with_header) this->header << s.str();
+
+    // Check out memory once, up front
+    *this << declare("int " + fname + "_work_init(" + type + "* work)") << " {\n"
+          << "work->mem = " << fname << "_checkout();\n"
+          << "return work->mem<0;\n"
+          << "}\n\n";
+    *this << declare("void " + fname + "_work_free(" + type + "* work)") << " {\n"
+          << fname << "_release(work->mem);\n"
+          << "}\n\n";
+
+    // Evaluate using the workspace
+    *this << declare("int " + fname + "_static(const casadi_real** arg, casadi_real** res, "
+                     + type + "* work)") << " {\n";
+    for (casadi_int i=0; i<f.n_in(); ++i) {
+      *this << "work->arg[" << i << "] = arg[" << i << "];\n";
+    }
+    for (casadi_int i=0; i<f.n_out(); ++i) {
+      *this << "work->res[" << i << "] = res[" << i << "];\n";
+    }
+    *this << "return " << fname << "(work->arg, work->res, work->iw, work->w, work->mem);\n"
+          << "}\n\n";
+  }
+
   std::string CodeGenerator::dump() {
     std::stringstream s;
     dump(s);
@@ -332,6 +562,11 @@ namespace casadi {
     // Open a file for writing
     f.open(name);
 
+    // Print header
+    file_begin(f, cpp);
+  }
+
+  void CodeGenerator::file_begin(std::ostream& f, bool cpp) {
     // Print header
     f << "/* This file was automatically generated by CasADi " << casadi_version() << ".\n"
       << " *  It consists of: \n"
@@ -350,15 +585,20 @@ namespace casadi {
   }
 
   void CodeGenerator::file_close(std::ofstream& f, bool cpp) {
+    // C linkage
+    file_end(f, cpp);
+
+    // Close file(s)
+    f.close();
+  }
+
+  void CodeGenerator::file_end(std::ostream& f, bool cpp) {
     // C linkage
     if (!cpp) {
       f << "#ifdef __cplusplus\n"
         << "} /* extern \"C\" */\n"
         << "#endif\n";
     }
-
-    // Close file(s)
-    f.close();
   }
 
   void CodeGenerator::generate_casadi_real(std::ostream &s) const {
@@ -414,22 +654,28 @@ namespace casadi {
        "The signature of CodeGenerator::generate has changed. "
        "Instead of providing the filename, only provide the prefix.");
 
-    // Create c file
     std::ofstream s;
-    std::string fullname = prefix + this->name + this->suffix;
-    file_open(s, fullname, this->cpp);
+    std::string fullname;
+    if (this->split) {
+      // One file per function
+      fullname = generate_split(prefix);
+    } else {
+      // Create c file
+      fullname = prefix + this->name + this->suffix;
+      file_open(s, fullname, this->cpp);
 
-    // Dump code to file
-    dump(s);
+      // Dump code to file
+      dump(s);
 
-    // Mex entry point
-    if (this->mex) generate_mex(s);
+      // Mex entry point
+      if (this->mex) generate_mex(s);
 
-    // Main entry point
-    if (this->main) generate_main(s);
+      // Main entry point
+      if (this->main) generate_main(s);
 
-    // Finalize file
-    file_close(s, this->cpp);
+      // Finalize file
+      file_close(s, this->cpp);
+    }
 
     // Generate s-function
     if (this->with_sfunction) {
@@ -442,23 +688,33 @@ namespace casadi {
 
     // Generate header
     if (this->with_header) {
-      // Create a header file
-      file_open(s, prefix + this->name + ".h", this->cpp);
+      std::stringstream h;
+      file_begin(h, this->cpp);
 
       // Define the casadi_real type (typically double)
-      generate_casadi_real(s);
+      generate_casadi_real(h);
 
       // Define the casadi_int type
-      generate_casadi_int(s);
+      generate_casadi_int(h);
 
       // Generate export symbol macros
-      if (this->with_import) generate_import_symbol(s);
+      if (this->with_import) generate_import_symbol(h);
 
       // Add declarations
-      s << this->header.str();
+      h << this->header.str();
 
       // Finalize file
-      file_close(s, this->cpp);
+      file_end(h, this->cpp);
+
+      // Create a header file, leaving an unchanged one untouched in split mode
+      std::string hname = prefix + this->name + ".h";
+      if (this->split) {
+        write_if_changed(hname, h.str());
+      } else {
+        s.open(hname);
+        s << h.str();
+        s.close();
+      }
     }
     return fullname;
   }
@@ -724,6 +980,23 @@ namespace casadi {
       << "}\n";
   }
 
+  void CodeGenerator::generate_function_list(std::ostream &s) {
+    // Only for exported functions, the symbol name must be a valid identifier
+    if (!this->with_export || exposed_fname.empty()) return;
+    if (this->name.empty() || isdigit(this->name[0])) return;
+    for (char c : this->name) if (!isalnum(c) && c!='_') return;
+
+    // Used by external_all to find all functions in a compiled library
+    s << declare("const char* " + this->name + "_functions(casadi_int i)") << " {\n"
+      << "  switch (i) {\n";
+    for (casadi_int i=0; i<exposed_fname.size(); ++i) {
+      s << "    case " << i << ": return \"" << exposed_fname[i] << "\";\n";
+    }
+    s << "    default: return 0;\n"
+      << "  }\n"
+      << "}\n\n";
+  }
+
   void CodeGenerator::define_rom_double(const void* id, casadi_int size) {
     auto it = file_scope_double_.find(id);
     casadi_assert(it==file_scope_double_.end(), "Already defined.");
@@ -753,6 +1026,23 @@ namespace casadi {
   }
 
   void CodeGenerator::dump(std::ostream& s) {
+    // Everything wrapped in a class template
+    if (this->cpp_template) return dump_template(s);
+
+    // Everything but the function definitions
+    dump_preamble(s);
+
+    // Codegen body
+    s << this->body.str();
+
+    // List of exposed functions
+    generate_function_list(s);
+
+    // End with new line
+    s << std::endl;
+  }
+
+  void CodeGenerator::dump_preamble(std::ostream& s) {
     // Consistency check
     casadi_assert_dev(current_indent_ == 0);
 
@@ -776,6 +1066,13 @@ namespace casadi {
     // Integer type (usually long long)
     generate_casadi_int(s);
 
+    // Vectorization-friendly dense kernels, see casadi_dot
+    if (simd_) {
+      s << "#ifndef CASADI_SIMD\n";
+      s << "#define CASADI_SIMD\n";
+      s << "#endif\n\n";
+    }
+
     if (needs_mem_) {
       s << "#ifndef CASADI_MAX_NUM_THREADS\n";
       s << "#define CASADI_MAX_NUM_THREADS 1\n";
@@ -807,8 +1104,12 @@ namespace casadi {
       }
     }
 
-    // Codegen auxiliary functions
-    s << this->auxiliaries.str();
+    // Codegen auxiliary functions, local to each translation unit when splitting
+    if (this->split) {
+      s << make_local(this->auxiliaries.str());
+    } else {
+      s << this->auxiliaries.str();
+    }
 
     // Print integer constants
     if (!integer_constants_.empty()) {
@@ -852,12 +1153,221 @@ namespace casadi {
       }
       s << std::endl << std::endl;
     }
+  }
 
-    // Codegen body
-    s << this->body.str();
+  std::string CodeGenerator::generate_split(const std::string& prefix) {
+    // Files to be written: name and contents
+    std::vector<std::pair<std::string, std::string> > files;
 
-    // End with new line
+    // Shared header
+    std::string shared = this->name + "_shared.h";
+    std::string guard = "CASADI_" + this->name + "_SHARED_H";
+    std::stringstream s;
+    file_begin(s, this->cpp);
+    s << "#ifndef " << guard << "\n"
+      << "#define " << guard << "\n\n"
+      << "/* Auxiliary functions are local to each translation unit */\n"
+      << "#ifndef CASADI_LOCAL\n"
+      << "  #if defined(__GNUC__)\n"
+      << "    #define CASADI_LOCAL static __attribute__((unused))\n"
+      << "  #else\n"
+      << "    #define CASADI_LOCAL static\n"
+      << "  #endif\n"
+      << "#endif\n\n";
+    dump_preamble(s);
+    s << "/* Functions */\n"
+      << unit_declarations_.str() << "\n"
+      << "#endif /* " << guard << " */\n";
+    file_end(s, this->cpp);
+    files.push_back(std::make_pair(prefix + shared, s.str()));
+
+    // One translation unit per function
+    for (auto&& u : units_) {
+      s.str(std::string());
+      file_begin(s, this->cpp);
+      s << "#include \"" << shared << "\"\n\n"
+        << u.second;
+      file_end(s, this->cpp);
+      files.push_back(std::make_pair(prefix + this->name + "_f" + str(u.first)
+                                     + this->suffix, s.str()));
+    }
+
+    // Main file with the entry points
+    s.str(std::string());
+    file_begin(s, this->cpp);
+    s << "#include \"" << shared << "\"\n\n"
+      << this->body.str();
+    generate_function_list(s);
     s << std::endl;
+    if (this->mex) generate_mex(s);
+    if (this->main) generate_main(s);
+    file_end(s, this->cpp);
+    std::string fullname = prefix + this->name + this->suffix;
+    files.push_back(std::make_pair(fullname, s.str()));
+
+    // Write files concurrently
+    ThreadPool::instance().run(files.size(), [&files](casadi_int i) {
+      write_if_changed(files[i].first, files[i].second);
+    });
+    return fullname;
+  }
+
+  void CodeGenerator::dump_template(std::ostream& s) {
+    // Consistency check
+    casadi_assert_dev(current_indent_ == 0);
+
+    // Include guard
+    std::string guard = "CASADI_" + this->name + "_HPP";
+    s << "#ifndef " << guard << "\n"
+      << "#define " << guard << "\n\n";
+    s << this->includes.str() << std::endl;
+
+    // The scalar type is a template parameter, the integer type is fixed
+    generate_casadi_int(s);
+    if (simd_) s << "#ifndef CASADI_SIMD\n#define CASADI_SIMD\n#endif\n\n";
+    if (needs_mem_) s << "#ifndef CASADI_MAX_NUM_THREADS\n#define CASADI_MAX_NUM_THREADS 1\n#endif\n\n";
+
+    // Check if inf/nan is needed
+    for (const auto& d : double_constants_) {
+      for (double e : d) {
+        if (isinf(e)) add_auxiliary(AUX_INF);
+        if (isnan(e)) add_auxiliary(AUX_NAN);
+      }
+    }
+
+    // Data and functions, in the same order as for C
+    std::stringstream m;
+    m << this->auxiliaries.str();
+    for (casadi_int i=0; i<integer_constants_.size(); ++i) {
+      print_vector(m, "casadi_s" + str(i), integer_constants_[i]);
+    }
+    for (casadi_int i=0; i<double_constants_.size(); ++i) {
+      print_vector(m, "casadi_c" + str(i), double_constants_[i]);
+    }
+    casadi_int i=0;
+    for (const auto& it : file_scope_double_) {
+      m << "static casadi_real casadi_rd" + str(i++) + "[" + str(it.second) + "];\n";
+    }
+    i=0;
+    for (const auto& it : file_scope_integer_) {
+      m << "static casadi_real casadi_ri" + str(i++) + "[" + str(it.second) + "];\n";
+    }
+    m << "\n" << this->body.str();
+
+    // External functions have global linkage and are compiled for double
+    if (!added_externals_.empty()) {
+      s << "/* External functions */\n";
+      for (auto&& e : added_externals_) {
+        s << "extern \"C\" " << replace(e, "casadi_real", "double") << "\n";
+      }
+      s << std::endl;
+    }
+
+    s << "template<typename casadi_real>\n"
+      << "struct " << this->name << " {\n"
+      << make_member(m.str())
+      << "};\n\n"
+      << "#endif /* " << guard << " */\n";
+  }
+
+  std::string CodeGenerator::make_member(const std::string& src) {
+    std::stringstream ret;
+    std::string line;
+    std::istringstream stream(src);
+    casadi_int depth = 0;
+    while (std::getline(stream, line)) {
+      if (depth==0 && !line.empty() && (isalpha(line[0]) || line[0]=='_')) {
+        size_t paren = line.find('(');
+        bool is_fun = paren!=std::string::npos && line.find('=')>paren
+          && line.find('{')>paren && line.find(';')>paren;
+        if (line.compare(0, 7, "typedef")==0 || line.compare(0, 6, "struct")==0
+            || line.compare(0, 4, "enum")==0) {
+          // Type definitions are nested types
+        } else if (line.compare(0, 7, "static ")!=0) {
+          // Functions become static member functions
+          if (is_fun) ret << "static ";
+        } else if (!is_fun) {
+          // Integer data is constexpr, other data needs inline definitions
+          if (line.compare(0, 24, "static const casadi_int ")==0) {
+            line = "static constexpr" + line.substr(12);
+          } else {
+            line = "static inline" + line.substr(6);
+          }
+        }
+      }
+      // Track nesting, skipping string and character literals
+      char quote = 0;
+      for (size_t i=0; i<line.size(); ++i) {
+        char c = line[i];
+        if (quote) {
+          if (c=='\\') {
+            ++i;
+          } else if (c==quote) {
+            quote = 0;
+          }
+        } else if (c=='"' || c=='\'') {
+          quote = c;
+        } else if (c=='{') {
+          depth++;
+        } else if (c=='}') {
+          depth--;
+        }
+      }
+      ret << line << "\n";
+    }
+    return ret.str();
+  }
+
+  std::string CodeGenerator::make_local(const std::string& src) {
+    std::stringstream ret;
+    std::string line;
+    std::istringstream stream(src);
+    casadi_int depth = 0;
+    while (std::getline(stream, line)) {
+      // Top-level function definition or declaration
+      if (depth==0 && !line.empty() && (isalpha(line[0]) || line[0]=='_')) {
+        size_t paren = line.find('(');
+        if (paren!=std::string::npos && line.find('=')>paren && line.find('{')>paren
+            && line.compare(0, 7, "typedef")!=0 && line.compare(0, 6, "static")!=0
+            && line.compare(0, 6, "extern")!=0) {
+          ret << "CASADI_LOCAL ";
+        }
+      }
+      // Track nesting, skipping string and character literals
+      char quote = 0;
+      for (size_t i=0; i<line.size(); ++i) {
+        char c = line[i];
+        if (quote) {
+          if (c=='\\') {
+            ++i;
+          } else if (c==quote) {
+            quote = 0;
+          }
+        } else if (c=='"' || c=='\'') {
+          quote = c;
+        } else if (c=='{') {
+          depth++;
+        } else if (c=='}') {
+          depth--;
+        }
+      }
+      ret << line << "\n";
+    }
+    return ret.str();
+  }
+
+  void CodeGenerator::write_if_changed(const std::string& fname, const std::string& contents) {
+    // Compare with existing file, if any, to avoid triggering recompilation
+    std::ifstream existing(fname, std::ios_base::binary);
+    if (existing.good()) {
+      std::stringstream ss;
+      ss << existing.rdbuf();
+      if (ss.str()==contents) return;
+    }
+    existing.close();
+    std::ofstream f(fname, std::ios_base::binary);
+    casadi_assert(f.good(), "Error opening stream '" + fname + "'.");
+    f << contents;
   }
 
   std::string CodeGenerator::work(casadi_int n, casadi_int sz) const {
@@ -919,9 +1429,21 @@ namespace casadi {
       case OP_EXPM1:
         add_auxiliary(AUX_EXPM1);
         return "casadi_expm1("+a0+")";
+      case OP_TWICE:
+        if (float_math_) return "(2.f*"+a0+")";
+        break;
+      case OP_INV:
+        if (float_math_) return "(1.f/"+a0+")";
+        break;
+      case OP_EXP: case OP_LOG: case OP_SQRT: case OP_SIN: case OP_COS: case OP_TAN:
+      case OP_ASIN: case OP_ACOS: case OP_ATAN: case OP_FLOOR: case OP_CEIL: case OP_ERF:
+      case OP_SINH: case OP_COSH: case OP_TANH: case OP_ASINH: case OP_ACOSH: case OP_ATANH:
+        if (float_math_) return math_fun(casadi_math<double>::name(op))+"("+a0+")";
+        break;
       default:
-        return casadi_math<double>::print(op, a0);
+        break;
     }
+    return casadi_math<double>::print(op, a0);
   }
   std::string CodeGenerator::print_op(casadi_int op, const std::string& a0, const std::string& a1) {
     switch (op) {
@@ -934,9 +1456,31 @@ namespace casadi {
       case OP_HYPOT:
         add_auxiliary(AUX_HYPOT);
         return "casadi_hypot("+a0+","+a1+")";
+      case OP_POW: case OP_CONSTPOW: case OP_FMOD: case OP_REMAINDER: case OP_COPYSIGN:
+      case OP_ATAN2:
+        if (float_math_) return math_fun(casadi_math<double>::name(op))+"("+a0+","+a1+")";
+        break;
       default:
-        return casadi_math<double>::print(op, a0, a1);
+        break;
     }
+    return casadi_math<double>::print(op, a0, a1);
+  }
+
+  std::string CodeGenerator::math_fun(const std::string& fname) const {
+    return float_math_ ? fname + "f" : fname;
+  }
+
+  std::string CodeGenerator::constant_real(double v) {
+    std::string ret = constant(v);
+    // Literals, but not casadi_inf and casadi_nan
+    if (float_math_ && !isnan(v) && !isinf(v)) ret += "f";
+    return ret;
+  }
+
+  std::vector<std::vector<double>> CodeGenerator::input_range(const std::string& fname) const {
+    auto it = input_range_.find(fname);
+    if (it==input_range_.end()) return {};
+    return it->second.to_double_vector_vector();
   }
 
   void CodeGenerator::add_include(const std::string& new_include, bool relative_path,
@@ -973,13 +1517,13 @@ namespace casadi {
       local(mem, "int");
       *this << mem << " = " << name << "_checkout();\n";
       *this << "if (" << mem << "<0) return 1;\n";
-      *this << "flag = " + name + "(" + arg + ", " + res + ", "
-              + iw + ", " + w + ", " << mem << ");\n";
+      *this << "flag = " << profile_call(f, name + "(" + arg + ", " + res + ", "
+              + iw + ", " + w + ", " + mem + ")") << ";\n";
       *this << name << "_release(" << mem << ");\n";
       return "flag";
     } else {
-      return name + "(" + arg + ", " + res + ", "
-              + iw + ", " + w + ", 0)";
+      return profile_call(f, name + "(" + arg + ", " + res + ", "
+              + iw + ", " + w + ", 0)");
     }
   }
 
@@ -1066,6 +1610,14 @@ namespace casadi {
     }
 
     if (allow_adding) {
+      // A narrower integer type must be able to hold all entries
+      if (this->casadi_int_type != CASADI_INT_TYPE_STR) {
+        for (casadi_int e : v) {
+          casadi_assert(e >= INT32_MIN && e <= INT32_MAX,
+            "Integer constant " + str(e) + " does not fit in casadi_int type '"
+            + this->casadi_int_type + "'");
+        }
+      }
       // Add to constants
       casadi_int ind = integer_constants_.size();
       integer_constants_.push_back(v);
@@ -1144,10 +1696,26 @@ namespace casadi {
       add_auxiliary(AUX_CLEAR, {"casadi_int"});
       this->auxiliaries << sanitize_source(casadi_interpn_str, inst);
       break;
+    case AUX_INTERPN_BATCH:
+      add_auxiliary(AUX_LOW);
+      add_auxiliary(AUX_INTERPN_INTERPOLATE);
+      add_auxiliary(AUX_FLIP, {});
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_CLEAR, {"casadi_int"});
+      this->auxiliaries << sanitize_source(casadi_interpn_batch_str, inst);
+      break;
     case AUX_INTERPN_GRAD:
       add_auxiliary(AUX_INTERPN);
       this->auxiliaries << sanitize_source(casadi_interpn_grad_str, inst);
       break;
+    case AUX_INTERPTT:
+      add_auxiliary(AUX_LOW);
+      this->auxiliaries << sanitize_source(casadi_interptt_str, inst);
+      break;
+    case AUX_INTERPTT_GRAD:
+      add_auxiliary(AUX_LOW);
+      this->auxiliaries << sanitize_source(casadi_interptt_grad_str, inst);
+      break;
     case AUX_DE_BOOR:
       this->auxiliaries << sanitize_source(casadi_de_boor_str, inst);
       break;
@@ -1279,6 +1847,9 @@ namespace casadi {
       add_auxiliary(AUX_CLEAR);
       add_auxiliary(AUX_NORM_2);
       add_auxiliary(AUX_MV);
+      add_auxiliary(AUX_TRANS);
+      add_auxiliary(AUX_TRIUSOLVE);
+      add_auxiliary(AUX_LDL);
       add_auxiliary(AUX_FABS);
       add_auxiliary(AUX_SIGN);
       this->auxiliaries << sanitize_source(casadi_lsqr_str, inst);
@@ -1322,6 +1893,12 @@ namespace casadi {
     case AUX_LDL:
       this->auxiliaries << sanitize_source(casadi_ldl_str, inst);
       break;
+    case AUX_TRIDIAG:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_FABS);
+      this->auxiliaries << sanitize_source(casadi_tridiag_str, inst);
+      break;
     case AUX_NEWTON:
       add_auxiliary(AUX_COPY);
       add_auxiliary(AUX_AXPY);
@@ -1329,6 +1906,12 @@ namespace casadi {
       add_auxiliary(AUX_QR);
       this->auxiliaries << sanitize_source(casadi_newton_str, inst);
       break;
+    case AUX_EXPM:
+      this->auxiliaries << sanitize_source(casadi_expm_str, inst);
+      break;
+    case AUX_KRON:
+      this->auxiliaries << sanitize_source(casadi_kron_str, inst);
+      break;
     case AUX_MAX_VIOL:
       add_auxiliary(AUX_FMAX);
       this->auxiliaries << sanitize_source(casadi_max_viol_str, inst);
@@ -1378,6 +1961,7 @@ namespace casadi {
       add_auxiliary(AUX_CVX);
       add_auxiliary(AUX_PROJECT);
       add_auxiliary(AUX_REGULARIZE);
+      add_auxiliary(AUX_LDL);
       add_auxiliary(AUX_COPY);
       this->auxiliaries << sanitize_source(casadi_convexify_str, inst);
       break;
@@ -1441,7 +2025,7 @@ namespace casadi {
                         << "#if __STDC_VERSION__ < 199901L\n"
                         << "  return x<y ? x : y;\n"
                         << "#else\n"
-                        << "  return fmin(x, y);\n"
+                        << "  return " << math_fun("fmin") << "(x, y);\n"
                         << "#endif\n"
                         << "}\n\n";
       break;
@@ -1452,7 +2036,7 @@ namespace casadi {
                         << "#if __STDC_VERSION__ < 199901L\n"
                         << "  return x>y ? x : y;\n"
                         << "#else\n"
-                        << "  return fmax(x, y);\n"
+                        << "  return " << math_fun("fmax") << "(x, y);\n"
                         << "#endif\n"
                         << "}\n\n";
       break;
@@ -1463,7 +2047,7 @@ namespace casadi {
                         << "#if __STDC_VERSION__ < 199901L\n"
                         << "  return x>0 ? x : -x;\n"
                         << "#else\n"
-                        << "  return fabs(x);\n"
+                        << "  return " << math_fun("fabs") << "(x);\n"
                         << "#endif\n"
                         << "}\n\n";
       break;
@@ -1520,7 +2104,7 @@ namespace casadi {
                         << "#if __STDC_VERSION__ < 199901L\n"
                         << "  return log(1+x);\n"
                         << "#else\n"
-                        << "  return log1p(x);\n"
+                        << "  return " << math_fun("log1p") << "(x);\n"
                         << "#endif\n"
                         << "}\n\n";
       break;
@@ -1531,7 +2115,7 @@ namespace casadi {
                         << "#if __STDC_VERSION__ < 199901L\n"
                         << "  return exp(x)-1;\n"
                         << "#else\n"
-                        << "  return expm1(x);\n"
+                        << "  return " << math_fun("expm1") << "(x);\n"
                         << "#endif\n"
                         << "}\n\n";
       break;
@@ -1542,13 +2126,201 @@ namespace casadi {
                         << "#if __STDC_VERSION__ < 199901L\n"
                         << "  return sqrt(x*x+y*y);\n"
                         << "#else\n"
-                        << "  return hypot(x, y);\n"
+                        << "  return " << math_fun("hypot") << "(x, y);\n"
                         << "#endif\n"
                         << "}\n\n";
       break;
+    case AUX_PROFILE:
+      this->auxiliaries << "/* Profiling hooks, no-ops unless defined */\n"
+                        << "#ifndef CASADI_PROFILE_ENTER\n"
+                        << "#define CASADI_PROFILE_ENTER(id, name) ((void) 0)\n"
+                        << "#endif\n"
+                        << "#ifndef CASADI_PROFILE_EXIT\n"
+                        << "#define CASADI_PROFILE_EXIT(id, name, flag) (flag)\n"
+                        << "#endif\n\n";
+      break;
+    case AUX_PARALLEL_FOR:
+      shorthand("parallel_for");
+      this->auxiliaries << "typedef void (*casadi_task_t)(void* data, casadi_int k);\n\n"
+                        << "typedef struct {\n"
+                        << "  const casadi_real** arg;\n"
+                        << "  casadi_real** res;\n"
+                        << "  casadi_int* iw;\n"
+                        << "  casadi_real* w;\n"
+                        << "  casadi_int n, n_chunk;\n"
+                        << "  int* flag;\n"
+                        << "} casadi_map_task;\n\n";
+      if (thread_backend_=="openmp") {
+        this->auxiliaries << "void casadi_parallel_for(casadi_int n, casadi_task_t task, "
+                          << "void* data) {\n"
+                          << "  casadi_int k;\n"
+                          << "#ifdef _OPENMP\n"
+                          << "  #pragma omp parallel for schedule(static)\n"
+                          << "#endif\n"
+                          << "  for (k=0; k<n; ++k) task(data, k);\n"
+                          << "}\n\n";
+      } else if (thread_backend_=="callback") {
+        shorthand("dispatch");
+        this->auxiliaries << "static void (*casadi_dispatch)(casadi_int n, casadi_task_t task, "
+                          << "void* data);\n\n"
+                          << declare("void " + this->prefix + "_set_dispatch("
+                               "void (*dispatch)(casadi_int n, "
+                               "void (*task)(void* data, casadi_int k), void* data))") << " {\n"
+                          << "  casadi_dispatch = dispatch;\n"
+                          << "}\n\n"
+                          << "void casadi_parallel_for(casadi_int n, casadi_task_t task, "
+                          << "void* data) {\n"
+                          << "  casadi_int k;\n"
+                          << "  if (casadi_dispatch) {\n"
+                          << "    casadi_dispatch(n, task, data);\n"
+                          << "  } else {\n"
+                          << "    for (k=0; k<n; ++k) task(data, k);\n"
+                          << "  }\n"
+                          << "}\n\n";
+      } else if (thread_backend_=="pthreads") {
+        add_include("pthread.h");
+        for (const char* e : {"pool_busy", "pool_lock", "pool_start", "pool_done",
+                              "pool_n_thread", "pool_n", "pool_next", "pool_pending",
+                              "pool_gen", "pool_task", "pool_data", "pool_work",
+                              "pool_worker"}) shorthand(e);
+        this->auxiliaries
+          << "#ifndef CASADI_NUM_THREADS\n"
+          << "#define CASADI_NUM_THREADS 4\n"
+          << "#endif\n\n"
+          << "/* Serializes parallel loops, nested or concurrent loops run serially */\n"
+          << "static pthread_mutex_t casadi_pool_busy = PTHREAD_MUTEX_INITIALIZER;\n"
+          << "/* Protects the state of the current loop */\n"
+          << "static pthread_mutex_t casadi_pool_lock = PTHREAD_MUTEX_INITIALIZER;\n"
+          << "static pthread_cond_t casadi_pool_start = PTHREAD_COND_INITIALIZER;\n"
+          << "static pthread_cond_t casadi_pool_done = PTHREAD_COND_INITIALIZER;\n"
+          << "static casadi_int casadi_pool_n_thread, casadi_pool_n, casadi_pool_next, "
+          << "casadi_pool_pending;\n"
+          << "static unsigned long casadi_pool_gen;\n"
+          << "static casadi_task_t casadi_pool_task;\n"
+          << "static void* casadi_pool_data;\n\n"
+          << "/* Execute remaining tasks of the current loop, lock held on entry and exit */\n"
+          << "static void casadi_pool_work(void) {\n"
+          << "  casadi_int k;\n"
+          << "  casadi_task_t task;\n"
+          << "  void* data;\n"
+          << "  while (casadi_pool_next<casadi_pool_n) {\n"
+          << "    k = casadi_pool_next++;\n"
+          << "    task = casadi_pool_task;\n"
+          << "    data = casadi_pool_data;\n"
+          << "    pthread_mutex_unlock(&casadi_pool_lock);\n"
+          << "    task(data, k);\n"
+          << "    pthread_mutex_lock(&casadi_pool_lock);\n"
+          << "    if (--casadi_pool_pending==0) pthread_cond_signal(&casadi_pool_done);\n"
+          << "  }\n"
+          << "}\n\n"
+          << "/* Persistent worker, joins every loop started */\n"
+          << "static void* casadi_pool_worker(void* arg) {\n"
+          << "  unsigned long gen = 0;\n"
+          << "  (void)arg;\n"
+          << "  pthread_mutex_lock(&casadi_pool_lock);\n"
+          << "  for (;;) {\n"
+          << "    while (gen==casadi_pool_gen) "
+          << "pthread_cond_wait(&casadi_pool_start, &casadi_pool_lock);\n"
+          << "    gen = casadi_pool_gen;\n"
+          << "    casadi_pool_work();\n"
+          << "  }\n"
+          << "  return 0;\n"
+          << "}\n\n"
+          << "void casadi_parallel_for(casadi_int n, casadi_task_t task, void* data) {\n"
+          << "  casadi_int k;\n"
+          << "  pthread_t thread;\n"
+          << "  if (n<2 || pthread_mutex_trylock(&casadi_pool_busy)) {\n"
+          << "    for (k=0; k<n; ++k) task(data, k);\n"
+          << "    return;\n"
+          << "  }\n"
+          << "  pthread_mutex_lock(&casadi_pool_lock);\n"
+          << "  /* Start workers on first use */\n"
+          << "  while (casadi_pool_n_thread<CASADI_NUM_THREADS-1\n"
+          << "         && pthread_create(&thread, 0, casadi_pool_worker, 0)==0) {\n"
+          << "    pthread_detach(thread);\n"
+          << "    casadi_pool_n_thread++;\n"
+          << "  }\n"
+          << "  casadi_pool_task = task;\n"
+          << "  casadi_pool_data = data;\n"
+          << "  casadi_pool_n = n;\n"
+          << "  casadi_pool_next = 0;\n"
+          << "  casadi_pool_pending = n;\n"
+          << "  casadi_pool_gen++;\n"
+          << "  pthread_cond_broadcast(&casadi_pool_start);\n"
+          << "  /* The calling thread takes part */\n"
+          << "  casadi_pool_work();\n"
+          << "  while (casadi_pool_pending>0) "
+          << "pthread_cond_wait(&casadi_pool_done, &casadi_pool_lock);\n"
+          << "  pthread_mutex_unlock(&casadi_pool_lock);\n"
+          << "  pthread_mutex_unlock(&casadi_pool_busy);\n"
+          << "}\n\n";
+      } else {
+        this->auxiliaries << "void casadi_parallel_for(casadi_int n, casadi_task_t task, "
+                          << "void* data) {\n"
+                          << "  casadi_int k;\n"
+                          << "  for (k=0; k<n; ++k) task(data, k);\n"
+                          << "}\n\n";
+      }
+      break;
     }
   }
 
+  std::string CodeGenerator::parallel_task(const Function& f) {
+    // Quick return if already generated
+    std::string fname = add_dependency(f);
+    auto it = added_tasks_.find(fname);
+    if (it!=added_tasks_.end()) return it->second;
+
+    // Give it a name
+    add_auxiliary(AUX_PARALLEL_FOR);
+    std::string tname = shorthand("task" + str(added_tasks_.size()));
+    added_tasks_[fname] = tname;
+
+    // Work vector sizes of each chunk
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    f.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+
+    // Evaluate the instances of a chunk with the work vectors of the chunk
+    comment("Evaluate a chunk of instances of " + fname);
+    *this << "static void " << tname << "(void* data, casadi_int k) {\n"
+          << "casadi_map_task* d = (casadi_map_task*)data;\n"
+          << "const casadi_real** arg1 = d->arg+" << f.n_in() << "+k*" << sz_arg << ";\n"
+          << "casadi_real** res1 = d->res+" << f.n_out() << "+k*" << sz_res << ";\n"
+          << "casadi_int i, i_end = ((k+1)*d->n)/d->n_chunk;\n"
+          << "for (i=(k*d->n)/d->n_chunk; i<i_end; ++i) {\n";
+    for (casadi_int j=0; j<f.n_in(); ++j) {
+      *this << "arg1[" << j << "] = d->arg[" << j << "] ? d->arg[" << j << "]+i*"
+            << f.nnz_in(j) << " : 0;\n";
+    }
+    for (casadi_int j=0; j<f.n_out(); ++j) {
+      *this << "res1[" << j << "] = d->res[" << j << "] ? d->res[" << j << "]+i*"
+            << f.nnz_out(j) << " : 0;\n";
+    }
+    *this << "if (" << profile_call(f, fname + "(arg1, res1, d->iw+k*" + str(sz_iw)
+                                    + ", d->w+k*" + str(sz_w) + ", 0)") << ") d->flag[k] = 1;\n"
+          << "}\n"
+          << "}\n\n";
+    return tname;
+  }
+
+  std::string CodeGenerator::profile_call(const Function& f, const std::string& call,
+                                          bool entry) {
+    if (!(entry ? profile_ : profile_calls_)) return call;
+    add_auxiliary(AUX_PROFILE);
+    // Index of the function in the generated file
+    casadi_int id = 0;
+    while (!(added_functions_.at(id).f==f)) id++;
+    std::string id_name = str(id) + ", " + constant(f.name());
+    return "(CASADI_PROFILE_ENTER(" + id_name + "), "
+           "CASADI_PROFILE_EXIT(" + id_name + ", " + call + "))";
+  }
+
+  std::string CodeGenerator::parallel_for(const std::string& n, const std::string& task,
+                                          const std::string& data) {
+    add_auxiliary(AUX_PARALLEL_FOR);
+    return "casadi_parallel_for(" + n + ", " + task + ", " + data + ")";
+  }
+
   std::string CodeGenerator::to_mex(const Sparsity& sp, const std::string& arg) {
     add_auxiliary(AUX_TO_MEX);
     std::stringstream s;
@@ -1741,6 +2513,20 @@ namespace casadi {
     return s.str();
   }
 
+  std::string CodeGenerator::interpn_batch(
+      const std::string& res, casadi_int ndim, const std::string& grid,
+      const std::string& offset,
+      const std::string& values, const std::string& x,
+      const std::string& lookup_mode, casadi_int m, casadi_int n,
+      const std::string& iw, const std::string& w) {
+    add_auxiliary(AUX_INTERPN_BATCH);
+    std::stringstream s;
+    s << "casadi_interpn_batch(" << res << ", " << ndim << ", " << grid << ", "  << offset << ", "
+      << values << ", " << x << ", " << lookup_mode << ", " << m << ", " << n << ", "
+      << iw << ", " << w << ");";
+    return s.str();
+  }
+
   std::string CodeGenerator::interpn_grad(const std::string& grad,
       casadi_int ndim, const std::string& grid, const std::string& offset,
       const std::string& values, const std::string& x,
@@ -1753,6 +2539,31 @@ namespace casadi {
     return s.str();
   }
 
+  std::string CodeGenerator::interptt(const std::string& res, casadi_int ndim,
+      const std::string& grid, const std::string& offset, const std::string& cores,
+      const std::string& core_offset, const std::string& rank, const std::string& x,
+      const std::string& lookup_mode, casadi_int m, const std::string& w) {
+    add_auxiliary(AUX_INTERPTT);
+    std::stringstream s;
+    s << "casadi_interptt(" << res << ", " << ndim << ", " << grid << ", " << offset << ", "
+      << cores << ", " << core_offset << ", " << rank << ", " << x << ", " << lookup_mode << ", "
+      << m << ", " << w << ");";
+    return s.str();
+  }
+
+  std::string CodeGenerator::interptt_grad(const std::string& grad, casadi_int ndim,
+      const std::string& grid, const std::string& offset, const std::string& cores,
+      const std::string& core_offset, const std::string& rank, const std::string& x,
+      const std::string& lookup_mode, casadi_int m, const std::string& iw,
+      const std::string& w) {
+    add_auxiliary(AUX_INTERPTT_GRAD);
+    std::stringstream s;
+    s << "casadi_interptt_grad(" << grad << ", " << ndim << ", " << grid << ", " << offset << ", "
+      << cores << ", " << core_offset << ", " << rank << ", " << x << ", " << lookup_mode << ", "
+      << m << ", " << iw << ", " << w << ");";
+    return s.str();
+  }
+
   std::string CodeGenerator::trans(const std::string& x, const Sparsity& sp_x,
                                    const std::string& y, const Sparsity& sp_y,
                                    const std::string& iw) {
@@ -1762,6 +2573,9 @@ namespace casadi {
   }
 
   std::string CodeGenerator::declare(std::string s) {
+    // Static member of the class template
+    if (this->cpp_template) return s;
+
     // Add c linkage
     std::string cpp_prefix = this->cpp ? "extern \"C\" " : "";
 
@@ -1781,6 +2595,24 @@ namespace casadi {
     // If sparsity match, simple copy
     if (sp_arg==sp_res) return copy(arg, sp_arg.nnz(), res);
 
+    // Straight-line assignments
+    if (unroll_sparse_>0 && sp_res.nnz()<=unroll_sparse_) {
+      // Location of each result nonzero in the argument, -1 if structurally zero
+      std::vector<casadi_int> mapping = sp_res.find();
+      sp_arg.get_nz(mapping);
+      std::stringstream s;
+      for (casadi_int k=0; k<sp_res.nnz(); ++k) {
+        if (k>0) s << "\n";
+        s << res << "[" << k << "] = ";
+        if (mapping[k]>=0) {
+          s << arg << "[" << mapping[k] << "];";
+        } else {
+          s << "0;";
+        }
+      }
+      return s.str();
+    }
+
     // Create call
     add_auxiliary(AUX_PROJECT);
     std::stringstream s;
@@ -1913,6 +2745,62 @@ namespace casadi {
                                     const std::string& y, const Sparsity& sp_y,
                                     const std::string& z, const Sparsity& sp_z,
                                     const std::string& w, bool tr) {
+    if (unroll_sparse_>0) {
+      // Terms contributing to each nonzero of z, in the order of casadi_mtimes
+      std::vector<std::vector<std::pair<casadi_int, casadi_int> > > terms(sp_z.nnz());
+      const casadi_int *colind_x = sp_x.colind(), *row_x = sp_x.row();
+      const casadi_int *colind_y = sp_y.colind(), *row_y = sp_y.row();
+      const casadi_int *colind_z = sp_z.colind(), *row_z = sp_z.row();
+      casadi_int n_terms = 0;
+      if (tr) {
+        // z += x'*y
+        std::vector<casadi_int> y_nz(sp_y.size1(), -1);
+        for (casadi_int cc=0; cc<sp_z.size2() && n_terms<=unroll_sparse_; ++cc) {
+          for (casadi_int kk=colind_y[cc]; kk<colind_y[cc+1]; ++kk) y_nz[row_y[kk]] = kk;
+          for (casadi_int kk=colind_z[cc]; kk<colind_z[cc+1]; ++kk) {
+            casadi_int rr = row_z[kk];
+            for (casadi_int kk1=colind_x[rr]; kk1<colind_x[rr+1]; ++kk1) {
+              casadi_int k2 = y_nz[row_x[kk1]];
+              if (k2<0) continue;
+              terms[kk].push_back({kk1, k2});
+              n_terms++;
+            }
+          }
+          for (casadi_int kk=colind_y[cc]; kk<colind_y[cc+1]; ++kk) y_nz[row_y[kk]] = -1;
+        }
+      } else {
+        // z += x*y
+        std::vector<casadi_int> z_nz(sp_z.size1(), -1);
+        for (casadi_int cc=0; cc<sp_y.size2() && n_terms<=unroll_sparse_; ++cc) {
+          for (casadi_int kk=colind_z[cc]; kk<colind_z[cc+1]; ++kk) z_nz[row_z[kk]] = kk;
+          for (casadi_int kk=colind_y[cc]; kk<colind_y[cc+1]; ++kk) {
+            casadi_int rr = row_y[kk];
+            for (casadi_int kk1=colind_x[rr]; kk1<colind_x[rr+1]; ++kk1) {
+              casadi_int k2 = z_nz[row_x[kk1]];
+              if (k2<0) continue;
+              terms[k2].push_back({kk1, kk});
+              n_terms++;
+            }
+          }
+          for (casadi_int kk=colind_z[cc]; kk<colind_z[cc+1]; ++kk) z_nz[row_z[kk]] = -1;
+        }
+      }
+      if (n_terms<=unroll_sparse_) {
+        std::stringstream s;
+        bool first = true;
+        for (casadi_int k=0; k<terms.size(); ++k) {
+          if (terms[k].empty()) continue;
+          if (!first) s << "\n";
+          first = false;
+          s << z << "[" << k << "] = " << z << "[" << k << "]";
+          for (auto&& t : terms[k]) {
+            s << "+" << x << "[" << t.first << "]*" << y << "[" << t.second << "]";
+          }
+          s << ";";
+        }
+        return s.str();
+      }
+    }
     add_auxiliary(AUX_MTIMES);
     return "casadi_mtimes(" + x + ", " + sparsity(sp_x) + ", " + y + ", " + sparsity(sp_y) + ", "
       + z + ", " + sparsity(sp_z) + ", " + w + ", " +  (tr ? "1" : "0") + ");";
@@ -2174,11 +3062,24 @@ namespace casadi {
   }
 
   std::string CodeGenerator::
-  lsqr_solve(const std::string& A, const std::string&x,
-             casadi_int nrhs, bool tr, const std::string& sp, const std::string& w) {
+  qr_solve_block(const std::string& x, casadi_int nrhs, bool tr,
+      const std::string& sp_v, const std::string& v,
+      const std::string& sp_r, const std::string& r,
+      const std::string& beta, const std::string& prinv,
+      const std::string& pc, const std::string& w, casadi_int nb) {
+    add_auxiliary(CodeGenerator::AUX_QR);
+    return "casadi_qr_solve_block(" + x + ", " + str(nrhs) + ", " + (tr ? "1" : "0") + ", "
+           + sp_v + ", " + v + ", " + sp_r + ", " + r + ", "
+           + beta + ", " + prinv + ", " + pc + ", " + w + ", " + str(nb) + ");";
+  }
+
+  std::string CodeGenerator::
+  lsqr_solve(const std::string& p, const std::string& A, const std::string& x,
+             casadi_int nrhs, bool tr, const std::string& pr, const std::string& x0,
+             const std::string& w) {
     add_auxiliary(CodeGenerator::AUX_LSQR);
-    return "casadi_lsqr_solve(" + A + ", " + x + ", " + str(nrhs) + ", "
-           + (tr ? "1" : "0") + ", " + sp + ", " + w + ");";
+    return "casadi_lsqr_solve(" + p + ", " + A + ", " + x + ", " + str(nrhs) + ", "
+           + (tr ? "1" : "0") + ", " + pr + ", " + x0 + ", " + w + ");";
   }
 
   std::string CodeGenerator::
@@ -2190,6 +3091,13 @@ namespace casadi {
            + d + ", " + p + ", " + w + ");";
   }
 
+  std::string CodeGenerator::
+  ldl_sn(const std::string& sn, const std::string& a, const std::string& lt,
+         const std::string& d, const std::string& w, const std::string& iw) {
+    add_auxiliary(CodeGenerator::AUX_LDL);
+    return "casadi_ldl_sn(" + sn + ", " + a + ", " + lt + ", " + d + ", " + w + ", " + iw + ");";
+  }
+
   std::string CodeGenerator::
   ldl_solve(const std::string& x, casadi_int nrhs,
     const std::string& sp_lt, const std::string& lt, const std::string& d,
@@ -2199,6 +3107,32 @@ namespace casadi {
            + lt + ", " + d + ", " + p + ", " + w + ");";
   }
 
+  std::string CodeGenerator::
+  ldl_solve_block(const std::string& x, casadi_int nrhs,
+    const std::string& sp_lt, const std::string& lt, const std::string& d,
+    const std::string& p, const std::string& w, casadi_int nb) {
+    add_auxiliary(CodeGenerator::AUX_LDL);
+    return "casadi_ldl_solve_block(" + x + ", " + str(nrhs) + ", " + sp_lt + ", "
+           + lt + ", " + d + ", " + p + ", " + w + ", " + str(nb) + ");";
+  }
+
+  std::string CodeGenerator::
+  kron(const std::string& a, const Sparsity& sp_a, const std::string& b,
+       const Sparsity& sp_b, const std::string& r) {
+    add_auxiliary(CodeGenerator::AUX_KRON);
+    return "casadi_kron(" + a + ", " + sparsity(sp_a) + ", " + b + ", " + sparsity(sp_b) + ", "
+           + r + ");";
+  }
+
+  std::string CodeGenerator::
+  expm(casadi_int n, casadi_int p, const std::string& a, const std::string& t,
+       const std::string& e, const std::string& r, const std::string& l,
+       const std::string& w, const std::string& iw) {
+    add_auxiliary(CodeGenerator::AUX_EXPM);
+    return "casadi_expm(" + str(n) + ", " + str(p) + ", " + a + ", " + t + ", " + e + ", "
+           + r + ", " + l + ", " + w + ", " + iw + ");";
+  }
+
   std::string CodeGenerator::
   fmax(const std::string& x, const std::string& y) {
     add_auxiliary(CodeGenerator::AUX_FMAX);
@@ -45,7 +45,58 @@ namespace casadi {
     /// Constructor
     CodeGenerator(const std::string& name, const Dict& opts = Dict());
 
-    /// Add a function (name generated)
+    /** \brief Add a function (name generated)
+
+      With the option "batch" set to n>0, SX functions also get an entry point
+      <fname>_batch evaluating n independent instances in struct-of-arrays layout:
+      nonzero j of instance k is stored at position j*n+k of each input and output.
+      Work vector lengths are given by <fname>_batch_work. Inputs and outputs may
+      coincide but must not partially overlap.
+
+      With the option "cuda", SX functions also get a CUDA/HIP kernel in which each
+      thread evaluates one instance, in the same struct-of-arrays layout, and a host
+      driver int <fname>_cuda(const casadi_real** arg, casadi_real** res,
+      casadi_int n, void* stream) taking device pointers and launching the kernel
+      asynchronously on the given stream (null for the default stream). The device
+      code is only compiled by nvcc (e.g. nvcc -x cu) or hipcc (with
+      -include hip/hip_runtime.h).
+
+      With the option "static_work", a type <fname>_work_t holding all work
+      vectors with compile-time sizes is generated, together with the entry
+      points <fname>_work_init, <fname>_work_free and <fname>_static. The
+      option "static_work_align" sets the alignment of the work arrays in bytes.
+
+      The option "thread_backend" selects how maps with "thread" parallelization
+      are evaluated: "serial" (default), "openmp", "pthreads" (a pool of
+      CASADI_NUM_THREADS-1 persistent workers, started on first use) or
+      "callback". With "callback", tasks are handed to a dispatcher registered
+      with <prefix>_set_dispatch, which must call task(data, k) for all k<n and
+      return when all have finished; if none is registered, tasks run serially.
+
+      With the option "profile", each entry point evaluates its function as
+      (CASADI_PROFILE_ENTER(id, name), CASADI_PROFILE_EXIT(id, name, flag)), where
+      flag is the return value of the call, id the index of the function in the
+      generated file and name its name. The option "profile_calls" does the same
+      for calls between generated functions. The hooks default to no-ops and can
+      be defined by the user, e.g. to functions recording timings and call counts.
+
+      With the option "cpp_template", a C++17 header (default suffix .hpp) is
+      generated instead, holding a class template <name><casadi_real> whose
+      static members are all generated functions and data. Entry points are
+      called as <name><double>::<fname>(arg, res, iw, w, mem), and any scalar
+      type supporting the arithmetic and math functions used may be substituted
+      for double. Sparsity patterns and other integer data are constexpr.
+
+      With the option "float_math" (requires casadi_real float), SX functions call
+      the single precision variants of the C99 math functions (sinf, expf, ...)
+      and use float literals, so that no operation is promoted to double. The
+      option "input_range" maps function names to bounds [[lb_0, ub_0], ...]
+      on the nonzeros of each input. For these functions, an interval range
+      analysis bounds all intermediate results, as well as the accumulated
+      rounding error of each output in casadi_real, and is reported in a comment
+      in the generated code. A warning is issued if an intermediate result may
+      overflow casadi_real.
+    */
     void add(const Function& f, bool with_jac_sparsity=false);
 
 #ifndef SWIG
@@ -62,6 +113,11 @@ namespace casadi {
       be a directory or a file prefix.
       returns the filename
 
+      With the option "split", every function dependency is written to a separate
+      translation unit (<name>_f0.c, <name>_f1.c, ...) that includes a shared header
+      (<name>_shared.h) with the auxiliary functions, constants and declarations.
+      Files whose contents did not change are not rewritten.
+
         \identifier{rv} */
     std::string generate(const std::string& prefix="");
 
@@ -218,7 +274,46 @@ namespace casadi {
     /** \brief Avoid stack?
 
         \identifier{si} */
-    bool avoid_stack() { return avoid_stack_;}
+    bool avoid_stack() const { return avoid_stack_;}
+
+    // Call BLAS for large dense operations?
+    bool blas() const { return blas_;}
+
+    /** \brief Maximum number of terms for which sparse kernels are unrolled, 0 if never
+
+      Products, projections and nonzero gathers with sparsity known at generation
+      time are emitted as straight-line code instead of runtime calls indexing
+      into sparsity patterns in ROM.
+    */
+    casadi_int unroll_sparse() const { return unroll_sparse_;}
+
+    /** \brief Wrap a call to a generated function in profiling hooks, if requested */
+    std::string profile_call(const Function& f, const std::string& call, bool entry=false);
+
+    /** \brief Literal of type casadi_real, in single precision with "float_math" */
+    std::string constant_real(double v);
+
+    /** \brief Math function for casadi_real, e.g. sinf instead of sin with "float_math" */
+    std::string math_fun(const std::string& fname) const;
+
+    /** \brief Bounds on the inputs of a function for range analysis, empty if not given */
+    std::vector<std::vector<double>> input_range(const std::string& fname) const;
+
+    /** \brief Backend for parallel evaluation of maps: serial, openmp, pthreads or callback */
+    const std::string& thread_backend() const { return thread_backend_;}
+
+    /** \brief Task evaluating a chunk of a parallel map over f
+
+      The task has signature void(void* data, casadi_int k), where data points to a
+      casadi_map_task struct. Instance i of the map is evaluated with the work
+      vectors of chunk k, which covers instances k*n/n_chunk to (k+1)*n/n_chunk-1.
+      Failures are recorded in flag[k].
+    */
+    std::string parallel_task(const Function& f);
+
+    /** \brief Evaluate tasks 0 to n-1 in parallel, using the thread backend */
+    std::string parallel_for(const std::string& n, const std::string& task,
+                             const std::string& data);
 
     /** \brief Print a constant in a lossless but compact manner
 
@@ -350,6 +445,13 @@ namespace casadi {
                         const std::string& lookup_mode, casadi_int m,
                         const std::string& iw, const std::string& w);
 
+    /** \brief Multilinear interpolation of a batch of points */
+    std::string interpn_batch(const std::string& res, casadi_int ndim, const std::string& grid,
+                        const std::string& offset,
+                        const std::string& values, const std::string& x,
+                        const std::string& lookup_mode, casadi_int m, casadi_int n,
+                        const std::string& iw, const std::string& w);
+
     /** \brief Multilinear interpolation - calculate gradient
 
         \identifier{sx} */
@@ -360,6 +462,20 @@ namespace casadi {
       const std::string& lookup_mode, casadi_int m,
       const std::string& iw, const std::string& w);
 
+    /** \brief Multilinear interpolation of a tensor train */
+    std::string interptt(const std::string& res, casadi_int ndim, const std::string& grid,
+                         const std::string& offset, const std::string& cores,
+                         const std::string& core_offset, const std::string& rank,
+                         const std::string& x, const std::string& lookup_mode, casadi_int m,
+                         const std::string& w);
+
+    /** \brief Multilinear interpolation of a tensor train - calculate gradient */
+    std::string interptt_grad(const std::string& grad, casadi_int ndim, const std::string& grid,
+                              const std::string& offset, const std::string& cores,
+                              const std::string& core_offset, const std::string& rank,
+                              const std::string& x, const std::string& lookup_mode, casadi_int m,
+                              const std::string& iw, const std::string& w);
+
     /** \brief Transpose
 
         \identifier{sy} */
@@ -384,11 +500,19 @@ namespace casadi {
                          const std::string& beta, const std::string& prinv,
                          const std::string& pc, const std::string& w);
 
+    /** \brief QR solve, blocks of nb right-hand-sides */
+    std::string qr_solve_block(const std::string& x, casadi_int nrhs, bool tr,
+                               const std::string& sp_v, const std::string& v,
+                               const std::string& sp_r, const std::string& r,
+                               const std::string& beta, const std::string& prinv,
+                               const std::string& pc, const std::string& w, casadi_int nb);
+
     /** \\brief LSQR solve
 
          \identifier{t1} */
-    std::string lsqr_solve(const std::string& A, const std::string&x,
-                          casadi_int nrhs, bool tr, const std::string& sp, const std::string& w);
+    std::string lsqr_solve(const std::string& p, const std::string& A, const std::string& x,
+                          casadi_int nrhs, bool tr, const std::string& pr,
+                          const std::string& x0, const std::string& w);
 
     /** \brief LDL factorization
 
@@ -398,6 +522,11 @@ namespace casadi {
                    const std::string& d, const std::string& p,
                    const std::string& w);
 
+    /** \brief Supernodal LDL factorization */
+    std::string ldl_sn(const std::string& sn, const std::string& a,
+                       const std::string& lt, const std::string& d,
+                       const std::string& w, const std::string& iw);
+
     /** \brief LDL solve
 
         \identifier{t3} */
@@ -406,6 +535,21 @@ namespace casadi {
                          const std::string& d, const std::string& p,
                          const std::string& w);
 
+    /** \brief LDL solve, blocks of nb right-hand-sides */
+    std::string ldl_solve_block(const std::string& x, casadi_int nrhs,
+                                const std::string& sp_lt, const std::string& lt,
+                                const std::string& d, const std::string& p,
+                                const std::string& w, casadi_int nb);
+
+    /** \brief Kronecker product */
+    std::string kron(const std::string& a, const Sparsity& sp_a, const std::string& b,
+                     const Sparsity& sp_b, const std::string& r);
+
+    /** \brief Matrix exponential expm(t*a), and optionally its Frechet derivative */
+    std::string expm(casadi_int n, casadi_int p, const std::string& a, const std::string& t,
+                     const std::string& e, const std::string& r, const std::string& l,
+                     const std::string& w, const std::string& iw);
+
     /** \brief fmax
 
         \identifier{t4} */
@@ -555,7 +699,10 @@ namespace casadi {
       AUX_TO_MEX,
       AUX_FROM_MEX,
       AUX_INTERPN,
+      AUX_INTERPN_BATCH,
       AUX_INTERPN_GRAD,
+      AUX_INTERPTT,
+      AUX_INTERPTT_GRAD,
       AUX_FLIP,
       AUX_INTERPN_WEIGHTS,
       AUX_LOW,
@@ -570,7 +717,10 @@ namespace casadi {
       AUX_SQPMETHOD,
       AUX_FEASIBLESQPMETHOD,
       AUX_LDL,
+      AUX_TRIDIAG,
       AUX_NEWTON,
+      AUX_EXPM,
+      AUX_KRON,
       AUX_TO_DOUBLE,
       AUX_TO_INT,
       AUX_CAST,
@@ -603,7 +753,9 @@ namespace casadi {
       AUX_MMIN,
       AUX_MMAX,
       AUX_LOGSUMEXP,
-      AUX_SPARSITY
+      AUX_SPARSITY,
+      AUX_PARALLEL_FOR,
+      AUX_PROFILE
     };
 
     /** \brief Add a built-in auxiliary function
@@ -772,12 +924,42 @@ namespace casadi {
     // Generate function specific code for Simulink s-Function
     std::string codegen_sfunction(const Function& f) const;
 
+    // Generate statically sized workspace struct and entry points
+    void add_static_work(const Function& f);
+
     // Export s-Function to file
     void generate_sfunction(const std::string& name, const std::string& sfunction) const;
 
     // Generate main entry point
     void generate_main(std::ostream &s) const;
 
+    // Generate <name>_functions, listing the exposed functions
+    void generate_function_list(std::ostream &s);
+
+    // Generate everything preceding the function definitions
+    void dump_preamble(std::ostream& s);
+
+    // Generate the split translation units, returns the main file name
+    std::string generate_split(const std::string& prefix);
+
+    // Make top-level functions of C source local to the translation unit
+    static std::string make_local(const std::string& src);
+
+    // Make top-level functions and variables of C source static class members
+    static std::string make_member(const std::string& src);
+
+    // Generate the class template of the cpp_template target
+    void dump_template(std::ostream& s);
+
+    // Write a file, unless it exists with the same contents
+    static void write_if_changed(const std::string& fname, const std::string& contents);
+
+    // Print file header and linkage to a stream
+    static void file_begin(std::ostream& f, bool cpp);
+
+    // Close linkage
+    static void file_end(std::ostream& f, bool cpp);
+
     // Generate export symbol macros
     void generate_export_symbol(std::ostream &s) const;
 
@@ -800,9 +982,24 @@ namespace casadi {
     // Should we create a memory entry point?
     bool with_mem;
 
+    // Generate statically sized workspace structs?
+    bool static_work;
+
+    // Alignment of the static work arrays in bytes, 0 for default
+    casadi_int static_work_align;
+
     // Generate header file?
     bool with_header;
 
+    // One translation unit per function?
+    bool split;
+
+    // Number of instances of batched entry points, 0 for none
+    casadi_int batch;
+
+    // Generate CUDA/HIP kernels
+    bool cuda;
+
     // Are we creating a MEX file?
     bool mex;
 
@@ -819,6 +1016,9 @@ namespace casadi {
     // Are we generating C++?
     bool cpp;
 
+    // Generate a header-only class template, parametrized by the scalar type?
+    bool cpp_template;
+
     // Should we generate a main (allowing evaluation from command line)
     bool main;
 
@@ -828,6 +1028,27 @@ namespace casadi {
     // Do we want to be lean on stack usage?
     bool avoid_stack_;
 
+    // Use the vectorization-friendly variants of the dense runtime kernels?
+    bool simd_;
+
+    // Call BLAS for large dense operations?
+    bool blas_;
+
+    // Unroll sparse kernels up to this number of terms
+    casadi_int unroll_sparse_;
+
+    // Backend for parallel evaluation of maps
+    std::string thread_backend_;
+
+    // Profiling hooks around entry points and calls between functions
+    bool profile_, profile_calls_;
+
+    // Single precision math functions and literals
+    bool float_math_;
+
+    // Input bounds for range analysis, by function name
+    Dict input_range_;
+
     std::string infinity, nan, real_min;
 
     /** \brief Codegen scalar
@@ -888,6 +1109,21 @@ namespace casadi {
     };
     std::vector<FunctionMeta> added_functions_;
 
+    // Normalized code of each generated function, for reuse of identical functions
+    std::map<std::string, std::string> function_code_;
+
+    // Parallel map task for each (codegen name of a) function
+    std::map<std::string, std::string> added_tasks_;
+
+    // Normalize generated code of a function for comparison
+    static std::string function_key(const std::string& code, const std::string& fname);
+
+    // Translation units when splitting: codegen index and code of each function
+    std::vector<std::pair<casadi_int, std::string> > units_;
+
+    // Declarations of functions defined in the translation units
+    std::stringstream unit_declarations_;
+
     // Constants
     std::vector<std::vector<double> > double_constants_;
     std::vector<std::vector<casadi_int> > integer_constants_;
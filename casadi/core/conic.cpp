@@ -510,6 +510,37 @@ namespace casadi {
 
   int Conic::
   eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<ConicMemory*>(mem);
+
+    // The solver sees the problem with permuted variables and constraints
+    const double* arg_orig[CONIC_NUM_IN];
+    double* res_orig[CONIC_NUM_OUT];
+    if (!perm_x_.empty()) {
+      std::copy(arg, arg + CONIC_NUM_IN, arg_orig);
+      std::copy(res, res + CONIC_NUM_OUT, res_orig);
+      auto gather = [&](casadi_int i, const std::vector<casadi_int>& p) {
+        if (arg[i]) {
+          for (casadi_int k=0; k<p.size(); ++k) w[k] = arg_orig[i][p[k]];
+          arg[i] = w;
+        }
+        w += p.size();
+      };
+      gather(CONIC_H, perm_h_nz_);
+      gather(CONIC_G, perm_x_);
+      gather(CONIC_A, perm_a_nz_);
+      gather(CONIC_LBX, perm_x_);
+      gather(CONIC_UBX, perm_x_);
+      gather(CONIC_LBA, perm_a_);
+      gather(CONIC_UBA, perm_a_);
+      gather(CONIC_X0, perm_x_);
+      gather(CONIC_LAM_X0, perm_x_);
+      gather(CONIC_LAM_A0, perm_a_);
+      for (casadi_int i : {CONIC_X, CONIC_LAM_X, CONIC_LAM_A}) {
+        if (res[i]) res[i] = w;
+        w += i==CONIC_LAM_A ? na_ : nx_;
+      }
+    }
+
     if (print_problem_) {
       uout() << "H:";
       DM::print_dense(uout(), H_, arg[CONIC_H], false);
@@ -523,7 +554,6 @@ namespace casadi {
       uout() << "lbx:" << std::vector<double>(arg[CONIC_LBX], arg[CONIC_LBX]+nx_) << std::endl;
       uout() << "ubx:" << std::vector<double>(arg[CONIC_UBX], arg[CONIC_UBX]+nx_) << std::endl;
     }
-    auto m = static_cast<ConicMemory*>(mem);
 
     if (inputs_check_) {
       check_inputs(arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
@@ -533,6 +563,17 @@ namespace casadi {
 
     int ret = solve(arg, res, iw, w, mem);
 
+    // Undo the permutation
+    if (!perm_x_.empty()) {
+      for (casadi_int i : {CONIC_X, CONIC_LAM_X, CONIC_LAM_A}) {
+        if (!res[i]) continue;
+        const std::vector<casadi_int>& p = i==CONIC_LAM_A ? perm_a_ : perm_x_;
+        for (casadi_int k=0; k<p.size(); ++k) res_orig[i][p[k]] = res[i][k];
+      }
+      std::copy(arg_orig, arg_orig + CONIC_NUM_IN, arg);
+      std::copy(res_orig, res_orig + CONIC_NUM_OUT, res);
+    }
+
     if (error_on_fail_ && !m->d_qp.success)
       casadi_error("conic process failed. "
                    "Set 'error_on_fail' option to false to ignore this error.");
@@ -551,6 +592,352 @@ namespace casadi {
     return Conic::plugin_options(name).info(op);
   }
 
+  casadi_int Conic::detect_ocp_structure(const Sparsity& A,
+      std::vector<int>& nx, std::vector<int>& nu, std::vector<int>& ng) {
+    nx.clear();
+    nu.clear();
+    ng.clear();
+    casadi_int na = A.size1();
+    if (na==0) return 0;
+
+    /* General strategy: look for the xk+1 diagonal part in A
+    */
+
+    // Find the right-most column for each row in A -> A_skyline
+    // Find the second-to-right-most column -> A_skyline2
+    // Find the left-most column -> A_bottomline
+    Sparsity AT = A.T();
+    std::vector<casadi_int> A_skyline;
+    std::vector<casadi_int> A_skyline2;
+    std::vector<casadi_int> A_bottomline;
+    for (casadi_int i=0;i<AT.size2();++i) {
+      casadi_int pivot = AT.colind()[i+1];
+      A_bottomline.push_back(pivot>AT.colind()[i] ? AT.row()[AT.colind()[i]] : -1);
+      if (pivot>AT.colind()[i]) {
+        A_skyline.push_back(AT.row()[pivot-1]);
+        if (pivot>AT.colind()[i]+1) {
+          A_skyline2.push_back(AT.row()[pivot-2]);
+        } else {
+          A_skyline2.push_back(-1);
+        }
+      } else {
+        A_skyline.push_back(-1);
+        A_skyline2.push_back(-1);
+      }
+    }
+
+    /*
+    Loop over the right-most columns of A:
+    they form the diagonal part due to xk+1 in gap constraints.
+    detect when the diagonal pattern is broken -> new stage
+    */
+    casadi_int pivot = 0; // Current right-most element
+    casadi_int start_pivot = pivot; // First right-most element that started the stage
+    casadi_int cg = 0; // Counter for non-gap-closing constraints
+    for (casadi_int i=0;i<na;++i) { // Loop over all rows
+      bool commit = false; // Set true to jump to the stage
+      if (A_skyline[i]>pivot+1) { // Jump to a diagonal in the future
+        nu.push_back(A_skyline[i]-pivot-1); // Size of jump equals number of states
+        commit = true;
+      } else if (A_skyline[i]==pivot+1) { // Walking the diagonal
+        if (A_skyline2[i]<start_pivot) { // Free of below-diagonal entries?
+          pivot++;
+        } else {
+          nu.push_back(0); // We cannot but conclude that we arrived at a new stage
+          commit = true;
+        }
+      } else { // non-gap-closing constraint detected
+        cg++;
+      }
+
+      if (commit) {
+        nx.push_back(pivot-start_pivot+1);
+        ng.push_back(cg); cg=0;
+        start_pivot = A_skyline[i];
+        pivot = A_skyline[i];
+      }
+    }
+    nx.push_back(pivot-start_pivot+1);
+
+    // Correction for k==0
+    nx[0] = A_skyline[0];
+    if (nu.empty()) nu.push_back(0);
+    nu[0] = 0;
+    ng.erase(ng.begin());
+    casadi_int cN=0;
+    for (casadi_int i=na-1;i>=0;--i) {
+      if (A_bottomline[i]<start_pivot) break;
+      cN++;
+    }
+    ng.push_back(cg-cN);
+    ng.push_back(cN);
+
+    casadi_int N = nu.size();
+    if (N>1) {
+      if (nu[0]==0 && nx[1]+nu[1]==nx[0]) {
+        nx[0] = nx[1];
+        nu[0] = nu[1];
+      }
+    }
+    nu.push_back(0);
+    return N;
+  }
+
+  bool Conic::is_ocp_structure(const Sparsity& H, const Sparsity& A,
+      const std::vector<int>& nx, const std::vector<int>& nu, const std::vector<int>& ng) {
+    casadi_int N = static_cast<casadi_int>(nx.size()) - 1;
+    if (N<1 || nu.size()!=N+1 || ng.size()!=N+1) return false;
+    for (casadi_int k=0; k<=N; ++k) {
+      if (nx[k]<0 || nu[k]<0 || ng[k]<0) return false;
+    }
+
+    // Stage of each variable, first variable of each stage
+    std::vector<casadi_int> var_stage, stage_start;
+    for (casadi_int k=0; k<=N; ++k) {
+      stage_start.push_back(var_stage.size());
+      var_stage.insert(var_stage.end(), nx[k]+nu[k], k);
+    }
+    stage_start.push_back(var_stage.size());
+    if (var_stage.size()!=A.size2() || H.size1()!=A.size2() || H.size2()!=A.size2()) return false;
+
+    // Stage of each constraint, and the identity column for gap-closing rows
+    std::vector<casadi_int> con_stage, con_eye;
+    for (casadi_int k=0; k<=N; ++k) {
+      if (k<N) {
+        for (casadi_int i=0; i<nx[k+1]; ++i) {
+          con_stage.push_back(k);
+          con_eye.push_back(stage_start[k+1]+i);
+        }
+      }
+      con_stage.insert(con_stage.end(), ng[k], k);
+      con_eye.insert(con_eye.end(), ng[k], -1);
+    }
+    if (con_stage.size()!=A.size1()) return false;
+
+    // Constraint Jacobian: A B I / C D blocks
+    const casadi_int *A_colind = A.colind(), *A_row = A.row();
+    for (casadi_int c=0; c<A.size2(); ++c) {
+      for (casadi_int el=A_colind[c]; el<A_colind[c+1]; ++el) {
+        casadi_int r = A_row[el];
+        if (var_stage[c]!=con_stage[r] && con_eye[r]!=c) return false;
+      }
+    }
+
+    // Hessian: block diagonal
+    const casadi_int *H_colind = H.colind(), *H_row = H.row();
+    for (casadi_int c=0; c<H.size2(); ++c) {
+      for (casadi_int el=H_colind[c]; el<H_colind[c+1]; ++el) {
+        if (var_stage[H_row[el]]!=var_stage[c]) return false;
+      }
+    }
+    return true;
+  }
+
+  // Breadth-first search through the variables and constraints of A, from variable s
+  static void ocp_bfs(const Sparsity& A, const Sparsity& AT, casadi_int s,
+      std::vector<casadi_int>& lv, std::vector<casadi_int>& lr) {
+    const casadi_int *colind = A.colind(), *row = A.row();
+    const casadi_int *colind_t = AT.colind(), *row_t = AT.row();
+    lv.assign(A.size2(), -1);
+    lr.assign(A.size1(), -1);
+    std::vector<casadi_int> queue(1, s);
+    lv[s] = 0;
+    for (casadi_int q=0; q<queue.size(); ++q) {
+      casadi_int v = queue[q];
+      for (casadi_int el=colind[v]; el<colind[v+1]; ++el) {
+        casadi_int r = row[el];
+        if (lr[r]>=0) continue;
+        lr[r] = lv[v];
+        for (casadi_int el_t=colind_t[r]; el_t<colind_t[r+1]; ++el_t) {
+          casadi_int u = row_t[el_t];
+          if (lv[u]>=0) continue;
+          lv[u] = lv[v]+1;
+          queue.push_back(u);
+        }
+      }
+    }
+  }
+
+  // Stage structure from a breadth-first search starting at variable s
+  static bool ocp_stages(const Sparsity& H, const Sparsity& A, const Sparsity& AT, casadi_int s,
+      std::vector<casadi_int>& perm_x, std::vector<casadi_int>& perm_a,
+      std::vector<int>& nx, std::vector<int>& nu, std::vector<int>& ng) {
+    casadi_int n = A.size2(), na = A.size1();
+    const casadi_int *colind = A.colind(), *row = A.row();
+    const casadi_int *colind_t = AT.colind(), *row_t = AT.row();
+    std::vector<casadi_int> lv, lr;
+    ocp_bfs(A, AT, s, lv, lr);
+    for (casadi_int v=0; v<n; ++v) if (lv[v]<0) return false;
+    casadi_int L = *std::max_element(lv.begin(), lv.end());
+
+    // Does a constraint reach the next level?
+    std::vector<bool> has_next(na, false);
+    for (casadi_int r=0; r<na; ++r) {
+      for (casadi_int el=colind_t[r]; el<colind_t[r+1]; ++el) {
+        if (lv[row_t[el]]==lr[r]+1) has_next[r] = true;
+      }
+    }
+
+    // Does a variable enter a constraint reaching the next level, from its own level?
+    // Number of constraints of the previous level it enters
+    std::vector<bool> future(n, false);
+    std::vector<casadi_int> n_prev(n, 0);
+    for (casadi_int v=0; v<n; ++v) {
+      for (casadi_int el=colind[v]; el<colind[v+1]; ++el) {
+        casadi_int r = row[el];
+        if (lr[r]==lv[v] && has_next[r]) future[v] = true;
+        if (lr[r]==lv[v]-1) n_prev[v]++;
+      }
+    }
+
+    // State of the next stage defined by each gap-closing constraint, -1 for other constraints
+    std::vector<casadi_int> defines(na, -1), defined_by(n, -1);
+    for (casadi_int r=0; r<na; ++r) {
+      if (!has_next[r]) continue;
+      std::vector<casadi_int> cand, single;
+      for (casadi_int el=colind_t[r]; el<colind_t[r+1]; ++el) {
+        casadi_int u = row_t[el];
+        if (lv[u]!=lr[r]+1) continue;
+        if (future[u]) cand.push_back(u);
+        if (n_prev[u]==1) single.push_back(u);
+      }
+      if (cand.size()>1) return false;
+      if (cand.empty() && lr[r]+1==L && single.size()==1) cand = single;
+      if (cand.empty()) continue;
+      if (defined_by[cand[0]]>=0) return false;
+      defines[r] = cand[0];
+      defined_by[cand[0]] = r;
+    }
+
+    // States are the start and the defined variables, other variables are controls
+    std::vector<casadi_int> var_stage(n);
+    for (casadi_int v=0; v<n; ++v) {
+      var_stage[v] = v==s || defined_by[v]>=0 ? lv[v] : lv[v]-1;
+    }
+    casadi_int N = *std::max_element(var_stage.begin(), var_stage.end());
+    if (N<1) return false;
+
+    // Stage of each constraint
+    std::vector<casadi_int> con_stage(na, 0);
+    for (casadi_int r=0; r<na; ++r) {
+      if (defines[r]>=0) {
+        con_stage[r] = lr[r];
+      } else {
+        for (casadi_int el=colind_t[r]; el<colind_t[r+1]; ++el) {
+          con_stage[r] = std::max(con_stage[r], var_stage[row_t[el]]);
+        }
+      }
+    }
+
+    // Order the variables as x_0, u_0, x_1, u_1, ... with x_k+1 in the order of the
+    // gap-closing constraints, and the constraints as gap-closing, other, per stage
+    perm_x.clear();
+    perm_a.clear();
+    nx.assign(N+1, 0);
+    nu.assign(N+1, 0);
+    ng.assign(N+1, 0);
+    for (casadi_int k=0; k<=N; ++k) {
+      if (k==0) {
+        perm_x.push_back(s);
+        nx[0]++;
+      } else {
+        for (casadi_int r=0; r<na; ++r) {
+          if (defines[r]>=0 && con_stage[r]==k-1) {
+            perm_x.push_back(defines[r]);
+            nx[k]++;
+          }
+        }
+      }
+      for (casadi_int v=0; v<n; ++v) {
+        if (v!=s && defined_by[v]<0 && var_stage[v]==k) {
+          perm_x.push_back(v);
+          nu[k]++;
+        }
+      }
+      for (casadi_int r=0; r<na; ++r) {
+        if (defines[r]>=0 && con_stage[r]==k) perm_a.push_back(r);
+      }
+      for (casadi_int r=0; r<na; ++r) {
+        if (defines[r]<0 && con_stage[r]==k) {
+          perm_a.push_back(r);
+          ng[k]++;
+        }
+      }
+    }
+    std::vector<casadi_int> mapping;
+    return Conic::is_ocp_structure(H.sub(perm_x, perm_x, mapping),
+                                   A.sub(perm_a, perm_x, mapping), nx, nu, ng);
+  }
+
+  casadi_int Conic::detect_ocp_permutation(const Sparsity& H, const Sparsity& A,
+      std::vector<casadi_int>& perm_x, std::vector<casadi_int>& perm_a,
+      std::vector<int>& nx, std::vector<int>& nu, std::vector<int>& ng) {
+    // Natural ordering
+    casadi_int N = detect_ocp_structure(A, nx, nu, ng);
+    if (N>=1 && is_ocp_structure(H, A, nx, nu, ng)) {
+      perm_x = range(A.size2());
+      perm_a = range(A.size1());
+      return N;
+    }
+    perm_x.clear();
+    perm_a.clear();
+    nx.clear();
+    nu.clear();
+    ng.clear();
+    if (A.size1()==0 || A.size2()==0) return 0;
+
+    // Ends of a pseudo-diameter of the graph, from repeated searches
+    Sparsity AT = A.T();
+    const casadi_int* colind = A.colind();
+    std::vector<casadi_int> lv, lr, cand;
+    casadi_int s = 0, ecc = -1;
+    for (casadi_int iter=0; iter<8; ++iter) {
+      ocp_bfs(A, AT, s, lv, lr);
+      casadi_int L = *std::max_element(lv.begin(), lv.end());
+      if (L<=ecc) break;
+      ecc = L;
+      // Variables at the far end, with fewest constraints first
+      cand.clear();
+      for (casadi_int v=0; v<A.size2(); ++v) if (lv[v]==L) cand.push_back(v);
+      std::stable_sort(cand.begin(), cand.end(), [&](casadi_int a, casadi_int b) {
+        return colind[a+1]-colind[a] < colind[b+1]-colind[b];});
+      cand.insert(cand.begin(), s);
+      s = cand[1];
+    }
+
+    // Try to start from either end
+    std::vector<casadi_int> tried;
+    for (casadi_int c : cand) {
+      if (tried.size()>=16) break;
+      if (std::find(tried.begin(), tried.end(), c)!=tried.end()) continue;
+      tried.push_back(c);
+      if (ocp_stages(H, A, AT, c, perm_x, perm_a, nx, nu, ng)) return nx.size()-1;
+    }
+    perm_x.clear();
+    perm_a.clear();
+    nx.clear();
+    nu.clear();
+    ng.clear();
+    return 0;
+  }
+
+  void Conic::permute_problem(const std::vector<casadi_int>& perm_x,
+      const std::vector<casadi_int>& perm_a) {
+    casadi_assert(np_==0, "Permutation of psd constraints not supported");
+    casadi_assert_dev(perm_x.size()==nx_ && perm_a.size()==na_);
+    perm_x_ = perm_x;
+    perm_a_ = perm_a;
+    H_ = H_.sub(perm_x, perm_x, perm_h_nz_);
+    A_ = A_.sub(perm_a, perm_x, perm_a_nz_);
+    if (!discrete_.empty()) {
+      std::vector<bool> discrete = discrete_;
+      for (casadi_int i=0; i<nx_; ++i) discrete_[i] = discrete[perm_x[i]];
+    }
+    set_qp_prob();
+    // Permuted inputs and outputs
+    alloc_w(H_.nnz() + A_.nnz() + 8*nx_ + 4*na_, true);
+  }
+
   bool Conic::is_a(const std::string& type, bool recursive) const {
     return type=="Conic" || (recursive && FunctionInternal::is_a(type, recursive));
   }
@@ -716,7 +1103,7 @@ namespace casadi {
   void Conic::serialize_body(SerializingStream &s) const {
     FunctionInternal::serialize_body(s);
 
-    s.version("Conic", 2);
+    s.version("Conic", 3);
     s.pack("Conic::discrete", discrete_);
     s.pack("Conic::print_problem", print_problem_);
     s.pack("Conic::H", H_);
@@ -726,6 +1113,10 @@ namespace casadi {
     s.pack("Conic::nx", nx_);
     s.pack("Conic::na", na_);
     s.pack("Conic::np", np_);
+    s.pack("Conic::perm_x", perm_x_);
+    s.pack("Conic::perm_a", perm_a_);
+    s.pack("Conic::perm_h_nz", perm_h_nz_);
+    s.pack("Conic::perm_a_nz", perm_a_nz_);
   }
 
   void Conic::serialize_type(SerializingStream &s) const {
@@ -738,7 +1129,7 @@ namespace casadi {
   }
 
   Conic::Conic(DeserializingStream & s) : FunctionInternal(s) {
-    int version = s.version("Conic", 1, 2);
+    int version = s.version("Conic", 1, 3);
     s.unpack("Conic::discrete", discrete_);
     s.unpack("Conic::print_problem", print_problem_);
     if (version==1) {
@@ -752,6 +1143,12 @@ namespace casadi {
     s.unpack("Conic::nx", nx_);
     s.unpack("Conic::na", na_);
     s.unpack("Conic::np", np_);
+    if (version>=3) {
+      s.unpack("Conic::perm_x", perm_x_);
+      s.unpack("Conic::perm_a", perm_a_);
+      s.unpack("Conic::perm_h_nz", perm_h_nz_);
+      s.unpack("Conic::perm_a_nz", perm_a_nz_);
+    }
   }
 
   void Conic::set_qp_prob() {
@@ -761,6 +1158,8 @@ namespace casadi {
   }
 
   void Conic::qp_codegen_body(CodeGenerator& g) const {
+    casadi_assert(perm_x_.empty(),
+      "Code generation not supported for problems with permuted stage structure");
     g.add_auxiliary(CodeGenerator::AUX_QP);
     g.local("d_qp", "struct casadi_qp_data");
     g.local("p_qp", "struct casadi_qp_prob");
@@ -152,6 +152,41 @@ namespace casadi {
         \identifier{24y} */
     void qp_codegen_body(CodeGenerator& g) const;
 
+    /** \brief Detect the stage structure of an OCP from the constraint Jacobian
+
+        Looks for the diagonal of the x_{k+1} entries in the gap-closing
+        constraints. Returns the horizon N and the number of states (length N+1),
+        controls (length N+1, last entry zero) and other constraints (length N+1)
+        per stage. */
+    static casadi_int detect_ocp_structure(const Sparsity& A,
+      std::vector<int>& nx, std::vector<int>& nu, std::vector<int>& ng);
+
+    /** \brief Check if a QP has a given OCP stage structure
+
+        The Hessian must be block diagonal with the stages, the constraint
+        Jacobian must fit the blocks A B I / C D of each stage. */
+    static bool is_ocp_structure(const Sparsity& H, const Sparsity& A,
+      const std::vector<int>& nx, const std::vector<int>& nu, const std::vector<int>& ng);
+
+    /** \brief Detect the stage structure of an OCP with variables and constraints in any order
+
+        If the natural ordering has no OCP structure, stages are assigned by a
+        breadth-first search through the constraint Jacobian, starting from the
+        ends of a pseudo-diameter: states of stage k+1 are the variables reached
+        from stage k that also enter constraints of later stages. Returns N>0 and
+        permutations such that A(perm_a, perm_x) and H(perm_x, perm_x) have the
+        structure nx, nu, ng, or 0 if none was found. */
+    static casadi_int detect_ocp_permutation(const Sparsity& H, const Sparsity& A,
+      std::vector<casadi_int>& perm_x, std::vector<casadi_int>& perm_a,
+      std::vector<int>& nx, std::vector<int>& nu, std::vector<int>& ng);
+
+    /** \brief Let the solver see the problem with permuted variables and constraints
+
+        Replaces H and A by H(perm_x, perm_x) and A(perm_a, perm_x). Inputs and
+        outputs are permuted in eval, so the function keeps its interface. */
+    void permute_problem(const std::vector<casadi_int>& perm_x,
+      const std::vector<casadi_int>& perm_a);
+
   protected:
     /// Options
     std::vector<bool> discrete_;
@@ -169,6 +204,9 @@ namespace casadi {
     /// The shape of psd constraint matrix
     casadi_int np_;
 
+    /// Permutation of the variables, constraints and nonzeros seen by the solver, if any
+    std::vector<casadi_int> perm_x_, perm_a_, perm_h_nz_, perm_a_nz_;
+
     /// SDP to SOCP conversion memory
     struct SDPToSOCPMem {
       // Block partition vector for SOCP (block i runs from r[i] to r[i+1])
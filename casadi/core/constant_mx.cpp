@@ -255,18 +255,23 @@ namespace casadi {
 
   void ConstantDM::serialize_type(SerializingStream& s) const {
     MXNode::serialize_type(s);
-    s.pack("ConstantMX::type", 'a');
+    // 'a': plain nonzeros, 'b': interned nonzeros
+    s.pack("ConstantMX::type", 'b');
   }
 
   void ConstantDM::serialize_body(SerializingStream& s) const {
     MXNode::serialize_body(s);
     DM v = get_DM();
-    s.pack("ConstantMX::nonzeros", v.nonzeros());
+    s.pack_interned("ConstantMX::nonzeros", v.nonzeros());
   }
 
-  ConstantDM::ConstantDM(DeserializingStream& s) : ConstantMX(s) {
+  ConstantDM::ConstantDM(DeserializingStream& s, bool interned) : ConstantMX(s) {
     std::vector<double> v;
-    s.unpack("ConstantMX::nonzeros", v);
+    if (interned) {
+      s.unpack_interned("ConstantMX::nonzeros", v);
+    } else {
+      s.unpack("ConstantMX::nonzeros", v);
+    }
     x_ = DM(sparsity_, v);
   }
 
@@ -283,7 +288,8 @@ namespace casadi {
     char t;
     s.unpack("ConstantMX::type", t);
     switch (t) {
-      case 'a':    return new ConstantDM(s);
+      case 'a':    return new ConstantDM(s, false);
+      case 'b':    return new ConstantDM(s, true);
       case 'f':    return new ConstantFile(s);
       case 'z':    return ZeroByZero::getInstance();
       case 'D':
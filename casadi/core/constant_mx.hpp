@@ -247,7 +247,7 @@ namespace casadi {
     /** \brief Deserializing constructor
 
         \identifier{zk} */
-    explicit ConstantDM(DeserializingStream& s);
+    ConstantDM(DeserializingStream& s, bool interned);
   };
 
   /// A constant to be read from a file
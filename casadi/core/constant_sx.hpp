@@ -108,29 +108,36 @@ class RealtypeSX : public ConstantSX {
 
     /// Destructor
     ~RealtypeSX() override {
-      size_t num_erased = cached_constants_.erase(value);
-      assert(num_erased==1);
-      (void)num_erased;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+      // The entry may already refer to a replacement, see create
+      auto it = cached_constants_.find(value);
+      if (it!=cached_constants_.end() && it->second==this) cached_constants_.erase(it);
     }
 
-    /// Static creator function (use instead of constructor)
+    /// Static creator function (use instead of constructor), the caller owns one reference
     inline static RealtypeSX* create(double value) {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
       // Try to find the constant
       CACHING_MAP<double, RealtypeSX*>::iterator it = cached_constants_.find(value);
 
-      // If not found, add it,
-      if (it==cached_constants_.end()) {
-        // Allocate a new object
-        RealtypeSX* n = new RealtypeSX(value);
+      // Return it to caller, unless it is being deleted
+      if (it!=cached_constants_.end() && it->second->acquire()) return it->second;
 
-        // Add to hash_table
-        cached_constants_.insert(it, std::make_pair(value, n));
+      // Allocate a new object
+      RealtypeSX* n = new RealtypeSX(value);
+      n->count++;
 
-        // Return it to caller
-        return n;
-      } else { // Else, returned the object
-        return it->second;
+      // Add to hash_table
+      if (it==cached_constants_.end()) {
+        cached_constants_.insert(it, std::make_pair(value, n));
+      } else {
+        it->second = n;
       }
+      return n;
     }
 
     ///@{
@@ -181,29 +188,36 @@ class IntegerSX : public ConstantSX {
 
     /// Destructor
     ~IntegerSX() override {
-      size_t num_erased = cached_constants_.erase(value);
-      assert(num_erased==1);
-      (void)num_erased;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+      // The entry may already refer to a replacement, see create
+      auto it = cached_constants_.find(value);
+      if (it!=cached_constants_.end() && it->second==this) cached_constants_.erase(it);
     }
 
-    /// Static creator function (use instead of constructor)
+    /// Static creator function (use instead of constructor), the caller owns one reference
     inline static IntegerSX* create(casadi_int value) {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
       // Try to find the constant
       CACHING_MAP<casadi_int, IntegerSX*>::iterator it = cached_constants_.find(value);
 
-      // If not found, add it,
-      if (it==cached_constants_.end()) {
-        // Allocate a new object
-        IntegerSX* n = new IntegerSX(value);
+      // Return it to caller, unless it is being deleted
+      if (it!=cached_constants_.end() && it->second->acquire()) return it->second;
 
-        // Add to hash_table
-        cached_constants_.insert(it, std::make_pair(value, n));
+      // Allocate a new object
+      IntegerSX* n = new IntegerSX(value);
+      n->count++;
 
-        // Return it to caller
-        return n;
-      } else { // Else, returned the object
-        return it->second;
+      // Add to hash_table
+      if (it==cached_constants_.end()) {
+        cached_constants_.insert(it, std::make_pair(value, n));
+      } else {
+        it->second = n;
       }
+      return n;
     }
 
     ///@{
@@ -471,13 +485,18 @@ inline SXNode* ConstantSX_deserialize(DeserializingStream& s) {
     case 'r': {
       double value;
       s.unpack("ConstantSX::value", value);
-      return RealtypeSX::create(value);
+      // The reference is taken by the deserializer
+      SXNode* n = RealtypeSX::create(value);
+      n->count--;
+      return n;
     }
     case 'i': {
       int value;
       s.unpack("ConstantSX::value", value);
       if (value==2) return casadi_limits<SXElem>::two.get();
-      return IntegerSX::create(value);
+      SXNode* n = IntegerSX::create(value);
+      n->count--;
+      return n;
     }
     case 'n': return casadi_limits<SXElem>::nan.get();
     case 'f': return casadi_limits<SXElem>::minus_inf.get();
@@ -24,6 +24,9 @@
 
 
 #include "convexify.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
 
 namespace casadi {
 
@@ -32,6 +35,7 @@ namespace casadi {
       case CVX_REGULARIZE: return "regularize";
       case CVX_EIGEN_REFLECT: return "eigen-reflect";
       case CVX_EIGEN_CLIP: return "eigen-clip";
+      case CVX_INERTIA: return "inertia";
     }
     return "unknown";
   }
@@ -58,15 +62,67 @@ namespace casadi {
     options["strategy"] = strategy_to_string(convexify_data_.config.strategy);
     options["margin"] = convexify_data_.config.margin;
     options["max_iter_eig"] = convexify_data_.config.max_iter_eig;
+    options["parallel"] = convexify_data_.parallel;
     res[0] = convexify(arg[0], options);
   }
 
   int Convexify::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
-    int ret = convexify_eval(&convexify_data_.config, arg[0], res[0], iw, w);
+    int ret = eval_blocks(convexify_data_, arg[0], res[0], iw, w);
     casadi_assert(!ret, "Failure in convexification.");
     return 0;
   }
 
+  int Convexify::eval_blocks(const ConvexifyData& d, const double* Hin, double* Hout,
+      casadi_int* iw, double* w, casadi_int* pd) {
+    const casadi_convexify_config<double>* c = &d.config;
+    if ((c->strategy!=CVX_EIGEN_REFLECT && c->strategy!=CVX_EIGEN_CLIP)
+        || (d.n_slot==1 && !pd)) {
+      return convexify_eval(c, Hin, Hout, iw, w);
+    }
+    convexify_project(c, Hin, Hout, w);
+
+    // Blocks are independent: claim them one by one, each slot with its own work vectors
+    casadi_int n_block = d.block_nz.size()-1;
+    casadi_int n_chunk = std::min(d.n_slot, ThreadPool::instance().size());
+    if (n_chunk<=1) {
+      for (casadi_int k=0; k<n_block; ++k) {
+        if (convexify_block(c, k, d.block_nz[k], Hout, iw, w, pd)) return 1;
+      }
+      return 0;
+    }
+    std::atomic<casadi_int> next(0);
+    std::vector<int> ret_values(n_chunk, 0);
+    ThreadPool::instance().run(n_chunk, [&](casadi_int s) {
+      casadi_int* iw1 = iw + s*d.sz_iw_block;
+      double* w1 = w + s*d.sz_w_block;
+      for (casadi_int k=next++; k<n_block && !ret_values[s]; k=next++) {
+        ret_values[s] = convexify_block(c, k, d.block_nz[k], Hout, iw1, w1, pd);
+      }
+    });
+    for (int r : ret_values) {
+      if (r) return r;
+    }
+    return 0;
+  }
+
+  void Convexify::init_blocks(ConvexifyData& d) {
+    casadi_int block_size = 0;
+    casadi_int n_block = d.scc_offset.size()-1;
+    d.block_nz.resize(1);
+    d.block_nz[0] = 0;
+    for (casadi_int k=0; k<n_block; ++k) {
+      casadi_int block = d.scc_offset[k+1]-d.scc_offset[k];
+      block_size = std::max(block_size, block);
+      d.block_nz.push_back(d.block_nz.back() +
+        (d.config.type_in==CVX_SYMM ? block*block : block*(block+1)/2));
+    }
+    d.sz_iw_block = 1+3*d.config.max_iter_eig;
+    // Work vector of casadi_cvx or of the positive definiteness check, and a copy of the block
+    d.sz_w_block = std::max(block_size*block_size, 2*(block_size-1)*d.config.max_iter_eig)
+      + block_size*block_size;
+    if (d.config.scc_transform) d.sz_w_block += block_size*block_size;
+  }
+
   std::string Convexify::generate(CodeGenerator& g,
     const ConvexifyData &d,
     const std::string& Hin, const std::string& Hout,
@@ -78,6 +134,10 @@ namespace casadi {
       g << "cvx_config.strategy = CVX_EIGEN_CLIP;\n";
     } else if (d.config.strategy==CVX_EIGEN_REFLECT) {
       g << "cvx_config.strategy = CVX_EIGEN_REFLECT;\n";
+    } else if (d.config.strategy==CVX_INERTIA) {
+      g << "cvx_config.strategy = CVX_INERTIA;\n";
+      g << "cvx_config.Lsp = " << g.sparsity(d.Lsp) << ";\n";
+      g << "cvx_config.ldl_p = " << g.constant(d.ldl_p) << ";\n";
     }
     if (d.config.type_in==CVX_SYMM) {
       g << "cvx_config.type_in = CVX_SYMM;\n";
@@ -110,7 +170,7 @@ namespace casadi {
 
   void Convexify::serialize(SerializingStream& s, const std::string& prefix,
       const ConvexifyData& d) {
-    s.version(prefix + "Convexify", 1);
+    s.version(prefix + "Convexify", 3);
     s.pack(prefix + "Convexify::type_in", static_cast<int>(d.config.type_in));
     s.pack(prefix + "Convexify::strategy", static_cast<int>(d.config.strategy));
     s.pack(prefix + "Convexify::margin", d.config.margin);
@@ -122,11 +182,15 @@ namespace casadi {
     s.pack(prefix + "Convexify::verbose", d.config.verbose);
     s.pack(prefix + "Convexify::Hsp", d.Hsp);
     s.pack(prefix + "Convexify::Hrsp", d.Hrsp);
+    s.pack(prefix + "Convexify::Lsp", d.Lsp);
+    s.pack(prefix + "Convexify::ldl_p", d.ldl_p);
+    s.pack(prefix + "Convexify::parallel", d.parallel);
+    s.pack(prefix + "Convexify::n_slot", d.n_slot);
   }
 
   void Convexify::deserialize(DeserializingStream& s, const std::string& prefix,
       ConvexifyData& d) {
-    s.version(prefix + "Convexify", 1);
+    int version = s.version(prefix + "Convexify", 1, 3);
     int type_in;
     s.unpack(prefix + "Convexify::type_in", type_in);
     d.config.type_in = static_cast<casadi_convexify_type_in_t>(type_in);
@@ -142,7 +206,19 @@ namespace casadi {
     s.unpack(prefix + "Convexify::verbose", d.config.verbose);
     s.unpack(prefix + "Convexify::Hsp", d.Hsp);
     s.unpack(prefix + "Convexify::Hrsp", d.Hrsp);
-
+    if (version>=2) {
+      s.unpack(prefix + "Convexify::Lsp", d.Lsp);
+      s.unpack(prefix + "Convexify::ldl_p", d.ldl_p);
+    }
+    d.parallel = false;
+    d.n_slot = 1;
+    if (version>=3) {
+      s.unpack(prefix + "Convexify::parallel", d.parallel);
+      s.unpack(prefix + "Convexify::n_slot", d.n_slot);
+    }
+    if (d.config.strategy==CVX_EIGEN_REFLECT || d.config.strategy==CVX_EIGEN_CLIP) {
+      init_blocks(d);
+    }
 
     d.config.scc_offset_size = d.scc_offset.size();
 
@@ -151,6 +227,8 @@ namespace casadi {
     d.config.Hrsp = d.Hrsp;;
     d.config.scc_offset = get_ptr(d.scc_offset);
     d.config.scc_mapping = get_ptr(d.scc_mapping);
+    d.config.Lsp = d.Lsp.is_null() ? nullptr : static_cast<const casadi_int*>(d.Lsp);
+    d.config.ldl_p = get_ptr(d.ldl_p);
   }
 
   void Convexify::generate(CodeGenerator& g,
@@ -179,6 +257,8 @@ namespace casadi {
     d.config.max_iter_eig = 200;
     std::string strategy = "eigen-clip";
     d.config.verbose = false;
+    d.parallel = false;
+    d.n_slot = 1;
 
     for (auto&& op : opts) {
       if (op.first=="strategy") {
@@ -190,6 +270,8 @@ namespace casadi {
         d.config.max_iter_eig = op.second;
       } else if (op.first=="verbose") {
         d.config.verbose = op.second;
+      } else if (op.first=="parallel") {
+        d.parallel = op.second;
       } else {
         casadi_error("Unknown option '" + op.first + "'.");
       }
@@ -203,9 +285,12 @@ namespace casadi {
       d.config.strategy = CVX_EIGEN_REFLECT;
     } else if (strategy=="eigen-clip") {
       d.config.strategy = CVX_EIGEN_CLIP;
+    } else if (strategy=="inertia") {
+      d.config.strategy = CVX_INERTIA;
+      casadi_assert(d.config.type_in==CVX_SYMM, "Only truly symmetric matrices supported");
     } else {
       casadi_error("Invalid convexify strategy. "
-        "Choose from regularize|eigen-reflect|eigen-clip. Got '" + strategy + "'.");
+        "Choose from regularize|eigen-reflect|eigen-clip|inertia. Got '" + strategy + "'.");
     }
 
     d.Hrsp = H;
@@ -253,6 +338,10 @@ namespace casadi {
         "with maximum size " + str(block_size) + ".");
     } else if (d.config.strategy==CVX_REGULARIZE) {
       Hsp = Hrsp + Sparsity::diag(H.size1());
+    } else if (d.config.strategy==CVX_INERTIA) {
+      Hsp = Hrsp + Sparsity::diag(H.size1());
+      // Symbolic factorization, reused for every shift
+      d.Lsp = Hsp.ldl(d.ldl_p);
     } else {
       Hsp = Hrsp;
     }
@@ -265,16 +354,21 @@ namespace casadi {
     }
 
     d.sz_iw = 0;
-    if (d.config.strategy==CVX_EIGEN_REFLECT || d.config.strategy==CVX_EIGEN_CLIP) {
-       d.sz_iw = 1+3* d.config.max_iter_eig;
-    }
-
     d.sz_w = 0;
     if (d.config.strategy==CVX_EIGEN_REFLECT || d.config.strategy==CVX_EIGEN_CLIP) {
-      d.sz_w = std::max(block_size, 2*(block_size-1)*d.config.max_iter_eig);
+      // One set of block work vectors per concurrently convexified block
+      init_blocks(d);
+      casadi_int n_block = d.scc_offset.size()-1;
+      if (d.parallel) d.n_slot = std::max(casadi_int(1),
+        std::min(n_block, ThreadPool::requested_size()));
+      d.sz_iw = d.n_slot*d.sz_iw_block;
+      d.sz_w = d.n_slot*d.sz_w_block;
       if (d.config.Hsp_project) d.sz_w = std::max(d.sz_w, Hsp.size1());
-      if (d.config.scc_transform) d.sz_w += block_size*block_size;
       if (inplace) d.sz_w = std::max(d.sz_w, Hsp.size1()+d.Hrsp.nnz());
+    } else if (d.config.strategy==CVX_INERTIA) {
+      // Factors L^T and D, followed by the work vector of casadi_ldl
+      d.sz_w = d.Lsp.nnz()+Hsp.size1();
+      if (inplace) d.sz_w = std::max(d.sz_w, d.Hrsp.nnz());
     }
     d.sz_w = Hsp.size1()+d.sz_w;
 
@@ -285,6 +379,8 @@ namespace casadi {
     d.config.Hrsp = d.Hrsp;
     d.config.scc_offset = get_ptr(d.scc_offset);
     d.config.scc_mapping = get_ptr(d.scc_mapping);
+    d.config.Lsp = d.Lsp.is_null() ? nullptr : static_cast<const casadi_int*>(d.Lsp);
+    d.config.ldl_p = get_ptr(d.ldl_p);
 
     return Hsp;
   }
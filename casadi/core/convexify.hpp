@@ -106,6 +106,17 @@ namespace casadi {
     static Sparsity setup(ConvexifyData& d, const Sparsity& H,
                       const Dict& opts=Dict(), bool inplace=true);
 
+    /** \brief Evaluate numerically, distributing the blocks of eigen-* strategies
+        over the thread pool if the parallel option is set
+
+        pd: optional flags per block, persistent across calls, see convexify_block
+    */
+    static int eval_blocks(const ConvexifyData& d, const double* Hin, double* Hout,
+      casadi_int* iw, double* w, casadi_int* pd=nullptr);
+
+    /// Nonzero offsets and work vector sizes of the blocks
+    static void init_blocks(ConvexifyData& d);
+
     static std::string generate(CodeGenerator& g,
       const ConvexifyData &d,
       const std::string& Hin, const std::string& Hout,
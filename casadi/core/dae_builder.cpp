@@ -253,6 +253,14 @@ void DaeBuilder::eliminate_quad() {
   }
 }
 
+void DaeBuilder::eliminate_alg() {
+  try {
+    (*this)->eliminate_alg();
+  } catch (std::exception& e) {
+    THROW_ERROR("eliminate_alg", e.what());
+  }
+}
+
 void DaeBuilder::sort_d() {
   try {
     (*this)->sort_d();
@@ -380,6 +380,15 @@ class CASADI_EXPORT DaeBuilder
   /// Eliminate quadrature states and turn them into ODE states
   void eliminate_quad();
 
+  /** \brief Solve algebraic equations explicitly where possible
+
+      The incidence of the algebraic variables in the algebraic equations is
+      permuted to block triangular form. Scalar blocks whose equation is affine in
+      its variable are solved symbolically and the variable becomes a dependent
+      variable, shrinking the implicit system passed to the integrator.
+  */
+  void eliminate_alg();
+
   /// Sort dependent parameters
   void sort_d();
 
@@ -465,6 +474,9 @@ class CASADI_EXPORT DaeBuilder
 
   /** \brief  Load a function from an FMU DLL, standard IO conforming with simulator
 
+    The result can be passed directly to the integrator, which then evaluates the FMU and
+    its directional derivatives without going through an MX wrapper.
+
     \param name    Name assigned to the resulting function object
     \param opts    Optional settings
 
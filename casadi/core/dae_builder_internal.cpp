@@ -26,17 +26,24 @@
 
 #include <cctype>
 #include <ctime>
+#include <fstream>
 #include <map>
 #include <set>
 #include <sstream>
 #include <string>
 #include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#ifdef CASADI_WITH_THREAD
+#include <mutex>
+#endif // CASADI_WITH_THREAD
 
 #include "casadi_misc.hpp"
 #include "exception.hpp"
 #include "code_generator.hpp"
 #include "calculus.hpp"
 #include "xml_file.hpp"
+#include "xml_stream_reader.hpp"
 #include "external.hpp"
 #include "fmu_function.hpp"
 #include "integrator.hpp"
@@ -49,6 +56,17 @@ throw CasadiException("Error in DaeBuilderInternal::" FNAME " for '" + this->nam
 
 namespace casadi {
 
+// Model descriptions without symbolic equations parsed in this process, by the content
+// of modelDescription.xml. Never freed, as it may outlive other static objects
+static std::unordered_map<std::string, SharedObject>& fmi_descriptions() {
+  static auto* d = new std::unordered_map<std::string, SharedObject>();
+  return *d;
+}
+
+#ifdef CASADI_WITH_THREAD
+static std::mutex fmi_descriptions_mtx;
+#endif // CASADI_WITH_THREAD
+
 Type from_fmi2(TypeFmi2 v) {
   switch (v) {
   case TypeFmi2::REAL: return Type::FLOAT64;
@@ -377,6 +395,7 @@ DaeBuilderInternal::DaeBuilderInternal(const std::string& name, const std::strin
   clear_cache_ = false;
   number_of_event_indicators_ = 0;
   provides_directional_derivative_ = 0;
+  can_get_and_set_fmu_state_ = false;
   symbolic_ = true;
   // Default options
   debug_ = false;
@@ -397,9 +416,27 @@ void DaeBuilderInternal::load_fmi_description(const std::string& filename) {
   // Ensure no variables already
   casadi_assert(n_variables() == 0, "Instance already has variables");
 
-  // Parse XML file
-  XmlFile xml_file("tinyxml");
-  XmlNode fmi_desc = xml_file.parse(filename)[0];  // One child; fmiModelDescription
+  // Read the XML file, its content identifies descriptions parsed before
+  std::ifstream file(filename);
+  casadi_assert(file.good(), "Cannot load " + filename);
+  std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(fmi_descriptions_mtx);
+#endif // CASADI_WITH_THREAD
+    auto it = fmi_descriptions().find(content);
+    if (it != fmi_descriptions().end()) {
+      copy_description(*static_cast<const DaeBuilderInternal*>(it->second.get()));
+      return;
+    }
+  }
+
+  // Parse XML file as a stream, one variable at a time
+  std::istringstream stream(content);
+  XmlStreamReader xml(stream, filename);
+  casadi_assert(xml.next() && xml.is_start() && xml.node().name == "fmiModelDescription",
+    "Missing 'fmiModelDescription' in " + filename);
+  XmlNode fmi_desc = xml.node();  // Attributes only
 
   // Read attributes
   fmi_version_ = fmi_desc.attribute<std::string>("fmiVersion", "");
@@ -414,83 +451,141 @@ void DaeBuilderInternal::load_fmi_description(const std::string& filename) {
   variable_naming_convention_ = fmi_desc.attribute<std::string>("variableNamingConvention", "");
   number_of_event_indicators_ = fmi_desc.attribute<casadi_int>("numberOfEventIndicators", 0);
 
-  // Process ModelExchange
-  if (fmi_desc.has_child("ModelExchange"))
-    import_model_exchange(fmi_desc["ModelExchange"]);
-
-  // Process ModelVariables
-  casadi_assert(fmi_desc.has_child("ModelVariables"), "Missing 'ModelVariables'");
-  import_model_variables(fmi_desc["ModelVariables"]);
-
-  // Process model structure
-  if (fmi_desc.has_child("ModelStructure"))
-    import_model_structure(fmi_desc["ModelStructure"]);
-
-  // **** Add binding equations ****
-  if (fmi_desc.has_child("equ:BindingEquations")) {
-    // Get a reference to the BindingEquations node
-    const XmlNode& bindeqs = fmi_desc["equ:BindingEquations"];
-    // Loop over binding equations
-    for (casadi_int i = 0; i < bindeqs.size(); ++i) {
-      // Reference to the binding equation
-      const XmlNode& beq_node = bindeqs[i];
-      // Get the variable and binding expression
-      Variable& var = read_variable(beq_node[0]);
-      if (beq_node[1].size() == 1) {
-        // Regular expression
-        var.beq = read_expr(beq_node[1][0]);
-      } else {
-        // OpenModelica 1.17 occationally generates integer values without type specifier (bug?)
-        casadi_assert(beq_node[1].size() == 0, "Not implemented");
-        casadi_int val;
-        beq_node[1].get(&val);
-        casadi_warning(var.name + " has binding equation without type specifier: " + str(val));
-        var.beq = val;
+  // Symbolic equations, processed at the end
+  XmlNode bindeqs, initeqs, dyneqs;
+
+  // Process the children of fmiModelDescription
+  bool has_model_variables = false;
+  while (xml.next() && xml.is_start()) {
+    std::string name = xml.node().name;
+    if (name == "ModelVariables") {
+      // Process ModelVariables
+      has_model_variables = true;
+      while (xml.next() && xml.is_start()) import_model_variable(xml.read());
+      // Handle derivatives
+      for (size_t i = 0; i < n_variables(); ++i) {
+        if (variable(i).der_of >= 0) {
+          // Add variable offset, make index 1
+          variable(i).der_of -= 1;
+          // Set der
+          variable(variable(i).der_of).der = i;
+        }
+      }
+    } else if (name == "ModelStructure") {
+      // Process model structure
+      while (xml.next() && xml.is_start()) {
+        std::string section = xml.node().name;
+        while (xml.next() && xml.is_start()) import_model_unknown(section, xml.read());
       }
+    } else if (name == "ModelExchange") {
+      // Process ModelExchange
+      import_model_exchange(xml.read());
+    } else if (name == "equ:BindingEquations") {
+      bindeqs = xml.read();
+    } else if (name == "equ:InitialEquations") {
+      initeqs = xml.read();
+    } else if (name == "equ:DynamicEquations") {
+      dyneqs = xml.read();
+    } else {
+      xml.skip();
     }
   }
+  casadi_assert(has_model_variables, "Missing 'ModelVariables'");
+
+  // **** Add binding equations ****
+  if (!bindeqs.name.empty()) import_binding_equations(bindeqs);
 
   // **** Add dynamic equations, initial equations ****
   symbolic_ = false;  // use DLL by default
-  for (bool init_eq : {true, false}) {
-    const char* equ = init_eq ? "equ:InitialEquations" : "equ:DynamicEquations";
-    if (fmi_desc.has_child(equ)) {
-      // Symbolic model equations available
-      symbolic_ = true;
-      // Get a reference to the DynamicEquations node
-      const XmlNode& dyneqs = fmi_desc[equ];
-      // Add equations
-      for (casadi_int i = 0; i < dyneqs.size(); ++i) {
-        // Get a reference to the variable
-        const XmlNode& n = dyneqs[i];
-        try {
-          // Consistency checks
-          casadi_assert_dev(n.name == "equ:Equation");
-          casadi_assert_dev(n.size() == 1 && n[0].name == "exp:Sub");
-          // Ensure not empty
-          if (n[0].size() == 0) {
-            casadi_warning(str(equ) + "#" + str(i) + " is empty, ignored.");
-            continue;
-          }
-          // Get the left-hand-sides and right-hand-sides
-          const XmlNode& lhs = n[0][0];
-          const XmlNode& rhs = n[0][1];
-          // Left-hand-side needs to be a variable
-          Variable& v = read_variable(lhs);
-          // Right-hand-side is the binding equation
-          MX beq = read_expr(rhs);
-          // Set the equation
-          w_.push_back(find(v.name));
-          v.beq = beq;
-          // Also add to list of initial equations
-          if (init_eq) {
-            init_lhs_.push_back(v.v);
-            init_rhs_.push_back(beq);
-          }
-        } catch (std::exception& e) {
-          uerr() << "Failed to read " << equ << "#" << i << ": " << e.what() << std::endl;
-        }
+  if (!initeqs.name.empty()) import_equations(initeqs, true);
+  if (!dyneqs.name.empty()) import_equations(dyneqs, false);
+
+  // Share descriptions without expressions in the variables with later instances
+  if (!symbolic_ && bindeqs.name.empty()) {
+    SharedObject d;
+    d.own(new DaeBuilderInternal(name_, path_, Dict()));
+    static_cast<DaeBuilderInternal*>(d.get())->copy_description(*this);
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(fmi_descriptions_mtx);
+#endif // CASADI_WITH_THREAD
+    fmi_descriptions().insert(std::make_pair(content, d));
+  }
+}
+
+void DaeBuilderInternal::copy_description(const DaeBuilderInternal& d) {
+  casadi_assert(n_variables() == 0, "Instance already has variables");
+  // Keep name, location and options of this instance
+  std::string name = name_, path = path_;
+  bool debug = debug_;
+  double fmutol = fmutol_;
+  *this = d;
+  name_ = name;
+  path_ = path;
+  debug_ = debug;
+  fmutol_ = fmutol;
+  // Own copies of the variables, with new symbols
+  for (Variable*& v : variables_) {
+    v = new Variable(*v);
+    v->v = MX::sym(v->name, v->v.sparsity());
+  }
+  clear_cache();
+}
+
+void DaeBuilderInternal::import_binding_equations(const XmlNode& bindeqs) {
+  // Loop over binding equations
+  for (casadi_int i = 0; i < bindeqs.size(); ++i) {
+    // Reference to the binding equation
+    const XmlNode& beq_node = bindeqs[i];
+    // Get the variable and binding expression
+    Variable& var = read_variable(beq_node[0]);
+    if (beq_node[1].size() == 1) {
+      // Regular expression
+      var.beq = read_expr(beq_node[1][0]);
+    } else {
+      // OpenModelica 1.17 occationally generates integer values without type specifier (bug?)
+      casadi_assert(beq_node[1].size() == 0, "Not implemented");
+      casadi_int val;
+      beq_node[1].get(&val);
+      casadi_warning(var.name + " has binding equation without type specifier: " + str(val));
+      var.beq = val;
+    }
+  }
+}
+
+void DaeBuilderInternal::import_equations(const XmlNode& dyneqs, bool init_eq) {
+  const char* equ = init_eq ? "equ:InitialEquations" : "equ:DynamicEquations";
+  // Symbolic model equations available
+  symbolic_ = true;
+  // Add equations
+  for (casadi_int i = 0; i < dyneqs.size(); ++i) {
+    // Get a reference to the variable
+    const XmlNode& n = dyneqs[i];
+    try {
+      // Consistency checks
+      casadi_assert_dev(n.name == "equ:Equation");
+      casadi_assert_dev(n.size() == 1 && n[0].name == "exp:Sub");
+      // Ensure not empty
+      if (n[0].size() == 0) {
+        casadi_warning(str(equ) + "#" + str(i) + " is empty, ignored.");
+        continue;
+      }
+      // Get the left-hand-sides and right-hand-sides
+      const XmlNode& lhs = n[0][0];
+      const XmlNode& rhs = n[0][1];
+      // Left-hand-side needs to be a variable
+      Variable& v = read_variable(lhs);
+      // Right-hand-side is the binding equation
+      MX beq = read_expr(rhs);
+      // Set the equation
+      w_.push_back(find(v.name));
+      v.beq = beq;
+      // Also add to list of initial equations
+      if (init_eq) {
+        init_lhs_.push_back(v.v);
+        init_rhs_.push_back(beq);
       }
+    } catch (std::exception& e) {
+      uerr() << "Failed to read " << equ << "#" << i << ": " << e.what() << std::endl;
     }
   }
 }
@@ -1095,6 +1190,52 @@ void DaeBuilderInternal::eliminate_quad() {
   q_.clear();
 }
 
+void DaeBuilderInternal::eliminate_alg() {
+  // Quick return if no algebraic variables
+  if (z_.empty()) return;
+  // Clear cache after this
+  clear_cache_ = true;
+  // Algebraic variables and the corresponding residuals
+  std::vector<MX> z = var(z_), alg = this->alg();
+  // Incidence of the scalar algebraic variables in the scalar residuals
+  std::vector<casadi_int> scalar;
+  for (casadi_int k = 0; k < z.size(); ++k) {
+    if (z[k].is_scalar() && alg[k].is_scalar()) scalar.push_back(k);
+  }
+  if (scalar.empty()) return;
+  std::vector<MX> zs = vector_slice(z, scalar), algs = vector_slice(alg, scalar);
+  Sparsity sp = MX::jacobian_sparsity(vertcat(algs), vertcat(zs));
+  // Block triangular form: equations in one block only depend on variables in
+  // the same block and blocks that do not depend on it
+  std::vector<casadi_int> rowperm, colperm, rowblock, colblock, crb, ccb;
+  casadi_int nb = sp.btf(rowperm, colperm, rowblock, colblock, crb, ccb);
+  // Solve scalar blocks
+  std::vector<bool> eliminated(z.size(), false);
+  for (casadi_int b = 0; b < nb; ++b) {
+    if (rowblock[b + 1] - rowblock[b] != 1 || colblock[b + 1] - colblock[b] != 1) continue;
+    casadi_int i = rowperm[rowblock[b]], j = colperm[colblock[b]];
+    // Structurally singular
+    if (!sp.has_nz(i, j)) continue;
+    // Residual must be affine in the variable: a*z + r
+    MX a = jacobian(algs[i], zs[j]);
+    if (a.is_zero() || depends_on(a, zs[j])) continue;
+    MX r = substitute(algs[i], zs[j], MX(0));
+    // The variable becomes a dependent variable
+    Variable& v = variable(z_[scalar[j]]);
+    v.beq = -r / a;
+    w_.push_back(v.index);
+    eliminated[scalar[j]] = true;
+  }
+  // Remove eliminated variables from z
+  size_t sz = 0;
+  for (size_t k = 0; k < z_.size(); ++k) {
+    if (!eliminated[k]) z_.at(sz++) = z_.at(k);
+  }
+  z_.resize(sz);
+  // Dependent variables may depend on each other
+  sort_w();
+}
+
 void DaeBuilderInternal::sort_d() {
   std::vector<MX> d = var(d_), ddef = this->ddef();
   sort_dependent(d, ddef);
@@ -1670,7 +1811,17 @@ Function DaeBuilderInternal::create(const std::string& fname,
   }
   // Call factory without lifted calls
   std::string fname_nocalls = lifted_calls ? fname + "_nocalls" : fname;
-  Function ret = oracle(sx, elim_w, lifted_calls).factory(fname_nocalls, s_in, s_out, lc_);
+  std::vector<bool> out_used = used_outputs(s_in, s_out);
+  Function ret;
+  if (std::all_of(out_used.begin(), out_used.end(), [](bool u) { return u;})) {
+    // All outputs needed, use the cached oracle
+    ret = oracle(sx, elim_w, lifted_calls).factory(fname_nocalls, s_in, s_out, lc_);
+  } else {
+    // Oracle pruned to the requested outputs
+    Function f = mx_oracle(elim_w, lifted_calls, out_used);
+    if (sx) f = f.expand("sx_oracle");
+    ret = f.factory(fname_nocalls, s_in, s_out, lc_);
+  }
   // If no lifted calls, done
   if (!lifted_calls) return ret;
   // MX expressions for ret without lifted calls
@@ -1940,68 +2091,111 @@ const Function& DaeBuilderInternal::oracle(bool sx, bool elim_w, bool lifted_cal
   if (clear_cache_) clear_cache();
   // Create an MX oracle, if needed
   if (oracle_[false][elim_w][lifted_calls].is_null()) {
-    // Oracle function inputs and outputs
-    std::vector<MX> f_in, f_out, v;
-    std::vector<std::string> f_in_name, f_out_name;
-    // Index for wdef
-    casadi_int wdef_ind = -1;
-    // Options consistency check
-    casadi_assert(!(elim_w && lifted_calls), "Incompatible options");
-    // Do we need to substitute out v
-    bool subst_v = false;
-    // Collect all DAE input variables
-    for (size_t i = 0; i != DAE_BUILDER_NUM_IN; ++i) {
-      if (i == DAE_BUILDER_Y) continue;  // fixme2
-      f_in_name.push_back(to_string(static_cast<DaeBuilderInternalIn>(i)));
-      v = input(static_cast<DaeBuilderInternalIn>(i));
-      if (v.empty()) {
+    oracle_[false][elim_w][lifted_calls]
+      = mx_oracle(elim_w, lifted_calls, std::vector<bool>(DAE_BUILDER_NUM_OUT, true));
+  }
+  // Return MX oracle, if requested
+  if (!sx) return oracle_[false][elim_w][lifted_calls];
+  // Create SX oracle, if needed
+  Function& sx_oracle = oracle_[true][elim_w][lifted_calls];
+  if (sx_oracle.is_null()) sx_oracle = oracle_[false][elim_w][lifted_calls].expand("sx_oracle");
+  // Return SX oracle reference
+  return sx_oracle;
+}
+
+Function DaeBuilderInternal::mx_oracle(bool elim_w, bool lifted_calls,
+    const std::vector<bool>& out_used) const {
+  // Oracle function inputs and outputs
+  std::vector<MX> f_in, f_out, v;
+  std::vector<std::string> f_in_name, f_out_name;
+  // Index for wdef
+  casadi_int wdef_ind = -1;
+  // Options consistency check
+  casadi_assert(!(elim_w && lifted_calls), "Incompatible options");
+  // Do we need to substitute out v
+  bool subst_v = false;
+  // Collect all DAE input variables
+  for (size_t i = 0; i != DAE_BUILDER_NUM_IN; ++i) {
+    if (i == DAE_BUILDER_Y) continue;  // fixme2
+    f_in_name.push_back(to_string(static_cast<DaeBuilderInternalIn>(i)));
+    v = input(static_cast<DaeBuilderInternalIn>(i));
+    if (v.empty()) {
+      f_in.push_back(MX(0, 1));
+    } else {
+      if (elim_w && i == DAE_BUILDER_W) {
+        // Keep an empty placeholder so that the input names still match
         f_in.push_back(MX(0, 1));
+        subst_v = true;
       } else {
-        if (elim_w && i == DAE_BUILDER_W) {
-          subst_v = true;
-        } else {
-          f_in.push_back(vertcat(v));
-        }
+        f_in.push_back(vertcat(v));
       }
     }
-    // Collect all DAE output variables
+  }
+  // Collect the requested DAE output variables, the others are left empty
+  for (size_t i = 0; i != DAE_BUILDER_NUM_OUT; ++i) {
+    f_out_name.push_back(to_string(static_cast<DaeBuilderInternalOut>(i)));
+    if (!out_used.at(i)) {
+      f_out.push_back(MX(0, 1));
+      continue;
+    }
+    v = output(static_cast<DaeBuilderInternalOut>(i));
+    if (v.empty()) {
+      f_out.push_back(MX(0, 1));
+    } else {
+      if (i == DAE_BUILDER_WDEF) wdef_ind = f_out.size();
+      f_out.push_back(vertcat(v));
+    }
+  }
+  // Eliminate v from inputs
+  if (subst_v) {
+    // Dependent variable definitions
+    std::vector<MX> wdef = this->wdef();
+    // Perform in-place substitution
+    substitute_inplace(var(w_), wdef, f_out, false);
+  } else if (lifted_calls && wdef_ind >= 0) {
+    // Dependent variable definitions
+    std::vector<MX> wdef = this->wdef();
+    // Remove references to call nodes
+    for (MX& wdefref : wdef) {
+      if (wdefref.is_output()) wdefref = MX::zeros(wdefref.sparsity());
+    }
+    // Save to oracle outputs
+    f_out.at(wdef_ind) = vertcat(wdef);
+  }
+  // Create oracle
+  return Function("mx_oracle", f_in, f_out, f_in_name, f_out_name);
+}
+
+std::vector<bool> DaeBuilderInternal::used_outputs(const std::vector<std::string>& s_in,
+    const std::vector<std::string>& s_out) const {
+  std::vector<bool> ret(DAE_BUILDER_NUM_OUT, false);
+  // Flag an output or the components of a linear combination
+  auto flag = [&](const std::string& n) {
     for (size_t i = 0; i != DAE_BUILDER_NUM_OUT; ++i) {
-      f_out_name.push_back(to_string(static_cast<DaeBuilderInternalOut>(i)));
-      v = output(static_cast<DaeBuilderInternalOut>(i));
-      if (v.empty()) {
-        f_out.push_back(MX(0, 1));
-      } else {
-        if (i == DAE_BUILDER_WDEF) wdef_ind = f_out.size();
-        f_out.push_back(vertcat(v));
+      if (n == to_string(static_cast<DaeBuilderInternalOut>(i))) ret[i] = true;
+    }
+    auto it = lc_.find(n);
+    if (it != lc_.end()) {
+      for (const std::string& c : it->second) {
+        for (size_t i = 0; i != DAE_BUILDER_NUM_OUT; ++i) {
+          if (c == to_string(static_cast<DaeBuilderInternalOut>(i))) ret[i] = true;
+        }
       }
     }
-    // Eliminate v from inputs
-    if (subst_v) {
-      // Dependent variable definitions
-      std::vector<MX> wdef = this->wdef();
-      // Perform in-place substitution
-      substitute_inplace(var(w_), wdef, f_out, false);
-    } else if (lifted_calls && wdef_ind >= 0) {
-      // Dependent variable definitions
-      std::vector<MX> wdef = this->wdef();
-      // Remove references to call nodes
-      for (MX& wdefref : wdef) {
-        if (wdefref.is_output()) wdefref = MX::zeros(wdefref.sparsity());
+  };
+  // Any ':'-separated token may refer to an output, e.g. "jac:ode:x" or "lam:alg"
+  for (auto s_io : {&s_in, &s_out}) {
+    for (const std::string& s : *s_io) {
+      size_t pos = 0;
+      while (true) {
+        size_t end = s.find(':', pos);
+        flag(s.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+        if (end == std::string::npos) break;
+        pos = end + 1;
       }
-      // Save to oracle outputs
-      f_out.at(wdef_ind) = vertcat(wdef);
     }
-    // Create oracle
-    oracle_[false][elim_w][lifted_calls]
-      = Function("mx_oracle", f_in, f_out, f_in_name, f_out_name);
   }
-  // Return MX oracle, if requested
-  if (!sx) return oracle_[false][elim_w][lifted_calls];
-  // Create SX oracle, if needed
-  Function& sx_oracle = oracle_[true][elim_w][lifted_calls];
-  if (sx_oracle.is_null()) sx_oracle = oracle_[false][elim_w][lifted_calls].expand("sx_oracle");
-  // Return SX oracle reference
-  return sx_oracle;
+  return ret;
 }
 
 void DaeBuilderInternal::CallIO::calc_jac() {
@@ -2492,6 +2686,7 @@ void DaeBuilderInternal::import_model_exchange(const XmlNode& n) {
   // Read attributes
   provides_directional_derivative_
     = n.attribute<bool>("providesDirectionalDerivative", false);
+  can_get_and_set_fmu_state_ = n.attribute<bool>("canGetAndSetFMUstate", false);
   model_identifier_ = n.attribute<std::string>("modelIdentifier");
   // Get list of source files
   if (n.has_child("SourceFiles")) {
@@ -2501,160 +2696,120 @@ void DaeBuilderInternal::import_model_exchange(const XmlNode& n) {
   }
 }
 
-void DaeBuilderInternal::import_model_variables(const XmlNode& modvars) {
-  // Add variables
-  for (casadi_int i = 0; i < modvars.size(); ++i) {
-    // Get a reference to the variable
-    const XmlNode& vnode = modvars[i];
-
-    // Name of variable
-    std::string name = vnode.attribute<std::string>("name");
-
-    // Ignore duplicate variables
-    if (varind_.find(name) != varind_.end()) {
-      casadi_warning("Duplicate variable '" + name + "' ignored");
-      continue;
-    }
-
-    // Create new variable
-    Variable& var = new_variable(name);
-    var.v = MX::sym(name);
-
-    // Read common attributes, cf. FMI 2.0.2 specification, 2.2.7
-    var.value_reference = static_cast<unsigned int>(vnode.attribute<casadi_int>("valueReference"));
-    var.description = vnode.attribute<std::string>("description", "");
-    std::string causality_str = vnode.attribute<std::string>("causality", "local");
-    if (causality_str == "internal") causality_str = "local";  // FMI 1.0 -> FMI 2.0
-    var.causality = to_enum<Causality>(causality_str);
-    std::string variability_str = vnode.attribute<std::string>("variability", "continuous");
-    if (variability_str == "parameter") variability_str = "fixed";  // FMI 1.0 -> FMI 2.0
-    var.variability = to_enum<Variability>(variability_str);
-    std::string initial_str = vnode.attribute<std::string>("initial", "");
-    if (initial_str.empty()) {
-      // Default value
-      var.initial = Variable::default_initial(var.causality, var.variability);
-    } else {
-      // Consistency check
-      casadi_assert(var.causality != Causality::INPUT && var.causality != Causality::INDEPENDENT,
-        "The combination causality = '" + to_string(var.causality) + "', "
-        "initial = '" + initial_str + "' is not allowed per FMI 2.0 specification.");
-      // Value specified
-      var.initial = to_enum<Initial>(initial_str);
-    }
-    // Other properties
-    if (vnode.has_child("Real")) {
-      const XmlNode& props = vnode["Real"];
-      var.unit = props.attribute<std::string>("unit", var.unit);
-      var.display_unit = props.attribute<std::string>("displayUnit", var.display_unit);
-      var.min = props.attribute<double>("min", -inf);
-      var.max = props.attribute<double>("max", inf);
-      var.nominal = props.attribute<double>("nominal", 1.);
-      var.set_attribute(Attribute::START, props.attribute<double>("start", 0.));
-      var.der_of = props.attribute<casadi_int>("derivative", var.der_of);
-    } else if (vnode.has_child("Integer")) {
-      const XmlNode& props = vnode["Integer"];
-      var.type = Type::INT32;
-      var.min = props.attribute<double>("min", -inf);
-      var.max = props.attribute<double>("max", inf);
-    } else if (vnode.has_child("Boolean")) {
-      var.type = Type::BOOLEAN;
-    } else if (vnode.has_child("String")) {
-      var.type = Type::STRING;
-    } else if (vnode.has_child("Enumeration")) {
-      var.type = Type::ENUMERATION;
-    } else {
-      casadi_warning("Unknown type for " + name);
-    }
-    // Initial classification of variables (states/outputs to be added later)
-    if (var.causality == Causality::INDEPENDENT) {
-      // Independent (time) variable
-      t_.push_back(var.index);
-    } else if (var.causality == Causality::INPUT) {
-      u_.push_back(var.index);
-    } else if (var.variability == Variability::TUNABLE) {
-      p_.push_back(var.index);
-    }
-  }
-  // Handle derivatives
-  for (size_t i = 0; i < n_variables(); ++i) {
-    if (variable(i).der_of >= 0) {
-      // Add variable offset, make index 1
-      variable(i).der_of -= 1;
-      // Set der
-      variable(variable(i).der_of).der = i;
-    }
-  }
-}
-
-void DaeBuilderInternal::import_model_structure(const XmlNode& n) {
-  // Outputs
-  if (n.has_child("Outputs")) {
-    for (auto& e : n["Outputs"].children) {
-      // Get index
-      outputs_.push_back(e.attribute<casadi_int>("index", 0) - 1);
-      // Corresponding variable
-      Variable& v = variable(outputs_.back());
-      // Add to y, unless state
-      if (v.der < 0) {
-        y_.push_back(v.index);
-        v.beq = v.v;
-      }
-      // Get dependencies
-      v.dependencies = e.attribute<std::vector<casadi_int>>("dependencies", {});
-      // dependenciesKind attribute, if present
-      if (e.has_attribute("dependenciesKind")) {
-        // Load list of strings
-        auto dK = e.attribute<std::vector<std::string>>("dependenciesKind", {});
-        // Convert to enum, add to list
-        v.dependenciesKind.reserve(v.dependencies.size());
-        for (auto&& s : dK) {
-          v.dependenciesKind.push_back(to_enum<DependenciesKind>(s));
-        }
-      }
-      // Mark interdependencies, change to index-0
-      for (casadi_int& d : v.dependencies) {
-        variable(--d).dependency = true;
-      }
-    }
-  }
-  // Derivatives
-  if (n.has_child("Derivatives")) {
-    for (auto& e : n["Derivatives"].children) {
-      // Get index
-      derivatives_.push_back(e.attribute<casadi_int>("index", 0) - 1);
-      // Corresponding variable
-      Variable& v = variable(derivatives_.back());
-      // Add to list of states
-      casadi_assert(v.der_of >= 0, "Error processing derivative info for " + v.name);
-      x_.push_back(v.der_of);
-      // Get dependencies
-      v.dependencies = e.attribute<std::vector<casadi_int>>("dependencies", {});
-      // dependenciesKind attribute, if present
-      if (e.has_attribute("dependenciesKind")) {
-        // Load list of strings
-        auto dK = e.attribute<std::vector<std::string>>("dependenciesKind", {});
-        // Convert to enum, add to list
-        v.dependenciesKind.reserve(v.dependencies.size());
-        for (auto&& s : dK) {
-          v.dependenciesKind.push_back(to_enum<DependenciesKind>(s));
-        }
-      }
-      // Mark interdependencies, change to index-0
-      for (casadi_int& d : v.dependencies) {
-        variable(--d).dependency = true;
-      }
-    }
-  }
-  // Initial unknowns
-  if (n.has_child("InitialUnknowns")) {
-    for (auto& e : n["InitialUnknowns"].children) {
-      // Get index
-      initial_unknowns_.push_back(e.attribute<casadi_int>("index", 0) - 1);
-      // Get dependencies
-      for (casadi_int d : e.attribute<std::vector<casadi_int>>("dependencies", {})) {
-        variable(d - 1).dependency = true;
-      }
-    }
+void DaeBuilderInternal::import_model_variable(const XmlNode& vnode) {
+  // Name of variable
+  std::string name = vnode.attribute<std::string>("name");
+
+  // Ignore duplicate variables
+  if (varind_.find(name) != varind_.end()) {
+    casadi_warning("Duplicate variable '" + name + "' ignored");
+    return;
+  }
+
+  // Create new variable
+  Variable& var = new_variable(name);
+  var.v = MX::sym(name);
+
+  // Read common attributes, cf. FMI 2.0.2 specification, 2.2.7
+  var.value_reference = static_cast<unsigned int>(vnode.attribute<casadi_int>("valueReference"));
+  var.description = vnode.attribute<std::string>("description", "");
+  std::string causality_str = vnode.attribute<std::string>("causality", "local");
+  if (causality_str == "internal") causality_str = "local";  // FMI 1.0 -> FMI 2.0
+  var.causality = to_enum<Causality>(causality_str);
+  std::string variability_str = vnode.attribute<std::string>("variability", "continuous");
+  if (variability_str == "parameter") variability_str = "fixed";  // FMI 1.0 -> FMI 2.0
+  var.variability = to_enum<Variability>(variability_str);
+  std::string initial_str = vnode.attribute<std::string>("initial", "");
+  if (initial_str.empty()) {
+    // Default value
+    var.initial = Variable::default_initial(var.causality, var.variability);
+  } else {
+    // Consistency check
+    casadi_assert(var.causality != Causality::INPUT && var.causality != Causality::INDEPENDENT,
+      "The combination causality = '" + to_string(var.causality) + "', "
+      "initial = '" + initial_str + "' is not allowed per FMI 2.0 specification.");
+    // Value specified
+    var.initial = to_enum<Initial>(initial_str);
+  }
+  // Other properties
+  if (vnode.has_child("Real")) {
+    const XmlNode& props = vnode["Real"];
+    var.unit = props.attribute<std::string>("unit", var.unit);
+    var.display_unit = props.attribute<std::string>("displayUnit", var.display_unit);
+    var.min = props.attribute<double>("min", -inf);
+    var.max = props.attribute<double>("max", inf);
+    var.nominal = props.attribute<double>("nominal", 1.);
+    var.set_attribute(Attribute::START, props.attribute<double>("start", 0.));
+    var.der_of = props.attribute<casadi_int>("derivative", var.der_of);
+  } else if (vnode.has_child("Integer")) {
+    const XmlNode& props = vnode["Integer"];
+    var.type = Type::INT32;
+    var.min = props.attribute<double>("min", -inf);
+    var.max = props.attribute<double>("max", inf);
+  } else if (vnode.has_child("Boolean")) {
+    var.type = Type::BOOLEAN;
+  } else if (vnode.has_child("String")) {
+    var.type = Type::STRING;
+  } else if (vnode.has_child("Enumeration")) {
+    var.type = Type::ENUMERATION;
+  } else {
+    casadi_warning("Unknown type for " + name);
+  }
+  // Initial classification of variables (states/outputs to be added later)
+  if (var.causality == Causality::INDEPENDENT) {
+    // Independent (time) variable
+    t_.push_back(var.index);
+  } else if (var.causality == Causality::INPUT) {
+    u_.push_back(var.index);
+  } else if (var.variability == Variability::TUNABLE) {
+    p_.push_back(var.index);
+  }
+}
+
+void DaeBuilderInternal::import_model_unknown(const std::string& section, const XmlNode& e) {
+  // Get index
+  casadi_int ind = e.attribute<casadi_int>("index", 0) - 1;
+  if (section == "InitialUnknowns") {
+    initial_unknowns_.push_back(ind);
+    // Get dependencies
+    for (casadi_int d : e.attribute<std::vector<casadi_int>>("dependencies", {})) {
+      variable(d - 1).dependency = true;
+    }
+    return;
+  }
+  // Corresponding variable
+  Variable& v = variable(ind);
+  if (section == "Outputs") {
+    outputs_.push_back(ind);
+    // Add to y, unless state
+    if (v.der < 0) {
+      y_.push_back(v.index);
+      v.beq = v.v;
+    }
+  } else if (section == "Derivatives") {
+    derivatives_.push_back(ind);
+    // Add to list of states
+    casadi_assert(v.der_of >= 0, "Error processing derivative info for " + v.name);
+    x_.push_back(v.der_of);
+  } else {
+    // Other sections are not used
+    return;
+  }
+  // Get dependencies
+  v.dependencies = e.attribute<std::vector<casadi_int>>("dependencies", {});
+  // dependenciesKind attribute, if present
+  if (e.has_attribute("dependenciesKind")) {
+    // Load list of strings
+    auto dK = e.attribute<std::vector<std::string>>("dependenciesKind", {});
+    // Convert to enum, add to list
+    v.dependenciesKind.reserve(v.dependencies.size());
+    for (auto&& s : dK) {
+      v.dependenciesKind.push_back(to_enum<DependenciesKind>(s));
+    }
+  }
+  // Mark interdependencies, change to index-0
+  for (casadi_int& d : v.dependencies) {
+    variable(--d).dependency = true;
   }
 }
 
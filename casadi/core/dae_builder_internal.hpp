@@ -196,6 +196,9 @@ class CASADI_EXPORT DaeBuilderInternal : public SharedObjectInternal {
   /// Eliminate quadrature states and turn them into ODE states
   void eliminate_quad();
 
+  /// Solve algebraic equations explicitly where possible
+  void eliminate_alg();
+
   /// Sort dependent parameters
   void sort_d();
 
@@ -395,6 +398,13 @@ class CASADI_EXPORT DaeBuilderInternal : public SharedObjectInternal {
   /// Get the (cached) oracle, SX or MX
   const Function& oracle(bool sx = false, bool elim_w = false, bool lifted_calls = false) const;
 
+  /// Create an MX oracle, with outputs not flagged in out_used left empty
+  Function mx_oracle(bool elim_w, bool lifted_calls, const std::vector<bool>& out_used) const;
+
+  /// Flag the oracle outputs needed for a factory call
+  std::vector<bool> used_outputs(const std::vector<std::string>& s_in,
+    const std::vector<std::string>& s_out) const;
+
   /// Get Jacobian sparsity
   Sparsity jac_sparsity(const std::vector<size_t>& oind, const std::vector<size_t>& iind) const;
 
@@ -427,6 +437,7 @@ protected:
   // Model Exchange
   std::string model_identifier_;
   bool provides_directional_derivative_;
+  bool can_get_and_set_fmu_state_;
   std::vector<std::string> source_files_;
 
   /// Name of instance
@@ -533,11 +544,20 @@ protected:
   // Read ModelExchange
   void import_model_exchange(const XmlNode& n);
 
-  // Read ModelVariables
-  void import_model_variables(const XmlNode& modvars);
+  // Read a variable in ModelVariables
+  void import_model_variable(const XmlNode& vnode);
+
+  // Read an entry of a section (Outputs, Derivatives, ..) of ModelStructure
+  void import_model_unknown(const std::string& section, const XmlNode& e);
+
+  // Read BindingEquations
+  void import_binding_equations(const XmlNode& bindeqs);
+
+  // Read InitialEquations or DynamicEquations
+  void import_equations(const XmlNode& eqs, bool init_eq);
 
-  // Read ModelStructure
-  void import_model_structure(const XmlNode& n);
+  // Copy a model description parsed before, with new symbols for the variables
+  void copy_description(const DaeBuilderInternal& d);
 
   /// Problem structure has changed: Clear cache
   void clear_cache() const;
@@ -69,7 +69,7 @@ namespace casadi {
   template<>
   DM CASADI_EXPORT DM::
   expm(const DM& A) {
-    Function ret = expmsol("mysolver", "slicot", A.sparsity());
+    Function ret = expmsol("mysolver", "pade", A.sparsity());
     return ret(std::vector<DM>{A, 1})[0];
   }
 
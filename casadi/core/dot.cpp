@@ -24,8 +24,18 @@
 
 
 #include "dot.hpp"
+
+#ifdef CASADI_WITH_BLAS
+extern "C" {
+  double ddot_(const int* n, const double* x, const int* incx, const double* y, const int* incy);
+}
+#endif // CASADI_WITH_BLAS
+
 namespace casadi {
 
+  // Smallest dense inner product passed on to BLAS
+  static const casadi_int blas_min_size = 1024;
+
   Dot::Dot(const MX& x, const MX& y) {
     casadi_assert_dev(x.sparsity()==y.sparsity());
     set_dep(x, y);
@@ -57,6 +67,13 @@ namespace casadi {
   }
 
   int Dot::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
+#ifdef CASADI_WITH_BLAS
+    if (dep(0).nnz() >= blas_min_size) {
+      int n = dep(0).nnz(), inc = 1;
+      *res[0] = ddot_(&n, arg[0], &inc, arg[1], &inc);
+      return 0;
+    }
+#endif // CASADI_WITH_BLAS
     return eval_gen<double>(arg, res, iw, w);
   }
 
@@ -95,6 +112,16 @@ namespace casadi {
   void Dot::generate(CodeGenerator& g,
                       const std::vector<casadi_int>& arg,
                       const std::vector<casadi_int>& res) const {
+    if (g.blas() && dep(0).nnz() >= blas_min_size) {
+      g.add_external("double ddot_(const int* n, const double* x, const int* incx, "
+                     "const double* y, const int* incy);");
+      g << "{\n"
+        << "int blas_n = " << dep(0).nnz() << ", blas_inc = 1;\n"
+        << g.workel(res[0]) << " = ddot_(&blas_n, " << g.work(arg[0], dep(0).nnz())
+        << ", &blas_inc, " << g.work(arg[1], dep(1).nnz()) << ", &blas_inc);\n"
+        << "}\n";
+      return;
+    }
     g << g.workel(res[0]) << " = "
       << g.dot(dep().nnz(), g.work(arg[0], dep(0).nnz()), g.work(arg[1], dep(1).nnz()))
       << ";\n";
@@ -31,8 +31,19 @@
 #include "function_internal.hpp"
 #include "runtime/shared.hpp"
 
+#ifdef CASADI_WITH_BLAS
+extern "C" {
+  void dgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+              const double* alpha, const double* a, const int* lda, const double* b,
+              const int* ldb, const double* beta, double* c, const int* ldc);
+}
+#endif // CASADI_WITH_BLAS
+
 namespace casadi {
 
+  // Smallest contraction, in multiply-adds, passed on to BLAS, cf. DenseMultiplication
+  static const casadi_int blas_min_size = 32768;
+
   Einstein::Einstein(const MX& C, const MX& A, const MX& B,
     const std::vector<casadi_int>& dim_c, const std::vector<casadi_int>& dim_a,
     const std::vector<casadi_int>& dim_b,
@@ -46,6 +57,109 @@ namespace casadi {
     n_iter_ = einstein_process(A, B, C, dim_a, dim_b, dim_c, a, b, c,
       iter_dims_, strides_a_, strides_b_, strides_c_);
 
+    detect_gemm();
+  }
+
+  // Merge a group of loops into one, possible if they are nested the same way in both tensors
+  static bool merge_loops(const std::vector<casadi_int>& loops,
+      const std::vector<casadi_int>& iter_dims,
+      const std::vector<casadi_int>& strides1, const std::vector<casadi_int>& strides2,
+      casadi_int& dim, casadi_int& stride1, casadi_int& stride2) {
+    std::vector<casadi_int> l = loops;
+    std::sort(l.begin(), l.end(), [&strides1](casadi_int i, casadi_int j) {
+      return strides1[1+i] < strides1[1+j];});
+    dim = 1;
+    stride1 = stride2 = 0;
+    for (casadi_int i=0; i<l.size(); ++i) {
+      casadi_int s1 = strides1[1+l[i]], s2 = strides2[1+l[i]];
+      if (i==0) {
+        stride1 = s1;
+        stride2 = s2;
+      } else if (s1!=stride1*dim || s2!=stride2*dim) {
+        return false;
+      }
+      dim *= iter_dims[l[i]];
+    }
+    return true;
+  }
+
+  // Leading dimension of a column-major (or if tr, row-major) matrix, zero if not such a matrix
+  static casadi_int leading_dim(casadi_int nrow, casadi_int srow,
+      casadi_int ncol, casadi_int scol, bool tr) {
+    if (tr) return leading_dim(ncol, scol, nrow, srow, false);
+    if (nrow>1 && srow!=1) return 0;
+    if (ncol==1) return nrow;
+    return scol>=nrow ? scol : 0;
+  }
+
+  void Einstein::detect_gemm() {
+    gemm_ = false;
+    if (n_iter_==0) return;
+
+    // Classify the loops: rows (in A and C), columns (in B and C), inner (in A and B)
+    std::vector<casadi_int> loops_m, loops_n, loops_k;
+    for (casadi_int j=0; j<iter_dims_.size(); ++j) {
+      bool in_a = strides_a_[1+j]!=0, in_b = strides_b_[1+j]!=0, in_c = strides_c_[1+j]!=0;
+      if (in_a && in_c && !in_b) {
+        loops_m.push_back(j);
+      } else if (in_b && in_c && !in_a) {
+        loops_n.push_back(j);
+      } else if (in_a && in_b && !in_c) {
+        loops_k.push_back(j);
+      } else {
+        // Batch index or reduction over a single tensor
+        return;
+      }
+    }
+
+    // Matrix dimensions and strides
+    casadi_int m, n, k, sa_m, sc_m, sb_n, sc_n, sa_k, sb_k;
+    if (!merge_loops(loops_m, iter_dims_, strides_a_, strides_c_, m, sa_m, sc_m)) return;
+    if (!merge_loops(loops_n, iter_dims_, strides_b_, strides_c_, n, sb_n, sc_n)) return;
+    if (!merge_loops(loops_k, iter_dims_, strides_a_, strides_b_, k, sa_k, sb_k)) return;
+
+    // C = op(A)*op(B) or, if C is stored transposed, C' = op(B)'*op(A)'
+    casadi_int sx_m, sx_k, sy_k, sy_n;
+    gemm_ldc_ = leading_dim(m, sc_m, n, sc_n, false);
+    if (gemm_ldc_) {
+      gemm_x_ = 1;
+      sx_m = sa_m;
+      sx_k = sa_k;
+      sy_k = sb_k;
+      sy_n = sb_n;
+    } else {
+      gemm_ldc_ = leading_dim(n, sc_n, m, sc_m, false);
+      if (!gemm_ldc_) return;
+      std::swap(m, n);
+      gemm_x_ = 2;
+      sx_m = sb_n;
+      sx_k = sb_k;
+      sy_k = sa_k;
+      sy_n = sa_m;
+    }
+    gemm_y_ = 3 - gemm_x_;
+    gemm_off_x_ = gemm_x_==1 ? strides_a_[0] : strides_b_[0];
+    gemm_off_y_ = gemm_y_==1 ? strides_a_[0] : strides_b_[0];
+
+    // Storage of the factors
+    gemm_tr_x_ = false;
+    gemm_ldx_ = leading_dim(m, sx_m, k, sx_k, false);
+    if (!gemm_ldx_) {
+      gemm_tr_x_ = true;
+      gemm_ldx_ = leading_dim(m, sx_m, k, sx_k, true);
+      if (!gemm_ldx_) return;
+    }
+    gemm_tr_y_ = false;
+    gemm_ldy_ = leading_dim(k, sy_k, n, sy_n, false);
+    if (!gemm_ldy_) {
+      gemm_tr_y_ = true;
+      gemm_ldy_ = leading_dim(k, sy_k, n, sy_n, true);
+      if (!gemm_ldy_) return;
+    }
+    gemm_m_ = m;
+    gemm_n_ = n;
+    gemm_k_ = k;
+    gemm_ = true;
   }
 
   std::string Einstein::disp(const std::vector<std::string>& arg) const {
@@ -53,6 +167,18 @@ namespace casadi {
   }
 
   int Einstein::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
+#ifdef CASADI_WITH_BLAS
+    if (gemm_ && gemm_m_*gemm_n_*gemm_k_ >= blas_min_size) {
+      if (arg[0]!=res[0]) std::copy(arg[0], arg[0]+nnz(), res[0]);
+      int m = gemm_m_, n = gemm_n_, k = gemm_k_;
+      int ldx = gemm_ldx_, ldy = gemm_ldy_, ldc = gemm_ldc_;
+      char tr_x = gemm_tr_x_ ? 'T' : 'N', tr_y = gemm_tr_y_ ? 'T' : 'N';
+      double one = 1;
+      dgemm_(&tr_x, &tr_y, &m, &n, &k, &one, arg[gemm_x_]+gemm_off_x_, &ldx,
+             arg[gemm_y_]+gemm_off_y_, &ldy, &one, res[0]+strides_c_[0], &ldc);
+      return 0;
+    }
+#endif // CASADI_WITH_BLAS
     return eval_gen<double>(arg, res, iw, w);
   }
 
@@ -135,9 +261,28 @@ namespace casadi {
       g << g.copy(g.work(arg[0], nnz()), nnz(), g.work(res[0], nnz()));
     }
 
-    // main loop
-    g.local("i", "casadi_int");
-    g << "for (i=0; i<" << n_iter_ << "; ++i) {\n";
+    // Matrix product
+    if (gemm_ && g.blas() && gemm_m_*gemm_n_*gemm_k_ >= blas_min_size) {
+      g.add_external("void dgemm_(const char* transa, const char* transb, "
+                     "const int* m, const int* n, const int* k, "
+                     "const double* alpha, const double* a, const int* lda, "
+                     "const double* b, const int* ldb, "
+                     "const double* beta, double* c, const int* ldc);");
+      g << "{\n"
+        << "char blas_tr_x = '" << (gemm_tr_x_ ? 'T' : 'N') << "', "
+        << "blas_tr_y = '" << (gemm_tr_y_ ? 'T' : 'N') << "';\n"
+        << "int blas_m = " << gemm_m_ << ", blas_n = " << gemm_n_
+        << ", blas_k = " << gemm_k_ << ";\n"
+        << "int blas_ldx = " << gemm_ldx_ << ", blas_ldy = " << gemm_ldy_
+        << ", blas_ldc = " << gemm_ldc_ << ";\n"
+        << "casadi_real blas_one = 1;\n"
+        << "dgemm_(&blas_tr_x, &blas_tr_y, &blas_m, &blas_n, &blas_k, &blas_one, "
+        << g.work(arg[gemm_x_], dep(gemm_x_).nnz()) << "+" << gemm_off_x_ << ", &blas_ldx, "
+        << g.work(arg[gemm_y_], dep(gemm_y_).nnz()) << "+" << gemm_off_y_ << ", &blas_ldy, "
+        << "&blas_one, " << g.work(res[0], nnz()) << "+" << strides_c_[0] << ", &blas_ldc);\n"
+        << "}\n";
+      return;
+    }
 
     // Data pointers
     g.local("cr", "const casadi_real", "*");
@@ -147,24 +292,26 @@ namespace casadi {
     g << "cs = " << g.work(arg[2], dep(2).nnz()) << "+" << strides_b_[0] << ";\n";
     g << "rr = " << g.work(res[0], dep(0).nnz()) << "+" << strides_c_[0] << ";\n";
 
-    // Construct indices
+    // Nested loops, in the order of iter_dims_: the innermost loops are contiguous
+    std::string ind_a, ind_b, ind_c;
     for (casadi_int j=0; j<iter_dims_.size(); ++j) {
-      if (j==0) {
-        g.local("k", "casadi_int");
-        g << "k = i;\n";
-        g.local("j", "casadi_int");
+      std::string i = "i" + str(j);
+      g.local(i, "casadi_int");
+      g << "for (" << i << "=0; " << i << "<" << iter_dims_[j] << "; ++" << i << ") {\n";
+      for (auto&& e : {std::make_pair(&ind_a, strides_a_[1+j]),
+                       std::make_pair(&ind_b, strides_b_[1+j]),
+                       std::make_pair(&ind_c, strides_c_[1+j])}) {
+        if (e.second==0) continue;
+        if (!e.first->empty()) *e.first += "+";
+        *e.first += e.second==1 ? i : i + "*" + str(e.second);
       }
-      g << "j = k % " << iter_dims_[j] << ";\n";
-      if (j+1<iter_dims_.size()) g << "k /= " << iter_dims_[j] << ";\n";
-      if (strides_a_[1+j]) g << "cr += j*" << strides_a_[1+j] << ";\n";
-      if (strides_b_[1+j]) g << "cs += j*" << strides_b_[1+j] << ";\n";
-      if (strides_c_[1+j]) g << "rr += j*" << strides_c_[1+j] << ";\n";
     }
 
     // Perform the actual multiplication
-    g << "*rr += *cr**cs;\n";
+    g << "rr[" << (ind_c.empty() ? "0" : ind_c) << "] += cr[" << (ind_a.empty() ? "0" : ind_a)
+      << "]*cs[" << (ind_b.empty() ? "0" : ind_b) << "];\n";
 
-    g << "}\n";
+    for (casadi_int j=0; j<iter_dims_.size(); ++j) g << "}\n";
   }
 
 } // namespace casadi
@@ -129,9 +129,12 @@ namespace casadi {
               {"a", a_}, {"b", b_}, {"c", c_},
               {"iter_dims", iter_dims_},
               {"strides_a", strides_a_}, {"strides_b", strides_b_}, {"strides_c", strides_c_},
-              {"n_iter", n_iter_}};
+              {"n_iter", n_iter_}, {"gemm", gemm_}};
     }
 
+    /// Detect if the contraction is a dense matrix product
+    void detect_gemm();
+
     /// Dimensions of tensors A B C
     std::vector<casadi_int> dim_c_, dim_a_, dim_b_;
     /// Einstein indices
@@ -145,6 +148,16 @@ namespace casadi {
 
     casadi_int n_iter_;
 
+    /** \brief Equivalent column-major matrix product, if any
+
+        C += op(X) * op(Y), with X and Y dependency gemm_x_ and gemm_y_,
+        starting at gemm_off_x_ and gemm_off_y_, transposed if gemm_tr_x_ and gemm_tr_y_ */
+    bool gemm_;
+    casadi_int gemm_x_, gemm_y_, gemm_off_x_, gemm_off_y_;
+    bool gemm_tr_x_, gemm_tr_y_;
+    casadi_int gemm_m_, gemm_n_, gemm_k_;
+    casadi_int gemm_ldx_, gemm_ldy_, gemm_ldc_;
+
   };
 
 
@@ -53,6 +53,24 @@ Function external(const std::string& name, const std::string& bin_name,
   return external(name, Importer(bin_name, "dll"), opts);
 }
 
+std::vector<Function> external_all(const std::string& bin_name, const Dict& opts) {
+  Importer li(bin_name, "dll");
+  // Library name without directory and suffix
+  std::string stem = bin_name.substr(bin_name.find_last_of("/\\") + 1);
+  stem = stem.substr(0, stem.find('.'));
+  // Names of the functions in the library
+  typedef const char* (*function_name_t)(casadi_int i);
+  function_name_t function_name = reinterpret_cast<function_name_t>(
+    li.get_function(stem + "_functions"));
+  casadi_assert(function_name != nullptr, "Library '" + bin_name + "' does not define '"
+    + stem + "_functions'. Was it generated by CasADi under this name?");
+  std::vector<Function> ret;
+  for (casadi_int i = 0; function_name(i) != nullptr; ++i) {
+    ret.push_back(external(function_name(i), li, opts));
+  }
+  return ret;
+}
+
 External::External(const std::string& name, const Importer& li)
   : FunctionInternal(name), li_(li) {
 
@@ -73,6 +91,13 @@ void External::init_external() {
   casadi_assert(static_cast<bool>(incref_) == static_cast<bool>(decref_),
     "External must either define both incref and decref or neither.");
 
+  // Integer type of the external code, if different from casadi_int
+  int_bytes_ = sizeof(casadi_int);
+  int_bytes_t int_bytes = (int_bytes_t)li_.get_function(name_ + "_int_bytes");
+  if (int_bytes) int_bytes_ = int_bytes();
+  casadi_assert(int_bytes_==sizeof(casadi_int) || int_bytes_==sizeof(int32_t),
+    "External: unsupported integer size " + str(int_bytes_) + " in '" + name_ + "'");
+
   // Getting default arguments
   get_default_in_ = (default_t)li_.get_function(name_ + "_default_in");
 
@@ -134,8 +159,18 @@ External::~External() {
   clear_mem();
 }
 
+// Sparsity pattern in compressed format with 32-bit integers
+static Sparsity compressed_int32(const int32_t* v) {
+  casadi_assert_dev(v!=nullptr);
+  casadi_int ncol = v[1];
+  size_t len = v[2]==1 ? 3 : 2 + ncol + 1 + v[2 + ncol];
+  std::vector<casadi_int> w(v, v + len);
+  return Sparsity::compressed(w.data());
+}
+
 size_t External::get_n_in() {
   if (get_n_in_) {
+    if (narrow_int()) return reinterpret_cast<getint32_t>(get_n_in_)();
     return get_n_in_();
   } else if (li_.has_meta(name_ + "_N_IN")) {
     return li_.meta_int(name_ + "_N_IN");
@@ -147,6 +182,7 @@ size_t External::get_n_in() {
 
 size_t External::get_n_out() {
   if (get_n_out_) {
+    if (narrow_int()) return reinterpret_cast<getint32_t>(get_n_out_)();
     return get_n_out_();
   } else if (li_.has_meta(name_ + "_N_OUT")) {
     return li_.meta_int(name_ + "_N_OUT");
@@ -158,6 +194,7 @@ size_t External::get_n_out() {
 
 double External::get_default_in(casadi_int i) const {
   if (get_default_in_) {
+    if (narrow_int()) return reinterpret_cast<default32_t>(get_default_in_)(i);
     return get_default_in_(i);
   } else {
     // Fall back to base class
@@ -168,7 +205,8 @@ double External::get_default_in(casadi_int i) const {
 std::string External::get_name_in(casadi_int i) {
   if (get_name_in_) {
     // Use function pointer
-    const char* n = get_name_in_(i);
+    const char* n = narrow_int() ? reinterpret_cast<name32_t>(get_name_in_)(i)
+      : get_name_in_(i);
     casadi_assert(n!=nullptr, "Error querying input name");
     return n;
   } else if (li_.has_meta(name_ + "_NAME_IN", i)) {
@@ -183,7 +221,8 @@ std::string External::get_name_in(casadi_int i) {
 std::string External::get_name_out(casadi_int i) {
   if (get_name_out_) {
     // Use function pointer
-    const char* n = get_name_out_(i);
+    const char* n = narrow_int() ? reinterpret_cast<name32_t>(get_name_out_)(i)
+      : get_name_out_(i);
     casadi_assert(n!=nullptr, "Error querying output name");
     return n;
   } else if (li_.has_meta(name_ + "_NAME_OUT", i)) {
@@ -198,6 +237,9 @@ std::string External::get_name_out(casadi_int i) {
 Sparsity GenericExternal::get_sparsity_in(casadi_int i) {
   // Use sparsity retrieval function, if present
   if (get_sparsity_in_) {
+    if (narrow_int()) {
+      return compressed_int32(reinterpret_cast<sparsity32_t>(get_sparsity_in_)(i));
+    }
     return Sparsity::compressed(get_sparsity_in_(i));
   } else if (li_.has_meta(name_ + "_SPARSITY_IN", i)) {
     return Sparsity::compressed(li_.meta_vector<casadi_int>(name_ + "_SPARSITY_IN", i));
@@ -210,6 +252,9 @@ Sparsity GenericExternal::get_sparsity_in(casadi_int i) {
 Sparsity GenericExternal::get_sparsity_out(casadi_int i) {
   // Use sparsity retrieval function, if present
   if (get_sparsity_out_) {
+    if (narrow_int()) {
+      return compressed_int32(reinterpret_cast<sparsity32_t>(get_sparsity_out_)(i));
+    }
     return Sparsity::compressed(get_sparsity_out_(i));
   } else if (li_.has_meta(name_ + "_SPARSITY_OUT", i)) {
     return Sparsity::compressed(li_.meta_vector<casadi_int>(name_ + "_SPARSITY_OUT", i));
@@ -237,6 +282,9 @@ Sparsity GenericExternal::get_jac_sparsity(casadi_int oind, casadi_int iind,
   casadi_int ind = iind + oind * n_in_;
   // Use sparsity retrieval function, if present
   if (get_jac_sparsity_) {
+    if (narrow_int()) {
+      return compressed_int32(reinterpret_cast<sparsity32_t>(get_jac_sparsity_)(ind));
+    }
     return Sparsity::compressed(get_jac_sparsity_(ind));
   } else if (li_.has_meta("JAC_" + name_ + "_SPARSITY_OUT", ind)) {
     return Sparsity::compressed(
@@ -250,6 +298,7 @@ Sparsity GenericExternal::get_jac_sparsity(casadi_int oind, casadi_int iind,
 bool GenericExternal::get_diff_in(casadi_int i) {
   if (get_diff_in_) {
     // Query function exists
+    if (narrow_int()) return reinterpret_cast<diff32_t>(get_diff_in_)(i);
     return get_diff_in_(i);
   } else {
     // Fall back to base class
@@ -260,6 +309,7 @@ bool GenericExternal::get_diff_in(casadi_int i) {
 bool GenericExternal::get_diff_out(casadi_int i) {
   if (get_diff_out_) {
     // Query function exists
+    if (narrow_int()) return reinterpret_cast<diff32_t>(get_diff_out_)(i);
     return get_diff_out_(i);
   } else {
     // Fall back to base class
@@ -283,7 +333,15 @@ void External::init(const Dict& opts) {
 
   // Allocate work vectors
   casadi_int sz_arg=0, sz_res=0, sz_iw=0, sz_w=0;
-  if (work_) {
+  if (work_ && narrow_int()) {
+    int32_t n_arg=0, n_res=0, n_iw=0, n_w=0;
+    casadi_int flag = reinterpret_cast<work32_t>(work_)(&n_arg, &n_res, &n_iw, &n_w);
+    casadi_assert(flag==0, "External: \"work\" failed");
+    sz_arg = n_arg;
+    sz_res = n_res;
+    sz_iw = n_iw;
+    sz_w = n_w;
+  } else if (work_) {
     casadi_int flag = work_(&sz_arg, &sz_res, &sz_iw, &sz_w);
     casadi_assert(flag==0, "External: \"work\" failed");
   } else if (li_.has_meta(name_ + "_WORK")) {
@@ -57,6 +57,17 @@ CASADI_EXPORT Function external(const std::string& name, const Dict& opts=Dict()
 CASADI_EXPORT Function external(const std::string& name, const std::string& bin_name,
                                 const Dict& opts=Dict());
 
+/** \brief  Load all functions from a shared library generated by CasADi
+ *
+ * The functions are listed by the symbol <stem>_functions, where <stem> is the
+ * file name without directory and suffix, i.e. the name passed to CodeGenerator.
+ * The library is loaded once and shared between the functions.
+ *
+ * \param bin_name File name of the shared library
+*/
+CASADI_EXPORT std::vector<Function> external_all(const std::string& bin_name,
+                                                 const Dict& opts=Dict());
+
 /** \brief  Load a just-in-time compiled external function
 
  * File name given
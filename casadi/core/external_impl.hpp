@@ -47,6 +47,17 @@
 
 namespace casadi {
 
+///@{
+/** \brief Function pointer types for external code generated with a 32-bit casadi_int */
+typedef int (*int_bytes_t)(void);
+typedef int32_t (*getint32_t)(void);
+typedef double (*default32_t)(int32_t i);
+typedef const char* (*name32_t)(int32_t i);
+typedef const int32_t* (*sparsity32_t)(int32_t i);
+typedef int (*diff32_t)(int32_t i);
+typedef int (*work32_t)(int32_t* sz_arg, int32_t* sz_res, int32_t* sz_iw, int32_t* sz_w);
+///@}
+
 class CASADI_EXPORT External : public FunctionInternal {
  protected:
   /** \brief Information about the library
@@ -79,6 +90,16 @@ class CASADI_EXPORT External : public FunctionInternal {
       \identifier{1z7} */
   work_t work_;
 
+  /** \brief Size of casadi_int in the external code
+
+      Differs from sizeof(casadi_int) for code generated with a 32-bit "casadi_int"
+      type, the query functions are then called through the narrow signatures.
+  */
+  int int_bytes_;
+
+  /// Is the external code using 32-bit integers while casadi_int is wider?
+  bool narrow_int() const { return int_bytes_ != sizeof(casadi_int);}
+
   ///@{
   /** \brief Data vectors
 
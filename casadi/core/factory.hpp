@@ -474,7 +474,7 @@ namespace casadi {
           // Calculate extended Hessian
           MatType H;
           if (symmetric) {
-            H = hessian(out_.at(f), vertcat(x1));
+            H = hessian(out_.at(f), vertcat(x1), opts);
           } else {
             H = jacobian(gradient(out_.at(f), vertcat(x1)), vertcat(x2));
           }
@@ -556,30 +556,34 @@ namespace casadi {
 
   template<typename MatType>
   void Factory<MatType>::calculate(const Dict& opts) {
+    // Hessian construction method, only passed on to the Hessian blocks
+    Dict d_opts = opts;
+    d_opts.erase("hessian_method");
+
     // Forward mode directional derivatives
     try {
-      calculate_fwd(opts);
+      calculate_fwd(d_opts);
     } catch (std::exception& e) {
       casadi_error("Forward mode AD failed:\n" + str(e.what()));
     }
 
     // Reverse mode directional derivatives
     try {
-      calculate_adj(opts);
+      calculate_adj(d_opts);
     } catch (std::exception& e) {
       casadi_error("Reverse mode AD failed:\n" + str(e.what()));
     }
 
     // Jacobian blocks
     try {
-      calculate_jac(opts);
+      calculate_jac(d_opts);
     } catch (std::exception& e) {
       casadi_error("Jacobian generation failed:\n" + str(e.what()));
     }
 
     // Gradient blocks
     try {
-      calculate_grad(opts);
+      calculate_grad(d_opts);
     } catch (std::exception& e) {
       casadi_error("Gradient generation failed:\n" + str(e.what()));
     }
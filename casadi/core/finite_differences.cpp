@@ -24,6 +24,7 @@
 
 
 #include "finite_differences.hpp"
+#include "thread_pool.hpp"
 
 namespace casadi {
 
@@ -61,7 +62,7 @@ casadi_int fd_offset(FdMode v) {
 }
 
 FiniteDiff::FiniteDiff(const std::string& name, casadi_int n)
-  : FunctionInternal(name), n_(n) {
+  : FunctionInternal(name), n_(n), n_slot_(1) {
 }
 
 FiniteDiff::~FiniteDiff() {
@@ -98,6 +99,9 @@ const Options FiniteDiff::options_
       {OT_INT,
       "Number of iterations to improve on the step-size "
       "[default: 1 if error estimate available, otherwise 0]"}},
+    {"parallelization",
+      {OT_STRING,
+      "Evaluate the directional derivatives in parallel [SERIAL|thread]"}},
     }
 };
 
@@ -114,6 +118,7 @@ void FiniteDiff::init(const Dict& opts) {
   h_ = calc_stepsize(m_.abstol);
   u_aim_ = 100;
   h_iter_ = has_err() ? 1 : 0;
+  std::string parallelization = "serial";
 
   // Read options
   for (auto&& op : opts) {
@@ -133,9 +138,20 @@ void FiniteDiff::init(const Dict& opts) {
       u_aim_ = op.second;
     } else if (op.first=="h_iter") {
       h_iter_ = op.second;
+    } else if (op.first=="parallelization") {
+      parallelization = op.second.to_string();
     }
   }
 
+  // Number of ranges of directions that can be evaluated concurrently
+  if (parallelization=="serial") {
+    n_slot_ = 1;
+  } else if (parallelization=="thread") {
+    n_slot_ = std::min(n_, ThreadPool::requested_size());
+  } else {
+    casadi_error("Unknown parallelization: " + parallelization);
+  }
+
   // Check h_iter for consistency
   if (h_iter_!=0 && !has_err()) {
     casadi_error("Perturbation size refinement requires an error estimate, "
@@ -146,9 +162,15 @@ void FiniteDiff::init(const Dict& opts) {
   // Allocate work vector for (perturbed) inputs and outputs
   n_z_ = derivative_of_.nnz_in();
   n_y_ = derivative_of_.nnz_out();
-  alloc_res(n_pert(), true); // yk
-  alloc_w((n_pert() + 3) * n_y_, true); // yk[:], y0, y, J
-  alloc_w(n_z_, true); // z
+  alloc_w(n_y_, true); // y0
+
+  // Allocate work vectors for each slot
+  size_t sz_arg, sz_res, sz_iw, sz_w;
+  slot_work(sz_arg, sz_res, sz_iw, sz_w);
+  alloc_arg(n_slot_ * sz_arg);
+  alloc_res(n_slot_ * sz_res);
+  alloc_iw(n_slot_ * sz_iw);
+  alloc_w(n_slot_ * sz_w);
 
   // Dimensions
   if (verbose_) {
@@ -156,9 +178,13 @@ void FiniteDiff::init(const Dict& opts) {
                     + str(n_z_) + " inputs, " + str(n_y_)
                     + " outputs and " + str(n_) + " directional derivatives.");
   }
+}
 
-  // Allocate sufficient temporary memory for function evaluation
-  alloc(derivative_of_);
+void FiniteDiff::slot_work(size_t& sz_arg, size_t& sz_res, size_t& sz_iw, size_t& sz_w) const {
+  derivative_of_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+  sz_res += n_pert(); // yk
+  sz_w += (n_pert() + 2) * n_y_; // yk[:], y, J
+  sz_w += n_z_; // z
 }
 
 Sparsity FiniteDiff::get_sparsity_in(casadi_int i) {
@@ -233,7 +259,6 @@ int FiniteDiff::eval(const double** arg, double** res,
     casadi_int* iw, double* w, void* mem) const {
   // Shorthands
   casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
-  casadi_int n_pert = this->n_pert();
 
   // Non-differentiated input
   const double** x0 = arg;
@@ -255,6 +280,29 @@ int FiniteDiff::eval(const double** arg, double** res,
   double** sens = res;
   res += n_out;
 
+  // Number of ranges of directions, each evaluated with its own work vectors
+  casadi_int n_chunk = std::min(n_slot_, ThreadPool::instance().size());
+  if (n_chunk<=1) return eval_dir(0, n_, x0, y0, seed, sens, arg, res, iw, w);
+
+  // Evaluate ranges of directions in parallel
+  size_t sz_arg, sz_res, sz_iw, sz_w;
+  slot_work(sz_arg, sz_res, sz_iw, sz_w);
+  std::vector<int> flag(n_chunk, 0);
+  ThreadPool::instance().run(n_chunk, [&](casadi_int k) {
+    flag[k] = eval_dir((k*n_)/n_chunk, ((k+1)*n_)/n_chunk, x0, y0, seed, sens,
+      arg + k*sz_arg, res + k*sz_res, iw + k*sz_iw, w + k*sz_w);
+  });
+  for (int fl : flag) if (fl) return 1;
+  return 0;
+}
+
+int FiniteDiff::eval_dir(casadi_int i_begin, casadi_int i_end, const double** x0,
+    double* y0, const double** seed, double** sens,
+    const double** arg, double** res, casadi_int* iw, double* w) const {
+  // Shorthands
+  casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
+  casadi_int n_pert = this->n_pert();
+
   // Finite difference approximation
   double* J = w;
   w += n_y_;
@@ -281,7 +329,7 @@ int FiniteDiff::eval(const double** arg, double** res,
   }
 
   // For all sensitivity directions
-  for (casadi_int i=0; i<n_; ++i) {
+  for (casadi_int i=i_begin; i<i_end; ++i) {
     // Initial stepsize
     double h = h_;
     // Perform finite difference algorithm with different step sizes
@@ -162,6 +162,14 @@ protected:
   // Calculate step size from absolute tolerance
   virtual double calc_stepsize(double abstol) const = 0;
 
+  // Work vector sizes for one slot, i.e. one range of directions
+  void slot_work(size_t& sz_arg, size_t& sz_res, size_t& sz_iw, size_t& sz_w) const;
+
+  // Evaluate the directions i_begin, ..., i_end-1 using the work vectors of one slot
+  int eval_dir(casadi_int i_begin, casadi_int i_end, const double** x0, double* y0,
+    const double** seed, double** sens,
+    const double** arg, double** res, casadi_int* iw, double* w) const;
+
   // Number of directional derivatives
   casadi_int n_;
 
@@ -182,6 +190,9 @@ protected:
 
   // Memory object
   casadi_finite_diff_mem<double> m_;
+
+  // Number of slots, i.e. ranges of directions that can be evaluated in parallel
+  casadi_int n_slot_;
 };
 
 /** Calculate derivative using forward differences
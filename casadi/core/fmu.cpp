@@ -31,6 +31,10 @@
 #include "fmu2.hpp"
 #endif  // WITH_FMI2
 
+#ifdef CASADI_WITH_THREAD
+#include <mutex>
+#endif // CASADI_WITH_THREAD
+
 namespace casadi {
 
 // Throw informative error message
@@ -43,6 +47,23 @@ throw CasadiException("Error in Fmu::" FNAME " for '" + this->name() + "' "\
   Fmu::Fmu() {
 
   }
+
+Importer FmuInternal::load_library(const std::string& path) {
+  // Libraries in use, by path. Never freed, as it may outlive other static objects
+  static auto* loaded = new std::map<std::string, WeakRef>();
+#ifdef CASADI_WITH_THREAD
+  static std::mutex mtx;
+  std::lock_guard<std::mutex> lock(mtx);
+#endif // CASADI_WITH_THREAD
+  // Reuse if still loaded by another instance
+  auto it = loaded->find(path);
+  if (it != loaded->end() && it->second.alive()) {
+    return shared_cast<Importer>(it->second.shared());
+  }
+  Importer li(path, "dll");
+  (*loaded)[path] = li;
+  return li;
+}
 Fmu::Fmu(const std::string& name, FmuApi api, const DaeBuilderInternal* dae,
     const std::vector<std::string>& scheme_in,
     const std::vector<std::string>& scheme_out,
@@ -258,9 +258,10 @@ void Fmu2::init(const DaeBuilderInternal* dae) {
   std::replace(instance_name_no_dot.begin(), instance_name_no_dot.end(), '.', '_');
   std::string dll_path = dae->path_ + "/binaries/" + system_infix()
     + "/" + instance_name_no_dot + dll_suffix();
-  li_ = Importer(dll_path, "dll");
+  li_ = load_library(dll_path);
 
   declared_ad_ = dae->provides_directional_derivative_;
+  declared_state_ = dae->can_get_and_set_fmu_state_;
 
   if (dae->provides_directional_derivative_) {
 
@@ -302,6 +303,11 @@ void Fmu2::finalize() {
       load_function<fmi2GetDirectionalDerivativeTYPE>("fmi2GetDirectionalDerivative");
   }
 
+  if (declared_state_) {
+    get_fmu_state_ = load_function<fmi2GetFMUstateTYPE>("fmi2GetFMUstate");
+    set_fmu_state_ = load_function<fmi2SetFMUstateTYPE>("fmi2SetFMUstate");
+  }
+
   // Callback functions
   functions_.logger = logger;
   functions_.allocateMemory = calloc;
@@ -420,6 +426,9 @@ int Fmu2::init_mem(FmuMemory* m) const {
   // Allocate/reset requested
   m->requested_.resize(oind_.size());
   std::fill(m->requested_.begin(), m->requested_.end(), false);
+  // Allocate/reset output cache
+  m->valid_out_.resize(oind_.size());
+  std::fill(m->valid_out_.begin(), m->valid_out_.end(), false);
   // Also allocate memory for corresponding Jacobian entry (for debugging)
   m->wrt_.resize(oind_.size());
   // Successful return
@@ -596,17 +605,31 @@ void Fmu2::get_stats(FmuMemory* m, Dict* stats,
 int Fmu2::eval(FmuMemory* m) const {
   // Gather inputs and outputs
   gather_io(m);
-  // Number of inputs and outputs
+  // Number of inputs
   size_t n_set = m->id_in_.size();
-  size_t n_out = m->id_out_.size();
   // Fmi return flag
   fmi2Status status;
-  // Set all variables
-  status = set_real_(m->instance, get_ptr(m->vr_in_), n_set, get_ptr(m->v_in_));
-  if (status != fmi2OK) {
-    casadi_warning("fmi2SetReal failed");
-    return 1;
+  // Set the variables that changed, if any
+  if (n_set > 0) {
+    status = set_real_(m->instance, get_ptr(m->vr_in_), n_set, get_ptr(m->v_in_));
+    if (status != fmi2OK) {
+      casadi_warning("fmi2SetReal failed");
+      return 1;
+    }
+    // Any previously retrieved outputs are out of date
+    std::fill(m->valid_out_.begin(), m->valid_out_.end(), false);
   }
+  // Only retrieve requested variables that are not up to date
+  size_t n_out = 0;
+  for (size_t k = 0; k < m->id_out_.size(); ++k) {
+    if (!m->valid_out_[m->id_out_[k]]) {
+      m->id_out_[n_out] = m->id_out_[k];
+      m->vr_out_[n_out] = m->vr_out_[k];
+      n_out++;
+    }
+  }
+  m->id_out_.resize(n_out);
+  m->vr_out_.resize(n_out);
   // Quick return if nothing requested
   if (n_out == 0) return 0;
   // Calculate all variables
@@ -620,11 +643,35 @@ int Fmu2::eval(FmuMemory* m) const {
   auto it = m->v_out_.begin();
   for (size_t id : m->id_out_) {
     m->obuf_[id] = *it++;
+    m->valid_out_[id] = true;
   }
   // Successful return
   return 0;
 }
 
+int Fmu2::get_unperturbed(FmuMemory* m) const {
+  // Reuse outputs already retrieved at the current point, if possible
+  bool all_valid = true;
+  for (size_t id : m->id_out_) all_valid = all_valid && m->valid_out_[id];
+  if (all_valid) {
+    for (size_t k = 0; k < m->id_out_.size(); ++k) m->v_out_[k] = m->obuf_[m->id_out_[k]];
+    return 0;
+  }
+  // Evaluate
+  fmi2Status status = get_real_(m->instance, get_ptr(m->vr_out_), m->id_out_.size(),
+    get_ptr(m->v_out_));
+  if (status != fmi2OK) {
+    casadi_warning("fmi2GetReal failed");
+    return 1;
+  }
+  // Save for subsequent requests
+  for (size_t k = 0; k < m->id_out_.size(); ++k) {
+    m->obuf_[m->id_out_[k]] = m->v_out_[k];
+    m->valid_out_[m->id_out_[k]] = true;
+  }
+  return 0;
+}
+
 int Fmu2::eval_ad(FmuMemory* m) const {
   // Number of inputs and outputs
   size_t n_known = m->id_in_.size();
@@ -632,13 +679,9 @@ int Fmu2::eval_ad(FmuMemory* m) const {
   // Quick return if nothing to be calculated
   if (n_unknown == 0) return 0;
   // Evalute (should not be necessary)
-  fmi2Status status = get_real_(m->instance, get_ptr(m->vr_out_), n_unknown, get_ptr(m->v_out_));
-  if (status != fmi2OK) {
-    casadi_warning("fmi2GetReal failed");
-    return 1;
-  }
+  if (get_unperturbed(m)) return 1;
   // Evaluate directional derivatives
-  status = get_directional_derivative_(m->instance, get_ptr(m->vr_out_), n_unknown,
+  fmi2Status status = get_directional_derivative_(m->instance, get_ptr(m->vr_out_), n_unknown,
     get_ptr(m->vr_in_), n_known, get_ptr(m->d_in_), get_ptr(m->d_out_));
   if (status != fmi2OK) {
     casadi_warning("fmi2GetDirectionalDerivative failed");
@@ -659,11 +702,17 @@ int Fmu2::eval_fd(FmuMemory* m, bool independent_seeds) const {
   size_t n_unknown = m->id_out_.size();
   // Quick return if nothing to be calculated
   if (n_unknown == 0) return 0;
-  // Evalute (should not be necessary)
-  fmi2Status status = get_real_(m->instance, get_ptr(m->vr_out_), n_unknown, get_ptr(m->v_out_));
-  if (status != fmi2OK) {
-    casadi_warning("fmi2GetReal failed");
-    return 1;
+  // Unperturbed outputs
+  if (get_unperturbed(m)) return 1;
+  // Fmi return flag
+  fmi2Status status;
+  // Save the state at the unperturbed point, if supported
+  if (get_fmu_state_) {
+    status = get_fmu_state_(m->instance, &m->fmu_state);
+    if (status != fmi2OK) {
+      casadi_warning("fmi2GetFMUstate failed");
+      return 1;
+    }
   }
   // Make outputs dimensionless
   for (size_t k = 0; k < n_unknown; ++k) m->v_out_[k] /= nominal_out_[m->id_out_[k]];
@@ -773,11 +822,19 @@ int Fmu2::eval_fd(FmuMemory* m, bool independent_seeds) const {
       }
     }
   }
-  // Restore FMU inputs
-  status = set_real_(m->instance, get_ptr(m->vr_in_), n_known, get_ptr(m->v_in_));
-  if (status != fmi2OK) {
-    casadi_warning("fmi2SetReal failed");
-    return 1;
+  // Restore FMU state, or else the FMU inputs
+  if (set_fmu_state_) {
+    status = set_fmu_state_(m->instance, m->fmu_state);
+    if (status != fmi2OK) {
+      casadi_warning("fmi2SetFMUstate failed");
+      return 1;
+    }
+  } else {
+    status = set_real_(m->instance, get_ptr(m->vr_in_), n_known, get_ptr(m->v_in_));
+    if (status != fmi2OK) {
+      casadi_warning("fmi2SetReal failed");
+      return 1;
+    }
   }
   // Step size
   double h = m->self.step_;
@@ -894,6 +951,8 @@ Fmu2::Fmu2(const std::string& name,
   set_boolean_ = 0;
   get_real_ = 0;
   get_directional_derivative_ = 0;
+  get_fmu_state_ = 0;
+  set_fmu_state_ = 0;
 }
 
 Fmu2* Fmu2::deserialize(DeserializingStream& s) {
@@ -914,8 +973,10 @@ Fmu2::Fmu2(DeserializingStream& s) : FmuInternal(s) {
   set_boolean_ = 0;
   get_real_ = 0;
   get_directional_derivative_ = 0;
+  get_fmu_state_ = 0;
+  set_fmu_state_ = 0;
 
-  s.version("Fmu2", 1);
+  int version = s.version("Fmu2", 1, 2);
   s.unpack("Fmu2::resource_loc", resource_loc_);
   s.unpack("Fmu2::fmutol", fmutol_);
   s.unpack("Fmu2::instance_name", instance_name_);
@@ -941,14 +1002,18 @@ Fmu2::Fmu2(DeserializingStream& s) : FmuInternal(s) {
   s.unpack("Fmu2::vr_aux_string", vr_aux_string_);
 
   s.unpack("Fmu2::declared_ad", declared_ad_);
-
+  if (version >= 2) {
+    s.unpack("Fmu2::declared_state", declared_state_);
+  } else {
+    declared_state_ = false;
+  }
 }
 
 
 void Fmu2::serialize_body(SerializingStream &s) const {
   FmuInternal::serialize_body(s);
 
-  s.version("Fmu2", 1);
+  s.version("Fmu2", 2);
   s.pack("Fmu2::resource_loc", resource_loc_);
   s.pack("Fmu2::fmutol", fmutol_);
   s.pack("Fmu2::instance_name", instance_name_);
@@ -974,6 +1039,7 @@ void Fmu2::serialize_body(SerializingStream &s) const {
   s.pack("Fmu2::vr_aux_string_", vr_aux_string_);
 
   s.pack("Fmu2::declared_ad", declared_ad_);
+  s.pack("Fmu2::declared_state", declared_state_);
 }
 
 #endif  // WITH_FMI2
@@ -91,6 +91,9 @@ class CASADI_EXPORT Fmu2 : public FmuInternal {
   // Does the FMU declare analytic derivatives support?
   bool declared_ad_;
 
+  // Does the FMU declare support for getting and setting its state?
+  bool declared_state_;
+
   // Following members set in finalize
 
   // FMU C API function prototypes. Cf. FMI specification 2.0.2
@@ -110,6 +113,8 @@ class CASADI_EXPORT Fmu2 : public FmuInternal {
   fmi2GetStringTYPE* get_string_;
   fmi2SetStringTYPE* set_string_;
   fmi2GetDirectionalDerivativeTYPE* get_directional_derivative_;
+  fmi2GetFMUstateTYPE* get_fmu_state_;
+  fmi2SetFMUstateTYPE* set_fmu_state_;
 
   // Callback functions
   fmi2CallbackFunctions functions_;
@@ -168,6 +173,9 @@ class CASADI_EXPORT Fmu2 : public FmuInternal {
   // Calculate all requested variables
   int eval(FmuMemory* m) const override;
 
+  // Get the unperturbed requested variables, reusing earlier results if possible
+  int get_unperturbed(FmuMemory* m) const;
+
   // Calculate directional derivatives using AD
   int eval_ad(FmuMemory* m) const override;
 
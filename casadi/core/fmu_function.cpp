@@ -27,6 +27,7 @@
 #include "casadi_misc.hpp"
 #include "serializing_stream.hpp"
 #include "dae_builder_internal.hpp"
+#include "thread_pool.hpp"
 
 #include <fstream>
 #include <iostream>
@@ -37,13 +38,6 @@
 #include <omp.h>
 #endif // WITH_OPENMP
 
-#ifdef CASADI_WITH_THREAD
-#ifdef CASADI_WITH_THREAD_MINGW
-#include <mingw.thread.h>
-#else // CASADI_WITH_THREAD_MINGW
-#include <thread>
-#endif // CASADI_WITH_THREAD_MINGW
-#endif // CASADI_WITH_THREAD
 
 namespace casadi {
 
@@ -51,15 +45,16 @@ int FmuFunction::init_mem(void* mem) const {
   casadi_assert(mem != 0, "Memory is null");
   // Instantiate base classes
   if (FunctionInternal::init_mem(mem)) return 1;
-  // Number of memory instances needed
-  casadi_int n_mem = std::max(static_cast<casadi_int>(1),
-    std::max(max_jac_tasks_, max_hess_tasks_));
-  // Initialize master and all slaves
-  FmuMemory* m = static_cast<FmuMemory*>(mem);
-  for (casadi_int i = 0; i < n_mem; ++i) {
-    // Initialize the memory object itself or a slave
-    FmuMemory* m1 = i == 0 ? m : m->slaves.at(i - 1);
-    if (fmu_.init_mem(m1)) return 1;
+  // Initialize master only, slaves are instantiated when first needed
+  return fmu_.init_mem(static_cast<FmuMemory*>(mem));
+}
+
+int FmuFunction::init_slaves(FmuMemory* m, casadi_int n_task) const {
+  // Instantiating is expensive: only done for tasks that actually run in parallel
+  if (parallelization_ == Parallelization::SERIAL) return 0;
+  for (casadi_int task = 1; task < n_task; ++task) {
+    FmuMemory* s = m->slaves.at(task - 1);
+    if (!s->instance && fmu_.init_mem(s)) return 1;
   }
   return 0;
 }
@@ -68,7 +63,7 @@ void* FmuFunction::alloc_mem() const {
   // Create (master) memory object
   FmuMemory* m = new FmuMemory(*this);
   // Attach additional (slave) memory objects
-  for (casadi_int i = 1; i < max_jac_tasks_; ++i) {
+  for (casadi_int i = 1; i < max_n_tasks_; ++i) {
     m->slaves.push_back(new FmuMemory(*this));
   }
   return m;
@@ -307,8 +302,8 @@ void FmuFunction::init(const Dict& opts) {
 #endif // WITH_OPENMP
 #ifdef CASADI_WITH_THREAD
     case Parallelization::THREAD:
-      max_n_tasks_ = std::thread::hardware_concurrency();
-      if (verbose_) casadi_message("std::thread using at most " + str(max_n_tasks_) + " threads");
+      max_n_tasks_ = ThreadPool::requested_size();
+      if (verbose_) casadi_message("Thread pool using at most " + str(max_n_tasks_) + " threads");
       break;
 #endif // CASADI_WITH_THREAD
     default:
@@ -432,6 +427,13 @@ void FmuFunction::init(const Dict& opts) {
 
   // Calculate graph coloring
   jac_colors_ = jac_sp_.uni_coloring();
+  // Each color is one directional derivative call: try a largest-first ordering too
+  if (jac_colors_.size2() > 1) {
+    std::vector<casadi_int> ord = jac_sp_.largest_first();
+    Sparsity colors_lf = jac_sp_.pmult(ord, false, true, true)
+      .uni_coloring(Sparsity(), jac_colors_.size2() - 1);
+    if (!colors_lf.is_null()) jac_colors_ = colors_lf.pmult(ord, true, false, false);
+  }
   if (verbose_) casadi_message("Jacobian graph coloring: " + str(jac_sp_.size2())
     + " -> " + str(jac_colors_.size2()) + " directions");
 
@@ -858,6 +860,13 @@ int FmuFunction::eval(const double** arg, double** res, casadi_int* iw, double*
       iw += fmu_.n_in();
     }
   }
+  // Instantiate slaves, if needed
+  if (need_jac || need_adj) {
+    if (init_slaves(m, max_jac_tasks_)) return 1;
+  }
+  if (need_hess) {
+    if (init_slaves(m, max_hess_tasks_)) return 1;
+  }
   // Evaluate everything except Hessian, possibly in parallel
   if (verbose_) casadi_message("Evaluating regular outputs, forward sens, extended Jacobian");
   if (eval_all(m, max_jac_tasks_, true, need_jac, need_fwd, need_adj, false)) return 1;
@@ -936,20 +945,14 @@ int FmuFunction::eval_all(FmuMemory* m, casadi_int n_task,
     #endif  // WITH_OPENMP
   } else if (parallelization_ == Parallelization::THREAD) {
     #ifdef CASADI_WITH_THREAD
-    // Return value for each thread
+    // Return value for each task
     std::vector<int> flag_task(n_task);
-    // Spawn threads
-    std::vector<std::thread> threads;
-    for (casadi_int task = 0; task < n_task; ++task) {
-      threads.emplace_back(
-        [&, task](int* fl) {
-          FmuMemory* s = task == 0 ? m : m->slaves.at(task - 1);
-          *fl = eval_task(s, task, n_task, need_nondiff && task == 0,
-            need_jac, need_fwd && task == 0, need_adj, need_hess);
-        }, &flag_task[task]);
-    }
-    // Join threads
-    for (auto&& th : threads) th.join();
+    // Evaluate in the shared thread pool
+    ThreadPool::instance().run(n_task, [&](casadi_int task) {
+      FmuMemory* s = task == 0 ? m : m->slaves.at(task - 1);
+      flag_task[task] = eval_task(s, task, n_task, need_nondiff && task == 0,
+        need_jac, need_fwd && task == 0, need_adj, need_hess);
+    });
     // Join return flags
     for (int fl : flag_task) flag = flag || fl;
     #else   // CASADI_WITH_THREAD
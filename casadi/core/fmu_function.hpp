@@ -69,6 +69,10 @@ struct CASADI_EXPORT FmuMemory : public FunctionMemory {
   std::vector<bool> changed_;
   // Which entries are being requested
   std::vector<bool> requested_;
+  // Which entries of obuf_ are up to date with the inputs
+  std::vector<bool> valid_out_;
+  // Saved FMU state, if supported
+  void* fmu_state;
   // Derivative with respect to
   std::vector<size_t> wrt_;
   // Current known/unknown variables
@@ -82,7 +86,8 @@ struct CASADI_EXPORT FmuMemory : public FunctionMemory {
   // Work vector (reals)
   std::vector<double> v_in_, v_out_, d_in_, d_out_, fd_out_, v_pert_;
   // Constructor
-  explicit FmuMemory(const FmuFunction& self) : self(self), instance(nullptr) {}
+  explicit FmuMemory(const FmuFunction& self) : self(self), instance(nullptr),
+    fmu_state(nullptr) {}
 };
 
 /// Type of parallelization
@@ -253,6 +258,9 @@ class CASADI_EXPORT FmuFunction : public FunctionInternal {
   int eval_all(FmuMemory* m, casadi_int n_task,
     bool need_nondiff, bool need_jac, bool need_fwd, bool need_adj, bool need_hess) const;
 
+  // Instantiate the slave memory objects for the first n_task tasks, if not already done
+  int init_slaves(FmuMemory* m, casadi_int n_task) const;
+
   // Evaluate numerically, single thread
   int eval_task(FmuMemory* m, casadi_int task, casadi_int n_task,
     bool need_nondiff, bool need_jac, bool need_fwd, bool need_adj, bool need_hess) const;
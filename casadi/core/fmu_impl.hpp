@@ -193,6 +193,9 @@ class CASADI_EXPORT FmuInternal : public SharedObjectInternal {
   /// DLL
   Importer li_;
 
+  /// Load a DLL, shared with the other FMU instances of the process using it
+  static Importer load_library(const std::string& path);
+
   // Mapping from scheme variable to and from FMU variable indices
   std::vector<size_t> iind_, iind_map_, oind_, oind_map_;
 
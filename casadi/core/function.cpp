@@ -35,6 +35,7 @@
 #include "jit_function.hpp"
 #include "serializing_stream.hpp"
 #include "serializer.hpp"
+#include "thread_pool.hpp"
 
 #include <cctype>
 #include <fstream>
@@ -499,7 +500,52 @@ namespace casadi {
       options.erase(it);
     }
 
+    // Checkpoint segment length, 0 if no checkpointing
+    casadi_int checkpoint = 0;
+    it = options.find("checkpoint");
+    if (it!=options.end()) {
+      checkpoint = it->second;
+      options.erase(it);
+    }
+
+    // Parallel prefix scan of affine recurrences
+    std::string scan = "sequential";
+    it = options.find("scan");
+    if (it!=options.end()) {
+      scan = it->second.to_string();
+      options.erase(it);
+    }
+    std::string scan_parallelization = "thread";
+    it = options.find("scan_parallelization");
+    if (it!=options.end()) {
+      scan_parallelization = it->second.to_string();
+      options.erase(it);
+    }
+
     casadi_assert(N>0, "mapaccum: N must be positive");
+    casadi_assert(checkpoint>=0, "mapaccum: checkpoint must be non-negative");
+    casadi_assert(scan=="sequential" || scan=="parallel" || scan=="auto",
+      "mapaccum: scan must be 'sequential', 'parallel' or 'auto', got '" + scan + "'");
+
+    if (scan!="sequential" && N>1) {
+      Function ret = mapaccum_scan(name, N, n_accum, scan_parallelization,
+                                   scan=="parallel", options);
+      if (!ret.is_null()) return ret;
+    }
+
+    if (checkpoint>0 && checkpoint<N) {
+      // Segments are unrolled internally and called as opaque functions, so that
+      // the reverse sweep only stores segment boundaries and recomputes the
+      // intermediates of one segment at a time
+      Dict seg_opts = options;
+      seg_opts["never_inline"] = true;
+      std::vector<Function> chain(N / checkpoint,
+        mapaccum(name + "_seg", std::vector<Function>(checkpoint, *this), n_accum, seg_opts));
+      casadi_int r = N % checkpoint;
+      if (r>0) chain.push_back(mapaccum(name + "_rem", std::vector<Function>(r, *this),
+                                        n_accum, seg_opts));
+      return mapaccum(name, chain, n_accum, options);
+    }
 
     if (base==-1)
       return mapaccum(name, std::vector<Function>(N, *this), n_accum, options);
@@ -562,6 +608,102 @@ namespace casadi {
     return Function(name, arg, res, name_in(), name_out(), opts);
   }
 
+  template<typename M>
+  Function affine_step(const Function& f, casadi_int n_accum,
+                       const std::vector<casadi_int>& offset, std::vector<M> arg) {
+    // Accumulators as slices of a single state vector
+    M x = M::sym("x", offset.back());
+    for (casadi_int i=0; i<n_accum; ++i) {
+      arg[i] = reshape(x(Slice(offset[i], offset[i+1])), f.size1_in(i), f.size2_in(i));
+    }
+    // Inlined, so that the dependency check sees through the call
+    std::vector<M> res;
+    f.call(arg, res, true, false);
+    std::vector<M> next(res.begin(), res.begin()+n_accum);
+    for (M& e : next) e = vec(e);
+    M xnext = vertcat(next);
+    if (!M::is_linear(xnext, x)) return Function();
+    M A, b;
+    M::linear_coeff(xnext, x, A, b, false);
+    std::vector<M> u(arg.begin()+n_accum, arg.end());
+    return Function(f.name() + "_step", u, {densify(A), densify(b)});
+  }
+
+  Function Function::mapaccum_scan(const std::string& name, casadi_int N, casadi_int n_accum,
+                                   const std::string& parallelization, bool check,
+                                   const Dict& opts) const {
+    casadi_int n_in = this->n_in();
+    casadi_assert(n_accum<=std::min(n_in, n_out()), "mapaccum: too many accumulators");
+    // Accumulators are stacked into a single dense state vector
+    std::vector<casadi_int> offset(1, 0);
+    for (casadi_int i=0; i<n_accum; ++i) {
+      if (!sparsity_in(i).is_dense() || sparsity_out(i)!=sparsity_in(i)) {
+        casadi_assert(!check, "mapaccum: scan requires dense accumulators with matching "
+          "input and output sparsity, got " + sparsity_in(i).dim() + " -> "
+          + sparsity_out(i).dim() + " for accumulator " + str(i));
+        return Function();
+      }
+      offset.push_back(offset.back() + numel_in(i));
+    }
+    casadi_int nx = offset.back();
+    // Step k maps x to A_k*x + b_k, with A_k and b_k depending on the other inputs only
+    Function step;
+    if (is_a("SXFunction")) {
+      step = affine_step(*this, n_accum, offset, sx_in());
+    } else if (is_a("MXFunction")) {
+      step = affine_step(*this, n_accum, offset, mx_in());
+    }
+    if (step.is_null()) {
+      casadi_assert(!check, "mapaccum: scan requires the accumulator outputs of '" + this->name()
+        + "' to be affine in the accumulator inputs");
+      return Function();
+    }
+
+    // Composition of two steps, (A2, b2) after (A1, b1)
+    MX A1 = MX::sym("A1", nx, nx), b1 = MX::sym("b1", nx);
+    MX A2 = MX::sym("A2", nx, nx), b2 = MX::sym("b2", nx);
+    Function comb(this->name() + "_comb", {A2, b2, A1, b1},
+                  {mtimes(A2, A1), mtimes(A2, b1) + b2});
+
+    // Symbolic inputs of the returned function
+    std::vector<MX> ret_in(n_in);
+    for (casadi_int i=0; i<n_in; ++i) {
+      ret_in[i] = MX::sym(name_in(i),
+        i<n_accum ? sparsity_in(i) : repmat(sparsity_in(i), 1, N));
+    }
+    std::vector<MX> u_all(ret_in.begin()+n_accum, ret_in.end());
+    std::vector<MX> ab = step.map(N, parallelization)(u_all);
+    MX A_all = ab[0], b_all = ab[1];
+
+    // Inclusive prefix scan: after the level with stride d, entry k holds the
+    // composition of steps max(0, k-2d+1), ..., k
+    for (casadi_int d=1; d<N; d*=2) {
+      std::vector<MX> c = comb.map(N-d, parallelization)({
+        A_all(Slice(), Slice(d*nx, N*nx)), b_all(Slice(), Slice(d, N)),
+        A_all(Slice(), Slice(0, (N-d)*nx)), b_all(Slice(), Slice(0, N-d))});
+      A_all = horzcat(A_all(Slice(), Slice(0, d*nx)), c[0]);
+      b_all = horzcat(b_all(Slice(), Slice(0, d)), c[1]);
+    }
+
+    // All states from the initial state
+    std::vector<MX> x0;
+    for (casadi_int i=0; i<n_accum; ++i) x0.push_back(vec(ret_in[i]));
+    MX X0 = vertcat(x0);
+    Function apply(this->name() + "_apply", {A1, b1, b2}, {mtimes(A1, b2) + b1});
+    MX X = apply.map(this->name() + "_apply_map", parallelization, N, std::vector<casadi_int>{2},
+                     std::vector<casadi_int>())(std::vector<MX>{A_all, b_all, X0}).at(0);
+
+    // Evaluate all steps independently from the state preceding each
+    MX X_prev = horzcat(X0, X(Slice(), Slice(0, N-1)));
+    std::vector<MX> f_arg = ret_in;
+    for (casadi_int i=0; i<n_accum; ++i) {
+      f_arg[i] = reshape(X_prev(Slice(offset[i], offset[i+1]), Slice()),
+                         size1_in(i), size2_in(i)*N);
+    }
+    std::vector<MX> ret_out = map(N, parallelization)(f_arg);
+    return Function(name, ret_in, ret_out, name_in(), name_out(), opts);
+  }
+
   Function Function::mapaccum(const std::string& name, casadi_int n,
                               const std::vector<casadi_int>& accum_in,
                               const std::vector<casadi_int>& accum_out,
@@ -613,6 +755,13 @@ namespace casadi {
   Function Function::map(const std::string& name, const std::string& parallelization, casadi_int n,
       const std::vector<casadi_int>& reduce_in, const std::vector<casadi_int>& reduce_out,
         const Dict& opts) const {
+    // Parallel evaluation with per-thread partial sums
+    if (parallelization=="thread") {
+      std::vector<bool> r_in(n_in(), false), r_out(n_out(), false);
+      for (casadi_int i : reduce_in) r_in.at(i) = true;
+      for (casadi_int i : reduce_out) r_out.at(i) = true;
+      return MapSum::create(name, parallelization, *this, n, r_in, r_out, opts);
+    }
     // Wrap in an MXFunction
     Function f = map(n, parallelization);
     // Start with the fully mapped inputs
@@ -897,6 +1046,11 @@ namespace casadi {
     return (*this)->get_stats(memory(mem));
   }
 
+  Dict Function::memory_report() const {
+    std::set<const FunctionInternal*> visited;
+    return (*this)->memory_report(visited);
+  }
+
   const std::vector<Sparsity>& Function::jac_sparsity(bool compact) const {
     // Make sure all are calculated
     for (casadi_int oind = 0; oind < n_out(); ++oind) {
@@ -1092,6 +1246,14 @@ namespace casadi {
     }
   }
 
+  Function Function::taylor(casadi_int order) const {
+    try {
+      return (*this)->taylor(order);
+    } catch(std::exception& e) {
+      THROW_ERROR("taylor", e.what());
+    }
+  }
+
   void Function::print_dimensions(std::ostream &stream) const {
     (*this)->print_dimensions(stream);
   }
@@ -1145,6 +1307,7 @@ namespace casadi {
 
   void Function::generate_in(const std::string& fname, const std::vector<DM>& arg) {
     std::vector<double> d = nz_from_in(arg);
+    if (is_nz_bin(fname)) return nz_bin_write(fname, d);
 
     // Set up output stream
     std::ofstream of(fname);
@@ -1160,6 +1323,7 @@ namespace casadi {
 
   void Function::generate_out(const std::string& fname, const std::vector<DM>& res) {
     std::vector<double> d = nz_from_out(res);
+    if (is_nz_bin(fname)) return nz_bin_write(fname, d);
 
     // Set up output stream
     std::ofstream of(fname);
@@ -1174,6 +1338,13 @@ namespace casadi {
   }
 
   std::vector<DM> Function::generate_in(const std::string& fname) {
+    if (is_nz_bin(fname)) {
+      std::vector<double> d = nz_bin_read(fname);
+      casadi_assert(d.size()==nnz_in(),
+        "Dimension mismatch: file contains a vector of size " + str(d.size())
+        + ", while size " + str(nnz_in()) + " was expected.");
+      return nz_to_in(d);
+    }
     DM data = DM::from_file(fname, "txt");
     // Empty files are okay
     if (data.is_empty(true)) data = DM(0, 1);
@@ -1186,6 +1357,13 @@ namespace casadi {
   }
 
   std::vector<DM> Function::generate_out(const std::string& fname) {
+    if (is_nz_bin(fname)) {
+      std::vector<double> d = nz_bin_read(fname);
+      casadi_assert(d.size()==nnz_out(),
+        "Dimension mismatch: file contains a vector of size " + str(d.size())
+        + ", while size " + str(nnz_out()) + " was expected.");
+      return nz_to_out(d);
+    }
     DM data = DM::from_file(fname, "txt");
     // Empty files are okay
     if (data.is_empty(true)) data = DM(0, 1);
@@ -1873,14 +2051,30 @@ namespace casadi {
     return (*this)->info();
   }
 
+  FunctionBuffer Function::prepare(const std::vector<const double*>& arg,
+                                   const std::vector<double*>& res) const {
+    casadi_assert(arg.size()<=n_in(), "Too many input buffers");
+    casadi_assert(res.size()<=n_out(), "Too many output buffers");
+    FunctionBuffer buf(*this);
+    for (casadi_int i=0; i<arg.size(); ++i) buf.bind_arg(i, arg[i]);
+    for (casadi_int i=0; i<res.size(); ++i) buf.bind_res(i, res[i]);
+    return buf;
+  }
+
   FunctionBuffer::FunctionBuffer(const Function& f) : f_(f) {
     w_.resize(f_.sz_w());
     iw_.resize(f_.sz_iw());
     arg_.resize(f_.sz_arg());
     res_.resize(f_.sz_res());
-    mem_ = f_->checkout();
-    mem_internal_ = f.memory(mem_);
     f_node_ = f.operator->();
+    // Same memory as used by _eval and released in the destructor
+    mem_internal_ = nullptr;
+    if (f_->checkout_) {
+      mem_ = f_->checkout_();
+    } else {
+      mem_ = f_.checkout();
+      mem_internal_ = f_.memory(mem_);
+    }
   }
 
   FunctionBuffer::~FunctionBuffer() {
@@ -1921,6 +2115,14 @@ namespace casadi {
      " bytes, got " + str(size) + ".");
     res_.at(i) = a;
   }
+  void FunctionBuffer::bind_arg(casadi_int i, const double* a) {
+    casadi_assert(i>=0 && i<f_.n_in(), "Input index out of bounds");
+    arg_[i] = a;
+  }
+  void FunctionBuffer::bind_res(casadi_int i, double* a) {
+    casadi_assert(i>=0 && i<f_.n_out(), "Output index out of bounds");
+    res_[i] = a;
+  }
   void FunctionBuffer::_eval() {
     if (f_node_->eval_) {
       ret_ = f_node_->eval_(get_ptr(arg_), get_ptr(res_), get_ptr(iw_), get_ptr(w_), mem_);
@@ -1932,6 +2134,81 @@ namespace casadi {
     return ret_;
   }
 
+  struct FunctionFuture::State {
+    // Function being evaluated
+    Function f;
+    // Cancellation request
+    std::atomic<bool> cancelled;
+    // Result or exception, valid when done
+    bool done;
+    std::vector<DM> res;
+    std::exception_ptr error;
+#ifdef CASADI_WITH_THREAD
+    mutable std::mutex mtx;
+    mutable std::condition_variable cv;
+#endif // CASADI_WITH_THREAD
+    explicit State(const Function& f) : f(f), cancelled(false), done(false) {}
+  };
+
+  FunctionFuture Function::call_async(const std::vector<DM>& arg) const {
+    auto s = std::make_shared<FunctionFuture::State>(*this);
+    ThreadPool::instance().submit([s, arg]() {
+      // Make the cancellation request visible to InterruptHandler::check
+      const std::atomic<bool>* prev = InterruptHandler::set_cancel_flag(&s->cancelled);
+      std::vector<DM> res;
+      std::exception_ptr error;
+      try {
+        if (s->cancelled) throw KeyboardInterruptException();
+        s->f.call(arg, res);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      InterruptHandler::set_cancel_flag(prev);
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(s->mtx);
+#endif // CASADI_WITH_THREAD
+      s->res = std::move(res);
+      s->error = error;
+      s->done = true;
+#ifdef CASADI_WITH_THREAD
+      s->cv.notify_all();
+#endif // CASADI_WITH_THREAD
+    });
+    return FunctionFuture(s);
+  }
+
+  FunctionFuture Function::call_async(const DMDict& arg) const {
+    return call_async(convert_in(arg));
+  }
+
+  bool FunctionFuture::ready() const {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(s_->mtx);
+#endif // CASADI_WITH_THREAD
+    return s_->done;
+  }
+
+  void FunctionFuture::wait() const {
+#ifdef CASADI_WITH_THREAD
+    std::unique_lock<std::mutex> lock(s_->mtx);
+    s_->cv.wait(lock, [this]() { return s_->done; });
+#endif // CASADI_WITH_THREAD
+  }
+
+  void FunctionFuture::cancel() {
+    s_->cancelled = true;
+  }
+
+  std::vector<DM> FunctionFuture::get() const {
+    wait();
+    if (s_->error) std::rethrow_exception(s_->error);
+    return s_->res;
+  }
+
+  DMDict FunctionFuture::get_dict() const {
+    return s_->f.convert_out(get());
+  }
+
   void CASADI_EXPORT _function_buffer_eval(void* raw) {
     static_cast<FunctionBuffer*>(raw)->_eval();
   }
@@ -29,6 +29,7 @@
 #include "mx.hpp"
 #include "printable.hpp"
 #include <exception>
+#include <memory>
 #include <stack>
 
 namespace casadi {
@@ -36,6 +37,8 @@ namespace casadi {
 #ifndef SWIG
   /** Forward declaration of internal class */
   class FunctionInternal;
+  class FunctionBuffer;
+  class FunctionFuture;
   class SerializingStream;
   class DeserializingStream;
 #endif // SWIG
@@ -526,6 +529,20 @@ namespace casadi {
     ///@}
 
 #ifndef SWIG
+    ///@{
+    /** \brief Evaluate numerically on the internal thread pool, without blocking
+
+        Memory is checked out by the evaluation as in call. The evaluation can be
+        cancelled with FunctionFuture::cancel, which takes effect at the next
+        interrupt check (InterruptHandler::check), e.g. between the iterations or
+        oracle calls of a solver. If only one thread is available
+        (GlobalOptions::setMaxNumThreads), the evaluation is performed before
+        returning.
+    */
+    FunctionFuture call_async(const std::vector<DM>& arg) const;
+    FunctionFuture call_async(const DMDict& arg) const;
+    ///@}
+
     /// Check if same as another function
     bool operator==(const Function& f) const;
 
@@ -632,11 +649,23 @@ namespace casadi {
         \identifier{1wg} */
     int rev(std::vector<bvec_t*> arg, std::vector<bvec_t*> res) const;
 
+    /** \brief Prepare repeated numerical evaluation with fixed buffers
+
+        Work vectors are allocated and memory is checked out once, and the
+        nonzeros of the inputs and outputs are read from and written to the
+        given buffers (null for none, missing trailing entries are null).
+        Each FunctionBuffer::eval then only calls the numerical kernel, bypassing
+        the checks of the generic evaluation. Buffers can be rebound with
+        FunctionBuffer::bind_arg and FunctionBuffer::bind_res.
+    */
+    FunctionBuffer prepare(const std::vector<const double*>& arg = {},
+                           const std::vector<double*>& res = {}) const;
+
 #endif // SWIG
 
     /** \brief  Evaluate symbolically in parallel and sum (matrix graph)
 
-        \param parallelization Type of parallelization used: unroll|serial|openmp
+        \param parallelization Type of parallelization used: unroll|serial|openmp|thread|simd|process
 
         \identifier{1wh} */
     std::vector<MX> mapsum(const std::vector<MX > &x,
@@ -682,6 +711,21 @@ namespace casadi {
 
         Set base to -1 to unroll all the way; no gains in memory efficiency here.
 
+        Set checkpoint to a segment length S>0 to group the iterations into
+        unrolled segments of length S that are called as opaque functions.
+        Reverse mode then only stores the N/S segment boundaries and recomputes
+        the intermediates of each segment during the backward sweep, trading
+        one extra forward evaluation for a work vector of order N/S+S
+        (choose S near sqrt(N) for long horizons).
+
+        Set scan to "parallel" to evaluate a recurrence that is affine in the
+        accumulated inputs, x_next = A(u)*x + b(u), as a parallel prefix scan:
+        the pairs (A, b) of all steps are composed in log2(N) levels of mapped
+        calls, after which all states follow from x0 independently. With "auto",
+        the scan is used only when the affine structure is detected, falling back
+        to sequential evaluation otherwise. The maps use the parallelization given
+        by scan_parallelization (default "thread").
+
         \identifier{1wi} */
     Function mapaccum(const std::string& name, casadi_int N, const Dict& opts = Dict()) const;
     Function mapaccum(const std::string& name, casadi_int N, casadi_int n_accum,
@@ -720,7 +764,7 @@ namespace casadi {
                 s_(N-1) <- f(a_(N-1), p_(N-1))
         \endverbatim
 
-        \param parallelization Type of parallelization used: unroll|serial|openmp
+        \param parallelization Type of parallelization used: unroll|serial|openmp|thread|simd|process
 
         \identifier{1wj} */
     Function map(casadi_int n, const std::string& parallelization="serial") const;
@@ -819,6 +863,23 @@ namespace casadi {
         \identifier{1wr} */
     Function reverse(casadi_int nadj) const;
 
+    /** \brief Get a function that calculates Taylor coefficients along a direction
+
+     *         Returns a function with <tt>2*n_in</tt> inputs and
+     *         <tt>(order+1)*n_out</tt> outputs.
+     *         The first <tt>n_in</tt> inputs correspond to nondifferentiated inputs x,
+     *         the last <tt>n_in</tt> inputs to the direction v.
+     *         Output <tt>d*n_out + i</tt> is the coefficient of t^d in the Taylor
+     *         expansion of output i of f(x + t*v), i.e. the d-th directional
+     *         derivative divided by d!.
+     *         All coefficients are calculated in a single sweep with
+     *         O(order^2) work per operation, rather than by nesting forward.
+     *         Currently only available for SX functions.
+     *
+     *        The functions returned are cached.
+     */
+    Function taylor(casadi_int order) const;
+
     /** \brief Get, if necessary generate, the sparsity of all Jacobian blocks
 
         \identifier{1ws} */
@@ -845,6 +906,8 @@ namespace casadi {
     std::string generate_dependencies(const std::string& fname, const Dict& opts=Dict()) const;
 
     /** \brief Export an input file that can be passed to generate C code with a main
+     *
+     * A file name ending in ".bin" selects a binary format instead of text, see nz_bin_write.
      *
      * \see generate_out
      * \see convert_in to convert between dict/map and vector
@@ -856,6 +919,8 @@ namespace casadi {
     /// @}
 
     /** \brief Export an output file that can be checked with generated C code output
+     *
+     * A file name ending in ".bin" selects a binary format instead of text, see nz_bin_write.
      *
      * \see generate_in
      * \see convert_out to convert between dict/map and vector
@@ -894,6 +959,11 @@ namespace casadi {
 
     /** \brief Save Function to a file
 
+        Options: "debug" (bool) adds type decorations,
+        "binary" (bool) writes a compact binary layout, which is loaded
+        from a memory-mapped file without per-element decoding,
+        "compression" (string) is "none" or "lz" for block compression.
+
         \see load
 
         \identifier{240} */
@@ -931,6 +1001,17 @@ namespace casadi {
     /// Get all statistics obtained at the end of the last evaluate call
     Dict stats(int mem=0) const;
 
+    /** \brief Report the memory footprint of the function
+
+        Returns a dictionary with the sizes of the work vectors, sparsity patterns and
+        instruction lists in bytes, the number of memory objects, and nested reports for
+        the dependencies and the cached derivative functions under "dependencies" and
+        "cache". A function reachable along several paths is only counted once, further
+        occurrences are reported with "shared" set. The entry "total_bytes" is the sum
+        over the function and everything it owns.
+    */
+    Dict memory_report() const;
+
     ///@{
     /** \brief Get symbolic primitives equivalent to the input expressions
 
@@ -1274,6 +1355,11 @@ namespace casadi {
     Function mapaccum(const std::string& name, const std::vector<Function>& chain,
                       casadi_int n_accum=1, const Dict& opts = Dict()) const;
 
+    /// Helper function for mapaccum, parallel prefix scan of an affine recurrence
+    Function mapaccum_scan(const std::string& name, casadi_int N, casadi_int n_accum,
+                           const std::string& parallelization, bool check,
+                           const Dict& opts) const;
+
 #ifdef WITH_EXTRA_CHECKS
     public:
     // How many times have we passed through
@@ -1330,6 +1416,18 @@ public:
 
       \identifier{1yc} */
   void set_res(casadi_int i, double* a, casadi_int size);
+
+#ifndef SWIG
+  /** \brief Evaluate with the bound buffers, returning the return value of the kernel */
+  int eval() { _eval(); return ret_;}
+
+  /** \brief Bind input buffer i, which must hold nnz_in(i) elements, or null */
+  void bind_arg(casadi_int i, const double* a);
+
+  /** \brief Bind output buffer i, which must hold nnz_out(i) elements, or null */
+  void bind_res(casadi_int i, double* a);
+#endif // SWIG
+
   /// Get last return value
   int ret();
   void _eval();
@@ -1338,6 +1436,36 @@ public:
 
 void CASADI_EXPORT _function_buffer_eval(void* raw);
 
+#ifndef SWIG
+/** \brief Result of an asynchronous evaluation, see Function::call_async */
+class CASADI_EXPORT FunctionFuture {
+public:
+  /// Shared state of the evaluation
+  struct State;
+
+  /// Constructor, use Function::call_async
+  explicit FunctionFuture(const std::shared_ptr<State>& s) : s_(s) {}
+
+  /// Has the evaluation finished?
+  bool ready() const;
+
+  /// Block until the evaluation has finished
+  void wait() const;
+
+  /// Request cancellation, the evaluation fails with KeyboardInterruptException
+  void cancel();
+
+  ///@{
+  /// Wait for the result, rethrowing any exception raised by the evaluation
+  std::vector<DM> get() const;
+  DMDict get_dict() const;
+  ///@}
+
+private:
+  std::shared_ptr<State> s_;
+};
+#endif // SWIG
+
 
 } // namespace casadi
 
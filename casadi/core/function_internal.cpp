@@ -26,6 +26,7 @@
 #include "function_internal.hpp"
 #include "casadi_call.hpp"
 #include "casadi_misc.hpp"
+#include "casadi_os.hpp"
 #include "global_options.hpp"
 #include "external.hpp"
 #include "finite_differences.hpp"
@@ -34,6 +35,8 @@
 #include "sx_function.hpp"
 #include "rootfinder_impl.hpp"
 #include "map.hpp"
+#include "thread_pool.hpp"
+#include "profiler.hpp"
 #include "mapsum.hpp"
 #include "switch.hpp"
 #include "interpolant_impl.hpp"
@@ -41,6 +44,7 @@
 #include "conic_impl.hpp"
 #include "integrator_impl.hpp"
 #include "external_impl.hpp"
+#include "importer_internal.hpp"
 #include "fmu_function.hpp"
 
 #include <cctype>
@@ -50,6 +54,16 @@
 #include <ctime>
 #endif // WITH_DL
 #include <iomanip>
+#include <fstream>
+#include <cstdio>
+#include <list>
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.condition_variable.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <condition_variable>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
 
 namespace casadi {
 
@@ -60,6 +74,7 @@ namespace casadi {
     record_time_ = false;
     regularity_check_ = false;
     error_on_fail_ = true;
+    init_mem_pool();
   }
 
   FunctionInternal::FunctionInternal(const std::string& name) : ProtoFunction(name) {
@@ -86,6 +101,13 @@ namespace casadi {
     jit_serialize_ = "source";
     jit_base_name_ = "jit_tmp";
     jit_temp_suffix_ = true;
+    jit_async_ = false;
+    jit_hot_calls_ = 0;
+    jit_hot_time_ = 0;
+    jit_hot_expand_ = false;
+    jit_hot_count_ = 0;
+    jit_hot_ns_ = 0;
+    jit_hot_started_ = false;
     compiler_plugin_ = CASADI_STR(CASADI_DEFAULT_COMPILER_PLUGIN);
 
     eval_ = nullptr;
@@ -115,14 +137,17 @@ namespace casadi {
   }
 
   ProtoFunction::~ProtoFunction() {
-    for (void* m : mem_) {
-      if (m!=nullptr) casadi_warning("Memory object has not been properly freed");
+    for (int k=0; k<n_mem_; ++k) {
+      if (mem_slot(k).mem!=nullptr) casadi_warning("Memory object has not been properly freed");
     }
-    mem_.clear();
+    for (auto&& b : mem_block_) delete[] b.load();
   }
 
   FunctionInternal::~FunctionInternal() {
-    if (jit_cleanup_ && jit_) {
+    // A background compilation removes the source itself when done, and
+    // sources compiled separately (OracleFunction's jit_parallel) are already gone
+    if (jit_cleanup_ && jit_ && compiler_plugin_!="llvm" && !jit_async_state_
+        && !compiler_.is_null()) {
       std::string jit_directory = get_from_dict(jit_options_, "directory", std::string(""));
       std::string jit_name = jit_directory + jit_name_ + ".c";
       if (remove(jit_name.c_str())) casadi_warning("Failed to remove " + jit_name);
@@ -137,10 +162,14 @@ namespace casadi {
     }
 
     // Make sure all options exist
-    get_options().check(opts);
+    {
+      ProfilerScope profile(this, "construct:options");
+      get_options().check(opts);
+    }
 
     // Initialize the class hierarchy
     try {
+      ProfilerScope profile(this, "construct:init");
       init(opts);
     } catch(std::exception& e) {
       casadi_error("Error calling " + class_name() + "::init for '" + name_ + "':\n"
@@ -149,6 +178,7 @@ namespace casadi {
 
     // Revisit class hierarchy in reverse order
     try {
+      ProfilerScope profile(this, "construct:finalize");
       finalize();
     } catch(std::exception& e) {
       casadi_error("Error calling " + class_name() + "::finalize for '" + name_ + "':\n"
@@ -235,6 +265,14 @@ namespace casadi {
       {"jit_serialize",
        {OT_STRING,
         "Specify behaviour when serializing a jitted function: SOURCE|link|embed."}},
+      {"jit_binaries",
+       {OT_DICT,
+        "Precompiled libraries for other targets, embedded in addition to the "
+        "jitted library when jit_serialize is 'embed'. Keys are target keys "
+        "<os>-<arch>[+feature..], e.g. 'linux-aarch64' or 'linux-x86_64+avx2+fma', "
+        "values are library file names. When deserializing, the best matching "
+        "library is loaded. If none matches, the function is evaluated without "
+        "compiled code."}},
       {"jit_name",
        {OT_STRING,
         "The file name used to write out code. "
@@ -246,6 +284,22 @@ namespace casadi {
         "This is desired for thread-safety. "
         "This behaviour may defeat caching compiler wrappers. "
         "Default: true"}},
+      {"jit_async",
+       {OT_BOOL,
+        "Compile in a background thread. Until the compiled code is ready, "
+        "the function is evaluated without it, e.g. by the SX/MX virtual machine. "
+        "Compiles synchronously if only one thread is available. Default: false"}},
+      {"jit_hot_calls",
+       {OT_INT,
+        "Tiered compilation: compile in the background, as for 'jit_async', "
+        "once the function has been evaluated this many times. Default: 0 (never)"}},
+      {"jit_hot_time",
+       {OT_DOUBLE,
+        "Tiered compilation: compile in the background, as for 'jit_async', "
+        "once the cumulative evaluation time exceeds this many seconds. Default: 0 (never)"}},
+      {"jit_hot_expand",
+       {OT_BOOL,
+        "Tiered compilation: expand MX functions to SX before compiling. Default: false"}},
       {"compiler",
        {OT_STRING,
         "Just-in-time compiler plugin to be used."}},
@@ -308,7 +362,9 @@ namespace casadi {
         "Directory to dump inputs/outputs to. Make sure the directory exists [.]"}},
       {"dump_format",
        {OT_STRING,
-        "Choose file format to dump matrices. See DM.from_file [mtx]"}},
+        "Choose file format to dump matrices. See DM.from_file [mtx]. "
+        "With 'bin', all inputs (outputs) of a call are instead dumped to a single binary "
+        "file <name>.<id>.in.bin (.out.bin), readable with generate_in (generate_out)"}},
       {"forward_options",
        {OT_DICT,
         "Options to be passed to a forward mode constructor"}},
@@ -383,6 +439,10 @@ namespace casadi {
     opts["jit_options"] = jit_options_;
     opts["jit_name"] = jit_base_name_;
     opts["jit_temp_suffix"] = jit_temp_suffix_;
+    opts["jit_async"] = jit_async_;
+    opts["jit_hot_calls"] = jit_hot_calls_;
+    opts["jit_hot_time"] = jit_hot_time_;
+    opts["jit_hot_expand"] = jit_hot_expand_;
     opts["ad_weight"] = ad_weight_;
     opts["ad_weight_sp"] = ad_weight_sp_;
     opts["always_inline"] = always_inline_;
@@ -467,6 +527,9 @@ namespace casadi {
         jit_serialize_ = op.second.to_string();
         casadi_assert(jit_serialize_=="source" || jit_serialize_=="link" || jit_serialize_=="embed",
           "jit_serialize option not understood. Pick one of source, link, embed.");
+      } else if (op.first=="jit_binaries") {
+        jit_binaries_.clear();
+        for (auto&& e : op.second.to_dict()) jit_binaries_[e.first] = e.second.to_string();
       } else if (op.first=="compiler") {
         compiler_plugin_ = op.second.to_string();
       } else if (op.first=="jit_options") {
@@ -475,6 +538,14 @@ namespace casadi {
         jit_base_name_ = op.second.to_string();
       } else if (op.first=="jit_temp_suffix") {
         jit_temp_suffix_ = op.second;
+      } else if (op.first=="jit_async") {
+        jit_async_ = op.second;
+      } else if (op.first=="jit_hot_calls") {
+        jit_hot_calls_ = op.second;
+      } else if (op.first=="jit_hot_time") {
+        jit_hot_time_ = op.second;
+      } else if (op.first=="jit_hot_expand") {
+        jit_hot_expand_ = op.second;
       } else if (op.first=="derivative_of") {
         derivative_of_ = op.second;
       } else if (op.first=="ad_weight") {
@@ -675,8 +746,41 @@ namespace casadi {
     return "o" + str(i);
   }
 
+  struct JitAsync {
+    // Set when the compilation has finished, successfully or not
+    std::atomic<bool> ready;
+    // Compiled code, valid once ready
+    Importer compiler;
+    eval_t eval;
+    casadi_checkout_t checkout;
+    casadi_release_t release;
+    // Error message if compilation failed
+    std::string error;
+#ifdef CASADI_WITH_THREAD
+    // For waiting on completion
+    std::mutex mtx;
+    std::condition_variable cv;
+#endif // CASADI_WITH_THREAD
+    JitAsync() : ready(false), eval(nullptr), checkout(nullptr), release(nullptr) {}
+  };
+
   void FunctionInternal::finalize() {
-    if (jit_) {
+    if (jit_ && compiler_plugin_=="llvm") {
+      // Compile in memory, without C code generation
+      casadi_assert(has_llvm(), "Function '" + name_ + "' of type " + class_name()
+        + " cannot be just-in-time compiled with the 'llvm' plugin.");
+      casadi_assert(jit_serialize_=="source",
+        "The 'llvm' plugin only supports jit_serialize 'source'.");
+      if (compiler_.is_null()) {
+        if (verbose_) casadi_message("Compiling function '" + name_ + "' to LLVM IR..");
+        Dict opts = jit_options_;
+        opts["ir"] = llvm_ir(name_);
+        compiler_ = Importer(name_, compiler_plugin_, opts);
+        if (verbose_) casadi_message("Compiling function '" + name_ + "' done.");
+      }
+      eval_ = (eval_t) compiler_.get_function(name_);
+      casadi_assert(eval_!=nullptr, "Cannot load JIT'ed function.");
+    } else if (jit_) {
       jit_name_ = jit_base_name_;
       if (jit_temp_suffix_) {
         jit_name_ = temporary_file(jit_name_, ".c");
@@ -691,20 +795,33 @@ namespace casadi {
           opts["prefix"] = "jit";
           CodeGenerator gen(jit_name_, opts);
           gen.add(self());
-          if (verbose_) casadi_message("Compiling function '" + name_ + "'..");
           std::string jit_directory = get_from_dict(jit_options_, "directory", std::string(""));
-          compiler_ = Importer(gen.generate(jit_directory), compiler_plugin_, jit_options_);
-          if (verbose_) casadi_message("Compiling function '" + name_ + "' done.");
+          if (jit_async_) {
+            jit_async_start(gen.generate(jit_directory));
+          } else {
+            if (verbose_) casadi_message("Compiling function '" + name_ + "'..");
+            compiler_ = Importer(gen.generate(jit_directory), compiler_plugin_, jit_options_);
+            if (verbose_) casadi_message("Compiling function '" + name_ + "' done.");
+          }
+        }
+        if (!compiler_.is_null()) {
+          // Try to load
+          eval_ = (eval_t) compiler_.get_function(name_);
+          checkout_ = (casadi_checkout_t) compiler_.get_function(name_ + "checkout");
+          release_ = (casadi_release_t) compiler_.get_function(name_ + "release");
+          casadi_assert(eval_!=nullptr, "Cannot load JIT'ed function.");
         }
-        // Try to load
-        eval_ = (eval_t) compiler_.get_function(name_);
-        checkout_ = (casadi_checkout_t) compiler_.get_function(name_ + "checkout");
-        release_ = (casadi_release_t) compiler_.get_function(name_ + "release");
-        casadi_assert(eval_!=nullptr, "Cannot load JIT'ed function.");
       } else {
         // Just jit dependencies
         jit_dependencies(jit_name_);
       }
+    } else if ((jit_hot_calls_>0 || jit_hot_time_>0) && has_codegen()) {
+      // Tiered compilation, prepare for switching to compiled code from eval_gen
+      if (compiler_plugin_=="llvm") {
+        casadi_warning("Tiered compilation is not supported by the 'llvm' plugin.");
+      } else {
+        jit_async_state_ = std::make_shared<JitAsync>();
+      }
     }
 
     // Finalize base classes
@@ -714,6 +831,85 @@ namespace casadi {
     if (dump_) dump();
   }
 
+  void FunctionInternal::jit_async_start(const std::string& source) {
+    // The state already exists for tiered compilation
+    if (!jit_async_state_) jit_async_state_ = std::make_shared<JitAsync>();
+    auto state = jit_async_state_;
+    // Plugins must be loaded from the calling thread
+    ImporterInternal::getPlugin(compiler_plugin_);
+    std::string plugin = compiler_plugin_, name = name_;
+    Dict jit_options = jit_options_;
+    bool verbose = verbose_, cleanup = jit_cleanup_;
+    if (verbose_) casadi_message("Compiling function '" + name_ + "' in the background..");
+    // The task holds no reference to the function, which may be destroyed first
+    ThreadPool::instance().submit([=]() {
+      try {
+        state->compiler = Importer(source, plugin, jit_options);
+        state->eval = (eval_t) state->compiler.get_function(name);
+        state->checkout = (casadi_checkout_t) state->compiler.get_function(name + "checkout");
+        state->release = (casadi_release_t) state->compiler.get_function(name + "release");
+        if (!state->eval) state->error = "Cannot load JIT'ed function.";
+      } catch (std::exception& e) {
+        state->error = e.what();
+      }
+      if (cleanup && remove(source.c_str())) casadi_warning("Failed to remove " + source);
+      if (state->error.empty()) {
+        if (verbose) casadi_message("Compiling function '" + name + "' done.");
+      } else {
+        casadi_warning("Background compilation of '" + name + "' failed, "
+          "continuing without compiled code: " + state->error);
+      }
+      // Publish, evaluation switches to the compiled code
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(state->mtx);
+#endif // CASADI_WITH_THREAD
+      state->ready.store(true, std::memory_order_release);
+#ifdef CASADI_WITH_THREAD
+      state->cv.notify_all();
+#endif // CASADI_WITH_THREAD
+    });
+  }
+
+  void FunctionInternal::jit_hot_start() const {
+    if (verbose_) casadi_message("Function '" + name_ + "' is hot.");
+    try {
+      std::string jit_name = jit_base_name_;
+      if (jit_temp_suffix_) {
+        jit_name = temporary_file(jit_name, ".c");
+        jit_name = std::string(jit_name.begin(), jit_name.begin()+jit_name.size()-2);
+      }
+      Function f = self();
+      if (jit_hot_expand_ && is_a("MXFunction", false)) {
+        try {
+          f = f.expand(name_);
+        } catch (std::exception& e) {
+          casadi_warning("Could not expand '" + name_ + "', compiling as is: " + e.what());
+        }
+      }
+      Dict opts;
+      opts["prefix"] = "jit";
+      CodeGenerator gen(jit_name, opts);
+      gen.add(f);
+      std::string jit_directory = get_from_dict(jit_options_, "directory", std::string(""));
+      // Does not modify the shared state pointer, which already exists
+      const_cast<FunctionInternal*>(this)->jit_async_start(gen.generate(jit_directory));
+    } catch (std::exception& e) {
+      casadi_warning("Tiered compilation of '" + name_ + "' failed, "
+        "continuing without compiled code: " + std::string(e.what()));
+    }
+  }
+
+  const Importer& FunctionInternal::jit_async_wait() const {
+    JitAsync& state = *jit_async_state_;
+#ifdef CASADI_WITH_THREAD
+    std::unique_lock<std::mutex> lock(state.mtx);
+    state.cv.wait(lock, [&state]() { return state.ready.load(); });
+#endif // CASADI_WITH_THREAD
+    casadi_assert(state.error.empty(),
+      "Background compilation of '" + name_ + "' failed: " + state.error);
+    return state.compiler;
+  }
+
   void ProtoFunction::finalize() {
     // Create memory object
     int mem = checkout();
@@ -721,6 +917,16 @@ namespace casadi {
   }
 
   void FunctionInternal::generate_in(const std::string& fname, const double** arg) const {
+    if (is_nz_bin(fname)) {
+      std::vector<double> d;
+      d.reserve(nnz_in());
+      for (casadi_int i=0; i<n_in_; ++i) {
+        const double* v = arg[i];
+        for (casadi_int k=0;k<nnz_in(i);++k) d.push_back(v ? v[k] : 0);
+      }
+      return nz_bin_write(fname, d);
+    }
+
     // Set up output stream
     std::ofstream of(fname);
     casadi_assert(of.good(), "Error opening stream '" + fname + "'.");
@@ -737,6 +943,18 @@ namespace casadi {
   }
 
   void FunctionInternal::generate_out(const std::string& fname, double** res) const {
+    if (is_nz_bin(fname)) {
+      std::vector<double> d;
+      d.reserve(nnz_out());
+      for (casadi_int i=0; i<n_out_; ++i) {
+        const double* v = res[i];
+        for (casadi_int k=0;k<nnz_out(i);++k) {
+          d.push_back(v ? v[k] : std::numeric_limits<double>::quiet_NaN());
+        }
+      }
+      return nz_bin_write(fname, d);
+    }
+
     // Set up output stream
     std::ofstream of(fname);
     casadi_assert(of.good(), "Error opening stream '" + fname + "'.");
@@ -756,6 +974,10 @@ namespace casadi {
     std::stringstream ss;
     ss << std::setfill('0') << std::setw(6) << id;
     std::string count = ss.str();
+    if (dump_format_=="bin") {
+      // All inputs in a single binary file
+      return generate_in(dump_dir_+ filesep() + name_ + "." + count + ".in.bin", arg);
+    }
     for (casadi_int i=0;i<n_in_;++i) {
       DM::to_file(dump_dir_+ filesep() + name_ + "." + count + ".in." + name_in_[i] + "." +
         dump_format_, sparsity_in_[i], arg[i]);
@@ -767,6 +989,10 @@ namespace casadi {
     std::stringstream ss;
     ss << std::setfill('0') << std::setw(6) << id;
     std::string count = ss.str();
+    if (dump_format_=="bin") {
+      // All outputs in a single binary file
+      return generate_out(dump_dir_+ filesep() + name_ + "." + count + ".out.bin", res);
+    }
     for (casadi_int i=0;i<n_out_;++i) {
       DM::to_file(dump_dir_+ filesep() + name_ + "." + count + ".out." + name_out_[i] + "." +
         dump_format_, sparsity_out_[i], res[i]);
@@ -824,6 +1050,7 @@ namespace casadi {
 
   int FunctionInternal::
   eval_gen(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    ProfilerScope profile(this);
     casadi_int dump_id = (dump_in_ || dump_out_ || dump_) ? get_dump_id() : 0;
     if (dump_in_) dump_in(dump_id, arg);
     if (dump_ && dump_id==0) dump();
@@ -834,24 +1061,47 @@ namespace casadi {
     for (auto&& s : m->fstats) s.second.reset();
     if (m->t_total) m->t_total->tic();
     int ret;
-    if (eval_) {
+    // Tiered compilation: track evaluations until hot
+    bool jit_hot_track = !jit_ && jit_async_state_ && !jit_hot_started_.load();
+    std::chrono::steady_clock::time_point jit_hot_t0;
+    if (jit_hot_track && jit_hot_time_>0) jit_hot_t0 = std::chrono::steady_clock::now();
+    // Compiled code, possibly just finished in the background
+    eval_t jit_eval = eval_;
+    casadi_checkout_t jit_checkout = checkout_;
+    casadi_release_t jit_release = release_;
+    if (!jit_eval && jit_async_state_ && jit_async_state_->ready.load(std::memory_order_acquire)) {
+      jit_eval = jit_async_state_->eval;
+      jit_checkout = jit_async_state_->checkout;
+      jit_release = jit_async_state_->release;
+    }
+    if (jit_eval) {
       int mem = 0;
-      if (checkout_) {
+      if (jit_checkout) {
 #ifdef CASADI_WITH_THREAD
     std::lock_guard<std::mutex> lock(mtx_);
 #endif //CASADI_WITH_THREAD
-        mem = checkout_();
+        mem = jit_checkout();
       }
-      ret = eval_(arg, res, iw, w, mem);
-      if (release_) {
+      ret = jit_eval(arg, res, iw, w, mem);
+      if (jit_release) {
 #ifdef CASADI_WITH_THREAD
     std::lock_guard<std::mutex> lock(mtx_);
 #endif //CASADI_WITH_THREAD
-        release_(mem);
+        jit_release(mem);
       }
     } else {
       ret = eval(arg, res, iw, w, mem);
     }
+    if (jit_hot_track) {
+      bool hot = jit_hot_calls_>0 && ++jit_hot_count_>=jit_hot_calls_;
+      if (jit_hot_time_>0) {
+        int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - jit_hot_t0).count();
+        hot = (jit_hot_ns_ += ns) >= jit_hot_time_*1e9 || hot;
+      }
+      // Only one thread triggers the compilation
+      if (hot && !jit_hot_started_.exchange(true)) jit_hot_start();
+    }
     if (m->t_total) m->t_total->toc();
     // Show statistics
     print_time(m->fstats);
@@ -951,6 +1201,9 @@ namespace casadi {
   Dict FunctionInternal::cache() const {
     // Return value
     Dict ret;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREAD
     // Add all Function instances that haven't been deleted
     for (auto&& cf : cache_) {
       if (cf.second.alive()) {
@@ -968,29 +1221,6 @@ namespace casadi {
     return ret;
   }
 
-  bool FunctionInternal::incache(const std::string& fname, Function& f,
-      const std::string& suffix) const {
-    auto it = cache_.find(fname + ":" + suffix);
-    if (it!=cache_.end() && it->second.alive()) {
-      f = shared_cast<Function>(it->second.shared());
-      return true;
-    } else {
-      return false;
-    }
-  }
-
-  void FunctionInternal::tocache(const Function& f, const std::string& suffix) const {
-    // Add to cache
-    cache_.insert(std::make_pair(f.name() + ":" + suffix, f));
-    // Remove a lost reference, if any, to prevent uncontrolled growth
-    for (auto it = cache_.begin(); it!=cache_.end(); ++it) {
-      if (!it->second.alive()) {
-        cache_.erase(it);
-        break; // just one dead reference is enough
-      }
-    }
-  }
-
   Function FunctionInternal::map(casadi_int n, const std::string& parallelization) const {
     Function f;
     if (parallelization=="serial") {
@@ -1115,100 +1345,230 @@ namespace casadi {
     }
   };
 
+  // Seed directions of one sweep in hierarchical sparsity detection
+  struct JacSparsitySweep {
+    // Seeds to toggle, as (begin, end, bit) triplets
+    std::vector<casadi_int> toggle;
+    // Offset from bit to fine block, for each bit and coarse block
+    IM lookup;
+  };
+
+  // Propagate the sweeps of a hierarchical refinement level and collect the triplets
+  template<bool fwd>
+  void jac_sparsity_sweeps(const FunctionInternal *f, casadi_int oind, casadi_int iind,
+                           const std::vector<JacSparsitySweep>& sweeps,
+                           const std::vector<casadi_int>& coarse,
+                           const std::vector<casadi_int>& fine,
+                           const std::vector<casadi_int>& fine_lookup, bool symm, void* mem,
+                           std::vector<casadi_int>& jrow, std::vector<casadi_int>& jcol) {
+    // Sweeps are independent: distribute contiguous chunks over the threads
+    casadi_int n_sweep = sweeps.size(), n_chunk = 1;
+    if (n_sweep>1 && f->has_sp_threadsafe()) {
+      n_chunk = std::min(n_sweep, ThreadPool::instance().size());
+    }
+
+    // Triplets, per chunk
+    std::vector< std::vector<casadi_int> > jrow_k(n_chunk), jcol_k(n_chunk);
+
+    ThreadPool::instance().run(n_chunk, [&](casadi_int k) {
+      // Seeds and sensitivities
+      std::vector<bvec_t> s_in(f->nnz_in(iind), 0);
+      std::vector<bvec_t> s_out(f->nnz_out(oind), 0);
+      bvec_t* seed_v = fwd ? get_ptr(s_in) : get_ptr(s_out);
+      bvec_t* sens_v = fwd ? get_ptr(s_out) : get_ptr(s_in);
+
+      // Evaluation buffers
+      std::vector<typename JacSparsityTraits<fwd>::arg_t> arg(f->sz_arg(), nullptr);
+      arg[iind] = get_ptr(s_in);
+      std::vector<bvec_t*> res(f->sz_res(), nullptr);
+      res[oind] = get_ptr(s_out);
+      std::vector<casadi_int> iw(f->sz_iw());
+      std::vector<bvec_t> w(f->sz_w());
+
+      // Triplets found by this chunk
+      std::vector<casadi_int>& jrow = jrow_k[k];
+      std::vector<casadi_int>& jcol = jcol_k[k];
+
+      for (casadi_int s=(k*n_sweep)/n_chunk; s<((k+1)*n_sweep)/n_chunk; ++s) {
+        const JacSparsitySweep& sw = sweeps[s];
+
+        // Toggle on seeds
+        for (casadi_int i=0; i<sw.toggle.size(); i+=3) {
+          bvec_toggle(seed_v, sw.toggle[i], sw.toggle[i+1], sw.toggle[i+2]);
+        }
+
+        // Propagate the dependencies
+        if (!fwd) std::fill(w.begin(), w.end(), 0);
+        JacSparsityTraits<fwd>::sp(f, get_ptr(arg), get_ptr(res),
+          get_ptr(iw), get_ptr(w), mem);
+
+        // Temporary bit work vector
+        bvec_t spsens;
+
+        // Loop over the cols of coarse blocks
+        for (casadi_int cri=0; cri<coarse.size()-1; ++cri) {
+
+          // Loop over the cols of fine blocks within the current coarse block
+          for (casadi_int fri=fine_lookup[coarse[cri]]; fri<fine_lookup[coarse[cri+1]]; ++fri) {
+            // Lump individual sensitivities together into fine block
+            bvec_or(sens_v, spsens, fine[fri], fine[fri+1]);
+
+            // Next iteration if no sparsity
+            if (!spsens) continue;
+
+            // Loop over all bvec_bits
+            for (casadi_int bvec_i=0; bvec_i<bvec_size; ++bvec_i) {
+              if (spsens & (bvec_t(1) << bvec_i)) {
+                // if dependency is found, add it to the new sparsity pattern
+                casadi_int ind = sw.lookup.sparsity().get_nz(bvec_i, cri);
+                if (ind==-1) continue;
+                casadi_int lk = sw.lookup->at(ind);
+                if (!symm) {
+                  jrow.push_back(bvec_i+lk);
+                  jcol.push_back(fri);
+                } else if (lk>-bvec_size) {
+                  jrow.push_back(bvec_i+lk);
+                  jcol.push_back(fri);
+                  jrow.push_back(fri);
+                  jcol.push_back(bvec_i+lk);
+                }
+              }
+            }
+          }
+        }
+
+        // Clear the seeds and sensitivities, ready for next bvec sweep
+        std::fill(s_in.begin(), s_in.end(), 0);
+        std::fill(s_out.begin(), s_out.end(), 0);
+      }
+    });
+
+    // Collect the triplets, in sweep order
+    for (casadi_int k=0; k<n_chunk; ++k) {
+      jrow.insert(jrow.end(), jrow_k[k].begin(), jrow_k[k].end());
+      jcol.insert(jcol.end(), jcol_k[k].begin(), jcol_k[k].end());
+    }
+  }
+
   template<bool fwd>
   Sparsity FunctionInternal::get_jac_sparsity_gen(casadi_int oind, casadi_int iind) const {
     // Number of nonzero inputs and outputs
     casadi_int nz_in = nnz_in(iind);
     casadi_int nz_out = nnz_out(oind);
 
-    // Evaluation buffers
-    std::vector<typename JacSparsityTraits<fwd>::arg_t> arg(sz_arg(), nullptr);
-    std::vector<bvec_t*> res(sz_res(), nullptr);
-    std::vector<casadi_int> iw(sz_iw());
-    std::vector<bvec_t> w(sz_w(), 0);
-
-    // Seeds and sensitivities
-    std::vector<bvec_t> seed(nz_in, 0);
-    arg[iind] = get_ptr(seed);
-    std::vector<bvec_t> sens(nz_out, 0);
-    res[oind] = get_ptr(sens);
-    if (!fwd) std::swap(seed, sens);
+    // Number of seed directions
+    casadi_int nz_seed = fwd ? nz_in : nz_out;
 
     // Number of forward sweeps we must make
-    casadi_int nsweep = seed.size() / bvec_size;
-    if (seed.size() % bvec_size) nsweep++;
+    casadi_int nsweep = nz_seed / bvec_size;
+    if (nz_seed % bvec_size) nsweep++;
 
     // Print
     if (verbose_) {
       casadi_message(str(nsweep) + std::string(fwd ? " forward" : " reverse") + " sweeps "
-                     "needed for " + str(seed.size()) + " directions");
+                     "needed for " + str(nz_seed) + " directions");
     }
 
-    // Progress
-    casadi_int progress = -10;
+    // Sweeps are independent: distribute contiguous chunks over the threads
+    casadi_int n_chunk = 1;
+    if (nsweep>1 && has_sp_threadsafe()) {
+      n_chunk = std::min(nsweep, ThreadPool::instance().size());
+    }
 
-    // Temporary vectors
-    std::vector<casadi_int> jcol, jrow;
+    // Temporary vectors, per chunk
+    std::vector< std::vector<casadi_int> > jcol_k(n_chunk), jrow_k(n_chunk);
 
-    // Loop over the variables, bvec_size variables at a time
-    for (casadi_int s=0; s<nsweep; ++s) {
+    ThreadPool::instance().run(n_chunk, [&](casadi_int k) {
+      // Sweeps handled by this chunk
+      casadi_int s_begin = (k*nsweep)/n_chunk, s_end = ((k+1)*nsweep)/n_chunk;
 
-      // Print progress
-      if (verbose_) {
-        casadi_int progress_new = (s*100)/nsweep;
-        // Print when entering a new decade
-        if (progress_new / 10 > progress / 10) {
-          progress = progress_new;
-          casadi_message(str(progress) + " %");
-        }
-      }
+      // Evaluation buffers
+      std::vector<typename JacSparsityTraits<fwd>::arg_t> arg(sz_arg(), nullptr);
+      std::vector<bvec_t*> res(sz_res(), nullptr);
+      std::vector<casadi_int> iw(sz_iw());
+      std::vector<bvec_t> w(sz_w(), 0);
 
-      // Nonzero offset
-      casadi_int offset = s*bvec_size;
+      // Seeds and sensitivities
+      std::vector<bvec_t> seed(nz_in, 0);
+      arg[iind] = get_ptr(seed);
+      std::vector<bvec_t> sens(nz_out, 0);
+      res[oind] = get_ptr(sens);
+      if (!fwd) std::swap(seed, sens);
 
-      // Number of local seed directions
-      casadi_int ndir_local = seed.size()-offset;
-      ndir_local = std::min(static_cast<casadi_int>(bvec_size), ndir_local);
+      // Progress
+      casadi_int progress = -10;
 
-      for (casadi_int i=0; i<ndir_local; ++i) {
-        seed[offset+i] |= bvec_t(1)<<i;
-      }
+      // Triplets found by this chunk
+      std::vector<casadi_int>& jcol = jcol_k[k];
+      std::vector<casadi_int>& jrow = jrow_k[k];
 
-      // Propagate the dependencies
-      JacSparsityTraits<fwd>::sp(this, get_ptr(arg), get_ptr(res),
-                                  get_ptr(iw), get_ptr(w), memory(0));
+      // Loop over the variables, bvec_size variables at a time
+      for (casadi_int s=s_begin; s<s_end; ++s) {
 
-      // Loop over the nonzeros of the output
-      for (casadi_int el=0; el<sens.size(); ++el) {
+        // Print progress, of the first chunk only
+        if (verbose_ && k==0) {
+          casadi_int progress_new = ((s-s_begin)*100)/(s_end-s_begin);
+          // Print when entering a new decade
+          if (progress_new / 10 > progress / 10) {
+            progress = progress_new;
+            casadi_message(str(progress) + " %");
+          }
+        }
+
+        // Nonzero offset
+        casadi_int offset = s*bvec_size;
 
-        // Get the sparsity sensitivity
-        bvec_t spsens = sens[el];
+        // Number of local seed directions
+        casadi_int ndir_local = seed.size()-offset;
+        ndir_local = std::min(static_cast<casadi_int>(bvec_size), ndir_local);
 
-        if (!fwd) {
-          // Clear the sensitivities for the next sweep
-          sens[el] = 0;
+        for (casadi_int i=0; i<ndir_local; ++i) {
+          seed[offset+i] |= bvec_t(1)<<i;
         }
 
-        // If there is a dependency in any of the directions
-        if (spsens!=0) {
+        // Propagate the dependencies
+        JacSparsityTraits<fwd>::sp(this, get_ptr(arg), get_ptr(res),
+                                    get_ptr(iw), get_ptr(w), memory(0));
+
+        // Loop over the nonzeros of the output
+        for (casadi_int el=0; el<sens.size(); ++el) {
+
+          // Get the sparsity sensitivity
+          bvec_t spsens = sens[el];
 
-          // Loop over seed directions
-          for (casadi_int i=0; i<ndir_local; ++i) {
+          if (!fwd) {
+            // Clear the sensitivities for the next sweep
+            sens[el] = 0;
+          }
+
+          // If there is a dependency in any of the directions
+          if (spsens!=0) {
+
+            // Loop over seed directions
+            for (casadi_int i=0; i<ndir_local; ++i) {
 
-            // If dependents on the variable
-            if ((bvec_t(1) << i) & spsens) {
-              // Add to pattern
-              jcol.push_back(el);
-              jrow.push_back(i+offset);
+              // If dependents on the variable
+              if ((bvec_t(1) << i) & spsens) {
+                // Add to pattern
+                jcol.push_back(el);
+                jrow.push_back(i+offset);
+              }
             }
           }
         }
-      }
 
-      // Remove the seeds
-      for (casadi_int i=0; i<ndir_local; ++i) {
-        seed[offset+i] = 0;
+        // Remove the seeds
+        for (casadi_int i=0; i<ndir_local; ++i) {
+          seed[offset+i] = 0;
+        }
       }
+    });
+
+    // Collect the triplets, in sweep order
+    std::vector<casadi_int> jcol, jrow;
+    for (casadi_int k=0; k<n_chunk; ++k) {
+      jcol.insert(jcol.end(), jcol_k[k].begin(), jcol_k[k].end());
+      jrow.insert(jrow.end(), jrow_k[k].begin(), jrow_k[k].end());
     }
 
     // Construct sparsity pattern and return
@@ -1229,20 +1589,6 @@ namespace casadi {
     casadi_int nz = nnz_in(iind);
     casadi_assert_dev(nz==nnz_out(oind));
 
-    // Evaluation buffers
-    std::vector<const bvec_t*> arg(sz_arg(), nullptr);
-    std::vector<bvec_t*> res(sz_res(), nullptr);
-    std::vector<casadi_int> iw(sz_iw());
-    std::vector<bvec_t> w(sz_w());
-
-    // Seeds
-    std::vector<bvec_t> seed(nz, 0);
-    arg[iind] = get_ptr(seed);
-
-    // Sensitivities
-    std::vector<bvec_t> sens(nz, 0);
-    res[oind] = get_ptr(sens);
-
     // Sparsity triplet accumulator
     std::vector<casadi_int> jcol, jrow;
 
@@ -1281,9 +1627,6 @@ namespace casadi {
           + str(D.size2()) + " <-> " + str(D.size1()));
       }
 
-      // Clear the seeds
-      std::fill(seed.begin(), seed.end(), 0);
-
       // Subdivide the coarse block
       for (casadi_int k=0; k<coarse.size()-1; ++k) {
         casadi_int diff = coarse[k+1]-coarse[k];
@@ -1307,6 +1650,12 @@ namespace casadi {
       std::vector<casadi_int> lookup_row;
       std::vector<casadi_int> lookup_value;
 
+      // Seeds of the current sweep
+      std::vector<casadi_int> toggle;
+
+      // Sweeps of this level
+      std::vector<JacSparsitySweep> sweeps;
+
       // The maximum number of fine blocks contained in one coarse block
       casadi_int n_fine_blocks_max = 0;
       for (casadi_int i=0;i<coarse.size()-1;++i) {
@@ -1354,8 +1703,9 @@ namespace casadi {
               }
 
               // Toggle on seeds
-              bvec_toggle(get_ptr(seed), fine[fci+fci_start], fine[fci+fci_start+1],
-                          bvec_i+bvec_i_mod);
+              toggle.push_back(fine[fci+fci_start]);
+              toggle.push_back(fine[fci+fci_start+1]);
+              toggle.push_back(bvec_i+bvec_i_mod);
               bvec_i_mod++;
             }
           }
@@ -1365,7 +1715,7 @@ namespace casadi {
 
           // Check if bvec buffer is full
           if (bvec_i==bvec_size || csd==D.size2()-1) {
-            // Calculate sparsity for bvec_size directions at once
+            // Sweep for bvec_size directions at once
 
             // Statistics
             nsweeps+=1;
@@ -1383,41 +1733,9 @@ namespace casadi {
             duplicates = sparsify(duplicates);
             lookup(duplicates.sparsity()) = -bvec_size;
 
-            // Propagate the dependencies
-            JacSparsityTraits<true>::sp(this, get_ptr(arg), get_ptr(res),
-              get_ptr(iw), get_ptr(w), nullptr);
-
-            // Temporary bit work vector
-            bvec_t spsens;
-
-            // Loop over the cols of coarse blocks
-            for (casadi_int cri=0; cri<coarse.size()-1; ++cri) {
-
-              // Loop over the cols of fine blocks within the current coarse block
-              for (casadi_int fri=fine_lookup[coarse[cri]];fri<fine_lookup[coarse[cri+1]];++fri) {
-                // Lump individual sensitivities together into fine block
-                bvec_or(get_ptr(sens), spsens, fine[fri], fine[fri+1]);
-
-                // Loop over all bvec_bits
-                for (casadi_int bvec_i=0;bvec_i<bvec_size;++bvec_i) {
-                  if (spsens & (bvec_t(1) << bvec_i)) {
-                    // if dependency is found, add it to the new sparsity pattern
-                    casadi_int ind = lookup.sparsity().get_nz(bvec_i, cri);
-                    if (ind==-1) continue;
-                    casadi_int lk = lookup->at(ind);
-                    if (lk>-bvec_size) {
-                      jrow.push_back(bvec_i+lk);
-                      jcol.push_back(fri);
-                      jrow.push_back(fri);
-                      jcol.push_back(bvec_i+lk);
-                    }
-                  }
-                }
-              }
-            }
-
-            // Clear the forward seeds/adjoint sensitivities, ready for next bvec sweep
-            std::fill(seed.begin(), seed.end(), 0);
+            // Save sweep, to be propagated below
+            sweeps.push_back(JacSparsitySweep{toggle, lookup});
+            toggle.clear();
 
             // Clean lookup table
             lookup_col.clear();
@@ -1435,6 +1753,10 @@ namespace casadi {
         }
       }
 
+      // Propagate the dependencies
+      jac_sparsity_sweeps<true>(this, oind, iind, sweeps, coarse, fine, fine_lookup, true,
+                                nullptr, jrow, jcol);
+
       // Construct fine sparsity pattern
       r = Sparsity::triplet(fine.size()-1, fine.size()-1, jrow, jcol);
 
@@ -1463,19 +1785,6 @@ namespace casadi {
     // Number of nonzero outputs
     casadi_int nz_out = nnz_out(oind);
 
-    // Seeds and sensitivities
-    std::vector<bvec_t> s_in(nz_in, 0);
-    std::vector<bvec_t> s_out(nz_out, 0);
-
-    // Evaluation buffers
-    std::vector<const bvec_t*> arg_fwd(sz_arg(), nullptr);
-    std::vector<bvec_t*> arg_adj(sz_arg(), nullptr);
-    arg_fwd[iind] = arg_adj[iind] = get_ptr(s_in);
-    std::vector<bvec_t*> res(sz_res(), nullptr);
-    res[oind] = get_ptr(s_out);
-    std::vector<casadi_int> iw(sz_iw());
-    std::vector<bvec_t> w(sz_w());
-
     // Sparsity triplet accumulator
     std::vector<casadi_int> jcol, jrow;
 
@@ -1508,13 +1817,6 @@ namespace casadi {
     // Get weighting factor
     double sp_w = sp_weight();
 
-    // Lookup table for bvec_t
-    std::vector<bvec_t> bvec_lookup;
-    bvec_lookup.reserve(bvec_size);
-    for (casadi_int i=0;i<bvec_size;++i) {
-      bvec_lookup.push_back(bvec_t(1) << i);
-    }
-
     while (!hasrun || coarse_col.size()!=nz_out+1 || coarse_row.size()!=nz_in+1) {
       if (verbose_) {
         casadi_message("Block size: " + str(granularity_col) + " x " + str(granularity_row));
@@ -1553,17 +1855,10 @@ namespace casadi {
             "(fwd cost: " + str(fwd_cost) + ", adj cost: " + str(adj_cost) + ")");
       }
 
-      // Get seeds and sensitivities
-      bvec_t* seed_v = use_fwd ? get_ptr(s_in) : get_ptr(s_out);
-      bvec_t* sens_v = use_fwd ? get_ptr(s_out) : get_ptr(s_in);
-
       // The number of zeros in the seed and sensitivity directions
       casadi_int nz_seed = use_fwd ? nz_in  : nz_out;
       casadi_int nz_sens = use_fwd ? nz_out : nz_in;
 
-      // Clear the seeds
-      for (casadi_int i=0; i<nz_seed; ++i) seed_v[i]=0;
-
       // Choose the active jacobian coloring scheme
       Sparsity D = use_fwd ? D1 : D2;
 
@@ -1608,6 +1903,11 @@ namespace casadi {
       std::vector<casadi_int> lookup_row;
       std::vector<casadi_int> lookup_value;
 
+      // Seeds of the current sweep
+      std::vector<casadi_int> toggle;
+
+      // Sweeps of this level
+      std::vector<JacSparsitySweep> sweeps;
 
       // The maximum number of fine blocks contained in one coarse block
       casadi_int n_fine_blocks_max = 0;
@@ -1653,8 +1953,9 @@ namespace casadi {
               }
 
               // Toggle on seeds
-              bvec_toggle(seed_v, fine_row[fci+fci_start], fine_row[fci+fci_start+1],
-                          bvec_i+bvec_i_mod);
+              toggle.push_back(fine_row[fci+fci_start]);
+              toggle.push_back(fine_row[fci+fci_start+1]);
+              toggle.push_back(bvec_i+bvec_i_mod);
               bvec_i_mod++;
             }
           }
@@ -1664,7 +1965,7 @@ namespace casadi {
 
           // Check if bvec buffer is full
           if (bvec_i==bvec_size || csd==D.size2()-1) {
-            // Calculate sparsity for bvec_size directions at once
+            // Sweep for bvec_size directions at once
 
             // Statistics
             nsweeps+=1;
@@ -1673,49 +1974,9 @@ namespace casadi {
             IM lookup = IM::triplet(lookup_row, lookup_col, lookup_value, bvec_size,
                                     coarse_col.size());
 
-            // Propagate the dependencies
-            if (use_fwd) {
-              JacSparsityTraits<true>::sp(this, get_ptr(arg_fwd), get_ptr(res),
-                get_ptr(iw), get_ptr(w), memory(0));
-            } else {
-              std::fill(w.begin(), w.end(), 0);
-              JacSparsityTraits<false>::sp(this, get_ptr(arg_adj), get_ptr(res),
-                get_ptr(iw), get_ptr(w), memory(0));
-            }
-
-            // Temporary bit work vector
-            bvec_t spsens;
-
-            // Loop over the cols of coarse blocks
-            for (casadi_int cri=0;cri<coarse_col.size()-1;++cri) {
-
-              // Loop over the cols of fine blocks within the current coarse block
-              for (casadi_int fri=fine_col_lookup[coarse_col[cri]];
-                   fri<fine_col_lookup[coarse_col[cri+1]];++fri) {
-                // Lump individual sensitivities together into fine block
-                bvec_or(sens_v, spsens, fine_col[fri], fine_col[fri+1]);
-
-                // Next iteration if no sparsity
-                if (!spsens) continue;
-
-                // Loop over all bvec_bits
-                for (casadi_int bvec_i=0;bvec_i<bvec_size;++bvec_i) {
-                  if (spsens & bvec_lookup[bvec_i]) {
-                    // if dependency is found, add it to the new sparsity pattern
-                    casadi_int ind = lookup.sparsity().get_nz(bvec_i, cri);
-                    if (ind==-1) continue;
-                    jrow.push_back(bvec_i+lookup->at(ind));
-                    jcol.push_back(fri);
-                  }
-                }
-              }
-            }
-
-            // Clear the forward seeds/adjoint sensitivities, ready for next bvec sweep
-            std::fill(s_in.begin(), s_in.end(), 0);
-
-            // Clear the adjoint seeds/forward sensitivities, ready for next bvec sweep
-            std::fill(s_out.begin(), s_out.end(), 0);
+            // Save sweep, to be propagated below
+            sweeps.push_back(JacSparsitySweep{toggle, lookup});
+            toggle.clear();
 
             // Clean lookup table
             lookup_col.clear();
@@ -1735,6 +1996,15 @@ namespace casadi {
 
       }
 
+      // Propagate the dependencies
+      if (use_fwd) {
+        jac_sparsity_sweeps<true>(this, oind, iind, sweeps, coarse_col, fine_col,
+                                  fine_col_lookup, false, memory(0), jrow, jcol);
+      } else {
+        jac_sparsity_sweeps<false>(this, oind, iind, sweeps, coarse_col, fine_col,
+                                   fine_col_lookup, false, memory(0), jrow, jcol);
+      }
+
       // Swap results if adjoint mode was used
       if (use_fwd) {
         // Construct fine sparsity pattern
@@ -1841,6 +2111,213 @@ namespace casadi {
     return r;
   }
 
+  // Stream buffer computing the 64-bit FNV-1a hash of everything written to it
+  class SparsityCacheHash : public std::streambuf {
+  public:
+    uint64_t h = 14695981039346656037ULL;
+    // Hash in hexadecimal
+    std::string str() const {
+      std::stringstream ss;
+      ss << std::hex << std::setw(16) << std::setfill('0') << h;
+      return ss.str();
+    }
+  protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+      for (std::streamsize i=0; i<n; ++i) {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 1099511628211ULL;
+      }
+      return n;
+    }
+    int_type overflow(int_type c) override {
+      if (c!=traits_type::eof()) {
+        char ch = traits_type::to_char_type(c);
+        xsputn(&ch, 1);
+      }
+      return traits_type::not_eof(c);
+    }
+  };
+
+  // 64-bit FNV-1a hash of a string, in hexadecimal
+  static std::string sparsity_cache_hash(const std::string& s) {
+    SparsityCacheHash h;
+    h.sputn(s.data(), s.size());
+    return h.str();
+  }
+
+  // File of an entry in a persistent cache directory
+  static std::string persistent_cache_file(const std::string& dir, const std::string& key,
+      const std::string& ext) {
+    return dir + filesep() + sparsity_cache_hash(key) + ext;
+  }
+
+  // Look up an entry in a persistent cache directory
+  template<typename T>
+  static bool persistent_cache_load(const std::string& dir, const std::string& key,
+      const std::string& ext, T& e) {
+    std::ifstream f(persistent_cache_file(dir, key, ext), std::ios::binary);
+    if (!f.good()) return false;
+    try {
+      DeserializingStream s(f);
+      std::string k;
+      s.unpack("SparsityCache::key", k);
+      if (k!=key) return false;
+      s.unpack("SparsityCache::entry", e);
+      return true;
+    } catch (std::exception&) {
+      // Corrupt or incompatible entry, treat as a miss
+      return false;
+    }
+  }
+
+  // Store an entry in a persistent cache directory
+  template<typename T>
+  static void persistent_cache_save(const std::string& dir, const std::string& key,
+      const std::string& ext, const T& e) {
+    std::string fname = persistent_cache_file(dir, key, ext);
+    try {
+      // Write to a temporary file and rename, so that readers never see partial entries
+      std::string tmp = temporary_file(fname + ".", ".tmp");
+      {
+        std::ofstream f(tmp, std::ios::binary);
+        SerializingStream s(f);
+        s.pack("SparsityCache::key", key);
+        s.pack("SparsityCache::entry", e);
+        casadi_assert(f.good(), "Failed to write '" + tmp + "'");
+      }
+      if (std::rename(tmp.c_str(), fname.c_str())) {
+        std::remove(tmp.c_str());
+        casadi_error("Failed to rename '" + tmp + "' to '" + fname + "'");
+      }
+    } catch (std::exception& ex) {
+      casadi_warning("Failed to store cache entry '" + fname + "': " + ex.what());
+    }
+  }
+
+  // Look up an entry in the persistent sparsity cache
+  static bool sparsity_cache_load(const std::string& key, std::vector<Sparsity>& e) {
+    return persistent_cache_load(GlobalOptions::sparsity_cache, key, ".casadi_sp", e);
+  }
+
+  // Store an entry in the persistent sparsity cache
+  static void sparsity_cache_save(const std::string& key, const std::vector<Sparsity>& e) {
+    persistent_cache_save(GlobalOptions::sparsity_cache, key, ".casadi_sp", e);
+  }
+
+  std::string FunctionInternal::sparsity_cache_id() const {
+    if (sparsity_cache_id_.empty()) {
+      try {
+        SparsityCacheHash h;
+        std::ostream os(&h);
+        self().serialize(os);
+        sparsity_cache_id_ = h.str();
+      } catch (std::exception&) {
+        // Not serializable, mark as such
+        sparsity_cache_id_ = "-";
+        if (verbose_) casadi_message(name_ + " cannot be serialized, sparsity cache disabled");
+      }
+    }
+    return sparsity_cache_id_=="-" ? std::string() : sparsity_cache_id_;
+  }
+
+  // Most recently used cached functions, first is most recent
+  static std::list<Function>& function_cache_lru() {
+    static auto* lru = new std::list<Function>();
+    return *lru;
+  }
+
+#ifdef CASADI_WITH_THREAD
+  static std::mutex& function_cache_lru_mtx() {
+    static auto* mtx = new std::mutex();
+    return *mtx;
+  }
+#endif // CASADI_WITH_THREAD
+
+  // Keep a strong reference to a recently used cached function
+  static void function_cache_touch(const Function& f) {
+    // Evicted entries, destroyed after releasing the lock
+    std::vector<Function> evicted;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(function_cache_lru_mtx());
+#endif // CASADI_WITH_THREAD
+    std::list<Function>& lru = function_cache_lru();
+    casadi_int max_size = std::max(GlobalOptions::function_cache_size, casadi_int(0));
+    if (max_size>0) {
+      // Move to the front
+      auto it = lru.begin();
+      while (it!=lru.end() && it->get()!=f.get()) ++it;
+      if (it==lru.end()) {
+        lru.push_front(f);
+      } else {
+        lru.splice(lru.begin(), lru, it);
+      }
+    }
+    // Drop the least recently used entries
+    while (static_cast<casadi_int>(lru.size())>max_size) {
+      evicted.push_back(lru.back());
+      lru.pop_back();
+    }
+  }
+
+  std::string FunctionInternal::function_cache_key(const std::string& fname,
+      const std::string& suffix) const {
+    if (GlobalOptions::function_cache.empty()) return std::string();
+    std::string id = sparsity_cache_id();
+    if (id.empty()) return std::string();
+    return "function:" + id + ":" + fname + ":" + suffix;
+  }
+
+  bool FunctionInternal::incache(const std::string& fname, Function& f,
+      const std::string& suffix) const {
+    {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREAD
+      auto it = cache_.find(fname + ":" + suffix);
+      if (it!=cache_.end() && it->second.alive()) {
+        f = shared_cast<Function>(it->second.shared());
+      }
+    }
+    // Look up in the persistent cache, if enabled
+    if (f.is_null()) {
+      std::string key = function_cache_key(fname, suffix);
+      Function f_disk;
+      if (!key.empty() && persistent_cache_load(GlobalOptions::function_cache, key,
+          ".casadi_fun", f_disk) && f_disk.name()==fname) {
+        if (verbose_) casadi_message(fname + " loaded from function cache");
+        f = f_disk;
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREAD
+        cache_[fname + ":" + suffix] = f;
+      }
+    }
+    if (f.is_null()) return false;
+    function_cache_touch(f);
+    return true;
+  }
+
+  void FunctionInternal::tocache(const Function& f, const std::string& suffix) const {
+    {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREAD
+      // Add to cache
+      cache_.insert(std::make_pair(f.name() + ":" + suffix, f));
+      // Remove a lost reference, if any, to prevent uncontrolled growth
+      for (auto it = cache_.begin(); it!=cache_.end(); ++it) {
+        if (!it->second.alive()) {
+          cache_.erase(it);
+          break; // just one dead reference is enough
+        }
+      }
+    }
+    function_cache_touch(f);
+    // Store in the persistent cache, if enabled
+    std::string key = function_cache_key(f.name(), suffix);
+    if (!key.empty()) persistent_cache_save(GlobalOptions::function_cache, key, ".casadi_fun", f);
+  }
+
   Sparsity& FunctionInternal::jac_sparsity(casadi_int oind, casadi_int iind, bool compact,
       bool symmetric) const {
     // If first call, allocate cache
@@ -1868,7 +2345,25 @@ namespace casadi {
         } else {
           // Use internal routine to determine sparsity
           if (has_spfwd() || has_sprev() || has_jac_sparsity(oind, iind)) {
-            sp = get_jac_sparsity(oind, iind, symmetric);
+            // Key in the persistent cache, if enabled
+            std::string key;
+            if (!GlobalOptions::sparsity_cache.empty()) {
+              std::string id = sparsity_cache_id();
+              if (!id.empty()) {
+                key = "jac_sparsity:" + id + ":" + str(oind) + ":" + str(iind)
+                  + ":" + str(symmetric);
+              }
+            }
+            std::vector<Sparsity> e;
+            if (!key.empty() && sparsity_cache_load(key, e) && e.size()==1
+                && (e[0].is_null() || e[0].size()==std::make_pair(nnz_out(oind), nnz_in(iind))
+                    || e[0].size()==std::make_pair(numel_out(oind), numel_in(iind)))) {
+              if (verbose_) casadi_message("Jacobian sparsity loaded from sparsity cache");
+              sp = e[0];
+            } else {
+              sp = get_jac_sparsity(oind, iind, symmetric);
+              if (!key.empty()) sparsity_cache_save(key, {sp});
+            }
           }
           // If null, dense
           if (sp.is_null()) sp = Sparsity::dense(nnz_out(oind), nnz_in(iind));
@@ -1902,6 +2397,62 @@ namespace casadi {
     return jsp;
   }
 
+  // Restrict a coloring of the columns of sp to its nonempty columns, dropping empty colors
+  static Sparsity coloring_nonempty(const Sparsity& D, const Sparsity& sp) {
+    const casadi_int* colind = sp.colind();
+    std::vector<casadi_int> ret_colind(1, 0), ret_row;
+    for (casadi_int c=0; c<D.size2(); ++c) {
+      for (casadi_int el=D.colind(c); el<D.colind(c+1); ++el) {
+        casadi_int j = D.row(el);
+        if (colind[j+1]>colind[j]) ret_row.push_back(j);
+      }
+      if (ret_row.size()>ret_colind.back()) ret_colind.push_back(ret_row.size());
+    }
+    return Sparsity(D.size1(), ret_colind.size()-1, ret_colind, ret_row);
+  }
+
+  // Bidirectional partition of J: the rows flagged in 'split' are recovered in adjoint mode,
+  // the other rows in forward mode. Accepted if cheaper than 'best'
+  static bool split_partition(const Sparsity& J, const std::vector<bool>& split, double w,
+                              double& best, Sparsity& D1, Sparsity& D2) {
+    // Separate the rows
+    std::vector<casadi_int> row, col, row_f, col_f, row_a, col_a;
+    J.get_triplet(row, col);
+    for (casadi_int k=0; k<row.size(); ++k) {
+      if (split[row[k]]) {
+        row_a.push_back(row[k]);
+        col_a.push_back(col[k]);
+      } else {
+        row_f.push_back(row[k]);
+        col_f.push_back(col[k]);
+      }
+    }
+    Sparsity Jf = Sparsity::triplet(J.size1(), J.size2(), row_f, col_f);
+    Sparsity JaT = Sparsity::triplet(J.size2(), J.size1(), col_a, row_a);
+
+    // Adjoint coloring of the split rows, one extra color for empty rows
+    double max_a = std::min(static_cast<double>(J.size1()), best/(1-w));
+    Sparsity Da = JaT.uni_coloring(JaT.T(), static_cast<casadi_int>(max_a) + 1);
+    if (Da.is_null()) return false;
+    Da = coloring_nonempty(Da, JaT);
+    double cost = (1-w)*static_cast<double>(Da.size2());
+    if (cost>=best) return false;
+
+    // Forward coloring of the remaining rows
+    double max_f = std::min(static_cast<double>(J.size2()), (best-cost)/w);
+    Sparsity Df = Jf.uni_coloring(Jf.T(), static_cast<casadi_int>(max_f) + 1);
+    if (Df.is_null()) return false;
+    Df = coloring_nonempty(Df, Jf);
+    cost += w*static_cast<double>(Df.size2());
+    if (cost>=best) return false;
+
+    // Accept
+    best = cost;
+    D1 = Df;
+    D2 = Da;
+    return true;
+  }
+
   void FunctionInternal::get_partition(casadi_int iind, casadi_int oind, Sparsity& D1, Sparsity& D2,
                                        bool compact, bool symmetric,
                                        bool allow_forward, bool allow_reverse) const {
@@ -1912,6 +2463,20 @@ namespace casadi {
     Sparsity &AT = jac_sparsity(oind, iind, compact, symmetric);
     Sparsity A = symmetric ? AT : AT.T();
 
+    // Look up the persistent cache, keyed on the pattern
+    std::string key;
+    if (!GlobalOptions::sparsity_cache.empty()) {
+      key = "partition:" + sparsity_cache_hash(A.serialize()) + ":" + str(symmetric)
+        + ":" + str(allow_forward) + ":" + str(allow_reverse) + ":" + str(ad_weight());
+      std::vector<Sparsity> e;
+      if (sparsity_cache_load(key, e) && e.size()==3 && e[0]==A) {
+        if (verbose_) casadi_message("Partition loaded from sparsity cache");
+        D1 = e[1];
+        D2 = e[2];
+        return;
+      }
+    }
+
     // Get seed matrices by graph coloring
     if (symmetric) {
       casadi_assert_dev(enable_forward_ || enable_fd_);
@@ -1998,7 +2563,44 @@ namespace casadi {
         }
       }
 
+      // Bidirectional partitions: dense rows in adjoint mode, dense columns in forward mode
+      if (allow_forward && allow_reverse) {
+        for (bool by_row : {true, false}) {
+          // Sparsity pattern with the split dimension as rows
+          const Sparsity& J = by_row ? AT : A;
+          const casadi_int* J_row = J.row();
+          std::vector<casadi_int> cnt(J.size1(), 0);
+          for (casadi_int k=0; k<J.nnz(); ++k) cnt[J_row[k]]++;
+          casadi_int max_cnt = 0;
+          for (casadi_int c : cnt) max_cnt = std::max(max_cnt, c);
+          // Split off all rows denser than a threshold, halving the threshold
+          casadi_int n_split_prev = 0;
+          for (casadi_int t=max_cnt/2; t>=1; t/=2) {
+            std::vector<bool> split(J.size1());
+            casadi_int n_split = 0;
+            for (casadi_int i=0; i<J.size1(); ++i) {
+              split[i] = cnt[i]>t;
+              if (split[i]) n_split++;
+            }
+            if (n_split==n_split_prev) continue;
+            n_split_prev = n_split;
+            // Entries recovered in adjoint mode for a row split, forward mode for a column split
+            bool better = by_row ? split_partition(J, split, w, best_coloring, D1, D2)
+                                 : split_partition(J, split, 1-w, best_coloring, D2, D1);
+            if (better && verbose_) {
+              casadi_message("Bidirectional coloring completed: " + str(D1.size2())
+                             + " forward and " + str(D2.size2()) + " adjoint directions needed ("
+                             + str(n_split) + " " + std::string(by_row ? "rows" : "columns")
+                             + " split off).");
+            }
+          }
+        }
+      }
+
     }
+
+    // Store in the persistent cache
+    if (!key.empty()) sparsity_cache_save(key, {A, D1, D2});
   }
 
   std::vector<DM> FunctionInternal::eval_dm(const std::vector<DM>& arg) const {
@@ -2168,6 +2770,51 @@ namespace casadi {
     casadi_error("'get_reverse' not defined for " + class_name());
   }
 
+  Function FunctionInternal::taylor(casadi_int order) const {
+    casadi_assert(order>=1, "Taylor order must be positive, got " + str(order));
+    // Retrieve/generate cached
+    Function f;
+    std::string fname = taylor_name(name_, order);
+    if (!incache(fname, f)) {
+      casadi_int i;
+      // Prefix to be used for directions, coefficients
+      std::string pref = diff_prefix("tay");
+      // Names of inputs
+      std::vector<std::string> inames;
+      for (i=0; i<n_in_; ++i) inames.push_back(name_in_[i]);
+      for (i=0; i<n_in_; ++i) inames.push_back(pref + name_in_[i]);
+      // Names of outputs
+      std::vector<std::string> onames;
+      for (i=0; i<n_out_; ++i) onames.push_back(name_out_[i]);
+      for (casadi_int d=1; d<=order; ++d) {
+        for (i=0; i<n_out_; ++i) onames.push_back(pref + str(d) + "_" + name_out_[i]);
+      }
+      // Options
+      Dict opts = combine(der_options_, generate_options("taylor"));
+      // Generate Taylor coefficient function
+      f = get_taylor(order, fname, inames, onames, opts);
+      // Consistency check for inputs
+      casadi_assert_dev(f.n_in()==2*n_in_);
+      for (i=0; i<n_in_; ++i) f.assert_size_in(i, size1_in(i), size2_in(i));
+      for (i=0; i<n_in_; ++i) f.assert_size_in(n_in_+i, size1_in(i), size2_in(i));
+      // Consistency check for outputs
+      casadi_assert_dev(f.n_out()==(order+1)*n_out_);
+      for (i=0; i<f.n_out(); ++i) f.assert_sparsity_out(i, sparsity_out(i % n_out_));
+      // Save to cache
+      tocache(f);
+    }
+    return f;
+  }
+
+  Function FunctionInternal::
+  get_taylor(casadi_int order, const std::string& name,
+             const std::vector<std::string>& inames,
+             const std::vector<std::string>& onames,
+             const Dict& opts) const {
+    casadi_error("'get_taylor' not defined for " + class_name()
+      + ". Consider calling 'expand' first.");
+  }
+
   void FunctionInternal::export_code(const std::string& lang, std::ostream &stream,
       const Dict& options) const {
     casadi_error("'export_code' not defined for " + class_name());
@@ -2276,7 +2923,8 @@ namespace casadi {
   void FunctionInternal::codegen(CodeGenerator& g, const std::string& fname) const {
     // Define function
     g << "/* " << definition() << " */\n";
-    g << "static " << signature(fname) << " {\n";
+    // External linkage when split into several translation units
+    g << (g.split ? "" : "static ") << signature(fname) << " {\n";
 
     // Reset local variables, flush buffer
     g.flush(g.body);
@@ -2407,6 +3055,12 @@ namespace casadi {
       << g.declare("casadi_int " + name_ + "_n_out(void)")
       << " { return " << n_out_ << ";}\n\n";
 
+    // Integer size, for loading code generated with a narrower casadi_int
+    if (g.casadi_int_type != CASADI_INT_TYPE_STR) {
+      g << g.declare("int " + name_ + "_int_bytes(void)")
+        << " { return sizeof(casadi_int);}\n\n";
+    }
+
     // Default inputs
     g << g.declare("casadi_real " + name_ + "_default_in(casadi_int i)") << " {\n"
       << "switch (i) {\n";
@@ -2692,6 +3346,124 @@ namespace casadi {
     g << "#error Code generation not supported for " << class_name() << "\n";
   }
 
+  std::string FunctionInternal::llvm_ir(const std::string& fname) const {
+    casadi_error("'llvm_ir' not defined for " + class_name());
+  }
+
+  void FunctionInternal::codegen_batch(CodeGenerator& g, const std::string& fname,
+      casadi_int n) const {
+    casadi_assert(n>0, "Batch size must be positive");
+    // Define function
+    g << "/* " << definition() << ", " << n << " instances in struct-of-arrays layout */\n";
+    g << g.declare(signature(fname)) << " {\n";
+
+    // Reset local variables, flush buffer
+    g.flush(g.body);
+
+    g.scope_enter();
+
+    // Generate function body (to buffer)
+    codegen_batch_body(g, n);
+
+    g.scope_exit();
+
+    // Finalize the function
+    g << "return 0;\n";
+    g << "}\n\n";
+
+    // Flush to function body
+    g.flush(g.body);
+
+    // Function that returns work vector lengths
+    g << g.declare(
+        "int " + fname + "_work(casadi_int *sz_arg, casadi_int* sz_res, "
+        "casadi_int *sz_iw, casadi_int *sz_w)")
+      << " {\n"
+      << "if (sz_arg) *sz_arg = " << n_in_ << ";\n"
+      << "if (sz_res) *sz_res = " << n_out_ << ";\n"
+      << "if (sz_iw) *sz_iw = 0;\n"
+      << "if (sz_w) *sz_w = " << codegen_batch_sz_w(g, n) << ";\n"
+      << "return 0;\n"
+      << "}\n\n";
+
+    // Number of instances
+    g << g.declare("casadi_int " + fname + "_size(void)")
+      << " { return " << n << ";}\n\n";
+
+    // Number of inputs and outputs
+    g << g.declare("casadi_int " + fname + "_n_in(void)")
+      << " { return " << n_in_ << ";}\n\n"
+      << g.declare("casadi_int " + fname + "_n_out(void)")
+      << " { return " << n_out_ << ";}\n\n";
+
+    // Dense n-by-nnz inputs and outputs, with one row per instance
+    std::vector<Sparsity> sp_in(n_in_), sp_out(n_out_);
+    for (casadi_int i=0; i<n_in_; ++i) sp_in[i] = Sparsity::dense(n, nnz_in(i));
+    for (casadi_int i=0; i<n_out_; ++i) sp_out[i] = Sparsity::dense(n, nnz_out(i));
+    g.add_io_sparsities(fname, sp_in, sp_out);
+
+    // Flush to function body
+    g.flush(g.body);
+  }
+
+  void FunctionInternal::codegen_batch_body(CodeGenerator& g, casadi_int n) const {
+    casadi_error("'codegen_batch_body' not defined for " + class_name());
+  }
+
+  void FunctionInternal::codegen_cuda(CodeGenerator& g, const std::string& fname) const {
+    // Device code is only compiled by nvcc or hipcc
+    g << "#if defined(__CUDACC__) || defined(__HIPCC__)\n"
+      << "#if defined(__HIPCC__) && !defined(cudaStream_t)\n"
+      << "#define cudaStream_t hipStream_t\n"
+      << "#define cudaGetLastError hipGetLastError\n"
+      << "#define cudaSuccess hipSuccess\n"
+      << "#endif\n\n";
+
+    // Kernel arguments: inputs, outputs and number of instances
+    std::stringstream params, call;
+    for (casadi_int i=0; i<n_in_; ++i) {
+      params << "const casadi_real* x" << i << ", ";
+      call << g.arg(i) << ", ";
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      params << "casadi_real* y" << i << ", ";
+      call << g.res(i) << ", ";
+    }
+    params << "casadi_int n";
+    call << "n";
+
+    // Kernel, one thread per instance
+    g << "/* " << definition() << ", one instance per thread */\n";
+    g << "__global__ void " << fname << "_kernel(" << params.str() << ") {\n";
+    g.flush(g.body);
+    g.scope_enter();
+    codegen_cuda_body(g);
+    g.scope_exit();
+    g << "}\n\n";
+    g.flush(g.body);
+
+    // Host driver: device pointers in struct-of-arrays layout, asynchronous on stream
+    g << "/* " << name_ << " for n instances on the device, asynchronous on a stream */\n";
+    g << g.declare("int " + fname + "(const casadi_real** arg, casadi_real** res, "
+                   "casadi_int n, void* stream)") << " {\n"
+      << "unsigned int block = 128;\n"
+      << "if (n<=0) return 0;\n"
+      << fname << "_kernel<<<(unsigned int)((n+block-1)/block), block, 0, "
+      << "(cudaStream_t)stream>>>(" << call.str() << ");\n"
+      << "return cudaGetLastError()==cudaSuccess ? 0 : 1;\n"
+      << "}\n\n";
+    g << "#endif /* __CUDACC__ || __HIPCC__ */\n\n";
+    g.flush(g.body);
+  }
+
+  void FunctionInternal::codegen_cuda_body(CodeGenerator& g) const {
+    casadi_error("'codegen_cuda_body' not defined for " + class_name());
+  }
+
+  casadi_int FunctionInternal::codegen_batch_sz_w(const CodeGenerator& g, casadi_int n) const {
+    casadi_error("'codegen_batch_sz_w' not defined for " + class_name());
+  }
+
   std::string FunctionInternal::
   generate_dependencies(const std::string& fname, const Dict& opts) const {
     casadi_error("'generate_dependencies' not defined for " + class_name());
@@ -3388,10 +4160,13 @@ namespace casadi {
   }
 
   void ProtoFunction::clear_mem() {
-    for (auto&& i : mem_) {
-      if (i!=nullptr) free_mem(i);
+    for (int k=0; k<n_mem_; ++k) {
+      void*& m = mem_slot(k).mem;
+      if (m!=nullptr) free_mem(m);
+      m = nullptr;
     }
-    mem_.clear();
+    n_mem_ = 0;
+    unused_ = 0;
   }
 
   size_t FunctionInternal::get_n_in() {
@@ -3488,38 +4263,68 @@ namespace casadi {
     return Sparsity::scalar();
   }
 
+  void ProtoFunction::init_mem_pool() {
+    for (auto&& b : mem_block_) b = nullptr;
+    n_mem_ = 0;
+    unused_ = 0;
+  }
+
+  ProtoFunction::MemSlot& ProtoFunction::mem_slot(int k) const {
+    // Block b holds slots 2^b-1, ..., 2^(b+1)-2
+    unsigned int k1 = static_cast<unsigned int>(k) + 1;
+    int b = 0;
+    while (k1 >> (b + 1)) b++;
+    return mem_block_[b].load(std::memory_order_acquire)[k1 - (1u << b)];
+  }
+
   void* ProtoFunction::memory(int ind) const {
-#ifdef CASADI_WITH_THREAD
-    std::lock_guard<std::mutex> lock(mtx_);
-#endif //CASADI_WITH_THREAD
-    return mem_.at(ind);
+    casadi_assert(ind>=0 && ind<n_mem_, "Memory object " + str(ind) + " does not exist");
+    return mem_slot(ind).mem;
   }
 
   int ProtoFunction::checkout() const {
+    // Pop from the stack of unused memory objects
+    uint64_t head = unused_.load(std::memory_order_acquire);
+    while (true) {
+      int top = static_cast<int>(head & 0xffffffffu) - 1;
+      if (top < 0) break;
+      // Slots are never deallocated, the tag invalidates a stale next
+      int next = mem_slot(top).next.load(std::memory_order_relaxed);
+      uint64_t new_head = ((head >> 32) + 1) << 32 | static_cast<uint64_t>(next + 1);
+      if (unused_.compare_exchange_weak(head, new_head, std::memory_order_acquire)) return top;
+    }
+    // Allocate a new memory object
 #ifdef CASADI_WITH_THREAD
     std::lock_guard<std::mutex> lock(mtx_);
 #endif //CASADI_WITH_THREAD
-    if (unused_.empty()) {
-      // Allocate a new memory object
-      void* m = alloc_mem();
-      mem_.push_back(m);
-      if (init_mem(m)) {
-        casadi_error("Failed to create or initialize memory object");
-      }
-      return static_cast<int>(mem_.size()) - 1;
-    } else {
-      // Use an unused memory object
-      int m = unused_.top();
-      unused_.pop();
-      return m;
+    int k = n_mem_;
+    unsigned int k1 = static_cast<unsigned int>(k) + 1;
+    int b = 0;
+    while (k1 >> (b + 1)) b++;
+    casadi_assert(b < n_mem_block, "Too many memory objects");
+    if (mem_block_[b].load()==nullptr) {
+      MemSlot* block = new MemSlot[1u << b];
+      for (unsigned int i=0; i<(1u << b); ++i) block[i].mem = nullptr;
+      mem_block_[b].store(block, std::memory_order_release);
+    }
+    void* m = alloc_mem();
+    mem_slot(k).mem = m;
+    n_mem_ = k + 1;
+    if (init_mem(m)) {
+      casadi_error("Failed to create or initialize memory object");
     }
+    return k;
   }
 
   void ProtoFunction::release(int mem) const {
-#ifdef CASADI_WITH_THREAD
-    std::lock_guard<std::mutex> lock(mtx_);
-#endif //CASADI_WITH_THREAD
-    unused_.push(mem);
+    // Push onto the stack of unused memory objects
+    MemSlot& slot = mem_slot(mem);
+    uint64_t head = unused_.load(std::memory_order_relaxed);
+    while (true) {
+      slot.next.store(static_cast<int>(head & 0xffffffffu) - 1, std::memory_order_relaxed);
+      uint64_t new_head = ((head >> 32) + 1) << 32 | static_cast<uint64_t>(mem + 1);
+      if (unused_.compare_exchange_weak(head, new_head, std::memory_order_release)) return;
+    }
   }
 
   Function FunctionInternal::
@@ -3553,6 +4358,73 @@ namespace casadi {
     }
   }
 
+  // Bytes used by the compressed column storage of a sparsity pattern
+  static size_t sparsity_bytes(const Sparsity& sp) {
+    if (sp.is_null()) return 0;
+    return (3 + sp.size2() + sp.nnz()) * sizeof(casadi_int);
+  }
+
+  Dict FunctionInternal::memory_report(std::set<const FunctionInternal*>& visited) const {
+    visited.insert(this);
+    Dict r;
+    r["class"] = class_name();
+    r["n_mem"] = n_mem();
+    r["sz_arg"] = static_cast<casadi_int>(sz_arg());
+    r["sz_res"] = static_cast<casadi_int>(sz_res());
+    r["sz_iw"] = static_cast<casadi_int>(sz_iw());
+    r["sz_w"] = static_cast<casadi_int>(sz_w());
+    // Work vectors, as allocated by every caller of eval
+    size_t work_bytes = sz_arg() * sizeof(double*) + sz_res() * sizeof(double*)
+      + sz_iw() * sizeof(casadi_int) + sz_w() * sizeof(double);
+    // Input and output sparsity patterns
+    size_t sp_bytes = 0;
+    for (auto&& sp : sparsity_in_) sp_bytes += sparsity_bytes(sp);
+    for (auto&& sp : sparsity_out_) sp_bytes += sparsity_bytes(sp);
+    // Cached Jacobian sparsity blocks
+    size_t jac_sp_bytes = 0;
+    for (casadi_int c = 0; c < 2; ++c) {
+      for (auto&& sp : jac_sparsity_[c]) jac_sp_bytes += sparsity_bytes(sp);
+    }
+    size_t instr_bytes = instructions_bytes();
+    size_t self_bytes = work_bytes + sp_bytes + jac_sp_bytes + instr_bytes;
+    r["work_bytes"] = static_cast<casadi_int>(work_bytes);
+    r["sparsity_bytes"] = static_cast<casadi_int>(sp_bytes);
+    r["jac_sparsity_bytes"] = static_cast<casadi_int>(jac_sp_bytes);
+    r["instructions_bytes"] = static_cast<casadi_int>(instr_bytes);
+    r["self_bytes"] = static_cast<casadi_int>(self_bytes);
+    r["jit"] = jit_;
+    casadi_int total_bytes = static_cast<casadi_int>(self_bytes);
+    // Report of a child function, counted once
+    auto child_report = [&](const Function& f) {
+      Dict c;
+      if (visited.count(f.get())) {
+        c["class"] = f->class_name();
+        c["shared"] = true;
+        c["total_bytes"] = 0;
+      } else {
+        c = f->memory_report(visited);
+        total_bytes += c["total_bytes"].as_int();
+      }
+      return c;
+    };
+    // Embedded functions
+    std::map<FunctionInternal*, Function> all_fun;
+    find(all_fun, 0);
+    for (auto&& n : get_function()) {
+      const Function& f = get_function(n);
+      if (!f.is_null()) all_fun[f.get()] = f;
+    }
+    Dict deps;
+    for (auto&& e : all_fun) deps[e.second.name()] = child_report(e.second);
+    r["dependencies"] = deps;
+    // Cached derivatives and other functions that are still alive
+    Dict cached;
+    for (auto&& e : cache()) cached[e.first] = child_report(e.second.as_function());
+    r["cache"] = cached;
+    r["total_bytes"] = total_bytes;
+    return r;
+  }
+
   std::vector<bool> FunctionInternal::
   which_depends(const std::string& s_in, const std::vector<std::string>& s_out,
       casadi_int order, bool tr) const {
@@ -3801,6 +4673,65 @@ namespace casadi {
     s.unpack("ProtoFunction::record_time", record_time_);
     if (version >= 2) s.unpack("ProtoFunction::regularity_check", regularity_check_);
     if (version >= 2) s.unpack("ProtoFunction::error_on_fail", error_on_fail_);
+    init_mem_pool();
+  }
+
+  // Target key of libraries compiled on this machine: <os>-<arch>
+  static std::string jit_target() {
+#if defined(_WIN32)
+    std::string os = "windows";
+#elif defined(__APPLE__)
+    std::string os = "osx";
+#else
+    std::string os = "linux";
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+    std::string arch = "x86_64";
+#elif defined(__i386__) || defined(_M_IX86)
+    std::string arch = "x86";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    std::string arch = "aarch64";
+#elif defined(__arm__) || defined(_M_ARM)
+    std::string arch = "arm";
+#else
+    std::string arch = "unknown";
+#endif
+    return os + "-" + arch;
+  }
+
+  // Does the CPU support a feature, as in a target key
+  static bool jit_cpu_supports(const std::string& feature) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    // __builtin_cpu_supports requires a string literal
+    if (feature=="sse4.2") return __builtin_cpu_supports("sse4.2");
+    if (feature=="avx") return __builtin_cpu_supports("avx");
+    if (feature=="avx2") return __builtin_cpu_supports("avx2");
+    if (feature=="fma") return __builtin_cpu_supports("fma");
+    if (feature=="avx512f") return __builtin_cpu_supports("avx512f");
+#endif
+    return false;
+  }
+
+  // Number of CPU features of a matching target key <os>-<arch>[+feature..], -1 if no match
+  static casadi_int jit_target_features(const std::string& key) {
+    std::vector<std::string> parts;
+    std::stringstream ss(key);
+    std::string part;
+    while (std::getline(ss, part, '+')) parts.push_back(part);
+    if (parts.empty() || parts[0]!=jit_target()) return -1;
+    for (casadi_int i=1; i<parts.size(); ++i) {
+      if (!jit_cpu_supports(parts[i])) return -1;
+    }
+    return parts.size()-1;
+  }
+
+  // Contents of a library file
+  static std::string read_library(const std::string& fname) {
+    std::ifstream binary(fname, std::ios_base::binary);
+    casadi_assert(binary.good(), "Could not open library '" + fname + "'.");
+    std::stringstream ss;
+    ss << binary.rdbuf();
+    return ss.str();
   }
 
   void FunctionInternal::serialize_type(SerializingStream &s) const {
@@ -3809,7 +4740,7 @@ namespace casadi {
 
   void FunctionInternal::serialize_body(SerializingStream& s) const {
     ProtoFunction::serialize_body(s);
-    s.version("FunctionInternal", 6);
+    s.version("FunctionInternal", 9);
     s.pack("FunctionInternal::is_diff_in", is_diff_in_);
     s.pack("FunctionInternal::is_diff_out", is_diff_out_);
     s.pack("FunctionInternal::sp_in", sparsity_in_);
@@ -3821,14 +4752,26 @@ namespace casadi {
     s.pack("FunctionInternal::jit_cleanup", jit_cleanup_);
     s.pack("FunctionInternal::jit_serialize", jit_serialize_);
     if (jit_serialize_=="link" || jit_serialize_=="embed") {
-      s.pack("FunctionInternal::jit_library", compiler_.library());
+      const Importer& compiler = jit_ && jit_async_state_ ? jit_async_wait() : compiler_;
+      // Not loaded when deserialized on a target without a matching library
+      std::string library = compiler.is_null() ? jit_library_ : compiler.library();
+      s.pack("FunctionInternal::jit_library", library);
       if (jit_serialize_=="embed") {
-        std::ifstream binary(compiler_.library(), std::ios_base::binary);
-        casadi_assert(binary.good(), "Could not open library '" + compiler_.library() + "'.");
-        s.pack("FunctionInternal::jit_binary", binary);
+        // Libraries by target key, the jitted library is keyed by the current target
+        std::map<std::string, std::string> bundle = jit_bundle_;
+        if (bundle.empty()) {
+          casadi_assert(!compiler.is_null(), "No library to embed.");
+          bundle[jit_target()] = read_library(library);
+        }
+        for (auto&& e : jit_binaries_) bundle[e.first] = read_library(e.second);
+        s.pack("FunctionInternal::jit_bundle", bundle);
       }
     }
     s.pack("FunctionInternal::jit_temp_suffix", jit_temp_suffix_);
+    s.pack("FunctionInternal::jit_async", jit_async_);
+    s.pack("FunctionInternal::jit_hot_calls", jit_hot_calls_);
+    s.pack("FunctionInternal::jit_hot_time", jit_hot_time_);
+    s.pack("FunctionInternal::jit_hot_expand", jit_hot_expand_);
     s.pack("FunctionInternal::jit_base_name", jit_base_name_);
     s.pack("FunctionInternal::jit_options", jit_options_);
     s.pack("FunctionInternal::compiler_plugin", compiler_plugin_);
@@ -3885,7 +4828,7 @@ namespace casadi {
   }
 
   FunctionInternal::FunctionInternal(DeserializingStream& s) : ProtoFunction(s) {
-    int version = s.version("FunctionInternal", 1, 6);
+    int version = s.version("FunctionInternal", 1, 9);
     s.unpack("FunctionInternal::is_diff_in", is_diff_in_);
     s.unpack("FunctionInternal::is_diff_out", is_diff_out_);
     s.unpack("FunctionInternal::sp_in", sparsity_in_);
@@ -3903,7 +4846,8 @@ namespace casadi {
     if (jit_serialize_=="link" || jit_serialize_=="embed") {
       std::string library;
       s.unpack("FunctionInternal::jit_library", library);
-      if (jit_serialize_=="embed") {
+      bool found = true, written = false;
+      if (jit_serialize_=="embed" && version < 9) {
         // If file already exist
         std::ifstream binary(library, std::ios_base::binary);
         if (binary.good()) { // library exists
@@ -3914,10 +4858,64 @@ namespace casadi {
           std::ofstream binary(library, std::ios_base::binary | std::ios_base::out);
           s.unpack("FunctionInternal::jit_binary", binary);
         }
+      } else if (jit_serialize_=="embed") {
+        s.unpack("FunctionInternal::jit_bundle", jit_bundle_);
+        // Pick the matching library with the most CPU features
+        std::string key;
+        casadi_int n_features = -1;
+        for (auto&& e : jit_bundle_) {
+          casadi_int n = jit_target_features(e.first);
+          if (n > n_features) {
+            key = e.first;
+            n_features = n;
+          }
+        }
+        found = n_features >= 0;
+        // If file already exist, ignore packed contents
+        std::ifstream binary(library, std::ios_base::binary);
+        if (found && !binary.good()) {
+          std::ofstream binary(library, std::ios_base::binary | std::ios_base::out);
+          binary << jit_bundle_[key];
+          written = true;
+        }
+        jit_library_ = library;
+      }
+      if (jit_serialize_=="link") {
+        compiler_ = Importer(library, "dll");
+      } else if (found) {
+        try {
+          compiler_ = Importer(library, "dll");
+        } catch (std::exception& e) {
+          casadi_warning("Could not load library '" + library + "' of function '" + name_
+            + "', evaluating without compiled code: " + std::string(e.what()));
+          if (written) std::remove(library.c_str());
+          found = false;
+        }
+      } else if (verbose_) {
+        casadi_message("No library of function '" + name_ + "' matches target '"
+          + jit_target() + "', evaluating without compiled code.");
       }
-      compiler_ = Importer(library, "dll");
+      // Fall back to the virtual machine
+      if (!found) jit_ = false;
     }
     s.unpack("FunctionInternal::jit_temp_suffix", jit_temp_suffix_);
+    if (version >= 7) {
+      s.unpack("FunctionInternal::jit_async", jit_async_);
+    } else {
+      jit_async_ = false;
+    }
+    if (version >= 8) {
+      s.unpack("FunctionInternal::jit_hot_calls", jit_hot_calls_);
+      s.unpack("FunctionInternal::jit_hot_time", jit_hot_time_);
+      s.unpack("FunctionInternal::jit_hot_expand", jit_hot_expand_);
+    } else {
+      jit_hot_calls_ = 0;
+      jit_hot_time_ = 0;
+      jit_hot_expand_ = false;
+    }
+    jit_hot_count_ = 0;
+    jit_hot_ns_ = 0;
+    jit_hot_started_ = false;
     s.unpack("FunctionInternal::jit_base_name", jit_base_name_);
     s.unpack("FunctionInternal::jit_options", jit_options_);
     s.unpack("FunctionInternal::compiler_plugin", compiler_plugin_);
@@ -4019,8 +5017,10 @@ namespace casadi {
       FunctionInternal::deserialize_map = {
     {"MXFunction", MXFunction::deserialize},
     {"SXFunction", SXFunction::deserialize},
+    {"SXTapeDerivative", SXTapeDerivative::deserialize},
     {"Interpolant", Interpolant::deserialize},
     {"Switch", Switch::deserialize},
+    {"LazyDerivative", LazyDerivative::deserialize},
     {"Map", Map::deserialize},
     {"MapSum", MapSum::deserialize},
     {"Nlpsol", Nlpsol::deserialize},
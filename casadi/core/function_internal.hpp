@@ -27,8 +27,9 @@
 #define CASADI_FUNCTION_INTERNAL_HPP
 
 #include "function.hpp"
+#include <atomic>
+#include <cstdint>
 #include <set>
-#include <stack>
 #include "code_generator.hpp"
 #include "importer.hpp"
 #include "options.hpp"
@@ -157,15 +158,21 @@ namespace casadi {
         \identifier{jm} */
     virtual void finalize();
 
-    /// Checkout a memory object
+    /** \brief Checkout a memory object
+
+        Lock-free, unless a new memory object needs to be allocated.
+    */
     int checkout() const;
 
-    /// Release a memory object
+    /// Release a memory object, lock-free
     void release(int mem) const;
 
-    /// Memory objects
+    /// Memory objects, lock-free
     void* memory(int ind) const;
 
+    /// Number of memory objects allocated so far
+    int n_mem() const { return n_mem_;}
+
     /** \brief Create memory block
 
         \identifier{jn} */
@@ -260,13 +267,38 @@ namespace casadi {
 #endif // CASADI_WITH_THREAD
 
   private:
-    /// Memory objects
-    mutable std::vector<void*> mem_;
+    /// Memory object and link in the stack of unused memory objects
+    struct MemSlot {
+      void* mem;
+      std::atomic<int> next;
+    };
+
+    /// Maximum number of blocks of memory slots
+    static const int n_mem_block = 31;
+
+    /// Initialize the memory pool, called from the constructors
+    void init_mem_pool();
+
+    /// Memory slot k, stored in block floor(log2(k+1))
+    MemSlot& mem_slot(int k) const;
+
+    /// Blocks of memory slots, block b has 2^b slots and is never reallocated
+    mutable std::atomic<MemSlot*> mem_block_[n_mem_block];
+
+    /// Number of memory objects
+    mutable std::atomic<int> n_mem_;
 
-    /// Unused memory objects
-    mutable std::stack<int> unused_;
+    /** \brief Stack of unused memory objects
+
+        Index of the top plus one (0 if empty) in the lower 32 bits,
+        a tag incremented at every update in the upper 32 bits to avoid ABA.
+    */
+    mutable std::atomic<uint64_t> unused_;
   };
 
+  // State of a just-in-time compilation in the background
+  struct JitAsync;
+
   /** \brief Internal class for Function
 
       \author Joel Andersson
@@ -345,6 +377,15 @@ namespace casadi {
     // Get all embedded functions, recursively
     virtual void find(std::map<FunctionInternal*, Function>& all_fun, casadi_int max_depth) const {}
 
+    /** \brief Memory footprint of the function and the functions it owns
+
+        Functions in \a visited are reported as shared and not counted again.
+    */
+    Dict memory_report(std::set<const FunctionInternal*>& visited) const;
+
+    /// Bytes used by the instruction list of a symbolic function, if any
+    virtual size_t instructions_bytes() const { return 0;}
+
     /** \brief Which variables enter with some order
 
     * \param[in] s_in Input name
@@ -365,6 +406,15 @@ namespace casadi {
     virtual bool has_sprev() const { return false;}
     ///@}
 
+    /** \brief Can sp_forward/sp_reverse be called concurrently?
+
+        When true, independent seed sweeps of the Jacobian sparsity detection
+        are distributed over the thread pool, each with private work vectors.
+        Requires that the propagation does not touch the memory object or
+        any other shared state.
+    */
+    virtual bool has_sp_threadsafe() const { return false;}
+
     ///@{
     /** \brief  Evaluate numerically
 
@@ -646,6 +696,25 @@ namespace casadi {
                                  const Dict& opts) const;
     ///@}
 
+    /// Helper function: Get name of Taylor coefficient function
+    static std::string taylor_name(const std::string& fcn, casadi_int order) {
+      return "tay" + str(order) + "_" + fcn;
+    }
+
+    ///@{
+    /** \brief Return function that calculates Taylor coefficients along a direction
+
+     *    taylor(order) returns a cached instance if available,
+     *    and calls <tt>Function get_taylor(casadi_int order)</tt>
+     *    if no cached version is available.
+     */
+    Function taylor(casadi_int order) const;
+    virtual Function get_taylor(casadi_int order, const std::string& name,
+                                const std::vector<std::string>& inames,
+                                const std::vector<std::string>& onames,
+                                const Dict& opts) const;
+    ///@}
+
     /** \brief Ensure that a matrix's sparsity is a horizontal multiple of another, or empty
 
         \identifier{26j} */
@@ -869,11 +938,59 @@ namespace casadi {
         \identifier{m3} */
     virtual bool has_codegen() const { return false;}
 
+    /** \brief Is generation of LLVM IR supported? */
+    virtual bool has_llvm() const { return false;}
+
+    /** \brief Generate LLVM IR for numerical evaluation
+
+        The module defines a function fname with the signature of eval_t.
+    */
+    virtual std::string llvm_ir(const std::string& fname) const;
+
+    /** \brief Is generation of a batched entry point supported? */
+    virtual bool has_codegen_batch() const { return false;}
+
+    /** \brief Generate a batched entry point fname evaluating n instances
+
+        Inputs and outputs are stored in struct-of-arrays layout: nonzero j of
+        instance k is found at position j*n+k. Also defines fname_work and
+        fname_size.
+    */
+    void codegen_batch(CodeGenerator& g, const std::string& fname, casadi_int n) const;
+
+    /** \brief Generate code for the body of a batched entry point */
+    virtual void codegen_batch_body(CodeGenerator& g, casadi_int n) const;
+
+    /** \brief Work vector length of a batched entry point */
+    virtual casadi_int codegen_batch_sz_w(const CodeGenerator& g, casadi_int n) const;
+
+    /** \brief Generate a CUDA/HIP kernel with a host driver fname
+
+        One thread evaluates one instance, with the same struct-of-arrays layout
+        as codegen_batch. Requires has_codegen_batch.
+    */
+    void codegen_cuda(CodeGenerator& g, const std::string& fname) const;
+
+    /** \brief Generate code for the body of a CUDA/HIP kernel, for instance k of n */
+    virtual void codegen_cuda_body(CodeGenerator& g) const;
+
     /** \brief Jit dependencies
 
         \identifier{m4} */
     virtual void jit_dependencies(const std::string& fname) {}
 
+    /** \brief Compile generated code in the background
+
+        Evaluation falls back to eval until the compiled code is ready.
+    */
+    void jit_async_start(const std::string& source);
+
+    /** \brief Wait for a background compilation to finish */
+    const Importer& jit_async_wait() const;
+
+    /** \brief Generate code and compile it in the background, when hot */
+    void jit_hot_start() const;
+
     /** \brief Export function in a specific language
 
         \identifier{m5} */
@@ -915,6 +1032,18 @@ namespace casadi {
         \identifier{mc} */
     virtual std::vector<std::string> get_free() const;
 
+    /** \brief Key of the function in the persistent sparsity cache
+
+        Hash of the serialized function, empty if it cannot be serialized.
+    */
+    std::string sparsity_cache_id() const;
+
+    /** \brief Key of a cached function in the persistent function cache
+
+        Empty if the persistent function cache is disabled or not applicable.
+    */
+    std::string function_cache_key(const std::string& fname, const std::string& suffix) const;
+
     /** \brief Get the unidirectional or bidirectional partition
 
         \identifier{md} */
@@ -1235,6 +1364,13 @@ namespace casadi {
         \identifier{nh} */
     std::string jit_serialize_;
 
+    /** \brief Precompiled libraries to embed, by target key */
+    std::map<std::string, std::string> jit_binaries_;
+
+    /** \brief Embedded libraries, by target key, and library file, when deserialized */
+    std::map<std::string, std::string> jit_bundle_;
+    std::string jit_library_;
+
     /** \brief  Name if jit source file
 
         \identifier{ni} */
@@ -1247,6 +1383,21 @@ namespace casadi {
         \identifier{nj} */
     bool jit_temp_suffix_;
 
+    /** \brief Compile in the background, evaluating without compiled code until ready */
+    bool jit_async_;
+
+    /** \brief Tiered compilation: evaluations, evaluation time before compiling, expand first */
+    casadi_int jit_hot_calls_;
+    double jit_hot_time_;
+    bool jit_hot_expand_;
+
+    /// Evaluations and cumulative evaluation time in nanoseconds, for tiered compilation
+    mutable std::atomic<casadi_int> jit_hot_count_;
+    mutable std::atomic<int64_t> jit_hot_ns_;
+
+    /// Tiered compilation has been triggered
+    mutable std::atomic<bool> jit_hot_started_;
+
     /** \brief Numerical evaluation redirected to a C function
 
         \identifier{nk} */
@@ -1279,10 +1430,17 @@ namespace casadi {
 
     /// Function cache
     mutable std::map<std::string, WeakRef> cache_;
+#ifdef CASADI_WITH_THREAD
+    /// Mutex for the function cache
+    mutable std::mutex cache_mtx_;
+#endif // CASADI_WITH_THREAD
 
     /// Cache for sparsities of the Jacobian blocks
     mutable std::vector<Sparsity> jac_sparsity_[2];
 
+    /// Hash of the serialized function, for the persistent sparsity cache
+    mutable std::string sparsity_cache_id_;
+
     /// If the function is the derivative of another function
     Function derivative_of_;
 
@@ -1294,6 +1452,9 @@ namespace casadi {
     Importer compiler_;
     Dict jit_options_;
 
+    /// Background compilation, if jit_async
+    std::shared_ptr<JitAsync> jit_async_state_;
+
     /// Penalty factor for using a complete Jacobian to calculate directional derivatives
     double jac_penalty_;
 
@@ -231,6 +231,9 @@ namespace casadi {
     static MatType triu2symm(const MatType &x);
     static MatType repsum(const MatType &x, casadi_int n, casadi_int m=1);
     static MatType diff(const MatType &x, casadi_int n=1, casadi_int axis=-1);
+    static MatType einstein_path(const std::vector<MatType>& A,
+      const std::vector< std::vector<casadi_int> >& dim_a, const std::vector<casadi_int>& dim_c,
+      const std::vector< std::vector<casadi_int> >& a, const std::vector<casadi_int>& c);
 
     static bool is_linear(const MatType &expr, const MatType &var);
     static bool is_quadratic(const MatType &expr, const MatType &var);
@@ -370,6 +373,20 @@ namespace casadi {
     }
     ///@}
 
+    /** \brief Compute any contraction of any number of dense tensors
+
+        einstein({A0, A1, ...}, {a0, a1, ...}, c) -> C
+
+        With the same index notation as the contraction of two tensors.
+        The tensors are contracted pairwise, in the order found by a greedy search
+        that picks the pair with the fewest multiply-adds first, as in opt_einsum. */
+    inline friend MatType
+      einstein(const std::vector<MatType>& A, const std::vector< std::vector<casadi_int> >& dim_a,
+        const std::vector<casadi_int>& dim_c,
+        const std::vector< std::vector<casadi_int> >& a, const std::vector<casadi_int>& c) {
+      return MatType::einstein_path(A, dim_a, dim_c, a, c);
+    }
+
     /** \brief Matrix divide (cf. slash '/' in MATLAB)
 
         \identifier{1bl} */
@@ -690,6 +707,9 @@ namespace casadi {
 
     /** \brief Common subexpression elimination
 
+        Structurally identical subexpressions, including commutative operations
+        with swapped operands, are merged in a single hash-based pass.
+
         \identifier{1co} */
     inline friend MatType cse(const MatType& e) {
       return MatType::cse({e}).at(0);
@@ -698,6 +718,9 @@ namespace casadi {
 
     /** \brief Common subexpression elimination
 
+        Structurally identical subexpressions, including commutative operations
+        with swapped operands, are merged in a single hash-based pass.
+
         \identifier{1cp} */
     inline friend std::vector<MatType> cse(const std::vector<MatType>& e) {
       return MatType::cse(e);
@@ -857,6 +880,12 @@ namespace casadi {
     ///@{
     /** \brief Hessian and (optionally) gradient
 
+        The option hessian_method selects how the Hessian is constructed: 'coloring'
+        (default) computes the Jacobian of the gradient with a star coloring of its
+        sparsity pattern, 'edge_pushing' (SX only) accumulates the nonzeros in a
+        single reverse sweep over the expression graph. The option is also accepted
+        by Function::factory, e.g. for the nlp_hess_l function of an nlpsol.
+
         \identifier{23z} */
     inline friend MatType hessian(const MatType &ex, const MatType &arg,
         const Dict& opts = Dict()) {
@@ -1409,6 +1438,81 @@ namespace casadi {
     return MatType::_rank1(A, alpha, x, y);
   }
 
+  template<typename MatType>
+  MatType GenericMatrix<MatType>::einstein_path(const std::vector<MatType>& A,
+      const std::vector< std::vector<casadi_int> >& dim_a, const std::vector<casadi_int>& dim_c,
+      const std::vector< std::vector<casadi_int> >& a, const std::vector<casadi_int>& c) {
+    casadi_assert(!A.empty(), "einstein: at least one tensor required");
+    casadi_assert(A.size()==dim_a.size() && A.size()==a.size(),
+      "einstein: dimension mismatch. Got " + str(A.size()) + " tensors, "
+      + str(dim_a.size()) + " dimensions and " + str(a.size()) + " indices");
+
+    // A single tensor is contracted with a scalar one
+    if (A.size()==1) return MatType::einstein(A[0], MatType(1), dim_a[0], {}, dim_c, a[0], {}, c);
+
+    // Dimensions of the indices
+    std::map<casadi_int, casadi_int> dim;
+    for (casadi_int i=0; i<A.size(); ++i) {
+      casadi_assert(dim_a[i].size()==a[i].size(), "einstein: dimension mismatch for tensor "
+        + str(i) + ": " + str(dim_a[i].size()) + " dimensions, " + str(a[i].size()) + " indices");
+      for (casadi_int j=0; j<a[i].size(); ++j) if (a[i][j]<0) dim[a[i][j]] = dim_a[i][j];
+    }
+
+    // Contract pairwise until two tensors remain
+    std::vector<MatType> t = A;
+    std::vector< std::vector<casadi_int> > dim_t = dim_a, t_ind = a;
+    while (t.size()>2) {
+      // Cheapest pair, with the fewest multiply-adds, then the smallest result
+      casadi_int best_i = -1, best_j = -1, best_cost = -1, best_size = -1;
+      std::vector<casadi_int> best_ind;
+      for (casadi_int i=0; i<t.size(); ++i) {
+        for (casadi_int j=i+1; j<t.size(); ++j) {
+          casadi_int cost = 1, size = 1;
+          std::vector<casadi_int> all_ind, r_ind;
+          for (const std::vector<casadi_int>* ind : {&t_ind[i], &t_ind[j]}) {
+            for (casadi_int e : *ind) {
+              if (e>=0 || std::find(all_ind.begin(), all_ind.end(), e)!=all_ind.end()) continue;
+              all_ind.push_back(e);
+              cost *= dim[e];
+              // Keep the index if needed by the result or by another tensor
+              bool keep = std::find(c.begin(), c.end(), e)!=c.end();
+              for (casadi_int k=0; k<t.size() && !keep; ++k) {
+                if (k==i || k==j) continue;
+                keep = std::find(t_ind[k].begin(), t_ind[k].end(), e)!=t_ind[k].end();
+              }
+              if (keep) {
+                r_ind.push_back(e);
+                size *= dim[e];
+              }
+            }
+          }
+          if (best_i<0 || cost<best_cost || (cost==best_cost && size<best_size)) {
+            best_i = i;
+            best_j = j;
+            best_cost = cost;
+            best_size = size;
+            best_ind = r_ind;
+          }
+        }
+      }
+
+      // Contract the pair
+      std::vector<casadi_int> dim_r;
+      for (casadi_int e : best_ind) dim_r.push_back(dim[e]);
+      MatType r = MatType::einstein(t[best_i], t[best_j], dim_t[best_i], dim_t[best_j], dim_r,
+        t_ind[best_i], t_ind[best_j], best_ind);
+      for (casadi_int k : {best_j, best_i}) {
+        t.erase(t.begin()+k);
+        dim_t.erase(dim_t.begin()+k);
+        t_ind.erase(t_ind.begin()+k);
+      }
+      t.push_back(r);
+      dim_t.push_back(dim_r);
+      t_ind.push_back(best_ind);
+    }
+    return MatType::einstein(t[0], t[1], dim_t[0], dim_t[1], dim_c, t_ind[0], t_ind[1], c);
+  }
+
   template<typename MatType>
   MatType GenericMatrix<MatType>::logsumexp(const MatType& x) {
     casadi_assert(x.is_dense(), "Argument must be dense");
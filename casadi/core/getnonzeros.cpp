@@ -482,6 +482,20 @@ namespace casadi {
   void GetNonzerosVector::generate(CodeGenerator& g,
                                     const std::vector<casadi_int>& arg,
                                     const std::vector<casadi_int>& res) const {
+    // Straight-line assignments
+    if (g.unroll_sparse()>0 && nz_.size()<=g.unroll_sparse()) {
+      std::string r = g.work(res[0], nnz()), a = g.work(arg[0], dep(0).nnz());
+      for (casadi_int k=0; k<nz_.size(); ++k) {
+        g << r << "[" << k << "] = ";
+        if (nz_[k]>=0) {
+          g << a << "[" << nz_[k] << "];\n";
+        } else {
+          g << "0;\n";
+        }
+      }
+      return;
+    }
+
     // Codegen the indices
     std::string ind = g.constant(nz_);
 
@@ -512,6 +526,21 @@ namespace casadi {
     return dep()->get_nzref(sp, nz_new);
   }
 
+  MX GetNonzeros::get_reshape(const Sparsity& sp) const {
+    // Same nonzeros, new sparsity pattern
+    return GetNonzeros::create(sp, dep(), all());
+  }
+
+  MX GetNonzeros::get_transpose() const {
+    if (sparsity().is_scalar()) return shared_from_this<MX>();
+    // Permute the nonzeros
+    std::vector<casadi_int> mapping;
+    Sparsity sp = sparsity().transpose(mapping);
+    std::vector<casadi_int> nz_all = all();
+    for (casadi_int& i : mapping) i = nz_all[i];
+    return GetNonzeros::create(sp, dep(), mapping);
+  }
+
   void GetNonzerosSlice::generate(CodeGenerator& g,
                                   const std::vector<casadi_int>& arg,
                                   const std::vector<casadi_int>& res) const {
@@ -86,6 +86,12 @@ namespace casadi {
     /// Get the nonzeros of matrix
     MX get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const override;
 
+    /// Reshape
+    MX get_reshape(const Sparsity& sp) const override;
+
+    /// Transpose
+    MX get_transpose() const override;
+
     /** \brief Deserialize without type information
 
         \identifier{i8} */
@@ -25,18 +25,34 @@
 
 #include "global_options.hpp"
 #include "exception.hpp"
+#include "casadi_logger.hpp"
 
 namespace casadi {
 
   bool GlobalOptions::simplification_on_the_fly = true;
+  bool GlobalOptions::hash_consing = false;
   bool GlobalOptions::hierarchical_sparsity = true;
 
+  std::string GlobalOptions::sparsity_cache;
+  casadi_int GlobalOptions::function_cache_size = 0;
+  std::string GlobalOptions::function_cache;
   std::string GlobalOptions::casadipath;
   std::string GlobalOptions::casadi_include_path;
 
   casadi_int GlobalOptions::max_num_dir = 64;
 
+  // By default, use all available cores
+  casadi_int GlobalOptions::max_num_threads = 0;
+
   // By default, use zero-based indexing
   casadi_int GlobalOptions::start_index = 0;
 
+  void GlobalOptions::setAsyncOutput(bool flag) {
+    Logger::set_async(flag);
+  }
+
+  bool GlobalOptions::getAsyncOutput() {
+    return Logger::is_async();
+  }
+
 } // namespace casadi
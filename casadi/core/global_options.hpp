@@ -60,6 +60,41 @@ namespace casadi {
           \identifier{17v} */
       static bool simplification_on_the_fly;
 
+      /** \brief Indicates whether SX nodes are hash-consed on construction
+
+      * A unary or binary operation with the same operation and dependencies as
+      * a live node returns that node instead of creating a duplicate.
+      * Default: false
+      */
+      static bool hash_consing;
+
+      /** \brief Directory of the persistent cache of Jacobian sparsity patterns
+
+      * Jacobian sparsity patterns and seed colorings are stored in this
+      * directory, keyed on a hash of the serialized function, and reused across
+      * processes. An empty string disables the cache.
+      * Default: ""
+      */
+      static std::string sparsity_cache;
+
+      /** \brief Number of cached derivative functions kept alive
+
+      * The most recently used functions from the function caches (derivatives,
+      * maps) are held by strong references, so that they are not rebuilt when
+      * no other reference exists. Zero means weak references only.
+      * Default: 0
+      */
+      static casadi_int function_cache_size;
+
+      /** \brief Directory of the persistent cache of derivative functions
+
+      * Functions added to the function caches are serialized to this directory,
+      * keyed on a hash of the serialized parent function, and reused across
+      * processes. An empty string disables the cache.
+      * Default: ""
+      */
+      static std::string function_cache;
+
       static std::string casadipath;
 
       static std::string casadi_include_path;
@@ -68,6 +103,8 @@ namespace casadi {
 
       static casadi_int max_num_dir;
 
+      static casadi_int max_num_threads;
+
       static casadi_int start_index;
 
 #endif //SWIG
@@ -75,10 +112,26 @@ namespace casadi {
       static void setSimplificationOnTheFly(bool flag) { simplification_on_the_fly = flag; }
       static bool getSimplificationOnTheFly() { return simplification_on_the_fly; }
 
+      // Setter and getter for hash_consing
+      static void setHashConsing(bool flag) { hash_consing = flag; }
+      static bool getHashConsing() { return hash_consing; }
+
       // Setter and getter for hierarchical_sparsity
       static void setHierarchicalSparsity(bool flag) { hierarchical_sparsity = flag; }
       static bool getHierarchicalSparsity() { return hierarchical_sparsity; }
 
+      // Setter and getter for sparsity_cache
+      static void setSparsityCache(const std::string & dir) { sparsity_cache = dir; }
+      static std::string getSparsityCache() { return sparsity_cache; }
+
+      // Setter and getter for function_cache_size
+      static void setFunctionCacheSize(casadi_int n) { function_cache_size = n; }
+      static casadi_int getFunctionCacheSize() { return function_cache_size; }
+
+      // Setter and getter for function_cache
+      static void setFunctionCache(const std::string & dir) { function_cache = dir; }
+      static std::string getFunctionCache() { return function_cache; }
+
       static void setCasadiPath(const std::string & path) { casadipath = path; }
       static std::string getCasadiPath() { return casadipath; }
 
@@ -88,6 +141,23 @@ namespace casadi {
       static void setMaxNumDir(casadi_int ndir) { max_num_dir=ndir; }
       static casadi_int getMaxNumDir() { return max_num_dir; }
 
+      /** \brief Number of threads used for thread-parallel evaluation
+
+      * Includes the calling thread. A value of 0 means hardware concurrency.
+      * Default: 0
+      */
+      static void setMaxNumThreads(casadi_int n) { max_num_threads=n; }
+      static casadi_int getMaxNumThreads() { return max_num_threads; }
+
+      /** \brief Write printed output from a background thread
+
+      * Keeps slow consoles and log sinks off the critical path of iterative
+      * solvers. Pending output is written out when disabled and at exit.
+      * Default: false
+      */
+      static void setAsyncOutput(bool flag);
+      static bool getAsyncOutput();
+
   };
 
 } // namespace casadi
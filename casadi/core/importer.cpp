@@ -34,6 +34,11 @@ namespace casadi {
   Importer::Importer(const std::string& name,
                            const std::string& compiler,
                            const Dict& opts) {
+    if (compiler=="dll" && opts.empty()) {
+      // Share the library with other importers
+      *this = DllLibrary::load(name);
+      return;
+    }
     if (compiler=="none") {
       own(new ImporterInternal(name));
     } else if (compiler=="dll") {
@@ -219,6 +219,42 @@ namespace casadi {
 
   }
 
+  // Loaded libraries, by file name
+  static std::map<std::string, WeakRef>& dll_registry() {
+    static auto* registry = new std::map<std::string, WeakRef>();
+    return *registry;
+  }
+
+#ifdef CASADI_WITH_THREAD
+  static std::mutex& dll_registry_mtx() {
+    static auto* mtx = new std::mutex();
+    return *mtx;
+  }
+#endif // CASADI_WITH_THREAD
+
+  Importer DllLibrary::load(const std::string& bin_name) {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(dll_registry_mtx());
+#endif // CASADI_WITH_THREAD
+    std::map<std::string, WeakRef>& registry = dll_registry();
+    // Reuse the library if still loaded
+    auto it = registry.find(bin_name);
+    if (it!=registry.end() && it->second.alive()) {
+      return shared_cast<Importer>(it->second.shared());
+    }
+    // Remove a lost reference, if any, to prevent uncontrolled growth
+    for (it = registry.begin(); it!=registry.end(); ++it) {
+      if (!it->second.alive()) {
+        registry.erase(it);
+        break;
+      }
+    }
+    // Load library
+    Importer ret = Importer::create(new DllLibrary(bin_name), Dict());
+    registry[bin_name] = ret;
+    return ret;
+  }
+
   void DllLibrary::init_handle() {
 
     std::vector<std::string> search_paths = get_search_paths();
@@ -194,6 +194,13 @@ namespace casadi {
     // Constructor
     explicit DllLibrary(const std::string& bin_name);
 
+    /** \brief Load a library, sharing it with other users of the same file name
+
+        Libraries are kept in a process-wide registry while referenced, so that
+        repeated calls for the same file reuse the loaded library.
+    */
+    static Importer load(const std::string& bin_name);
+
     void finalize() override;
 
     void init_handle();
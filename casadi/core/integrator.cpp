@@ -137,6 +137,16 @@ Function integrator(const std::string& name, const std::string& solver,
   if (dae.has_free()) {
     casadi_error("Cannot create '" + name + "' since " + str(dae.get_free()) + " are free.");
   }
+  // Batched integration of several trajectories?
+  auto batch_it = opts.find("batch");
+  if (batch_it != opts.end()) {
+    Dict batch_opts = opts;
+    batch_opts.erase("batch");
+    casadi_int K = batch_it->second;
+    casadi_assert(K >= 1, "Option 'batch' must be positive");
+    if (K > 1) return Integrator::create_batch(name, solver, dae, t0, tout, K, batch_opts);
+    return integrator(name, solver, dae, t0, tout, batch_opts);
+  }
   Integrator* intg = Integrator::getPlugin(solver).creator(name, dae, t0, tout);
   return intg->create_advanced(opts);
 }
@@ -239,6 +249,10 @@ Integrator::Integrator(const std::string& name, const Function& oracle,
   nfwd_ = 0;
   nadj_ = 0;
   print_stats_ = false;
+  ne_ = 0;
+  has_transition_ = false;
+  max_events_ = 20;
+  event_tol_ = 1e-12;
 }
 
 Integrator::~Integrator() {
@@ -342,6 +356,7 @@ int Integrator::eval(const double** arg, double** res,
 
   // Reset solver, take time to t0
   m->t = t0_;
+  m->nevents = 0;
   reset(m, x0, z0, p);
 
   // Next stop time due to step change in input
@@ -462,7 +477,29 @@ const Options Integrator::options_
       "Options to be passed down to the augmented integrator, if one is constructed."}},
     {"output_t0",
       {OT_BOOL,
-      "[DEPRECATED] Output the state at the initial time"}}
+      "[DEPRECATED] Output the state at the initial time"}},
+    {"batch",
+      {OT_INT,
+      "Number of trajectories to integrate simultaneously [1]. The trajectories share "
+      "a single solver instance operating on the stacked DAE and inputs/outputs are "
+      "concatenated horizontally, as for Function::map"}},
+    {"event_indicator",
+      {OT_FUNCTION,
+      "Event indicators with the DAE inputs (t, x, z, p, u). An event occurs when a "
+      "component changes sign and is located inside the integrator"}},
+    {"event_transition",
+      {OT_FUNCTION,
+      "State reinitialization (t, x, z, p, u) -> x applied at each event [default: none]"}},
+    {"event_direction",
+      {OT_INTVECTOR,
+      "Direction of the zero-crossings triggering each event: 1 for increasing, "
+      "-1 for decreasing, 0 for both [default: 0]"}},
+    {"max_events",
+      {OT_INT,
+      "Maximum number of events per evaluation [20]"}},
+    {"event_tol",
+      {OT_DOUBLE,
+      "Time tolerance for locating events by bisection [1e-12]"}}
     }
 };
 
@@ -473,6 +510,7 @@ void Integrator::init(const Dict& opts) {
   bool output_t0 = false;
   std::vector<double> grid;
   bool uses_legacy_options = false;
+  Function event_indicator, event_transition;
 
   // Read options
   for (auto&& op : opts) {
@@ -498,6 +536,16 @@ void Integrator::init(const Dict& opts) {
     } else if (op.first=="tf") {
       tf = op.second;
       uses_legacy_options = true;
+    } else if (op.first=="event_indicator") {
+      event_indicator = op.second;
+    } else if (op.first=="event_transition") {
+      event_transition = op.second;
+    } else if (op.first=="event_direction") {
+      event_dir_ = op.second;
+    } else if (op.first=="max_events") {
+      max_events_ = op.second;
+    } else if (op.first=="event_tol") {
+      event_tol_ = op.second;
     }
   }
 
@@ -539,6 +587,10 @@ void Integrator::init(const Dict& opts) {
   casadi_assert(oracle_.n_in() == DYN_NUM_IN, "DAE has wrong number of inputs");
   casadi_assert(oracle_.n_out() == DYN_NUM_OUT, "DAE has wrong number of outputs");
 
+  // Call the DAE function directly if the oracle merely wraps it
+  Function fwd_oracle = forwarded_function(oracle_);
+  if (!fwd_oracle.is_null()) oracle_ = fwd_oracle;
+
   // Consistency checks, input sparsities
   for (casadi_int i = 0; i < DYN_NUM_IN; ++i) {
     const Sparsity& sp = oracle_.sparsity_in(i);
@@ -637,6 +689,34 @@ void Integrator::init(const Dict& opts) {
     }
   }
 
+  // Event handling
+  if (!event_indicator.is_null()) {
+    casadi_assert(supports_events(), "Plugin '" + std::string(plugin_name())
+      + "' does not support events");
+    casadi_assert(nfwd_ == 0 && nadj_ == 0,
+      "Sensitivity analysis across events is not supported");
+    for (const Function* f : {&event_indicator, &event_transition}) {
+      if (f->is_null()) continue;
+      casadi_assert(f->n_in() == DYN_NUM_IN && f->n_out() == 1,
+        "Event functions must have the DAE inputs (t, x, z, p, u) and a single output");
+      casadi_assert(f->nnz_in(DYN_X) == nx1_ && f->nnz_in(DYN_Z) == nz1_
+        && f->nnz_in(DYN_P) == np1_ && f->nnz_in(DYN_U) == nu1_,
+        "Event function '" + f->name() + "' has inconsistent input dimensions");
+    }
+    ne_ = event_indicator.nnz_out(0);
+    set_function(event_indicator, "event_indicator");
+    if (event_dir_.empty()) event_dir_.resize(ne_, 0);
+    casadi_assert(event_dir_.size() == ne_, "'event_direction' has wrong length");
+    if (!event_transition.is_null()) {
+      casadi_assert(event_transition.nnz_out(0) == nx1_,
+        "Event transition must return the state");
+      has_transition_ = true;
+      set_function(event_transition, "event_transition");
+    }
+  } else {
+    casadi_assert(event_transition.is_null(), "'event_transition' requires 'event_indicator'");
+  }
+
   // Nominal values for states
   nom_x_ = oracle_.nominal_in(DYN_X);
   nom_z_ = oracle_.nominal_in(DYN_Z);
@@ -668,10 +748,62 @@ void Integrator::init(const Dict& opts) {
 int Integrator::init_mem(void* mem) const {
   if (OracleFunction::init_mem(mem)) return 1;
 
-  //auto m = static_cast<IntegratorMemory*>(mem);
+  auto m = static_cast<IntegratorMemory*>(mem);
+  m->nevents = 0;
+  m->e.resize(ne_);
+  m->e_prev.resize(ne_);
+  if (has_transition_) m->x_event.resize(nx_);
+  return 0;
+}
+
+Dict Integrator::get_stats(void* mem) const {
+  Dict stats = OracleFunction::get_stats(mem);
+  auto m = static_cast<IntegratorMemory*>(mem);
+  if (ne_ > 0) stats["nevents"] = m->nevents;
+  return stats;
+}
+
+int Integrator::calc_event(IntegratorMemory* m, double t, const double* x, const double* z,
+    const double* p, const double* u, double* e) const {
+  std::fill(m->arg, m->arg + DYN_NUM_IN, nullptr);
+  m->arg[DYN_T] = &t;
+  m->arg[DYN_X] = x;
+  m->arg[DYN_Z] = z;
+  m->arg[DYN_P] = p;
+  m->arg[DYN_U] = u;
+  m->res[0] = e;
+  return calc_function(m, "event_indicator");
+}
+
+int Integrator::calc_transition(IntegratorMemory* m, double t, double* x, const double* z,
+    const double* p, const double* u) const {
+  if (!has_transition_) return 0;
+  std::fill(m->arg, m->arg + DYN_NUM_IN, nullptr);
+  m->arg[DYN_T] = &t;
+  m->arg[DYN_X] = x;
+  m->arg[DYN_Z] = z;
+  m->arg[DYN_P] = p;
+  m->arg[DYN_U] = u;
+  m->res[0] = get_ptr(m->x_event);
+  if (calc_function(m, "event_transition")) return 1;
+  casadi_copy(get_ptr(m->x_event), nx_, x);
   return 0;
 }
 
+void Integrator::register_event(IntegratorMemory* m, double t) const {
+  if (verbose_) casadi_message("Event at t = " + str(t));
+  casadi_assert(++m->nevents <= max_events_,
+    "Maximum number of events (" + str(max_events_) + ") exceeded at t = " + str(t));
+}
+
+bool Integrator::event_crossed(const double* e0, const double* e1) const {
+  for (casadi_int i = 0; i < ne_; ++i) {
+    if (event_dir_[i] >= 0 && e0[i] < 0 && e1[i] >= 0) return true;
+    if (event_dir_[i] <= 0 && e0[i] > 0 && e1[i] <= 0) return true;
+  }
+  return false;
+}
+
 Function Integrator::augmented_dae() const {
   // If no sensitivities, augmented oracle is the oracle itself
   if (nfwd_ == 0) return oracle_;
@@ -1594,6 +1726,8 @@ FixedStepIntegrator::FixedStepIntegrator(const std::string& name, const Function
 
   // Default options
   nk_target_ = 20;
+  checkpoints_ = 0;
+  dense_output_ = false;
 }
 
 FixedStepIntegrator::~FixedStepIntegrator() {
@@ -1606,6 +1740,15 @@ const Options FixedStepIntegrator::options_
       {OT_INT,
       "Target number of finite elements. "
       "The actual number may be higher to accommodate all output times"}},
+    {"checkpoints",
+      {OT_INT,
+      "Number of checkpoints per control interval for the backward problem. "
+      "Forward steps between checkpoints are recomputed (binomial checkpointing). "
+      "Default: 0, store the state at every finite element"}},
+    {"dense_output",
+      {OT_BOOL,
+      "Take number_of_finite_elements uniform steps regardless of the output times and "
+      "evaluate the outputs with the continuous extension of the method. Default: false"}},
     {"simplify",
       {OT_BOOL,
       "Implement as MX Function (codegeneratable/serializable) default: false"}},
@@ -1691,11 +1834,22 @@ void FixedStepIntegrator::init(const Dict& opts) {
   for (auto&& op : opts) {
     if (op.first=="number_of_finite_elements") {
       nk_target_ = op.second;
+    } else if (op.first=="checkpoints") {
+      checkpoints_ = op.second;
+    } else if (op.first=="dense_output") {
+      dense_output_ = op.second;
     }
   }
 
   // Consistency check
   casadi_assert(nk_target_ > 0, "Number of finite elements must be strictly positive");
+  casadi_assert(checkpoints_ >= 0, "Number of checkpoints must be non-negative");
+  if (dense_output_) {
+    casadi_assert(nu_ == 0, "Dense output requires that there are no controls");
+    casadi_assert(nfwd_ == 0 && nadj_ == 0,
+      "Sensitivity analysis with dense output is not supported");
+    casadi_assert(ne_ == 0, "Dense output cannot be combined with events");
+  }
 
   // Target interval length
   double h_target = (tout_.back() - t0_) / nk_target_;
@@ -1705,7 +1859,13 @@ void FixedStepIntegrator::init(const Dict& opts) {
   disc_.push_back(0);
   double t_cur = t0_;
   for (double t_next : tout_) {
-    disc_.push_back(disc_.back() + std::ceil((t_next - t_cur) / h_target));
+    if (dense_output_) {
+      // Steps needed to reach t_next on the uniform grid
+      casadi_int k = std::ceil((t_next - t0_) / h_target - 1e-10);
+      disc_.push_back(std::min(std::max(k, disc_.back()), nk_target_));
+    } else {
+      disc_.push_back(disc_.back() + std::ceil((t_next - t_cur) / h_target));
+    }
     t_cur = t_next;
   }
 
@@ -1726,6 +1886,7 @@ void FixedStepIntegrator::init(const Dict& opts) {
   alloc_w(nq_, true); // q
   alloc_w(nv_, true); // v_prev
   alloc_w(nq_, true); // q_prev
+  if (dense_output_) alloc_w(dense_size(), true); // dense
 
   // Work vectors, backward problem
   alloc_w(nrv_, true); // rv
@@ -1736,8 +1897,13 @@ void FixedStepIntegrator::init(const Dict& opts) {
 
   // Allocate tape if backward states are present
   if (nrx_ > 0) {
-    alloc_w((disc_.back() + 1) * nx_, true); // x_tape
-    alloc_w(disc_.back() * nv_, true); // v_tape
+    if (checkpoints_ > 0) {
+      // State at the start of each control interval and the free checkpoints
+      alloc_w((nt() + checkpoints_) * (nx_ + nv_), true); // chk
+    } else {
+      alloc_w((disc_.back() + 1) * nx_, true); // x_tape
+      alloc_w(disc_.back() * nv_, true); // v_tape
+    }
   }
 }
 
@@ -1764,6 +1930,9 @@ void FixedStepIntegrator::set_work(void* mem, const double**& arg, double**& res
   m->q = w; w += nq_;
   m->v_prev = w; w += nv_;
   m->q_prev = w; w += nq_;
+  if (dense_output_) {
+    m->dense = w; w += dense_size();
+  }
 
   // Work vectors, backward problem
   m->rv = w; w += nrv_;
@@ -1774,8 +1943,12 @@ void FixedStepIntegrator::set_work(void* mem, const double**& arg, double**& res
 
   // Allocate tape if backward states are present
   if (nrx_ > 0) {
-    m->x_tape = w; w += (disc_.back() + 1) * nx_;
-    m->v_tape = w; w += disc_.back() * nv_;
+    if (checkpoints_ > 0) {
+      m->chk = w; w += (nt() + checkpoints_) * (nx_ + nv_);
+    } else {
+      m->x_tape = w; w += (disc_.back() + 1) * nx_;
+      m->v_tape = w; w += disc_.back() * nv_;
+    }
   }
 }
 
@@ -1793,10 +1966,46 @@ void FixedStepIntegrator::advance(IntegratorMemory* mem,
   // Set controls
   casadi_copy(u, nu_, m->u);
 
+  // Dense output: continue on the uniform grid, then interpolate
+  if (dense_output_) {
+    double h = (tout_.back() - t0_) / nk_target_;
+    for (casadi_int j = disc_[m->k]; j < disc_[m->k + 1]; ++j) {
+      casadi_copy(m->x, nx_, m->x_prev);
+      casadi_copy(m->v, nv_, m->v_prev);
+      casadi_copy(m->q, nq_, m->q_prev);
+      stepF(m, t0_ + j * h, h, m->x_prev, m->v_prev, m->x, m->v, m->q);
+      casadi_axpy(nq_, 1., m->q_prev, m->q);
+    }
+    casadi_int j = disc_[m->k + 1];
+    if (j == 0) {
+      // Still at the initial time
+      casadi_copy(m->x, nx_, x);
+      casadi_copy(m->z, nz_, z);
+      casadi_copy(m->q, nq_, q);
+    } else {
+      double t = t0_ + (j - 1) * h;
+      double theta = std::min(std::max((m->t_next - t) / h, 0.), 1.);
+      // Output times inside the same step share the step-dependent data
+      if (m->dense_k != j) {
+        dense_prepare(m, t, h, m->dense_k == j - 1);
+        m->dense_k = j;
+      }
+      interpolate(m, t, h, theta, x, z, q);
+    }
+    return;
+  }
+
   // Number of finite elements and time steps
   casadi_int nj = disc_[m->k + 1] - disc_[m->k];
   double h = (m->t_next - m->t) / nj;
 
+  // Checkpoint at the start of the control interval
+  if (nrx_ > 0 && checkpoints_ > 0) {
+    double* cp = m->chk + (nx_ + nv_) * m->k;
+    casadi_copy(m->x, nx_, cp);
+    casadi_copy(m->v, nv_, cp + nx_);
+  }
+
   // Take steps
   for (casadi_int j = 0; j < nj; ++j) {
     // Current time
@@ -1811,8 +2020,11 @@ void FixedStepIntegrator::advance(IntegratorMemory* mem,
     stepF(m, t, h, m->x_prev, m->v_prev, m->x, m->v, m->q);
     casadi_axpy(nq_, 1., m->q_prev, m->q);
 
+    // Locate events inside the step
+    if (ne_ > 0) event_step(m, t, h);
+
     // Save state, if needed
-    if (nrx_ > 0) {
+    if (nrx_ > 0 && checkpoints_ == 0) {
       casadi_int tapeind = disc_[m->k] + j;
       casadi_copy(m->x, nx_, m->x_tape + nx_ * (tapeind + 1));
       casadi_copy(m->v, nv_, m->v_tape + nv_ * tapeind);
@@ -1825,6 +2037,91 @@ void FixedStepIntegrator::advance(IntegratorMemory* mem,
   casadi_copy(m->q, nq_, q);
 }
 
+void FixedStepIntegrator::dense_prepare(FixedStepMemory* m, double t, double h,
+    bool consecutive) const {
+  // Derivatives at the start and at the end of the step
+  double *xdot0 = m->dense, *xdot1 = xdot0 + nx_, *qdot0 = xdot1 + nx_, *qdot1 = qdot0 + nq_;
+  // The end of the previous step is the start of this one
+  if (consecutive) {
+    casadi_copy(xdot1, nx_, xdot0);
+    casadi_copy(qdot1, nq_, qdot0);
+  }
+  for (casadi_int i = consecutive ? 1 : 0; i < 2; ++i) {
+    double ti = t + i * h;
+    std::fill(m->arg, m->arg + DYN_NUM_IN, nullptr);
+    m->arg[DYN_T] = &ti;
+    m->arg[DYN_X] = i == 0 ? m->x_prev : m->x;
+    m->arg[DYN_Z] = (i == 0 ? m->v_prev : m->v) + nv_ - nz_;
+    m->arg[DYN_P] = m->p;
+    m->arg[DYN_U] = m->u;
+    std::fill(m->res, m->res + DYN_NUM_OUT, nullptr);
+    m->res[DYN_ODE] = i == 0 ? xdot0 : xdot1;
+    m->res[DYN_QUAD] = i == 0 ? qdot0 : qdot1;
+    if (calc_function(m, "dae")) casadi_error("Evaluating the DAE right-hand side failed");
+  }
+}
+
+void FixedStepIntegrator::interpolate(FixedStepMemory* m, double t, double h, double theta,
+    double* x, double* z, double* q) const {
+  const double *xdot0 = m->dense, *xdot1 = xdot0 + nx_, *qdot0 = xdot1 + nx_,
+    *qdot1 = qdot0 + nq_;
+  // Cubic Hermite interpolation
+  double s2 = theta * theta, s3 = s2 * theta;
+  double h00 = 2 * s3 - 3 * s2 + 1, h10 = h * (s3 - 2 * s2 + theta);
+  double h01 = 3 * s2 - 2 * s3, h11 = h * (s3 - s2);
+  for (casadi_int i = 0; i < nx_; ++i) {
+    x[i] = h00 * m->x_prev[i] + h10 * xdot0[i] + h01 * m->x[i] + h11 * xdot1[i];
+  }
+  for (casadi_int i = 0; i < nq_; ++i) {
+    q[i] = h00 * m->q_prev[i] + h10 * qdot0[i] + h01 * m->q[i] + h11 * qdot1[i];
+  }
+  // Algebraic variables from the end of the step
+  casadi_copy(m->v + nv_ - nz_, nz_, z);
+}
+
+void FixedStepIntegrator::event_step(FixedStepMemory* m, double t, double h) const {
+  double *e = get_ptr(m->e), *e_prev = get_ptr(m->e_prev);
+  // Indicators at the start of the step, if not available from the previous step
+  if (m->k == 0 && t == t0_) calc_event(m, t, m->x_prev, m->z, m->p, m->u, e_prev);
+  // Start of the part of the step still to be checked
+  double ts = t, t_end = t + h;
+  while (true) {
+    // Indicators at the end of the step
+    calc_event(m, t_end, m->x, m->v + nv_ - nz_, m->p, m->u, e);
+    if (!event_crossed(e_prev, e)) break;
+    // Bisection on the step size, at most the precision of the step length
+    double lo = 0, hi = t_end - ts;
+    while (hi - lo > event_tol_ && lo + 0.5 * (hi - lo) > lo && lo + 0.5 * (hi - lo) < hi) {
+      double mid = lo + 0.5 * (hi - lo);
+      stepF(m, ts, mid, m->x_prev, m->v_prev, m->x, m->v, m->q);
+      calc_event(m, ts + mid, m->x, m->v + nv_ - nz_, m->p, m->u, e);
+      if (event_crossed(e_prev, e)) {
+        hi = mid;
+      } else {
+        lo = mid;
+      }
+    }
+    // Take the step up to just after the crossing
+    stepF(m, ts, hi, m->x_prev, m->v_prev, m->x, m->v, m->q);
+    casadi_axpy(nq_, 1., m->q_prev, m->q);
+    ts += hi;
+    register_event(m, ts);
+    // Reinitialize the state
+    calc_transition(m, ts, m->x, m->v + nv_ - nz_, m->p, m->u);
+    calc_event(m, ts, m->x, m->v + nv_ - nz_, m->p, m->u, e_prev);
+    // Done if the event is at the end of the step
+    if (t_end - ts <= event_tol_) return;
+    // Take the remainder of the step
+    casadi_copy(m->x, nx_, m->x_prev);
+    casadi_copy(m->v, nv_, m->v_prev);
+    casadi_copy(m->q, nq_, m->q_prev);
+    stepF(m, ts, t_end - ts, m->x_prev, m->v_prev, m->x, m->v, m->q);
+    casadi_axpy(nq_, 1., m->q_prev, m->q);
+  }
+  // Indicators at the start of the next step
+  std::copy(e, e + ne_, e_prev);
+}
+
 void FixedStepIntegrator::retreat(IntegratorMemory* mem, const double* u,
     double* rx, double* rq, double* uq) const {
   auto m = static_cast<FixedStepMemory*>(mem);
@@ -1836,25 +2133,18 @@ void FixedStepIntegrator::retreat(IntegratorMemory* mem, const double* u,
   casadi_int nj = disc_[m->k + 1] - disc_[m->k];
   double h = (m->t - m->t_next) / nj;
 
-  // Take steps
-  for (casadi_int j = nj; j-- > 0; ) {
-    // Current time
-    double t = m->t_next + j * h;
-
-    // Update the previous step
-    casadi_copy(m->rx, nrx_, m->rx_prev);
-    casadi_copy(m->rq, nrq_, m->rq_prev);
-    casadi_copy(m->uq, nuq_, m->uq_prev);
-
-    // Take step
-    casadi_int tapeind = disc_[m->k] + j;
-    stepB(m, t, h,
-      m->x_tape + nx_ * tapeind, m->x_tape + nx_ * (tapeind + 1),
-      m->v_tape + nv_ * tapeind,
-      m->rx_prev, m->rv, m->rx, m->rq, m->uq);
-    casadi_clear(m->rv, nrv_);
-    casadi_axpy(nrq_, 1., m->rq_prev, m->rq);
-    casadi_axpy(nuq_, 1., m->uq_prev, m->uq);
+  if (checkpoints_ > 0) {
+    // Recompute the forward steps from the checkpoint at the start of the control interval
+    retreat_segment(m, 0, nj, checkpoints_, m->chk + (nx_ + nv_) * m->k,
+      m->chk + (nx_ + nv_) * nt(), m->t_next, h);
+  } else {
+    // Take steps
+    for (casadi_int j = nj; j-- > 0; ) {
+      casadi_int tapeind = disc_[m->k] + j;
+      retreat_step(m, m->t_next + j * h, h,
+        m->x_tape + nx_ * tapeind, m->x_tape + nx_ * (tapeind + 1),
+        m->v_tape + nv_ * tapeind);
+    }
   }
 
   // Return to user
@@ -1863,6 +2153,68 @@ void FixedStepIntegrator::retreat(IntegratorMemory* mem, const double* u,
   casadi_copy(m->uq, nuq_, uq);
 }
 
+void FixedStepIntegrator::retreat_step(FixedStepMemory* m, double t, double h,
+    const double* x0, const double* xf, const double* vf) const {
+  // Update the previous step
+  casadi_copy(m->rx, nrx_, m->rx_prev);
+  casadi_copy(m->rq, nrq_, m->rq_prev);
+  casadi_copy(m->uq, nuq_, m->uq_prev);
+
+  // Take step
+  stepB(m, t, h, x0, xf, vf, m->rx_prev, m->rv, m->rx, m->rq, m->uq);
+  casadi_clear(m->rv, nrv_);
+  casadi_axpy(nrq_, 1., m->rq_prev, m->rq);
+  casadi_axpy(nuq_, 1., m->uq_prev, m->uq);
+}
+
+void FixedStepIntegrator::recompute(FixedStepMemory* m, casadi_int a, casadi_int b,
+    const double* cp, double t0, double h) const {
+  // The forward problem is complete, so its work vectors can be reused
+  casadi_copy(cp, nx_, m->x);
+  casadi_copy(cp + nx_, nv_, m->v);
+  for (casadi_int j = a; j < b; ++j) {
+    casadi_copy(m->x, nx_, m->x_prev);
+    casadi_copy(m->v, nv_, m->v_prev);
+    stepF(m, t0 + j * h, h, m->x_prev, m->v_prev, m->x, m->v, m->q);
+  }
+}
+
+/// Largest number of steps that can be reversed with s checkpoints and t forward sweeps
+static casadi_int binomial_steps(casadi_int s, casadi_int t) {
+  // (s+t)! / (s! t!), saturating
+  double r = 1;
+  for (casadi_int i = 1; i <= t; ++i) r = r * static_cast<double>(s + i) / static_cast<double>(i);
+  return r > 1e15 ? static_cast<casadi_int>(1e15) : static_cast<casadi_int>(r + 0.5);
+}
+
+void FixedStepIntegrator::retreat_segment(FixedStepMemory* m, casadi_int a, casadi_int b,
+    casadi_int s, const double* cp, double* slots, double t0, double h) const {
+  casadi_int n = b - a;
+  if (n <= 0) return;
+  if (n == 1 || s == 0) {
+    // Recompute from the checkpoint for each step, last step first
+    for (casadi_int j = b; j-- > a; ) {
+      recompute(m, a, j, cp, t0, h);
+      casadi_copy(m->x, nx_, m->x_prev);
+      casadi_copy(m->v, nv_, m->v_prev);
+      stepF(m, t0 + j * h, h, m->x_prev, m->v_prev, m->x, m->v, m->q);
+      retreat_step(m, t0 + j * h, h, m->x_prev, m->x, m->v);
+    }
+    return;
+  }
+  // Number of forward sweeps needed with s checkpoints
+  casadi_int t = 1;
+  while (binomial_steps(s, t) < n) ++t;
+  // Place a checkpoint such that the remaining steps can be reversed with one checkpoint less
+  casadi_int mid = a + std::max(n - binomial_steps(s - 1, t), casadi_int(1));
+  recompute(m, a, mid, cp, t0, h);
+  casadi_copy(m->x, nx_, slots);
+  casadi_copy(m->v, nv_, slots + nx_);
+  retreat_segment(m, mid, b, s - 1, slots, slots + nx_ + nv_, t0, h);
+  // The checkpoint slot is free again
+  retreat_segment(m, a, mid, s, cp, slots, t0, h);
+}
+
 void FixedStepIntegrator::stepF(FixedStepMemory* m, double t, double h,
     const double* x0, const double* v0, double* xf, double* vf, double* qf) const {
   // Evaluate nondifferentiated
@@ -1969,6 +2321,9 @@ void FixedStepIntegrator::reset(IntegratorMemory* mem, const double* x, const do
   // Get consistent initial conditions
   casadi_fill(m->v, nv_, std::numeric_limits<double>::quiet_NaN());
 
+  // No steps taken yet
+  m->dense_k = -1;
+
   // Add the first element in the tape
   if (nrx_ > 0) {
     casadi_copy(x, nx_, m->x_tape);
@@ -2018,10 +2373,27 @@ const Options ImplicitFixedStepIntegrator::options_
       "An implicit function solver"}},
     {"rootfinder_options",
       {OT_DICT,
-      "Options to be passed to the NLP Solver"}}
+      "Options to be passed to the NLP Solver"}},
+    {"block_triangular",
+      {OT_BOOL,
+      "Permute the equations of the implicit step to block triangular form (BTF) and solve "
+      "the diagonal blocks one after the other, each with its own rootfinder. Default: false"}}
     }
 };
 
+// Residual of the equations 'rows' of an implicit step as a function of the variables 'idx'
+template<typename XType>
+static Function btf_block_residual(const std::string& name, const Function& F,
+    const std::vector<casadi_int>& rows, const std::vector<casadi_int>& idx) {
+  std::vector<XType> arg = XType::get_input(F);
+  XType vb = XType::sym("vb", idx.size());
+  std::vector<XType> a = arg;
+  a[STEP_V0](idx) = vb;
+  XType res = F(a).at(STEP_VF)(rows);
+  return Function(name, {vb, arg[STEP_V0], arg[STEP_T], arg[STEP_H], arg[STEP_X0],
+    arg[STEP_P], arg[STEP_U]}, {res});
+}
+
 void ImplicitFixedStepIntegrator::init(const Dict& opts) {
   // Call the base class init
   FixedStepIntegrator::init(opts);
@@ -2029,6 +2401,7 @@ void ImplicitFixedStepIntegrator::init(const Dict& opts) {
   // Default (temporary) options
   std::string implicit_function_name = "newton";
   Dict rootfinder_options;
+  bool block_triangular = false;
 
   // Read options
   for (auto&& op : opts) {
@@ -2036,16 +2409,73 @@ void ImplicitFixedStepIntegrator::init(const Dict& opts) {
       implicit_function_name = op.second.to_string();
     } else if (op.first=="rootfinder_options") {
       rootfinder_options = op.second;
+    } else if (op.first=="block_triangular") {
+      block_triangular = op.second;
     }
   }
 
-  // Complete rootfinder dictionary
-  rootfinder_options["implicit_input"] = STEP_V0;
-  rootfinder_options["implicit_output"] = STEP_VF;
+  // Block triangular form of the implicit step equations
+  const Function& F = get_function("implicit_step");
+  std::vector<casadi_int> rowperm, colperm, rowblock, colblock, coarse_rowblock, coarse_colblock;
+  casadi_int nb = 1;
+  bool lower = false;
+  if (block_triangular) {
+    Sparsity sp = F.jac_sparsity(STEP_VF, STEP_V0);
+    nb = sp.btf(rowperm, colperm, rowblock, colblock, coarse_rowblock, coarse_colblock);
+    // Only square diagonal blocks can be solved one after the other
+    for (casadi_int b = 0; b < nb; ++b) {
+      if (rowblock[b + 1] - rowblock[b] != colblock[b + 1] - colblock[b]) nb = 1;
+    }
+    // Lower or upper block triangular?
+    std::vector<casadi_int> row_block(sp.size1()), col_block(sp.size2());
+    for (casadi_int b = 0; b < nb; ++b) {
+      for (casadi_int k = rowblock[b]; k < rowblock[b + 1]; ++k) row_block[rowperm[k]] = b;
+      for (casadi_int k = colblock[b]; k < colblock[b + 1]; ++k) col_block[colperm[k]] = b;
+    }
+    const casadi_int *colind = sp.colind(), *row = sp.row();
+    for (casadi_int c = 0; c < sp.size2(); ++c) {
+      for (casadi_int k = colind[c]; k < colind[c + 1]; ++k) {
+        if (col_block[c] < row_block[row[k]]) lower = true;
+      }
+    }
+    if (verbose_) casadi_message("Implicit step has " + str(nb) + " diagonal blocks");
+  }
+
+  Function rf;
+  if (nb > 1) {
+    // Solve the blocks in dependency order, the initial guess only enters as guess
+    rootfinder_options["implicit_input"] = 0;
+    rootfinder_options["implicit_output"] = 0;
+    bool sx = oracle_.is_a("SXFunction");
+    std::vector<MX> arg = F.mx_in();
+    MX v = MX::zeros(arg[STEP_V0].sparsity());
+    for (casadi_int i = 0; i < nb; ++i) {
+      casadi_int b = lower ? i : nb - 1 - i;
+      std::vector<casadi_int> rows(rowperm.begin() + rowblock[b],
+        rowperm.begin() + rowblock[b + 1]);
+      std::vector<casadi_int> idx(colperm.begin() + colblock[b],
+        colperm.begin() + colblock[b + 1]);
+      std::string bname = "implicit_step_" + str(b);
+      Function G = sx ? btf_block_residual<SX>(bname, F, rows, idx)
+        : btf_block_residual<MX>(bname, F, rows, idx);
+      Function rfb = rootfinder("step_" + str(b), implicit_function_name, G, rootfinder_options);
+      MX vb = rfb(std::vector<MX>{arg[STEP_V0](idx), v, arg[STEP_T], arg[STEP_H], arg[STEP_X0],
+        arg[STEP_P], arg[STEP_U]}).at(0);
+      v(idx) = vb;
+    }
+    std::vector<MX> a = arg;
+    a[STEP_V0] = v;
+    std::vector<MX> res = F(a);
+    res[STEP_VF] = v;
+    rf = Function("step", arg, res, F.name_in(), F.name_out());
+  } else {
+    // Complete rootfinder dictionary
+    rootfinder_options["implicit_input"] = STEP_V0;
+    rootfinder_options["implicit_output"] = STEP_VF;
 
-  // Allocate a solver
-  Function rf = rootfinder("step", implicit_function_name,
-    get_function("implicit_step"), rootfinder_options);
+    // Allocate a solver
+    rf = rootfinder("step", implicit_function_name, F, rootfinder_options);
+  }
   set_function(rf);
   if (nfwd_ > 0) set_function(rf.forward(nfwd_));
 
@@ -2114,10 +2544,84 @@ Function Integrator::map2oracle(const std::string& name,
   return Function(name, de_in, de_out, dyn_in(), dyn_out());
 }
 
+Function Integrator::forwarded_function(const Function& oracle) {
+  // Only MX oracles without free variables can be wrappers
+  if (!oracle.is_a("MXFunction") || oracle.has_free()) return Function();
+  // Inline the oracle
+  std::vector<MX> arg = oracle.mx_in(), res;
+  oracle.call(arg, res, true);
+  // Locate the call node through the (nonempty) ODE right-hand-side
+  if (!res.at(DYN_ODE).is_output()) return Function();
+  MX c = res.at(DYN_ODE).dep();
+  if (!c.is_call()) return Function();
+  Function f = c.which_function();
+  // Callee must have the DAE scheme and the same sparsity patterns
+  if (f.name_in() != dyn_in() || f.name_out() != dyn_out()) return Function();
+  for (casadi_int i = 0; i < DYN_NUM_IN; ++i) {
+    if (f.sparsity_in(i) != oracle.sparsity_in(i)) return Function();
+  }
+  for (casadi_int i = 0; i < DYN_NUM_OUT; ++i) {
+    if (f.sparsity_out(i) != oracle.sparsity_out(i)) return Function();
+  }
+  // Arguments must be passed on unmodified
+  for (casadi_int i = 0; i < DYN_NUM_IN; ++i) {
+    if (f.nnz_in(i) > 0 && !is_equal(c.dep(i), arg.at(i))) return Function();
+  }
+  // Results must be returned unmodified
+  for (casadi_int i = 0; i < DYN_NUM_OUT; ++i) {
+    if (f.nnz_out(i) == 0) continue;
+    if (!res.at(i).is_output() || res.at(i).which_output() != i
+      || !is_equal(res.at(i).dep(), c)) return Function();
+  }
+  return f;
+}
+
+Function Integrator::create_batch(const std::string& name, const std::string& solver,
+    const Function& dae, double t0, const std::vector<double>& tout, casadi_int K,
+    const Dict& opts) {
+  // Evaluate the DAE for all trajectories at once, sharing the time variable
+  Function dae_map = dae.map(dae.name() + "_batch", "serial", K, std::vector<casadi_int>{DYN_T},
+    std::vector<casadi_int>{});
+  std::vector<MX> dae_in(DYN_NUM_IN), dae_arg(DYN_NUM_IN);
+  for (casadi_int i = 0; i < DYN_NUM_IN; ++i) {
+    if (i == DYN_T) {
+      dae_in[i] = MX::sym(dyn_in(i), dae.sparsity_in(i));
+      dae_arg[i] = dae_in[i];
+    } else {
+      // Trajectory k occupies entries k*n, ..., (k+1)*n-1 of the stacked vector
+      casadi_int n = dae.nnz_in(i);
+      dae_in[i] = MX::sym(dyn_in(i), n * K);
+      dae_arg[i] = n == 0 ? MX(dae.size1_in(i), dae.size2_in(i) * K) : reshape(dae_in[i], n, K);
+    }
+  }
+  std::vector<MX> dae_res = dae_map(dae_arg);
+  for (MX& r : dae_res) r = vec(r);
+  Function stacked_dae(dae.name(), dae_in, dae_res, dyn_in(), dyn_out());
+  // Keep the stacked right-hand-side a flat SX expression if possible
+  if (dae.is_a("SXFunction")) stacked_dae = stacked_dae.expand();
+
+  // Integrator for the stacked system
+  Function I = integrator(name + "_stacked", solver, stacked_dae, t0, tout, opts);
+
+  // Convert between the stacked (n*K-by-c) and the concatenated (n-by-c*K) formats
+  std::vector<MX> ret_in(INTEGRATOR_NUM_IN), arg(INTEGRATOR_NUM_IN);
+  for (casadi_int i = 0; i < INTEGRATOR_NUM_IN; ++i) {
+    casadi_int n = I.size1_in(i) / K, c = I.size2_in(i);
+    ret_in[i] = MX::sym(integrator_in(i), n, c * K);
+    arg[i] = n == 0 ? MX(I.size1_in(i), c) : vertcat(horzsplit(ret_in[i], c));
+  }
+  std::vector<MX> res = I(arg), ret_out(INTEGRATOR_NUM_OUT);
+  for (casadi_int i = 0; i < INTEGRATOR_NUM_OUT; ++i) {
+    casadi_int n = I.size1_out(i) / K, c = I.size2_out(i);
+    ret_out[i] = n == 0 ? MX(n, c * K) : horzcat(vertsplit(res[i], n));
+  }
+  return Function(name, ret_in, ret_out, integrator_in(), integrator_out());
+}
+
 void Integrator::serialize_body(SerializingStream &s) const {
   OracleFunction::serialize_body(s);
 
-  s.version("Integrator", 2);
+  s.version("Integrator", 3);
 
   s.pack("Integrator::sp_jac_dae", sp_jac_dae_);
   s.pack("Integrator::sp_jac_rdae", sp_jac_rdae_);
@@ -2157,6 +2661,11 @@ void Integrator::serialize_body(SerializingStream &s) const {
   s.pack("Integrator::augmented_options", augmented_options_);
   s.pack("Integrator::opts", opts_);
   s.pack("Integrator::print_stats", print_stats_);
+  s.pack("Integrator::ne", ne_);
+  s.pack("Integrator::has_transition", has_transition_);
+  s.pack("Integrator::event_dir", event_dir_);
+  s.pack("Integrator::max_events", max_events_);
+  s.pack("Integrator::event_tol", event_tol_);
 }
 
 void Integrator::serialize_type(SerializingStream &s) const {
@@ -2169,7 +2678,7 @@ ProtoFunction* Integrator::deserialize(DeserializingStream& s) {
 }
 
 Integrator::Integrator(DeserializingStream & s) : OracleFunction(s) {
-  s.version("Integrator", 2);
+  int version = s.version("Integrator", 2, 3);
 
   s.unpack("Integrator::sp_jac_dae", sp_jac_dae_);
   s.unpack("Integrator::sp_jac_rdae", sp_jac_rdae_);
@@ -2209,13 +2718,27 @@ Integrator::Integrator(DeserializingStream & s) : OracleFunction(s) {
   s.unpack("Integrator::augmented_options", augmented_options_);
   s.unpack("Integrator::opts", opts_);
   s.unpack("Integrator::print_stats", print_stats_);
+  if (version >= 3) {
+    s.unpack("Integrator::ne", ne_);
+    s.unpack("Integrator::has_transition", has_transition_);
+    s.unpack("Integrator::event_dir", event_dir_);
+    s.unpack("Integrator::max_events", max_events_);
+    s.unpack("Integrator::event_tol", event_tol_);
+  } else {
+    ne_ = 0;
+    has_transition_ = false;
+    max_events_ = 20;
+    event_tol_ = 1e-12;
+  }
 }
 
 void FixedStepIntegrator::serialize_body(SerializingStream &s) const {
   Integrator::serialize_body(s);
 
-  s.version("FixedStepIntegrator", 3);
+  s.version("FixedStepIntegrator", 5);
   s.pack("FixedStepIntegrator::nk_target", nk_target_);
+  s.pack("FixedStepIntegrator::checkpoints", checkpoints_);
+  s.pack("FixedStepIntegrator::dense_output", dense_output_);
   s.pack("FixedStepIntegrator::disc", disc_);
   s.pack("FixedStepIntegrator::nv", nv_);
   s.pack("FixedStepIntegrator::nv1", nv1_);
@@ -2224,8 +2747,18 @@ void FixedStepIntegrator::serialize_body(SerializingStream &s) const {
 }
 
 FixedStepIntegrator::FixedStepIntegrator(DeserializingStream & s) : Integrator(s) {
-  s.version("FixedStepIntegrator", 3);
+  int version = s.version("FixedStepIntegrator", 3, 5);
   s.unpack("FixedStepIntegrator::nk_target", nk_target_);
+  if (version >= 4) {
+    s.unpack("FixedStepIntegrator::checkpoints", checkpoints_);
+  } else {
+    checkpoints_ = 0;
+  }
+  if (version >= 5) {
+    s.unpack("FixedStepIntegrator::dense_output", dense_output_);
+  } else {
+    dense_output_ = false;
+  }
   s.unpack("FixedStepIntegrator::disc", disc_);
   s.unpack("FixedStepIntegrator::nv", nv_);
   s.unpack("FixedStepIntegrator::nv1", nv1_);
@@ -47,6 +47,12 @@ struct CASADI_EXPORT IntegratorMemory : public OracleMemory {
   double t_next;
   // Next stop time due to step change in input, continuous
   double t_stop;
+  // Number of events in the current evaluation
+  casadi_int nevents;
+  // Event indicators, at the end and at the start of a step
+  std::vector<double> e, e_prev;
+  // State after an event transition
+  std::vector<double> x_event;
 };
 
 /// Memory struct, forward sparsity pattern propagation
@@ -183,6 +189,26 @@ Integrator : public OracleFunction, public PluginInterface<Integrator> {
       \identifier{1m4} */
   virtual void print_stats(IntegratorMemory* mem) const {}
 
+  /** \brief Get all statistics */
+  Dict get_stats(void* mem) const override;
+
+  /// Can the plugin locate events inside advance?
+  virtual bool supports_events() const { return false;}
+
+  /// Evaluate the event indicators
+  int calc_event(IntegratorMemory* m, double t, const double* x, const double* z,
+    const double* p, const double* u, double* e) const;
+
+  /// Apply the event transition, overwriting x
+  int calc_transition(IntegratorMemory* m, double t, double* x, const double* z,
+    const double* p, const double* u) const;
+
+  /// Count an event at time t, enforcing max_events
+  void register_event(IntegratorMemory* m, double t) const;
+
+  /// Has an event indicator changed sign from e0 to e1?
+  bool event_crossed(const double* e0, const double* e1) const;
+
   /// Forward sparsity pattern propagation through DAE, forward problem
   int fdae_sp_forward(SpForwardMem* m, const bvec_t* x,
     const bvec_t* p, const bvec_t* u, bvec_t* ode, bvec_t* alg) const;
@@ -347,6 +373,21 @@ Integrator : public OracleFunction, public PluginInterface<Integrator> {
   /// Options
   bool print_stats_;
 
+  /// Number of event indicators
+  casadi_int ne_;
+
+  /// Is there an event transition function?
+  bool has_transition_;
+
+  /// Direction of the zero-crossings for each event indicator
+  std::vector<casadi_int> event_dir_;
+
+  /// Maximum number of events per evaluation
+  casadi_int max_events_;
+
+  /// Time tolerance for event localization
+  double event_tol_;
+
   // Creator function for internal class
   typedef Integrator* (*Creator)(const std::string& name, const Function& oracle,
     double t0, const std::vector<double>& tout);
@@ -364,6 +405,18 @@ Integrator : public OracleFunction, public PluginInterface<Integrator> {
   template<typename XType>
   static Function map2oracle(const std::string& name, const std::map<std::string, XType>& d);
 
+  /** \brief Function called by an MX oracle that only forwards its arguments, if any
+
+      The callee must itself have the DAE scheme, e.g. an FmuFunction created with
+      DaeBuilder::create. Returns a null Function if there is no such callee.
+  */
+  static Function forwarded_function(const Function& oracle);
+
+  /// Create an integrator advancing K trajectories through one stacked DAE
+  static Function create_batch(const std::string& name, const std::string& solver,
+    const Function& dae, double t0, const std::vector<double>& tout, casadi_int K,
+    const Dict& opts);
+
   /** \brief Serialize an object without type information
 
       \identifier{1md} */
@@ -469,6 +522,15 @@ struct CASADI_EXPORT FixedStepMemory : public IntegratorMemory {
 
   /// State and dependent variables at all times
   double *x_tape, *v_tape;
+
+  /// Checkpointed state and dependent variables, if checkpointing
+  double *chk;
+
+  /// Step-dependent data of the continuous extension, if dense output
+  double *dense;
+
+  /// Number of steps taken when dense was last prepared, -1 if not valid
+  casadi_int dense_k;
 };
 
 class CASADI_EXPORT FixedStepIntegrator : public Integrator {
@@ -548,15 +610,53 @@ class CASADI_EXPORT FixedStepIntegrator : public Integrator {
   void stepF(FixedStepMemory* m, double t, double h,
     const double* x0, const double* v0, double* xf, double* vf, double* qf) const;
 
+  /// Events are located by bisection on the step size
+  bool supports_events() const override { return true;}
+
+  /// Locate and handle the events inside a step that has just been taken
+  void event_step(FixedStepMemory* m, double t, double h) const;
+
+  /// Size of the step-dependent data of the continuous extension
+  virtual casadi_int dense_size() const { return 2 * (nx_ + nq_);}
+
+  /** \brief Prepare the continuous extension of the last step [t, t+h]
+
+      Shared by all output times inside the step. If consecutive, the data was last
+      prepared for the step before.
+  */
+  virtual void dense_prepare(FixedStepMemory* m, double t, double h, bool consecutive) const;
+
+  /// Evaluate the continuous extension of the last step at t + theta*h, 0 <= theta <= 1
+  virtual void interpolate(FixedStepMemory* m, double t, double h, double theta,
+    double* x, double* z, double* q) const;
+
   /// Take integrator step backward
   void stepB(FixedStepMemory* m, double t, double h,
     const double* x0, const double* xf, const double* vf,
     const double* rx0, const double* rv0,
     double* rxf, double* rqf, double* uqf) const;
 
+  /// Take integrator step backward, accumulating the backward quadratures
+  void retreat_step(FixedStepMemory* m, double t, double h,
+    const double* x0, const double* xf, const double* vf) const;
+
+  /// Recompute the steps a..b-1 from the checkpoint cp, result in m->x and m->v
+  void recompute(FixedStepMemory* m, casadi_int a, casadi_int b, const double* cp,
+    double t0, double h) const;
+
+  /// Retreat over the steps a..b-1 with s free checkpoints (binomial checkpointing)
+  void retreat_segment(FixedStepMemory* m, casadi_int a, casadi_int b, casadi_int s,
+    const double* cp, double* slots, double t0, double h) const;
+
   // Target number of finite elements
   casadi_int nk_target_;
 
+  // Number of free checkpoints for the backward sweep, 0 if the whole trajectory is taped
+  casadi_int checkpoints_;
+
+  // Step freely on a uniform grid and interpolate at the output times
+  bool dense_output_;
+
   // Number of steps per control interval
   std::vector<casadi_int> disc_;
 
@@ -260,7 +260,7 @@ namespace casadi {
        {OT_STRINGVECTOR,
         "Specifies, for each grid dimension, the lookup algorithm used to find the correct index. "
         "'linear' uses a for-loop + break; (default when #knots<=100), "
-        "'exact' uses floored division (only for uniform grids), "
+        "'exact' uses floored division (only for uniform grids, default for them), "
         "'binary' uses a binary search. (default when #knots>100)."}},
       {"inline",
        {OT_BOOL,
@@ -321,20 +321,22 @@ namespace casadi {
     std::vector<casadi_int> ret;
     for (casadi_int i=0;i<offset.size()-1;++i) {
       casadi_int n = offset[i+1]-offset[i];
-      ret.push_back(Low::interpret_lookup_mode(modes.empty() ? "auto": modes[i], n));
-    }
+      std::string mode = modes.empty() ? "auto": modes[i];
+      ret.push_back(Low::interpret_lookup_mode(mode, n));
+      if (knots.empty()) continue;
 
-    for (casadi_int i=0;i<offset.size()-1;++i) {
+      casadi_int m_left  = margin_left.empty() ? 0 : margin_left[i];
+      casadi_int m_right = margin_right.empty() ? 0 : margin_right[i];
+
+      std::vector<double> grid(
+          knots.begin()+offset[i]+m_left,
+          knots.begin()+offset[i+1]-m_right);
       if (ret[i]==LOOKUP_EXACT) {
-        if (!knots.empty()) {
-          casadi_int m_left  = margin_left.empty() ? 0 : margin_left[i];
-          casadi_int m_right = margin_right.empty() ? 0 : margin_right[i];
-
-          std::vector<double> grid(
-              knots.begin()+offset[i]+m_left,
-              knots.begin()+offset[i+1]-m_right);
-          casadi_assert_dev(is_increasing(grid) && is_equally_spaced(grid));
-        }
+        casadi_assert_dev(is_increasing(grid) && is_equally_spaced(grid));
+      } else if (mode=="auto" && grid.size()>2 && is_increasing(grid) &&
+          is_equally_spaced(grid)) {
+        // Uniform grid: the interval can be computed directly
+        ret[i] = LOOKUP_EXACT;
       }
     }
     return ret;
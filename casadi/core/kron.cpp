@@ -0,0 +1,145 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "kron.hpp"
+#include "casadi_misc.hpp"
+
+namespace casadi {
+
+  Kron::Kron(const MX& a, const MX& b) {
+    set_dep(a, b);
+    set_sparsity(Sparsity::kron(a.sparsity(), b.sparsity()));
+  }
+
+  std::string Kron::disp(const std::vector<std::string>& arg) const {
+    return "kron(" + arg.at(0) + ", " + arg.at(1) + ")";
+  }
+
+  template<typename T>
+  int Kron::eval_gen(const T** arg, T** res, casadi_int* iw, T* w) const {
+    casadi_kron(arg[0], dep(0).sparsity(), arg[1], dep(1).sparsity(), res[0]);
+    return 0;
+  }
+
+  int Kron::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
+    return eval_gen<double>(arg, res, iw, w);
+  }
+
+  int Kron::eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const {
+    return eval_gen<SXElem>(arg, res, iw, w);
+  }
+
+  void Kron::eval_mx(const std::vector<MX>& arg, std::vector<MX>& res) const {
+    res[0] = MX::kron(arg[0], arg[1]);
+  }
+
+  int Kron::sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    const Sparsity& a_sp = dep(0).sparsity();
+    const Sparsity& b_sp = dep(1).sparsity();
+    const casadi_int *a_colind = a_sp.colind(), *b_colind = b_sp.colind();
+    bvec_t* r = res[0];
+    // Same order of the nonzeros as casadi_kron
+    for (casadi_int a_cc=0; a_cc<a_sp.size2(); ++a_cc) {
+      for (casadi_int b_cc=0; b_cc<b_sp.size2(); ++b_cc) {
+        for (casadi_int a_el=a_colind[a_cc]; a_el<a_colind[a_cc+1]; ++a_el) {
+          for (casadi_int b_el=b_colind[b_cc]; b_el<b_colind[b_cc+1]; ++b_el) {
+            *r++ = arg[0][a_el] | arg[1][b_el];
+          }
+        }
+      }
+    }
+    return 0;
+  }
+
+  int Kron::sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    const Sparsity& a_sp = dep(0).sparsity();
+    const Sparsity& b_sp = dep(1).sparsity();
+    const casadi_int *a_colind = a_sp.colind(), *b_colind = b_sp.colind();
+    bvec_t* r = res[0];
+    for (casadi_int a_cc=0; a_cc<a_sp.size2(); ++a_cc) {
+      for (casadi_int b_cc=0; b_cc<b_sp.size2(); ++b_cc) {
+        for (casadi_int a_el=a_colind[a_cc]; a_el<a_colind[a_cc+1]; ++a_el) {
+          for (casadi_int b_el=b_colind[b_cc]; b_el<b_colind[b_cc+1]; ++b_el) {
+            arg[0][a_el] |= *r;
+            arg[1][b_el] |= *r;
+            *r++ = 0;
+          }
+        }
+      }
+    }
+    return 0;
+  }
+
+  void Kron::ad_forward(const std::vector<std::vector<MX> >& fseed,
+                        std::vector<std::vector<MX> >& fsens) const {
+    for (casadi_int d=0; d<fsens.size(); ++d) {
+      fsens[d][0] = MX::kron(fseed[d][0], dep(1)) + MX::kron(dep(0), fseed[d][1]);
+    }
+  }
+
+  void Kron::ad_reverse(const std::vector<std::vector<MX> >& aseed,
+                        std::vector<std::vector<MX> >& asens) const {
+    const MX& a = dep(0);
+    const MX& b = dep(1);
+    casadi_int m = a.size1(), n = a.size2(), p = b.size1(), q = b.size2();
+    // Entry (i*p+k, j*q+l) of the seed is entry (k, i, l, j) of a p-by-m-by-q-by-n tensor
+    std::vector<casadi_int> dim_s = {p, m, q, n}, s = {-1, -2, -3, -4};
+    for (casadi_int d=0; d<asens.size(); ++d) {
+      MX seed = vec(densify(aseed[d][0]));
+      MX adj_a = MX::einstein(seed, vec(densify(b)), dim_s, {p, q}, {m, n},
+        s, {-1, -3}, {-2, -4});
+      MX adj_b = MX::einstein(seed, vec(densify(a)), dim_s, {m, n}, {p, q},
+        s, {-2, -4}, {-1, -3});
+      asens[d][0] += project(reshape(adj_a, m, n), a.sparsity());
+      asens[d][1] += project(reshape(adj_b, p, q), b.sparsity());
+    }
+  }
+
+  void Kron::generate(CodeGenerator& g,
+                      const std::vector<casadi_int>& arg,
+                      const std::vector<casadi_int>& res) const {
+    g << g.kron(g.work(arg[0], dep(0).nnz()), dep(0).sparsity(),
+                g.work(arg[1], dep(1).nnz()), dep(1).sparsity(),
+                g.work(res[0], nnz())) << "\n";
+  }
+
+  MX Kron::get_mac(const MX& y, const MX& z) const {
+    const MX& a = dep(0);
+    const MX& b = dep(1);
+    casadi_int m = a.size1(), n = a.size2(), p = b.size1(), q = b.size2();
+    // Multiply with the smaller factor first
+    bool b_first = p*q*n + p*n*m <= q*n*m + p*q*m;
+    std::vector<MX> cols = horzsplit(y);
+    for (MX& c : cols) {
+      MX x = reshape(c, q, n);
+      x = b_first ? mtimes(mtimes(b, x), a.T()) : mtimes(b, mtimes(x, a.T()));
+      c = vec(x);
+    }
+    MX ret = horzcat(cols);
+    return z.nnz()==0 ? ret : z + ret;
+  }
+
+} // namespace casadi
@@ -25,6 +25,7 @@
 
 #include "linsol_internal.hpp"
 #include "mx_node.hpp"
+#include "profiler.hpp"
 
 namespace casadi {
 
@@ -115,7 +116,10 @@ namespace casadi {
 
     if (m->t_total) m->fstats.at("sfact").tic();
     // Perform pivoting
-    if ((*this)->sfact(m, A)) return 1;
+    {
+      ProfilerScope profile(operator->(), "sfact");
+      if ((*this)->sfact(m, A)) return 1;
+    }
     if (m->t_total) m->fstats.at("sfact").toc();
 
     // Mark as (successfully) pivoted
@@ -139,7 +143,11 @@ namespace casadi {
 
     m->is_nfact = false;
     if (m->t_total) m->fstats.at("nfact").tic();
-    int flag = (*this)->nfact(m, A);
+    int flag;
+    {
+      ProfilerScope profile(operator->(), "nfact");
+      flag = (*this)->nfact(m, A);
+    }
     if (m->t_total) m->fstats.at("nfact").toc();
     if (flag && (*this)->regularity_check_) {
       // Collect nonzeros
@@ -188,7 +196,11 @@ namespace casadi {
     auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
     casadi_assert(m->is_nfact, "Linear system has not been factorized");
     if (m->t_total) m->fstats.at("solve").tic();
-    int ret = (*this)->solve(m, A, x, nrhs, tr);
+    int ret;
+    {
+      ProfilerScope profile(operator->(), "solve");
+      ret = (*this)->solve(m, A, x, nrhs, tr);
+    }
     if (m->t_total) m->fstats.at("solve").toc();
     return ret;
   }
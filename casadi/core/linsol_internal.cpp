@@ -25,8 +25,79 @@
 
 #include "linsol_internal.hpp"
 
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif //CASADI_WITH_THREAD
+
 namespace casadi {
 
+  /// Cached symbolic data with the pattern it was computed for
+  struct LinsolSymbolicEntry {
+    Sparsity sp;
+    std::weak_ptr<const void> data;
+  };
+
+  /// Symbolic data of all live linear solvers, by plugin, key and sparsity hash
+  typedef std::multimap<std::pair<std::string, std::size_t>, LinsolSymbolicEntry>
+    LinsolSymbolicCache;
+
+  static LinsolSymbolicCache& linsol_symbolic_cache() {
+    static LinsolSymbolicCache ret;
+    return ret;
+  }
+
+#ifdef CASADI_WITH_THREAD
+  static std::mutex linsol_symbolic_mtx;
+#endif //CASADI_WITH_THREAD
+
+  // Find a live entry
+  static std::shared_ptr<const void> linsol_symbolic_find(
+      const LinsolSymbolicCache::key_type& key, const Sparsity& sp) {
+    auto eq = linsol_symbolic_cache().equal_range(key);
+    for (auto it=eq.first; it!=eq.second; ++it) {
+      std::shared_ptr<const void> ret = it->second.data.lock();
+      if (ret && it->second.sp.is_equal(sp)) return ret;
+    }
+    return nullptr;
+  }
+
+  std::shared_ptr<const void> LinsolInternal::shared_symbolic(const std::string& key,
+      const std::function<std::shared_ptr<const void>()>& fcn) {
+    LinsolSymbolicCache::key_type k(std::string(plugin_name()) + ":" + key, sp_.hash());
+    {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(linsol_symbolic_mtx);
+#endif //CASADI_WITH_THREAD
+      symbolic_ = linsol_symbolic_find(k, sp_);
+      if (symbolic_) {
+        if (verbose_) casadi_message("Reusing symbolic factorization");
+        return symbolic_;
+      }
+    }
+    // Not holding the lock while computing, a concurrent duplicate is harmless
+    std::shared_ptr<const void> ret = fcn();
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(linsol_symbolic_mtx);
+#endif //CASADI_WITH_THREAD
+    symbolic_ = linsol_symbolic_find(k, sp_);
+    if (symbolic_) return symbolic_;
+    // Garbage collect entries of deleted solvers
+    LinsolSymbolicCache& cache = linsol_symbolic_cache();
+    for (auto it=cache.begin(); it!=cache.end();) {
+      if (it->second.data.expired()) {
+        it = cache.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    cache.insert(std::make_pair(k, LinsolSymbolicEntry{sp_, ret}));
+    return symbolic_ = ret;
+  }
+
   LinsolInternal::LinsolInternal(const std::string& name, const Sparsity& sp)
    : ProtoFunction(name), sp_(sp) {
   }
@@ -95,6 +166,30 @@ namespace casadi {
   }
 #endif
 
+  void LinsolInternal::refine(const double* A, double* x, casadi_int nrhs, bool tr,
+                              casadi_int n_iter, double* b, double* r,
+                              const std::function<void(double*)>& solve1) const {
+    casadi_int n = nrow();
+    for (casadi_int k=0; k<nrhs; ++k) {
+      casadi_copy(x, n, b);
+      // Initial solution
+      solve1(x);
+      for (casadi_int iter=0; iter<n_iter; ++iter) {
+        // Residual r = b - A*x
+        casadi_clear(r, n);
+        casadi_mv(A, sp_, x, r, tr);
+        for (casadi_int i=0; i<n; ++i) r[i] = b[i] - r[i];
+        // Correction
+        solve1(r);
+        casadi_axpy(n, 1., r, x);
+        // Stop when the correction no longer changes x
+        if (casadi_norm_inf(n, r) <= std::numeric_limits<double>::epsilon()
+                                     * casadi_norm_inf(n, x)) break;
+      }
+      x += n;
+    }
+  }
+
   int LinsolInternal::nfact(void* mem, const double* A) const {
     casadi_error("'nfact' not defined for " + class_name());
   }
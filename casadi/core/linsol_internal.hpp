@@ -29,6 +29,8 @@
 #include "linsol.hpp"
 #include "function_internal.hpp"
 #include "plugin_interface.hpp"
+#include <memory>
+#include <functional>
 
 /// \cond INTERNAL
 
@@ -117,6 +119,9 @@ namespace casadi {
     virtual void generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const;
 
+    /// Add functions called by the generated code
+    virtual void add_dependency(CodeGenerator& g) const {}
+
     // Creator function for internal class
     typedef LinsolInternal* (*Creator)(const std::string& name, const Sparsity& sp);
 
@@ -157,6 +162,34 @@ namespace casadi {
     Sparsity sp_;
 
   protected:
+    /** \brief Symbolic data shared between instances
+
+        Returns the object computed by the first call for the same plugin, an equal
+        sparsity pattern and the same key, as long as some instance still holds it.
+        The key should encode all options that affect the symbolic factorization. */
+    template<typename T>
+    std::shared_ptr<const T> shared_symbolic(const std::string& key,
+                                             const std::function<T()>& fcn) {
+      return std::static_pointer_cast<const T>(shared_symbolic(key,
+        std::function<std::shared_ptr<const void>()>([&fcn]() {
+          return std::shared_ptr<const void>(std::make_shared<const T>(fcn()));})));
+    }
+
+    /** \brief Symbolic data shared between instances, type erased */
+    std::shared_ptr<const void> shared_symbolic(const std::string& key,
+      const std::function<std::shared_ptr<const void>()>& fcn);
+
+    /** \brief Iterative refinement
+
+        Solves for nrhs right-hand-sides in x, starting with x = solve1(b) and updating
+        with x += solve1(b - A*x) at most n_iter times, where solve1 solves with an
+        approximate factorization in place. Work vectors b and r have length nrow. */
+    void refine(const double* A, double* x, casadi_int nrhs, bool tr, casadi_int n_iter,
+                double* b, double* r, const std::function<void(double*)>& solve1) const;
+
+    /// Symbolic data, keeps the entry of shared_symbolic alive
+    std::shared_ptr<const void> symbolic_;
+
     /** \brief Deserializing constructor
 
         \identifier{ec} */
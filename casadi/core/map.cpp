@@ -25,14 +25,26 @@
 
 #include "map.hpp"
 #include "serializing_stream.hpp"
-
-#ifdef CASADI_WITH_THREAD
-#ifdef CASADI_WITH_THREAD_MINGW
-#include <mingw.thread.h>
-#else // CASADI_WITH_THREAD_MINGW
-#include <thread>
-#endif // CASADI_WITH_THREAD_MINGW
-#endif // CASADI_WITH_THREAD
+#include "thread_pool.hpp"
+#include "sx_function.hpp"
+#include "conic_impl.hpp"
+#include "global_options.hpp"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif // __linux__
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif // MSG_NOSIGNAL
+#endif // _WIN32
 
 namespace casadi {
 
@@ -44,7 +56,14 @@ namespace casadi {
     } else if (parallelization== "openmp") {
       return Function::create(new OmpMap("ompmap" + suffix, f, n), Dict());
     } else if (parallelization== "thread") {
+      if (f.is_a("Conic", true)) {
+        return Function::create(new ConicMap("conicmap" + suffix, f, n), Dict());
+      }
       return Function::create(new ThreadMap("threadmap" + suffix, f, n), Dict());
+    } else if (parallelization== "simd") {
+      return Function::create(new SimdMap("simdmap" + suffix, f, n), Dict());
+    } else if (parallelization== "process") {
+      return Function::create(new ProcessMap("processmap" + suffix, f, n), Dict());
     } else {
       casadi_error("Unknown parallelization: " + parallelization);
     }
@@ -69,6 +88,21 @@ namespace casadi {
       || (recursive && Map::is_a(type, recursive));
   }
 
+  bool ConicMap::is_a(const std::string& type, bool recursive) const {
+    return type=="ConicMap"
+      || (recursive && ThreadMap::is_a(type, recursive));
+  }
+
+  bool SimdMap::is_a(const std::string& type, bool recursive) const {
+    return type=="SimdMap"
+      || (recursive && Map::is_a(type, recursive));
+  }
+
+  bool ProcessMap::is_a(const std::string& type, bool recursive) const {
+    return type=="ProcessMap"
+      || (recursive && Map::is_a(type, recursive));
+  }
+
  std::vector<std::string> Map::get_function() const {
     return {"f"};
   }
@@ -109,6 +143,12 @@ namespace casadi {
       return new OmpMap(s);
     } else if (class_name=="ThreadMap") {
       return new ThreadMap(s);
+    } else if (class_name=="ConicMap") {
+      return new ConicMap(s);
+    } else if (class_name=="SimdMap") {
+      return new SimdMap(s);
+    } else if (class_name=="ProcessMap") {
+      return new ProcessMap(s);
     } else {
       casadi_error("class name '" + class_name + "' unknown.");
     }
@@ -421,7 +461,7 @@ namespace casadi {
     clear_mem();
   }
 
-  void ThreadsWork(const Function& f, casadi_int i,
+  void ThreadsWork(const Function& f, casadi_int i, casadi_int slot,
       const double** arg, double** res,
       casadi_int* iw, double* w,
       casadi_int ind, int& ret) {
@@ -435,19 +475,19 @@ namespace casadi {
     f.sz_work(sz_arg, sz_res, sz_iw, sz_w);
 
     // Input buffers
-    const double** arg1 = arg + n_in + i*sz_arg;
+    const double** arg1 = arg + n_in + slot*sz_arg;
     for (casadi_int j=0; j<n_in; ++j) {
       arg1[j] = arg[j] ? arg[j] + i*f.nnz_in(j) : nullptr;
     }
 
     // Output buffers
-    double** res1 = res + n_out + i*sz_res;
+    double** res1 = res + n_out + slot*sz_res;
     for (casadi_int j=0; j<n_out; ++j) {
       res1[j] = res[j] ? res[j] + i*f.nnz_out(j) : nullptr;
     }
 
     try {
-      ret = f(arg1, res1, iw + i*sz_iw, w + i*sz_w, ind);
+      ret = f(arg1, res1, iw + slot*sz_iw, w + slot*sz_w, ind);
     } catch (std::exception& e) {
       ret = 1;
       casadi_warning("Exception raised: " + std::string(e.what()));
@@ -463,29 +503,25 @@ namespace casadi {
 #ifndef CASADI_WITH_THREAD
     return Map::eval(arg, res, iw, w, mem);
 #else // CASADI_WITH_THREAD
+    // Number of chunks, each processed by one thread with its own work vectors
+    casadi_int n_chunk = std::min(n_slot_, ThreadPool::instance().size());
+
     // Checkout memory objects
-    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_);
-    for (casadi_int i=0; i<n_; ++i) ind.emplace_back(f_);
+    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_chunk);
+    for (casadi_int k=0; k<n_chunk; ++k) ind.emplace_back(f_);
 
     // Allocate space for return values
-    std::vector<int> ret_values(n_);
-
-    // Spawn threads
-    std::vector<std::thread> threads;
-    for (casadi_int i=0; i<n_; ++i) {
-      // Why the lambda function?
-      // Because it was the first iteration to pass tests on MingGW
-      // using mingw-std-threads.
-      threads.emplace_back(
-        [i](const Function& f, const double** arg, double** res,
-            casadi_int* iw, double* w, casadi_int ind, int& ret) {
-              ThreadsWork(f, i, arg, res, iw, w, ind, ret);
-            },
-        std::ref(f_), arg, res, iw, w, casadi_int(ind[i]), std::ref(ret_values[i]));
-    }
-
-    // Join threads
-    for (auto && th : threads) th.join();
+    std::vector<int> ret_values(n_chunk, 0);
+
+    // Evaluate contiguous chunks of instances on the persistent workers
+    ThreadPool::instance().run(n_chunk, [&](casadi_int k) {
+      casadi_int i_begin = (k*n_)/n_chunk, i_end = ((k+1)*n_)/n_chunk;
+      for (casadi_int i=i_begin; i<i_end; ++i) {
+        int ret = 0;
+        ThreadsWork(f_, i, k, arg, res, iw, w, ind[k], ret);
+        ret_values[k] = ret_values[k] || ret;
+      }
+    });
 
     // Anticipate success
     int ret = 0;
@@ -497,8 +533,32 @@ namespace casadi {
 #endif // CASADI_WITH_THREAD
   }
 
+  bool ThreadMap::codegen_parallel(const CodeGenerator& g) const {
+    // Functions with memory would require thread-safe checkout in generated code
+    return g.thread_backend()!="serial" && n_slot_>1 && f_->codegen_mem_type().empty();
+  }
+
+  void ThreadMap::codegen_declarations(CodeGenerator& g) const {
+    Map::codegen_declarations(g);
+    if (codegen_parallel(g)) g.parallel_task(f_);
+  }
+
   void ThreadMap::codegen_body(CodeGenerator& g) const {
-    Map::codegen_body(g);
+    if (!codegen_parallel(g)) return Map::codegen_body(g);
+    // One task per chunk, each with its own work vectors, as in eval
+    g << "casadi_int k;\n"
+      << "int flag[" << n_slot_ << "];\n"
+      << "casadi_map_task d;\n"
+      << "d.arg = arg;\n"
+      << "d.res = res;\n"
+      << "d.iw = iw;\n"
+      << "d.w = w;\n"
+      << "d.n = " << n_ << ";\n"
+      << "d.n_chunk = " << n_slot_ << ";\n"
+      << "d.flag = flag;\n"
+      << "for (k=0; k<" << n_slot_ << "; ++k) flag[k] = 0;\n"
+      << g.parallel_for(str(n_slot_), g.parallel_task(f_), "&d") << ";\n"
+      << "for (k=0; k<" << n_slot_ << "; ++k) if (flag[k]) return 1;\n";
   }
 
   void ThreadMap::init(const Dict& opts) {
@@ -509,14 +569,379 @@ namespace casadi {
     // Call the initialization method of the base class
     Map::init(opts);
 
-    // Allocate memory for holding memory object references
-    alloc_iw(n_, true);
+    // Work vectors for parallel evaluation
+    init_slots();
+  }
+
+  ThreadMap::ThreadMap(DeserializingStream& s) : Map(s), n_slot_(0) {
+    // Not serialized, since it depends on the number of threads available
+    init_slots();
+  }
+
+  void ThreadMap::init_slots() {
+    // No need for more work vectors than concurrently running threads
+    n_slot_ = std::min(n_, ThreadPool::requested_size());
 
     // Allocate sufficient memory for parallel evaluation
-    alloc_arg(f_.sz_arg() * n_);
-    alloc_res(f_.sz_res() * n_);
-    alloc_w(f_.sz_w() * n_);
-    alloc_iw(f_.sz_iw() * n_);
+    alloc_arg(f_.sz_arg() * n_slot_);
+    alloc_res(f_.sz_res() * n_slot_);
+    alloc_w(f_.sz_w() * n_slot_);
+    alloc_iw(f_.sz_iw() * n_slot_);
+  }
+
+  ConicMap::~ConicMap() {
+    clear_mem();
+  }
+
+  int ConicMap::init_mem(void* mem) const {
+    if (ThreadMap::init_mem(mem)) return 1;
+    auto m = static_cast<ConicMapMemory*>(mem);
+    // Solver memory for every chunk, kept for all calls
+    for (casadi_int k=0; k<n_slot_; ++k) m->mem.push_back(f_.checkout());
+    m->success.resize(n_, false);
+    m->iter_count.resize(n_, -1);
+    m->unified_return_status.resize(n_, SOLVER_RET_UNKNOWN);
+    return 0;
+  }
+
+  void ConicMap::free_mem(void *mem) const {
+    auto m = static_cast<ConicMapMemory*>(mem);
+    for (int k : m->mem) f_.release(k);
+    delete m;
+  }
+
+  int ConicMap::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+    auto m = static_cast<ConicMapMemory*>(mem);
+
+    // Number of chunks, each solved with its own memory and work vectors
+    casadi_int n_chunk = std::min(n_slot_, ThreadPool::instance().size());
+
+    // Allocate space for return values
+    std::vector<int> ret_values(n_chunk, 0);
+
+    // Solve contiguous chunks of instances on the persistent workers
+    ThreadPool::instance().run(n_chunk, [&](casadi_int k) {
+      auto mk = static_cast<ConicMemory*>(f_->memory(m->mem[k]));
+      casadi_int i_begin = (k*n_)/n_chunk, i_end = ((k+1)*n_)/n_chunk;
+      for (casadi_int i=i_begin; i<i_end; ++i) {
+        int ret = 0;
+        ThreadsWork(f_, i, k, arg, res, iw, w, m->mem[k], ret);
+        ret_values[k] = ret_values[k] || ret;
+        m->success[i] = !ret && mk->d_qp.success;
+        m->iter_count[i] = mk->d_qp.iter_count;
+        m->unified_return_status[i] = mk->d_qp.unified_return_status;
+      }
+    });
+
+    // Compute aggregate return value
+    int ret = 0;
+    for (int e : ret_values) ret = ret || e;
+    return ret;
+  }
+
+  Dict ConicMap::get_stats(void* mem) const {
+    Dict stats = ThreadMap::get_stats(mem);
+    auto m = static_cast<ConicMapMemory*>(mem);
+    std::vector<std::string> unified_return_status;
+    for (auto e : m->unified_return_status) {
+      unified_return_status.push_back(string_from_UnifiedReturnStatus(e));
+    }
+    stats["success"] = m->success;
+    stats["iter_count"] = m->iter_count;
+    stats["unified_return_status"] = unified_return_status;
+    return stats;
+  }
+
+  const casadi_int SimdMap::max_batch;
+
+  SimdMap::~SimdMap() {
+    clear_mem();
+  }
+
+  void SimdMap::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    Map::init(opts);
+
+    // Work vectors for batched evaluation
+    init_batch();
+    if (verbose_ && batch_==0) {
+      casadi_message("Batched evaluation not possible for " + f_.class_name()
+                     + ", falling back to serial evaluation");
+    }
+  }
+
+  SimdMap::SimdMap(DeserializingStream& s) : Map(s), batch_(0) {
+    init_batch();
+  }
+
+  void SimdMap::init_batch() {
+    // Batching requires an SXFunction without free variables
+    batch_ = f_.is_a("SXFunction") && !f_.has_free() ? std::min(n_, max_batch) : 0;
+
+    // Allocate sufficient memory for batched evaluation
+    if (batch_ > 0) alloc_w(f_.sz_w() * batch_);
+  }
+
+  int SimdMap::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+    // Fall back to serial evaluation if needed
+    if (batch_==0) return Map::eval(arg, res, iw, w, mem);
+    const SXFunction* f = static_cast<const SXFunction*>(f_.get());
+    // Input and output buffers
+    const double** arg1 = arg+n_in_;
+    std::copy_n(arg, n_in_, arg1);
+    double** res1 = res+n_out_;
+    std::copy_n(res, n_out_, res1);
+    // Evaluate batch by batch, the last batch possibly incomplete
+    for (casadi_int i=0; i<n_; i+=batch_) {
+      casadi_int n_batch = std::min(batch_, n_-i);
+      if (f->eval_batch(arg1, res1, iw, w, n_batch)) return 1;
+      for (casadi_int j=0; j<n_in_; ++j) {
+        if (arg1[j]) arg1[j] += n_batch*f_.nnz_in(j);
+      }
+      for (casadi_int j=0; j<n_out_; ++j) {
+        if (res1[j]) res1[j] += n_batch*f_.nnz_out(j);
+      }
+    }
+    return 0;
+  }
+
+  void SimdMap::codegen_body(CodeGenerator& g) const {
+    Map::codegen_body(g);
+  }
+
+#ifndef _WIN32
+  // Send a message in full, false on failure
+  static bool process_send(int sock, const void* data, size_t n) {
+    const char* p = static_cast<const char*>(data);
+    while (n>0) {
+      ssize_t k = send(sock, p, n, MSG_NOSIGNAL);
+      if (k<0 && errno==EINTR) continue;
+      if (k<=0) return false;
+      p += k;
+      n -= k;
+    }
+    return true;
+  }
+
+  // Receive a message in full, false on failure or end of stream
+  static bool process_recv(int sock, void* data, size_t n) {
+    char* p = static_cast<char*>(data);
+    while (n>0) {
+      ssize_t k = recv(sock, p, n, 0);
+      if (k<0 && errno==EINTR) continue;
+      if (k<=0) return false;
+      p += k;
+      n -= k;
+    }
+    return true;
+  }
+
+  // Terminate and reap all workers of a memory object
+  static void process_stop(ProcessMapMemory* m) {
+    // A negative number of instances asks the worker to exit
+    casadi_int quit = -1;
+    for (int s : m->sock) {
+      process_send(s, &quit, sizeof(quit));
+      close(s);
+    }
+    for (int pid : m->pid) waitpid(pid, nullptr, 0);
+    m->sock.clear();
+    m->pid.clear();
+  }
+#endif // _WIN32
+
+  ProcessMap::~ProcessMap() {
+    clear_mem();
+  }
+
+  void ProcessMap::init(const Dict& opts) {
+#ifdef _WIN32
+    casadi_warning("Process parallelization is not available on Windows. "
+                   "Falling back to serial evaluation.");
+#endif // _WIN32
+    // Call the initialization method of the base class
+    Map::init(opts);
+
+    // One worker per requested thread, at most one per instance
+    n_worker_ = std::min(n_, ThreadPool::requested_size());
+  }
+
+  ProcessMap::ProcessMap(DeserializingStream& s) : Map(s) {
+    // Not serialized, since it depends on the number of threads available
+    n_worker_ = std::min(n_, ThreadPool::requested_size());
+  }
+
+  void ProcessMap::free_mem(void *mem) const {
+    auto m = static_cast<ProcessMapMemory*>(mem);
+#ifndef _WIN32
+    process_stop(m);
+#endif // _WIN32
+    delete m;
+  }
+
+  int ProcessMap::start_workers(ProcessMapMemory* m) const {
+#ifdef _WIN32
+    return 1;
+#else // _WIN32
+    // Serialized function, shipped to every worker once
+    std::string fs = f_.serialize();
+    casadi_int sz = fs.size();
+    for (casadi_int k=0; k<n_worker_; ++k) {
+      int sv[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) {
+        casadi_warning("Could not create socket: " + std::string(strerror(errno)));
+        process_stop(m);
+        return 1;
+      }
+#ifdef SO_NOSIGPIPE
+      int on = 1;
+      setsockopt(sv[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif // SO_NOSIGPIPE
+      pid_t pid = fork();
+      if (pid==0) {
+        // Worker: exit with the parent, no threads of its own
+#ifdef __linux__
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+#endif // __linux__
+        close(sv[0]);
+        for (int s : m->sock) close(s);
+        GlobalOptions::setMaxNumThreads(1);
+        worker(sv[1]);
+        _exit(0);
+      }
+      close(sv[1]);
+      if (pid<0) {
+        casadi_warning("Could not start worker process: " + std::string(strerror(errno)));
+        close(sv[0]);
+        process_stop(m);
+        return 1;
+      }
+      m->pid.push_back(pid);
+      m->sock.push_back(sv[0]);
+      if (!process_send(sv[0], &sz, sizeof(sz)) || !process_send(sv[0], fs.data(), sz)) {
+        casadi_warning("Could not send function to worker process");
+        process_stop(m);
+        return 1;
+      }
+    }
+    return 0;
+#endif // _WIN32
+  }
+
+  void ProcessMap::worker(int sock) {
+#ifndef _WIN32
+    // Receive the function
+    casadi_int sz;
+    if (!process_recv(sock, &sz, sizeof(sz))) return;
+    std::string fs(sz, ' ');
+    if (!process_recv(sock, &fs[0], sz)) return;
+    Function f;
+    try {
+      f = Function::deserialize(fs);
+    } catch (std::exception& e) {
+      casadi_warning("Worker process could not deserialize function: "
+        + std::string(e.what()));
+      return;
+    }
+    casadi_int n_in = f.n_in(), n_out = f.n_out();
+
+    // Work vectors
+    std::vector<const double*> arg(f.sz_arg());
+    std::vector<double*> res(f.sz_res());
+    std::vector<casadi_int> iw(f.sz_iw());
+    std::vector<double> w(f.sz_w());
+    std::vector<std::vector<double>> arg_buf(n_in), res_buf(n_out);
+    scoped_checkout<Function> mem(f);
+
+    // Number of instances and mask of the inputs and outputs present
+    std::vector<casadi_int> header(1 + n_in + n_out);
+    while (process_recv(sock, get_ptr(header), header.size()*sizeof(casadi_int))) {
+      casadi_int n_inst = header[0];
+      if (n_inst<0) return;
+      // Receive input nonzeros
+      for (casadi_int j=0; j<n_in; ++j) {
+        arg_buf[j].resize(header[1+j] ? n_inst*f.nnz_in(j) : 0);
+        if (!process_recv(sock, get_ptr(arg_buf[j]), arg_buf[j].size()*sizeof(double))) return;
+      }
+      for (casadi_int j=0; j<n_out; ++j) {
+        res_buf[j].resize(header[1+n_in+j] ? n_inst*f.nnz_out(j) : 0);
+      }
+      // Evaluate all instances of the chunk
+      int flag = 0;
+      for (casadi_int i=0; i<n_inst; ++i) {
+        for (casadi_int j=0; j<n_in; ++j) {
+          arg[j] = header[1+j] ? get_ptr(arg_buf[j]) + i*f.nnz_in(j) : nullptr;
+        }
+        for (casadi_int j=0; j<n_out; ++j) {
+          res[j] = header[1+n_in+j] ? get_ptr(res_buf[j]) + i*f.nnz_out(j) : nullptr;
+        }
+        try {
+          if (f(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), mem)) flag = 1;
+        } catch (std::exception& e) {
+          flag = 1;
+          casadi_warning("Exception raised: " + std::string(e.what()));
+        }
+      }
+      // Reply with output nonzeros and return flag
+      for (casadi_int j=0; j<n_out; ++j) {
+        if (!process_send(sock, get_ptr(res_buf[j]), res_buf[j].size()*sizeof(double))) return;
+      }
+      if (!process_send(sock, &flag, sizeof(flag))) return;
+    }
+#endif // _WIN32
+  }
+
+  int ProcessMap::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+#ifdef _WIN32
+    return Map::eval(arg, res, iw, w, mem);
+#else // _WIN32
+    auto m = static_cast<ProcessMapMemory*>(mem);
+    if (m->sock.empty() && start_workers(m)) return 1;
+    casadi_int n_chunk = m->sock.size();
+
+    // Header of every request: number of instances, inputs and outputs present
+    std::vector<casadi_int> header(1 + n_in_ + n_out_);
+    for (casadi_int j=0; j<n_in_; ++j) header[1+j] = arg[j]!=nullptr;
+    for (casadi_int j=0; j<n_out_; ++j) header[1+n_in_+j] = res[j]!=nullptr;
+
+    // Send a contiguous chunk of instances to every worker
+    bool ok = true;
+    for (casadi_int k=0; k<n_chunk && ok; ++k) {
+      casadi_int i_begin = (k*n_)/n_chunk, i_end = ((k+1)*n_)/n_chunk;
+      header[0] = i_end - i_begin;
+      ok = process_send(m->sock[k], get_ptr(header), header.size()*sizeof(casadi_int));
+      for (casadi_int j=0; j<n_in_ && ok; ++j) {
+        if (!arg[j]) continue;
+        casadi_int nnz = f_.nnz_in(j);
+        ok = process_send(m->sock[k], arg[j] + i_begin*nnz, header[0]*nnz*sizeof(double));
+      }
+    }
+
+    // Collect the results
+    int ret = 0;
+    for (casadi_int k=0; k<n_chunk && ok; ++k) {
+      casadi_int i_begin = (k*n_)/n_chunk, i_end = ((k+1)*n_)/n_chunk;
+      for (casadi_int j=0; j<n_out_ && ok; ++j) {
+        if (!res[j]) continue;
+        casadi_int nnz = f_.nnz_out(j);
+        ok = process_recv(m->sock[k], res[j] + i_begin*nnz, (i_end-i_begin)*nnz*sizeof(double));
+      }
+      int flag = 1;
+      ok = ok && process_recv(m->sock[k], &flag, sizeof(flag));
+      ret = ret || flag;
+    }
+
+    // Lost contact with a worker: restart all of them on the next call
+    if (!ok) {
+      casadi_warning("Communication with worker process failed");
+      process_stop(m);
+      return 1;
+    }
+    return ret;
+#endif // _WIN32
   }
 
 } // namespace casadi
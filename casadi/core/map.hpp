@@ -266,8 +266,9 @@ namespace casadi {
   };
 
   /** A map Evaluate in parallel using std::thread
-      Note: Do not use this class with much more than the intended number of
-      threads for the parallel evaluation as it will cause excessive memory use.
+      The evaluations are divided into contiguous chunks, which are handed to the
+      persistent workers of ThreadPool. At most GlobalOptions::getMaxNumThreads()
+      chunks are executed concurrently, each with its own work vectors.
 
       \author Joris Gillis
       \date 2018
@@ -276,7 +277,8 @@ namespace casadi {
     friend class Map;
   public:
     // Constructor (protected, use create function in Map)
-    ThreadMap(const std::string& name, const Function& f, casadi_int n) : Map(name, f, n) {}
+    ThreadMap(const std::string& name, const Function& f, casadi_int n)
+      : Map(name, f, n), n_slot_(0) {}
 
     /** \brief  Destructor
 
@@ -304,6 +306,9 @@ namespace casadi {
     /// Type of parallellization
     std::string parallelization() const override { return "thread"; }
 
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
     /** \brief Generate code for the body of the C function
 
         \identifier{hy} */
@@ -313,7 +318,186 @@ namespace casadi {
     /** \brief Deserializing constructor
 
         \identifier{hz} */
-    explicit ThreadMap(DeserializingStream& s) : Map(s) {}
+    explicit ThreadMap(DeserializingStream& s);
+
+    // Set the number of slots and allocate work vectors for them
+    void init_slots();
+
+    // Evaluate chunks in parallel in generated code?
+    bool codegen_parallel(const CodeGenerator& g) const;
+
+    // Number of work vector slots, i.e. maximum number of concurrent chunks
+    casadi_int n_slot_;
+  };
+
+  /** A map Evaluate with instruction-level batching
+      For SXFunction bodies, each instruction is executed for a batch of
+      instances at a time (see SXFunction::eval_batch), allowing the compiler
+      to emit SIMD instructions for the inner loops. Other functions are
+      evaluated serially.
+  */
+  class CASADI_EXPORT SimdMap : public Map {
+    friend class Map;
+  public:
+    // Constructor (protected, use create function in Map)
+    SimdMap(const std::string& name, const Function& f, casadi_int n)
+      : Map(name, f, n), batch_(0) {}
+
+    /** \brief  Destructor */
+    ~SimdMap() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "SimdMap";}
+
+    /** \brief Check if the function is of a particular type */
+    bool is_a(const std::string& type, bool recursive) const override;
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /// Type of parallellization
+    std::string parallelization() const override { return "simd"; }
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /// Number of instances in a batch, a multiple of the widest common SIMD register
+    static const casadi_int max_batch = 8;
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit SimdMap(DeserializingStream& s);
+
+    // Set the batch size and allocate work vectors for it
+    void init_batch();
+
+    // Number of instances evaluated together, 0 if batching is not possible
+    casadi_int batch_;
+  };
+
+  /** \brief Memory of a ProcessMap */
+  struct CASADI_EXPORT ProcessMapMemory : public FunctionMemory {
+    // Process id and socket of every worker, started on first evaluation
+    std::vector<int> pid, sock;
+  };
+
+  /** A map Evaluate in separate worker processes
+
+      Every memory object of the map owns a set of worker processes, forked on
+      the first evaluation. The serialized function is sent to each worker
+      once, after which only the nonzeros of the inputs and outputs of a
+      contiguous chunk of instances are exchanged over a socket per call.
+      Intended for expensive functions that should not share a process, e.g.
+      because they are not thread-safe or hold the GIL. Derivatives are mapped
+      with the same backend. Without POSIX process support, the evaluation
+      falls back to serial.
+  */
+  class CASADI_EXPORT ProcessMap : public Map {
+    friend class Map;
+  public:
+    // Constructor (protected, use create function in Map)
+    ProcessMap(const std::string& name, const Function& f, casadi_int n)
+      : Map(name, f, n), n_worker_(0) {}
+
+    /** \brief  Destructor */
+    ~ProcessMap() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "ProcessMap";}
+
+    /** \brief Check if the function is of a particular type */
+    bool is_a(const std::string& type, bool recursive) const override;
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /// Type of parallellization
+    std::string parallelization() const override { return "process"; }
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new ProcessMapMemory();}
+
+    /** \brief Free memory block, terminating the workers */
+    void free_mem(void *mem) const override;
+
+    /** \brief Serve evaluation requests on a socket until it is closed
+
+        Reads a serialized function, then repeatedly a chunk of input nonzeros,
+        replying with the output nonzeros and a return flag.
+    */
+    static void worker(int sock);
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit ProcessMap(DeserializingStream& s);
+
+    // Start the worker processes
+    int start_workers(ProcessMapMemory* m) const;
+
+    // Number of worker processes per memory object
+    casadi_int n_worker_;
+  };
+
+  /** \brief Memory of a ConicMap */
+  struct CASADI_EXPORT ConicMapMemory : public FunctionMemory {
+    // Memory objects of the QP solver, one per chunk
+    std::vector<int> mem;
+
+    // Statistics per instance
+    std::vector<bool> success;
+    std::vector<casadi_int> iter_count;
+    std::vector<UnifiedReturnStatus> unified_return_status;
+  };
+
+  /** A thread map over a QP solver for many independent instances
+
+      Instances are packed contiguously, as for any map, and share the
+      structural setup of the QP solver. Every chunk of contiguous instances is
+      solved with a solver memory object that is kept by the map, so that
+      solver setup happens once per chunk instead of per instance and each
+      chunk warm starts from the previous call. The statistics of all
+      instances are available.
+  */
+  class CASADI_EXPORT ConicMap : public ThreadMap {
+    friend class Map;
+  public:
+    // Constructor (protected, use create function in Map)
+    ConicMap(const std::string& name, const Function& f, casadi_int n)
+      : ThreadMap(name, f, n) {}
+
+    /** \brief  Destructor */
+    ~ConicMap() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "ConicMap";}
+
+    /** \brief Check if the function is of a particular type */
+    bool is_a(const std::string& type, bool recursive) const override;
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new ConicMapMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit ConicMap(DeserializingStream& s) : ThreadMap(s) {}
   };
 
 } // namespace casadi
@@ -25,6 +25,7 @@
 
 #include "mapsum.hpp"
 #include "serializing_stream.hpp"
+#include "thread_pool.hpp"
 
 namespace casadi {
 
@@ -38,12 +39,17 @@ namespace casadi {
     casadi_assert(reduce_in.size()==f.n_in(), "Dimension mismatch");
     casadi_assert(reduce_out.size()==f.n_out(), "Dimension mismatch");
 
-    if (parallelization == "serial") {
+    if (parallelization == "serial" || parallelization == "thread") {
       std::string suffix = str(reduce_in)+str(reduce_out);
+      if (parallelization != "serial") suffix += parallelization;
       Function ret;
       if (!f->incache(name, ret, suffix)) {
-        // Create new serial map
-        ret = Function::create(new MapSum(name, f, n, reduce_in, reduce_out), opts);
+        // Create new map
+        if (parallelization == "serial") {
+          ret = Function::create(new MapSum(name, f, n, reduce_in, reduce_out), opts);
+        } else {
+          ret = Function::create(new ThreadMapSum(name, f, n, reduce_in, reduce_out), opts);
+        }
         casadi_assert_dev(ret.name()==name);
         // Save in cache
         f->tocache(ret, suffix);
@@ -87,6 +93,8 @@ namespace casadi {
     s.unpack("MapSum::class_name", class_name);
     if (class_name=="MapSum") {
       return new MapSum(s);
+    } else if (class_name=="ThreadMapSum") {
+      return new ThreadMapSum(s);
     } else {
       casadi_error("class name '" + class_name + "' unknown.");
     }
@@ -414,4 +422,124 @@ namespace casadi {
     return eval_gen(arg, res, iw, w, m);
   }
 
+  ThreadMapSum::~ThreadMapSum() {
+    clear_mem();
+  }
+
+  void ThreadMapSum::init(const Dict& opts) {
+#ifndef CASADI_WITH_THREAD
+    casadi_warning("CasADi was not compiled with WITH_THREAD=ON. "
+                   "Falling back to serial evaluation.");
+#endif // CASADI_WITH_THREAD
+    // Call the initialization method of the base class
+    MapSum::init(opts);
+
+    // Work vectors for parallel evaluation
+    init_slots();
+  }
+
+  ThreadMapSum::ThreadMapSum(DeserializingStream& s) : MapSum(s), n_slot_(0), n_red_(0) {
+    // Not serialized, since it depends on the number of threads available
+    init_slots();
+  }
+
+  void ThreadMapSum::init_slots() {
+    // No need for more work vectors than concurrently running threads
+    n_slot_ = std::min(n_, ThreadPool::requested_size());
+
+    // Nonzeros of the reduced outputs
+    n_red_ = 0;
+    for (casadi_int j=0; j<f_.n_out(); ++j) {
+      if (reduce_out_[j]) n_red_ += f_.nnz_out(j);
+    }
+
+    // Per slot: work vectors and scratch space for the reduced outputs of one instance,
+    // followed by the partial sums of all slots but the first
+    alloc_arg(f_.sz_arg() * n_slot_);
+    alloc_res(f_.sz_res() * n_slot_);
+    alloc_iw(f_.sz_iw() * n_slot_);
+    alloc_w((f_.sz_w() + n_red_) * n_slot_ + n_red_ * (n_slot_ - 1));
+  }
+
+  int ThreadMapSum::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+#ifndef CASADI_WITH_THREAD
+    return MapSum::eval(arg, res, iw, w, mem);
+#else // CASADI_WITH_THREAD
+    // Number of chunks, each processed by one thread with its own work vectors
+    casadi_int n_chunk = std::min(n_slot_, ThreadPool::instance().size());
+
+    // Checkout memory objects
+    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_chunk);
+    for (casadi_int k=0; k<n_chunk; ++k) ind.emplace_back(f_);
+
+    // Accumulators of the reduced outputs: the outputs themselves for the first chunk
+    size_t sz_slot = f_.sz_w() + n_red_;
+    std::vector<double*> acc(n_chunk * n_out_, nullptr);
+    for (casadi_int j=0; j<n_out_; ++j) {
+      if (reduce_out_[j]) acc[j] = res[j];
+    }
+    for (casadi_int k=1; k<n_chunk; ++k) {
+      double* partial = w + n_slot_ * sz_slot + (k-1) * n_red_;
+      for (casadi_int j=0; j<n_out_; ++j) {
+        if (!reduce_out_[j]) continue;
+        if (res[j]) acc[k*n_out_ + j] = partial;
+        partial += f_.nnz_out(j);
+      }
+    }
+
+    // Return values of the chunks
+    std::vector<int> ret_values(n_chunk, 0);
+
+    // Evaluate contiguous chunks of instances, summing into the accumulator of the chunk
+    ThreadPool::instance().run(n_chunk, [&](casadi_int k) {
+      const double** arg1 = arg + n_in_ + k*f_.sz_arg();
+      double** res1 = res + n_out_ + k*f_.sz_res();
+      casadi_int* iw1 = iw + k*f_.sz_iw();
+      double* w1 = w + k*sz_slot;
+      double** acc1 = get_ptr(acc) + k*n_out_;
+      for (casadi_int j=0; j<n_out_; ++j) {
+        if (acc1[j]) casadi_clear(acc1[j], f_.nnz_out(j));
+      }
+      casadi_int i_begin = (k*n_)/n_chunk, i_end = ((k+1)*n_)/n_chunk;
+      for (casadi_int i=i_begin; i<i_end && !ret_values[k]; ++i) {
+        for (casadi_int j=0; j<n_in_; ++j) {
+          arg1[j] = arg[j] && !reduce_in_[j] ? arg[j] + i*f_.nnz_in(j) : arg[j];
+        }
+        double* scratch = w1 + f_.sz_w();
+        for (casadi_int j=0; j<n_out_; ++j) {
+          if (reduce_out_[j]) {
+            res1[j] = acc1[j] ? scratch : nullptr;
+            scratch += f_.nnz_out(j);
+          } else {
+            res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : nullptr;
+          }
+        }
+        if (f_(arg1, res1, iw1, w1, ind[k])) ret_values[k] = 1;
+        for (casadi_int j=0; j<n_out_; ++j) {
+          if (acc1[j]) casadi_add(f_.nnz_out(j), res1[j], acc1[j]);
+        }
+      }
+    });
+
+    // Tree reduction: at level s, the accumulator of chunk k+s is added to that of chunk k
+    for (casadi_int s=1; s<n_chunk; s*=2) {
+      casadi_int n_pair = (n_chunk - s + 2*s - 1) / (2*s);
+      ThreadPool::instance().run(n_pair, [&](casadi_int p) {
+        casadi_int k = 2*s*p;
+        for (casadi_int j=0; j<n_out_; ++j) {
+          if (acc[k*n_out_ + j]) {
+            casadi_add(f_.nnz_out(j), acc[(k+s)*n_out_ + j], acc[k*n_out_ + j]);
+          }
+        }
+      });
+    }
+
+    // Aggregate return value
+    int ret = 0;
+    for (int e : ret_values) ret = ret || e;
+    return ret;
+#endif // CASADI_WITH_THREAD
+  }
+
 } // namespace casadi
@@ -229,6 +229,51 @@ namespace casadi {
     std::vector<bool> reduce_out_;
   };
 
+  /** Map with reduce_in/reduce_out, evaluated in parallel
+
+      Contiguous chunks of instances are evaluated on the persistent workers of
+      ThreadPool. Each chunk sums its reduced outputs into a partial accumulator,
+      the partial sums are then combined pairwise in a tree reduction. The memory
+      overhead is one accumulator per chunk rather than one output per instance.
+  */
+  class CASADI_EXPORT ThreadMapSum : public MapSum {
+    friend class MapSum;
+  public:
+    /** \brief Destructor */
+    ~ThreadMapSum() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "ThreadMapSum";}
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /// Type of parallellization
+    std::string parallelization() const override { return "thread"; }
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit ThreadMapSum(DeserializingStream& s);
+
+    // Constructor (protected, use create function in MapSum)
+    ThreadMapSum(const std::string& name, const Function& f, casadi_int n,
+                 const std::vector<bool>& reduce_in,
+                 const std::vector<bool>& reduce_out)
+      : MapSum(name, f, n, reduce_in, reduce_out), n_slot_(0), n_red_(0) {}
+
+    // Set the number of slots and allocate work vectors for them
+    void init_slots();
+
+    // Number of work vector slots, i.e. maximum number of concurrent chunks
+    casadi_int n_slot_;
+
+    // Total number of nonzeros of the reduced outputs
+    casadi_int n_red_;
+  };
+
 
 } // namespace casadi
 /// \endcond
@@ -314,6 +314,14 @@ namespace casadi {
       substitute(const std::vector<Matrix<Scalar> >& ex,
                  const std::vector<Matrix<Scalar> >& v,
                  const std::vector<Matrix<Scalar> >& vdef);
+    /** \brief Reusable plan for substituting variables v in expressions ex
+
+     * The expression graph is sorted once. Evaluating the returned Function
+     * with different vdef gives the same result as <tt>substitute(ex, v, vdef)</tt>
+     * at a cost linear in the graph size.
+     */
+    static Function substitute_plan(const std::vector<Matrix<Scalar> >& ex,
+                                    const std::vector<Matrix<Scalar> >& v);
     static void substitute_inplace(const std::vector<Matrix<Scalar> >& v,
                                   std::vector<Matrix<Scalar> >& vdef,
                                   std::vector<Matrix<Scalar> >& ex,
@@ -2570,6 +2570,13 @@ namespace casadi {
     return std::vector<Matrix<Scalar> >();
   }
 
+  template<typename Scalar>
+  Function Matrix<Scalar>::substitute_plan(const std::vector<Matrix<Scalar> >& ex,
+                                           const std::vector<Matrix<Scalar> >& v) {
+    casadi_error("'substitute_plan' not defined for " + type_name());
+    return Function();
+  }
+
   template<typename Scalar>
   void Matrix<Scalar>::substitute_inplace(const std::vector<Matrix<Scalar> >& v,
                                            std::vector<Matrix<Scalar> >& vdef,
@@ -31,8 +31,19 @@
 #include "function_internal.hpp"
 #include "serializing_stream.hpp"
 
+#ifdef CASADI_WITH_BLAS
+extern "C" {
+  void dgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+              const double* alpha, const double* a, const int* lda, const double* b,
+              const int* ldb, const double* beta, double* c, const int* ldc);
+}
+#endif // CASADI_WITH_BLAS
+
 namespace casadi {
 
+  // Smallest dense product, in multiply-adds, passed on to BLAS
+  static const casadi_int blas_min_size = 32768;
+
   Multiplication::Multiplication(const MX& z, const MX& x, const MX& y) {
     casadi_assert(x.size2() == y.size1() && x.size1() == z.size1()
       && y.size2() == z.size2(),
@@ -129,18 +140,58 @@ namespace casadi {
                           g.work(res[0], nnz())) << '\n';
     }
 
+    // Column-wise axpy: contiguous inner loop, same summation order as casadi_mtimes
     casadi_int nrow_x = dep(1).size1(), nrow_y = dep(2).size1(), ncol_y = dep(2).size2();
+    if (g.blas() && nrow_x*nrow_y*ncol_y >= blas_min_size) {
+      g.add_external("void dgemm_(const char* transa, const char* transb, "
+                     "const int* m, const int* n, const int* k, "
+                     "const double* alpha, const double* a, const int* lda, "
+                     "const double* b, const int* ldb, "
+                     "const double* beta, double* c, const int* ldc);");
+      g << "{\n"
+        << "char blas_tr = 'N';\n"
+        << "int blas_m = " << nrow_x << ", blas_n = " << ncol_y
+        << ", blas_k = " << nrow_y << ";\n"
+        << "casadi_real blas_one = 1;\n"
+        << "dgemm_(&blas_tr, &blas_tr, &blas_m, &blas_n, &blas_k, &blas_one, "
+        << g.work(arg[1], dep(1).nnz()) << ", &blas_m, " << g.work(arg[2], dep(2).nnz())
+        << ", &blas_k, &blas_one, " << g.work(res[0], nnz()) << ", &blas_m);\n"
+        << "}\n";
+      return;
+    }
     g.local("rr", "casadi_real", "*");
     g.local("ss", "casadi_real", "*");
     g.local("tt", "casadi_real", "*");
     g.local("i", "casadi_int");
     g.local("j", "casadi_int");
     g.local("k", "casadi_int");
-    g << "for (i=0, rr=" << g.work(res[0], nnz()) <<"; i<" << ncol_y << "; ++i)"
-      << " for (j=0; j<" << nrow_x << "; ++j, ++rr)"
-      << " for (k=0, ss=" << g.work(arg[1], dep(1).nnz()) << "+j, tt="
-      << g.work(arg[2], dep(2).nnz()) << "+i*" << nrow_y << "; k<" << nrow_y << "; ++k)"
-      << " *rr += ss[k*" << nrow_x << "]**tt++;\n";
+    g << "for (i=0, rr=" << g.work(res[0], nnz()) << ", tt=" << g.work(arg[2], dep(2).nnz())
+      << "; i<" << ncol_y << "; ++i, rr+=" << nrow_x << ")"
+      << " for (k=0, ss=" << g.work(arg[1], dep(1).nnz()) << "; k<" << nrow_y << "; ++k, ++tt)"
+      << " for (j=0; j<" << nrow_x << "; ++j)"
+      << " rr[j] += *ss++**tt;\n";
+  }
+
+  int DenseMultiplication::
+  eval(const double** arg, double** res, casadi_int* iw, double* w) const {
+    casadi_int nrow_x = dep(1).size1(), nrow_y = dep(2).size1(), ncol_y = dep(2).size2();
+    casadi_int i, k;
+    const double *x, *y = arg[2];
+    double* z = res[0];
+    if (arg[0]!=z) std::copy(arg[0], arg[0]+nnz(), z);
+#ifdef CASADI_WITH_BLAS
+    if (nrow_x*nrow_y*ncol_y >= blas_min_size) {
+      int m = nrow_x, n = ncol_y, k = nrow_y;
+      double one = 1;
+      char tr = 'N';
+      dgemm_(&tr, &tr, &m, &n, &k, &one, arg[1], &m, y, &k, &one, z, &m);
+      return 0;
+    }
+#endif // CASADI_WITH_BLAS
+    for (i=0; i<ncol_y; ++i, z+=nrow_x) {
+      for (k=0, x=arg[1]; k<nrow_y; ++k, x+=nrow_x) casadi_axpy(nrow_x, *y++, x, z);
+    }
+    return 0;
   }
 
   void Multiplication::serialize_type(SerializingStream& s) const {
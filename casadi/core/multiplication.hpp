@@ -159,6 +159,9 @@ namespace casadi {
         \identifier{11z} */
     ~DenseMultiplication() override {}
 
+    /// Evaluate the function numerically, column by column
+    int eval(const double** arg, double** res, casadi_int* iw, double* w) const override;
+
     /** \brief Generate code for the operation
 
         \identifier{120} */
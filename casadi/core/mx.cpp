@@ -36,6 +36,8 @@
 #include "serializing_stream.hpp"
 #include "im.hpp"
 #include "bspline.hpp"
+#include "kron.hpp"
+#include <queue>
 
 // Throw informative error message
 #define CASADI_THROW_ERROR(FNAME, WHAT) \
@@ -629,6 +631,9 @@ namespace casadi {
     if (x.is_scalar() || y.is_scalar()) {
       // Use element-wise multiplication if at least one factor scalar
       return x*y;
+    } else if (x.op()==OP_KRON) {
+      // Multiply with the factors, without forming the pattern of the product
+      return mac(x, y, MX(x.size1(), y.size2()));
     } else {
       MX z = MX::zeros(Sparsity::mtimes(x.sparsity(), y.sparsity()));
       return mac(x, y, z);
@@ -1396,12 +1401,15 @@ namespace casadi {
     if (all_equal) return ex;
 
     // Otherwise, evaluate symbolically
-    Function F("tmp_substitute", v, ex, Dict{{"max_io", 0}, {"allow_free", true}});
     std::vector<MX> ret;
-    F.call(vdef, ret, true);
+    substitute_plan(ex, v).call(vdef, ret, true);
     return ret;
   }
 
+  Function MX::substitute_plan(const std::vector<MX> &ex, const std::vector<MX> &v) {
+    return Function("substitute_plan", v, ex, Dict{{"max_io", 0}, {"allow_free", true}});
+  }
+
   MX MX::graph_substitute(const MX& x, const std::vector<MX> &v,
                           const std::vector<MX> &vdef) {
     return graph_substitute(std::vector<MX>{x}, v, vdef).at(0);
@@ -1717,7 +1725,13 @@ namespace casadi {
   MX MX::hessian(const MX& f, const MX& x, MX &g, const Dict& opts) {
     try {
       Dict all_opts = opts;
-      g = gradient(f, x, opts);
+      auto it = all_opts.find("hessian_method");
+      if (it!=all_opts.end()) {
+        casadi_assert(it->second.to_string()=="coloring",
+          "hessian_method '" + it->second.to_string() + "' is only available for SX");
+        all_opts.erase(it);
+      }
+      g = gradient(f, x, all_opts);
       if (!opts.count("symmetric")) all_opts["symmetric"] = true;
       return jacobian(g, x, all_opts);
     } catch (std::exception& e) {
@@ -1850,18 +1864,13 @@ namespace casadi {
   }
 
   MX MX::kron(const MX& a, const MX& b) {
-    const Sparsity &a_sp = a.sparsity();
-    MX filler(b.size());
-    std::vector< std::vector< MX > > blocks(a.size1(), std::vector< MX >(a.size2(), filler));
-    for (casadi_int i=0; i<a.size1(); ++i) {
-      for (casadi_int j=0; j<a.size2(); ++j) {
-        casadi_int k = a_sp.get_nz(i, j);
-        if (k!=-1) {
-          blocks[i][j] = a.nz(k)*b;
-        }
-      }
+    if (a.is_scalar() || b.is_scalar()) {
+      return a*b;
+    } else if (a.nnz()==0 || b.nnz()==0) {
+      return MX(a.size1()*b.size1(), a.size2()*b.size2());
+    } else {
+      return MX::create(new Kron(a, b));
     }
-    return blockcat(blocks);
   }
 
   MX MX::repmat(const MX& x, casadi_int n, casadi_int m) {
@@ -1894,6 +1903,11 @@ namespace casadi {
       MX nz = sparsity_cast(a, Sparsity::dense(a.nnz()));
       const Sparsity& Q = a.sparsity();
       return mtimes(MX(Q, 1/nz).T(), b);
+#ifdef CASADI_WITH_BLAS
+    } else if (a.is_dense() && a.size1()>=64 && Linsol::has_plugin("lapacklu")) {
+      // Large dense A -> LAPACK
+      return solve(a, b, "lapacklu");
+#endif // CASADI_WITH_BLAS
     } else {
       // Fall-back to QR factorization
       return solve(a, b, "qr");
@@ -1917,12 +1931,12 @@ namespace casadi {
   MX MX::expm_const(const MX& A, const MX& t) {
     Dict opts;
     opts["const_A"] = true;
-    Function ret = expmsol("mysolver", "slicot", A.sparsity(), opts);
+    Function ret = expmsol("mysolver", "pade", A.sparsity(), opts);
     return ret(std::vector<MX>{A, t})[0];
   }
 
   MX MX::expm(const MX& A) {
-    Function ret = expmsol("mysolver", "slicot", A.sparsity());
+    Function ret = expmsol("mysolver", "pade", A.sparsity());
     return ret(std::vector<MX>{A, 1})[0];
   }
 
@@ -2022,7 +2036,6 @@ namespace casadi {
 
 
   std::vector<MX> MX::cse(const std::vector<MX>& e) {
-    MX c = veccat(e);
     Function f("f", std::vector<MX>{}, e,
       {{"live_variables", false}, {"max_io", 0}, {"cse", false}, {"allow_free", true}});
     MXFunction *ff = f.get<MXFunction>();
@@ -2034,7 +2047,7 @@ namespace casadi {
     std::vector<std::vector<MX> > res_split(e.size());
     for (casadi_int i=0; i<e.size(); ++i) res_split[i].resize(e[i].n_primitives());
 
-    std::vector<MX> arg1, res1;
+    std::vector<MX> arg1, res1, res_key;
     std::vector<MX> res(e.size());
 
     std::unordered_map<std::string, MX > cache;
@@ -2066,12 +2079,22 @@ namespace casadi {
         res1.resize(it->res.size());
         it->data->eval_mx(arg1, res1);
 
+        // Commutative operations are matched regardless of operand order:
+        // the key is formed from the operation with ordered arguments
+        res_key.clear();
+        if (arg1.size()==2 && operation_checker<CommChecker>(it->op)
+            && arg1[1].get() < arg1[0].get()) {
+          std::swap(arg1[0], arg1[1]);
+          res_key.resize(res1.size());
+          it->data->eval_mx(arg1, res_key);
+        }
+
         // Get the result
         for (casadi_int i=0; i<res1.size(); ++i) {
           casadi_int el = it->res[i]; // index of the output
           MX& out_i = res1[i];
 
-          std::string key = s.pack(out_i);
+          std::string key = s.pack(res_key.empty() ? out_i : res_key[i]);
           auto itk = cache.find(key);
           if (itk==cache.end()) {
             cache[key] = out_i;
@@ -2090,6 +2113,300 @@ namespace casadi {
     return res;
   }
 
+  Function MX::graph_substitute_plan(const std::vector<MX>& ex,
+                                     const std::vector<MX>& expr) {
+    // Symbols taking the place of the substituted nodes
+    std::vector<MX> syms(expr.size());
+    for (casadi_int i=0; i<syms.size(); ++i) {
+      syms[i] = MX::sym("v_" + str(i), expr[i].sparsity());
+    }
+    return Function("graph_substitute_plan", syms, graph_substitute(ex, expr, syms),
+      Dict{{"max_io", 0}, {"allow_free", true}});
+  }
+
+  std::vector<MX> MX::auto_map(const std::vector<MX>& e,
+      const std::string& parallelization, casadi_int min_calls) {
+    Function f("f", std::vector<MX>{}, e,
+      {{"live_variables", false}, {"max_io", 0}, {"cse", false}, {"allow_free", true}});
+    MXFunction *ff = f.get<MXFunction>();
+    const auto& alg = ff->algorithm_;
+    casadi_int n_alg = alg.size();
+
+    // Instruction writing each work element
+    std::vector<casadi_int> producer(ff->workloc_.size()-1, -1);
+    for (casadi_int k=0; k<n_alg; ++k) {
+      for (casadi_int el : alg[k].res) if (el>=0) producer[el] = k;
+    }
+
+    // Number of calls to each function
+    std::map<FunctionInternal*, casadi_int> n_calls;
+    for (auto&& a : alg) {
+      if (a.op==OP_CALL) n_calls[a.data->which_function().get()]++;
+    }
+
+    // Level of each call: one more than the calls to the same function it depends on.
+    // Calls with the same level cannot depend on each other
+    typedef std::map<FunctionInternal*, casadi_int> Levels;
+    std::vector<Levels> work_level(producer.size());
+    std::map<std::pair<FunctionInternal*, casadi_int>, std::vector<casadi_int> > groups;
+    for (casadi_int k=0; k<n_alg; ++k) {
+      const auto& a = alg[k];
+      Levels lev;
+      for (casadi_int el : a.arg) {
+        if (el<0) continue;
+        for (auto&& l : work_level[el]) lev[l.first] = std::max(lev[l.first], l.second);
+      }
+      if (a.op==OP_CALL) {
+        FunctionInternal* fk = a.data->which_function().get();
+        if (n_calls[fk]>=min_calls) {
+          casadi_int& l = lev[fk];
+          groups[{fk, ++l}].push_back(k);
+        }
+      }
+      for (casadi_int el : a.res) if (el>=0) work_level[el] = lev;
+    }
+
+    // Representative instruction of each group, the first call
+    std::vector<casadi_int> rep = range(n_alg);
+    std::vector<std::vector<casadi_int> > members(n_alg);
+    for (auto&& g : groups) {
+      if (g.second.size()<2) continue;
+      for (casadi_int k : g.second) rep[k] = g.second.front();
+      members[g.second.front()] = g.second;
+    }
+
+    // Topological sort with each group merged into one node, keeping the original order
+    // where possible
+    std::vector<casadi_int> n_dep(n_alg, 0);
+    std::vector<std::vector<casadi_int> > dependents(n_alg);
+    for (casadi_int k=0; k<n_alg; ++k) {
+      for (casadi_int el : alg[k].arg) {
+        if (el<0) continue;
+        casadi_int p = rep[producer[el]];
+        if (p==rep[k]) continue;
+        dependents[p].push_back(rep[k]);
+        n_dep[rep[k]]++;
+      }
+    }
+    std::priority_queue<casadi_int, std::vector<casadi_int>, std::greater<casadi_int> > ready;
+    for (casadi_int k=0; k<n_alg; ++k) if (rep[k]==k && n_dep[k]==0) ready.push(k);
+
+    // Symbolic work
+    std::vector<MX> swork(producer.size());
+    std::vector<std::vector<MX> > res_split(e.size());
+    for (casadi_int i=0; i<e.size(); ++i) res_split[i].resize(e[i].n_primitives());
+    std::vector<MX> arg1, res1;
+
+    // Arguments of an instruction
+    auto get_arg = [&](const MXAlgEl& a, std::vector<MX>& arg) {
+      arg.resize(a.arg.size());
+      for (casadi_int i=0; i<arg.size(); ++i) {
+        casadi_int el = a.arg[i];
+        arg[i] = el<0 ? MX(a.data->dep(i).size()) : swork[el];
+      }
+    };
+
+    while (!ready.empty()) {
+      casadi_int k = ready.top();
+      ready.pop();
+      const auto& a = alg[k];
+      if (a.op == OP_INPUT) {
+        // pass
+      } else if (a.op==OP_OUTPUT) {
+        res_split.at(a.data->ind()).at(a.data->segment()) = swork[a.arg.front()];
+      } else if (a.op==OP_PARAMETER) {
+        swork[a.res.front()] = a.data;
+      } else if (members[k].empty()) {
+        get_arg(a, arg1);
+        res1.resize(a.res.size());
+        a.data->eval_mx(arg1, res1);
+        for (casadi_int i=0; i<res1.size(); ++i) {
+          if (a.res[i]>=0) swork[a.res[i]] = res1[i];
+        }
+      } else {
+        // One mapped call for the whole group
+        const Function& fk = a.data->which_function();
+        casadi_int n = members[k].size();
+        std::vector<std::vector<MX> > marg(n);
+        for (casadi_int j=0; j<n; ++j) get_arg(alg[members[k][j]], marg[j]);
+        std::vector<casadi_int> reduce_in;
+        std::vector<MX> fm_arg;
+        for (casadi_int i=0; i<fk.n_in(); ++i) {
+          bool shared = true;
+          std::vector<MX> v(n);
+          for (casadi_int j=0; j<n; ++j) {
+            v[j] = marg[j][i];
+            shared = shared && is_equal(v[j], v[0]);
+          }
+          if (shared) {
+            reduce_in.push_back(i);
+            fm_arg.push_back(v[0]);
+          } else {
+            fm_arg.push_back(horzcat(v));
+          }
+        }
+        Function fm = fk.map(fk.name() + "_map", parallelization, n, reduce_in,
+          std::vector<casadi_int>{});
+        std::vector<MX> fm_res = fm(fm_arg);
+        for (casadi_int i=0; i<fk.n_out(); ++i) {
+          std::vector<MX> r = horzsplit(fm_res[i], fk.size2_out(i));
+          for (casadi_int j=0; j<n; ++j) {
+            casadi_int el = alg[members[k][j]].res[i];
+            if (el>=0) swork[el] = r[j];
+          }
+        }
+      }
+      for (casadi_int d : dependents[k]) {
+        if (--n_dep[d]==0) ready.push(d);
+      }
+    }
+
+    // Join split outputs
+    std::vector<MX> res(e.size());
+    for (casadi_int i=0; i<res.size(); ++i) res[i] = e[i].join_primitives(res_split[i]);
+    return res;
+  }
+
+  std::vector<MX> MX::fuse_calls(const std::vector<MX>& e, casadi_int max_nodes) {
+    Function f("f", std::vector<MX>{}, e,
+      {{"live_variables", false}, {"max_io", 0}, {"cse", false}, {"allow_free", true}});
+    MXFunction *ff = f.get<MXFunction>();
+    const auto& alg = ff->algorithm_;
+    casadi_int n_alg = alg.size();
+
+    // Instructions reading each work element
+    std::vector<std::vector<casadi_int> > consumers(ff->workloc_.size()-1);
+    for (casadi_int k=0; k<n_alg; ++k) {
+      for (casadi_int el : alg[k].arg) if (el>=0) consumers[el].push_back(k);
+    }
+
+    // Calls that can be fused: small SX functions that may be inlined
+    auto fusable = [&](const MXAlgEl& a) {
+      if (a.op!=OP_CALL) return false;
+      const Function& fk = a.data->which_function();
+      return fk.is_a("SXFunction") && !fk->never_inline_ && !fk.has_free()
+        && fk.n_nodes()<=max_nodes;
+    };
+
+    // Symbolic work
+    std::vector<MX> swork(consumers.size());
+    std::vector<std::vector<MX> > res_split(e.size());
+    for (casadi_int i=0; i<e.size(); ++i) res_split[i].resize(e[i].n_primitives());
+    std::vector<MX> arg1, res1;
+
+    // Arguments of an instruction
+    auto get_arg = [&](const MXAlgEl& a, std::vector<MX>& arg) {
+      arg.resize(a.arg.size());
+      for (casadi_int i=0; i<arg.size(); ++i) {
+        casadi_int el = a.arg[i];
+        arg[i] = el<0 ? MX(a.data->dep(i).size()) : swork[el];
+      }
+    };
+
+    // Evaluate a single instruction
+    auto eval = [&](const MXAlgEl& a) {
+      get_arg(a, arg1);
+      res1.resize(a.res.size());
+      a.data->eval_mx(arg1, res1);
+      for (casadi_int i=0; i<res1.size(); ++i) {
+        if (a.res[i]>=0) swork[a.res[i]] = res1[i];
+      }
+    };
+
+    // Calls in the current group and the work elements they write
+    std::vector<casadi_int> group;
+    std::vector<bool> in_group(n_alg, false);
+    std::vector<bool> group_el(consumers.size(), false);
+    casadi_int n_fused = 0;
+
+    // Replace the group by a single call to an SXFunction
+    auto flush = [&]() {
+      if (group.size()==1) {
+        eval(alg[group.front()]);
+      } else if (!group.empty()) {
+        // Symbolic inputs of the fused function, one per external work element
+        std::vector<SX> sx_in, sx_out;
+        std::vector<MX> mx_in;
+        std::map<casadi_int, SX> sx_el;
+        std::vector<casadi_int> out_el;
+        for (casadi_int k : group) {
+          const MXAlgEl& a = alg[k];
+          const Function& fk = a.data->which_function();
+          std::vector<SX> fk_arg(a.arg.size());
+          for (casadi_int i=0; i<fk_arg.size(); ++i) {
+            casadi_int el = a.arg[i];
+            if (el<0) {
+              fk_arg[i] = SX::zeros(fk.sparsity_in(i));
+            } else {
+              auto it = sx_el.find(el);
+              if (it==sx_el.end()) {
+                SX v = SX::sym("v" + str(sx_in.size()), a.data->dep(i).sparsity());
+                sx_in.push_back(v);
+                mx_in.push_back(swork[el]);
+                it = sx_el.insert(std::make_pair(el, v)).first;
+              }
+              fk_arg[i] = it->second;
+            }
+          }
+          std::vector<SX> fk_res = fk(fk_arg);
+          for (casadi_int i=0; i<fk_res.size(); ++i) {
+            casadi_int el = a.res[i];
+            if (el<0) continue;
+            sx_el[el] = fk_res[i];
+            // Only results needed outside of the group become outputs
+            bool external = consumers[el].empty();
+            for (casadi_int c : consumers[el]) external = external || !in_group[c];
+            if (external) {
+              sx_out.push_back(fk_res[i]);
+              out_el.push_back(el);
+            }
+          }
+        }
+        Function fused("fused_" + str(n_fused++), sx_in, sx_out,
+                       Dict{{"allow_duplicate_io_names", true}});
+        std::vector<MX> fused_res = fused(mx_in);
+        for (casadi_int i=0; i<out_el.size(); ++i) swork[out_el[i]] = fused_res[i];
+      }
+      for (casadi_int k : group) {
+        in_group[k] = false;
+        for (casadi_int el : alg[k].res) if (el>=0) group_el[el] = false;
+      }
+      group.clear();
+    };
+
+    for (casadi_int k=0; k<n_alg; ++k) {
+      const auto& a = alg[k];
+      if (fusable(a)) {
+        group.push_back(k);
+        in_group[k] = true;
+        for (casadi_int el : a.res) if (el>=0) group_el[el] = true;
+        continue;
+      }
+      // An instruction outside of the group that reads from it closes the group
+      for (casadi_int el : a.arg) {
+        if (el>=0 && group_el[el]) {
+          flush();
+          break;
+        }
+      }
+      if (a.op == OP_INPUT) {
+        // pass
+      } else if (a.op==OP_OUTPUT) {
+        res_split.at(a.data->ind()).at(a.data->segment()) = swork[a.arg.front()];
+      } else if (a.op==OP_PARAMETER) {
+        swork[a.res.front()] = a.data;
+      } else {
+        eval(a);
+      }
+    }
+    flush();
+
+    // Join split outputs
+    std::vector<MX> res(e.size());
+    for (casadi_int i=0; i<res.size(); ++i) res[i] = e[i].join_primitives(res_split[i]);
+    return res;
+  }
+
   MX MX::stop_diff(const MX& expr, casadi_int order) {
     std::vector<MX> s = symvar(expr);
     MX x = veccat(s);
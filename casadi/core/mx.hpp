@@ -50,9 +50,16 @@ namespace casadi {
     Sparsity scc_sp;
     Sparsity Hrsp;
     Sparsity Hsp;
+    Sparsity Lsp;
+    std::vector<casadi_int> ldl_p;
+    /// Nonzero offsets of the blocks in scc_mapping
+    std::vector<casadi_int> block_nz;
     casadi_convexify_config<double> config;
     casadi_int sz_iw;
     casadi_int sz_w;
+    /// Convexify blocks concurrently, each slot with sz_iw_block/sz_w_block work
+    bool parallel;
+    casadi_int n_slot, sz_iw_block, sz_w_block;
     casadi_int *iw;
     double* w;
   };
@@ -574,6 +581,13 @@ namespace casadi {
     static std::vector<MX> substitute(const std::vector<MX> &ex,
                                          const std::vector<MX> &v,
                                          const std::vector<MX> &vdef);
+    /** \brief Reusable plan for substituting variables v in expressions ex
+
+     * The expression graph is sorted once. Evaluating the returned Function
+     * symbolically, i.e. <tt>plan.call(vdef, res, true)</tt>, gives the same result as
+     * <tt>substitute(ex, v, vdef)</tt> at a cost linear in the graph size.
+     */
+    static Function substitute_plan(const std::vector<MX> &ex, const std::vector<MX> &v);
     static void substitute_inplace(const std::vector<MX>& v,
                                   std::vector<MX>& vdef,
                                   std::vector<MX>& ex, bool reverse);
@@ -634,6 +648,17 @@ namespace casadi {
     static std::vector<MX> graph_substitute(const std::vector<MX> &ex,
                                             const std::vector<MX> &expr,
                                             const std::vector<MX> &exprs);
+    /** \brief Reusable plan for substituting expressions in graph
+
+     * Returns a Function with one input per expression in expr. Evaluating it
+     * symbolically, i.e. <tt>plan.call(exprs, res, true)</tt>, gives the same result as
+     * <tt>graph_substitute(ex, expr, exprs)</tt> without sorting the graph again.
+     */
+    static Function graph_substitute_plan(const std::vector<MX> &ex,
+                                          const std::vector<MX> &expr);
+    static std::vector<MX> auto_map(const std::vector<MX>& e,
+                                    const std::string& parallelization, casadi_int min_calls);
+    static std::vector<MX> fuse_calls(const std::vector<MX>& e, casadi_int max_nodes);
     static MX matrix_expand(const MX& e, const std::vector<MX> &boundary,
                             const Dict& options);
     static std::vector<MX> matrix_expand(const std::vector<MX>& e,
@@ -723,6 +748,30 @@ namespace casadi {
       return MX::graph_substitute(ex, v, vdef);
     }
 
+    /** \brief Replace independent calls to the same function by a map
+
+     * Calls to a Function that occurs at least min_calls times are grouped
+     * such that no call in a group depends on another one in the same group.
+     * Each group is replaced by a single call to a map over the group, using
+     * the given parallelization. Arguments shared by all calls in a group
+     * are not repeated. */
+    inline friend std::vector<MX>
+      auto_map(const std::vector<MX>& e, const std::string& parallelization="serial",
+               casadi_int min_calls=2) {
+      return MX::auto_map(e, parallelization, min_calls);
+    }
+
+    /** \brief Fuse calls to small SXFunctions into single SXFunction calls
+
+     * Consecutive calls, in topological order, to SXFunctions with at most
+     * max_nodes operations are merged into one call to a new SXFunction.
+     * This removes the dispatch overhead of each call without expanding the
+     * whole graph. Functions with the never_inline option are left alone. */
+    inline friend std::vector<MX>
+      fuse_calls(const std::vector<MX>& e, casadi_int max_nodes=100) {
+      return MX::fuse_calls(e, max_nodes);
+    }
+
     /** \brief Expand MX graph to SXFunction call
      *
      *  Expand the given expression e, optionally
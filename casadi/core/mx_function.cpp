@@ -29,6 +29,8 @@
 #include "casadi_interrupt.hpp"
 #include "io_instruction.hpp"
 #include "serializing_stream.hpp"
+#include "thread_pool.hpp"
+#include "profiler.hpp"
 
 #include <stack>
 #include <typeinfo>
@@ -65,7 +67,19 @@ namespace casadi {
         "Print each operation during evaluation"}},
       {"cse",
        {OT_BOOL,
-        "Perform common subexpression elimination (complexity is N*log(N) in graph size)"}},
+        "Perform common subexpression elimination (hash-based, linear in graph size)"}},
+      {"auto_map",
+       {OT_STRING,
+        "Replace independent calls to the same function by a single map call "
+        "with the given parallelization, e.g. 'serial' or 'thread' (Default: off)"}},
+      {"fuse_calls",
+       {OT_INT,
+        "Fuse consecutive calls to SXFunctions with at most this many operations "
+        "into single SXFunction calls, see fuse_calls (Default: 0, off)"}},
+      {"parallel",
+       {OT_BOOL,
+        "Evaluate independent function calls concurrently on the thread pool. "
+        "Disables live variables. (Default: false)"}},
       {"allow_free",
        {OT_BOOL,
         "Allow construction with free variables (Default: false)"}},
@@ -116,7 +130,10 @@ namespace casadi {
     live_variables_ = true;
     print_instructions_ = false;
     bool cse_opt = false;
+    std::string auto_map_opt;
+    casadi_int fuse_calls_opt = 0;
     bool allow_free = false;
+    parallel_ = false;
 
     // Read options
     for (auto&& op : opts) {
@@ -128,11 +145,20 @@ namespace casadi {
         print_instructions_ = op.second;
       } else if (op.first=="cse") {
         cse_opt = op.second;
+      } else if (op.first=="auto_map") {
+        auto_map_opt = op.second.to_string();
+      } else if (op.first=="fuse_calls") {
+        fuse_calls_opt = op.second;
       } else if (op.first=="allow_free") {
         allow_free = op.second;
+      } else if (op.first=="parallel") {
+        parallel_ = op.second;
       }
     }
 
+    // Reusing work vector elements would serialize the schedule
+    if (parallel_) live_variables_ = false;
+
     // Check/set default inputs
     if (default_in_.empty()) {
       default_in_.resize(n_in_, 0);
@@ -142,6 +168,8 @@ namespace casadi {
     }
 
     if (cse_opt) out_ = cse(out_);
+    if (fuse_calls_opt>0) out_ = fuse_calls(out_, fuse_calls_opt);
+    if (!auto_map_opt.empty()) out_ = auto_map(out_, auto_map_opt);
 
     // Stack used to sort the computational graph
     std::stack<MXNode*> s;
@@ -195,7 +223,10 @@ namespace casadi {
 
       // If a new element in the algorithm needs to be added
       if (op>=0) {
-        AlgEl ae;
+        // Construct in place
+        place_in_alg.push_back(algorithm_.size());
+        algorithm_.emplace_back();
+        AlgEl& ae = algorithm_.back();
         ae.op = op;
         ae.data.own(n);
         ae.arg.resize(n->n_dep());
@@ -216,10 +247,6 @@ namespace casadi {
           }
         }
 
-        // Save to algorithm
-        place_in_alg.push_back(algorithm_.size());
-        algorithm_.push_back(ae);
-
       } else { // Function output node
         // Get the output index
         casadi_int oind = n->which_output();
@@ -244,14 +271,22 @@ namespace casadi {
     std::vector<casadi_int>& place = place_in_alg; // Reuse memory as it is no longer needed
     place.resize(nodes.size());
 
-    // Stack with unused elements in the work vector, sorted by sparsity pattern
-    SPARSITY_MAP<casadi_int, std::stack<casadi_int> > unused_all;
+    // Stack with unused elements in the work vector, sorted by number of nonzeros
+    std::map<casadi_int, std::stack<casadi_int, std::vector<casadi_int> > > unused_all;
+
+    // Number of nonzeros of each element in the work vector, set by its first use
+    std::vector<casadi_int> elem_nnz;
 
     // Work vector size
     casadi_int worksize = 0;
 
+    // Elements freed by an operation before its results are allocated,
+    // with the number of nonzeros of the argument
+    std::vector<std::pair<casadi_int, casadi_int> > inplace;
+
     // Find a place in the work vector for the operation
     for (auto&& e : algorithm_) {
+      inplace.clear();
 
       // There are two tasks, allocate memory of the result and free the
       // memory off the arguments, order depends on whether inplace is possible
@@ -275,11 +310,13 @@ namespace casadi {
             // Free variable for reuse
             if (live_variables_ && remaining==0) {
 
-              // Get a pointer to the sparsity pattern of the argument that can be freed
-              casadi_int nnz = nodes[ch_ind]->sparsity().nnz();
-
-              // Add to the stack of unused work vector elements for the current sparsity
-              unused_all[nnz].push(place[ch_ind]);
+              if (task==0) {
+                // Candidate for an in-place operation, first argument last
+                inplace.push_back(std::make_pair(place[ch_ind], nodes[ch_ind]->sparsity().nnz()));
+              } else {
+                // Add to the stack of unused work vector elements of this size
+                unused_all[elem_nnz[place[ch_ind]]].push(place[ch_ind]);
+              }
             }
 
             // Point to the place in the work vector instead of to the place in the list of nodes
@@ -297,27 +334,42 @@ namespace casadi {
         // Allocate/reuse memory for the results of the operation
         for (casadi_int c=0; c<e.res.size(); ++c) {
           if (e.res[c]>=0) {
+            casadi_int nnz = e.data->sparsity(c).nnz();
 
             // Are reuse of variables (live variables) enabled?
             if (live_variables_) {
-              // Get a pointer to the sparsity pattern node
-              casadi_int nnz = e.data->sparsity(c).nnz();
-
-              // Get a reference to the stack for the current sparsity
-              std::stack<casadi_int>& unused = unused_all[nnz];
-
-              // Try to reuse a variable from the stack if possible (last in, first out)
-              if (!unused.empty()) {
-                e.res[c] = place[e.res[c]] = unused.top();
-                unused.pop();
+              // Operate in-place on an argument with the same number of nonzeros
+              bool found = false;
+              for (auto k=inplace.rbegin(); k!=inplace.rend(); ++k) {
+                if (k->first>=0 && k->second==nnz) {
+                  e.res[c] = place[e.res[c]] = k->first;
+                  k->first = -1;
+                  found = true;
+                  break;
+                }
+              }
+              if (found) continue;
+
+              // Smallest unused element that is large enough, wasting at most half
+              auto it = nnz<=1 ? unused_all.find(nnz) : unused_all.lower_bound(nnz);
+              if (it!=unused_all.end() && it->first<=2*nnz) {
+                e.res[c] = place[e.res[c]] = it->second.top();
+                it->second.pop();
+                if (it->second.empty()) unused_all.erase(it);
                 continue; // Success, no new element needed in the work vector
               }
             }
 
             // Allocate a new element in the work vector
+            elem_nnz.push_back(nnz);
             e.res[c] = place[e.res[c]] = worksize++;
           }
         }
+
+        // Arguments not operated on in-place can be reused later
+        for (auto&& k : inplace) {
+          if (k.first>=0) unused_all[elem_nnz[k.first]].push(k.first);
+        }
       }
     }
 
@@ -355,9 +407,13 @@ namespace casadi {
       if (workloc_[i]<0) workloc_[i] = i==0 ? 0 : workloc_[i-1];
       workloc_[i] += sz_w;
     }
+    size_t sz_w_tmp = sz_w;
     sz_w += wind;
     alloc_w(sz_w);
 
+    // Schedule for concurrent evaluation
+    if (parallel_) init_parallel(sz_w_tmp, sz_w);
+
     // Reset the temporary variables
     for (casadi_int i=0; i<nodes.size(); ++i) {
       if (nodes[i]) {
@@ -416,6 +472,180 @@ namespace casadi {
         break;
       }
     }
+
+    // Dependencies of the outputs, for partial evaluation
+    init_out_mask();
+  }
+
+  void MXFunction::init_parallel(size_t sz_w_tmp, size_t sz_w) {
+    // Level of each instruction, respecting read-after-write, write-after-read
+    // and write-after-write dependencies on the work vector elements
+    std::vector<casadi_int> level(algorithm_.size(), 0);
+    std::vector<casadi_int> last_write(workloc_.size(), -1), last_read(workloc_.size(), -1);
+    casadi_int n_level = 0;
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& e = algorithm_[k];
+      casadi_int lev = 0;
+      for (casadi_int a : e.arg) {
+        if (a>=0 && last_write[a]>=0) lev = std::max(lev, level[last_write[a]] + 1);
+      }
+      for (casadi_int r : e.res) {
+        if (r<0) continue;
+        if (last_write[r]>=0) lev = std::max(lev, level[last_write[r]] + 1);
+        if (last_read[r]>=0) lev = std::max(lev, last_read[r] + 1);
+      }
+      level[k] = lev;
+      n_level = std::max(n_level, lev + 1);
+      for (casadi_int a : e.arg) {
+        if (a>=0) last_read[a] = std::max(last_read[a], lev);
+      }
+      for (casadi_int r : e.res) {
+        if (r>=0) {
+          last_write[r] = k;
+          last_read[r] = -1;
+        }
+      }
+    }
+
+    // Instructions of each level, in algorithm order
+    par_levels_.clear();
+    par_levels_.resize(n_level);
+    for (casadi_int k=0; k<algorithm_.size(); ++k) par_levels_[level[k]].push_back(k);
+
+    // Maximum number of calls that can run concurrently
+    casadi_int max_calls = 0;
+    for (auto&& lev : par_levels_) {
+      casadi_int n_call = 0;
+      for (casadi_int k : lev) if (algorithm_[k].op==OP_CALL) n_call++;
+      max_calls = std::max(max_calls, n_call);
+    }
+    n_slot_ = std::min(max_calls, ThreadPool::requested_size());
+    if (n_slot_<=1) {
+      if (verbose_) casadi_message("No independent calls, evaluating sequentially");
+      parallel_ = false;
+      par_levels_.clear();
+      return;
+    }
+
+    // Work vectors for each slot, slot 0 uses the regular ones
+    sz_arg_slot_ = sz_res_slot_ = sz_iw_slot_ = 0;
+    for (auto&& e : algorithm_) {
+      if (e.op!=OP_CALL) continue;
+      sz_arg_slot_ = std::max(sz_arg_slot_, e.data->sz_arg());
+      sz_res_slot_ = std::max(sz_res_slot_, e.data->sz_res());
+      sz_iw_slot_ = std::max(sz_iw_slot_, e.data->sz_iw());
+    }
+    sz_w_slot_ = sz_w_tmp;
+    w_slot_offset_ = sz_w;
+    alloc_arg(n_slot_*sz_arg_slot_);
+    alloc_res(n_slot_*sz_res_slot_);
+    alloc_iw(n_slot_*sz_iw_slot_);
+    alloc_w(sz_w + (n_slot_-1)*sz_w_slot_);
+    if (verbose_) {
+      casadi_message(str(n_level) + " levels, up to " + str(n_slot_) + " concurrent calls");
+    }
+  }
+
+  int MXFunction::eval_el(const AlgEl& e, casadi_int k, const double** arg, double** res,
+      const double** arg1, double** res1, casadi_int* iw, double* w, double* w_tmp) const {
+    if (e.op==OP_INPUT) {
+      // Pass an input
+      double *w1 = w+workloc_[e.res.front()];
+      casadi_int nnz=e.data.nnz();
+      casadi_int i=e.data->ind();
+      casadi_int nz_offset=e.data->offset();
+      if (arg[i]==nullptr) {
+        std::fill(w1, w1+nnz, 0);
+      } else {
+        std::copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w1);
+      }
+    } else if (e.op==OP_OUTPUT) {
+      // Get an output
+      double *w1 = w+workloc_[e.arg.front()];
+      casadi_int nnz=e.data->dep().nnz();
+      casadi_int i=e.data->ind();
+      casadi_int nz_offset=e.data->offset();
+      if (res[i]) std::copy(w1, w1+nnz, res[i]+nz_offset);
+    } else {
+      // Point pointers to the data corresponding to the element
+      for (casadi_int i=0; i<e.arg.size(); ++i)
+        arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]] : nullptr;
+      for (casadi_int i=0; i<e.res.size(); ++i)
+        res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : nullptr;
+
+      // Evaluate
+      if (print_instructions_) print_arg(uout(), k, e, arg1);
+      if (e.data->eval(arg1, res1, iw, w_tmp)) return 1;
+      if (print_instructions_) print_res(uout(), k, e, res1);
+    }
+    return 0;
+  }
+
+  int MXFunction::eval_parallel(const double** arg, double** res, casadi_int* iw, double* w,
+      bvec_t req, bool partial) const {
+    const double** arg1 = arg+n_in_;
+    double** res1 = res+n_out_;
+    std::vector<casadi_int> calls;
+    for (auto&& lev : par_levels_) {
+      // Other operations are cheap and evaluated directly
+      calls.clear();
+      for (casadi_int k : lev) {
+        if (partial && out_mask_[k] && !(out_mask_[k] & req)) continue;
+        const AlgEl& e = algorithm_[k];
+        if (e.op==OP_CALL) {
+          calls.push_back(k);
+        } else if (eval_el(e, k, arg, res, arg1, res1, iw, w, w)) {
+          return 1;
+        }
+      }
+      if (calls.size()<=1) {
+        for (casadi_int k : calls) {
+          if (eval_el(algorithm_[k], k, arg, res, arg1, res1, iw, w, w)) return 1;
+        }
+        continue;
+      }
+      // Independent calls concurrently, each slot with its own work vectors
+      casadi_int n_chunk = std::min(static_cast<casadi_int>(calls.size()), n_slot_);
+      std::vector<int> flag(n_chunk, 0);
+      ThreadPool::instance().run(n_chunk, [&](casadi_int s) {
+        const double** arg_s = arg1 + s*sz_arg_slot_;
+        double** res_s = res1 + s*sz_res_slot_;
+        casadi_int* iw_s = iw + s*sz_iw_slot_;
+        double* w_s = s==0 ? w : w + w_slot_offset_ + (s-1)*sz_w_slot_;
+        for (casadi_int j=s; j<calls.size(); j+=n_chunk) {
+          casadi_int k = calls[j];
+          if (eval_el(algorithm_[k], k, arg, res, arg_s, res_s, iw_s, w, w_s)) flag[s] = 1;
+        }
+      });
+      for (int f : flag) if (f) return 1;
+    }
+    return 0;
+  }
+
+  void MXFunction::init_out_mask() {
+    out_mask_.clear();
+    if (n_out_<=1) return;
+    out_mask_.resize(algorithm_.size());
+    // Propagate backward, results are cleared before marking the arguments
+    std::vector<bvec_t> wmask(workloc_.size(), 0);
+    for (casadi_int k=algorithm_.size()-1; k>=0; --k) {
+      const AlgEl& e = algorithm_[k];
+      bvec_t m = 0;
+      if (e.op==OP_OUTPUT) {
+        m = bvec_t(1) << (e.data->ind() % bvec_size);
+      } else {
+        for (casadi_int r : e.res) {
+          if (r>=0) {
+            m |= wmask[r];
+            wmask[r] = 0;
+          }
+        }
+      }
+      for (casadi_int a : e.arg) {
+        if (a>=0) wmask[a] |= m;
+      }
+      out_mask_[k] = m;
+    }
   }
 
   int MXFunction::eval(const double** arg, double** res,
@@ -433,45 +663,46 @@ namespace casadi {
                    + str(free_vars_) + " are free.");
     }
 
-    // Operation number (for printing)
-    casadi_int k = 0;
+    // Outputs that are requested
+    bvec_t req = 0;
+    bool partial = false;
+    for (casadi_int i=0; i<n_out_; ++i) {
+      if (res[i]) {
+        req |= bvec_t(1) << (i % bvec_size);
+      } else {
+        partial = true;
+      }
+    }
+    partial = partial && !out_mask_.empty();
+
+    // Time the nodes individually, sequentially
+    if (Profiler::is_instructions_enabled()) {
+      ProfilerInstructions& r = Profiler::instructions(this, algorithm_.size());
+      if (r.op.empty()) {
+        for (auto&& e : algorithm_) {
+          r.op.push_back(casadi_math<double>::name(e.op));
+          r.expr.push_back(print(e));
+        }
+      }
+      int64_t t = Profiler::now();
+      for (casadi_int k=0; k<algorithm_.size(); ++k) {
+        if (partial && out_mask_[k] && !(out_mask_[k] & req)) continue;
+        if (eval_el(algorithm_[k], k, arg, res, arg1, res1, iw, w, w)) return 1;
+        t = r.record(k, t);
+      }
+      return 0;
+    }
+
+    // Independent calls concurrently
+    if (parallel_) return eval_parallel(arg, res, iw, w, req, partial);
 
     // Evaluate all of the nodes of the algorithm:
     // should only evaluate nodes that have not yet been calculated!
-    for (auto&& e : algorithm_) {
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      // Skip operations that only contribute to outputs not requested
+      if (partial && out_mask_[k] && !(out_mask_[k] & req)) continue;
       // Perform the operation
-      if (e.op==OP_INPUT) {
-        // Pass an input
-        double *w1 = w+workloc_[e.res.front()];
-        casadi_int nnz=e.data.nnz();
-        casadi_int i=e.data->ind();
-        casadi_int nz_offset=e.data->offset();
-        if (arg[i]==nullptr) {
-          std::fill(w1, w1+nnz, 0);
-        } else {
-          std::copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w1);
-        }
-      } else if (e.op==OP_OUTPUT) {
-        // Get an output
-        double *w1 = w+workloc_[e.arg.front()];
-        casadi_int nnz=e.data->dep().nnz();
-        casadi_int i=e.data->ind();
-        casadi_int nz_offset=e.data->offset();
-        if (res[i]) std::copy(w1, w1+nnz, res[i]+nz_offset);
-      } else {
-        // Point pointers to the data corresponding to the element
-        for (casadi_int i=0; i<e.arg.size(); ++i)
-          arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]] : nullptr;
-        for (casadi_int i=0; i<e.res.size(); ++i)
-          res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : nullptr;
-
-        // Evaluate
-        if (print_instructions_) print_arg(uout(), k, e, arg1);
-        if (e.data->eval(arg1, res1, iw, w)) return 1;
-        if (print_instructions_) print_res(uout(), k, e, res1);
-      }
-      // Increase counter
-      k++;
+      if (eval_el(algorithm_[k], k, arg, res, arg1, res1, iw, w, w)) return 1;
     }
     return 0;
   }
@@ -1145,6 +1376,30 @@ namespace casadi {
     return 0;
   }
 
+  const Function& MXFunction::expansion() const {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+    if (expansion_.is_null()) {
+      if (verbose_) casadi_message("Expanding '" + name_ + "'");
+      std::vector<SX> ex_in = sx_in();
+      std::vector<SX> ex_out(n_out_);
+      for (casadi_int i=0; i<n_out_; ++i) ex_out[i] = SX::zeros(sparsity_out_[i]);
+      std::vector<const SXElem*> arg(sz_arg(), nullptr);
+      std::vector<SXElem*> res(sz_res(), nullptr);
+      for (casadi_int i=0; i<n_in_; ++i) arg[i] = ex_in[i].ptr();
+      for (casadi_int i=0; i<n_out_; ++i) res[i] = ex_out[i].ptr();
+      std::vector<casadi_int> iw(sz_iw());
+      std::vector<SXElem> w(sz_w());
+      if (eval_sx(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), nullptr)) {
+        casadi_error("Failed to expand '" + name_ + "'");
+      }
+      expansion_ = Function(name_ + "_expanded", ex_in, ex_out, name_in_, name_out_,
+                            {{"allow_duplicate_io_names", true}});
+    }
+    return expansion_;
+  }
+
   void MXFunction::codegen_declarations(CodeGenerator& g) const {
 
     // Make sure that there are no free variables
@@ -1173,6 +1428,16 @@ namespace casadi {
     }
   }
 
+  size_t MXFunction::instructions_bytes() const {
+    size_t ret = algorithm_.capacity() * sizeof(AlgEl)
+      + workloc_.capacity() * sizeof(casadi_int)
+      + free_vars_.capacity() * sizeof(MX);
+    for (auto&& e : algorithm_) {
+      ret += (e.arg.capacity() + e.res.capacity()) * sizeof(casadi_int);
+    }
+    return ret;
+  }
+
   void MXFunction::codegen_body(CodeGenerator& g) const {
     // Temporary variables and vectors
     g.init_local("arg1", "arg+" + str(n_in_));
@@ -1791,6 +2056,9 @@ namespace casadi {
     s.unpack("MXFunction::live_variables", live_variables_);
     print_instructions_ = false;
     if (version >= 2) s.unpack("MXFunction::print_instructions", print_instructions_);
+    // Concurrent evaluation is not retained, it depends on the machine
+    parallel_ = false;
+    init_out_mask();
 
     XFunction<MXFunction, MX, MXNode>::delayed_deserialize_members(s);
   }
@@ -93,6 +93,41 @@ namespace casadi {
     /// Print instructions during evaluation
     bool print_instructions_;
 
+    /// For each instruction, the outputs that depend on it (empty if single output)
+    std::vector<bvec_t> out_mask_;
+
+    /// Evaluate independent calls concurrently
+    bool parallel_;
+
+    /// Instructions grouped by dependency level, for concurrent evaluation
+    std::vector<std::vector<casadi_int> > par_levels_;
+
+    /// Number of concurrently evaluated calls and their work vectors
+    casadi_int n_slot_;
+    size_t sz_arg_slot_, sz_res_slot_, sz_iw_slot_, sz_w_slot_, w_slot_offset_;
+
+    /** \brief Build the schedule and work vectors for concurrent evaluation */
+    void init_parallel(size_t sz_w_tmp, size_t sz_w);
+
+    /** \brief Evaluate a single instruction
+
+        The operation reads and writes the work vector w and uses w_tmp as scratch.
+    */
+    int eval_el(const AlgEl& e, casadi_int k, const double** arg, double** res,
+                const double** arg1, double** res1, casadi_int* iw, double* w,
+                double* w_tmp) const;
+
+    /** \brief Evaluate level by level, independent calls concurrently */
+    int eval_parallel(const double** arg, double** res, casadi_int* iw, double* w,
+                      bvec_t req, bool partial) const;
+
+    /** \brief Determine which outputs depend on each instruction
+
+        Output i is represented by bit i modulo bvec_size, so the masks are
+        conservative when there are more outputs than bits.
+    */
+    void init_out_mask();
+
     /** \brief Constructor
 
         \identifier{22} */
@@ -165,6 +200,9 @@ namespace casadi {
         \identifier{2d} */
     void codegen_body(CodeGenerator& g) const override;
 
+    /// Bytes used by the algorithm and the work vector offsets
+    size_t instructions_bytes() const override;
+
     /** \brief Serialize an object without type information
 
         \identifier{2e} */
@@ -191,6 +229,17 @@ namespace casadi {
     int eval_sx(const SXElem** arg, SXElem** res,
                 casadi_int* iw, SXElem* w, void* mem) const override;
 
+    /** \brief Expansion to SX, generated when first needed
+
+        Used when the function is called from the MX graph of another function that
+        is being expanded, so that a function called many times is only expanded once
+        and each call is a single pass over the instructions of the expansion.
+    */
+    const Function& expansion() const;
+
+    /// Cached expansion to SX
+    mutable Function expansion_;
+
     /** \brief Evaluate symbolically, MX type
 
         \identifier{2i} */
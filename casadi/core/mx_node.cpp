@@ -51,6 +51,7 @@
 #include "assertion.hpp"
 #include "monitor.hpp"
 #include "repmat.hpp"
+#include "kron.hpp"
 #include "casadi_find.hpp"
 #include "casadi_low.hpp"
 #include "einstein.hpp"
@@ -1223,6 +1224,7 @@ namespace casadi {
     {OP_BSPLINE, BSplineCommon::deserialize},
     {OP_CONVEXIFY, Convexify::deserialize},
     {OP_LOGSUMEXP, LogSumExp::deserialize},
+    {OP_KRON, Kron::deserialize},
     {-1, OutputNode::deserialize}
   };
 
@@ -25,6 +25,9 @@
 
 #include "nlp_builder.hpp"
 #include "core.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 
 namespace casadi {
@@ -59,19 +62,34 @@ namespace casadi {
         throw CasadiException(ss.str());
       }
     }
-    // Open file for reading
-    s_.open(filename.c_str());
+    // Read the whole file at once, parsing from memory avoids per-token stream overhead
     if (verbose_) casadi_message("Reading file \"" + filename + "\"");
-
-    // Read the header of the NL-file (first 10 lines)
+    std::ifstream file(filename.c_str(), std::ifstream::binary);
+    casadi_assert(file.good(), "Could not open \"" + filename + "\"");
+    file.seekg(0, std::ios::end);
+    std::streamoff sz = file.tellg();
+    file.seekg(0, std::ios::beg);
+    buf_.resize(sz + 1);
+    file.read(buf_.data(), sz);
+    casadi_assert(file.gcount()==sz, "Could not read \"" + filename + "\"");
+    buf_[sz] = '\0';
+    pos_ = buf_.data();
+    end_ = pos_ + sz;
+
+    // Read the header of the NL-file (first 10 lines), always in text form
     const casadi_int header_sz = 10;
     std::vector<std::string> header(header_sz);
     for (casadi_int k=0; k<header_sz; ++k) {
-      getline(s_, header[k]);
+      const char* eol = pos_;
+      while (eol<end_ && *eol!='\n') ++eol;
+      header[k].assign(pos_, eol);
+      pos_ = eol<end_ ? eol + 1 : eol;
     }
 
     // Assert that the file is not in binary form
-    if (header.at(0).at(0)=='g') {
+    if (header[0].empty()) {
+      casadi_error("File could not be read");
+    } else if (header[0][0]=='g') {
       binary_ = false;
     } else if (header.at(0).at(0)=='b') {
       binary_ = true;
@@ -159,13 +177,6 @@ namespace casadi {
     // All variables, including dependent
     v_ = nlp_.x;
 
-    if (binary_) {
-      std::streampos offset = s_.tellg();
-      s_.close();
-      s_.open(filename.c_str(), std::ifstream::binary);
-      s_.seekg(offset);
-    }
-
     // Read segments
     parse();
 
@@ -173,11 +184,6 @@ namespace casadi {
     nlp_.f = sign_*nlp_.f;
   }
 
-  NlImporter::~NlImporter() {
-    // Close the NL file
-    s_.close();
-  }
-
   void NlImporter::parse() {
     // Segment key
     char key;
@@ -185,8 +191,8 @@ namespace casadi {
     // Process segments
     while (true) {
       // Read segment key
+      if (at_end()) break; // end of file encountered
       key = read_char();
-      if (s_.eof()) break; // end of file encountered
       switch (key) {
         case 'F': F_segment(); break;
         case 'S': S_segment(); break;
@@ -212,10 +218,6 @@ namespace casadi {
 
     // Temporaries
     int i;
-    double d;
-
-    // Error message
-    std::stringstream msg;
 
     // Process instruction
     switch (inst) {
@@ -230,30 +232,15 @@ namespace casadi {
 
       // Numeric expression
       case 'n':
+      return constant(read_double());
 
-      // Read the floating point number
-      d = read_double();
-
-      // Return an expression containing the number
-      return d;
-
-      // Numeric expression
+      // Numeric expression, short
       case 's':
+      return constant(read_short());
 
-      // Read the short number
-      d = read_short();
-
-      // Return an expression containing the number
-      return d;
-
-      // Numeric expression
+      // Numeric expression, long
       case 'l':
-
-      // Read the short number
-      d = static_cast<double>(read_long());
-
-      // Return an expression containing the number
-      return d;
+      return constant(static_cast<double>(read_long()));
 
       // Operation
       case 'o':
@@ -272,34 +259,11 @@ namespace casadi {
           // Read dependency
           MX x = expr();
 
-          // Perform operation
-          switch (i) {
-            case 13:  return floor(x);
-            case 14:  return ceil(x);
-            case 15:  return abs(x);
-            case 16:  return -x;
-            case 34:  return logic_not(x);
-            case 37:  return tanh(x);
-            case 38:  return tan(x);
-            case 39:  return sqrt(x);
-            case 40:  return sinh(x);
-            case 41:  return sin(x);
-            case 42:  return log10(x);
-            case 43:  return log(x);
-            case 44:  return exp(x);
-            case 45:  return cosh(x);
-            case 46:  return cos(x);
-            // case 47:  return atanh(x); FIXME
-            case 49:  return atan(x);
-            // case 50:  return asinh(x); FIXME
-            case 51:  return asin(x);
-            // case 52:  return acosh(x); FIXME
-            case 53:  return acos(x);
-
-            default:
-            casadi_error("Unknown unary operation: " + str(i));
-          }
-          break;
+          // Reuse an identical subexpression
+          std::vector<MX>& r = ops_[std::make_tuple(i, x.get(),
+                                                    static_cast<const MXNode*>(nullptr))];
+          if (r.empty()) r = {unary(i, x), x};
+          return r[0];
         }
 
         // Binary operations, class 2 in Gay2005
@@ -311,35 +275,10 @@ namespace casadi {
           MX x = expr();
           MX y = expr();
 
-          // Perform operation
-          switch (i) {
-            case 0:   return x + y;
-            case 1:   return x - y;
-            case 2:   return x * y;
-            case 3:   return x / y;
-            // case 4:   return rem(x, y); FIXME
-            case 5:   return pow(x, y);
-            // case 6:   return x < y; // TODO(Joel): Verify this,
-            // what is the difference to 'le' == 23 below?
-            case 20:  return logic_or(x, y);
-            case 21:  return logic_and(x, y);
-            case 22:  return x < y;
-            case 23:  return x <= y;
-            case 24:  return x == y;
-            case 28:  return x >= y;
-            case 29:  return x > y;
-            case 30:  return x != y;
-            case 48:  return atan2(x, y);
-            // case 55:  return intdiv(x, y); // FIXME
-            // case 56:  return precision(x, y); // FIXME
-            // case 57:  return round(x, y); // FIXME
-            // case 58:  return trunc(x, y); // FIXME
-            // case 73:  return iff(x, y); // FIXME
-
-            default:
-            casadi_error("Unknown binary operation: " + str(i));
-          }
-          break;
+          // Reuse an identical subexpression
+          std::vector<MX>& r = ops_[std::make_tuple(i, x.get(), y.get())];
+          if (r.empty()) r = {binary(i, x, y), x, y};
+          return r[0];
         }
 
         // N-ary operator, classes 2, 6 and 11 in Gay2005
@@ -395,14 +334,98 @@ namespace casadi {
       break;
 
       default:
-       uout() << s_.tellg() << std::endl;
-      casadi_error("Unknown instruction: " + str(inst));
+      casadi_error("Unknown instruction: " + str(inst) + " at offset "
+                   + str(static_cast<casadi_int>(pos_ - buf_.data())));
     }
 
     // Throw error message
     casadi_error("Unknown error");
   }
 
+  MX NlImporter::constant(double d) {
+    // Key by bit pattern, keeping e.g. -0 and 0 apart
+    uint64_t key;
+    std::memcpy(&key, &d, sizeof(d));
+    MX& r = constants_[key];
+    if (r.is_empty()) r = d;
+    return r;
+  }
+
+  MX NlImporter::unary(int i, const MX& x) {
+    switch (i) {
+      case 13:  return floor(x);
+      case 14:  return ceil(x);
+      case 15:  return abs(x);
+      case 16:  return -x;
+      case 34:  return logic_not(x);
+      case 37:  return tanh(x);
+      case 38:  return tan(x);
+      case 39:  return sqrt(x);
+      case 40:  return sinh(x);
+      case 41:  return sin(x);
+      case 42:  return log10(x);
+      case 43:  return log(x);
+      case 44:  return exp(x);
+      case 45:  return cosh(x);
+      case 46:  return cos(x);
+      // case 47:  return atanh(x); FIXME
+      case 49:  return atan(x);
+      // case 50:  return asinh(x); FIXME
+      case 51:  return asin(x);
+      // case 52:  return acosh(x); FIXME
+      case 53:  return acos(x);
+
+      default:
+      casadi_error("Unknown unary operation: " + str(i));
+    }
+  }
+
+  MX NlImporter::binary(int i, const MX& x, const MX& y) {
+    switch (i) {
+      case 0:   return x + y;
+      case 1:   return x - y;
+      case 2:   return x * y;
+      case 3:   return x / y;
+      // case 4:   return rem(x, y); FIXME
+      case 5:   return pow(x, y);
+      // case 6:   return x < y; // TODO(Joel): Verify this,
+      // what is the difference to 'le' == 23 below?
+      case 20:  return logic_or(x, y);
+      case 21:  return logic_and(x, y);
+      case 22:  return x < y;
+      case 23:  return x <= y;
+      case 24:  return x == y;
+      case 28:  return x >= y;
+      case 29:  return x > y;
+      case 30:  return x != y;
+      case 48:  return atan2(x, y);
+      // case 55:  return intdiv(x, y); // FIXME
+      // case 56:  return precision(x, y); // FIXME
+      // case 57:  return round(x, y); // FIXME
+      // case 58:  return trunc(x, y); // FIXME
+      // case 73:  return iff(x, y); // FIXME
+
+      default:
+      casadi_error("Unknown binary operation: " + str(i));
+    }
+  }
+
+  MX NlImporter::linear(int k) {
+    std::vector<double> c(k);
+    std::vector<MX> v(k);
+    for (int kk=0; kk<k; ++kk) {
+      // Get the term
+      int j = read_int();
+      c[kk] = read_double();
+      casadi_assert(!v_.at(j).is_empty(), "Circular dependencies not supported");
+      v[kk] = v_[j];
+    }
+    // A chain of k additions would make the graph k nodes deep
+    if (k==0) return 0;
+    if (k==1) return c[0]*v[0];
+    return mtimes(DM(c).T(), vertcat(v));
+  }
+
   void NlImporter::F_segment() {
     casadi_error("Imported function description unsupported.");
   }
@@ -422,72 +445,94 @@ namespace casadi {
       v_.resize(i+1);
     }
 
-    // Initialize element to zero
-    v_.at(i) = 0;
+    // Linear terms, referring to variables that have already been defined
+    MX lin = linear(j);
 
-    // Add the linear terms
-    for (int jj=0; jj<j; ++jj) {
-      // Linear term
-      int pl = read_int();
-      double cl = read_double();
+    // Add the nonlinear term
+    v_.at(i) = lin + expr();
+  }
 
-      // Add to variable definition (assuming it has already been defined)
-      casadi_assert(!v_.at(pl).is_empty(), "Circular dependencies not supported");
-      v_.at(i) += cl*v_.at(pl);
+  bool NlImporter::at_end() {
+    if (!binary_) {
+      while (pos_<end_) {
+        if (*pos_=='#') {
+          // Comment until the end of the line
+          while (pos_<end_ && *pos_!='\n') ++pos_;
+        } else if (std::isspace(static_cast<unsigned char>(*pos_))) {
+          ++pos_;
+        } else {
+          break;
+        }
+      }
     }
-
-    // Finally, add the nonlinear term
-    v_.at(i) += expr();
+    return pos_>=end_;
   }
 
   int NlImporter::read_int() {
     int i;
     if (binary_) {
-      s_.read(reinterpret_cast<char *>(&i), sizeof(int));
+      casadi_assert(end_-pos_>=sizeof(int), "Unexpected end of file");
+      std::memcpy(&i, pos_, sizeof(int));
+      pos_ += sizeof(int);
     } else {
-      s_ >> i;
+      casadi_assert(!at_end(), "Unexpected end of file");
+      bool neg = *pos_=='-';
+      if (neg || *pos_=='+') ++pos_;
+      casadi_assert(std::isdigit(static_cast<unsigned char>(*pos_)),
+        "Integer expected at offset " + str(static_cast<casadi_int>(pos_ - buf_.data())));
+      i = 0;
+      while (std::isdigit(static_cast<unsigned char>(*pos_))) i = 10*i + (*pos_++ - '0');
+      if (neg) i = -i;
     }
     return i;
   }
 
   char NlImporter::read_char() {
-    char c;
-    if (binary_) {
-      s_.read(&c, 1);
-    } else {
-      s_ >> c;
-    }
-    return c;
+    if (!binary_) casadi_assert(!at_end(), "Unexpected end of file");
+    casadi_assert(pos_<end_, "Unexpected end of file");
+    return *pos_++;
   }
 
   double NlImporter::read_double() {
     double d;
     if (binary_) {
-      s_.read(reinterpret_cast<char *>(&d), sizeof(double));
+      casadi_assert(end_-pos_>=sizeof(double), "Unexpected end of file");
+      std::memcpy(&d, pos_, sizeof(double));
+      pos_ += sizeof(double);
     } else {
-      s_ >> d;
+      casadi_assert(!at_end(), "Unexpected end of file");
+      // The buffer is null-terminated
+      char* e;
+      d = std::strtod(pos_, &e);
+      casadi_assert(e!=pos_,
+        "Number expected at offset " + str(static_cast<casadi_int>(pos_ - buf_.data())));
+      pos_ = e;
     }
     return d;
   }
 
   short NlImporter::read_short() {
-    short d;
     if (binary_) {
-      s_.read(reinterpret_cast<char *>(&d), 2);
+      int16_t d;
+      casadi_assert(end_-pos_>=2, "Unexpected end of file");
+      std::memcpy(&d, pos_, 2);
+      pos_ += 2;
+      return d;
     } else {
-      s_ >> d;
+      return static_cast<short>(read_int());
     }
-    return d;
   }
 
   long NlImporter::read_long() {
-    long d;
     if (binary_) {
-      s_.read(reinterpret_cast<char *>(&d), 4);
+      int32_t d;
+      casadi_assert(end_-pos_>=4, "Unexpected end of file");
+      std::memcpy(&d, pos_, 4);
+      pos_ += 4;
+      return d;
     } else {
-      s_ >> d;
+      return read_int();
     }
-    return d;
   }
 
   void NlImporter::C_segment() {
@@ -668,15 +713,8 @@ namespace casadi {
     int i = read_int();
     int k = read_int();
 
-    // Get terms
-    for (int kk=0; kk<k; ++kk) {
-      // Get the term
-      int j = read_int();
-      double c = read_double();
-
-      // Add to constraints
-      nlp_.g.at(i) += c*v_.at(j);
-    }
+    // Add terms to constraints
+    nlp_.g.at(i) += linear(k);
   }
 
   void NlImporter::G_segment() {
@@ -684,15 +722,8 @@ namespace casadi {
     read_int(); // i
     int k = read_int();
 
-    // Get terms
-    for (int kk=0; kk<k; ++kk) {
-      // Get the term
-      int j = read_int();
-      double c = read_double();
-
-      // Add to objective
-      nlp_.f += c*v_.at(j);
-    }
+    // Add terms to objective
+    nlp_.f += linear(k);
   }
 
 
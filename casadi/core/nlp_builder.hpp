@@ -27,6 +27,8 @@
 #define CASADI_NLP_BUILDER_HPP
 
 #include "mx.hpp"
+#include <map>
+#include <tuple>
 
 namespace casadi {
 
@@ -97,9 +99,9 @@ namespace casadi {
   public:
     // Constructor
     NlImporter(NlpBuilder& nlp, const std::string& filename, const Dict& opts);
-    // Destructor
-    ~NlImporter();
   private:
+    // Skip whitespace and comments in text mode, true if the end of the file is reached
+    bool at_end();
     int read_int();
     char read_char();
     double read_double();
@@ -111,10 +113,18 @@ namespace casadi {
     bool verbose_;
     // Binary mode
     bool binary_;
-    // File stream
-    std::ifstream s_;
+    // Contents of the file, null-terminated
+    std::vector<char> buf_;
+    // Read position and end of the contents
+    const char *pos_, *end_;
     // All variables, including dependent
     std::vector<MX> v_;
+    // Constants by bit pattern, such that repeated constants share a node
+    std::map<uint64_t, MX> constants_;
+    // Operations by operation and argument nodes, such that repeated subexpressions share a node.
+    // Holds the result and the arguments, keeping the latter alive so that their addresses
+    // cannot be reused by other nodes
+    std::map<std::tuple<int, const MXNode*, const MXNode*>, std::vector<MX> > ops_;
     // Number of objectives and constraints
     casadi_int n_var_, n_con_, n_obj_, n_eq_, n_lcon_;
     // nonlinear vars in constraints, objectives, both
@@ -154,6 +164,13 @@ namespace casadi {
     void G_segment();
     /// Read an expression from an NL-file (Polish infix format)
     MX expr();
+    /// Constant expression, shared between occurrences
+    MX constant(double d);
+    /// Unary and binary operations with .nl operation codes
+    static MX unary(int i, const MX& x);
+    static MX binary(int i, const MX& x, const MX& y);
+    /// Read the linear terms of a segment, sum_k c_k*v_{j_k}, with a single dot product
+    MX linear(int k);
   };
 #endif // SWIG
 
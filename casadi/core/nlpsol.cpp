@@ -24,6 +24,8 @@
 
 
 #include "nlpsol_impl.hpp"
+#include "nlpsol_presolve.hpp"
+#include "nlpsol_multistart.hpp"
 #include "external.hpp"
 #include "casadi/core/timing.hpp"
 #include "nlp_builder.hpp"
@@ -47,6 +49,48 @@ namespace casadi {
   Function construct_nlpsol(const std::string& name, const std::string& solver,
                   const std::map<std::string, X>& nlp, const Dict& opts) {
 
+    if (get_from_dict(opts, "presolve", false)) {
+      X x = get_from_dict(nlp, "x", X(0, 1));
+      X p = get_from_dict(nlp, "p", X(0, 1));
+      X f = get_from_dict(nlp, "f", X(0));
+      X g = get_from_dict(nlp, "g", X(0, 1));
+
+      // Options for the solver of the reduced problem
+      Dict solver_opts = opts;
+      solver_opts.erase("presolve");
+
+      // Candidates for elimination: x_j enters a single constraint, linearly,
+      // and does not enter the objective
+      std::vector<casadi_int> sing_x, sing_g;
+      std::vector<X> sing_coeff;
+      if (g.numel()>0) {
+        Sparsity sp = jacobian_sparsity(g, x);
+        std::vector<bool> is_nonlin = which_depends(g, x, 2, false);
+        std::vector<bool> in_f = which_depends(f, x, 1, false);
+        const casadi_int* colind = sp.colind();
+        const casadi_int* row = sp.row();
+        X J;
+        for (casadi_int j=0; j<x.numel(); ++j) {
+          if (colind[j+1]-colind[j]!=1 || is_nonlin[j] || in_f[j]) continue;
+          if (J.is_empty()) J = jacobian(g, x);
+          // Coefficient may depend on p, but not on x
+          X a = J(row[colind[j]], j);
+          if (depends_on(a, x)) continue;
+          sing_x.push_back(j);
+          sing_g.push_back(row[colind[j]]);
+          sing_coeff.push_back(a);
+        }
+      }
+      Function coeff_fcn;
+      if (!sing_x.empty()) {
+        coeff_fcn = Function("presolve_coeff", std::vector<X>{p},
+          std::vector<X>{densify(vertcat(sing_coeff))});
+      }
+      return Function::create(new NlpsolPresolve(name, solver,
+        Nlpsol::create_oracle(nlp, solver_opts), sing_x, sing_g, coeff_fcn, solver_opts),
+        Dict());
+    }
+
     if (get_from_dict(opts, "detect_simple_bounds", false)) {
       X x = get_from_dict(nlp, "x", X(0, 1));
       X p = get_from_dict(nlp, "p", X(0, 1));
@@ -191,9 +235,29 @@ namespace casadi {
     if (nlp.has_free()) {
       casadi_error("Cannot create '" + name + "' since " + str(nlp.get_free()) + " are free.");
     }
+    if (get_from_dict(opts, "presolve", false)) {
+      // Only fixed variables are removed, no symbolic expressions available
+      Dict solver_opts = opts;
+      solver_opts.erase("presolve");
+      return Function::create(new NlpsolPresolve(name, solver, nlp, {}, {}, Function(),
+        solver_opts), Dict());
+    }
     return Function::create(Nlpsol::instantiate(name, solver, nlp), opts);
   }
 
+  Function nlpsol_multistart(const std::string& name, const Function& solver,
+                             casadi_int n_start, const Dict& opts) {
+    return Function::create(new NlpsolMultistart(name, solver, n_start), opts);
+  }
+
+  Function nlpsol_predictor(const std::string& name, const Function& solver,
+                            casadi_int n_corrector, const Dict& opts) {
+    casadi_assert(solver.is_a("Nlpsol", true),
+      "nlpsol_predictor: '" + solver.name() + "' is not an NLP solver");
+    casadi_assert(n_corrector >= 0, "nlpsol_predictor: n_corrector must be nonnegative");
+    return static_cast<const Nlpsol*>(solver.get())->predictor(name, n_corrector, opts);
+  }
+
   std::vector<std::string> nlpsol_in() {
     std::vector<std::string> ret(nlpsol_n_in());
     for (size_t i=0; i<ret.size(); ++i) ret[i]=nlpsol_in(i);
@@ -272,6 +336,8 @@ namespace casadi {
     print_time_ = true;
     calc_multipliers_ = false;
     bound_consistency_ = false;
+    warm_start_ = false;
+    warm_start_shift_x_ = warm_start_shift_g_ = 0;
     min_lam_ = 0;
     calc_lam_x_ = calc_f_ = calc_g_ = false;
     calc_lam_p_ = true;
@@ -380,6 +446,19 @@ namespace casadi {
       {"min_lam",
        {OT_DOUBLE,
         "Minimum allowed multiplier value"}},
+      {"warm_start",
+       {OT_BOOL,
+        "Start from the primal-dual solution of the previous call with the same "
+        "memory object instead of x0, lam_x0 and lam_g0. Solvers may also keep "
+        "internal state such as Hessian approximations [false]"}},
+      {"warm_start_shift_x",
+       {OT_INT,
+        "Shift the warm start x and lam_x by this many entries, repeating the last "
+        "entries, e.g. the number of variables per stage of an OCP [0]"}},
+      {"warm_start_shift_g",
+       {OT_INT,
+        "Shift the warm start lam_g by this many entries, repeating the last "
+        "entries [0]"}},
       {"oracle_options",
        {OT_DICT,
         "Options to be passed to the oracle function"}},
@@ -396,6 +475,12 @@ namespace casadi {
         "1) Subtleties in heuristics and stopping criteria may change the solution, "
         "2) IPOPT may lie about multipliers of simple equality bounds unless "
         "'fixed_variable_treatment' is set to 'relax_bounds'."}},
+      {"presolve",
+       {OT_BOOL,
+        "Remove fixed variables (lbx==ubx) and variables that only enter a single "
+        "equality constraint linearly (and not the objective) before calling the solver "
+        "(default false). The solver is rebuilt when the pattern changes. "
+        "Solution and multipliers are mapped back to the full problem."}},
       {"detect_simple_bounds_is_simple",
        {OT_BOOLVECTOR,
         "For internal use only."}},
@@ -460,6 +545,12 @@ namespace casadi {
         bound_consistency_ = op.second;
       } else if (op.first=="min_lam") {
         min_lam_ = op.second;
+      } else if (op.first=="warm_start") {
+        warm_start_ = op.second;
+      } else if (op.first=="warm_start_shift_x") {
+        warm_start_shift_x_ = op.second;
+      } else if (op.first=="warm_start_shift_g") {
+        warm_start_shift_g_ = op.second;
       } else if (op.first=="sens_linsol") {
         sens_linsol_ = op.second.to_string();
       } else if (op.first=="sens_linsol_options") {
@@ -581,6 +672,7 @@ namespace casadi {
     m->add_stat("callback_fun");
     m->success = false;
     m->unified_return_status = SOLVER_RET_UNKNOWN;
+    m->warm_start = false;
     return 0;
   }
 
@@ -767,6 +859,19 @@ namespace casadi {
       }
     }
 
+    // Start from the (shifted) solution of the previous call
+    m->warm_start = warm_start_ && !m->z_warm.empty();
+    if (m->warm_start) {
+      for (casadi_int i=0; i<nx_; ++i) {
+        casadi_int k = warm_start_index(i, nx_, warm_start_shift_x_);
+        d_nlp->z[i] = m->z_warm[k];
+        d_nlp->lam[i] = m->lam_warm[k];
+      }
+      for (casadi_int i=0; i<ng_; ++i) {
+        d_nlp->lam[nx_+i] = m->lam_warm[nx_ + warm_start_index(i, ng_, warm_start_shift_g_)];
+      }
+    }
+
     // Set multipliers to nan
     casadi_fill(d_nlp->lam_p, np_, nan);
 
@@ -806,6 +911,17 @@ namespace casadi {
       bound_consistency(nx_+ng_, d_nlp->z, d_nlp->lam, d_nlp->lbz, d_nlp->ubz);
     }
 
+    // Keep the solution for warm starting the next call
+    if (warm_start_) {
+      if (flag) {
+        m->z_warm.clear();
+        m->lam_warm.clear();
+      } else {
+        m->z_warm.assign(d_nlp->z, d_nlp->z + nx_);
+        m->lam_warm.assign(d_nlp->lam, d_nlp->lam + nx_ + ng_);
+      }
+    }
+
     // Get optimal solution
     casadi_copy(d_nlp->z, nx_, d_nlp->x);
 
@@ -1061,6 +1177,112 @@ namespace casadi {
     return Function(name, arg, res, inames, onames, options);
   }
 
+  Function Nlpsol::
+  predictor(const std::string& name, casadi_int n_corrector, const Dict& opts) const {
+    // Reference solution, obtained for the parameters p_ref
+    MX x_ref = MX::sym("x_ref", sparsity_out_.at(NLPSOL_X));
+    MX lam_x_ref = MX::sym("lam_x_ref", sparsity_out_.at(NLPSOL_LAM_X));
+    MX lam_g_ref = MX::sym("lam_g_ref", sparsity_out_.at(NLPSOL_LAM_G));
+    MX p_ref = MX::sym("p_ref", sparsity_in_.at(NLPSOL_P));
+
+    // New parameters and bounds
+    MX p = MX::sym("p", sparsity_in_.at(NLPSOL_P));
+    MX lbx = MX::sym("lbx", sparsity_in_.at(NLPSOL_LBX));
+    MX ubx = MX::sym("ubx", sparsity_in_.at(NLPSOL_UBX));
+    MX lbg = MX::sym("lbg", sparsity_in_.at(NLPSOL_LBG));
+    MX ubg = MX::sym("ubg", sparsity_in_.at(NLPSOL_UBG));
+
+    // (x, p, lam_f, lam_g) -> (f, g, grad_x, grad_p)
+    Function nlp_grad = get_function("nlp_grad");
+
+    // Remaining outputs at the reference solution
+    std::vector<MX> vv = nlp_grad({x_ref, p_ref, 1, lam_g_ref});
+    MX f_ref = vv.at(0), g_ref = vv.at(1), lam_p_ref = -vv.at(3);
+
+    // Active set (assumed known and given by the multiplier signs)
+    MX ubIx = lam_x_ref > min_lam_;
+    MX lbIx = lam_x_ref < -min_lam_;
+    MX bIx = ubIx + lbIx;
+    MX iIx = 1-bIx;
+    MX ubIg = lam_g_ref > min_lam_;
+    MX lbIg = lam_g_ref < -min_lam_;
+    MX bIg = ubIg + lbIg;
+    MX iIg = 1-bIg;
+
+    // Bound changes for active constraints, where the bounds equal x_ref and g_ref
+    MX dlbx = if_else(lbIx, lbx - x_ref, 0), dubx = if_else(ubIx, ubx - x_ref, 0);
+    MX dlbg = if_else(lbIg, lbg - g_ref, 0), dubg = if_else(ubIg, ubg - g_ref, 0);
+
+    // Predictor: first order update using the forward sensitivities
+    Function fwd = self().forward(1);
+    std::vector<MX> fwd_arg(NLPSOL_NUM_IN + NLPSOL_NUM_OUT + NLPSOL_NUM_IN);
+    fwd_arg[NLPSOL_X0] = x_ref;
+    fwd_arg[NLPSOL_P] = p_ref;
+    fwd_arg[NLPSOL_LBX] = lbx;
+    fwd_arg[NLPSOL_UBX] = ubx;
+    fwd_arg[NLPSOL_LBG] = lbg;
+    fwd_arg[NLPSOL_UBG] = ubg;
+    fwd_arg[NLPSOL_LAM_X0] = lam_x_ref;
+    fwd_arg[NLPSOL_LAM_G0] = lam_g_ref;
+    casadi_int off = NLPSOL_NUM_IN;
+    fwd_arg[off + NLPSOL_X] = x_ref;
+    fwd_arg[off + NLPSOL_F] = f_ref;
+    fwd_arg[off + NLPSOL_G] = g_ref;
+    fwd_arg[off + NLPSOL_LAM_X] = lam_x_ref;
+    fwd_arg[off + NLPSOL_LAM_G] = lam_g_ref;
+    fwd_arg[off + NLPSOL_LAM_P] = lam_p_ref;
+    off += NLPSOL_NUM_OUT;
+    fwd_arg[off + NLPSOL_X0] = 0;
+    fwd_arg[off + NLPSOL_P] = p - p_ref;
+    fwd_arg[off + NLPSOL_LBX] = dlbx;
+    fwd_arg[off + NLPSOL_UBX] = dubx;
+    fwd_arg[off + NLPSOL_LBG] = dlbg;
+    fwd_arg[off + NLPSOL_UBG] = dubg;
+    fwd_arg[off + NLPSOL_LAM_X0] = 0;
+    fwd_arg[off + NLPSOL_LAM_G0] = 0;
+    std::vector<MX> fwd_res = fwd(fwd_arg);
+    MX x = x_ref + fwd_res.at(NLPSOL_X);
+    MX lam_g = lam_g_ref + fwd_res.at(NLPSOL_LAM_G);
+
+    // Corrector: Newton steps on the KKT conditions at p, with the active set fixed
+    if (n_corrector > 0) {
+      Function kkt = this->kkt();
+      // Values of the active bounds
+      MX bnd_x = if_else(lbIx, lbx, if_else(ubIx, ubx, 0));
+      MX bnd_g = if_else(lbIg, lbg, if_else(ubIg, ubg, 0));
+      for (casadi_int k = 0; k < n_corrector; ++k) {
+        // Hessian of the Lagrangian, Jacobian of the constraints
+        std::vector<MX> HJ_res = kkt({x, p, 1, lam_g});
+        MX JG = HJ_res.at(0);
+        MX HL = HJ_res.at(1);
+        // KKT matrix, same structure as in get_forward
+        MX H_11 = mtimes(diag(iIx), HL) + diag(bIx);
+        MX H_12 = mtimes(diag(iIx), JG.T());
+        MX H_21 = mtimes(diag(bIg), JG);
+        MX H_22 = diag(-iIg);
+        MX H = MX::blockcat({{H_11, H_12}, {H_21, H_22}});
+        // Residual: stationarity for free variables, feasibility for active constraints
+        vv = nlp_grad({x, p, 1, lam_g});
+        MX r_x = if_else(iIx, vv.at(2), 0) + if_else(bIx, x - bnd_x, 0);
+        MX r_g = if_else(bIg, vv.at(1) - bnd_g, 0) - if_else(iIg, lam_g, 0);
+        // Newton step
+        MX v = MX::solve(H, -MX::vertcat({r_x, r_g}), sens_linsol_, sens_linsol_options_);
+        std::vector<MX> v_split = vertsplit(v, {0, nx_, nx_+ng_});
+        x += v_split.at(0);
+        lam_g += v_split.at(1);
+      }
+    }
+
+    // Objective, constraints and remaining multipliers at the updated point
+    vv = nlp_grad({x, p, 1, lam_g});
+    MX lam_x = if_else(bIx, -vv.at(2), 0);
+    std::vector<MX> res = {x, vv.at(0), vv.at(1), lam_x, lam_g, -vv.at(3)};
+    return Function(name,
+      {x_ref, lam_x_ref, lam_g_ref, p_ref, p, lbx, ubx, lbg, ubg}, res,
+      {"x_ref", "lam_x_ref", "lam_g_ref", "p_ref", "p", "lbx", "ubx", "lbg", "ubg"},
+      nlpsol_out(), opts);
+  }
+
   Function Nlpsol::
   get_reverse(casadi_int nadj, const std::string& name,
               const std::vector<std::string>& inames,
@@ -1184,13 +1406,19 @@ namespace casadi {
   }
 
   int Nlpsol::callback(NlpsolMemory* m) const {
+    auto d_nlp = &m->d_nlp;
+
+    // Early termination requested by a driver, e.g. multi-start
+    if (m->stop_check) {
+      double pr_inf = casadi_max_viol(nx_ + ng_, d_nlp->z, d_nlp->lbz, d_nlp->ubz);
+      if (m->stop_check(d_nlp->objective, pr_inf)) return 1;
+    }
+
     // Quick return if no callback function
     if (fcallback_.is_null()) return 0;
     // Callback inputs
     std::fill_n(m->arg, fcallback_.n_in(), nullptr);
 
-    auto d_nlp = &m->d_nlp;
-
     m->arg[NLPSOL_X] = d_nlp->z;
     m->arg[NLPSOL_F] = &d_nlp->objective;
     m->arg[NLPSOL_G] = d_nlp->z + nx_;
@@ -1269,7 +1497,7 @@ namespace casadi {
   void Nlpsol::serialize_body(SerializingStream &s) const {
     OracleFunction::serialize_body(s);
 
-    s.version("Nlpsol", 3);
+    s.version("Nlpsol", 4);
     s.pack("Nlpsol::nx", nx_);
     s.pack("Nlpsol::ng", ng_);
     s.pack("Nlpsol::np", np_);
@@ -1293,6 +1521,9 @@ namespace casadi {
     s.pack("Nlpsol::detect_simple_bounds_is_simple", detect_simple_bounds_is_simple_);
     s.pack("Nlpsol::detect_simple_bounds_parts", detect_simple_bounds_parts_);
     s.pack("Nlpsol::detect_simple_bounds_target_x", detect_simple_bounds_target_x_);
+    s.pack("Nlpsol::warm_start", warm_start_);
+    s.pack("Nlpsol::warm_start_shift_x", warm_start_shift_x_);
+    s.pack("Nlpsol::warm_start_shift_g", warm_start_shift_g_);
   }
 
   void Nlpsol::serialize_type(SerializingStream &s) const {
@@ -1305,7 +1536,7 @@ namespace casadi {
   }
 
   Nlpsol::Nlpsol(DeserializingStream & s) : OracleFunction(s) {
-    int version = s.version("Nlpsol", 1, 3);
+    int version = s.version("Nlpsol", 1, 4);
     s.unpack("Nlpsol::nx", nx_);
     s.unpack("Nlpsol::ng", ng_);
     s.unpack("Nlpsol::np", np_);
@@ -1339,6 +1570,14 @@ namespace casadi {
       s.unpack("Nlpsol::detect_simple_bounds_parts", detect_simple_bounds_parts_);
       s.unpack("Nlpsol::detect_simple_bounds_target_x", detect_simple_bounds_target_x_);
     }
+    if (version>=4) {
+      s.unpack("Nlpsol::warm_start", warm_start_);
+      s.unpack("Nlpsol::warm_start_shift_x", warm_start_shift_x_);
+      s.unpack("Nlpsol::warm_start_shift_g", warm_start_shift_g_);
+    } else {
+      warm_start_ = false;
+      warm_start_shift_x_ = warm_start_shift_g_ = 0;
+    }
     for (casadi_int i=0;i<detect_simple_bounds_is_simple_.size();++i) {
       if (detect_simple_bounds_is_simple_[i]) {
         detect_simple_bounds_target_g_.push_back(i);
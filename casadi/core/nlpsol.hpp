@@ -83,6 +83,37 @@ namespace casadi {
                                 const Function& nlp, const Dict& opts=Dict());
   ///@}
 
+  /** \brief Multi-start driver for an NLP solver
+
+      Returns a function with the same inputs and outputs as \a solver,
+      except that x0 has \a n_start columns, one initial guess per start.
+      The starts are solved concurrently on the thread pool, sharing the solver
+      and its oracle functions, and the best successful solution is returned.
+      Per-start objectives and return flags are available from stats().
+
+      Options: terminate_early (bool), terminate_min_iter (int), terminate_tol,
+      terminate_tol_pr (double), see the documentation of the returned function.
+  */
+  CASADI_EXPORT Function nlpsol_multistart(const std::string& name, const Function& solver,
+                                           casadi_int n_start, const Dict& opts=Dict());
+
+  /** \brief Approximate re-solve of a parametric NLP from a known solution
+
+      Returns a function that updates a solution of \a solver, obtained for the
+      parameters p_ref, to new parameters and bounds without solving the NLP.
+      A first order predictor is calculated from the parametric sensitivities of
+      the solution, keeping the active set (given by the multiplier signs) fixed.
+      It is followed by \a n_corrector Newton steps on the KKT conditions at the
+      new parameters, with the same active set.
+
+      Inputs: x_ref, lam_x_ref, lam_g_ref, p_ref, p, lbx, ubx, lbg, ubg
+      Outputs: x, f, g, lam_x, lam_g, lam_p
+
+      The options are passed to the constructor of the returned function.
+  */
+  CASADI_EXPORT Function nlpsol_predictor(const std::string& name, const Function& solver,
+                                          casadi_int n_corrector=0, const Dict& opts=Dict());
+
   /** \brief Get input scheme of NLP solvers
 
   * \if EXPANDED
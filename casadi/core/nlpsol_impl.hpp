@@ -29,6 +29,7 @@
 #include "nlpsol.hpp"
 #include "oracle_function.hpp"
 #include "plugin_interface.hpp"
+#include <functional>
 
 
 /// \cond INTERNAL
@@ -46,6 +47,12 @@ namespace casadi {
     bool success;
     // Return status
     UnifiedReturnStatus unified_return_status;
+    // Primal-dual solution of the previous call, for warm starting
+    std::vector<double> z_warm, lam_warm;
+    // Was the current call warm started?
+    bool warm_start;
+    // Early termination test (objective, primal infeasibility), set by drivers
+    std::function<bool(double, double)> stop_check;
   };
 
   /** \brief NLP solver storage class
@@ -96,6 +103,8 @@ namespace casadi {
     bool calc_multipliers_;
     bool calc_lam_x_, calc_lam_p_, calc_f_, calc_g_;
     bool bound_consistency_;
+    bool warm_start_;
+    casadi_int warm_start_shift_x_, warm_start_shift_g_;
     double min_lam_;
     bool no_nlp_grad_;
     std::vector<bool> discrete_;
@@ -253,10 +262,19 @@ namespace casadi {
     // Get KKT function
     Function kkt() const;
 
+    // Get a predictor-corrector for parametric re-solves, cf. nlpsol_predictor
+    Function predictor(const std::string& name, casadi_int n_corrector,
+                       const Dict& opts) const;
+
     // Make sure primal-dual solution is consistent with bounds
     static void bound_consistency(casadi_int n, double* z, double* lam,
                                   const double* lbz, const double* ubz);
 
+    // Index in the previous solution that entry i is warm started from
+    static casadi_int warm_start_index(casadi_int i, casadi_int n, casadi_int shift) {
+      return i + shift < n ? i + shift : i;
+    }
+
     // Creator function for internal class
     typedef Nlpsol* (*Creator)(const std::string& name, const Function& oracle);
 
@@ -0,0 +1,236 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "nlpsol_multistart.hpp"
+#include "nlpsol_impl.hpp"
+#include "thread_pool.hpp"
+
+namespace casadi {
+
+  NlpsolMultistart::NlpsolMultistart(const std::string& name, const Function& solver,
+                                     casadi_int n_start)
+    : FunctionInternal(name), solver_(solver), n_start_(n_start) {
+    casadi_assert(solver_.n_in()==NLPSOL_NUM_IN && solver_.n_out()==NLPSOL_NUM_OUT,
+      "Multi-start requires an NLP solver, got " + solver_.class_name() + ".");
+    casadi_assert(n_start_>0, "Number of starts must be positive.");
+    terminate_early_ = false;
+    terminate_min_iter_ = 5;
+    terminate_tol_ = 1e-6;
+    terminate_tol_pr_ = 1e-6;
+  }
+
+  NlpsolMultistart::~NlpsolMultistart() {
+    clear_mem();
+  }
+
+  const Options NlpsolMultistart::options_
+  = {{&FunctionInternal::options_},
+     {{"terminate_early",
+       {OT_BOOL,
+        "Terminate a start when a feasible iterate has an objective above the best "
+        "objective found so far, a heuristic (default false)"}},
+      {"terminate_min_iter",
+       {OT_INT,
+        "Minimum number of iterations before a start can be terminated (default 5)"}},
+      {"terminate_tol",
+       {OT_DOUBLE,
+        "Relative objective margin for early termination (default 1e-6)"}},
+      {"terminate_tol_pr",
+       {OT_DOUBLE,
+        "Primal infeasibility below which an iterate counts as feasible (default 1e-6)"}}
+     }
+  };
+
+  void NlpsolMultistart::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="terminate_early") {
+        terminate_early_ = op.second;
+      } else if (op.first=="terminate_min_iter") {
+        terminate_min_iter_ = op.second;
+      } else if (op.first=="terminate_tol") {
+        terminate_tol_ = op.second;
+      } else if (op.first=="terminate_tol_pr") {
+        terminate_tol_pr_ = op.second;
+      }
+    }
+    casadi_assert(!terminate_early_ || solver_.is_a("Nlpsol", true),
+      "Option 'terminate_early' requires a plain NLP solver.");
+  }
+
+  Sparsity NlpsolMultistart::get_sparsity_in(casadi_int i) {
+    if (i==NLPSOL_X0) {
+      // One column per start
+      return Sparsity::dense(solver_.nnz_out(NLPSOL_X), n_start_);
+    } else {
+      return solver_.sparsity_in(i);
+    }
+  }
+
+  void NlpsolMultistart::serialize_body(SerializingStream &s) const {
+    casadi_error("Serialization not supported for multi-start, "
+      "serialize the underlying solver instead.");
+  }
+
+  void NlpsolMultistart::find(std::map<FunctionInternal*, Function>& all_fun,
+      casadi_int max_depth) const {
+    add_embedded(all_fun, solver_, max_depth);
+  }
+
+  int NlpsolMultistart::eval(const double** arg, double** res,
+                             casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<NlpsolMultistartMemory*>(mem);
+    casadi_int nx = solver_.nnz_out(NLPSOL_X);
+
+    // Offsets of the outputs of a start in its solution buffer
+    std::vector<casadi_int> offset(n_out_ + 1, 0);
+    for (casadi_int i=0; i<n_out_; ++i) offset[i+1] = offset[i] + nnz_out(i);
+
+    // Reset statistics
+    m->f_start.assign(n_start_, nan);
+    m->success_start.assign(n_start_, 0);
+    m->stats_start.assign(n_start_, Dict());
+    std::vector<std::vector<double>> sol(n_start_);
+
+    // Best objective among successful starts, shared between threads
+    std::atomic<double> f_best(inf);
+    std::atomic<casadi_int> next(0), n_terminated(0);
+
+    // Each thread checks out its own solver memory
+    casadi_int n_chunk = std::min(n_start_, ThreadPool::instance().size());
+    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_chunk);
+    for (casadi_int k=0; k<n_chunk; ++k) ind.emplace_back(solver_);
+
+    // Starts are claimed one at a time, since solve times vary a lot
+    ThreadPool::instance().run(n_chunk, [&](casadi_int k) {
+      // Work vectors of this thread
+      std::vector<const double*> arg1(solver_.sz_arg());
+      std::vector<double*> res1(solver_.sz_res());
+      std::vector<casadi_int> iw1(solver_.sz_iw());
+      std::vector<double> w1(solver_.sz_w());
+
+      // Early termination of dominated starts
+      casadi_int n_iter = 0;
+      bool terminated = false;
+      NlpsolMemory* sm = nullptr;
+      if (terminate_early_) {
+        sm = static_cast<NlpsolMemory*>(solver_.memory(ind[k]));
+        sm->stop_check = [&](double f, double pr_inf) {
+          if (++n_iter < terminate_min_iter_ || pr_inf > terminate_tol_pr_) return false;
+          double fb = f_best.load();
+          terminated = f > fb + terminate_tol_ * (1 + std::fabs(fb));
+          return terminated;
+        };
+      }
+
+      casadi_int i;
+      while ((i = next++) < n_start_) {
+        n_iter = 0;
+        terminated = false;
+
+        // Inputs, x0 from the corresponding column
+        std::copy_n(arg, n_in_, arg1.begin());
+        if (arg[NLPSOL_X0]) arg1[NLPSOL_X0] = arg[NLPSOL_X0] + i*nx;
+
+        // Outputs
+        sol[i].resize(offset.back());
+        for (casadi_int j=0; j<n_out_; ++j) res1[j] = get_ptr(sol[i]) + offset[j];
+
+        // Solve, a failing start does not affect the others
+        bool ok = true;
+        try {
+          if (solver_(get_ptr(arg1), get_ptr(res1), get_ptr(iw1), get_ptr(w1), ind[k])) {
+            ok = false;
+          }
+        } catch (KeyboardInterruptException& ex) {
+          if (sm) sm->stop_check = nullptr;
+          throw;
+        } catch (std::exception& ex) {
+          if (verbose_ && !terminated) {
+            casadi_message("Start " + str(i) + " failed: " + std::string(ex.what()));
+          }
+          ok = false;
+        }
+        if (terminated) n_terminated++;
+
+        // Record the result
+        Dict stats = solver_.stats(ind[k]);
+        bool success = ok && !terminated && stats.count("success")
+          && stats.at("success").to_bool();
+        double f = sol[i][offset[NLPSOL_F]];
+        m->stats_start[i] = stats;
+        m->f_start[i] = f;
+        m->success_start[i] = success;
+
+        // Update the best objective
+        if (success) {
+          double fb = f_best.load();
+          while (f < fb && !f_best.compare_exchange_weak(fb, f)) {}
+        }
+      }
+      if (sm) sm->stop_check = nullptr;
+    });
+
+    // Pick the best successful start, or else the best start
+    m->best = -1;
+    for (bool need_success : {true, false}) {
+      for (casadi_int i=0; i<n_start_; ++i) {
+        if (need_success && !m->success_start[i]) continue;
+        if (std::isnan(m->f_start[i])) continue;
+        if (m->best<0 || m->f_start[i] < m->f_start[m->best]) m->best = i;
+      }
+      if (m->best>=0) break;
+    }
+    m->n_terminated = n_terminated;
+
+    // Copy the solution
+    casadi_int best = m->best<0 ? 0 : m->best;
+    for (casadi_int j=0; j<n_out_; ++j) {
+      casadi_copy(get_ptr(sol[best]) + offset[j], nnz_out(j), res[j]);
+    }
+    return 0;
+  }
+
+  Dict NlpsolMultistart::get_stats(void* mem) const {
+    Dict stats = FunctionInternal::get_stats(mem);
+    auto m = static_cast<NlpsolMultistartMemory*>(mem);
+    // Statistics of the returned start
+    if (m->best>=0) {
+      for (auto&& s : m->stats_start[m->best]) stats[s.first] = s.second;
+    } else {
+      stats["success"] = false;
+    }
+    std::vector<bool> success_start(m->success_start.begin(), m->success_start.end());
+    stats["best_start"] = m->best;
+    stats["f_start"] = m->f_start;
+    stats["success_start"] = success_start;
+    stats["n_terminated"] = m->n_terminated;
+    return stats;
+  }
+
+} // namespace casadi
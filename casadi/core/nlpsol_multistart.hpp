@@ -0,0 +1,131 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_NLPSOL_MULTISTART_HPP
+#define CASADI_NLPSOL_MULTISTART_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Memory for a multi-start NLP driver */
+  struct CASADI_EXPORT NlpsolMultistartMemory : public FunctionMemory {
+    // Objective and success of each start
+    std::vector<double> f_start;
+    std::vector<char> success_start;
+    // Statistics of each start
+    std::vector<Dict> stats_start;
+    // Best start, -1 if none
+    casadi_int best = -1;
+    // Number of starts terminated early
+    casadi_int n_terminated = 0;
+  };
+
+  /** \brief Multi-start driver for an NLP solver
+
+      Solves the NLP from each column of x0, concurrently on the thread pool.
+      The solver, and hence its oracle functions, is shared between the starts,
+      each running solve checks out its own memory object.
+      The solution with the lowest objective among the successful starts is returned.
+  */
+  class CASADI_EXPORT NlpsolMultistart : public FunctionInternal {
+  public:
+    /** \brief Constructor */
+    NlpsolMultistart(const std::string& name, const Function& solver, casadi_int n_start);
+
+    /** \brief  Destructor */
+    ~NlpsolMultistart() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "NlpsolMultistart";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return solver_.n_in();}
+    size_t get_n_out() override { return solver_.n_out();}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override { return solver_.sparsity_out(i);}
+    /// @}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override { return solver_.name_in(i);}
+    std::string get_name_out(casadi_int i) override { return solver_.name_out(i);}
+    /// @}
+
+    /** \brief Get default input value */
+    double get_default_in(casadi_int ind) const override { return solver_.default_in(ind);}
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new NlpsolMultistartMemory();}
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override {
+      delete static_cast<NlpsolMultistartMemory*>(mem);
+    }
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    // Get all embedded functions, recursively
+    void find(std::map<FunctionInternal*, Function>& all_fun, casadi_int max_depth) const override;
+
+    // NLP solver
+    Function solver_;
+
+    // Number of starts
+    casadi_int n_start_;
+
+    // Early termination of starts that are dominated by the best solution
+    bool terminate_early_;
+    casadi_int terminate_min_iter_;
+    double terminate_tol_, terminate_tol_pr_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_NLPSOL_MULTISTART_HPP
@@ -0,0 +1,331 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "nlpsol_presolve.hpp"
+#include "nlpsol_impl.hpp"
+
+namespace casadi {
+
+  NlpsolPresolve::NlpsolPresolve(const std::string& name, const std::string& solver,
+                                 const Function& oracle,
+                                 const std::vector<casadi_int>& sing_x,
+                                 const std::vector<casadi_int>& sing_g,
+                                 const Function& sing_coeff, const Dict& solver_opts)
+    : FunctionInternal(name), solver_(solver), oracle_(oracle),
+      sing_x_(sing_x), sing_g_(sing_g), sing_coeff_(sing_coeff),
+      solver_opts_(solver_opts) {
+    nx_ = oracle_.nnz_in(NL_X);
+    np_ = oracle_.nnz_in(NL_P);
+    ng_ = oracle_.nnz_out(NL_G);
+    casadi_assert_dev(sing_x_.size()==sing_g_.size());
+  }
+
+  NlpsolPresolve::~NlpsolPresolve() {
+    clear_mem();
+  }
+
+  size_t NlpsolPresolve::get_n_in() {
+    return NLPSOL_NUM_IN;
+  }
+
+  size_t NlpsolPresolve::get_n_out() {
+    return NLPSOL_NUM_OUT;
+  }
+
+  Sparsity NlpsolPresolve::get_sparsity_in(casadi_int i) {
+    switch (static_cast<NlpsolInput>(i)) {
+    case NLPSOL_X0:
+    case NLPSOL_LBX:
+    case NLPSOL_UBX:
+    case NLPSOL_LAM_X0:
+      return Sparsity::dense(nx_);
+    case NLPSOL_LBG:
+    case NLPSOL_UBG:
+    case NLPSOL_LAM_G0:
+      return Sparsity::dense(ng_);
+    case NLPSOL_P:
+      return Sparsity::dense(np_);
+    case NLPSOL_NUM_IN: break;
+    }
+    return Sparsity();
+  }
+
+  Sparsity NlpsolPresolve::get_sparsity_out(casadi_int i) {
+    switch (static_cast<NlpsolOutput>(i)) {
+    case NLPSOL_F:
+      return Sparsity::scalar();
+    case NLPSOL_X:
+    case NLPSOL_LAM_X:
+      return Sparsity::dense(nx_);
+    case NLPSOL_G:
+    case NLPSOL_LAM_G:
+      return Sparsity::dense(ng_);
+    case NLPSOL_LAM_P:
+      return Sparsity::dense(np_);
+    case NLPSOL_NUM_OUT: break;
+    }
+    return Sparsity();
+  }
+
+  std::string NlpsolPresolve::get_name_in(casadi_int i) {
+    return nlpsol_in(i);
+  }
+
+  std::string NlpsolPresolve::get_name_out(casadi_int i) {
+    return nlpsol_out(i);
+  }
+
+  double NlpsolPresolve::get_default_in(casadi_int ind) const {
+    return nlpsol_default_in(ind);
+  }
+
+  void NlpsolPresolve::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Memory for the coefficient evaluation
+    if (!sing_coeff_.is_null()) alloc(sing_coeff_);
+  }
+
+  void NlpsolPresolve::serialize_body(SerializingStream &s) const {
+    casadi_error("Serialization not supported for 'presolve', "
+      "serialize the solver without presolve instead.");
+  }
+
+  template<typename X>
+  Function NlpsolPresolve::reduced_solver_gen(const std::vector<bool>& fixed,
+                                              const std::vector<casadi_int>& elim) const {
+    // Eliminated variables
+    std::vector<bool> is_elim(nx_, false);
+    for (casadi_int k : elim) is_elim[sing_x_[k]] = true;
+
+    // Indices of free and fixed variables
+    std::vector<casadi_int> free_ind, fixed_ind;
+    for (casadi_int j=0; j<nx_; ++j) {
+      if (fixed[j]) {
+        fixed_ind.push_back(j);
+      } else if (!is_elim[j]) {
+        free_ind.push_back(j);
+      }
+    }
+
+    // Symbolic primitives of the reduced problem
+    X xr = X::sym("x", free_ind.size());
+    X xf = X::sym("x_fixed", fixed_ind.size());
+    X p = X::sym("p", np_);
+
+    // Full decision vector, eliminated variables are zero
+    std::vector<X> xr_split = vertsplit(xr), xf_split = vertsplit(xf);
+    std::vector<X> x_full(nx_, X(0.));
+    for (casadi_int k=0; k<free_ind.size(); ++k) x_full[free_ind[k]] = xr_split[k];
+    for (casadi_int k=0; k<fixed_ind.size(); ++k) x_full[fixed_ind[k]] = xf_split[k];
+    std::vector<X> res = oracle_(std::vector<X>{vertcat(x_full), p});
+
+    // Reduced problem, fixed variables are appended to the parameters
+    std::map<std::string, X> nlp;
+    nlp["x"] = xr;
+    nlp["p"] = vertcat(p, xf);
+    nlp["f"] = res.at(NL_F);
+    nlp["g"] = res.at(NL_G);
+
+    // Options that depend on the problem dimensions
+    Dict opts = solver_opts_;
+    auto it = opts.find("discrete");
+    if (it!=opts.end()) {
+      std::vector<bool> discrete = it->second;
+      std::vector<bool> discrete_r;
+      for (casadi_int j : free_ind) discrete_r.push_back(discrete.at(j));
+      it->second = discrete_r;
+    }
+    it = opts.find("equality");
+    if (it!=opts.end()) {
+      std::vector<bool> equality = it->second;
+      for (casadi_int k : elim) equality.at(sing_g_[k]) = false;
+      it->second = equality;
+    }
+
+    // Multipliers of fixed variables are obtained from lam_p
+    if (!fixed_ind.empty() && !get_from_dict(opts, "no_nlp_grad", false)) {
+      opts["calc_lam_p"] = true;
+    }
+    return nlpsol(name_ + "_presolved", solver_, nlp, opts);
+  }
+
+  Function NlpsolPresolve::reduced_solver(const std::vector<bool>& fixed,
+                                          const std::vector<casadi_int>& elim) const {
+    if (oracle_.is_a("SXFunction")) {
+      return reduced_solver_gen<SX>(fixed, elim);
+    } else {
+      return reduced_solver_gen<MX>(fixed, elim);
+    }
+  }
+
+  int NlpsolPresolve::eval(const double** arg, double** res,
+                           casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<NlpsolPresolveMemory*>(mem);
+
+    // Input value, or default if missing
+    auto in = [&](casadi_int i, casadi_int k) {
+      return arg[i] ? arg[i][k] : get_default_in(i);
+    };
+
+    // Detect fixed variables
+    std::vector<bool> fixed(nx_), is_elim(nx_, false);
+    for (casadi_int j=0; j<nx_; ++j) {
+      double lb = in(NLPSOL_LBX, j), ub = in(NLPSOL_UBX, j);
+      fixed[j] = lb==ub && std::isfinite(lb);
+    }
+
+    // Coefficients of the singleton columns
+    std::vector<double> coeff(sing_x_.size());
+    if (!sing_coeff_.is_null()) {
+      const double** arg1 = arg + n_in_;
+      double** res1 = res + n_out_;
+      arg1[0] = arg[NLPSOL_P];
+      res1[0] = get_ptr(coeff);
+      if (sing_coeff_(arg1, res1, iw, w)) return 1;
+    }
+
+    // Singleton columns in equality constraints, at most one per constraint
+    std::vector<casadi_int> elim;
+    std::vector<bool> row_used(ng_, false);
+    for (casadi_int k=0; k<sing_x_.size(); ++k) {
+      casadi_int j = sing_x_[k], i = sing_g_[k];
+      if (fixed[j] || row_used[i] || coeff[k]==0) continue;
+      double lb = in(NLPSOL_LBG, i), ub = in(NLPSOL_UBG, i);
+      if (lb!=ub || !std::isfinite(lb)) continue;
+      elim.push_back(k);
+      row_used[i] = true;
+      is_elim[j] = true;
+    }
+
+    // Rebuild the reduced solver if the pattern changed
+    if (m->solver.is_null() || fixed!=m->fixed || elim!=m->elim) {
+      if (verbose_) casadi_message("Rebuilding reduced solver");
+      m->solver = reduced_solver(fixed, elim);
+      m->fixed = fixed;
+      m->elim = elim;
+    }
+
+    // Indices of free and fixed variables
+    std::vector<casadi_int> free_ind, fixed_ind;
+    for (casadi_int j=0; j<nx_; ++j) {
+      if (fixed[j]) {
+        fixed_ind.push_back(j);
+      } else if (!is_elim[j]) {
+        free_ind.push_back(j);
+      }
+    }
+    casadi_int nr = free_ind.size(), nf = fixed_ind.size();
+
+    // Inputs of the reduced problem
+    std::vector<double> x0(nr), lbx(nr), ubx(nr), lam_x0(nr), p(np_ + nf);
+    std::vector<double> lbg(ng_), ubg(ng_), lam_g0(ng_);
+    for (casadi_int k=0; k<nr; ++k) {
+      casadi_int j = free_ind[k];
+      x0[k] = in(NLPSOL_X0, j);
+      lbx[k] = in(NLPSOL_LBX, j);
+      ubx[k] = in(NLPSOL_UBX, j);
+      lam_x0[k] = in(NLPSOL_LAM_X0, j);
+    }
+    for (casadi_int i=0; i<np_; ++i) p[i] = in(NLPSOL_P, i);
+    for (casadi_int k=0; k<nf; ++k) p[np_ + k] = in(NLPSOL_LBX, fixed_ind[k]);
+    for (casadi_int i=0; i<ng_; ++i) {
+      lbg[i] = in(NLPSOL_LBG, i);
+      ubg[i] = in(NLPSOL_UBG, i);
+      lam_g0[i] = in(NLPSOL_LAM_G0, i);
+    }
+
+    // h + a*x_j == c with x_j in [l, u] becomes h in c - a*[l, u]
+    for (casadi_int k : elim) {
+      casadi_int j = sing_x_[k], i = sing_g_[k];
+      double a = coeff[k], c = lbg[i];
+      double l = in(NLPSOL_LBX, j), u = in(NLPSOL_UBX, j);
+      lbg[i] = a>0 ? c - a*u : c - a*l;
+      ubg[i] = a>0 ? c - a*l : c - a*u;
+    }
+
+    // Outputs of the reduced problem
+    std::vector<double> x(nr), g(ng_), lam_x(nr), lam_g(ng_), lam_p(np_ + nf);
+    double f = 0;
+
+    // Solve the reduced problem
+    std::vector<const double*> arg_r(NLPSOL_NUM_IN);
+    arg_r[NLPSOL_X0] = get_ptr(x0);
+    arg_r[NLPSOL_P] = get_ptr(p);
+    arg_r[NLPSOL_LBX] = get_ptr(lbx);
+    arg_r[NLPSOL_UBX] = get_ptr(ubx);
+    arg_r[NLPSOL_LBG] = get_ptr(lbg);
+    arg_r[NLPSOL_UBG] = get_ptr(ubg);
+    arg_r[NLPSOL_LAM_X0] = get_ptr(lam_x0);
+    arg_r[NLPSOL_LAM_G0] = get_ptr(lam_g0);
+    std::vector<double*> res_r(NLPSOL_NUM_OUT);
+    res_r[NLPSOL_X] = get_ptr(x);
+    res_r[NLPSOL_F] = &f;
+    res_r[NLPSOL_G] = get_ptr(g);
+    res_r[NLPSOL_LAM_X] = get_ptr(lam_x);
+    res_r[NLPSOL_LAM_G] = get_ptr(lam_g);
+    res_r[NLPSOL_LAM_P] = get_ptr(lam_p);
+    m->solver(arg_r, res_r);
+
+    // Map the solution back to the full problem
+    std::vector<double> x_full(nx_), g_full = g, lam_x_full(nx_);
+    for (casadi_int k=0; k<nr; ++k) {
+      x_full[free_ind[k]] = x[k];
+      lam_x_full[free_ind[k]] = lam_x[k];
+    }
+    for (casadi_int k=0; k<nf; ++k) {
+      x_full[fixed_ind[k]] = p[np_ + k];
+      lam_x_full[fixed_ind[k]] = lam_p[np_ + k];
+    }
+    for (casadi_int k : elim) {
+      casadi_int j = sing_x_[k], i = sing_g_[k];
+      double a = coeff[k], c = in(NLPSOL_LBG, i);
+      x_full[j] = (c - g[i])/a;
+      g_full[i] = g[i] + a*x_full[j];
+      lam_x_full[j] = -a*lam_g[i];
+    }
+    casadi_copy(get_ptr(x_full), nx_, res[NLPSOL_X]);
+    if (res[NLPSOL_F]) *res[NLPSOL_F] = f;
+    casadi_copy(get_ptr(g_full), ng_, res[NLPSOL_G]);
+    casadi_copy(get_ptr(lam_x_full), nx_, res[NLPSOL_LAM_X]);
+    casadi_copy(get_ptr(lam_g), ng_, res[NLPSOL_LAM_G]);
+    casadi_copy(get_ptr(lam_p), np_, res[NLPSOL_LAM_P]);
+
+    // Statistics
+    m->stats = m->solver.stats();
+    m->stats["n_fixed"] = nf;
+    m->stats["n_eliminated"] = static_cast<casadi_int>(elim.size());
+    return 0;
+  }
+
+  Dict NlpsolPresolve::get_stats(void* mem) const {
+    Dict stats = FunctionInternal::get_stats(mem);
+    auto m = static_cast<NlpsolPresolveMemory*>(mem);
+    for (auto&& s : m->stats) stats[s.first] = s.second;
+    return stats;
+  }
+
+} // namespace casadi
@@ -0,0 +1,142 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_NLPSOL_PRESOLVE_HPP
+#define CASADI_NLPSOL_PRESOLVE_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Memory for a presolving NLP solver wrapper */
+  struct CASADI_EXPORT NlpsolPresolveMemory : public FunctionMemory {
+    // Solver for the reduced problem, for the current pattern
+    Function solver;
+
+    // Pattern that the reduced solver was built for
+    std::vector<bool> fixed;
+    std::vector<casadi_int> elim;
+
+    // Statistics of the last call
+    Dict stats;
+  };
+
+  /** \brief NLP solver wrapper that removes fixed variables and singleton columns
+
+      Variables with lbx==ubx are turned into parameters and variables that only
+      appear linearly in a single equality constraint, and not in the objective,
+      are eliminated by turning the constraint into a range constraint.
+      The reduced problem is passed to the actual solver, which is rebuilt
+      whenever the pattern of fixed and eliminated variables changes.
+      Solution and multipliers are mapped back to the full problem.
+  */
+  class CASADI_EXPORT NlpsolPresolve : public FunctionInternal {
+  public:
+    /** \brief Constructor */
+    NlpsolPresolve(const std::string& name, const std::string& solver,
+                   const Function& oracle,
+                   const std::vector<casadi_int>& sing_x,
+                   const std::vector<casadi_int>& sing_g,
+                   const Function& sing_coeff, const Dict& solver_opts);
+
+    /** \brief  Destructor */
+    ~NlpsolPresolve() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "NlpsolPresolve";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override;
+    size_t get_n_out() override;
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override;
+    /// @}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override;
+    std::string get_name_out(casadi_int i) override;
+    /// @}
+
+    /** \brief Get default input value */
+    double get_default_in(casadi_int ind) const override;
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new NlpsolPresolveMemory();}
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<NlpsolPresolveMemory*>(mem);}
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Build a solver for the reduced problem */
+    Function reduced_solver(const std::vector<bool>& fixed,
+                            const std::vector<casadi_int>& elim) const;
+
+    /** \brief Build a solver for the reduced problem, symbolic type X */
+    template<typename X>
+    Function reduced_solver_gen(const std::vector<bool>& fixed,
+                                const std::vector<casadi_int>& elim) const;
+
+    // Name of the solver plugin
+    std::string solver_;
+
+    // NLP oracle, inputs (x, p) and outputs (f, g)
+    Function oracle_;
+
+    // Candidates for elimination: variable and its only constraint
+    std::vector<casadi_int> sing_x_, sing_g_;
+
+    // Coefficients of the candidates as a function of p
+    Function sing_coeff_;
+
+    // Options passed on to the solver
+    Dict solver_opts_;
+
+    // Problem dimensions
+    casadi_int nx_, ng_, np_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_NLPSOL_PRESOLVE_HPP
@@ -99,6 +99,15 @@ void Opti::subject_to(const std::vector<MX>& g) {
   for (const auto& gs : g) subject_to(gs);
 }
 
+void Opti::subject_to_dynamics(const Function& F, const MX& X, const std::vector<MX>& args,
+    const std::string& parallelization) {
+  try {
+    (*this)->subject_to_dynamics(F, X, args, parallelization);
+  } catch(std::exception& e) {
+    THROW_ERROR("subject_to_dynamics", e.what());
+  }
+}
+
 void Opti::subject_to() {
   try {
     (*this)->subject_to();
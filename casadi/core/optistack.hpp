@@ -165,6 +165,27 @@ public:
   /// Clear constraints
   void subject_to();
 
+  /** \brief Add the dynamics constraints of an optimal control problem
+  *
+  * For a state trajectory X with N+1 columns, adds X(:,k+1) == F(X(:,k), args(:,k)..)
+  * for all k=0..N-1 as a single constraint. F is evaluated once, mapped over the
+  * N intervals, instead of once per interval. The constraint stays one block
+  * in the baked problem, and the mapped evaluation can run in parallel.
+  *
+  * \param[in] F Function with the state as its first input, the next state as its first output
+  * \param[in] X State trajectory, one column per stage
+  * \param[in] args Remaining inputs of F, either one column per interval or shared
+  * \param[in] parallelization Passed on to Function::map
+  *
+  * \verbatim
+  * Python
+  * opti.subject_to_dynamics(F, X, [U, T/N])
+  * \endverbatim
+  */
+  void subject_to_dynamics(const Function& F, const MX& X,
+    const std::vector<MX>& args=std::vector<MX>(),
+    const std::string& parallelization="serial");
+
   /** \brief Set a solver
   *
   * \param[in] solver any of the nlpsol plugins can be used here
@@ -320,7 +341,11 @@ public:
    * \param[in] args List of parameters and decision/dual variables
    *                (which can be given an initial guess) with the resulting Function
    * \param[in] res List of expressions that will get evaluated at the optimal solution
-   * \param[in] opts Standard CasADi Funcion options
+   * \param[in] opts Standard CasADi Funcion options, and
+   *                 warm_start (bool): keep the primal and dual solution of each call
+   *                 as the initial guess of the next call on the same memory object,
+   *                 starting from the current initial guess. The arguments must then
+   *                 all be parameters, e.g. for receding horizon control.
 
       \identifier{1j} */
   Function to_function(const std::string& name,
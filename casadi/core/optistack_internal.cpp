@@ -27,6 +27,7 @@
 #include "conic.hpp"
 #include "function_internal.hpp"
 #include "global_options.hpp"
+#include "warm_start_function.hpp"
 
 namespace casadi {
 
@@ -908,6 +909,26 @@ void OptiNode::subject_to(const MX& g) {
   register_dual(meta_con(g));
 }
 
+void OptiNode::subject_to_dynamics(const Function& F, const MX& X,
+    const std::vector<MX>& args, const std::string& parallelization) {
+  casadi_int N = X.size2()-1;
+  casadi_assert(N>=1, "The state trajectory needs at least two columns, got " + X.dim() + ".");
+  casadi_assert(F.n_in()==args.size()+1,
+    "Function '" + F.name() + "' has " + str(F.n_in()) + " inputs, expected " +
+    str(args.size()+1) + ": the state followed by the remaining arguments.");
+  casadi_assert(F.n_out()>=1, "Function '" + F.name() + "' has no outputs.");
+  casadi_assert(F.size_in(0)==std::make_pair(X.size1(), casadi_int(1)),
+    "The first input of '" + F.name() + "' must be a column of the state dimension "
+    + str(X.size1()) + ", got " + F.sparsity_in(0).dim() + ".");
+
+  // Evaluate all intervals in a single call
+  std::vector<MX> arg = {X(Slice(), Slice(0, N))};
+  arg.insert(arg.end(), args.begin(), args.end());
+  MX X_next = F.map(N, parallelization)(arg).at(0);
+
+  subject_to(X(Slice(), Slice(1, N+1))==X_next);
+}
+
 void OptiNode::subject_to() {
   mark_problem_dirty();
   g_.clear();
@@ -980,10 +1001,35 @@ OptiSol OptiNode::solve(bool accept_limit) {
       "You must call 'solver' on the Opti stack to select a solver. "
       "Suggestion: opti.solver('ipopt')");
 
-    if (problem_type_=="conic") {
-      solver_ = qpsol("solver", solver_name_, nlp_, opts);
-    } else {
-      solver_ = nlpsol("solver", solver_name_, nlp_, opts);
+    // Look for a solver of the same problem, e.g. when toggling constraints
+    std::vector<MX> expr = g_;
+    expr.push_back(f_);
+    std::string key = solver_name_ + ";" + problem_type_ + ";" + str(solver_options_);
+    bool cached = false;
+    if (!user_callback_) {
+      for (const CachedSolver& c : solver_cache_) {
+        if (c.key!=key || c.expr.size()!=expr.size()) continue;
+        bool same = true;
+        for (casadi_int i=0; i<expr.size() && same; ++i) same = c.expr[i].get()==expr[i].get();
+        if (same) {
+          solver_ = c.solver;
+          cached = true;
+          break;
+        }
+      }
+    }
+
+    if (!cached) {
+      if (problem_type_=="conic") {
+        solver_ = qpsol("solver", solver_name_, nlp_, opts);
+      } else {
+        solver_ = nlpsol("solver", solver_name_, nlp_, opts);
+      }
+      // Solvers with a callback are tied to this instance
+      if (!user_callback_) {
+        solver_cache_.push_back({expr, key, solver_});
+        if (solver_cache_.size()>solver_cache_size_) solver_cache_.pop_front();
+      }
     }
     mark_solver_dirty(false);
   }
@@ -1272,6 +1318,15 @@ Function OptiNode::to_function(const std::string& name,
     const Dict& opts) {
   if (problem_dirty()) return baked_copy().to_function(name, args, res, name_in, name_out, opts);
 
+  // Feed the solution back as the initial guess of the next call
+  bool warm_start = false;
+  Dict fopts = opts;
+  auto it = fopts.find("warm_start");
+  if (it!=fopts.end()) {
+    warm_start = it->second;
+    fopts.erase(it);
+  }
+
   Function solver;
   if (problem_type_=="conic") {
     solver = qpsol("solver", solver_name_, nlp_, solver_options_);
@@ -1292,6 +1347,9 @@ Function OptiNode::to_function(const std::string& name,
     for (const auto& prim : a.primitives()) {
       if (!symbol_active_[meta(prim).count]) continue;
       casadi_int i = meta(prim).active_i;
+      casadi_assert(!warm_start || meta(prim).type==OPTI_PAR,
+        "With 'warm_start', the initial guess is taken from the previous call: "
+        "arguments must be parameters.");
       if (meta(prim).type==OPTI_VAR) {
         x0.at(i) = prim;
       } else if (meta(prim).type==OPTI_PAR) {
@@ -1313,6 +1371,18 @@ Function OptiNode::to_function(const std::string& name,
   arg["lbg"] = r["lbg"];
   arg["ubg"] = r["ubg"];
 
+  // Primal and dual initial guess as additional inputs
+  std::vector<std::vector<double>> ws0;
+  std::vector<MX> ws_in;
+  if (warm_start) {
+    for (const std::string& s : {"x0", "lam_x0", "lam_g0"}) {
+      ws_in.push_back(MX::sym(s, solver.sparsity_in(s)));
+      ws0.push_back(s=="lam_x0" ? std::vector<double>(solver.nnz_in(s), 0) :
+        densify(evalf(arg[s])).nonzeros());
+      arg[s] = ws_in.back();
+    }
+  }
+
   r = solver(arg);
 
   std::vector<MX> helper_in = {veccat(active_symvar(OPTI_VAR)),
@@ -1322,7 +1392,17 @@ Function OptiNode::to_function(const std::string& name,
 
   std::vector<MX> arg_in = helper(std::vector<MX>{r.at("x"), arg["p"], r.at("lam_g")});
 
-  return Function(name, args, arg_in, name_in, name_out, opts);
+  if (!warm_start) return Function(name, args, arg_in, name_in, name_out, opts);
+
+  // Solution as additional outputs
+  std::vector<MX> f_in = args, f_out = arg_in;
+  f_in.insert(f_in.end(), ws_in.begin(), ws_in.end());
+  for (const std::string& s : {"x", "lam_x", "lam_g"}) f_out.push_back(r.at(s));
+  std::vector<std::string> f_name_in = name_in, f_name_out = name_out;
+  if (!name_in.empty()) f_name_in.insert(f_name_in.end(), {"x0", "lam_x0", "lam_g0"});
+  if (!name_out.empty()) f_name_out.insert(f_name_out.end(), {"x", "lam_x", "lam_g"});
+  Function f(name + "_cold", f_in, f_out, f_name_in, f_name_out, fopts);
+  return Function::create(new WarmStartFunction(name, f, ws0), Dict());
 
 }
 
@@ -27,6 +27,7 @@
 
 #include "optistack.hpp"
 #include "shared_object_internal.hpp"
+#include <deque>
 
 namespace casadi {
 
@@ -74,6 +75,9 @@ public:
 
   /// brief Add constraints
   void subject_to(const MX& g);
+  /// Add the dynamics of all intervals as a single mapped constraint
+  void subject_to_dynamics(const Function& F, const MX& X, const std::vector<MX>& args,
+    const std::string& parallelization);
   /// Clear constraints
   void subject_to();
 
@@ -360,6 +364,19 @@ private:
   /// Solver
   Function solver_;
 
+  /// Previously created solvers, reused when the same problem reappears
+  struct CachedSolver {
+    // Objective and constraints, kept alive so that node identity is meaningful
+    std::vector<MX> expr;
+    // Solver plugin, problem type and options
+    std::string key;
+    Function solver;
+  };
+  std::deque<CachedSolver> solver_cache_;
+
+  /// Maximum number of cached solvers
+  static const casadi_int solver_cache_size_ = 8;
+
   /// Result of solver
   DMDict res_;
   DMDict arg_;
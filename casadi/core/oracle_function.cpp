@@ -26,6 +26,8 @@
 #include "oracle_function.hpp"
 #include "external.hpp"
 #include "serializing_stream.hpp"
+#include "importer_internal.hpp"
+#include "thread_pool.hpp"
 
 #include <iomanip>
 #include <iostream>
@@ -50,6 +52,16 @@ const Options OracleFunction::options_
     {"show_eval_warnings",
       {OT_BOOL,
       "Show warnings generated from function evaluations [true]"}},
+    {"cache_evaluations",
+      {OT_BOOL,
+      "Reuse the outputs of a user problem function when it is called again "
+      "with unchanged inputs [false]"}},
+    {"jit_parallel",
+      {OT_BOOL,
+      "Generate a separate translation unit for every just-in-time compiled "
+      "function and compile them concurrently, using up to "
+      "GlobalOptions::getMaxNumThreads() compiler instances [false]. "
+      "Requires jit_serialize 'source'."}},
     {"common_options",
       {OT_DICT,
       "Options for auto-generated functions"}},
@@ -71,6 +83,10 @@ void OracleFunction::init(const Dict& opts) {
 
   max_num_threads_ = 1;
 
+  cache_evaluations_ = false;
+
+  jit_parallel_ = false;
+
   // Read options
   for (auto&& op : opts) {
     if (op.first=="expand") {
@@ -89,6 +105,10 @@ void OracleFunction::init(const Dict& opts) {
       monitor_ = op.second;
     } else if (op.first=="show_eval_warnings") {
       show_eval_warnings_ = op.second;
+    } else if (op.first=="cache_evaluations") {
+      cache_evaluations_ = op.second;
+    } else if (op.first=="jit_parallel") {
+      jit_parallel_ = op.second;
     }
   }
 
@@ -149,6 +169,8 @@ void OracleFunction::join_results(OracleMemory* m) const {
     auto* ml = m->thread_local_mem[i];
     for (auto&& s : ml->fstats) {
       m->fstats.at(s.first).join(s.second);
+      // Thread local statistics are per call
+      s.second.reset();
     }
   }
 }
@@ -167,6 +189,25 @@ Function OracleFunction::create_function(const std::string& fname,
       const std::vector<std::string>& s_in,
       const std::vector<std::string>& s_out,
       const Dict& opts) {
+  return create_function_expr(fname, e_in, e_out, s_in, s_out, opts);
+}
+
+Function OracleFunction::create_function(const std::string& fname,
+      const std::vector<SX>& e_in,
+      const std::vector<SX>& e_out,
+      const std::vector<std::string>& s_in,
+      const std::vector<std::string>& s_out,
+      const Dict& opts) {
+  return create_function_expr(fname, e_in, e_out, s_in, s_out, opts);
+}
+
+template<typename XType>
+Function OracleFunction::create_function_expr(const std::string& fname,
+      const std::vector<XType>& e_in,
+      const std::vector<XType>& e_out,
+      const std::vector<std::string>& s_in,
+      const std::vector<std::string>& s_out,
+      const Dict& opts) {
 
   // Print progress
   if (verbose_) {
@@ -252,14 +293,243 @@ Function OracleFunction::create_function(const Function& oracle, const std::stri
   return ret;
 }
 
-Function OracleFunction::create_forward(const std::string& fname, casadi_int nfwd) {
+Function OracleFunction::create_forward(const std::string& fname, casadi_int nfwd,
+    const std::string& parallelization, casadi_int max_num_threads) {
   // Create derivative
-  Function ret = get_function(fname).forward(nfwd);
+  Function ret;
   std::string fwd_name = forward_name(fname, nfwd);  // may be different from ret.name()
+  if (parallelization == "serial" || nfwd == 1) {
+    ret = get_function(fname).forward(nfwd);
+  } else {
+    // Map a single-direction derivative over the directions
+    const Function& f = get_function(fname);
+    Function f1 = f.forward(1);
+    Function fm = f1.map(nfwd, parallelization, max_num_threads);
+    std::vector<MX> arg = f1.mx_in(), f_arg = arg;
+    for (casadi_int i = 0; i < f1.n_in(); ++i) {
+      if (i < f.n_in() + f.n_out()) {
+        // Nondifferentiated inputs and outputs are shared by all directions
+        f_arg[i] = repmat(arg[i], 1, nfwd);
+      } else {
+        arg[i] = MX::sym(f1.name_in(i), repmat(f1.sparsity_in(i), 1, nfwd));
+        f_arg[i] = arg[i];
+      }
+    }
+    ret = Function(fwd_name, arg, fm(f_arg), f1.name_in(), f1.name_out());
+  }
   if (!has_function(fwd_name)) set_function(ret, fwd_name, true);
   return ret;
 }
 
+Function OracleFunction::create_hess_vec(const std::string& fname,
+    const std::vector<std::string>& s_in, const std::string& f, const std::string& x,
+    const Function::AuxOut& aux, const Dict& opts) {
+  // Print progress
+  if (verbose_) {
+    casadi_message(name_ + "::create_hess_vec " + fname + ":" + str(s_in) + "->" + f);
+  }
+
+  // Check if function is already in cache
+  Function ret;
+  if (!incache(fname, ret)) {
+    // Index of the differentiated input
+    auto it_x = std::find(s_in.begin(), s_in.end(), x);
+    casadi_assert(it_x!=s_in.end(), "No input " + x + " in " + str(s_in));
+    casadi_int ix = it_x - s_in.begin();
+
+    // Retrieve specific set of options if available
+    Dict specific_options;
+    auto it = specific_options_.find(fname);
+    if (it!=specific_options_.end()) specific_options = it->second;
+
+    // Combine specific and common options
+    Dict opt = combine(specific_options, common_options_);
+    opt = combine(opts, opt);
+
+    // Gradient, reverse mode
+    Function gfcn = oracle_.factory(fname + "_grad", s_in, {"grad:" + f + ":" + x}, aux, opt);
+
+    // Directional derivative of the gradient, forward mode
+    Function dfcn = gfcn.forward(1);
+    std::vector<MX> arg = gfcn.mx_in();
+    MX v = MX::sym("v", gfcn.sparsity_in(ix));
+    std::vector<MX> darg = arg;
+    darg.push_back(MX(gfcn.size_out(0)));
+    for (casadi_int i=0; i<gfcn.n_in(); ++i) darg.push_back(i==ix ? v : MX(gfcn.size_in(i)));
+    arg.push_back(v);
+    std::vector<std::string> name_in = gfcn.name_in();
+    name_in.push_back("v");
+    ret = Function(fname, arg, dfcn(darg), name_in, {"hess_vec"});
+
+    // Make sure that it's sound
+    if (ret.has_free()) {
+      casadi_error("Cannot create '" + fname + "' since " + str(ret.get_free()) + " are free.");
+    }
+
+    // Add to cache
+    tocache(ret);
+  }
+
+  // Save and return
+  set_function(ret, fname, true);
+  return ret;
+}
+
+template<typename XType>
+static Function split_input(const Function& f, casadi_int ix,
+    const std::vector<casadi_int>& blocks) {
+  std::vector<XType> arg, f_arg;
+  std::vector<std::string> name_in;
+  for (casadi_int i=0; i<f.n_in(); ++i) {
+    if (i==ix) {
+      std::vector<XType> xb;
+      for (casadi_int b=0; b+1<blocks.size(); ++b) {
+        name_in.push_back(f.name_in(i) + "_" + str(b));
+        xb.push_back(XType::sym(name_in.back(), blocks[b+1]-blocks[b]));
+      }
+      arg.insert(arg.end(), xb.begin(), xb.end());
+      f_arg.push_back(vertcat(xb));
+    } else {
+      arg.push_back(XType::sym(f.name_in(i), f.sparsity_in(i)));
+      name_in.push_back(f.name_in(i));
+      f_arg.push_back(arg.back());
+    }
+  }
+  return Function(f.name() + "_split", arg, f(f_arg), name_in, f.name_out());
+}
+
+Function OracleFunction::create_block_function(const std::string& fname,
+    const std::vector<std::string>& s_in,
+    const std::vector<std::string>& s_out,
+    const std::string& x, const std::vector<casadi_int>& blocks,
+    const Function::AuxOut& aux, const Dict& opts) {
+  // Print progress
+  if (verbose_) {
+    casadi_message(name_ + "::create_block_function " + fname + ":" + str(s_in) + "->"
+      + str(s_out) + ", " + str(blocks.size()-1) + " blocks");
+  }
+
+  // Check if function is already in cache
+  Function ret;
+  if (!incache(fname, ret)) {
+    casadi_assert(blocks.size()>=2 && blocks.front()==0
+      && blocks.back()==oracle_.nnz_in(oracle_.index_in(x)) && is_monotone(blocks),
+      "Invalid blocks " + str(blocks) + " for " + x);
+    casadi_int nb = blocks.size()-1;
+
+    // Oracle with the blocks of x as separate inputs
+    Function split = oracle_.is_a("SXFunction")
+      ? split_input<SX>(oracle_, oracle_.index_in(x), blocks)
+      : split_input<MX>(oracle_, oracle_.index_in(x), blocks);
+
+    // Inputs of the block functions
+    std::vector<std::string> s_in_b;
+    for (auto&& s : s_in) {
+      if (s==x) {
+        for (casadi_int b=0; b<nb; ++b) s_in_b.push_back(x + "_" + str(b));
+      } else {
+        s_in_b.push_back(s);
+      }
+    }
+
+    // Classify outputs: 'v' gradient, 'h' Jacobian, 'd' Hessian, 'n' not w.r.t. x
+    std::vector<char> kind;
+    for (auto&& s : s_out) {
+      std::vector<std::string> tok;
+      std::stringstream ss(s);
+      std::string t;
+      while (std::getline(ss, t, ':')) tok.push_back(t);
+      auto has = [&](const std::string& w) {
+        return std::find(tok.begin(), tok.end(), w)!=tok.end();
+      };
+      if (tok.size()<2 || tok.back()!=x) {
+        kind.push_back('n');
+      } else if (has("hess")) {
+        casadi_assert(tok[tok.size()-2]==x, "Mixed Hessian " + s + " not supported");
+        kind.push_back('d');
+      } else if (has("jac")) {
+        kind.push_back('h');
+      } else if (has("grad")) {
+        kind.push_back('v');
+      } else {
+        casadi_error("Cannot evaluate " + s + " block by block");
+      }
+    }
+
+    // Retrieve specific set of options if available
+    Dict specific_options;
+    auto it = specific_options_.find(fname);
+    if (it!=specific_options_.end()) specific_options = it->second;
+
+    // Combine specific and common options
+    Dict opt = combine(specific_options, common_options_);
+    opt = combine(opts, opt);
+
+    // Create the block functions
+    std::vector<Function> fb(nb);
+    std::vector<std::vector<casadi_int>> ind(nb);
+    for (casadi_int b=0; b<nb; ++b) {
+      std::string xb = x + "_" + str(b);
+      std::vector<std::string> s_out_b;
+      for (casadi_int i=0; i<s_out.size(); ++i) {
+        if (kind[i]=='n') {
+          if (b>0) continue;
+          s_out_b.push_back(s_out[i]);
+        } else {
+          std::string s = s_out[i].substr(0, s_out[i].size() - x.size()) + xb;
+          if (kind[i]=='d') {
+            s = s.substr(0, s.size() - xb.size() - 1 - x.size()) + xb + ":" + xb;
+          }
+          s_out_b.push_back(s);
+        }
+        ind[b].push_back(i);
+      }
+      fb[b] = split.factory(fname + "_" + str(b), s_in_b, s_out_b, aux, opt);
+    }
+
+    // Assemble the blocks
+    std::vector<MX> arg, arg_b;
+    for (casadi_int i=0, j=0; i<s_in.size(); ++i) {
+      if (s_in[i]==x) {
+        arg.push_back(MX::sym(x, blocks.back()));
+        std::vector<MX> xb = vertsplit(arg.back(), blocks);
+        arg_b.insert(arg_b.end(), xb.begin(), xb.end());
+        j += nb;
+      } else {
+        arg.push_back(MX::sym(s_in[i], fb[0].sparsity_in(j++)));
+        arg_b.push_back(arg.back());
+      }
+    }
+    std::vector<std::vector<MX>> res_b(s_out.size());
+    for (casadi_int b=0; b<nb; ++b) {
+      std::vector<MX> r = fb[b](arg_b);
+      for (casadi_int k=0; k<r.size(); ++k) res_b[ind[b][k]].push_back(r[k]);
+    }
+    std::vector<MX> res;
+    for (casadi_int i=0; i<s_out.size(); ++i) {
+      switch (kind[i]) {
+        case 'v': res.push_back(vertcat(res_b[i])); break;
+        case 'h': res.push_back(horzcat(res_b[i])); break;
+        case 'd': res.push_back(diagcat(res_b[i])); break;
+        default: res.push_back(res_b[i].at(0));
+      }
+    }
+    ret = Function(fname, arg, res, s_in, s_out, {{"parallel", true}});
+
+    // Make sure that it's sound
+    if (ret.has_free()) {
+      casadi_error("Cannot create '" + fname + "' since " + str(ret.get_free()) + " are free.");
+    }
+
+    // Add to cache
+    tocache(ret);
+  }
+
+  // Save and return
+  set_function(ret, fname, true);
+  return ret;
+}
+
 void OracleFunction::
 set_function(const Function& fcn, const std::string& fname, bool jit) {
   casadi_assert(!has_function(fname), "Duplicate function " + fname);
@@ -268,10 +538,87 @@ set_function(const Function& fcn, const std::string& fname, bool jit) {
   r.jit = jit;
 }
 
+void OracleFunction::set_fused(const std::string& fname, const std::string& fused,
+    const std::vector<casadi_int>& ind) {
+  const Function& f = get_function(fname);
+  const Function& F = get_function(fused);
+  casadi_assert(f.n_in()==F.n_in(), "Inputs of " + fname + " and " + fused + " differ");
+  for (casadi_int i=0; i<f.n_in(); ++i) {
+    casadi_assert(f.sparsity_in(i)==F.sparsity_in(i),
+      "Inputs of " + fname + " and " + fused + " differ");
+  }
+  casadi_assert(ind.size()==f.n_out(), "Wrong number of outputs for " + fname);
+  for (casadi_int i=0; i<f.n_out(); ++i) {
+    casadi_assert(ind[i]>=0 && ind[i]<F.n_out() && f.sparsity_out(i)==F.sparsity_out(ind[i]),
+      "Output " + str(i) + " of " + fname + " does not match " + fused);
+  }
+  fused_[fname] = {fused, ind};
+}
+
 int OracleFunction::
 calc_function(OracleMemory* m, const std::string& fcn,
               const double* const* arg, int thread_id) const {
   auto ml = m->thread_local_mem.at(thread_id);
+
+  // Get function
+  const Function& f = get_function(fcn);
+
+  // Number of inputs and outputs
+  casadi_int n_in = f.n_in(), n_out = f.n_out();
+
+  // Input buffers
+  if (arg) {
+    std::fill_n(ml->arg, n_in, nullptr);
+    for (casadi_int i=0; i<n_in; ++i) ml->arg[i] = *arg++;
+  }
+
+  // Evaluate directly, unless cached or fused
+  auto fit = fused_.find(fcn);
+  if (fit==fused_.end() && !cache_evaluations_) return eval_function(ml, fcn, ml->res);
+
+  // Function providing the outputs
+  const std::string& src = fit==fused_.end() ? fcn : fit->second.fused;
+  LocalOracleMemory::EvalCache& c = ml->cache.at(src);
+
+  // Same inputs as in the cached evaluation?
+  bool hit = c.valid;
+  double* a = get_ptr(c.arg);
+  for (casadi_int i=0; i<n_in && hit; ++i) {
+    casadi_int nnz = f.nnz_in(i);
+    if (ml->arg[i]) {
+      hit = std::equal(ml->arg[i], ml->arg[i] + nnz, a);
+    } else {
+      hit = std::all_of(a, a + nnz, [](double v) { return v==0;});
+    }
+    a += nnz;
+  }
+
+  if (hit) {
+    if (monitored(fcn)) casadi_message("Reusing \"" + src + "\" for \"" + fcn + "\"");
+  } else {
+    // Evaluate into the cache
+    c.valid = false;
+    int flag = eval_function(ml, src, get_ptr(c.res_ptr));
+    if (flag) return flag;
+    a = get_ptr(c.arg);
+    for (casadi_int i=0; i<n_in; ++i) {
+      casadi_copy(ml->arg[i], f.nnz_in(i), a);
+      a += f.nnz_in(i);
+    }
+    c.valid = true;
+  }
+
+  // Copy requested outputs
+  for (casadi_int i=0; i<n_out; ++i) {
+    if (!ml->res[i]) continue;
+    casadi_int k = fit==fused_.end() ? i : fit->second.ind[i];
+    casadi_copy(c.res_ptr[k], f.nnz_out(i), ml->res[i]);
+  }
+  return 0;
+}
+
+int OracleFunction::
+eval_function(LocalOracleMemory* ml, const std::string& fcn, double** res) const {
   // Is the function monitored?
   bool monitored = this->monitored(fcn);
 
@@ -293,14 +640,8 @@ calc_function(OracleMemory* m, const std::string& fcn,
   // Number of inputs and outputs
   casadi_int n_in = f.n_in(), n_out = f.n_out();
 
-  // Prepare stats, start timer
-  ScopedTiming tic(fstats);
-
-  // Input buffers
-  if (arg) {
-    std::fill_n(ml->arg, n_in, nullptr);
-    for (casadi_int i=0; i<n_in; ++i) ml->arg[i] = *arg++;
-  }
+  // Prepare stats, start timer if timings are recorded
+  ScopedTiming tic(fstats, record_time_);
 
   // Print inputs nonzeros
   if (monitored) {
@@ -326,7 +667,7 @@ calc_function(OracleMemory* m, const std::string& fcn,
 
   // Evaluate memory-less
   try {
-    if (f(ml->arg, ml->res, ml->iw, ml->w)) {
+    if (f(ml->arg, res, ml->iw, ml->w)) {
       // Recoverable error
       if (monitored) casadi_message(name_ + ":" + fcn + " failed");
       return 1;
@@ -342,12 +683,12 @@ calc_function(OracleMemory* m, const std::string& fcn,
     s << fcn << " output nonzeros:\n";
     for (casadi_int i=0; i<n_out; ++i) {
       s << " " << i << " (" << f.name_out(i) << "): ";
-      if (ml->res[i]) {
+      if (res[i]) {
         // Print nonzeros
         s << "[";
         for (casadi_int k=0; k<f.nnz_out(i); ++k) {
           if (k!=0) s << ", ";
-          DM::print_scalar(s, ml->res[i][k]);
+          DM::print_scalar(s, res[i][k]);
         }
         s << "]\n";
       } else {
@@ -360,14 +701,14 @@ calc_function(OracleMemory* m, const std::string& fcn,
 
   // Make sure not NaN or Inf
   for (casadi_int i=0; i<n_out; ++i) {
-    if (!ml->res[i]) continue;
-    if (!std::all_of(ml->res[i], ml->res[i]+f.nnz_out(i), [](double v) { return isfinite(v);})) {
+    if (!res[i]) continue;
+    if (!std::all_of(res[i], res[i]+f.nnz_out(i), [](double v) { return isfinite(v);})) {
       std::stringstream ss;
 
-      auto it = std::find_if(ml->res[i], ml->res[i] + f.nnz_out(i),
+      auto it = std::find_if(res[i], res[i] + f.nnz_out(i),
         [](double v) { return !isfinite(v);});
-      casadi_int k = std::distance(ml->res[i], it);
-      bool is_nan = isnan(ml->res[i][k]);
+      casadi_int k = std::distance(res[i], it);
+      bool is_nan = isnan(res[i][k]);
       ss << name_ << ":" << fcn << " failed: " << (is_nan? "NaN" : "Inf") <<
       " detected for output " << f.name_out(i) << ", at " << f.sparsity_out(i).repr_el(k) << ".";
 
@@ -405,6 +746,39 @@ std::string OracleFunction::generate_dependencies(const std::string& fname,
 }
 
 void OracleFunction::jit_dependencies(const std::string& fname) {
+  if (jit_parallel_ && jit_serialize_!="source") {
+    casadi_warning("jit_parallel requires jit_serialize 'source', compiling serially.");
+    jit_parallel_ = false;
+  }
+  if (jit_parallel_) {
+    // One translation unit per function, generated serially
+    std::vector<RegFun*> jit_fun;
+    std::vector<std::string> src;
+    for (auto&& e : all_functions_) {
+      if (!e.second.jit) continue;
+      CodeGenerator gen(fname + "_" + e.first);
+      gen.add(e.second.f);
+      jit_fun.push_back(&e.second);
+      src.push_back(gen.generate());
+    }
+    if (verbose_) casadi_message("compiling " + str(src.size()) + " translation units.");
+    // Plugins must be loaded from the calling thread
+    ImporterInternal::getPlugin(compiler_plugin_);
+    // Compile concurrently, each compiler running in a separate process
+    jit_compilers_.resize(src.size());
+    ThreadPool::instance().run(src.size(), [&](casadi_int k) {
+      jit_compilers_[k] = Importer(src[k], compiler_plugin_, jit_options_);
+    });
+    // Replace the Oracle functions with generated functions
+    for (casadi_int k=0; k<jit_fun.size(); ++k) {
+      if (jit_cleanup_ && remove(src[k].c_str())) casadi_warning("Failed to remove " + src[k]);
+      jit_fun[k]->f_original = jit_fun[k]->f;
+      jit_fun[k]->f = external(jit_fun[k]->f.name(), jit_compilers_[k]);
+    }
+    // Remove the empty file reserving the temporary name
+    if (jit_cleanup_ && jit_temp_suffix_) remove((fname + ".c").c_str());
+    return;
+  }
   if (compiler_.is_null()) {
     if (verbose_) casadi_message("compiling to "+ fname+"'.");
     // JIT dependent functions
@@ -441,6 +815,24 @@ int OracleFunction::local_init_mem(void* mem) const {
     m->add_stat(e.first);
   }
 
+  // Allocate space for cached evaluations
+  for (auto&& e : all_functions_) {
+    bool cached = cache_evaluations_;
+    for (auto&& fu : fused_) cached = cached || fu.second.fused==e.first;
+    if (!cached) continue;
+    const Function& f = e.second.f;
+    LocalOracleMemory::EvalCache& c = m->cache[e.first];
+    c.arg.resize(f.nnz_in());
+    c.res.resize(f.nnz_out());
+    c.res_ptr.resize(f.n_out());
+    double* r = get_ptr(c.res);
+    for (casadi_int i=0; i<f.n_out(); ++i) {
+      c.res_ptr[i] = r;
+      r += f.nnz_out(i);
+    }
+    c.valid = false;
+  }
+
   return 0;
 }
 
@@ -525,7 +917,7 @@ bool OracleFunction::has_function(const std::string& fname) const {
 void OracleFunction::serialize_body(SerializingStream &s) const {
   FunctionInternal::serialize_body(s);
 
-  s.version("OracleFunction", 3);
+  s.version("OracleFunction", 5);
   s.pack("OracleFunction::oracle", oracle_);
   s.pack("OracleFunction::common_options", common_options_);
   s.pack("OracleFunction::specific_options", specific_options_);
@@ -555,12 +947,20 @@ void OracleFunction::serialize_body(SerializingStream &s) const {
   s.pack("OracleFunction::stride_res", stride_res_);
   s.pack("OracleFunction::stride_iw", stride_iw_);
   s.pack("OracleFunction::stride_w", stride_w_);
+  s.pack("OracleFunction::cache_evaluations", cache_evaluations_);
+  s.pack("OracleFunction::fused::size", fused_.size());
+  for (auto &e : fused_) {
+    s.pack("OracleFunction::fused::key", e.first);
+    s.pack("OracleFunction::fused::value::fused", e.second.fused);
+    s.pack("OracleFunction::fused::value::ind", e.second.ind);
+  }
+  s.pack("OracleFunction::jit_parallel", jit_parallel_);
 
 }
 
 OracleFunction::OracleFunction(DeserializingStream& s) : FunctionInternal(s) {
 
-  int version = s.version("OracleFunction", 1, 3);
+  int version = s.version("OracleFunction", 1, 5);
   s.unpack("OracleFunction::oracle", oracle_);
   s.unpack("OracleFunction::common_options", common_options_);
   s.unpack("OracleFunction::specific_options", specific_options_);
@@ -612,6 +1012,24 @@ OracleFunction::OracleFunction(DeserializingStream& s) : FunctionInternal(s) {
     stride_iw_ = 0;
     stride_w_ = 0;
   }
+  if (version>=4) {
+    s.unpack("OracleFunction::cache_evaluations", cache_evaluations_);
+    s.unpack("OracleFunction::fused::size", size);
+    for (casadi_int i=0;i<size;++i) {
+      std::string key;
+      s.unpack("OracleFunction::fused::key", key);
+      FusedFun& r = fused_[key];
+      s.unpack("OracleFunction::fused::value::fused", r.fused);
+      s.unpack("OracleFunction::fused::value::ind", r.ind);
+    }
+  } else {
+    cache_evaluations_ = false;
+  }
+  if (version>=5) {
+    s.unpack("OracleFunction::jit_parallel", jit_parallel_);
+  } else {
+    jit_parallel_ = false;
+  }
 }
 
 } // namespace casadi
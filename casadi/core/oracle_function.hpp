@@ -40,6 +40,21 @@ namespace casadi {
     double** res;
     casadi_int* iw;
     double* w;
+
+    // Result of the last evaluation of a function
+    struct EvalCache {
+      // Input nonzeros
+      std::vector<double> arg;
+      // Output nonzeros
+      std::vector<double> res;
+      // Start of each output in res
+      std::vector<double*> res_ptr;
+      // Does the cache hold a successful evaluation?
+      bool valid;
+    };
+
+    // Cached evaluations, if any
+    std::map<std::string, EvalCache> cache;
   };
 
   /** \brief Function memory
@@ -91,6 +106,22 @@ namespace casadi {
     // Active monitors
     std::vector<std::string> monitor_;
 
+    // Reuse function outputs when called with unchanged inputs
+    bool cache_evaluations_;
+
+    // Compile the jit functions as separate translation units, concurrently
+    bool jit_parallel_;
+
+    // Compilers for the jit functions when compiled separately
+    std::vector<Importer> jit_compilers_;
+
+    // Functions whose outputs are taken from a fused function
+    struct FusedFun {
+      std::string fused;
+      std::vector<casadi_int> ind;
+    };
+    std::map<std::string, FusedFun> fused_;
+
     // Memory stride in case of multipel threads
     size_t stride_arg_, stride_res_, stride_iw_, stride_w_;
 
@@ -154,8 +185,54 @@ namespace casadi {
       const std::vector<std::string>& s_out,
       const Dict& opts=Dict());
 
-    /** Create an oracle function as a forward derivative of a different function */
-    Function create_forward(const std::string& fname, casadi_int nfwd);
+    /** Create an oracle function from SX */
+    Function create_function(const std::string& fname,
+      const std::vector<SX>& e_in,
+      const std::vector<SX>& e_out,
+      const std::vector<std::string>& s_in,
+      const std::vector<std::string>& s_out,
+      const Dict& opts=Dict());
+
+    /** Create an oracle function from expressions */
+    template<typename XType>
+    Function create_function_expr(const std::string& fname,
+      const std::vector<XType>& e_in,
+      const std::vector<XType>& e_out,
+      const std::vector<std::string>& s_in,
+      const std::vector<std::string>& s_out,
+      const Dict& opts);
+
+    /** Create an oracle function as a forward derivative of a different function
+
+        With a parallelization other than "serial", the directions are evaluated
+        as independent single-direction derivatives, mapped over nfwd */
+    Function create_forward(const std::string& fname, casadi_int nfwd,
+      const std::string& parallelization="serial", casadi_int max_num_threads=1);
+
+    /** Create an oracle function calculating Hessian-vector products
+
+        The Hessian of oracle output f with respect to input x is never formed: the
+        product with the direction, an additional input "v", is a forward directional
+        derivative of the reverse mode gradient (forward-over-reverse) */
+    Function create_hess_vec(const std::string& fname,
+      const std::vector<std::string>& s_in, const std::string& f, const std::string& x,
+      const Function::AuxOut& aux=Function::AuxOut(), const Dict& opts=Dict());
+
+    /** Create an oracle function evaluated block by block
+
+        The input x is split into the blocks given by the offsets. For every block,
+        a function with the derivatives with respect to that block only is created,
+        and the results are assembled: gradients are stacked vertically, Jacobians
+        horizontally and Hessians block diagonally, i.e. the Hessian is assumed to
+        have no entries between different blocks. Outputs that are not derivatives
+        with respect to x are calculated with the first block. Calls to the block
+        functions are independent and are evaluated concurrently */
+    Function create_block_function(const std::string& fname,
+      const std::vector<std::string>& s_in,
+      const std::vector<std::string>& s_out,
+      const std::string& x, const std::vector<casadi_int>& blocks,
+      const Function::AuxOut& aux=Function::AuxOut(),
+      const Dict& opts=Dict());
 
     /** Register the function for evaluation and statistics gathering */
     void set_function(const Function& fcn, const std::string& fname, bool jit=false);
@@ -163,10 +240,21 @@ namespace casadi {
     /** Register the function for evaluation and statistics gathering */
     void set_function(const Function& fcn) { set_function(fcn, fcn.name()); }
 
+    /** Take the outputs of a registered function from a fused function
+
+        The fused function must have the same inputs. Output i of fname is
+        output ind[i] of the fused function. The fused function is evaluated
+        with caching, i.e. at most once for the same inputs */
+    void set_fused(const std::string& fname, const std::string& fused,
+      const std::vector<casadi_int>& ind);
+
     // Calculate an oracle function
     int calc_function(OracleMemory* m, const std::string& fcn,
       const double* const* arg=nullptr, int thread_id=0) const;
 
+    // Evaluate a function for the inputs in the work vectors
+    int eval_function(LocalOracleMemory* ml, const std::string& fcn, double** res) const;
+
     // Forward sparsity propagation through a function
     int calc_sp_forward(const std::string& fcn, const bvec_t** arg, bvec_t** res,
       casadi_int* iw, bvec_t* w) const;
@@ -0,0 +1,309 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "profiler.hpp"
+#include "function_internal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace casadi {
+
+  namespace {
+    // A completed event
+    struct ProfilerEvent {
+      std::string name, category;
+      int64_t t_start, t_stop;
+      casadi_int depth;
+    };
+
+    // Events recorded by one thread
+    struct ProfilerBuffer {
+      casadi_int tid;
+      std::vector<ProfilerEvent> events;
+      // Instruction counters, by Function
+      std::map<const ProtoFunction*, ProfilerInstructions> instructions;
+    };
+
+    // Buffers of all threads that recorded events
+    std::mutex profiler_mtx;
+    std::vector<std::shared_ptr<ProfilerBuffer> > profiler_buffers;
+
+    // Time origin
+    std::chrono::steady_clock::time_point profiler_epoch = std::chrono::steady_clock::now();
+
+    ProfilerBuffer& local_buffer() {
+      thread_local std::shared_ptr<ProfilerBuffer> b;
+      if (!b) {
+        b = std::make_shared<ProfilerBuffer>();
+        std::lock_guard<std::mutex> lock(profiler_mtx);
+        b->tid = profiler_buffers.size();
+        profiler_buffers.push_back(b);
+      }
+      return *b;
+    }
+
+    // Events of a thread, in order of start time, callers before callees
+    std::vector<ProfilerEvent> sorted_events(const ProfilerBuffer& b) {
+      std::vector<ProfilerEvent> ev = b.events;
+      std::stable_sort(ev.begin(), ev.end(), [](const ProfilerEvent& x, const ProfilerEvent& y) {
+        return x.t_start < y.t_start || (x.t_start == y.t_start && x.depth < y.depth);
+      });
+      return ev;
+    }
+
+    struct PathStats {
+      casadi_int n_call = 0;
+      int64_t t_total = 0, t_self = 0;
+    };
+
+    // Aggregate events by call path
+    std::map<std::string, PathStats> path_stats() {
+      std::map<std::string, PathStats> ret;
+      std::lock_guard<std::mutex> lock(profiler_mtx);
+      for (auto&& b : profiler_buffers) {
+        std::vector<ProfilerEvent> ev = sorted_events(*b);
+        // Stack of open events: path, stop time
+        std::vector<std::pair<std::string, int64_t> > stack;
+        for (auto&& e : ev) {
+          // Pop events that ended before this one started
+          while (!stack.empty() && stack.back().second <= e.t_start) stack.pop_back();
+          int64_t dur = e.t_stop - e.t_start;
+          std::string path = stack.empty() ? e.name : stack.back().first + ";" + e.name;
+          // Time spent in the callee is not part of the caller's self time
+          if (!stack.empty()) ret[stack.back().first].t_self -= dur;
+          PathStats& s = ret[path];
+          s.n_call++;
+          s.t_total += dur;
+          s.t_self += dur;
+          stack.emplace_back(path, e.t_stop);
+        }
+      }
+      return ret;
+    }
+
+    // Escape a string for JSON
+    std::string json_escape(const std::string& s) {
+      std::string r;
+      for (char c : s) {
+        if (c == '"' || c == '\\') {
+          r.push_back('\\');
+          r.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+          r.push_back(' ');
+        } else {
+          r.push_back(c);
+        }
+      }
+      return r;
+    }
+  } // namespace
+
+  std::atomic<bool> Profiler::enabled_(false);
+  std::atomic<bool> Profiler::instructions_(false);
+
+  void Profiler::start(bool instructions) {
+    clear();
+    instructions_ = instructions;
+    enabled_ = true;
+  }
+
+  void Profiler::stop() {
+    enabled_ = false;
+    instructions_ = false;
+  }
+
+  void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(profiler_mtx);
+    for (auto&& b : profiler_buffers) {
+      b->events.clear();
+      b->instructions.clear();
+    }
+  }
+
+  int64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - profiler_epoch).count();
+  }
+
+  casadi_int& Profiler::depth() {
+    thread_local casadi_int d = 0;
+    return d;
+  }
+
+  void Profiler::record(const std::string& name, const std::string& category,
+      int64_t t_start, int64_t t_stop, casadi_int depth) {
+    local_buffer().events.push_back({name, category, t_start, t_stop, depth});
+  }
+
+  ProfilerInstructions& Profiler::instructions(const ProtoFunction* f, casadi_int n) {
+    ProfilerInstructions& r = local_buffer().instructions[f];
+    // New Function, or a different Function allocated at the same address
+    if (r.function != f->name_ || r.n_call.size() != n) {
+      r.function = f->name_;
+      r.op.clear();
+      r.expr.clear();
+      r.n_call.assign(n, 0);
+      r.t_total.assign(n, 0);
+    }
+    return r;
+  }
+
+  Dict Profiler::instruction_stats() {
+    std::map<std::string, PathStats> s;
+    std::lock_guard<std::mutex> lock(profiler_mtx);
+    for (auto&& b : profiler_buffers) {
+      for (auto&& e : b->instructions) {
+        const ProfilerInstructions& r = e.second;
+        for (casadi_int k = 0; k < r.op.size(); ++k) {
+          if (r.n_call[k] == 0) continue;
+          PathStats& st = s[r.op[k]];
+          st.n_call += r.n_call[k];
+          st.t_total += r.t_total[k];
+        }
+      }
+    }
+    Dict ret;
+    for (auto&& e : s) {
+      ret[e.first] = Dict{{"n_call", e.second.n_call},
+        {"t_total", 1e-9 * static_cast<double>(e.second.t_total)}};
+    }
+    return ret;
+  }
+
+  std::string Profiler::hot_nodes(casadi_int n) {
+    // Instructions with the same Function name and index are merged across threads
+    struct Node {
+      std::string op, expr;
+      casadi_int n_call = 0;
+      int64_t t_total = 0;
+    };
+    typedef std::map<std::pair<std::string, casadi_int>, Node> NodeMap;
+    NodeMap nodes;
+    {
+      std::lock_guard<std::mutex> lock(profiler_mtx);
+      for (auto&& b : profiler_buffers) {
+        for (auto&& e : b->instructions) {
+          const ProfilerInstructions& r = e.second;
+          for (casadi_int k = 0; k < r.op.size(); ++k) {
+            if (r.n_call[k] == 0) continue;
+            Node& nd = nodes[std::make_pair(r.function, k)];
+            nd.op = r.op[k];
+            nd.expr = r.expr[k];
+            nd.n_call += r.n_call[k];
+            nd.t_total += r.t_total[k];
+          }
+        }
+      }
+    }
+    // Sort by decreasing total time
+    std::vector<const NodeMap::value_type*> sorted;
+    int64_t t_sum = 0;
+    for (auto&& e : nodes) {
+      sorted.push_back(&e);
+      t_sum += e.second.t_total;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+      [](const NodeMap::value_type* x, const NodeMap::value_type* y) {
+        return x->second.t_total > y->second.t_total;
+      });
+    if (n >= 0 && sorted.size() > n) sorted.resize(n);
+    std::stringstream ss;
+    ss << std::setw(20) << "function" << std::setw(8) << "instr" << std::setw(16) << "op"
+       << std::setw(10) << "n_call" << std::setw(12) << "t_total" << std::setw(8) << "%"
+       << "  instruction\n";
+    for (auto&& e : sorted) {
+      const Node& nd = e->second;
+      ss << std::setw(20) << e->first.first << std::setw(8) << e->first.second
+         << std::setw(16) << nd.op << std::setw(10) << nd.n_call
+         << std::setw(12) << std::scientific << std::setprecision(3)
+         << 1e-9 * static_cast<double>(nd.t_total)
+         << std::setw(8) << std::fixed << std::setprecision(1)
+         << (t_sum > 0 ? 100. * static_cast<double>(nd.t_total) / static_cast<double>(t_sum) : 0.)
+         << "  " << nd.expr << "\n";
+    }
+    return ss.str();
+  }
+
+  Dict Profiler::stats() {
+    Dict ret;
+    for (auto&& e : path_stats()) {
+      ret[e.first] = Dict{{"n_call", e.second.n_call},
+        {"t_total", 1e-9 * static_cast<double>(e.second.t_total)},
+        {"t_self", 1e-9 * static_cast<double>(e.second.t_self)}};
+    }
+    return ret;
+  }
+
+  void Profiler::save_trace(const std::string& fname) {
+    std::ofstream f(fname);
+    casadi_assert(f.good(), "Could not open file '" + fname + "' for writing.");
+    f << std::fixed << std::setprecision(3);
+    f << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(profiler_mtx);
+    for (auto&& b : profiler_buffers) {
+      for (auto&& e : sorted_events(*b)) {
+        if (!first) f << ",";
+        first = false;
+        // Complete events, timestamps in microseconds
+        f << "\n{\"name\": \"" << json_escape(e.name) << "\", \"cat\": \""
+          << json_escape(e.category) << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << b->tid
+          << ", \"ts\": " << 1e-3 * static_cast<double>(e.t_start)
+          << ", \"dur\": " << 1e-3 * static_cast<double>(e.t_stop - e.t_start) << "}";
+      }
+    }
+    f << "\n]}\n";
+  }
+
+  void Profiler::save_folded(const std::string& fname) {
+    std::ofstream f(fname);
+    casadi_assert(f.good(), "Could not open file '" + fname + "' for writing.");
+    for (auto&& e : path_stats()) {
+      f << e.first << " " << e.second.t_self << "\n";
+    }
+  }
+
+  void ProfilerScope::begin(const ProtoFunction* f, const char* what) {
+    f_ = f;
+    what_ = what;
+    Profiler::depth()++;
+    t_start_ = Profiler::now();
+  }
+
+  void ProfilerScope::end() {
+    int64_t t_stop = Profiler::now();
+    casadi_int depth = --Profiler::depth();
+    std::string name = f_->name_;
+    if (what_) name = name + ":" + what_;
+    Profiler::record(name, f_->class_name(), t_start_, t_stop, depth);
+  }
+
+} // namespace casadi
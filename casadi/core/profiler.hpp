@@ -0,0 +1,182 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef CASADI_PROFILER_HPP
+#define CASADI_PROFILER_HPP
+
+#include "generic_type.hpp"
+
+#ifndef SWIG
+#include <atomic>
+#include <cstdint>
+#endif // SWIG
+
+namespace casadi {
+
+#ifndef SWIG
+  class ProtoFunction;
+
+  /// \cond INTERNAL
+  /** \brief Instruction-level counters of one Function in one thread */
+  struct CASADI_EXPORT ProfilerInstructions {
+    /// Name of the Function
+    std::string function;
+    /// Operation name and printed instruction
+    std::vector<std::string> op, expr;
+    /// Number of evaluations and accumulated time in nanoseconds
+    std::vector<casadi_int> n_call;
+    std::vector<int64_t> t_total;
+    /// Record instruction k, started at time t, returns the current time
+    inline int64_t record(casadi_int k, int64_t t);
+  };
+  /// \endcond
+#endif // SWIG
+
+  /** \brief Hierarchical profiler for numerical evaluation
+
+      When enabled, every numerical Function evaluation and every linear solver
+      factorization and solve is recorded with a nanosecond timer, together with
+      the thread it ran on. Nested evaluations (e.g. the body of a Map, a called
+      Function, the right-hand side of an integrator) appear below their caller.
+
+      Function construction is recorded as well, split into the phases
+      "construct:options", "construct:init" and "construct:finalize".
+
+      When disabled, the overhead is a single atomic load per evaluation.
+
+      The recorded events can be exported as a Chrome trace (chrome://tracing,
+      Perfetto, speedscope) or as folded stacks, the format consumed by
+      flamegraph tools such as flamegraph.pl and by perf-based tooling.
+
+      Optionally, the individual instructions of SX and MX Functions can be timed as
+      well, attributing time to opcodes and MX node types. This is considerably more
+      expensive, for SX it is dominated by the timer itself, so the counts are exact
+      while the times are indicative only.
+
+      Start, stop, clear and export should not be called while evaluations are running
+      on other threads.
+
+      \date 2026
+  */
+  class CASADI_EXPORT Profiler {
+    private:
+      /// No instances are allowed
+      Profiler();
+    public:
+      /// Clear all recorded events and start recording, optionally also per instruction
+      static void start(bool instructions=false);
+
+      /// Stop recording, recorded events are kept
+      static void stop();
+
+      /// Clear all recorded events
+      static void clear();
+
+      /// Is the profiler recording?
+      static bool is_enabled() { return enabled_; }
+
+      /// Is the profiler recording individual SX/MX instructions?
+      static bool is_instructions_enabled() { return instructions_; }
+
+      /** \brief Statistics per call path
+
+          Returns a dictionary keyed by the call path ("f;g;h") with entries
+          n_call, t_total and t_self (in seconds).
+      */
+      static Dict stats();
+
+      /// Export events in Chrome trace event format (JSON)
+      static void save_trace(const std::string& fname);
+
+      /// Export self time per call path in nanoseconds, as folded stacks
+      static void save_folded(const std::string& fname);
+
+      /** \brief Statistics per SX opcode or MX node type
+
+          Returns a dictionary keyed by operation ("mul", "mtimes", "getnonzeros", ..)
+          with entries n_call and t_total (in seconds). The time of MX call nodes
+          includes the time spent in the called Function.
+      */
+      static Dict instruction_stats();
+
+      /** \brief Report of the instructions with the largest total time
+
+          Lists function name, instruction index (as in Function::disp with more=true),
+          operation, number of calls, total time and the instruction itself.
+      */
+      static std::string hot_nodes(casadi_int n=10);
+
+#ifndef SWIG
+      /// Current time in nanoseconds
+      static int64_t now();
+
+      /// Record a completed event
+      static void record(const std::string& name, const std::string& category,
+        int64_t t_start, int64_t t_stop, casadi_int depth);
+
+      /// Nesting depth in the current thread
+      static casadi_int& depth();
+
+      /** \brief Instruction counters of a Function with n instructions, current thread
+
+          The op and expr fields are empty if the Function is seen for the first time.
+      */
+      static ProfilerInstructions& instructions(const ProtoFunction* f, casadi_int n);
+
+    private:
+      static std::atomic<bool> enabled_, instructions_;
+#endif // SWIG
+  };
+
+#ifndef SWIG
+  /// \cond INTERNAL
+  /** \brief Records the lifetime of the object as a profiler event, if enabled */
+  class CASADI_EXPORT ProfilerScope {
+    public:
+      ProfilerScope(const ProtoFunction* f, const char* what = nullptr) : f_(nullptr) {
+        if (Profiler::is_enabled()) begin(f, what);
+      }
+      ~ProfilerScope() {
+        if (f_) end();
+      }
+    private:
+      void begin(const ProtoFunction* f, const char* what);
+      void end();
+      const ProtoFunction* f_;
+      const char* what_;
+      int64_t t_start_;
+  };
+
+  int64_t ProfilerInstructions::record(casadi_int k, int64_t t) {
+    int64_t t1 = Profiler::now();
+    n_call[k]++;
+    t_total[k] += t1 - t;
+    return t1;
+  }
+  /// \endcond
+#endif // SWIG
+
+} // namespace casadi
+
+#endif // CASADI_PROFILER_HPP
@@ -111,6 +111,11 @@ namespace casadi {
     }
   }
 
+  MX Reshape::get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const {
+    // Reshaping does not change the order of the nonzeros
+    return dep()->get_nzref(sp, nz);
+  }
+
   bool Reshape::is_valid_input() const {
     return dep()->is_valid_input();
   }
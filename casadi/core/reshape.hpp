@@ -117,6 +117,9 @@ namespace casadi {
     /// Transpose (if a dimension is one)
     MX get_transpose() const override;
 
+    /// Get the nonzeros of matrix
+    MX get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const override;
+
     /** \brief  Check if valid function input
 
         \identifier{1dt} */
@@ -23,7 +23,8 @@
 typedef enum {
   CVX_REGULARIZE,
   CVX_EIGEN_CLIP,
-  CVX_EIGEN_REFLECT
+  CVX_EIGEN_REFLECT,
+  CVX_INERTIA
 } casadi_convexify_strategy_t;
 
 // SYMBOL "convexify_type_in_t"
@@ -51,19 +52,18 @@ struct casadi_convexify_config {
   /// For eigen-* convexification strategies: maximum iterations for symmetric Schur decomposition
   // Needs to be "big enough"
   casadi_int max_iter_eig;
+  /// For the inertia strategy: sparsity of the transposed L factor and the fill-reducing ordering
+  const casadi_int *Lsp;
+  const casadi_int *ldl_p;
   int verbose;
 };
 // C-REPLACE "casadi_convexify_config<T1>" "struct casadi_convexify_config"
 
 
-// SYMBOL "convexify_eval"
+// SYMBOL "convexify_project"
+// Copy or project the input onto the sparsity pattern of the output
 template<typename T1>
-int convexify_eval(const casadi_convexify_config<T1>* c, const T1* Hin, T1* Hout, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
-    casadi_int i, j, k, kk, block_size, offset;
-    int ret;
-    T1 reg, e;
-    T1 *H_block, *w_cvx;
-
+void convexify_project(const casadi_convexify_config<T1>* c, const T1* Hin, T1* Hout, T1* w) { // NOLINT(whitespace/line_length)
     casadi_int Hrsp_nnz = c->Hrsp[2+c->Hrsp[1]];
     casadi_int nnz = c->Hsp[2+c->Hsp[1]];
 
@@ -77,99 +77,211 @@ int convexify_eval(const casadi_convexify_config<T1>* c, const T1* Hin, T1* Hout
     } else {
       if (Hin!=Hout) casadi_copy(Hin, nnz, Hout);
     }
+}
 
-    if (c->strategy==CVX_REGULARIZE) {
-      // Determine regularization parameter with Gershgorin theorem
-      reg = c->margin-casadi_lb_eig(c->Hsp, Hout);
-      if (reg > 0) casadi_regularize(c->Hsp, Hout, reg);
-    } else if (c->strategy==CVX_EIGEN_REFLECT || c->strategy==CVX_EIGEN_CLIP) {
-      offset = 0;
+// SYMBOL "convexify_posdef"
+// Is A-margin*I positive definite? Dense Cholesky factorization in w (n*n)
+template<typename T1>
+int convexify_posdef(casadi_int n, const T1* A, T1 margin, T1* w) {
+    casadi_int i, j, k;
+    T1 s;
+    casadi_copy(A, n*n, w);
+    for (j=0;j<n;++j) {
+      s = w[j+j*n]-margin;
+      for (k=0;k<j;++k) s -= w[j+k*n]*w[j+k*n];
+      if (!(s>0)) return 0;
+      s = sqrt(s);
+      w[j+j*n] = s;
+      for (i=j+1;i<n;++i) {
+        for (k=0;k<j;++k) w[i+j*n] -= w[i+k*n]*w[j+k*n];
+        w[i+j*n] /= s;
+      }
+    }
+    return 1;
+}
 
-      // Loop over Hessian blocks
-      for (k=0;k<c->scc_offset_size-1;++k) {
-        block_size = c->scc_offset[k+1]-c->scc_offset[k];
+// SYMBOL "convexify_block"
+// Convexify the k-th diagonal block of an eigen-* strategy, with mapping starting at offset
+//
+// pd: if not null, per block a flag that the block needed no correction in the previous
+//     call. Such blocks are first checked for positive definiteness, skipping the
+//     eigendecomposition if possible.
+template<typename T1>
+int convexify_block(const casadi_convexify_config<T1>* c, casadi_int k, casadi_int offset,
+    T1* Hout, casadi_int* iw, T1* w, casadi_int* pd) {
+    casadi_int i, j, kk, block_size, sz_cvx;
+    int ret;
+    T1 e, dev, mag;
+    T1 *H_block, *w_cvx, *H_orig;
+
+    block_size = c->scc_offset[k+1]-c->scc_offset[k];
 
-        H_block = w;
-        w_cvx = w;
-
-        // Set w_cvx to dense Hessian block from Hout
-        if (c->scc_transform) {
-          kk=0;
-          if (c->type_in==CVX_SYMM) {
-            // Loop over columns of block
-            for (i=0;i<block_size;++i) {
-              // Loop over elements in column
-              for (j=0;j<block_size;++j, ++kk) {
-                H_block[kk] = Hout[c->scc_mapping[offset+kk]];
-              }
-            }
-          } else if (c->type_in==CVX_TRIU) {
-            // Loop over columns of block
-            for (i=0;i<block_size;++i) {
-              // Loop over elements in column
-              for (j=0;j<i+1;++j, ++kk) {
-                  e = Hout[c->scc_mapping[offset+kk]];
-                  H_block[i*block_size+j] = e;
-                  H_block[i+block_size*j] = e;
-              }
-            }
-          } else {
-            // Loop over columns of block
-            for (i=0;i<block_size;++i) {
-              for (j=i;j<block_size;++j, ++kk) {
-                e = Hout[c->scc_mapping[offset+kk]];
-                H_block[i*block_size+j] = e;
-                H_block[i+block_size*j] = e;
-              }
-            }
+    H_block = w;
+    w_cvx = w;
+
+    // Set w_cvx to dense Hessian block from Hout
+    if (c->scc_transform) {
+      kk=0;
+      if (c->type_in==CVX_SYMM) {
+        // Loop over columns of block
+        for (i=0;i<block_size;++i) {
+          // Loop over elements in column
+          for (j=0;j<block_size;++j, ++kk) {
+            H_block[kk] = Hout[c->scc_mapping[offset+kk]];
+          }
+        }
+      } else if (c->type_in==CVX_TRIU) {
+        // Loop over columns of block
+        for (i=0;i<block_size;++i) {
+          // Loop over elements in column
+          for (j=0;j<i+1;++j, ++kk) {
+              e = Hout[c->scc_mapping[offset+kk]];
+              H_block[i*block_size+j] = e;
+              H_block[i+block_size*j] = e;
+          }
+        }
+      } else {
+        // Loop over columns of block
+        for (i=0;i<block_size;++i) {
+          for (j=i;j<block_size;++j, ++kk) {
+            e = Hout[c->scc_mapping[offset+kk]];
+            H_block[i*block_size+j] = e;
+            H_block[i+block_size*j] = e;
           }
-          w_cvx += block_size*block_size;
-        } else {
-          H_block = Hout+offset;
         }
+      }
+      w_cvx += block_size*block_size;
+    } else {
+      H_block = Hout+offset;
+    }
 
-        // Perform convexification
-        ret = casadi_cvx(block_size, H_block, c->margin, 1e-10,
-          c->strategy==CVX_EIGEN_REFLECT, c->max_iter_eig, w_cvx, iw);
-        if (ret) return ret;
+    if (pd) {
+      if (pd[k]) {
+        // Positive definite block: leave untouched
+        pd[k] = convexify_posdef(block_size, H_block, c->margin, w_cvx);
+        if (pd[k]) return 0;
+      }
+      // Keep a copy to detect whether the correction was needed
+      sz_cvx = 2*(block_size-1)*c->max_iter_eig;
+      if (sz_cvx<block_size*block_size) sz_cvx = block_size*block_size;
+      H_orig = w_cvx + sz_cvx;
+      casadi_copy(H_block, block_size*block_size, H_orig);
+    }
+
+    // Perform convexification
+    ret = casadi_cvx(block_size, H_block, c->margin, 1e-10,
+      c->strategy==CVX_EIGEN_REFLECT, c->max_iter_eig, w_cvx, iw);
+    if (ret) return ret;
 
-        // Fill in upper-rectangular part
+    // Fill in upper-rectangular part
+    for (i=0;i<block_size;++i) {
+      for (j=0;j<i+1;++j) {
+        H_block[block_size*i+j] = H_block[block_size*j+i];
+      }
+    }
+
+    // Unchanged block (up to rounding): check positive definiteness in the next call
+    if (pd) {
+      dev = 0;
+      mag = 1;
+      for (i=0;i<block_size*block_size;++i) {
+        dev = fmax(dev, fabs(H_block[i]-H_orig[i]));
+        mag = fmax(mag, fabs(H_orig[i]));
+      }
+      pd[k] = dev <= 1e-10*mag;
+    }
+
+    // Put results back in Hout
+    if (c->scc_transform) {
+      kk=0;
+      if (c->type_in==CVX_SYMM) {
+        // Loop over columns of block
         for (i=0;i<block_size;++i) {
-          for (j=0;j<i+1;++j) {
-            H_block[block_size*i+j] = H_block[block_size*j+i];
+          // Loop over elements in column
+          for (j=0;j<block_size;++j, ++kk) {
+            Hout[c->scc_mapping[offset+kk]] = H_block[kk];
           }
         }
-
-        // Put results back in Hout
-        if (c->scc_transform) {
-          kk=0;
-          if (c->type_in==CVX_SYMM) {
-            // Loop over columns of block
-            for (i=0;i<block_size;++i) {
-              // Loop over elements in column
-              for (j=0;j<block_size;++j, ++kk) {
-                Hout[c->scc_mapping[offset+kk]] = H_block[kk];
-              }
-            }
-          } else if (c->type_in==CVX_TRIU) {
-            // Loop over columns of block
-            for (i=0;i<block_size;++i) {
-              // Loop over elements in column
-              for (j=0;j<i+1;++j, ++kk) {
-                Hout[c->scc_mapping[offset+kk]] = H_block[block_size*i+j];
-              }
-            }
-          } else {
-            // Loop over columns of block
-            for (i=0;i<block_size;++i) {
-              // Loop over elements in column
-              for (j=i;j<block_size;++j, ++kk) {
-                Hout[c->scc_mapping[offset+kk]] = H_block[block_size*i+j];
-              }
-            }
+      } else if (c->type_in==CVX_TRIU) {
+        // Loop over columns of block
+        for (i=0;i<block_size;++i) {
+          // Loop over elements in column
+          for (j=0;j<i+1;++j, ++kk) {
+            Hout[c->scc_mapping[offset+kk]] = H_block[block_size*i+j];
+          }
+        }
+      } else {
+        // Loop over columns of block
+        for (i=0;i<block_size;++i) {
+          // Loop over elements in column
+          for (j=i;j<block_size;++j, ++kk) {
+            Hout[c->scc_mapping[offset+kk]] = H_block[block_size*i+j];
           }
         }
+      }
+    }
+
+    return 0;
+}
+
+// SYMBOL "convexify_eval"
+template<typename T1>
+int convexify_eval(const casadi_convexify_config<T1>* c, const T1* Hin, T1* Hout, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
+    casadi_int i, k, block_size, offset, n;
+    int ret;
+    T1 reg, reg_prev, reg_lo, reg_hi, e;
+    T1 *lt, *d;
+
+    convexify_project(c, Hin, Hout, w);
+
+    if (c->strategy==CVX_REGULARIZE) {
+      // Determine regularization parameter with Gershgorin theorem
+      reg = c->margin-casadi_lb_eig(c->Hsp, Hout);
+      if (reg > 0) casadi_regularize(c->Hsp, Hout, reg);
+    } else if (c->strategy==CVX_INERTIA) {
+      // Smallest diagonal shift for which all pivots of the LDL^T factorization
+      // exceed the margin: try 0, 1e-4, then increase by a factor 8 until the
+      // shift is sufficient, followed by a few bisection steps
+      n = c->Hsp[1];
+      lt = w;
+      d = lt + c->Lsp[2+n];
+      // Sufficient shift according to the Gershgorin theorem
+      reg_hi = c->margin-casadi_lb_eig(c->Hsp, Hout);
+      reg = reg_lo = reg_prev = 0;
+      k = 0;
+      while (reg < reg_hi) {
+        casadi_regularize(c->Hsp, Hout, reg-reg_prev);
+        reg_prev = reg;
+        casadi_ldl(c->Hsp, Hout, c->Lsp, lt, d, c->ldl_p, d+n);
+        // Check inertia
+        for (i=0; i<n; ++i) {
+          if (!(d[i] > c->margin)) break;
+        }
+        if (i==n) {
+          reg_hi = reg;
+        } else {
+          reg_lo = reg;
+        }
+        // Next trial shift
+        e = reg==0 ? 1e-4 : 8*reg;
+        if (k==0 && reg_lo==reg && e < reg_hi) {
+          reg = e;
+        } else if (reg_lo>0 && k++ < 3) {
+          reg = (reg_lo+reg_hi)/2;
+        } else {
+          break;
+        }
+      }
+      if (reg_hi > reg_prev) casadi_regularize(c->Hsp, Hout, reg_hi-reg_prev);
+    } else if (c->strategy==CVX_EIGEN_REFLECT || c->strategy==CVX_EIGEN_CLIP) {
+      offset = 0;
 
+      // Loop over Hessian blocks
+      for (k=0;k<c->scc_offset_size-1;++k) {
+        ret = convexify_block(c, k, offset, Hout, iw, w, 0);
+        if (ret) return ret;
+
+        block_size = c->scc_offset[k+1]-c->scc_offset[k];
         if (c->type_in==CVX_SYMM) {
           offset += block_size*block_size;
         } else {
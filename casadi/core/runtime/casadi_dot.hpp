@@ -22,6 +22,19 @@ template<typename T1>
 T1 casadi_dot(casadi_int n, const T1* x, const T1* y) {
   casadi_int i;
   T1 r = 0;
+#ifdef CASADI_SIMD
+  /* Independent partial sums, lets the compiler vectorize the reduction */
+  T1 r1 = 0, r2 = 0, r3 = 0;
+  for (i=0; i+3<n; i+=4) {
+    r += x[i]*y[i];
+    r1 += x[i+1]*y[i+1];
+    r2 += x[i+2]*y[i+2];
+    r3 += x[i+3]*y[i+3];
+  }
+  r = (r + r1) + (r2 + r3);
+  for (; i<n; ++i) r += x[i]*y[i];
+#else
   for (i=0; i<n; ++i) r += *x++ * *y++;
+#endif
   return r;
 }
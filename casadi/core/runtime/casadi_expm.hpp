@@ -0,0 +1,276 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// All matrices are dense n-by-n, column major. Rows p, ..., n-1 of the matrices multiplied
+// or factorized only have a diagonal entry, as is the case for polynomials of a matrix
+// with zero trailing rows. With p == n, the matrices are general.
+
+// SYMBOL "expm_mul"
+template<typename T1>
+void casadi_expm_mul(casadi_int n, casadi_int p, const T1* x, const T1* y, T1* z) {
+  // Local variables
+  casadi_int i, j, k;
+  T1 yk;
+  for (j=0; j<n; ++j) {
+    for (i=0; i<n; ++i) z[i+j*n] = 0;
+    // Leading rows of y
+    for (k=0; k<p; ++k) {
+      yk = y[k+j*n];
+      if (yk==0) continue;
+      for (i=0; i<p; ++i) z[i+j*n] += x[i+k*n]*yk;
+    }
+    // Diagonal trailing row of y
+    if (j>=p) {
+      yk = y[j+j*n];
+      for (i=0; i<p; ++i) z[i+j*n] += x[i+j*n]*yk;
+      z[j+j*n] = x[j+j*n]*yk;
+    }
+  }
+}
+
+// SYMBOL "expm_lu"
+template<typename T1>
+void casadi_expm_lu(casadi_int n, casadi_int p, T1* q, casadi_int* iw) {
+  // Local variables
+  casadi_int i, j, k, piv;
+  T1 qkj;
+  // LU factorization of the leading p-by-p block with partial pivoting, in place
+  for (k=0; k<p; ++k) {
+    piv = k;
+    for (i=k+1; i<p; ++i) {
+      if (fabs(q[i+k*n]) > fabs(q[piv+k*n])) piv = i;
+    }
+    iw[k] = piv;
+    if (piv!=k) {
+      for (j=0; j<n; ++j) {
+        qkj = q[k+j*n];
+        q[k+j*n] = q[piv+j*n];
+        q[piv+j*n] = qkj;
+      }
+    }
+    for (i=k+1; i<p; ++i) q[i+k*n] /= q[k+k*n];
+    for (j=k+1; j<p; ++j) {
+      qkj = q[k+j*n];
+      if (qkj==0) continue;
+      for (i=k+1; i<p; ++i) q[i+j*n] -= q[i+k*n]*qkj;
+    }
+  }
+}
+
+// SYMBOL "expm_solve"
+template<typename T1>
+void casadi_expm_solve(casadi_int n, casadi_int p, const T1* q, T1* b, const casadi_int* iw) {
+  // Local variables
+  casadi_int i, j, k;
+  T1 bk, *bj;
+  for (j=0; j<n; ++j) {
+    bj = b + j*n;
+    // Row interchanges
+    for (k=0; k<p; ++k) {
+      if (iw[k]!=k) {
+        bk = bj[k];
+        bj[k] = bj[iw[k]];
+        bj[iw[k]] = bk;
+      }
+    }
+    // Diagonal trailing rows
+    for (k=p; k<n; ++k) {
+      bj[k] /= q[k+k*n];
+      bk = bj[k];
+      if (bk==0) continue;
+      for (i=0; i<p; ++i) bj[i] -= q[i+k*n]*bk;
+    }
+    // Forward substitution with unit lower triangular factor
+    for (k=0; k<p; ++k) {
+      bk = bj[k];
+      for (i=k+1; i<p; ++i) bj[i] -= q[i+k*n]*bk;
+    }
+    // Backward substitution with upper triangular factor
+    for (k=p; k-- > 0; ) {
+      bj[k] /= q[k+k*n];
+      bk = bj[k];
+      for (i=0; i<k; ++i) bj[i] -= q[i+k*n]*bk;
+    }
+  }
+}
+
+// SYMBOL "expm_sz_w"
+inline
+casadi_int casadi_expm_sz_w(casadi_int n, int frechet) {
+  return (frechet ? 19 : 10)*n*n;
+}
+
+// SYMBOL "expm"
+template<typename T1>
+void casadi_expm(casadi_int n, casadi_int p, const T1* a, T1 t, const T1* e,
+    T1* r, T1* l, T1* w, casadi_int* iw) {
+  // Pade coefficients, degrees 3, 5, 7, 9 and 13
+  const T1 b3[] = {120., 60., 12., 1.};
+  const T1 b5[] = {30240., 15120., 3360., 420., 30., 1.};
+  const T1 b7[] = {17297280., 8648640., 1995840., 277200., 25200., 1512., 56., 1.};
+  const T1 b9[] = {17643225600., 8821612800., 2075673600., 302702400., 30270240.,
+    2162160., 110880., 3960., 90., 1.};
+  const T1 b13[] = {64764752532480000., 32382376266240000., 7771770303897600.,
+    1187353796428800., 129060195264000., 10559470521600., 670442572800.,
+    33522128640., 1323241920., 40840800., 960960., 16380., 182., 1.};
+  // Largest 1-norm for which a degree is accurate
+  const T1 theta[] = {1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+    2.097847961257068e0, 5.371920351148152e0};
+  // Local variables
+  casadi_int i, j, k, m, np, s, nn;
+  const T1* b;
+  T1 nrm, c, sc, v;
+  T1 *as, *pw, *ui, *u, *vv, *q, *tmp, *es, *mw, *lui, *lu, *lv, *ltmp;
+  int frechet;
+  frechet = e && l;
+  nn = n*n;
+  es = mw = lui = lu = lv = ltmp = 0;
+  // Work vectors
+  as = w; w += nn;
+  pw = w; w += 4*nn;
+  ui = w; w += nn;
+  u = w; w += nn;
+  vv = w; w += nn;
+  q = w; w += nn;
+  tmp = w; w += nn;
+  if (frechet) {
+    es = w; w += nn;
+    mw = w; w += 4*nn;
+    lui = w; w += nn;
+    lu = w; w += nn;
+    lv = w; w += nn;
+    ltmp = w; w += nn;
+  }
+  // 1-norm of t*a
+  nrm = 0;
+  for (j=0; j<n; ++j) {
+    c = 0;
+    for (i=0; i<n; ++i) c += fabs(a[i+j*n]);
+    if (c>nrm) nrm = c;
+  }
+  nrm *= fabs(t);
+  // Degree and number of squarings
+  s = 0;
+  if (nrm<=theta[0]) {
+    m = 3;
+  } else if (nrm<=theta[1]) {
+    m = 5;
+  } else if (nrm<=theta[2]) {
+    m = 7;
+  } else if (nrm<=theta[3]) {
+    m = 9;
+  } else {
+    m = 13;
+    while (nrm>theta[4]) {
+      nrm *= 0.5;
+      s++;
+    }
+  }
+  b = m==3 ? b3 : m==5 ? b5 : m==7 ? b7 : m==9 ? b9 : b13;
+  // Scaled matrices
+  sc = t;
+  for (k=0; k<s; ++k) sc *= 0.5;
+  for (i=0; i<nn; ++i) as[i] = sc*a[i];
+  if (frechet) for (i=0; i<nn; ++i) es[i] = sc*e[i];
+  // Even powers A^2, A^4, ... and their Frechet derivatives
+  np = m==13 ? 3 : (m-1)/2;
+  casadi_expm_mul(n, p, as, as, pw);
+  if (frechet) {
+    casadi_expm_mul(n, p, as, es, mw);
+    casadi_expm_mul(n, p, es, as, tmp);
+    for (i=0; i<nn; ++i) mw[i] += tmp[i];
+  }
+  for (k=1; k<np; ++k) {
+    casadi_expm_mul(n, p, pw+(k-1)*nn, pw, pw+k*nn);
+    if (frechet) {
+      casadi_expm_mul(n, p, pw, mw+(k-1)*nn, mw+k*nn);
+      casadi_expm_mul(n, p, mw, pw+(k-1)*nn, tmp);
+      for (i=0; i<nn; ++i) mw[k*nn+i] += tmp[i];
+    }
+  }
+  // Odd part ui, with U = A*ui, and even part V of the numerator
+  for (i=0; i<nn; ++i) ui[i] = vv[i] = 0;
+  if (frechet) for (i=0; i<nn; ++i) lui[i] = lv[i] = 0;
+  if (m==13) {
+    // ui = A6*(b13*A6 + b11*A4 + b9*A2) + ..., V = A6*(b12*A6 + b10*A4 + b8*A2) + ...
+    for (k=0; k<2; ++k) {
+      for (i=0; i<nn; ++i) {
+        q[i] = b[13-k]*pw[2*nn+i] + b[11-k]*pw[nn+i] + b[9-k]*pw[i];
+      }
+      casadi_expm_mul(n, p, pw+2*nn, q, k==0 ? ui : vv);
+      if (frechet) {
+        for (i=0; i<nn; ++i) {
+          ltmp[i] = b[13-k]*mw[2*nn+i] + b[11-k]*mw[nn+i] + b[9-k]*mw[i];
+        }
+        casadi_expm_mul(n, p, pw+2*nn, ltmp, k==0 ? lui : lv);
+        casadi_expm_mul(n, p, mw+2*nn, q, tmp);
+        for (i=0; i<nn; ++i) (k==0 ? lui : lv)[i] += tmp[i];
+      }
+    }
+    m = 7;
+  }
+  // Lower order terms
+  for (k=1; 2*k<=m; ++k) {
+    for (i=0; i<nn; ++i) {
+      ui[i] += b[2*k+1]*pw[(k-1)*nn+i];
+      vv[i] += b[2*k]*pw[(k-1)*nn+i];
+    }
+    if (frechet) {
+      for (i=0; i<nn; ++i) {
+        lui[i] += b[2*k+1]*mw[(k-1)*nn+i];
+        lv[i] += b[2*k]*mw[(k-1)*nn+i];
+      }
+    }
+  }
+  for (i=0; i<n; ++i) {
+    ui[i+i*n] += b[1];
+    vv[i+i*n] += b[0];
+  }
+  casadi_expm_mul(n, p, as, ui, u);
+  if (frechet) {
+    casadi_expm_mul(n, p, as, lui, lu);
+    casadi_expm_mul(n, p, es, ui, tmp);
+    for (i=0; i<nn; ++i) lu[i] += tmp[i];
+  }
+  // R = (V-U)^(-1)*(V+U)
+  for (i=0; i<nn; ++i) {
+    v = vv[i];
+    q[i] = v - u[i];
+    r[i] = v + u[i];
+  }
+  casadi_expm_lu(n, p, q, iw);
+  casadi_expm_solve(n, p, q, r, iw);
+  // L = (V-U)^(-1)*(LU + LV + (LU - LV)*R)
+  if (frechet) {
+    for (i=0; i<nn; ++i) ltmp[i] = lu[i] - lv[i];
+    casadi_expm_mul(n, p, ltmp, r, l);
+    for (i=0; i<nn; ++i) l[i] += lu[i] + lv[i];
+    casadi_expm_solve(n, p, q, l, iw);
+  }
+  // Undo the scaling by repeated squaring
+  for (k=0; k<s; ++k) {
+    if (frechet) {
+      casadi_expm_mul(n, p, r, l, ltmp);
+      casadi_expm_mul(n, p, l, r, tmp);
+      for (i=0; i<nn; ++i) l[i] = ltmp[i] + tmp[i];
+    }
+    casadi_expm_mul(n, p, r, r, tmp);
+    for (i=0; i<nn; ++i) r[i] = tmp[i];
+  }
+}
@@ -0,0 +1,58 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// SYMBOL "interpn_batch"
+template<typename T1>
+void casadi_interpn_batch(T1* res, casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* values, const T1* x, const casadi_int* lookup_mode, casadi_int m, casadi_int n, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
+  // Work vectors
+  T1 *alpha, *coeff;
+  casadi_int *index, *corner;
+  casadi_int i, j, k, ng;
+  const T1* g;
+  T1 xi;
+  alpha = w; w += ndim;
+  index = iw; iw += ndim;
+  corner = iw; iw += ndim;
+  coeff = 0;
+  // Loop over query points
+  for (k=0; k<n; ++k) {
+    // Left index and fraction of interval
+    for (i=0; i<ndim; ++i) {
+      xi = x ? x[i] : 0;
+      g = grid + offset[i];
+      ng = offset[i+1]-offset[i];
+      j = index[i];
+      // Keep the interval of the previous point if it still brackets xi
+      if (k==0 || lookup_mode[i]==1 || (j>0 && xi<g[j]) || (j<ng-2 && xi>=g[j+1])) {
+        j = index[i] = casadi_low(xi, g, ng, lookup_mode[i]);
+      }
+      alpha[i] = (xi-g[j])/(g[j+1]-g[j]);
+    }
+    // Loop over all corners, add contribution to output
+    casadi_clear_casadi_int(corner, ndim);
+    casadi_clear(res, m);
+    do {
+      casadi_interpn_interpolate(res, ndim, offset, values,
+        alpha, index, corner, coeff, m);
+    } while (casadi_flip(corner, ndim));
+    // Next point
+    if (x) x += ndim;
+    res += m;
+  }
+}
@@ -0,0 +1,57 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// SYMBOL "interptt"
+template<typename T1>
+void casadi_interptt(T1* res, casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* cores, const casadi_int* core_offset, const casadi_int* rank, const T1* x, const casadi_int* lookup_mode, casadi_int m, T1* w) { // NOLINT(whitespace/line_length)
+  casadi_int i, j, a, b, ng, r0, r1, rmax;
+  const T1 *g, *c;
+  T1 *v, *vn, *t;
+  T1 xi, alpha;
+  // Quick return
+  if (!res) return;
+  // Work vectors
+  rmax = 1;
+  for (i=0; i<ndim; ++i) if (rank[i]>rmax) rmax = rank[i];
+  v = w; w += rmax;
+  vn = w; w += rmax;
+  // Contract the cores from the right, interpolating each one in its dimension
+  v[0] = 1;
+  for (i=ndim-1; i>=0; --i) {
+    g = grid + offset[i];
+    ng = offset[i+1]-offset[i];
+    xi = x ? x[i] : 0;
+    j = casadi_low(xi, g, ng, lookup_mode[i]);
+    alpha = (xi-g[j])/(g[j+1]-g[j]);
+    r0 = rank[i];
+    r1 = rank[i+1];
+    c = cores + core_offset[i] + j*r0;
+    for (a=0; a<r0; ++a) vn[a] = 0;
+    for (b=0; b<r1; ++b) {
+      for (a=0; a<r0; ++a) vn[a] += ((1-alpha)*c[a] + alpha*c[a+r0])*v[b];
+      c += r0*ng;
+    }
+    t = v; v = vn; vn = t;
+  }
+  // Multiply with the output core
+  for (j=0; j<m; ++j) {
+    res[j] = 0;
+    for (a=0; a<rank[0]; ++a) res[j] += cores[j+m*a]*v[a];
+  }
+}
@@ -0,0 +1,94 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// SYMBOL "interptt_grad"
+template<typename T1>
+void casadi_interptt_grad(T1* grad, casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* cores, const casadi_int* core_offset, const casadi_int* rank, const T1* x, const casadi_int* lookup_mode, casadi_int m, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
+  casadi_int i, j, a, b, ng, r0, r1, rmax;
+  casadi_int* index;
+  const T1 *g, *c;
+  T1 *alpha, *r, *u, *l, *ln, *t;
+  T1 xi, s, dg;
+  // Quick return
+  if (!grad) return;
+  // Work vectors
+  rmax = 1;
+  for (i=0; i<ndim; ++i) if (rank[i]>rmax) rmax = rank[i];
+  index = iw; iw += ndim;
+  alpha = w; w += ndim;
+  r = w; w += (ndim+1)*rmax;
+  u = w; w += rmax;
+  l = w; w += m*rmax;
+  ln = w; w += m*rmax;
+  // Interval and fraction in each dimension
+  for (i=0; i<ndim; ++i) {
+    g = grid + offset[i];
+    ng = offset[i+1]-offset[i];
+    xi = x ? x[i] : 0;
+    j = index[i] = casadi_low(xi, g, ng, lookup_mode[i]);
+    alpha[i] = (xi-g[j])/(g[j+1]-g[j]);
+  }
+  // Right partial contractions: r[i] = C_i ... C_{ndim-1}
+  r[ndim*rmax] = 1;
+  for (i=ndim-1; i>=0; --i) {
+    ng = offset[i+1]-offset[i];
+    r0 = rank[i];
+    r1 = rank[i+1];
+    c = cores + core_offset[i] + index[i]*r0;
+    for (a=0; a<r0; ++a) r[i*rmax+a] = 0;
+    for (b=0; b<r1; ++b) {
+      s = r[(i+1)*rmax+b];
+      for (a=0; a<r0; ++a) r[i*rmax+a] += ((1-alpha[i])*c[a] + alpha[i]*c[a+r0])*s;
+      c += r0*ng;
+    }
+  }
+  // Left partial contractions, starting from the output core
+  for (j=0; j<m*rank[0]; ++j) l[j] = cores[j];
+  for (i=0; i<ndim; ++i) {
+    g = grid + offset[i];
+    ng = offset[i+1]-offset[i];
+    dg = g[index[i]+1]-g[index[i]];
+    r0 = rank[i];
+    r1 = rank[i+1];
+    // Derivative of the interpolated core, applied to the right contraction
+    c = cores + core_offset[i] + index[i]*r0;
+    for (a=0; a<r0; ++a) u[a] = 0;
+    for (b=0; b<r1; ++b) {
+      s = r[(i+1)*rmax+b]/dg;
+      for (a=0; a<r0; ++a) u[a] += (c[a+r0]-c[a])*s;
+      c += r0*ng;
+    }
+    for (j=0; j<m; ++j) {
+      grad[i*m+j] = 0;
+      for (a=0; a<r0; ++a) grad[i*m+j] += l[j+m*a]*u[a];
+    }
+    // Absorb the interpolated core into the left contraction
+    if (i==ndim-1) break;
+    c = cores + core_offset[i] + index[i]*r0;
+    for (b=0; b<r1; ++b) {
+      for (j=0; j<m; ++j) ln[j+m*b] = 0;
+      for (a=0; a<r0; ++a) {
+        s = (1-alpha[i])*c[a] + alpha[i]*c[a+r0];
+        for (j=0; j<m; ++j) ln[j+m*b] += l[j+m*a]*s;
+      }
+      c += r0*ng;
+    }
+    t = l; l = ln; ln = t;
+  }
+}
@@ -58,6 +58,70 @@ void casadi_ldl(const casadi_int* sp_a, const T1* a,
   }
 }
 
+// SYMBOL "ldl_sn"
+// Supernodal variant of casadi_ldl, with the same output.
+// Each supernode is a range of consecutive columns of L with identical structure below
+// the diagonal block. It is stored as one dense column-major block, factorized with
+// dense kernels and used to update the ancestor supernodes.
+// sn = [n, nsn, nnz_a, nnz_lt, sz_w, start[nsn+1], rowind[nsn+1], off[nsn+1], sn_of[n],
+//       rows[rowind[nsn]], a2b[nnz_a], lt2b[nnz_lt]]
+// with the supernode columns start, the offsets rowind into the row indices rows,
+// the offsets off of the blocks, the supernode sn_of of each column and the block
+// locations a2b and lt2b of the nonzeros of A (-1 if not in the lower part) and L^T.
+// len[w] >= sz_w, len[iw] >= n
+template<typename T1>
+void casadi_ldl_sn(const casadi_int* sn, const T1* a, T1* lt, T1* d, T1* w, casadi_int* iw) {
+  casadi_int n, nsn, nnz_a, nnz_lt, s, t, ns, m, p, q, i, j, k, kb;
+  const casadi_int *start, *rowind, *off, *sn_of, *rows, *a2b, *lt2b, *rows_t;
+  T1 *b, *bt, *u, dp, c;
+  // Extract symbolic factorization
+  n = sn[0]; nsn = sn[1]; nnz_a = sn[2]; nnz_lt = sn[3];
+  start = sn+5; rowind = start+nsn+1; off = rowind+nsn+1; sn_of = off+nsn+1;
+  rows = sn_of+n; a2b = rows+rowind[nsn]; lt2b = a2b+nnz_a;
+  // Supernode blocks, followed by an update column
+  b = w; u = w + off[nsn];
+  // Copy the lower triangular part of the permuted A to the blocks
+  for (k=0; k<off[nsn]; ++k) b[k] = 0;
+  for (k=0; k<nnz_a; ++k) if (a2b[k]>=0) b[a2b[k]] = a[k];
+  // Loop over supernodes
+  for (t=0; t<nsn; ++t) {
+    ns = start[t+1]-start[t];
+    m = rowind[t+1]-rowind[t];
+    rows_t = rows+rowind[t];
+    bt = b+off[t];
+    // Dense LDL^T of the block
+    for (p=0; p<ns; ++p) {
+      dp = d[start[t]+p] = bt[p*m+p];
+      for (q=p+1; q<ns; ++q) {
+        c = bt[p*m+q]/dp;
+        for (i=q; i<m; ++i) bt[q*m+i] -= c*bt[p*m+i];
+      }
+      for (i=p+1; i<m; ++i) bt[p*m+i] /= dp;
+    }
+    // Update the ancestors with the rows below the diagonal block
+    s = -1;
+    for (kb=ns; kb<m; ++kb) {
+      k = rows_t[kb];
+      // Local row indices of the target supernode
+      if (sn_of[k]!=s) {
+        s = sn_of[k];
+        for (i=rowind[s]; i<rowind[s+1]; ++i) iw[rows[i]] = i-rowind[s];
+      }
+      // u = L(kb:m-1, :) * D * L(kb, :)'
+      for (i=kb; i<m; ++i) u[i] = 0;
+      for (p=0; p<ns; ++p) {
+        c = bt[p*m+kb]*d[start[t]+p];
+        for (i=kb; i<m; ++i) u[i] += c*bt[p*m+i];
+      }
+      // Subtract from column k of the target
+      j = off[s] + (k-start[s])*(rowind[s+1]-rowind[s]);
+      for (i=kb; i<m; ++i) b[j+iw[rows_t[i]]] -= u[i];
+    }
+  }
+  // Extract the nonzeros of L^T
+  for (k=0; k<nnz_lt; ++k) lt[k] = b[lt2b[k]];
+}
+
 // SYMBOL "ldl_trs"
 // Solve for (I+R) with R an optionally transposed strictly upper triangular matrix.
 template<typename T1>
@@ -107,3 +171,72 @@ void casadi_ldl_solve(T1* x, casadi_int nrhs, const casadi_int* sp_lt, const T1*
     x += n;
   }
 }
+
+// SYMBOL "ldl_trs_block"
+// Solve for (I+R) with R an optionally transposed strictly upper triangular matrix,
+// for nb right-hand-sides interleaved in x, i.e. x[i*nb+j] is row i of rhs j
+template<typename T1>
+void casadi_ldl_trs_block(const casadi_int* sp_r, const T1* nz_r, T1* x, casadi_int nb,
+                          casadi_int tr) {
+  casadi_int ncol, c, k, j;
+  const casadi_int *colind, *row;
+  T1 r, *xc, *xr;
+  // Extract sparsity
+  ncol=sp_r[1];
+  colind=sp_r+2; row=sp_r+2+ncol+1;
+  if (tr) {
+    // Forward substitution
+    for (c=0; c<ncol; ++c) {
+      xc = x + c*nb;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        r = nz_r[k];
+        xr = x + row[k]*nb;
+        for (j=0; j<nb; ++j) xc[j] -= r*xr[j];
+      }
+    }
+  } else {
+    // Backward substitution
+    for (c=ncol-1; c>=0; --c) {
+      xc = x + c*nb;
+      for (k=colind[c+1]-1; k>=colind[c]; --k) {
+        r = nz_r[k];
+        xr = x + row[k]*nb;
+        for (j=0; j<nb; ++j) xr[j] -= r*xc[j];
+      }
+    }
+  }
+}
+
+// SYMBOL "ldl_solve_block"
+// Linear solve using an LDL^T factorized linear system, passing over the factors
+// once for every block of nb right-hand-sides
+// len[w] >= n*nb
+template<typename T1>
+void casadi_ldl_solve_block(T1* x, casadi_int nrhs, const casadi_int* sp_lt, const T1* lt,
+                            const T1* d, const casadi_int* p, T1* w, casadi_int nb) {
+  casadi_int i, j, k, m;
+  casadi_int n = sp_lt[1];
+  for (k=0; k<nrhs; k+=m) {
+    // Number of right-hand-sides in this block
+    m = nrhs - k;
+    if (m>nb) m = nb;
+    // Multiply by P, interleave
+    for (j=0; j<m; ++j) {
+      for (i=0; i<n; ++i) w[i*m+j] = x[j*n+p[i]];
+    }
+    //  Solve for L
+    casadi_ldl_trs_block(sp_lt, lt, w, m, 1);
+    // Divide by D
+    for (i=0; i<n; ++i) {
+      for (j=0; j<m; ++j) w[i*m+j] /= d[i];
+    }
+    // Solve for L'
+    casadi_ldl_trs_block(sp_lt, lt, w, m, 0);
+    // Multiply by P', deinterleave
+    for (j=0; j<m; ++j) {
+      for (i=0; i<n; ++i) x[j*n+p[i]] = w[i*m+j];
+    }
+    // Next block
+    x += m*n;
+  }
+}
@@ -31,6 +31,9 @@ casadi_int casadi_low(T1 x, const T1* grid, casadi_int ng, casadi_int lookup_mod
         ret = (casadi_int) ((x-g0)*(ng-1)/dg); // NOLINT(readability/casting)
         if (ret<0) ret=0;
         if (ret>ng-2) ret=ng-2;
+        // Correct for rounding close to a grid point
+        if (ret<ng-2 && x>=grid[ret+1]) ret++;
+        if (ret>0 && x<grid[ret]) ret--;
         return ret;
       }
     case 2:
@@ -20,6 +20,24 @@
 //    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+// SYMBOL "lsqr_prob"
+template<typename T1>
+struct casadi_lsqr_prob {
+  // Sparsity of A
+  const casadi_int* sp;
+  // LSMR instead of LSQR
+  casadi_int lsmr;
+  // Right preconditioner P, x = P*y, with numerical values pr:
+  // 0: none, 1: inverse column norms of op(A),
+  // 2: inverse of the incomplete Cholesky factor R of op(A)'*op(A), 3: sparse matrix
+  casadi_int prec;
+  // Sparsity of op(A), op(A)'*op(A), its strictly upper triangular LDL' factor and R
+  const casadi_int *sp_b, *sp_btb, *sp_lt, *sp_r;
+  // Sparsity of the preconditioner matrix
+  const casadi_int* sp_p;
+};
+// C-REPLACE "casadi_lsqr_prob<T1>" "struct casadi_lsqr_prob"
+
 // SYMBOL "lsqr_sym_ortho"
 template<typename T1>
 void casadi_lsqr_sym_ortho(T1 a, T1 b, T1* cs, T1* sn, T1* rho) {
@@ -64,10 +82,188 @@ void casadi_lsqr_sym_ortho(T1 a, T1 b, T1* cs, T1* sn, T1* rho) {
 //    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+// SYMBOL "lsqr_prec_setup"
+// Calculate the preconditioner for op(A), if it depends on A only
+// len[pr] >= n for the diagonal, nnz(sp_r) for the incomplete Cholesky preconditioner
+// len[iw] >= n, len[w] >= nnz(A) + nnz(sp_btb) + nnz(sp_lt) + 2*n
+template<typename T1>
+void casadi_lsqr_prec_setup(const casadi_lsqr_prob<T1>* p, const T1* A, casadi_int tr,
+                            T1* pr, casadi_int* iw, T1* w) {
+  casadi_int n, c, r, k, k2;
+  const casadi_int *b_colind, *b_row, *btb_colind, *btb_row, *lt_colind, *lt_row;
+  const T1* b;
+  T1 s, *btb, *lt, *d;
+  if (p->prec!=1 && p->prec!=2) return;
+  n = p->sp[1];
+  b_colind = p->sp_b+2; b_row = p->sp_b+2+n+1;
+  // op(A)
+  if (tr) {
+    casadi_trans(A, p->sp, w, p->sp_b, iw);
+    b = w;
+    w += b_colind[n];
+  } else {
+    b = A;
+  }
+  if (p->prec==1) {
+    // Inverse column norms
+    for (c=0; c<n; ++c) {
+      s = 0;
+      for (k=b_colind[c]; k<b_colind[c+1]; ++k) s += b[k]*b[k];
+      pr[c] = s>0 ? 1/sqrt(s) : 1;
+    }
+    return;
+  }
+  btb_colind = p->sp_btb+2; btb_row = p->sp_btb+2+n+1;
+  lt_colind = p->sp_lt+2; lt_row = p->sp_lt+2+n+1;
+  btb = w; w += btb_colind[n];
+  lt = w; w += lt_colind[n];
+  d = w; w += n;
+  // Gram matrix op(A)'*op(A)
+  casadi_clear(w, n);
+  for (c=0; c<n; ++c) {
+    for (k=b_colind[c]; k<b_colind[c+1]; ++k) w[b_row[k]] = b[k];
+    for (k=btb_colind[c]; k<btb_colind[c+1]; ++k) {
+      r = btb_row[k];
+      s = 0;
+      for (k2=b_colind[r]; k2<b_colind[r+1]; ++k2) s += b[k2]*w[b_row[k2]];
+      btb[k] = s;
+    }
+    for (k=b_colind[c]; k<b_colind[c+1]; ++k) w[b_row[k]] = 0;
+  }
+  // Incomplete LDL', without fill-in
+  for (c=0; c<n; ++c) iw[c] = c;
+  casadi_ldl(p->sp_btb, btb, p->sp_lt, lt, d, iw, w);
+  // Replace breakdowns by positive pivots
+  for (c=0; c<n; ++c) if (d[c]<=0) d[c] = d[c]<0 ? -d[c] : 1;
+  // R = sqrt(D)*(I + L'), the diagonal is the last entry of each column
+  for (c=0; c<n; ++c) {
+    for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) *pr++ = sqrt(d[lt_row[k]])*lt[k];
+    *pr++ = sqrt(d[c]);
+  }
+}
+
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// SYMBOL "lsqr_prec"
+// Apply the preconditioner P, or P' if adj, to v in place
+// len[w] >= n
+template<typename T1>
+void casadi_lsqr_prec(const casadi_lsqr_prob<T1>* p, const T1* pr, T1* v,
+                      casadi_int adj, casadi_int tr, T1* w) {
+  casadi_int n, i;
+  n = p->sp[1];
+  if (p->prec==1) {
+    for (i=0; i<n; ++i) v[i] *= pr[i];
+  } else if (p->prec==2) {
+    casadi_triusolve(p->sp_r, pr, v, adj, 0, 1);
+  } else if (p->prec==3) {
+    // The preconditioner matrix is given for A, its transpose is used for A'
+    casadi_clear(w, n);
+    casadi_mv(pr, p->sp_p, v, w, adj!=tr);
+    casadi_copy(w, n, v);
+  }
+}
+
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// SYMBOL "lsqr_aprod"
+// u += op(A)*P*v, or v += P'*op(A)'*u if adj
+// len[w] >= 2*n
+template<typename T1>
+void casadi_lsqr_aprod(const casadi_lsqr_prob<T1>* p, const T1* A, const T1* pr,
+                       casadi_int adj, casadi_int tr, T1* u, T1* v, T1* w) {
+  casadi_int n, i;
+  T1* t;
+  n = p->sp[1];
+  t = w; w += n;
+  if (adj) {
+    casadi_clear(t, n);
+    casadi_mv(A, p->sp, u, t, !tr);
+    casadi_lsqr_prec(p, pr, t, 1, tr, w);
+    for (i=0; i<n; ++i) v[i] += t[i];
+  } else {
+    casadi_copy(v, n, t);
+    casadi_lsqr_prec(p, pr, t, 0, tr, w);
+    casadi_mv(A, p->sp, t, u, tr);
+  }
+}
+
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// SYMBOL "lsqr_finalize"
+// x = x0 + P*y
+// len[w] >= n
+template<typename T1>
+void casadi_lsqr_finalize(const casadi_lsqr_prob<T1>* p, const T1* pr, T1* x, T1* y,
+                          casadi_int tr, const T1* x0, T1* w) {
+  casadi_int n, i;
+  n = p->sp[1];
+  casadi_lsqr_prec(p, pr, y, 0, tr, w);
+  if (x0) {
+    for (i=0; i<n; ++i) x[i] = x0[i] + y[i];
+  } else {
+    casadi_copy(y, n, x);
+  }
+}
+
 // SYMBOL "lsqr_single_solve"
+// Solve min ||op(A)*P*y - (b - op(A)*x0)||, x = x0 + P*y, with b and x stored in x
 // Ref: scipy
+// len[w] >= m + 6*n
 template<typename T1>
-int casadi_lsqr_single_solve(const T1* A, T1* x, casadi_int tr, const casadi_int* sp, T1* w) {
+int casadi_lsqr_single_solve(const casadi_lsqr_prob<T1>* p, const T1* A, T1* x,
+                             casadi_int tr, const T1* pr, const T1* x0, T1* w) {
     casadi_int m, n, i;
     T1 damp, atol, btol, conlim, ctol, anorm, acond, dampsq, ddnorm, res2, xnorm, xxnorm, z;
     T1 cs2, sn2, alpha, beta, rhobar, phibar, bnorm, rnorm, arnorm, rhobar1, cs1, sn1, psi;
@@ -76,8 +272,8 @@ int casadi_lsqr_single_solve(const T1* A, T1* x, casadi_int tr, const casadi_int
     casadi_int iter_lim, itn, istop;
     T1 *u, *v, *xx, *ww, *dk;
 
-    m = sp[0];
-    n = sp[1];
+    m = p->sp[0];
+    n = p->sp[1];
 
     damp = 0;
     atol = 1e-15;
@@ -104,15 +300,21 @@ int casadi_lsqr_single_solve(const T1* A, T1* x, casadi_int tr, const casadi_int
     u = w;  w+= m; casadi_copy(x, m, u);
     v = w;  w+= n; casadi_clear(v, n);
     xx = w; w+= n; casadi_clear(xx, n);
-    ww = w; w+= n; casadi_clear(v, n);
+    ww = w; w+= n; casadi_clear(ww, n);
     dk = w; w+= n;
 
+    // Residual of the initial guess
+    if (x0) {
+      for (i=0;i<n;++i) dk[i] = -x0[i];
+      casadi_mv(A, p->sp, dk, u, tr);
+    }
+
     alpha = 0;
     beta = casadi_norm_2(m, u);
 
     if (beta>0) {
       for (i=0;i<m;++i) u[i]*=1/beta;
-      casadi_mv(A, sp, u, v, !tr);
+      casadi_lsqr_aprod(p, A, pr, 1, tr, u, v, w);
       alpha = casadi_norm_2(n, v);
     }
 
@@ -128,21 +330,21 @@ int casadi_lsqr_single_solve(const T1* A, T1* x, casadi_int tr, const casadi_int
     arnorm = alpha * beta;
 
     if (arnorm==0.0) {
-      casadi_clear(x, m);
+      casadi_lsqr_finalize(p, pr, x, xx, tr, x0, w);
       return 0;
     }
 
     while (itn<iter_lim) {
       itn++;
       for (i=0;i<m;++i) u[i]*=-alpha;
-      casadi_mv(A, sp, v, u, tr);
+      casadi_lsqr_aprod(p, A, pr, 0, tr, u, v, w);
       beta = casadi_norm_2(m, u);
 
       if (beta>0) {
         for (i=0;i<m;++i) u[i]*=1/beta;
         anorm = sqrt(anorm*anorm + alpha*alpha+beta*beta+damp*damp);
         for (i=0;i<n;++i) v[i]*=-beta;
-        casadi_mv(A, sp, u, v, !tr);
+        casadi_lsqr_aprod(p, A, pr, 1, tr, u, v, w);
         alpha = casadi_norm_2(n, v);
         if (alpha>0) for (i=0;i<n;++i) v[i]*=1/alpha;
       }
@@ -212,7 +414,195 @@ int casadi_lsqr_single_solve(const T1* A, T1* x, casadi_int tr, const casadi_int
       if (istop != 0) break;
 
     }
-    casadi_copy(xx, m, x);
+    casadi_lsqr_finalize(p, pr, x, xx, tr, x0, w);
+    return 0;
+}
+
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// SYMBOL "lsmr_single_solve"
+// LSMR variant of casadi_lsqr_single_solve, monotonically decreasing ||op(A)'*r||
+// Ref: scipy
+// len[w] >= m + 6*n
+template<typename T1>
+int casadi_lsmr_single_solve(const casadi_lsqr_prob<T1>* p, const T1* A, T1* x,
+                             casadi_int tr, const T1* pr, const T1* x0, T1* w) {
+    casadi_int m, n, i, itn, iter_lim, istop;
+    T1 atol, btol, conlim, ctol, alpha, beta, normb, zetabar, alphabar, rho, rhobar, cbar, sbar;
+    T1 betadd, betad, rhodold, tautildeold, thetatilde, zeta, d, normA2, maxrbar, minrbar;
+    T1 normA, condA, normx, normr, normar, chat, shat, alphahat, rhoold, c, s, thetanew;
+    T1 rhobarold, zetaold, thetabar, rhotemp, betaacute, betacheck, betahat, thetatildeold;
+    T1 ctildeold, stildeold, rhotildeold, taud, test1, test2, test3, t1, rtol;
+    T1 *u, *v, *h, *hbar, *xx;
+
+    m = p->sp[0];
+    n = p->sp[1];
+
+    atol = 1e-15;
+    btol = 1e-15;
+    conlim = 1e8;
+    iter_lim = 10000;
+
+    u = w;    w+= m; casadi_copy(x, m, u);
+    v = w;    w+= n; casadi_clear(v, n);
+    h = w;    w+= n;
+    hbar = w; w+= n; casadi_clear(hbar, n);
+    xx = w;   w+= n; casadi_clear(xx, n);
+
+    // Residual of the initial guess
+    if (x0) {
+      for (i=0;i<n;++i) h[i] = -x0[i];
+      casadi_mv(A, p->sp, h, u, tr);
+    }
+
+    alpha = 0;
+    beta = casadi_norm_2(m, u);
+    normb = beta;
+
+    if (beta>0) {
+      for (i=0;i<m;++i) u[i]*=1/beta;
+      casadi_lsqr_aprod(p, A, pr, 1, tr, u, v, w);
+      alpha = casadi_norm_2(n, v);
+    }
+    if (alpha>0) for (i=0;i<n;++i) v[i]*=1/alpha;
+
+    itn = 0;
+    istop = 0;
+    ctol = 0;
+    if (conlim > 0) ctol = 1/conlim;
+    zetabar = alpha*beta;
+    alphabar = alpha;
+    rho = 1;
+    rhobar = 1;
+    cbar = 1;
+    sbar = 0;
+    casadi_copy(v, n, h);
+
+    // Estimation of ||r||
+    betadd = beta;
+    betad = 0;
+    rhodold = 1;
+    tautildeold = 0;
+    thetatilde = 0;
+    zeta = 0;
+    d = 0;
+
+    // Estimation of ||A|| and cond(A)
+    normA2 = alpha*alpha;
+    maxrbar = 0;
+    minrbar = 1e100;
+
+    normar = alpha*beta;
+    if (normar==0) {
+      casadi_lsqr_finalize(p, pr, x, xx, tr, x0, w);
+      return 0;
+    }
+
+    while (itn<iter_lim) {
+      itn++;
+      for (i=0;i<m;++i) u[i]*=-alpha;
+      casadi_lsqr_aprod(p, A, pr, 0, tr, u, v, w);
+      beta = casadi_norm_2(m, u);
+
+      if (beta>0) {
+        for (i=0;i<m;++i) u[i]*=1/beta;
+        for (i=0;i<n;++i) v[i]*=-beta;
+        casadi_lsqr_aprod(p, A, pr, 1, tr, u, v, w);
+        alpha = casadi_norm_2(n, v);
+        if (alpha>0) for (i=0;i<n;++i) v[i]*=1/alpha;
+      }
+
+      // Rotation without damping
+      chat = sign(alphabar);
+      shat = 0;
+      alphahat = fabs(alphabar);
+
+      // Rotation P_k
+      rhoold = rho;
+      casadi_lsqr_sym_ortho(alphahat, beta, &c, &s, &rho);
+      thetanew = s*alpha;
+      alphabar = c*alpha;
+
+      // Rotation Pbar_k
+      rhobarold = rhobar;
+      zetaold = zeta;
+      thetabar = sbar*rho;
+      rhotemp = cbar*rho;
+      casadi_lsqr_sym_ortho(cbar*rho, thetanew, &cbar, &sbar, &rhobar);
+      zeta = cbar*zetabar;
+      zetabar = -sbar*zetabar;
+
+      // Update h, hbar and x
+      t1 = thetabar*rho/(rhoold*rhobarold);
+      for (i=0;i<n;++i) hbar[i] = h[i] - t1*hbar[i];
+      t1 = zeta/(rho*rhobar);
+      for (i=0;i<n;++i) xx[i] += t1*hbar[i];
+      t1 = thetanew/rho;
+      for (i=0;i<n;++i) h[i] = v[i] - t1*h[i];
+
+      // Estimate ||r||
+      betaacute = chat*betadd;
+      betacheck = -shat*betadd;
+      betahat = c*betaacute;
+      betadd = -s*betaacute;
+      thetatildeold = thetatilde;
+      casadi_lsqr_sym_ortho(rhodold, thetabar, &ctildeold, &stildeold, &rhotildeold);
+      thetatilde = stildeold*rhobar;
+      rhodold = ctildeold*rhobar;
+      betad = -stildeold*betad + ctildeold*betahat;
+      tautildeold = (zetaold - thetatildeold*tautildeold)/rhotildeold;
+      taud = (zeta - thetatilde*tautildeold)/rhodold;
+      d += betacheck*betacheck;
+      normr = sqrt(d + (betad-taud)*(betad-taud) + betadd*betadd);
+
+      // Estimate ||A||
+      normA2 += beta*beta;
+      normA = sqrt(normA2);
+      normA2 += alpha*alpha;
+
+      // Estimate cond(A)
+      if (rhobarold>maxrbar) maxrbar = rhobarold;
+      if (itn>1 && rhobarold<minrbar) minrbar = rhobarold;
+      condA = (maxrbar>rhotemp ? maxrbar : rhotemp)/(minrbar<rhotemp ? minrbar : rhotemp);
+
+      // Convergence tests
+      normar = fabs(zetabar);
+      normx = casadi_norm_2(n, xx);
+      test1 = normr/normb;
+      test2 = normA*normr!=0 ? normar/(normA*normr) : 1e100;
+      test3 = 1/condA;
+      t1 = test1/(1 + normA*normx/normb);
+      rtol = btol + atol*normA*normx/normb;
+
+      if (itn >= iter_lim) istop = 7;
+      if (1 + test3 <= 1) istop = 6;
+      if (1 + test2 <= 1) istop = 5;
+      if (1 + t1 <= 1) istop = 4;
+
+      if (test3 <= ctol) istop = 3;
+      if (test2 <= atol) istop = 2;
+      if (test1 <= rtol) istop = 1;
+
+      if (istop != 0) break;
+    }
+    casadi_lsqr_finalize(p, pr, x, xx, tr, x0, w);
     return 0;
 }
 
@@ -236,12 +626,19 @@ int casadi_lsqr_single_solve(const T1* A, T1* x, casadi_int tr, const casadi_int
 //
 
 // SYMBOL "lsqr_solve"
+// x0 holds an initial guess for each right-hand-side, or is null
+// len[w] >= m + 6*n
 template<typename T1>
-int casadi_lsqr_solve(const T1* A, T1* x, casadi_int nrhs, casadi_int tr,
-        const casadi_int* sp, T1* w) {
-    casadi_int i;
+int casadi_lsqr_solve(const casadi_lsqr_prob<T1>* p, const T1* A, T1* x, casadi_int nrhs,
+                      casadi_int tr, const T1* pr, const T1* x0, T1* w) {
+    casadi_int i, n;
+    n = p->sp[1];
     for (i=0; i<nrhs;++i) {
-      if (casadi_lsqr_single_solve(A, x+i*sp[1], tr, sp, w)) return 1;
+      if (p->lsmr) {
+        if (casadi_lsmr_single_solve(p, A, x+i*n, tr, pr, x0 ? x0+i*n : 0, w)) return 1;
+      } else {
+        if (casadi_lsqr_single_solve(p, A, x+i*n, tr, pr, x0 ? x0+i*n : 0, w)) return 1;
+      }
     }
     return 0;
 }
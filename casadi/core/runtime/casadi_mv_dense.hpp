@@ -22,12 +22,29 @@ template<typename T1>
 void casadi_mv_dense(const T1* x, casadi_int nrow_x, casadi_int ncol_x,
     const T1* y, T1* z, casadi_int tr) {
   casadi_int i, j;
+#ifdef CASADI_SIMD
+  T1 r0, r1, r2, r3;
+#endif
   if (!x || !y || !z) return;
   if (tr) {
     for (i=0; i<ncol_x; ++i) {
+#ifdef CASADI_SIMD
+      /* Independent partial sums, cf. casadi_dot */
+      r0 = r1 = r2 = r3 = 0;
+      for (j=0; j+3<nrow_x; j+=4) {
+        r0 += x[j]*y[j];
+        r1 += x[j+1]*y[j+1];
+        r2 += x[j+2]*y[j+2];
+        r3 += x[j+3]*y[j+3];
+      }
+      for (; j<nrow_x; ++j) r0 += x[j]*y[j];
+      z[i] += (r0 + r1) + (r2 + r3);
+      x += nrow_x;
+#else
       for (j=0; j<nrow_x; ++j) {
         z[i] += *x++ * y[j];
       }
+#endif
     }
   } else {
     for (i=0; i<ncol_x; ++i) {
@@ -17,20 +17,22 @@
 //    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
-// SYMBOL "nd_boor_eval"
+// SYMBOL "nd_boor_accumulate"
+// Accumulate the coefficients weighted with the tensor product of de Boor vectors
+//
+// starts[k*stride] and all_boor[(boor_offset[k]+i)*stride], boor_offset[k] the sum of
+// all_degree[j]+1 for j<k, are the start index and the i-th de Boor value in dimension k
 template<typename T1>
-void casadi_nd_boor_eval(T1* ret, casadi_int n_dims, const T1* all_knots, const casadi_int* offset, const casadi_int* all_degree, const casadi_int* strides, const T1* c, casadi_int m, const T1* all_x, const casadi_int* lookup_mode, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
+void casadi_nd_boor_accumulate(T1* ret, casadi_int n_dims, const casadi_int* all_degree, const casadi_int* strides, const T1* c, casadi_int m, const casadi_int* starts, const T1* all_boor, casadi_int stride, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
   casadi_int n_iter, k, i, pivot;
-  casadi_int *boor_offset, *starts, *index, *coeff_offset;
-  T1 *cumprod, *all_boor;
+  casadi_int *boor_offset, *index, *coeff_offset;
+  T1 *cumprod;
 
   boor_offset = iw; iw+=n_dims+1;
-  starts = iw; iw+=n_dims;
   index = iw; iw+=n_dims;
   coeff_offset = iw;
 
-  cumprod = w; w+= n_dims+1;
-  all_boor = w;
+  cumprod = w;
 
   boor_offset[0] = 0;
   cumprod[n_dims] = 1;
@@ -38,11 +40,72 @@ void casadi_nd_boor_eval(T1* ret, casadi_int n_dims, const T1* all_knots, const
 
   n_iter = 1;
   for (k=0;k<n_dims;++k) {
-    T1 *boor;
+    n_iter*= all_degree[k]+1;
+    boor_offset[k+1] = boor_offset[k] + all_degree[k]+1;
+  }
+
+  casadi_clear_casadi_int(index, n_dims);
+
+  // Prepare cumulative product
+  for (pivot=n_dims-1;pivot>=0;--pivot) {
+    cumprod[pivot] = all_boor[boor_offset[pivot]*stride]*cumprod[pivot+1];
+    coeff_offset[pivot] = starts[pivot*stride]*strides[pivot]+coeff_offset[pivot+1];
+  }
+
+  for (k=0;k<n_iter;++k) {
+    casadi_int pivot = 0;
+    // accumulate result
+    for (i=0;i<m;++i) ret[i] += c[coeff_offset[0]+i]*cumprod[0];
+
+    // Increment index
+    index[0]++;
+
+    // Handle index overflow
+    {
+      // increment next index (forward)
+      while (index[pivot]==boor_offset[pivot+1]-boor_offset[pivot]) {
+        index[pivot] = 0;
+        if (pivot==n_dims-1) break;
+        index[++pivot]++;
+      }
+
+      // update cumulative structures (reverse)
+      while (pivot>0) {
+        // Compute product
+        cumprod[pivot] = all_boor[(boor_offset[pivot]+index[pivot])*stride]*cumprod[pivot+1];
+        // Compute offset
+        coeff_offset[pivot] = (starts[pivot*stride]+index[pivot])*strides[pivot]
+          +coeff_offset[pivot+1];
+        pivot--;
+      }
+    }
+
+    // Compute product
+    cumprod[0] = all_boor[index[0]*stride]*cumprod[1];
+
+    // Compute offset
+    coeff_offset[0] = (starts[0]+index[0])*m+coeff_offset[1];
+
+  }
+}
+
+// SYMBOL "nd_boor_eval"
+template<typename T1>
+void casadi_nd_boor_eval(T1* ret, casadi_int n_dims, const T1* all_knots, const casadi_int* offset, const casadi_int* all_degree, const casadi_int* strides, const T1* c, casadi_int m, const T1* all_x, const casadi_int* lookup_mode, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
+  casadi_int k;
+  casadi_int *starts;
+  T1 *all_boor, *boor;
+
+  starts = iw; iw+=n_dims;
+
+  // Cumulative products of casadi_nd_boor_accumulate first
+  all_boor = w+n_dims+1;
+
+  boor = all_boor;
+  for (k=0;k<n_dims;++k) {
     const T1* knots;
     T1 x;
     casadi_int degree, n_knots, n_b, L, start;
-    boor = all_boor+boor_offset[k];
 
     degree = all_degree[k];
     knots = all_knots + offset[k];
@@ -71,50 +134,117 @@ void casadi_nd_boor_eval(T1* ret, casadi_int n_dims, const T1* all_knots, const
     }
     casadi_de_boor(x, knots+start, 2*degree+2, degree, boor);
     boor+= degree+1;
-    n_iter*= degree+1;
-    boor_offset[k+1] = boor_offset[k] + degree+1;
   }
 
-  casadi_clear_casadi_int(index, n_dims);
+  casadi_nd_boor_accumulate(ret, n_dims, all_degree, strides, c, m, starts, all_boor, 1, iw, w);
+}
 
-  // Prepare cumulative product
-  for (pivot=n_dims-1;pivot>=0;--pivot) {
-    cumprod[pivot] = (*(all_boor+boor_offset[pivot]))*cumprod[pivot+1];
-    coeff_offset[pivot] = starts[pivot]*strides[pivot]+coeff_offset[pivot+1];
+// SYMBOL "nd_boor_eval_batch"
+// Evaluate at the n_x points stored as columns of all_x, ret is m-by-n_x
+//
+// Points are processed in chunks of n_chunk. The knot span of the previous point is
+// tried first, amortizing the search for sorted queries, and the de Boor recursion
+// runs over the points of a chunk in the innermost loop, without branches.
+template<typename T1>
+void casadi_nd_boor_eval_batch(T1* ret, casadi_int n_dims, const T1* all_knots, const casadi_int* offset, const casadi_int* all_degree, const casadi_int* strides, const T1* c, casadi_int m, const T1* all_x, casadi_int n_x, casadi_int n_chunk, const casadi_int* lookup_mode, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
+  casadi_int k, p, p0, n_p, i, d, max_degree, n_boor, boor_offset;
+  casadi_int *starts, *spans;
+  T1 *all_boor, *kn, *boor, *xs;
+  T1 bottom0, bottom1;
+
+  max_degree = 0;
+  n_boor = 0;
+  for (k=0;k<n_dims;++k) {
+    if (all_degree[k]>max_degree) max_degree = all_degree[k];
+    n_boor+= all_degree[k]+1;
   }
 
-  for (k=0;k<n_iter;++k) {
-    casadi_int pivot = 0;
-    // accumulate result
-    for (i=0;i<m;++i) ret[i] += c[coeff_offset[0]+i]*cumprod[0];
-
-    // Increment index
-    index[0]++;
-
-    // Handle index overflow
-    {
-      // increment next index (forward)
-      while (index[pivot]==boor_offset[pivot+1]-boor_offset[pivot]) {
-        index[pivot] = 0;
-        if (pivot==n_dims-1) break;
-        index[++pivot]++;
+  starts = iw; iw+= n_dims*n_chunk;
+  spans = iw; iw+= n_dims;
+
+  all_boor = w; w+= n_boor*n_chunk;
+  kn = w; w+= (2*max_degree+2)*n_chunk;
+  boor = w; w+= (2*max_degree+1)*n_chunk;
+  xs = w; w+= n_chunk;
+
+  casadi_fill_casadi_int(spans, n_dims, -1);
+
+  for (p0=0;p0<n_x;p0+=n_chunk) {
+    n_p = n_x-p0;
+    if (n_p>n_chunk) n_p = n_chunk;
+
+    boor_offset = 0;
+    for (k=0;k<n_dims;++k) {
+      const T1* knots;
+      const T1* grid;
+      T1 x;
+      casadi_int degree, n_knots, n_b, ng, L, start;
+
+      degree = all_degree[k];
+      knots = all_knots + offset[k];
+      n_knots = offset[k+1]-offset[k];
+      n_b = n_knots-degree-1;
+      grid = knots+degree;
+      ng = n_knots-2*degree;
+
+      // Knot spans and initial de Boor vectors
+      for (p=0;p<n_p;++p) {
+        x = all_x[(p0+p)*n_dims+k];
+        xs[p] = x;
+        L = spans[k];
+        if (!(L>=0 && (L==0 || x>=grid[L]) && (L==ng-2 || x<grid[L+1]))) {
+          L = casadi_low(x, grid, ng, lookup_mode[k]);
+        }
+        spans[k] = L;
+
+        start = L;
+        if (start>n_b-degree-1) start = n_b-degree-1;
+        starts[k*n_chunk+p] = start;
+
+        for (i=0;i<2*degree+2;++i) kn[i*n_chunk+p] = knots[start+i];
+        for (i=0;i<2*degree+1;++i) boor[i*n_chunk+p] = 0;
+        if (x>=knots[0] && x<=knots[n_knots-1]) {
+          if (x==knots[1]) {
+            for (i=0;i<degree+1;++i) boor[i*n_chunk+p] = 1;
+          } else if (x==knots[n_knots-1]) {
+            boor[degree*n_chunk+p] = 1;
+          } else if (knots[L+degree]==x) {
+            boor[(degree-1)*n_chunk+p] = 1;
+          } else {
+            boor[degree*n_chunk+p] = 1;
+          }
+        }
       }
 
-      // update cumulative structures (reverse)
-      while (pivot>0) {
-        // Compute product
-        cumprod[pivot] = (*(all_boor+boor_offset[pivot]+index[pivot]))*cumprod[pivot+1];
-        // Compute offset
-        coeff_offset[pivot] = (starts[pivot]+index[pivot])*strides[pivot]+coeff_offset[pivot+1];
-        pivot--;
+      // De Boor recursion, zero denominators contributing nothing
+      for (d=1;d<degree+1;++d) {
+        for (i=0;i<2*degree+1-d;++i) {
+          T1 *b0, *b1;
+          const T1 *k0, *k1, *kd0, *kd1;
+          b0 = boor+i*n_chunk;
+          b1 = b0+n_chunk;
+          k0 = kn+i*n_chunk;
+          k1 = k0+n_chunk;
+          kd0 = kn+(i+d)*n_chunk;
+          kd1 = kd0+n_chunk;
+          for (p=0;p<n_p;++p) {
+            bottom0 = kd0[p]-k0[p];
+            bottom1 = kd1[p]-k1[p];
+            b0[p] = (xs[p]-k0[p])*b0[p]*(bottom0!=0)/(bottom0+(bottom0==0))
+              + (kd1[p]-xs[p])*b1[p]*(bottom1!=0)/(bottom1+(bottom1==0));
+          }
+        }
       }
+      for (i=0;i<degree+1;++i) {
+        for (p=0;p<n_p;++p) all_boor[(boor_offset+i)*n_chunk+p] = boor[i*n_chunk+p];
+      }
+      boor_offset+= degree+1;
     }
 
-    // Compute product
-    cumprod[0] = (*(all_boor+index[0]))*cumprod[1];
-
-    // Compute offset
-    coeff_offset[0] = (starts[0]+index[0])*m+coeff_offset[1];
-
+    // Tensor product contributions
+    for (p=0;p<n_p;++p) {
+      casadi_nd_boor_accumulate(ret+(p0+p)*m, n_dims, all_degree, strides, c, m,
+        starts+p, all_boor+p, n_chunk, iw, w);
+    }
   }
 }
@@ -41,6 +41,23 @@ struct casadi_newton_mem {
 };
 
 // C-REPLACE "casadi_newton_mem<T1>" "struct casadi_newton_mem"
+// SYMBOL "newton_step"
+template<typename T1>
+int casadi_newton_step(const casadi_newton_mem<T1>* m) {
+    // Solve J^(-1) g, with the factorization of J in m
+    casadi_qr_solve(m->g, 1, 0, m->sp_v, m->lin_v, m->sp_r, m->lin_r, m->lin_beta,
+                    m->prinv, m->pc, m->lin_w);
+
+    // Update Xk+1 = Xk - J^(-1) g
+    casadi_axpy(m->n, -1., m->g, m->x);
+
+    // Check tolerance on step
+    if (m->abstol_step>0 && casadi_norm_inf(m->n, m->g) <= m->abstol_step) return 2;
+
+    // We will need another newton step
+    return 0;
+}
+
 // SYMBOL "newton"
 template<typename T1>
 int casadi_newton(const casadi_newton_mem<T1>* m) {
@@ -51,16 +68,16 @@ int casadi_newton(const casadi_newton_mem<T1>* m) {
     casadi_qr(m->sp_a, m->jac_g_x, m->lin_w,
               m->sp_v,  m->lin_v, m->sp_r, m->lin_r, m->lin_beta,
               m->prinv, m->pc);
-    // Solve J^(-1) g
-    casadi_qr_solve(m->g, 1, 0, m->sp_v, m->lin_v, m->sp_r, m->lin_r, m->lin_beta,
-                    m->prinv, m->pc, m->lin_w);
 
-    // Update Xk+1 = Xk - J^(-1) g
-    casadi_axpy(m->n, -1., m->g, m->x);
+    return casadi_newton_step(m);
+}
 
-    // Check tolerance on step
-    if (m->abstol_step>0 && casadi_norm_inf(m->n, m->g) <= m->abstol_step) return 2;
+// SYMBOL "newton_reuse"
+template<typename T1>
+int casadi_newton_reuse(const casadi_newton_mem<T1>* m) {
+    // Check tolerance on residual
+    if (m->abstol>0 && casadi_norm_inf(m->n, m->g) <= m->abstol) return 1;
 
-    // We will need another newton step
-    return 0;
+    // Simplified Newton step, with the factorization of a previous iteration
+    return casadi_newton_step(m);
 }
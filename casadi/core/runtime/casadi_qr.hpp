@@ -233,6 +233,7 @@ void casadi_qr_colcomb(T1* v, const T1* nz_r, const casadi_int* sp_r,
                        const casadi_int* pc, T1 eps, casadi_int ind) {
   // Local variables
   casadi_int ncol, r, c, k;
+  T1 s;
   const casadi_int *r_colind, *r_row;
   // Extract sparsity
   ncol = sp_r[1];
@@ -268,5 +269,141 @@ void casadi_qr_colcomb(T1* v, const T1* nz_r, const casadi_int* sp_r,
     }
   }
   // Normalize v
-  casadi_scal(ncol, 1./sqrt(casadi_dot(ncol, v, v)), v);
+  s = 1./sqrt(casadi_dot(ncol, v, v));
+  casadi_scal(ncol, s, v);
+}
+
+// SYMBOL "qr_mv_block"
+// Multiply QR Q matrix from the right with nb vectors interleaved in x,
+// i.e. x[i*nb+j] is row i of vector j, cf. casadi_qr_mv
+// len[x] >= nrow_ext*nb, len[alpha] >= nb
+template<typename T1>
+void casadi_qr_mv_block(const casadi_int* sp_v, const T1* v, const T1* beta, T1* x,
+                        casadi_int nb, casadi_int tr, T1* alpha) {
+  // Local variables
+  casadi_int ncol, c, c1, k, j;
+  T1 vk, *xr;
+  const casadi_int *colind, *row;
+  // Extract sparsity
+  ncol=sp_v[1];
+  colind=sp_v+2; row=sp_v+2+ncol+1;
+  // Loop over vectors
+  for (c1=0; c1<ncol; ++c1) {
+    // Forward order for transpose, otherwise backwards
+    c = tr ? c1 : ncol-1-c1;
+    // Calculate scalar factors alpha = beta(c)*dot(v(:,c), x)
+    for (j=0; j<nb; ++j) alpha[j] = 0;
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      vk = v[k];
+      xr = x + row[k]*nb;
+      for (j=0; j<nb; ++j) alpha[j] += vk*xr[j];
+    }
+    for (j=0; j<nb; ++j) alpha[j] *= beta[c];
+    // x -= alpha*v(:,c)
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      vk = v[k];
+      xr = x + row[k]*nb;
+      for (j=0; j<nb; ++j) xr[j] -= alpha[j]*vk;
+    }
+  }
+}
+
+// SYMBOL "qr_trs_block"
+// Solve for an (optionally transposed) upper triangular matrix R,
+// for nb right-hand-sides interleaved in x, cf. casadi_qr_trs
+template<typename T1>
+void casadi_qr_trs_block(const casadi_int* sp_r, const T1* nz_r, T1* x, casadi_int nb,
+                         casadi_int tr) {
+  // Local variables
+  casadi_int ncol, r, c, k, j;
+  T1 rk, *xr, *xc;
+  const casadi_int *colind, *row;
+  // Extract sparsity
+  ncol=sp_r[1];
+  colind=sp_r+2; row=sp_r+2+ncol+1;
+  if (tr) {
+    // Forward substitution
+    for (c=0; c<ncol; ++c) {
+      xc = x + c*nb;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        r = row[k];
+        rk = nz_r[k];
+        if (r==c) {
+          for (j=0; j<nb; ++j) xc[j] /= rk;
+        } else {
+          xr = x + r*nb;
+          for (j=0; j<nb; ++j) xc[j] -= rk*xr[j];
+        }
+      }
+    }
+  } else {
+    // Backward substitution
+    for (c=ncol-1; c>=0; --c) {
+      xc = x + c*nb;
+      for (k=colind[c+1]-1; k>=colind[c]; --k) {
+        r = row[k];
+        rk = nz_r[k];
+        xr = x + r*nb;
+        if (r==c) {
+          for (j=0; j<nb; ++j) xr[j] /= rk;
+        } else {
+          for (j=0; j<nb; ++j) xr[j] -= rk*xc[j];
+        }
+      }
+    }
+  }
+}
+
+// SYMBOL "qr_solve_block"
+// Solve a factorized linear system, passing over the factors once for every
+// block of nb right-hand-sides, cf. casadi_qr_solve
+// len[w] >= (max(ncol, nrow_ext)+1)*nb
+template<typename T1>
+void casadi_qr_solve_block(T1* x, casadi_int nrhs, casadi_int tr,
+                           const casadi_int* sp_v, const T1* v, const casadi_int* sp_r,
+                           const T1* r, const T1* beta, const casadi_int* prinv,
+                           const casadi_int* pc, T1* w, casadi_int nb) {
+  casadi_int k, m, c, j, nrow_ext, ncol;
+  T1* alpha;
+  nrow_ext = sp_v[0]; ncol = sp_v[1];
+  // Work vector for the Householder scalings, after the interleaved vectors
+  alpha = w + (nrow_ext>ncol ? nrow_ext : ncol)*nb;
+  for (k=0; k<nrhs; k+=m) {
+    // Number of right-hand-sides in this block
+    m = nrhs - k;
+    if (m>nb) m = nb;
+    if (tr) {
+      // (PR' Q R PC)' x = PC' R' Q' PR x = b <-> x = PR' Q R' \ PC b
+      // Multiply by PC
+      for (c=0; c<nrow_ext*m; ++c) w[c] = 0;
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) w[c*m+j] = x[j*ncol+pc[c]];
+      }
+      //  Solve for R'
+      casadi_qr_trs_block(sp_r, r, w, m, 1);
+      // Multiply by Q
+      casadi_qr_mv_block(sp_v, v, beta, w, m, 0, alpha);
+      // Multiply by PR'
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) x[j*ncol+c] = w[prinv[c]*m+j];
+      }
+    } else {
+      //PR' Q R PC x = b <-> x = PC' R \ Q' PR b
+      // Multiply with PR
+      for (c=0; c<nrow_ext*m; ++c) w[c] = 0;
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) w[prinv[c]*m+j] = x[j*ncol+c];
+      }
+      // Multiply with Q'
+      casadi_qr_mv_block(sp_v, v, beta, w, m, 1, alpha);
+      //  Solve for R
+      casadi_qr_trs_block(sp_r, r, w, m, 0);
+      // Multiply with PC'
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) x[j*ncol+pc[c]] = w[c*m+j];
+      }
+    }
+    // Next block
+    x += m*ncol;
+  }
 }
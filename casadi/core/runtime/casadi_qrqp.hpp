@@ -45,6 +45,8 @@ struct casadi_qrqp_prob {
   casadi_int max_iter;
   // Primal and dual error tolerance
   T1 constr_viol_tol, dual_inf_tol;
+  // Maximum number of active-set changes handled by factorization updates
+  casadi_int max_up;
 };
 // C-REPLACE "casadi_qrqp_prob<T1>" "struct casadi_qrqp_prob"
 
@@ -57,6 +59,7 @@ void casadi_qrqp_setup(casadi_qrqp_prob<T1>* p) {
   p->max_iter = 1000;
   p->constr_viol_tol = 1e-8;
   p->dual_inf_tol = 1e-8;
+  p->max_up = 0;
 }
 
 // SYMBOL "qrqp_flag_t"
@@ -105,6 +108,14 @@ struct casadi_qrqp_data {
   casadi_int r_index, r_sign;
   // Iteration
   casadi_int iter;
+  // Number of QR factorizations
+  casadi_int n_fact;
+  // Factorization updates: number of changed columns (-1 if no valid factorization),
+  // changed columns, active set of the factorized matrix, pivoting
+  casadi_int n_up, *up_ind, *up_act, *up_piv;
+  // Factorization updates: solves with changed columns, unit vectors,
+  // LU-factorized capacitance matrix, temporary vector
+  T1 *up_w, *up_z, *up_c, *up_t;
 };
 // C-REPLACE "casadi_qrqp_data<T1>" "struct casadi_qrqp_data"
 
@@ -143,6 +154,11 @@ void casadi_qrqp_work(const casadi_qrqp_prob<T1>* p, casadi_int* sz_arg, casadi_
   *sz_iw += p->qp->nz; // neverupper
   *sz_iw += p->qp->nz; // neverlower
   *sz_iw += p->qp->nz; // lincomb
+  *sz_w += 2 * p->qp->nz * p->max_up; // up_w, up_z
+  *sz_w += p->max_up * p->max_up; // up_c
+  *sz_w += p->max_up; // up_t
+  *sz_iw += p->qp->nz; // up_act
+  *sz_iw += 2 * p->max_up; // up_ind, up_piv
 }
 
 // SYMBOL "qrqp_init"
@@ -173,6 +189,14 @@ void casadi_qrqp_init(casadi_qrqp_data<T1>* d, casadi_int** iw, T1** w) {
   d->neverupper = *iw; *iw += p->qp->nz;
   d->neverlower = *iw; *iw += p->qp->nz;
   d->lincomb = *iw; *iw += p->qp->nz;
+  d->up_w = *w; *w += p->qp->nz * p->max_up;
+  d->up_z = *w; *w += p->qp->nz * p->max_up;
+  d->up_c = *w; *w += p->max_up * p->max_up;
+  d->up_t = *w; *w += p->max_up;
+  d->up_act = *iw; *iw += p->qp->nz;
+  d->up_ind = *iw; *iw += p->max_up;
+  d->up_piv = *iw; *iw += p->max_up;
+  d->n_up = -1;
   d->w = *w;
   d->iw = *iw;
 
@@ -218,6 +242,7 @@ int casadi_qrqp_reset(casadi_qrqp_data<T1>* d) {
   d->r_sign = 0;
   // Reset iteration counter
   d->iter = 0;
+  d->n_fact = 0;
   return 0;
 }
 
@@ -669,6 +694,174 @@ void casadi_qrqp_take_step(casadi_qrqp_data<T1>* d) {
   }
 }
 
+// SYMBOL "qrqp_lu"
+// Dense LU factorization with partial pivoting, returns the smallest pivot
+template<typename T1>
+T1 casadi_qrqp_lu(T1* c, casadi_int n, casadi_int* piv) {
+  // Local variables
+  casadi_int i, j, k, ip;
+  T1 t, pmin;
+  pmin = std::numeric_limits<T1>::infinity();
+  for (k=0; k<n; ++k) {
+    // Find pivot
+    ip = k;
+    for (i=k+1; i<n; ++i) if (fabs(c[i+k*n]) > fabs(c[ip+k*n])) ip = i;
+    piv[k] = ip;
+    // Swap rows
+    if (ip != k) {
+      for (j=0; j<n; ++j) {
+        t = c[k+j*n];
+        c[k+j*n] = c[ip+j*n];
+        c[ip+j*n] = t;
+      }
+    }
+    pmin = fmin(pmin, fabs(c[k+k*n]));
+    if (c[k+k*n] == 0) return 0;
+    // Eliminate below the pivot
+    for (i=k+1; i<n; ++i) c[i+k*n] /= c[k+k*n];
+    for (j=k+1; j<n; ++j) {
+      for (i=k+1; i<n; ++i) c[i+j*n] -= c[i+k*n] * c[k+j*n];
+    }
+  }
+  return pmin;
+}
+
+// SYMBOL "qrqp_lu_solve"
+// Solve with a dense LU factorization, transposed if tr
+template<typename T1>
+void casadi_qrqp_lu_solve(const T1* c, casadi_int n, const casadi_int* piv, T1* x,
+    casadi_int tr) {
+  // Local variables
+  casadi_int i, j, k;
+  T1 t;
+  if (tr) {
+    // Solve with U'
+    for (j=0; j<n; ++j) {
+      for (i=0; i<j; ++i) x[j] -= c[i+j*n] * x[i];
+      x[j] /= c[j+j*n];
+    }
+    // Solve with L'
+    for (j=n-1; j>=0; --j) {
+      for (i=j+1; i<n; ++i) x[j] -= c[i+j*n] * x[i];
+    }
+    // Undo row permutation
+    for (k=n-1; k>=0; --k) {
+      t = x[k];
+      x[k] = x[piv[k]];
+      x[piv[k]] = t;
+    }
+  } else {
+    // Row permutation
+    for (k=0; k<n; ++k) {
+      t = x[k];
+      x[k] = x[piv[k]];
+      x[piv[k]] = t;
+    }
+    // Solve with L
+    for (j=0; j<n; ++j) {
+      for (i=j+1; i<n; ++i) x[i] -= c[i+j*n] * x[j];
+    }
+    // Solve with U
+    for (j=n-1; j>=0; --j) {
+      x[j] /= c[j+j*n];
+      for (i=0; i<j; ++i) x[i] -= c[i+j*n] * x[j];
+    }
+  }
+}
+
+// SYMBOL "qrqp_solve"
+// Solve with the (updated) KKT factorization, transposed if tr
+template<typename T1>
+void casadi_qrqp_solve(casadi_qrqp_data<T1>* d, T1* x, casadi_int tr) {
+  // Local variables
+  casadi_int k, i;
+  const casadi_qrqp_prob<T1>* p = d->prob;
+  // Solve with the factorized matrix M0
+  casadi_qr_solve(x, 1, tr, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
+    p->prinv, p->pc, d->w);
+  if (d->n_up <= 0) return;
+  // Woodbury correction for the changed columns, M = M0 + U*E'
+  if (tr) {
+    // x := x - Z * C'\(U'*x), with U(:,k) = -s*kkt_vector
+    for (k=0; k<d->n_up; ++k) {
+      i = d->up_ind[k];
+      d->up_t[k] = d->up_act[i] ? -casadi_qrqp_kkt_dot(d, x, i) : casadi_qrqp_kkt_dot(d, x, i);
+    }
+    casadi_qrqp_lu_solve(d->up_c, d->n_up, d->up_piv, d->up_t, 1);
+    for (k=0; k<d->n_up; ++k) casadi_axpy(p->qp->nz, -d->up_t[k], d->up_z + k*p->qp->nz, x);
+  } else {
+    // x := x - W * C\(E'*x)
+    for (k=0; k<d->n_up; ++k) d->up_t[k] = x[d->up_ind[k]];
+    casadi_qrqp_lu_solve(d->up_c, d->n_up, d->up_piv, d->up_t, 0);
+    for (k=0; k<d->n_up; ++k) casadi_axpy(p->qp->nz, -d->up_t[k], d->up_w + k*p->qp->nz, x);
+  }
+}
+
+// SYMBOL "qrqp_update"
+// Update the factorization for columns that changed since it was formed, 1 if not possible
+template<typename T1>
+int casadi_qrqp_update(casadi_qrqp_data<T1>* d) {
+  // Local variables
+  casadi_int i, j, k, n_up, n_kept, nz;
+  T1* wk;
+  const casadi_qrqp_prob<T1>* p = d->prob;
+  nz = p->qp->nz;
+  if (d->n_up < 0) return 1;
+  // Keep the changed columns that are still changed
+  n_up = 0;
+  for (k=0; k<d->n_up; ++k) {
+    i = d->up_ind[k];
+    if ((d->lam[i] != 0.) != d->up_act[i]) {
+      if (n_up < k) {
+        d->up_ind[n_up] = i;
+        casadi_copy(d->up_w + k*nz, nz, d->up_w + n_up*nz);
+        casadi_copy(d->up_z + k*nz, nz, d->up_z + n_up*nz);
+      }
+      n_up++;
+    }
+  }
+  // Add columns that changed since the last call
+  n_kept = n_up;
+  for (i=0; i<nz; ++i) {
+    if ((d->lam[i] != 0.) == d->up_act[i]) continue;
+    // Already handled?
+    for (k=0; k<n_kept; ++k) if (d->up_ind[k] == i) break;
+    if (k < n_kept) continue;
+    // Too many changes, refactorize
+    if (n_up == p->max_up) {
+      d->n_up = -1;
+      return 1;
+    }
+    d->up_ind[n_up] = i;
+    // W(:,k) = M0\U(:,k), where U(:,k) is the new minus the factorized column
+    wk = d->up_w + n_up*nz;
+    casadi_qrqp_kkt_vector(d, wk, i);
+    if (!d->up_act[i]) casadi_scal(nz, -1., wk);
+    casadi_qr_solve(wk, 1, 0, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
+      p->prinv, p->pc, d->w);
+    // Z(:,k) = M0'\e_i
+    wk = d->up_z + n_up*nz;
+    casadi_clear(wk, nz);
+    wk[i] = 1.;
+    casadi_qr_solve(wk, 1, 1, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
+      p->prinv, p->pc, d->w);
+    n_up++;
+  }
+  d->n_up = n_up;
+  if (n_up == 0) return 0;
+  // Capacitance matrix C = I + E'*W
+  for (j=0; j<n_up; ++j) {
+    for (k=0; k<n_up; ++k) d->up_c[k+j*n_up] = d->up_w[d->up_ind[k] + j*nz];
+    d->up_c[j+j*n_up] += 1.;
+  }
+  // Refactorize if (close to) singular
+  if (casadi_qrqp_lu(d->up_c, n_up, d->up_piv) < 1e-12) {
+    d->n_up = -1;
+    return 1;
+  }
+  return 0;
+}
+
 // SYMBOL "qrqp_flip_check"
 template<typename T1>
 int casadi_qrqp_flip_check(casadi_qrqp_data<T1>* d) {
@@ -678,15 +871,13 @@ int casadi_qrqp_flip_check(casadi_qrqp_data<T1>* d) {
   // Calculate the difference between old and new column index
   if (d->sign == 0) casadi_scal(p->qp->nz, -1., d->dlam);
   // Try to find a linear combination of the new columns
-  casadi_qr_solve(d->dlam, 1, 0, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
-    p->prinv, p->pc, d->w);
+  casadi_qrqp_solve(d, d->dlam, 0);
   // If dlam[index]!=1, new columns must be linearly independent
   if (fabs(d->dlam[d->index]-1.) >= 1e-12) return 0;
   // Next, find a linear combination of the new rows
   casadi_clear(d->dz, p->qp->nz);
   d->dz[d->index] = 1;
-  casadi_qr_solve(d->dz, 1, 1, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
-    p->prinv, p->pc, d->w);
+  casadi_qrqp_solve(d, d->dz, 1);
   // Normalize dlam, dz
   casadi_scal(p->qp->nz, 1./sqrt(casadi_dot(p->qp->nz, d->dlam, d->dlam)), d->dlam);
   casadi_scal(p->qp->nz, 1./sqrt(casadi_dot(p->qp->nz, d->dz, d->dz)), d->dz);
@@ -697,6 +888,8 @@ int casadi_qrqp_flip_check(casadi_qrqp_data<T1>* d) {
 // SYMBOL "qrqp_factorize"
 template<typename T1>
 void casadi_qrqp_factorize(casadi_qrqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
   const casadi_qrqp_prob<T1>* p = d->prob;
   // Do we already have a search direction due to lost singularity?
   if (d->has_search_dir) {
@@ -705,11 +898,22 @@ void casadi_qrqp_factorize(casadi_qrqp_data<T1>* d) {
   }
   // Construct the KKT matrix
   casadi_qrqp_kkt(d);
+  // Update the existing factorization, if possible
+  if (p->max_up > 0 && casadi_qrqp_update(d) == 0) {
+    d->sing = 0;
+    return;
+  }
   // QR factorization
   casadi_qr(p->sp_kkt, d->nz_kkt, d->w, p->sp_v, d->nz_v, p->sp_r,
             d->nz_r, d->beta, p->prinv, p->pc);
+  d->n_fact++;
   // Check singularity
   d->sing = casadi_qr_singular(&d->mina, &d->imina, d->nz_r, p->sp_r, p->pc, 1e-12);
+  // Starting point for factorization updates
+  if (p->max_up > 0) {
+    d->n_up = d->sing ? -1 : 0;
+    for (i=0; i<p->qp->nz; ++i) d->up_act[i] = d->lam[i] != 0.;
+  }
 }
 
 // SYMBOL "qrqp_expand_step"
@@ -827,6 +1031,9 @@ int casadi_qrqp_singular_step(casadi_qrqp_data<T1>* d) {
     casadi_copy(d->nz_v, nnz_kkt, d->nz_kkt);
     casadi_qr(p->sp_kkt, d->nz_kkt, d->w, p->sp_v, d->nz_v, p->sp_r, d->nz_r,
               d->beta, p->prinv, p->pc);
+    d->n_fact++;
+    // The factorization no longer corresponds to the KKT matrix
+    d->n_up = -1;
     // For all nullspace vectors
     nk = casadi_qr_singular(static_cast<T1*>(0), 0, d->nz_r, p->sp_r, p->pc, 1e-12);
   }
@@ -924,8 +1131,6 @@ int casadi_qrqp_singular_step(casadi_qrqp_data<T1>* d) {
 // SYMBOL "qrqp_calc_step"
 template<typename T1>
 int casadi_qrqp_calc_step(casadi_qrqp_data<T1>* d) {
-  // Local variables
-  const casadi_qrqp_prob<T1>* p = d->prob;
   // Reset returns
   d->r_index = -1;
   d->r_sign = 0;
@@ -934,8 +1139,7 @@ int casadi_qrqp_calc_step(casadi_qrqp_data<T1>* d) {
   // Negative KKT residual
   casadi_qrqp_kkt_residual(d, d->dz);
   // Solve to get step in z[:nx] and lam[nx:]
-  casadi_qr_solve(d->dz, 1, 1, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
-                  p->prinv, p->pc, d->w);
+  casadi_qrqp_solve(d, d->dz, 1);
   // Have step in dz[:nx] and dlam[nx:]. Calculate complete dz and dlam
   casadi_qrqp_expand_step(d);
   // Successful return
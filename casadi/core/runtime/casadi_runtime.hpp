@@ -176,11 +176,30 @@ namespace casadi {
   T1 casadi_interpn(casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* values,
                             const T1* x, casadi_int* iw, T1* w);
 
+  // Multilinear interpolant - batch of points, reusing intervals for sorted queries
+  template<typename T1>
+  void casadi_interpn_batch(T1* res, casadi_int ndim, const T1* grid, const casadi_int* offset,
+                            const T1* values, const T1* x, const casadi_int* lookup_mode,
+                            casadi_int m, casadi_int n, casadi_int* iw, T1* w);
+
   // Multilinear interpolant - calculate gradient
   template<typename T1>
   void casadi_interpn_grad(T1* grad, casadi_int ndim, const T1* grid, const casadi_int* offset,
                                    const T1* values, const T1* x, casadi_int* iw, T1* w);
 
+  // Multilinear interpolant of a tensor train
+  template<typename T1>
+  void casadi_interptt(T1* res, casadi_int ndim, const T1* grid, const casadi_int* offset,
+                       const T1* cores, const casadi_int* core_offset, const casadi_int* rank,
+                       const T1* x, const casadi_int* lookup_mode, casadi_int m, T1* w);
+
+  // Multilinear interpolant of a tensor train - calculate gradient
+  template<typename T1>
+  void casadi_interptt_grad(T1* grad, casadi_int ndim, const T1* grid, const casadi_int* offset,
+                            const T1* cores, const casadi_int* core_offset,
+                            const casadi_int* rank, const T1* x, const casadi_int* lookup_mode,
+                            casadi_int m, casadi_int* iw, T1* w);
+
   // De boor single basis evaluation
   template<typename T1>
   void casadi_de_boor(T1 x, const T1* knots, casadi_int n_knots, casadi_int degree, T1* boor);
@@ -192,6 +211,14 @@ namespace casadi {
                             casadi_int m,
                             const T1* x, const casadi_int* lookup_mode, casadi_int* iw, T1* w);
 
+  // De boor nd evaluation, batch of points
+  template<typename T1>
+  void casadi_nd_boor_eval_batch(T1* ret, casadi_int n_dims, const T1* knots,
+                            const casadi_int* offset, const casadi_int* degree,
+                            const casadi_int* strides, const T1* c, casadi_int m,
+                            const T1* x, casadi_int n_x, casadi_int n_chunk,
+                            const casadi_int* lookup_mode, casadi_int* iw, T1* w);
+
   template<typename T1>
   T1 casadi_mmax(const T1* x, casadi_int n, T1 is_dense);
 
@@ -229,6 +256,19 @@ namespace casadi {
   template<typename T1>
   int casadi_newton(const casadi_newton_mem<T1>* m);
 
+  // Newton step with the current factorization
+  template<typename T1>
+  int casadi_newton_step(const casadi_newton_mem<T1>* m);
+
+  // Simplified Newton step, reusing the factorization
+  template<typename T1>
+  int casadi_newton_reuse(const casadi_newton_mem<T1>* m);
+
+  // Matrix exponential expm(t*a) and optionally its Frechet derivative in direction t*e
+  template<typename T1>
+  void casadi_expm(casadi_int n, casadi_int p, const T1* a, T1 t, const T1* e,
+    T1* r, T1* l, T1* w, casadi_int* iw);
+
   // Dense matrix multiplication
   #define CASADI_GEMM_NT(M, N, K, A, LDA, B, LDB, C, LDC) \
     for (i=0, rr=C; i<M; ++i) \
@@ -282,11 +322,15 @@ namespace casadi {
   #include "casadi_interpn_weights.hpp"
   #include "casadi_interpn_interpolate.hpp"
   #include "casadi_interpn.hpp"
+  #include "casadi_interpn_batch.hpp"
   #include "casadi_interpn_grad.hpp"
+  #include "casadi_interptt.hpp"
+  #include "casadi_interptt_grad.hpp"
   #include "casadi_mv_dense.hpp"
   #include "casadi_finite_diff.hpp"
   #include "casadi_file_slurp.hpp"
   #include "casadi_ldl.hpp"
+  #include "casadi_tridiag.hpp"
   #include "casadi_qr.hpp"
   #include "casadi_qp.hpp"
   #include "casadi_qrqp.hpp"
@@ -298,6 +342,7 @@ namespace casadi {
   #include "casadi_bfgs.hpp"
   #include "casadi_regularize.hpp"
   #include "casadi_newton.hpp"
+  #include "casadi_expm.hpp"
   #include "casadi_bound_consistency.hpp"
   #include "casadi_lsqr.hpp"
   #include "casadi_dense_lsqr.hpp"
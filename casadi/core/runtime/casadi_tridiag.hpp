@@ -0,0 +1,222 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// Block tridiagonal matrices with n_blk block rows of dense, column-major b-by-b blocks,
+// stored as f = [D_0..D_{n_blk-1}, L_0..L_{n_blk-1}, U_0..U_{n_blk-1}] where D_i is the
+// diagonal block, L_i couples block row i to block column i-1 and U_i to block column i+1
+
+// SYMBOL "tridiag_lu"
+// Dense LU factorization with partial pivoting of a b-by-b block, in place
+template<typename T1>
+void casadi_tridiag_lu(T1* a, casadi_int* p, casadi_int b) {
+  casadi_int i, j, k;
+  T1 t;
+  for (j=0; j<b; ++j) {
+    // Pivot row
+    p[j] = j;
+    for (i=j+1; i<b; ++i) if (fabs(a[i+j*b])>fabs(a[p[j]+j*b])) p[j] = i;
+    if (p[j]!=j) {
+      for (k=0; k<b; ++k) {
+        t = a[j+k*b]; a[j+k*b] = a[p[j]+k*b]; a[p[j]+k*b] = t;
+      }
+    }
+    // Eliminate below the diagonal
+    for (i=j+1; i<b; ++i) a[i+j*b] /= a[j+j*b];
+    for (k=j+1; k<b; ++k) {
+      for (i=j+1; i<b; ++i) a[i+k*b] -= a[i+j*b]*a[j+k*b];
+    }
+  }
+}
+
+// SYMBOL "tridiag_lu_solve"
+// Solve with a block factorized by casadi_tridiag_lu, for r right-hand-sides in place
+template<typename T1>
+void casadi_tridiag_lu_solve(const T1* a, const casadi_int* p, casadi_int b,
+                             T1* x, casadi_int r) {
+  casadi_int i, j, k;
+  T1 t;
+  for (k=0; k<r; ++k) {
+    for (j=0; j<b; ++j) {
+      if (p[j]!=j) {
+        t = x[j]; x[j] = x[p[j]]; x[p[j]] = t;
+      }
+    }
+    for (j=0; j<b; ++j) {
+      for (i=j+1; i<b; ++i) x[i] -= a[i+j*b]*x[j];
+    }
+    for (j=b-1; j>=0; --j) {
+      x[j] /= a[j+j*b];
+      for (i=0; i<j; ++i) x[i] -= a[i+j*b]*x[j];
+    }
+    x += b;
+  }
+}
+
+// SYMBOL "tridiag_gemm"
+// c -= a*x with a b-by-b and x, c b-by-r
+template<typename T1>
+void casadi_tridiag_gemm(const T1* a, const T1* x, T1* c, casadi_int b, casadi_int r) {
+  casadi_int i, j, k;
+  for (k=0; k<r; ++k) {
+    for (j=0; j<b; ++j) {
+      for (i=0; i<b; ++i) c[i+k*b] -= a[i+j*b]*x[j+k*b];
+    }
+  }
+}
+
+// SYMBOL "tridiag_scatter"
+// Scatter the nonzeros of A into block storage, map holds the position of each nonzero
+template<typename T1>
+void casadi_tridiag_scatter(const T1* a, casadi_int nnz, const casadi_int* map,
+                            casadi_int n_blk, casadi_int b, T1* f) {
+  casadi_int k;
+  for (k=0; k<3*n_blk*b*b; ++k) f[k] = 0;
+  for (k=0; k<nnz; ++k) f[map[k]] = a[k];
+}
+
+// SYMBOL "tridiag_thomas"
+// Block Thomas algorithm: factorize block row by block row, in place.
+// D_i is replaced by the factorized Schur complement S_i, U_i by S_i^{-1} U_i
+template<typename T1>
+void casadi_tridiag_thomas(T1* f, casadi_int* p, casadi_int n_blk, casadi_int b) {
+  casadi_int i, b2;
+  T1 *d, *l, *u;
+  b2 = b*b;
+  d = f; l = f + n_blk*b2; u = f + 2*n_blk*b2;
+  for (i=0; i<n_blk; ++i) {
+    if (i>0) casadi_tridiag_gemm(l+i*b2, u+(i-1)*b2, d+i*b2, b, b);
+    casadi_tridiag_lu(d+i*b2, p+i*b, b);
+    if (i+1<n_blk) casadi_tridiag_lu_solve(d+i*b2, p+i*b, b, u+i*b2, b);
+  }
+}
+
+// SYMBOL "tridiag_thomas_solve"
+// Solve with a matrix factorized by casadi_tridiag_thomas, in place
+template<typename T1>
+void casadi_tridiag_thomas_solve(const T1* f, const casadi_int* p, casadi_int n_blk,
+                                 casadi_int b, T1* x, casadi_int nrhs) {
+  casadi_int i, k, b2;
+  const T1 *d, *l, *u;
+  b2 = b*b;
+  d = f; l = f + n_blk*b2; u = f + 2*n_blk*b2;
+  for (k=0; k<nrhs; ++k) {
+    for (i=0; i<n_blk; ++i) {
+      if (i>0) casadi_tridiag_gemm(l+i*b2, x+(i-1)*b, x+i*b, b, 1);
+      casadi_tridiag_lu_solve(d+i*b2, p+i*b, b, x+i*b, 1);
+    }
+    for (i=n_blk-2; i>=0; --i) casadi_tridiag_gemm(u+i*b2, x+(i+1)*b, x+i*b, b, 1);
+    x += n_blk*b;
+  }
+}
+
+// SYMBOL "tridiag_cr"
+// Block cyclic reduction: at stride s, the active block rows are s-1, 2s-1, ...
+// Every other active row is eliminated, the remaining ones are coupled at stride 2s.
+// All rows eliminated at, or reduced within, a level are independent of each other.
+// The couplings L_i, U_i of each reduced row are saved to f[3*n_blk*b2 ...] in order
+// len[f] >= 5*n_blk*b*b, len[w] >= b*b
+template<typename T1>
+void casadi_tridiag_cr(T1* f, casadi_int* p, casadi_int n_blk, casadi_int b, T1* w) {
+  casadi_int s, i, im, ip, k, m, b2;
+  T1 *d, *l, *u, *save;
+  b2 = b*b;
+  d = f; l = f + n_blk*b2; u = f + 2*n_blk*b2; save = f + 3*n_blk*b2;
+  for (s=1; ; s*=2) {
+    m = n_blk/s;
+    // Factorize the block rows eliminated at this level
+    for (k=0; k<m; k+=2) {
+      i = s-1 + k*s;
+      casadi_tridiag_lu(d+i*b2, p+i*b, b);
+    }
+    if (m==1) break;
+    // Eliminate neighbours from the remaining block rows
+    for (k=1; k<m; k+=2) {
+      i = s-1 + k*s;
+      im = i - s;
+      ip = i + s;
+      casadi_copy(l+i*b2, b2, save);
+      casadi_copy(u+i*b2, b2, save+b2);
+      // Lower neighbour
+      casadi_copy(u+im*b2, b2, w);
+      casadi_tridiag_lu_solve(d+im*b2, p+im*b, b, w, b);
+      casadi_tridiag_gemm(save, w, d+i*b2, b, b);
+      casadi_copy(l+im*b2, b2, w);
+      casadi_tridiag_lu_solve(d+im*b2, p+im*b, b, w, b);
+      casadi_clear(l+i*b2, b2);
+      casadi_tridiag_gemm(save, w, l+i*b2, b, b);
+      // Upper neighbour
+      casadi_clear(u+i*b2, b2);
+      if (ip<n_blk) {
+        casadi_copy(l+ip*b2, b2, w);
+        casadi_tridiag_lu_solve(d+ip*b2, p+ip*b, b, w, b);
+        casadi_tridiag_gemm(save+b2, w, d+i*b2, b, b);
+        casadi_copy(u+ip*b2, b2, w);
+        casadi_tridiag_lu_solve(d+ip*b2, p+ip*b, b, w, b);
+        casadi_tridiag_gemm(save+b2, w, u+i*b2, b, b);
+      }
+      save += 2*b2;
+    }
+  }
+}
+
+// SYMBOL "tridiag_cr_solve"
+// Solve with a matrix factorized by casadi_tridiag_cr, in place
+// len[w] >= b
+template<typename T1>
+void casadi_tridiag_cr_solve(const T1* f, const casadi_int* p, casadi_int n_blk,
+                             casadi_int b, T1* x, casadi_int nrhs, T1* w) {
+  casadi_int s, i, im, ip, k, m, r, b2;
+  const T1 *d, *l, *u, *save;
+  b2 = b*b;
+  d = f; l = f + n_blk*b2; u = f + 2*n_blk*b2;
+  for (r=0; r<nrhs; ++r) {
+    // Reduce the right-hand-side, same traversal as the factorization
+    save = f + 3*n_blk*b2;
+    for (s=1; n_blk/s>1; s*=2) {
+      m = n_blk/s;
+      for (k=1; k<m; k+=2) {
+        i = s-1 + k*s;
+        im = i - s;
+        ip = i + s;
+        casadi_copy(x+im*b, b, w);
+        casadi_tridiag_lu_solve(d+im*b2, p+im*b, b, w, 1);
+        casadi_tridiag_gemm(save, w, x+i*b, b, 1);
+        if (ip<n_blk) {
+          casadi_copy(x+ip*b, b, w);
+          casadi_tridiag_lu_solve(d+ip*b2, p+ip*b, b, w, 1);
+          casadi_tridiag_gemm(save+b2, w, x+i*b, b, 1);
+        }
+        save += 2*b2;
+      }
+    }
+    // Back substitution, from the last level down
+    for (; s>=1; s/=2) {
+      m = n_blk/s;
+      for (k=0; k<m; k+=2) {
+        i = s-1 + k*s;
+        im = i - s;
+        ip = i + s;
+        if (k>0) casadi_tridiag_gemm(l+i*b2, x+im*b, x+i*b, b, 1);
+        if (ip<n_blk) casadi_tridiag_gemm(u+i*b2, x+ip*b, x+i*b, b, 1);
+        casadi_tridiag_lu_solve(d+i*b2, p+i*b, b, x+i*b, 1);
+      }
+    }
+    x += n_blk*b;
+  }
+}
@@ -89,59 +89,53 @@ casadi_int einstein_process(const T& A, const T& B, const T& C,
       }
     }
 
+    // Strides of every index in A, B and C, zero if the index does not appear
+    std::map<casadi_int, std::vector<casadi_int> > stride_map;
+    for (const auto& e : dim_map) stride_map[e.first].resize(3, 0);
+
+    std::vector<casadi_int> offset(3, 0);
+    const std::vector<casadi_int>* ind[3] = {&a, &b, &c};
+    const std::vector<casadi_int>* dim[3] = {&dim_a, &dim_b, &dim_c};
+    for (casadi_int k=0;k<3;++k) {
+      casadi_int cumprod = 1;
+      for (casadi_int j=0;j<ind[k]->size();++j) {
+        casadi_int ij = ind[k]->at(j);
+        if (ij<0) {
+          stride_map[ij][k] += cumprod;
+        } else {
+          offset[k]+=ij*cumprod;
+        }
+        cumprod*= dim[k]->at(j);
+      }
+    }
+
+    // Loop order: indices with the largest strides outermost, such that the innermost
+    // loops run over contiguous memory. Ties are broken by dimension, largest innermost.
     std::vector< std::pair<casadi_int, casadi_int> > dim_map_pair;
     for (const auto & i : dim_map) dim_map_pair.push_back(i);
 
     std::sort(dim_map_pair.begin(), dim_map_pair.end(),
-      [](const std::pair<casadi_int, casadi_int>& a, const std::pair<casadi_int, casadi_int>& b) { return a.second < b.second;});
+      [&stride_map](const std::pair<casadi_int, casadi_int>& a,
+          const std::pair<casadi_int, casadi_int>& b) {
+        const std::vector<casadi_int>& sa = stride_map[a.first];
+        const std::vector<casadi_int>& sb = stride_map[b.first];
+        casadi_int wa = sa[0]+sa[1]+sa[2], wb = sb[0]+sb[1]+sb[2];
+        if (wa!=wb) return wa > wb;
+        return a.second < b.second;});
 
-    std::vector<casadi_int> dim_map_keys;
     // Compute the total number of iterations needed
     casadi_int n_iter = 1;
+    iter_dims.clear();
+    strides_a.assign(1, offset[0]);
+    strides_b.assign(1, offset[1]);
+    strides_c.assign(1, offset[2]);
     for (const auto& e : dim_map_pair) {
       n_iter*= e.second;
-      dim_map_keys.push_back(-e.first);
       iter_dims.push_back(e.second);
-    }
-
-    strides_a.clear();
-    strides_a.resize(iter_dims.size()+1);
-    strides_b.clear();
-    strides_b.resize(iter_dims.size()+1);
-    strides_c.clear();
-    strides_c.resize(iter_dims.size()+1);
-
-    std::vector<casadi_int> lu;
-
-    if (!dim_map_keys.empty()) lu = lookupvector(dim_map_keys);
-
-    // Update data pointers to match indices
-    casadi_int cumprod = 1;
-    for (casadi_int j=0;j<a.size();++j) {
-      if (a[j]<0) {
-        strides_a[1+lu[-a[j]]] = cumprod;
-      } else {
-        strides_a[0]+=a[j]*cumprod;
-      }
-      cumprod*= dim_a[j];
-    }
-    cumprod = 1;
-    for (casadi_int j=0;j<b.size();++j) {
-      if (b[j]<0) {
-        strides_b[1+lu[-b[j]]] = cumprod;
-      } else {
-        strides_b[0]+=b[j]*cumprod;
-      }
-      cumprod*= dim_b[j];
-    }
-    cumprod = 1;
-    for (casadi_int j=0;j<c.size();++j) {
-      if (c[j]<0) {
-        strides_c[1+lu[-c[j]]] = cumprod;
-      } else {
-        strides_c[0]+=c[j]*cumprod;
-      }
-      cumprod*= dim_c[j];
+      const std::vector<casadi_int>& s = stride_map[e.first];
+      strides_a.push_back(s[0]);
+      strides_b.push_back(s[1]);
+      strides_c.push_back(s[2]);
     }
 
     return n_iter;
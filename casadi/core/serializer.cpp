@@ -31,6 +31,13 @@
 #include "importer.hpp"
 #include "generic_type.hpp"
 #include <iomanip>
+#include <cstring>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
 
 namespace casadi {
 
@@ -38,16 +45,6 @@ namespace casadi {
         SerializerBase(std::unique_ptr<std::ostream>(new std::stringstream()), opts) {
     }
 
-    FileSerializer::FileSerializer(const std::string& fname, const Dict& opts) :
-        SerializerBase(
-          std::unique_ptr<std::ostream>(
-            new std::ofstream(fname, std::ios_base::binary | std::ios::out)),
-          opts) {
-      if ((sstream_->rdstate() & std::ifstream::failbit) != 0) {
-        casadi_error("Could not open file '" + fname + "' for writing.");
-      }
-    }
-
     SerializerBase::SerializerBase(std::unique_ptr<std::ostream> stream, const Dict& opts) :
         sstream_(std::move(stream)),
         serializer_(new SerializingStream(*sstream_, opts)) {
@@ -103,9 +100,283 @@ namespace casadi {
       deserializer_(new DeserializingStream(*dstream_)) {
     }
 
+#ifndef _WIN32
+    /** \brief Read-only input stream over a memory-mapped file
+
+        Reads are served directly from the page cache, without an intermediate
+        stream buffer. Bulk reads of numeric vectors amount to a single memcpy.
+    */
+    class MappedFileStream : public std::istream {
+    public:
+      MappedFileStream(void* data, size_t size) : std::istream(&buf_), data_(data), size_(size) {
+        char* p = static_cast<char*>(data);
+        buf_.init(p, size);
+      }
+      ~MappedFileStream() override {
+        munmap(data_, size_);
+      }
+    private:
+      struct Buffer : public std::streambuf {
+        void init(char* p, size_t size) { setg(p, p, p + size); }
+      };
+      Buffer buf_;
+      void* data_;
+      size_t size_;
+    };
+#endif // _WIN32
+
+    /* Block compression of serialized data
+     *
+     * The stream starts with the magic "CASZ" followed by blocks of at most
+     * lz_block_size bytes, each prefixed by its uncompressed and compressed
+     * size (32-bit little endian). Blocks that do not compress are stored as is.
+     * Within a block, an LZ77 sequence consists of a token (literal length in
+     * the high nibble, match length minus 4 in the low nibble, 15 meaning that
+     * 255-terminated extension bytes follow), the literals, and, unless the
+     * block ends there, a 16-bit match offset.
+     */
+    static const char lz_magic[] = "CASZ";
+    static const size_t lz_block_size = 1 << 16;
+    static const size_t lz_hash_bits = 14;
+
+    static void lz_put_u32(std::string& dst, uint32_t v) {
+      for (int i=0; i<4; ++i) dst.push_back(static_cast<char>((v >> (8*i)) & 0xff));
+    }
+
+    static uint32_t lz_get_u32(const char* p) {
+      uint32_t v = 0;
+      for (int i=0; i<4; ++i) v |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8*i);
+      return v;
+    }
+
+    static void lz_put_length(std::string& dst, size_t len) {
+      for (; len>=255; len-=255) dst.push_back(static_cast<char>(255));
+      dst.push_back(static_cast<char>(len));
+    }
+
+    static void lz_put_sequence(std::string& dst, const char* lit, size_t n_lit,
+        size_t offset, size_t len) {
+      size_t m = len==0 ? 0 : len - 4;
+      dst.push_back(static_cast<char>((std::min<size_t>(n_lit, 15) << 4)
+        | std::min<size_t>(m, 15)));
+      if (n_lit>=15) lz_put_length(dst, n_lit-15);
+      dst.append(lit, n_lit);
+      if (len==0) return;
+      dst.push_back(static_cast<char>(offset & 0xff));
+      dst.push_back(static_cast<char>(offset >> 8));
+      if (m>=15) lz_put_length(dst, m-15);
+    }
+
+    static void lz_compress(const char* src, size_t n, std::string& dst) {
+      std::vector<int64_t> table(1 << lz_hash_bits, -1);
+      size_t anchor = 0, i = 0;
+      while (i+4<=n) {
+        uint32_t seq;
+        std::memcpy(&seq, src+i, 4);
+        uint32_t h = (seq*2654435761u) >> (32-lz_hash_bits);
+        int64_t ref = table[h];
+        table[h] = i;
+        if (ref>=0 && i-ref<=0xffff && std::memcmp(src+ref, src+i, 4)==0) {
+          size_t len = 4;
+          while (i+len<n && src[ref+len]==src[i+len]) len++;
+          lz_put_sequence(dst, src+anchor, i-anchor, i-ref, len);
+          i += len;
+          anchor = i;
+        } else {
+          i++;
+        }
+      }
+      if (anchor<n) lz_put_sequence(dst, src+anchor, n-anchor, 0, 0);
+    }
+
+    static size_t lz_get_length(const char*& p, const char* end, size_t len) {
+      if (len<15) return len;
+      unsigned char c;
+      do {
+        casadi_assert(p<end, "Corrupt compressed stream.");
+        c = static_cast<unsigned char>(*p++);
+        len += c;
+      } while (c==255);
+      return len;
+    }
+
+    static void lz_decompress(const char* p, size_t n, char* dst, size_t n_dst) {
+      const char* end = p + n;
+      size_t op = 0;
+      while (op<n_dst) {
+        casadi_assert(p<end, "Corrupt compressed stream.");
+        unsigned char token = static_cast<unsigned char>(*p++);
+        size_t n_lit = lz_get_length(p, end, token >> 4);
+        casadi_assert(n_lit<=static_cast<size_t>(end-p) && op+n_lit<=n_dst,
+          "Corrupt compressed stream.");
+        std::memcpy(dst+op, p, n_lit);
+        p += n_lit;
+        op += n_lit;
+        if (op==n_dst) break;
+        casadi_assert(end-p>=2, "Corrupt compressed stream.");
+        size_t offset = static_cast<unsigned char>(p[0])
+          | (static_cast<size_t>(static_cast<unsigned char>(p[1])) << 8);
+        p += 2;
+        size_t len = lz_get_length(p, end, token & 15) + 4;
+        casadi_assert(offset>0 && offset<=op && op+len<=n_dst, "Corrupt compressed stream.");
+        // Byte-wise, since source and destination may overlap
+        for (size_t k=0; k<len; ++k, ++op) dst[op] = dst[op-offset];
+      }
+    }
+
+    /** \brief Output stream compressing into an underlying stream block by block */
+    class CompressedOStream : public std::ostream {
+    public:
+      explicit CompressedOStream(std::unique_ptr<std::ostream> out) :
+          std::ostream(&buf_), buf_(std::move(out)) {
+        if (buf_.out->fail()) setstate(std::ios::failbit);
+      }
+    private:
+      struct Buffer : public std::streambuf {
+        explicit Buffer(std::unique_ptr<std::ostream> o) : out(std::move(o)), data(lz_block_size) {
+          out->write(lz_magic, 4);
+          setp(data.data(), data.data() + data.size());
+        }
+        ~Buffer() override {
+          flush_block();
+        }
+        int overflow(int c) override {
+          flush_block();
+          if (c!=traits_type::eof()) {
+            *pptr() = static_cast<char>(c);
+            pbump(1);
+          }
+          return out->good() ? traits_type::not_eof(c) : traits_type::eof();
+        }
+        int sync() override {
+          flush_block();
+          out->flush();
+          return out->good() ? 0 : -1;
+        }
+        void flush_block() {
+          size_t n = pptr() - pbase();
+          if (n==0) return;
+          std::string block;
+          lz_compress(pbase(), n, block);
+          std::string header;
+          lz_put_u32(header, n);
+          if (block.size()<n) {
+            lz_put_u32(header, block.size());
+            out->write(header.data(), header.size());
+            out->write(block.data(), block.size());
+          } else {
+            // Incompressible, store as is
+            lz_put_u32(header, n);
+            out->write(header.data(), header.size());
+            out->write(pbase(), n);
+          }
+          setp(data.data(), data.data() + data.size());
+        }
+        std::unique_ptr<std::ostream> out;
+        std::vector<char> data;
+      };
+      Buffer buf_;
+    };
+
+    /** \brief Input stream decompressing from an underlying stream block by block */
+    class CompressedIStream : public std::istream {
+    public:
+      explicit CompressedIStream(std::unique_ptr<std::istream> in) :
+          std::istream(&buf_), buf_(std::move(in)) {
+      }
+    private:
+      struct Buffer : public std::streambuf {
+        explicit Buffer(std::unique_ptr<std::istream> i) : in(std::move(i)) {
+          char magic[4];
+          in->read(magic, 4);
+          casadi_assert(in->gcount()==4 && std::memcmp(magic, lz_magic, 4)==0,
+            "Not a compressed stream.");
+          setg(nullptr, nullptr, nullptr);
+        }
+        int underflow() override {
+          if (gptr()<egptr()) return traits_type::to_int_type(*gptr());
+          char header[8];
+          in->read(header, 8);
+          if (in->gcount()==0) return traits_type::eof();
+          casadi_assert(in->gcount()==8, "Corrupt compressed stream.");
+          size_t n = lz_get_u32(header), n_comp = lz_get_u32(header+4);
+          casadi_assert(n<=lz_block_size && n_comp<=n, "Corrupt compressed stream.");
+          data.resize(n);
+          if (n_comp==n) {
+            in->read(data.data(), n);
+            casadi_assert(static_cast<size_t>(in->gcount())==n, "Corrupt compressed stream.");
+          } else {
+            comp.resize(n_comp);
+            in->read(comp.data(), n_comp);
+            casadi_assert(static_cast<size_t>(in->gcount())==n_comp,
+              "Corrupt compressed stream.");
+            lz_decompress(comp.data(), n_comp, data.data(), n);
+          }
+          setg(data.data(), data.data(), data.data() + n);
+          return n==0 ? traits_type::eof() : traits_type::to_int_type(*gptr());
+        }
+        std::unique_ptr<std::istream> in;
+        std::vector<char> data, comp;
+      };
+      Buffer buf_;
+    };
+
+    // Map the file into memory if possible, otherwise fall back to a file stream
+    static std::istream* open_file_raw(const std::string& fname) {
+#ifndef _WIN32
+      int fd = open(fname.c_str(), O_RDONLY);
+      if (fd>=0) {
+        struct stat st;
+        void* data = MAP_FAILED;
+        if (fstat(fd, &st)==0 && st.st_size>0) {
+          data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (data!=MAP_FAILED) return new MappedFileStream(data, st.st_size);
+      }
+#endif // _WIN32
+      return new std::ifstream(fname, std::ios_base::binary | std::ios::in);
+    }
+
+    // Open a file for reading, decompressing if needed
+    static std::istream* open_file(const std::string& fname) {
+      std::unique_ptr<std::istream> in(open_file_raw(fname));
+      // The text encoded header never starts with the magic's first character
+      if (in->peek()==lz_magic[0]) return new CompressedIStream(std::move(in));
+      return in.release();
+    }
+
+    // Open a file for writing, compressing if requested
+    static std::ostream* open_file(const std::string& fname, const Dict& opts) {
+      std::unique_ptr<std::ostream> out(
+        new std::ofstream(fname, std::ios_base::binary | std::ios::out));
+      auto it = opts.find("compression");
+      if (it!=opts.end()) {
+        std::string compression = it->second;
+        if (compression=="lz") return new CompressedOStream(std::move(out));
+        casadi_assert(compression=="none",
+          "Unknown compression '" + compression + "'. Options are 'none' and 'lz'.");
+      }
+      return out.release();
+    }
+
+    // Options handled by the stream rather than the serializer
+    static Dict stream_options(const Dict& opts) {
+      Dict ret = opts;
+      ret.erase("compression");
+      return ret;
+    }
+
+    FileSerializer::FileSerializer(const std::string& fname, const Dict& opts) :
+        SerializerBase(std::unique_ptr<std::ostream>(open_file(fname, opts)),
+          stream_options(opts)) {
+      if ((sstream_->rdstate() & std::ifstream::failbit) != 0) {
+        casadi_error("Could not open file '" + fname + "' for writing.");
+      }
+    }
+
     FileDeserializer::FileDeserializer(const std::string& fname) :
-        DeserializerBase(std::unique_ptr<std::istream>(
-          new std::ifstream(fname, std::ios_base::binary | std::ios::in))) {
+        DeserializerBase(std::unique_ptr<std::istream>(open_file(fname))) {
       if ((dstream_->rdstate() & std::ifstream::failbit) != 0) {
         casadi_error("Could not open file '" + fname + "' for reading.");
       }
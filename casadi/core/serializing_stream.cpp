@@ -31,6 +31,7 @@
 #include "fmu.hpp"
 #include "generic_type.hpp"
 #include "shared_object_internal.hpp"
+#include <cstring>
 #include "sx_node.hpp"
 #include "sparsity_internal.hpp"
 #include "mx_node.hpp"
@@ -40,10 +41,14 @@
 
 namespace casadi {
 
+    // Version 3: text layout, each byte encoded as two characters
+    // Version 4: binary layout, header as in version 3
     static casadi_int serialization_protocol_version = 3;
+    static casadi_int serialization_protocol_version_binary = 4;
     static casadi_int serialization_check = 123456789012345;
 
-    DeserializingStream::DeserializingStream(std::istream& in_s) : in(in_s), debug_(false) {
+    DeserializingStream::DeserializingStream(std::istream& in_s) : in(in_s), debug_(false),
+        binary_(false), pos_(0) {
 
       casadi_assert(in_s.good(), "Invalid input stream. If you specified an input file, "
         "make sure it exists relative to the current directory.");
@@ -58,14 +63,16 @@ namespace casadi {
       // API version check
       casadi_int v;
       unpack(v);
-      casadi_assert(v==serialization_protocol_version,
+      casadi_assert(v==serialization_protocol_version || v==serialization_protocol_version_binary,
         "Serialization protocol is not compatible. "
         "Got version " + str(v) + ", while " +
-        str(serialization_protocol_version) + " was expected.");
+        str(serialization_protocol_version) + " or " +
+        str(serialization_protocol_version_binary) + " was expected.");
 
       bool debug;
       unpack(debug);
       debug_ = debug;
+      binary_ = v==serialization_protocol_version_binary;
 
     }
 
@@ -74,25 +81,29 @@ namespace casadi {
     }
 
     SerializingStream::SerializingStream(std::ostream& out_s, const Dict& opts) :
-        out(out_s), debug_(false) {
-      // Sanity check
-      pack(serialization_check);
-      // API version check
-      pack(casadi_int(serialization_protocol_version));
-
+        out(out_s), debug_(false), binary_(false), pos_(0) {
       bool debug = false;
+      bool binary = false;
 
       // Read options
       for (auto&& op : opts) {
         if (op.first=="debug") {
           debug = op.second;
+        } else if (op.first=="binary") {
+          binary = op.second;
         } else {
           casadi_error("Unknown option: '" + op.first + "'.");
         }
       }
 
+      // Sanity check
+      pack(serialization_check);
+      // API version check, also identifies the layout
+      pack(binary ? serialization_protocol_version_binary : serialization_protocol_version);
+
       pack(debug);
       debug_ = debug;
+      binary_ = binary;
     }
 
     void SerializingStream::decorate(char e) {
@@ -186,20 +197,32 @@ namespace casadi {
     }
 
     void DeserializingStream::unpack(char& e) {
+      if (binary_) {
+        in.get(e);
+        pos_++;
+        return;
+      }
       unsigned char ref = 'a';
       in.get(e);
       char t;
       in.get(t);
+      pos_ += 2;
       e = (reinterpret_cast<unsigned char&>(e)-ref) +
           ((reinterpret_cast<unsigned char&>(t)-ref) << 4);
     }
 
     void SerializingStream::pack(char e) {
+      if (binary_) {
+        out.put(e);
+        pos_++;
+        return;
+      }
       unsigned char ref = 'a';
       // Note: outputstreams work neatly with std::hex,
       // but inputstreams don't
       out.put(ref + (reinterpret_cast<unsigned char&>(e) % 16));
       out.put(ref + (reinterpret_cast<unsigned char&>(e) >> 4));
+      pos_ += 2;
     }
 
     void SerializingStream::pack(const std::string& e) {
@@ -361,6 +384,92 @@ namespace casadi {
     }
   }
 
+  void SerializingStream::align(size_t a) {
+    while (pos_ % a) {
+      out.put(0);
+      pos_++;
+    }
+  }
+
+  void DeserializingStream::align(size_t a) {
+    while (pos_ % a) {
+      in.get();
+      pos_++;
+    }
+  }
+
+  template <>
+  void SerializingStream::pack(const std::vector<double>& e) {
+    decorate('V');
+    pack(static_cast<casadi_int>(e.size()));
+    if (binary_) {
+      // Aligned, so that a memory-mapped file can be copied from directly
+      align(sizeof(double));
+      out.write(reinterpret_cast<const char*>(e.data()), e.size()*sizeof(double));
+      pos_ += e.size()*sizeof(double);
+    } else {
+      for (double i : e) pack(i);
+    }
+  }
+
+  template <>
+  void DeserializingStream::unpack(std::vector<double>& e) {
+    assert_decoration('V');
+    casadi_int s;
+    unpack(s);
+    e.resize(s);
+    if (binary_) {
+      align(sizeof(double));
+      in.read(reinterpret_cast<char*>(e.data()), s*sizeof(double));
+      casadi_assert(!in.fail(),
+        "DeserializingStream: unexpected end of stream.");
+      pos_ += s*sizeof(double);
+    } else {
+      for (double& i : e) unpack(i);
+    }
+  }
+
+  template <>
+  void SerializingStream::pack(const std::vector<casadi_int>& e) {
+    decorate('V');
+    pack(static_cast<casadi_int>(e.size()));
+    if (binary_) {
+      // Stored as 64-bit integers, as for scalars
+      align(sizeof(int64_t));
+      for (casadi_int i : e) {
+        int64_t n = i;
+        out.write(reinterpret_cast<const char*>(&n), sizeof(int64_t));
+      }
+      pos_ += e.size()*sizeof(int64_t);
+    } else {
+      for (casadi_int i : e) pack(i);
+    }
+  }
+
+  template <>
+  void DeserializingStream::unpack(std::vector<casadi_int>& e) {
+    assert_decoration('V');
+    casadi_int s;
+    unpack(s);
+    e.resize(s);
+    if (binary_) {
+      align(sizeof(int64_t));
+      if (sizeof(casadi_int)==sizeof(int64_t)) {
+        in.read(reinterpret_cast<char*>(e.data()), s*sizeof(int64_t));
+      } else {
+        for (casadi_int& i : e) {
+          int64_t n;
+          in.read(reinterpret_cast<char*>(&n), sizeof(int64_t));
+          i = n;
+        }
+      }
+      casadi_assert(!in.fail(), "DeserializingStream: unexpected end of stream.");
+      pos_ += s*sizeof(int64_t);
+    } else {
+      for (casadi_int& i : e) unpack(i);
+    }
+  }
+
   int DeserializingStream::version(const std::string& name) {
     int load_version;
     unpack(name+"::serialization::version", load_version);
@@ -422,20 +531,82 @@ namespace casadi {
     }
   }
 
+  // Hash of the bit patterns (FNV-1a)
+  static size_t interned_hash(const std::vector<double>& e) {
+    uint64_t h = 14695981039346656037ull;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(e.data());
+    for (size_t i=0; i<e.size()*sizeof(double); ++i) {
+      h ^= p[i];
+      h *= 1099511628211ull;
+    }
+    return static_cast<size_t>(h ^ e.size());
+  }
+
+  casadi_int SerializingStream::intern(const std::vector<double>& e, size_t hash) {
+    casadi_int r = interned_.size();
+    interned_.push_back(e);
+    interned_map_.insert(std::make_pair(hash, r));
+    return r;
+  }
+
+  void SerializingStream::pack_interned(const std::string& descr, const std::vector<double>& e) {
+    size_t hash = interned_hash(e);
+    auto range = interned_map_.equal_range(hash);
+    for (auto it=range.first; it!=range.second; ++it) {
+      const std::vector<double>& v = interned_[it->second];
+      if (v.size()==e.size() &&
+          std::memcmp(v.data(), e.data(), e.size()*sizeof(double))==0) {
+        pack(descr + "::flag", 'r'); // reference
+        pack(descr + "::reference", it->second);
+        return;
+      }
+    }
+    pack(descr + "::flag", 'd'); // definition
+    pack(descr, e);
+    intern(e, hash);
+    if (interned_nodes_) interned_nodes_->push_back(e);
+  }
+
+  void DeserializingStream::unpack_interned(const std::string& descr, std::vector<double>& e) {
+    char i;
+    unpack(descr + "::flag", i);
+    switch (i) {
+      case 'd': // definition
+        unpack(descr, e);
+        if (interned_map_) interned_map_->intern(e, interned_hash(e));
+        interned_.push_back(e);
+        break;
+      case 'r': // reference
+        {
+          casadi_int k;
+          unpack(descr + "::reference", k);
+          e = interned_.at(k);
+        }
+        break;
+      default:
+        casadi_assert_dev(false);
+    }
+  }
+
   void SerializingStream::connect(DeserializingStream & s) {
     nodes_ = &s.nodes_;
+    interned_nodes_ = &s.interned_;
   }
 
   void DeserializingStream::connect(SerializingStream & s) {
     shared_map_ = &s.shared_map_;
+    interned_map_ = &s;
   }
 
   void SerializingStream::reset() {
     shared_map_.clear();
+    interned_map_.clear();
+    interned_.clear();
   }
 
   void DeserializingStream::reset() {
     nodes_.clear();
+    interned_.clear();
   }
 
 } // namespace casadi
@@ -154,6 +154,9 @@ namespace casadi {
     int version(const std::string& name);
     int version(const std::string& name, int min, int max);
 
+    /** \brief Unpacks a vector written with SerializingStream::pack_interned */
+    void unpack_interned(const std::string& descr, std::vector<double>& e);
+
     void connect(SerializingStream & s);
     void reset();
 
@@ -197,10 +200,20 @@ namespace casadi {
     /// Collection of all shared pointer deserialized so far
     std::vector<UniversalNodeOwner> nodes_;
     std::unordered_map<void*, casadi_int>* shared_map_ = nullptr;
+    /// Interned vectors deserialized so far
+    std::vector<std::vector<double> > interned_;
+    SerializingStream* interned_map_ = nullptr;
+    /** \brief Skip padding up to a multiple of a bytes (binary layout) */
+    void align(size_t a);
+
     /// Input stream
     std::istream& in;
     /// Debug mode?
     bool debug_;
+    /// Binary layout?
+    bool binary_;
+    /// Number of bytes read
+    size_t pos_;
   };
 
   /** \brief Helper class for Serialization
@@ -280,6 +293,13 @@ namespace casadi {
 
     void version(const std::string& name, int v);
 
+    /** \brief Packs a vector, or a back-reference if identical contents were packed before
+     *
+     * Constant data tends to be repeated many times in large expression graphs,
+     * while (unlike Sparsity) not being shared by pointer.
+     */
+    void pack_interned(const std::string& descr, const std::vector<double>& e);
+
     void connect(DeserializingStream & s);
     void reset();
 
@@ -315,15 +335,39 @@ namespace casadi {
     /// Mapping from shared pointers to running counter
     std::unordered_map<void*, casadi_int> shared_map_;
     std::vector<UniversalNodeOwner>* nodes_ = nullptr;
+
+    /** \brief Register an interned vector, returns its index */
+    casadi_int intern(const std::vector<double>& e, size_t hash);
+    /// Interned vectors, indexed by a hash of the contents
+    std::unordered_multimap<size_t, casadi_int> interned_map_;
+    std::vector<std::vector<double> > interned_;
+    std::vector<std::vector<double> >* interned_nodes_ = nullptr;
+    /** \brief Insert padding up to a multiple of a bytes (binary layout) */
+    void align(size_t a);
+
     /// Output stream
     std::ostream& out;
     /// Debug mode?
     bool debug_;
+    /// Binary layout?
+    bool binary_;
+    /// Number of bytes written
+    size_t pos_;
   };
 
   template <>
   CASADI_EXPORT void DeserializingStream::unpack(std::vector<bool>& e);
 
+  // Numeric vectors are stored contiguously and aligned in the binary layout
+  template <>
+  CASADI_EXPORT void DeserializingStream::unpack(std::vector<double>& e);
+  template <>
+  CASADI_EXPORT void DeserializingStream::unpack(std::vector<casadi_int>& e);
+  template <>
+  CASADI_EXPORT void SerializingStream::pack(const std::vector<double>& e);
+  template <>
+  CASADI_EXPORT void SerializingStream::pack(const std::vector<casadi_int>& e);
+
 } // namespace casadi
 
 #endif // CASADI_SERIALIZING_STREAM_HPP
@@ -88,6 +88,9 @@ namespace casadi {
     /// Get an IM representation of a GetNonzeros or SetNonzeros node
     Matrix<casadi_int> mapping() const override;
 
+    /// Get the nonzeros of matrix
+    MX get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const override;
+
     /// Can the operation be performed inplace (i.e. overwrite the result)
     casadi_int n_inplace() const override { return 1;}
 
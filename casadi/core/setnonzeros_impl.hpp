@@ -800,6 +800,36 @@ namespace casadi {
     return Matrix<casadi_int>(this->dep(1).sparsity(), nz, false);
   }
 
+  template<bool Add>
+  MX SetNonzeros<Add>::get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const {
+    // For each nonzero of the result, the last nonzero of x assigned to it, if any
+    std::vector<casadi_int> nz_all = all();
+    std::vector<casadi_int> src(this->nnz(), -1);
+    for (casadi_int k=0; k<nz_all.size(); ++k) {
+      if (nz_all[k]>=0) src[nz_all[k]] = k;
+    }
+    // Check if the requested nonzeros come from y only or (assignment) from x only
+    bool from_y = true, from_x = !Add;
+    for (casadi_int i : nz) {
+      if (i<0) continue;
+      if (src[i]>=0) {
+        from_y = false;
+      } else {
+        from_x = false;
+      }
+    }
+    // Bypass this node
+    if (from_y) return this->dep(0)->get_nzref(sp, nz);
+    if (from_x) {
+      std::vector<casadi_int> nz_new(nz);
+      for (casadi_int& i : nz_new) {
+        if (i>=0) i = src[i];
+      }
+      return this->dep(1)->get_nzref(sp, nz_new);
+    }
+    return MXNode::get_nzref(sp, nz);
+  }
+
   template<bool Add>
   bool SetNonzerosVector<Add>::is_equal(const MXNode* node, casadi_int depth) const {
     // Check dependencies
@@ -112,6 +112,13 @@ namespace casadi {
         \identifier{at} */
     void assign(SharedObjectInternal* node);
 
+    /** \brief Assign the node only if it still has owners
+
+     * Fails, leaving the object unchanged, if the reference count of the node
+     * has already dropped to zero, i.e. it is being deleted by another thread.
+     */
+    bool try_own(SharedObjectInternal* node);
+
     /// Get a const pointer to the node
     SharedObjectInternal* get() const;
 
@@ -176,6 +176,9 @@ namespace casadi {
                   const std::vector<casadi_int>& arg,
                   const std::vector<casadi_int>& res) const override;
 
+    /** \brief Add functions called by the linear solver to the generated code */
+    void add_dependency(CodeGenerator& g) const override;
+
     /// Linear solver (may be shared between multiple nodes)
     Linsol linsol_;
 
@@ -257,6 +257,11 @@ namespace casadi {
     return this->sparsity().size1();
   }
 
+  template<bool Tr>
+  void LinsolCall<Tr>::add_dependency(CodeGenerator& g) const {
+    linsol_->add_dependency(g);
+  }
+
   template<bool Tr>
   void LinsolCall<Tr>::generate(CodeGenerator& g,
                             const std::vector<casadi_int>& arg,
@@ -29,6 +29,13 @@
 #include "casadi_misc.hpp"
 #include "serializing_stream.hpp"
 #include <climits>
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
 #define CASADI_THROW_ERROR(FNAME, WHAT) \
 throw CasadiException("Error in Sparsity::" FNAME " at " + CASADI_WHERE + ":\n"\
@@ -400,9 +407,65 @@ namespace casadi {
     return (*this)->combine(y, f0x_is_zero, fx0_is_zero, mapping);
   }
 
+  /// Small per-thread cache of binary operation result patterns
+  class PatternCache {
+  public:
+    // Operation tags: combine flags in the lower bits, matrix product separately
+    enum Tag {TAG_MTIMES = 4};
+
+    // Look up a result, keyed on the identity of the operand patterns
+    const Sparsity* find(const Sparsity& x, const Sparsity& y, int tag) {
+      const Entry& e = table_[slot(x, y, tag)];
+      if (e.tag==tag && e.x.get()==x.get() && e.y.get()==y.get()) return &e.r;
+      return nullptr;
+    }
+
+    // Store a result, evicting whatever occupied the slot
+    void insert(const Sparsity& x, const Sparsity& y, int tag, const Sparsity& r) {
+      Entry& e = table_[slot(x, y, tag)];
+      e.x = x;
+      e.y = y;
+      e.r = r;
+      e.tag = tag;
+    }
+
+    static PatternCache& get() {
+      thread_local PatternCache ret;
+      return ret;
+    }
+
+  private:
+    // Entries hold references to the operands, so pointer identity implies equal patterns
+    struct Entry {
+      Sparsity x, y, r;
+      int tag = -1;
+    };
+    static const size_t n_slot = 64;
+    Entry table_[n_slot];
+
+    static size_t slot(const Sparsity& x, const Sparsity& y, int tag) {
+      size_t h = 0;
+      hash_combine(h, reinterpret_cast<uintptr_t>(x.get()));
+      hash_combine(h, reinterpret_cast<uintptr_t>(y.get()));
+      hash_combine(h, tag);
+      return h % n_slot;
+    }
+  };
+
   Sparsity Sparsity::combine(const Sparsity& y, bool f0x_is_zero,
                                     bool fx0_is_zero) const {
-    return (*this)->combine(y, f0x_is_zero, fx0_is_zero);
+    // Quick return if same pattern object or both dense
+    if (get()==y.get()) return y;
+    if (is_dense() && y.is_dense() && size()==y.size()) return y;
+
+    // Previously computed?
+    PatternCache& cache = PatternCache::get();
+    int tag = (f0x_is_zero ? 1 : 0) | (fx0_is_zero ? 2 : 0);
+    const Sparsity* r = cache.find(*this, y, tag);
+    if (r) return *r;
+    Sparsity ret = (*this)->combine(y, f0x_is_zero, fx0_is_zero);
+    cache.insert(*this, y, tag, ret);
+    return ret;
   }
 
   Sparsity Sparsity::unite(const Sparsity& y, std::vector<unsigned char>& mapping) const {
@@ -410,7 +473,7 @@ namespace casadi {
   }
 
   Sparsity Sparsity::unite(const Sparsity& y) const {
-    return (*this)->combine(y, false, false);
+    return combine(y, false, false);
   }
 
   Sparsity Sparsity::intersect(const Sparsity& y,
@@ -419,7 +482,7 @@ namespace casadi {
   }
 
   Sparsity Sparsity::intersect(const Sparsity& y) const {
-    return (*this)->combine(y, true, true);
+    return combine(y, true, true);
   }
 
   bool Sparsity::is_subset(const Sparsity& rhs) const {
@@ -432,7 +495,16 @@ namespace casadi {
       "Matrix product with incompatible dimensions. Lhs is "
       + x.dim() + " and rhs is " + y.dim() + ".");
 
-    return x->_mtimes(y);
+    // Dense product is dense
+    if (x.is_dense() && y.is_dense()) return dense(x.size1(), y.size2());
+
+    // Previously computed?
+    PatternCache& cache = PatternCache::get();
+    const Sparsity* r = cache.find(x, y, PatternCache::TAG_MTIMES);
+    if (r) return *r;
+    Sparsity ret = x->_mtimes(y);
+    cache.insert(x, y, PatternCache::TAG_MTIMES, ret);
+    return ret;
   }
 
   bool Sparsity::is_stacked(const Sparsity& y, casadi_int n) const {
@@ -520,9 +592,38 @@ namespace casadi {
     }
   }
 
-  Sparsity::CachingMap& Sparsity::getCache() {
-    static CachingMap ret;
-    return ret;
+  /// Partition of the sparsity pattern cache
+  struct SparsityCacheShard {
+    Sparsity::CachingMap cache;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::mutex mtx;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+  };
+
+  static SparsityCacheShard& getCacheShard(std::size_t h) {
+    // Never destroyed, patterns with static storage duration may outlive it
+    static SparsityCacheShard* ret = new SparsityCacheShard[Sparsity::n_cache_shard];
+    return ret[h % Sparsity::n_cache_shard];
+  }
+
+  Sparsity::CachingMap& Sparsity::getCache(std::size_t h) {
+    return getCacheShard(h).cache;
+  }
+
+  void Sparsity::uncache(const SparsityInternal* node) {
+    std::size_t h = node->hash();
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::lock_guard<std::mutex> lock(getCacheShard(h).mtx);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    CachingMap& cache = getCache(h);
+    std::pair<CachingMap::iterator, CachingMap::iterator> eq = cache.equal_range(h);
+    for (CachingMap::iterator i=eq.first; i!=eq.second; ++i) {
+      if (i->second.alive() && i->second->raw_==node) {
+        // Lookups will no longer find the pattern
+        cache.erase(i);
+        return;
+      }
+    }
   }
 
   const Sparsity& Sparsity::getScalar() {
@@ -612,14 +713,27 @@ namespace casadi {
   }
 
   std::vector<casadi_int> Sparsity::etree(bool ata) const {
-    std::vector<casadi_int> parent(size2()), w(size1() + size2());
-    SparsityInternal::etree(*this, get_ptr(parent), get_ptr(w), ata);
-    return parent;
+    return (*this)->symbolic("etree:" + str(ata), [&]() {
+      std::vector<casadi_int> parent(size2()), w(size1() + size2());
+      SparsityInternal::etree(*this, get_ptr(parent), get_ptr(w), ata);
+      return std::vector<std::vector<casadi_int> >{parent};
+    }).front();
   }
 
   Sparsity Sparsity::ldl(std::vector<casadi_int>& p, bool amd) const {
     casadi_assert(is_symmetric(),
                  "LDL factorization requires a symmetric matrix");
+    // Calculated once for every pattern and ordering
+    const std::vector<std::vector<casadi_int> >& r = (*this)->symbolic("ldl:" + str(amd), [&]() {
+      std::vector<casadi_int> perm;
+      Sparsity Lt = ldl_calc(perm, amd);
+      return std::vector<std::vector<casadi_int> >{perm, Lt.compress()};
+    });
+    p = r[0];
+    return compressed(r[1]);
+  }
+
+  Sparsity Sparsity::ldl_calc(std::vector<casadi_int>& p, bool amd) const {
     // Recursive call if AMD
     if (amd) {
       // Get AMD reordering
@@ -628,7 +742,7 @@ namespace casadi {
       std::vector<casadi_int> tmp;
       Sparsity Aperm = sub(p, p, tmp);
       // Call recursively
-      return Aperm.ldl(tmp, false);
+      return Aperm.ldl_calc(tmp, false);
     }
     // Dimension
     casadi_int n=size1();
@@ -652,6 +766,23 @@ namespace casadi {
   void Sparsity::
   qr_sparse(Sparsity& V, Sparsity& R, std::vector<casadi_int>& prinv,
             std::vector<casadi_int>& pc, bool amd) const {
+    // Calculated once for every pattern and ordering
+    const std::vector<std::vector<casadi_int> >& r = (*this)->symbolic("qr:" + str(amd), [&]() {
+      Sparsity sp_v, sp_r;
+      std::vector<casadi_int> rowperm, colperm;
+      qr_calc(sp_v, sp_r, rowperm, colperm, amd);
+      return std::vector<std::vector<casadi_int> >{sp_v.compress(), sp_r.compress(),
+                                                   rowperm, colperm};
+    });
+    V = compressed(r[0]);
+    R = compressed(r[1]);
+    prinv = r[2];
+    pc = r[3];
+  }
+
+  void Sparsity::
+  qr_calc(Sparsity& V, Sparsity& R, std::vector<casadi_int>& prinv,
+          std::vector<casadi_int>& pc, bool amd) const {
     // Dimensions
     casadi_int size1=this->size1(), size2=this->size2();
 
@@ -663,7 +794,7 @@ namespace casadi {
       std::vector<casadi_int> tmp;
       Sparsity Aperm = sub(range(size1), pc, tmp);
       // Call recursively
-      return Aperm.qr_sparse(V, R, prinv, tmp, false);
+      return Aperm.qr_calc(V, R, prinv, tmp, false);
     }
 
     // No column permutation
@@ -704,7 +835,15 @@ namespace casadi {
   }
 
   std::vector<casadi_int> Sparsity::amd() const {
-    return (*this)->amd();
+    return (*this)->symbolic("amd", [this]() {
+      return std::vector<std::vector<casadi_int> >{(*this)->amd()};
+    }).front();
+  }
+
+  std::vector<casadi_int> Sparsity::nd(casadi_int leaf_size) const {
+    return (*this)->symbolic("nd:" + str(leaf_size), [&]() {
+      return std::vector<std::vector<casadi_int> >{(*this)->nd(leaf_size)};
+    }).front();
   }
 
   casadi_int Sparsity::btf(std::vector<casadi_int>& rowperm, std::vector<casadi_int>& colperm,
@@ -872,8 +1011,11 @@ namespace casadi {
     // Hash the pattern
     std::size_t h = hash_sparsity(nrow, ncol, colind, row);
 
-    // Get a reference to the cache
-    CachingMap& cache = getCache();
+    // Get a reference to the cache partition
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::lock_guard<std::mutex> lock(getCacheShard(h).mtx);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    CachingMap& cache = getCache(h);
 
     // Record the current number of buckets (for garbage collection below)
     casadi_int bucket_count_before = cache.bucket_count();
@@ -893,20 +1035,15 @@ namespace casadi {
         // Check if the pattern still exists
         if (wref.alive()) {
 
-          // Get an owning reference to the cached pattern
-          Sparsity ref = shared_cast<Sparsity>(wref.shared());
-
           // Check if the pattern matches
-          if (ref.is_equal(nrow, ncol, colind, row)) {
+          SparsityInternal* ref = static_cast<SparsityInternal*>(wref->raw_);
+          if (ref->is_equal(nrow, ncol, colind, row)) {
 
-            // Found match!
-            own(ref.get());
-            return;
-
-          } else { // There is a hash rowision (unlikely, but possible)
-            // Leave the pattern alone, continue to the next matching pattern
-            continue;
+            // Found match, unless it is being deleted by another thread
+            if (try_own(ref)) return;
           }
+          // Otherwise a hash collision (unlikely, but possible), continue
+          continue;
         } else {
 
           // Check if one of the other cache entries indeed has a matching sparsity
@@ -915,14 +1052,9 @@ namespace casadi {
           for (; j!=eq.second; ++j) {
             if (j->second.alive()) {
 
-              // Recover cached sparsity
-              Sparsity ref = shared_cast<Sparsity>(j->second.shared());
-
               // Match found if sparsity matches
-              if (ref.is_equal(nrow, ncol, colind, row)) {
-                own(ref.get());
-                return;
-              }
+              SparsityInternal* ref = static_cast<SparsityInternal*>(j->second->raw_);
+              if (ref->is_equal(nrow, ncol, colind, row) && try_own(ref)) return;
             }
           }
 
@@ -1077,12 +1209,7 @@ namespace casadi {
   }
 
   Sparsity Sparsity::banded(casadi_int n, casadi_int p) {
-    // This is not an efficient implementation
-    Sparsity ret = Sparsity(n, n);
-    for (casadi_int i=-p;i<=p;++i) {
-      ret = ret + Sparsity::band(n, i);
-    }
-    return ret;
+    return SparsityInternal::full_band(n, p, p);
   }
 
   Sparsity Sparsity::unit(casadi_int n, casadi_int el) {
@@ -873,8 +873,14 @@ namespace casadi {
 #ifndef SWIG
     typedef std::unordered_multimap<std::size_t, WeakRef> CachingMap;
 
-    /// Cached sparsity patterns
-    static CachingMap& getCache();
+    /// Number of partitions of the pattern cache, locked independently
+    static const std::size_t n_cache_shard = 16;
+
+    /// Cached sparsity patterns in the partition of hash h
+    static CachingMap& getCache(std::size_t h);
+
+    /// Remove a pattern which is being destroyed from the cache
+    static void uncache(const SparsityInternal* node);
 
     /// (Dense) scalar
     static const Sparsity& getScalar();
@@ -1002,6 +1008,15 @@ namespace casadi {
         \identifier{d8} */
     std::vector<casadi_int> amd() const;
 
+    /** \brief Nested dissection preordering
+
+      Fill-reducing ordering for a symmetric sparsity pattern, as amd. The graph of the
+      pattern is recursively split in two by a vertex separator, which is ordered after
+      the two parts. This gives less fill than amd for patterns from 2-D and 3-D meshes,
+      and a balanced elimination tree. Parts with at most leaf_size nodes are ordered
+      with amd. */
+    std::vector<casadi_int> nd(casadi_int leaf_size=64) const;
+
 #ifndef SWIG
     /** \brief Propagate sparsity through a linear solve
 
@@ -1179,6 +1194,11 @@ namespace casadi {
     void assign_cached(casadi_int nrow, casadi_int ncol,
                         const casadi_int* colind, const casadi_int* row, bool order_rows=false);
 
+    /// Symbolic LDL and QR factorizations, without caching
+    Sparsity ldl_calc(std::vector<casadi_int>& p, bool amd) const;
+    void qr_calc(Sparsity& V, Sparsity& R, std::vector<casadi_int>& prinv,
+                 std::vector<casadi_int>& pc, bool amd) const;
+
 #endif //SWIG
   };
 
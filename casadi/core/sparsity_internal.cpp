@@ -31,6 +31,14 @@
 #include <cstdlib>
 #include <cmath>
 
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
 namespace casadi {
   void SparsityInternal::etree(const casadi_int* sp, casadi_int* parent,
       casadi_int *w, casadi_int ata) {
@@ -449,7 +457,8 @@ namespace casadi {
   SparsityInternal::
   SparsityInternal(casadi_int nrow, casadi_int ncol,
       const casadi_int* colind, const casadi_int* row) :
-    sp_(2 + ncol+1 + colind[ncol]), btf_(nullptr) {
+    sp_(2 + ncol+1 + colind[ncol]), btf_(nullptr), symbolic_(nullptr),
+    struct_kind_(STRUCT_UNKNOWN), struct_lower_(-1), struct_upper_(-1) {
     sp_[0] = nrow;
     sp_[1] = ncol;
     std::copy(colind, colind+ncol+1, sp_.begin()+2);
@@ -457,7 +466,12 @@ namespace casadi {
   }
 
   SparsityInternal::~SparsityInternal() {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    // Remove from the cache before the memory is released
+    Sparsity::uncache(this);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
     delete btf_;
+    delete symbolic_;
   }
 
   const SparsityInternal::Btf& SparsityInternal::btf() const {
@@ -469,6 +483,32 @@ namespace casadi {
     return *btf_;
   }
 
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+  // Guards the symbolic_ caches of all patterns
+  static std::mutex symbolic_mtx;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
+  const std::vector<std::vector<casadi_int> >& SparsityInternal::symbolic(const std::string& key,
+      const std::function<std::vector<std::vector<casadi_int> >()>& fcn) const {
+    {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::lock_guard<std::mutex> lock(symbolic_mtx);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+      if (symbolic_) {
+        auto it = symbolic_->find(key);
+        if (it!=symbolic_->end()) return it->second;
+      }
+    }
+    // Not holding the lock while calculating, which may use other cached results
+    std::vector<std::vector<casadi_int> > r = fcn();
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::lock_guard<std::mutex> lock(symbolic_mtx);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    if (!symbolic_) symbolic_ = new std::map<std::string, std::vector<std::vector<casadi_int> > >();
+    // Entries are never removed, so the reference remains valid
+    return symbolic_->insert(std::make_pair(key, r)).first->second;
+  }
+
 
   casadi_int SparsityInternal::numel() const {
     return size1()*size2();
@@ -494,7 +534,81 @@ namespace casadi {
     return col;
   }
 
+  SparsityInternal::StructureKind
+  SparsityInternal::structure(casadi_int& lower, casadi_int& upper) const {
+    if (struct_kind_==STRUCT_UNKNOWN) {
+      const casadi_int* colind = this->colind();
+      const casadi_int* row = this->row();
+      casadi_int n = size2();
+      casadi_int kind = STRUCT_GENERAL, kl = -1, ku = -1;
+      // Rows are sorted, so a column is contiguous if its first and last rows and its
+      // number of nonzeros match
+      bool nonempty = size1()==n && n>0;
+      for (casadi_int c=0; c<n && nonempty; ++c) nonempty = colind[c+1]>colind[c];
+      if (nonempty) {
+        // Bandwidths
+        kl = ku = 0;
+        for (casadi_int c=0; c<n; ++c) {
+          ku = std::max(ku, c - row[colind[c]]);
+          kl = std::max(kl, row[colind[c+1]-1] - c);
+        }
+        // Full band?
+        kind = STRUCT_BANDED;
+        for (casadi_int c=0; c<n && kind==STRUCT_BANDED; ++c) {
+          casadi_int r0 = std::max(casadi_int(0), c-ku), r1 = std::min(n-1, c+kl);
+          if (row[colind[c]]!=r0 || row[colind[c+1]-1]!=r1 || colind[c+1]-colind[c]!=r1-r0+1) {
+            kind = STRUCT_GENERAL;
+          }
+        }
+        // Block diagonal with dense blocks of the size of the first one?
+        casadi_int bs = colind[1];
+        if (kind==STRUCT_GENERAL && n % bs == 0) {
+          kind = STRUCT_BLOCKDIAG;
+          kl = ku = bs;
+          for (casadi_int c=0; c<n && kind==STRUCT_BLOCKDIAG; ++c) {
+            if (colind[c+1]-colind[c]!=bs || row[colind[c]]!=(c/bs)*bs) kind = STRUCT_GENERAL;
+          }
+        }
+        if (kind==STRUCT_GENERAL) kl = ku = -1;
+      }
+      struct_lower_ = kl;
+      struct_upper_ = ku;
+      struct_kind_ = kind;
+    }
+    lower = struct_lower_;
+    upper = struct_upper_;
+    return static_cast<StructureKind>(struct_kind_);
+  }
+
+  Sparsity SparsityInternal::full_band(casadi_int n, casadi_int lower, casadi_int upper) {
+    casadi_assert_dev(n>=0 && lower>=0 && upper>=0);
+    lower = std::min(lower, std::max(n-1, casadi_int(0)));
+    upper = std::min(upper, std::max(n-1, casadi_int(0)));
+    std::vector<casadi_int> colind(n+1), row;
+    row.reserve(n*(lower+upper+1));
+    colind[0] = 0;
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int r=std::max(casadi_int(0), c-upper); r<=std::min(n-1, c+lower); ++r) {
+        row.push_back(r);
+      }
+      colind[c+1] = row.size();
+    }
+    return Sparsity(n, n, colind, row);
+  }
+
   Sparsity SparsityInternal::T() const {
+    // Band and block structures are transposed without sorting
+    casadi_int lower, upper;
+    switch (structure(lower, upper)) {
+      case STRUCT_BANDED:
+        if (lower!=upper) return full_band(size1(), upper, lower);
+        // fall-through
+      case STRUCT_BLOCKDIAG:
+        return shared_from_this<Sparsity>();
+      default:
+        break;
+    }
+
     // Dummy mapping
     std::vector<casadi_int> mapping;
 
@@ -503,6 +617,31 @@ namespace casadi {
 
   Sparsity SparsityInternal::transpose(
       std::vector<casadi_int>& mapping, bool invert_mapping) const {
+    // Band and block structures have contiguous columns: entry (j, i) of the
+    // original is found at an offset j from the first row of column i
+    casadi_int lower, upper;
+    StructureKind s = structure(lower, upper);
+    if (s==STRUCT_BANDED || s==STRUCT_BLOCKDIAG) {
+      Sparsity ret = T();
+      const casadi_int* colind = this->colind();
+      const casadi_int* row = this->row();
+      const casadi_int* t_colind = ret.colind();
+      const casadi_int* t_row = ret.row();
+      mapping.resize(nnz());
+      for (casadi_int j=0; j<ret.size2(); ++j) {
+        for (casadi_int k=t_colind[j]; k<t_colind[j+1]; ++k) {
+          casadi_int i = t_row[k];
+          casadi_int el = colind[i] + j - row[colind[i]];
+          if (invert_mapping) {
+            mapping[el] = k;
+          } else {
+            mapping[k] = el;
+          }
+        }
+      }
+      return ret;
+    }
+
     // Get the sparsity of the transpose in sparse triplet form
     std::vector<casadi_int> trans_col = get_row();
     std::vector<casadi_int> trans_row = get_col();
@@ -960,6 +1099,105 @@ namespace casadi {
     #undef FLIP
   }
 
+  std::vector<casadi_int> SparsityInternal::nd(casadi_int leaf_size) const {
+    casadi_assert(is_symmetric(), "Nested dissection requires a symmetric matrix");
+    casadi_int n=size2();
+    const casadi_int *colind = this->colind(), *row = this->row();
+    Sparsity sp = shared_from_this<Sparsity>();
+
+    // Ordering, separators are eliminated after the parts they separate
+    std::vector<casadi_int> p(n);
+    // Membership of the current subgraph, level in the breadth-first search
+    std::vector<bool> in_graph(n, false);
+    std::vector<casadi_int> level(n, -1), queue;
+    queue.reserve(n);
+
+    // Breadth-first search within the current subgraph, returns the number of levels
+    auto bfs = [&](casadi_int root) {
+      for (casadi_int i : queue) level[i] = -1;
+      queue.clear();
+      queue.push_back(root);
+      level[root] = 0;
+      for (casadi_int k=0; k<queue.size(); ++k) {
+        casadi_int i = queue[k];
+        for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
+          casadi_int j = row[el];
+          if (in_graph[j] && level[j]<0) {
+            level[j] = level[i]+1;
+            queue.push_back(j);
+          }
+        }
+      }
+      return level[queue.back()]+1;
+    };
+
+    // Subgraphs to be ordered, with the end of their segment in p
+    std::vector<std::pair<std::vector<casadi_int>, casadi_int> > stack;
+    if (n>0) stack.push_back(std::make_pair(range(n), n));
+    while (!stack.empty()) {
+      std::vector<casadi_int> nodes = stack.back().first;
+      casadi_int end = stack.back().second;
+      stack.pop_back();
+      casadi_int begin = end - nodes.size();
+
+      // Bisect the subgraph if large enough
+      std::vector<casadi_int> part1, part2, sep;
+      if (nodes.size()>leaf_size) {
+        for (casadi_int i : nodes) in_graph[i] = true;
+        // Pseudo-peripheral node: move to the last node found while the number of levels grows
+        casadi_int root = nodes.front(), n_level = bfs(root);
+        while (true) {
+          casadi_int cand = queue.back(), n_level_cand = bfs(cand);
+          if (n_level_cand<=n_level) break;
+          root = cand;
+          n_level = n_level_cand;
+        }
+        n_level = bfs(root);
+        if (queue.size()<nodes.size()) {
+          // Disconnected: the component of root, then the rest
+          for (casadi_int i : nodes) (level[i]<0 ? part2 : part1).push_back(i);
+        } else if (n_level>=3) {
+          // Smallest level splitting the nodes with at most a 2:1 imbalance,
+          // or else the level closest to the middle
+          std::vector<casadi_int> count(n_level, 0);
+          for (casadi_int i : nodes) count[level[i]]++;
+          casadi_int mid = -1, cum = 0, nn = nodes.size();
+          for (casadi_int l=1; l<n_level-1; ++l) {
+            cum += count[l-1];
+            if (3*cum>=nn && 3*(cum+count[l])<=2*nn && (mid<0 || count[l]<count[mid])) mid = l;
+          }
+          if (mid<0) {
+            for (mid=1, cum=count[0]; mid<n_level-2 && 2*(cum+count[mid])<nn; ) cum += count[mid++];
+          }
+          // Separator: nodes of the middle level connected to the next level
+          for (casadi_int i : nodes) {
+            bool in_sep = false;
+            if (level[i]==mid) {
+              for (casadi_int el=colind[i]; el<colind[i+1] && !in_sep; ++el) {
+                in_sep = in_graph[row[el]] && level[row[el]]==mid+1;
+              }
+            }
+            (in_sep ? sep : level[i]<=mid ? part1 : part2).push_back(i);
+          }
+        }
+        for (casadi_int i : nodes) in_graph[i] = false;
+      }
+
+      if (part1.empty() || part2.empty()) {
+        // Leaf, or no separator found: approximate minimum degree
+        std::vector<casadi_int> mapping;
+        std::vector<casadi_int> q = sp.sub(nodes, nodes, mapping).amd();
+        for (casadi_int k=0; k<nodes.size(); ++k) p[begin+k] = nodes[q[k]];
+      } else {
+        // Separator last, the parts are ordered in turn
+        std::copy(sep.begin(), sep.end(), p.begin()+end-sep.size());
+        stack.push_back(std::make_pair(part2, end-sep.size()));
+        stack.push_back(std::make_pair(part1, begin+part1.size()));
+      }
+    }
+    return p;
+  }
+
   void SparsityInternal::bfs(casadi_int n, std::vector<casadi_int>& wi, std::vector<casadi_int>& wj,
                               std::vector<casadi_int>& queue, const std::vector<casadi_int>& imatch,
                               const std::vector<casadi_int>& jmatch, casadi_int mark) const {
@@ -1739,6 +1977,18 @@ namespace casadi {
     // Quick return if second factor is diagonal
     if (y.is_diag()) return shared_from_this<Sparsity>();
 
+    // Products of full bands and of block diagonals with equal blocks keep the structure
+    if (is_square() && y.is_square() && d1==d2) {
+      casadi_int x_lower, x_upper, y_lower, y_upper;
+      StructureKind x_s = structure(x_lower, x_upper);
+      StructureKind y_s = y->structure(y_lower, y_upper);
+      if (x_s==STRUCT_BANDED && y_s==STRUCT_BANDED) {
+        return full_band(d1, x_lower + y_lower, x_upper + y_upper);
+      } else if (x_s==STRUCT_BLOCKDIAG && y_s==STRUCT_BLOCKDIAG && x_lower==y_lower) {
+        return shared_from_this<Sparsity>();
+      }
+    }
+
     // Direct access to the vectors
     const casadi_int* x_row = row();
     const casadi_int* x_colind = colind();
@@ -1829,6 +2079,12 @@ namespace casadi {
   }
 
   bool SparsityInternal::is_symmetric() const {
+    casadi_int lower, upper;
+    switch (structure(lower, upper)) {
+      case STRUCT_BANDED: return lower==upper;
+      case STRUCT_BLOCKDIAG: return true;
+      default: break;
+    }
     return is_transpose(*this);
   }
 
@@ -29,6 +29,8 @@
 
 #include "sparsity.hpp"
 #include "shared_object_internal.hpp"
+#include <functional>
+#include <map>
 /// \cond INTERNAL
 
 namespace casadi {
@@ -63,7 +65,21 @@ namespace casadi {
         \identifier{23j} */
     mutable Btf* btf_;
 
+    /** \brief Orderings and symbolic factorizations, keyed by operation and arguments
+
+      Calculated on first call, then cached. Sparsity patterns are stored compressed,
+      such that a pattern is never kept alive by the cache of another pattern */
+    mutable std::map<std::string, std::vector<std::vector<casadi_int> > >* symbolic_;
+
+    /** \brief Band or block structure, see structure()
+
+      Calculated on first call, then cached */
+    mutable casadi_int struct_kind_, struct_lower_, struct_upper_;
+
   public:
+    /// Structures recognized by structure()
+    enum StructureKind {STRUCT_UNKNOWN, STRUCT_GENERAL, STRUCT_BANDED, STRUCT_BLOCKDIAG};
+
     /// Construct a sparsity pattern from arrays
     SparsityInternal(casadi_int nrow, casadi_int ncol,
                      const casadi_int* colind, const casadi_int* row);
@@ -141,6 +157,18 @@ namespace casadi {
         \identifier{en} */
     std::vector<casadi_int> amd() const;
 
+    /** \brief Nested dissection preordering
+
+      * Bisection by breadth-first level structures from a pseudo-peripheral node,
+      * cf. George & Liu. Parts with at most leaf_size nodes are ordered with AMD. */
+    std::vector<casadi_int> nd(casadi_int leaf_size) const;
+
+    /** \brief Cached ordering or symbolic factorization, calculated by fcn on first call
+
+        Shared by all users of the sparsity pattern */
+    const std::vector<std::vector<casadi_int> >& symbolic(const std::string& key,
+      const std::function<std::vector<std::vector<casadi_int> >()>& fcn) const;
+
     /** \brief Calculate the elimination tree for a matrix
 
       * len[w] >= ata ? ncol + nrow : ncol
@@ -276,6 +304,17 @@ namespace casadi {
     static void ldl_row(const casadi_int* sp, const casadi_int* parent,
       casadi_int* l_colind, casadi_int* l_row, casadi_int *w);
 
+    /** \brief Detect a full band or a block diagonal with dense square blocks
+
+      For STRUCT_BANDED, every entry within the lower and upper bandwidths is nonzero.
+      For STRUCT_BLOCKDIAG, lower and upper are both set to the block size. Requires
+      O(ncol) operations on the first call, then cached.
+    */
+    StructureKind structure(casadi_int& lower, casadi_int& upper) const;
+
+    /// Create a full band with given lower and upper bandwidths, in O(nnz)
+    static Sparsity full_band(casadi_int n, casadi_int lower, casadi_int upper);
+
     /// Transpose the matrix
     Sparsity T() const;
 
@@ -34,25 +34,44 @@ namespace casadi {
 
     // Consitency check
     casadi_assert_dev(!f_.empty());
+
+    lazy_derivatives_ = false;
   }
 
   void Switch::serialize_body(SerializingStream &s) const {
     FunctionInternal::serialize_body(s);
-    s.version("Switch", 1);
+    s.version("Switch", 2);
     s.pack("Switch::f", f_);
     s.pack("Switch::f_def", f_def_);
     s.pack("Switch::project_in", project_in_);
     s.pack("Switch::project_out", project_out_);
+    s.pack("Switch::lazy_derivatives", lazy_derivatives_);
   }
 
   Switch::Switch(DeserializingStream& s) : FunctionInternal(s) {
-    s.version("Switch", 1);
+    int version = s.version("Switch", 1, 2);
     s.unpack("Switch::f", f_);
     s.unpack("Switch::f_def", f_def_);
     s.unpack("Switch::project_in", project_in_);
     s.unpack("Switch::project_out", project_out_);
+    if (version>=2) {
+      s.unpack("Switch::lazy_derivatives", lazy_derivatives_);
+    } else {
+      lazy_derivatives_ = false;
+    }
+    init_offsets();
   }
 
+  const Options Switch::options_
+  = {{&FunctionInternal::options_},
+     {{"lazy_derivatives",
+       {OT_BOOL,
+        "Generate the forward and reverse derivatives of each case when the case is "
+        "first evaluated, rather than for all cases when the derivative of the Switch "
+        "is created. Derivatives created this way cannot be code generated (Default: false)"}}
+     }
+  };
+
   Switch::~Switch() {
     clear_mem();
   }
@@ -105,11 +124,18 @@ namespace casadi {
     // Call the initialization method of the base class
     FunctionInternal::init(opts);
 
-    // Buffer for mismatching sparsities
-    size_t sz_buf=0;
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="lazy_derivatives") {
+        lazy_derivatives_ = op.second;
+      }
+    }
 
     // Keep track of sparsity projections
-    project_in_ = project_out_ = false;
+    init_offsets();
+
+    // Buffer for mismatching sparsities
+    size_t sz_buf=0;
 
     // Get required work
     for (casadi_int k=0; k<=f_.size(); ++k) {
@@ -122,21 +148,19 @@ namespace casadi {
       // Required work vectors
       size_t sz_buf_k=0;
 
-      // Add size for input buffers
+      // Add size for input buffers, unless the nonzeros can be passed in place
       for (casadi_int i=1; i<n_in_; ++i) {
         const Sparsity& s = fk.sparsity_in(i-1);
-        if (s!=sparsity_in_[i]) {
-          project_in_ = true;
+        if (off_in_[k][i-1]<0) {
           alloc_w(s.size1()); // for casadi_project
           sz_buf_k += s.nnz();
         }
       }
 
-      // Add size for output buffers
+      // Add size for output buffers, unless the nonzeros can be written in place
       for (casadi_int i=0; i<n_out_; ++i) {
         const Sparsity& s = fk.sparsity_out(i);
-        if (s!=sparsity_out_[i]) {
-          project_out_ = true;
+        if (off_out_[k][i]<0) {
           alloc_w(s.size1()); // for casadi_project
           sz_buf_k += s.nnz();
         }
@@ -150,22 +174,58 @@ namespace casadi {
     alloc_w(sz_buf, true);
   }
 
+  // Offset of the nonzeros of f_sp in those of sp, a superset, -1 if not contiguous
+  static casadi_int nz_offset(const Sparsity& f_sp, const Sparsity& sp) {
+    if (f_sp==sp || f_sp.nnz()==0) return 0;
+    std::vector<casadi_int> nz = f_sp.find();
+    sp.get_nz(nz);
+    for (casadi_int j=1; j<nz.size(); ++j) {
+      if (nz[j]!=nz[0]+j) return -1;
+    }
+    return nz[0];
+  }
+
+  void Switch::init_offsets() {
+    project_in_ = project_out_ = false;
+    off_in_.assign(f_.size()+1, std::vector<casadi_int>());
+    off_out_.assign(f_.size()+1, std::vector<casadi_int>());
+    for (casadi_int k=0; k<=f_.size(); ++k) {
+      const Function& fk = k<f_.size() ? f_[k] : f_def_;
+      if (fk.is_null()) continue;
+      off_in_[k].resize(n_in_-1);
+      for (casadi_int i=0; i<n_in_-1; ++i) {
+        const Sparsity& f_sp = fk.sparsity_in(i);
+        if (f_sp!=sparsity_in_[i+1]) project_in_ = true;
+        off_in_[k][i] = nz_offset(f_sp, sparsity_in_[i+1]);
+      }
+      off_out_[k].resize(n_out_);
+      for (casadi_int i=0; i<n_out_; ++i) {
+        const Sparsity& f_sp = fk.sparsity_out(i);
+        if (f_sp!=sparsity_out_[i]) project_out_ = true;
+        off_out_[k][i] = nz_offset(f_sp, sparsity_out_[i]);
+      }
+    }
+  }
+
   int Switch::eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
     // Get the function to be evaluated
     casadi_int k = arg[0] ? static_cast<casadi_int>(*arg[0]) : 0;
-    const Function& fk = k>=0 && k<f_.size() ? f_[k] : f_def_;
+    if (k<0 || k>=f_.size()) k = f_.size();
+    const Function& fk = k<f_.size() ? f_[k] : f_def_;
+    if (fk.is_null()) return 1;
 
-    // Project arguments with different sparsity
+    // Pass arguments with different sparsity in place, or projected
     const double** arg1;
     if (project_in_) {
-      // Project one or more argument
       arg1 = arg + n_in_;
       for (casadi_int i=0; i<n_in_-1; ++i) {
-        const Sparsity& f_sp = fk.sparsity_in(i);
-        const Sparsity& sp = sparsity_in_[i+1];
         arg1[i] = arg[i+1];
-        if (arg1[i] && f_sp!=sp) {
-          casadi_project(arg1[i], sp, w, f_sp, w + f_sp.nnz());
+        casadi_int off = off_in_[k][i];
+        if (arg1[i] && off>0) {
+          arg1[i] += off;
+        } else if (arg1[i] && off<0) {
+          const Sparsity& f_sp = fk.sparsity_in(i);
+          casadi_project(arg1[i], sparsity_in_[i+1], w, f_sp, w + f_sp.nnz());
           arg1[i] = w; w += f_sp.nnz();
         }
       }
@@ -174,18 +234,23 @@ namespace casadi {
       arg1 = arg + 1;
     }
 
-    // Temporary memory for results with different sparsity
+    // Write results with different sparsity in place, or to a buffer
     double** res1;
     if (project_out_) {
-      // Project one or more results
       res1 = res + n_out_;
       for (casadi_int i=0; i<n_out_; ++i) {
-        const Sparsity& f_sp = fk.sparsity_out(i);
-        const Sparsity& sp = sparsity_out_[i];
         res1[i] = res[i];
-        if (res1[i] && f_sp!=sp) {
+        if (!res1[i]) continue;
+        casadi_int off = off_out_[k][i];
+        casadi_int nnz = fk.nnz_out(i), nnz_sw = nnz_out(i);
+        if (off<0) {
           res1[i] = w;
-          w += f_sp.nnz();
+          w += nnz;
+        } else if (nnz<nnz_sw) {
+          // Zero the entries outside of the case's nonzeros
+          casadi_clear(res1[i], off);
+          casadi_clear(res1[i] + off + nnz, nnz_sw - off - nnz);
+          res1[i] += off;
         }
       }
     } else {
@@ -196,19 +261,23 @@ namespace casadi {
     // Evaluate the corresponding function
     if (fk(arg1, res1, iw, w, 0)) return 1;
 
-    // Project results with different sparsity
+    // Project results written to a buffer
     if (project_out_) {
       for (casadi_int i=0; i<n_out_; ++i) {
-        const Sparsity& f_sp = fk.sparsity_out(i);
-        const Sparsity& sp = sparsity_out_[i];
-        if (res[i] && f_sp!=sp) {
-          casadi_project(res1[i], f_sp, res[i], sp, w);
+        if (res[i] && off_out_[k][i]<0) {
+          casadi_project(res1[i], fk.sparsity_out(i), res[i], sparsity_out_[i], w);
         }
       }
     }
     return 0;
   }
 
+  // Directional derivatives of a case, generated on first use
+  static Function lazy_derivative(const Function& f, bool fwd, casadi_int nder) {
+    std::string name = (fwd ? "fwd" : "adj") + str(nder) + "_" + f.name();
+    return Function::create(new LazyDerivative(name, f, fwd, nder), Dict());
+  }
+
   Function Switch
   ::get_forward(casadi_int nfwd, const std::string& name,
                 const std::vector<std::string>& inames,
@@ -217,15 +286,19 @@ namespace casadi {
     // Derivative of each case
     std::vector<Function> der(f_.size());
     for (casadi_int k=0; k<f_.size(); ++k) {
-      if (!f_[k].is_null()) der[k] = f_[k].forward(nfwd);
+      if (f_[k].is_null()) continue;
+      der[k] = lazy_derivatives_ ? lazy_derivative(f_[k], true, nfwd) : f_[k].forward(nfwd);
     }
 
     // Default case
     Function der_def;
-    if (!f_def_.is_null()) der_def = f_def_.forward(nfwd);
+    if (!f_def_.is_null()) {
+      der_def = lazy_derivatives_ ? lazy_derivative(f_def_, true, nfwd) : f_def_.forward(nfwd);
+    }
 
     // New Switch for derivatives
-    Function sw = Function::conditional("switch_" + name, der, der_def);
+    Function sw = Function::conditional("switch_" + name, der, der_def,
+                                        {{"lazy_derivatives", lazy_derivatives_}});
 
     // Get expressions for the derivative switch
     std::vector<MX> arg = sw.mx_in();
@@ -248,15 +321,19 @@ namespace casadi {
     // Derivative of each case
     std::vector<Function> der(f_.size());
     for (casadi_int k=0; k<f_.size(); ++k) {
-      if (!f_[k].is_null()) der[k] = f_[k].reverse(nadj);
+      if (f_[k].is_null()) continue;
+      der[k] = lazy_derivatives_ ? lazy_derivative(f_[k], false, nadj) : f_[k].reverse(nadj);
     }
 
     // Default case
     Function der_def;
-    if (!f_def_.is_null()) der_def = f_def_.reverse(nadj);
+    if (!f_def_.is_null()) {
+      der_def = lazy_derivatives_ ? lazy_derivative(f_def_, false, nadj) : f_def_.reverse(nadj);
+    }
 
     // New Switch for derivatives
-    Function sw = Function::conditional("switch_" + name, der, der_def);
+    Function sw = Function::conditional("switch_" + name, der, der_def,
+                                        {{"lazy_derivatives", lazy_derivatives_}});
 
     // Get expressions for the derivative switch
     std::vector<MX> arg = sw.mx_in();
@@ -288,6 +365,14 @@ namespace casadi {
     }
   }
 
+  bool Switch::has_codegen() const {
+    for (casadi_int k=0; k<=f_.size(); ++k) {
+      const Function& fk = k<f_.size() ? f_[k] : f_def_;
+      if (!fk.is_null() && !fk->has_codegen()) return false;
+    }
+    return true;
+  }
+
   void Switch::codegen_declarations(CodeGenerator& g) const {
     for (casadi_int k=0; k<=f_.size(); ++k) {
       const Function& fk = k<f_.size() ? f_[k] : f_def_;
@@ -428,32 +513,36 @@ namespace casadi {
       if (fk.is_null()) {
         g << "return 1;\n";
       } else {
-        // Project arguments with different sparsity
+        // Pass arguments with different sparsity in place, or projected
         for (casadi_int i=0; i<n_in_-1; ++i) {
-          const Sparsity& f_sp = fk.sparsity_in(i);
-          const Sparsity& sp = sparsity_in_[i+1];
-          if (f_sp!=sp) {
-            if (f_sp.nnz()==0) {
-              g << "arg1[" << i << "]=0;\n";
-            } else {
-              g.local("t", "casadi_real", "*");
-              g << "t=w, w+=" << f_sp.nnz() << ";\n"
-                << g.project("arg1[" + str(i) + "]", sp, "t", f_sp, "w") << "\n"
-                << "arg1[" << i << "]=t;\n";
-            }
+          std::string a = "arg1[" + str(i) + "]";
+          casadi_int off = off_in_[k1][i];
+          if (off>0) {
+            g << "if (" << a << ") " << a << "+=" << off << ";\n";
+          } else if (off<0) {
+            const Sparsity& f_sp = fk.sparsity_in(i);
+            g.local("t", "casadi_real", "*");
+            g << "if (" << a << ") {\n"
+              << "t=w, w+=" << f_sp.nnz() << ";\n"
+              << g.project(a, sparsity_in_[i+1], "t", f_sp, "w") << "\n"
+              << a << "=t;\n"
+              << "}\n";
           }
         }
 
-        // Temporary memory for results with different sparsity
+        // Write results with different sparsity in place, or to a buffer
         for (casadi_int i=0; i<n_out_; ++i) {
-          const Sparsity& f_sp = fk.sparsity_out(i);
-          const Sparsity& sp = sparsity_out_[i];
-          if (f_sp!=sp) {
-            if (f_sp.nnz()==0) {
-              g << "res1[" << i << "]=0;\n";
-            } else {
-              g << "res1[" << i << "]=w, w+=" << f_sp.nnz() << ";\n";
-            }
+          std::string r = "res1[" + str(i) + "]";
+          casadi_int off = off_out_[k1][i];
+          casadi_int nnz = fk.nnz_out(i), nnz_sw = nnz_out(i);
+          if (off<0) {
+            g << "if (" << r << ") " << r << "=w, w+=" << nnz << ";\n";
+          } else if (nnz<nnz_sw) {
+            g << "if (" << r << ") {\n";
+            if (off>0) g << g.clear(r, off) << "\n";
+            if (off+nnz<nnz_sw) g << g.clear(r + "+" + str(off+nnz), nnz_sw-off-nnz) << "\n";
+            if (off>0) g << r << "+=" << off << ";\n";
+            g << "}\n";
           }
         }
 
@@ -462,13 +551,12 @@ namespace casadi {
                          project_out_ ? "res1" : "res",
                          "iw", "w") << ") return 1;\n";
 
-        // Project results with different sparsity
+        // Project results written to a buffer
         for (casadi_int i=0; i<n_out_; ++i) {
-          const Sparsity& f_sp = fk.sparsity_out(i);
-          const Sparsity& sp = sparsity_out_[i];
-          if (f_sp!=sp) {
-            g << g.project("res1[" + str(i) + "]", f_sp,
-                           g.res(i), sp, "w") << "\n";
+          if (off_out_[k1][i]<0) {
+            g << "if (" << g.res(i) << ") "
+              << g.project("res1[" + str(i) + "]", fk.sparsity_out(i),
+                           g.res(i), sparsity_out_[i], "w") << "\n";
           }
         }
 
@@ -494,4 +582,150 @@ namespace casadi {
     if (!f_def_.is_null()) add_embedded(all_fun, f_def_, max_depth);
   }
 
+  LazyDerivative::LazyDerivative(const std::string& name, const Function& f,
+                                 bool fwd, casadi_int nder)
+    : FunctionInternal(name), f_(f), fwd_(fwd), nder_(nder) {
+  }
+
+  LazyDerivative::~LazyDerivative() {
+    clear_mem();
+  }
+
+  size_t LazyDerivative::get_n_in() {
+    return f_.n_in() + f_.n_out() + (fwd_ ? f_.n_in() : f_.n_out());
+  }
+
+  size_t LazyDerivative::get_n_out() {
+    return fwd_ ? f_.n_out() : f_.n_in();
+  }
+
+  Sparsity LazyDerivative::get_sparsity_in(casadi_int i) {
+    casadi_int n_in = f_.n_in(), n_out = f_.n_out();
+    if (i<n_in) return f_.sparsity_in(i);
+    if (i<n_in+n_out) return f_.sparsity_out(i-n_in);
+    i -= n_in + n_out;
+    return repmat(fwd_ ? f_.sparsity_in(i) : f_.sparsity_out(i), 1, nder_);
+  }
+
+  Sparsity LazyDerivative::get_sparsity_out(casadi_int i) {
+    return repmat(fwd_ ? f_.sparsity_out(i) : f_.sparsity_in(i), 1, nder_);
+  }
+
+  const Function& LazyDerivative::derivative() const {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+    if (der_.is_null()) {
+      if (verbose_) casadi_message("Generating derivative '" + name_ + "'");
+      Function der = fwd_ ? f_.forward(nder_) : f_.reverse(nder_);
+      // The derivative may expect other input sparsities, project in that case
+      for (casadi_int i=0; i<n_in_; ++i) {
+        if (der.sparsity_in(i)!=sparsity_in_[i]) {
+          std::vector<MX> arg = mx_in();
+          der = Function(name_, arg, der(arg), name_in_, name_out_);
+          break;
+        }
+      }
+      der_ = der;
+    }
+    return der_;
+  }
+
+  void LazyDerivative::free_mem(void *mem) const {
+    auto m = static_cast<LazyDerivativeMemory*>(mem);
+    if (m->mem>=0) der_.release(m->mem);
+    delete m;
+  }
+
+  int LazyDerivative::eval(const double** arg, double** res,
+      casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<LazyDerivativeMemory*>(mem);
+    const Function& der = derivative();
+    // Allocate work vectors and memory on first use
+    if (m->mem<0) {
+      m->arg.resize(der.sz_arg());
+      m->res.resize(der.sz_res());
+      m->iw.resize(der.sz_iw());
+      m->w.resize(der.sz_w());
+      m->mem = der.checkout();
+    }
+    std::copy_n(arg, n_in_, m->arg.begin());
+    std::copy_n(res, n_out_, m->res.begin());
+    return der(get_ptr(m->arg), get_ptr(m->res), get_ptr(m->iw), get_ptr(m->w), m->mem);
+  }
+
+  int LazyDerivative::eval_sx(const SXElem** arg, SXElem** res,
+      casadi_int* iw, SXElem* w, void* mem) const {
+    const Function& der = derivative();
+    std::vector<const SXElem*> arg1(der.sz_arg());
+    std::vector<SXElem*> res1(der.sz_res());
+    std::vector<casadi_int> iw1(der.sz_iw());
+    std::vector<SXElem> w1(der.sz_w());
+    std::copy_n(arg, n_in_, arg1.begin());
+    std::copy_n(res, n_out_, res1.begin());
+    return der(get_ptr(arg1), get_ptr(res1), get_ptr(iw1), get_ptr(w1), 0);
+  }
+
+  int LazyDerivative::sp_forward(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem) const {
+    const Function& der = derivative();
+    std::vector<const bvec_t*> arg1(der.sz_arg());
+    std::vector<bvec_t*> res1(der.sz_res());
+    std::vector<casadi_int> iw1(der.sz_iw());
+    std::vector<bvec_t> w1(der.sz_w());
+    std::copy_n(arg, n_in_, arg1.begin());
+    std::copy_n(res, n_out_, res1.begin());
+    return der(get_ptr(arg1), get_ptr(res1), get_ptr(iw1), get_ptr(w1), 0);
+  }
+
+  int LazyDerivative::sp_reverse(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem) const {
+    const Function& der = derivative();
+    std::vector<bvec_t*> arg1(der.sz_arg());
+    std::vector<bvec_t*> res1(der.sz_res());
+    std::vector<casadi_int> iw1(der.sz_iw());
+    std::vector<bvec_t> w1(der.sz_w());
+    std::copy_n(arg, n_in_, arg1.begin());
+    std::copy_n(res, n_out_, res1.begin());
+    return der.rev(get_ptr(arg1), get_ptr(res1), get_ptr(iw1), get_ptr(w1), 0);
+  }
+
+  Function LazyDerivative::get_forward(casadi_int nfwd, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    Function df = derivative().forward(nfwd);
+    std::vector<MX> arg = df.mx_in();
+    return Function(name, arg, df(arg), inames, onames, opts);
+  }
+
+  Function LazyDerivative::get_reverse(casadi_int nadj, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    Function df = derivative().reverse(nadj);
+    std::vector<MX> arg = df.mx_in();
+    return Function(name, arg, df(arg), inames, onames, opts);
+  }
+
+  void LazyDerivative::find(std::map<FunctionInternal*, Function>& all_fun,
+      casadi_int max_depth) const {
+    add_embedded(all_fun, f_, max_depth);
+  }
+
+  void LazyDerivative::serialize_body(SerializingStream &s) const {
+    FunctionInternal::serialize_body(s);
+    s.version("LazyDerivative", 1);
+    s.pack("LazyDerivative::f", f_);
+    s.pack("LazyDerivative::fwd", fwd_);
+    s.pack("LazyDerivative::nder", nder_);
+  }
+
+  LazyDerivative::LazyDerivative(DeserializingStream& s) : FunctionInternal(s) {
+    s.version("LazyDerivative", 1);
+    s.unpack("LazyDerivative::f", f_);
+    s.unpack("LazyDerivative::fwd", fwd_);
+    s.unpack("LazyDerivative::nder", nder_);
+  }
+
 } // namespace casadi
@@ -71,11 +71,20 @@ namespace casadi {
     Sparsity get_sparsity_out(casadi_int i) override;
     /// @}
 
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
     /** \brief  Initialize
 
         \identifier{1kt} */
     void init(const Dict& opts) override;
 
+    /** \brief Locate the nonzeros of each case in the inputs and outputs */
+    void init_offsets();
+
     /** \brief  Evaluate numerically, work vectors given
 
         \identifier{1ku} */
@@ -122,7 +131,7 @@ namespace casadi {
     /** \brief Is codegen supported?
 
         \identifier{1l0} */
-    bool has_codegen() const override { return true;}
+    bool has_codegen() const override;
 
     /** \brief Generate code for the body of the C function
 
@@ -138,6 +147,14 @@ namespace casadi {
     // Sparsity projection needed?
     bool project_in_, project_out_;
 
+    /* For each case (default last) and input/output, the offset of its nonzeros
+       in the nonzeros of the Switch, or -1 if they are not contiguous and
+       must be copied through a buffer */
+    std::vector<std::vector<casadi_int>> off_in_, off_out_;
+
+    // Generate the derivatives of each case when it is first evaluated
+    bool lazy_derivatives_;
+
     /** \brief Serialize an object without type information
 
         \identifier{1l2} */
@@ -161,6 +178,110 @@ namespace casadi {
     explicit Switch(DeserializingStream& s);
   };
 
+  /// Memory of LazyDerivative
+  struct CASADI_EXPORT LazyDerivativeMemory : public FunctionMemory {
+    // Work vectors and memory of the generated derivative, -1 if not checked out
+    std::vector<const double*> arg;
+    std::vector<double*> res;
+    std::vector<casadi_int> iw;
+    std::vector<double> w;
+    int mem = -1;
+  };
+
+  /** \brief Directional derivatives of a function, generated when first needed
+
+      Stands in for f.forward(nder) or f.reverse(nder) as a case of the derivative
+      of a Switch with lazy_derivatives, such that only the derivatives of the
+      cases that are actually selected are ever generated. The work vectors of the
+      derivative are owned by the memory object, hence code generation is not
+      supported.
+  */
+  class CASADI_EXPORT LazyDerivative : public FunctionInternal {
+  public:
+    /// Constructor
+    LazyDerivative(const std::string& name, const Function& f, bool fwd, casadi_int nder);
+
+    /// Destructor
+    ~LazyDerivative() override;
+
+    /// Get type name
+    std::string class_name() const override {return "LazyDerivative";}
+
+    ///@{
+    /// Number of function inputs and outputs
+    size_t get_n_in() override;
+    size_t get_n_out() override;
+    ///@}
+
+    ///@{
+    /// Sparsities of function inputs and outputs
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override;
+    ///@}
+
+    /// Generate the derivative, if not already done
+    const Function& derivative() const;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new LazyDerivativeMemory();}
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    /// Evaluate numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /// Evaluate symbolically
+    int eval_sx(const SXElem** arg, SXElem** res,
+                casadi_int* iw, SXElem* w, void* mem) const override;
+
+    ///@{
+    /// Propagate sparsity through the derivative
+    bool has_spfwd() const override { return true;}
+    bool has_sprev() const override { return true;}
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                   casadi_int* iw, bvec_t* w, void* mem) const override;
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+    ///@}
+
+    ///@{
+    /// Higher order derivatives, from the generated derivative
+    bool has_forward(casadi_int nfwd) const override { return true;}
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    bool has_reverse(casadi_int nadj) const override { return true;}
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    /// Serialize an object without type information
+    void serialize_body(SerializingStream &s) const override;
+
+    /// Deserialize without type information
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new LazyDerivative(s); }
+
+    // Get all embedded functions, recursively
+    void find(std::map<FunctionInternal*, Function>& all_fun, casadi_int max_depth) const override;
+
+    // Function to be differentiated
+    Function f_;
+
+    // Forward or reverse mode, number of directions
+    bool fwd_;
+    casadi_int nder_;
+
+    // Generated derivative
+    mutable Function der_;
+
+  protected:
+    /// Deserializing constructor
+    explicit LazyDerivative(DeserializingStream& s);
+  };
+
 } // namespace casadi
 /// \endcond
 
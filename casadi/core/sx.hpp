@@ -105,6 +105,9 @@ template<> inline std::string matrixName<SXElem>() { return "SX"; }
   template<>
   SX SX::substitute(const SX& ex, const SX& v, const SX& vdef);
 
+  template<>
+  Function SX::substitute_plan(const std::vector<SX>& ex, const std::vector<SX>& v);
+
   template<>
   void SX::substitute_inplace(const std::vector<SX>& v, std::vector<SX>& vdef,
                              std::vector<SX>& ex, bool reverse);
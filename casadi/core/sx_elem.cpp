@@ -42,6 +42,11 @@ namespace casadi {
   // Allocate storage for the caching
   CACHING_MAP<casadi_int, IntegerSX*> IntegerSX::cached_constants_;
   CACHING_MAP<double, RealtypeSX*> RealtypeSX::cached_constants_;
+  std::unordered_map<BinarySX::Key, BinarySX*, BinarySX::KeyHash> BinarySX::cached_;
+  std::unordered_map<UnarySX::Key, UnarySX*, UnarySX::KeyHash> UnarySX::cached_;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+  std::mutex SXNode::cache_mtx_;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
   SXElem::SXElem() {
     node = casadi_limits<SXElem>::nan.node;
@@ -69,14 +74,23 @@ namespace casadi {
       else if (intval == 1)        node = casadi_limits<SXElem>::one.node;
       else if (intval == 2)        node = casadi_limits<SXElem>::two.node;
       else if (intval == -1)       node = casadi_limits<SXElem>::minus_one.node;
-      else                        node = IntegerSX::create(intval);
-      node->count++;
+      else                        node = nullptr;
+      // Cached constants are returned with a reference already taken
+      if (node) {
+        node->count++;
+      } else {
+        node = IntegerSX::create(intval);
+      }
     } else {
       if (isnan(val))              node = casadi_limits<SXElem>::nan.node;
       else if (isinf(val))         node = val > 0 ? casadi_limits<SXElem>::inf.node :
                                       casadi_limits<SXElem>::minus_inf.node;
-      else                        node = RealtypeSX::create(val);
-      node->count++;
+      else                        node = nullptr;
+      if (node) {
+        node->count++;
+      } else {
+        node = RealtypeSX::create(val);
+      }
     }
   }
 
@@ -113,17 +127,17 @@ namespace casadi {
     SXNode* ret = node;
 
     // quick return if the old and new pointers point to the same object
-    if (node == scalar.node) return ret;
+    if (node == scalar.node) return nullptr;
 
     // decrease the counter but do not delete if this was the last pointer
-    --node->count;
+    bool last = --node->count == 0;
 
     // save the new pointer
     node = scalar.node;
     node->count++;
 
-    // Return a pointer to the old node
-    return ret;
+    // Return a pointer to the old node, if it has no owners left
+    return last ? ret : nullptr;
   }
 
   SXElem& SXElem::operator=(double scalar) {
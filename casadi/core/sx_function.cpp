@@ -29,11 +29,19 @@
 #include <deque>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
+#include <set>
+#include <map>
+#include <queue>
 #include "sx_node.hpp"
+#include "binary_sx.hpp"
+#include "unary_sx.hpp"
 #include "casadi_common.hpp"
 #include "sparsity_internal.hpp"
 #include "casadi_interrupt.hpp"
 #include "serializing_stream.hpp"
+#include "profiler.hpp"
+#include "thread_pool.hpp"
 
 namespace casadi {
 
@@ -47,6 +55,10 @@ namespace casadi {
     // Default (persistent) options
     just_in_time_opencl_ = false;
     just_in_time_sparsity_ = false;
+    bytecode_ = false;
+    vm_worksize_ = 0;
+    short_circuit_ = false;
+    numeric_ad_ = false;
   }
 
   SXFunction::~SXFunction() {
@@ -65,6 +77,44 @@ namespace casadi {
                    + str(free_vars_) + " are free.");
     }
 
+    // Outputs that are requested
+    bvec_t req = 0;
+    bool partial = false;
+    for (casadi_int i=0; i<n_out_; ++i) {
+      if (res[i]) {
+        req |= bvec_t(1) << (i % bvec_size);
+      } else {
+        partial = true;
+      }
+    }
+
+    // Time the instructions individually
+    if (Profiler::is_instructions_enabled()) return eval_profiled(arg, res, w, req, partial);
+
+    // Skip branches whose condition is zero
+    if (!branches_.empty()) return eval_branches(arg, res, w, req, partial);
+
+    // Skip instructions that only contribute to outputs not requested
+    if (partial && !out_mask_.empty()) {
+      for (size_t k=0; k<algorithm_.size(); ++k) {
+        if (out_mask_[k] && !(out_mask_[k] & req)) continue;
+        const AlgEl& e = algorithm_[k];
+        switch (e.op) {
+          CASADI_MATH_FUN_BUILTIN(w[e.i1], w[e.i2], w[e.i0])
+
+        case OP_CONST: w[e.i0] = e.d; break;
+        case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+        case OP_OUTPUT: if (res[e.i0]!=nullptr) res[e.i0][e.i2] = w[e.i1]; break;
+        default:
+          casadi_error("Unknown operation" + str(e.op));
+        }
+      }
+      return 0;
+    }
+
+    // Bytecode interpreter
+    if (bytecode_) return vm_eval(arg, res, w);
+
     // NOTE: The implementation of this function is very delicate. Small changes in the
     // class structure can cause large performance losses. For this reason,
     // the preprocessor macros are used below
@@ -84,6 +134,456 @@ namespace casadi {
     return 0;
   }
 
+  int SXFunction::eval_profiled(const double** arg, double** res, double* w,
+      bvec_t req, bool partial) const {
+    ProfilerInstructions& r = Profiler::instructions(this, algorithm_.size());
+    if (r.op.empty()) {
+      for (auto&& e : algorithm_) {
+        r.op.push_back(casadi_math<double>::name(e.op));
+        r.expr.push_back(print(e));
+      }
+    }
+    partial = partial && !out_mask_.empty();
+    int64_t t = Profiler::now();
+    for (size_t k=0; k<algorithm_.size(); ++k) {
+      if (partial && out_mask_[k] && !(out_mask_[k] & req)) continue;
+      const AlgEl& e = algorithm_[k];
+      switch (e.op) {
+        CASADI_MATH_FUN_BUILTIN(w[e.i1], w[e.i2], w[e.i0])
+
+      case OP_CONST: w[e.i0] = e.d; break;
+      case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+      case OP_OUTPUT: if (res[e.i0]!=nullptr) res[e.i0][e.i2] = w[e.i1]; break;
+      default:
+        casadi_error("Unknown operation" + str(e.op));
+      }
+      t = r.record(k, t);
+    }
+    return 0;
+  }
+
+  int SXFunction::eval_branches(const double** arg, double** res, double* w,
+      bvec_t req, bool partial) const {
+    partial = partial && !out_mask_.empty();
+    auto b = branches_.begin();
+    casadi_int k = 0, n = algorithm_.size();
+    while (k<n) {
+      if (b!=branches_.end() && b->begin==k) {
+        if (w[b->cond]==0) {
+          // Jump past the branch, including the branches nested in it
+          k = b->end;
+          while (b!=branches_.end() && b->begin<k) ++b;
+        } else {
+          ++b;
+        }
+        continue;
+      }
+      if (!partial || !out_mask_[k] || (out_mask_[k] & req)) {
+        const AlgEl& e = algorithm_[k];
+        switch (e.op) {
+          CASADI_MATH_FUN_BUILTIN(w[e.i1], w[e.i2], w[e.i0])
+
+        case OP_CONST: w[e.i0] = e.d; break;
+        case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+        case OP_OUTPUT: if (res[e.i0]!=nullptr) res[e.i0][e.i2] = w[e.i1]; break;
+        default:
+          casadi_error("Unknown operation" + str(e.op));
+        }
+      }
+      k++;
+    }
+    return 0;
+  }
+
+  int SXFunction::eval_batch(const double** arg, double** res,
+      casadi_int* iw, double* w, casadi_int n) const {
+    if (verbose_) casadi_message(name_ + "::eval_batch");
+
+    // Make sure no free parameters
+    if (!free_vars_.empty()) {
+      std::stringstream ss;
+      disp(ss, false);
+      casadi_error("Cannot evaluate \"" + ss.str() + "\" since variables "
+                   + str(free_vars_) + " are free.");
+    }
+
+    // Evaluate the algorithm, work vector element i of instance k is stored in w[i*n+k]
+    for (auto&& e : algorithm_) {
+      switch (e.op) {
+        CASADI_MATH_FUN_BUILTIN_GEN(BinaryOperationVV, w + e.i1*n, w + e.i2*n, w + e.i0*n, n)
+
+      case OP_CONST: std::fill_n(w + e.i0*n, n, e.d); break;
+      case OP_INPUT:
+        if (arg[e.i1]==nullptr) {
+          std::fill_n(w + e.i0*n, n, 0.);
+        } else {
+          const double* a = arg[e.i1] + e.i2;
+          casadi_int stride = nnz_in(e.i1);
+          for (casadi_int k=0; k<n; ++k) w[e.i0*n+k] = a[k*stride];
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=nullptr) {
+          double* r = res[e.i0] + e.i2;
+          casadi_int stride = nnz_out(e.i0);
+          for (casadi_int k=0; k<n; ++k) r[k*stride] = w[e.i1*n+k];
+        }
+        break;
+      default:
+        casadi_error("Unknown operation" + str(e.op));
+      }
+    }
+    return 0;
+  }
+
+  namespace {
+    // Opcodes of the bytecode interpreter
+    enum VmOp {
+      // Terminate evaluation
+      VM_STOP,
+      // w[i0] = constant i1, arg[i1][i2], res[i0][i2] = w[i1]
+      VM_CONST, VM_INPUT, VM_OUTPUT,
+      // w[i0] = w[i1] OP w[i2]
+      VM_ADD, VM_SUB, VM_MUL, VM_DIV,
+      // w[i0] = OP(w[i1])
+      VM_NEG, VM_SQ, VM_SQRT, VM_SIN, VM_COS, VM_EXP, VM_LOG,
+      // Binary operations with constant i2 as immediate operand
+      VM_ADD_C, VM_SUB_C, VM_C_SUB, VM_MUL_C, VM_DIV_C, VM_C_DIV,
+      // Fused multiply-add: w[i1]*w[i2]+w[i3], w[i1]*w[i2]-w[i3], w[i3]-w[i1]*w[i2]
+      VM_MUL_ADD, VM_MUL_SUB, VM_SUB_MUL,
+      // Any other operation i3, w[i0] = i3(w[i1], w[i2])
+      VM_GENERIC,
+      // Number of opcodes
+      VM_NUM_OP
+    };
+
+    // Does the instruction define w[i0]?
+    inline bool vm_has_dest(int op) {
+      return op!=VM_STOP && op!=VM_OUTPUT;
+    }
+
+    // Work vector locations that are read by an instruction, bitmask for i1, i2, i3
+    inline int vm_reads(int op) {
+      switch (op) {
+      case VM_STOP: case VM_CONST: case VM_INPUT: return 0;
+      case VM_OUTPUT: return 1;
+      case VM_NEG: case VM_SQ: case VM_SQRT: case VM_SIN: case VM_COS: case VM_EXP: case VM_LOG:
+      case VM_ADD_C: case VM_SUB_C: case VM_C_SUB: case VM_MUL_C: case VM_DIV_C: case VM_C_DIV:
+        return 1;
+      case VM_MUL_ADD: case VM_MUL_SUB: case VM_SUB_MUL: return 7;
+      default: return 3;
+      }
+    }
+
+    // Access operand j of an instruction
+    inline int& vm_operand(VmInstruction& e, casadi_int j) {
+      return j==0 ? e.i1 : j==1 ? e.i2 : e.i3;
+    }
+
+    // Does the instruction have an operand i3?
+    inline bool vm_has_i3(int op) {
+      return op==VM_MUL_ADD || op==VM_MUL_SUB || op==VM_SUB_MUL || op==VM_GENERIC;
+    }
+
+    // Operand i3 and the next instruction, for the wide and the compact encoding
+    inline int vm_i3(const VmInstruction* pc) { return pc->i3;}
+    inline int vm_i3(const VmInstruction16* pc) { return pc[1].op;}
+    inline const VmInstruction* vm_skip_i3(const VmInstruction* pc) { return pc + 1;}
+    inline const VmInstruction16* vm_skip_i3(const VmInstruction16* pc) { return pc + 2;}
+
+    // Interpret bytecode, with the constant pool c
+    template<typename Instr>
+    int vm_run(const Instr* pc, const double* c, const double** arg, double** res, double* w) {
+      // Use direct threading when labels as values are available, otherwise a switch
+#if defined(__GNUC__)
+#define CASADI_VM_COMPUTED_GOTO
+#endif
+
+#ifdef CASADI_VM_COMPUTED_GOTO
+      // Jump table, in the order of VmOp
+      static const void* const labels[VM_NUM_OP] = {
+        &&L_VM_STOP,
+        &&L_VM_CONST, &&L_VM_INPUT, &&L_VM_OUTPUT,
+        &&L_VM_ADD, &&L_VM_SUB, &&L_VM_MUL, &&L_VM_DIV,
+        &&L_VM_NEG, &&L_VM_SQ, &&L_VM_SQRT, &&L_VM_SIN, &&L_VM_COS, &&L_VM_EXP, &&L_VM_LOG,
+        &&L_VM_ADD_C, &&L_VM_SUB_C, &&L_VM_C_SUB, &&L_VM_MUL_C, &&L_VM_DIV_C, &&L_VM_C_DIV,
+        &&L_VM_MUL_ADD, &&L_VM_MUL_SUB, &&L_VM_SUB_MUL,
+        &&L_VM_GENERIC
+      };
+#define VM_CASE(OP) L_##OP:
+#define VM_NEXT ++pc; goto *labels[pc->op];
+#define VM_NEXT_I3 pc = vm_skip_i3(pc); goto *labels[pc->op];
+      goto *labels[pc->op];
+#else // CASADI_VM_COMPUTED_GOTO
+#define VM_CASE(OP) case OP:
+#define VM_NEXT ++pc; continue;
+#define VM_NEXT_I3 pc = vm_skip_i3(pc); continue;
+      while (true) {
+        switch (pc->op) {
+#endif // CASADI_VM_COMPUTED_GOTO
+      VM_CASE(VM_CONST) w[pc->i0] = c[pc->i1]; VM_NEXT
+      VM_CASE(VM_INPUT) w[pc->i0] = arg[pc->i1]==nullptr ? 0 : arg[pc->i1][pc->i2]; VM_NEXT
+      VM_CASE(VM_OUTPUT) if (res[pc->i0]!=nullptr) res[pc->i0][pc->i2] = w[pc->i1]; VM_NEXT
+      VM_CASE(VM_ADD) w[pc->i0] = w[pc->i1] + w[pc->i2]; VM_NEXT
+      VM_CASE(VM_SUB) w[pc->i0] = w[pc->i1] - w[pc->i2]; VM_NEXT
+      VM_CASE(VM_MUL) w[pc->i0] = w[pc->i1] * w[pc->i2]; VM_NEXT
+      VM_CASE(VM_DIV) w[pc->i0] = w[pc->i1] / w[pc->i2]; VM_NEXT
+      VM_CASE(VM_NEG) w[pc->i0] = -w[pc->i1]; VM_NEXT
+      VM_CASE(VM_SQ) w[pc->i0] = w[pc->i1] * w[pc->i1]; VM_NEXT
+      VM_CASE(VM_SQRT) w[pc->i0] = std::sqrt(w[pc->i1]); VM_NEXT
+      VM_CASE(VM_SIN) w[pc->i0] = std::sin(w[pc->i1]); VM_NEXT
+      VM_CASE(VM_COS) w[pc->i0] = std::cos(w[pc->i1]); VM_NEXT
+      VM_CASE(VM_EXP) w[pc->i0] = std::exp(w[pc->i1]); VM_NEXT
+      VM_CASE(VM_LOG) w[pc->i0] = std::log(w[pc->i1]); VM_NEXT
+      VM_CASE(VM_ADD_C) w[pc->i0] = w[pc->i1] + c[pc->i2]; VM_NEXT
+      VM_CASE(VM_SUB_C) w[pc->i0] = w[pc->i1] - c[pc->i2]; VM_NEXT
+      VM_CASE(VM_C_SUB) w[pc->i0] = c[pc->i2] - w[pc->i1]; VM_NEXT
+      VM_CASE(VM_MUL_C) w[pc->i0] = w[pc->i1] * c[pc->i2]; VM_NEXT
+      VM_CASE(VM_DIV_C) w[pc->i0] = w[pc->i1] / c[pc->i2]; VM_NEXT
+      VM_CASE(VM_C_DIV) w[pc->i0] = c[pc->i2] / w[pc->i1]; VM_NEXT
+      VM_CASE(VM_MUL_ADD) w[pc->i0] = w[pc->i1] * w[pc->i2] + w[vm_i3(pc)]; VM_NEXT_I3
+      VM_CASE(VM_MUL_SUB) w[pc->i0] = w[pc->i1] * w[pc->i2] - w[vm_i3(pc)]; VM_NEXT_I3
+      VM_CASE(VM_SUB_MUL) w[pc->i0] = w[vm_i3(pc)] - w[pc->i1] * w[pc->i2]; VM_NEXT_I3
+      VM_CASE(VM_GENERIC)
+        casadi_math<double>::fun(static_cast<unsigned char>(vm_i3(pc)), w[pc->i1], w[pc->i2],
+                                 w[pc->i0]);
+        VM_NEXT_I3
+      VM_CASE(VM_STOP) return 0;
+#ifndef CASADI_VM_COMPUTED_GOTO
+        default:
+          casadi_error("Unknown opcode " + str(pc->op));
+        }
+      }
+#endif // CASADI_VM_COMPUTED_GOTO
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_NEXT_I3
+#undef CASADI_VM_COMPUTED_GOTO
+    }
+  } // namespace
+
+  void SXFunction::vm_compile() {
+    vm_code_.clear();
+    vm_code16_.clear();
+    vm_const_.clear();
+
+    // Lower the algorithm, renaming the work vector locations to values that are
+    // defined exactly once. Values holding constants are tracked for immediates.
+    std::vector<int> val(worksize_, -1);
+    std::vector<int> const_ind;
+    int n_val = 0;
+    for (auto&& a : algorithm_) {
+      VmInstruction e;
+      e.i1 = e.i2 = e.i3 = 0;
+      switch (a.op) {
+      case OP_CONST:
+        e.op = VM_CONST;
+        e.i1 = static_cast<int>(vm_const_.size());
+        vm_const_.push_back(a.d);
+        break;
+      case OP_INPUT:
+        e.op = VM_INPUT;
+        e.i1 = a.i1;
+        e.i2 = a.i2;
+        break;
+      case OP_OUTPUT:
+        e.op = VM_OUTPUT;
+        e.i0 = a.i0;
+        e.i1 = val.at(a.i1);
+        e.i2 = a.i2;
+        break;
+      default:
+        {
+          int x = val.at(a.i1);
+          int y = casadi_math<double>::ndeps(a.op)==2 ? val.at(a.i2) : x;
+          int cx = const_ind[x], cy = const_ind[y];
+          e.i1 = x;
+          e.i2 = y;
+          switch (a.op) {
+          case OP_ADD:
+            if (cy>=0 && cx<0) {
+              e.op = VM_ADD_C; e.i2 = cy;
+            } else if (cx>=0 && cy<0) {
+              e.op = VM_ADD_C; e.i1 = y; e.i2 = cx;
+            } else {
+              e.op = VM_ADD;
+            }
+            break;
+          case OP_SUB:
+            if (cy>=0 && cx<0) {
+              e.op = VM_SUB_C; e.i2 = cy;
+            } else if (cx>=0 && cy<0) {
+              e.op = VM_C_SUB; e.i1 = y; e.i2 = cx;
+            } else {
+              e.op = VM_SUB;
+            }
+            break;
+          case OP_MUL:
+            if (cy>=0 && cx<0) {
+              e.op = VM_MUL_C; e.i2 = cy;
+            } else if (cx>=0 && cy<0) {
+              e.op = VM_MUL_C; e.i1 = y; e.i2 = cx;
+            } else {
+              e.op = VM_MUL;
+            }
+            break;
+          case OP_DIV:
+            if (cy>=0 && cx<0) {
+              e.op = VM_DIV_C; e.i2 = cy;
+            } else if (cx>=0 && cy<0) {
+              e.op = VM_C_DIV; e.i1 = y; e.i2 = cx;
+            } else {
+              e.op = VM_DIV;
+            }
+            break;
+          case OP_NEG: e.op = VM_NEG; break;
+          case OP_SQ: e.op = VM_SQ; break;
+          case OP_SQRT: e.op = VM_SQRT; break;
+          case OP_SIN: e.op = VM_SIN; break;
+          case OP_COS: e.op = VM_COS; break;
+          case OP_EXP: e.op = VM_EXP; break;
+          case OP_LOG: e.op = VM_LOG; break;
+          default:
+            e.op = VM_GENERIC;
+            e.i3 = a.op;
+          }
+        }
+      }
+      // New value
+      if (vm_has_dest(e.op)) {
+        e.i0 = n_val++;
+        val.at(a.i0) = e.i0;
+        const_ind.push_back(e.op==VM_CONST ? e.i1 : -1);
+      }
+      vm_code_.push_back(e);
+    }
+
+    // Number of reads and defining instruction of each value
+    std::vector<int> n_read(n_val, 0), def(n_val, -1);
+    for (casadi_int k=0; k<vm_code_.size(); ++k) {
+      VmInstruction& e = vm_code_[k];
+      if (vm_has_dest(e.op)) def[e.i0] = k;
+      int r = vm_reads(e.op);
+      for (casadi_int j=0; j<3; ++j) {
+        if (r & (1 << j)) n_read[vm_operand(e, j)]++;
+      }
+    }
+
+    // Fuse additions and subtractions with a multiplication that is not used elsewhere
+    std::vector<bool> fused(vm_code_.size(), false);
+    for (auto&& e : vm_code_) {
+      if (e.op!=VM_ADD && e.op!=VM_SUB) continue;
+      for (casadi_int j=0; j<2; ++j) {
+        int v = vm_operand(e, j), c = vm_operand(e, 1-j);
+        if (v==c || n_read[v]!=1 || vm_code_[def[v]].op!=VM_MUL) continue;
+        const VmInstruction& m = vm_code_[def[v]];
+        fused[def[v]] = true;
+        e.op = e.op==VM_ADD ? VM_MUL_ADD : j==0 ? VM_MUL_SUB : VM_SUB_MUL;
+        e.i1 = m.i1;
+        e.i2 = m.i2;
+        e.i3 = c;
+        break;
+      }
+    }
+
+    // Dead code elimination, outputs and printing are the only side effects
+    std::vector<bool> live(n_val, false);
+    std::vector<bool> keep(vm_code_.size(), false);
+    for (casadi_int k=vm_code_.size(); k-->0; ) {
+      VmInstruction& e = vm_code_[k];
+      if (fused[k]) continue;
+      if (e.op==VM_OUTPUT || (e.op==VM_GENERIC && e.i3==OP_PRINTME) || live[e.i0]) {
+        keep[k] = true;
+        int r = vm_reads(e.op);
+        for (casadi_int j=0; j<3; ++j) {
+          if (r & (1 << j)) live[vm_operand(e, j)] = true;
+        }
+      }
+    }
+    casadi_int n_keep = 0;
+    for (casadi_int k=0; k<vm_code_.size(); ++k) {
+      if (keep[k]) vm_code_[n_keep++] = vm_code_[k];
+    }
+    vm_code_.resize(n_keep);
+
+    // Last instruction reading each value
+    std::vector<casadi_int> last_read(n_val, -1);
+    for (casadi_int k=0; k<vm_code_.size(); ++k) {
+      VmInstruction& e = vm_code_[k];
+      int r = vm_reads(e.op);
+      for (casadi_int j=0; j<3; ++j) {
+        if (r & (1 << j)) last_read[vm_operand(e, j)] = k;
+      }
+    }
+
+    // Assign work vector locations, reusing locations of values that are no longer needed
+    std::vector<int> loc(n_val, -1);
+    std::vector<int> unused;
+    int n_loc = 0;
+    for (casadi_int k=0; k<vm_code_.size(); ++k) {
+      VmInstruction& e = vm_code_[k];
+      int r = vm_reads(e.op);
+      for (casadi_int j=0; j<3; ++j) {
+        if (!(r & (1 << j))) continue;
+        int& v = vm_operand(e, j);
+        if (last_read[v]==k) {
+          // Last read, release location
+          unused.push_back(loc[v]);
+          last_read[v] = -1;
+        }
+        v = loc[v];
+      }
+      if (vm_has_dest(e.op)) {
+        int v = e.i0;
+        if (unused.empty()) {
+          loc[v] = n_loc++;
+        } else {
+          loc[v] = unused.back();
+          unused.pop_back();
+        }
+        e.i0 = loc[v];
+        // A value that is never read can be released directly
+        if (last_read[v]<0) unused.push_back(loc[v]);
+      }
+    }
+    vm_worksize_ = n_loc;
+
+    // Terminate
+    VmInstruction e;
+    e.op = VM_STOP;
+    e.i0 = e.i1 = e.i2 = e.i3 = 0;
+    vm_code_.push_back(e);
+    casadi_int n_code = vm_code_.size()-1;
+
+    // Compact encoding if all operands fit in 16 bits
+    bool narrow = true;
+    for (auto&& e : vm_code_) {
+      for (int v : {e.i0, e.i1, e.i2, vm_has_i3(e.op) ? e.i3 : 0}) {
+        if (v<0 || v>std::numeric_limits<uint16_t>::max()) narrow = false;
+      }
+      if (!narrow) break;
+    }
+    if (narrow) {
+      vm_code16_.reserve(vm_code_.size() + n_code/4);
+      for (auto&& e : vm_code_) {
+        vm_code16_.push_back({static_cast<uint16_t>(e.op), static_cast<uint16_t>(e.i0),
+          static_cast<uint16_t>(e.i1), static_cast<uint16_t>(e.i2)});
+        if (vm_has_i3(e.op)) vm_code16_.push_back({static_cast<uint16_t>(e.i3), 0, 0, 0});
+      }
+      vm_code_.clear();
+      vm_code_.shrink_to_fit();
+    }
+
+    if (verbose_) casadi_message(name_ + "::vm_compile: " + str(n_code)
+      + " instructions, work vector of size " + str(vm_worksize_)
+      + (narrow ? ", compact encoding" : ""));
+  }
+
+  int SXFunction::vm_eval(const double** arg, double** res, double* w) const {
+    if (!vm_code16_.empty()) return vm_run(vm_code16_.data(), vm_const_.data(), arg, res, w);
+    return vm_run(vm_code_.data(), vm_const_.data(), arg, res, w);
+  }
+
   bool SXFunction::is_smooth() const {
     // Go through all nodes and check if any node is non-smooth
     for (auto&& a : algorithm_) {
@@ -94,6 +594,13 @@ namespace casadi {
     return true;
   }
 
+  Dict SXFunction::info() const {
+    return {{"n_operations", static_cast<casadi_int>(operations_.size())},
+            {"n_constants", static_cast<casadi_int>(constants_.size())},
+            {"n_instructions", static_cast<casadi_int>(algorithm_.size())},
+            {"n_branches", static_cast<casadi_int>(branches_.size())}};
+  }
+
   void SXFunction::disp_more(std::ostream &stream) const {
     stream << "Algorithm:";
 
@@ -104,35 +611,45 @@ namespace casadi {
     for (auto&& a : algorithm_) {
       InterruptHandler::check();
       stream << std::endl;
-      if (a.op==OP_OUTPUT) {
-        stream << "output[" << a.i0 << "][" << a.i2 << "] = @" << a.i1;
+      if (a.op==OP_PARAMETER) {
+        stream << "@" << a.i0 << " = " << *p_it++;
       } else {
-        stream << "@" << a.i0 << " = ";
-        if (a.op==OP_INPUT) {
-          stream << "input[" << a.i1 << "][" << a.i2 << "]";
-        } else {
-          if (a.op==OP_CONST) {
-            stream << a.d;
-          } else if (a.op==OP_PARAMETER) {
-            stream << *p_it++;
-          } else {
-            casadi_int ndep = casadi_math<double>::ndeps(a.op);
-            stream << casadi_math<double>::pre(a.op);
-            for (casadi_int c=0; c<ndep; ++c) {
-              if (c==0) {
-                stream << "@" << a.i1;
-              } else {
-                stream << casadi_math<double>::sep(a.op);
-                stream << "@" << a.i2;
-              }
+        stream << print(a);
+      }
+      stream << ";";
+    }
+  }
 
+  std::string SXFunction::print(const AlgEl& a) const {
+    std::stringstream stream;
+    if (a.op==OP_OUTPUT) {
+      stream << "output[" << a.i0 << "][" << a.i2 << "] = @" << a.i1;
+    } else {
+      stream << "@" << a.i0 << " = ";
+      if (a.op==OP_INPUT) {
+        stream << "input[" << a.i1 << "][" << a.i2 << "]";
+      } else {
+        if (a.op==OP_CONST) {
+          stream << a.d;
+        } else if (a.op==OP_PARAMETER) {
+          stream << "parameter";
+        } else {
+          casadi_int ndep = casadi_math<double>::ndeps(a.op);
+          stream << casadi_math<double>::pre(a.op);
+          for (casadi_int c=0; c<ndep; ++c) {
+            if (c==0) {
+              stream << "@" << a.i1;
+            } else {
+              stream << casadi_math<double>::sep(a.op);
+              stream << "@" << a.i2;
             }
-            stream << casadi_math<double>::post(a.op);
+
           }
+          stream << casadi_math<double>::post(a.op);
         }
       }
-      stream << ";";
     }
+    return stream.str();
   }
 
   void SXFunction::codegen_declarations(CodeGenerator& g) const {
@@ -144,10 +661,38 @@ namespace casadi {
     }
   }
 
+  size_t SXFunction::instructions_bytes() const {
+    return algorithm_.capacity() * sizeof(AlgEl)
+      + vm_code_.capacity() * sizeof(VmInstruction)
+      + vm_code16_.capacity() * sizeof(VmInstruction16)
+      + vm_const_.capacity() * sizeof(double)
+      + (operations_.capacity() + constants_.capacity() + free_vars_.capacity())
+        * sizeof(SXElem)
+      + default_in_.capacity() * sizeof(double);
+  }
+
   void SXFunction::codegen_body(CodeGenerator& g) const {
 
+    // Range analysis, if bounds on the inputs are given
+    std::vector<std::vector<double>> in_range = g.input_range(name_);
+    if (!in_range.empty()) codegen_range(g, in_range);
+
+    // Ends of the open branches
+    std::vector<casadi_int> branch_end;
+    auto b = branches_.begin();
+
     // Run the algorithm
-    for (auto&& a : algorithm_) {
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& a = algorithm_[k];
+      // Close and open branches
+      while (!branch_end.empty() && branch_end.back()==k) {
+        g << "}\n";
+        branch_end.pop_back();
+      }
+      for (; b!=branches_.end() && b->begin==k; ++b) {
+        g << "if (" << g.sx_work(b->cond) << "!=0) {\n";
+        branch_end.push_back(b->end);
+      }
       if (a.op==OP_OUTPUT) {
         g << "if (res[" << a.i0 << "]!=0) "
           << g.res(a.i0) << "[" << a.i2 << "]=" << g.sx_work(a.i1);
@@ -158,7 +703,7 @@ namespace casadi {
 
         // What to store
         if (a.op==OP_CONST) {
-          g << g.constant(a.d);
+          g << g.constant_real(a.d);
         } else if (a.op==OP_INPUT) {
           g << g.arg(a.i1) << "? " << g.arg(a.i1) << "[" << a.i2 << "] : 0";
         } else {
@@ -172,6 +717,600 @@ namespace casadi {
     }
   }
 
+  // Product of interval end points, with 0*inf=0
+  inline double range_mul(double x, double y) {
+    return x==0 || y==0 ? 0 : x*y;
+  }
+
+  // Interval product
+  void range_times(double xl, double xu, double yl, double yu, double& zl, double& zu) {
+    double c[4] = {range_mul(xl, yl), range_mul(xl, yu), range_mul(xu, yl), range_mul(xu, yu)};
+    zl = *std::min_element(c, c+4);
+    zu = *std::max_element(c, c+4);
+  }
+
+  double SXFunction::range_analysis(const std::vector<std::vector<double>>& in_range, double eps,
+                                    std::vector<std::vector<double>>& lb,
+                                    std::vector<std::vector<double>>& ub,
+                                    std::vector<std::vector<double>>& err) const {
+    casadi_assert(in_range.size()==n_in_,
+      "Range analysis of '" + name_ + "': Expected bounds for " + str(n_in_) + " inputs, "
+      "got " + str(in_range.size()));
+    for (casadi_int i=0; i<n_in_; ++i) {
+      casadi_assert(in_range[i].size()==2 && in_range[i][0]<=in_range[i][1],
+        "Range analysis of '" + name_ + "': Bounds on input " + str(i)
+        + " must be [lb, ub] with lb<=ub");
+    }
+    const double inf = std::numeric_limits<double>::infinity();
+    const double pi = 3.14159265358979323846;
+
+    // Outputs that are never written are zero
+    lb.resize(n_out_);
+    ub.resize(n_out_);
+    err.resize(n_out_);
+    for (casadi_int i=0; i<n_out_; ++i) {
+      lb[i].assign(nnz_out(i), 0);
+      ub[i].assign(nnz_out(i), 0);
+      err[i].assign(nnz_out(i), 0);
+    }
+
+    // Bounds and error bounds of the work vector elements
+    std::vector<double> wl(worksize_, 0), wu(worksize_, 0), we(worksize_, 0);
+    double peak = 0;
+
+    // Largest and smallest magnitude in an interval
+    auto mag = [](double l, double u) { return std::max(std::fabs(l), std::fabs(u));};
+    auto mig = [](double l, double u) { return l>0 ? l : u<0 ? -u : 0.;};
+    // Error propagated through a function with Lipschitz constant L
+    auto lip = [](double L, double e) { return e==0 ? 0 : L*e;};
+
+    for (auto&& a : algorithm_) {
+      if (a.op==OP_OUTPUT) {
+        lb[a.i0][a.i2] = wl[a.i1];
+        ub[a.i0][a.i2] = wu[a.i1];
+        err[a.i0][a.i2] = we[a.i1];
+        continue;
+      }
+
+      // Operands
+      double xl = 0, xu = 0, xe = 0, yl = 0, yu = 0, ye = 0;
+      if (a.op!=OP_CONST && a.op!=OP_INPUT) {
+        xl = wl[a.i1];
+        xu = wu[a.i1];
+        xe = we[a.i1];
+        if (casadi_math<double>::ndeps(a.op)==2) {
+          yl = wl[a.i2];
+          yu = wu[a.i2];
+          ye = we[a.i2];
+        }
+      }
+
+      // Result, error before rounding of the result
+      double zl = -inf, zu = inf, ze = inf;
+      switch (a.op) {
+      case OP_CONST:
+        zl = zu = a.d;
+        // Integers up to 1/eps are exact, other constants are rounded
+        ze = a.d==std::floor(a.d) && std::fabs(a.d)<=1/eps ? 0 : eps*std::fabs(a.d);
+        break;
+      case OP_INPUT:
+        zl = in_range[a.i1][0];
+        zu = in_range[a.i1][1];
+        ze = eps*mag(zl, zu);
+        break;
+      case OP_ASSIGN:
+        zl = xl; zu = xu; ze = xe;
+        break;
+      case OP_ADD:
+        zl = xl+yl; zu = xu+yu; ze = xe+ye;
+        break;
+      case OP_SUB:
+        zl = xl-yu; zu = xu-yl; ze = xe+ye;
+        break;
+      case OP_MUL:
+        range_times(xl, xu, yl, yu, zl, zu);
+        ze = lip(mag(xl, xu), ye) + lip(mag(yl, yu), xe);
+        break;
+      case OP_DIV:
+        if (yl>0 || yu<0) {
+          range_times(xl, xu, 1/yu, 1/yl, zl, zu);
+          ze = (xe + lip(mag(zl, zu), ye))/mig(yl, yu);
+        }
+        break;
+      case OP_INV:
+        if (xl>0 || xu<0) {
+          zl = 1/xu; zu = 1/xl;
+          ze = lip(1/(mig(xl, xu)*mig(xl, xu)), xe);
+        }
+        break;
+      case OP_NEG:
+        zl = -xu; zu = -xl; ze = xe;
+        break;
+      case OP_TWICE:
+        zl = 2*xl; zu = 2*xu; ze = 2*xe;
+        break;
+      case OP_SQ:
+        zl = mig(xl, xu)*mig(xl, xu); zu = mag(xl, xu)*mag(xl, xu);
+        ze = lip(2*mag(xl, xu), xe);
+        break;
+      case OP_FABS:
+        zl = mig(xl, xu); zu = mag(xl, xu); ze = xe;
+        break;
+      case OP_SQRT:
+        if (xu>=0) {
+          zl = std::sqrt(std::max(xl, 0.)); zu = std::sqrt(xu);
+          ze = lip(xl>0 ? 0.5/zl : inf, xe);
+        }
+        break;
+      case OP_EXP:
+        zl = std::exp(xl); zu = std::exp(xu); ze = lip(zu, xe);
+        break;
+      case OP_EXPM1:
+        zl = std::expm1(xl); zu = std::expm1(xu); ze = lip(std::exp(xu), xe);
+        break;
+      case OP_LOG:
+        if (xu>0) {
+          zl = xl>0 ? std::log(xl) : -inf; zu = std::log(xu);
+          ze = lip(xl>0 ? 1/xl : inf, xe);
+        }
+        break;
+      case OP_LOG1P:
+        if (xu>-1) {
+          zl = xl>-1 ? std::log1p(xl) : -inf; zu = std::log1p(xu);
+          ze = lip(xl>-1 ? 1/(1+xl) : inf, xe);
+        }
+        break;
+      case OP_SIN:
+      case OP_COS:
+        zl = -1; zu = 1; ze = xe;
+        break;
+      case OP_TAN:
+        if (xl>-pi/2 && xu<pi/2) {
+          zl = std::tan(xl); zu = std::tan(xu);
+          ze = lip(1 + mag(zl, zu)*mag(zl, zu), xe);
+        }
+        break;
+      case OP_ASIN:
+      case OP_ACOS:
+        if (xl>=-1 && xu<=1) {
+          zl = std::asin(xl); zu = std::asin(xu);
+          if (a.op==OP_ACOS) {
+            zl = pi/2 - zu; zu = pi/2 - std::asin(xl);
+          }
+          double m = mag(xl, xu);
+          ze = lip(m<1 ? 1/std::sqrt(1-m*m) : inf, xe);
+        }
+        break;
+      case OP_ATAN:
+        zl = std::atan(xl); zu = std::atan(xu); ze = xe;
+        break;
+      case OP_SINH:
+        zl = std::sinh(xl); zu = std::sinh(xu); ze = lip(std::cosh(mag(xl, xu)), xe);
+        break;
+      case OP_COSH:
+        zl = std::cosh(mig(xl, xu)); zu = std::cosh(mag(xl, xu));
+        ze = lip(std::sinh(mag(xl, xu)), xe);
+        break;
+      case OP_TANH:
+        zl = std::tanh(xl); zu = std::tanh(xu); ze = xe;
+        break;
+      case OP_ASINH:
+        zl = std::asinh(xl); zu = std::asinh(xu); ze = xe;
+        break;
+      case OP_ACOSH:
+        if (xl>=1) {
+          zl = std::acosh(xl); zu = std::acosh(xu);
+          ze = lip(xl>1 ? 1/std::sqrt(xl*xl-1) : inf, xe);
+        }
+        break;
+      case OP_ATANH:
+        if (xl>-1 && xu<1) {
+          zl = std::atanh(xl); zu = std::atanh(xu);
+          ze = lip(1/(1-mag(xl, xu)*mag(xl, xu)), xe);
+        }
+        break;
+      case OP_ERF:
+        zl = std::erf(xl); zu = std::erf(xu); ze = lip(2/std::sqrt(pi), xe);
+        break;
+      case OP_FMIN:
+        zl = std::min(xl, yl); zu = std::min(xu, yu); ze = std::max(xe, ye);
+        break;
+      case OP_FMAX:
+        zl = std::max(xl, yl); zu = std::max(xu, yu); ze = std::max(xe, ye);
+        break;
+      case OP_HYPOT:
+        zl = std::hypot(mig(xl, xu), mig(yl, yu)); zu = std::hypot(mag(xl, xu), mag(yl, yu));
+        ze = xe + ye;
+        break;
+      case OP_POW:
+      case OP_CONSTPOW:
+        // Constant exponent only
+        if (yl==yu && ye==0) {
+          double p = yl;
+          if (p==std::floor(p) && std::fabs(p)<=64 && (p>=0 || xl>0 || xu<0)) {
+            // Integer exponent
+            double l = std::pow(xl, p), u = std::pow(xu, p);
+            zl = std::min(l, u); zu = std::max(l, u);
+            if (std::fmod(p, 2)==0 && xl<0 && xu>0) zl = p==0 ? 1 : 0;
+          } else if (xl>0) {
+            double l = std::pow(xl, p), u = std::pow(xu, p);
+            zl = std::min(l, u); zu = std::max(l, u);
+          } else {
+            break;
+          }
+          if (p==0) {
+            ze = 0;
+          } else {
+            double m = p>=1 ? mag(xl, xu) : mig(xl, xu);
+            ze = lip(std::fabs(p)*std::pow(m, p-1), xe);
+          }
+        }
+        break;
+      case OP_LT:
+      case OP_LE:
+        // Determined if the operands are separated by more than their errors
+        if (xu+xe+ye<yl) {
+          zl = zu = 1; ze = 0;
+        } else if (xl>yu+xe+ye) {
+          zl = zu = 0; ze = 0;
+        } else {
+          zl = 0; zu = 1; ze = xe+ye>0 ? 1 : 0;
+        }
+        break;
+      case OP_EQ:
+      case OP_NE:
+      case OP_NOT:
+      case OP_AND:
+      case OP_OR:
+        zl = 0; zu = 1; ze = xe+ye>0 ? 1 : 0;
+        break;
+      case OP_SIGN:
+        zl = xl>0 ? 1 : xl<0 ? -1 : 0; zu = xu>0 ? 1 : xu<0 ? -1 : 0;
+        ze = xe>0 && xl<=xe && xu>=-xe ? 2 : 0;
+        break;
+      case OP_FLOOR:
+      case OP_CEIL:
+        zl = a.op==OP_FLOOR ? std::floor(xl) : std::ceil(xl);
+        zu = a.op==OP_FLOOR ? std::floor(xu) : std::ceil(xu);
+        ze = xe>0 ? 1 : 0;
+        break;
+      case OP_IF_ELSE_ZERO:
+        if (xl==0 && xu==0) {
+          zl = zu = 0; ze = 0;
+        } else {
+          zl = std::min(yl, 0.); zu = std::max(yu, 0.);
+          if (xl>0 || xu<0) {
+            zl = yl; zu = yu;
+          }
+          ze = xe>0 ? mag(yl, yu) + ye : ye;
+        }
+        break;
+      default:
+        break;
+      }
+
+      // Invalid operations give unbounded results
+      if (zl!=zl || zu!=zu) {
+        zl = -inf;
+        zu = inf;
+      }
+      if (ze!=ze) ze = inf;
+
+      // Rounding of the result
+      double zm = mag(zl, zu);
+      if (a.op!=OP_CONST && a.op!=OP_INPUT) ze += eps*zm;
+      peak = std::max(peak, zm);
+      wl[a.i0] = zl;
+      wu[a.i0] = zu;
+      we[a.i0] = ze;
+    }
+    return peak;
+  }
+
+  void SXFunction::codegen_range(CodeGenerator& g,
+                                 const std::vector<std::vector<double>>& in_range) const {
+    // Unit roundoff and overflow threshold of casadi_real
+    bool single = g.casadi_real_type=="float";
+    double eps = single ? std::numeric_limits<float>::epsilon()/2
+                        : std::numeric_limits<double>::epsilon()/2;
+    double real_max = single ? std::numeric_limits<float>::max()
+                             : std::numeric_limits<double>::max();
+    std::vector<std::vector<double>> lb, ub, err;
+    double peak = range_analysis(in_range, eps, lb, ub, err);
+
+    std::stringstream s;
+    s << std::scientific << std::setprecision(3);
+    s << "/* Range analysis, unit roundoff " << eps << ":\n"
+      << "   intermediate results: |w| <= " << peak << "\n";
+    for (casadi_int i=0; i<n_out_; ++i) {
+      if (lb[i].empty()) continue;
+      s << "   " << name_out_[i] << ": ["
+        << *std::min_element(lb[i].begin(), lb[i].end()) << ", "
+        << *std::max_element(ub[i].begin(), ub[i].end()) << "], rounding error <= "
+        << *std::max_element(err[i].begin(), err[i].end()) << "\n";
+    }
+    s << "*/\n";
+    g << s.str();
+
+    if (peak>real_max) {
+      casadi_warning("Range analysis of '" + name_ + "': Intermediate results may overflow "
+        + g.casadi_real_type + " (|w| <= " + str(peak) + ")");
+    }
+  }
+
+  casadi_int SXFunction::codegen_batch_sz_w(const CodeGenerator& g, casadi_int n) const {
+    // Zeros for missing inputs, scratch space for missing outputs
+    casadi_int max_nnz_in = 0, max_nnz_out = 0;
+    for (casadi_int i=0; i<n_in_; ++i) max_nnz_in = std::max(max_nnz_in, nnz_in(i));
+    for (casadi_int i=0; i<n_out_; ++i) max_nnz_out = std::max(max_nnz_out, nnz_out(i));
+    casadi_int sz = n*(max_nnz_in + max_nnz_out);
+    // Work vector of all instances, if not on the stack
+    if (g.avoid_stack()) sz += n*worksize_;
+    return sz;
+  }
+
+  void SXFunction::codegen_batch_body(CodeGenerator& g, casadi_int n) const {
+    casadi_int max_nnz_in = 0;
+    for (casadi_int i=0; i<n_in_; ++i) max_nnz_in = std::max(max_nnz_in, nnz_in(i));
+    casadi_int off_w = codegen_batch_sz_w(g, n) - (g.avoid_stack() ? n*worksize_ : 0);
+
+    // Missing inputs are read from zeros, missing outputs written to scratch space,
+    // so that the loop over the instances is free of branches
+    if (n_in_>0) {
+      g.local("k", "casadi_int");
+      std::string cond;
+      for (casadi_int i=0; i<n_in_; ++i) {
+        g.local("x" + str(i), "const casadi_real", "*");
+        g << "x" << i << " = " << g.arg(i) << " ? " << g.arg(i) << " : w;\n";
+        cond += (i==0 ? "" : " || ") + g.arg(i) + "==0";
+      }
+      g << "if (" << cond << ") for (k=0; k<" << n*max_nnz_in << "; ++k) w[k] = 0;\n";
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      g.local("y" + str(i), "casadi_real", "*");
+      g << "y" << i << " = " << g.res(i) << " ? " << g.res(i) << " : w+"
+        << n*max_nnz_in << ";\n";
+    }
+
+    // Work vector element i of instance k
+    auto work = [&](casadi_int i) -> std::string {
+      if (g.avoid_stack()) return "w[" + str(off_w + i*n) + "+k]";
+      return g.sx_work(i);
+    };
+
+    // One iteration per instance, which only accesses entries of that instance
+    g.local("k", "casadi_int");
+    g << "#if defined(__clang__)\n"
+      << "#pragma clang loop vectorize(assume_safety)\n"
+      << "#elif defined(__GNUC__)\n"
+      << "#pragma GCC ivdep\n"
+      << "#elif defined(_MSC_VER)\n"
+      << "#pragma loop(ivdep)\n"
+      << "#endif\n";
+    g << "for (k=0; k<" << n << "; ++k) {\n";
+    for (auto&& a : algorithm_) {
+      if (a.op==OP_OUTPUT) {
+        g << "y" << a.i0 << "[" << a.i2*n << "+k]=" << work(a.i1);
+      } else {
+        // Where to store the result
+        g << work(a.i0) << "=";
+
+        // What to store
+        if (a.op==OP_CONST) {
+          g << g.constant_real(a.d);
+        } else if (a.op==OP_INPUT) {
+          g << "x" << a.i1 << "[" << a.i2*n << "+k]";
+        } else {
+          casadi_int ndep = casadi_math<double>::ndeps(a.op);
+          casadi_assert_dev(ndep>0);
+          if (ndep==1) g << g.print_op(a.op, work(a.i1));
+          if (ndep==2) g << g.print_op(a.op, work(a.i1), work(a.i2));
+        }
+      }
+      g  << ";\n";
+    }
+    g << "}\n";
+  }
+
+  void SXFunction::codegen_cuda_body(CodeGenerator& g) const {
+    // Instance evaluated by this thread
+    g.local("k", "casadi_int");
+    g << "k = (casadi_int)blockIdx.x*blockDim.x + threadIdx.x;\n";
+    g << "if (k>=n) return;\n";
+
+    // Work vector elements are registers, auxiliaries are host functions
+    auto work = [&](casadi_int i) -> std::string {
+      std::string name = "a" + str(i);
+      g.local(name, "casadi_real");
+      return name;
+    };
+    for (auto&& a : algorithm_) {
+      if (a.op==OP_OUTPUT) {
+        g << "if (y" << a.i0 << ") y" << a.i0 << "[" << a.i2 << "*n+k]=" << work(a.i1);
+      } else {
+        // Where to store the result
+        std::string r = work(a.i0);
+        g << r << "=";
+
+        // What to store
+        if (a.op==OP_CONST) {
+          g << g.constant_real(a.d);
+        } else if (a.op==OP_INPUT) {
+          g << "x" << a.i1 << " ? x" << a.i1 << "[" << a.i2 << "*n+k] : 0";
+        } else {
+          casadi_int ndep = casadi_math<double>::ndeps(a.op);
+          casadi_assert_dev(ndep>0);
+          std::string x = work(a.i1), y = ndep==2 ? work(a.i2) : "";
+          switch (a.op) {
+            case OP_SQ: g << "(" << x << "*" << x << ")"; break;
+            case OP_SIGN: g << "(" << x << "<0 ? -1 : " << x << ">0 ? 1 : " << x << ")"; break;
+            case OP_FABS: case OP_LOG1P: case OP_EXPM1:
+              g << g.math_fun(casadi_math<double>::name(a.op)) << "(" << x << ")"; break;
+            case OP_FMIN: case OP_FMAX: case OP_HYPOT:
+              g << g.math_fun(casadi_math<double>::name(a.op)) << "(" << x << "," << y << ")";
+              break;
+            default:
+              g << (ndep==1 ? g.print_op(a.op, x) : g.print_op(a.op, x, y));
+          }
+        }
+      }
+      g  << ";\n";
+    }
+  }
+
+  double casadi_sx_math(int op, double x, double y) {
+    double f;
+    casadi_math<double>::fun(static_cast<unsigned char>(op), x, y, f);
+    return f;
+  }
+
+  namespace {
+    // LLVM IR literal representing a double exactly
+    std::string llvm_double(double d) {
+      uint64_t bits;
+      std::memcpy(&bits, &d, sizeof(bits));
+      std::stringstream ss;
+      ss << "0x" << std::hex << std::uppercase << std::setw(16) << std::setfill('0') << bits;
+      return ss.str();
+    }
+  } // namespace
+
+  std::string SXFunction::llvm_ir(const std::string& fname) const {
+    casadi_assert(free_vars_.empty(), "Cannot generate LLVM IR for \"" + name_
+      + "\" since variables " + str(free_vars_) + " are free.");
+
+    // Largest input and output
+    casadi_int max_nnz_in = 1, max_nnz_out = 1;
+    for (casadi_int i=0; i<n_in_; ++i) max_nnz_in = std::max(max_nnz_in, nnz_in(i));
+    for (casadi_int i=0; i<n_out_; ++i) max_nnz_out = std::max(max_nnz_out, nnz_out(i));
+
+    // Function body, intrinsics that are used
+    std::stringstream b;
+    std::set<std::string> intrinsics;
+    bool has_generic = false;
+
+    // Value held by each location of the work vector
+    std::vector<std::string> val(worksize_);
+
+    // Input and output pointers, loaded at the first use
+    std::vector<bool> arg_loaded(n_in_, false), res_loaded(n_out_, false);
+
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& a = algorithm_[k];
+      std::string t = "%t" + str(k);
+      if (a.op==OP_CONST) {
+        val.at(a.i0) = llvm_double(a.d);
+        continue;
+      } else if (a.op==OP_INPUT) {
+        // Missing inputs are read from a vector of zeros
+        if (!arg_loaded[a.i1]) {
+          std::string p = "%arg" + str(a.i1);
+          b << "  " << p << ".p = getelementptr ptr, ptr %arg, i64 " << a.i1 << "\n"
+            << "  " << p << ".v = load ptr, ptr " << p << ".p\n"
+            << "  " << p << ".n = icmp eq ptr " << p << ".v, null\n"
+            << "  " << p << " = select i1 " << p << ".n, ptr @zeros, ptr " << p << ".v\n";
+          arg_loaded[a.i1] = true;
+        }
+        b << "  " << t << ".p = getelementptr double, ptr %arg" << a.i1 << ", i64 " << a.i2 << "\n"
+          << "  " << t << " = load double, ptr " << t << ".p\n";
+      } else if (a.op==OP_OUTPUT) {
+        // Missing outputs are written to scratch memory
+        if (!res_loaded[a.i0]) {
+          std::string p = "%res" + str(a.i0);
+          b << "  " << p << ".p = getelementptr ptr, ptr %res, i64 " << a.i0 << "\n"
+            << "  " << p << ".v = load ptr, ptr " << p << ".p\n"
+            << "  " << p << ".n = icmp eq ptr " << p << ".v, null\n"
+            << "  " << p << " = select i1 " << p << ".n, ptr %scratch, ptr " << p << ".v\n";
+          res_loaded[a.i0] = true;
+        }
+        b << "  " << t << ".p = getelementptr double, ptr %res" << a.i0 << ", i64 " << a.i2 << "\n"
+          << "  store double " << val.at(a.i1) << ", ptr " << t << ".p\n";
+        continue;
+      } else {
+        const std::string& x = val.at(a.i1);
+        const std::string& y = casadi_math<double>::ndeps(a.op)==2 ? val.at(a.i2) : x;
+        std::string intrinsic;
+        switch (a.op) {
+        case OP_ASSIGN: val.at(a.i0) = x; continue;
+        case OP_ADD: b << "  " << t << " = fadd double " << x << ", " << y << "\n"; break;
+        case OP_SUB: b << "  " << t << " = fsub double " << x << ", " << y << "\n"; break;
+        case OP_MUL: b << "  " << t << " = fmul double " << x << ", " << y << "\n"; break;
+        case OP_DIV: b << "  " << t << " = fdiv double " << x << ", " << y << "\n"; break;
+        case OP_NEG: b << "  " << t << " = fneg double " << x << "\n"; break;
+        case OP_SQ: b << "  " << t << " = fmul double " << x << ", " << x << "\n"; break;
+        case OP_TWICE: b << "  " << t << " = fadd double " << x << ", " << x << "\n"; break;
+        case OP_INV:
+          b << "  " << t << " = fdiv double " << llvm_double(1) << ", " << x << "\n";
+          break;
+        case OP_LT: case OP_LE: case OP_EQ: case OP_NE:
+          b << "  " << t << ".c = fcmp "
+            << (a.op==OP_LT ? "olt" : a.op==OP_LE ? "ole" : a.op==OP_EQ ? "oeq" : "une")
+            << " double " << x << ", " << y << "\n"
+            << "  " << t << " = uitofp i1 " << t << ".c to double\n";
+          break;
+        case OP_NOT:
+          b << "  " << t << ".c = fcmp oeq double " << x << ", 0.0\n"
+            << "  " << t << " = uitofp i1 " << t << ".c to double\n";
+          break;
+        case OP_AND: case OP_OR:
+          b << "  " << t << ".x = fcmp une double " << x << ", 0.0\n"
+            << "  " << t << ".y = fcmp une double " << y << ", 0.0\n"
+            << "  " << t << ".c = " << (a.op==OP_AND ? "and" : "or") << " i1 "
+            << t << ".x, " << t << ".y\n"
+            << "  " << t << " = uitofp i1 " << t << ".c to double\n";
+          break;
+        case OP_IF_ELSE_ZERO:
+          b << "  " << t << ".c = fcmp une double " << x << ", 0.0\n"
+            << "  " << t << " = select i1 " << t << ".c, double " << y << ", double 0.0\n";
+          break;
+        case OP_SQRT: intrinsic = "sqrt"; break;
+        case OP_SIN: intrinsic = "sin"; break;
+        case OP_COS: intrinsic = "cos"; break;
+        case OP_EXP: intrinsic = "exp"; break;
+        case OP_LOG: intrinsic = "log"; break;
+        case OP_FABS: intrinsic = "fabs"; break;
+        case OP_FLOOR: intrinsic = "floor"; break;
+        case OP_CEIL: intrinsic = "ceil"; break;
+        case OP_POW: case OP_CONSTPOW: intrinsic = "pow"; break;
+        case OP_FMIN: intrinsic = "minnum"; break;
+        case OP_FMAX: intrinsic = "maxnum"; break;
+        case OP_COPYSIGN: intrinsic = "copysign"; break;
+        default:
+          // Any other operation, evaluated by CasADi
+          b << "  " << t << " = call double @casadi_sx_math(i32 " << static_cast<int>(a.op)
+            << ", double " << x << ", double " << y << ")\n";
+          has_generic = true;
+        }
+        if (!intrinsic.empty()) {
+          bool binary = a.op==OP_POW || a.op==OP_CONSTPOW || a.op==OP_FMIN
+            || a.op==OP_FMAX || a.op==OP_COPYSIGN;
+          b << "  " << t << " = call double @llvm." << intrinsic << ".f64(double " << x;
+          if (binary) b << ", double " << y;
+          b << ")\n";
+          intrinsics.insert(intrinsic + (binary ? ".f64(double, double)" : ".f64(double)"));
+        }
+      }
+      val.at(a.i0) = t;
+    }
+
+    // Assemble module
+    std::stringstream s;
+    s << "; LLVM IR for the CasADi function '" << name_ << "'\n"
+      << "@zeros = private unnamed_addr constant [" << max_nnz_in << " x double] "
+      << "zeroinitializer\n";
+    for (auto&& i : intrinsics) s << "declare double @llvm." << i << "\n";
+    if (has_generic) s << "declare double @casadi_sx_math(i32, double, double)\n";
+    s << "\n"
+      << "define i32 @\"" << fname << "\"(ptr %arg, ptr %res, "
+      << "ptr %iw, ptr %w, i32 %mem) {\n"
+      << "entry:\n"
+      << "  %scratch = alloca [" << max_nnz_out << " x double]\n"
+      << b.str()
+      << "  ret i32 0\n"
+      << "}\n";
+    return s.str();
+  }
+
   const Options SXFunction::options_
   = {{&FunctionInternal::options_},
      {{"default_in",
@@ -189,10 +1328,38 @@ namespace casadi {
         "Reuse variables in the work vector"}},
       {"cse",
        {OT_BOOL,
-        "Perform common subexpression elimination (complexity is N*log(N) in graph size)"}},
+        "Perform common subexpression elimination (hash-based, linear in graph size)"}},
+      {"optimize",
+       {OT_BOOL,
+        "Reduce the operation count before evaluation or code generation: "
+        "constant folding, strength reduction (e.g. x^2 -> x*x, division by a constant "
+        "-> multiplication), reassociation of constant terms, dead code elimination and "
+        "common subexpression elimination. May change results in the last digits. "
+        "The count is reported with verbose and by info()"}},
       {"allow_free",
        {OT_BOOL,
         "Allow construction with free variables (Default: false)"}},
+      {"bytecode",
+       {OT_BOOL,
+        "Evaluate numerically using an optimized bytecode interpreter (Default: false)"}},
+      {"instruction_order",
+       {OT_STRING,
+        "Order of the instructions: 'depth_first' (default) visits the operands in order, "
+        "'sethi_ullman' visits the operand that needs most work vector entries first, "
+        "which reduces the size of the work vector and keeps producers close to their "
+        "consumers. The resulting size is reported with verbose and by sz_w()"}},
+      {"short_circuit",
+       {OT_BOOL,
+        "Place the instructions that are only needed by the value of an if_else_zero "
+        "right before it, and skip them when the condition is zero. Applies to numerical "
+        "evaluation and generated code, not to the bytecode interpreter or batch "
+        "evaluation (Default: false)"}},
+      {"numeric_ad",
+       {OT_BOOL,
+        "Evaluate forward and reverse directional derivatives numerically, by recording "
+        "the partial derivatives of each operation on a tape and propagating the "
+        "directions through it, instead of constructing derivative expressions. "
+        "Jacobians are then assembled from directional derivatives (Default: false)"}},
       {"allow_duplicate_io_names",
        {OT_BOOL,
         "Allow construction with duplicate io names (Default: false)"}}
@@ -205,9 +1372,113 @@ namespace casadi {
     opts["live_variables"] = live_variables_;
     opts["just_in_time_sparsity"] = just_in_time_sparsity_;
     opts["just_in_time_opencl"] = just_in_time_opencl_;
+    opts["bytecode"] = bytecode_;
+    opts["short_circuit"] = short_circuit_;
+    opts["numeric_ad"] = numeric_ad_;
     return opts;
   }
 
+  /// Apply an operation, with rewrites that reduce the cost of evaluation
+  static SXElem optimize_op(casadi_int op, const SXElem& x, const SXElem& y) {
+    switch (op) {
+    case OP_POW:
+    case OP_CONSTPOW:
+      // Strength reduction of small constant powers
+      if (y.is_constant()) {
+        double p = static_cast<double>(y);
+        if (p==1) return x;
+        if (p==2) return sq(x);
+        if (p==3) return x*sq(x);
+        if (p==-1) return 1/x;
+        if (p==0.5) return sqrt(x);
+      }
+      break;
+    case OP_DIV:
+      // Division by a constant becomes multiplication by its reciprocal
+      if (y.is_constant()) {
+        double r = 1/static_cast<double>(y);
+        if (std::isfinite(r) && r!=0) return optimize_op(OP_MUL, r, x);
+      }
+      break;
+    case OP_MUL:
+      // Constant factor first, then combine constants: c1*(c2*x) -> (c1*c2)*x
+      if (!x.is_constant() && y.is_constant()) return optimize_op(OP_MUL, y, x);
+      if (x.is_constant() && y.is_op(OP_MUL) && y.dep(0).is_constant()) {
+        return SXElem(static_cast<double>(x)*static_cast<double>(y.dep(0))) * y.dep(1);
+      }
+      break;
+    case OP_SUB:
+      // x - c -> (-c) + x
+      if (!x.is_constant() && y.is_constant()) {
+        return optimize_op(OP_ADD, -static_cast<double>(y), x);
+      }
+      break;
+    case OP_ADD:
+      // Constant term first, then combine constants: c1+(c2+x) -> (c1+c2)+x
+      if (!x.is_constant() && y.is_constant()) return optimize_op(OP_ADD, y, x);
+      if (x.is_constant() && y.is_op(OP_ADD) && y.dep(0).is_constant()) {
+        return SXElem(static_cast<double>(x)+static_cast<double>(y.dep(0))) + y.dep(1);
+      }
+      if (x.is_constant() && y.is_op(OP_SUB) && y.dep(0).is_constant()) {
+        return SXElem(static_cast<double>(x)+static_cast<double>(y.dep(0))) - y.dep(1);
+      }
+      break;
+    default: break;
+    }
+    // No rewrite, constants are folded when the node is created
+    SXElem f;
+    switch (op) {
+      CASADI_MATH_FUN_BUILTIN(x, y, f)
+    }
+    return f;
+  }
+
+  /** \brief Rebuild an expression graph with rewrites that reduce the operation count
+
+    Constant folding, strength reduction and reassociation of constant terms
+    and factors are applied in a single topologically sorted pass. Nodes that
+    no longer contribute to any output are dropped since the new graph is
+    built from the outputs, and common subexpressions are merged afterwards.
+  */
+  static std::vector<SX> optimize_graph(const std::vector<SX>& e, casadi_int& n_op) {
+    Function f("f", std::vector<SX>{}, e, {{"live_variables", false},
+      {"max_io", 0}, {"cse", false}, {"allow_free", true}});
+    const SXFunction* ff = f.get<SXFunction>();
+    n_op = ff->operations_.size();
+
+    std::vector<SX> ret;
+    for (auto&& ek : e) ret.push_back(SX::zeros(ek.sparsity()));
+
+    // Symbolic work vector
+    std::vector<SXElem> w(ff->worksize_);
+    std::vector<SXElem>::const_iterator c_it = ff->constants_.begin();
+    std::vector<SXElem>::const_iterator p_it = ff->free_vars_.begin();
+    for (auto&& a : ff->algorithm_) {
+      switch (a.op) {
+      case OP_INPUT:
+        w[a.i0] = 0;
+        break;
+      case OP_OUTPUT:
+        ret[a.i0].nonzeros().at(a.i2) = w[a.i1];
+        break;
+      case OP_CONST:
+        w[a.i0] = *c_it++;
+        break;
+      case OP_PARAMETER:
+        w[a.i0] = *p_it++;
+        break;
+      default:
+        {
+          // Evaluate to a temporary, the result may overwrite an operand
+          SXElem r = optimize_op(a.op, w[a.i1],
+            casadi_math<double>::ndeps(a.op)==2 ? w[a.i2] : SXElem(0));
+          w[a.i0] = r;
+        }
+      }
+    }
+    return SX::cse(ret);
+  }
+
   void SXFunction::init(const Dict& opts) {
     // Call the init function of the base class
     XFunction<SXFunction, SX, SXNode>::init(opts);
@@ -217,7 +1488,9 @@ namespace casadi {
     live_variables_ = true;
 
     bool cse_opt = false;
+    bool optimize_opt = false;
     bool allow_free = false;
+    std::string instruction_order = "depth_first";
 
     // Read options
     for (auto&& op : opts) {
@@ -229,14 +1502,33 @@ namespace casadi {
         just_in_time_opencl_ = op.second;
       } else if (op.first=="just_in_time_sparsity") {
         just_in_time_sparsity_ = op.second;
+      } else if (op.first=="bytecode") {
+        bytecode_ = op.second;
+      } else if (op.first=="short_circuit") {
+        short_circuit_ = op.second;
+      } else if (op.first=="numeric_ad") {
+        numeric_ad_ = op.second;
       } else if (op.first=="cse") {
         cse_opt = op.second;
+      } else if (op.first=="optimize") {
+        optimize_opt = op.second;
       } else if (op.first=="allow_free") {
         allow_free = op.second;
+      } else if (op.first=="instruction_order") {
+        instruction_order = op.second.to_string();
+        casadi_assert(instruction_order=="depth_first" || instruction_order=="sethi_ullman",
+          "Option 'instruction_order' must be 'depth_first' or 'sethi_ullman', got '"
+          + instruction_order + "'");
       }
     }
 
-    if (cse_opt) out_ = cse(out_);
+    // Operation count before optimization, for reporting
+    casadi_int n_op_before = -1;
+    if (optimize_opt) {
+      out_ = optimize_graph(out_, n_op_before);
+    } else if (cse_opt) {
+      out_ = cse(out_);
+    }
 
     // Check/set default inputs
     if (default_in_.empty()) {
@@ -274,6 +1566,13 @@ namespace casadi {
       }
     }
 
+    // Reduce the number of live variables, updates the temporary variables
+    if (instruction_order=="sethi_ullman") sort_sethi_ullman(nodes);
+
+    // Make branches contiguous, updates the temporary variables
+    branches_.clear();
+    if (short_circuit_) sort_branches(nodes);
+
     // Sort the nodes by type
     constants_.clear();
     operations_.clear();
@@ -286,6 +1585,10 @@ namespace casadi {
           operations_.push_back(SXElem::create(t));
       }
     }
+    if (verbose_ && n_op_before>=0) {
+      casadi_message(name_ + "::init: optimize reduced the operation count from "
+                     + str(n_op_before) + " to " + str(operations_.size()));
+    }
 
     // Input instructions
     std::vector<std::pair<int, SXNode*> > symb_loc;
@@ -415,6 +1718,9 @@ namespace casadi {
 
     worksize_ = worksize;
 
+    // Location of the branch conditions in the work vector
+    for (auto&& b : branches_) b.cond = place[b.cond];
+
     if (verbose_) {
       if (live_variables_) {
         casadi_message("Using live variables: work array is " + str(worksize_)
@@ -489,10 +1795,208 @@ namespace casadi {
       casadi_error("OpenCL is not supported in this version of CasADi");
     }
 
+    // Lower to bytecode
+    if (bytecode_ && free_vars_.empty()) {
+      vm_compile();
+      alloc_w(vm_worksize_);
+    }
+
+    // Dependencies of the outputs, for partial evaluation
+    init_out_mask();
+
     // Print
     if (verbose_) casadi_message(str(algorithm_.size()) + " elementary operations");
   }
 
+  void SXFunction::sort_sethi_ullman(std::vector<SXNode*>& nodes) {
+    casadi_int n = nodes.size();
+
+    // Work vector entries needed to evaluate each node, as if the graph was a tree
+    std::vector<casadi_int> need(n, 0);
+    for (casadi_int i=0; i<n; ++i) {
+      SXNode* t = nodes[i];
+      if (!t) continue;
+      if (t->n_dep()==0) {
+        need[i] = 1;
+      } else if (t->n_dep()==1) {
+        need[i] = need[t->dep(0).get()->temp];
+      } else {
+        casadi_int a = need[t->dep(0).get()->temp], b = need[t->dep(1).get()->temp];
+        need[i] = a==b ? a+1 : std::max(a, b);
+      }
+    }
+
+    // Depth-first search from each output nonzero, most demanding operand first
+    std::vector<SXNode*> ret;
+    ret.reserve(n);
+    std::vector<bool> done(n, false);
+    // Node, number of operands visited and whether to visit the operands in reverse order
+    struct Visit {
+      SXNode* t;
+      casadi_int next;
+      bool rev;
+    };
+    std::vector<Visit> s;
+    for (auto&& e : out_) {
+      for (auto&& nz : e.nonzeros()) {
+        s.push_back({nz.get(), 0, false});
+        while (!s.empty()) {
+          Visit& v = s.back();
+          casadi_int k = v.t->temp;
+          if (done[k]) {
+            s.pop_back();
+          } else if (v.next < v.t->n_dep()) {
+            if (v.next==0 && v.t->n_dep()==2) {
+              // Operands already evaluated need no additional entries
+              casadi_int c0 = v.t->dep(0).get()->temp, c1 = v.t->dep(1).get()->temp;
+              v.rev = (done[c1] ? 0 : need[c1]) > (done[c0] ? 0 : need[c0]);
+            }
+            casadi_int d = v.rev ? v.t->n_dep()-1-v.next : v.next;
+            v.next++;
+            s.push_back({v.t->dep(d).get(), 0, false});
+          } else {
+            ret.push_back(v.t);
+            done[k] = true;
+            s.pop_back();
+          }
+        }
+        // Output instruction
+        ret.push_back(nullptr);
+      }
+    }
+    casadi_assert_dev(ret.size()==n);
+
+    // Update the positions
+    nodes = ret;
+    for (casadi_int i=0; i<n; ++i) {
+      if (nodes[i]) nodes[i]->temp = static_cast<int>(i);
+    }
+  }
+
+  void SXFunction::sort_branches(std::vector<SXNode*>& nodes) {
+    casadi_int n = nodes.size();
+
+    // Number of references to each node, including the outputs
+    std::vector<casadi_int> uses(n, 0);
+    for (SXNode* t : nodes) {
+      if (t) {
+        for (casadi_int d=0; d<t->n_dep(); ++d) uses[t->dep(d).get()->temp]++;
+      }
+    }
+    for (auto&& e : out_) {
+      for (auto&& nz : e.nonzeros()) uses[nz.get()->temp]++;
+    }
+
+    // Innermost if_else_zero whose branch contains each node, -1 if none.
+    // Nested if_else_zero nodes come first, so their branches are found first
+    std::vector<casadi_int> owner(n, -1);
+    std::vector<casadi_int> cnt(n, 0), touched;
+    std::priority_queue<casadi_int> q;
+    for (casadi_int i=0; i<n; ++i) {
+      if (!nodes[i] || nodes[i]->op()!=OP_IF_ELSE_ZERO) continue;
+      casadi_int y = nodes[i]->dep(1).get()->temp;
+      cnt[y]++;
+      touched.push_back(y);
+      q.push(y);
+      // Nodes are visited after all their users, in reverse topological order
+      while (!q.empty()) {
+        casadi_int j = q.top();
+        q.pop();
+        // Not in the branch if used elsewhere
+        if (cnt[j]<uses[j] || nodes[j]->is_symbolic()) continue;
+        if (owner[j]<0) owner[j] = i;
+        for (casadi_int d=0; d<nodes[j]->n_dep(); ++d) {
+          casadi_int c = nodes[j]->dep(d).get()->temp;
+          if (cnt[c]++==0) {
+            touched.push_back(c);
+            q.push(c);
+          }
+        }
+      }
+      for (casadi_int j : touched) cnt[j] = 0;
+      touched.clear();
+    }
+
+    // Nodes outside of any branch and the branch of each if_else_zero, in the original order
+    std::vector<casadi_int> top;
+    std::map<casadi_int, std::vector<casadi_int>> branch;
+    for (casadi_int i=0; i<n; ++i) {
+      if (owner[i]<0) {
+        top.push_back(i);
+      } else {
+        branch[owner[i]].push_back(i);
+      }
+    }
+
+    // Emit each branch right before its if_else_zero, without recursion
+    std::vector<SXNode*> sorted;
+    sorted.reserve(n);
+    std::vector<casadi_int> pos(n), open;
+    std::vector<std::pair<const std::vector<casadi_int>*, casadi_int>> stack;
+    stack.push_back(std::make_pair(&top, 0));
+    while (!stack.empty()) {
+      auto& s = stack.back();
+      if (s.second==s.first->size()) {
+        stack.pop_back();
+        if (stack.empty()) break;
+        // The branch is complete, add its if_else_zero
+        casadi_int i = (*stack.back().first)[stack.back().second++];
+        branches_[open.back()].end = sorted.size();
+        open.pop_back();
+        pos[i] = sorted.size();
+        sorted.push_back(nodes[i]);
+        continue;
+      }
+      casadi_int i = (*s.first)[s.second];
+      auto it = branch.find(i);
+      if (it==branch.end()) {
+        s.second++;
+        if (nodes[i]) pos[i] = sorted.size();
+        sorted.push_back(nodes[i]);
+      } else {
+        open.push_back(branches_.size());
+        branches_.push_back({static_cast<casadi_int>(sorted.size()), -1,
+                             nodes[i]->dep(0).get()->temp});
+        stack.push_back(std::make_pair(&it->second, 0));
+      }
+    }
+
+    // Conditions refer to the new positions
+    for (auto&& b : branches_) b.cond = pos[b.cond];
+    nodes = sorted;
+    for (casadi_int i=0; i<n; ++i) {
+      if (nodes[i]) nodes[i]->temp = static_cast<int>(i);
+    }
+  }
+
+  void SXFunction::init_out_mask() {
+    out_mask_.clear();
+    if (n_out_<=1) return;
+    out_mask_.resize(algorithm_.size());
+    // Propagate backward, like sp_reverse
+    std::vector<bvec_t> wmask(worksize_, 0);
+    for (casadi_int k=algorithm_.size()-1; k>=0; --k) {
+      const AlgEl& e = algorithm_[k];
+      switch (e.op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+      case OP_INPUT:
+        out_mask_[k] = wmask[e.i0];
+        wmask[e.i0] = 0;
+        break;
+      case OP_OUTPUT:
+        out_mask_[k] = bvec_t(1) << (e.i0 % bvec_size);
+        wmask[e.i1] |= out_mask_[k];
+        break;
+      default: // Unary or binary operation
+        out_mask_[k] = wmask[e.i0];
+        wmask[e.i0] = 0;
+        wmask[e.i1] |= out_mask_[k];
+        wmask[e.i2] |= out_mask_[k];
+      }
+    }
+  }
+
   SX SXFunction::instructions_sx() const {
     std::vector<SXElem> ret(algorithm_.size(), casadi_limits<SXElem>::nan);
 
@@ -648,12 +2152,11 @@ namespace casadi {
       }
     }
 
-    // Work vector
-    std::vector<SXElem> w(worksize_);
-
     // Calculate forward sensitivities
     if (verbose_) casadi_message("Calculating forward derivatives");
-    for (casadi_int dir=0; dir<nfwd; ++dir) {
+    auto fwd = [&](casadi_int dir) {
+      // Work vector
+      std::vector<SXElem> w(worksize_);
       std::vector<TapeEl<SXElem> >::const_iterator it2 = s_pdwork.begin();
       for (auto&& a : algorithm_) {
         switch (a.op) {
@@ -677,7 +2180,13 @@ namespace casadi {
           it2++;
         }
       }
-    }
+    };
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    // The directions are independent and only share the tape
+    ThreadPool::instance().run(nfwd, fwd);
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
+    for (casadi_int dir=0; dir<nfwd; ++dir) fwd(dir);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
   }
 
   void SXFunction::ad_reverse(const std::vector<std::vector<SX> >& aseed,
@@ -691,111 +2200,706 @@ namespace casadi {
     // Quick return if possible
     if (nadj==0) return;
 
-    // Check if seeds need to have dimensions corrected
-    casadi_int npar = 1;
-    for (auto&& r : aseed) {
-      if (!matching_res(r, npar)) {
-        casadi_assert_dev(npar==1);
-        return ad_reverse(replace_aseed(aseed, npar), asens);
-      }
+    // Check if seeds need to have dimensions corrected
+    casadi_int npar = 1;
+    for (auto&& r : aseed) {
+      if (!matching_res(r, npar)) {
+        casadi_assert_dev(npar==1);
+        return ad_reverse(replace_aseed(aseed, npar), asens);
+      }
+    }
+
+    // Make sure matching sparsity of fseed
+    bool matching_sparsity = true;
+    for (casadi_int d=0; d<nadj; ++d) {
+      casadi_assert_dev(aseed[d].size()==n_out_);
+      for (casadi_int i=0; matching_sparsity && i<n_out_; ++i)
+        matching_sparsity = aseed[d][i].sparsity()==sparsity_out_[i];
+    }
+
+    // Correct sparsity if needed
+    if (!matching_sparsity) {
+      std::vector<std::vector<SX> > aseed2(aseed);
+      for (casadi_int d=0; d<nadj; ++d)
+        for (casadi_int i=0; i<n_out_; ++i)
+          if (aseed2[d][i].sparsity()!=sparsity_out_[i])
+            aseed2[d][i] = project(aseed2[d][i], sparsity_out_[i]);
+      return ad_reverse(aseed2, asens);
+    }
+
+    // Allocate results if needed
+    for (casadi_int d=0; d<nadj; ++d) {
+      asens[d].resize(n_in_);
+      for (casadi_int i=0; i<asens[d].size(); ++i) {
+        if (asens[d][i].sparsity()!=sparsity_in_[i]) {
+          asens[d][i] = SX::zeros(sparsity_in_[i]);
+        } else {
+          std::fill(asens[d][i]->begin(), asens[d][i]->end(), 0);
+        }
+      }
+    }
+
+    // Iterator to the binary operations
+    std::vector<SXElem>::const_iterator b_it=operations_.begin();
+
+    // Tape
+    std::vector<TapeEl<SXElem> > s_pdwork(operations_.size());
+    std::vector<TapeEl<SXElem> >::iterator it1 = s_pdwork.begin();
+
+    // Evaluate algorithm
+    if (verbose_) casadi_message("Evaluating algorithm forward");
+    for (auto&& a : algorithm_) {
+      switch (a.op) {
+      case OP_INPUT:
+      case OP_OUTPUT:
+      case OP_CONST:
+      case OP_PARAMETER:
+        break;
+      default:
+        {
+          const SXElem& f=*b_it++;
+          switch (a.op) {
+            CASADI_MATH_DER_BUILTIN(f->dep(0), f->dep(1), f, it1++->d)
+          }
+        }
+      }
+    }
+
+    // Calculate adjoint sensitivities
+    if (verbose_) casadi_message("Calculating adjoint derivatives");
+
+    auto adj = [&](casadi_int dir) {
+      // Work vector
+      std::vector<SXElem> w(worksize_, 0);
+      auto it2 = s_pdwork.rbegin();
+      for (auto it = algorithm_.rbegin(); it!=algorithm_.rend(); ++it) {
+        SXElem seed;
+        switch (it->op) {
+        case OP_INPUT:
+          asens[dir][it->i1].nonzeros()[it->i2] = w[it->i0];
+          w[it->i0] = 0;
+          break;
+        case OP_OUTPUT:
+          w[it->i1] += aseed[dir][it->i0].nonzeros()[it->i2];
+          break;
+        case OP_CONST:
+        case OP_PARAMETER:
+          w[it->i0] = 0;
+          break;
+        case OP_IF_ELSE_ZERO:
+          seed = w[it->i0];
+          w[it->i0] = 0;
+          w[it->i2] += if_else_zero(it2++->d[1], seed);
+          break;
+        CASADI_MATH_BINARY_BUILTIN // Binary operation
+          seed = w[it->i0];
+          w[it->i0] = 0;
+          w[it->i1] += it2->d[0] * seed;
+          w[it->i2] += it2++->d[1] * seed;
+          break;
+        default: // Unary operation
+          seed = w[it->i0];
+          w[it->i0] = 0;
+          w[it->i1] += it2++->d[0] * seed;
+        }
+      }
+    };
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    // The directions are independent and only share the tape
+    ThreadPool::instance().run(nadj, adj);
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
+    for (casadi_int dir=0; dir<nadj; ++dir) adj(dir);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+  }
+
+  // Scaled partial derivatives d^(p+q) f/(dx^p dy^q)/(p! q!), p+q<=order, of an
+  // operation, ordered by p and then by q (q=0 only for unary operations)
+  static Function taylor_partials(casadi_int op, casadi_int order) {
+    SX x = SX::sym("x"), y = SX::sym("y");
+    SXElem f;
+    casadi_math<SXElem>::fun(op, x->at(0), y->at(0), f);
+    bool binary = casadi_math<double>::ndeps(op)==2;
+    std::vector<SX> d;
+    SX dp = f;
+    for (casadi_int p=0; p<=order; ++p) {
+      if (p>0) dp = jacobian(dp, x) / static_cast<double>(p);
+      SX dpq = dp;
+      for (casadi_int q=0; q<=(binary ? order-p : 0); ++q) {
+        if (q>0) dpq = jacobian(dpq, y) / static_cast<double>(q);
+        d.push_back(dpq);
+      }
+    }
+    return Function("taylor_partials_" + str(op), {x, y}, d);
+  }
+
+  // Coefficients 1..order of the truncated Taylor polynomial of an operation,
+  // given the polynomials of the arguments and the nondifferentiated result c[0]
+  static void taylor_op(casadi_int op, const std::vector<SXElem>& a,
+                        const std::vector<SXElem>& b, std::vector<SXElem>& c,
+                        std::map<casadi_int, Function>& partials) {
+    casadi_int k = c.size() - 1;
+    switch (op) {
+    case OP_ASSIGN:
+    case OP_LIFT:
+    case OP_PRINTME:
+      for (casadi_int j=1; j<=k; ++j) c[j] = a[j];
+      return;
+    case OP_ADD:
+      for (casadi_int j=1; j<=k; ++j) c[j] = a[j] + b[j];
+      return;
+    case OP_SUB:
+      for (casadi_int j=1; j<=k; ++j) c[j] = a[j] - b[j];
+      return;
+    case OP_NEG:
+      for (casadi_int j=1; j<=k; ++j) c[j] = -a[j];
+      return;
+    case OP_TWICE:
+      for (casadi_int j=1; j<=k; ++j) c[j] = 2*a[j];
+      return;
+    case OP_MUL:
+    case OP_SQ:
+      {
+        const std::vector<SXElem>& b1 = op==OP_SQ ? a : b;
+        for (casadi_int j=1; j<=k; ++j) {
+          c[j] = 0;
+          for (casadi_int i=0; i<=j; ++i) c[j] += a[i] * b1[j-i];
+        }
+      }
+      return;
+    case OP_DIV:
+      for (casadi_int j=1; j<=k; ++j) {
+        SXElem s = a[j];
+        for (casadi_int i=0; i<j; ++i) s -= c[i] * b[j-i];
+        c[j] = s / b[0];
+      }
+      return;
+    case OP_INV:
+      for (casadi_int j=1; j<=k; ++j) {
+        SXElem s = 0;
+        for (casadi_int i=0; i<j; ++i) s -= c[i] * a[j-i];
+        c[j] = s / a[0];
+      }
+      return;
+    case OP_SQRT:
+      for (casadi_int j=1; j<=k; ++j) {
+        SXElem s = a[j];
+        for (casadi_int i=1; i<j; ++i) s -= c[i] * c[j-i];
+        c[j] = s / (2*c[0]);
+      }
+      return;
+    case OP_EXP:
+      // c' = c*a'
+      for (casadi_int j=1; j<=k; ++j) {
+        SXElem s = 0;
+        for (casadi_int i=1; i<=j; ++i) s += static_cast<double>(i) * a[i] * c[j-i];
+        c[j] = s / static_cast<double>(j);
+      }
+      return;
+    case OP_LOG:
+      // c'*a = a'
+      for (casadi_int j=1; j<=k; ++j) {
+        SXElem s = static_cast<double>(j) * a[j];
+        for (casadi_int i=1; i<j; ++i) s -= static_cast<double>(j-i) * c[j-i] * a[i];
+        c[j] = s / (static_cast<double>(j) * a[0]);
+      }
+      return;
+    case OP_SIN:
+    case OP_COS:
+    case OP_SINH:
+    case OP_COSH:
+      {
+        // Propagate the function together with its derivative,
+        // s' = co*a', co' = sgn*s*a'
+        bool is_sin = op==OP_SIN || op==OP_SINH;
+        double sgn = op==OP_SIN || op==OP_COS ? -1 : 1;
+        std::vector<SXElem> s(k+1), co(k+1);
+        if (op==OP_SIN) {
+          s[0] = c[0];
+          co[0] = cos(a[0]);
+        } else if (op==OP_COS) {
+          s[0] = sin(a[0]);
+          co[0] = c[0];
+        } else if (op==OP_SINH) {
+          s[0] = c[0];
+          co[0] = cosh(a[0]);
+        } else {
+          s[0] = sinh(a[0]);
+          co[0] = c[0];
+        }
+        for (casadi_int j=1; j<=k; ++j) {
+          SXElem ss = 0, sc = 0;
+          for (casadi_int i=1; i<=j; ++i) {
+            ss += static_cast<double>(i) * a[i] * co[j-i];
+            sc += static_cast<double>(i) * a[i] * s[j-i];
+          }
+          s[j] = ss / static_cast<double>(j);
+          co[j] = sgn * sc / static_cast<double>(j);
+        }
+        for (casadi_int j=1; j<=k; ++j) c[j] = is_sin ? s[j] : co[j];
+      }
+      return;
+    case OP_TAN:
+    case OP_TANH:
+      {
+        // c' = g*a' with g = 1 + sgn*c^2
+        double sgn = op==OP_TAN ? 1 : -1;
+        std::vector<SXElem> g(k);
+        for (casadi_int j=1; j<=k; ++j) {
+          SXElem s = j==1 ? 1 : 0;
+          for (casadi_int i=0; i<j; ++i) s += sgn * c[i] * c[j-1-i];
+          g[j-1] = s;
+          s = 0;
+          for (casadi_int i=1; i<=j; ++i) s += static_cast<double>(i) * a[i] * g[j-i];
+          c[j] = s / static_cast<double>(j);
+        }
+      }
+      return;
+    case OP_ATAN:
+      {
+        // c'*h = a' with h = 1 + a^2
+        std::vector<SXElem> h(k+1);
+        for (casadi_int j=0; j<=k; ++j) {
+          h[j] = j==0 ? 1 : 0;
+          for (casadi_int i=0; i<=j; ++i) h[j] += a[i] * a[j-i];
+        }
+        for (casadi_int j=1; j<=k; ++j) {
+          SXElem s = static_cast<double>(j) * a[j];
+          for (casadi_int i=1; i<j; ++i) s -= static_cast<double>(j-i) * c[j-i] * h[i];
+          c[j] = s / (static_cast<double>(j) * h[0]);
+        }
+      }
+      return;
+    case OP_FABS:
+      for (casadi_int j=1; j<=k; ++j) c[j] = sign(a[0]) * a[j];
+      return;
+    case OP_IF_ELSE_ZERO:
+      for (casadi_int j=1; j<=k; ++j) c[j] = if_else_zero(a[0], b[j]);
+      return;
+    case OP_FMIN:
+    case OP_FMAX:
+      {
+        SXElem cond = op==OP_FMIN ? a[0] <= b[0] : a[0] >= b[0];
+        for (casadi_int j=1; j<=k; ++j) {
+          c[j] = if_else_zero(cond, a[j]) + if_else_zero(!cond, b[j]);
+        }
+      }
+      return;
+    case OP_LT:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+    case OP_NOT:
+    case OP_AND:
+    case OP_OR:
+    case OP_SIGN:
+    case OP_FLOOR:
+    case OP_CEIL:
+      // Piecewise constant
+      for (casadi_int j=1; j<=k; ++j) c[j] = 0;
+      return;
+    default:
+      break;
+    }
+
+    // Any other operation: sum of scaled partial derivatives times
+    // products of powers of the argument increments
+    bool binary = casadi_math<double>::ndeps(op)==2;
+    auto it = partials.find(op);
+    if (it==partials.end()) it = partials.insert({op, taylor_partials(op, k)}).first;
+    std::vector<SX> d = it->second(std::vector<SX>{a[0], binary ? b[0] : SXElem(0)});
+    // Powers of the increments a-a[0], b-b[0]
+    std::vector<std::vector<SXElem> > pa(k+1, std::vector<SXElem>(k+1, 0));
+    std::vector<std::vector<SXElem> > pb(binary ? k+1 : 1, std::vector<SXElem>(k+1, 0));
+    pa[0][0] = 1;
+    for (casadi_int p=1; p<=k; ++p) {
+      for (casadi_int j=p; j<=k; ++j) {
+        for (casadi_int i=1; i<=j-p+1; ++i) pa[p][j] += a[i] * pa[p-1][j-i];
+      }
+    }
+    pb[0][0] = 1;
+    for (casadi_int q=1; q<pb.size(); ++q) {
+      for (casadi_int j=q; j<=k; ++j) {
+        for (casadi_int i=1; i<=j-q+1; ++i) pb[q][j] += b[i] * pb[q-1][j-i];
+      }
+    }
+    for (casadi_int j=1; j<=k; ++j) c[j] = 0;
+    casadi_int ind = 0;
+    for (casadi_int p=0; p<=k; ++p) {
+      for (casadi_int q=0; q<=(binary ? k-p : 0); ++q) {
+        const SXElem& dpq = d.at(ind++)->at(0);
+        if (p+q==0) continue;
+        for (casadi_int j=p+q; j<=k; ++j) {
+          SXElem s = 0;
+          for (casadi_int i=p; i<=j-q; ++i) s += pa[p][i] * pb[q][j-i];
+          c[j] += dpq * s;
+        }
+      }
+    }
+  }
+
+  SX SXFunction::hess_edge_pushing() const {
+    casadi_assert(n_in_==1 && n_out_==1 && nnz_out(0)<=1,
+      "Edge pushing requires a function with one input and one scalar output");
+    casadi_int n = algorithm_.size();
+
+    // Nodes are identified by the instruction that defines them
+    std::vector<casadi_int> loc(worksize_, -1), arg0(n, -1), arg1(n, -1);
+    std::vector<SXElem> dep0(n), dep1(n), d0(n), d1(n);
+    casadi_int out = -1;
+    std::vector<SXElem>::const_iterator b_it = operations_.begin();
+    for (casadi_int k=0; k<n; ++k) {
+      const AlgEl& e = algorithm_[k];
+      switch (e.op) {
+      case OP_INPUT:
+      case OP_CONST:
+      case OP_PARAMETER:
+        break;
+      case OP_OUTPUT:
+        out = loc[e.i1];
+        continue;
+      default:
+        {
+          const SXElem& f = *b_it++;
+          SXElem d[2];
+          switch (e.op) {
+            CASADI_MATH_DER_BUILTIN(f->dep(0), f->dep(1), f, d)
+          }
+          arg0[k] = loc[e.i1];
+          if (casadi_math<double>::ndeps(e.op)==2) arg1[k] = loc[e.i2];
+          dep0[k] = f->dep(0);
+          dep1[k] = f->dep(1);
+          d0[k] = d[0];
+          d1[k] = d[1];
+        }
+      }
+      loc[e.i0] = k;
+    }
+
+    // Multiply by the partial derivative with respect to operand j of node k
+    auto scale = [&](casadi_int k, casadi_int j, const SXElem& w) -> SXElem {
+      if (algorithm_[k].op==OP_IF_ELSE_ZERO) return j==0 ? 0 : if_else_zero(d1[k], w);
+      return (j==0 ? d0[k] : d1[k]) * w;
+    };
+
+    // Adjoints and the symmetric nonlinear interactions between the nodes,
+    // with the weight of an off-diagonal pair stored in both directions
+    std::vector<SXElem> v(n, 0);
+    std::vector<std::map<casadi_int, SXElem> > W(n);
+    auto add = [&](casadi_int j, casadi_int k, const SXElem& w) {
+      if (w.is_zero()) return;
+      W[j][k] += w;
+      if (j!=k) W[k][j] += w;
+    };
+    if (out>=0) v[out] = 1;
+
+    // Second order partial derivatives of the operations
+    std::map<casadi_int, Function> partials;
+
+    // Eliminate the nodes in reverse order
+    for (casadi_int k=n-1; k>=0; --k) {
+      casadi_int op = algorithm_[k].op;
+      if (op==OP_INPUT || op==OP_OUTPUT) continue;
+      std::vector<casadi_int> p;
+      if (arg0[k]>=0) p.push_back(arg0[k]);
+      if (arg1[k]>=0) p.push_back(arg1[k]);
+      // Pushing: interactions of the node are passed on to its operands
+      std::map<casadi_int, SXElem> Wk;
+      Wk.swap(W[k]);
+      for (auto&& q : Wk) {
+        if (q.first==k) continue;
+        W[q.first].erase(k);
+        for (casadi_int j=0; j<p.size(); ++j) {
+          SXElem w = scale(k, j, q.second);
+          add(p[j], q.first, p[j]==q.first ? 2*w : w);
+        }
+      }
+      auto diag = Wk.find(k);
+      if (diag!=Wk.end()) {
+        for (casadi_int j=0; j<p.size(); ++j) {
+          for (casadi_int i=j; i<p.size(); ++i) {
+            SXElem w = scale(k, i, scale(k, j, diag->second));
+            add(p[j], p[i], i!=j && p[i]==p[j] ? 2*w : w);
+          }
+        }
+      }
+      if (v[k].is_zero() || p.empty()) continue;
+      // Creating: second order partial derivatives of the operation, weighted by the adjoint
+      switch (op) {
+      case OP_ASSIGN:
+      case OP_ADD:
+      case OP_SUB:
+      case OP_NEG:
+      case OP_TWICE:
+      case OP_IF_ELSE_ZERO:
+        break;
+      case OP_MUL:
+        add(p[0], p[1], p[0]==p[1] ? 2*v[k] : v[k]);
+        break;
+      case OP_SQ:
+        add(p[0], p[0], 2*v[k]);
+        break;
+      default:
+        {
+          auto it = partials.find(op);
+          if (it==partials.end()) it = partials.insert({op, taylor_partials(op, 2)}).first;
+          std::vector<SX> h = it->second(std::vector<SX>{dep0[k], dep1[k]});
+          if (p.size()==1) {
+            add(p[0], p[0], 2*v[k]*h.at(2).scalar());
+          } else {
+            add(p[0], p[0], 2*v[k]*h.at(5).scalar());
+            add(p[1], p[1], 2*v[k]*h.at(2).scalar());
+            SXElem w = v[k]*h.at(4).scalar();
+            add(p[0], p[1], p[0]==p[1] ? 2*w : w);
+          }
+        }
+      }
+      // Adjoint
+      for (casadi_int j=0; j<p.size(); ++j) v[p[j]] += scale(k, j, v[k]);
+    }
+
+    // Remaining interactions are between the inputs
+    std::vector<casadi_int> ind = sparsity_in_[0].find();
+    std::vector<casadi_int> nz(n, -1), row, col;
+    for (casadi_int k=0; k<n; ++k) {
+      if (algorithm_[k].op==OP_INPUT) nz[k] = algorithm_[k].i2;
+    }
+    std::vector<SXElem> val;
+    for (casadi_int k=0; k<n; ++k) {
+      if (nz[k]<0) continue;
+      for (auto&& q : W[k]) {
+        row.push_back(ind[nz[k]]);
+        col.push_back(ind[nz[q.first]]);
+        val.push_back(q.second);
+      }
+    }
+    casadi_int sz = sparsity_in_[0].numel();
+    return SX::triplet(row, col, SX(val), sz, sz);
+  }
+
+  // Options of a derivative that also apply to a tape derivative
+  static Dict tape_options(const Dict& opts) {
+    Dict ret;
+    for (auto&& op : opts) {
+      if (op.first!="jit" && FunctionInternal::options_.find(op.first)) ret.insert(op);
+    }
+    return ret;
+  }
+
+  Function SXFunction::get_forward(casadi_int nfwd, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    if (!numeric_ad_ || !free_vars_.empty()) {
+      return XFunction<SXFunction, SX, SXNode>::get_forward(nfwd, name, inames, onames, opts);
     }
+    return Function::create(new SXTapeDerivative(name, self(), true, nfwd), tape_options(opts));
+  }
 
-    // Make sure matching sparsity of fseed
-    bool matching_sparsity = true;
-    for (casadi_int d=0; d<nadj; ++d) {
-      casadi_assert_dev(aseed[d].size()==n_out_);
-      for (casadi_int i=0; matching_sparsity && i<n_out_; ++i)
-        matching_sparsity = aseed[d][i].sparsity()==sparsity_out_[i];
+  Function SXFunction::get_reverse(casadi_int nadj, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    if (!numeric_ad_ || !free_vars_.empty()) {
+      return XFunction<SXFunction, SX, SXNode>::get_reverse(nadj, name, inames, onames, opts);
     }
+    return Function::create(new SXTapeDerivative(name, self(), false, nadj), tape_options(opts));
+  }
 
-    // Correct sparsity if needed
-    if (!matching_sparsity) {
-      std::vector<std::vector<SX> > aseed2(aseed);
-      for (casadi_int d=0; d<nadj; ++d)
-        for (casadi_int i=0; i<n_out_; ++i)
-          if (aseed2[d][i].sparsity()!=sparsity_out_[i])
-            aseed2[d][i] = project(aseed2[d][i], sparsity_out_[i]);
-      return ad_reverse(aseed2, asens);
+  void SXFunction::eval_tape(const double** arg, double* w, double* tape) const {
+    double x, y;
+    for (auto&& e : algorithm_) {
+      switch (e.op) {
+      case OP_CONST: w[e.i0] = e.d; break;
+      case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+      case OP_OUTPUT: break;
+      default:
+        // Operands are copied, the result may overwrite them
+        x = w[e.i1];
+        y = w[e.i2];
+        casadi_math<double>::derF(e.op, x, y, w[e.i0], tape);
+      }
+      tape += 2;
     }
+  }
 
-    // Allocate results if needed
-    for (casadi_int d=0; d<nadj; ++d) {
-      asens[d].resize(n_in_);
-      for (casadi_int i=0; i<asens[d].size(); ++i) {
-        if (asens[d][i].sparsity()!=sparsity_in_[i]) {
-          asens[d][i] = SX::zeros(sparsity_in_[i]);
-        } else {
-          std::fill(asens[d][i]->begin(), asens[d][i]->end(), 0);
+  void SXFunction::fwd_tape(const double** fseed, double** fsens, const double* tape,
+      double* dw, casadi_int nder) const {
+    casadi_int d, nz;
+    double *r;
+    const double *a, *b, *s;
+    for (casadi_int i=0; i<n_out_; ++i) {
+      if (fsens[i]) casadi_clear(fsens[i], nnz_out(i)*nder);
+    }
+    for (auto&& e : algorithm_) {
+      switch (e.op) {
+      case OP_INPUT:
+        r = dw + e.i0*nder;
+        s = fseed[e.i1];
+        nz = nnz_in(e.i1);
+        for (d=0; d<nder; ++d) r[d] = s ? s[e.i2 + d*nz] : 0;
+        break;
+      case OP_OUTPUT:
+        if (fsens[e.i0]) {
+          a = dw + e.i1*nder;
+          nz = nnz_out(e.i0);
+          for (d=0; d<nder; ++d) fsens[e.i0][e.i2 + d*nz] = a[d];
         }
+        break;
+      case OP_CONST:
+      case OP_PARAMETER:
+        casadi_clear(dw + e.i0*nder, nder);
+        break;
+      case OP_IF_ELSE_ZERO:
+        r = dw + e.i0*nder;
+        b = dw + e.i2*nder;
+        for (d=0; d<nder; ++d) r[d] = tape[1]==0 ? 0 : b[d];
+        break;
+      CASADI_MATH_BINARY_BUILTIN // Binary operation
+        r = dw + e.i0*nder;
+        a = dw + e.i1*nder;
+        b = dw + e.i2*nder;
+        for (d=0; d<nder; ++d) r[d] = tape[0]*a[d] + tape[1]*b[d];
+        break;
+      default: // Unary operation
+        r = dw + e.i0*nder;
+        a = dw + e.i1*nder;
+        for (d=0; d<nder; ++d) r[d] = tape[0]*a[d];
       }
+      tape += 2;
     }
+  }
 
-    // Iterator to the binary operations
-    std::vector<SXElem>::const_iterator b_it=operations_.begin();
-
-    // Tape
-    std::vector<TapeEl<SXElem> > s_pdwork(operations_.size());
-    std::vector<TapeEl<SXElem> >::iterator it1 = s_pdwork.begin();
-
-    // Evaluate algorithm
-    if (verbose_) casadi_message("Evaluating algorithm forward");
-    for (auto&& a : algorithm_) {
-      switch (a.op) {
+  void SXFunction::adj_tape(const double** aseed, double** asens, const double* tape,
+      double* dw, casadi_int nder) const {
+    casadi_int d, nz;
+    double seed, *r, *a, *b;
+    casadi_clear(dw, worksize_*nder);
+    for (casadi_int i=0; i<n_in_; ++i) {
+      if (asens[i]) casadi_clear(asens[i], nnz_in(i)*nder);
+    }
+    tape += 2*algorithm_.size();
+    for (auto it = algorithm_.rbegin(); it!=algorithm_.rend(); ++it) {
+      tape -= 2;
+      switch (it->op) {
       case OP_INPUT:
+        r = dw + it->i0*nder;
+        if (asens[it->i1]) {
+          nz = nnz_in(it->i1);
+          for (d=0; d<nder; ++d) asens[it->i1][it->i2 + d*nz] += r[d];
+        }
+        casadi_clear(r, nder);
+        break;
       case OP_OUTPUT:
+        if (aseed[it->i0]) {
+          a = dw + it->i1*nder;
+          nz = nnz_out(it->i0);
+          for (d=0; d<nder; ++d) a[d] += aseed[it->i0][it->i2 + d*nz];
+        }
+        break;
       case OP_CONST:
       case OP_PARAMETER:
+        casadi_clear(dw + it->i0*nder, nder);
         break;
-      default:
-        {
-          const SXElem& f=*b_it++;
-          switch (a.op) {
-            CASADI_MATH_DER_BUILTIN(f->dep(0), f->dep(1), f, it1++->d)
-          }
+      case OP_IF_ELSE_ZERO:
+        r = dw + it->i0*nder;
+        b = dw + it->i2*nder;
+        for (d=0; d<nder; ++d) {
+          seed = r[d];
+          r[d] = 0;
+          if (tape[1]!=0) b[d] += seed;
+        }
+        break;
+      CASADI_MATH_BINARY_BUILTIN // Binary operation
+        r = dw + it->i0*nder;
+        a = dw + it->i1*nder;
+        b = dw + it->i2*nder;
+        for (d=0; d<nder; ++d) {
+          seed = r[d];
+          r[d] = 0;
+          a[d] += tape[0]*seed;
+          b[d] += tape[1]*seed;
+        }
+        break;
+      default: // Unary operation
+        r = dw + it->i0*nder;
+        a = dw + it->i1*nder;
+        for (d=0; d<nder; ++d) {
+          seed = r[d];
+          r[d] = 0;
+          a[d] += tape[0]*seed;
         }
       }
     }
+  }
 
-    // Calculate adjoint sensitivities
-    if (verbose_) casadi_message("Calculating adjoint derivatives");
+  Function SXFunction::get_taylor(casadi_int order, const std::string& name,
+                                  const std::vector<std::string>& inames,
+                                  const std::vector<std::string>& onames,
+                                  const Dict& opts) const {
+    // Directions
+    std::vector<SX> ret_in(in_);
+    for (casadi_int i=0; i<n_in_; ++i) {
+      ret_in.push_back(SX::sym(inames.at(n_in_+i), sparsity_in_[i]));
+    }
 
-    // Work vector
-    std::vector<SXElem> w(worksize_, 0);
+    // Coefficients of each output
+    std::vector<SX> ret_out(out_);
+    for (casadi_int d=1; d<=order; ++d) {
+      for (casadi_int i=0; i<n_out_; ++i) ret_out.push_back(SX::zeros(sparsity_out_[i]));
+    }
 
-    for (casadi_int dir=0; dir<nadj; ++dir) {
-      auto it2 = s_pdwork.rbegin();
-      for (auto it = algorithm_.rbegin(); it!=algorithm_.rend(); ++it) {
-        SXElem seed;
-        switch (it->op) {
-        case OP_INPUT:
-          asens[dir][it->i1].nonzeros()[it->i2] = w[it->i0];
-          w[it->i0] = 0;
-          break;
-        case OP_OUTPUT:
-          w[it->i1] += aseed[dir][it->i0].nonzeros()[it->i2];
-          break;
-        case OP_CONST:
-        case OP_PARAMETER:
-          w[it->i0] = 0;
-          break;
-        case OP_IF_ELSE_ZERO:
-          seed = w[it->i0];
-          w[it->i0] = 0;
-          w[it->i2] += if_else_zero(it2++->d[1], seed);
-          break;
-        CASADI_MATH_BINARY_BUILTIN // Binary operation
-          seed = w[it->i0];
-          w[it->i0] = 0;
-          w[it->i1] += it2->d[0] * seed;
-          w[it->i2] += it2++->d[1] * seed;
-          break;
-        default: // Unary operation
-          seed = w[it->i0];
-          w[it->i0] = 0;
-          w[it->i1] += it2++->d[0] * seed;
+    // Taylor polynomial of each work vector element
+    std::vector<std::vector<SXElem> > w(worksize_, std::vector<SXElem>(order+1));
+
+    // Iterators to the operations and free variables
+    std::vector<SXElem>::const_iterator b_it = operations_.begin();
+    std::vector<SXElem>::const_iterator p_it = free_vars_.begin();
+
+    // Partial derivatives of operations without a dedicated recurrence
+    std::map<casadi_int, Function> partials;
+
+    // Propagate
+    std::vector<SXElem> a, b, c(order+1);
+    for (auto&& e : algorithm_) {
+      switch (e.op) {
+      case OP_INPUT:
+        std::fill(c.begin(), c.end(), 0);
+        c[0] = in_[e.i1]->at(e.i2);
+        c[1] = ret_in[n_in_+e.i1]->at(e.i2);
+        w[e.i0] = c;
+        break;
+      case OP_OUTPUT:
+        for (casadi_int d=1; d<=order; ++d) {
+          ret_out[d*n_out_ + e.i0]->at(e.i2) = w[e.i1][d];
+        }
+        break;
+      case OP_CONST:
+        std::fill(c.begin(), c.end(), 0);
+        c[0] = e.d;
+        w[e.i0] = c;
+        break;
+      case OP_PARAMETER:
+        std::fill(c.begin(), c.end(), 0);
+        c[0] = *p_it++;
+        w[e.i0] = c;
+        break;
+      default:
+        // Copy arguments, the result may overwrite them
+        a = w[e.i1];
+        if (casadi_math<double>::ndeps(e.op)==2) {
+          b = w[e.i2];
+        } else {
+          b.clear();
         }
+        c[0] = *b_it++;
+        taylor_op(e.op, a, b, c, partials);
+        w[e.i0] = c;
       }
     }
+
+    Dict options = opts;
+    options["allow_duplicate_io_names"] = true;
+    return Function(name, ret_in, ret_out, inames, onames, options);
   }
 
   int SXFunction::
@@ -975,60 +3079,452 @@ namespace casadi {
 
   SXFunction::SXFunction(DeserializingStream& s) :
     XFunction<SXFunction, SX, SXNode>(s) {
-    s.version("SXFunction", 1);
+    int version = s.version("SXFunction", 1, 6);
     size_t n_instructions;
     s.unpack("SXFunction::n_instr", n_instructions);
 
     s.unpack("SXFunction::worksize", worksize_);
     s.unpack("SXFunction::free_vars", free_vars_);
-    s.unpack("SXFunction::operations", operations_);
-    s.unpack("SXFunction::constants", constants_);
+    if (version<3) {
+      s.unpack("SXFunction::operations", operations_);
+      s.unpack("SXFunction::constants", constants_);
+    }
     s.unpack("SXFunction::default_in", default_in_);
 
     algorithm_.resize(n_instructions);
-    for (casadi_int k=0;k<n_instructions;++k) {
-      AlgEl& e = algorithm_[k];
-      s.unpack("SXFunction::ScalarAtomic::op", e.op);
-      s.unpack("SXFunction::ScalarAtomic::i0", e.i0);
-      s.unpack("SXFunction::ScalarAtomic::i1", e.i1);
-      s.unpack("SXFunction::ScalarAtomic::i2", e.i2);
+    if (version>=5) {
+      // Instruction tape and constant pool
+      bool narrow;
+      std::vector<int> tape;
+      std::vector<double> pool;
+      s.unpack("SXFunction::narrow", narrow);
+      s.unpack("SXFunction::algorithm", tape);
+      s.unpack("SXFunction::constants", pool);
+      std::vector<int> fields;
+      if (narrow) {
+        fields.reserve(2*tape.size());
+        for (int t : tape) {
+          uint32_t u = static_cast<uint32_t>(t);
+          fields.push_back(static_cast<int>(u & 0xFFFF));
+          fields.push_back(static_cast<int>(u >> 16));
+        }
+      } else {
+        fields.swap(tape);
+      }
+      casadi_assert_dev(fields.size()==4*n_instructions);
+      for (casadi_int k=0;k<n_instructions;++k) {
+        AlgEl& e = algorithm_[k];
+        e.op = fields[4*k];
+        e.i0 = fields[4*k+1];
+        if (e.op==OP_CONST) {
+          e.d = pool.at(fields[4*k+2]);
+        } else {
+          e.i1 = fields[4*k+2];
+          e.i2 = fields[4*k+3];
+        }
+      }
+    } else if (version>=3) {
+      // Flat instruction tape
+      std::vector<casadi_int> tape;
+      s.unpack("SXFunction::algorithm", tape);
+      casadi_assert_dev(tape.size()==4*n_instructions);
+      for (casadi_int k=0;k<n_instructions;++k) {
+        AlgEl& e = algorithm_[k];
+        e.op = tape[4*k];
+        e.i0 = tape[4*k+1];
+        e.i1 = tape[4*k+2];
+        e.i2 = tape[4*k+3];
+      }
+    } else {
+      for (casadi_int k=0;k<n_instructions;++k) {
+        AlgEl& e = algorithm_[k];
+        s.unpack("SXFunction::ScalarAtomic::op", e.op);
+        s.unpack("SXFunction::ScalarAtomic::i0", e.i0);
+        s.unpack("SXFunction::ScalarAtomic::i1", e.i1);
+        s.unpack("SXFunction::ScalarAtomic::i2", e.i2);
+      }
     }
 
     // Default (persistent) options
     just_in_time_opencl_ = false;
     just_in_time_sparsity_ = false;
+    bytecode_ = false;
+    vm_worksize_ = 0;
+    short_circuit_ = false;
+    numeric_ad_ = false;
 
     s.unpack("SXFunction::live_variables", live_variables_);
+    if (version>=2) s.unpack("SXFunction::bytecode", bytecode_);
+    if (version>=4) {
+      s.unpack("SXFunction::short_circuit", short_circuit_);
+      std::vector<casadi_int> branches;
+      s.unpack("SXFunction::branches", branches);
+      for (casadi_int k=0; k<branches.size(); k+=3) {
+        branches_.push_back({branches[k], branches[k+1], branches[k+2]});
+      }
+    }
 
-    XFunction<SXFunction, SX, SXNode>::delayed_deserialize_members(s);
+    if (version>=6) s.unpack("SXFunction::numeric_ad", numeric_ad_);
+
+    // Bytecode is not serialized, but regenerated from the algorithm
+    if (bytecode_ && free_vars_.empty()) vm_compile();
+    init_out_mask();
+
+    if (version>=3) {
+      // Expression graph is not serialized, but regenerated from the algorithm
+      rebuild_graph();
+    } else {
+      XFunction<SXFunction, SX, SXNode>::delayed_deserialize_members(s);
+    }
+  }
+
+  void SXFunction::rebuild_graph() {
+    // Values of the work vector
+    std::vector<SXElem> w(worksize_);
+
+    // Outputs
+    out_.resize(n_out_);
+    for (casadi_int i=0; i<n_out_; ++i) out_[i] = SX(sparsity_out_.at(i));
+
+    // Iterator to free variables
+    std::vector<SXElem>::const_iterator p_it = free_vars_.begin();
+
+    constants_.clear();
+    operations_.clear();
+    operations_.reserve(algorithm_.size());
+    for (auto&& a : algorithm_) {
+      switch (a.op) {
+      case OP_INPUT:
+        w[a.i0] = in_.at(a.i1)->at(a.i2);
+        break;
+      case OP_OUTPUT:
+        out_.at(a.i0)->at(a.i2) = w[a.i1];
+        break;
+      case OP_CONST:
+        w[a.i0] = a.d;
+        constants_.push_back(w[a.i0]);
+        break;
+      case OP_PARAMETER:
+        w[a.i0] = *p_it++;
+        break;
+      default:
+        // Create the node directly, bypassing simplifications
+        if (casadi_math<double>::ndeps(a.op)==2) {
+          w[a.i0] = BinarySX::create(a.op, w[a.i1], w[a.i2]);
+        } else {
+          w[a.i0] = UnarySX::create(a.op, w[a.i1]);
+        }
+        operations_.push_back(w[a.i0]);
+      }
+    }
+    casadi_assert_dev(p_it==free_vars_.end());
   }
 
   void SXFunction::serialize_body(SerializingStream &s) const {
     XFunction<SXFunction, SX, SXNode>::serialize_body(s);
-    s.version("SXFunction", 1);
+    s.version("SXFunction", 6);
     s.pack("SXFunction::n_instr", algorithm_.size());
 
     s.pack("SXFunction::worksize", worksize_);
     s.pack("SXFunction::free_vars", free_vars_);
-    s.pack("SXFunction::operations", operations_);
-    s.pack("SXFunction::constants", constants_);
     s.pack("SXFunction::default_in", default_in_);
 
-    // Loop over algorithm
+    // Flat instruction tape, the expression graph is regenerated from it.
+    // Constants are moved to a separate pool, referenced by index
+    std::vector<double> pool;
+    std::vector<int> fields;
+    fields.reserve(4*algorithm_.size());
     for (const auto& e : algorithm_) {
-      s.pack("SXFunction::ScalarAtomic::op", e.op);
-      s.pack("SXFunction::ScalarAtomic::i0", e.i0);
-      s.pack("SXFunction::ScalarAtomic::i1", e.i1);
-      s.pack("SXFunction::ScalarAtomic::i2", e.i2);
+      fields.push_back(e.op);
+      fields.push_back(e.i0);
+      if (e.op==OP_CONST) {
+        fields.push_back(static_cast<int>(pool.size()));
+        fields.push_back(0);
+        pool.push_back(e.d);
+      } else {
+        fields.push_back(e.i1);
+        fields.push_back(e.i2);
+      }
+    }
+    // Two fields per entry if all fit in 16 bits
+    bool narrow = true;
+    for (int f : fields) {
+      if (f<0 || f>std::numeric_limits<uint16_t>::max()) {
+        narrow = false;
+        break;
+      }
+    }
+    std::vector<int> tape;
+    if (narrow) {
+      tape.reserve(fields.size()/2);
+      for (casadi_int k=0; k<fields.size(); k+=2) {
+        tape.push_back(static_cast<int>(static_cast<uint32_t>(fields[k])
+          | (static_cast<uint32_t>(fields[k+1]) << 16)));
+      }
+    } else {
+      tape.swap(fields);
     }
+    s.pack("SXFunction::narrow", narrow);
+    s.pack("SXFunction::algorithm", tape);
+    s.pack("SXFunction::constants", pool);
 
     s.pack("SXFunction::live_variables", live_variables_);
-
-    XFunction<SXFunction, SX, SXNode>::delayed_serialize_members(s);
+    s.pack("SXFunction::bytecode", bytecode_);
+
+    s.pack("SXFunction::short_circuit", short_circuit_);
+    std::vector<casadi_int> branches;
+    for (const auto& b : branches_) {
+      branches.push_back(b.begin);
+      branches.push_back(b.end);
+      branches.push_back(b.cond);
+    }
+    s.pack("SXFunction::branches", branches);
+    s.pack("SXFunction::numeric_ad", numeric_ad_);
   }
 
   ProtoFunction* SXFunction::deserialize(DeserializingStream& s) {
     return new SXFunction(s);
   }
 
+  SXTapeDerivative::SXTapeDerivative(const std::string& name, const Function& f,
+                                     bool fwd, casadi_int nder)
+    : FunctionInternal(name), f_(f), fwd_(fwd), nder_(nder) {
+  }
+
+  SXTapeDerivative::~SXTapeDerivative() {
+    clear_mem();
+  }
+
+  size_t SXTapeDerivative::get_n_in() {
+    return f_.n_in() + f_.n_out() + (fwd_ ? f_.n_in() : f_.n_out());
+  }
+
+  size_t SXTapeDerivative::get_n_out() {
+    return fwd_ ? f_.n_out() : f_.n_in();
+  }
+
+  Sparsity SXTapeDerivative::get_sparsity_in(casadi_int i) {
+    casadi_int n_in = f_.n_in(), n_out = f_.n_out();
+    if (i<n_in) return f_.sparsity_in(i);
+    if (i<n_in+n_out) return f_.sparsity_out(i-n_in);
+    i -= n_in + n_out;
+    return repmat(fwd_ ? f_.sparsity_in(i) : f_.sparsity_out(i), 1, nder_);
+  }
+
+  Sparsity SXTapeDerivative::get_sparsity_out(casadi_int i) {
+    return repmat(fwd_ ? f_.sparsity_out(i) : f_.sparsity_in(i), 1, nder_);
+  }
+
+  void SXTapeDerivative::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    casadi_assert(f_.is_a("SXFunction"), "Tape derivatives require an SXFunction");
+    casadi_assert(!f_.has_free(), "Cannot evaluate derivatives of '" + f_.name()
+      + "' numerically since variables " + str(f_.get_free()) + " are free.");
+
+    // Values, partial derivatives of each instruction and derivative directions
+    alloc_w(sx()->worksize_*(1+nder_) + 2*sx()->algorithm_.size(), true);
+  }
+
+  const Function& SXTapeDerivative::derivative() const {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+    if (der_.is_null()) {
+      if (verbose_) casadi_message("Generating symbolic derivative '" + name_ + "'");
+      const XFunction<SXFunction, SX, SXNode>* f = sx();
+      if (fwd_) {
+        der_ = f->XFunction<SXFunction, SX, SXNode>::get_forward(nder_, name_,
+          name_in_, name_out_, Dict());
+      } else {
+        der_ = f->XFunction<SXFunction, SX, SXNode>::get_reverse(nder_, name_,
+          name_in_, name_out_, Dict());
+      }
+    }
+    return der_;
+  }
+
+  int SXTapeDerivative::eval(const double** arg, double** res,
+      casadi_int* iw, double* w, void* mem) const {
+    const SXFunction* f = sx();
+    const double** seed = arg + f->n_in_ + f->n_out_;
+    // Evaluate f, recording the partial derivatives
+    double* fw = w;
+    w += f->worksize_;
+    double* tape = w;
+    w += 2*f->algorithm_.size();
+    f->eval_tape(arg, fw, tape);
+    // Propagate all directions through the tape
+    if (fwd_) {
+      f->fwd_tape(seed, res, tape, w, nder_);
+    } else {
+      f->adj_tape(seed, res, tape, w, nder_);
+    }
+    return 0;
+  }
+
+  int SXTapeDerivative::eval_sx(const SXElem** arg, SXElem** res,
+      casadi_int* iw, SXElem* w, void* mem) const {
+    const Function& der = derivative();
+    std::vector<const SXElem*> arg1(der.sz_arg());
+    std::vector<SXElem*> res1(der.sz_res());
+    std::vector<casadi_int> iw1(der.sz_iw());
+    std::vector<SXElem> w1(der.sz_w());
+    std::copy_n(arg, n_in_, arg1.begin());
+    std::copy_n(res, n_out_, res1.begin());
+    return der(get_ptr(arg1), get_ptr(res1), get_ptr(iw1), get_ptr(w1), 0);
+  }
+
+  void SXTapeDerivative::sp_f(bvec_t** x, bvec_t** y, bool fwd) const {
+    std::vector<bvec_t*> arg1(f_.sz_arg());
+    std::vector<bvec_t*> res1(f_.sz_res());
+    std::vector<casadi_int> iw1(f_.sz_iw());
+    std::vector<bvec_t> w1(f_.sz_w());
+    std::copy_n(x, f_.n_in(), arg1.begin());
+    std::copy_n(y, f_.n_out(), res1.begin());
+    if (fwd) {
+      std::vector<const bvec_t*> carg1(arg1.begin(), arg1.end());
+      f_(get_ptr(carg1), get_ptr(res1), get_ptr(iw1), get_ptr(w1), 0);
+    } else {
+      f_.rev(get_ptr(arg1), get_ptr(res1), get_ptr(iw1), get_ptr(w1), 0);
+    }
+  }
+
+  int SXTapeDerivative::sp_forward(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem) const {
+    casadi_int n_in = f_.n_in(), n_out = f_.n_out(), i, k, nz;
+    const bvec_t** seed = arg + n_in + n_out;
+    // Dependencies of a single direction, shaped as the inputs and outputs of f
+    std::vector<bvec_t> xb(f_.nnz_in()), yb(f_.nnz_out()), zb;
+    std::vector<bvec_t*> x(n_in), y(n_out);
+    for (i=0, k=0; i<n_in; k+=f_.nnz_in(i++)) x[i] = get_ptr(xb) + k;
+    for (i=0, k=0; i<n_out; k+=f_.nnz_out(i++)) y[i] = get_ptr(yb) + k;
+    // Adjoint directions: the outputs of f depending on the nonzeros of the inputs
+    if (!fwd_) {
+      for (i=0; i<n_in; ++i) {
+        nz = f_.nnz_in(i);
+        for (k=0; k<nz; ++k) x[i][k] = arg[i] ? arg[i][k] : 0;
+      }
+      sp_f(get_ptr(x), get_ptr(y), true);
+      zb = yb;
+    }
+    for (casadi_int d=0; d<nder_; ++d) {
+      if (fwd_) {
+        // Sensitivities depend on the seeds and on the nonzeros of the same inputs
+        for (i=0; i<n_in; ++i) {
+          nz = f_.nnz_in(i);
+          for (k=0; k<nz; ++k) {
+            x[i][k] = (arg[i] ? arg[i][k] : 0) | (seed[i] ? seed[i][k + d*nz] : 0);
+          }
+        }
+        sp_f(get_ptr(x), get_ptr(y), true);
+        for (i=0; i<n_out; ++i) {
+          if (res[i]) std::copy_n(y[i], f_.nnz_out(i), res[i] + d*f_.nnz_out(i));
+        }
+      } else {
+        // Transposed Jacobian times the seeds, and the nonlinear dependencies
+        const bvec_t* z = get_ptr(zb);
+        for (i=0; i<n_out; ++i) {
+          nz = f_.nnz_out(i);
+          for (k=0; k<nz; ++k) y[i][k] = *z++ | (seed[i] ? seed[i][k + d*nz] : 0);
+        }
+        std::fill(xb.begin(), xb.end(), 0);
+        sp_f(get_ptr(x), get_ptr(y), false);
+        for (i=0; i<n_in; ++i) {
+          if (res[i]) std::copy_n(x[i], f_.nnz_in(i), res[i] + d*f_.nnz_in(i));
+        }
+      }
+    }
+    return 0;
+  }
+
+  int SXTapeDerivative::sp_reverse(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem) const {
+    casadi_int n_in = f_.n_in(), n_out = f_.n_out(), i, k, nz;
+    bvec_t** seed = arg + n_in + n_out;
+    std::vector<bvec_t> xb(f_.nnz_in()), yb(f_.nnz_out());
+    std::vector<bvec_t*> x(n_in), y(n_out);
+    for (i=0, k=0; i<n_in; k+=f_.nnz_in(i++)) x[i] = get_ptr(xb) + k;
+    for (i=0, k=0; i<n_out; k+=f_.nnz_out(i++)) y[i] = get_ptr(yb) + k;
+    for (casadi_int d=0; d<nder_; ++d) {
+      if (fwd_) {
+        for (i=0; i<n_out; ++i) {
+          nz = f_.nnz_out(i);
+          for (k=0; k<nz; ++k) y[i][k] = res[i] ? res[i][k + d*nz] : 0;
+          if (res[i]) std::fill_n(res[i] + d*nz, nz, 0);
+        }
+        std::fill(xb.begin(), xb.end(), 0);
+        sp_f(get_ptr(x), get_ptr(y), false);
+        for (i=0; i<n_in; ++i) {
+          nz = f_.nnz_in(i);
+          for (k=0; k<nz; ++k) {
+            if (arg[i]) arg[i][k] |= x[i][k];
+            if (seed[i]) seed[i][k + d*nz] |= x[i][k];
+          }
+        }
+      } else {
+        for (i=0; i<n_in; ++i) {
+          nz = f_.nnz_in(i);
+          for (k=0; k<nz; ++k) x[i][k] = res[i] ? res[i][k + d*nz] : 0;
+          if (res[i]) std::fill_n(res[i] + d*nz, nz, 0);
+        }
+        sp_f(get_ptr(x), get_ptr(y), true);
+        for (i=0; i<n_out; ++i) {
+          nz = f_.nnz_out(i);
+          if (seed[i]) {
+            for (k=0; k<nz; ++k) seed[i][k + d*nz] |= y[i][k];
+          }
+        }
+        std::fill(xb.begin(), xb.end(), 0);
+        sp_f(get_ptr(x), get_ptr(y), false);
+        for (i=0; i<n_in; ++i) {
+          if (arg[i]) {
+            nz = f_.nnz_in(i);
+            for (k=0; k<nz; ++k) arg[i][k] |= x[i][k];
+          }
+        }
+      }
+    }
+    return 0;
+  }
+
+  Function SXTapeDerivative::get_forward(casadi_int nfwd, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    Function df = derivative().forward(nfwd);
+    std::vector<MX> arg = df.mx_in();
+    return Function(name, arg, df(arg), inames, onames, opts);
+  }
+
+  Function SXTapeDerivative::get_reverse(casadi_int nadj, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    Function df = derivative().reverse(nadj);
+    std::vector<MX> arg = df.mx_in();
+    return Function(name, arg, df(arg), inames, onames, opts);
+  }
+
+  void SXTapeDerivative::find(std::map<FunctionInternal*, Function>& all_fun,
+      casadi_int max_depth) const {
+    add_embedded(all_fun, f_, max_depth);
+  }
+
+  void SXTapeDerivative::serialize_body(SerializingStream &s) const {
+    FunctionInternal::serialize_body(s);
+    s.version("SXTapeDerivative", 1);
+    s.pack("SXTapeDerivative::f", f_);
+    s.pack("SXTapeDerivative::fwd", fwd_);
+    s.pack("SXTapeDerivative::nder", nder_);
+  }
+
+  SXTapeDerivative::SXTapeDerivative(DeserializingStream& s) : FunctionInternal(s) {
+    s.version("SXTapeDerivative", 1);
+    s.unpack("SXTapeDerivative::f", f_);
+    s.unpack("SXTapeDerivative::fwd", fwd_);
+    s.unpack("SXTapeDerivative::nder", nder_);
+  }
+
 } // namespace casadi
@@ -43,6 +43,28 @@ namespace casadi {
     };
   };
 
+  /** \brief  An instruction of the SXFunction bytecode interpreter
+
+      Operands i1, i2, i3 are work vector locations or, depending on the opcode,
+      input/output indices, nonzero indices or indices into the constant pool.
+  */
+  struct VmInstruction {
+    int op;     /// Opcode
+    int i0, i1, i2, i3;
+  };
+
+  /** \brief  Compact 8-byte encoding of VmInstruction
+
+      Used when all operands fit in 16 bits. Instructions with an operand i3 are
+      followed by an extension word holding i3 in its op field.
+  */
+  struct VmInstruction16 {
+    uint16_t op, i0, i1, i2;
+  };
+
+  /** \brief  Evaluate an elementary operation, called from just-in-time compiled LLVM IR */
+  extern "C" CASADI_EXPORT double casadi_sx_math(int op, double x, double y);
+
 /** \brief  Internal node class for SXFunction
 
     Do not use any internal class directly - always use the public Function
@@ -72,6 +94,66 @@ class CASADI_EXPORT SXFunction :
       \identifier{ue} */
   int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+  /** \brief  Lower the algorithm to bytecode
+
+      Constant operands are embedded as immediates, multiplications followed by a
+      single addition or subtraction are fused, dead instructions are removed and
+      the work vector is reallocated based on the live ranges of the values.
+  */
+  void vm_compile();
+
+  /** \brief  Evaluate numerically using the bytecode interpreter */
+  int vm_eval(const double** arg, double** res, double* w) const;
+
+  /** \brief  Evaluate numerically, timing each instruction with the Profiler */
+  int eval_profiled(const double** arg, double** res, double* w,
+                    bvec_t req, bool partial) const;
+
+  /** \brief  Evaluate numerically, skipping the branches whose condition is zero */
+  int eval_branches(const double** arg, double** res, double* w,
+                    bvec_t req, bool partial) const;
+
+  /** \brief Make the branches of if_else_zero contiguous
+
+      The instructions that are only used by the value operand of an
+      if_else_zero node are moved right before it, keeping their relative
+      order, and recorded in branches_ with the condition node.
+      Expects the temp fields to hold the position in nodes, and updates them.
+  */
+  void sort_branches(std::vector<SXNode*>& nodes);
+
+  /** \brief Reorder the instructions to reduce the number of live variables
+
+      Keeps the order of the outputs, but evaluates the operand needing more
+      work vector entries first (Sethi-Ullman numbering, treating the graph as a tree).
+      Expects the temp fields to hold the position in nodes, and updates them.
+  */
+  void sort_sethi_ullman(std::vector<SXNode*>& nodes);
+
+  /** \brief Determine which outputs depend on each instruction
+
+      Output i is represented by bit i modulo bvec_size, so the masks are
+      conservative when there are more outputs than bits.
+  */
+  void init_out_mask();
+
+  /** \brief Reconstruct the expression graph from the algorithm
+
+      Recreates out_, operations_ and constants_ from in_, free_vars_ and the
+      instruction tape in a single forward pass, without simplifications.
+  */
+  void rebuild_graph();
+
+  /** \brief  Evaluate numerically for a batch of n instances
+
+      Inputs and outputs of the instances are stored consecutively, as for Map.
+      Each instruction is executed for all instances before moving on to the next,
+      which allows the compiler to vectorize the inner loops.
+      The work vector must have length n*sz_w().
+  */
+  int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                 casadi_int n) const;
+
   /** \brief  evaluate symbolically while also propagating directional derivatives
 
       \identifier{uf} */
@@ -95,11 +177,54 @@ class CASADI_EXPORT SXFunction :
   void ad_reverse(const std::vector<std::vector<SX> >& aseed,
                             std::vector<std::vector<SX> >& asens) const;
 
+  ///@{
+  /** \brief Directional derivatives, evaluated on the tape with numeric_ad */
+  Function get_forward(casadi_int nfwd, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+  Function get_reverse(casadi_int nadj, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+  ///@}
+
+  /** \brief With numeric_ad, the Jacobian is assembled from directional derivatives */
+  bool has_jacobian() const override { return !numeric_ad_;}
+
+  /** \brief Evaluate the algorithm, recording the partial derivatives of each operation
+
+      The tape holds two entries per instruction.
+  */
+  void eval_tape(const double** arg, double* w, double* tape) const;
+
+  /** \brief Propagate nder forward directions through the recorded tape
+
+      The derivative work vector holds the nder directions of each work vector
+      element consecutively. The seeds and sensitivities of the directions are
+      stored consecutively, as for forward().
+  */
+  void fwd_tape(const double** fseed, double** fsens, const double* tape, double* dw,
+                casadi_int nder) const;
+
+  /** \brief Propagate nder adjoint directions backwards through the recorded tape */
+  void adj_tape(const double** aseed, double** asens, const double* tape, double* dw,
+                casadi_int nder) const;
+
+  /** \brief Propagate truncated Taylor polynomials through the algorithm */
+  Function get_taylor(casadi_int order, const std::string& name,
+                      const std::vector<std::string>& inames,
+                      const std::vector<std::string>& onames,
+                      const Dict& opts) const override;
+
   /** \brief  Check if smooth
 
       \identifier{ui} */
   bool is_smooth() const;
 
+  /** \brief Operation counts of the algorithm */
+  Dict info() const override;
+
   /** \brief  Print the algorithm
 
       \identifier{uj} */
@@ -149,6 +274,16 @@ class CASADI_EXPORT SXFunction :
       \identifier{up} */
   SX hess(casadi_int iind=0, casadi_int oind=0);
 
+  /** \brief Hessian of a scalar output by edge pushing
+
+      A single reverse sweep over the algorithm, which eliminates one node at a
+      time. The adjoint and the symmetric second order interactions of the node
+      are passed on to its operands, so that after the sweep only the interactions
+      between the inputs, i.e. the nonzeros of the Hessian, remain. No coloring of
+      the Hessian sparsity pattern is needed.
+  */
+  SX hess_edge_pushing() const;
+
   /** \brief Get the number of atomic operations
 
       \identifier{uq} */
@@ -219,6 +354,9 @@ class CASADI_EXPORT SXFunction :
       \identifier{uz} */
   std::vector<AlgEl> algorithm_;
 
+  /** \brief  Print an instruction, free parameters are printed as such */
+  std::string print(const AlgEl& a) const;
+
   // Work vector size
   size_t worksize_;
 
@@ -270,6 +408,42 @@ class CASADI_EXPORT SXFunction :
       \identifier{v5} */
   void codegen_body(CodeGenerator& g) const override;
 
+  /// Bytes used by the algorithm, the bytecode and the constants
+  size_t instructions_bytes() const override;
+
+  /** \brief Interval range analysis
+
+      Given bounds [lb, ub] on the nonzeros of each input, bounds each nonzero of
+      each output as well as a first-order bound on its accumulated rounding error
+      in an arithmetic with unit roundoff eps. Operations without an interval rule
+      give unbounded results. Returns the largest magnitude of any intermediate.
+  */
+  double range_analysis(const std::vector<std::vector<double>>& in_range, double eps,
+                        std::vector<std::vector<double>>& lb,
+                        std::vector<std::vector<double>>& ub,
+                        std::vector<std::vector<double>>& err) const;
+
+  /** \brief Report the range analysis in the generated code */
+  void codegen_range(CodeGenerator& g, const std::vector<std::vector<double>>& in_range) const;
+
+  /** \brief Is generation of LLVM IR supported? */
+  bool has_llvm() const override { return free_vars_.empty();}
+
+  /** \brief Generate LLVM IR for numerical evaluation */
+  std::string llvm_ir(const std::string& fname) const override;
+
+  /** \brief Is generation of a batched entry point supported? */
+  bool has_codegen_batch() const override { return free_vars_.empty();}
+
+  /** \brief Generate code for the body of a batched entry point */
+  void codegen_batch_body(CodeGenerator& g, casadi_int n) const override;
+
+  /** \brief Work vector length of a batched entry point */
+  casadi_int codegen_batch_sz_w(const CodeGenerator& g, casadi_int n) const override;
+
+  /** \brief Generate code for the body of a CUDA/HIP kernel */
+  void codegen_cuda_body(CodeGenerator& g) const override;
+
   /** \brief  Propagate sparsity forward
 
       \identifier{v6} */
@@ -281,6 +455,9 @@ class CASADI_EXPORT SXFunction :
       \identifier{v7} */
   int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
 
+  /** \brief Sparsity propagation is reentrant, unless falling back to the base class */
+  bool has_sp_threadsafe() const override { return sp_weight()>0 && sp_weight()<1;}
+
   /** *\brief get SX expression associated with instructions
 
        \identifier{v8} */
@@ -306,6 +483,38 @@ class CASADI_EXPORT SXFunction :
   /// Live variables?
   bool live_variables_;
 
+  /// Evaluate using the bytecode interpreter?
+  bool bytecode_;
+
+  /// Bytecode, terminated by a stop instruction
+  std::vector<VmInstruction> vm_code_;
+
+  /// Compact bytecode, replaces vm_code_ when not empty
+  std::vector<VmInstruction16> vm_code16_;
+
+  /// Constant pool of the bytecode
+  std::vector<double> vm_const_;
+
+  /// Work vector size of the bytecode
+  size_t vm_worksize_;
+
+  /// For each instruction, the outputs that depend on it (empty if single output)
+  std::vector<bvec_t> out_mask_;
+
+  /// Skip branches of if_else_zero whose condition is zero?
+  bool short_circuit_;
+
+  /// Evaluate directional derivatives numerically on the tape?
+  bool numeric_ad_;
+
+  /// Instructions [begin, end) that are skipped when work vector element cond is zero
+  struct Branch {
+    casadi_int begin, end, cond;
+  };
+
+  /// Branches sorted by begin, enclosing branches before the ones nested in them
+  std::vector<Branch> branches_;
+
 protected:
   /** \brief Deserializing constructor
 
@@ -313,6 +522,104 @@ protected:
   explicit SXFunction(DeserializingStream& s);
 };
 
+/** \brief Directional derivatives of an SXFunction, evaluated on its tape
+
+    Stands in for f.forward(nder) or f.reverse(nder) when f has numeric_ad.
+    Each evaluation sweeps the algorithm of f once, recording the partial
+    derivatives of every operation, and then propagates all directions at once
+    through the recorded tape, so no derivative expressions are constructed.
+    Symbolic evaluation, higher order derivatives and code generation use the
+    symbolic derivative, which is generated when first needed.
+*/
+class CASADI_EXPORT SXTapeDerivative : public FunctionInternal {
+public:
+  /// Constructor
+  SXTapeDerivative(const std::string& name, const Function& f, bool fwd, casadi_int nder);
+
+  /// Destructor
+  ~SXTapeDerivative() override;
+
+  /// Get type name
+  std::string class_name() const override {return "SXTapeDerivative";}
+
+  ///@{
+  /// Number of function inputs and outputs
+  size_t get_n_in() override;
+  size_t get_n_out() override;
+  ///@}
+
+  ///@{
+  /// Sparsities of function inputs and outputs
+  Sparsity get_sparsity_in(casadi_int i) override;
+  Sparsity get_sparsity_out(casadi_int i) override;
+  ///@}
+
+  /// Initialize
+  void init(const Dict& opts) override;
+
+  /// Differentiated function
+  const SXFunction* sx() const { return static_cast<const SXFunction*>(f_.get());}
+
+  /// Generate the symbolic derivative, if not already done
+  const Function& derivative() const;
+
+  /// Evaluate numerically
+  int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+  /// Evaluate symbolically
+  int eval_sx(const SXElem** arg, SXElem** res,
+              casadi_int* iw, SXElem* w, void* mem) const override;
+
+  ///@{
+  /// Propagate sparsity through the dependency pattern of f
+  bool has_spfwd() const override { return true;}
+  bool has_sprev() const override { return true;}
+  int sp_forward(const bvec_t** arg, bvec_t** res,
+                 casadi_int* iw, bvec_t* w, void* mem) const override;
+  int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+  ///@}
+
+  ///@{
+  /// Higher order derivatives, from the symbolic derivative
+  bool has_forward(casadi_int nfwd) const override { return true;}
+  Function get_forward(casadi_int nfwd, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+  bool has_reverse(casadi_int nadj) const override { return true;}
+  Function get_reverse(casadi_int nadj, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+  ///@}
+
+  /// Serialize an object without type information
+  void serialize_body(SerializingStream &s) const override;
+
+  /// Deserialize without type information
+  static ProtoFunction* deserialize(DeserializingStream& s) { return new SXTapeDerivative(s); }
+
+  // Get all embedded functions, recursively
+  void find(std::map<FunctionInternal*, Function>& all_fun, casadi_int max_depth) const override;
+
+  // Function to be differentiated
+  Function f_;
+
+  // Forward or reverse mode, number of directions
+  bool fwd_;
+  casadi_int nder_;
+
+  // Symbolic derivative
+  mutable Function der_;
+
+protected:
+  /// Dependencies through f, forward or backwards, with one pointer per input and output
+  void sp_f(bvec_t** x, bvec_t** y, bool fwd) const;
+
+  /// Deserializing constructor
+  explicit SXTapeDerivative(DeserializingStream& s);
+};
+
 
 } // namespace casadi
 
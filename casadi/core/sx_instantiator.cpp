@@ -27,6 +27,8 @@
 
 #include "sx_function.hpp"
 
+#include <cstring>
+
 namespace casadi {
 
   template<>
@@ -462,8 +464,12 @@ namespace casadi {
 
 
     // Otherwise, evaluate symbolically
-    Function F("tmp_substitute", v, ex, Dict{{"max_io", 0}, {"allow_free", true}});
-    return F(vdef);
+    return substitute_plan(ex, v)(vdef);
+  }
+
+  template<>
+  Function CASADI_EXPORT SX::substitute_plan(const std::vector<SX>& ex, const std::vector<SX>& v) {
+    return Function("substitute_plan", v, ex, Dict{{"max_io", 0}, {"allow_free", true}});
   }
 
   template<>
@@ -564,36 +570,27 @@ namespace casadi {
     return false;
   }
 
-  class IncrementalSerializer {
-    public:
-
-    IncrementalSerializer() : serializer(ss) {
+  /// Structural key of an SX node in terms of its (already unique) dependencies
+  struct SXCseKey {
+    casadi_int op;
+    uintptr_t a, b;
+    bool operator==(const SXCseKey& y) const {
+      return op==y.op && a==y.a && b==y.b;
     }
+  };
 
-    std::string pack(const SXElem& a) {
-      serializer.pack(a);
-      // Serialization goes wrong if serialized SXNodes get destroyed
-      ref.push_back(a);
-      std::string ret = ss.str();
-      ss.str("");
-      ss.clear();
-      //uout() << a << ":" << ret << std::endl;
-      return ret;
+  struct SXCseKeyHash {
+    size_t operator()(const SXCseKey& k) const {
+      size_t h = std::hash<casadi_int>()(k.op);
+      h ^= std::hash<uintptr_t>()(k.a) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      h ^= std::hash<uintptr_t>()(k.b) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      return h;
     }
-
-    private:
-      std::stringstream ss;
-      // List of references to keep alive
-      std::vector<SXElem> ref;
-      SerializingStream serializer;
   };
 
-
   template<>
   std::vector<SX> CASADI_EXPORT SX::cse(const std::vector<SX>& e) {
 
-    SX c = veccat(e);
-    //std::vector<SX> args = symvar(c);
     Function f("f", std::vector<SX>{}, e, {{"live_variables", false},
       {"max_io", 0}, {"cse", false}, {"allow_free", true}});
     SXFunction *ff = f.get<SXFunction>();
@@ -606,18 +603,16 @@ namespace casadi {
     // Symbolic work, non-differentiated
     std::vector<SXElem> w(ff->worksize_);
 
-    std::vector<const SXElem*> arg(f.sz_arg());
-    /*for (casadi_int i=0;i<args.size();++i) {
-      arg[i] = get_ptr(args.at(i).nonzeros());
-    }*/
-
     std::vector<SXElem*> res(f.sz_res());
     for (casadi_int i=0;i<e.size();++i) {
       res[i] = get_ptr(ret.at(i).nonzeros());
     }
 
-    std::unordered_map<std::string, SXElem > cache;
-    IncrementalSerializer s;
+    // Unique node for each operation on unique dependencies.
+    // Since the algorithm is sorted topologically, the dependencies of each
+    // operation have already been made unique, so a single pass suffices.
+    std::unordered_map<SXCseKey, SXElem, SXCseKeyHash> cache;
+    cache.reserve(ff->algorithm_.size());
 
     // Iterator to stack of constants
     std::vector<SXElem>::const_iterator c_it = ff->constants_.begin();
@@ -629,39 +624,52 @@ namespace casadi {
     for (auto&& a : ff->algorithm_) {
       switch (a.op) {
       case OP_INPUT:
-        w[a.i0] = arg[a.i1]==nullptr ? 0 : arg[a.i1][a.i2];
-        if (arg[a.i1]!=nullptr) cache[s.pack(w[a.i0])] = w[a.i0];
+        w[a.i0] = 0;
         break;
       case OP_OUTPUT:
         if (res[a.i0]!=nullptr) res[a.i0][a.i2] = w[a.i1];
         break;
       case OP_CONST:
-        w[a.i0] = *c_it++;
-        cache[s.pack(w[a.i0])] = w[a.i0];
+        {
+          // Constants with the same value are merged
+          double v = a.d;
+          SXCseKey key = {OP_CONST, 0, 0};
+          std::memcpy(&key.a, &v, std::min(sizeof(v), sizeof(key.a)));
+          auto itk = cache.find(key);
+          if (itk==cache.end()) {
+            w[a.i0] = *c_it;
+            cache[key] = w[a.i0];
+          } else {
+            w[a.i0] = itk->second;
+          }
+          c_it++;
+        }
         break;
       case OP_PARAMETER:
         w[a.i0] = *p_it++;
-        cache[s.pack(w[a.i0])] = w[a.i0];
         break;
       default:
         {
+          // Key in terms of the unique dependencies
+          uintptr_t k1 = reinterpret_cast<uintptr_t>(w[a.i1].get());
+          uintptr_t k2 = casadi_math<double>::ndeps(a.op)==2 ?
+            reinterpret_cast<uintptr_t>(w[a.i2].get()) : 0;
+          // Commutative operations are matched regardless of operand order
+          if (k2<k1 && operation_checker<CommChecker>(a.op)) std::swap(k1, k2);
+          SXCseKey key = {a.op, k1, k2};
+          auto itk = cache.find(key);
+          if (itk!=cache.end()) {
+            w[a.i0] = itk->second;
+            break;
+          }
 
           // Evaluate the function to a temporary value
           // (as it might overwrite the children in the work vector)
           SXElem f;
-          // Missing simplifications like [x+y]->[twice]
           switch (a.op) {
             CASADI_MATH_FUN_BUILTIN(w[a.i1], w[a.i2], f)
           }
-
-          std::string key = s.pack(f);
-
-          auto itk = cache.find(key);
-          if (itk==cache.end()) {
-            cache[key] = f;
-          } else {
-            f = itk->second;
-          }
+          cache[key] = f;
 
           // Finally save the function value
           w[a.i0] = f;
@@ -684,8 +692,24 @@ namespace casadi {
   template<>
   SX CASADI_EXPORT SX::hessian(const SX &ex, const SX &arg, SX &g, const Dict& opts) {
     Dict all_opts = opts;
-    if (!opts.count("symmetric")) all_opts["symmetric"] = true;
+    std::string hessian_method = "coloring";
+    auto it = all_opts.find("hessian_method");
+    if (it!=all_opts.end()) {
+      hessian_method = it->second.to_string();
+      all_opts.erase(it);
+    }
     g = gradient(ex, arg);
+    if (hessian_method=="edge_pushing") {
+      casadi_assert(ex.is_scalar(), "'hessian' only defined for scalar expressions.");
+      Dict h_opts;
+      extract_from_dict(all_opts, "helper_options", h_opts);
+      h_opts["allow_free"] = true;
+      Function h("hess_helper", {arg}, {ex}, h_opts);
+      return h.get<SXFunction>()->hess_edge_pushing();
+    }
+    casadi_assert(hessian_method=="coloring", "Unknown hessian_method '" + hessian_method
+      + "', expected 'coloring' or 'edge_pushing'");
+    if (!opts.count("symmetric")) all_opts["symmetric"] = true;
     return jacobian(g, arg, all_opts);
   }
 
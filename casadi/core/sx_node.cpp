@@ -32,9 +32,123 @@
 
 #include <limits>
 #include <stack>
+#ifdef CASADI_WITH_SX_POOL
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+#endif // CASADI_WITH_SX_POOL
 
 namespace casadi {
 
+#ifdef CASADI_WITH_SX_POOL
+  namespace {
+    // Pooled block sizes: 16, 32, ..., 128 bytes
+    const std::size_t pool_granularity = 16, pool_n_class = 8;
+
+    // Blocks moved between the thread-local and the shared free lists at once
+    const std::size_t pool_batch = 1024;
+
+    // Unused block, linked in a free list
+    struct PoolBlock {
+      PoolBlock* next;
+    };
+
+    // Free list
+    struct PoolList {
+      PoolBlock* head;
+      std::size_t n;
+    };
+
+    // Free lists of the current thread, trivially destructible so that nodes
+    // can still be deleted during the destruction of static objects
+#ifdef CASADI_WITH_THREAD
+    thread_local PoolList pool_local[pool_n_class];
+#else // CASADI_WITH_THREAD
+    PoolList pool_local[pool_n_class];
+#endif // CASADI_WITH_THREAD
+
+    // Free lists shared by all threads
+    struct PoolShared {
+#ifdef CASADI_WITH_THREAD
+      std::mutex mtx;
+#endif // CASADI_WITH_THREAD
+      PoolList list[pool_n_class];
+    };
+
+    // Never destroyed, for the same reason
+    PoolShared& pool_shared() {
+      static PoolShared* p = new PoolShared();
+      return *p;
+    }
+
+    // Move up to n blocks from the front of one list to another
+    void pool_move(PoolList& from, PoolList& to, std::size_t n) {
+      while (n-- > 0 && from.head) {
+        PoolBlock* b = from.head;
+        from.head = b->next;
+        from.n--;
+        b->next = to.head;
+        to.head = b;
+        to.n++;
+      }
+    }
+
+    // Refill an empty thread-local free list
+    void pool_refill(std::size_t c, PoolList& l) {
+      PoolShared& p = pool_shared();
+      {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(p.mtx);
+#endif // CASADI_WITH_THREAD
+        pool_move(p.list[c], l, pool_batch);
+      }
+      if (l.head) return;
+      // Allocate a new chunk, never freed
+      std::size_t sz = (c + 1) * pool_granularity;
+      char* chunk = static_cast<char*>(::operator new(pool_batch * sz));
+      for (std::size_t i = pool_batch; i-- > 0; ) {
+        PoolBlock* b = reinterpret_cast<PoolBlock*>(chunk + i * sz);
+        b->next = l.head;
+        l.head = b;
+      }
+      l.n = pool_batch;
+    }
+  } // namespace
+
+  void* SXNode::operator new(std::size_t sz) {
+    std::size_t c = (sz + pool_granularity - 1) / pool_granularity - 1;
+    if (c >= pool_n_class) return ::operator new(sz);
+    PoolList& l = pool_local[c];
+    if (!l.head) pool_refill(c, l);
+    PoolBlock* b = l.head;
+    l.head = b->next;
+    l.n--;
+    return b;
+  }
+
+  void SXNode::operator delete(void* ptr, std::size_t sz) {
+    std::size_t c = (sz + pool_granularity - 1) / pool_granularity - 1;
+    if (c >= pool_n_class) return ::operator delete(ptr);
+    PoolList& l = pool_local[c];
+    PoolBlock* b = static_cast<PoolBlock*>(ptr);
+    b->next = l.head;
+    l.head = b;
+    l.n++;
+    // Make blocks freed by this thread available to other threads
+    if (l.n >= 2 * pool_batch) {
+      PoolShared& p = pool_shared();
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(p.mtx);
+#endif // CASADI_WITH_THREAD
+      pool_move(l, p.list[c], pool_batch);
+    }
+  }
+#endif // CASADI_WITH_SX_POOL
+
   SXNode::SXNode() {
     count = 0;
     temp = 0;
@@ -154,14 +268,14 @@ namespace casadi {
 
   void SXNode::safe_delete(SXNode* n) {
     // Quick return if more owners
-    if (n->count>0) return;
+    if (!n || n->count>0) return;
     // Delete straight away if it doesn't have any dependencies
     if (!n->n_dep()) {
       delete n;
       return;
     }
     // Stack of expressions to be deleted
-    std::stack<SXNode*> deletion_stack;
+    std::stack<SXNode*, std::vector<SXNode*>> deletion_stack;
     // Add the node to the deletion stack
     deletion_stack.push(n);
     // Process stack
@@ -174,8 +288,8 @@ namespace casadi {
         // Get the node of the dependency of the top element
         // and remove it from the smart pointer
         SXNode *n2 = t->dep(c2).assignNoDelete(casadi_limits<SXElem>::nan);
-        // Check if this is the only reference to the element
-        if (n2->count == 0) {
+        // Check if this was the only reference to the element
+        if (n2) {
           // Check if unary or binary
           if (!n2->n_dep()) {
             // Delete straight away if not binary
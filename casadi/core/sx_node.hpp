@@ -26,10 +26,19 @@
 #ifndef CASADI_SX_NODE_HPP
 #define CASADI_SX_NODE_HPP
 
+#include <cstddef>
 #include <iostream>
 #include <math.h>
 #include <sstream>
 #include <string>
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+#include <atomic>
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
 /** \brief  Scalar expression (which also works as a smart pointer class to this class)
 
@@ -62,6 +71,19 @@ namespace casadi {
         \identifier{9v} */
     virtual ~SXNode();
 
+#ifdef CASADI_WITH_SX_POOL
+    /** \brief Allocate from a pool of fixed-size blocks
+
+        Blocks are taken from per-thread free lists that are refilled in chunks,
+        which avoids a heap allocation per node when building large graphs.
+        Freed blocks are kept for reuse and not returned to the operating system.
+    */
+    static void* operator new(std::size_t sz);
+
+    /// Return a block to the pool
+    static void operator delete(void* ptr, std::size_t sz);
+#endif // CASADI_WITH_SX_POOL
+
     ///@{
     /** \brief  check properties of a node
 
@@ -167,7 +189,31 @@ namespace casadi {
     mutable int temp;
 
     // Reference counter -- counts the number of parents of the node
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::atomic<unsigned int> count;
+
+    /// Protects the caches of constants and hash-consed nodes
+    static std::mutex cache_mtx_;
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
     unsigned int count;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
+    /** \brief Take a reference to a node found in a cache
+
+        Fails if the node has no owners left, i.e. it is being deleted by another thread.
+    */
+    bool acquire() {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      unsigned int c = count.load();
+      while (c>0) {
+        if (count.compare_exchange_weak(c, c+1)) return true;
+      }
+      return false;
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
+      count++;
+      return true;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    }
 
     /** \brief Serialize an object
 
@@ -0,0 +1,270 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "thread_pool.hpp"
+#include "global_options.hpp"
+
+#include <algorithm>
+
+namespace casadi {
+
+#ifdef CASADI_WITH_THREAD
+  namespace {
+    // Index of the deque owned by the current thread, 0 for non-workers
+    thread_local casadi_int pool_worker_id = 0;
+  } // namespace
+#endif // CASADI_WITH_THREAD
+
+  ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+#ifdef CASADI_WITH_THREAD
+  ThreadPool::ThreadPool() : n_active_(0), n_queued_(0), stop_(false), resizing_(false) {
+    deques_.emplace_back(new Deque());
+  }
+
+  ThreadPool::~ThreadPool() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    resize(lock, 0);
+  }
+#else // CASADI_WITH_THREAD
+  ThreadPool::ThreadPool() {
+  }
+
+  ThreadPool::~ThreadPool() {
+  }
+#endif // CASADI_WITH_THREAD
+
+  casadi_int ThreadPool::requested_size() {
+#ifdef CASADI_WITH_THREAD
+    casadi_int n = GlobalOptions::getMaxNumThreads();
+    if (n <= 0) n = std::thread::hardware_concurrency();
+    return std::max(n, casadi_int(1));
+#else // CASADI_WITH_THREAD
+    return 1;
+#endif // CASADI_WITH_THREAD
+  }
+
+  casadi_int ThreadPool::size() const {
+    return requested_size();
+  }
+
+  void ThreadPool::run(casadi_int n_task, const std::function<void(casadi_int)>& task) {
+    // Quick return if no parallelism is possible
+    if (n_task <= 1 || requested_size() == 1) {
+      for (casadi_int k = 0; k < n_task; ++k) task(k);
+      return;
+    }
+#ifdef CASADI_WITH_THREAD
+    std::unique_lock<std::mutex> lock(mtx_);
+    // Adapt the number of workers, only when no other batch is running
+    cv_.wait(lock, [this]() { return !resizing_; });
+    if (n_active_++ == 0) resize(lock, requested_size() - 1);
+    lock.unlock();
+    // Push the batch onto the deque of the current thread
+    casadi_int id = pool_worker_id;
+    Deque& q = *deques_.at(id);
+    Batch b;
+    b.task = &task;
+    b.n_task = n_task;
+    b.next = 0;
+    b.n_left = n_task;
+    b.detached = false;
+    {
+      std::lock_guard<std::mutex> qlock(q.mtx);
+      q.batches.push_back(&b);
+    }
+    {
+      std::lock_guard<std::mutex> wlock(mtx_);
+      n_queued_++;
+    }
+    cv_.notify_all();
+    // Take part in the evaluation
+    Batch* b1;
+    casadi_int k;
+    while (claim(q, &b, k)) execute(&b, k);
+    // Help with other batches while waiting for the tasks claimed by others
+    while (b.n_left > 0) {
+      if (find(id, b1, k)) {
+        execute(b1, k);
+      } else {
+        lock.lock();
+        cv_.wait(lock, [this, &b]() { return b.n_left == 0 || n_queued_ > 0; });
+        lock.unlock();
+      }
+    }
+    // Batch completed
+    lock.lock();
+    n_active_--;
+    lock.unlock();
+    // Propagate errors
+    if (b.error) std::rethrow_exception(b.error);
+#endif // CASADI_WITH_THREAD
+  }
+
+  void ThreadPool::submit(const std::function<void()>& task) {
+    // Quick return if no workers
+    if (requested_size() == 1) {
+      task();
+      return;
+    }
+#ifdef CASADI_WITH_THREAD
+    std::unique_lock<std::mutex> lock(mtx_);
+    // Counts as running until completed, which keeps the workers alive
+    cv_.wait(lock, [this]() { return !resizing_; });
+    if (n_active_++ == 0) resize(lock, requested_size() - 1);
+    lock.unlock();
+    // Single-task batch, deleted by the worker completing it
+    Batch* b = new Batch();
+    b->owned_task = [task](casadi_int) { task(); };
+    b->task = &b->owned_task;
+    b->n_task = 1;
+    b->next = 0;
+    b->n_left = 1;
+    b->detached = true;
+    Deque& q = *deques_.at(pool_worker_id);
+    {
+      std::lock_guard<std::mutex> qlock(q.mtx);
+      q.batches.push_back(b);
+    }
+    {
+      std::lock_guard<std::mutex> wlock(mtx_);
+      n_queued_++;
+    }
+    cv_.notify_all();
+#endif // CASADI_WITH_THREAD
+  }
+
+#ifdef CASADI_WITH_THREAD
+  bool ThreadPool::claim(Deque& q, bool back, Batch*& b, casadi_int& k) {
+    std::lock_guard<std::mutex> qlock(q.mtx);
+    if (q.batches.empty()) return false;
+    b = back ? q.batches.back() : q.batches.front();
+    k = b->next++;
+    // Remove from deque when all tasks have been claimed
+    if (b->next == b->n_task) {
+      if (back) {
+        q.batches.pop_back();
+      } else {
+        q.batches.pop_front();
+      }
+      n_queued_--;
+    }
+    return true;
+  }
+
+  bool ThreadPool::claim(Deque& q, Batch* b, casadi_int& k) {
+    std::lock_guard<std::mutex> qlock(q.mtx);
+    if (b->next == b->n_task) return false;
+    k = b->next++;
+    // Remove from deque when all tasks have been claimed
+    if (b->next == b->n_task) {
+      q.batches.erase(std::find(q.batches.begin(), q.batches.end(), b));
+      n_queued_--;
+    }
+    return true;
+  }
+
+  bool ThreadPool::find(casadi_int id, Batch*& b, casadi_int& k) {
+    // Most recent batch of the own deque
+    if (claim(*deques_[id], true, b, k)) return true;
+    // Oldest batch of any other deque
+    casadi_int n = deques_.size();
+    for (casadi_int i = 1; i < n; ++i) {
+      if (claim(*deques_[(id + i) % n], false, b, k)) return true;
+    }
+    return false;
+  }
+
+  void ThreadPool::execute(Batch* b, casadi_int k) {
+    std::exception_ptr error;
+    try {
+      (*b->task)(k);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // Register error, before the batch can be released
+    if (error) {
+      std::lock_guard<std::mutex> wlock(mtx_);
+      if (!b->error) b->error = error;
+    }
+    // Register completion, b may go out of scope after the last decrement
+    bool detached = b->detached;
+    if (--b->n_left == 0) {
+      std::lock_guard<std::mutex> wlock(mtx_);
+      if (detached) {
+        delete b;
+        n_active_--;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  void ThreadPool::resize(std::unique_lock<std::mutex>& lock, casadi_int n_worker) {
+    // Quick return if nothing to do
+    if (static_cast<casadi_int>(workers_.size()) == n_worker) return;
+    resizing_ = true;
+    // Stop the current workers, if any
+    if (!workers_.empty()) {
+      stop_ = true;
+      cv_.notify_all();
+      lock.unlock();
+      for (auto&& th : workers_) th.join();
+      lock.lock();
+      workers_.clear();
+      stop_ = false;
+    }
+    // One deque per worker and one shared by all other threads
+    deques_.resize(1);
+    for (casadi_int i = 1; i <= n_worker; ++i) deques_.emplace_back(new Deque());
+    // Start new workers
+    for (casadi_int i = 1; i <= n_worker; ++i) {
+      workers_.emplace_back([this, i]() {
+        pool_worker_id = i;
+        work(i);
+      });
+    }
+    resizing_ = false;
+    cv_.notify_all();
+  }
+
+  void ThreadPool::work(casadi_int id) {
+    Batch* b;
+    casadi_int k;
+    while (true) {
+      if (find(id, b, k)) {
+        execute(b, k);
+      } else {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this]() { return stop_ || n_queued_ > 0; });
+        if (stop_) return;
+      }
+    }
+  }
+#endif // CASADI_WITH_THREAD
+
+} // namespace casadi
@@ -0,0 +1,176 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_THREAD_POOL_HPP
+#define CASADI_THREAD_POOL_HPP
+
+#include "casadi_common.hpp"
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#include <mingw.mutex.h>
+#include <mingw.condition_variable.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Process-wide work-stealing pool of persistent worker threads
+
+      Tasks are submitted in batches of n_task independent tasks, identified by
+      their index. Each worker owns a deque of batches: batches submitted from
+      within a worker (e.g. a thread-parallel map inside a thread-parallel map)
+      are pushed onto its own deque and processed last-in first-out, while idle
+      workers steal the oldest batches from the other deques.
+      The submitting thread takes part in the evaluation and keeps executing
+      other tasks while waiting for its batch, so nested parallelism neither
+      deadlocks nor oversubscribes the cores.
+
+      The number of threads, including the calling thread, is given by
+      GlobalOptions::getMaxNumThreads(), where 0 means hardware concurrency.
+      Without CASADI_WITH_THREAD, all tasks are executed serially by the caller.
+  */
+  class CASADI_EXPORT ThreadPool {
+  public:
+    /// Access the process-wide instance
+    static ThreadPool& instance();
+
+    /// Number of threads that can work on a batch, including the caller
+    casadi_int size() const;
+
+    /// Number of threads requested by the user, resolving hardware concurrency
+    static casadi_int requested_size();
+
+    /** \brief Evaluate task(k) for k = 0, ..., n_task-1, blocking
+
+        Exceptions raised by the tasks are rethrown in the calling thread,
+        after all tasks of the batch have finished.
+    */
+    void run(casadi_int n_task, const std::function<void(casadi_int)>& task);
+
+    /** \brief Schedule task() for execution by a worker, without blocking
+
+        The task must not throw. If no workers are available (a single thread
+        requested or no thread support), the task is executed by the caller.
+    */
+    void submit(const std::function<void()>& task);
+
+    /// Destructor, joins all workers
+    ~ThreadPool();
+
+  private:
+    /// Use instance() instead
+    ThreadPool();
+
+    /// No copies
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+#ifdef CASADI_WITH_THREAD
+    // A batch of tasks
+    struct Batch {
+      // Task to be executed
+      const std::function<void(casadi_int)>* task;
+      // Number of tasks
+      casadi_int n_task;
+      // Next task to be claimed, protected by the mutex of the owning deque
+      casadi_int next;
+      // Number of tasks not yet finished
+      std::atomic<casadi_int> n_left;
+      // First exception raised, if any, protected by mtx_
+      std::exception_ptr error;
+      // Submitted without a waiting caller: owned and released by the pool
+      bool detached;
+      // Task storage for detached batches
+      std::function<void(casadi_int)> owned_task;
+    };
+
+    // Deque of batches with unclaimed tasks, owned by a thread
+    struct Deque {
+      std::mutex mtx;
+      std::deque<Batch*> batches;
+    };
+
+    // Claim a task from a deque, from the back (owner) or the front (thief)
+    bool claim(Deque& q, bool back, Batch*& b, casadi_int& k);
+
+    // Claim a task of a particular batch
+    bool claim(Deque& q, Batch* b, casadi_int& k);
+
+    // Claim a task from the own deque or steal one from another deque
+    bool find(casadi_int id, Batch*& b, casadi_int& k);
+
+    // Execute a claimed task and register completion
+    void execute(Batch* b, casadi_int k);
+
+    // (Re)start workers, no batches may be running, lock must be held
+    void resize(std::unique_lock<std::mutex>& lock, casadi_int n_worker);
+
+    // Worker loop
+    void work(casadi_int id);
+
+    // Protects sleeping, resizing and error reporting
+    std::mutex mtx_;
+
+    // Signals new batches, completed batches and shutdown
+    std::condition_variable cv_;
+
+    // Deques: index 0 is shared by all non-worker threads, index i by worker i
+    std::vector<std::unique_ptr<Deque>> deques_;
+
+    // Persistent workers
+    std::vector<std::thread> workers_;
+
+    // Number of batches currently being executed
+    casadi_int n_active_;
+
+    // Number of batches with unclaimed tasks
+    std::atomic<casadi_int> n_queued_;
+
+    // Stop flag for the workers
+    bool stop_;
+
+    // Set during (re)start of the workers
+    bool resizing_;
+#endif // CASADI_WITH_THREAD
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_THREAD_POOL_HPP
@@ -62,12 +62,16 @@ namespace casadi {
     n_call += rhs.n_call;
   }
 
-  ScopedTiming::ScopedTiming(FStats& f) : f_(f) {
-    f_.tic();
+  ScopedTiming::ScopedTiming(FStats& f, bool timed) : f_(f), timed_(timed) {
+    if (timed_) f_.tic();
   }
 
   ScopedTiming::~ScopedTiming() {
-    f_.toc();
+    if (timed_) {
+      f_.toc();
+    } else {
+      f_.n_call += 1;
+    }
   }
 
 } // namespace casadi
@@ -84,12 +84,15 @@ namespace casadi {
 
   };
 
+  /** Time a scope, or only count the call if timed is false
+  */
   class CASADI_EXPORT ScopedTiming {
     public:
-      ScopedTiming(FStats& f);
+      ScopedTiming(FStats& f, bool timed=true);
       ~ScopedTiming();
     private:
       FStats& f_;
+      bool timed_;
   };
 
 /// \endcond
@@ -194,6 +194,17 @@ namespace casadi {
     res[0] = arg[0].T();
   }
 
+  MX Transpose::get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const {
+    // Nonzeros of the argument corresponding to the nonzeros of the transpose
+    std::vector<casadi_int> mapping;
+    dep().sparsity().transpose(mapping);
+    std::vector<casadi_int> nz_new(nz);
+    for (casadi_int& i : nz_new) {
+      if (i>=0) i = mapping[i];
+    }
+    return dep()->get_nzref(sp, nz_new);
+  }
+
   void Transpose::ad_forward(const std::vector<std::vector<MX> >& fseed,
                           std::vector<std::vector<MX> >& fsens) const {
     for (casadi_int d=0; d<fsens.size(); ++d) {
@@ -110,6 +110,9 @@ namespace casadi {
     /// Transpose
     MX get_transpose() const override { return dep();}
 
+    /// Get the nonzeros of matrix
+    MX get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const override;
+
     /// Solve for square linear system
     //virtual MX get_solve(const MX& r, bool tr, const Linsol& linear_solver) const {
     // return dep()->get_solve(r, !tr, linear_solver);} // FIXME #1001
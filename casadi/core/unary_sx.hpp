@@ -28,6 +28,9 @@
 
 #include "sx_node.hpp"
 #include "serializing_stream.hpp"
+#include "global_options.hpp"
+#include "sparsity.hpp"
+#include <unordered_map>
 
 /// \cond INTERNAL
 
@@ -45,7 +48,23 @@ class UnarySX : public SXNode {
     /** \brief  Constructor is private, use "create" below
 
         \identifier{du} */
-    UnarySX(unsigned char op, const SXElem& dep) : op_(op), dep_(dep) {}
+    UnarySX(unsigned char op, const SXElem& dep) : op_(op), hash_consed_(false), dep_(dep) {}
+
+    /** \brief  Key of the hash-cons table: operation and dependency */
+    struct Key {
+      unsigned char op;
+      const SXNode* dep;
+      bool operator==(const Key& k) const { return op==k.op && dep==k.dep;}
+    };
+
+    /** \brief  Hash function for Key */
+    struct KeyHash {
+      std::size_t operator()(const Key& k) const {
+        std::size_t seed = k.op;
+        hash_combine(seed, reinterpret_cast<uintptr_t>(k.dep));
+        return seed;
+      }
+    };
 
   public:
 
@@ -59,6 +78,27 @@ class UnarySX : public SXNode {
         double ret_val;
         casadi_math<double>::fun(op, dep_val, dep_val, ret_val);
         return ret_val;
+      } else if (GlobalOptions::hash_consing) {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+        // Reuse a live node with the same operation and dependency, if any
+        Key k = {op, dep.get()};
+        auto it = cached_.find(k);
+        if (it!=cached_.end() && it->second->acquire()) {
+          SXElem ret = SXElem::create(it->second);
+          it->second->count--;
+          return ret;
+        }
+        UnarySX* n = new UnarySX(op, dep);
+        n->hash_consed_ = true;
+        if (it==cached_.end()) {
+          cached_.insert(it, std::make_pair(k, n));
+        } else {
+          // Replaces a node that is being deleted
+          it->second = n;
+        }
+        return SXElem::create(n);
       } else {
         // Expression containing free variables
         return SXElem::create(new UnarySX(op, dep));
@@ -69,6 +109,13 @@ class UnarySX : public SXNode {
 
         \identifier{dw} */
     ~UnarySX() override {
+      if (hash_consed_) {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+        auto it = cached_.find({op_, dep_.get()});
+        if (it!=cached_.end() && it->second==this) cached_.erase(it);
+      }
       safe_delete(dep_.assignNoDelete(casadi_limits<SXElem>::nan));
     }
 
@@ -115,6 +162,12 @@ class UnarySX : public SXNode {
         \identifier{e2} */
     unsigned char op_;
 
+    /** \brief  Is the node in the hash-cons table? */
+    bool hash_consed_;
+
+    /** \brief  Hash-cons table of live nodes */
+    static std::unordered_map<Key, UnarySX*, KeyHash> cached_;
+
     /** \brief  The dependencies of the node
 
         \identifier{e3} */
@@ -0,0 +1,104 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "warm_start_function.hpp"
+
+namespace casadi {
+
+  WarmStartFunction::WarmStartFunction(const std::string& name, const Function& f,
+                                       const std::vector<std::vector<double>>& ws0)
+    : FunctionInternal(name), f_(f), ws0_(ws0) {
+    casadi_int n_ws = ws0_.size();
+    casadi_assert(f_.n_in()>=n_ws && f_.n_out()>=n_ws, "Too many warm-start values");
+    for (casadi_int i=0; i<n_ws; ++i) {
+      casadi_int i_in = f_.n_in() - n_ws + i, i_out = f_.n_out() - n_ws + i;
+      casadi_assert(f_.nnz_in(i_in)==f_.nnz_out(i_out) && ws0_[i].size()==f_.nnz_in(i_in),
+        "Dimension mismatch for warm-start value " + str(i) + ".");
+    }
+  }
+
+  WarmStartFunction::~WarmStartFunction() {
+    clear_mem();
+  }
+
+  void WarmStartFunction::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Buffers for the warm-start outputs
+    for (casadi_int i=0; i<ws0_.size(); ++i) alloc_w(f_.nnz_out(n_out_ + i), true);
+
+    // Work vectors of the wrapped function
+    alloc(f_);
+  }
+
+  int WarmStartFunction::init_mem(void* mem) const {
+    if (FunctionInternal::init_mem(mem)) return 1;
+    auto m = static_cast<WarmStartFunctionMemory*>(mem);
+    m->ws = ws0_;
+    m->mem_f = f_.checkout();
+    return 0;
+  }
+
+  void WarmStartFunction::free_mem(void *mem) const {
+    auto m = static_cast<WarmStartFunctionMemory*>(mem);
+    if (m->mem_f>=0) f_.release(m->mem_f);
+    delete m;
+  }
+
+  void WarmStartFunction::serialize_body(SerializingStream &s) const {
+    casadi_error("Serialization not supported for warm-started functions, "
+      "serialize the wrapped function instead.");
+  }
+
+  void WarmStartFunction::find(std::map<FunctionInternal*, Function>& all_fun,
+      casadi_int max_depth) const {
+    add_embedded(all_fun, f_, max_depth);
+  }
+
+  int WarmStartFunction::eval(const double** arg, double** res,
+                              casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<WarmStartFunctionMemory*>(mem);
+    casadi_int n_ws = ws0_.size();
+    // Exposed arguments followed by the stored warm-start values
+    const double** arg1 = arg + n_in_;
+    std::copy_n(arg, n_in_, arg1);
+    for (casadi_int i=0; i<n_ws; ++i) arg1[n_in_ + i] = get_ptr(m->ws[i]);
+    // Exposed results followed by buffers for the new warm-start values
+    double** res1 = res + n_out_;
+    std::copy_n(res, n_out_, res1);
+    for (casadi_int i=0; i<n_ws; ++i) {
+      res1[n_out_ + i] = w;
+      w += m->ws[i].size();
+    }
+    if (f_(arg1, res1, iw, w, m->mem_f)) return 1;
+    // Store for the next call
+    for (casadi_int i=0; i<n_ws; ++i) {
+      std::copy_n(res1[n_out_ + i], m->ws[i].size(), m->ws[i].begin());
+    }
+    return 0;
+  }
+
+} // namespace casadi
@@ -0,0 +1,112 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_WARM_START_FUNCTION_HPP
+#define CASADI_WARM_START_FUNCTION_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Memory for a warm-started function */
+  struct CASADI_EXPORT WarmStartFunctionMemory : public FunctionMemory {
+    // Values fed back to the next call
+    std::vector<std::vector<double>> ws;
+    // Memory of the wrapped function
+    int mem_f = -1;
+  };
+
+  /** \brief Function with a state that is fed back between calls
+
+      Wraps a function f whose last n_ws inputs are warm-start values and whose last
+      n_ws outputs are the corresponding values after the call, e.g. an NLP solver
+      returning its primal and dual solution. The last n_ws outputs of one call are
+      the last n_ws inputs of the next call on the same memory object, the remaining
+      inputs and outputs are exposed. Each memory object keeps a memory object of f.
+  */
+  class CASADI_EXPORT WarmStartFunction : public FunctionInternal {
+  public:
+    /** \brief Constructor, ws0 are the initial warm-start values */
+    WarmStartFunction(const std::string& name, const Function& f,
+                      const std::vector<std::vector<double>>& ws0);
+
+    /** \brief  Destructor */
+    ~WarmStartFunction() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "WarmStartFunction";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return f_.n_in() - ws0_.size();}
+    size_t get_n_out() override { return f_.n_out() - ws0_.size();}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override { return f_.sparsity_in(i);}
+    Sparsity get_sparsity_out(casadi_int i) override { return f_.sparsity_out(i);}
+    /// @}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override { return f_.name_in(i);}
+    std::string get_name_out(casadi_int i) override { return f_.name_out(i);}
+    /// @}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new WarmStartFunctionMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    // Get all embedded functions, recursively
+    void find(std::map<FunctionInternal*, Function>& all_fun, casadi_int max_depth) const override;
+
+    // Wrapped function
+    Function f_;
+
+    // Initial warm-start values
+    std::vector<std::vector<double>> ws0_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_WARM_START_FUNCTION_HPP
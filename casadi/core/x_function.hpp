@@ -493,8 +493,6 @@ namespace casadi {
 
       // Get the sparsity of the Jacobian block
       Sparsity jsp = jac_sparsity(0, 0, true, symmetric).T();
-      const casadi_int* jsp_colind = jsp.colind();
-      const casadi_int* jsp_row = jsp.row();
 
       // Input sparsity
       std::vector<casadi_int> input_col = sparsity_in_.at(iind).get_col();
@@ -634,14 +632,13 @@ namespace casadi {
           }
         }
 
-        // Evaluate symbolically
+        // Evaluate symbolically, a bidirectional partition needs both modes
         if (!fseed.empty()) {
-          casadi_assert_dev(aseed.empty());
           if (verbose_) casadi_message("Calling 'ad_forward'");
           static_cast<const DerivedType*>(this)->ad_forward(fseed, fsens);
           if (verbose_) casadi_message("Back from 'ad_forward'");
-        } else if (!aseed.empty()) {
-          casadi_assert_dev(fseed.empty());
+        }
+        if (!aseed.empty()) {
           if (verbose_) casadi_message("Calling 'ad_reverse'");
           static_cast<const DerivedType*>(this)->ad_reverse(aseed, asens);
           if (verbose_) casadi_message("Back from 'ad_reverse'");
@@ -654,22 +651,19 @@ namespace casadi {
             continue;
           }
 
-          // If symmetric, see how many times each output appears
-          if (symmetric) {
-            // Initialize to zero
-            tmp.resize(nnz_out(oind));
-            std::fill(tmp.begin(), tmp.end(), 0);
+          // See how many times each output appears, only unique entries are recovered
+          tmp.resize(nnz_out(oind));
+          std::fill(tmp.begin(), tmp.end(), 0);
 
-            // "Multiply" Jacobian sparsity by seed vector
-            for (casadi_int el = D1.colind(offset_nfdir+d); el<D1.colind(offset_nfdir+d+1); ++el) {
+          // "Multiply" Jacobian sparsity by seed vector
+          for (casadi_int el = D1.colind(offset_nfdir+d); el<D1.colind(offset_nfdir+d+1); ++el) {
 
-              // Get the input nonzero
-              casadi_int c = D1.row(el);
+            // Get the input nonzero
+            casadi_int c = D1.row(el);
 
-              // Propagate dependencies
-              for (casadi_int el_jsp=jsp_colind[c]; el_jsp<jsp_colind[c+1]; ++el_jsp) {
-                tmp[jsp_row[el_jsp]]++;
-              }
+            // Propagate dependencies
+            for (casadi_int el_out=jsp_trans.colind(c); el_out<jsp_trans.colind(c+1); ++el_out) {
+              tmp[jsp_trans.row(el_out)]++;
             }
           }
 
@@ -718,7 +712,7 @@ namespace casadi {
                   adds[f_out] = el_out;
                   adds2[f_out] = elJ;
                 }
-              } else {
+              } else if (tmp[r_out]==1) {
                 // Get the output seed
                 adds[f_out] = elJ;
               }
@@ -769,6 +763,16 @@ namespace casadi {
           sparsity_in_.at(iind).find(nzmap);
           asens[d][iind].sparsity().get_nz(nzmap);
 
+          // See how many times each input appears, only unique entries are recovered
+          tmp.resize(nnz_in(iind));
+          std::fill(tmp.begin(), tmp.end(), 0);
+          for (casadi_int el = D2.colind(offset_nadir+d); el<D2.colind(offset_nadir+d+1); ++el) {
+            casadi_int r = D2.row(el);
+            for (casadi_int elJ = jsp.colind(r); elJ<jsp.colind(r+1); ++elJ) {
+              tmp[jsp.row(elJ)]++;
+            }
+          }
+
           // For all the output nonzeros treated in the sweep
           for (casadi_int el = D2.colind(offset_nadir+d); el<D2.colind(offset_nadir+d+1); ++el) {
 
@@ -783,7 +787,7 @@ namespace casadi {
 
               // Get the corresponding adjoint sensitivity nonzero
               casadi_int anz = nzmap[inz];
-              if (anz<0) continue;
+              if (anz<0 || tmp[inz]!=1) continue;
 
               // Get the input seed
               ret.at(0).nz(elJ) = asens[d][iind].nz(anz);
@@ -0,0 +1,267 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "xml_stream_reader.hpp"
+#include "exception.hpp"
+
+#include <cctype>
+#include <cstring>
+
+namespace casadi {
+
+  XmlStreamReader::XmlStreamReader(std::istream& stream, const std::string& source)
+    : buf_(stream.rdbuf()), source_(source), line_(1), is_start_(false), depth_(-1),
+      pending_end_(false) {
+    casadi_assert(buf_ != nullptr, "No stream buffer");
+  }
+
+  void XmlStreamReader::error(const std::string& msg) const {
+    casadi_error((source_.empty() ? std::string("XML") : source_) + ":" + str(line_)
+      + ": " + msg);
+  }
+
+  char XmlStreamReader::get_char() {
+    int c = get();
+    if (c == EOF) error("Unexpected end of file");
+    return static_cast<char>(c);
+  }
+
+  void XmlStreamReader::skip_ws() {
+    while (peek() != EOF && std::isspace(peek())) get();
+  }
+
+  std::string XmlStreamReader::read_until(const std::string& end) {
+    std::string s;
+    while (s.size() < end.size()
+        || s.compare(s.size() - end.size(), end.size(), end) != 0) {
+      s.push_back(get_char());
+    }
+    s.resize(s.size() - end.size());
+    return s;
+  }
+
+  std::string XmlStreamReader::read_name() {
+    std::string s;
+    while (peek() != EOF) {
+      char c = static_cast<char>(peek());
+      if (std::isspace(static_cast<unsigned char>(c)) || std::strchr("/>=<\"'", c)) break;
+      s.push_back(c);
+      get();
+    }
+    if (s.empty()) error("Name expected");
+    return s;
+  }
+
+  void XmlStreamReader::read_entity(std::string& s) {
+    std::string e;
+    for (char c = get_char(); c != ';'; c = get_char()) {
+      e.push_back(c);
+      if (e.size() > 10) error("Malformed entity '&" + e + "'");
+    }
+    if (e == "lt") {
+      s.push_back('<');
+    } else if (e == "gt") {
+      s.push_back('>');
+    } else if (e == "amp") {
+      s.push_back('&');
+    } else if (e == "quot") {
+      s.push_back('"');
+    } else if (e == "apos") {
+      s.push_back('\'');
+    } else if (e.size() > 1 && e[0] == '#') {
+      // Numeric character reference, encode as UTF-8
+      unsigned long cp;
+      try {
+        cp = e[1] == 'x' ? std::stoul(e.substr(2), nullptr, 16) : std::stoul(e.substr(1));
+      } catch (std::exception&) {
+        error("Malformed entity '&" + e + ";'");
+      }
+      if (cp < 0x80) {
+        s.push_back(static_cast<char>(cp));
+      } else if (cp < 0x800) {
+        s.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+      } else if (cp < 0x10000) {
+        s.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        s.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+      } else {
+        s.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        s.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        s.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+      }
+    } else {
+      error("Unknown entity '&" + e + ";'");
+    }
+  }
+
+  void XmlStreamReader::read_start_tag() {
+    node_ = XmlNode();
+    node_.line = line_;
+    node_.name = read_name();
+    // Attributes
+    while (true) {
+      skip_ws();
+      char c = get_char();
+      if (c == '>') {
+        break;
+      } else if (c == '/') {
+        if (get_char() != '>') error("'>' expected after '/' in <" + node_.name + ">");
+        pending_end_ = true;
+        break;
+      }
+      std::string att_name(1, c);
+      if (peek() != '=' && !std::isspace(peek())) att_name += read_name();
+      skip_ws();
+      if (get_char() != '=') error("'=' expected after attribute '" + att_name + "'");
+      skip_ws();
+      char q = get_char();
+      if (q != '"' && q != '\'') error("Quoted value expected for attribute '" + att_name + "'");
+      std::string value;
+      for (char v = get_char(); v != q; v = get_char()) {
+        if (v == '&') {
+          read_entity(value);
+        } else {
+          value.push_back(v);
+        }
+      }
+      node_.attributes[att_name] = value;
+    }
+    is_start_ = true;
+    depth_ = open_.size();
+    open_.push_back(OpenElement{node_.name, "", ""});
+  }
+
+  void XmlStreamReader::read_end_tag() {
+    if (open_.empty()) error("Unexpected end tag");
+    // Text with surrounding whitespace removed
+    OpenElement& e = open_.back();
+    size_t first = e.text.find_first_not_of(" \t\r\n");
+    size_t last = e.text.find_last_not_of(" \t\r\n");
+    node_ = XmlNode();
+    node_.line = line_;
+    node_.name = e.name;
+    if (first != std::string::npos) node_.text = e.text.substr(first, last - first + 1);
+    node_.comment = e.comment;
+    open_.pop_back();
+    is_start_ = false;
+    depth_ = open_.size();
+  }
+
+  bool XmlStreamReader::next() {
+    // End tag of a self-closing element
+    if (pending_end_) {
+      pending_end_ = false;
+      read_end_tag();
+      return true;
+    }
+    while (true) {
+      int c = get();
+      if (c == EOF) {
+        if (!open_.empty()) error("Unexpected end of file, <" + open_.back().name + "> not closed");
+        return false;
+      }
+      if (c != '<') {
+        // Text content
+        if (open_.empty()) {
+          if (!std::isspace(c)) error("Text outside of the root element");
+        } else if (c == '&') {
+          read_entity(open_.back().text);
+        } else {
+          open_.back().text.push_back(static_cast<char>(c));
+        }
+        continue;
+      }
+      c = peek();
+      if (c == '?') {
+        // Declaration or processing instruction
+        read_until("?>");
+      } else if (c == '!') {
+        get();
+        if (peek() == '-') {
+          // Comment
+          get();
+          if (get_char() != '-') error("Malformed comment");
+          std::string comment = read_until("-->");
+          if (!open_.empty()) open_.back().comment = comment;
+        } else if (peek() == '[') {
+          // CDATA section, verbatim text
+          get();
+          if (read_until("[") != "CDATA") error("Malformed CDATA section");
+          std::string cdata = read_until("]]>");
+          if (!open_.empty()) open_.back().text += cdata;
+        } else {
+          // Document type declaration, possibly with an internal subset
+          casadi_int level = 0;
+          for (char d = get_char(); d != '>' || level > 0; d = get_char()) {
+            if (d == '[') level++;
+            if (d == ']') level--;
+          }
+        }
+      } else if (c == '/') {
+        get();
+        std::string name = read_name();
+        skip_ws();
+        if (get_char() != '>') error("'>' expected in </" + name + ">");
+        if (open_.empty() || open_.back().name != name) {
+          error("Mismatched end tag </" + name + ">"
+            + (open_.empty() ? std::string() : ", expected </" + open_.back().name + ">"));
+        }
+        read_end_tag();
+        return true;
+      } else {
+        read_start_tag();
+        return true;
+      }
+    }
+  }
+
+  XmlNode XmlStreamReader::read() {
+    casadi_assert(is_start_, "Not at a start tag");
+    XmlNode ret = node_;
+    casadi_int d = depth_;
+    while (next()) {
+      if (is_start_) {
+        ret.children.push_back(read());
+      } else if (depth_ == d) {
+        ret.text = node_.text;
+        ret.comment = node_.comment;
+        return ret;
+      }
+    }
+    error("Unexpected end of file");
+  }
+
+  void XmlStreamReader::skip() {
+    casadi_assert(is_start_, "Not at a start tag");
+    casadi_int d = depth_;
+    while (next()) {
+      if (!is_start_ && depth_ == d) return;
+    }
+    error("Unexpected end of file");
+  }
+
+} // namespace casadi
@@ -0,0 +1,136 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_XML_STREAM_READER_HPP
+#define CASADI_XML_STREAM_READER_HPP
+
+#include <istream>
+#include "xml_node.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Streaming (pull) XML parser
+
+      Reads an XML document tag by tag, without building the document tree, so that
+      large documents can be processed one element at a time. Subtrees that are
+      needed in full can be read into an XmlNode with read().
+
+      Elements, attributes, text, CDATA sections, comments and the predefined and
+      numeric character entities are supported. Declarations, processing
+      instructions and document type declarations are skipped, DTDs are not read.
+  */
+  class CASADI_EXPORT XmlStreamReader {
+  public:
+    /** \brief Constructor, source is used in error messages */
+    explicit XmlStreamReader(std::istream& stream, const std::string& source = "");
+
+    /** \brief Advance to the next start or end tag
+
+        Returns false at the end of the document. Self-closing elements produce a
+        start tag followed by an end tag.
+    */
+    bool next();
+
+    /** \brief Is the current tag a start tag? */
+    bool is_start() const { return is_start_;}
+
+    /** \brief Current element: name, attributes and line, no children
+
+        At an end tag, text and comment are set as well.
+    */
+    const XmlNode& node() const { return node_;}
+
+    /** \brief Nesting depth of the current element, the root element has depth 0 */
+    casadi_int depth() const { return depth_;}
+
+    /** \brief Read the element at the current start tag, including all descendants
+
+        Afterwards, the current tag is its end tag.
+    */
+    XmlNode read();
+
+    /** \brief Skip the element at the current start tag, including all descendants */
+    void skip();
+
+  private:
+    // Get the next character, -1 at the end of the stream
+    int get() {
+      int c = buf_->sbumpc();
+      if (c == '\n') line_++;
+      return c;
+    }
+
+    // Peek at the next character
+    int peek() { return buf_->sgetc();}
+
+    // Get the next character, error at the end of the stream
+    char get_char();
+
+    // Skip whitespace
+    void skip_ws();
+
+    // Read until (and excluding) a terminating sequence
+    std::string read_until(const std::string& end);
+
+    // Read a tag or attribute name
+    std::string read_name();
+
+    // Decode a character entity, after the '&'
+    void read_entity(std::string& s);
+
+    // Parse a start tag, after the '<'
+    void read_start_tag();
+
+    // Parse an end tag, after the '</'
+    void read_end_tag();
+
+    // Throw an error with the current location
+    [[noreturn]] void error(const std::string& msg) const;
+
+    std::streambuf* buf_;
+    std::string source_;
+    casadi_int line_;
+
+    // Current tag
+    XmlNode node_;
+    bool is_start_;
+    casadi_int depth_;
+
+    // A self-closing element is pending its end tag
+    bool pending_end_;
+
+    // Open elements with the text and last comment read so far
+    struct OpenElement {
+      std::string name, text, comment;
+    };
+    std::vector<OpenElement> open_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_XML_STREAM_READER_HPP
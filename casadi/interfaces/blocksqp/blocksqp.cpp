@@ -114,6 +114,10 @@ namespace casadi {
       {"block_hess",
        {OT_INT,
         "Blockwise Hessian approximation?"}},
+      {"block_eval",
+       {OT_BOOL,
+        "Evaluate the gradient, Jacobian and exact Hessian block by block, "
+        "with the blocks evaluated concurrently [default: false]"}},
       {"hess_scaling",
        {OT_INT,
         "Scaling strategy for Hessian approximation"}},
@@ -251,6 +255,7 @@ namespace casadi {
     warmstart_ = false;
     max_it_qp_ = 5000;
     block_hess_ = true;
+    block_eval_ = false;
     hess_scaling_ = 2;
     fallback_scaling_ = 4;
     max_time_qp_ = 10000.0;
@@ -332,6 +337,8 @@ namespace casadi {
         max_it_qp_ = op.second;
       } else if (op.first=="block_hess") {
         block_hess_ = op.second;
+      } else if (op.first=="block_eval") {
+        block_eval_ = op.second;
       } else if (op.first=="hess_scaling") {
         hess_scaling_ = op.second;
       } else if (op.first=="fallback_scaling") {
@@ -467,9 +474,6 @@ namespace casadi {
 
     // Setup NLP functions
     create_function("nlp_fg", {"x", "p"}, {"f", "g"});
-    Function gf_jg = create_function("nlp_gf_jg", {"x", "p"},
-                                     {"f", "g", "grad:f:x", "jac:g:x"});
-    Asp_ = gf_jg.sparsity_out("jac_g_x");
 
     if (!block_hess_) {
       // No block-structured Hessian
@@ -518,8 +522,18 @@ namespace casadi {
       nnz_H_ += dim_[i]*dim_[i];
     }
 
-    create_function("nlp_hess_l", {"x", "p", "lam:f", "lam:g"},
-                    {"triu:hess:gamma:x:x"}, {{"gamma", {"f", "g"}}});
+    if (block_eval_ && nblocks_>1) {
+      // Derivatives of the blocks are independent
+      create_block_function("nlp_gf_jg", {"x", "p"},
+                            {"f", "g", "grad:f:x", "jac:g:x"}, "x", blocks_);
+      create_block_function("nlp_hess_l", {"x", "p", "lam:f", "lam:g"},
+                            {"triu:hess:gamma:x:x"}, "x", blocks_, {{"gamma", {"f", "g"}}});
+    } else {
+      create_function("nlp_gf_jg", {"x", "p"}, {"f", "g", "grad:f:x", "jac:g:x"});
+      create_function("nlp_hess_l", {"x", "p", "lam:f", "lam:g"},
+                      {"triu:hess:gamma:x:x"}, {{"gamma", {"f", "g"}}});
+    }
+    Asp_ = get_function("nlp_gf_jg").sparsity_out(3);
     exact_hess_lag_sp_ = get_function("nlp_hess_l").sparsity_out(0);
 
     if (verbose_) casadi_message(str(nblocks_) + " blocks of max size " + str(max_size) + ".");
@@ -354,6 +354,7 @@ namespace casadi {
     bool warmstart_; // Use warmstarting
     bool qp_init_;
     bool block_hess_;  // Blockwise Hessian approximation?
+    bool block_eval_;  // Evaluate the derivatives block by block?
     casadi_int hess_scaling_;// Scaling strategy for Hessian approximation
     casadi_int fallback_scaling_;  // If indefinite update is used, the type of fallback strategy
     double max_time_qp_;  // Maximum number of time in seconds per QP solve per SQP iteration
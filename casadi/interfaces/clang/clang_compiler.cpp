@@ -28,6 +28,14 @@
 #include "casadi/core/casadi_misc.hpp"
 #include "casadi/core/casadi_meta.hpp"
 #include <fstream>
+#include <map>
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
 
 // To be able to get the plugin path
 #ifdef _WIN32 // also for 64-bit
@@ -72,6 +80,32 @@ namespace casadi {
     if (context_) delete context_; // NOLINT(readability-delete-null-pointer)
   }
 
+  /* Process-wide state shared by all instances: the include paths, which are
+   * read from file once, and the precompiled headers, one per set of frontend flags
+   */
+  struct ClangShared {
+    std::string jit_include;
+    std::vector<std::pair<std::string, bool> > system_include, csystem_include,
+      cxxsystem_include;
+    // Precompiled headers, protected by mtx
+    std::map<std::string, std::string> pch;
+#ifdef CASADI_WITH_THREAD
+    std::mutex mtx;
+#endif // CASADI_WITH_THREAD
+    ClangShared();
+    ~ClangShared() {
+      for (auto&& e : pch) remove(e.second.c_str());
+    }
+  };
+
+  static ClangShared& clang_shared() {
+    static ClangShared shared;
+    return shared;
+  }
+
+  // Headers included by generated code, precompiled if requested
+  static const char* clang_pch_includes[] = {"math.h", "string.h", "stdio.h", "stdlib.h"};
+
   const Options ClangCompiler::options_
   = {{&ImporterInternal::options_},
      {{"include_path",
@@ -80,7 +114,19 @@ namespace casadi {
         "The include directory shipped with CasADi will be automatically appended."}},
       {"flags",
        {OT_STRINGVECTOR,
-        "Compile flags for the JIT compiler. Default: None"}}
+        "Compile flags for the JIT compiler. Default: None"}},
+      {"optimization_level",
+       {OT_INT,
+        "Optimization level, as for -O, used by both the frontend and the code generator. "
+        "Default: 0"}},
+      {"target_cpu",
+       {OT_STRING,
+        "CPU to generate code for, 'native' for the host CPU and its features "
+        "(as for -march=native). Default: generic"}},
+      {"precompiled_headers",
+       {OT_BOOL,
+        "Precompile the standard headers included by generated code once per process "
+        "and set of flags, instead of parsing them for every function. Default: false"}}
      }
   };
 
@@ -88,24 +134,106 @@ namespace casadi {
     // Base class
     ImporterInternal::init(opts);
 
+    // Default options
+    optimization_level_ = 0;
+    precompiled_headers_ = false;
+
     // Read options
     for (auto&& op : opts) {
       if (op.first=="include_path") {
         include_path_ = op.second.to_string();
       } else if (op.first=="flags") {
         flags_ = op.second;
+      } else if (op.first=="optimization_level") {
+        optimization_level_ = op.second;
+      } else if (op.first=="target_cpu") {
+        target_cpu_ = op.second.to_string();
+      } else if (op.first=="precompiled_headers") {
+        precompiled_headers_ = op.second;
+      }
+    }
+    casadi_assert(optimization_level_>=0 && optimization_level_<=3,
+      "Option 'optimization_level' must be in 0..3");
+
+    // Target CPU and features
+    std::string cpu = target_cpu_;
+    std::vector<std::string> features;
+    if (cpu=="native") {
+      cpu = llvm::sys::getHostCPUName().str();
+#if LLVM_VERSION_MAJOR >= 19
+      llvm::StringMap<bool> host_features = llvm::sys::getHostCPUFeatures();
+#else
+      llvm::StringMap<bool> host_features;
+      llvm::sys::getHostCPUFeatures(host_features);
+#endif
+      for (auto&& f : host_features) {
+        features.push_back((f.second ? "+" : "-") + f.first().str());
       }
     }
 
-    // Arguments to pass to the clang frontend
-    std::vector<const char *> args(1, name_.c_str());
-    for (auto&& f : flags_) {
-      args.push_back(f.c_str());
+    // Frontend flags
+    std::vector<std::string> flags = flags_;
+    flags.push_back("-O" + str(optimization_level_));
+    if (!cpu.empty()) {
+      flags.push_back("-target-cpu");
+      flags.push_back(cpu);
+    }
+    for (auto&& f : features) {
+      flags.push_back("-target-feature");
+      flags.push_back(f);
     }
 
-    // Create the compiler instance
-    clang::CompilerInstance compInst;
+    // Use precompiled standard headers
+    if (precompiled_headers_) {
+      std::string pch = precompiled_header(flags);
+      flags.push_back("-include-pch");
+      flags.push_back(pch);
+    }
 
+    // Create an LLVM context (NOTE: should use a static context instead?)
+    context_ = new llvm::LLVMContext();
+
+    // Create an action and make the compiler instance carry it out
+    std::vector<std::string> args(1, name_);
+    args.insert(args.end(), flags.begin(), flags.end());
+    act_ = new clang::EmitLLVMOnlyAction(context_);
+    execute(args, *act_);
+
+    // Grab the module built by the EmitLLVMOnlyAction
+    #if LLVM_VERSION_MAJOR>=4 || (LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR>=5)
+    std::unique_ptr<llvm::Module> module = act_->takeModule();
+    module_ = module.get();
+    #else
+    llvm::Module* module = act_->takeModule();
+    module_ = module;
+    #endif
+
+    // Code generator optimization level
+#if LLVM_VERSION_MAJOR >= 18
+    llvm::CodeGenOptLevel opt_level[] = {llvm::CodeGenOptLevel::None,
+      llvm::CodeGenOptLevel::Less, llvm::CodeGenOptLevel::Default,
+      llvm::CodeGenOptLevel::Aggressive};
+#else
+    llvm::CodeGenOpt::Level opt_level[] = {llvm::CodeGenOpt::None,
+      llvm::CodeGenOpt::Less, llvm::CodeGenOpt::Default, llvm::CodeGenOpt::Aggressive};
+#endif
+
+    // Create the JIT.  This takes ownership of the module.
+    std::string ErrStr;
+    llvm::EngineBuilder builder(std::move(module));
+    builder.setEngineKind(llvm::EngineKind::JIT).setErrorStr(&ErrStr)
+      .setOptLevel(opt_level[optimization_level_]);
+    if (!cpu.empty()) builder.setMCPU(cpu);
+    if (!features.empty()) builder.setMAttrs(features);
+    executionEngine_ = builder.create();
+    if (!executionEngine_) {
+      casadi_error("Could not create ExecutionEngine: " + ErrStr);
+    }
+
+    executionEngine_->finalizeObject();
+  }
+
+  ClangShared::ClangShared() {
     // A symbol in the DLL
     void *addr = reinterpret_cast<void*>(&casadi_register_importer_clang);
 
@@ -131,19 +259,31 @@ namespace casadi {
     jit_include = jit_include.substr(0, jit_include.find_last_of('/'));
 #endif // _WIN32
     jit_include += filesep() + "casadi" + filesep() + "jit";
+    this->jit_include = jit_include;
 
-#if 0
-    // Initialize target info with the default triple for our platform.
-    auto targetoptions = std::make_shared<clang::Taroptions>();
-    targetoptions->Triple = llvm::sys::getDefaultTargetTriple();
-    clang::TargetInfo *targetInfo =
-      clang::TargetInfo::CreateTargetInfo(compInst.get_diagnostics(), targetoptions);
-    compInst.setTarget(targetInfo);
-#endif
+    // Read the system includes (C or C++, C only, C++ only)
+    system_include = ClangCompiler::getIncludes("system_includes.txt", jit_include);
+    csystem_include = ClangCompiler::getIncludes("csystem_includes.txt", jit_include);
+    cxxsystem_include = ClangCompiler::getIncludes("cxxsystem_includes.txt", jit_include);
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+  }
+
+  void ClangCompiler::execute(const std::vector<std::string>& args,
+      clang::FrontendAction& act) {
+    const ClangShared& shared = clang_shared();
+
+    // Arguments to pass to the clang frontend
+    std::vector<const char *> argv;
+    for (auto&& a : args) argv.push_back(a.c_str());
+
+    // Create the compiler instance
+    clang::CompilerInstance compInst;
 
     // The compiler invocation needs a DiagnosticsEngine so it can report problems
     clang::DiagnosticOptions* diagOpts = new clang::DiagnosticOptions();
-    myerr_ = new llvm::raw_os_ostream(uerr());
+    if (!myerr_) myerr_ = new llvm::raw_os_ostream(uerr());
     clang::TextDiagnosticPrinter *diagClient = new clang::TextDiagnosticPrinter(*myerr_, diagOpts);
 
     clang::DiagnosticIDs* diagID = new clang::DiagnosticIDs();
@@ -157,10 +297,10 @@ namespace casadi {
     clang::CompilerInvocation* compInv = new clang::CompilerInvocation();
     #endif
     #if LLVM_VERSION_MAJOR >= 5
-    clang::CompilerInvocation::CreateFromArgs(*compInv, args, diags);
+    clang::CompilerInvocation::CreateFromArgs(*compInv, argv, diags);
     #else
-    clang::CompilerInvocation::CreateFromArgs(*compInv, &args[0],
-                                              &args[0] + args.size(), diags);
+    clang::CompilerInvocation::CreateFromArgs(*compInv, &argv[0],
+                                              &argv[0] + argv.size(), diags);
     #endif
     compInst.setInvocation(compInv);
 
@@ -170,29 +310,20 @@ namespace casadi {
       casadi_error("Cannot create diagnostics");
 
     // Set resource directory
-    std::string resourcedir = jit_include + filesep() + "clang" + filesep() + CLANG_VERSION_STRING;
+    std::string resourcedir = shared.jit_include + filesep() + "clang" + filesep()
+      + CLANG_VERSION_STRING;
     compInst.getHeaderSearchOpts().ResourceDir = resourcedir;
 
-    // Read the system includes (C or C++)
-    std::vector<std::pair<std::string, bool> >
-    system_include = getIncludes("system_includes.txt", jit_include);
-    for (auto i=system_include.begin(); i!=system_include.end(); ++i) {
-      compInst.getHeaderSearchOpts().AddPath(i->first,
-                                             clang::frontend::System, i->second, false);
+    // System includes
+    for (auto&& i : shared.system_include) {
+      compInst.getHeaderSearchOpts().AddPath(i.first, clang::frontend::System, i.second, false);
     }
-
-    // Read the system includes (C only)
-    system_include = getIncludes("csystem_includes.txt", jit_include);
-    for (auto i=system_include.begin(); i!=system_include.end(); ++i) {
-      compInst.getHeaderSearchOpts().AddPath(i->first,
-                                             clang::frontend::CSystem, i->second, false);
+    for (auto&& i : shared.csystem_include) {
+      compInst.getHeaderSearchOpts().AddPath(i.first, clang::frontend::CSystem, i.second, false);
     }
-
-    // Read the system includes (C++ only)
-    system_include = getIncludes("cxxsystem_includes.txt", jit_include);
-    for (auto i=system_include.begin(); i!=system_include.end(); ++i) {
-      compInst.getHeaderSearchOpts().AddPath(i->first,
-                                             clang::frontend::CXXSystem, i->second, false);
+    for (auto&& i : shared.cxxsystem_include) {
+      compInst.getHeaderSearchOpts().AddPath(i.first, clang::frontend::CXXSystem,
+        i.second, false);
     }
 
     // Search path
@@ -203,36 +334,41 @@ namespace casadi {
       compInst.getHeaderSearchOpts().AddPath(path, clang::frontend::System, false, false);
     }
 
-    // Create an LLVM context (NOTE: should use a static context instead?)
-    context_ = new llvm::LLVMContext();
-
-    // Create an action and make the compiler instance carry it out
-    act_ = new clang::EmitLLVMOnlyAction(context_);
-    if (!compInst.ExecuteAction(*act_))
+    if (!compInst.ExecuteAction(act))
       casadi_error("Cannot execute action");
+  }
 
-    // Grab the module built by the EmitLLVMOnlyAction
-    #if LLVM_VERSION_MAJOR>=4 || (LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR>=5)
-    std::unique_ptr<llvm::Module> module = act_->takeModule();
-    module_ = module.get();
-    #else
-    llvm::Module* module = act_->takeModule();
-    module_ = module;
-    #endif
-
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
-
-    // Create the JIT.  This takes ownership of the module.
-    std::string ErrStr;
-    executionEngine_ =
-      llvm::EngineBuilder(std::move(module)).setEngineKind(llvm::EngineKind::JIT)
-      .setErrorStr(&ErrStr).create();
-    if (!executionEngine_) {
-      casadi_error("Could not create ExecutionEngine: " + ErrStr);
+  std::string ClangCompiler::precompiled_header(const std::vector<std::string>& flags) {
+    // Precompiled headers are only valid for the same flags and search paths
+    std::string key = include_path_;
+    for (auto&& f : flags) key += '\0' + f;
+    ClangShared& shared = clang_shared();
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(shared.mtx);
+#endif // CASADI_WITH_THREAD
+    auto it = shared.pch.find(key);
+    if (it!=shared.pch.end()) return it->second;
+
+    // Header including the standard headers
+    std::string header = temporary_file("casadi_clang_pch", ".h");
+    {
+      std::ofstream f(header);
+      for (const char* inc : clang_pch_includes) f << "#include <" << inc << ">\n";
     }
-
-    executionEngine_->finalizeObject();
+    std::string pch = temporary_file("casadi_clang_pch", ".pch");
+    std::vector<std::string> args = {header, "-x", "c-header", "-emit-pch", "-o", pch};
+    args.insert(args.end(), flags.begin(), flags.end());
+    clang::GeneratePCHAction act;
+    try {
+      execute(args, act);
+    } catch (...) {
+      remove(header.c_str());
+      remove(pch.c_str());
+      throw;
+    }
+    remove(header.c_str());
+    shared.pch[key] = pch;
+    return pch;
   }
 
   signal_t ClangCompiler::get_function(const std::string& symname) {
@@ -38,6 +38,7 @@
 #include <clang/Driver/Tool.h>
 #include <clang/Frontend/CompilerInstance.h>
 #include <clang/Frontend/CompilerInvocation.h>
+#include <clang/Frontend/FrontendActions.h>
 #include <clang/Frontend/FrontendDiagnostic.h>
 #include <clang/Frontend/TextDiagnosticPrinter.h>
 
@@ -119,9 +120,18 @@ namespace casadi {
     static std::vector<std::pair<std::string, bool> >
       getIncludes(const std::string& file, const std::string& path);
 
+    // Run a frontend action with the given frontend arguments
+    void execute(const std::vector<std::string>& args, clang::FrontendAction& act);
+
+    // Get a precompiled header for the given frontend flags, creating it if needed
+    std::string precompiled_header(const std::vector<std::string>& flags);
+
     // Options
     std::string include_path_;
     std::vector<std::string> flags_;
+    casadi_int optimization_level_;
+    std::string target_cpu_;
+    bool precompiled_headers_;
 
   protected:
     clang::EmitLLVMOnlyAction* act_;
@@ -88,6 +88,11 @@ namespace casadi {
       {"mip_start",
        {OT_BOOL,
         "Hot start integers with x0 [Default false]."}},
+      {"persistent",
+       {OT_BOOL,
+        "Keep the loaded CPLEX problem between calls and only push changed bounds, "
+        "costs and coefficients. The problem is reloaded when the SOCP data change. "
+        "The previous solution is kept as a MIP start [Default false]."}},
       {"sos_groups",
        {OT_INTVECTORVECTOR,
         "Definition of SOS groups by indices."}},
@@ -117,6 +122,7 @@ namespace casadi {
     dep_check_ = 0;
     warm_start_ = false;
     mip_start_ = false;
+    persistent_ = false;
 
     std::vector< std::vector<casadi_int> > sos_groups;
     std::vector< std::vector<double> > sos_weights;
@@ -140,6 +146,8 @@ namespace casadi {
         warm_start_ = op.second;
       } else if (op.first=="mip_start") {
         mip_start_ = op.second;
+      } else if (op.first=="persistent") {
+        persistent_ = op.second;
       } else if (op.first=="sos_groups") {
         sos_groups = op.second.to_int_vector_vector();
       } else if (op.first=="sos_weights") {
@@ -350,6 +358,9 @@ namespace casadi {
     copy_vector(sm.map_Q.sparsity().colind(), m->socp_colind);
     copy_vector(sm.map_Q.sparsity().row(), m->socp_row);
 
+    m->loaded = false;
+    m->lp_reused = false;
+
     m->add_stat("preprocessing");
     m->add_stat("solver");
     m->add_stat("postprocessing");
@@ -357,6 +368,144 @@ namespace casadi {
   }
 
 
+  // Do nonzeros match the data a problem was loaded with, an empty vector if absent
+  inline bool same_data(const std::vector<double>& v, const double* x, casadi_int n) {
+    if (!x) return v.empty();
+    return v.size()==n && std::equal(v.begin(), v.end(), x);
+  }
+
+  // Copy nonzeros, an empty vector if absent
+  inline std::vector<double> copy_data(const double* x, casadi_int n) {
+    return x ? std::vector<double>(x, x+n) : std::vector<double>();
+  }
+
+  void CplexInterface::cache_lp(CplexMemory* m, const double** arg, const double* g,
+      const double* lbx, const double* ubx, const double* H, const double* A) const {
+    m->lp_g.assign(g, g+nx_);
+    m->lp_lbx.assign(lbx, lbx+nx_);
+    m->lp_ubx.assign(ubx, ubx+nx_);
+    m->lp_sense = m->sense;
+    m->lp_rhs = m->rhs;
+    m->lp_rngval = m->rngval;
+    m->lp_h.assign(H, H+nnz_in(CONIC_H));
+    m->lp_a.assign(A, A+nnz_in(CONIC_A));
+    m->lp_p = copy_data(arg[CONIC_P], nnz_in(CONIC_P));
+    m->lp_q = copy_data(arg[CONIC_Q], nnz_in(CONIC_Q));
+  }
+
+  bool CplexInterface::update_lp(CplexMemory* m, const double** arg, const double* g,
+      const double* lbx, const double* ubx, const double* H, const double* A) const {
+    // Changed SOCP data need a reload
+    if (!same_data(m->lp_p, arg[CONIC_P], nnz_in(CONIC_P))) return false;
+    if (!same_data(m->lp_q, arg[CONIC_Q], nnz_in(CONIC_Q))) return false;
+
+    // Linear cost
+    m->chg_ind.clear();
+    m->chg_val.clear();
+    for (casadi_int i=0; i<nx_; ++i) {
+      if (g[i]==m->lp_g[i]) continue;
+      m->chg_ind.push_back(i);
+      m->chg_val.push_back(g[i]);
+      m->lp_g[i] = g[i];
+    }
+    if (!m->chg_ind.empty()) {
+      if (CPXXchgobj(m->env, m->lp, m->chg_ind.size(), get_ptr(m->chg_ind),
+          get_ptr(m->chg_val))) {
+        casadi_error("CPXXchgobj failed");
+      }
+    }
+
+    // Bounds on the variables
+    m->chg_ind.clear();
+    m->chg_lu.clear();
+    m->chg_val.clear();
+    for (casadi_int i=0; i<nx_; ++i) {
+      if (lbx[i]!=m->lp_lbx[i]) {
+        m->chg_ind.push_back(i);
+        m->chg_lu.push_back('L');
+        m->chg_val.push_back(lbx[i]);
+        m->lp_lbx[i] = lbx[i];
+      }
+      if (ubx[i]!=m->lp_ubx[i]) {
+        m->chg_ind.push_back(i);
+        m->chg_lu.push_back('U');
+        m->chg_val.push_back(ubx[i]);
+        m->lp_ubx[i] = ubx[i];
+      }
+    }
+    if (!m->chg_ind.empty()) {
+      if (CPXXchgbds(m->env, m->lp, m->chg_ind.size(), get_ptr(m->chg_ind),
+          get_ptr(m->chg_lu), get_ptr(m->chg_val))) {
+        casadi_error("CPXXchgbds failed");
+      }
+    }
+
+    // Senses, right-hand-sides and ranges of the linear constraints
+    m->chg_ind.clear();
+    for (casadi_int i=0; i<na_; ++i) {
+      if (m->sense[i]==m->lp_sense[i] && m->rhs[i]==m->lp_rhs[i]
+          && m->rngval[i]==m->lp_rngval[i]) continue;
+      m->chg_ind.push_back(i);
+      m->lp_sense[i] = m->sense[i];
+      m->lp_rhs[i] = m->rhs[i];
+      m->lp_rngval[i] = m->rngval[i];
+    }
+    if (!m->chg_ind.empty()) {
+      m->chg_lu.resize(m->chg_ind.size());
+      m->chg_val.resize(m->chg_ind.size());
+      for (casadi_int k=0; k<m->chg_ind.size(); ++k) m->chg_lu[k] = m->sense[m->chg_ind[k]];
+      if (CPXXchgsense(m->env, m->lp, m->chg_ind.size(), get_ptr(m->chg_ind),
+          get_ptr(m->chg_lu))) {
+        casadi_error("CPXXchgsense failed");
+      }
+      for (casadi_int k=0; k<m->chg_ind.size(); ++k) m->chg_val[k] = m->rhs[m->chg_ind[k]];
+      if (CPXXchgrhs(m->env, m->lp, m->chg_ind.size(), get_ptr(m->chg_ind),
+          get_ptr(m->chg_val))) {
+        casadi_error("CPXXchgrhs failed");
+      }
+      for (casadi_int k=0; k<m->chg_ind.size(); ++k) m->chg_val[k] = m->rngval[m->chg_ind[k]];
+      if (CPXXchgrngval(m->env, m->lp, m->chg_ind.size(), get_ptr(m->chg_ind),
+          get_ptr(m->chg_val))) {
+        casadi_error("CPXXchgrngval failed");
+      }
+    }
+
+    // Coefficients of A
+    m->chg_ind.clear();
+    m->chg_col.clear();
+    m->chg_val.clear();
+    const casadi_int *A_colind=A_.colind(), *A_row=A_.row();
+    for (casadi_int c=0; c<A_.size2(); ++c) {
+      for (casadi_int k=A_colind[c]; k<A_colind[c+1]; ++k) {
+        if (A[k]==m->lp_a[k]) continue;
+        m->chg_ind.push_back(A_row[k]);
+        m->chg_col.push_back(c);
+        m->chg_val.push_back(A[k]);
+        m->lp_a[k] = A[k];
+      }
+    }
+    if (!m->chg_ind.empty()) {
+      if (CPXXchgcoeflist(m->env, m->lp, m->chg_ind.size(), get_ptr(m->chg_ind),
+          get_ptr(m->chg_col), get_ptr(m->chg_val))) {
+        casadi_error("CPXXchgcoeflist failed");
+      }
+    }
+
+    // Coefficients of H, symmetric pairs are changed together
+    const casadi_int *H_colind=H_.colind(), *H_row=H_.row();
+    for (casadi_int c=0; c<H_.size2(); ++c) {
+      for (casadi_int k=H_colind[c]; k<H_colind[c+1]; ++k) {
+        if (H[k]==m->lp_h[k]) continue;
+        m->lp_h[k] = H[k];
+        if (H_row[k]>c) continue;
+        if (CPXXchgqpcoef(m->env, m->lp, H_row[k], c, H[k])) {
+          casadi_error("CPXXchgqpcoef failed");
+        }
+      }
+    }
+    return true;
+  }
+
   int CplexInterface::
   solve(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
     auto m = static_cast<CplexMemory*>(mem);
@@ -422,109 +571,119 @@ namespace casadi {
       }
     }
 
-    // Copying objective, constraints, and bounds.
-    const CPXNNZ* matbeg = get_ptr(m->a_colind);
-    const CPXDIM* matind = get_ptr(m->a_row);
-
-    const double* matval = A;
-    const double* obj = g;
-    const double* lb = lbx;
-    const double* ub = ubx;
-    if (CPXXcopylp(m->env, m->lp, nx_, na_, m->objsen, obj, get_ptr(m->rhs), get_ptr(m->sense),
-                  matbeg, get_ptr(m->matcnt), matind, matval, lb, ub, get_ptr(m->rngval))) {
-      casadi_error("CPXXcopylp failed");
-    }
+    // Update the problem of the previous call in place, if possible
+    m->lp_reused = m->loaded && update_lp(m, arg, g, lbx, ubx, H, A);
+    if (!m->lp_reused) {
+      // Copying objective, constraints, and bounds.
+      const CPXNNZ* matbeg = get_ptr(m->a_colind);
+      const CPXDIM* matind = get_ptr(m->a_row);
+
+      const double* matval = A;
+      const double* obj = g;
+      const double* lb = lbx;
+      const double* ub = ubx;
+      if (CPXXcopylp(m->env, m->lp, nx_, na_, m->objsen, obj, get_ptr(m->rhs), get_ptr(m->sense),
+                    matbeg, get_ptr(m->matcnt), matind, matval, lb, ub, get_ptr(m->rngval))) {
+        casadi_error("CPXXcopylp failed");
+      }
 
 
-    // Add SOS constraints when applicable
-    if (!sos_ind_.empty()) {
-      if (CPXXaddsos(m->env, m->lp,
-          sos_beg_.size()-1, sos_ind_.size(),
-          get_ptr(sos_types_),
-          get_ptr(sos_beg_), get_ptr(sos_ind_), get_ptr(sos_weights_), nullptr)) {
-        casadi_error("CPXXaddsos failed");
+      // Add SOS constraints when applicable
+      if (!sos_ind_.empty()) {
+        if (CPXXaddsos(m->env, m->lp,
+            sos_beg_.size()-1, sos_ind_.size(),
+            get_ptr(sos_types_),
+            get_ptr(sos_beg_), get_ptr(sos_ind_), get_ptr(sos_weights_), nullptr)) {
+          casadi_error("CPXXaddsos failed");
+        }
       }
-    }
 
-    if (nnz_in(CONIC_H) > 0) {
-      // Preparing coefficient matrix Q
-      const CPXNNZ* qmatbeg = get_ptr(m->h_colind);
-      const CPXDIM* qmatind = get_ptr(m->h_row);
-      const double* qmatval = H;
-      if (CPXXcopyquad(m->env, m->lp, qmatbeg, get_ptr(m->qmatcnt), qmatind, qmatval)) {
-        casadi_error("CPXXcopyquad failed");
+      if (nnz_in(CONIC_H) > 0) {
+        // Preparing coefficient matrix Q
+        const CPXNNZ* qmatbeg = get_ptr(m->h_colind);
+        const CPXDIM* qmatind = get_ptr(m->h_row);
+        const double* qmatval = H;
+        if (CPXXcopyquad(m->env, m->lp, qmatbeg, get_ptr(m->qmatcnt), qmatind, qmatval)) {
+          casadi_error("CPXXcopyquad failed");
+        }
       }
-    }
 
-    // =================
-    // BEGIN SOCP BLOCK
-    // =================
+      // =================
+      // BEGIN SOCP BLOCK
+      // =================
 
-    // Prepare lower bounds for helper variables for SOCP
-    casadi_int j=0;
-    for (casadi_int i=0;i<sm.r.size()-1;++i) {
-      for (casadi_int k=0;k<sm.r[i+1]-sm.r[i]-1;++k) {
-        m->socp_lbx[j++] = -inf;
+      // Prepare lower bounds for helper variables for SOCP
+      casadi_int j=0;
+      for (casadi_int i=0;i<sm.r.size()-1;++i) {
+        for (casadi_int k=0;k<sm.r[i+1]-sm.r[i]-1;++k) {
+          m->socp_lbx[j++] = -inf;
+        }
+        m->socp_lbx[j++] = 0;
       }
-      m->socp_lbx[j++] = 0;
-    }
-
-    // Add helper variables for SOCP
-    if (CPXXnewcols(m->env, m->lp, sm.r.back(), nullptr,
-        get_ptr(m->socp_lbx), nullptr, nullptr, nullptr)) {
-      casadi_error("CPXXnewcols failed");
-    }
 
-    // SOCP helper constraints
-    const Sparsity& sp = sm.map_Q.sparsity();
-    const casadi_int* colind = sp.colind();
-    const casadi_int* row = sp.row();
-    const casadi_int* data = sm.map_Q.ptr();
+      // Add helper variables for SOCP
+      if (CPXXnewcols(m->env, m->lp, sm.r.back(), nullptr,
+          get_ptr(m->socp_lbx), nullptr, nullptr, nullptr)) {
+        casadi_error("CPXXnewcols failed");
+      }
 
-    const double* p = arg[CONIC_P];
-    const double* q = arg[CONIC_Q];
+      // SOCP helper constraints
+      const Sparsity& sp = sm.map_Q.sparsity();
+      const casadi_int* colind = sp.colind();
+      const casadi_int* row = sp.row();
+      const casadi_int* data = sm.map_Q.ptr();
+
+      const double* p = arg[CONIC_P];
+      const double* q = arg[CONIC_Q];
+
+      casadi_int numnz = 0;
+      // Loop over columns
+      for (casadi_int i=0; i<sp.size2(); ++i) {
+        m->socp_lbound[i] = sm.map_P[i]==-1 ? 0 : -p[sm.map_P[i]];
+        // Loop over rows
+        for (casadi_int k=colind[i]; k<colind[i+1]; ++k) {
+          casadi_int j = row[k];
+          m->socp_lval[numnz] = (q && j<nx_) ? q[data[k]] : -1;
+          numnz++;
+        }
+      }
 
-    casadi_int numnz = 0;
-    // Loop over columns
-    for (casadi_int i=0; i<sp.size2(); ++i) {
-      m->socp_lbound[i] = sm.map_P[i]==-1 ? 0 : -p[sm.map_P[i]];
-      // Loop over rows
-      for (casadi_int k=colind[i]; k<colind[i+1]; ++k) {
-        casadi_int j = row[k];
-        m->socp_lval[numnz] = (q && j<nx_) ? q[data[k]] : -1;
-        numnz++;
+      // Adding SOCP helper constraints
+      if (CPXXaddrows(m->env, m->lp, 0, sp.size2(), sp.nnz(), get_ptr(m->socp_lbound), nullptr,
+                      get_ptr(m->socp_colind), get_ptr(m->socp_row), get_ptr(m->socp_lval),
+                      nullptr, nullptr)) {
+        casadi_error("CPXXaddrows failed");
       }
-    }
 
-    // Adding SOCP helper constraints
-    if (CPXXaddrows(m->env, m->lp, 0, sp.size2(), sp.nnz(), get_ptr(m->socp_lbound), nullptr,
-                    get_ptr(m->socp_colind), get_ptr(m->socp_row), get_ptr(m->socp_lval),
-                    nullptr, nullptr)) {
-      casadi_error("CPXXaddrows failed");
-    }
+      // Loop over blocks
+      for (casadi_int i=0; i<sm.r.size()-1; ++i) {
+        casadi_int block_size = sm.r[i+1]-sm.r[i];
 
-    // Loop over blocks
-    for (casadi_int i=0; i<sm.r.size()-1; ++i) {
-      casadi_int block_size = sm.r[i+1]-sm.r[i];
+        // Indicate x'x - y^2 <= 0
+        for (casadi_int j=0;j<block_size;++j) {
+          m->socp_qind[j] = nx_ + sm.r[i] + j;
+          m->socp_qval[j] = j<block_size-1 ? 1 : -1;
+        }
 
-      // Indicate x'x - y^2 <= 0
-      for (casadi_int j=0;j<block_size;++j) {
-        m->socp_qind[j] = nx_ + sm.r[i] + j;
-        m->socp_qval[j] = j<block_size-1 ? 1 : -1;
+        if (CPXXaddqconstr(m->env, m->lp, 0, block_size,
+                            0, 'L', nullptr, nullptr,
+                            get_ptr(m->socp_qind), get_ptr(m->socp_qind), get_ptr(m->socp_qval),
+                            nullptr)) {
+          casadi_error("CPXXaddqconstr failed");
+        }
       }
 
-      if (CPXXaddqconstr(m->env, m->lp, 0, block_size,
-                          0, 'L', nullptr, nullptr,
-                          get_ptr(m->socp_qind), get_ptr(m->socp_qind), get_ptr(m->socp_qval),
-                          nullptr)) {
-        casadi_error("CPXXaddqconstr failed");
+      // =================
+      // END SOCP BLOCK
+      // =================
+
+      // Remember the data for updating the problem in place
+      if (persistent_) {
+        cache_lp(m, arg, g, lbx, ubx, H, A);
+        m->loaded = true;
       }
     }
 
-    // =================
-    // END SOCP BLOCK
-    // =================
-
     // Warm-starting if possible
     if (qp_method_ != 0 && qp_method_ != 4 && m->is_warm) {
       // TODO(Joel): Initialize slacks and dual variables of bound constraints
@@ -546,10 +705,31 @@ namespace casadi {
 
     if (mip_) {
       // Pass type of variables
-      if (CPXXcopyctype(m->env, m->lp, &ctype_[0])) {
+      if (!m->lp_reused && CPXXcopyctype(m->env, m->lp, &ctype_[0])) {
         casadi_error("CPXXcopyctype failed");
       }
 
+      if (m->lp_reused) {
+        // Replace the MIP starts of the previous call by its solution
+        int nstarts = CPXXgetnummipstarts(m->env, m->lp);
+        if (nstarts>0 && CPXXdelmipstarts(m->env, m->lp, 0, nstarts-1)) {
+          casadi_error("CPXXdelmipstarts failed");
+        }
+        const CPXNNZ beg[] = {0};
+        std::vector<int> varindices;
+        std::vector<double> values;
+        for (casadi_int i=0; i<nx_; ++i) {
+          if (discrete_.at(i) && !isnan(m->x_prev.at(i))) {
+            varindices.push_back(i);
+            values.push_back(m->x_prev[i]);
+          }
+        }
+        if (!varindices.empty() && CPXXaddmipstarts(m->env, m->lp, 1, varindices.size(),
+            &beg[0], get_ptr(varindices), get_ptr(values), nullptr, nullptr)) {
+          casadi_error("CPXXaddmipstarts failed");
+        }
+      }
+
       if (mip_start_) {
         // Add a single MIP start based on x0
         const CPXNNZ beg[] = {0};
@@ -609,6 +789,12 @@ namespace casadi {
         casadi_error("CPXXgetslack failed");
       }
 
+      // Keep the solution as a MIP start for the next call
+      if (persistent_) {
+        m->x_prev.assign(x, x+nx_);
+        if (stat==CPX_STAT_INFEASIBLE) casadi_fill(get_ptr(m->x_prev), nx_, nan);
+      }
+
       // Not a number as dual variables (not calculated with MIQP algorithm)
       casadi_fill(lam_a, na_, nan);
       casadi_fill(lam_x, nx_, nan);
@@ -718,6 +904,7 @@ namespace casadi {
     char status_string[CPXMESSAGEBUFSIZE];
     CPXXgetstatstring(m->env, m->return_status, status_string);
     stats["return_status"] = std::string(status_string);
+    stats["lp_reused"] = m->lp_reused;
 
     return stats;
   }
@@ -756,7 +943,7 @@ namespace casadi {
   }
 
   CplexInterface::CplexInterface(DeserializingStream& s) : Conic(s) {
-    s.version("CplexInterface", 1);
+    int version = s.version("CplexInterface", 1, 2);
     s.unpack("CplexInterface::opts", opts_);
     s.unpack("CplexInterface::qp_method", qp_method_);
     s.unpack("CplexInterface::dump_to_file", dump_to_file_);
@@ -764,6 +951,11 @@ namespace casadi {
     s.unpack("CplexInterface::dep_check", dep_check_);
     s.unpack("CplexInterface::warm_start", warm_start_);
     s.unpack("CplexInterface::mip_start", mip_start_);
+    if (version >= 2) {
+      s.unpack("CplexInterface::persistent", persistent_);
+    } else {
+      persistent_ = false;
+    }
     s.unpack("CplexInterface::mip", mip_);
     s.unpack("CplexInterface::ctype", ctype_);
     s.unpack("CplexInterface::sos_weights", sos_weights_);
@@ -776,7 +968,7 @@ namespace casadi {
   void CplexInterface::serialize_body(SerializingStream &s) const {
     Conic::serialize_body(s);
 
-    s.version("CplexInterface", 1);
+    s.version("CplexInterface", 2);
     s.pack("CplexInterface::opts", opts_);
     s.pack("CplexInterface::qp_method", qp_method_);
     s.pack("CplexInterface::dump_to_file", dump_to_file_);
@@ -784,6 +976,7 @@ namespace casadi {
     s.pack("CplexInterface::dep_check", dep_check_);
     s.pack("CplexInterface::warm_start", warm_start_);
     s.pack("CplexInterface::mip_start", mip_start_);
+    s.pack("CplexInterface::persistent", persistent_);
     s.pack("CplexInterface::mip", mip_);
     s.pack("CplexInterface::ctype", ctype_);
     s.pack("CplexInterface::sos_weights", sos_weights_);
@@ -85,6 +85,24 @@ namespace casadi {
 
     int return_status;
 
+    /// Has the problem been loaded, for the 'persistent' option
+    bool loaded;
+
+    /// Was the problem of the previous call reused
+    bool lp_reused;
+
+    /// Data the problem was loaded or last updated with
+    std::vector<char> lp_sense;
+    std::vector<double> lp_g, lp_lbx, lp_ubx, lp_rhs, lp_rngval, lp_h, lp_a, lp_p, lp_q;
+
+    /// Changed entries
+    std::vector<CPXDIM> chg_ind, chg_col;
+    std::vector<char> chg_lu;
+    std::vector<double> chg_val;
+
+    /// Solution of the previous call
+    std::vector<double> x_prev;
+
     /// Constructor
     CplexMemory();
 
@@ -152,6 +170,14 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /// Remember the data a persistent problem was loaded with
+    void cache_lp(CplexMemory* m, const double** arg, const double* g, const double* lbx,
+      const double* ubx, const double* H, const double* A) const;
+
+    /// Update a persistent problem in place, false if it needs to be reloaded
+    bool update_lp(CplexMemory* m, const double** arg, const double* g, const double* lbx,
+      const double* ubx, const double* H, const double* A) const;
+
     /// All CPLEX options
     Dict opts_;
 
@@ -164,6 +190,7 @@ namespace casadi {
     casadi_int dep_check_;
     bool warm_start_;
     bool mip_start_;
+    bool persistent_;
     ///@}
 
     // Are we solving a mixed-integer problem?
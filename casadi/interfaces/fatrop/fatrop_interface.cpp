@@ -0,0 +1,838 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "fatrop_interface.hpp"
+#include "casadi/core/conic_impl.hpp"
+#include <numeric>
+#include <cstring>
+
+#include <ocp/OCPAbstract.hpp>
+#include <ocp/StageOCPApplication.hpp>
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_NLPSOL_FATROP_EXPORT
+  casadi_register_nlpsol_fatrop(Nlpsol::Plugin* plugin) {
+    plugin->creator = FatropInterface::creator;
+    plugin->name = "fatrop";
+    plugin->doc = FatropInterface::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &FatropInterface::options_;
+    plugin->deserialize = &FatropInterface::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_NLPSOL_FATROP_EXPORT casadi_load_nlpsol_fatrop() {
+    Nlpsol::registerPlugin(casadi_register_nlpsol_fatrop);
+  }
+
+  FatropInterface::FatropInterface(const std::string& name, const Function& nlp)
+    : Nlpsol(name, nlp) {
+  }
+
+  FatropInterface::~FatropInterface() {
+    clear_mem();
+  }
+
+  const Options FatropInterface::options_
+  = {{&Nlpsol::options_},
+     {{"N",
+       {OT_INT,
+        "OCP horizon"}},
+      {"nx",
+       {OT_INTVECTOR,
+        "Number of states, length N+1"}},
+      {"nu",
+       {OT_INTVECTOR,
+        "Number of controls, length N+1"}},
+      {"ng",
+       {OT_INTVECTOR,
+        "Number of non-dynamic constraints, length N+1"}},
+      {"fatrop",
+       {OT_DICT,
+        "Options to be passed to fatrop"}}
+     }
+  };
+
+  void FatropInterface::init(const Dict& opts) {
+    // Call the init method of the base class
+    Nlpsol::init(opts);
+
+    casadi_int struct_cnt=0;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="N") {
+        N_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="nx") {
+        nxs_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="nu") {
+        nus_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="ng") {
+        ngs_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="fatrop") {
+        opts_ = op.second;
+      }
+    }
+
+    casadi_assert(struct_cnt==0 || struct_cnt==4,
+      "You must either set all of N, nx, nu, ng; "
+      "or set none at all (automatic detection).");
+
+    // Objective, constraints and multipliers are recovered from the primal-dual solution
+    if (!no_nlp_grad_) {
+      calc_f_ = true;
+      calc_g_ = ng_>0;
+      calc_lam_x_ = true;
+    }
+
+    // Stage functions
+    if (oracle_.is_a("SXFunction")) {
+      init_stages<SX>(struct_cnt==0);
+    } else {
+      init_stages<MX>(struct_cnt==0);
+    }
+  }
+
+  template<typename XType>
+  void FatropInterface::init_stages(bool detect_structure) {
+    // Inline the NLP, such that stage functions only contain the expressions of their stage
+    XType x = XType::sym("x", nx_);
+    XType p = XType::sym("p", np_);
+    std::vector<XType> res;
+    oracle_.call(std::vector<XType>{x, p}, res, true);
+    XType f = res.at(NL_F), g = res.at(NL_G);
+
+    // Stage structure
+    Sparsity jac_g_sp = XType::jacobian_sparsity(g, x);
+    if (detect_structure) {
+      N_ = Conic::detect_ocp_structure(jac_g_sp, nxs_, nus_, ngs_);
+    }
+    casadi_assert(Conic::is_ocp_structure(Sparsity(nx_, nx_), jac_g_sp, nxs_, nus_, ngs_),
+      "Constraints do not have the stage structure of an optimal control problem. "
+      "Structure is: N " + str(N_) + ", nx " + str(nxs_) + ", "
+      "nu " + str(nus_) + ", ng " + str(ngs_) + ".");
+    if (verbose_) {
+      casadi_message("Using structure: N " + str(N_) + ", nx " + str(nxs_) + ", "
+        "nu " + str(nus_) + ", ng " + str(ngs_) + ".");
+    }
+
+    // Offsets of the stage variables and constraints
+    x_offset_.resize(N_+2);
+    g_offset_.resize(N_+2);
+    x_offset_[0] = g_offset_[0] = 0;
+    std::vector<casadi_int> var_stage;
+    for (casadi_int k=0; k<=N_; ++k) {
+      x_offset_[k+1] = x_offset_[k] + nxs_[k] + nus_[k];
+      g_offset_[k+1] = g_offset_[k] + (k<N_ ? nxs_[k+1] : 0) + ngs_[k];
+      var_stage.insert(var_stage.end(), nxs_[k] + nus_[k], k);
+    }
+
+    // Split the objective into a sum of terms
+    std::vector<XType> terms, stack = {f};
+    while (!stack.empty()) {
+      XType e = stack.back();
+      stack.pop_back();
+      if (e.is_op(OP_ADD)) {
+        stack.push_back(e.dep(1));
+        stack.push_back(e.dep(0));
+      } else if (e.is_op(OP_SUB)) {
+        stack.push_back(-e.dep(1));
+        stack.push_back(e.dep(0));
+      } else {
+        terms.push_back(e);
+      }
+    }
+
+    // Collect the terms per stage, terms without dependencies go to the first stage
+    std::vector<XType> fk(N_+1, 0);
+    Sparsity terms_sp = XType::jacobian_sparsity(vertcat(terms), x).T();
+    const casadi_int *terms_colind = terms_sp.colind(), *terms_row = terms_sp.row();
+    for (casadi_int t=0; t<terms.size(); ++t) {
+      casadi_int k = 0;
+      for (casadi_int el=terms_colind[t]; el<terms_colind[t+1]; ++el) {
+        casadi_int s = var_stage[terms_row[el]];
+        casadi_assert(el==terms_colind[t] || s==k,
+          "Objective must be a sum of terms that each depend on a single stage, "
+          "but a term couples stages " + str(k) + " and " + str(s) + ".");
+        k = s;
+      }
+      fk[k] += terms[t];
+    }
+
+    // Coefficients of x_k+1 in the gap-closing constraints, which must be constant
+    gap_scale_.assign(ng_, 1);
+    XType jac_g = XType::jacobian(g, x);
+    for (casadi_int k=0; k<N_; ++k) {
+      Slice rows(g_offset_[k], g_offset_[k]+nxs_[k+1]);
+      XType d = diag(jac_g(rows, Slice(x_offset_[k+1], x_offset_[k+1]+nxs_[k+1])));
+      casadi_assert(!any(XType::which_depends(d, x, 1, true))
+        && (np_==0 || !any(XType::which_depends(d, p, 1, true))),
+        "Gap-closing constraints of stage " + str(k) + " must be linear in the next state.");
+      Function fd("gap_scale", {x, p}, {densify(d)});
+      DM dv = fd(std::vector<DM>{DM::zeros(nx_), DM::zeros(np_)}).at(0);
+      for (casadi_int i=0; i<nxs_[k+1]; ++i) {
+        double di = dv->at(i);
+        casadi_assert(di!=0 && std::isfinite(di),
+          "Gap-closing constraint " + str(g_offset_[k]+i) + " has coefficient " + str(di)
+          + " for the next state.");
+        gap_scale_[g_offset_[k]+i] = di;
+      }
+    }
+
+    // Value, first and second order derivative functions per stage
+    XType lam_f = XType::sym("lam_f");
+    for (casadi_int k=0; k<=N_; ++k) {
+      Slice cols(x_offset_[k], x_offset_[k+1]), rows(g_offset_[k], g_offset_[k+1]);
+      XType gk = g(rows);
+      XType grad_fk = densify(XType::jacobian(fk[k], x)(0, cols)).T();
+      XType jac_gk = densify(jac_g(rows, cols));
+      XType lam_g = XType::sym("lam_g", gk.size1());
+      XType grad_lk;
+      XType hess_lk = XType::hessian(lam_f*fk[k] + dot(lam_g, gk), x, grad_lk);
+      create_function("nlp_stage_" + str(k), {x, p}, {fk[k], gk},
+                      {"x", "p"}, {"f", "g"});
+      create_function("nlp_stage_jac_" + str(k), {x, p}, {fk[k], grad_fk, gk, jac_gk},
+                      {"x", "p"}, {"f", "grad_f", "g", "jac_g"});
+      create_function("nlp_stage_hess_" + str(k), {x, p, lam_f, lam_g},
+                      {densify(grad_lk(cols)), densify(hess_lk(cols, cols))},
+                      {"x", "p", "lam_f", "lam_g"}, {"grad_l", "hess_l"});
+    }
+  }
+
+  int FatropInterface::init_mem(void* mem) const {
+    if (Nlpsol::init_mem(mem)) return 1;
+    auto m = static_cast<FatropMemory*>(mem);
+
+    // Largest stage
+    casadi_int max_n = 0, max_ng = 0;
+    for (casadi_int k=0; k<=N_; ++k) {
+      max_n = std::max(max_n, x_offset_[k+1]-x_offset_[k]);
+      max_ng = std::max(max_ng, g_offset_[k+1]-g_offset_[k]);
+    }
+
+    m->xk.resize(nx_);
+    m->fk.resize(1);
+    m->grad_fk.resize(max_n);
+    m->gk.resize(max_ng);
+    m->jac_gk.resize(max_ng*max_n);
+    m->hess_lk.resize(max_n*max_n);
+    m->grad_lk.resize(max_n);
+    m->lam_gk.resize(max_ng);
+    m->tmp.resize((max_n+1)*(max_ng+max_n));
+    m->jac_arg.resize(max_n);
+    m->jac_stage = -1;
+
+    m->g_eq.resize(ng_);
+    m->g_ineq.resize(ng_);
+    m->x_eq.resize(nx_);
+    m->x_ineq.resize(nx_);
+    m->g_eq_idx.resize(N_+2);
+    m->g_ineq_idx.resize(N_+2);
+    m->x_eq_idx.resize(N_+2);
+    m->x_ineq_idx.resize(N_+2);
+    return 0;
+  }
+
+  Dict FatropInterface::get_stats(void* mem) const {
+    Dict stats = Nlpsol::get_stats(mem);
+    auto m = static_cast<FatropMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    return stats;
+  }
+
+  FatropMemory::FatropMemory() {
+    return_status = "";
+  }
+
+  FatropMemory::~FatropMemory() {
+  }
+
+  casadi_int FatropInterface::n_eq(FatropMemory* m, casadi_int k) const {
+    return m->g_eq_idx[k+1]-m->g_eq_idx[k] + m->x_eq_idx[k+1]-m->x_eq_idx[k];
+  }
+
+  casadi_int FatropInterface::n_ineq(FatropMemory* m, casadi_int k) const {
+    return m->g_ineq_idx[k+1]-m->g_ineq_idx[k] + m->x_ineq_idx[k+1]-m->x_ineq_idx[k];
+  }
+
+  void FatropInterface::set_stage(FatropMemory* m, casadi_int k, const double* states_k,
+      const double* inputs_k) const {
+    double* xk = get_ptr(m->xk) + x_offset_[k];
+    casadi_copy(states_k, nxs_[k], xk);
+    casadi_copy(inputs_k, nus_[k], xk + nxs_[k]);
+    // The gap-closing constraints are linear in the next state
+    if (k<N_) casadi_clear(xk + nxs_[k] + nus_[k], nxs_[k+1]);
+  }
+
+  int FatropInterface::calc_stage(FatropMemory* m, casadi_int k) const {
+    m->arg[0] = get_ptr(m->xk);
+    m->arg[1] = m->d_nlp.p;
+    m->res[0] = get_ptr(m->fk);
+    m->res[1] = get_ptr(m->gk);
+    m->jac_stage = -1;
+    return calc_function(m, "nlp_stage_" + str(k));
+  }
+
+  int FatropInterface::calc_stage_jac(FatropMemory* m, casadi_int k) const {
+    // Reuse if the variables of the stage are unchanged
+    const double* zk = get_ptr(m->xk) + x_offset_[k];
+    casadi_int n = x_offset_[k+1] - x_offset_[k];
+    if (m->jac_stage==k && std::equal(zk, zk + n, m->jac_arg.begin())) return 0;
+    m->arg[0] = get_ptr(m->xk);
+    m->arg[1] = m->d_nlp.p;
+    m->res[0] = get_ptr(m->fk);
+    m->res[1] = get_ptr(m->grad_fk);
+    m->res[2] = get_ptr(m->gk);
+    m->res[3] = get_ptr(m->jac_gk);
+    m->jac_stage = -1;
+    if (calc_function(m, "nlp_stage_jac_" + str(k))) return 1;
+    std::copy(zk, zk + n, m->jac_arg.begin());
+    m->jac_stage = k;
+    return 0;
+  }
+
+  int FatropInterface::calc_stage_hess(FatropMemory* m, casadi_int k, double objective_scale,
+      const double* lam_dyn, const double* lam_eq, const double* lam_ineq) const {
+    casadi_int i, c;
+    // Multipliers of the stage constraints
+    double* lam_gk = get_ptr(m->lam_gk);
+    casadi_clear(lam_gk, g_offset_[k+1] - g_offset_[k]);
+    if (k<N_) {
+      for (i=0; i<nxs_[k+1]; ++i) lam_gk[i] = -lam_dyn[i]/gap_scale_[g_offset_[k]+i];
+    }
+    c = 0;
+    for (i=m->g_eq_idx[k]; i<m->g_eq_idx[k+1]; ++i) lam_gk[m->g_eq[i]-g_offset_[k]] = lam_eq[c++];
+    c = 0;
+    for (i=m->g_ineq_idx[k]; i<m->g_ineq_idx[k+1]; ++i) {
+      lam_gk[m->g_ineq[i]-g_offset_[k]] = lam_ineq[c++];
+    }
+    m->arg[0] = get_ptr(m->xk);
+    m->arg[1] = m->d_nlp.p;
+    m->arg[2] = &objective_scale;
+    m->arg[3] = lam_gk;
+    m->res[0] = get_ptr(m->grad_lk);
+    m->res[1] = get_ptr(m->hess_lk);
+    if (calc_function(m, "nlp_stage_hess_" + str(k))) return 1;
+    // Variable bounds
+    c = m->g_eq_idx[k+1] - m->g_eq_idx[k];
+    for (i=m->x_eq_idx[k]; i<m->x_eq_idx[k+1]; ++i) {
+      m->grad_lk[m->x_eq[i]-x_offset_[k]] += lam_eq[c++];
+    }
+    c = m->g_ineq_idx[k+1] - m->g_ineq_idx[k];
+    for (i=m->x_ineq_idx[k]; i<m->x_ineq_idx[k+1]; ++i) {
+      m->grad_lk[m->x_ineq[i]-x_offset_[k]] += lam_ineq[c++];
+    }
+    return 0;
+  }
+
+// Stage variable in CasADi order [x; u] corresponding to Fatrop order [u; x]
+inline casadi_int fatrop_var(casadi_int j, casadi_int nx, casadi_int nu) {
+  return j<nu ? nx+j : j-nu;
+}
+
+class CasadiStructuredNLP : public fatrop::OCPAbstract {
+  public:
+    const FatropInterface& solver;
+    FatropMemory* m;
+    CasadiStructuredNLP(const FatropInterface& solv, FatropMemory* mem) : solver(solv), m(mem) {
+    }
+  /// @brief number of states for time step k
+  /// @param k: time step
+  fatrop_int get_nxk(const fatrop_int k) const override {
+    if (k==solver.nxs_.size()) return solver.nxs_[k-1];
+    return solver.nxs_[k];
+  }
+  /// @brief number of inputs for time step k
+  /// @param k: time step
+  fatrop_int get_nuk(const fatrop_int k) const override {
+    return solver.nus_[k];
+  };
+  /// @brief number of equality constraints for time step k
+  /// @param k: time step
+  fatrop_int get_ngk(const fatrop_int k) const override {
+    return solver.n_eq(m, k);
+  };
+  /// @brief  number of stage parameters for time step k
+  /// @param k: time step
+  fatrop_int get_n_stage_params_k(const fatrop_int k) const override { return 0;}
+  /// @brief  number of global parameters
+  fatrop_int get_n_global_params() const override { return 0;}
+  /// @brief default stage parameters for time step k
+  /// @param stage_params: pointer to array of size n_stage_params_k
+  /// @param k: time step
+  fatrop_int get_default_stage_paramsk(double *stage_params, const fatrop_int k) const override {
+    return 0;
+  }
+  /// @brief default global parameters
+  /// @param global_params: pointer to array of size n_global_params
+  fatrop_int get_default_global_params(double *global_params) const override{ return 0; }
+  /// @brief number of inequality constraints for time step k
+  /// @param k: time step
+  virtual fatrop_int get_ng_ineq_k(const fatrop_int k) const {
+    return solver.n_ineq(m, k);
+  }
+  /// @brief horizon length
+  fatrop_int get_horizon_length() const override {
+    return solver.N_+1;
+  }
+  /// @brief  discretized dynamics
+  /// it evaluates the vertical concatenation of A_k^T, B_k^T, and b_k^T from the linearized dynamics x_{k+1} = A_k x_k + B_k u_k + b_k.
+  /// The matrix is in column major format.
+  /// @param states_kp1: pointer to nx_{k+1}-array states of time step k+1
+  /// @param inputs_k: pointer to array inputs of time step k
+  /// @param states_k: pointer to array states of time step k
+  /// @param stage_params_k: pointer to array stage parameters of time step k
+  /// @param global_params: pointer to array global parameters
+  /// @param res: pointer to (nu+nx+1 x nu+nx)-matrix
+  /// @param k: time step
+  fatrop_int eval_BAbtk(
+      const double *states_kp1,
+      const double *inputs_k,
+      const double *states_k,
+      const double *stage_params_k,
+      const double *global_params,
+      MAT *res,
+      const fatrop_int k) override {
+    casadi_int nx = solver.nxs_[k], nu = solver.nus_[k], nxp = solver.nxs_[k+1];
+    casadi_int n = nx+nu, nr = solver.g_offset_[k+1]-solver.g_offset_[k];
+    const double* d = get_ptr(solver.gap_scale_) + solver.g_offset_[k];
+    const double* lbg = m->d_nlp.lbz + solver.nx_ + solver.g_offset_[k];
+    solver.set_stage(m, k, states_k, inputs_k);
+    if (solver.calc_stage_jac(m, k)) return 1;
+    // x_k+1 = (lbg - r_k(x_k, u_k))/d
+    double* t = get_ptr(m->tmp);
+    for (casadi_int i=0; i<nxp; ++i) {
+      for (casadi_int j=0; j<n; ++j) {
+        t[j + i*(n+1)] = -m->jac_gk[i + fatrop_var(j, nx, nu)*nr]/d[i];
+      }
+      t[n + i*(n+1)] = (lbg[i] - m->gk[i])/d[i] - (states_kp1 ? states_kp1[i] : 0);
+    }
+    blasfeo_pack_dmat(n+1, nxp, t, n+1, res, 0, 0);
+    return 0;
+  }
+  /// @brief  stagewise Lagrangian Hessian
+  /// It evaluates is the vertical concatenation of (1) the Hessian of the Lagrangian to the concatenation of (u_k, x_k) (2) the first order derivative of the Lagrangian Hessian to the concatenation of (u_k, x_k).
+  /// The matrix is in column major format.
+  /// @param objective_scale: scale factor for objective function (usually 1.0)
+  /// @param inputs_k: pointer to array inputs of time step k
+  /// @param states_k: pointer to array states of time step k
+  /// @param lam_dyn_k: pointer to array dual variables for dynamics of time step k
+  /// @param lam_eq_k: pointer to array dual variables for equality constraints of time step k
+  /// @param lam_eq_ineq_k: pointer to array dual variables for inequality constraints of time step k
+  /// @param stage_params_k: pointer to array stage parameters of time step k
+  /// @param global_params: pointer to array global parameters
+  /// @param res: pointer to (nu+nx+1 x nu+nx)-matrix.
+  /// @param k
+  /// @return
+  fatrop_int eval_RSQrqtk(
+      const double *objective_scale,
+      const double *inputs_k,
+      const double *states_k,
+      const double *lam_dyn_k,
+      const double *lam_eq_k,
+      const double *lam_eq_ineq_k,
+      const double *stage_params_k,
+      const double *global_params,
+      MAT *res,
+      const fatrop_int k) override {
+    casadi_int nx = solver.nxs_[k], nu = solver.nus_[k], n = nx+nu;
+    solver.set_stage(m, k, states_k, inputs_k);
+    if (solver.calc_stage_hess(m, k, *objective_scale, lam_dyn_k, lam_eq_k, lam_eq_ineq_k)) {
+      return 1;
+    }
+    double* t = get_ptr(m->tmp);
+    for (casadi_int l=0; l<n; ++l) {
+      casadi_int cl = fatrop_var(l, nx, nu);
+      for (casadi_int j=0; j<n; ++j) {
+        t[j + l*(n+1)] = m->hess_lk[fatrop_var(j, nx, nu) + cl*n];
+      }
+      t[n + l*(n+1)] = m->grad_lk[cl];
+    }
+    blasfeo_pack_dmat(n+1, n, t, n+1, res, 0, 0);
+    return 0;
+  }
+  /// @brief stagewise equality constraints Jacobian.
+  /// It evaluates the vertical concatenation of (1) the Jacobian of the equality constraints to the concatenation of (u_k, x_k) (2) the equality constraints evaluated at u_k, x_k.
+  /// The matrix is in column major format.
+  /// @param inputs_k: pointer to array inputs of time step k
+  /// @param states_k: pointer to array states of time step k
+  /// @param stage_params_k: pointer to array stage parameters of time step k
+  /// @param global_params: pointer to array global parameters
+  /// @param res: pointer to (nu+nx+1 x ng)-matrix.
+  /// @param k: time step
+  /// @return
+  fatrop_int eval_Ggtk(
+      const double *inputs_k,
+      const double *states_k,
+      const double *stage_params_k,
+      const double *global_params,
+      MAT *res,
+      const fatrop_int k) override {
+    solver.set_stage(m, k, states_k, inputs_k);
+    if (solver.calc_stage_jac(m, k)) return 1;
+    casadi_int ng = pack_Ggt(k, m->g_eq, m->g_eq_idx, m->x_eq, m->x_eq_idx, true);
+    casadi_int n = solver.nxs_[k]+solver.nus_[k];
+    blasfeo_pack_dmat(n+1, ng, get_ptr(m->tmp), n+1, res, 0, 0);
+    return 0;
+  }
+  /// @brief stagewise inequality constraints Jacobian.
+  /// It evaluates the vertical concatenation of (1) the Jacobian of the inequality constraints to the concatenation of (u_k, x_k) (2) the inequality constraints evaluated at u_k, x_k.
+  /// The matrix is in column major format.
+  /// @param inputs_k: pointer to array inputs of time step k
+  /// @param states_k: pointer to array states of time step k
+  /// @param stage_params_k: pointer to array stage parameters of time step k
+  /// @param global_params_ko: pointer to array global parameters
+  /// @param res: pointer to (nu+nx+1 x ng_ineq)-matrix, column major format
+  /// @param k : time step
+  /// @return
+  fatrop_int eval_Ggt_ineqk(
+      const double *inputs_k,
+      const double *states_k,
+      const double *stage_params_k,
+      const double *global_params,
+      MAT *res,
+      const fatrop_int k) {
+    solver.set_stage(m, k, states_k, inputs_k);
+    if (solver.calc_stage_jac(m, k)) return 1;
+    casadi_int ng = pack_Ggt(k, m->g_ineq, m->g_ineq_idx, m->x_ineq, m->x_ineq_idx, false);
+    casadi_int n = solver.nxs_[k]+solver.nus_[k];
+    blasfeo_pack_dmat(n+1, ng, get_ptr(m->tmp), n+1, res, 0, 0);
+    return 0;
+  }
+  /// @brief the dynamics constraint violation (b_k = -x_{k+1} + f_k(u_k, x_k, p_k, p))
+  /// @param states_kp1: pointer to array states of time step k+1
+  /// @param inputs_k: pointer to array inputs of time step k
+  /// @param states_k: pointer to array states of time step k
+  /// @param stage_params_k: pointer to array stage parameters of time step k
+  /// @param global_params: pointer to array global parameters
+  /// @param res: pointer to array nx_{k+1}-vector
+  /// @param k: time step
+  /// @return
+  fatrop_int eval_bk(
+      const double *states_kp1,
+      const double *inputs_k,
+      const double *states_k,
+      const double *stage_params_k,
+      const double *global_params,
+      double *res,
+      const fatrop_int k) override {
+    const double* d = get_ptr(solver.gap_scale_) + solver.g_offset_[k];
+    const double* lbg = m->d_nlp.lbz + solver.nx_ + solver.g_offset_[k];
+    solver.set_stage(m, k, states_k, inputs_k);
+    if (solver.calc_stage(m, k)) return 1;
+    for (casadi_int i=0; i<solver.nxs_[k+1]; ++i) {
+      res[i] = (lbg[i] - m->gk[i])/d[i] - states_kp1[i];
+    }
+    return 0;
+  }
+  /// @brief the equality constraint violation (g_k = g_k(u_k, x_k, p_k, p))
+  /// @param inputs_k: pointer to array inputs of time step k
+  /// @param states_k: pointer to array states of time step k
+  /// @param stage_params_k: pointer to array stage parameters of time step k
+  /// @param global_params: pointer to array global parameters
+  /// @param res: pointer to array ng-vector
+  /// @param k: time step
+  fatrop_int eval_gk(
+      const double *states_k,
+      const double *inputs_k,
+      const double *stage_params_k,
+      const double *global_params,
+      double *res,
+      const fatrop_int k) override {
+    solver.set_stage(m, k, states_k, inputs_k);
+    if (solver.calc_stage(m, k)) return 1;
+    eval_con(k, m->g_eq, m->g_eq_idx, m->x_eq, m->x_eq_idx, true, res);
+    return 0;
+  }
+  /// @brief the inequality constraint violation (g_ineq_k = g_ineq_k(u_k, x_k, p_k, p))
+  /// @param inputs_k: pointer to array inputs of time step k
+  /// @param states_k: pointer to array states of time step k
+  /// @param stage_params_k: pointer to array stage parameters of time step k
+  /// @param global_params: pointer to array global parameters
+  /// @param res: pointer to array ng_ineq-vector
+  /// @param k: time step
+  fatrop_int eval_gineqk(
+      const double *states_k,
+      const double *inputs_k,
+      const double *stage_params_k,
+      const double *global_params,
+      double *res,
+      const fatrop_int k)  override {
+    solver.set_stage(m, k, states_k, inputs_k);
+    if (solver.calc_stage(m, k)) return 1;
+    eval_con(k, m->g_ineq, m->g_ineq_idx, m->x_ineq, m->x_ineq_idx, false, res);
+    return 0;
+  }
+  /// @brief gradient of the objective function (not the Lagrangian!) to the concatenation of (u_k, x_k)
+  /// @param objective_scale: pointer to objective scale
+  /// @param inputs_k: pointer to array inputs of time step k
+  /// @param states_k: pointer to array states of time step k
+  /// @param stage_params_k: pointer to array stage parameters of time step k
+  /// @param global_params: pointer to array global parameters
+  /// @param res: pointer to (nu+nx)-array
+  /// @param k: time step
+  fatrop_int eval_rqk(
+      const double *objective_scale,
+      const double *inputs_k,
+      const double *states_k,
+      const double *stage_params_k,
+      const double *global_params,
+      double *res,
+      const fatrop_int k) override {
+    casadi_int nx = solver.nxs_[k], nu = solver.nus_[k];
+    solver.set_stage(m, k, states_k, inputs_k);
+    if (solver.calc_stage_jac(m, k)) return 1;
+    for (casadi_int j=0; j<nx+nu; ++j) {
+      res[j] = *objective_scale * m->grad_fk[fatrop_var(j, nx, nu)];
+    }
+    return 0;
+  }
+  /// @brief objective function value
+  /// @param objective_scale: pointer to array objective scale
+  /// @param inputs_k: pointer to array inputs of time step k
+  /// @param states_k: pointer to array states of time step k
+  /// @param stage_params_k: pointer to array stage parameters of time step k
+  /// @param global_params: pointer to array global parameters
+  /// @param res: pointer to double
+  /// @param k: time step
+  fatrop_int eval_Lk(
+      const double *objective_scale,
+      const double *inputs_k,
+      const double *states_k,
+      const double *stage_params_k,
+      const double *global_params,
+      double *res,
+      const fatrop_int k) override {
+    solver.set_stage(m, k, states_k, inputs_k);
+    if (solver.calc_stage(m, k)) return 1;
+    *res = *objective_scale * m->fk[0];
+    return 0;
+  }
+  /// @brief the bounds of the inequalites at stage k
+  /// @param lower: pointer to ng_ineq-vector
+  /// @param upper: pointer to ng_ineq-vector
+  /// @param k: time step
+  fatrop_int get_boundsk(double *lower, double *upper, const fatrop_int k) const override {
+    const double *lbz = m->d_nlp.lbz, *ubz = m->d_nlp.ubz;
+    casadi_int i, c = 0;
+    for (i=m->g_ineq_idx[k]; i<m->g_ineq_idx[k+1]; ++i) {
+      lower[c] = lbz[solver.nx_ + m->g_ineq[i]];
+      upper[c] = ubz[solver.nx_ + m->g_ineq[i]];
+      c++;
+    }
+    for (i=m->x_ineq_idx[k]; i<m->x_ineq_idx[k+1]; ++i) {
+      lower[c] = lbz[m->x_ineq[i]];
+      upper[c] = ubz[m->x_ineq[i]];
+      c++;
+    }
+    return 0;
+  }
+  /// @brief default initial guess for the states of stage k
+  /// @param xk: pointer to states of time step k
+  /// @param k: time step
+  fatrop_int get_initial_xk(double *xk, const fatrop_int k) const override {
+    casadi_copy(m->d_nlp.z + solver.x_offset_[k], solver.nxs_[k], xk);
+    return 0;
+  }
+  /// @brief default initial guess for the inputs of stage k
+  /// @param uk: pointer to inputs of time step k
+  /// @param k: time step
+  fatrop_int get_initial_uk(double *uk, const fatrop_int k) const override {
+    casadi_copy(m->d_nlp.z + solver.x_offset_[k] + solver.nxs_[k], solver.nus_[k], uk);
+    return 0;
+  }
+
+  private:
+  // Jacobian (transposed, in Fatrop order) and value of the path constraints and
+  // variable bounds of stage k in the given selection, returns the number of columns
+  casadi_int pack_Ggt(casadi_int k,
+      const std::vector<casadi_int>& g_sel, const std::vector<casadi_int>& g_sel_idx,
+      const std::vector<casadi_int>& x_sel, const std::vector<casadi_int>& x_sel_idx,
+      bool eq) {
+    casadi_int nx = solver.nxs_[k], nu = solver.nus_[k], n = nx+nu;
+    casadi_int nr = solver.g_offset_[k+1]-solver.g_offset_[k];
+    const double* xk = get_ptr(m->xk) + solver.x_offset_[k];
+    double* t = get_ptr(m->tmp);
+    casadi_int i, j, c = 0;
+    for (i=g_sel_idx[k]; i<g_sel_idx[k+1]; ++i) {
+      casadi_int r = g_sel[i] - solver.g_offset_[k];
+      for (j=0; j<n; ++j) t[j + c*(n+1)] = m->jac_gk[r + fatrop_var(j, nx, nu)*nr];
+      t[n + c*(n+1)] = m->gk[r] - (eq ? m->d_nlp.lbz[solver.nx_ + g_sel[i]] : 0);
+      c++;
+    }
+    for (i=x_sel_idx[k]; i<x_sel_idx[k+1]; ++i) {
+      casadi_int v = x_sel[i] - solver.x_offset_[k];
+      casadi_clear(t + c*(n+1), n);
+      t[(v<nx ? nu+v : v-nx) + c*(n+1)] = 1;
+      t[n + c*(n+1)] = xk[v] - (eq ? m->d_nlp.lbz[x_sel[i]] : 0);
+      c++;
+    }
+    return c;
+  }
+
+  // Value of the path constraints and variable bounds of stage k in the given selection
+  void eval_con(casadi_int k,
+      const std::vector<casadi_int>& g_sel, const std::vector<casadi_int>& g_sel_idx,
+      const std::vector<casadi_int>& x_sel, const std::vector<casadi_int>& x_sel_idx,
+      bool eq, double* res) {
+    const double* xk = get_ptr(m->xk);
+    casadi_int i, c = 0;
+    for (i=g_sel_idx[k]; i<g_sel_idx[k+1]; ++i) {
+      res[c++] = m->gk[g_sel[i] - solver.g_offset_[k]]
+        - (eq ? m->d_nlp.lbz[solver.nx_ + g_sel[i]] : 0);
+    }
+    for (i=x_sel_idx[k]; i<x_sel_idx[k+1]; ++i) {
+      res[c++] = xk[x_sel[i]] - (eq ? m->d_nlp.lbz[x_sel[i]] : 0);
+    }
+  }
+};
+
+  int FatropInterface::solve(void* mem) const {
+    auto m = static_cast<FatropMemory*>(mem);
+    auto d_nlp = &m->d_nlp;
+    const double *lbz = d_nlp->lbz, *ubz = d_nlp->ubz;
+    casadi_int i, k;
+
+    // Split path constraints and variable bounds into equalities and inequalities
+    m->g_eq_idx[0] = m->g_ineq_idx[0] = m->x_eq_idx[0] = m->x_ineq_idx[0] = 0;
+    for (k=0; k<=N_; ++k) {
+      casadi_int ngap = k<N_ ? nxs_[k+1] : 0;
+      for (i=g_offset_[k]; i<g_offset_[k]+ngap; ++i) {
+        casadi_assert(lbz[nx_+i]==ubz[nx_+i],
+          "Gap-closing constraint " + str(i) + " must have equal bounds.");
+      }
+      m->g_eq_idx[k+1] = m->g_eq_idx[k];
+      m->g_ineq_idx[k+1] = m->g_ineq_idx[k];
+      for (i=g_offset_[k]+ngap; i<g_offset_[k+1]; ++i) {
+        if (lbz[nx_+i]==ubz[nx_+i]) {
+          m->g_eq[m->g_eq_idx[k+1]++] = i;
+        } else if (lbz[nx_+i]!=-inf || ubz[nx_+i]!=inf) {
+          m->g_ineq[m->g_ineq_idx[k+1]++] = i;
+        }
+      }
+      m->x_eq_idx[k+1] = m->x_eq_idx[k];
+      m->x_ineq_idx[k+1] = m->x_ineq_idx[k];
+      for (i=x_offset_[k]; i<x_offset_[k+1]; ++i) {
+        if (lbz[i]==ubz[i]) {
+          m->x_eq[m->x_eq_idx[k+1]++] = i;
+        } else if (lbz[i]!=-inf || ubz[i]!=inf) {
+          m->x_ineq[m->x_ineq_idx[k+1]++] = i;
+        }
+      }
+    }
+    m->jac_stage = -1;
+
+    CasadiStructuredNLP nlp(*this, m);
+    fatrop::OCPApplication app(std::make_shared<CasadiStructuredNLP>(nlp));
+    app.build();
+
+    // Pass options
+    for (auto&& op : opts_) {
+      if (op.second.is_bool()) {
+        app.set_option(op.first, op.second.to_bool());
+      } else if (op.second.is_int()) {
+        app.set_option(op.first, static_cast<int>(op.second.to_int()));
+      } else if (op.second.is_double()) {
+        app.set_option(op.first, op.second.to_double());
+      } else if (op.second.is_string()) {
+        app.set_option(op.first, op.second.to_string());
+      } else {
+        casadi_error("Option '" + op.first + "' has unsupported type " + op.second.get_description());
+      }
+    }
+
+    int ret = app.optimize();
+    m->success = ret==0;
+    m->return_status = m->success ? "Solve_Succeeded" : "Solve_Failed";
+    if (!m->success) return 0;
+
+    // Primal solution, ordered u0 x0 u1 x1 ...
+    blasfeo_dvec* primal = static_cast<blasfeo_dvec*>(app.last_solution_primal());
+    casadi_int offset = 0;
+    for (k=0; k<=N_; ++k) {
+      blasfeo_unpack_dvec(nus_[k], primal, offset, d_nlp->z + x_offset_[k] + nxs_[k], 1);
+      offset += nus_[k];
+      blasfeo_unpack_dvec(nxs_[k], primal, offset, d_nlp->z + x_offset_[k], 1);
+      offset += nxs_[k];
+    }
+
+    // Dual solution, ordered equalities, dynamics, inequalities
+    casadi_int n_dual = 0;
+    for (k=0; k<=N_; ++k) n_dual += n_eq(m, k) + n_ineq(m, k) + (k<N_ ? nxs_[k+1] : 0);
+    std::vector<double> dual(n_dual);
+    blasfeo_unpack_dvec(n_dual, static_cast<blasfeo_dvec*>(app.last_solution_dual()), 0,
+      get_ptr(dual), 1);
+    double *lam_x = d_nlp->lam, *lam_g = d_nlp->lam + nx_;
+    casadi_clear(d_nlp->lam, nx_ + ng_);
+    offset = 0;
+    for (k=0; k<=N_; ++k) {
+      for (i=m->g_eq_idx[k]; i<m->g_eq_idx[k+1]; ++i) lam_g[m->g_eq[i]] = dual[offset++];
+      for (i=m->x_eq_idx[k]; i<m->x_eq_idx[k+1]; ++i) lam_x[m->x_eq[i]] = dual[offset++];
+    }
+    for (k=0; k<N_; ++k) {
+      for (i=g_offset_[k]; i<g_offset_[k]+nxs_[k+1]; ++i) {
+        lam_g[i] = -dual[offset++]/gap_scale_[i];
+      }
+    }
+    for (k=0; k<=N_; ++k) {
+      for (i=m->g_ineq_idx[k]; i<m->g_ineq_idx[k+1]; ++i) lam_g[m->g_ineq[i]] = dual[offset++];
+      for (i=m->x_ineq_idx[k]; i<m->x_ineq_idx[k+1]; ++i) lam_x[m->x_ineq[i]] = dual[offset++];
+    }
+    m->unified_return_status = SOLVER_RET_SUCCESS;
+    return 0;
+  }
+
+  FatropInterface::FatropInterface(DeserializingStream& s) : Nlpsol(s) {
+    s.version("FatropInterface", 1);
+    s.unpack("FatropInterface::N", N_);
+    s.unpack("FatropInterface::nx", nxs_);
+    s.unpack("FatropInterface::nu", nus_);
+    s.unpack("FatropInterface::ng", ngs_);
+    s.unpack("FatropInterface::x_offset", x_offset_);
+    s.unpack("FatropInterface::g_offset", g_offset_);
+    s.unpack("FatropInterface::gap_scale", gap_scale_);
+    s.unpack("FatropInterface::opts", opts_);
+  }
+
+  void FatropInterface::serialize_body(SerializingStream &s) const {
+    Nlpsol::serialize_body(s);
+    s.version("FatropInterface", 1);
+    s.pack("FatropInterface::N", N_);
+    s.pack("FatropInterface::nx", nxs_);
+    s.pack("FatropInterface::nu", nus_);
+    s.pack("FatropInterface::ng", ngs_);
+    s.pack("FatropInterface::x_offset", x_offset_);
+    s.pack("FatropInterface::g_offset", g_offset_);
+    s.pack("FatropInterface::gap_scale", gap_scale_);
+    s.pack("FatropInterface::opts", opts_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,188 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_FATROP_INTERFACE_HPP
+#define CASADI_FATROP_INTERFACE_HPP
+
+#include "casadi/core/nlpsol_impl.hpp"
+#include <casadi/interfaces/fatrop/casadi_nlpsol_fatrop_export.h>
+
+/** \defgroup plugin_Nlpsol_fatrop
+    \par
+Interface to the Fatrop solver for optimal control problems
+
+The NLP must have the stage structure of a multiple shooting transcription:
+
+ - The variable ordering must be [x0 u0 x1 u1 ... xN]
+ - The constraints must be in order: [gap0 path0 gap1 path1 ... pathN]
+
+    gap: d .* x_k+1 + r_k(x_k, u_k, p) = lbg = ubg, with d a constant vector
+    path: lbg <= c_k(x_k, u_k, p) <= ubg
+
+ - The objective must be a sum of terms, each depending on a single stage
+
+The stage structure is detected from the constraint Jacobian, unless all of
+N, nx, nu, ng are supplied. For every stage, functions for the values, first
+and second order derivatives of the stage terms are generated, such that no
+Jacobian or Hessian of the full NLP is ever evaluated. For MX problems, the
+stage functions are obtained by inlining the NLP; set 'expand' to get SX.
+
+    \identifier{27i} */
+
+/** \pluginsection{Nlpsol,fatrop} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  // Forward declaration
+  class FatropInterface;
+
+  struct CASADI_NLPSOL_FATROP_EXPORT FatropMemory : public NlpsolMemory {
+    // Primal variables, only the stage being evaluated is up to date
+    std::vector<double> xk;
+
+    // Stage function outputs
+    std::vector<double> fk, grad_fk, gk, jac_gk, hess_lk, grad_lk, lam_gk;
+
+    // Matrix passed to Fatrop, column major
+    std::vector<double> tmp;
+
+    // Stage of the Jacobian evaluation in jac_gk, -1 if none, and its arguments
+    casadi_int jac_stage;
+    std::vector<double> jac_arg;
+
+    // Path constraints and variable bounds per stage, split into equalities and inequalities
+    std::vector<casadi_int> g_eq, g_ineq, x_eq, x_ineq;
+    std::vector<casadi_int> g_eq_idx, g_ineq_idx, x_eq_idx, x_ineq_idx;
+
+    // Return status
+    const char* return_status;
+
+    /// Constructor
+    FatropMemory();
+
+    /// Destructor
+    ~FatropMemory();
+  };
+
+  /** \brief \pluginbrief{Nlpsol,fatrop}
+
+     @copydoc Nlpsol_doc
+     @copydoc plugin_Nlpsol_fatrop
+  */
+  class CASADI_NLPSOL_FATROP_EXPORT FatropInterface : public Nlpsol {
+  public:
+    // Stage structure
+    casadi_int N_;
+    std::vector<int> nxs_, nus_, ngs_;
+
+    // Offsets of the stage variables and constraints, length N+2
+    std::vector<casadi_int> x_offset_, g_offset_;
+
+    // Coefficient of x_k+1 in the gap-closing constraints, one for other constraints
+    std::vector<double> gap_scale_;
+
+    /// All Fatrop options
+    Dict opts_;
+
+    explicit FatropInterface(const std::string& name, const Function& nlp);
+    ~FatropInterface() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "fatrop";}
+
+    // Get name of the class
+    std::string class_name() const override { return "FatropInterface";}
+
+    /** \brief  Create a new NLP Solver */
+    static Nlpsol* creator(const std::string& name, const Function& nlp) {
+      return new FatropInterface(name, nlp);
+    }
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new FatropMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<FatropMemory*>(mem);}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    // Solve the NLP
+    int solve(void* mem) const override;
+
+    /// Number of path constraints and variable bounds of stage k
+    casadi_int n_eq(FatropMemory* m, casadi_int k) const;
+    casadi_int n_ineq(FatropMemory* m, casadi_int k) const;
+
+    /// Copy the variables of stage k into the memory, with the next state set to zero
+    void set_stage(FatropMemory* m, casadi_int k, const double* states_k,
+      const double* inputs_k) const;
+
+    /// Evaluate the stage objective and constraints
+    int calc_stage(FatropMemory* m, casadi_int k) const;
+
+    /// Evaluate the stage objective and constraints, with derivatives
+    int calc_stage_jac(FatropMemory* m, casadi_int k) const;
+
+    /// Evaluate the Hessian and gradient of the stage Lagrangian
+    int calc_stage_hess(FatropMemory* m, casadi_int k, double objective_scale,
+      const double* lam_dyn, const double* lam_eq, const double* lam_ineq) const;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new FatropInterface(s); }
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit FatropInterface(DeserializingStream& s);
+
+  private:
+    // Create the stage functions
+    template<typename XType>
+    void init_stages(bool detect_structure);
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_FATROP_INTERFACE_HPP
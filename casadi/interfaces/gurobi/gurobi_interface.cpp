@@ -79,7 +79,13 @@ namespace casadi {
         "Weights corresponding to SOS entries."}},
       {"sos_types",
        {OT_INTVECTOR,
-        "Specify 1 or 2 for each SOS group."}}
+        "Specify 1 or 2 for each SOS group."}},
+      {"persistent",
+       {OT_BOOL,
+        "Keep the Gurobi model alive between calls and only push changed bounds, "
+        "costs and coefficients. The model is rebuilt when the constraint senses, "
+        "range bounds or SOCP data change. Discrete variables are started from "
+        "the previous solution [false]"}}
      }
   };
 
@@ -89,6 +95,7 @@ namespace casadi {
 
     // Default options
     std::vector<std::string> vtype;
+    persistent_ = false;
 
     std::vector< std::vector<casadi_int> > sos_groups;
     std::vector< std::vector<double> > sos_weights;
@@ -106,6 +113,8 @@ namespace casadi {
         sos_weights = op.second.to_double_vector_vector();
       } else if (op.first=="sos_types") {
         sos_types = op.second.to_int_vector();
+      } else if (op.first=="persistent") {
+        persistent_ = op.second;
       }
     }
 
@@ -166,6 +175,12 @@ namespace casadi {
     m->sos_ind = sos_ind_;
     m->sos_types = sos_types_;
 
+    m->model = nullptr;
+    m->model_reused = false;
+    m->row_type.resize(na_);
+    m->row_index.resize(na_);
+    m->npi = 0;
+
     m->add_stat("preprocessing");
     m->add_stat("solver");
     m->add_stat("postprocessing");
@@ -206,6 +221,198 @@ namespace casadi {
     return "Unknown";
   }
 
+  // Type of a linear constraint: 0 absent, otherwise the sense, 'R' for ranges
+  inline char row_type(double lb, double ub) {
+    if (isinf(lb)) return isinf(ub) ? 0 : GRB_LESS_EQUAL;
+    if (isinf(ub)) return GRB_GREATER_EQUAL;
+    return lb==ub ? GRB_EQUAL : 'R';
+  }
+
+  // Do nonzeros match the data a model was built with, an empty vector if absent
+  inline bool same_data(const std::vector<double>& v, const double* x, casadi_int n) {
+    if (!x) return v.empty();
+    return v.size()==n && std::equal(v.begin(), v.end(), x);
+  }
+
+  // Copy nonzeros, an empty vector if absent
+  inline std::vector<double> copy_data(const double* x, casadi_int n) {
+    return x ? std::vector<double>(x, x+n) : std::vector<double>();
+  }
+
+  char GurobiInterface::var_type(casadi_int i, double lb, double ub) const {
+    if (!vtype_.empty()) {
+      // Explicitly set 'vtype' takes precedence
+      return vtype_.at(i);
+    } else if (!discrete_.empty() && discrete_.at(i)) {
+      // Variable marked as discrete (integer or binary)
+      return lb==0 && ub==1 ? GRB_BINARY : GRB_INTEGER;
+    } else {
+      // Continious variable
+      return GRB_CONTINUOUS;
+    }
+  }
+
+  void GurobiInterface::add_qpterms(GurobiMemory* m, GRBmodel* model, const double* h,
+      int* ind, int* ind2, double* val) const {
+    const casadi_int *H_colind=H_.colind(), *H_row=H_.row();
+    for (int i=0; i<nx_; ++i) {
+
+      // Quadratic term nonzero indices
+      casadi_int numqnz = H_colind[1]-H_colind[0];
+      for (casadi_int k=0;k<numqnz;++k) ind[k]=H_row[k];
+      H_colind++;
+      H_row += numqnz;
+
+      // Corresponding column
+      casadi_fill(ind2, numqnz, i);
+
+      // Quadratic term nonzeros
+      if (h) {
+        casadi_copy(h, numqnz, val);
+        casadi_scal(numqnz, 0.5, val);
+        h += numqnz;
+      } else {
+        casadi_clear(val, numqnz);
+      }
+
+      // Pass to model
+      casadi_int flag = GRBaddqpterms(model, numqnz, ind, ind2, val);
+      casadi_assert(!flag, GRBgeterrormsg(m->env));
+    }
+  }
+
+  void GurobiInterface::cache_data(GurobiMemory* m, const double** arg,
+      const char* vtypes) const {
+    const SDPToSOCPMem& sm = sdp_to_socp_mem_;
+    const double *a = arg[CONIC_A], *lba = arg[CONIC_LBA], *uba = arg[CONIC_UBA],
+      *lbx = arg[CONIC_LBX], *ubx = arg[CONIC_UBX];
+    m->vtype.assign(vtypes, vtypes+nx_);
+    m->lbx.resize(nx_);
+    m->ubx.resize(nx_);
+    for (casadi_int i=0; i<nx_; ++i) {
+      double lb = lbx ? lbx[i] : 0., ub = ubx ? ubx[i] : 0.;
+      m->lbx[i] = isinf(lb) ? -GRB_INFINITY : lb;
+      m->ubx[i] = isinf(ub) ? GRB_INFINITY : ub;
+    }
+    m->g = copy_data(arg[CONIC_G], nx_);
+    m->lba.resize(na_);
+    m->uba.resize(na_);
+    for (casadi_int i=0; i<na_; ++i) {
+      m->lba[i] = lba ? lba[i] : 0.;
+      m->uba[i] = uba ? uba[i] : 0.;
+    }
+    m->a.resize(sm.AT.nnz());
+    for (casadi_int k=0; k<sm.AT.nnz(); ++k) m->a[k] = a ? a[sm.A_mapping[k]] : 0;
+    m->h = copy_data(arg[CONIC_H], H_.nnz());
+    m->p = copy_data(arg[CONIC_P], nnz_in(CONIC_P));
+    m->q = copy_data(arg[CONIC_Q], nnz_in(CONIC_Q));
+  }
+
+  bool GurobiInterface::update_model(GurobiMemory* m, const double** arg,
+      int* ind, int* ind2, double* val) const {
+    const SDPToSOCPMem& sm = sdp_to_socp_mem_;
+    const double *h=arg[CONIC_H],
+      *g=arg[CONIC_G],
+      *a=arg[CONIC_A],
+      *lba=arg[CONIC_LBA],
+      *uba=arg[CONIC_UBA],
+      *lbx=arg[CONIC_LBX],
+      *ubx=arg[CONIC_UBX],
+      *p=arg[CONIC_P],
+      *q=arg[CONIC_Q];
+    GRBmodel *model = m->model;
+    casadi_int flag;
+
+    // Changed constraint senses, range bounds or SOCP data need a new model
+    for (casadi_int i=0; i<na_; ++i) {
+      double lb = lba ? lba[i] : 0., ub = uba ? uba[i] : 0.;
+      char t = row_type(lb, ub);
+      if (t!=m->row_type[i]) return false;
+      if (t=='R' && (lb!=m->lba[i] || ub!=m->uba[i])) return false;
+    }
+    if (!same_data(m->p, p, nnz_in(CONIC_P))) return false;
+    if (!same_data(m->q, q, nnz_in(CONIC_Q))) return false;
+
+    // Variable types, bounds and linear cost
+    for (casadi_int i=0; i<nx_; ++i) {
+      double lb = lbx ? lbx[i] : 0., ub = ubx ? ubx[i] : 0.;
+      if (isinf(lb)) lb = -GRB_INFINITY;
+      if (isinf(ub)) ub =  GRB_INFINITY;
+      char vtype = var_type(i, lb, ub);
+      if (vtype!=m->vtype[i]) {
+        flag = GRBsetcharattrelement(model, "VType", i, vtype);
+        casadi_assert(!flag, GRBgeterrormsg(m->env));
+        m->vtype[i] = vtype;
+      }
+      if (lb!=m->lbx[i]) {
+        flag = GRBsetdblattrelement(model, "LB", i, lb);
+        casadi_assert(!flag, GRBgeterrormsg(m->env));
+        m->lbx[i] = lb;
+      }
+      if (ub!=m->ubx[i]) {
+        flag = GRBsetdblattrelement(model, "UB", i, ub);
+        casadi_assert(!flag, GRBgeterrormsg(m->env));
+        m->ubx[i] = ub;
+      }
+      double gi = g ? g[i] : 0.;
+      if (gi!=(m->g.empty() ? 0. : m->g[i])) {
+        flag = GRBsetdblattrelement(model, "Obj", i, gi);
+        casadi_assert(!flag, GRBgeterrormsg(m->env));
+      }
+    }
+    m->g = copy_data(g, nx_);
+
+    // Right-hand-sides and coefficients of the linear constraints
+    m->cind.clear();
+    m->vind.clear();
+    m->cval.clear();
+    const casadi_int *AT_colind=sm.AT.colind(), *AT_row=sm.AT.row();
+    for (casadi_int i=0; i<na_; ++i) {
+      double lb = lba ? lba[i] : 0., ub = uba ? uba[i] : 0.;
+      if (m->row_index[i]>=0 && (lb!=m->lba[i] || ub!=m->uba[i])) {
+        double rhs = m->row_type[i]==GRB_LESS_EQUAL ? ub : lb;
+        flag = GRBsetdblattrelement(model, "RHS", m->row_index[i], rhs);
+        casadi_assert(!flag, GRBgeterrormsg(m->env));
+      }
+      m->lba[i] = lb;
+      m->uba[i] = ub;
+      for (casadi_int k=AT_colind[i]; k<AT_colind[i+1]; ++k) {
+        double v = a ? a[sm.A_mapping[k]] : 0;
+        if (v==m->a[k]) continue;
+        m->a[k] = v;
+        if (m->row_index[i]<0) continue;
+        m->cind.push_back(m->row_index[i]);
+        m->vind.push_back(AT_row[k]);
+        m->cval.push_back(v);
+      }
+    }
+    if (!m->cval.empty()) {
+      flag = GRBchgcoeffs(model, m->cval.size(), get_ptr(m->cind), get_ptr(m->vind),
+        get_ptr(m->cval));
+      casadi_assert(!flag, GRBgeterrormsg(m->env));
+    }
+
+    // Quadratic terms are replaced as a whole
+    if (!same_data(m->h, h, H_.nnz())) {
+      flag = GRBdelq(model);
+      casadi_assert(!flag, GRBgeterrormsg(m->env));
+      add_qpterms(m, model, h, ind, ind2, val);
+      m->h = copy_data(h, H_.nnz());
+    }
+
+    // Start discrete variables from the previous solution
+    for (casadi_int i=0; i<nx_; ++i) {
+      if (m->vtype[i] != GRB_CONTINUOUS && !isnan(m->x_prev.at(i))) {
+        flag = GRBsetdblattrelement(model, "Start", i, m->x_prev[i]);
+        casadi_assert(!flag, GRBgeterrormsg(m->env));
+      }
+    }
+
+    flag = GRBupdatemodel(model);
+    casadi_assert(!flag, GRBgeterrormsg(m->env));
+    return true;
+  }
+
   int GurobiInterface::
   solve(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
     auto m = static_cast<GurobiMemory*>(mem);
@@ -249,217 +456,196 @@ namespace casadi {
     // Greate an empty model
     GRBmodel *model = nullptr;
     try {
-      casadi_int flag = GRBnewmodel(m->env, &model, name_.c_str(), 0,
-        nullptr, nullptr, nullptr, nullptr, nullptr);
-      casadi_assert(!flag, GRBgeterrormsg(m->env));
-
-      // Add variables
-      for (casadi_int i=0; i<nx_; ++i) {
-        // Get bounds
-        double lb = lbx ? lbx[i] : 0., ub = ubx ? ubx[i] : 0.;
-        if (isinf(lb)) lb = -GRB_INFINITY;
-        if (isinf(ub)) ub =  GRB_INFINITY;
-
-        // Get variable type
-        char vtype;
-        if (!vtype_.empty()) {
-          // Explicitly set 'vtype' takes precedence
-          vtype = vtype_.at(i);
-        } else if (!discrete_.empty() && discrete_.at(i)) {
-          // Variable marked as discrete (integer or binary)
-          vtype = lb==0 && ub==1 ? GRB_BINARY : GRB_INTEGER;
-        } else {
-          // Continious variable
-          vtype = GRB_CONTINUOUS;
+      casadi_int flag;
+
+      // Update the model of the previous call in place, if possible
+      m->model_reused = m->model && update_model(m, arg, ind, ind2, val);
+      if (m->model_reused) {
+        model = m->model;
+      } else {
+        if (m->model) {
+          GRBfreemodel(m->model);
+          m->model = nullptr;
         }
-        vtypes[i] = vtype;
-
-        // Pass to model
-        flag = GRBaddvar(model, 0, nullptr, nullptr, g ? g[i] : 0., lb, ub, vtype, nullptr);
+        flag = GRBnewmodel(m->env, &model, name_.c_str(), 0,
+          nullptr, nullptr, nullptr, nullptr, nullptr);
         casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
 
-      GRBupdatemodel(model);
-      for (casadi_int i=0; i<nx_; ++i) {
-        // If it is a discrete variable, we can pass the start guess
-        if (vtypes[i] != GRB_CONTINUOUS) {
-          flag = GRBsetdblattrelement(model, "Start", i, x0[i]);
-          casadi_assert(!flag, GRBgeterrormsg(m->env));
-        }
-      }
+        // Add variables
+        for (casadi_int i=0; i<nx_; ++i) {
+          // Get bounds
+          double lb = lbx ? lbx[i] : 0., ub = ubx ? ubx[i] : 0.;
+          if (isinf(lb)) lb = -GRB_INFINITY;
+          if (isinf(ub)) ub =  GRB_INFINITY;
 
+          // Get variable type
+          char vtype = var_type(i, lb, ub);
+          vtypes[i] = vtype;
 
-      /*  Treat SOCP constraints */
-
-      // Add helper variables for SOCP
-      for (casadi_int i=0;i<sm.r.size()-1;++i) {
-        for (casadi_int k=0;k<sm.r[i+1]-sm.r[i]-1;++k) {
-          flag = GRBaddvar(model, 0, nullptr, nullptr, 0, -GRB_INFINITY, GRB_INFINITY,
-                           GRB_CONTINUOUS, nullptr);
+          // Pass to model
+          flag = GRBaddvar(model, 0, nullptr, nullptr, g ? g[i] : 0., lb, ub, vtype, nullptr);
           casadi_assert(!flag, GRBgeterrormsg(m->env));
         }
-        flag = GRBaddvar(model, 0, nullptr, nullptr, 0, 0, GRB_INFINITY, GRB_CONTINUOUS, nullptr);
-        casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
 
-      flag = GRBupdatemodel(model);
-      casadi_assert(!flag, GRBgeterrormsg(m->env));
-
-      // Add quadratic terms
-      const casadi_int *H_colind=H_.colind(), *H_row=H_.row();
-      for (int i=0; i<nx_; ++i) {
+        GRBupdatemodel(model);
+        for (casadi_int i=0; i<nx_; ++i) {
+          // If it is a discrete variable, we can pass the start guess
+          if (vtypes[i] != GRB_CONTINUOUS) {
+            flag = GRBsetdblattrelement(model, "Start", i, x0[i]);
+            casadi_assert(!flag, GRBgeterrormsg(m->env));
+          }
+        }
 
-        // Quadratic term nonzero indices
-        casadi_int numqnz = H_colind[1]-H_colind[0];
-        for (casadi_int k=0;k<numqnz;++k) ind[k]=H_row[k];
-        H_colind++;
-        H_row += numqnz;
 
-        // Corresponding column
-        casadi_fill(ind2, numqnz, i);
+        /*  Treat SOCP constraints */
 
-        // Quadratic term nonzeros
-        if (h) {
-          casadi_copy(h, numqnz, val);
-          casadi_scal(numqnz, 0.5, val);
-          h += numqnz;
-        } else {
-          casadi_clear(val, numqnz);
+        // Add helper variables for SOCP
+        for (casadi_int i=0;i<sm.r.size()-1;++i) {
+          for (casadi_int k=0;k<sm.r[i+1]-sm.r[i]-1;++k) {
+            flag = GRBaddvar(model, 0, nullptr, nullptr, 0, -GRB_INFINITY, GRB_INFINITY,
+                             GRB_CONTINUOUS, nullptr);
+            casadi_assert(!flag, GRBgeterrormsg(m->env));
+          }
+          flag = GRBaddvar(model, 0, nullptr, nullptr, 0, 0, GRB_INFINITY, GRB_CONTINUOUS, nullptr);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
         }
 
-        // Pass to model
-        flag = GRBaddqpterms(model, numqnz, ind, ind2, val);
+        flag = GRBupdatemodel(model);
         casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
 
-      std::vector<char> constraint_type(na_); // For each a entry: 0 absent, 1 linear
-      casadi_int npi = 0;
+        // Add quadratic terms
+        add_qpterms(m, model, h, ind, ind2, val);
 
-      // Add constraints
-      const casadi_int *AT_colind=sm.AT.colind(), *AT_row=sm.AT.row();
-      for (casadi_int i=0; i<na_; ++i) {
-        // Get bounds
-        double lb = lba ? lba[i] : 0., ub = uba ? uba[i] : 0.;
+        m->npi = 0;
 
-        casadi_int numnz = 0;
-        // Loop over rows
-        for (casadi_int k=AT_colind[i]; k<AT_colind[i+1]; ++k) {
-          casadi_int j = AT_row[k];
+        // Add constraints
+        const casadi_int *AT_colind=sm.AT.colind(), *AT_row=sm.AT.row();
+        for (casadi_int i=0; i<na_; ++i) {
+          // Get bounds
+          double lb = lba ? lba[i] : 0., ub = uba ? uba[i] : 0.;
 
-          ind[numnz] = j;
-          val[numnz] = a ? a[sm.A_mapping[k]]  : 0;
+          casadi_int numnz = 0;
+          // Loop over rows
+          for (casadi_int k=AT_colind[i]; k<AT_colind[i+1]; ++k) {
+            casadi_int j = AT_row[k];
 
-          numnz++;
-        }
+            ind[numnz] = j;
+            val[numnz] = a ? a[sm.A_mapping[k]]  : 0;
 
-        constraint_type[i] = 1;
-        // Pass to model
-        if (isinf(lb)) {
-          if (isinf(ub)) {
-            constraint_type[i] = 0;
-            // Neither upper or lower bounds, skip
-          } else {
-            // Only upper bound
-            flag = GRBaddconstr(model, numnz, ind, val, GRB_LESS_EQUAL, ub, nullptr);
-            casadi_assert(!flag, GRBgeterrormsg(m->env));
-            npi++;
+            numnz++;
           }
-        } else {
-          if (isinf(ub)) {
-            // Only lower bound
-            flag = GRBaddconstr(model, numnz, ind, val, GRB_GREATER_EQUAL, lb, nullptr);
-            casadi_assert(!flag, GRBgeterrormsg(m->env));
-            npi++;
-          } else if (lb==ub) {
-            // Upper and lower bounds equal
-            flag = GRBaddconstr(model, numnz, ind, val, GRB_EQUAL, lb, nullptr);
-            casadi_assert(!flag, GRBgeterrormsg(m->env));
-            npi++;
+
+          m->row_type[i] = row_type(lb, ub);
+          m->row_index[i] = m->row_type[i] ? m->npi : -1;
+          // Pass to model
+          if (isinf(lb)) {
+            if (isinf(ub)) {
+              // Neither upper or lower bounds, skip
+            } else {
+              // Only upper bound
+              flag = GRBaddconstr(model, numnz, ind, val, GRB_LESS_EQUAL, ub, nullptr);
+              casadi_assert(!flag, GRBgeterrormsg(m->env));
+              m->npi++;
+            }
           } else {
-            // Both upper and lower bounds
-            flag = GRBaddrangeconstr(model, numnz, ind, val, lb, ub, nullptr);
-            casadi_assert(!flag, GRBgeterrormsg(m->env));
-            npi++;
+            if (isinf(ub)) {
+              // Only lower bound
+              flag = GRBaddconstr(model, numnz, ind, val, GRB_GREATER_EQUAL, lb, nullptr);
+              casadi_assert(!flag, GRBgeterrormsg(m->env));
+              m->npi++;
+            } else if (lb==ub) {
+              // Upper and lower bounds equal
+              flag = GRBaddconstr(model, numnz, ind, val, GRB_EQUAL, lb, nullptr);
+              casadi_assert(!flag, GRBgeterrormsg(m->env));
+              m->npi++;
+            } else {
+              // Both upper and lower bounds
+              flag = GRBaddrangeconstr(model, numnz, ind, val, lb, ub, nullptr);
+              casadi_assert(!flag, GRBgeterrormsg(m->env));
+              m->npi++;
+            }
           }
         }
-      }
-      std::vector<double> pi(npi);
 
-      // Add SOS constraints when applicable
-      if (!m->sos_ind.empty()) {
-        flag = GRBaddsos(model, m->sos_beg.size()-1, m->sos_ind.size(),
-            get_ptr(m->sos_types), get_ptr(m->sos_beg), get_ptr(m->sos_ind),
-            get_ptr(m->sos_weights));
-        casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
+        // Add SOS constraints when applicable
+        if (!m->sos_ind.empty()) {
+          flag = GRBaddsos(model, m->sos_beg.size()-1, m->sos_ind.size(),
+              get_ptr(m->sos_types), get_ptr(m->sos_beg), get_ptr(m->sos_ind),
+              get_ptr(m->sos_weights));
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
+        }
 
-      // SOCP helper constraints
-      const Sparsity& sp = sm.map_Q.sparsity();
-      const casadi_int* colind = sp.colind();
-      const casadi_int* row = sp.row();
-      const casadi_int* data = sm.map_Q.ptr();
+        // SOCP helper constraints
+        const Sparsity& sp = sm.map_Q.sparsity();
+        const casadi_int* colind = sp.colind();
+        const casadi_int* row = sp.row();
+        const casadi_int* data = sm.map_Q.ptr();
 
-      // Loop over columns
-      for (casadi_int i=0; i<sp.size2(); ++i) {
+        // Loop over columns
+        for (casadi_int i=0; i<sp.size2(); ++i) {
 
-        casadi_int numnz = 0;
-        // Loop over rows
-        for (casadi_int k=colind[i]; k<colind[i+1]; ++k) {
-          casadi_int j = row[k];
+          casadi_int numnz = 0;
+          // Loop over rows
+          for (casadi_int k=colind[i]; k<colind[i+1]; ++k) {
+            casadi_int j = row[k];
 
-          ind[numnz] = j;
-          val[numnz] = (q && j<nx_) ? q[data[k]] : -1;
+            ind[numnz] = j;
+            val[numnz] = (q && j<nx_) ? q[data[k]] : -1;
 
-          numnz++;
-        }
+            numnz++;
+          }
 
-        // Get bound
-        double bound = sm.map_P[i]==-1 ? 0 : -p[sm.map_P[i]];
+          // Get bound
+          double bound = sm.map_P[i]==-1 ? 0 : -p[sm.map_P[i]];
 
-        flag = GRBaddconstr(model, numnz, ind, val, GRB_EQUAL, bound, nullptr);
-        casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
+          flag = GRBaddconstr(model, numnz, ind, val, GRB_EQUAL, bound, nullptr);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
+        }
 
-      // Loop over blocks
-      for (casadi_int i=0; i<sm.r.size()-1; ++i) {
-        casadi_int block_size = sm.r[i+1]-sm.r[i];
+        // Loop over blocks
+        for (casadi_int i=0; i<sm.r.size()-1; ++i) {
+          casadi_int block_size = sm.r[i+1]-sm.r[i];
 
-        // Indicate x'x - y^2 <= 0
-        for (casadi_int j=0;j<block_size;++j) {
-          ind[j] = nx_ + sm.r[i] + j;
-          val[j] = j<block_size-1 ? 1 : -1;
-        }
+          // Indicate x'x - y^2 <= 0
+          for (casadi_int j=0;j<block_size;++j) {
+            ind[j] = nx_ + sm.r[i] + j;
+            val[j] = j<block_size-1 ? 1 : -1;
+          }
 
-        flag = GRBaddqconstr(model, 0, nullptr, nullptr,
-          block_size, ind, ind, val,
-          GRB_LESS_EQUAL, 0, nullptr);
-        casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
+          flag = GRBaddqconstr(model, 0, nullptr, nullptr,
+            block_size, ind, ind, val,
+            GRB_LESS_EQUAL, 0, nullptr);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
+        }
 
-      flag = 0;
-      for (auto && op : opts_) {
-        int ret = GRBgetparamtype(m->env, op.first.c_str());
-        switch (ret) {
-          case -1:
-            casadi_error("Parameter '" + op.first + "' unknown to Gurobi.");
-          case 1:
-            {
-              flag = GRBsetintparam(GRBgetenv(model), op.first.c_str(), op.second);
-              break;
-            }
-          case 2:
-              flag = GRBsetdblparam(GRBgetenv(model), op.first.c_str(), op.second);
-              break;
-          case 3:
-            {
-              std::string s = op.second;
-              flag = GRBsetstrparam(GRBgetenv(model), op.first.c_str(), s.c_str());
-              break;
-            }
-          default:
-            casadi_error("Not implememented : " + str(ret));
+        flag = 0;
+        for (auto && op : opts_) {
+          int ret = GRBgetparamtype(m->env, op.first.c_str());
+          switch (ret) {
+            case -1:
+              casadi_error("Parameter '" + op.first + "' unknown to Gurobi.");
+            case 1:
+              {
+                flag = GRBsetintparam(GRBgetenv(model), op.first.c_str(), op.second);
+                break;
+              }
+            case 2:
+                flag = GRBsetdblparam(GRBgetenv(model), op.first.c_str(), op.second);
+                break;
+            case 3:
+              {
+                std::string s = op.second;
+                flag = GRBsetstrparam(GRBgetenv(model), op.first.c_str(), s.c_str());
+                break;
+              }
+            default:
+              casadi_error("Not implememented : " + str(ret));
+          }
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
         }
-        casadi_assert(!flag, GRBgeterrormsg(m->env));
+
+        // Remember the data for updating the model in place
+        if (persistent_) cache_data(m, arg, vtypes);
       }
 
       m->fstats.at("preprocessing").toc();
@@ -502,17 +688,13 @@ namespace casadi {
         if (flag) std::fill_n(lam_x, nx_, casadi::nan);
       }
       if (lam_a) {
-        flag = GRBgetdblattrarray(model, "Pi", 0, npi, get_ptr(pi));
+        std::vector<double> pi(m->npi);
+        flag = GRBgetdblattrarray(model, "Pi", 0, m->npi, get_ptr(pi));
         if (flag) {
           std::fill_n(lam_a, na_, casadi::nan);
         } else {
-          const double * p = get_ptr(pi);
           for (casadi_int i=0;i<na_;++i) {
-            if (constraint_type[i]==0) {
-              lam_a[i] = 0;
-            } else if (constraint_type[i]==1) {
-              lam_a[i] = -(*p++);
-            }
+            lam_a[i] = m->row_index[i]<0 ? 0 : -pi[m->row_index[i]];
           }
         }
       }
@@ -538,13 +720,23 @@ namespace casadi {
         }
       }
 
-      // Free memory
-      GRBfreemodel(model);
+      if (persistent_) {
+        // Keep the model and solution for the next call
+        m->model = model;
+        m->x_prev.resize(nx_);
+        flag = GRBgetdblattrarray(model, "X", 0, nx_, get_ptr(m->x_prev));
+        if (flag) std::fill(m->x_prev.begin(), m->x_prev.end(), casadi::nan);
+      } else {
+        // Free memory
+        GRBfreemodel(model);
+      }
       m->fstats.at("postprocessing").toc();
 
     } catch (...) {
       // Free memory
-      if (model) GRBfreemodel(model);
+      if (model && model!=m->model) GRBfreemodel(model);
+      if (m->model) GRBfreemodel(m->model);
+      m->model = nullptr;
       throw;
     }
 
@@ -556,6 +748,7 @@ namespace casadi {
     auto m = static_cast<GurobiMemory*>(mem);
     stats["return_status"] = return_status_string(m->return_status);
     stats["pool_sol_nr"] = m->pool_sol_nr;
+    stats["model_reused"] = m->model_reused;
     stats["pool_obj_val"] = m->pool_obj_vals;
 	  stats["pool_solutions"] = m->pool_solutions;
     return stats;
@@ -563,16 +756,23 @@ namespace casadi {
 
   GurobiMemory::GurobiMemory() {
     this->env = nullptr;
+    this->model = nullptr;
   }
 
   GurobiMemory::~GurobiMemory() {
+    if (this->model) GRBfreemodel(this->model);
     if (this->env) GRBfreeenv(this->env);
   }
 
   GurobiInterface::GurobiInterface(DeserializingStream& s) : Conic(s) {
-    s.version("GurobiInterface", 1);
+    int version = s.version("GurobiInterface", 1, 2);
     s.unpack("GurobiInterface::vtype", vtype_);
     s.unpack("GurobiInterface::opts", opts_);
+    if (version >= 2) {
+      s.unpack("GurobiInterface::persistent", persistent_);
+    } else {
+      persistent_ = false;
+    }
     s.unpack("GurobiInterface::sos_weights", sos_weights_);
     s.unpack("GurobiInterface::sos_beg", sos_beg_);
     s.unpack("GurobiInterface::sos_ind", sos_ind_);
@@ -582,9 +782,10 @@ namespace casadi {
 
   void GurobiInterface::serialize_body(SerializingStream &s) const {
     Conic::serialize_body(s);
-    s.version("GurobiInterface", 1);
+    s.version("GurobiInterface", 2);
     s.pack("GurobiInterface::vtype", vtype_);
     s.pack("GurobiInterface::opts", opts_);
+    s.pack("GurobiInterface::persistent", persistent_);
     s.pack("GurobiInterface::sos_weights", sos_weights_);
     s.pack("GurobiInterface::sos_beg", sos_beg_);
     s.pack("GurobiInterface::sos_ind", sos_ind_);
@@ -50,6 +50,32 @@ namespace casadi {
     // Gurobi environment
     GRBenv *env;
 
+    // Model kept between calls with the 'persistent' option, null if none
+    GRBmodel *model;
+
+    // Was the model of the previous call reused
+    bool model_reused;
+
+    // Type of each row of A: 0 absent, otherwise the sense, 'R' for ranges
+    std::vector<char> row_type;
+
+    // Constraint index of each row of A in the model, -1 if absent
+    std::vector<int> row_index;
+
+    // Number of linear constraints in the model
+    int npi;
+
+    // Data the model was built or last updated with, A in transposed order
+    std::vector<char> vtype;
+    std::vector<double> lbx, ubx, g, lba, uba, a, h, p, q;
+
+    // Coefficient changes of A
+    std::vector<int> cind, vind;
+    std::vector<double> cval;
+
+    // Solution of the previous call
+    std::vector<double> x_prev;
+
     int return_status;
 
     int pool_sol_nr;
@@ -130,6 +156,20 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /// Type of a variable given its bounds
+    char var_type(casadi_int i, double lb, double ub) const;
+
+    /// Add the quadratic cost terms to a model
+    void add_qpterms(GurobiMemory* m, GRBmodel* model, const double* h,
+      int* ind, int* ind2, double* val) const;
+
+    /// Remember the data a persistent model was built with
+    void cache_data(GurobiMemory* m, const double** arg, const char* vtypes) const;
+
+    /// Update a persistent model in place, false if it needs to be rebuilt
+    bool update_model(GurobiMemory* m, const double** arg,
+      int* ind, int* ind2, double* val) const;
+
     // Variable types
     std::vector<char> vtype_;
 
@@ -142,6 +182,9 @@ namespace casadi {
     /// Gurobi options
     Dict opts_;
 
+    /// Keep the model alive between calls and update it in place
+    bool persistent_;
+
     /// SDP to SOCP conversion memory
     SDPToSOCPMem sdp_to_socp_mem_;
 
@@ -164,6 +164,13 @@ namespace casadi {
     auto m = static_cast<HighsMemory*>(mem);
     highs_init_mem(&m->d);
 
+    // Keep the matrices to detect when only vectors change, so that the basis is reused
+    m->a_prev.resize(A_.nnz());
+    m->h_prev.resize(H_.nnz());
+    m->d.a_prev = get_ptr(m->a_prev);
+    m->d.h_prev = get_ptr(m->h_prev);
+    m->d.keep_model = 1;
+
     m->add_stat("preprocessing");
     m->add_stat("solver");
     m->add_stat("postprocessing");
@@ -216,10 +223,10 @@ namespace casadi {
     auto m = static_cast<HighsMemory*>(mem);
 
     // Statistics
-    m->fstats.at("solver").tic();
+    if (m->t_total) m->fstats.at("solver").tic();
 
     casadi_highs_solve(&m->d, arg, res, iw, w);
-    m->fstats.at("solver").toc();
+    if (m->t_total) m->fstats.at("solver").toc();
 
     return 0;
   }
@@ -241,6 +248,7 @@ namespace casadi {
     g.add_auxiliary(CodeGenerator::AUX_CLIP_MAX);
     g.add_auxiliary(CodeGenerator::AUX_DOT);
     g.add_auxiliary(CodeGenerator::AUX_BILIN);
+    g.add_auxiliary(CodeGenerator::AUX_COPY);
     g.add_include("interfaces/highs_c_api.h");
 
     g.auxiliaries << g.sanitize_source(highs_runtime_str, {"casadi_real"});
@@ -56,6 +56,8 @@ namespace casadi {
     // Problem data structure
     casadi_highs_data<double> d;
 
+    // Matrix nonzeros of the model in the HiGHS instance
+    std::vector<double> a_prev, h_prev;
   };
 
   /** \brief \pluginbrief{Conic,highs}
@@ -69,6 +69,13 @@ struct casadi_highs_data {
   T1 sum_dual_infeasibilities;
 
   void* highs;
+
+  // Keep the matrix nonzeros in a_prev, h_prev to detect unchanged matrices?
+  int keep_model;
+  // Has a model been passed to the HiGHS instance?
+  int model_passed;
+  // Matrix nonzeros of that model
+  T1 *a_prev, *h_prev;
 };
 // C-REPLACE "casadi_highs_data<T1>" "struct casadi_highs_data"
 
@@ -76,6 +83,10 @@ struct casadi_highs_data {
 template<typename T1>
 int highs_init_mem(casadi_highs_data<T1>* d) {
   d->highs = Highs_create();
+  d->keep_model = 0;
+  d->model_passed = 0;
+  d->a_prev = 0;
+  d->h_prev = 0;
   return 0;
 }
 
@@ -111,20 +122,45 @@ int casadi_highs_solve(casadi_highs_data<T1>* d, const double** arg, double** re
   casadi_qp_data<T1>* d_qp = d->qp;
 
 
-  // Create HiGHS instance and pass problem
-  int status;
+  // Pass problem, or only the vectors if the matrices are unchanged, keeping the basis
+  int status, reuse;
+  casadi_int k;
   const int matrix_format = 1;
   const int sense = 1;
   const double offset = 0.0;
 
-  status = Highs_passModel(d->highs, p_qp->nx, p_qp->na, p_qp->nnz_a, p_qp->nnz_h,
-    matrix_format, matrix_format, sense, offset,
-    d_qp->g, d_qp->lbx, d_qp->ubx, d_qp->lba, d_qp->uba,
-    p->colinda, p->rowa, d_qp->a,
-    p->colindh, p->rowh, d_qp->h,
-    p->integrality);
-  
-  if (!(status==kHighsStatusOk || status==kHighsStatusWarning)) return 1;
+  reuse = d->keep_model && d->model_passed;
+  for (k=0; reuse && k<p_qp->nnz_a; ++k) reuse = d_qp->a[k]==d->a_prev[k];
+  for (k=0; reuse && k<p_qp->nnz_h; ++k) reuse = d_qp->h[k]==d->h_prev[k];
+
+  if (reuse) {
+    // Pass the full model next time if an update fails
+    d->model_passed = 0;
+    if (p_qp->nx>0) {
+      status = Highs_changeColsCostByRange(d->highs, 0, p_qp->nx-1, d_qp->g);
+      if (!(status==kHighsStatusOk || status==kHighsStatusWarning)) return 1;
+      status = Highs_changeColsBoundsByRange(d->highs, 0, p_qp->nx-1, d_qp->lbx, d_qp->ubx);
+      if (!(status==kHighsStatusOk || status==kHighsStatusWarning)) return 1;
+    }
+    if (p_qp->na>0) {
+      status = Highs_changeRowsBoundsByRange(d->highs, 0, p_qp->na-1, d_qp->lba, d_qp->uba);
+      if (!(status==kHighsStatusOk || status==kHighsStatusWarning)) return 1;
+    }
+    d->model_passed = 1;
+  } else {
+    status = Highs_passModel(d->highs, p_qp->nx, p_qp->na, p_qp->nnz_a, p_qp->nnz_h,
+      matrix_format, matrix_format, sense, offset,
+      d_qp->g, d_qp->lbx, d_qp->ubx, d_qp->lba, d_qp->uba,
+      p->colinda, p->rowa, d_qp->a,
+      p->colindh, p->rowh, d_qp->h,
+      p->integrality);
+    if (!(status==kHighsStatusOk || status==kHighsStatusWarning)) return 1;
+    if (d->keep_model) {
+      casadi_copy(d_qp->a, p_qp->nnz_a, d->a_prev);
+      casadi_copy(d_qp->h, p_qp->nnz_h, d->h_prev);
+      d->model_passed = 1;
+    }
+  }
 
   // solve incumbent model
   status = Highs_run(d->highs);
@@ -0,0 +1,287 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "ma57_interface.hpp"
+#include "casadi/core/global_options.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_LINSOL_MA57_EXPORT
+  casadi_register_linsol_ma57(LinsolInternal::Plugin* plugin) {
+    plugin->creator = Ma57Interface::creator;
+    plugin->name = "ma57";
+    plugin->doc = Ma57Interface::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Ma57Interface::options_;
+    plugin->deserialize = &Ma57Interface::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_LINSOL_MA57_EXPORT casadi_load_linsol_ma57() {
+    LinsolInternal::registerPlugin(casadi_register_linsol_ma57);
+  }
+
+  Ma57Interface::Ma57Interface(const std::string& name, const Sparsity& sp)
+    : LinsolInternal(name, sp) {
+  }
+
+  Ma57Interface::~Ma57Interface() {
+    clear_mem();
+  }
+
+  const Options Ma57Interface::options_
+  = {{&ProtoFunction::options_},
+     {{"pivtol",
+       {OT_DOUBLE,
+       "Relative pivot tolerance, CNTL(1) [default 1e-8]"}},
+      {"ordering",
+       {OT_INT,
+       "Pivot ordering computed in the analysis phase, ICNTL(6) [default 5: automatic]"}},
+      {"scaling",
+       {OT_BOOL,
+       "Scale the matrix before factorization, ICNTL(15) [default true]"}},
+      {"static_pivoting",
+       {OT_BOOL,
+       "Replace small pivots instead of delaying them [default false]"}},
+      {"static_tol",
+       {OT_DOUBLE,
+       "Pivots smaller than this are replaced when static pivoting, CNTL(4) [default 1e-10]"}},
+      {"static_value",
+       {OT_DOUBLE,
+       "Value that small pivots are replaced with when static pivoting, CNTL(5) "
+       "[default 1e-10]"}}
+     }
+  };
+
+  void Ma57Interface::init(const Dict& opts) {
+    // Call the init method of the base class
+    LinsolInternal::init(opts);
+
+    // Default options
+    pivtol_ = 1e-8;
+    ordering_ = 5;
+    scaling_ = true;
+    static_pivoting_ = false;
+    static_tol_ = 1e-10;
+    static_value_ = 1e-10;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="pivtol") {
+        pivtol_ = op.second;
+      } else if (op.first=="ordering") {
+        ordering_ = op.second;
+      } else if (op.first=="scaling") {
+        scaling_ = op.second;
+      } else if (op.first=="static_pivoting") {
+        static_pivoting_ = op.second;
+      } else if (op.first=="static_tol") {
+        static_tol_ = op.second;
+      } else if (op.first=="static_value") {
+        static_value_ = op.second;
+      }
+    }
+  }
+
+  int Ma57Interface::init_mem(void* mem) const {
+    if (LinsolInternal::init_mem(mem)) return 1;
+    auto m = static_cast<Ma57Memory*>(mem);
+
+    // Set default options for MA57
+    ma57id_(m->cntl, m->icntl);
+    m->icntl[1 - 1] = -1;  // Suppress error messages
+    m->icntl[2 - 1] = -1;  // Suppress warning messages
+    m->icntl[3 - 1] = -1;  // Suppress diagnostic messages
+    m->icntl[5 - 1] = 0;   // No printing
+    m->icntl[6 - 1] = ordering_;
+    m->icntl[15 - 1] = scaling_ ? 1 : 0;
+    m->cntl[1 - 1] = pivtol_;
+    if (static_pivoting_) {
+      m->icntl[7 - 1] = 1;  // Threshold pivoting, required for static pivoting
+      m->cntl[4 - 1] = static_tol_;
+      m->cntl[5 - 1] = static_value_;
+    }
+
+    // Sparsity pattern in MA57 format, upper triangular part
+    casadi_int n = this->ncol();
+    casadi_int nnz = sp_.nnz_upper();
+    m->nz.resize(nnz);
+    m->irn.clear();
+    m->jcn.clear();
+    m->irn.reserve(nnz);
+    m->jcn.reserve(nnz);
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+    for (casadi_int c = 0; c < n; ++c) {
+      for (casadi_int k = colind[c]; k < colind[c + 1]; ++k) {
+        if (row[k] <= c) {
+          m->irn.push_back(row[k] + 1);
+          m->jcn.push_back(c + 1);
+        }
+      }
+    }
+
+    // Work vectors
+    m->keep.resize(5*n + nnz + std::max(n, nnz) + 42);
+    m->iwork.resize(5*n);
+    m->is_analyzed = false;
+    return 0;
+  }
+
+  int Ma57Interface::sfact(void* mem, const double* A) const {
+    auto m = static_cast<Ma57Memory*>(mem);
+
+    // The analysis depends only on the sparsity pattern, which is fixed
+    if (m->is_analyzed) return 0;
+
+    // Analysis phase (MA57AD)
+    int N = this->ncol();
+    int NE = m->nz.size();
+    int LKEEP = m->keep.size();
+    ma57ad_(&N, &NE, get_ptr(m->irn), get_ptr(m->jcn), &LKEEP, get_ptr(m->keep),
+            get_ptr(m->iwork), m->icntl, m->info, m->rinfo);
+    if (m->info[1 - 1] < 0) {
+      if (verbose_) casadi_message("ma57ad_ returns INFO(1) = " + str(m->info[1 - 1]));
+      return 1;
+    }
+
+    // Allocate the recommended memory for the factors, with some margin
+    m->fact.resize(std::max(static_cast<casadi_int>(1.2 * m->info[9 - 1]), casadi_int(1)));
+    m->ifact.resize(std::max(static_cast<casadi_int>(1.2 * m->info[10 - 1]), casadi_int(1)));
+    m->is_analyzed = true;
+    return 0;
+  }
+
+  int Ma57Interface::nfact(void* mem, const double* A) const {
+    auto m = static_cast<Ma57Memory*>(mem);
+    casadi_assert_dev(A!=nullptr);
+
+    // Analysis, if not already performed
+    if (sfact(mem, A)) return 1;
+
+    // Get upper triangular entries
+    casadi_int n = this->ncol();
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+    auto nz_it = m->nz.begin();
+    for (casadi_int c = 0; c < n; ++c) {
+      for (casadi_int k = colind[c]; k < colind[c + 1]; ++k) {
+        if (row[k] <= c) *nz_it++ = A[k];
+      }
+    }
+
+    // Numerical factorization (MA57BD), enlarging the factor storage if needed
+    int N = n;
+    int NE = m->nz.size();
+    int LKEEP = m->keep.size();
+    while (true) {
+      int LFACT = m->fact.size();
+      int LIFACT = m->ifact.size();
+      ma57bd_(&N, &NE, get_ptr(m->nz), get_ptr(m->fact), &LFACT, get_ptr(m->ifact),
+              &LIFACT, &LKEEP, get_ptr(m->keep), get_ptr(m->iwork), m->icntl, m->cntl,
+              m->info, m->rinfo);
+      if (m->info[1 - 1] == -3) {
+        m->fact.resize(std::max(2 * m->fact.size(), static_cast<size_t>(m->info[17 - 1])));
+      } else if (m->info[1 - 1] == -4) {
+        m->ifact.resize(std::max(2 * m->ifact.size(), static_cast<size_t>(m->info[18 - 1])));
+      } else {
+        break;
+      }
+    }
+    if (m->info[1 - 1] < 0) {
+      if (verbose_) casadi_message("ma57bd_ returns INFO(1) = " + str(m->info[1 - 1]));
+      return 1;
+    }
+    m->neig = m->info[24 - 1];
+    m->rank = m->info[25 - 1];
+    return 0;
+  }
+
+  casadi_int Ma57Interface::neig(void* mem, const double* A) const {
+    auto m = static_cast<Ma57Memory*>(mem);
+    casadi_assert_dev(m->is_nfact);
+    return m->neig;
+  }
+
+  casadi_int Ma57Interface::rank(void* mem, const double* A) const {
+    auto m = static_cast<Ma57Memory*>(mem);
+    casadi_assert_dev(m->is_nfact);
+    return m->rank;
+  }
+
+  int Ma57Interface::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
+    auto m = static_cast<Ma57Memory*>(mem);
+
+    // Solve for all right-hand-sides at once (MA57CD), the matrix is symmetric
+    int JOB = 1;
+    int N = this->ncol();
+    int NRHS = nrhs;
+    int LFACT = m->fact.size();
+    int LIFACT = m->ifact.size();
+    if (m->work.size() < static_cast<size_t>(N * nrhs)) m->work.resize(N * nrhs);
+    int LWORK = m->work.size();
+    ma57cd_(&JOB, &N, get_ptr(m->fact), &LFACT, get_ptr(m->ifact), &LIFACT,
+            &NRHS, x, &N, get_ptr(m->work), &LWORK, get_ptr(m->iwork), m->icntl,
+            m->info);
+    if (m->info[1 - 1] < 0) {
+      if (verbose_) casadi_message("ma57cd_ returns INFO(1) = " + str(m->info[1 - 1]));
+      return 1;
+    }
+    return 0;
+  }
+
+  Ma57Memory::Ma57Memory() {
+    is_analyzed = false;
+    neig = -1;
+    rank = -1;
+  }
+
+  Ma57Memory::~Ma57Memory() {
+  }
+
+  Ma57Interface::Ma57Interface(DeserializingStream& s) : LinsolInternal(s) {
+    s.version("Ma57", 1);
+    s.unpack("Ma57Interface::pivtol", pivtol_);
+    s.unpack("Ma57Interface::ordering", ordering_);
+    s.unpack("Ma57Interface::scaling", scaling_);
+    s.unpack("Ma57Interface::static_pivoting", static_pivoting_);
+    s.unpack("Ma57Interface::static_tol", static_tol_);
+    s.unpack("Ma57Interface::static_value", static_value_);
+  }
+
+  void Ma57Interface::serialize_body(SerializingStream &s) const {
+    LinsolInternal::serialize_body(s);
+    s.version("Ma57", 1);
+    s.pack("Ma57Interface::pivtol", pivtol_);
+    s.pack("Ma57Interface::ordering", ordering_);
+    s.pack("Ma57Interface::scaling", scaling_);
+    s.pack("Ma57Interface::static_pivoting", static_pivoting_);
+    s.pack("Ma57Interface::static_tol", static_tol_);
+    s.pack("Ma57Interface::static_value", static_value_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,186 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_MA57_INTERFACE_HPP
+#define CASADI_MA57_INTERFACE_HPP
+
+#include "casadi/core/linsol_internal.hpp"
+#include <casadi/interfaces/hsl/casadi_linsol_ma57_export.h>
+
+extern "C" {
+  void ma57id_(double* CNTL, int* ICNTL);
+  void ma57ad_(int* N, int* NE, const int* IRN, const int* JCN,
+               int* LKEEP, int* KEEP, int* IWORK, int* ICNTL,
+               int* INFO, double* RINFO);
+  void ma57bd_(int* N, int* NE, const double* A, double* FACT, int* LFACT,
+               int* IFACT, int* LIFACT, int* LKEEP, int* KEEP, int* IWORK,
+               int* ICNTL, double* CNTL, int* INFO, double* RINFO);
+  void ma57cd_(int* JOB, int* N, double* FACT, int* LFACT, int* IFACT,
+               int* LIFACT, int* NRHS, double* RHS, int* LRHS, double* WORK,
+               int* LWORK, int* IWORK, int* ICNTL, int* INFO);
+}
+
+/** \defgroup plugin_Linsol_ma57 Title
+    \par
+
+ * Interface to the sparse direct linear solver MA57
+ * Works for symmetric indefinite systems
+ * The analysis phase is performed once for the fixed sparsity pattern.
+ * Static pivoting can be enabled to avoid delayed pivots, in which case the
+ * factorization is that of a slightly perturbed matrix.
+
+    \identifier{27j} */
+
+/** \pluginsection{Linsol,ma57} */
+/// \cond INTERNAL
+namespace casadi {
+  struct CASADI_LINSOL_MA57_EXPORT Ma57Memory : public LinsolMemory {
+    // Constructor
+    Ma57Memory();
+
+    // Destructor
+    ~Ma57Memory();
+
+    /* Upper triangular nonzeros of the matrix */
+    std::vector<double> nz;
+
+    /* Row and column indices of the nonzeros (IRN and JCN in MA57) */
+    std::vector<int> irn, jcn;
+
+    /* Control values (ICNTL and CNTL in MA57) */
+    int icntl[20];
+    double cntl[5];
+
+    /* Information (INFO and RINFO in MA57) */
+    int info[40];
+    double rinfo[20];
+
+    /* Analysis data (KEEP in MA57) */
+    std::vector<int> keep;
+
+    /* Integer work space (IWORK in MA57) */
+    std::vector<int> iwork;
+
+    /* Factors (FACT and IFACT in MA57) */
+    std::vector<double> fact;
+    std::vector<int> ifact;
+
+    /* Real work space (WORK in MA57CD) */
+    std::vector<double> work;
+
+    // Has the analysis phase been performed?
+    bool is_analyzed;
+
+    /* number of negative eigenvalues */
+    int neig;
+
+    // Rank of matrix
+    int rank;
+  };
+
+  /** \brief \pluginbrief{Linsol,ma57}
+   * @copydoc Linsol_doc
+   * @copydoc plugin_Linsol_ma57
+   */
+  class CASADI_LINSOL_MA57_EXPORT Ma57Interface : public LinsolInternal {
+  public:
+
+    // Create a linear solver given a sparsity pattern and a number of right hand sides
+    Ma57Interface(const std::string& name, const Sparsity& sp);
+
+    /** \brief  Create a new Linsol */
+    static LinsolInternal* creator(const std::string& name, const Sparsity& sp) {
+      return new Ma57Interface(name, sp);
+    }
+
+    // Destructor
+    ~Ma57Interface() override;
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new Ma57Memory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<Ma57Memory*>(mem);}
+
+    // Analysis phase, performed once since the sparsity pattern is fixed
+    int sfact(void* mem, const double* A) const override;
+
+    // Factorize the linear system
+    int nfact(void* mem, const double* A) const override;
+
+    /// Number of negative eigenvalues
+    casadi_int neig(void* mem, const double* A) const override;
+
+    /// Matrix rank
+    casadi_int rank(void* mem, const double* A) const override;
+
+    // Solve the linear system
+    int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "ma57";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Ma57Interface";}
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new Ma57Interface(s); }
+
+    ///@{
+    // Options
+    double pivtol_;
+    casadi_int ordering_;
+    bool scaling_, static_pivoting_;
+    double static_tol_, static_value_;
+    ///@}
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit Ma57Interface(DeserializingStream& s);
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_MA57_INTERFACE_HPP
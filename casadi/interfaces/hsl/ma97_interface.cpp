@@ -0,0 +1,242 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "ma97_interface.hpp"
+#include "casadi/core/global_options.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_LINSOL_MA97_EXPORT
+  casadi_register_linsol_ma97(LinsolInternal::Plugin* plugin) {
+    plugin->creator = Ma97Interface::creator;
+    plugin->name = "ma97";
+    plugin->doc = Ma97Interface::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Ma97Interface::options_;
+    plugin->deserialize = &Ma97Interface::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_LINSOL_MA97_EXPORT casadi_load_linsol_ma97() {
+    LinsolInternal::registerPlugin(casadi_register_linsol_ma97);
+  }
+
+  Ma97Interface::Ma97Interface(const std::string& name, const Sparsity& sp)
+    : LinsolInternal(name, sp) {
+  }
+
+  Ma97Interface::~Ma97Interface() {
+    clear_mem();
+  }
+
+  const Options Ma97Interface::options_
+  = {{&ProtoFunction::options_},
+     {{"pivtol",
+       {OT_DOUBLE,
+       "Relative pivot tolerance, control.u [default 1e-8]"}},
+      {"ordering",
+       {OT_INT,
+       "Pivot ordering computed in the analysis phase, control.ordering "
+       "[default 5: automatic]"}},
+      {"scaling",
+       {OT_INT,
+       "Scaling algorithm, control.scaling [default 0: no scaling]"}},
+      {"factor_min",
+       {OT_INT,
+       "Minimum number of flops for a parallel factorization, control.factor_min "
+       "[default 20000000]"}},
+      {"solve_min",
+       {OT_INT,
+       "Minimum number of entries in the factors for a parallel solve, control.solve_min "
+       "[default 100000]"}}
+     }
+  };
+
+  void Ma97Interface::init(const Dict& opts) {
+    // Call the init method of the base class
+    LinsolInternal::init(opts);
+
+    // Default options
+    pivtol_ = 1e-8;
+    ordering_ = 5;
+    scaling_ = 0;
+    factor_min_ = 20000000;
+    solve_min_ = 100000;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="pivtol") {
+        pivtol_ = op.second;
+      } else if (op.first=="ordering") {
+        ordering_ = op.second;
+      } else if (op.first=="scaling") {
+        scaling_ = op.second;
+      } else if (op.first=="factor_min") {
+        factor_min_ = op.second;
+      } else if (op.first=="solve_min") {
+        solve_min_ = op.second;
+      }
+    }
+  }
+
+  int Ma97Interface::init_mem(void* mem) const {
+    if (LinsolInternal::init_mem(mem)) return 1;
+    auto m = static_cast<Ma97Memory*>(mem);
+
+    // Free existing analysis and factorization, if any
+    ma97_finalise_d(&m->akeep, &m->fkeep);
+    m->is_analyzed = false;
+
+    // Set default options for MA97
+    ma97_default_control_d(&m->control);
+    m->control.f_arrays = 0;      // C numbering
+    m->control.action = 1;        // Continue if singular
+    m->control.print_level = -1;  // No printing
+    m->control.u = pivtol_;
+    m->control.ordering = ordering_;
+    m->control.scaling = scaling_;
+    m->control.factor_min = factor_min_;
+    m->control.solve_min = solve_min_;
+
+    // Sparsity pattern in MA97 format, lower triangular part
+    casadi_int n = this->ncol();
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+    m->ptr.resize(n + 1);
+    m->row.clear();
+    m->ptr[0] = 0;
+    for (casadi_int c = 0; c < n; ++c) {
+      for (casadi_int k = colind[c]; k < colind[c + 1]; ++k) {
+        if (row[k] >= c) m->row.push_back(row[k]);
+      }
+      m->ptr[c + 1] = m->row.size();
+    }
+    m->val.resize(m->row.size());
+    return 0;
+  }
+
+  int Ma97Interface::sfact(void* mem, const double* A) const {
+    auto m = static_cast<Ma97Memory*>(mem);
+
+    // The analysis depends only on the sparsity pattern, which is fixed
+    if (m->is_analyzed) return 0;
+
+    // Analysis phase
+    ma97_analyse_d(0, this->ncol(), get_ptr(m->ptr), get_ptr(m->row), nullptr,
+                   &m->akeep, &m->control, &m->info, nullptr);
+    if (m->info.flag < 0) {
+      if (verbose_) casadi_message("ma97_analyse_d returns flag = " + str(m->info.flag));
+      return 1;
+    }
+    m->is_analyzed = true;
+    return 0;
+  }
+
+  int Ma97Interface::nfact(void* mem, const double* A) const {
+    auto m = static_cast<Ma97Memory*>(mem);
+    casadi_assert_dev(A!=nullptr);
+
+    // Analysis, if not already performed
+    if (sfact(mem, A)) return 1;
+
+    // Get lower triangular entries
+    casadi_int n = this->ncol();
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+    auto val_it = m->val.begin();
+    for (casadi_int c = 0; c < n; ++c) {
+      for (casadi_int k = colind[c]; k < colind[c + 1]; ++k) {
+        if (row[k] >= c) *val_it++ = A[k];
+      }
+    }
+
+    // Numerical factorization of a real symmetric indefinite matrix
+    const int matrix_type = 4;
+    ma97_factor_d(matrix_type, get_ptr(m->ptr), get_ptr(m->row), get_ptr(m->val),
+                  &m->akeep, &m->fkeep, &m->control, &m->info, nullptr);
+    if (m->info.flag < 0) {
+      if (verbose_) casadi_message("ma97_factor_d returns flag = " + str(m->info.flag));
+      return 1;
+    }
+    return 0;
+  }
+
+  casadi_int Ma97Interface::neig(void* mem, const double* A) const {
+    auto m = static_cast<Ma97Memory*>(mem);
+    casadi_assert_dev(m->is_nfact);
+    return m->info.num_neg;
+  }
+
+  casadi_int Ma97Interface::rank(void* mem, const double* A) const {
+    auto m = static_cast<Ma97Memory*>(mem);
+    casadi_assert_dev(m->is_nfact);
+    return m->info.matrix_rank;
+  }
+
+  int Ma97Interface::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
+    auto m = static_cast<Ma97Memory*>(mem);
+
+    // Solve for all right-hand-sides at once, the matrix is symmetric
+    int n = this->ncol();
+    ma97_solve_d(0, nrhs, x, n, &m->akeep, &m->fkeep, &m->control, &m->info);
+    if (m->info.flag < 0) {
+      if (verbose_) casadi_message("ma97_solve_d returns flag = " + str(m->info.flag));
+      return 1;
+    }
+    return 0;
+  }
+
+  Ma97Memory::Ma97Memory() {
+    akeep = nullptr;
+    fkeep = nullptr;
+    is_analyzed = false;
+  }
+
+  Ma97Memory::~Ma97Memory() {
+    ma97_finalise_d(&akeep, &fkeep);
+  }
+
+  Ma97Interface::Ma97Interface(DeserializingStream& s) : LinsolInternal(s) {
+    s.version("Ma97", 1);
+    s.unpack("Ma97Interface::pivtol", pivtol_);
+    s.unpack("Ma97Interface::ordering", ordering_);
+    s.unpack("Ma97Interface::scaling", scaling_);
+    s.unpack("Ma97Interface::factor_min", factor_min_);
+    s.unpack("Ma97Interface::solve_min", solve_min_);
+  }
+
+  void Ma97Interface::serialize_body(SerializingStream &s) const {
+    LinsolInternal::serialize_body(s);
+    s.version("Ma97", 1);
+    s.pack("Ma97Interface::pivtol", pivtol_);
+    s.pack("Ma97Interface::ordering", ordering_);
+    s.pack("Ma97Interface::scaling", scaling_);
+    s.pack("Ma97Interface::factor_min", factor_min_);
+    s.pack("Ma97Interface::solve_min", solve_min_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,209 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_MA97_INTERFACE_HPP
+#define CASADI_MA97_INTERFACE_HPP
+
+#include "casadi/core/linsol_internal.hpp"
+#include <casadi/interfaces/hsl/casadi_linsol_ma97_export.h>
+
+extern "C" {
+  // C interface of MA97, as declared in hsl_ma97d.h
+  struct ma97_control_d {
+    int f_arrays;
+    int action;
+    int nemin;
+    double multiplier;
+    int ordering;
+    int print_level;
+    int scaling;
+    double small;
+    double u;
+    int unit_diagnostics;
+    int unit_error;
+    int unit_warning;
+    long factor_min;
+    int solve_blas3;
+    long solve_min;
+    int solve_mf;
+    double consist_tol;
+    int ispare[5];
+    double rspare[10];
+  };
+
+  struct ma97_info_d {
+    int flag;
+    int flag68;
+    int flag77;
+    int matrix_dup;
+    int matrix_rank;
+    int matrix_outrange;
+    int matrix_missing_diag;
+    int maxdepth;
+    int maxfront;
+    int num_delay;
+    long num_factor;
+    long num_flops;
+    int num_neg;
+    int num_sup;
+    int num_two;
+    int ordering;
+    int stat;
+    int maxsupernode;
+    int ispare[4];
+    double rspare[10];
+  };
+
+  void ma97_default_control_d(struct ma97_control_d* control);
+  void ma97_analyse_d(int check, int n, const int ptr[], const int row[], double val[],
+                      void** akeep, const struct ma97_control_d* control,
+                      struct ma97_info_d* info, int order[]);
+  void ma97_factor_d(int matrix_type, const int ptr[], const int row[], const double val[],
+                     void** akeep, void** fkeep, const struct ma97_control_d* control,
+                     struct ma97_info_d* info, double scale[]);
+  void ma97_solve_d(int job, int nrhs, double x[], int ldx, void** akeep, void** fkeep,
+                    const struct ma97_control_d* control, struct ma97_info_d* info);
+  void ma97_finalise_d(void** akeep, void** fkeep);
+}
+
+/** \defgroup plugin_Linsol_ma97 Title
+    \par
+
+ * Interface to the sparse direct linear solver MA97
+ * Works for symmetric indefinite systems
+ * The factorization and solve are multithreaded with OpenMP, the number of
+ * threads is set with the OMP_NUM_THREADS environment variable. The analysis
+ * phase is performed once for the fixed sparsity pattern.
+
+    \identifier{27k} */
+
+/** \pluginsection{Linsol,ma97} */
+/// \cond INTERNAL
+namespace casadi {
+  struct CASADI_LINSOL_MA97_EXPORT Ma97Memory : public LinsolMemory {
+    // Constructor
+    Ma97Memory();
+
+    // Destructor
+    ~Ma97Memory();
+
+    /* Lower triangular part of the matrix, compressed column format */
+    std::vector<int> ptr, row;
+    std::vector<double> val;
+
+    /* Control values and information */
+    ma97_control_d control;
+    ma97_info_d info;
+
+    /* Analysis and factorization data */
+    void* akeep;
+    void* fkeep;
+
+    // Has the analysis phase been performed?
+    bool is_analyzed;
+  };
+
+  /** \brief \pluginbrief{Linsol,ma97}
+   * @copydoc Linsol_doc
+   * @copydoc plugin_Linsol_ma97
+   */
+  class CASADI_LINSOL_MA97_EXPORT Ma97Interface : public LinsolInternal {
+  public:
+
+    // Create a linear solver given a sparsity pattern and a number of right hand sides
+    Ma97Interface(const std::string& name, const Sparsity& sp);
+
+    /** \brief  Create a new Linsol */
+    static LinsolInternal* creator(const std::string& name, const Sparsity& sp) {
+      return new Ma97Interface(name, sp);
+    }
+
+    // Destructor
+    ~Ma97Interface() override;
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new Ma97Memory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<Ma97Memory*>(mem);}
+
+    // Analysis phase, performed once since the sparsity pattern is fixed
+    int sfact(void* mem, const double* A) const override;
+
+    // Factorize the linear system
+    int nfact(void* mem, const double* A) const override;
+
+    /// Number of negative eigenvalues
+    casadi_int neig(void* mem, const double* A) const override;
+
+    /// Matrix rank
+    casadi_int rank(void* mem, const double* A) const override;
+
+    // Solve the linear system
+    int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "ma97";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Ma97Interface";}
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new Ma97Interface(s); }
+
+    ///@{
+    // Options
+    double pivtol_;
+    casadi_int ordering_, scaling_, factor_min_, solve_min_;
+    ///@}
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit Ma97Interface(DeserializingStream& s);
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_MA97_INTERFACE_HPP
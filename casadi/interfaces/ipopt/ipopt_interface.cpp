@@ -108,9 +108,15 @@ namespace casadi {
        {OT_FUNCTION,
         "Function for calculating the gradient of the objective "
         "(column, autogenerated by default)"}},
+      {"fused_oracle",
+       {OT_BOOL,
+        "Evaluate f, g, grad_f and jac_g in one function at each new iterate, "
+        "and serve the individual IPOPT callbacks from its cached result. "
+        "Shared subexpressions are computed once per iterate, but line search "
+        "trial points also compute the derivatives (default: false)."}},
       {"convexify_strategy",
        {OT_STRING,
-        "NONE|regularize|eigen-reflect|eigen-clip. "
+        "NONE|regularize|eigen-reflect|eigen-clip|inertia. "
         "Strategy to convexify the Lagrange Hessian before passing it to the solver."}},
       {"convexify_margin",
        {OT_DOUBLE,
@@ -130,7 +136,14 @@ namespace casadi {
         "abstol: use inactive_lam_value"}},
       {"inactive_lam_value",
        {OT_DOUBLE,
-        "Value used in inactive_lam_strategy (default: 10)."}}
+        "Value used in inactive_lam_strategy (default: 10)."}},
+      {"warm_start",
+       {OT_BOOL,
+        "Warm start from the previous successful solution of the same memory (default: false). "
+        "The bound and constraint multipliers of that solution replace lam_x0 and lam_g0, and "
+        "IPOPT is started with warm_start_init_point=yes and mu_init set to the final barrier "
+        "parameter. The primal initial guess remains x0. "
+        "Tune warm_start_bound_push etc. through the ipopt options."}}
      }
   };
 
@@ -148,6 +161,9 @@ namespace casadi {
     clip_inactive_lam_ = false;
     inactive_lam_strategy_ = "reltol";
     inactive_lam_value_ = 10;
+    warm_start_ = false;
+
+    bool fused_oracle = false;
 
     // Read user options
     for (auto&& op : opts) {
@@ -182,6 +198,8 @@ namespace casadi {
         casadi_assert_dev(f.n_in()==2);
         casadi_assert_dev(f.n_out()==2);
         set_function(f, "nlp_grad_f");
+      } else if (op.first=="fused_oracle") {
+        fused_oracle = op.second;
       } else if (op.first=="convexify_strategy") {
         convexify_strategy = op.second.to_string();
       } else if (op.first=="convexify_margin") {
@@ -194,9 +212,17 @@ namespace casadi {
         inactive_lam_strategy_ = op.second.to_string();
       } else if (op.first=="inactive_lam_value") {
         inactive_lam_value_ = op.second;
+      } else if (op.first=="warm_start") {
+        warm_start_ = op.second;
       }
     }
 
+    if (warm_start_) {
+      casadi_assert(opts_.find("warm_start_init_point")==opts_.end()
+        && opts_.find("mu_init")==opts_.end(),
+        "IPOPT options 'warm_start_init_point' and 'mu_init' are set by 'warm_start'.");
+    }
+
     // Do we need second order derivatives?
     exact_hessian_ = true;
     auto hessian_approximation = opts_.find("hessian_approximation");
@@ -207,6 +233,8 @@ namespace casadi {
     // Setup NLP functions
     create_function("nlp_f", {"x", "p"}, {"f"});
     create_function("nlp_g", {"x", "p"}, {"g"});
+    bool fuse_grad_f = fused_oracle && !has_function("nlp_grad_f");
+    bool fuse_jac_g = fused_oracle && !has_function("nlp_jac_g");
     if (!has_function("nlp_grad_f")) {
       create_function("nlp_grad_f", {"x", "p"}, {"f", "grad:f:x"});
     }
@@ -215,6 +243,18 @@ namespace casadi {
     }
     jacg_sp_ = get_function("nlp_jac_g").sparsity_out(1);
 
+    // All first order quantities from one function
+    if (fused_oracle) {
+      std::vector<std::string> fg_out = {"f", "g"};
+      if (fuse_grad_f) fg_out.push_back("grad:f:x");
+      if (fuse_jac_g) fg_out.push_back("jac:g:x");
+      create_function("nlp_fg", {"x", "p"}, fg_out);
+      set_fused("nlp_f", "nlp_fg", {0});
+      set_fused("nlp_g", "nlp_fg", {1});
+      if (fuse_grad_f) set_fused("nlp_grad_f", "nlp_fg", {0, 2});
+      if (fuse_jac_g) set_fused("nlp_jac_g", "nlp_fg", {1, fuse_grad_f ? 3 : 2});
+    }
+
     convexify_ = false;
 
     // Allocate temporary work vectors
@@ -350,6 +390,14 @@ namespace casadi {
     casadi_assert(status == Solve_Succeeded, "Error during IPOPT initialization");
 
     if (convexify_) m->add_stat("convexify");
+
+    // No previous solution yet
+    m->ws_available = false;
+    if (warm_start_) {
+      m->ws_z_L.resize(nx_);
+      m->ws_z_U.resize(nx_);
+      m->ws_lambda.resize(ng_);
+    }
     return 0;
   }
 
@@ -441,11 +489,26 @@ namespace casadi {
     Ipopt::SmartPtr<Ipopt::IpoptApplication> *app =
       static_cast<Ipopt::SmartPtr<Ipopt::IpoptApplication>*>(m->app);
 
+    // Start from the previous solution, or cold
+    if (warm_start_) {
+      bool ret = (*app)->Options()->SetStringValue("warm_start_init_point",
+        m->ws_available ? "yes" : "no");
+      ret = ret && (*app)->Options()->SetNumericValue("mu_init",
+        m->ws_available ? m->ws_mu : (*app)->RegOptions()->GetOption("mu_init")->DefaultNumber());
+      casadi_assert_dev(ret);
+    }
+
     // Ask Ipopt to solve the problem
     Ipopt::ApplicationReturnStatus status = (*app)->OptimizeTNLP(*userclass);
     m->return_status = return_status_string(status);
     m->success = status==Solve_Succeeded || status==Solved_To_Acceptable_Level
                  || status==Feasible_Point_Found;
+
+    // Keep the multipliers from finalize_solution and the final barrier parameter
+    if (warm_start_) {
+      m->ws_available = m->success && !m->mu.empty();
+      if (m->ws_available) m->ws_mu = m->mu.back();
+    }
     if (status==Maximum_Iterations_Exceeded ||
         status==Maximum_CpuTime_Exceeded) m->unified_return_status = SOLVER_RET_LIMITED;
 
@@ -501,6 +564,7 @@ namespace casadi {
       m->alpha_du.push_back(alpha_du);
       m->ls_trials.push_back(ls_trials);
       m->obj.push_back(obj_value);
+      if (m->stop_check && m->stop_check(obj_value, inf_pr)) return 0;
       if (!fcallback_.is_null()) {
         ScopedTiming tic(m->fstats.at("callback_fun"));
         if (full_callback) {
@@ -578,6 +642,13 @@ namespace casadi {
       // Get the constraints
       casadi_copy(g, ng_, m->gk);
 
+      // Save the primal-dual state for a warm start
+      if (warm_start_) {
+        casadi_copy(z_L, nx_, get_ptr(m->ws_z_L));
+        casadi_copy(z_U, nx_, get_ptr(m->ws_z_U));
+        casadi_copy(lambda, ng_, get_ptr(m->ws_lambda));
+      }
+
       // Get statistics
       m->iter_count = iter_count;
 
@@ -614,7 +685,10 @@ namespace casadi {
       }
 
       // Initialize dual variables (simple bounds)
-      if (init_z) {
+      if (init_z && m->ws_available) {
+        casadi_copy(get_ptr(m->ws_z_L), nx_, z_L);
+        casadi_copy(get_ptr(m->ws_z_U), nx_, z_U);
+      } else if (init_z) {
         for (casadi_int i=0; i<nx_; ++i) {
           z_L[i] = std::max(0., -d_nlp->lam[i]);
           z_U[i] = std::max(0., d_nlp->lam[i]);
@@ -623,7 +697,7 @@ namespace casadi {
 
       // Initialize dual variables (nonlinear bounds)
       if (init_lambda) {
-        casadi_copy(d_nlp->lam + nx_, ng_, lambda);
+        casadi_copy(m->ws_available ? get_ptr(m->ws_lambda) : d_nlp->lam + nx_, ng_, lambda);
       }
 
       return true;
@@ -703,6 +777,7 @@ namespace casadi {
     this->app = nullptr;
     this->userclass = nullptr;
     this->return_status = "Unset";
+    this->ws_available = false;
   }
 
   IpoptMemory::~IpoptMemory() {
@@ -738,7 +813,7 @@ namespace casadi {
   }
 
   IpoptInterface::IpoptInterface(DeserializingStream& s) : Nlpsol(s) {
-    int version = s.version("IpoptInterface", 1, 3);
+    int version = s.version("IpoptInterface", 1, 4);
     s.unpack("IpoptInterface::jacg_sp", jacg_sp_);
     s.unpack("IpoptInterface::hesslag_sp", hesslag_sp_);
     s.unpack("IpoptInterface::exact_hessian", exact_hessian_);
@@ -765,11 +840,16 @@ namespace casadi {
       inactive_lam_strategy_ = "reltol";
       inactive_lam_value_ = 10;
     }
+    if (version>=4) {
+      s.unpack("IpoptInterface::warm_start", warm_start_);
+    } else {
+      warm_start_ = false;
+    }
   }
 
   void IpoptInterface::serialize_body(SerializingStream &s) const {
     Nlpsol::serialize_body(s);
-    s.version("IpoptInterface", 3);
+    s.version("IpoptInterface", 4);
     s.pack("IpoptInterface::jacg_sp", jacg_sp_);
     s.pack("IpoptInterface::hesslag_sp", hesslag_sp_);
     s.pack("IpoptInterface::exact_hessian", exact_hessian_);
@@ -788,6 +868,7 @@ namespace casadi {
     s.pack("IpoptInterface::clip_inactive_lam", clip_inactive_lam_);
     s.pack("IpoptInterface::inactive_lam_strategy", inactive_lam_strategy_);
     s.pack("IpoptInterface::inactive_lam_value", inactive_lam_value_);
+    s.pack("IpoptInterface::warm_start", warm_start_);
 
   }
 
@@ -84,6 +84,11 @@ namespace casadi {
     const char* return_status;
     int iter_count;
 
+    // Primal-dual state and barrier parameter at the previous solution
+    bool ws_available;
+    std::vector<double> ws_z_L, ws_z_U, ws_lambda;
+    double ws_mu;
+
     // Meta-data
     std::map<std::string, std::vector<std::string> > var_string_md;
     std::map<std::string, std::vector<int> > var_integer_md;
@@ -197,6 +202,9 @@ namespace casadi {
     std::string inactive_lam_strategy_;
     double inactive_lam_value_;
 
+    // Warm start from the previous solution?
+    bool warm_start_;
+
     /// Data for convexification
     ConvexifyData convexify_data_;
 
@@ -0,0 +1,232 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "llvm_compiler.hpp"
+#include "casadi/core/casadi_misc.hpp"
+#include "casadi/core/casadi_meta.hpp"
+#include "casadi/core/sx_function.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_IMPORTER_LLVM_EXPORT
+  casadi_register_importer_llvm(ImporterInternal::Plugin* plugin) {
+    plugin->creator = LlvmCompiler::creator;
+    plugin->name = "llvm";
+    plugin->doc = LlvmCompiler::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &LlvmCompiler::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_IMPORTER_LLVM_EXPORT casadi_load_importer_llvm() {
+    ImporterInternal::registerPlugin(casadi_register_importer_llvm);
+  }
+
+  namespace {
+    // Error message of an llvm::Error
+    std::string llvm_message(llvm::Error err) {
+      std::string ret;
+      llvm::raw_string_ostream ss(ret);
+      ss << err;
+      return ss.str();
+    }
+
+    // Unwrap an llvm::Expected, raising an error on failure
+    template<typename T>
+    T llvm_check(llvm::Expected<T> e, const std::string& what) {
+      if (!e) casadi_error(what + " failed: " + llvm_message(e.takeError()));
+      return std::move(*e);
+    }
+  } // namespace
+
+  LlvmCompiler::LlvmCompiler(const std::string& name) :
+    ImporterInternal(name) {
+    opt_level_ = 2;
+  }
+
+  LlvmCompiler::~LlvmCompiler() {
+  }
+
+  const Options LlvmCompiler::options_
+  = {{&ImporterInternal::options_},
+     {{"ir",
+       {OT_STRING,
+        "LLVM IR of the module. Default: read from the file given as name"}},
+      {"opt_level",
+       {OT_INT,
+        "Optimization level 0-3 of the LLVM pass pipeline. Default: 2"}}
+     }
+  };
+
+  void LlvmCompiler::init(const Dict& opts) {
+    // Base class
+    ImporterInternal::init(opts);
+
+    // Read options
+    bool has_ir = false;
+    for (auto&& op : opts) {
+      if (op.first=="ir") {
+        ir_ = op.second.to_string();
+        has_ir = true;
+      } else if (op.first=="opt_level") {
+        opt_level_ = op.second;
+      }
+    }
+    casadi_assert(opt_level_>=0 && opt_level_<=3, "Option 'opt_level' must be 0, 1, 2 or 3");
+
+    // Read IR from file
+    if (!has_ir) {
+      std::ifstream file(name_);
+      casadi_assert(file.good(), "Cannot open LLVM IR file '" + name_ + "'");
+      std::stringstream ss;
+      ss << file.rdbuf();
+      ir_ = ss.str();
+    }
+
+    // Prepare for code generation for the host, once
+    static std::once_flag target_initialized;
+    std::call_once(target_initialized, []() {
+      llvm::InitializeNativeTarget();
+      llvm::InitializeNativeTargetAsmPrinter();
+    });
+
+    // Parse the IR
+    auto context = std::make_unique<llvm::LLVMContext>();
+#if LLVM_VERSION_MAJOR==14
+    context->enableOpaquePointers();
+#endif
+    llvm::SMDiagnostic diag;
+    std::unique_ptr<llvm::Module> module =
+      llvm::parseIR(llvm::MemoryBufferRef(ir_, name_), diag, *context);
+    if (!module) {
+      std::string msg;
+      llvm::raw_string_ostream ss(msg);
+      diag.print(name_.c_str(), ss);
+      casadi_error("Parsing LLVM IR failed: " + ss.str());
+    }
+    std::string msg;
+    llvm::raw_string_ostream msg_ss(msg);
+    casadi_assert(!llvm::verifyModule(*module, &msg_ss), "Invalid LLVM IR: " + msg_ss.str());
+
+    // Create the JIT for the host
+    jit_ = llvm_check(llvm::orc::LLJITBuilder().create(), "Creating LLJIT");
+    module->setDataLayout(jit_->getDataLayout());
+    module->setTargetTriple(jit_->getTargetTriple().str());
+
+    // Optimize
+    if (opt_level_>0) {
+      llvm::LoopAnalysisManager lam;
+      llvm::FunctionAnalysisManager fam;
+      llvm::CGSCCAnalysisManager cgam;
+      llvm::ModuleAnalysisManager mam;
+      llvm::PassBuilder pb;
+      pb.registerModuleAnalyses(mam);
+      pb.registerCGSCCAnalyses(cgam);
+      pb.registerFunctionAnalyses(fam);
+      pb.registerLoopAnalyses(lam);
+      pb.crossRegisterProxies(lam, fam, cgam, mam);
+      llvm::OptimizationLevel level = opt_level_==1 ? llvm::OptimizationLevel::O1 :
+        opt_level_==2 ? llvm::OptimizationLevel::O2 : llvm::OptimizationLevel::O3;
+      llvm::ModulePassManager mpm = pb.buildPerModuleDefaultPipeline(level);
+      mpm.run(*module, mam);
+    }
+
+    // Symbols needed by the generated code, not relying on the global symbol table
+    llvm::orc::JITDylib& lib = jit_->getMainJITDylib();
+    std::vector<std::pair<std::string, void*> > symbols = {
+      {"casadi_sx_math", reinterpret_cast<void*>(&casadi_sx_math)},
+      {"sqrt", reinterpret_cast<void*>(static_cast<double(*)(double)>(&std::sqrt))},
+      {"sin", reinterpret_cast<void*>(static_cast<double(*)(double)>(&std::sin))},
+      {"cos", reinterpret_cast<void*>(static_cast<double(*)(double)>(&std::cos))},
+      {"exp", reinterpret_cast<void*>(static_cast<double(*)(double)>(&std::exp))},
+      {"log", reinterpret_cast<void*>(static_cast<double(*)(double)>(&std::log))},
+      {"fabs", reinterpret_cast<void*>(static_cast<double(*)(double)>(&std::fabs))},
+      {"floor", reinterpret_cast<void*>(static_cast<double(*)(double)>(&std::floor))},
+      {"ceil", reinterpret_cast<void*>(static_cast<double(*)(double)>(&std::ceil))},
+      {"pow", reinterpret_cast<void*>(static_cast<double(*)(double, double)>(&std::pow))},
+      {"fmin", reinterpret_cast<void*>(static_cast<double(*)(double, double)>(&std::fmin))},
+      {"fmax", reinterpret_cast<void*>(static_cast<double(*)(double, double)>(&std::fmax))},
+      {"copysign",
+        reinterpret_cast<void*>(static_cast<double(*)(double, double)>(&std::copysign))}};
+    llvm::orc::SymbolMap symbol_map;
+    for (auto&& s : symbols) {
+#if LLVM_VERSION_MAJOR>=17
+      symbol_map[jit_->mangleAndIntern(s.first)] = llvm::orc::ExecutorSymbolDef(
+        llvm::orc::ExecutorAddr::fromPtr(s.second), llvm::JITSymbolFlags::Exported);
+#else
+      symbol_map[jit_->mangleAndIntern(s.first)] = llvm::JITEvaluatedSymbol(
+        llvm::pointerToJITTargetAddress(s.second), llvm::JITSymbolFlags::Exported);
+#endif
+    }
+    if (auto err = lib.define(llvm::orc::absoluteSymbols(symbol_map))) {
+      casadi_error("Defining symbols failed: " + llvm_message(std::move(err)));
+    }
+
+    // Anything else is resolved in the current process
+    lib.addGenerator(llvm_check(
+      llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+        jit_->getDataLayout().getGlobalPrefix()), "Creating symbol generator"));
+
+    // Add the module
+    if (auto err = jit_->addIRModule(
+        llvm::orc::ThreadSafeModule(std::move(module), std::move(context)))) {
+      casadi_error("Adding LLVM IR module failed: " + llvm_message(std::move(err)));
+    }
+  }
+
+  signal_t LlvmCompiler::get_function(const std::string& symname) {
+    auto sym = jit_->lookup(symname);
+    if (!sym) {
+      llvm::consumeError(sym.takeError());
+      return nullptr;
+    }
+#if LLVM_VERSION_MAJOR>=15
+    return sym->toPtr<signal_t>();
+#else
+    return reinterpret_cast<signal_t>(sym->getAddress());
+#endif
+  }
+
+} // namespace casadi
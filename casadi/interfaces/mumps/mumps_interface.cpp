@@ -61,7 +61,19 @@ namespace casadi {
        "Symmetric matrix"}},
       {"posdef",
        {OT_BOOL,
-       "Positive definite"}}
+       "Positive definite"}},
+      {"ordering",
+       {OT_INT,
+       "Ordering computed in the analysis phase, ICNTL(7) [default 7: automatic]"}},
+      {"nthreads",
+       {OT_INT,
+       "Number of OpenMP threads used by MUMPS, ICNTL(16) [default 0: MUMPS default]"}},
+      {"blr",
+       {OT_BOOL,
+       "Block Low-Rank factorization, ICNTL(35) [default false]"}},
+      {"blr_tol",
+       {OT_DOUBLE,
+       "Dropping threshold of the Block Low-Rank compression, CNTL(7) [default 0]"}}
      }
   };
 
@@ -72,6 +84,10 @@ namespace casadi {
     // Default options
     symmetric_ = false;
     posdef_ = false;
+    ordering_ = 7;
+    nthreads_ = 0;
+    blr_ = false;
+    blr_tol_ = 0;
 
     // Read user options
     for (auto&& op : opts) {
@@ -79,6 +95,14 @@ namespace casadi {
         symmetric_ = op.second;
       } else if (op.first=="posdef") {
         posdef_ = op.second;
+      } else if (op.first=="ordering") {
+        ordering_ = op.second;
+      } else if (op.first=="nthreads") {
+        nthreads_ = op.second;
+      } else if (op.first=="blr") {
+        blr_ = op.second;
+      } else if (op.first=="blr_tol") {
+        blr_tol_ = op.second;
       }
     }
 
@@ -105,6 +129,21 @@ namespace casadi {
     m->id->sym = symmetric_ ? posdef_ ? 2 : 1 : 0;
     m->id->comm_fortran = -987654;
     dmumps_c(m->id);
+    m->is_analyzed = false;
+
+    // No outputs
+    m->id->icntl[1 - 1] = -1;
+    m->id->icntl[2 - 1] = -1;
+    m->id->icntl[3 - 1] = -1;
+    m->id->icntl[4 - 1] = 0;
+
+    // Ordering, multithreading and Block Low-Rank
+    m->id->icntl[7 - 1] = ordering_;
+    m->id->icntl[16 - 1] = nthreads_;
+    if (blr_) {
+      m->id->icntl[35 - 1] = 1;
+      m->id->cntl[7 - 1] = blr_tol_;
+    }
 
     // Sparsity pattern in MUMPS format
     casadi_int n = this->nrow();
@@ -128,10 +167,7 @@ namespace casadi {
     return 0;
   }
 
-  int MumpsInterface::nfact(void* mem, const double* A) const {
-    auto m = static_cast<MumpsMemory*>(mem);
-    casadi_assert_dev(A!=nullptr);
-
+  void MumpsInterface::set_nz(MumpsMemory* m, const double* A) const {
     // Copy nonzero entries to m->nz
     auto nz_it = m->nz.begin();
     if (symmetric_) {
@@ -148,23 +184,50 @@ namespace casadi {
       // Copy all entries
       std::copy(A, A + this->nnz(), nz_it);
     }
+    m->id->a = get_ptr(m->nz);
+  }
+
+  int MumpsInterface::sfact(void* mem, const double* A) const {
+    auto m = static_cast<MumpsMemory*>(mem);
+
+    // The analysis depends only on the sparsity pattern, which is fixed
+    if (m->is_analyzed) return 0;
 
-    // Define problem
+    // Define problem, values may be used for scaling and pivoting heuristics
+    set_nz(m, A);
     m->id->n = this->nrow();
     m->id->nnz = m->nz.size();
     m->id->irn = get_ptr(m->irn);
     m->id->jcn = get_ptr(m->jcn);
-    m->id->a = get_ptr(m->nz);
 
-    // No outputs
-    m->id->icntl[1 - 1] = -1;
-    m->id->icntl[2 - 1] = -1;
-    m->id->icntl[3 - 1] = -1;
-    m->id->icntl[4 - 1] = 0;
+    // Analysis phase
+    m->id->job = 1;
+    dmumps_c(m->id);
+    if (m->id->infog[1 - 1] < 0) {
+      if (verbose_) casadi_message("MUMPS analysis failed, INFOG(1)="
+                                   + str(m->id->infog[1 - 1]));
+      return 1;
+    }
+    m->is_analyzed = true;
+    return 0;
+  }
+
+  int MumpsInterface::nfact(void* mem, const double* A) const {
+    auto m = static_cast<MumpsMemory*>(mem);
+    casadi_assert_dev(A!=nullptr);
 
-    // Symbolic and numeric factorization
-    m->id->job = 4;
+    // Analysis, if not already performed
+    if (sfact(mem, A)) return 1;
+
+    // Numeric factorization, reusing the analysis
+    set_nz(m, A);
+    m->id->job = 2;
     dmumps_c(m->id);
+    if (m->id->infog[1 - 1] < 0) {
+      if (verbose_) casadi_message("MUMPS factorization failed, INFOG(1)="
+                                   + str(m->id->infog[1 - 1]));
+      return 1;
+    }
 
     return 0;
   }
@@ -189,6 +252,7 @@ namespace casadi {
 
   MumpsMemory::MumpsMemory() {
     this->id = 0;
+    this->is_analyzed = false;
   }
 
   MumpsMemory::~MumpsMemory() {
@@ -202,16 +266,31 @@ namespace casadi {
   }
 
   MumpsInterface::MumpsInterface(DeserializingStream& s) : LinsolInternal(s) {
-    s.version("Mumps", 1);
+    int version = s.version("Mumps", 1, 2);
     s.unpack("MumpsInterface::symmetric", symmetric_);
     s.unpack("MumpsInterface::posdef", posdef_);
+    if (version >= 2) {
+      s.unpack("MumpsInterface::ordering", ordering_);
+      s.unpack("MumpsInterface::nthreads", nthreads_);
+      s.unpack("MumpsInterface::blr", blr_);
+      s.unpack("MumpsInterface::blr_tol", blr_tol_);
+    } else {
+      ordering_ = 7;
+      nthreads_ = 0;
+      blr_ = false;
+      blr_tol_ = 0;
+    }
   }
 
   void MumpsInterface::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("Mumps", 1);
+    s.version("Mumps", 2);
     s.pack("MumpsInterface::symmetric", symmetric_);
     s.pack("MumpsInterface::posdef", posdef_);
+    s.pack("MumpsInterface::ordering", ordering_);
+    s.pack("MumpsInterface::nthreads", nthreads_);
+    s.pack("MumpsInterface::blr", blr_);
+    s.pack("MumpsInterface::blr_tol", blr_tol_);
   }
 
 } // namespace casadi
@@ -60,6 +60,9 @@ namespace casadi {
 
     // Nonzeros
     std::vector<double> nz;
+
+    // Has the analysis phase been performed?
+    bool is_analyzed;
   };
 
   /** \brief \pluginbrief{Linsol,mumps}
@@ -98,6 +101,12 @@ namespace casadi {
     /** \brief Free memory block */
     void free_mem(void *mem) const override { delete static_cast<MumpsMemory*>(mem);}
 
+    // Pass the nonzeros of A to MUMPS
+    void set_nz(MumpsMemory* m, const double* A) const;
+
+    // Analysis phase, performed once since the sparsity pattern is fixed
+    int sfact(void* mem, const double* A) const override;
+
     // Factorize the linear system
     int nfact(void* mem, const double* A) const override;
 
@@ -122,6 +131,9 @@ namespace casadi {
     ///@{
     // Options
     bool symmetric_, posdef_;
+    casadi_int ordering_, nthreads_;
+    bool blr_;
+    double blr_tol_;
     ///@}
 
   protected:
@@ -194,6 +194,11 @@ namespace casadi {
     if (osqp_setup(&m->work, &data, &settings_)) return 1;
     // if(osqp_setup(&data, &settings_)) return 1;
 
+    // Matrices are set at the first solve
+    m->P.resize(nnzHupp_);
+    m->A.resize(nnzA_);
+    m->P_set = m->A_set = false;
+
     m->fstats["preprocessing"]  = FStats();
     m->fstats["solver"]         = FStats();
     m->fstats["postprocessing"] = FStats();
@@ -252,9 +257,27 @@ namespace casadi {
       offset+= n;
     }
 
-    // Pass Hessian and constraint matrices
-    ret = osqp_update_P_A(m->work, w, nullptr, nnzHupp_, A, nullptr, nnzA_);
-    casadi_assert(ret==0, "Problem in osqp_update_P_A");
+    // Pass Hessian and constraint matrices, unless unchanged since the last call
+    bool update_P = !m->P_set || !std::equal(w, w+nnzHupp_, m->P.begin());
+    bool update_A = !m->A_set || !std::equal(A, A+nnzA_, m->A.begin());
+    if (update_P && update_A) {
+      ret = osqp_update_P_A(m->work, w, nullptr, nnzHupp_, A, nullptr, nnzA_);
+      casadi_assert(ret==0, "Problem in osqp_update_P_A");
+    } else if (update_P) {
+      ret = osqp_update_P(m->work, w, nullptr, nnzHupp_);
+      casadi_assert(ret==0, "Problem in osqp_update_P");
+    } else if (update_A) {
+      ret = osqp_update_A(m->work, A, nullptr, nnzA_);
+      casadi_assert(ret==0, "Problem in osqp_update_A");
+    }
+    if (update_P) {
+      std::copy(w, w+nnzHupp_, m->P.begin());
+      m->P_set = true;
+    }
+    if (update_A) {
+      std::copy(A, A+nnzA_, m->A.begin());
+      m->A_set = true;
+    }
 
 
     if (warm_start_primal_) {
@@ -450,6 +473,7 @@ namespace casadi {
   }
 
   OsqpMemory::OsqpMemory() {
+    P_set = A_set = false;
   }
 
   OsqpMemory::~OsqpMemory() {
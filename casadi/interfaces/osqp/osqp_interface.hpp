@@ -50,6 +50,10 @@ namespace casadi {
     // Structures
     OSQPWorkspace* work;
 
+    // Nonzeros of P and A last passed to OSQP, changes trigger a refactorization
+    std::vector<double> P, A;
+    bool P_set, A_set;
+
     /// Constructor
     OsqpMemory();
 
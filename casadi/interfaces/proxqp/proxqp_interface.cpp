@@ -50,7 +50,7 @@ namespace casadi {
 
   ProxqpInterface::ProxqpInterface(const std::string& name,
                                    const std::map<std::string, Sparsity>& st)
-    : Conic(name, st), sparse_backend(true), max_iter(0.0) {
+    : Conic(name, st), sparse_backend(true), max_iter(0.0), persistent_(false) {
   }
 
   ProxqpInterface::~ProxqpInterface() {
@@ -67,7 +67,13 @@ namespace casadi {
         "Use x input to warmstart [Default: true]."}},
       {"warm_start_dual",
        {OT_BOOL,
-        "Use y and z input to warmstart [Default: true]."}}
+        "Use y and z input to warmstart [Default: true]."}},
+      {"persistent",
+       {OT_BOOL,
+        "Keep the ProxQP solver alive between calls. When the equality pattern "
+        "(lba==uba) is unchanged, the solver is updated instead of recreated, "
+        "without passing unchanged matrices, and started from the previous "
+        "solution [false]"}}
      }
   };
 
@@ -77,6 +83,8 @@ namespace casadi {
 
     warm_start_primal_ = true;
     warm_start_dual_ = true;
+    persistent_ = false;
+    std::string backend = "sparse";
 
     // Read options
     for (auto&& op : opts) {
@@ -84,6 +92,8 @@ namespace casadi {
         warm_start_primal_ = op.second;
       } else if (op.first=="warm_start_dual") {
         warm_start_dual_ = op.second;
+      } else if (op.first=="persistent") {
+        persistent_ = op.second;
       } else if (op.first=="proxqp") {
         const Dict& opts = op.second;
         for (auto&& op : opts) {
@@ -103,13 +113,7 @@ namespace casadi {
           } else if (op.first=="verbose") {
             settings_.verbose = op.second;
           } else if (op.first=="backend") {
-            if (op.second == "sparse") {
-              sparse_backend = true;
-            } else if (op.second == "dense") {
-              sparse_backend = false;
-            } else {
-              casadi_error("[Backend option] Please specify either sparse or dense");
-            }
+            backend = op.second.to_string();
           } else {
             casadi_error("[ProxQP settings] User-specified option "
                          "'" + str(op.first) + "' not recognized.");
@@ -118,6 +122,23 @@ namespace casadi {
       }
     }
 
+    // Select backend, "auto" uses dense storage for small problems with enough fill
+    if (backend == "sparse") {
+      sparse_backend = true;
+    } else if (backend == "dense") {
+      sparse_backend = false;
+    } else if (backend == "auto") {
+      double n = static_cast<double>(nx_)*static_cast<double>(nx_ + na_);
+      double fill = n==0 ? 0 : static_cast<double>(H_.nnz() + A_.nnz())/n;
+      sparse_backend = nx_ + na_ > 300 || fill < 0.3;
+      if (verbose_) {
+        casadi_message("Fill " + str(fill) + ", using "
+          + std::string(sparse_backend ? "sparse" : "dense") + " backend");
+      }
+    } else {
+      casadi_error("[Backend option] Please specify either sparse, dense or auto");
+    }
+
     // Allocate memory for problem
     nA_ = nnz_in(CONIC_A);
     nH_ = nnz_in(CONIC_H);
@@ -149,6 +170,9 @@ namespace casadi {
     m->lb_vector.resize(na_);
     m->b_vector.resize(na_);
 
+    m->initialized = false;
+    m->updated = false;
+
     m->add_stat("preprocessing");
     m->add_stat("solver");
     m->add_stat("postprocessing");
@@ -164,7 +188,7 @@ namespace casadi {
     typedef Eigen::Triplet<double> T;
 
     auto m = static_cast<ProxqpMemory*>(mem);
-    m->fstats.at("preprocessing").tic();
+    if (m->t_total) m->fstats.at("preprocessing").tic();
 
     // Get problem data
     double* g=w; w += nx_;
@@ -248,59 +272,69 @@ namespace casadi {
     std::size_t n_eq = m->b_vector.size();
     std::size_t n_ineq = m->lba_vector.size() + m->lbx_vector.size();
 
-    // Convert H_ from casadi::Sparsity to Eigen::SparseMatrix
-    H_.get_triplet(m->row, m->col);
-    for (int k=0; k<H_.nnz(); ++k) {
-      m->tripletList.push_back(T(
-        static_cast<double>(m->row[k]),
-        static_cast<double>(m->col[k]),
-        static_cast<double>(H[k])));
-    }
+    // Can the solver from the previous call be updated?
+    std::vector<bool> is_eq(lhs_equals_rhs_constraint.data(),
+      lhs_equals_rhs_constraint.data() + lhs_equals_rhs_constraint.size());
+    bool update = persistent_ && m->initialized && is_eq == m->is_eq;
+    // Are the matrices unchanged?
+    bool same_matrices = update
+      && std::equal(H, H + nnz_in(CONIC_H), m->H_prev.begin())
+      && std::equal(A, A + nnz_in(CONIC_A), m->A_prev.begin());
+
+    // Handle constraints on decision variable x in inequality constraint matrix C
+    uint32_t n_constraints_x = 0;
+    if (m->ubx_vector.size() > 0 || m->lbx_vector.size() > 0) n_constraints_x = nx_;
+
     Eigen::SparseMatrix<double> H_spa(H_.size1(), H_.size2());
-    H_spa.setFromTriplets(m->tripletList.begin(), m->tripletList.end());
-    m->tripletList.clear();
-
-    // Convert A_ from casadi Sparsity to Eigen::SparseMatrix and split
-    // in- and equality constraints into different matrices
-    m->tripletList.reserve(A_.nnz());
-    A_.get_triplet(m->row, m->col);
-
-    for (int k=0; k<A_.nnz(); ++k) {
-      // Detect equality constraint
-      if (lhs_equals_rhs_constraint[m->row[k]]) {
-        // Equality constraint the row[k] is decreased by the number of previous inequality constraints
-        m->tripletListEq.push_back(T(
-          static_cast<double>(m->row[k] - number_of_prev_inequality[m->row[k]]),
-          static_cast<double>(m->col[k]),
-          static_cast<double>(A[k])));
-      } else {
-        // Inequality constraint the row[k] is decreased by the number of previous equality constraints
+    Eigen::SparseMatrix<double> A_spa(n_eq, nx_);
+    Eigen::SparseMatrix<double> C_spa(n_ineq, nx_);
+    if (!same_matrices) {
+      // Convert H_ from casadi::Sparsity to Eigen::SparseMatrix
+      H_.get_triplet(m->row, m->col);
+      for (int k=0; k<H_.nnz(); ++k) {
         m->tripletList.push_back(T(
-          static_cast<double>(m->row[k] - number_of_prev_equality[m->row[k]]),
+          static_cast<double>(m->row[k]),
           static_cast<double>(m->col[k]),
-          static_cast<double>(A[k])));
+          static_cast<double>(H[k])));
+      }
+      H_spa.setFromTriplets(m->tripletList.begin(), m->tripletList.end());
+      m->tripletList.clear();
+
+      // Convert A_ from casadi Sparsity to Eigen::SparseMatrix and split
+      // in- and equality constraints into different matrices
+      m->tripletList.reserve(A_.nnz());
+      A_.get_triplet(m->row, m->col);
+
+      for (int k=0; k<A_.nnz(); ++k) {
+        // Detect equality constraint
+        if (lhs_equals_rhs_constraint[m->row[k]]) {
+          // Equality constraint the row[k] is decreased by the number of previous inequality constraints
+          m->tripletListEq.push_back(T(
+            static_cast<double>(m->row[k] - number_of_prev_inequality[m->row[k]]),
+            static_cast<double>(m->col[k]),
+            static_cast<double>(A[k])));
+        } else {
+          // Inequality constraint the row[k] is decreased by the number of previous equality constraints
+          m->tripletList.push_back(T(
+            static_cast<double>(m->row[k] - number_of_prev_equality[m->row[k]]),
+            static_cast<double>(m->col[k]),
+            static_cast<double>(A[k])));
+        }
       }
-    }
 
-    // Handle constraints on decision variable x in inequality constraint matrix C
-    uint32_t n_constraints_x = 0;
-    if (m->ubx_vector.size() > 0 || m->lbx_vector.size() > 0) {
-      for (int k=0; k<nx_; ++k) {
+      for (uint32_t k=0; k<n_constraints_x; ++k) {
         m->tripletList.push_back(T(
           static_cast<double>(m->lba_vector.size() + k),
           static_cast<double>(k),
           static_cast<double>(1.0)));
-        ++n_constraints_x;
       }
-    }
 
-    Eigen::SparseMatrix<double> A_spa(n_eq, nx_);
-    A_spa.setFromTriplets(m->tripletListEq.begin(), m->tripletListEq.end());
-    m->tripletListEq.clear();
+      A_spa.setFromTriplets(m->tripletListEq.begin(), m->tripletListEq.end());
+      m->tripletListEq.clear();
 
-    Eigen::SparseMatrix<double> C_spa(n_ineq, nx_);
-    C_spa.setFromTriplets(m->tripletList.begin(), m->tripletList.end());
-    m->tripletList.clear();
+      C_spa.setFromTriplets(m->tripletList.begin(), m->tripletList.end());
+      m->tripletList.clear();
+    }
 
     // Get stacked lower and upper inequality bounds
     m->ub_vector.resize(n_ineq);
@@ -316,17 +350,31 @@ namespace casadi {
     } else {
       m->lb_vector << m->lbx_vector;
     }
-    m->fstats.at("preprocessing").toc();
+    if (m->t_total) m->fstats.at("preprocessing").toc();
 
     // Solve Problem
-    m->fstats.at("solver").tic();
+    if (m->t_total) m->fstats.at("solver").tic();
 
     if (sparse_backend) {
-      m->sparse_solver = proxsuite::proxqp::sparse::QP<double, long long> (nx_, n_eq, n_ineq);
-      m->sparse_solver.init(H_spa, m->g_vector,
-                            A_spa, m->b_vector,
-                            C_spa, m->lb_vector, m->ub_vector);
-      m->sparse_solver.settings = settings_;
+      if (!update) {
+        m->sparse_solver = proxsuite::proxqp::sparse::QP<double, long long> (nx_, n_eq, n_ineq);
+        m->sparse_solver.settings = settings_;
+        m->sparse_solver.init(H_spa, m->g_vector,
+                              A_spa, m->b_vector,
+                              C_spa, m->lb_vector, m->ub_vector);
+      } else if (same_matrices) {
+        m->sparse_solver.update(proxsuite::nullopt, m->g_vector,
+                                proxsuite::nullopt, m->b_vector,
+                                proxsuite::nullopt, m->lb_vector, m->ub_vector);
+      } else {
+        m->sparse_solver.update(H_spa, m->g_vector,
+                                A_spa, m->b_vector,
+                                C_spa, m->lb_vector, m->ub_vector);
+      }
+      if (update) {
+        m->sparse_solver.settings.initial_guess =
+          InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT;
+      }
 
       m->sparse_solver.solve();
 
@@ -336,11 +384,25 @@ namespace casadi {
       m->objValue = m->sparse_solver.results.info.objValue;
       m->status = m->sparse_solver.results.info.status;
     } else {
-      m->dense_solver = proxsuite::proxqp::dense::QP<double> (nx_, n_eq, n_ineq);
-      m->dense_solver.init(Eigen::MatrixXd(H_spa), m->g_vector,
-        Eigen::MatrixXd(A_spa), m->b_vector,
-        Eigen::MatrixXd(C_spa), m->lb_vector, m->ub_vector);
-      m->dense_solver.settings = settings_;
+      if (!update) {
+        m->dense_solver = proxsuite::proxqp::dense::QP<double> (nx_, n_eq, n_ineq);
+        m->dense_solver.settings = settings_;
+        m->dense_solver.init(Eigen::MatrixXd(H_spa), m->g_vector,
+          Eigen::MatrixXd(A_spa), m->b_vector,
+          Eigen::MatrixXd(C_spa), m->lb_vector, m->ub_vector);
+      } else if (same_matrices) {
+        m->dense_solver.update(proxsuite::nullopt, m->g_vector,
+          proxsuite::nullopt, m->b_vector,
+          proxsuite::nullopt, m->lb_vector, m->ub_vector);
+      } else {
+        m->dense_solver.update(Eigen::MatrixXd(H_spa), m->g_vector,
+          Eigen::MatrixXd(A_spa), m->b_vector,
+          Eigen::MatrixXd(C_spa), m->lb_vector, m->ub_vector);
+      }
+      if (update) {
+        m->dense_solver.settings.initial_guess =
+          InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT;
+      }
 
       m->dense_solver.solve();
 
@@ -350,10 +412,19 @@ namespace casadi {
       m->objValue = m->dense_solver.results.info.objValue;
       m->status = m->dense_solver.results.info.status;
     }
-    m->fstats.at("solver").toc();
+
+    // Remember what the solver was set up with
+    m->updated = update;
+    if (persistent_) {
+      m->initialized = true;
+      m->is_eq = is_eq;
+      m->H_prev.assign(H, H + nnz_in(CONIC_H));
+      m->A_prev.assign(A, A + nnz_in(CONIC_A));
+    }
+    if (m->t_total) m->fstats.at("solver").toc();
 
     // Post-processing to retrieve the results
-    m->fstats.at("postprocessing").tic();
+    if (m->t_total) m->fstats.at("postprocessing").tic();
     casadi_copy(m->results_x->data(), nx_, res[CONIC_X]);
 
     // Copy back the multipliers.
@@ -378,9 +449,9 @@ namespace casadi {
 
         for (int k=0; k<lhs_equals_rhs_constraint.size(); ++k) {
           if (lhs_equals_rhs_constraint[k]) {
-            lam_a[k] = m->results_y->coeff(k);
+            lam_a[k] = m->results_y->coeff(k - number_of_prev_inequality[k]);
           } else {
-            lam_a[k] = m->results_z->coeff(k);
+            lam_a[k] = m->results_z->coeff(k - number_of_prev_equality[k]);
           }
         }
         casadi_copy(lam_a.data(), na_, res[CONIC_LAM_A]);
@@ -401,7 +472,7 @@ namespace casadi {
         m->d_qp.unified_return_status = SOLVER_RET_UNKNOWN;
       }
     }
-    m->fstats.at("postprocessing").toc();
+    if (m->t_total) m->fstats.at("postprocessing").toc();
 
     return 0;
   }
@@ -424,6 +495,7 @@ namespace casadi {
     }
 
     stats["return_status"] = ret_status;
+    stats["updated"] = m->updated;
     return stats;
   }
 
@@ -438,7 +510,7 @@ namespace casadi {
   }
 
   ProxqpInterface::ProxqpInterface(DeserializingStream& s) : Conic(s) {
-    s.version("ProxqpInterface", 1);
+    int version = s.version("ProxqpInterface", 1, 2);
     s.unpack("ProxqpInterface::warm_start_primal", warm_start_primal_);
     s.unpack("ProxqpInterface::warm_start_dual", warm_start_dual_);
 
@@ -451,11 +523,16 @@ namespace casadi {
     settings_.max_iter = isize(max_iter);
     s.unpack("ProxqpInterface::settings::verbose", settings_.verbose);
     s.unpack("ProxqpInterface::settings::sparse_backend", sparse_backend);
+    if (version >= 2) {
+      s.unpack("ProxqpInterface::persistent", persistent_);
+    } else {
+      persistent_ = false;
+    }
   }
 
   void ProxqpInterface::serialize_body(SerializingStream &s) const {
     Conic::serialize_body(s);
-    s.version("ProxqpInterface", 1);
+    s.version("ProxqpInterface", 2);
     s.pack("ProxqpInterface::warm_start_primal", warm_start_primal_);
     s.pack("ProxqpInterface::warm_start_dual", warm_start_dual_);
     s.pack("ProxqpInterface::settings::default_rho", settings_.default_rho);
@@ -466,6 +543,7 @@ namespace casadi {
     s.pack("ProxqpInterface::settings::max_iter", static_cast<double>(settings_.max_iter));
     s.pack("ProxqpInterface::settings::verbose", settings_.verbose);
     s.pack("ProxqpInterface::settings::sparse_backend", sparse_backend);
+    s.pack("ProxqpInterface::persistent", persistent_);
   }
 
 } // namespace casadi
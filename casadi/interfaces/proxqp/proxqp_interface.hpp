@@ -79,6 +79,14 @@ namespace casadi {
     double objValue;
     proxsuite::proxqp::QPSolverOutput status;
 
+    // Solver kept between calls with the 'persistent' option
+    bool initialized;
+    // Equality pattern and matrix data the solver was last set up with
+    std::vector<bool> is_eq;
+    std::vector<double> H_prev, A_prev;
+    // Was the last solve an update of the previous problem?
+    bool updated;
+
     /// Constructor
     ProxqpMemory();
 
@@ -153,6 +161,9 @@ namespace casadi {
     bool sparse_backend;
     double max_iter;
 
+    // Keep the solver alive between calls, updating it when possible
+    bool persistent_;
+
     // Number of nonzeros in Hessian
     casadi_int nH_;
 
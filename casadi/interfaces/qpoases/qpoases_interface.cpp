@@ -84,7 +84,17 @@ namespace casadi {
         "Maximal number of Schur updates [75]"}},
       {"linsol_plugin",
        {OT_STRING,
-        "Linear solver plugin"}},
+        "Linear solver plugin for the Schur complement approach, e.g. ma57 or ldl [ma27]"}},
+      {"linsol_options",
+       {OT_DICT,
+        "Options to be passed to the linear solver"}},
+      {"hotstart",
+       {OT_BOOL,
+        "Keep the (S)QProblem between calls and hotstart from the previous working set, "
+        "also when the values of H and A change [true]"}},
+      {"hotstart_fallback",
+       {OT_BOOL,
+        "Retry with a cold start when a hotstart fails [true]"}},
       {"nWSR",
        {OT_INT,
         "The maximum number of working set recalculations to be performed during "
@@ -201,6 +211,8 @@ namespace casadi {
     max_cputime_ = -1;
     ops_.setToDefault();
     linsol_plugin_ = "ma27";
+    hotstart_ = true;
+    hotstart_fallback_ = true;
 
     // Read options
     for (auto&& op : opts) {
@@ -229,6 +241,12 @@ namespace casadi {
         max_schur_ = op.second;
       } else if (op.first=="linsol_plugin") {
         linsol_plugin_ = std::string(op.second);
+      } else if (op.first=="linsol_options") {
+        linsol_options_ = op.second;
+      } else if (op.first=="hotstart") {
+        hotstart_ = op.second;
+      } else if (op.first=="hotstart_fallback") {
+        hotstart_fallback_ = op.second;
       } else if (op.first=="nWSR") {
         max_nWSR_ = op.second;
       } else if (op.first=="CPUtime") {
@@ -302,11 +320,8 @@ namespace casadi {
       "https://github.com/casadi/casadi/issues/2358");
     }
 
-    // Allocate work vectors
-    if (sparse_) {
-      alloc_w(nnz_in(CONIC_H), true); // h
-      alloc_w(nnz_in(CONIC_A), true); // a
-    } else {
+    // Allocate work vectors, sparse matrices are held by the memory
+    if (!sparse_) {
       alloc_w(nx_*nx_, true); // h
       alloc_w(nx_*na_, true); // a
     }
@@ -322,12 +337,18 @@ namespace casadi {
     if (Conic::init_mem(mem)) return 1;
     auto m = static_cast<QpoasesMemory*>(mem);
     m->called_once = false;
+    m->hotstarted = false;
 
     // Linear solver, if any
     m->linsol_plugin = linsol_plugin_;
+    m->linsol_options = linsol_options_;
 
     // Create qpOASES instance
     delete m->qp;
+    delete m->h;
+    delete m->a;
+    m->h = nullptr;
+    m->a = nullptr;
     if (schur_) {
       m->sqp = new qpOASES::SQProblemSchur(nx_, na_, hess_, max_schur_,
         mem, qpoases_init, qpoases_sfact, qpoases_nfact, qpoases_solve);
@@ -348,14 +369,53 @@ namespace casadi {
     m->a_row.resize(A_.nnz());
     m->a_colind.resize(A_.size2()+1);
 
+    // Sparse matrices, only the nonzeros change between calls
+    if (sparse_) {
+      copy_vector(H_.colind(), m->h_colind);
+      copy_vector(H_.row(), m->h_row);
+      m->h_nz.resize(H_.nnz());
+      m->h = new qpOASES::SymSparseMat(H_.size1(), H_.size2(),
+        get_ptr(m->h_row), get_ptr(m->h_colind), get_ptr(m->h_nz));
+      m->h->createDiagInfo();
+      copy_vector(A_.colind(), m->a_colind);
+      copy_vector(A_.row(), m->a_row);
+      m->a_nz.resize(A_.nnz());
+      m->a = new qpOASES::SparseMatrix(A_.size1(), A_.size2(),
+        get_ptr(m->a_row), get_ptr(m->a_colind), get_ptr(m->a_nz));
+    }
+
     return 0;
   }
 
+  template<typename MatH, typename MatA>
+  casadi_int QpoasesInterface::solve_sqp(QpoasesMemory* m, MatH h, const double* g, MatA a,
+      const double* lb, const double* ub, const double* lbA, const double* ubA,
+      int& nWSR) const {
+    double cputime = max_cputime_;
+    double *cputime_ptr = cputime<=0 ? nullptr : &cputime;
+    m->hotstarted = hotstart_ && m->called_once;
+    if (m->hotstarted) {
+      // Start from the previous working set, H and A may have changed
+      casadi_int flag = m->sqp->hotstart(h, g, a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
+      if (flag==qpOASES::SUCCESSFUL_RETURN || !hotstart_fallback_) return flag;
+      if (verbose_) {
+        casadi_message("qpOASES hotstart failed: " + getErrorMessage(flag)
+                       + ". Retrying with a cold start.");
+      }
+      // A failed hotstart may leave an inconsistent working set
+      m->hotstarted = false;
+      nWSR = max_nWSR_;
+      cputime = max_cputime_;
+    }
+    if (m->called_once) m->sqp->reset();
+    return m->sqp->init(h, g, a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
+  }
+
   int QpoasesInterface::
   solve(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
     auto m = static_cast<QpoasesMemory*>(mem);
 
-    m->fstats.at("preprocessing").tic();
+    if (m->t_total) m->fstats.at("preprocessing").tic();
 
     // Problem has not been solved at this point
     m->return_status = -1;
@@ -382,35 +442,16 @@ namespace casadi {
 
     // Sparse or dense mode?
     if (sparse_) {
-      // Get quadratic term
-      copy_vector(H_.colind(), m->h_colind);
-      copy_vector(H_.row(), m->h_row);
-      double* h=w; w += H_.nnz();
-      casadi_copy(arg[CONIC_H], H_.nnz(), h);
-      delete m->h;
-      m->h = new qpOASES::SymSparseMat(H_.size1(), H_.size2(),
-        get_ptr(m->h_row), get_ptr(m->h_colind), h);
-      m->h->createDiagInfo();
-
-      // Get linear term
-      copy_vector(A_.colind(), m->a_colind);
-      copy_vector(A_.row(), m->a_row);
-      double* a=w; w += A_.nnz();
-      casadi_copy(arg[CONIC_A], A_.nnz(), a);
-      delete m->a;
-      m->a = new qpOASES::SparseMatrix(A_.size1(), A_.size2(),
-        get_ptr(m->a_row), get_ptr(m->a_colind), a);
+      // Update the nonzeros of the quadratic and linear terms
+      casadi_copy(arg[CONIC_H], H_.nnz(), get_ptr(m->h_nz));
+      casadi_copy(arg[CONIC_A], A_.nnz(), get_ptr(m->a_nz));
 
-      m->fstats.at("preprocessing").toc();
-      m->fstats.at("solver").tic();
+      if (m->t_total) m->fstats.at("preprocessing").toc();
+      if (m->t_total) m->fstats.at("solver").tic();
 
       // Solve sparse
-      if (m->called_once) {
-        flag = m->sqp->hotstart(m->h, g, m->a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
-      } else {
-        flag = m->sqp->init(m->h, g, m->a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
-      }
-      m->fstats.at("solver").toc();
+      flag = solve_sqp(m, m->h, g, m->a, lb, ub, lbA, ubA, nWSR);
+      if (m->t_total) m->fstats.at("solver").toc();
 
     } else {
       // Get quadratic term
@@ -421,8 +462,8 @@ namespace casadi {
       double* a = w; w += nx_*na_;
       casadi_densify(arg[CONIC_A], A_, a, true);
 
-      m->fstats.at("preprocessing").toc();
-      m->fstats.at("solver").tic();
+      if (m->t_total) m->fstats.at("preprocessing").toc();
+      if (m->t_total) m->fstats.at("solver").tic();
       // Solve dense
       if (na_==0) {
         if (m->called_once) {
@@ -433,20 +474,17 @@ namespace casadi {
         } else {
           flag = m->qp->init(h, g, lb, ub, nWSR, cputime_ptr);
         }
+        m->hotstarted = false;
       } else {
-        if (m->called_once) {
-          flag = m->sqp->hotstart(h, g, a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
-        } else {
-          flag = m->sqp->init(h, g, a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
-        }
+        flag = solve_sqp(m, h, g, a, lb, ub, lbA, ubA, nWSR);
       }
-      m->fstats.at("solver").toc();
+      if (m->t_total) m->fstats.at("solver").toc();
     }
 
     // Solver is "warm" now
     m->called_once = true;
 
-    m->fstats.at("postprocessing").tic();
+    if (m->t_total) m->fstats.at("postprocessing").tic();
 
     m->return_status = flag;
     m->d_qp.success = flag==qpOASES::SUCCESSFUL_RETURN;
@@ -484,7 +522,7 @@ namespace casadi {
       casadi_copy(dual+nx_, na_, res[CONIC_LAM_A]);
     }
 
-    m->fstats.at("postprocessing").toc();
+    if (m->t_total) m->fstats.at("postprocessing").toc();
 
     return m->d_qp.unified_return_status;
   }
@@ -882,7 +920,7 @@ namespace casadi {
     m->nz.resize(sp.nnz());
 
     // Create linear solver
-    m->linsol = Linsol("linsol", m->linsol_plugin, sp);
+    m->linsol = Linsol("linsol", m->linsol_plugin, sp, m->linsol_options);
 
     return 0;
   }
@@ -934,11 +972,12 @@ namespace casadi {
     Dict stats = Conic::get_stats(mem);
     auto m = static_cast<QpoasesMemory*>(mem);
     stats["return_status"] = getErrorMessage(m->return_status);
+    stats["hotstart"] = m->hotstarted;
     return stats;
   }
 
   QpoasesInterface::QpoasesInterface(DeserializingStream& s) : Conic(s) {
-    s.version("QpoasesInterface", 1);
+    int version = s.version("QpoasesInterface", 1, 2);
     s.unpack("QpoasesInterface::max_nWSR", max_nWSR_);
     s.unpack("QpoasesInterface::max_cputime", max_cputime_);
     casadi_int hess;
@@ -948,6 +987,14 @@ namespace casadi {
     s.unpack("QpoasesInterface::schur", schur_);
     s.unpack("QpoasesInterface::max_schur", max_schur_);
     s.unpack("QpoasesInterface::linsol_plugin", linsol_plugin_);
+    if (version >= 2) {
+      s.unpack("QpoasesInterface::linsol_options", linsol_options_);
+      s.unpack("QpoasesInterface::hotstart", hotstart_);
+      s.unpack("QpoasesInterface::hotstart_fallback", hotstart_fallback_);
+    } else {
+      hotstart_ = true;
+      hotstart_fallback_ = false;
+    }
     ops_.setToDefault();
     casadi_int print_level;
     s.unpack("QpoasesInterface::ops::printLevel", print_level);
@@ -1019,7 +1066,7 @@ namespace casadi {
 
   void QpoasesInterface::serialize_body(SerializingStream &s) const {
     Conic::serialize_body(s);
-    s.version("QpoasesInterface", 1);
+    s.version("QpoasesInterface", 2);
     s.pack("QpoasesInterface::max_nWSR", max_nWSR_);
     s.pack("QpoasesInterface::max_cputime", max_cputime_);
     s.pack("QpoasesInterface::hess", static_cast<casadi_int>(hess_));
@@ -1027,6 +1074,9 @@ namespace casadi {
     s.pack("QpoasesInterface::schur", schur_);
     s.pack("QpoasesInterface::max_schur", max_schur_);
     s.pack("QpoasesInterface::linsol_plugin", linsol_plugin_);
+    s.pack("QpoasesInterface::linsol_options", linsol_options_);
+    s.pack("QpoasesInterface::hotstart", hotstart_);
+    s.pack("QpoasesInterface::hotstart_fallback", hotstart_fallback_);
     s.pack("QpoasesInterface::ops::printLevel", static_cast<casadi_int>(ops_.printLevel));
     s.pack("QpoasesInterface::ops::enableRamping", from_BooleanType(ops_.enableRamping));
     s.pack("QpoasesInterface::ops::enableFarBounds",
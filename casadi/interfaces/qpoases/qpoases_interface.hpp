@@ -53,6 +53,9 @@ namespace casadi {
     // Linear solver plugin class
     std::string linsol_plugin;
 
+    // Linear solver options
+    Dict linsol_options;
+
     /// QP Solver
     union {
       qpOASES::SQProblem *sqp;
@@ -66,6 +69,9 @@ namespace casadi {
     /// Has qpOASES been called once?
     bool called_once;
 
+    /// Was the last solution obtained with a hotstart?
+    bool hotstarted;
+
     // Map linear system nonzeros
     std::vector<casadi_int> lin_map;
 
@@ -74,6 +80,9 @@ namespace casadi {
 
     std::vector<int> h_row, h_colind, a_row, a_colind;
 
+    // Nonzeros of the sparse QP matrices, kept alive between calls
+    std::vector<double> h_nz, a_nz;
+
     // Nonzero entries
     std::vector<double> nz;
 
@@ -159,6 +168,12 @@ namespace casadi {
     /// qpOases printing function
     static void qpoases_printf(const char* s);
 
+    /// Solve with an SQProblem, hotstarting from the previous working set if possible
+    template<typename MatH, typename MatA>
+    casadi_int solve_sqp(QpoasesMemory* m, MatH h, const double* g, MatA a,
+      const double* lb, const double* ub, const double* lbA, const double* ubA,
+      int& nWSR) const;
+
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
@@ -193,6 +208,9 @@ namespace casadi {
     bool schur_;
     casadi_int max_schur_;
     std::string linsol_plugin_;
+    Dict linsol_options_;
+    bool hotstart_;
+    bool hotstart_fallback_;
     ///@}
 
     /// Throw error
@@ -144,6 +144,13 @@ int CvodesInterface::init_mem(void* mem) const {
   double t0 = 0;
   THROWING(CVodeInit, m->mem, rhsF, t0, m->xz);
 
+  // Root finding for events
+  if (ne_ > 0) {
+    THROWING(CVodeRootInit, m->mem, ne_, rootF);
+    std::vector<int> rootdir(event_dir_.begin(), event_dir_.end());
+    THROWING(CVodeSetRootDirection, m->mem, get_ptr(rootdir));
+  }
+
   // Set tolerances
   if (scale_abstol_) {
     THROWING(CVodeSVtolerances, m->mem, reltol_, m->abstolv);
@@ -270,8 +277,21 @@ void CvodesInterface::advance(IntegratorMemory* mem,
       // ... with taping
       THROWING(CVodeF, m->mem, m->t_next, m->xz, &tret, CV_NORMAL, &m->ncheck);
     } else {
-      // ... without taping
-      THROWING(CVode, m->mem, m->t_next, m->xz, &tret, CV_NORMAL);
+      // ... without taping, stopping at events
+      while (true) {
+        int flag = CVode(m->mem, m->t_next, m->xz, &tret, CV_NORMAL);
+        cvodes_error("CVode", flag);
+        if (flag != CV_ROOT_RETURN) break;
+        register_event(m, tret);
+        if (has_transition_) {
+          // Reinitialize with the new state, keeping the quadratures
+          if (nq_ > 0) THROWING(CVodeGetQuad, m->mem, &tret, m->q);
+          calc_transition(m, tret, NV_DATA_S(m->xz), nullptr, m->p, m->u);
+          THROWING(CVodeReInit, m->mem, tret, m->xz);
+          if (nq_ > 0) THROWING(CVodeQuadReInit, m->mem, m->q);
+          THROWING(CVodeSetStopTime, m->mem, m->t_stop);
+        }
+      }
     }
 
     // Get quadratures
@@ -419,6 +439,19 @@ int CvodesInterface::rhsQF(double t, N_Vector x, N_Vector qdot, void *user_data)
   }
 }
 
+int CvodesInterface::rootF(double t, N_Vector x, double *gout, void *user_data) {
+  try {
+    auto m = to_mem(user_data);
+    auto& s = m->self;
+    if (s.calc_event(m, t, NV_DATA_S(x), nullptr, m->p, m->u, gout)) return 1;
+
+    return 0;
+  } catch(std::exception& e) { // non-recoverable error
+    uerr() << "rootF failed: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
 int CvodesInterface::rhsB(double t, N_Vector x, N_Vector rx, N_Vector rxdot, void *user_data) {
   try {
     casadi_assert_dev(user_data);
@@ -134,6 +134,9 @@ class CASADI_INTEGRATOR_CVODES_EXPORT CvodesInterface : public SundialsInterface
   void advance(IntegratorMemory* mem,
     const double* u, double* x, double* z, double* q) const override;
 
+  /// Events are located with the CVODES root finding
+  bool supports_events() const override { return true;}
+
   /** \brief Introduce an impulse into the backwards integration at the current time */
   void impulseB(IntegratorMemory* mem,
     const double* rx, const double* rz, const double* rp) const override;
@@ -160,6 +163,7 @@ class CASADI_INTEGRATOR_CVODES_EXPORT CvodesInterface : public SundialsInterface
   static int rhsF(double t, N_Vector x, N_Vector xdot, void *user_data);
   static int rhsB(double t, N_Vector x, N_Vector xB, N_Vector xdotB, void *user_data);
   static int rhsQF(double t, N_Vector x, N_Vector qdot, void *user_data);
+  static int rootF(double t, N_Vector x, double *gout, void *user_data);
   static int rhsQB(double t, N_Vector x, N_Vector rx, N_Vector ruqdot, void *user_data);
   static int jtimesF(N_Vector v, N_Vector Jv, double t, N_Vector x, N_Vector xdot,
     void *user_data, N_Vector tmp);
@@ -78,6 +78,9 @@ namespace casadi {
     lower_bandwidth_ = -1;
     use_preconditioner_ = false;
     abstol_ = 1e-6;
+    max_setup_calls_ = 0;
+    anderson_depth_ = 0;
+    reuse_jacobian_ = false;
   }
 
   KinsolInterface::~KinsolInterface() {
@@ -129,7 +132,22 @@ namespace casadi {
         "Precondition an iterative solver"}},
       {"strategy",
        {OT_STRING,
-        "Globalization strategy"}},
+        "Globalization strategy: none|linesearch for Newton iterations, "
+        "picard for Picard iterations with the Jacobian as linear operator, "
+        "fp for the fixed point iteration u = u - F(u)"}},
+      {"max_setup_calls",
+       {OT_INT,
+        "Maximum number of nonlinear iterations between calls to the linear solver setup, "
+        "i.e. Jacobian evaluation and factorization. Putting 0 sets the default value "
+        "of KinSol (10)."}},
+      {"anderson_depth",
+       {OT_INT,
+        "Number of previous iterates used in Anderson acceleration of the picard "
+        "and fp strategies (default: 0)"}},
+      {"reuse_jacobian",
+       {OT_BOOL,
+        "Keep the linear solver setup between calls, such that a call does not start "
+        "with a new Jacobian factorization (default: false)"}},
       {"disable_internal_warnings",
        {OT_BOOL,
         "Disable KINSOL internal warning messages"}}
@@ -177,12 +195,23 @@ namespace casadi {
         use_preconditioner_ = op.second;
       } else if (op.first=="abstol") {
         abstol_ = op.second;
+      } else if (op.first=="max_setup_calls") {
+        max_setup_calls_ = op.second;
+      } else if (op.first=="anderson_depth") {
+        anderson_depth_ = op.second;
+      } else if (op.first=="reuse_jacobian") {
+        reuse_jacobian_ = op.second;
       }
     }
 
     // Get globalization strategy
     if (strategy=="linesearch") {
       strategy_ = KIN_LINESEARCH;
+    } else if (strategy=="picard") {
+      strategy_ = KIN_PICARD;
+    } else if (strategy=="fp") {
+      strategy_ = KIN_FP;
+      casadi_assert(u_c_.empty(), "KINSOL: strategy 'fp' does not support constraints");
     } else {
       casadi_assert_dev(strategy=="none");
       strategy_ = KIN_NONE;
@@ -256,7 +285,7 @@ namespace casadi {
                         casadi_int*& iw, double*& w) const {
       Rootfinder::set_work(mem, arg, res, iw, w);
       auto m = static_cast<KinsolMemory*>(mem);
-      m->jac = w; w += sp_jac_.nnz();
+      m->jac = reuse_jacobian_ ? get_ptr(m->jac_fact) : w; w += sp_jac_.nnz();
    }
 
   void KinsolInterface::get_jtimes() {
@@ -273,8 +302,19 @@ namespace casadi {
     // Get the initial guess
     casadi_copy(m->iarg[iin_], nnz_in(iin_), NV_DATA_S(m->u));
 
+    // Start with the linear solver setup of the previous call, if any
+    int flag = KINSetNoInitSetup(m->mem, reuse_jacobian_ && m->has_setup);
+    casadi_assert_dev(flag==KIN_SUCCESS);
+
     // Solve the nonlinear system of equations
-    int flag = KINSol(m->mem, m->u, strategy_, u_scale_, f_scale_);
+    flag = KINSol(m->mem, m->u, strategy_, u_scale_, f_scale_);
+    KINGetNumNonlinSolvIters(m->mem, &m->iter);
+
+    // Fixed point and Picard iterations do not return their last iterate
+    if (flag==KIN_SUCCESS && (strategy_==KIN_FP || strategy_==KIN_PICARD)) {
+      N_VScale(1.0, KINMem(m->mem)->kin_unew, m->u);
+    }
+    if (flag>=KIN_SUCCESS && m->iter>0 && strategy_!=KIN_FP) m->has_setup = true;
     m->success = flag>= KIN_SUCCESS;
     if (flag<KIN_SUCCESS) kinsol_error("KINSol", flag, error_on_fail_);
     if (flag==KIN_MAXITER_REACHED) m->unified_return_status = SOLVER_RET_LIMITED;
@@ -311,6 +351,11 @@ namespace casadi {
     m.res[iout_] = f_data;
     oracle_(m.arg, m.res, m.iw, m.w, 0);
 
+    // Fixed point iteration u = G(u), with G(u) = u - F(u)
+    if (strategy_==KIN_FP) {
+      for (casadi_int k=0; k<n_; ++k) f_data[k] = u_data[k] - f_data[k];
+    }
+
     // Make sure that all entries of the linear system are valid
     for (int k=0; k<n_; ++k) {
       try {
@@ -478,7 +523,7 @@ namespace casadi {
     //const int* row = sp_jac_.row();
 
     // Factorize the linear system
-    if (linsol_.nfact(m.jac)) casadi_error("'nfact' failed");
+    if (linsol_.nfact(m.jac, m.mem_linsol)) casadi_error("'nfact' failed");
   }
 
   int KinsolInterface::psolve_wrapper(N_Vector u, N_Vector uscale, N_Vector fval,
@@ -497,7 +542,9 @@ namespace casadi {
   void KinsolInterface::psolve(KinsolMemory& m, N_Vector u, N_Vector uscale, N_Vector fval,
                             N_Vector fscale, N_Vector v, N_Vector tmp) const {
     // Solve the factorized system
-    if (linsol_.solve(m.jac, NV_DATA_S(v))) casadi_error("'solve' failed");
+    if (linsol_.solve(m.jac, NV_DATA_S(v), 1, false, m.mem_linsol)) {
+      casadi_error("'solve' failed");
+    }
   }
 
   int KinsolInterface::lsetup(KINMem kin_mem) {
@@ -538,9 +585,9 @@ namespace casadi {
       N_VScale(1.0, b, x);
       s.psolve(*m, u, uscale, fval, fscale, x, tmp1);
 
-      // Calculate residuals
-      int flag = KINSpilsAtimes(kin_mem, x, b);
-      if (flag) return flag;
+      // Calculate residuals, b = J*x
+      int new_u = 0;
+      s.jtimes(*m, x, b, u, &new_u);
       *sJpnorm = N_VWL2Norm(b, fscale);
       N_VProd(b, fscale, b);
       N_VProd(b, fscale, b);
@@ -700,6 +747,7 @@ namespace casadi {
   KinsolMemory::KinsolMemory(const KinsolInterface& s) : self(s) {
     this->u = nullptr;
     this->mem = nullptr;
+    this->mem_linsol = -1;
   }
 
   KinsolMemory::~KinsolMemory() {
@@ -714,6 +762,12 @@ namespace casadi {
     // Current solution
     m->u = N_VNew_Serial(n_);
 
+    // Linear solver memory, and Jacobian if kept between calls
+    m->mem_linsol = linsol_.checkout();
+    if (reuse_jacobian_) m->jac_fact.resize(sp_jac_.nnz());
+    m->has_setup = false;
+    m->iter = 0;
+
     // Create KINSOL memory block
     m->mem = KINCreate();
 
@@ -737,13 +791,21 @@ namespace casadi {
     flag = KINSetPrintLevel(m->mem, print_level_);
     casadi_assert(flag==KIN_SUCCESS, "KINSetPrintLevel");
 
+    // Setting maximum number of Newton iterations
+    flag = KINSetNumMaxIters(m->mem, max_iter_);
+    casadi_assert_dev(flag==KIN_SUCCESS);
+
+    // Anderson acceleration, must be set before KINInit
+    flag = KINSetMAA(m->mem, anderson_depth_);
+    casadi_assert(flag==KIN_SUCCESS, "KINSetMAA");
+
     // Initialize KINSOL
     flag = KINInit(m->mem, func_wrapper, m->u);
     casadi_assert_dev(flag==KIN_SUCCESS);
 
-    // Setting maximum number of Newton iterations
-    flag = KINSetMaxNewtonStep(m->mem, max_iter_);
-    casadi_assert_dev(flag==KIN_SUCCESS);
+    // Maximum number of iterations between linear solver setups
+    flag = KINSetMaxSetupCalls(m->mem, max_setup_calls_);
+    casadi_assert(flag==KIN_SUCCESS, "KINSetMaxSetupCalls");
 
     // Set constraints
     if (!u_c_.empty()) {
@@ -824,4 +886,17 @@ namespace casadi {
     return 0;
   }
 
+  void KinsolInterface::free_mem(void *mem) const {
+    auto m = static_cast<KinsolMemory*>(mem);
+    if (m->mem_linsol>=0) linsol_.release(m->mem_linsol);
+    delete m;
+  }
+
+  Dict KinsolInterface::get_stats(void* mem) const {
+    Dict stats = Rootfinder::get_stats(mem);
+    auto m = static_cast<KinsolMemory*>(mem);
+    stats["iter_count"] = static_cast<casadi_int>(m->iter);
+    return stats;
+  }
+
 } // namespace casadi
@@ -73,6 +73,16 @@ namespace casadi {
 
     // Current Jacobian
     double* jac;
+
+    // Linear solver memory and Jacobian kept between calls, if reuse_jacobian
+    int mem_linsol;
+    std::vector<double> jac_fact;
+
+    // Has a linear solver setup been performed in a previous call
+    bool has_setup;
+
+    // Number of nonlinear iterations
+    long iter;
   };
 
   /** \brief \pluginbrief{Rootfinder,kinsol}
@@ -149,6 +159,15 @@ namespace casadi {
     // Absolute tolerance
     double abstol_;
 
+    // Maximum number of nonlinear iterations between linear solver setups
+    casadi_int max_setup_calls_;
+
+    // Number of previous iterates used for Anderson acceleration
+    casadi_int anderson_depth_;
+
+    // Keep the linear solver setup between calls
+    bool reuse_jacobian_;
+
     // Jacobian times vector function
     Function jtimes_;
 
@@ -168,7 +187,10 @@ namespace casadi {
     int init_mem(void* mem) const override;
 
     /** \brief Free memory block */
-    void free_mem(void *mem) const override { delete static_cast<KinsolMemory*>(mem);}
+    void free_mem(void *mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
 
     /** \brief Set the (persistent) work vectors */
     void set_work(void* mem, const double**& arg, double**& res,
@@ -66,6 +66,12 @@ const Options SundialsInterface::options_
     {"use_preconditioner",
       {OT_BOOL,
       "Precondition the iterative solver [default: true]"}},
+    {"preconditioner",
+      {OT_STRING,
+      "Preconditioner for the iterative solver: EXACT (factorize the Newton matrix)|"
+      "block_jacobi (factorize the diagonal blocks of its block triangular form)|"
+      "incomplete (incomplete LDL factorization without fill-in, for symmetric "
+      "sparsity patterns)"}},
     {"stop_at_end",
       {OT_BOOL,
       "[DEPRECATED] Stop the integrator at the end of the interval"}},
@@ -107,10 +113,41 @@ const Options SundialsInterface::options_
       "Coefficient in the nonlinear convergence test"}},
     {"scale_abstol",
      {OT_BOOL,
-      "Scale absolute tolerance by nominal value"}}
+      "Scale absolute tolerance by nominal value"}},
+    {"sensitivity_parallelization",
+     {OT_STRING,
+      "Evaluation of the forward sensitivity right-hand-sides: "
+      "SERIAL (all directions at once)|thread|openmp (one direction per task)"}},
+    {"sensitivity_max_num_threads",
+     {OT_INT,
+      "Maximum number of threads for sensitivity_parallelization [default: nfwd]"}}
     }
 };
 
+// Restrict a sparsity pattern to the diagonal blocks of its block triangular form
+static Sparsity btf_diagonal_blocks(const Sparsity& sp) {
+  std::vector<casadi_int> rowperm, colperm, rowblock, colblock, coarse_rowblock, coarse_colblock;
+  casadi_int nb = sp.btf(rowperm, colperm, rowblock, colblock, coarse_rowblock, coarse_colblock);
+  // Block of each row and column
+  std::vector<casadi_int> row_block(sp.size1(), -1), col_block(sp.size2(), -2);
+  for (casadi_int b = 0; b < nb; ++b) {
+    for (casadi_int k = rowblock[b]; k < rowblock[b + 1]; ++k) row_block[rowperm[k]] = b;
+    for (casadi_int k = colblock[b]; k < colblock[b + 1]; ++k) col_block[colperm[k]] = b;
+  }
+  // Keep the entries inside the diagonal blocks
+  std::vector<casadi_int> row, col;
+  const casadi_int *colind = sp.colind(), *r = sp.row();
+  for (casadi_int c = 0; c < sp.size2(); ++c) {
+    for (casadi_int k = colind[c]; k < colind[c + 1]; ++k) {
+      if (row_block[r[k]] == col_block[c]) {
+        row.push_back(r[k]);
+        col.push_back(c);
+      }
+    }
+  }
+  return Sparsity::triplet(sp.size1(), sp.size2(), row, col);
+}
+
 void SundialsInterface::init(const Dict& opts) {
   // Call the base class method
   Integrator::init(opts);
@@ -124,6 +161,7 @@ void SundialsInterface::init(const Dict& opts) {
   max_krylov_ = 10;
   linear_solver_ = "qr";
   std::string newton_scheme = "direct";
+  std::string preconditioner = "exact";
   quad_err_con_ = false;
   std::string interpolation_type = "hermite";
   steps_per_checkpoint_ = 20;
@@ -135,6 +173,8 @@ void SundialsInterface::init(const Dict& opts) {
   max_order_ = 0;
   nonlin_conv_coeff_ = 0;
   scale_abstol_ = false;
+  std::string sens_parallelization = "serial";
+  casadi_int sens_max_num_threads = nfwd_;
 
   // Read options
   for (auto&& op : opts) {
@@ -151,6 +191,8 @@ void SundialsInterface::init(const Dict& opts) {
       }
     } else if (op.first=="use_preconditioner") {
       use_precon_ = op.second;
+    } else if (op.first=="preconditioner") {
+      preconditioner = op.second.to_string();
     } else if (op.first=="max_krylov") {
       max_krylov_ = op.second;
     } else if (op.first=="newton_scheme") {
@@ -181,8 +223,14 @@ void SundialsInterface::init(const Dict& opts) {
       nonlin_conv_coeff_ = op.second;
     } else if (op.first=="scale_abstol") {
       scale_abstol_ = op.second;
+    } else if (op.first=="sensitivity_parallelization") {
+      sens_parallelization = op.second.to_string();
+    } else if (op.first=="sensitivity_max_num_threads") {
+      sens_max_num_threads = op.second;
     }
   }
+  casadi_assert(sens_max_num_threads >= 1 || nfwd_ == 0,
+    "Option 'sensitivity_max_num_threads' must be positive");
 
   // Type of Newton scheme
   if (newton_scheme=="direct") {
@@ -197,6 +245,18 @@ void SundialsInterface::init(const Dict& opts) {
     casadi_error("Unknown Newton scheme: " + newton_scheme);
   }
 
+  // Approximate preconditioners
+  if (preconditioner != "exact") {
+    casadi_assert(preconditioner == "block_jacobi" || preconditioner == "incomplete",
+      "Unknown preconditioner: " + preconditioner);
+    casadi_assert(newton_scheme_ != SD_DIRECT && use_precon_,
+      "Preconditioner '" + preconditioner + "' requires an iterative Newton scheme");
+    if (preconditioner == "incomplete") {
+      linear_solver_ = "ldl";
+      linear_solver_options_["incomplete"] = true;
+    }
+  }
+
   // Interpolation_type
   if (interpolation_type=="hermite") {
     interp_ = SD_HERMITE;
@@ -225,6 +285,16 @@ void SundialsInterface::init(const Dict& opts) {
       jacF_sp = horzcat(vertcat(jacF_sp, jacF.sparsity_out(JACF_ALG_X)),
         vertcat(jacF.sparsity_out(JACF_ODE_Z), jacF.sparsity_out(JACF_ALG_Z)));
     }
+    // Drop the coupling between the diagonal blocks
+    if (preconditioner == "block_jacobi") {
+      casadi_int nnz_full = jacF_sp.nnz();
+      jacF_sp = btf_diagonal_blocks(jacF_sp);
+      if (verbose_) casadi_message("Block-Jacobi preconditioner keeps " + str(jacF_sp.nnz())
+        + " of " + str(nnz_full) + " nonzeros");
+    } else if (preconditioner == "incomplete") {
+      // The LDL factorization requires a symmetric pattern
+      jacF_sp = jacF_sp + jacF_sp.T();
+    }
   } else {
     // Reuse existing Jacobian function
     jacF = d->get_function("jacF");
@@ -247,11 +317,13 @@ void SundialsInterface::init(const Dict& opts) {
 
   // Attach functions to calculate DAE and quadrature RHS all-at-once
   if (nfwd_ > 0) {
-    create_forward("daeF", nfwd_);
-    if (nq_ > 0) create_forward("quadF", nfwd_);
+    create_forward("daeF", nfwd_, sens_parallelization, sens_max_num_threads);
+    if (nq_ > 0) create_forward("quadF", nfwd_, sens_parallelization, sens_max_num_threads);
     if (nadj_ > 0) {
-      create_forward("daeB", nfwd_);
-      if (nrq_ > 0 || nuq_ > 0) create_forward("quadB", nfwd_);
+      create_forward("daeB", nfwd_, sens_parallelization, sens_max_num_threads);
+      if (nrq_ > 0 || nuq_ > 0) {
+        create_forward("quadB", nfwd_, sens_parallelization, sens_max_num_threads);
+      }
     }
   }
 
@@ -260,7 +332,7 @@ void SundialsInterface::init(const Dict& opts) {
     create_function("jtimesF", {"t", "x", "z", "p", "u", "fwd:x", "fwd:z"},
       {"fwd:ode", "fwd:alg"});
     if (nfwd_ > 0) {
-      create_forward("jtimesF", nfwd_);
+      create_forward("jtimesF", nfwd_, sens_parallelization, sens_max_num_threads);
     }
   }
 
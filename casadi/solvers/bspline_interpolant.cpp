@@ -174,6 +174,15 @@ namespace casadi {
     return ret;
   }
 
+  DM BSplineInterpolant::kron_mtimes(const std::vector<DM>& J, const DM& C) {
+    casadi_int m = C.size2();
+    DM D = C;
+    for (const DM& Jk : J) {
+      D = mtimes(Jk, DM::reshape(D, Jk.size2(), -1)).T();
+    }
+    return DM::reshape(D, m, -1).T();
+  }
+
   int BSplineInterpolant::eval(const double** arg, double** res,
                                 casadi_int* iw, double* w, void* mem) const {
     scoped_checkout<Function> m(S_);
@@ -170,6 +170,18 @@ namespace casadi {
 
     static std::vector<double> not_a_knot(const std::vector<double>& x, casadi_int k);
 
+    /** \brief Solve kron(J[n-1], ..., J[0]) C = V, V having one row per grid point
+
+        The 1-D systems are solved sequentially along each grid dimension:
+        with V viewed as a tensor with the current dimension first, each solve
+        is followed by a transpose that rotates the next dimension to the front.
+    */
+    template <typename M>
+    M kron_solve(const std::vector<DM>& J, const M& V, const Dict& linsol_options) const;
+
+    /// Multiply with kron(J[n-1], ..., J[0]) from the left
+    static DM kron_mtimes(const std::vector<DM>& J, const DM& C);
+
     template <typename M>
     MX construct_graph(const MX& x, const M& values, const Dict& linsol_options, const Dict& opts);
 
@@ -183,6 +195,18 @@ namespace casadi {
   };
 
 
+  template <typename M>
+  M BSplineInterpolant::kron_solve(const std::vector<DM>& J, const M& V,
+      const Dict& linsol_options) const {
+    casadi_int m = V.size2();
+    M D = V;
+    for (const DM& Jk : J) {
+      D = solve(Jk, M::reshape(D, Jk.size2(), -1), linear_solver_, linsol_options).T();
+    }
+    // Dimensions rotated back in place, output index first
+    return M::reshape(D, m, -1).T();
+  }
+
   template <typename M>
   MX BSplineInterpolant::construct_graph(const MX& x, const M& values,
       const Dict& linsol_options, const Dict& opts) {
@@ -210,19 +234,25 @@ namespace casadi {
           std::vector< std::vector<double> > knots;
           for (casadi_int k=0;k<degree_.size();++k)
             knots.push_back(not_a_knot(grid[k], degree_[k]));
-          Dict opts_dual;
-          opts_dual["lookup_mode"] = lookup_modes_;
-
-          DM J = MX::bspline_dual(meshgrid(grid), knots, degree_, opts_dual);
 
-          casadi_assert_dev(J.size1()==J.size2());
+          // The collocation matrix is a Kronecker product of 1-D collocation matrices
+          std::vector<DM> J(degree_.size());
+          for (casadi_int k=0;k<degree_.size();++k) {
+            Dict opts_dual;
+            if (!lookup_modes_.empty()) {
+              opts_dual["lookup_mode"] = std::vector<std::string>{lookup_modes_[k]};
+            }
+            J[k] = MX::bspline_dual(grid[k], {knots[k]}, {degree_[k]}, opts_dual);
+            casadi_assert_dev(J[k].size1()==J[k].size2());
+          }
 
           M V = M::reshape(values, m_, -1).T();
-          M C_opt = solve(J, V, linear_solver_, linsol_options);
+          M C_opt = kron_solve(J, V, linsol_options);
 
-          if (!has_parametric_values()) {
-            double fit = static_cast<double>(norm_1(mtimes(J, C_opt) - V));
-            if (verbose_) casadi_message("Lookup table fitting error: " + str(fit));
+          if (!has_parametric_values() && verbose_) {
+            DM residual = kron_mtimes(J, static_cast<DM>(C_opt)) - static_cast<DM>(V);
+            double fit = static_cast<double>(norm_1(residual));
+            casadi_message("Lookup table fitting error: " + str(fit));
           }
 
           return MX::bspline(x, C_opt.T(), knots, degree_, m_, opts_bspline);
@@ -79,6 +79,9 @@ namespace casadi {
       }
     }
 
+    // All collocation time points
+    set_collocation_points();
+
     // Call the base class init
     ImplicitFixedStepIntegrator::init(opts);
   }
@@ -96,8 +99,7 @@ namespace casadi {
     Function f = get_function("dae");
 
     // All collocation time points
-    std::vector<double> tau_root = collocation_points(deg_, collocation_scheme_);
-    tau_root.insert(tau_root.begin(), 0);
+    const std::vector<double>& tau_root = tau_root_;
 
     // Coefficients of the collocation equation
     std::vector<std::vector<double> > C(deg_ + 1, std::vector<double>(deg_ + 1, 0));
@@ -244,10 +246,69 @@ namespace casadi {
     }
   }
 
+  void Collocation::dense_prepare(FixedStepMemory* m, double t, double h,
+      bool consecutive) const {
+    if (nq_ == 0) return;
+    const double* v = m->v;
+    casadi_int nxz = nx_ + nz_;
+    for (casadi_int j = 1; j < deg_ + 1; ++j) {
+      double tj = t + h * tau_root_[j];
+      std::fill(m->arg, m->arg + DYN_NUM_IN, nullptr);
+      m->arg[DYN_T] = &tj;
+      m->arg[DYN_X] = v + (j - 1) * nxz;
+      m->arg[DYN_Z] = v + (j - 1) * nxz + nx_;
+      m->arg[DYN_P] = m->p;
+      m->arg[DYN_U] = m->u;
+      std::fill(m->res, m->res + DYN_NUM_OUT, nullptr);
+      m->res[DYN_QUAD] = m->dense + (j - 1) * nq_;
+      if (calc_function(m, "dae")) casadi_error("Evaluating the DAE right-hand side failed");
+    }
+  }
+
+  void Collocation::interpolate(FixedStepMemory* m, double t, double h, double theta,
+      double* x, double* z, double* q) const {
+    // Collocated states x_1, z_1, ..., x_d, z_d of the last step
+    const double* v = m->v;
+    casadi_int nxz = nx_ + nz_;
+    // Lagrange basis through all points for x, through the collocation points for z and q
+    casadi_clear(x, nx_);
+    casadi_clear(z, nz_);
+    casadi_copy(m->q_prev, nq_, q);
+    for (casadi_int j = 0; j < deg_ + 1; ++j) {
+      double lj = 1, pz = 1;
+      for (casadi_int r = 0; r < deg_ + 1; ++r) {
+        if (r == j) continue;
+        double d = tau_root_[j] - tau_root_[r];
+        lj *= (theta - tau_root_[r]) / d;
+        if (r > 0) pz *= (theta - tau_root_[r]) / d;
+      }
+      casadi_axpy(nx_, lj, j == 0 ? m->x_prev : v + (j - 1) * nxz, x);
+      if (j == 0) continue;
+      casadi_axpy(nz_, pz, v + (j - 1) * nxz + nx_, z);
+      // Quadrature: integrate the interpolated integrand, as in the step
+      casadi_axpy(nq_, h * quad_basis_[j](theta), m->dense + (j - 1) * nq_, q);
+    }
+  }
+
   Collocation::Collocation(DeserializingStream& s) : ImplicitFixedStepIntegrator(s) {
     s.version("Collocation", 2);
     s.unpack("Collocation::deg", deg_);
     s.unpack("Collocation::collocation_scheme", collocation_scheme_);
+    set_collocation_points();
+  }
+
+  void Collocation::set_collocation_points() {
+    tau_root_ = collocation_points(deg_, collocation_scheme_);
+    tau_root_.insert(tau_root_.begin(), 0);
+    // Lagrange basis through the collocation points, integrated from the start of the step
+    quad_basis_.resize(deg_ + 1);
+    for (casadi_int j = 1; j < deg_ + 1; ++j) {
+      Polynomial pz = 1;
+      for (casadi_int r = 1; r < deg_ + 1; ++r) {
+        if (r != j) pz *= Polynomial(-tau_root_[r], 1) / (tau_root_[j] - tau_root_[r]);
+      }
+      quad_basis_[j] = pz.anti_derivative();
+    }
   }
 
   void Collocation::serialize_body(SerializingStream &s) const {
@@ -28,6 +28,7 @@
 
 #include "casadi/core/integrator_impl.hpp"
 #include "casadi/core/integration_tools.hpp"
+#include "casadi/core/polynomial.hpp"
 #include <casadi/solvers/casadi_integrator_collocation_export.h>
 
 /** \defgroup plugin_Integrator_collocation Title
@@ -95,6 +96,16 @@ namespace casadi {
     void reset(IntegratorMemory* mem,
       const double* x, const double* z, const double* p) const override;
 
+    /// Quadrature integrands at the collocation points
+    casadi_int dense_size() const override { return deg_ * nq_;}
+
+    /** \brief Evaluate the quadrature integrands of the last step */
+    void dense_prepare(FixedStepMemory* m, double t, double h, bool consecutive) const override;
+
+    /** \brief Evaluate the collocation polynomial of the last step */
+    void interpolate(FixedStepMemory* m, double t, double h, double theta,
+      double* x, double* z, double* q) const override;
+
     MX algebraic_state_init(const MX& x0, const MX& z0) const override;
     MX algebraic_state_output(const MX& Z) const override;
 
@@ -104,6 +115,15 @@ namespace casadi {
     // Collocation scheme
     std::string collocation_scheme_;
 
+    // Collocation points, including the start of the interval
+    std::vector<double> tau_root_;
+
+    // Integrated Lagrange basis through the collocation points, for dense output
+    std::vector<Polynomial> quad_basis_;
+
+    // Set the collocation points and the derived interpolation data
+    void set_collocation_points();
+
     /// A documentation string
     static const std::string meta_doc;
 
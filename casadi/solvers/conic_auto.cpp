@@ -0,0 +1,200 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "conic_auto.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_AUTO_EXPORT
+  casadi_register_conic_auto(Conic::Plugin* plugin) {
+    plugin->creator = ConicAuto::creator;
+    plugin->name = "auto";
+    plugin->doc = ConicAuto::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &ConicAuto::options_;
+    plugin->deserialize = &ConicAuto::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_AUTO_EXPORT casadi_load_conic_auto() {
+    Conic::registerPlugin(casadi_register_conic_auto);
+  }
+
+  ConicAuto::ConicAuto(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  ConicAuto::~ConicAuto() {
+    clear_mem();
+  }
+
+  void* ConicAuto::alloc_mem() const {
+    ConicAutoMemory *m = new ConicAutoMemory();
+    m->solver_mem = solver_.checkout();
+    return m;
+  }
+
+  void ConicAuto::free_mem(void *mem) const {
+    auto m = static_cast<ConicAutoMemory*>(mem);
+    solver_.release(m->solver_mem);
+    delete m;
+  }
+
+  const Options ConicAuto::options_
+  = {{&Conic::options_},
+     {{"dense_threshold",
+       {OT_DOUBLE,
+        "Use a dense solver if the fraction of structural nonzeros in H and A "
+        "is at least this value [0.3]"}},
+      {"dense_max_size",
+       {OT_INT,
+        "Never use a dense solver if the number of variables plus constraints "
+        "exceeds this value [300]"}},
+      {"dense_plugins",
+       {OT_STRINGVECTOR,
+        "Dense solvers to try, in order [qpoases, proxqp, qrqp]"}},
+      {"sparse_plugins",
+       {OT_STRINGVECTOR,
+        "Sparse solvers to try, in order [highs, ooqp, proxqp, qrqp]"}},
+      {"plugin_options",
+       {OT_DICT,
+        "Options to be passed to the selected solver, by plugin name"}}
+     }
+  };
+
+  double ConicAuto::density() const {
+    double n = static_cast<double>(nx_)*static_cast<double>(nx_ + na_);
+    if (n==0) return 0;
+    return static_cast<double>(H_.nnz() + A_.nnz())/n;
+  }
+
+  void ConicAuto::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+
+    // Default options
+    double dense_threshold = 0.3;
+    casadi_int dense_max_size = 300;
+    std::vector<std::string> dense_plugins = {"qpoases", "proxqp", "qrqp"};
+    std::vector<std::string> sparse_plugins = {"highs", "ooqp", "proxqp", "qrqp"};
+    Dict plugin_options;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="dense_threshold") {
+        dense_threshold = op.second;
+      } else if (op.first=="dense_max_size") {
+        dense_max_size = op.second;
+      } else if (op.first=="dense_plugins") {
+        dense_plugins = op.second;
+      } else if (op.first=="sparse_plugins") {
+        sparse_plugins = op.second;
+      } else if (op.first=="plugin_options") {
+        plugin_options = op.second;
+      }
+    }
+
+    // Dense storage pays off for small problems with enough fill
+    bool dense = nx_ + na_ <= dense_max_size && density() >= dense_threshold;
+    const std::vector<std::string>& plugins = dense ? dense_plugins : sparse_plugins;
+    if (verbose_) {
+      casadi_message("Fill " + str(density()) + ", trying "
+        + std::string(dense ? "dense" : "sparse") + " solvers " + str(plugins));
+    }
+
+    // Problem structure
+    std::map<std::string, Sparsity> st = {{"h", H_}, {"a", A_}};
+    if (!Q_.is_empty()) st["q"] = Q_;
+    if (!P_.is_empty()) st["p"] = P_;
+
+    // Take the first plugin that is available and accepts the problem
+    std::string errors;
+    for (const std::string& p : plugins) {
+      if (!has_conic(p)) continue;
+      Dict solver_opts;
+      if (plugin_options.find(p)!=plugin_options.end()) solver_opts = plugin_options.at(p);
+      if (p=="proxqp") {
+        solver_opts = combine(solver_opts,
+          {{"proxqp", Dict{{"backend", dense ? "dense" : "sparse"}}}}, true);
+      } else if (p=="qpoases" && !dense) {
+        solver_opts = combine(solver_opts, {{"sparse", true}});
+      }
+      if (!discrete_.empty()) solver_opts["discrete"] = discrete_;
+      solver_opts["error_on_fail"] = false;
+      try {
+        solver_ = conic(name_ + "_" + p, p, st, solver_opts);
+      } catch (std::exception& e) {
+        errors += "\n" + p + ": " + e.what();
+        continue;
+      }
+      plugin_ = p;
+      break;
+    }
+    casadi_assert(!solver_.is_null(), "No QP solver available for this problem among "
+      + str(plugins) + "." + errors);
+    if (verbose_) casadi_message("Selected '" + plugin_ + "'");
+
+    alloc(solver_);
+  }
+
+  int ConicAuto::
+  solve(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<ConicAutoMemory*>(mem);
+
+    // Same inputs and outputs
+    int ret = solver_(arg, res, iw, w, m->solver_mem);
+    auto solver_m = static_cast<ConicMemory*>(solver_.memory(m->solver_mem));
+    m->d_qp.success = solver_m->d_qp.success;
+    m->d_qp.unified_return_status = solver_m->d_qp.unified_return_status;
+    m->d_qp.iter_count = solver_m->d_qp.iter_count;
+    return ret;
+  }
+
+  Dict ConicAuto::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    auto m = static_cast<ConicAutoMemory*>(mem);
+    stats["plugin"] = plugin_;
+    stats["solver_stats"] = solver_.stats(m->solver_mem);
+    return stats;
+  }
+
+  ConicAuto::ConicAuto(DeserializingStream& s) : Conic(s) {
+    s.version("ConicAuto", 1);
+    s.unpack("ConicAuto::plugin", plugin_);
+    s.unpack("ConicAuto::solver", solver_);
+  }
+
+  void ConicAuto::serialize_body(SerializingStream &s) const {
+    Conic::serialize_body(s);
+
+    s.version("ConicAuto", 1);
+    s.pack("ConicAuto::plugin", plugin_);
+    s.pack("ConicAuto::solver", solver_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,129 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_CONIC_AUTO_HPP
+#define CASADI_CONIC_AUTO_HPP
+
+#include "casadi/core/conic_impl.hpp"
+#include <casadi/solvers/casadi_conic_auto_export.h>
+
+
+/** \defgroup plugin_Conic_auto Title
+    \par
+
+   Select a QP solver from the sparsity of H and A.
+   Problems that are small and dense enough are routed to a solver with
+   dense storage, the others to a sparse solver. The first available
+   plugin of the corresponding list that accepts the problem is used.
+
+    \identifier{2f0} */
+
+/** \pluginsection{Conic,auto} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_CONIC_AUTO_EXPORT ConicAutoMemory : public ConicMemory {
+    casadi_int solver_mem;
+  };
+
+  /** \brief \pluginbrief{Conic,auto}
+
+      @copydoc Conic_doc
+      @copydoc plugin_Conic_auto
+  */
+  class CASADI_CONIC_AUTO_EXPORT ConicAuto : public Conic {
+  public:
+    /** \brief  Create a new Solver */
+    explicit ConicAuto(const std::string& name,
+                       const std::map<std::string, Sparsity> &st);
+
+    /** \brief  Create a new QP Solver */
+    static Conic* creator(const std::string& name,
+                          const std::map<std::string, Sparsity>& st) {
+      return new ConicAuto(name, st);
+    }
+
+    /** \brief  Destructor */
+    ~ConicAuto() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "auto";}
+
+    // Get name of the class
+    std::string class_name() const override { return "ConicAuto";}
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Can discrete variables be treated
+    bool integer_support() const override { return true;}
+
+    /// Can psd constraints be treated
+    bool psd_support() const override { return true;}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    int solve(const double** arg, double** res,
+      casadi_int* iw, double* w, void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    /// Fraction of structural nonzeros in H and A
+    double density() const;
+
+    /// Selected plugin
+    std::string plugin_;
+
+    /// Solve with
+    Function solver_;
+
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new ConicAuto(s); }
+
+  protected:
+     /** \brief Deserializing constructor */
+    explicit ConicAuto(DeserializingStream& s);
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_CONIC_AUTO_HPP
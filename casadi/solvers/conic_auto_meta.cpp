@@ -0,0 +1,68 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *    Copyright (C) 2019 Jorn Baayen, KISTERS AG
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "conic_auto.hpp"
+      #include <string>
+
+      const std::string casadi::ConicAuto::meta_doc=
+      "\n"
+"Select a QP solver from the sparsity of H and A.\n"
+"Problems that are small and dense enough are routed to a solver with\n"
+"dense storage, the others to a sparse solver. The first available\n"
+"plugin of the corresponding list that accepts the problem is used.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+--------------------------------+\n"
+"|       Id        |      Type       |          Description           |\n"
+"+=================+=================+================================+\n"
+"| dense_max_size  | OT_INT          | Never use a dense solver if    |\n"
+"|                 |                 | the number of variables plus   |\n"
+"|                 |                 | constraints exceeds this value |\n"
+"|                 |                 | [300]                          |\n"
+"+-----------------+-----------------+--------------------------------+\n"
+"| dense_plugins   | OT_STRINGVECTOR | Dense solvers to try, in order |\n"
+"|                 |                 | [qpoases, proxqp, qrqp]        |\n"
+"+-----------------+-----------------+--------------------------------+\n"
+"| dense_threshold | OT_DOUBLE       | Use a dense solver if the      |\n"
+"|                 |                 | fraction of structural         |\n"
+"|                 |                 | nonzeros in H and A is at      |\n"
+"|                 |                 | least this value [0.3]         |\n"
+"+-----------------+-----------------+--------------------------------+\n"
+"| plugin_options  | OT_DICT         | Options to be passed to the    |\n"
+"|                 |                 | selected solver, by plugin     |\n"
+"|                 |                 | name                           |\n"
+"+-----------------+-----------------+--------------------------------+\n"
+"| sparse_plugins  | OT_STRINGVECTOR | Sparse solvers to try, in      |\n"
+"|                 |                 | order [highs, ooqp, proxqp,    |\n"
+"|                 |                 | qrqp]                          |\n"
+"+-----------------+-----------------+--------------------------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -0,0 +1,651 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "dormand_prince.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTEGRATOR_DOPRI_EXPORT
+      casadi_register_integrator_dopri(Integrator::Plugin* plugin) {
+    plugin->creator = DormandPrince::creator;
+    plugin->name = "dopri";
+    plugin->doc = DormandPrince::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &DormandPrince::options_;
+    plugin->deserialize = &DormandPrince::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTEGRATOR_DOPRI_EXPORT casadi_load_integrator_dopri() {
+    Integrator::registerPlugin(casadi_register_integrator_dopri);
+  }
+
+  // Bounds on the step size change after a step
+  static const double fac_min = 0.2, fac_max = 5.;
+
+  DormandPrince::DormandPrince(const std::string& name, const Function& dae, double t0,
+      const std::vector<double>& tout)
+      : Integrator(name, dae, t0, tout) {
+  }
+
+  DormandPrince::~DormandPrince() {
+    clear_mem();
+  }
+
+  const Options DormandPrince::options_
+  = {{&Integrator::options_},
+     {{"abstol",
+       {OT_DOUBLE,
+        "Absolute tolerence for the IVP solution [default: 1e-8]"}},
+      {"reltol",
+       {OT_DOUBLE,
+        "Relative tolerence for the IVP solution [default: 1e-6]"}},
+      {"max_num_steps",
+       {OT_INT,
+        "Maximum number of integrator steps, including rejected ones [default: 10000]"}},
+      {"step0",
+       {OT_DOUBLE,
+        "Initial step size [default: 0/one thousandth of the horizon]"}},
+      {"max_step_size",
+       {OT_DOUBLE,
+        "Max step size [default: 0/inf]"}}
+     }
+  };
+
+  void DormandPrince::init(const Dict& opts) {
+    // Call the base class init
+    Integrator::init(opts);
+
+    // Default options
+    abstol_ = 1e-8;
+    reltol_ = 1e-6;
+    max_num_steps_ = 10000;
+    step0_ = 0;
+    max_step_size_ = 0;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="abstol") {
+        abstol_ = op.second;
+      } else if (op.first=="reltol") {
+        reltol_ = op.second;
+      } else if (op.first=="max_num_steps") {
+        max_num_steps_ = op.second;
+      } else if (op.first=="step0") {
+        step0_ = op.second;
+      } else if (op.first=="max_step_size") {
+        max_step_size_ = op.second;
+      }
+    }
+
+    // Algebraic variables not supported
+    casadi_assert(nz_==0 && nrz_==0,
+      "Explicit Runge-Kutta integrators do not support algebraic variables");
+    casadi_assert(abstol_ > 0, "Absolute tolerance must be strictly positive");
+
+    // Continuous-time dynamics, forward problem
+    set_function(oracle_, "dae");
+    if (nadj_ > 0) set_function(rdae_, "rdae");
+    const Function& f = oracle_;
+
+    // Symbolic inputs
+    MX t0 = MX::sym("t0", f.sparsity_in(DYN_T));
+    MX h = MX::sym("h");
+    MX x0 = MX::sym("x0", f.sparsity_in(DYN_X));
+    MX p = MX::sym("p", f.sparsity_in(DYN_P));
+    MX u = MX::sym("u", f.sparsity_in(DYN_U));
+
+    // Butcher tableau of the Dormand-Prince 5(4) pair, last row holds the 5th order weights
+    const double c[7] = {0, 1./5, 3./10, 4./5, 8./9, 1, 1};
+    const double a[7][6] = {
+      {0},
+      {1./5},
+      {3./40, 9./40},
+      {44./45, -56./15, 32./9},
+      {19372./6561, -25360./2187, 64448./6561, -212./729},
+      {9017./3168, -355./33, 46732./5247, 49./176, -5103./18656},
+      {35./384, 0, 500./1113, 125./192, -2187./6784, 11./84}};
+
+    // Difference between the 5th and 4th order weights
+    const double e[7] = {71./57600, 0, -71./16695, 71./1920, -17253./339200, 22./525, -1./40};
+
+    // Arguments when calling f
+    std::vector<MX> f_arg(DYN_NUM_IN);
+    std::vector<MX> f_res;
+    f_arg[DYN_P] = p;
+    f_arg[DYN_U] = u;
+
+    // Stages, the last one evaluated at the 5th order solution
+    std::vector<MX> k(7), kq(7);
+    MX xf, qf;
+    for (casadi_int s = 0; s < 7; ++s) {
+      MX xs = x0;
+      for (casadi_int j = 0; j < s; ++j) {
+        if (a[s][j] != 0) xs += (a[s][j] * h) * k[j];
+      }
+      f_arg[DYN_T] = t0 + c[s] * h;
+      f_arg[DYN_X] = xs;
+      f_res = f(f_arg);
+      k[s] = f_res[DYN_ODE];
+      kq[s] = f_res[DYN_QUAD];
+      if (s == 6) xf = xs;
+    }
+
+    // Quadratures and error estimate
+    qf = MX::zeros(f.sparsity_out(DYN_QUAD));
+    MX err = MX::zeros(f.sparsity_out(DYN_ODE));
+    for (casadi_int s = 0; s < 7; ++s) {
+      if (s < 6 && a[6][s] != 0) qf += (a[6][s] * h) * kq[s];
+      if (e[s] != 0) err += (e[s] * h) * k[s];
+    }
+
+    // Define discrete time dynamics
+    f_arg.resize(STEP_NUM_IN);
+    f_arg[STEP_T] = t0;
+    f_arg[STEP_H] = h;
+    f_arg[STEP_X0] = x0;
+    f_arg[STEP_V0] = MX(0, 1);
+    f_arg[STEP_P] = p;
+    f_arg[STEP_U] = u;
+    f_res.resize(STEP_NUM_OUT);
+    f_res[STEP_XF] = xf;
+    f_res[STEP_VF] = MX(0, 1);
+    f_res[STEP_QF] = qf;
+    Function F("step", f_arg, f_res,
+      {"t", "h", "x0", "v0", "p", "u"}, {"xf", "vf", "qf"});
+    set_function(F, F.name(), true);
+    if (nfwd_ > 0) create_forward("step", nfwd_);
+
+    // Same step with the error estimate, used for trial steps
+    f_res.push_back(err);
+    Function F_err("step_err", f_arg, f_res,
+      {"t", "h", "x0", "v0", "p", "u"}, {"xf", "vf", "qf", "err"});
+    set_function(F_err, F_err.name(), true);
+
+    // Backward integration
+    if (nadj_ > 0) {
+      Function adj_F = F.reverse(nadj_);
+      set_function(adj_F, adj_F.name(), true);
+      if (nfwd_ > 0) {
+        create_forward(adj_F.name(), nfwd_);
+      }
+    }
+
+    // Work vectors, forward problem
+    alloc_w(np_, true); // p
+    alloc_w(nu_, true); // u
+    alloc_w(nq_, true); // q
+    alloc_w(nx_, true); // xf
+    alloc_w(nq_, true); // qf
+    alloc_w(nx1_, true); // err
+
+    // Work vectors, backward problem
+    alloc_w(nrp_, true); // rp
+    alloc_w(nuq_, true); // uq
+    alloc_w(nrq_, true); // rq_prev
+    alloc_w(nuq_, true); // uq_prev
+  }
+
+  void DormandPrince::set_work(void* mem, const double**& arg, double**& res,
+      casadi_int*& iw, double*& w) const {
+    auto m = static_cast<DormandPrinceMemory*>(mem);
+
+    // Set work in base classes
+    Integrator::set_work(mem, arg, res, iw, w);
+
+    // Work vectors, allocated in base class
+    m->x = w; w += nx_;
+    m->z = w; w += nz_;
+    m->x_prev = w; w += nx_;
+    m->rx = w; w += nrx_;
+    m->rz = w; w += nrz_;
+    m->rx_prev = w; w += nrx_;
+    m->rq = w; w += nrq_;
+
+    // Work vectors, forward problem
+    m->p = w; w += np_;
+    m->u = w; w += nu_;
+    m->q = w; w += nq_;
+    m->xf = w; w += nx_;
+    m->qf = w; w += nq_;
+    m->err = w; w += nx1_;
+
+    // Work vectors, backward problem
+    m->rp = w; w += nrp_;
+    m->uq = w; w += nuq_;
+    m->rq_prev = w; w += nrq_;
+    m->uq_prev = w; w += nuq_;
+  }
+
+  int DormandPrince::init_mem(void* mem) const {
+    if (Integrator::init_mem(mem)) return 1;
+    auto m = static_cast<DormandPrinceMemory*>(mem);
+    m->h = 0;
+    m->nsteps = m->nrejected = 0;
+    return 0;
+  }
+
+  void DormandPrince::reset(IntegratorMemory* mem, const double* x, const double* z,
+      const double* p) const {
+    auto m = static_cast<DormandPrinceMemory*>(mem);
+
+    // Set parameters
+    casadi_copy(p, np_, m->p);
+
+    // Update the state
+    casadi_copy(x, nx_, m->x);
+
+    // Reset summation states
+    casadi_clear(m->q, nq_);
+
+    // Initial step size
+    m->h = step0_ > 0 ? step0_ : 1e-3 * (tout_.back() - t0_);
+    if (max_step_size_ > 0) m->h = std::min(m->h, max_step_size_);
+
+    // Reset statistics
+    m->nsteps = m->nrejected = 0;
+
+    // Start the tape
+    if (nrx_ > 0) {
+      m->t_tape.clear();
+      m->h_tape.clear();
+      m->x_tape.assign(m->x, m->x + nx_);
+      m->k_tape.assign(1, 0);
+    }
+  }
+
+  double DormandPrince::error_norm(const double* x0, const double* xf,
+      const double* err) const {
+    double s = 0;
+    for (casadi_int i = 0; i < nx1_; ++i) {
+      double r = err[i] / (abstol_ + reltol_ * std::fmax(std::fabs(x0[i]), std::fabs(xf[i])));
+      s += r * r;
+    }
+    return std::sqrt(s / static_cast<double>(nx1_));
+  }
+
+  double DormandPrince::step_factor(double err_norm) const {
+    if (err_norm == 0) return fac_max;
+    double fac = 0.9 * std::pow(err_norm, -0.2);
+    // Also catches a non-finite error estimate
+    if (!(fac >= fac_min)) return fac_min;
+    return std::min(fac, fac_max);
+  }
+
+  double DormandPrince::trial_step(DormandPrinceMemory* m, double t, double h) const {
+    std::fill(m->arg, m->arg + STEP_NUM_IN, nullptr);
+    m->arg[STEP_T] = &t;  // t
+    m->arg[STEP_H] = &h;  // h
+    m->arg[STEP_X0] = m->x;  // x0
+    m->arg[STEP_P] = m->p;  // p
+    m->arg[STEP_U] = m->u;  // u
+    std::fill(m->res, m->res + STEP_NUM_OUT + 1, nullptr);
+    m->res[STEP_XF] = m->xf;  // xf
+    m->res[STEP_QF] = m->qf;  // qf
+    m->res[STEP_NUM_OUT] = m->err;  // err
+    calc_function(m, "step_err");
+    return error_norm(m->x, m->xf, m->err);
+  }
+
+  void DormandPrince::stepF_fwd(DormandPrinceMemory* m, double t, double h) const {
+    m->arg[STEP_T] = &t;  // t
+    m->arg[STEP_H] = &h;  // h
+    m->arg[STEP_X0] = m->x;  // x0
+    m->arg[STEP_V0] = nullptr;  // v0
+    m->arg[STEP_P] = m->p;  // p
+    m->arg[STEP_U] = m->u;  // u
+    m->arg[STEP_NUM_IN + STEP_XF] = m->xf;  // out:xf
+    m->arg[STEP_NUM_IN + STEP_VF] = nullptr;  // out:vf
+    m->arg[STEP_NUM_IN + STEP_QF] = m->qf;  // out:qf
+    m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_T] = nullptr;  // fwd:t
+    m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_H] = nullptr;  // fwd:h
+    m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_X0] = m->x + nx1_;  // fwd:x0
+    m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_V0] = nullptr;  // fwd:v0
+    m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_P] = m->p + np1_;  // fwd:p
+    m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_U] = m->u + nu1_;  // fwd:u
+    m->res[STEP_XF] = m->xf + nx1_;  // fwd:xf
+    m->res[STEP_VF] = nullptr;  // fwd:vf
+    m->res[STEP_QF] = m->qf + nq1_;  // fwd:qf
+    calc_function(m, forward_name("step", nfwd_));
+  }
+
+  void DormandPrince::advance(IntegratorMemory* mem,
+      const double* u, double* x, double* z, double* q) const {
+    auto m = static_cast<DormandPrinceMemory*>(mem);
+
+    // Set controls
+    casadi_copy(u, nu_, m->u);
+
+    // Take steps until the output time is reached
+    double t = m->t;
+    while (t < m->t_next) {
+      casadi_assert(m->nsteps + m->nrejected < max_num_steps_,
+        "Maximum number of steps reached at t = " + str(t));
+      // Do not step past the output time
+      double h = m->h;
+      bool last = t + h >= m->t_next;
+      if (last) h = m->t_next - t;
+      casadi_assert(t + h > t, "Step size underflow at t = " + str(t));
+
+      // Trial step
+      double err_norm = trial_step(m, t, h);
+      bool accepted = err_norm <= 1;
+      if (accepted) {
+        // Propagate sensitivities before x is overwritten
+        if (nfwd_ > 0) stepF_fwd(m, t, h);
+        casadi_copy(m->xf, nx_, m->x);
+        casadi_axpy(nq_, 1., m->qf, m->q);
+        // Save step, if needed
+        if (nrx_ > 0) {
+          m->t_tape.push_back(t);
+          m->h_tape.push_back(h);
+          m->x_tape.insert(m->x_tape.end(), m->x, m->x + nx_);
+        }
+        t = last ? m->t_next : t + h;
+        m->nsteps++;
+      } else {
+        m->nrejected++;
+      }
+
+      // Next step size, a last step that was cut short does not shrink it
+      double h_new = h * step_factor(err_norm);
+      m->h = accepted && last ? std::max(h_new, m->h) : h_new;
+      if (max_step_size_ > 0) m->h = std::min(m->h, max_step_size_);
+    }
+
+    // Accepted steps belonging to this output interval
+    if (nrx_ > 0) m->k_tape.push_back(m->t_tape.size());
+
+    // Return to user
+    casadi_copy(m->x, nx_, x);
+    casadi_copy(m->q, nq_, q);
+  }
+
+  void DormandPrince::resetB(IntegratorMemory* mem) const {
+    auto m = static_cast<DormandPrinceMemory*>(mem);
+
+    // Clear adjoint seeds
+    casadi_clear(m->rp, nrp_);
+    casadi_clear(m->rx, nrx_);
+
+    // Reset summation states
+    casadi_clear(m->rq, nrq_);
+    casadi_clear(m->uq, nuq_);
+  }
+
+  void DormandPrince::impulseB(IntegratorMemory* mem,
+      const double* rx, const double* rz, const double* rp) const {
+    auto m = static_cast<DormandPrinceMemory*>(mem);
+    // Add impulse to backward parameters
+    casadi_axpy(nrp_, 1., rp, m->rp);
+
+    // Add impulse to state
+    casadi_axpy(nrx_, 1., rx, m->rx);
+  }
+
+  void DormandPrince::retreat(IntegratorMemory* mem, const double* u,
+      double* rx, double* rq, double* uq) const {
+    auto m = static_cast<DormandPrinceMemory*>(mem);
+
+    // Set controls
+    casadi_copy(u, nu_, m->u);
+
+    // Revisit the accepted steps of the output interval in reverse order
+    for (casadi_int j = m->k_tape[m->k + 1]; j-- > m->k_tape[m->k]; ) {
+      // Update the previous step
+      casadi_copy(m->rx, nrx_, m->rx_prev);
+      casadi_copy(m->rq, nrq_, m->rq_prev);
+      casadi_copy(m->uq, nuq_, m->uq_prev);
+
+      // Take step
+      stepB(m, m->t_tape[j], m->h_tape[j],
+        get_ptr(m->x_tape) + nx_ * j, get_ptr(m->x_tape) + nx_ * (j + 1),
+        m->rx_prev, m->rx, m->rq, m->uq);
+      casadi_axpy(nrq_, 1., m->rq_prev, m->rq);
+      casadi_axpy(nuq_, 1., m->uq_prev, m->uq);
+    }
+
+    // Return to user
+    casadi_copy(m->rx, nrx_, rx);
+    casadi_copy(m->rq, nrq_, rq);
+    casadi_copy(m->uq, nuq_, uq);
+  }
+
+  void DormandPrince::stepB(DormandPrinceMemory* m, double t, double h,
+      const double* x0, const double* xf, const double* rx0,
+      double* rxf, double* rqf, double* uqf) const {
+    // Evaluate nondifferentiated
+    std::fill(m->arg, m->arg + BSTEP_NUM_IN, nullptr);
+    m->arg[BSTEP_T] = &t;  // t
+    m->arg[BSTEP_H] = &h;  // h
+    m->arg[BSTEP_X0] = x0;  // x0
+    m->arg[BSTEP_P] = m->p;  // p
+    m->arg[BSTEP_U] = m->u;  // u
+    m->arg[BSTEP_OUT_XF] = xf;  // out:xf
+    m->arg[BSTEP_ADJ_XF] = rx0;  // adj:xf
+    m->arg[BSTEP_ADJ_QF] = m->rp;  // adj:qf
+    std::fill(m->res, m->res + BSTEP_NUM_OUT, nullptr);
+    m->res[BSTEP_ADJ_X0] = rxf;  // adj:x0
+    m->res[BSTEP_ADJ_P] = rqf;  // adj:p
+    m->res[BSTEP_ADJ_U] = uqf;  // adj:u
+    calc_function(m, reverse_name("step", nadj_));
+    // Evaluate sensitivities
+    if (nfwd_ > 0) {
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_T] = nullptr;  // out:adj:t
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_H] = nullptr;  // out:adj:h
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_X0] = rxf;  // out:adj:x0
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_V0] = nullptr;  // out:adj:v0
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_P] = rqf;  // out:adj:p
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_U] = uqf;  // out:adj:u
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_T] = nullptr;  // fwd:t
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_H] = nullptr;  // fwd:h
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_X0] = x0 + nx1_;  // fwd:x0
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_V0] = nullptr;  // fwd:v0
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_P] = m->p + np1_;  // fwd:p
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_U] = m->u + nu1_;  // fwd:u
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_OUT_XF] = xf + nx1_;  // fwd:out:xf
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_OUT_VF] = nullptr;  // fwd:out:vf
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_OUT_QF] = nullptr;  // fwd:out:qf
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_ADJ_XF] = rx0 + nrx1_ * nadj_;  // fwd:adj:xf
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_ADJ_VF] = nullptr;  // fwd:adj:vf
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_ADJ_QF] = m->rp + nrp1_ * nadj_;  // fwd:adj:qf
+      m->res[BSTEP_ADJ_T] = nullptr;  // fwd:adj:t
+      m->res[BSTEP_ADJ_H] = nullptr;  // fwd:adj:h
+      m->res[BSTEP_ADJ_X0] = rxf + nrx1_ * nadj_;  // fwd:rxf
+      m->res[BSTEP_ADJ_V0] = nullptr;  // fwd:adj:v0
+      m->res[BSTEP_ADJ_P] = rqf + nrq1_ * nadj_;  // fwd:rqf
+      m->res[BSTEP_ADJ_U] = uqf + nuq1_ * nadj_;  // fwd:uqf
+      calc_function(m, forward_name(reverse_name("step", nadj_), nfwd_));
+    }
+  }
+
+  Dict DormandPrince::get_stats(void* mem) const {
+    Dict stats = Integrator::get_stats(mem);
+    auto m = static_cast<DormandPrinceMemory*>(mem);
+    stats["nsteps"] = m->nsteps;
+    stats["nrejected"] = m->nrejected;
+    return stats;
+  }
+
+  void DormandPrince::print_stats(IntegratorMemory* mem) const {
+    auto m = static_cast<DormandPrinceMemory*>(mem);
+    print("FORWARD INTEGRATION:\n");
+    print("Number of accepted steps: %ld\n", static_cast<long>(m->nsteps));
+    print("Number of rejected steps: %ld\n", static_cast<long>(m->nrejected));
+    print("Step size to be attempted on the next step: %g\n", m->h);
+  }
+
+  void DormandPrince::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(get_function("step_err"));
+    if (nfwd_ > 0) g.add_dependency(get_function(forward_name("step", nfwd_)));
+  }
+
+  void DormandPrince::codegen_body(CodeGenerator& g) const {
+    // Work vectors, after the ones allocated in the base class
+    casadi_int w_offset = 2 * nx_ + nz_ + 2 * nrx_ + nrz_ + nrq_;
+    g.local("xk", "casadi_real", "*");
+    g.local("pk", "casadi_real", "*");
+    g.local("uk", "casadi_real", "*");
+    g.local("qk", "casadi_real", "*");
+    g.local("xf", "casadi_real", "*");
+    g.local("qf", "casadi_real", "*");
+    g.local("ek", "casadi_real", "*");
+    g << "xk = w;\n";
+    g << "pk = w+" << w_offset << ";\n"; w_offset += np_;
+    g << "uk = w+" << w_offset << ";\n"; w_offset += nu_;
+    g << "qk = w+" << w_offset << ";\n"; w_offset += nq_;
+    g << "xf = w+" << w_offset << ";\n"; w_offset += nx_;
+    g << "qf = w+" << w_offset << ";\n"; w_offset += nq_;
+    g << "ek = w+" << w_offset << ";\n"; w_offset += nx1_;
+    w_offset += nrp_ + 2 * nuq_ + nrq_;
+    std::string w_call = "w+" + str(w_offset);
+    g.local("tk", "casadi_real");
+    g.local("hk", "casadi_real");
+    g.local("hn", "casadi_real");
+    g.local("en", "casadi_real");
+    g.local("fac", "casadi_real");
+    g.local("k", "casadi_int");
+    g.local("i", "casadi_int");
+    g.local("ns", "casadi_int");
+    g.local("last", "casadi_int");
+    std::string tout = g.constant(tout_);
+
+    // Offset pointer into a gridded argument or result, if any
+    auto grid_ptr = [](const std::string& v, casadi_int n) {
+      return v + " ? " + v + "+" + str(n) + "*k : 0";
+    };
+
+    g.comment("Initial conditions");
+    g << g.copy(g.arg(INTEGRATOR_X0), nx_, "xk") << "\n";
+    g << g.copy(g.arg(INTEGRATOR_P), np_, "pk") << "\n";
+    g << g.clear("qk", nq_) << "\n";
+    g << "tk = " << g.constant(t0_) << ";\n";
+    double h0 = step0_ > 0 ? step0_ : 1e-3 * (tout_.back() - t0_);
+    if (max_step_size_ > 0) h0 = std::min(h0, max_step_size_);
+    g << "hn = " << g.constant(h0) << ";\n";
+    g << "ns = 0;\n";
+
+    g << "for (k=0; k<" << nt() << "; ++k) {\n";
+    g << g.copy(grid_ptr(g.arg(INTEGRATOR_U), nu_), nu_, "uk") << "\n";
+    g << "while (tk < " << tout << "[k]) {\n";
+    g << "if (++ns > " << max_num_steps_ << ") return 1;\n";
+    g.comment("Do not step past the output time");
+    g << "hk = hn;\n";
+    g << "last = tk + hk >= " << tout << "[k];\n";
+    g << "if (last) hk = " << tout << "[k] - tk;\n";
+    g << "if (tk + hk <= tk) return 1;\n";
+
+    g.comment("Trial step");
+    g << g.arg(n_in_ + STEP_T) << " = &tk;\n";
+    g << g.arg(n_in_ + STEP_H) << " = &hk;\n";
+    g << g.arg(n_in_ + STEP_X0) << " = xk;\n";
+    g << g.arg(n_in_ + STEP_V0) << " = 0;\n";
+    g << g.arg(n_in_ + STEP_P) << " = pk;\n";
+    g << g.arg(n_in_ + STEP_U) << " = uk;\n";
+    g << g.res(n_out_ + STEP_XF) << " = xf;\n";
+    g << g.res(n_out_ + STEP_VF) << " = 0;\n";
+    g << g.res(n_out_ + STEP_QF) << " = qf;\n";
+    g << g.res(n_out_ + STEP_NUM_OUT) << " = ek;\n";
+    std::string flag = g(get_function("step_err"),
+      "arg+" + str(n_in_), "res+" + str(n_out_), "iw", w_call);
+    g << "if (" << flag << ") return 1;\n";
+
+    g.comment("Weighted RMS norm of the error estimate");
+    g << "en = 0;\n";
+    g << "for (i=0; i<" << nx1_ << "; ++i) {\n";
+    g << "fac = fabs(xk[i]) > fabs(xf[i]) ? fabs(xk[i]) : fabs(xf[i]);\n";
+    g << "fac = ek[i]/(" << g.constant(abstol_) << "+" << g.constant(reltol_) << "*fac);\n";
+    g << "en += fac*fac;\n";
+    g << "}\n";
+    g << "en = sqrt(en/" << nx1_ << ");\n";
+
+    g << "if (en <= 1) {\n";
+    if (nfwd_ > 0) {
+      g.comment("Propagate sensitivities before xk is overwritten");
+      g << g.arg(n_in_ + STEP_NUM_IN + STEP_XF) << " = xf;\n";
+      g << g.arg(n_in_ + STEP_NUM_IN + STEP_VF) << " = 0;\n";
+      g << g.arg(n_in_ + STEP_NUM_IN + STEP_QF) << " = qf;\n";
+      g << g.arg(n_in_ + STEP_NUM_IN + STEP_NUM_OUT + STEP_T) << " = 0;\n";
+      g << g.arg(n_in_ + STEP_NUM_IN + STEP_NUM_OUT + STEP_H) << " = 0;\n";
+      g << g.arg(n_in_ + STEP_NUM_IN + STEP_NUM_OUT + STEP_X0) << " = xk+" << nx1_ << ";\n";
+      g << g.arg(n_in_ + STEP_NUM_IN + STEP_NUM_OUT + STEP_V0) << " = 0;\n";
+      g << g.arg(n_in_ + STEP_NUM_IN + STEP_NUM_OUT + STEP_P) << " = pk+" << np1_ << ";\n";
+      g << g.arg(n_in_ + STEP_NUM_IN + STEP_NUM_OUT + STEP_U) << " = uk+" << nu1_ << ";\n";
+      g << g.res(n_out_ + STEP_XF) << " = xf+" << nx1_ << ";\n";
+      g << g.res(n_out_ + STEP_QF) << " = qf+" << nq1_ << ";\n";
+      flag = g(get_function(forward_name("step", nfwd_)),
+        "arg+" + str(n_in_), "res+" + str(n_out_), "iw", w_call);
+      g << "if (" << flag << ") return 1;\n";
+    }
+    g << g.copy("xf", nx_, "xk") << "\n";
+    if (nq_ > 0) g << g.axpy(nq_, "1.", "qf", "qk") << "\n";
+    g << "tk = last ? " << tout << "[k] : tk + hk;\n";
+    g << "}\n";
+
+    g.comment("Next step size, a last step that was cut short does not shrink it");
+    g << "if (en == 0) {\n";
+    g << "fac = " << fac_max << ";\n";
+    g << "} else {\n";
+    g << "fac = 0.9*pow(en, -0.2);\n";
+    g << "if (!(fac >= " << fac_min << ")) fac = " << fac_min << ";\n";
+    g << "if (fac > " << fac_max << ") fac = " << fac_max << ";\n";
+    g << "}\n";
+    g << "fac *= hk;\n";
+    g << "if (!(en <= 1 && last && hn > fac)) hn = fac;\n";
+    if (max_step_size_ > 0) {
+      g << "if (hn > " << g.constant(max_step_size_) << ") hn = "
+        << g.constant(max_step_size_) << ";\n";
+    }
+    g << "}\n";
+
+    g.comment("Outputs at the output time");
+    g << g.copy("xk", nx_, grid_ptr(g.res(INTEGRATOR_XF), nx_)) << "\n";
+    if (nq_ > 0) g << g.copy("qk", nq_, grid_ptr(g.res(INTEGRATOR_QF), nq_)) << "\n";
+    g << "}\n";
+  }
+
+  DormandPrince::DormandPrince(DeserializingStream& s) : Integrator(s) {
+    s.version("DormandPrince", 1);
+    s.unpack("DormandPrince::abstol", abstol_);
+    s.unpack("DormandPrince::reltol", reltol_);
+    s.unpack("DormandPrince::max_num_steps", max_num_steps_);
+    s.unpack("DormandPrince::step0", step0_);
+    s.unpack("DormandPrince::max_step_size", max_step_size_);
+  }
+
+  void DormandPrince::serialize_body(SerializingStream &s) const {
+    Integrator::serialize_body(s);
+    s.version("DormandPrince", 1);
+    s.pack("DormandPrince::abstol", abstol_);
+    s.pack("DormandPrince::reltol", reltol_);
+    s.pack("DormandPrince::max_num_steps", max_num_steps_);
+    s.pack("DormandPrince::step0", step0_);
+    s.pack("DormandPrince::max_step_size", max_step_size_);
+  }
+
+} // namespace casadi
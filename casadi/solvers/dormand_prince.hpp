@@ -0,0 +1,192 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_DORMAND_PRINCE_HPP
+#define CASADI_DORMAND_PRINCE_HPP
+
+#include "casadi/core/integrator_impl.hpp"
+#include <casadi/solvers/casadi_integrator_dopri_export.h>
+
+/** \defgroup plugin_Integrator_dopri Title
+    \par
+
+      Adaptive-step explicit Runge-Kutta integrator for ODEs, using the
+      embedded 5(4) tableau of Dormand and Prince.
+
+      The step size is controlled from the embedded error estimate of the
+      nondifferentiated states. Sensitivities are those of the discrete scheme,
+      with the accepted step sizes held fixed.
+*/
+/** \pluginsection{Integrator,dopri} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_INTEGRATOR_DOPRI_EXPORT DormandPrinceMemory : public IntegratorMemory {
+    // Work vectors, allocated in base class
+    double *x, *z, *x_prev, *rx, *rz, *rx_prev, *rq;
+
+    /// Work vectors, forward problem
+    double *p, *u, *q, *xf, *qf, *err;
+
+    /// Work vectors, backward problem
+    double *rp, *uq, *rq_prev, *uq_prev;
+
+    /// Step size to be attempted next
+    double h;
+
+    /// Accepted steps: start times, step sizes and states at the step boundaries
+    std::vector<double> t_tape, h_tape, x_tape;
+
+    /// Index of the first accepted step of each output interval
+    std::vector<casadi_int> k_tape;
+
+    /// Statistics
+    casadi_int nsteps, nrejected;
+  };
+
+  /** \brief \pluginbrief{Integrator,dopri}
+
+      @copydoc plugin_Integrator_dopri
+  */
+  class CASADI_INTEGRATOR_DOPRI_EXPORT DormandPrince : public Integrator {
+   public:
+
+    /// Constructor
+    DormandPrince(const std::string& name, const Function& dae, double t0,
+      const std::vector<double>& tout);
+
+    /** \brief  Create a new integrator */
+    static Integrator* creator(const std::string& name, const Function& dae,
+        double t0, const std::vector<double>& tout) {
+      return new DormandPrince(name, dae, t0, tout);
+    }
+
+    /// Destructor
+    ~DormandPrince() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "dopri";}
+
+    // Get name of the class
+    std::string class_name() const override { return "DormandPrince";}
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Initialize stage
+    void init(const Dict& opts) override;
+
+    /** \brief Set the (persistent) work vectors */
+    void set_work(void* mem, const double**& arg, double**& res,
+      casadi_int*& iw, double*& w) const override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new DormandPrinceMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<DormandPrinceMemory*>(mem);}
+
+    /// Reset the forward problem
+    void reset(IntegratorMemory* mem,
+      const double* x, const double* z, const double* p) const override;
+
+    /// Advance solution in time
+    void advance(IntegratorMemory* mem,
+      const double* u, double* x, double* z, double* q) const override;
+
+    /// Reset the backward problem
+    void resetB(IntegratorMemory* mem) const override;
+
+    /// Introduce an impulse into the backwards integration at the current time
+    void impulseB(IntegratorMemory* mem,
+      const double* rx, const double* rz, const double* rp) const override;
+
+    /// Retreat solution in time
+    void retreat(IntegratorMemory* mem, const double* u,
+      double* rx, double* rq, double* uq) const override;
+
+    /// Weighted RMS norm of the error estimate
+    double error_norm(const double* x0, const double* xf, const double* err) const;
+
+    /// Step size factor from the error norm
+    double step_factor(double err_norm) const;
+
+    /// Take a trial step, returns the weighted error norm
+    double trial_step(DormandPrinceMemory* m, double t, double h) const;
+
+    /// Propagate forward sensitivities through an accepted step
+    void stepF_fwd(DormandPrinceMemory* m, double t, double h) const;
+
+    /// Take an integrator step backward
+    void stepB(DormandPrinceMemory* m, double t, double h,
+      const double* x0, const double* xf, const double* rx0,
+      double* rxf, double* rqf, double* uqf) const;
+
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
+    /** \brief  Print solver statistics */
+    void print_stats(IntegratorMemory* mem) const override;
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return nrx_ == 0;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the function body */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize into MX */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new DormandPrince(s); }
+
+    // Options
+    double abstol_, reltol_, step0_, max_step_size_;
+    casadi_int max_num_steps_;
+
+   protected:
+
+    /** \brief Deserializing constructor */
+    explicit DormandPrince(DeserializingStream& s);
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_DORMAND_PRINCE_HPP
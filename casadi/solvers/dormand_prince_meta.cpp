@@ -0,0 +1,71 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+      #include "dormand_prince.hpp"
+      #include <string>
+
+      const std::string casadi::DormandPrince::meta_doc=
+      "\n"
+"Adaptive-step explicit Runge-Kutta integrator for ODEs, using the\n"
+"embedded 5(4) tableau of Dormand and Prince.\n"
+"\n"
+"The step size is controlled from the embedded error estimate of the\n"
+"nondifferentiated states. Sensitivities are those of the discrete\n"
+"scheme, with the accepted step sizes held fixed.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"|       Id        |      Type       |     Default     |   Description   |\n"
+"+=================+=================+=================+=================+\n"
+"| abstol          | OT_DOUBLE       | 1e-8            | Absolute        |\n"
+"|                 |                 |                 | tolerence for   |\n"
+"|                 |                 |                 | the IVP         |\n"
+"|                 |                 |                 | solution        |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| max_num_steps   | OT_INT          | 10000           | Maximum number  |\n"
+"|                 |                 |                 | of integrator   |\n"
+"|                 |                 |                 | steps,          |\n"
+"|                 |                 |                 | including       |\n"
+"|                 |                 |                 | rejected ones   |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| max_step_size   | OT_DOUBLE       | 0/inf           | Max step size   |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| reltol          | OT_DOUBLE       | 1e-6            | Relative        |\n"
+"|                 |                 |                 | tolerence for   |\n"
+"|                 |                 |                 | the IVP         |\n"
+"|                 |                 |                 | solution        |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| step0           | OT_DOUBLE       | 0/one           | Initial step    |\n"
+"|                 |                 | thousandth of   | size            |\n"
+"|                 |                 | the horizon     |                 |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
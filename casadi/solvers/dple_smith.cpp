@@ -0,0 +1,215 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "dple_smith.hpp"
+#include "casadi/core/casadi_misc.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_DPLE_SMITH_EXPORT
+  casadi_register_dple_smith(Dple::Plugin* plugin) {
+    plugin->creator = DpleSmith::creator;
+    plugin->name = "smith";
+    plugin->doc = DpleSmith::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &DpleSmith::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_DPLE_SMITH_EXPORT casadi_load_dple_smith() {
+    Dple::registerPlugin(casadi_register_dple_smith);
+  }
+
+  // Dense product z = x*y, or z = x*y' if trans_y
+  static void dple_mul(casadi_int n, const double* x, const double* y, double* z,
+      bool trans_y) {
+    casadi_int i, j, k;
+    double yk;
+    for (j=0; j<n; ++j) {
+      for (i=0; i<n; ++i) z[i+j*n] = 0;
+      for (k=0; k<n; ++k) {
+        yk = trans_y ? y[j+k*n] : y[k+j*n];
+        if (yk==0) continue;
+        for (i=0; i<n; ++i) z[i+j*n] += x[i+k*n]*yk;
+      }
+    }
+  }
+
+  // Propagate x <- a*x*a' + (v+v')/2, using the work vector t
+  static void dple_step(casadi_int n, const double* a, const double* v, double* x, double* t) {
+    casadi_int i, j;
+    dple_mul(n, a, x, t, false);
+    dple_mul(n, t, a, x, true);
+    if (v) {
+      for (j=0; j<n; ++j) {
+        for (i=0; i<n; ++i) x[i+j*n] += (v[i+j*n] + v[j+i*n])/2;
+      }
+    }
+  }
+
+  DpleSmith::DpleSmith(const std::string& name, const SpDict& st)
+    : Dple(name, st) {
+  }
+
+  DpleSmith::~DpleSmith() {
+    clear_mem();
+  }
+
+  const Options DpleSmith::options_
+  = {{&Dple::options_},
+     {{"tol",
+       {OT_DOUBLE,
+        "Stop doubling when the squared 1-norm of the next power of the monodromy matrix "
+        "drops below this value. Default: 1e-16."}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of doublings, i.e. at most 2^max_iter terms of the series. "
+        "Default: 60."}}
+     }
+  };
+
+  void DpleSmith::init(const Dict& opts) {
+    // Call the init method of the base class
+    Dple::init(opts);
+
+    // Default options
+    tol_ = 1e-16;
+    max_iter_ = 60;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      }
+    }
+
+    n_ = A_.size1()/K_;
+
+    // Allocate work vectors
+    alloc_w(3*n_*n_, true);
+  }
+
+  bool DpleSmith::factorize(DpleSmithMemory* m, const double* a, double* w) const {
+    casadi_int i, j, k, nn = n_*n_;
+    double *phi = w, *t = w + nn, nrm, c;
+    m->n_fact++;
+    m->npw = -1;
+    m->pw.clear();
+    // Monodromy matrix Phi = A_(K-1)*...*A_0
+    casadi_clear(phi, nn);
+    for (i=0; i<n_; ++i) phi[i+i*n_] = 1;
+    for (k=0; k<K_; ++k) {
+      if (a) {
+        dple_mul(n_, a + k*nn, phi, t, false);
+      } else {
+        casadi_clear(t, nn);
+      }
+      casadi_copy(t, nn, phi);
+    }
+    // Repeated squares, until the remaining terms of the series are negligible
+    for (k=0; k<=max_iter_; ++k) {
+      nrm = 0;
+      for (j=0; j<n_; ++j) {
+        c = 0;
+        for (i=0; i<n_; ++i) c += fabs(phi[i+j*n_]);
+        nrm = fmax(nrm, c);
+      }
+      if (nrm*nrm <= tol_) {
+        m->npw = k;
+        return true;
+      }
+      if (k==max_iter_ || !std::isfinite(nrm)) break;
+      m->pw.insert(m->pw.end(), phi, phi + nn);
+      dple_mul(n_, phi, phi, t, false);
+      casadi_copy(t, nn, phi);
+    }
+    return false;
+  }
+
+  int DpleSmith::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+    auto m = static_cast<DpleSmithMemory*>(mem);
+    casadi_int i, j, k, r, nn = n_*n_;
+    const double *a = arg[DPLE_A], *v;
+    double *x = w, *t = w + nn, *t2 = w + 2*nn, *p;
+
+    // Reuse the repeated squares of Phi if A has not changed
+    casadi_int nnz_a = A_.nnz();
+    bool reuse = m->npw>=0 && a && m->a.size()==nnz_a
+      && std::equal(a, a + nnz_a, m->a.begin());
+    if (!reuse) {
+      if (a) {
+        m->a.assign(a, a + nnz_a);
+      } else {
+        m->a.clear();
+      }
+      if (!factorize(m, a, w)) {
+        if (error_unstable_) {
+          casadi_error("DpleSmith: the product of the A_i is not stable.");
+        }
+        return 1;
+      }
+    }
+
+    for (r=0; r<nrhs_; ++r) {
+      v = arg[DPLE_V] ? arg[DPLE_V] + r*K_*nn : nullptr;
+      p = res[DPLE_P] ? res[DPLE_P] + r*K_*nn : nullptr;
+      if (!p) continue;
+      // W, the solution at the end of the period when starting from zero
+      casadi_clear(x, nn);
+      for (k=0; k<K_; ++k) {
+        dple_step(n_, a ? a + k*nn : nullptr, v ? v + k*nn : nullptr, x, t);
+      }
+      // P_0 = sum_i Phi^i*W*Phi^i' by doubling
+      for (k=0; k<m->npw; ++k) {
+        const double* pw = get_ptr(m->pw) + k*nn;
+        dple_mul(n_, pw, x, t, false);
+        dple_mul(n_, t, pw, t2, true);
+        casadi_axpy(nn, 1., t2, x);
+      }
+      // P_(k+1) = A_k*P_k*A_k' + V_k
+      for (k=0; k<K_; ++k) {
+        if (k>0) dple_step(n_, a ? a + (k-1)*nn : nullptr, v ? v + (k-1)*nn : nullptr, x, t);
+        for (j=0; j<n_; ++j) {
+          for (i=0; i<n_; ++i) p[k*nn+i+j*n_] = (x[i+j*n_] + x[j+i*n_])/2;
+        }
+      }
+    }
+    return 0;
+  }
+
+  Dict DpleSmith::get_stats(void* mem) const {
+    Dict stats = Dple::get_stats(mem);
+    auto m = static_cast<DpleSmithMemory*>(mem);
+    stats["n_fact"] = m->n_fact;
+    return stats;
+  }
+
+} // namespace casadi
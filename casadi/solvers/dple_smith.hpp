@@ -0,0 +1,131 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_DPLE_SMITH_HPP
+#define CASADI_DPLE_SMITH_HPP
+
+#include "casadi/core/dple_impl.hpp"
+#include <casadi/solvers/casadi_dple_smith_export.h>
+
+/** \defgroup plugin_Dple_smith Title
+    \par
+
+  * Builtin solver for Discrete Periodic Lyapunov Equations.
+  *
+  * The periodic equation is lifted to the discrete Lyapunov equation
+  * P_0 = Phi*P_0*Phi' + W of the monodromy matrix Phi = A_(K-1)*...*A_0,
+  * which is solved with Smith's doubling iteration. The repeated squares of Phi
+  * only depend on A and are kept across calls as long as A does not change,
+  * and are shared by all right-hand sides.
+  */
+
+/** \pluginsection{Dple,smith} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_DPLE_SMITH_EXPORT DpleSmithMemory : public ProtoFunctionMemory {
+    /// Value of A for which the cached squares are valid
+    std::vector<double> a;
+
+    /// Phi^(2^j), j = 0, 1, ...
+    std::vector<double> pw;
+
+    /// Number of cached squares, -1 if not valid
+    casadi_int npw;
+
+    /// Number of times the squares were (re)computed
+    casadi_int n_fact;
+
+    /// Constructor
+    DpleSmithMemory() : npw(-1), n_fact(0) {}
+  };
+
+  /** \brief \pluginbrief{Dple,smith}
+
+     @copydoc Dple_doc
+     @copydoc plugin_Dple_smith
+  */
+  class CASADI_DPLE_SMITH_EXPORT DpleSmith : public Dple {
+  public:
+    /** \brief  Constructor */
+    DpleSmith(const std::string& name, const SpDict& st);
+
+    /** \brief  Create a new solver */
+    static Dple* creator(const std::string& name, const SpDict& st) {
+      return new DpleSmith(name, st);
+    }
+
+    /** \brief  Destructor */
+    ~DpleSmith() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "smith";}
+
+    // Get name of the class
+    std::string class_name() const override { return "DpleSmith";}
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new DpleSmithMemory();}
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<DpleSmithMemory*>(mem);}
+
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  protected:
+    /// Dimension of the state space
+    casadi_int n_;
+
+    /// Tolerance on the norm of the neglected powers of Phi
+    double tol_;
+
+    /// Maximum number of doublings
+    casadi_int max_iter_;
+
+    /// Compute the repeated squares of Phi, returns false if they do not converge
+    bool factorize(DpleSmithMemory* m, const double* a, double* w) const;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_DPLE_SMITH_HPP
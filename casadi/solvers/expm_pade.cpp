@@ -0,0 +1,251 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "expm_pade.hpp"
+#include "casadi/core/casadi_misc.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_EXPM_PADE_EXPORT
+  casadi_register_expm_pade(Expm::Plugin* plugin) {
+    plugin->creator = ExpmPade::creator;
+    plugin->name = "pade";
+    plugin->doc = ExpmPade::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &ExpmPade::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_EXPM_PADE_EXPORT casadi_load_expm_pade() {
+    Expm::registerPlugin(casadi_register_expm_pade);
+  }
+
+  ExpmPade::ExpmPade(const std::string& name, const Sparsity& A)
+    : Expm(name, A), sp_(A) {
+  }
+
+  ExpmPade::~ExpmPade() {
+    clear_mem();
+  }
+
+  const Options ExpmPade::options_
+  = {{&Expm::options_},
+     {{"frechet",
+       {OT_BOOL,
+        "Also calculate the Frechet derivative L(t*A, t*E) of the matrix exponential "
+        "in the direction of an additional input E. Default: false."}}
+     }
+  };
+
+  Sparsity ExpmPade::get_sparsity_in(casadi_int i) {
+    if (i==2) return A_;
+    return Expm::get_sparsity_in(i);
+  }
+
+  Sparsity ExpmPade::get_sparsity_out(casadi_int i) {
+    if (i==1) return A_;
+    return Expm::get_sparsity_out(i);
+  }
+
+  void ExpmPade::init(const Dict& opts) {
+    // Default options
+    frechet_ = false;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="frechet") {
+        frechet_ = op.second;
+      }
+    }
+
+    // Call the init method of the base class
+    Expm::init(opts);
+
+    n_ = A_.size1();
+
+    // Order the rows without structural nonzeros last, keeping the result block triangular
+    p_ = n_;
+    perm_.clear();
+    if (!frechet_) {
+      std::vector<bool> nz_row(n_, false);
+      for (casadi_int r : sp_.get_row()) nz_row[r] = true;
+      std::vector<casadi_int> perm;
+      for (casadi_int i=0; i<n_; ++i) if (nz_row[i]) perm.push_back(i);
+      p_ = perm.size();
+      for (casadi_int i=0; i<n_; ++i) if (!nz_row[i]) perm.push_back(i);
+      if (!is_range(perm, 0, n_)) perm_ = perm;
+    }
+
+    // Allocate work vectors
+    casadi_int nn = n_*n_;
+    alloc_w((frechet_ ? 4 : 2)*nn + casadi_expm_sz_w(n_, frechet_), true);
+    alloc_iw(n_, true);
+  }
+
+  int ExpmPade::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+    casadi_int i, j, nn = n_*n_;
+    double *a, *r, *e = nullptr, *l = nullptr;
+    a = w; w += nn;
+    r = w; w += nn;
+    if (frechet_) {
+      e = w; w += nn;
+      l = w; w += nn;
+    }
+    // Symmetrically permuted input
+    if (perm_.empty()) {
+      casadi_copy(arg[0], nn, a);
+    } else {
+      for (j=0; j<n_; ++j) {
+        for (i=0; i<n_; ++i) a[i+j*n_] = arg[0] ? arg[0][perm_[i]+perm_[j]*n_] : 0;
+      }
+    }
+    if (frechet_) casadi_copy(arg[2], nn, e);
+    // Calculate the matrix exponential
+    casadi_expm(n_, p_, a, arg[1] ? *arg[1] : 0., e, r, l, w, iw);
+    // Undo the permutation
+    if (perm_.empty()) {
+      casadi_copy(r, nn, res[0]);
+    } else if (res[0]) {
+      for (j=0; j<n_; ++j) {
+        for (i=0; i<n_; ++i) res[0][perm_[i]+perm_[j]*n_] = r[i+j*n_];
+      }
+    }
+    if (frechet_) casadi_copy(l, nn, res[1]);
+    return 0;
+  }
+
+  void ExpmPade::codegen_body(CodeGenerator& g) const {
+    casadi_int nn = n_*n_;
+    g.local("a", "casadi_real", "*");
+    g.local("r", "casadi_real", "*");
+    g << "a = w; w += " << nn << ";\n";
+    g << "r = w; w += " << nn << ";\n";
+    if (frechet_) {
+      g.local("e", "casadi_real", "*");
+      g.local("l", "casadi_real", "*");
+      g << "e = w; w += " << nn << ";\n";
+      g << "l = w; w += " << nn << ";\n";
+    }
+    // Symmetrically permuted input
+    std::string perm;
+    if (perm_.empty()) {
+      g << g.copy(g.arg(0), nn, "a") << "\n";
+    } else {
+      g.local("i", "casadi_int");
+      g.local("j", "casadi_int");
+      perm = g.constant(perm_);
+      g << "for (j=0; j<" << n_ << "; ++j) {\n"
+        << "for (i=0; i<" << n_ << "; ++i) a[i+j*" << n_ << "] = "
+        << g.arg(0) << " ? " << g.arg(0) << "[" << perm << "[i]+" << perm << "[j]*" << n_
+        << "] : 0;\n"
+        << "}\n";
+    }
+    if (frechet_) g << g.copy(g.arg(2), nn, "e") << "\n";
+    // Calculate the matrix exponential
+    g << g.expm(n_, p_, "a", g.arg(1) + " ? *" + g.arg(1) + " : 0.",
+                frechet_ ? "e" : "0", "r", frechet_ ? "l" : "0", "w", "iw") << "\n";
+    // Undo the permutation
+    if (perm_.empty()) {
+      g << g.copy("r", nn, g.res(0)) << "\n";
+    } else {
+      g << "if (" << g.res(0) << ") {\n"
+        << "for (j=0; j<" << n_ << "; ++j) {\n"
+        << "for (i=0; i<" << n_ << "; ++i) " << g.res(0) << "[" << perm << "[i]+" << perm
+        << "[j]*" << n_ << "] = r[i+j*" << n_ << "];\n"
+        << "}\n"
+        << "}\n";
+    }
+    if (frechet_) g << g.copy("l", nn, g.res(1)) << "\n";
+  }
+
+  Function ExpmPade::frechet() const {
+    return expmsol(name_ + "_frechet", "pade", A_, {{"frechet", true}});
+  }
+
+  Function ExpmPade::get_forward(casadi_int nfwd, const std::string& name,
+                               const std::vector<std::string>& inames,
+                               const std::vector<std::string>& onames,
+                               const Dict& opts) const {
+    MX A = MX::sym("A", A_);
+    MX t = MX::sym("t");
+    if (frechet_) {
+      // Exponential of the block triangular matrix [A E; 0 A]
+      MX E = MX::sym("E", A_);
+      MX R = expm(MX::blockcat({{A, E}, {MX(n_, n_), A}})*t);
+      Function f(name_ + "_extended", {A, t, E},
+        {R(Slice(0, n_), Slice(0, n_)), R(Slice(0, n_), Slice(n_, 2*n_))});
+      return f.forward(nfwd);
+    }
+    MX Y = MX::sym("Y", A_);
+    MX Adot = MX::sym("Adot", A_);
+    MX tdot = MX::sym("tdot");
+
+    MX Ydot = mtimes(A, Y)*tdot;
+    if (!const_A_) {
+      Ydot += frechet()(std::vector<MX>{A, t, Adot}).at(1);
+    }
+
+    Function ret = Function(name, {A, t, Y, Adot, tdot}, {Ydot});
+
+    return ret.map(name, "serial", nfwd,
+      std::vector<casadi_int>{0, 1, 2}, std::vector<casadi_int>{});
+  }
+
+  Function ExpmPade::get_reverse(casadi_int nadj, const std::string& name,
+                               const std::vector<std::string>& inames,
+                               const std::vector<std::string>& onames,
+                               const Dict& opts) const {
+    MX A = MX::sym("A", A_);
+    MX t = MX::sym("t");
+    if (frechet_) {
+      // Exponential of the block triangular matrix [A E; 0 A]
+      MX E = MX::sym("E", A_);
+      MX R = expm(MX::blockcat({{A, E}, {MX(n_, n_), A}})*t);
+      Function f(name_ + "_extended", {A, t, E},
+        {R(Slice(0, n_), Slice(0, n_)), R(Slice(0, n_), Slice(n_, 2*n_))});
+      return f.reverse(nadj);
+    }
+    MX Y = MX::sym("Y", A_);
+    MX Ybar = MX::sym("Ybar", A_);
+
+    MX tbar = sum2(sum1(Ybar*mtimes(A, Y)));
+    MX Abar;
+    if (const_A_) {
+      Abar = MX(Sparsity(A_.size()));
+    } else {
+      // The adjoint of the Frechet derivative is the Frechet derivative at A^T
+      Abar = frechet()(std::vector<MX>{A.T(), t, Ybar}).at(1);
+    }
+    Function ret = Function(name, {A, t, Y, Ybar}, {Abar, tbar});
+
+    return ret.map(name, "serial", nadj,
+      std::vector<casadi_int>{0, 1, 2}, std::vector<casadi_int>{});
+  }
+
+} // namespace casadi
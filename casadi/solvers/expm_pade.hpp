@@ -0,0 +1,143 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_EXPM_PADE_HPP
+#define CASADI_EXPM_PADE_HPP
+
+#include "casadi/core/expm_impl.hpp"
+#include <casadi/solvers/casadi_expm_pade_export.h>
+
+/** \defgroup plugin_Expm_pade Title
+    \par
+
+  * Matrix exponential with Pade approximants and scaling and squaring (Higham 2005),
+  * implemented in CasADi's C runtime and thus supporting code generation.
+  *
+  * Rows without structural nonzeros in the sparsity pattern of A are exploited,
+  * e.g. for the discretization expm([A B; 0 0]*t) of a linear system.
+  * Derivatives use the Frechet derivative of the Pade approximant (Al-Mohy and Higham 2009)
+  * instead of the exponential of a matrix of twice the size.
+  */
+
+/** \pluginsection{Expm,pade} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief \pluginbrief{Expm,pade}
+
+     @copydoc Expm_doc
+     @copydoc plugin_Expm_pade
+  */
+  class CASADI_EXPM_PADE_EXPORT ExpmPade : public Expm {
+  public:
+    /** \brief  Constructor */
+    ExpmPade(const std::string& name, const Sparsity& A);
+
+    /** \brief  Create a new solver */
+    static Expm* creator(const std::string& name, const Sparsity& A) {
+      return new ExpmPade(name, A);
+    }
+
+    /** \brief  Destructor */
+    ~ExpmPade() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "pade";}
+
+    // Get name of the class
+    std::string class_name() const override { return "ExpmPade";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return frechet_ ? 3 : 2;}
+    size_t get_n_out() override { return frechet_ ? 2 : 1;}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override;
+    /// @}
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    ///@{
+    /** \brief Derivatives, using the Frechet derivative */
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    /** \brief Which inputs are differentiable */
+    bool get_diff_in(casadi_int i) override { return i != 0 || !const_A_;}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  protected:
+    /// Sparsity pattern of A, as passed to the constructor
+    Sparsity sp_;
+
+    /// Also calculate the Frechet derivative L(t*A, t*E)
+    bool frechet_;
+
+    /// Dimension
+    casadi_int n_;
+
+    /// Number of structurally nonzero rows, which are ordered first by perm_
+    casadi_int p_;
+
+    /// Symmetric permutation moving the zero rows last, empty if not needed
+    std::vector<casadi_int> perm_;
+
+    /// Frechet derivative, for derivative calculations
+    Function frechet() const;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_EXPM_PADE_HPP
@@ -64,7 +64,15 @@ namespace casadi {
         "Stopping criterion tolerance on step size"}},
       {"max_iter",
        {OT_INT,
-        "Maximum number of Newton iterations to perform before returning."}}
+        "Maximum number of Newton iterations to perform before returning."}},
+      {"reuse_jacobian",
+       {OT_BOOL,
+        "Simplified Newton: reuse the factorized Jacobian across iterations of a call "
+        "(default: false)"}},
+      {"reuse_rate",
+       {OT_DOUBLE,
+        "Refactorize the Jacobian when a reused Jacobian decreases max(|F|) by less "
+        "than this factor (default: 0.5)"}}
      }
   };
 
@@ -77,6 +85,8 @@ namespace casadi {
     max_iter_ = 1000;
     abstol_ = 1e-12;
     abstolStep_ = 1e-12;
+    reuse_jacobian_ = false;
+    reuse_rate_ = 0.5;
 
     // Read options
     for (auto&& op : opts) {
@@ -86,6 +96,10 @@ namespace casadi {
         abstol_ = op.second;
       } else if (op.first=="abstolStep") {
         abstolStep_ = op.second;
+      } else if (op.first=="reuse_jacobian") {
+        reuse_jacobian_ = op.second;
+      } else if (op.first=="reuse_rate") {
+        reuse_rate_ = op.second;
       }
     }
 
@@ -145,18 +159,35 @@ namespace casadi {
     // Get the initial guess
     casadi_copy(m->iarg[iin_], n_, M->x);
 
+    // Evaluate and factorize the Jacobian in the current iteration?
+    bool fresh = true;
+    double g_prev = 0;
+    m->n_fact = 0;
     for (m->iter=0; m->iter<max_iter_; ++m->iter) {
-       /* (re)calculate f and J */
-       // Use x to evaluate J
        for (casadi_int i=0;i<n_in_;++i) m->arg[i] = m->iarg[i];
        m->arg[iin_] = M->x;
-       for (casadi_int i=0;i<n_out_;++i) m->res[i+1] = m->ires[i];
-       m->res[0] = M->jac_g_x;
-       m->res[1+iout_] = M->g;
-       jac_f_z_(m->arg, m->res, m->iw, m->w);
-
-       m->return_status = casadi_newton(M);
+       if (!fresh) {
+         // Use x to evaluate f only
+         for (casadi_int i=0;i<n_out_;++i) m->res[i] = m->ires[i];
+         m->res[iout_] = M->g;
+         oracle_(m->arg, m->res, m->iw, m->w);
+         // Refactorize if the reused Jacobian converges too slowly
+         if (casadi_norm_inf(n_, M->g) > reuse_rate_ * g_prev) fresh = true;
+       }
+       if (fresh) {
+         /* (re)calculate f and J */
+         // Use x to evaluate J
+         for (casadi_int i=0;i<n_out_;++i) m->res[i+1] = m->ires[i];
+         m->res[0] = M->jac_g_x;
+         m->res[1+iout_] = M->g;
+         jac_f_z_(m->arg, m->res, m->iw, m->w);
+       }
+       g_prev = casadi_norm_inf(n_, M->g);
+
+       m->return_status = fresh ? casadi_newton(M) : casadi_newton_reuse(M);
+       if (fresh && m->return_status!=1) m->n_fact++;
        if (m->return_status) break;
+       fresh = !reuse_jacobian_;
     }
     // Get the solution
     casadi_copy(M->x, n_, m->ires[iout_]);
@@ -196,21 +227,49 @@ namespace casadi {
     g << g.copy(g.arg(iin_), n_, "m.x") << "\n";
 
     g.local("iter", "casadi_int");
+    if (reuse_jacobian_) {
+      g.local("fresh", "casadi_int");
+      g.local("g_prev", "casadi_real");
+      g << "fresh = 1;\n";
+      g << "g_prev = 0;\n";
+    }
     g << "for (iter=0; iter<" + str(max_iter_) + "; ++iter) {\n";
 
-    g.comment("(re)calculate f and J");
-    // Use x to evaluate J
     for (casadi_int i=0;i<n_in_;++i) {
       g << g.arg(i+n_in_) << " = " << (i==iin_? "m.x" : g.arg(i)) << ";\n";
     }
+    std::string flag;
+    if (reuse_jacobian_) {
+      g << "if (!fresh) {\n";
+      g.comment("Use x to evaluate f only");
+      for (casadi_int i=0;i<n_out_;++i) {
+        g << g.res(i+n_out_) + " = " << (i==iout_? "m.g" : g.res(i)) << ";\n";
+      }
+      flag = g(oracle_, "arg+" + str(n_in_), "res+" + str(n_out_), "iw",
+        "w+" + str(w_offset));
+      g << "if (" << flag << ") return 1;\n";
+      g.comment("Refactorize if the reused Jacobian converges too slowly");
+      g << "if (" << g.norm_inf(n_, "m.g") << ">" << reuse_rate_ << "*g_prev) fresh = 1;\n";
+      g << "}\n";
+      g << "if (fresh) {\n";
+    }
+    g.comment("(re)calculate f and J");
+    // Use x to evaluate J
     g << g.res(n_out_) + " = m.jac_g_x;\n";
     for (casadi_int i=0;i<n_out_;++i) {
       g << g.res(i+n_out_+1) + " = " << (i==iout_? "m.g" : g.res(i)) << ";\n";
     }
-    std::string flag = g(get_function("jac_f_z"),
+    flag = g(get_function("jac_f_z"),
       "arg+" + str(n_in_), "res+" + str(n_out_), "iw", "w+" + str(w_offset));
     g << "if (" << flag << ") return 1;\n";
-    g << "if (casadi_newton(&m)) break;\n";
+    if (reuse_jacobian_) {
+      g << "}\n";
+      g << "g_prev = " << g.norm_inf(n_, "m.g") << ";\n";
+      g << "if (fresh ? casadi_newton(&m) : casadi_newton_reuse(&m)) break;\n";
+      g << "fresh = 0;\n";
+    } else {
+      g << "if (casadi_newton(&m)) break;\n";
+    }
     g << "}\n";
 
     // Get the solution
@@ -220,6 +279,7 @@ namespace casadi {
 
   void FastNewton::codegen_declarations(CodeGenerator& g) const {
     g.add_dependency(get_function("jac_f_z"));
+    if (reuse_jacobian_) g.add_dependency(oracle_);
   }
 
   int FastNewton::init_mem(void* mem) const {
@@ -227,6 +287,7 @@ namespace casadi {
     auto m = static_cast<FastNewtonMemory*>(mem);
     m->return_status = 0;
     m->iter = 0;
+    m->n_fact = 0;
     return 0;
   }
 
@@ -248,15 +309,23 @@ namespace casadi {
     auto m = static_cast<FastNewtonMemory*>(mem);
     stats["return_status"] = return_code(m->return_status);
     stats["iter_count"] = m->iter;
+    stats["n_fact"] = m->n_fact;
     return stats;
   }
 
 
   FastNewton::FastNewton(DeserializingStream& s) : Rootfinder(s) {
-    s.version("Newton", 1);
+    int version = s.version("Newton", 1, 2);
     s.unpack("Newton::max_iter", max_iter_);
     s.unpack("Newton::abstol", abstol_);
     s.unpack("Newton::abstolStep", abstolStep_);
+    if (version >= 2) {
+      s.unpack("Newton::reuse_jacobian", reuse_jacobian_);
+      s.unpack("Newton::reuse_rate", reuse_rate_);
+    } else {
+      reuse_jacobian_ = false;
+      reuse_rate_ = 0.5;
+    }
     s.unpack("Newton::jac_f_z", jac_f_z_);
     s.unpack("Newton::sp_v", sp_v_);
     s.unpack("Newton::sp_r", sp_r_);
@@ -266,10 +335,12 @@ namespace casadi {
 
   void FastNewton::serialize_body(SerializingStream &s) const {
     Rootfinder::serialize_body(s);
-    s.version("Newton", 1);
+    s.version("Newton", 2);
     s.pack("Newton::max_iter", max_iter_);
     s.pack("Newton::abstol", abstol_);
     s.pack("Newton::abstolStep", abstolStep_);
+    s.pack("Newton::reuse_jacobian", reuse_jacobian_);
+    s.pack("Newton::reuse_rate", reuse_rate_);
     s.pack("Newton::jac_f_z", jac_f_z_);
     s.pack("Newton::sp_v", sp_v_);
     s.pack("Newton::sp_r", sp_r_);
@@ -48,6 +48,8 @@ namespace casadi {
     int return_status;
     // Number of iterations
     casadi_int iter;
+    // Number of Jacobian factorizations
+    casadi_int n_fact;
 
     casadi_newton_mem<double> M;
   };
@@ -135,6 +137,12 @@ namespace casadi {
     /// Absolute tolerance that should be met on step
     double abstolStep_;
 
+    /// Reuse the factorized Jacobian across iterations
+    bool reuse_jacobian_;
+
+    /// Required decrease of the residual with a reused Jacobian
+    double reuse_rate_;
+
     /// Reference to jacobian function
     Function jac_f_z_;
 
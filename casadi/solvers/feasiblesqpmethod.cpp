@@ -76,7 +76,8 @@ namespace casadi {
         "The QP solver to be used by the SQP method [qpoases]"}},
       {"qpsol_options",
        {OT_DICT,
-        "Options to be passed to the QP solver"}},
+        "Options to be passed to the QP solver. For qrqp, 'max_updates' defaults to 20 "
+        "so that the KKT factorization is kept between QPs with the same H and A"}},
       {"hessian_approximation",
        {OT_STRING,
         "limited-memory|exact"}},
@@ -124,7 +125,7 @@ namespace casadi {
         "Function for calculating the Hessian of the Lagrangian (autogenerated by default)"}},
       {"convexify_strategy",
        {OT_STRING,
-        "NONE|regularize|eigen-reflect|eigen-clip. "
+        "NONE|regularize|eigen-reflect|eigen-clip|inertia. "
         "Strategy to convexify the Lagrange Hessian before passing it to the solver."}},
       {"convexify_margin",
        {OT_DOUBLE,
@@ -405,6 +406,10 @@ namespace casadi {
     }
 
     casadi_assert(!qpsol_plugin.empty(), "'qpsol' option has not been set");
+    // The feasibility QPs share H and A, let qrqp keep its KKT factorization between them
+    if (qpsol_plugin=="qrqp" && qpsol_options.find("max_updates")==qpsol_options.end()) {
+      qpsol_options["max_updates"] = 20;
+    }
     // qpsol_options["dump_in"] = true;
     // qpsol_options["dump_out"] = true;
     // qpsol_options["dump"] = true;
@@ -490,6 +495,18 @@ namespace casadi {
     m->iter_count = -1;
   }
 
+  void* Feasiblesqpmethod::alloc_mem() const {
+    FeasiblesqpmethodMemory* m = new FeasiblesqpmethodMemory();
+    m->qpsol_mem = qpsol_.checkout();
+    return m;
+  }
+
+  void Feasiblesqpmethod::free_mem(void *mem) const {
+    auto m = static_cast<FeasiblesqpmethodMemory*>(mem);
+    qpsol_.release(m->qpsol_mem);
+    delete m;
+  }
+
   int Feasiblesqpmethod::init_mem(void* mem) const {
     if (Nlpsol::init_mem(mem)) return 1;
     auto m = static_cast<FeasiblesqpmethodMemory*>(mem);
@@ -1070,16 +1087,16 @@ int Feasiblesqpmethod::solve(void* mem) const {
             m->res[0] = d->Bk;
             if (calc_function(m, "nlp_hess_l")) return 1;
             if (convexify_) {
-              ScopedTiming tic(m->fstats.at("convexify"));
+              ScopedTiming tic(m->fstats.at("convexify"), record_time_);
               if (convexify_eval(&convexify_data_.config, d->Bk, d->Bk, m->iw, m->w)) return 1;
             }
           } else if (m->iter_count==0) {
-            ScopedTiming tic(m->fstats.at("BFGS"));
+            ScopedTiming tic(m->fstats.at("BFGS"), record_time_);
             // Initialize BFGS
             casadi_fill(d->Bk, Hsp_.nnz(), 1.);
             casadi_bfgs_reset(Hsp_, d->Bk);
           } else {
-            ScopedTiming tic(m->fstats.at("BFGS"));
+            ScopedTiming tic(m->fstats.at("BFGS"), record_time_);
             // Update BFGS
             if (m->iter_count % lbfgs_memory_ == 0) casadi_bfgs_reset(Hsp_, d->Bk);
             // Update the Hessian approximation
@@ -1135,16 +1152,16 @@ int Feasiblesqpmethod::solve(void* mem) const {
             m->res[0] = d->Bk;
             if (calc_function(m, "nlp_hess_l")) return 1;
             if (convexify_) {
-              ScopedTiming tic(m->fstats.at("convexify"));
+              ScopedTiming tic(m->fstats.at("convexify"), record_time_);
               if (convexify_eval(&convexify_data_.config, d->Bk, d->Bk, m->iw, m->w)) return 1;
             }
           } else if (m->iter_count==0) {
-            ScopedTiming tic(m->fstats.at("BFGS"));
+            ScopedTiming tic(m->fstats.at("BFGS"), record_time_);
             // Initialize BFGS
             casadi_fill(d->Bk, Hsp_.nnz(), 1.);
             casadi_bfgs_reset(Hsp_, d->Bk);
           } else {
-            ScopedTiming tic(m->fstats.at("BFGS"));
+            ScopedTiming tic(m->fstats.at("BFGS"), record_time_);
             // Update BFGS
             if (m->iter_count % lbfgs_memory_ == 0) casadi_bfgs_reset(Hsp_, d->Bk);
             // Update the Hessian approximation
@@ -1348,7 +1365,7 @@ int Feasiblesqpmethod::solve(void* mem) const {
   int Feasiblesqpmethod::solve_LP(FeasiblesqpmethodMemory* m, const double* g,
                            const double* lbdz, const double* ubdz, const double* A,
                            double* x_opt, double* dlam, int mode) const {
-    ScopedTiming tic(m->fstats.at("QP"));
+    ScopedTiming tic(m->fstats.at("QP"), record_time_);
     // Inputs
     std::fill_n(m->arg, qpsol_.n_in(), nullptr);
     // double lol;
@@ -1374,7 +1391,7 @@ int Feasiblesqpmethod::solve(void* mem) const {
 
 
     // Solve the QP
-    qpsol_(m->arg, m->res, m->iw, m->w, 0);
+    qpsol_(m->arg, m->res, m->iw, m->w, m->qpsol_mem);
 
     if (verbose_) print("QP solved\n");
     return 0;
@@ -1383,7 +1400,7 @@ int Feasiblesqpmethod::solve(void* mem) const {
   int Feasiblesqpmethod::solve_QP(FeasiblesqpmethodMemory* m, const double* H, const double* g,
                            const double* lbdz, const double* ubdz, const double* A,
                            double* x_opt, double* dlam, int mode) const {
-    ScopedTiming tic(m->fstats.at("QP"));
+    ScopedTiming tic(m->fstats.at("QP"), record_time_);
     // Inputs
     std::fill_n(m->arg, qpsol_.n_in(), nullptr);
     m->arg[CONIC_H] = H;
@@ -1408,7 +1425,7 @@ int Feasiblesqpmethod::solve(void* mem) const {
 
 
     // Solve the QP
-    qpsol_(m->arg, m->res, m->iw, m->w, 0);
+    qpsol_(m->arg, m->res, m->iw, m->w, m->qpsol_mem);
 
     if (verbose_) print("QP solved\n");
     return 0;
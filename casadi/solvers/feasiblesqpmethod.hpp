@@ -56,6 +56,9 @@ namespace casadi {
 
     /// Iteration count
     int iter_count;
+
+    /// Memory of the QP solver, kept between QPs and calls
+    casadi_int qpsol_mem;
   };
 
   /** \brief  \pluginbrief{Nlpsol,feasiblesqpmethod}
@@ -91,13 +94,13 @@ namespace casadi {
     void init(const Dict& opts) override;
 
     /** \brief Create memory block */
-    void* alloc_mem() const override { return new FeasiblesqpmethodMemory();}
+    void* alloc_mem() const override;
 
     /** \brief Initalize memory block */
     int init_mem(void* mem) const override;
 
     /** \brief Free memory block */
-    void free_mem(void *mem) const override { delete static_cast<FeasiblesqpmethodMemory*>(mem);}
+    void free_mem(void *mem) const override;
 
     /** \brief Set the (persistent) work vectors */
     void set_work(void* mem, const double**& arg, double**& res,
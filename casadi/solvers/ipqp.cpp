@@ -87,7 +87,19 @@ namespace casadi {
         "Options to be passed to the linear solver"}},
       {"min_lam",
        {OT_DOUBLE,
-        "Smallest multiplier treated as inactive for the initial active set [0]."}}
+        "Smallest multiplier treated as inactive for the initial active set [0]."}},
+      {"iterative_kkt",
+       {OT_BOOL,
+        "Solve the KKT systems with GMRES, preconditioned with the factorization "
+        "of an earlier KKT matrix. The preconditioner is only refactorized when "
+        "GMRES fails to converge [false]."}},
+      {"kkt_tol",
+       {OT_DOUBLE,
+        "Relative residual tolerance for the iterative KKT solves. Early iterations "
+        "use the looser tolerance min(0.1, mu) [1e-10]."}},
+      {"kkt_max_iter",
+       {OT_INT,
+        "Maximum number of GMRES iterations per KKT solve before refactorizing [20]."}}
      }
   };
 
@@ -103,6 +115,9 @@ namespace casadi {
     print_header_ = true;
     print_info_ = true;
     linear_solver_ = "ldl";
+    iterative_kkt_ = false;
+    kkt_tol_ = 1e-10;
+    kkt_max_iter_ = 20;
     // Read user options
     for (auto&& op : opts) {
       if (op.first=="max_iter") {
@@ -125,12 +140,25 @@ namespace casadi {
         linear_solver_ = op.second.to_string();
       } else if (op.first=="linear_solver_options") {
         linear_solver_options_ = op.second;
+      } else if (op.first=="iterative_kkt") {
+        iterative_kkt_ = op.second;
+      } else if (op.first=="kkt_tol") {
+        kkt_tol_ = op.second;
+      } else if (op.first=="kkt_max_iter") {
+        kkt_max_iter_ = op.second;
       }
     }
     // Memory for IP solver
     alloc_w(casadi_ipqp_sz_w(&p_), true);
     // Memory for KKT formation
     alloc_w(kkt_.nnz(), true);
+    if (iterative_kkt_) {
+      casadi_assert(kkt_max_iter_>0, "'kkt_max_iter' must be positive");
+      // Preconditioner and GMRES work vectors
+      casadi_int n = kkt_.size1(), m = kkt_max_iter_;
+      alloc_w(kkt_.nnz(), true);
+      alloc_w(n*(m+1) + (m+1)*m + 3*m + 1 + n, true);
+    }
     alloc_iw(A_.size2());
     alloc_w(nx_ + na_);
     // KKT solver
@@ -140,6 +168,7 @@ namespace casadi {
       print("-------------------------------------------\n");
       print("This is casadi::Ipqp\n");
       print("Linear solver:                   %12s\n", linear_solver_.c_str());
+      if (iterative_kkt_) print("KKT solver:                      %12s\n", "gmres");
       print("Number of variables:             %12d\n", nx_);
       print("Number of constraints:           %12d\n", na_);
       print("Number of nonzeros in H:         %12d\n", H_.nnz());
@@ -156,6 +185,79 @@ namespace casadi {
     if (Conic::init_mem(mem)) return 1;
     auto m = static_cast<IpqpMemory*>(mem);
     m->return_status = "";
+    m->n_fact = m->kkt_iter = 0;
+    return 0;
+  }
+
+  int Ipqp::kkt_gmres(const double* nz_kkt, const double* nz_prec, double* b, double tol,
+      casadi_int* iter, int linsol_mem, double* w) const {
+    casadi_int n = kkt_.size1(), m = kkt_max_iter_, ld = m + 1, i, j, k;
+    double beta, h, t, den;
+    bool converged = false;
+    // Work vectors: Krylov basis, Hessenberg matrix, Givens rotations, residual
+    double* V = w; w += n*(m+1);
+    double* H = w; w += (m+1)*m;
+    double* cs = w; w += m;
+    double* sn = w; w += m;
+    double* g = w; w += m+1;
+    double* z = w; w += n;
+    *iter = 0;
+    // Zero initial guess
+    beta = casadi_norm_2(n, b);
+    if (beta == 0) return 0;
+    casadi_copy(b, n, V);
+    casadi_scal(n, 1./beta, V);
+    casadi_clear(g, m+1);
+    g[0] = beta;
+    for (j=0; j<m; ++j) {
+      // Next Krylov vector: K * M^{-1} * v_j
+      casadi_copy(V + j*n, n, z);
+      if (linsol_.solve(nz_prec, z, 1, false, linsol_mem)) return -1;
+      double* v = V + (j+1)*n;
+      casadi_clear(v, n);
+      casadi_mv(nz_kkt, kkt_, z, v, false);
+      // Modified Gram-Schmidt
+      for (i=0; i<=j; ++i) {
+        h = casadi_dot(n, v, V + i*n);
+        H[i + j*ld] = h;
+        casadi_axpy(n, -h, V + i*n, v);
+      }
+      h = casadi_norm_2(n, v);
+      H[j+1 + j*ld] = h;
+      if (h > 0) casadi_scal(n, 1./h, v);
+      // Apply previous Givens rotations to the new column
+      for (i=0; i<j; ++i) {
+        t = cs[i]*H[i + j*ld] + sn[i]*H[i+1 + j*ld];
+        H[i+1 + j*ld] = -sn[i]*H[i + j*ld] + cs[i]*H[i+1 + j*ld];
+        H[i + j*ld] = t;
+      }
+      // New rotation eliminating the subdiagonal entry
+      den = sqrt(H[j + j*ld]*H[j + j*ld] + h*h);
+      if (den == 0) break;
+      cs[j] = H[j + j*ld] / den;
+      sn[j] = h / den;
+      H[j + j*ld] = den;
+      H[j+1 + j*ld] = 0;
+      g[j+1] = -sn[j]*g[j];
+      g[j] *= cs[j];
+      *iter = j + 1;
+      if (fabs(g[j+1]) <= tol*beta || h == 0) {
+        converged = true;
+        break;
+      }
+    }
+    if (!converged) return 1;
+    // Solve the triangular least squares system
+    k = *iter;
+    for (i=k-1; i>=0; --i) {
+      for (j=i+1; j<k; ++j) g[i] -= H[i + j*ld]*g[j];
+      g[i] /= H[i + i*ld];
+    }
+    // Solution: M^{-1} * V * y
+    casadi_clear(z, n);
+    for (i=0; i<k; ++i) casadi_axpy(n, g[i], V + i*n, z);
+    if (linsol_.solve(nz_prec, z, 1, false, linsol_mem)) return -1;
+    casadi_copy(z, n, b);
     return 0;
   }
 
@@ -166,6 +268,17 @@ namespace casadi {
     char buf[121];
     // Setup KKT system
     double* nz_kkt = w; w += kkt_.nnz();
+    // Factorized matrix, lagging behind the KKT matrix when solving iteratively
+    double *nz_prec = nz_kkt, *w_gmres = 0;
+    if (iterative_kkt_) {
+      casadi_int n = kkt_.size1(), mk = kkt_max_iter_;
+      nz_prec = w; w += kkt_.nnz();
+      w_gmres = w; w += n*(mk+1) + (mk+1)*mk + 3*mk + 1 + n;
+    }
+    bool have_prec = false;
+    casadi_int kkt_iter;
+    int flag;
+    m->n_fact = m->kkt_iter = 0;
     // Checkout a linear solver instance
     int linsol_mem = linsol_.checkout();
     // Setup IP solver
@@ -203,14 +316,41 @@ namespace casadi {
         // Form KKT
         casadi_kkt(kkt_, nz_kkt, H_, arg[CONIC_H], A_, arg[CONIC_A],
           d.S, d.D, w, iw);
+        // Keep the factorization of an earlier iteration as preconditioner
+        if (iterative_kkt_ && have_prec) break;
         // Factorize KKT
-        if (linsol_.nfact(nz_kkt, linsol_mem))
+        if (nz_prec != nz_kkt) casadi_copy(nz_kkt, kkt_.nnz(), nz_prec);
+        m->n_fact++;
+        if (linsol_.nfact(nz_prec, linsol_mem)) {
           d.status = IPQP_FACTOR_ERROR;
+        } else {
+          have_prec = true;
+        }
         break;
       case IPQP_SOLVE:
-        // Solve KKT
-        if (linsol_.solve(nz_kkt, d.linsys, 1, false, linsol_mem))
-          d.status = IPQP_SOLVE_ERROR;
+        if (iterative_kkt_) {
+          // Inexact solves while far from the solution
+          double tol = fmax(kkt_tol_, fmin(0.1, d.mu));
+          flag = kkt_gmres(nz_kkt, nz_prec, d.linsys, tol, &kkt_iter, linsol_mem, w_gmres);
+          m->kkt_iter += kkt_iter;
+          if (flag == 1) {
+            // Preconditioner too inaccurate: refactorize and retry
+            casadi_copy(nz_kkt, kkt_.nnz(), nz_prec);
+            m->n_fact++;
+            if (linsol_.nfact(nz_prec, linsol_mem)) {
+              have_prec = false;
+              d.status = IPQP_SOLVE_ERROR;
+              break;
+            }
+            flag = kkt_gmres(nz_kkt, nz_prec, d.linsys, tol, &kkt_iter, linsol_mem, w_gmres);
+            m->kkt_iter += kkt_iter;
+          }
+          if (flag) d.status = IPQP_SOLVE_ERROR;
+        } else {
+          // Solve KKT
+          if (linsol_.solve(nz_kkt, d.linsys, 1, false, linsol_mem))
+            d.status = IPQP_SOLVE_ERROR;
+        }
         break;
       }
     }
@@ -236,11 +376,13 @@ namespace casadi {
     Dict stats = Conic::get_stats(mem);
     auto m = static_cast<IpqpMemory*>(mem);
     stats["return_status"] = m->return_status;
+    stats["n_fact"] = m->n_fact;
+    if (iterative_kkt_) stats["kkt_iter"] = m->kkt_iter;
     return stats;
   }
 
   Ipqp::Ipqp(DeserializingStream& s) : Conic(s) {
-    s.version("Ipqp", 1);
+    int version = s.version("Ipqp", 1, 2);
     s.unpack("Ipqp::kkt", kkt_);
     s.unpack("Ipqp::print_iter", print_iter_);
     s.unpack("Ipqp::print_header", print_header_);
@@ -253,12 +395,21 @@ namespace casadi {
     s.unpack("Ipqp::du_tol", p_.du_tol);
     s.unpack("Ipqp::co_tol", p_.co_tol);
     s.unpack("Ipqp::mu_tol", p_.mu_tol);
+    if (version >= 2) {
+      s.unpack("Ipqp::iterative_kkt", iterative_kkt_);
+      s.unpack("Ipqp::kkt_tol", kkt_tol_);
+      s.unpack("Ipqp::kkt_max_iter", kkt_max_iter_);
+    } else {
+      iterative_kkt_ = false;
+      kkt_tol_ = 1e-10;
+      kkt_max_iter_ = 20;
+    }
   }
 
   void Ipqp::serialize_body(SerializingStream &s) const {
     Conic::serialize_body(s);
 
-    s.version("Ipqp", 1);
+    s.version("Ipqp", 2);
     s.pack("Ipqp::kkt", kkt_);
     s.pack("Ipqp::print_iter", print_iter_);
     s.pack("Ipqp::print_header", print_header_);
@@ -270,6 +421,9 @@ namespace casadi {
     s.pack("Ipqp::du_tol", p_.du_tol);
     s.pack("Ipqp::co_tol", p_.co_tol);
     s.pack("Ipqp::mu_tol", p_.mu_tol);
+    s.pack("Ipqp::iterative_kkt", iterative_kkt_);
+    s.pack("Ipqp::kkt_tol", kkt_tol_);
+    s.pack("Ipqp::kkt_max_iter", kkt_max_iter_);
   }
 
 } // namespace casadi
@@ -43,6 +43,8 @@
 namespace casadi {
   struct CASADI_CONIC_IPQP_EXPORT IpqpMemory : public ConicMemory {
     const char* return_status;
+    // Number of KKT factorizations and Krylov iterations
+    casadi_int n_fact, kkt_iter;
   };
 
   /** \brief \pluginbrief{Conic,ipqp}
@@ -112,8 +114,21 @@ namespace casadi {
     bool print_iter_, print_header_, print_info_;
     std::string linear_solver_;
     Dict linear_solver_options_;
+    bool iterative_kkt_;
+    double kkt_tol_;
+    casadi_int kkt_max_iter_;
     ///@}
 
+    /** \brief Solve the KKT system with preconditioned GMRES
+     *
+     * The factorization in the linear solver, possibly of an earlier KKT matrix,
+     * is used as a right preconditioner. The right-hand side b is overwritten
+     * by the solution only if the relative residual drops below tol.
+     * Returns 0 on convergence, 1 if not converged, -1 on linear solver failure.
+     */
+    int kkt_gmres(const double* nz_kkt, const double* nz_prec, double* b, double tol,
+      casadi_int* iter, int linsol_mem, double* w) const;
+
     void serialize_body(SerializingStream &s) const override;
 
     /** \brief Deserialize with type disambiguation */
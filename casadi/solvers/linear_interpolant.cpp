@@ -88,8 +88,13 @@ namespace casadi {
     if (res[0]) {
       const double* values = has_parametric_values() ? arg[arg_values()] : get_ptr(values_);
       const double* grid = has_parametric_grid() ? arg[arg_grid()] : get_ptr(grid_);
-      casadi_interpn(res[0], ndim_, grid, get_ptr(offset_),
-                    values, arg[0], get_ptr(lookup_mode_), m_, iw, w);
+      if (batch_x_==1) {
+        casadi_interpn(res[0], ndim_, grid, get_ptr(offset_),
+                      values, arg[0], get_ptr(lookup_mode_), m_, iw, w);
+      } else {
+        casadi_interpn_batch(res[0], ndim_, grid, get_ptr(offset_),
+                      values, arg[0], get_ptr(lookup_mode_), m_, batch_x_, iw, w);
+      }
     }
     return 0;
   }
@@ -97,10 +102,15 @@ namespace casadi {
   void LinearInterpolant::codegen_body(CodeGenerator& g) const {
     std::string values = has_parametric_values() ? g.arg(arg_values()) : g.constant(values_);
     std::string grid = has_parametric_grid() ? g.arg(arg_grid()) : g.constant(grid_);
-    g << "  if (res[0]) {\n"
-      << "    " << g.interpn("res[0]", ndim_, grid, g.constant(offset_),
-      values, "arg[0]", g.constant(lookup_mode_), m_,  "iw", "w") << "\n"
-      << "  }\n";
+    g << "  if (res[0]) {\n";
+    if (batch_x_==1) {
+      g << "    " << g.interpn("res[0]", ndim_, grid, g.constant(offset_),
+        values, "arg[0]", g.constant(lookup_mode_), m_,  "iw", "w") << "\n";
+    } else {
+      g << "    " << g.interpn_batch("res[0]", ndim_, grid, g.constant(offset_),
+        values, "arg[0]", g.constant(lookup_mode_), m_, batch_x_, "iw", "w") << "\n";
+    }
+    g << "  }\n";
   }
 
   Function LinearInterpolant::
@@ -136,6 +146,8 @@ namespace casadi {
     auto m = derivative_of_.get<LinearInterpolant>();
     alloc_w(2*m->ndim_ + m->m_, true);
     alloc_iw(2*m->ndim_, true);
+    // Gradient of a single point, scattered into the block diagonal
+    if (m->batch_x_>1) alloc_w(m->ndim_*m->m_, true);
   }
 
   int LinearInterpolantJac::
@@ -145,8 +157,25 @@ namespace casadi {
     const double* values = has_parametric_values() ? arg[m->arg_values()] : get_ptr(m->values_);
     const double* grid = has_parametric_grid() ? arg[m->arg_grid()] : get_ptr(m->grid_);
 
-    casadi_interpn_grad(res[0], m->ndim_, grid, get_ptr(m->offset_),
-                      values, arg[0], get_ptr(m->lookup_mode_), m->m_, iw, w);
+    if (m->batch_x_==1) {
+      casadi_interpn_grad(res[0], m->ndim_, grid, get_ptr(m->offset_),
+                        values, arg[0], get_ptr(m->lookup_mode_), m->m_, iw, w);
+      return 0;
+    }
+
+    // Dense Jacobian of all points, nonzero only in diagonal blocks
+    if (!res[0]) return 0;
+    casadi_int ndim = m->ndim_, nm = m->m_, nb = m->batch_x_;
+    double* grad = w + 2*ndim + nm;
+    casadi_clear(res[0], nnz_out(0));
+    for (casadi_int k=0; k<nb; ++k) {
+      casadi_interpn_grad(grad, ndim, grid, get_ptr(m->offset_),
+                        values, arg[0] ? arg[0]+k*ndim : 0,
+                        get_ptr(m->lookup_mode_), nm, iw, w);
+      for (casadi_int i=0; i<ndim; ++i) {
+        casadi_copy(grad+i*nm, nm, res[0] + (k*ndim+i)*nm*nb + k*nm);
+      }
+    }
     return 0;
   }
 
@@ -166,9 +195,28 @@ namespace casadi {
     std::string values = has_parametric_values() ? g.arg(m->arg_values()) : g.constant(m->values_);
     std::string grid = has_parametric_grid() ? g.arg(m->arg_grid()) : g.constant(m->grid_);
 
-    g << "  " << g.interpn_grad("res[0]", m->ndim_,
-      grid, g.constant(m->offset_), values,
-      "arg[0]", g.constant(m->lookup_mode_), m->m_, "iw", "w") << "\n";
+    if (m->batch_x_==1) {
+      g << "  " << g.interpn_grad("res[0]", m->ndim_,
+        grid, g.constant(m->offset_), values,
+        "arg[0]", g.constant(m->lookup_mode_), m->m_, "iw", "w") << "\n";
+      return;
+    }
+
+    // Dense Jacobian of all points, nonzero only in diagonal blocks
+    casadi_int ndim = m->ndim_, nm = m->m_, nb = m->batch_x_;
+    std::string grad = "w+" + str(2*ndim + nm);
+    g.local("k", "casadi_int");
+    g.local("i", "casadi_int");
+    g << "  if (!res[0]) return 0;\n";
+    g << "  " << g.clear("res[0]", nnz_out(0)) << "\n";
+    g << "  for (k=0; k<" << nb << "; ++k) {\n";
+    g << "    " << g.interpn_grad(grad, ndim, grid, g.constant(m->offset_), values,
+      "arg[0]+k*" + str(ndim), g.constant(m->lookup_mode_), nm, "iw", "w") << "\n";
+    g << "    for (i=0; i<" << ndim << "; ++i) {\n";
+    g << "      " << g.copy(grad + "+i*" + str(nm), nm,
+      "res[0]+(k*" + str(ndim) + "+i)*" + str(nm*nb) + "+k*" + str(nm)) << "\n";
+    g << "    }\n";
+    g << "  }\n";
   }
 
 
@@ -25,9 +25,13 @@
 
 #include "linsol_ldl.hpp"
 #include "casadi/core/global_options.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 namespace casadi {
 
+  // Number of right-hand-sides solved for per pass over the factors
+  static const casadi_int nrhs_block = 8;
+
   extern "C"
   int CASADI_LINSOL_LDL_EXPORT
   casadi_register_linsol_ldl(LinsolInternal::Plugin* plugin) {
@@ -60,7 +64,28 @@ namespace casadi {
        "Incomplete factorization, without any fill-in"}},
       {"preordering",
        {OT_BOOL,
-       "Approximate minimal degree (AMD) preordering"}}
+       "Approximate minimal degree (AMD) preordering, same as ordering 'amd' or 'natural'"}},
+      {"ordering",
+       {OT_STRING,
+       "Fill-reducing ordering: 'amd' (approximate minimal degree), "
+       "'nd' (nested dissection) or 'natural' [amd]"}},
+      {"supernodal",
+       {OT_BOOL,
+       "Supernodal numeric factorization, using dense kernels for columns of the factor "
+       "with identical sparsity [false]"}},
+      {"mixed_precision",
+       {OT_BOOL,
+       "Factorize in single precision, recovering double precision accuracy with "
+       "iterative refinement. Not used in generated code [false]"}},
+      {"refine",
+       {OT_INT,
+       "Maximum number of iterative refinement steps. "
+       "Not used in generated code [0, 10 with mixed_precision]"}},
+      {"parallel_solve",
+       {OT_BOOL,
+       "Triangular solves scheduled by elimination tree subtrees, "
+       "distributed over the thread pool. "
+       "Not used in generated code [false]"}}
      }
   };
 
@@ -70,32 +95,215 @@ namespace casadi {
 
     // Default options
     incomplete_ = false;
-    amd_ = true;
+    ordering_ = "amd";
+    supernodal_ = false;
+    mixed_ = false;
+    refine_ = -1;
+    parallel_ = false;
 
     // Read user options
     for (auto&& op : opts) {
       if (op.first=="incomplete") {
         incomplete_ = op.second;
-      } else if (op.first=="amd") {
-        amd_ = op.second;
+      } else if (op.first=="preordering") {
+        ordering_ = op.second.to_bool() ? "amd" : "natural";
+      } else if (op.first=="ordering") {
+        ordering_ = op.second.to_string();
+      } else if (op.first=="supernodal") {
+        supernodal_ = op.second;
+      } else if (op.first=="mixed_precision") {
+        mixed_ = op.second;
+      } else if (op.first=="refine") {
+        refine_ = op.second;
+      } else if (op.first=="parallel_solve") {
+        parallel_ = op.second;
+      }
+    }
+    if (refine_<0) refine_ = mixed_ ? 10 : 0;
+
+    casadi_assert(ordering_=="amd" || ordering_=="nd" || ordering_=="natural",
+                  "Unknown ordering '" + ordering_ + "', expected 'amd', 'nd' or 'natural'");
+    casadi_assert(!(supernodal_ && incomplete_),
+                  "Supernodal factorization requires complete factorization");
+
+    // Symbolic factorization, shared between instances with the same pattern
+    auto sym = shared_symbolic<LinsolLdlSymbolic>(
+      str(incomplete_) + ordering_ + str(supernodal_), [this]() {
+        init_symbolic();
+        return LinsolLdlSymbolic{p_, sp_Lt_, sn_};
+      });
+    p_ = sym->p;
+    sp_Lt_ = sym->sp_Lt;
+    sn_ = sym->sn;
+
+    // Subtree schedule for the solve
+    if (parallel_) init_subtrees();
+  }
+
+  void LinsolLdl::init_subtrees() {
+    casadi_int n = nrow();
+    // Elimination tree from the first entry below the diagonal in each column of L
+    sp_L_ = sp_Lt_.transpose(L_nz_);
+    const casadi_int *L_colind = sp_L_.colind(), *L_row = sp_L_.row();
+    std::vector<casadi_int> parent(n), size(n, 1);
+    for (casadi_int i=0; i<n; ++i) {
+      parent[i] = L_colind[i]==L_colind[i+1] ? -1 : L_row[L_colind[i]];
+      if (parent[i]>=0) size[parent[i]] += size[i];
+    }
+    // Largest subtree handled by a single task
+    casadi_int max_size = std::max(n/64, static_cast<casadi_int>(256));
+    // Assign subtrees to tasks, parents before children
+    std::vector<casadi_int> task(n);
+    casadi_int n_task = 0;
+    for (casadi_int i=n-1; i>=0; --i) {
+      if (parent[i]>=0 && task[parent[i]]>=0) {
+        task[i] = task[parent[i]];
+      } else if (size[i]<=max_size) {
+        task[i] = n_task++;
+      } else {
+        task[i] = -1;
       }
     }
+    // Nodes of each task in increasing order, followed by the remaining nodes
+    task_ptr_.assign(n_task+2, 0);
+    for (casadi_int i=0; i<n; ++i) task_ptr_[(task[i]<0 ? n_task : task[i]) + 1]++;
+    for (casadi_int t=0; t<=n_task; ++t) task_ptr_[t+1] += task_ptr_[t];
+    task_ind_.resize(n);
+    std::vector<casadi_int> pos(task_ptr_.begin(), task_ptr_.end()-1);
+    for (casadi_int i=0; i<n; ++i) task_ind_[pos[task[i]<0 ? n_task : task[i]]++] = i;
+    if (verbose_) {
+      casadi_message("Parallel solve: " + str(n_task) + " subtrees, "
+                     + str(task_ptr_[n_task+1]-task_ptr_[n_task]) + " of " + str(n)
+                     + " nodes solved serially");
+    }
+  }
+
+  void LinsolLdl::solve_subtrees(double* x, casadi_int nrhs, const double* lt, const double* d,
+                                 double* w) const {
+    casadi_int n = nrow(), n_task = task_ptr_.size()-2;
+    const casadi_int *Lt_colind = sp_Lt_.colind(), *Lt_row = sp_Lt_.row();
+    const casadi_int *L_colind = sp_L_.colind(), *L_row = sp_L_.row();
+    // Solve for L, same operations as casadi_ldl_trs, entries depend on descendants only
+    auto fwd = [&](casadi_int t) {
+      for (casadi_int i=task_ptr_[t]; i<task_ptr_[t+1]; ++i) {
+        casadi_int c = task_ind_[i];
+        double s = w[c];
+        for (casadi_int k=Lt_colind[c]; k<Lt_colind[c+1]; ++k) s -= lt[k]*w[Lt_row[k]];
+        w[c] = s;
+      }
+    };
+    // Solve for L', gathering along rows of L' in the order casadi_ldl_trs scatters,
+    // entries depend on ancestors only
+    auto bwd = [&](casadi_int t) {
+      for (casadi_int i=task_ptr_[t+1]-1; i>=task_ptr_[t]; --i) {
+        casadi_int r = task_ind_[i];
+        double s = w[r];
+        for (casadi_int k=L_colind[r+1]-1; k>=L_colind[r]; --k) s -= lt[L_nz_[k]]*w[L_row[k]];
+        w[r] = s;
+      }
+    };
+    for (casadi_int k=0; k<nrhs; ++k) {
+      // Multiply by P
+      for (casadi_int i=0; i<n; ++i) w[i] = x[p_[i]];
+      // Solve for L: subtrees in parallel, then the remaining nodes
+      ThreadPool::instance().run(n_task, fwd);
+      fwd(n_task);
+      // Divide by D
+      for (casadi_int i=0; i<n; ++i) w[i] /= d[i];
+      // Solve for L': remaining nodes, then the subtrees in parallel
+      bwd(n_task);
+      ThreadPool::instance().run(n_task, bwd);
+      // Multiply by P'
+      for (casadi_int i=0; i<n; ++i) x[p_[i]] = w[i];
+      x += n;
+    }
+  }
 
-    // Symbolic factorization
-    if (incomplete_) {
-      if (amd_) {
-        // Incomplete LDL^T, AMD permutation
+  void LinsolLdl::init_symbolic() {
+    if (!incomplete_ && ordering_!="nd") {
+      // Regular LDL^T, cached with the sparsity pattern
+      sp_Lt_ = sp_.ldl(p_, ordering_=="amd");
+    } else {
+      // Fill-reducing permutation
+      if (ordering_=="amd") {
         p_ = sp_.amd();
-        std::vector<casadi_int> tmp;
-        Sparsity Aperm = sp_.sub(p_, p_, tmp);
+      } else if (ordering_=="nd") {
+        p_ = sp_.nd();
+      } else {
+        p_ = range(sp_.size1());
+      }
+      std::vector<casadi_int> tmp;
+      Sparsity Aperm = sp_.sub(p_, p_, tmp);
+
+      // Symbolic factorization
+      if (incomplete_) {
         sp_Lt_ = triu(Aperm, false);  // no fill-in
       } else {
-        p_ = range(sp_.size1());  // no reordering
-        sp_Lt_ = triu(sp_, false);  // no fill-in
+        sp_Lt_ = Aperm.ldl(tmp, false);
+      }
+    }
+
+    // Supernodes
+    if (supernodal_) init_supernodes();
+  }
+
+  void LinsolLdl::init_supernodes() {
+    casadi_int n = nrow();
+    // Strictly lower part of L, with mapping to the nonzeros of L^T
+    std::vector<casadi_int> lt_nz;
+    Sparsity L = sp_Lt_.transpose(lt_nz);
+    const casadi_int *L_colind = L.colind(), *L_row = L.row();
+    // Merge column j with j-1 if j is its parent and the structure below is shared
+    std::vector<casadi_int> start(1, 0);
+    for (casadi_int j=1; j<n; ++j) {
+      casadi_int nz_prev = L_colind[j]-L_colind[j-1], nz = L_colind[j+1]-L_colind[j];
+      if (nz_prev!=nz+1 || L_row[L_colind[j-1]]!=j) start.push_back(j);
+    }
+    if (n>0) start.push_back(n);
+    casadi_int nsn = start.size()-1;
+    // Row indices and offsets of the dense blocks
+    std::vector<casadi_int> rowind(1, 0), off(1, 0), sn_of(n), rows;
+    casadi_int m_max = 0;
+    for (casadi_int s=0; s<nsn; ++s) {
+      for (casadi_int j=start[s]; j<start[s+1]; ++j) {
+        rows.push_back(j);
+        sn_of[j] = s;
+      }
+      casadi_int j_last = start[s+1]-1;
+      rows.insert(rows.end(), L_row+L_colind[j_last], L_row+L_colind[j_last+1]);
+      casadi_int m = rows.size()-rowind.back();
+      rowind.push_back(rows.size());
+      off.push_back(off.back() + m*(start[s+1]-start[s]));
+      m_max = std::max(m_max, m);
+    }
+    // Inverse permutation
+    std::vector<casadi_int> pinv(n);
+    for (casadi_int i=0; i<n; ++i) pinv[p_[i]] = i;
+    // Block locations of the nonzeros of A and L^T
+    std::vector<casadi_int> a2b(sp_.nnz(), -1), lt2b(sp_Lt_.nnz(), -1), loc(n, -1);
+    const casadi_int *A_colind = sp_.colind(), *A_row = sp_.row();
+    for (casadi_int s=0; s<nsn; ++s) {
+      casadi_int m = rowind[s+1]-rowind[s];
+      for (casadi_int k=rowind[s]; k<rowind[s+1]; ++k) loc[rows[k]] = k-rowind[s];
+      for (casadi_int j=start[s]; j<start[s+1]; ++j) {
+        casadi_int b = off[s] + (j-start[s])*m;
+        for (casadi_int k=A_colind[p_[j]]; k<A_colind[p_[j]+1]; ++k) {
+          casadi_int i = pinv[A_row[k]];
+          if (i>=j) a2b[k] = b + loc[i];
+        }
+        for (casadi_int k=L_colind[j]; k<L_colind[j+1]; ++k) {
+          lt2b[lt_nz[k]] = b + loc[L_row[k]];
+        }
       }
-    } else {
-      // Regular LDL^T
-      sp_Lt_ = sp_.ldl(p_, amd_);
+    }
+    // Pack, cf. casadi_ldl_sn
+    sn_ = {n, nsn, sp_.nnz(), sp_Lt_.nnz(), off.back()+m_max};
+    for (auto v : {&start, &rowind, &off, &sn_of, &rows, &a2b, &lt2b}) {
+      sn_.insert(sn_.end(), v->begin(), v->end());
+    }
+    if (verbose_) {
+      casadi_message(str(nsn) + " supernodes for " + str(n) + " columns, largest block "
+                     + str(m_max) + " rows");
     }
   }
 
@@ -105,9 +313,23 @@ namespace casadi {
 
     // Work vectors
     casadi_int nrow = this->nrow();
+    casadi_int sz_w = sn_.empty() ? nrow : sn_[4];
     m->d.resize(nrow);
-    m->l.resize(sp_Lt_.nnz());
-    m->w.resize(nrow);
+    m->iw.resize(sn_.empty() ? 0 : nrow);
+    if (mixed_) {
+      m->af.resize(sp_.nnz());
+      m->lf.resize(sp_Lt_.nnz());
+      m->df.resize(nrow);
+      m->wf.resize(sz_w);
+      m->xf.resize(nrow);
+    } else {
+      m->l.resize(sp_Lt_.nnz());
+      m->w.resize(std::max(sz_w, nrow*nrhs_block));
+    }
+    if (mixed_ || refine_>0) {
+      m->b.resize(nrow);
+      m->res.resize(nrow);
+    }
 
     return 0;
   }
@@ -118,7 +340,23 @@ namespace casadi {
 
   int LinsolLdl::nfact(void* mem, const double* A) const {
     auto m = static_cast<LinsolLdlMemory*>(mem);
-    casadi_ldl(sp_, A, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    if (mixed_) {
+      // Factorize in single precision, keep D in double for neig and rank
+      std::copy(A, A+sp_.nnz(), m->af.begin());
+      if (sn_.empty()) {
+        casadi_ldl(sp_, get_ptr(m->af), sp_Lt_, get_ptr(m->lf), get_ptr(m->df), get_ptr(p_),
+                   get_ptr(m->wf));
+      } else {
+        casadi_ldl_sn(get_ptr(sn_), get_ptr(m->af), get_ptr(m->lf), get_ptr(m->df),
+                      get_ptr(m->wf), get_ptr(m->iw));
+      }
+      std::copy(m->df.begin(), m->df.end(), m->d.begin());
+    } else if (sn_.empty()) {
+      casadi_ldl(sp_, A, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    } else {
+      casadi_ldl_sn(get_ptr(sn_), A, get_ptr(m->l), get_ptr(m->d), get_ptr(m->w),
+                    get_ptr(m->iw));
+    }
     for (double d : m->d) {
       if (d==0) casadi_warning("LDL factorization has zeros in D");
     }
@@ -127,7 +365,32 @@ namespace casadi {
 
   int LinsolLdl::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LinsolLdlMemory*>(mem);
-    casadi_ldl_solve(x, nrhs, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    if (mixed_) {
+      // Single precision solves, refined in double precision
+      refine(A, x, nrhs, false, refine_, get_ptr(m->b), get_ptr(m->res), [&](double* y) {
+        std::copy(y, y+nrow(), m->xf.begin());
+        casadi_ldl_solve(get_ptr(m->xf), 1, sp_Lt_, get_ptr(m->lf), get_ptr(m->df), get_ptr(p_),
+                         get_ptr(m->wf));
+        std::copy(m->xf.begin(), m->xf.end(), y);
+      });
+    } else if (refine_>0) {
+      refine(A, x, nrhs, false, refine_, get_ptr(m->b), get_ptr(m->res), [&](double* y) {
+        if (parallel_ && ThreadPool::instance().size()>1) {
+          solve_subtrees(y, 1, get_ptr(m->l), get_ptr(m->d), get_ptr(m->w));
+        } else {
+          casadi_ldl_solve(y, 1, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_),
+                           get_ptr(m->w));
+        }
+      });
+    } else if (parallel_ && ThreadPool::instance().size()>1) {
+      solve_subtrees(x, nrhs, get_ptr(m->l), get_ptr(m->d), get_ptr(m->w));
+    } else if (nrhs==1) {
+      casadi_ldl_solve(x, nrhs, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_),
+                       get_ptr(m->w));
+    } else {
+      casadi_ldl_solve_block(x, nrhs, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_),
+                             get_ptr(m->w), nrhs_block);
+    }
     return 0;
   }
 
@@ -159,31 +422,60 @@ namespace casadi {
     // Place in block to avoid conflicts caused by local variables
     g << "{\n";
     g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
+    casadi_int nb = std::min(nrhs, nrhs_block);
+    casadi_int sz_w = std::max(sn_.empty() ? nrow() : sn_[4], nrow()*nb);
     g << "casadi_real lt[" << sp_Lt_.nnz() << "], "
          "d[" << nrow() << "], "
-         "w[" << nrow() << "];\n";
+         "w[" << sz_w << "];\n";
 
     // Factorize
-    g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+    if (sn_.empty()) {
+      g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+    } else {
+      g << "casadi_int iw[" << nrow() << "];\n";
+      g << g.ldl_sn(g.constant(sn_), A, "lt", "d", "w", "iw") << "\n";
+    }
 
     // Solve
-    g << g.ldl_solve(x, nrhs, sp_Lt, "lt", "d", p, "w") << "\n";
+    if (nb==1) {
+      g << g.ldl_solve(x, nrhs, sp_Lt, "lt", "d", p, "w") << "\n";
+    } else {
+      g << g.ldl_solve_block(x, nrhs, sp_Lt, "lt", "d", p, "w", nb) << "\n";
+    }
 
     // End of block
     g << "}\n";
   }
 
   LinsolLdl::LinsolLdl(DeserializingStream& s) : LinsolInternal(s) {
-    s.version("LinsolLdl", 1);
+    int version = s.version("LinsolLdl", 1, 4);
     s.unpack("LinsolLdl::p", p_);
     s.unpack("LinsolLdl::sp_Lt", sp_Lt_);
+    if (version>1) s.unpack("LinsolLdl::sn", sn_);
+    if (version>2) {
+      s.unpack("LinsolLdl::mixed", mixed_);
+      s.unpack("LinsolLdl::refine", refine_);
+    } else {
+      mixed_ = false;
+      refine_ = 0;
+    }
+    if (version>3) {
+      s.unpack("LinsolLdl::parallel_solve", parallel_);
+    } else {
+      parallel_ = false;
+    }
+    if (parallel_) init_subtrees();
   }
 
   void LinsolLdl::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("LinsolLdl", 1);
+    s.version("LinsolLdl", 4);
     s.pack("LinsolLdl::p", p_);
     s.pack("LinsolLdl::sp_Lt", sp_Lt_);
+    s.pack("LinsolLdl::sn", sn_);
+    s.pack("LinsolLdl::mixed", mixed_);
+    s.pack("LinsolLdl::refine", refine_);
+    s.pack("LinsolLdl::parallel_solve", parallel_);
   }
 
 } // namespace casadi
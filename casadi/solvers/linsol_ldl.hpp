@@ -42,6 +42,18 @@
 namespace casadi {
   struct CASADI_LINSOL_LDL_EXPORT LinsolLdlMemory : public LinsolMemory {
     std::vector<double> l, d, w;
+    std::vector<casadi_int> iw;
+    // Single precision factorization
+    std::vector<float> af, lf, df, wf, xf;
+    // Iterative refinement
+    std::vector<double> b, res;
+  };
+
+  /// Symbolic factorization, shared between instances
+  struct LinsolLdlSymbolic {
+    std::vector<casadi_int> p;
+    Sparsity sp_Lt;
+    std::vector<casadi_int> sn;
   };
 
   /** \brief \pluginbrief{LinsolInternal,ldl}
@@ -108,13 +120,36 @@ namespace casadi {
     // Get name of the class
     std::string class_name() const override { return "LinsolLdl";}
 
+    // Compute the symbolic factorization
+    void init_symbolic();
+
+    // Detect the supernodes for the supernodal factorization
+    void init_supernodes();
+
+    // Subtree schedule for the parallel solve
+    void init_subtrees();
+
+    // Solve with independent subtrees in parallel, cf. casadi_ldl_solve
+    void solve_subtrees(double* x, casadi_int nrhs, const double* lt, const double* d,
+                        double* w) const;
+
     // Symbolic factorization
     std::vector<casadi_int> p_;
     Sparsity sp_Lt_;
 
+    // Supernodes, cf. casadi_ldl_sn, empty if not supernodal
+    std::vector<casadi_int> sn_;
+
+    // Nodes of the elimination tree by parallel task, the last one being serial,
+    // with L and its mapping to the nonzeros of L'
+    std::vector<casadi_int> task_ptr_, task_ind_, L_nz_;
+    Sparsity sp_L_;
+
     ///@{
     // Options
-    bool incomplete_, amd_;
+    bool incomplete_, supernodal_, mixed_, parallel_;
+    casadi_int refine_;
+    std::string ordering_;
     ///@}
 
     /** \brief Serialize an object without type information */
@@ -28,6 +28,9 @@
 
 namespace casadi {
 
+  // Number of right-hand-sides solved for per pass over the factors
+  static const casadi_int nrhs_block = 8;
+
   extern "C"
   int CASADI_LINSOL_QR_EXPORT
   casadi_register_linsol_qr(LinsolInternal::Plugin* plugin) {
@@ -58,9 +61,21 @@ namespace casadi {
      {{"eps",
        {OT_DOUBLE,
         "Minimum R entry before singularity is declared [1e-12]"}},
+      {"ordering",
+       {OT_STRING,
+        "Fill-reducing column ordering, applied to the pattern of A'*A: "
+        "'amd' (approximate minimal degree), 'nd' (nested dissection) or 'natural' [amd]"}},
       {"cache",
        {OT_DOUBLE,
-        "Amount of factorisations to remember (thread-local) [0]"}}
+        "Amount of factorisations to remember (thread-local) [0]"}},
+      {"mixed_precision",
+       {OT_BOOL,
+        "Factorize in single precision, recovering double precision accuracy with "
+        "iterative refinement. Not used in generated code [false]"}},
+      {"refine",
+       {OT_INT,
+        "Maximum number of iterative refinement steps. "
+        "Not used in generated code [0, 10 with mixed_precision]"}}
      }
   };
 
@@ -71,16 +86,45 @@ namespace casadi {
     // Read options
     eps_ = 1e-12;
     n_cache_ = 0;
+    mixed_ = false;
+    refine_ = -1;
+    ordering_ = "amd";
     for (auto&& op : opts) {
       if (op.first=="eps") {
         eps_ = op.second;
+      } else if (op.first=="ordering") {
+        ordering_ = op.second.to_string();
       } else if (op.first=="cache") {
         n_cache_ = op.second;
+      } else if (op.first=="mixed_precision") {
+        mixed_ = op.second;
+      } else if (op.first=="refine") {
+        refine_ = op.second;
       }
     }
-
-    // Symbolic factorization
-    sp_.qr_sparse(sp_v_, sp_r_, prinv_, pc_);
+    if (refine_<0) refine_ = mixed_ ? 10 : 0;
+    casadi_assert(!(mixed_ && n_cache_>0), "Option 'cache' not supported with 'mixed_precision'");
+    casadi_assert(ordering_=="amd" || ordering_=="nd" || ordering_=="natural",
+                  "Unknown ordering '" + ordering_ + "', expected 'amd', 'nd' or 'natural'");
+
+    // Symbolic factorization, shared between instances with the same pattern
+    auto sym = shared_symbolic<LinsolQrSymbolic>(ordering_, [this]() {
+        LinsolQrSymbolic r;
+        if (ordering_=="nd") {
+          // Nested dissection of the pattern of A'*A
+          r.pc = mtimes(sp_.T(), sp_).nd();
+          std::vector<casadi_int> tmp;
+          sp_.sub(range(nrow()), r.pc, tmp).qr_sparse(r.sp_v, r.sp_r, r.prinv, tmp, false);
+        } else {
+          // Cached with the sparsity pattern
+          sp_.qr_sparse(r.sp_v, r.sp_r, r.prinv, r.pc, ordering_=="amd");
+        }
+        return r;
+      });
+    sp_v_ = sym->sp_v;
+    sp_r_ = sym->sp_r;
+    prinv_ = sym->prinv;
+    pc_ = sym->pc;
   }
 
   void LinsolQr::finalize() {
@@ -93,10 +137,23 @@ namespace casadi {
     auto m = static_cast<LinsolQrMemory*>(mem);
 
     // Memory for numerical solution
-    m->v.resize(sp_v_.nnz());
-    m->r.resize(sp_r_.nnz());
-    m->beta.resize(ncol());
-    m->w.resize(nrow() + ncol());
+    if (mixed_) {
+      m->af.resize(sp_.nnz());
+      m->vf.resize(sp_v_.nnz());
+      m->rf.resize(sp_r_.nnz());
+      m->betaf.resize(ncol());
+      m->wf.resize(nrow() + ncol());
+      m->xf.resize(ncol());
+    } else {
+      m->v.resize(sp_v_.nnz());
+      m->r.resize(sp_r_.nnz());
+      m->beta.resize(ncol());
+      m->w.resize(std::max(nrow() + ncol(), sz_w_block(nrhs_block)));
+    }
+    if (mixed_ || refine_>0) {
+      m->b.resize(nrow());
+      m->res.resize(nrow());
+    }
 
     m->cache.resize(cache_stride_*n_cache_);
     m->cache_loc.resize(n_cache_, -1);
@@ -104,13 +161,47 @@ namespace casadi {
     return 0;
   }
 
+  casadi_int LinsolQr::sz_w_block(casadi_int nb) const {
+    // cf. casadi_qr_solve_block
+    return (std::max(ncol(), sp_v_.size1()) + 1)*nb;
+  }
+
   int LinsolQr::sfact(void* mem, const double* A) const {
     return 0;
   }
 
+  template<typename T1>
+  int LinsolQr::factorize(const T1* A, T1* w, T1* v, T1* r, T1* beta) const {
+    casadi_qr(sp_, A, w, sp_v_, v, sp_r_, r, beta, get_ptr(prinv_), get_ptr(pc_));
+    // Check singularity
+    T1 rmin;
+    casadi_int irmin, nullity;
+    nullity = casadi_qr_singular(&rmin, &irmin, r, sp_r_, get_ptr(pc_), static_cast<T1>(eps_));
+    if (nullity) {
+      if (verbose_) {
+        print("Singularity detected: Rank %lld<%lld\n", ncol()-nullity, ncol());
+        print("First singular R entry: %g<%g, corresponding to row %lld\n",
+              static_cast<double>(rmin), eps_, irmin);
+        casadi_qr_colcomb(w, r, sp_r_, get_ptr(pc_), static_cast<T1>(eps_), 0);
+        print("Linear combination of columns:\n[");
+        for (casadi_int k=0; k<ncol(); ++k) print(k==0 ? "%g" : ", %g", static_cast<double>(w[k]));
+        print("]\n");
+      }
+      return 1;
+    }
+    return 0;
+  }
+
   int LinsolQr::nfact(void* mem, const double* A) const {
     auto m = static_cast<LinsolQrMemory*>(mem);
 
+    if (mixed_) {
+      // Factorize in single precision
+      std::copy(A, A+sp_.nnz(), m->af.begin());
+      return factorize(get_ptr(m->af), get_ptr(m->wf), get_ptr(m->vf), get_ptr(m->rf),
+                       get_ptr(m->betaf));
+    }
+
     // Check for a cache hit
     double* cache = nullptr;
     bool cache_hit = cache_check(A, get_ptr(m->cache), get_ptr(m->cache_loc),
@@ -126,24 +217,7 @@ namespace casadi {
     }
 
     // Cache miss -> compute result
-    casadi_qr(sp_, A, get_ptr(m->w),
-              sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
-              get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_));
-    // Check singularity
-    double rmin;
-    casadi_int irmin, nullity;
-    nullity = casadi_qr_singular(&rmin, &irmin, get_ptr(m->r), sp_r_, get_ptr(pc_), eps_);
-    if (nullity) {
-      if (verbose_) {
-        print("Singularity detected: Rank %lld<%lld\n", ncol()-nullity, ncol());
-        print("First singular R entry: %g<%g, corresponding to row %lld\n", rmin, eps_, irmin);
-        casadi_qr_colcomb(get_ptr(m->w), get_ptr(m->r), sp_r_, get_ptr(pc_), eps_, 0);
-        print("Linear combination of columns:\n[");
-        for (casadi_int k=0; k<ncol(); ++k) print(k==0 ? "%g" : ", %g", m->w[k]);
-        print("]\n");
-      }
-      return 1;
-    }
+    if (factorize(A, get_ptr(m->w), get_ptr(m->v), get_ptr(m->r), get_ptr(m->beta))) return 1;
 
     if (cache) { // Store result in cache
       casadi_copy(A, sp_.nnz(), cache); cache+=sp_.nnz();
@@ -156,9 +230,29 @@ namespace casadi {
 
   int LinsolQr::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LinsolQrMemory*>(mem);
-    casadi_qr_solve(x, nrhs, tr,
-                    sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
-                    get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->w));
+    if (mixed_) {
+      // Single precision solves, refined in double precision
+      refine(A, x, nrhs, tr, refine_, get_ptr(m->b), get_ptr(m->res), [&](double* y) {
+        std::copy(y, y+ncol(), m->xf.begin());
+        casadi_qr_solve(get_ptr(m->xf), 1, tr, sp_v_, get_ptr(m->vf), sp_r_, get_ptr(m->rf),
+                        get_ptr(m->betaf), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->wf));
+        std::copy(m->xf.begin(), m->xf.end(), y);
+      });
+    } else if (refine_>0) {
+      refine(A, x, nrhs, tr, refine_, get_ptr(m->b), get_ptr(m->res), [&](double* y) {
+        casadi_qr_solve(y, 1, tr, sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
+                        get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->w));
+      });
+    } else if (nrhs==1) {
+      casadi_qr_solve(x, nrhs, tr,
+                      sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
+                      get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->w));
+    } else {
+      casadi_qr_solve_block(x, nrhs, tr,
+                            sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
+                            get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->w),
+                            nrhs_block);
+    }
     return 0;
   }
 
@@ -174,10 +268,11 @@ namespace casadi {
     // Place in block to avoid conflicts caused by local variables
     g << "{\n";
     g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
+    casadi_int nb = std::min(nrhs, nrhs_block);
     g << "casadi_real v[" << sp_v_.nnz() << "], "
          "r[" << sp_r_.nnz() << "], "
          "beta[" << ncol() << "], "
-         "w[" << nrow() + ncol() << "];\n";
+         "w[" << std::max(nrow() + ncol(), sz_w_block(nb)) << "];\n";
 
     if (n_cache_) {
       g << "casadi_real *c;\n";
@@ -211,14 +306,19 @@ namespace casadi {
     }
 
     // Solve
-    g << g.qr_solve(x, nrhs, tr, sp_v, "v", sp_r, "r", "beta", prinv, pc, "w") << "\n";
+    if (nb==1) {
+      g << g.qr_solve(x, nrhs, tr, sp_v, "v", sp_r, "r", "beta", prinv, pc, "w") << "\n";
+    } else {
+      g << g.qr_solve_block(x, nrhs, tr, sp_v, "v", sp_r, "r", "beta", prinv, pc, "w", nb)
+        << "\n";
+    }
 
     // End of block
     g << "}\n";
   }
 
   LinsolQr::LinsolQr(DeserializingStream& s) : LinsolInternal(s) {
-    int version = s.version("LinsolQr", 1, 2);
+    int version = s.version("LinsolQr", 1, 3);
     s.unpack("LinsolQr::prinv", prinv_);
     s.unpack("LinsolQr::pc", pc_);
     s.unpack("LinsolQr::sp_v", sp_v_);
@@ -229,17 +329,26 @@ namespace casadi {
     } else {
       n_cache_ = 1;
     }
+    if (version>2) {
+      s.unpack("LinsolQr::mixed", mixed_);
+      s.unpack("LinsolQr::refine", refine_);
+    } else {
+      mixed_ = false;
+      refine_ = 0;
+    }
   }
 
   void LinsolQr::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("LinsolQr", 2);
+    s.version("LinsolQr", 3);
     s.pack("LinsolQr::prinv", prinv_);
     s.pack("LinsolQr::pc", pc_);
     s.pack("LinsolQr::sp_v", sp_v_);
     s.pack("LinsolQr::sp_r", sp_r_);
     s.pack("LinsolQr::eps", eps_);
     s.pack("LinsolQr::n_cache", n_cache_);
+    s.pack("LinsolQr::mixed", mixed_);
+    s.pack("LinsolQr::refine", refine_);
   }
 
 } // namespace casadi
@@ -46,6 +46,18 @@ namespace casadi {
 
     // Cache locations sorted by access time
     std::vector<int> cache_loc;
+
+    // Single precision factorization
+    std::vector<float> af, vf, rf, betaf, wf, xf;
+
+    // Iterative refinement
+    std::vector<double> b, res;
+  };
+
+  /// Symbolic factorization, shared between instances
+  struct LinsolQrSymbolic {
+    std::vector<casadi_int> prinv, pc;
+    Sparsity sp_v, sp_r;
   };
 
   /** \brief \pluginbrief{LinsolInternal,qr}
@@ -90,6 +102,13 @@ namespace casadi {
     // Symbolic factorization
     int nfact(void* mem, const double* A) const override;
 
+    // Numeric factorization in the precision of T1, with singularity check
+    template<typename T1>
+    int factorize(const T1* A, T1* w, T1* v, T1* r, T1* beta) const;
+
+    // Work vector size for casadi_qr_solve_block
+    casadi_int sz_w_block(casadi_int nb) const;
+
     // Factorize the linear system
     int sfact(void* mem, const double* A) const override;
 
@@ -114,6 +133,13 @@ namespace casadi {
     Sparsity sp_v_, sp_r_;
     double eps_;
 
+    // Fill-reducing column ordering
+    std::string ordering_;
+
+    // Precision
+    bool mixed_;
+    casadi_int refine_;
+
     /// Cache size
     casadi_int n_cache_;
     casadi_int cache_stride_;
@@ -37,6 +37,7 @@ namespace casadi {
     plugin->doc = LinsolTridiag::meta_doc.c_str();
     plugin->version = CASADI_VERSION;
     plugin->options = &LinsolTridiag::options_;
+    plugin->deserialize = &LinsolTridiag::deserialize;
     return 0;
   }
 
@@ -53,9 +54,67 @@ namespace casadi {
     clear_mem();
   }
 
+  const Options LinsolTridiag::options_
+  = {{&ProtoFunction::options_},
+     {{"block_size",
+       {OT_INT,
+        "Size of the dense blocks of a block tridiagonal matrix [1]"}},
+      {"algorithm",
+       {OT_STRING,
+        "'thomas' (sequential elimination) or 'cyclic_reduction' (odd-even reduction, "
+        "with independent eliminations within each of the log2 levels, "
+        "better suited for long systems) [thomas]"}}
+     }
+  };
+
   void LinsolTridiag::init(const Dict& opts) {
     // Call the init method of the base class
     LinsolInternal::init(opts);
+
+    // Default options
+    block_size_ = 1;
+    std::string algorithm = "thomas";
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="block_size") {
+        block_size_ = op.second;
+      } else if (op.first=="algorithm") {
+        algorithm = op.second.to_string();
+      }
+    }
+    casadi_assert(algorithm=="thomas" || algorithm=="cyclic_reduction",
+                  "Unknown algorithm '" + algorithm + "', expected 'thomas' or 'cyclic_reduction'");
+    cyclic_reduction_ = algorithm=="cyclic_reduction";
+    casadi_assert(block_size_>=1, "'block_size' must be positive");
+    casadi_assert(nrow()%block_size_==0,
+                  "Dimension " + str(nrow()) + " not a multiple of block size " + str(block_size_));
+
+    init_map();
+  }
+
+  void LinsolTridiag::init_map() {
+    casadi_int b = block_size_, b2 = b*b, nb = n_blk();
+    const casadi_int *colind = sp_.colind(), *row = sp_.row();
+    map_.resize(sp_.nnz());
+    map_tr_.resize(sp_.nnz());
+    // Position of entry (r, c) in block storage
+    auto pos = [&](casadi_int r, casadi_int c) {
+      casadi_int br = r/b, bc = c/b, off = r%b + (c%b)*b;
+      casadi_assert(bc>=br-1 && bc<=br+1, "Entry (" + str(r) + ", " + str(c) + ") outside "
+                    "the block tridiagonal band with block size " + str(b));
+      return (bc==br ? 0 : bc<br ? nb : 2*nb)*b2 + br*b2 + off;
+    };
+    for (casadi_int c=0; c<ncol(); ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        map_[k] = pos(row[k], c);
+        map_tr_[k] = pos(c, row[k]);
+      }
+    }
+  }
+
+  casadi_int LinsolTridiag::sz_f() const {
+    return (cyclic_reduction_ ? 5 : 3)*n_blk()*block_size_*block_size_;
   }
 
   int LinsolTridiag::init_mem(void* mem) const {
@@ -63,9 +122,11 @@ namespace casadi {
     auto m = static_cast<LinsolTridiagMemory*>(mem);
 
     // Memory for numerical solution
-    m->c.resize(nrow());
-    m->ctr.resize(nrow());
-    m->d.resize(nrow());
+    m->f.resize(sz_f());
+    m->ftr.resize(sz_f());
+    m->p.resize(nrow());
+    m->ptr.resize(nrow());
+    m->w.resize(block_size_*block_size_);
     return 0;
   }
 
@@ -75,82 +136,76 @@ namespace casadi {
 
   int LinsolTridiag::nfact(void* mem, const double* A) const {
     auto m = static_cast<LinsolTridiagMemory*>(mem);
-    m->have_c = false;
-    m->have_ctr = false;
+    m->have_f = false;
+    m->have_ftr = false;
     return 0;
   }
 
   int LinsolTridiag::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LinsolTridiagMemory*>(mem);
-    casadi_int i, k;
-    const casadi_int *a_colind;
-    // Extract sparsity
-    a_colind = sp_ + 2;
-    // Precompute cacheable coefficients
-    if (tr) {
-      if (!m->have_ctr) {
-        // Precompute coefficients (transposed matrix)
-        m->ctr[0] = A[a_colind[0] + 1] / A[a_colind[0] + 0];
-        for (i = 1; i < nrow(); i++) {
-          // A[i + 1, i] / (A[i, i] - A[i - 1, i] * m->ctr[i - 1]);
-          double denom = A[a_colind[i] + 1] - A[a_colind[i] + 0] * m->ctr[i - 1];
-          m->ctr[i] = A[a_colind[i] + 2] / denom;
-        }
-        m->have_ctr = true;
-      }
-    } else {
-      if (!m->have_c) {
-        // Precompute coefficients
-        m->c[0] = A[a_colind[1] + 0] / A[a_colind[0] + 0];
-        double denom = A[a_colind[1] + 1] - A[a_colind[1 - 1] + 1] * m->c[1 - 1];
-        m->c[1] = A[a_colind[1 + 1] + 0] / denom;
-        for (i = 2; i < nrow(); i++) {
-          // A[i, i + 1] / (A[i, i] - A[i, i - 1] * m->c[i - 1]);
-          double denom = A[a_colind[i] + 1] - A[a_colind[i - 1] + 2] * m->c[i - 1];
-          m->c[i] = A[a_colind[i + 1] + 0] / denom;
-        }
-        m->have_c = true;
-      }
-    }
-    // Compute
-    for (k = 0; k < nrhs; k++) {
-      if (tr) {
-        // Compute remaining coefficients (transposed matrix)
-        m->d[0] = x[0] / A[a_colind[0] + 0];
-        for (i = 1; i < nrow(); i++) {
-          //m->d[i] = (x[i] - A[i - 1, i] * m->d[i - 1]) / (A[i, i] - A[i - 1, i] * m->c[i - 1]);
-          double denom = A[a_colind[i] + 1] - A[a_colind[i] + 0] * m->ctr[i - 1];
-          m->d[i] = (x[i] - A[a_colind[i] + 0] * m->d[i - 1]) / denom;
-        }
-        // Solve
-        x[nrow() - 1] = m->d[nrow() - 1];
-        for (i = nrow() - 2; i >= 0; i--) {
-          x[i] = m->d[i] - m->ctr[i] * x[i + 1];
-        }
+    casadi_int b = block_size_, nb = n_blk();
+    // Factorize A or its transpose on first use
+    bool& have = tr ? m->have_ftr : m->have_f;
+    double* f = get_ptr(tr ? m->ftr : m->f);
+    casadi_int* p = get_ptr(tr ? m->ptr : m->p);
+    if (!have) {
+      casadi_tridiag_scatter(A, sp_.nnz(), get_ptr(tr ? map_tr_ : map_), nb, b, f);
+      if (cyclic_reduction_) {
+        casadi_tridiag_cr(f, p, nb, b, get_ptr(m->w));
       } else {
-        // Compute remaining coefficients
-        m->d[0] = x[0] / A[a_colind[0] + 0];
-        double denom = A[a_colind[1] + 1] - A[a_colind[1 - 1] + 1] * m->c[1 - 1];
-        m->d[1] = (x[1] - A[a_colind[1 - 1] + 1] * m->d[1 - 1]) / denom;
-        for (i = 2; i < nrow(); i++) {
-          //m->d[i] = (x[i] - A[i, i - 1] * m->d[i - 1]) / (A[i, i] - A[i, i - 1] * m->c[i - 1]);
-          double denom = A[a_colind[i] + 1] - A[a_colind[i - 1] + 2] * m->c[i - 1];
-          m->d[i] = (x[i] - A[a_colind[i - 1] + 2] * m->d[i - 1]) / denom;
-        }
-        // Solve
-        x[nrow() - 1] = m->d[nrow() - 1];
-        for (i = nrow() - 2; i >= 0; i--) {
-          x[i] = m->d[i] - m->c[i] * x[i + 1];
-        }
+        casadi_tridiag_thomas(f, p, nb, b);
       }
-      x += ncol();
+      have = true;
+    }
+    // Solve
+    if (cyclic_reduction_) {
+      casadi_tridiag_cr_solve(f, p, nb, b, x, nrhs, get_ptr(m->w));
+    } else {
+      casadi_tridiag_thomas_solve(f, p, nb, b, x, nrhs);
     }
     return 0;
   }
 
   void LinsolTridiag::generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const {
-    casadi_error("Not implemented");
+    g.add_auxiliary(CodeGenerator::AUX_TRIDIAG);
+    casadi_int b = block_size_, nb = n_blk();
+    std::string map = g.constant(tr ? map_tr_ : map_);
+
+    // Place in block to avoid conflicts caused by local variables
+    g << "{\n";
+    g << "casadi_real f[" << sz_f() << "], w[" << b*b << "];\n";
+    g << "casadi_int p[" << nrow() << "];\n";
+
+    // Factorize
+    g << "casadi_tridiag_scatter(" << A << ", " << sp_.nnz() << ", " << map << ", "
+      << nb << ", " << b << ", f);\n";
+    if (cyclic_reduction_) {
+      g << "casadi_tridiag_cr(f, p, " << nb << ", " << b << ", w);\n";
+      g << "casadi_tridiag_cr_solve(f, p, " << nb << ", " << b << ", " << x << ", "
+        << nrhs << ", w);\n";
+    } else {
+      g << "casadi_tridiag_thomas(f, p, " << nb << ", " << b << ");\n";
+      g << "casadi_tridiag_thomas_solve(f, p, " << nb << ", " << b << ", " << x << ", "
+        << nrhs << ");\n";
+    }
+
+    // End of block
+    g << "}\n";
+  }
+
+  LinsolTridiag::LinsolTridiag(DeserializingStream& s) : LinsolInternal(s) {
+    s.version("LinsolTridiag", 1);
+    s.unpack("LinsolTridiag::block_size", block_size_);
+    s.unpack("LinsolTridiag::cyclic_reduction", cyclic_reduction_);
+    init_map();
+  }
+
+  void LinsolTridiag::serialize_body(SerializingStream &s) const {
+    LinsolInternal::serialize_body(s);
+    s.version("LinsolTridiag", 1);
+    s.pack("LinsolTridiag::block_size", block_size_);
+    s.pack("LinsolTridiag::cyclic_reduction", cyclic_reduction_);
   }
 
 } // namespace casadi
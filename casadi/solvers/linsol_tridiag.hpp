@@ -30,7 +30,8 @@
 /** \defgroup plugin_Linsol_tridiag Title
     \par
 
-  * Linear solver for tridiagonal matrices
+  * Linear solver for tridiagonal and block tridiagonal matrices, using the
+  * (block) Thomas algorithm or (block) cyclic reduction
 
     \identifier{22v} */
 
@@ -42,8 +43,10 @@
 
 namespace casadi {
   struct CASADI_LINSOL_TRIDIAG_EXPORT LinsolTridiagMemory : public LinsolMemory {
-    bool have_c, have_ctr;
-    std::vector<double> c, ctr, d;
+    // Factorization of A and of its transpose, computed on demand
+    bool have_f, have_ftr;
+    std::vector<double> f, ftr, w;
+    std::vector<casadi_int> p, ptr;
   };
 
   /** \brief \pluginbrief{LinsolInternal,tridiag}
@@ -64,6 +67,12 @@ namespace casadi {
     // Destructor
     ~LinsolTridiag() override;
 
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
     // Initialize the solver
     void init(const Dict& opts) override;
 
@@ -97,6 +106,35 @@ namespace casadi {
 
     /// A documentation string
     static const std::string meta_doc;
+
+    // Size of the dense blocks
+    casadi_int block_size_;
+
+    // Cyclic reduction instead of the Thomas algorithm
+    bool cyclic_reduction_;
+
+    // Position of each nonzero of A in block storage, for A and for its transpose
+    std::vector<casadi_int> map_, map_tr_;
+
+    // Number of block rows
+    casadi_int n_blk() const { return nrow()/block_size_;}
+
+    // Length of the factorization storage
+    casadi_int sz_f() const;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new LinsolTridiag(s); }
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit LinsolTridiag(DeserializingStream& s);
+
+  private:
+    // Map the nonzeros of A to block storage
+    void init_map();
   };
 
 } // namespace casadi
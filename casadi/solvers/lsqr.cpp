@@ -24,6 +24,7 @@
 
 
 #include "lsqr.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 #ifdef WITH_DL
 #include <cstdlib>
@@ -56,13 +57,131 @@ namespace casadi {
     clear_mem();
   }
 
+  const Options Lsqr::options_
+  = {{&ProtoFunction::options_},
+     {{"method",
+       {OT_STRING,
+        "'lsqr' or 'lsmr', with a monotonically decreasing normal equation residual [lsqr]"}},
+      {"preconditioner",
+       {OT_STRING,
+        "Right preconditioner: 'none', 'diagonal' (column scaling), "
+        "'ichol' (incomplete Cholesky factorization of A'*A, without fill-in) or "
+        "'function' (see preconditioner_function) [none]"}},
+      {"preconditioner_function",
+       {OT_FUNCTION,
+        "Function mapping the nonzeros of A to a sparse matrix P approximating "
+        "the inverse of A, used as x = P*y. Its transpose is used for transposed solves"}},
+      {"warm_start",
+       {OT_BOOL,
+        "Use the solution of the previous call as the initial guess. "
+        "Not used in generated code [false]"}},
+      {"parallel",
+       {OT_BOOL,
+        "Distribute the right-hand-sides over the thread pool. "
+        "Not used in generated code [false]"}}
+     }
+  };
+
+  void Lsqr::init(const Dict& opts) {
+    // Call the init method of the base class
+    LinsolInternal::init(opts);
+
+    // Default options
+    std::string method = "lsqr", preconditioner = "none";
+    warm_start_ = false;
+    parallel_ = false;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="method") {
+        method = op.second.to_string();
+      } else if (op.first=="preconditioner") {
+        preconditioner = op.second.to_string();
+      } else if (op.first=="preconditioner_function") {
+        prec_fcn_ = op.second;
+      } else if (op.first=="warm_start") {
+        warm_start_ = op.second;
+      } else if (op.first=="parallel") {
+        parallel_ = op.second;
+      }
+    }
+
+    casadi_assert(method=="lsqr" || method=="lsmr",
+                  "Unknown method '" + method + "', expected 'lsqr' or 'lsmr'");
+    lsmr_ = method=="lsmr";
+    if (preconditioner=="none") {
+      prec_ = 0;
+    } else if (preconditioner=="diagonal") {
+      prec_ = 1;
+    } else if (preconditioner=="ichol") {
+      prec_ = 2;
+    } else if (preconditioner=="function") {
+      prec_ = 3;
+    } else {
+      casadi_error("Unknown preconditioner '" + preconditioner + "', "
+                   "expected 'none', 'diagonal', 'ichol' or 'function'");
+    }
+    if (prec_==3) {
+      casadi_assert(!prec_fcn_.is_null(),
+                    "Preconditioner 'function' requires 'preconditioner_function'");
+      casadi_assert(prec_fcn_.n_in()==1 && prec_fcn_.n_out()==1,
+                    "'preconditioner_function' must have one input and one output");
+      casadi_assert(prec_fcn_.nnz_in(0)==sp_.nnz(),
+                    "'preconditioner_function' input must match the nonzeros of A");
+      casadi_assert(prec_fcn_.size1_out(0)==ncol() && prec_fcn_.size2_out(0)==ncol(),
+                    "'preconditioner_function' output must be " + str(ncol()) + "-by-"
+                    + str(ncol()));
+    }
+
+    init_prec();
+  }
+
+  void Lsqr::init_prec() {
+    for (casadi_int tr=0; tr<2; ++tr) {
+      if (prec_==1 || prec_==2) sp_b_[tr] = tr ? sp_.T() : sp_;
+      if (prec_==2) {
+        sp_btb_[tr] = Sparsity::mtimes(sp_b_[tr].T(), sp_b_[tr]) + Sparsity::diag(ncol());
+        sp_lt_[tr] = triu(sp_btb_[tr], false);
+        sp_r_[tr] = sp_lt_[tr] + Sparsity::diag(ncol());
+      }
+      casadi_lsqr_prob<double>& p = p_[tr];
+      p.sp = sp_;
+      p.lsmr = lsmr_;
+      p.prec = prec_;
+      p.sp_b = prec_==1 || prec_==2 ? static_cast<const casadi_int*>(sp_b_[tr]) : nullptr;
+      p.sp_btb = prec_==2 ? static_cast<const casadi_int*>(sp_btb_[tr]) : nullptr;
+      p.sp_lt = prec_==2 ? static_cast<const casadi_int*>(sp_lt_[tr]) : nullptr;
+      p.sp_r = prec_==2 ? static_cast<const casadi_int*>(sp_r_[tr]) : nullptr;
+      p.sp_p = prec_==3 ? static_cast<const casadi_int*>(prec_fcn_.sparsity_out(0)) : nullptr;
+    }
+  }
+
+  casadi_int Lsqr::sz_w_setup(bool tr) const {
+    if (prec_!=2) return nrow();
+    return sp_.nnz() + sp_btb_[tr].nnz() + sp_lt_[tr].nnz() + 2*ncol();
+  }
+
   int Lsqr::init_mem(void* mem) const {
     if (LinsolInternal::init_mem(mem)) return 1;
     auto m = static_cast<LsqrMemory*>(mem);
 
-    // Temporary storage
-    m->w.resize(nrow()+4*ncol());
+    // Temporary storage, for each right-hand-side solved concurrently
+    casadi_int n_slot = parallel_ ? ThreadPool::requested_size() : 1;
+    m->w.resize(std::max(sz_w()*n_slot, std::max(sz_w_setup(false), sz_w_setup(true))));
+    m->iw.resize(ncol());
     m->A.resize(sp_.nnz());
+
+    // Preconditioner
+    for (casadi_int tr=0; tr<2; ++tr) {
+      m->pr[tr].resize(prec_==1 ? ncol() : prec_==2 ? sp_r_[tr].nnz() : 0);
+    }
+    if (prec_==3) {
+      m->pr[0].resize(prec_fcn_.nnz_out(0));
+      m->arg.resize(prec_fcn_.sz_arg());
+      m->res.resize(prec_fcn_.sz_res());
+      m->iw_fcn.resize(prec_fcn_.sz_iw());
+      m->w_fcn.resize(prec_fcn_.sz_w());
+    }
     return 0;
   }
 
@@ -70,30 +189,134 @@ namespace casadi {
     auto m = static_cast<LsqrMemory*>(mem);
 
     std::copy(A, A+m->A.size(), get_ptr(m->A));
+    m->have_pr[0] = m->have_pr[1] = false;
+
+    // Evaluate the preconditioner function
+    if (prec_==3) {
+      m->arg[0] = A;
+      m->res[0] = get_ptr(m->pr[0]);
+      if (prec_fcn_(get_ptr(m->arg), get_ptr(m->res), get_ptr(m->iw_fcn), get_ptr(m->w_fcn))) {
+        return 1;
+      }
+    }
     return 0;
   }
 
+  void Lsqr::add_dependency(CodeGenerator& g) const {
+    if (prec_==3) g.add_dependency(prec_fcn_);
+  }
+
   void Lsqr::generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const {
-    // Codegen the integer vectors
-    std::string sp = g.sparsity(sp_);
+    const casadi_lsqr_prob<double>& p = p_[tr];
 
-        // Place in block to avoid conflicts caused by local variables
+    // Place in block to avoid conflicts caused by local variables
     g << "{\n";
     g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
-    g << "casadi_real w[" << nrow() + 4*ncol() << "];\n";
+    g << "struct casadi_lsqr_prob p;\n";
+    g << "casadi_real w[" << std::max(sz_w(), sz_w_setup(tr)) << "];\n";
+    g << "p.sp = " << g.sparsity(sp_) << ";\n";
+    g << "p.lsmr = " << p.lsmr << ";\n";
+    g << "p.prec = " << p.prec << ";\n";
+    if (prec_==1 || prec_==2) {
+      g << "p.sp_b = " << g.sparsity(sp_b_[tr]) << ";\n";
+    }
+    if (prec_==2) {
+      g << "p.sp_btb = " << g.sparsity(sp_btb_[tr]) << ";\n";
+      g << "p.sp_lt = " << g.sparsity(sp_lt_[tr]) << ";\n";
+      g << "p.sp_r = " << g.sparsity(sp_r_[tr]) << ";\n";
+    }
+
+    // Preconditioner
+    std::string pr = "0";
+    if (prec_==1 || prec_==2) {
+      casadi_int sz_pr = prec_==1 ? ncol() : sp_r_[tr].nnz();
+      g << "casadi_real pr[" << sz_pr << "];\n";
+      g << "casadi_int iw[" << ncol() << "];\n";
+      g << "casadi_lsqr_prec_setup(&p, " << A << ", " << tr << ", pr, iw, w);\n";
+      pr = "pr";
+    } else if (prec_==3) {
+      g << "p.sp_p = " << g.sparsity(prec_fcn_.sparsity_out(0)) << ";\n";
+      g << "casadi_real pr[" << prec_fcn_.nnz_out(0) << "];\n";
+      g << "const casadi_real* arg_p[" << std::max(prec_fcn_.sz_arg(), size_t(1)) << "];\n";
+      g << "casadi_real* res_p[" << std::max(prec_fcn_.sz_res(), size_t(1)) << "];\n";
+      g << "casadi_int iw_p[" << std::max(prec_fcn_.sz_iw(), size_t(1)) << "];\n";
+      g << "casadi_real w_p[" << std::max(prec_fcn_.sz_w(), size_t(1)) << "];\n";
+      g << "arg_p[0] = " << A << ";\n";
+      g << "res_p[0] = pr;\n";
+      g << "if (" << g(prec_fcn_, "arg_p", "res_p", "iw_p", "w_p") << ") return 1;\n";
+      pr = "pr";
+    }
 
     // Solve
-    g << g.lsqr_solve(A, x, nrhs, tr, sp, "w") << "\n";
+    g << g.lsqr_solve("&p", A, x, nrhs, tr, pr, "0", "w") << "\n";
 
     // End of block
     g << "}\n";
-
   }
 
   int Lsqr::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LsqrMemory*>(mem);
-    return casadi_lsqr_solve(A, x, nrhs, tr, sp_, get_ptr(m->w));
+    const casadi_lsqr_prob<double>* p = &p_[tr];
+
+    // Preconditioner for A or for its transpose
+    const double* pr = nullptr;
+    if (prec_==1 || prec_==2) {
+      if (!m->have_pr[tr]) {
+        casadi_lsqr_prec_setup(p, A, tr, get_ptr(m->pr[tr]), get_ptr(m->iw), get_ptr(m->w));
+        m->have_pr[tr] = true;
+      }
+      pr = get_ptr(m->pr[tr]);
+    } else if (prec_==3) {
+      pr = get_ptr(m->pr[0]);
+    }
+
+    // Initial guess from the previous call with the same number of right-hand-sides
+    std::vector<double>& x0 = m->x0[tr];
+    const double* x0_ptr = warm_start_ && x0.size()==ncol()*nrhs ? get_ptr(x0) : nullptr;
+
+    // Solve, distributing the right-hand-sides over the thread pool
+    casadi_int n_task = 1;
+    if (parallel_) n_task = std::min(std::min(nrhs, ThreadPool::instance().size()),
+                                     static_cast<casadi_int>(m->w.size()/sz_w()));
+    std::vector<int> flag(n_task, 0);
+    auto task = [&](casadi_int t) {
+      double* w = get_ptr(m->w) + t*sz_w();
+      for (casadi_int k=t; k<nrhs; k+=n_task) {
+        if (casadi_lsqr_solve(p, A, x+k*ncol(), 1, tr, pr,
+                              x0_ptr ? x0_ptr+k*ncol() : nullptr, w)) flag[t] = 1;
+      }
+    };
+    if (n_task>1) {
+      ThreadPool::instance().run(n_task, task);
+    } else {
+      task(0);
+    }
+    for (int f : flag) if (f) return 1;
+
+    // Store for warm starting
+    if (warm_start_) x0.assign(x, x+ncol()*nrhs);
+    return 0;
+  }
+
+  Lsqr::Lsqr(DeserializingStream& s) : LinsolInternal(s) {
+    s.version("Lsqr", 1);
+    s.unpack("Lsqr::lsmr", lsmr_);
+    s.unpack("Lsqr::prec", prec_);
+    s.unpack("Lsqr::prec_fcn", prec_fcn_);
+    s.unpack("Lsqr::warm_start", warm_start_);
+    s.unpack("Lsqr::parallel", parallel_);
+    init_prec();
+  }
+
+  void Lsqr::serialize_body(SerializingStream &s) const {
+    LinsolInternal::serialize_body(s);
+    s.version("Lsqr", 1);
+    s.pack("Lsqr::lsmr", lsmr_);
+    s.pack("Lsqr::prec", prec_);
+    s.pack("Lsqr::prec_fcn", prec_fcn_);
+    s.pack("Lsqr::warm_start", warm_start_);
+    s.pack("Lsqr::parallel", parallel_);
   }
 
 } // namespace casadi
@@ -32,7 +32,8 @@
 /** \defgroup plugin_Linsol_symbolicqr Title
     \par
 
-    Linear solver for sparse least-squares problems
+    Linear solver for sparse least-squares problems, using LSQR or LSMR
+    with optional right preconditioning
     Inspired from https://github.com/scipy/scipy/blob/v0.14.0/scipy/sparse/linalg/isolve/lsqr.py#L96
 
     \identifier{230} */
@@ -50,6 +51,19 @@ namespace casadi {
     std::vector<double> w;
 
     std::vector<double> A;
+
+    // Preconditioner for A and for its transpose
+    bool have_pr[2];
+    std::vector<double> pr[2];
+    std::vector<casadi_int> iw;
+
+    // Solution of the previous call with A and with its transpose, for warm starting
+    std::vector<double> x0[2];
+
+    // Preconditioner function evaluation
+    std::vector<double*> res;
+    std::vector<casadi_int> iw_fcn;
+    std::vector<double> w_fcn;
   };
 
   /** \brief \pluginbrief{Linsol,symbolicqr}
@@ -67,6 +81,15 @@ namespace casadi {
     // Destructor
     ~Lsqr() override;
 
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
     // Get name of the plugin
     const char* plugin_name() const override { return "lsqr";}
 
@@ -97,15 +120,52 @@ namespace casadi {
     void generate(CodeGenerator& g, const std::string& A, const std::string& x,
                   casadi_int nrhs, bool tr) const override;
 
+    /// Add the preconditioner function to the generated code
+    void add_dependency(CodeGenerator& g) const override;
+
     /// A documentation string
     static const std::string meta_doc;
 
+    // LSMR instead of LSQR
+    bool lsmr_;
+
+    // Preconditioner: 0 none, 1 diagonal, 2 incomplete Cholesky, 3 function
+    casadi_int prec_;
+
+    // Function mapping the nonzeros of A to a preconditioner matrix
+    Function prec_fcn_;
+
+    // Use the solution of the previous call as initial guess
+    bool warm_start_;
+
+    // Distribute right-hand-sides over the thread pool
+    bool parallel_;
+
+    // Sparsity of op(A), op(A)'*op(A) and its incomplete factors, for A and its transpose
+    Sparsity sp_b_[2], sp_btb_[2], sp_lt_[2], sp_r_[2];
+
+    // Problem structure for A and its transpose
+    casadi_lsqr_prob<double> p_[2];
+
+    // Length of the work vector of a single solve
+    casadi_int sz_w() const { return nrow() + 6*ncol();}
+
+    // Length of the work vector of the preconditioner setup
+    casadi_int sz_w_setup(bool tr) const;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
     /** \brief Deserialize with type disambiguation */
     static ProtoFunction* deserialize(DeserializingStream& s) { return new Lsqr(s); }
 
   protected:
     /** \brief Deserializing constructor */
-    explicit Lsqr(DeserializingStream& s) : LinsolInternal(s) {}
+    explicit Lsqr(DeserializingStream& s);
+
+  private:
+    // Sparsity patterns and problem structures of the preconditioner
+    void init_prec();
   };
 
 } // namespace casadi
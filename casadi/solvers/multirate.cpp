@@ -0,0 +1,211 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "multirate.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTEGRATOR_MULTIRATE_EXPORT
+      casadi_register_integrator_multirate(Integrator::Plugin* plugin) {
+    plugin->creator = Multirate::creator;
+    plugin->name = "multirate";
+    plugin->doc = Multirate::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Multirate::options_;
+    plugin->deserialize = &Multirate::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTEGRATOR_MULTIRATE_EXPORT casadi_load_integrator_multirate() {
+    Integrator::registerPlugin(casadi_register_integrator_multirate);
+  }
+
+  Multirate::Multirate(const std::string& name, const Function& dae, double t0,
+      const std::vector<double>& tout)
+      : FixedStepIntegrator(name, dae, t0, tout) {
+  }
+
+  Multirate::~Multirate() {
+  }
+
+  const Options Multirate::options_
+  = {{&FixedStepIntegrator::options_},
+     {{"fast_states",
+       {OT_INTVECTOR,
+        "Indices of the fast differential states, e.g. the positions of the fast "
+        "variables in DaeBuilder::x()"}},
+      {"substeps",
+       {OT_INT,
+        "Number of substeps of the fast states per finite element, must be even [default: 4]"}}
+     }
+  };
+
+  void Multirate::init(const Dict& opts) {
+    // Default options
+    substeps_ = 4;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="fast_states") {
+        fast_ = op.second;
+      } else if (op.first=="substeps") {
+        substeps_ = op.second;
+      }
+    }
+
+    // Consistency checks
+    casadi_assert(substeps_ > 0 && substeps_ % 2 == 0,
+      "Number of substeps must be positive and even");
+
+    // Remaining states are slow
+    std::vector<bool> is_fast(oracle_.nnz_in(DYN_X), false);
+    for (casadi_int i : fast_) {
+      casadi_assert(i >= 0 && i < is_fast.size() && !is_fast[i],
+        "Fast states must be distinct indices into x");
+      is_fast[i] = true;
+    }
+    slow_.clear();
+    for (casadi_int i = 0; i < is_fast.size(); ++i) if (!is_fast[i]) slow_.push_back(i);
+
+    // Call the base class init
+    FixedStepIntegrator::init(opts);
+
+    // Algebraic variables not supported
+    casadi_assert(nz_==0 && nrz_==0,
+      "Multirate integrators do not support algebraic variables");
+  }
+
+  template<typename XType>
+  static Function ode_rows(const std::string& name, const Function& f,
+      const std::vector<casadi_int>& rows, bool with_quad) {
+    std::vector<XType> arg = XType::get_input(f);
+    std::vector<XType> res = f(arg);
+    std::vector<XType> ret = {res[DYN_ODE](rows)};
+    if (with_quad) ret.push_back(res[DYN_QUAD]);
+    return Function(name, {arg[DYN_T], arg[DYN_X], arg[DYN_P], arg[DYN_U]}, ret);
+  }
+
+  void Multirate::setup_step() {
+    // Continuous-time dynamics, forward problem
+    Function f = get_function("dae");
+
+    // Separate right-hand sides for the fast and the slow states
+    bool sx = f.is_a("SXFunction");
+    Function f_fast = sx ? ode_rows<SX>("f_fast", f, fast_, false)
+      : ode_rows<MX>("f_fast", f, fast_, false);
+    Function f_slow = sx ? ode_rows<SX>("f_slow", f, slow_, true)
+      : ode_rows<MX>("f_slow", f, slow_, true);
+
+    // Symbolic inputs
+    MX t0 = MX::sym("t0", f.sparsity_in(DYN_T));
+    MX h = MX::sym("h");
+    MX x0 = MX::sym("x0", f.sparsity_in(DYN_X));
+    MX p = MX::sym("p", f.sparsity_in(DYN_P));
+    MX u = MX::sym("u", f.sparsity_in(DYN_U));
+
+    // Slow and fast parts of the state
+    MX xs0 = x0(slow_), xf0 = x0(fast_);
+    auto state = [&](const MX& xs, const MX& xf) {
+      MX x = MX::zeros(x0.sparsity());
+      if (!slow_.empty()) x(slow_) = xs;
+      if (!fast_.empty()) x(fast_) = xf;
+      return x;
+    };
+
+    // Slow derivative and quadrature rate at the start of the step
+    std::vector<MX> r = f_slow(std::vector<MX>{t0, x0, p, u});
+    MX k1 = r[0], k1q = r[1];
+
+    // Fast substeps, with the slow states extrapolated linearly
+    MX hf = h / substeps_;
+    MX xf = xf0, xf_mid;
+    auto fast_rhs = [&](const MX& t, const MX& xf) {
+      return f_fast(std::vector<MX>{t, state(xs0 + (t - t0) * k1, xf), p, u}).at(0);
+    };
+    for (casadi_int i = 0; i < substeps_; ++i) {
+      MX ti = t0 + i * hf;
+      MX l1 = fast_rhs(ti, xf);
+      MX l2 = fast_rhs(ti + hf / 2, xf + hf / 2 * l1);
+      MX l3 = fast_rhs(ti + hf / 2, xf + hf / 2 * l2);
+      MX l4 = fast_rhs(ti + hf, xf + hf * l3);
+      xf += hf / 6 * (l1 + 2 * l2 + 2 * l3 + l4);
+      if (2 * (i + 1) == substeps_) xf_mid = xf;
+    }
+
+    // Slow RK4 step, fast states from the substeps
+    r = f_slow(std::vector<MX>{t0 + h / 2, state(xs0 + h / 2 * k1, xf_mid), p, u});
+    MX k2 = r[0], k2q = r[1];
+    r = f_slow(std::vector<MX>{t0 + h / 2, state(xs0 + h / 2 * k2, xf_mid), p, u});
+    MX k3 = r[0], k3q = r[1];
+    r = f_slow(std::vector<MX>{t0 + h, state(xs0 + h * k3, xf), p, u});
+    MX k4 = r[0], k4q = r[1];
+    MX xsf = xs0 + h / 6 * (k1 + 2 * k2 + 2 * k3 + k4);
+    MX qf = h / 6 * (k1q + 2 * k2q + 2 * k3q + k4q);
+
+    // Define discrete time dynamics
+    std::vector<MX> F_in(STEP_NUM_IN), F_out(STEP_NUM_OUT);
+    F_in[STEP_T] = t0;
+    F_in[STEP_H] = h;
+    F_in[STEP_X0] = x0;
+    F_in[STEP_V0] = MX(0, 1);
+    F_in[STEP_P] = p;
+    F_in[STEP_U] = u;
+    F_out[STEP_XF] = state(xsf, xf);
+    F_out[STEP_QF] = qf;
+    F_out[STEP_VF] = MX(0, 1);
+    Function F("step", F_in, F_out,
+      {"t", "h", "x0", "v0", "p", "u"}, {"xf", "vf", "qf"});
+    set_function(F, F.name(), true);
+    if (nfwd_ > 0) create_forward("step", nfwd_);
+
+    // Backward integration
+    if (nadj_ > 0) {
+      Function adj_F = F.reverse(nadj_);
+      set_function(adj_F, adj_F.name(), true);
+      if (nfwd_ > 0) {
+        create_forward(adj_F.name(), nfwd_);
+      }
+    }
+  }
+
+  Multirate::Multirate(DeserializingStream& s) : FixedStepIntegrator(s) {
+    s.version("Multirate", 1);
+    s.unpack("Multirate::fast", fast_);
+    s.unpack("Multirate::slow", slow_);
+    s.unpack("Multirate::substeps", substeps_);
+  }
+
+  void Multirate::serialize_body(SerializingStream &s) const {
+    FixedStepIntegrator::serialize_body(s);
+    s.version("Multirate", 1);
+    s.pack("Multirate::fast", fast_);
+    s.pack("Multirate::slow", slow_);
+    s.pack("Multirate::substeps", substeps_);
+  }
+
+} // namespace casadi
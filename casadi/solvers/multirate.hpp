@@ -0,0 +1,111 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_MULTIRATE_HPP
+#define CASADI_MULTIRATE_HPP
+
+#include "casadi/core/integrator_impl.hpp"
+#include <casadi/solvers/casadi_integrator_multirate_export.h>
+
+/** \defgroup plugin_Integrator_multirate Title
+    \par
+
+      Fixed-step multirate explicit Runge-Kutta integrator for ODEs.
+
+      The differential states are partitioned into slow and fast states. The
+      slow states take one RK4 step per finite element, the fast states take
+      'substeps' RK4 substeps inside it. During the substeps, the slow states
+      are extrapolated linearly using their derivative at the start of the step.
+      The fast and slow parts of the right-hand side are evaluated separately.
+*/
+/** \pluginsection{Integrator,multirate} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief \pluginbrief{Integrator,multirate}
+
+      @copydoc plugin_Integrator_multirate
+  */
+  class CASADI_INTEGRATOR_MULTIRATE_EXPORT Multirate : public FixedStepIntegrator {
+   public:
+
+    /// Constructor
+    Multirate(const std::string& name, const Function& dae, double t0,
+      const std::vector<double>& tout);
+
+    /** \brief  Create a new integrator */
+    static Integrator* creator(const std::string& name, const Function& dae,
+        double t0, const std::vector<double>& tout) {
+      return new Multirate(name, dae, t0, tout);
+    }
+
+    /// Destructor
+    ~Multirate() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "multirate";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Multirate";}
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Initialize stage
+    void init(const Dict& opts) override;
+
+    /// Setup step functions
+    void setup_step() override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize into MX */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new Multirate(s); }
+
+    // Indices of the fast and of the slow differential states
+    std::vector<casadi_int> fast_, slow_;
+
+    // Number of substeps of the fast states per step
+    casadi_int substeps_;
+
+   protected:
+
+    /** \brief Deserializing constructor */
+    explicit Multirate(DeserializingStream& s);
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_MULTIRATE_HPP
@@ -0,0 +1,61 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+      #include "multirate.hpp"
+      #include <string>
+
+      const std::string casadi::Multirate::meta_doc=
+      "\n"
+"Fixed-step multirate explicit Runge-Kutta integrator for ODEs.\n"
+"\n"
+"The differential states are partitioned into slow and fast states.\n"
+"The slow states take one RK4 step per finite element, the fast states\n"
+"take 'substeps' RK4 substeps inside it. During the substeps, the slow\n"
+"states are extrapolated linearly using their derivative at the start\n"
+"of the step. The fast and slow parts of the right-hand side are\n"
+"evaluated separately.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"|       Id        |      Type       |     Default     |   Description   |\n"
+"+=================+=================+=================+=================+\n"
+"| fast_states     | OT_INTVECTOR    |                 | Indices of the  |\n"
+"|                 |                 |                 | fast            |\n"
+"|                 |                 |                 | differential    |\n"
+"|                 |                 |                 | states          |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| substeps        | OT_INT          | 4               | Number of       |\n"
+"|                 |                 |                 | substeps of the |\n"
+"|                 |                 |                 | fast states per |\n"
+"|                 |                 |                 | finite element  |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -24,6 +24,7 @@
 
 
 #include "newton.hpp"
+#include "casadi/core/thread_pool.hpp"
 #include <iomanip>
 
 namespace casadi {
@@ -69,7 +70,24 @@ namespace casadi {
         "Print information about each iteration"}},
       {"line_search",
        {OT_BOOL,
-        "Enable line-search (default: true)"}}
+        "Enable line-search (default: true)"}},
+      {"reuse_jacobian",
+       {OT_BOOL,
+        "Simplified Newton: reuse the factorized Jacobian across iterations and calls "
+        "while the convergence rate is acceptable (default: false)"}},
+      {"reuse_rate",
+       {OT_DOUBLE,
+        "Refactorize the Jacobian when a reused Jacobian decreases max(|F|) by less "
+        "than this factor (default: 0.5)"}},
+      {"broyden",
+       {OT_INT,
+        "Maximum number of Broyden rank-one updates of a reused Jacobian before it is "
+        "refactorized, implies reuse_jacobian (default: 0)"}},
+      {"block_triangular",
+       {OT_BOOL,
+        "Permute the Jacobian to block triangular form and solve the diagonal blocks "
+        "in sequence, each with its own Newton iterations and factorization. Independent "
+        "blocks are solved concurrently. No line-search (default: false)"}}
      }
   };
 
@@ -84,6 +102,12 @@ namespace casadi {
     abstolStep_ = 1e-12;
     print_iteration_ = false;
     line_search_ = true;
+    reuse_jacobian_ = false;
+    reuse_rate_ = 0.5;
+    broyden_ = 0;
+    block_triangular_ = false;
+    std::string linear_solver = "qr";
+    Dict linear_solver_options;
 
     // Read options
     for (auto&& op : opts) {
@@ -97,8 +121,23 @@ namespace casadi {
         print_iteration_ = op.second;
       } else if (op.first=="line_search") {
         line_search_ = op.second;
+      } else if (op.first=="reuse_jacobian") {
+        reuse_jacobian_ = op.second;
+      } else if (op.first=="reuse_rate") {
+        reuse_rate_ = op.second;
+      } else if (op.first=="broyden") {
+        broyden_ = op.second;
+      } else if (op.first=="block_triangular") {
+        block_triangular_ = op.second;
+      } else if (op.first=="linear_solver") {
+        linear_solver = op.second.to_string();
+      } else if (op.first=="linear_solver_options") {
+        linear_solver_options = op.second;
       }
     }
+    if (broyden_>0) reuse_jacobian_ = true;
+    casadi_assert(!(block_triangular_ && reuse_jacobian_),
+      "Options 'block_triangular' and 'reuse_jacobian' cannot be combined");
 
     casadi_assert(oracle_.n_in()>0,
                           "Newton: the supplied f must have at least one input.");
@@ -107,6 +146,15 @@ namespace casadi {
 
     set_function(oracle_, "g");
 
+    // Residual and Jacobian of the diagonal blocks
+    if (block_triangular_) {
+      if (oracle_.is_a("SXFunction")) {
+        init_blocks<SX>(linear_solver, linear_solver_options);
+      } else {
+        init_blocks<MX>(linear_solver, linear_solver_options);
+      }
+    }
+
 
     // Allocate memory
     alloc_w(n_, true); // x
@@ -114,6 +162,8 @@ namespace casadi {
     alloc_w(n_, true); // dx trial
     alloc_w(n_, true); // F trial
     alloc_w(sp_jac_.nnz(), true); // J
+    alloc_w(n_, true); // F previous
+    alloc_w(n_, true); // step previous
   }
 
  void Newton::set_work(void* mem, const double**& arg, double**& res,
@@ -125,19 +175,219 @@ namespace casadi {
      m->x_trial = w; w += n_;
      m->f_trial = w; w += n_;
      m->jac = w; w += sp_jac_.nnz();
+     m->f_prev = w; w += n_;
+     m->s_prev = w; w += n_;
+  }
+
+  template<typename XType>
+  void Newton::init_blocks(const std::string& linear_solver,
+      const Dict& linear_solver_options) {
+    // Block triangular form of the Jacobian
+    std::vector<casadi_int> rowperm, colperm, rowblock, colblock, coarse_rowblock, coarse_colblock;
+    casadi_int nb = sp_jac_.btf(rowperm, colperm, rowblock, colblock,
+                                coarse_rowblock, coarse_colblock);
+    blk_col_.resize(nb);
+    blk_row_.resize(nb);
+    std::vector<casadi_int> col_blk(n_);
+    for (casadi_int b=0; b<nb; ++b) {
+      blk_col_[b].assign(colperm.begin()+colblock[b], colperm.begin()+colblock[b+1]);
+      blk_row_[b].assign(rowperm.begin()+rowblock[b], rowperm.begin()+rowblock[b+1]);
+      casadi_assert_dev(blk_col_[b].size()==blk_row_[b].size());
+      for (casadi_int c : blk_col_[b]) col_blk[c] = b;
+    }
+
+    // A block depends on the blocks of the unknowns entering its equations
+    const casadi_int *colind = sp_jac_.colind(), *row = sp_jac_.row();
+    std::vector<casadi_int> row_blk(n_);
+    for (casadi_int b=0; b<nb; ++b) {
+      for (casadi_int r : blk_row_[b]) row_blk[r] = b;
+    }
+    std::vector<std::vector<casadi_int>> deps(nb);
+    for (casadi_int c=0; c<n_; ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        if (row_blk[row[k]]!=col_blk[c]) deps[row_blk[row[k]]].push_back(col_blk[c]);
+      }
+    }
+
+    // Level of each block: one more than the highest level of its dependencies
+    std::vector<casadi_int> level(nb, -1);
+    for (casadi_int b0=0; b0<nb; ++b0) {
+      std::vector<casadi_int> stack = {b0};
+      while (!stack.empty()) {
+        casadi_int b = stack.back();
+        if (level[b]>=0) {
+          stack.pop_back();
+          continue;
+        }
+        casadi_int lev = 0;
+        bool ready = true;
+        for (casadi_int d : deps[b]) {
+          if (level[d]<0) {
+            stack.push_back(d);
+            ready = false;
+          } else {
+            lev = std::max(lev, level[d]+1);
+          }
+        }
+        if (ready) {
+          level[b] = lev;
+          stack.pop_back();
+        }
+      }
+    }
+    blk_level_.clear();
+    for (casadi_int b=0; b<nb; ++b) {
+      if (level[b]>=static_cast<casadi_int>(blk_level_.size())) blk_level_.resize(level[b]+1);
+      blk_level_[level[b]].push_back(b);
+    }
+
+    // Inline the residual with the unknowns of each block as separate symbols
+    std::vector<XType> arg = XType::get_input(oracle_);
+    XType z = arg[iin_];
+    std::vector<casadi_int> inv_colperm(n_);
+    for (casadi_int b=0, k=0; b<nb; ++b) {
+      for (casadi_int c : blk_col_[b]) inv_colperm[c] = k++;
+    }
+    blk_fcn_.resize(nb);
+    blk_linsol_.resize(nb);
+    for (casadi_int b=0; b<nb; ++b) {
+      XType zb = XType::sym("z_" + str(b), blk_col_[b].size());
+      std::vector<XType> zperm(nb);
+      for (casadi_int c=0; c<nb; ++c) {
+        if (c==b) {
+          zperm[c] = zb;
+        } else {
+          z.get_nz(zperm[c], false, Matrix<casadi_int>(blk_col_[c]));
+        }
+      }
+      XType zfull;
+      vertcat(zperm).get_nz(zfull, false, Matrix<casadi_int>(inv_colperm));
+      std::vector<XType> arg_b = arg, res;
+      arg_b[iin_] = zfull;
+      oracle_.call(arg_b, res, true);
+      XType rb;
+      res.at(iout_).get_nz(rb, false, Matrix<casadi_int>(blk_row_[b]));
+      XType jb = XType::jacobian(rb, zb);
+      arg_b = arg;
+      arg_b.insert(arg_b.begin(), zb);
+      std::vector<std::string> name_in = oracle_.name_in();
+      name_in.insert(name_in.begin(), "z_" + str(b));
+      blk_fcn_[b] = Function(name_ + "_blk" + str(b), arg_b, {rb, jb},
+                             name_in, {"r", "jac"});
+      blk_linsol_[b] = Linsol(name_ + "_linsol" + str(b), linear_solver,
+                              jb.sparsity(), linear_solver_options);
+    }
+    if (verbose_) {
+      casadi_message("Block triangular form: " + str(nb) + " blocks in "
+                     + str(blk_level_.size()) + " levels");
+    }
+  }
+
+  void Newton::solve_block(NewtonMemory* m, casadi_int b) const {
+    NewtonBlockMemory& mb = m->blk[b];
+    casadi_int nb = blk_col_[b].size();
+    const Function& f = blk_fcn_[b];
+    const Linsol& linsol = blk_linsol_[b];
+
+    // Initial guess
+    for (casadi_int i=0; i<nb; ++i) mb.z[i] = m->x[blk_col_[b][i]];
+
+    // Other unknowns are read from x, which is not modified while the block is solved
+    mb.arg[0] = get_ptr(mb.z);
+    std::copy_n(m->iarg, n_in_, mb.arg.begin()+1);
+    mb.arg[1+iin_] = m->x;
+    mb.res[0] = get_ptr(mb.r);
+    mb.res[1] = get_ptr(mb.jac);
+
+    mb.success = false;
+    mb.n_fact = 0;
+    for (mb.iter=0; mb.iter<max_iter_; ) {
+      mb.iter++;
+      if (f(get_ptr(mb.arg), get_ptr(mb.res), get_ptr(mb.iw), get_ptr(mb.w), mb.mem_fcn)) {
+        return;
+      }
+
+      // Check convergence on residual
+      if (casadi_norm_inf(nb, get_ptr(mb.r)) <= abstol_) {
+        mb.success = true;
+        return;
+      }
+
+      // Newton step
+      linsol.nfact(get_ptr(mb.jac), mb.mem_linsol);
+      mb.n_fact++;
+      linsol.solve(get_ptr(mb.jac), get_ptr(mb.r), 1, false, mb.mem_linsol);
+      casadi_axpy(nb, -1., get_ptr(mb.r), get_ptr(mb.z));
+
+      // Check convergence on step
+      if (casadi_norm_inf(nb, get_ptr(mb.r)) <= abstolStep_) {
+        mb.success = true;
+        return;
+      }
+    }
+  }
+
+  void Newton::broyden_apply(NewtonMemory* m, double* v) const {
+    for (casadi_int i=0; i<m->n_broyden; ++i) {
+      double s_v = casadi_dot(n_, get_ptr(m->broyden_s)+i*n_, v);
+      casadi_axpy(n_, s_v, get_ptr(m->broyden_u)+i*n_, v);
+    }
   }
 
   int Newton::solve(void* mem) const {
     auto m = static_cast<NewtonMemory*>(mem);
 
-    scoped_checkout<Linsol> mem_linsol(linsol_);
+    // Linear solver memory, kept in the Newton memory if the Jacobian is reused
+    scoped_checkout<Linsol> mem_linsol_local(linsol_);
+    int mem_linsol = reuse_jacobian_ ? m->mem_linsol : static_cast<int>(mem_linsol_local);
+    double* jac = reuse_jacobian_ ? get_ptr(m->jac_fact) : m->jac;
 
     // Get the initial guess
     casadi_copy(m->iarg[iin_], n_, m->x);
 
     // Perform the Newton iterations
     m->iter=0;
+    m->n_fact=0;
+
+    if (block_triangular_) {
+      bool success = true;
+      for (auto&& lev : blk_level_) {
+        // Blocks on the same level only read unknowns of previous levels
+        ThreadPool::instance().run(lev.size(), [&](casadi_int i) { solve_block(m, lev[i]); });
+        for (casadi_int b : lev) {
+          NewtonBlockMemory& mb = m->blk[b];
+          for (casadi_int i=0; i<mb.z.size(); ++i) m->x[blk_col_[b][i]] = mb.z[i];
+          m->iter += mb.iter;
+          m->n_fact += mb.n_fact;
+          success = success && mb.success;
+        }
+        if (!success) break;
+      }
+      if (verbose_) casadi_message("Block triangular Newton took " + str(m->iter) + " steps in "
+                                   + str(blk_fcn_.size()) + " blocks");
+
+      // Evaluate the other outputs at the solution
+      if (n_out_>1) {
+        std::copy_n(m->iarg, n_in_, m->arg);
+        m->arg[iin_] = m->x;
+        std::copy_n(m->ires, n_out_, m->res);
+        m->res[iout_] = m->f;
+        calc_function(m, "g");
+      }
+
+      // Get the solution
+      casadi_copy(m->x, n_, m->ires[iout_]);
+      m->return_status = success ? "success" : "max_iteration_reached";
+      if (!success) m->unified_return_status = SOLVER_RET_LIMITED;
+      m->success = success;
+      return 0;
+    }
     bool success = true;
+    // Evaluate and factorize the Jacobian in the current iteration?
+    bool fresh = !reuse_jacobian_ || !m->has_fact;
+    double abstol_prev = std::numeric_limits<double>::infinity();
+    // Is there a step to base a Broyden update on?
+    bool has_step = false;
     while (true) {
       // Break if maximum number of iterations already reached
       if (m->iter >= max_iter_) {
@@ -151,13 +401,19 @@ namespace casadi {
       // Start a new iteration
       m->iter++;
 
-      // Use x to evaluate g and J
+      // Use x to evaluate g and J, or only g with a reused J
       std::copy_n(m->iarg, n_in_, m->arg);
       m->arg[iin_] = m->x;
-      m->res[0] = m->jac;
-      std::copy_n(m->ires, n_out_, m->res+1);
-      m->res[1+iout_] = m->f;
-      calc_function(m, "jac_f_z");
+      if (fresh) {
+        m->res[0] = jac;
+        std::copy_n(m->ires, n_out_, m->res+1);
+        m->res[1+iout_] = m->f;
+        calc_function(m, "jac_f_z");
+      } else {
+        std::copy_n(m->ires, n_out_, m->res);
+        m->res[iout_] = m->f;
+        calc_function(m, "g");
+      }
 
       // Check convergence
       double abstol = 0;
@@ -169,11 +425,59 @@ namespace casadi {
           if (verbose_) casadi_message("Converged to acceptable tolerance: " + str(abstol_));
           break;
         }
+      } else if (!fresh) {
+        abstol = casadi_norm_inf(n_, m->f);
+      }
+
+      // Refresh a reused Jacobian if the convergence rate is poor
+      if (!fresh && abstol > reuse_rate_ * abstol_prev) {
+        if (verbose_) casadi_message("Slow convergence, refactorizing the Jacobian");
+        fresh = true;
+        m->res[0] = jac;
+        std::copy_n(m->ires, n_out_, m->res+1);
+        m->res[1+iout_] = m->f;
+        calc_function(m, "jac_f_z");
+      }
+
+      // Broyden update with the secant condition for the last step
+      if (!fresh && broyden_>0 && has_step) {
+        if (m->n_broyden==broyden_) {
+          if (verbose_) casadi_message("Broyden updates exhausted, refactorizing the Jacobian");
+          fresh = true;
+          m->res[0] = jac;
+          std::copy_n(m->ires, n_out_, m->res+1);
+          m->res[1+iout_] = m->f;
+          calc_function(m, "jac_f_z");
+        } else {
+          // H*y, with y the change in F
+          double* hy = m->x_trial;
+          casadi_copy(m->f, n_, hy);
+          casadi_axpy(n_, -1., m->f_prev, hy);
+          linsol_.solve(jac, hy, 1, false, mem_linsol);
+          broyden_apply(m, hy);
+          // u = (s - H*y)/(s'*H*y)
+          double s_hy = casadi_dot(n_, m->s_prev, hy);
+          if (fabs(s_hy) > 1e-12 * casadi_norm_2(n_, m->s_prev) * casadi_norm_2(n_, hy)) {
+            double* u = get_ptr(m->broyden_u) + m->n_broyden*n_;
+            casadi_copy(m->s_prev, n_, u);
+            casadi_axpy(n_, -1., hy, u);
+            casadi_scal(n_, 1/s_hy, u);
+            casadi_copy(m->s_prev, n_, get_ptr(m->broyden_s) + m->n_broyden*n_);
+            m->n_broyden++;
+          }
+        }
       }
 
       // Factorize the linear solver with J
-      linsol_.nfact(m->jac, mem_linsol);
-      linsol_.solve(m->jac, m->f, 1, false, mem_linsol);
+      if (fresh) {
+        linsol_.nfact(jac, mem_linsol);
+        m->n_fact++;
+        m->has_fact = true;
+        m->n_broyden = 0;
+      }
+      if (broyden_>0) casadi_copy(m->f, n_, m->f_prev);
+      linsol_.solve(jac, m->f, 1, false, mem_linsol);
+      if (broyden_>0) broyden_apply(m, m->f);
 
       // Check convergence again
       double abstolStep=0;
@@ -188,6 +492,7 @@ namespace casadi {
       }
 
       double alpha = 1;
+      if (broyden_>0) casadi_copy(m->x, n_, m->s_prev);
       if (line_search_) {
         std::copy_n(m->iarg, n_in_, m->arg);
         m->arg[iin_] = m->x_trial;
@@ -212,11 +517,25 @@ namespace casadi {
           }
           alpha*= 0.5;
         }
-        if (!success) break;
+        if (!success) {
+          // Retry with a fresh Jacobian before giving up
+          if (fresh) break;
+          success = true;
+          fresh = true;
+          has_step = false;
+          abstol_prev = std::numeric_limits<double>::infinity();
+          continue;
+        }
       } else {
         // X = Xk - J^(-1) F
         casadi_axpy(n_, -alpha, m->f, m->x);
       }
+      if (broyden_>0) {
+        // Step taken
+        casadi_scal(n_, -1., m->s_prev);
+        casadi_axpy(n_, 1., m->x, m->s_prev);
+        has_step = true;
+      }
 
       if (print_iteration_) {
         // Only print iteration header once in a while
@@ -228,6 +547,9 @@ namespace casadi {
         printIteration(uout(), m->iter, abstol, abstolStep, alpha);
       }
 
+      // Reuse the Jacobian in the next iteration
+      abstol_prev = abstol;
+      fresh = !reuse_jacobian_;
     }
 
     // Get the solution
@@ -235,7 +557,8 @@ namespace casadi {
 
     // Store the iteration count
     if (success) m->return_status = "success";
-    if (verbose_) casadi_message("Newton algorithm took " + str(m->iter) + " steps");
+    if (verbose_) casadi_message("Newton algorithm took " + str(m->iter) + " steps, "
+                                 + str(m->n_fact) + " factorizations");
 
     m->success = success;
 
@@ -270,35 +593,100 @@ namespace casadi {
     auto m = static_cast<NewtonMemory*>(mem);
     m->return_status = "";
     m->iter = 0;
+    m->n_fact = 0;
+    m->has_fact = false;
+    m->n_broyden = 0;
+    if (reuse_jacobian_) {
+      m->mem_linsol = linsol_.checkout();
+      m->jac_fact.resize(sp_jac_.nnz());
+      m->broyden_u.resize(broyden_*n_);
+      m->broyden_s.resize(broyden_*n_);
+    }
+    m->blk.resize(blk_fcn_.size());
+    for (casadi_int b=0; b<m->blk.size(); ++b) {
+      NewtonBlockMemory& mb = m->blk[b];
+      const Function& f = blk_fcn_[b];
+      mb.z.resize(blk_col_[b].size());
+      mb.r.resize(blk_col_[b].size());
+      mb.jac.resize(f.nnz_out(1));
+      mb.arg.resize(f.sz_arg());
+      mb.res.resize(f.sz_res());
+      mb.iw.resize(f.sz_iw());
+      mb.w.resize(f.sz_w());
+      mb.mem_fcn = f.checkout();
+      mb.mem_linsol = blk_linsol_[b].checkout();
+      mb.iter = mb.n_fact = 0;
+      mb.success = false;
+    }
     return 0;
   }
 
+  void Newton::free_mem(void *mem) const {
+    auto m = static_cast<NewtonMemory*>(mem);
+    if (reuse_jacobian_) linsol_.release(m->mem_linsol);
+    for (casadi_int b=0; b<m->blk.size(); ++b) {
+      blk_fcn_[b].release(m->blk[b].mem_fcn);
+      blk_linsol_[b].release(m->blk[b].mem_linsol);
+    }
+    delete m;
+  }
+
   Dict Newton::get_stats(void* mem) const {
     Dict stats = Rootfinder::get_stats(mem);
     auto m = static_cast<NewtonMemory*>(mem);
     stats["return_status"] = m->return_status;
     stats["iter_count"] = m->iter;
+    stats["n_fact"] = m->n_fact;
     return stats;
   }
 
 
   Newton::Newton(DeserializingStream& s) : Rootfinder(s) {
-    s.version("Newton", 1);
+    int version = s.version("Newton", 1, 4);
     s.unpack("Newton::max_iter", max_iter_);
     s.unpack("Newton::abstol", abstol_);
     s.unpack("Newton::abstolStep", abstolStep_);
     s.unpack("Newton::print_iteration", print_iteration_);
     s.unpack("Newton::line_search", line_search_);
+    // Version 2 did not store the options it introduced
+    if (version >= 3) {
+      s.unpack("Newton::reuse_jacobian", reuse_jacobian_);
+      s.unpack("Newton::reuse_rate", reuse_rate_);
+      s.unpack("Newton::broyden", broyden_);
+    } else {
+      reuse_jacobian_ = false;
+      reuse_rate_ = 0.5;
+      broyden_ = 0;
+    }
+    if (version >= 4) {
+      s.unpack("Newton::block_triangular", block_triangular_);
+      s.unpack("Newton::blk_col", blk_col_);
+      s.unpack("Newton::blk_row", blk_row_);
+      s.unpack("Newton::blk_level", blk_level_);
+      s.unpack("Newton::blk_fcn", blk_fcn_);
+      s.unpack("Newton::blk_linsol", blk_linsol_);
+    } else {
+      block_triangular_ = false;
+    }
   }
 
   void Newton::serialize_body(SerializingStream &s) const {
     Rootfinder::serialize_body(s);
-    s.version("Newton", 1);
+    s.version("Newton", 4);
     s.pack("Newton::max_iter", max_iter_);
     s.pack("Newton::abstol", abstol_);
     s.pack("Newton::abstolStep", abstolStep_);
     s.pack("Newton::print_iteration", print_iteration_);
     s.pack("Newton::line_search", line_search_);
+    s.pack("Newton::reuse_jacobian", reuse_jacobian_);
+    s.pack("Newton::reuse_rate", reuse_rate_);
+    s.pack("Newton::broyden", broyden_);
+    s.pack("Newton::block_triangular", block_triangular_);
+    s.pack("Newton::blk_col", blk_col_);
+    s.pack("Newton::blk_row", blk_row_);
+    s.pack("Newton::blk_level", blk_level_);
+    s.pack("Newton::blk_fcn", blk_fcn_);
+    s.pack("Newton::blk_linsol", blk_linsol_);
   }
 
 } // namespace casadi
@@ -41,6 +41,23 @@
 /// \cond INTERNAL
 namespace casadi {
 
+  // Memory for the Newton iterations on a diagonal block
+  struct CASADI_ROOTFINDER_NEWTON_EXPORT NewtonBlockMemory {
+    // Unknowns, residual and Jacobian of the block
+    std::vector<double> z, r, jac;
+    // Work vectors for the block function
+    std::vector<const double*> arg;
+    std::vector<double*> res;
+    std::vector<casadi_int> iw;
+    std::vector<double> w;
+    // Memory of the block function and linear solver
+    int mem_fcn, mem_linsol;
+    // Number of iterations and factorizations
+    casadi_int iter, n_fact;
+    // Converged
+    bool success;
+  };
+
   // Memory
   struct CASADI_ROOTFINDER_NEWTON_EXPORT NewtonMemory
     : public RootfinderMemory {
@@ -54,10 +71,24 @@ namespace casadi {
     double* f_trial;
     // Current Jacobian
     double* jac;
+    // Residual and step of the previous iteration, for Broyden updates
+    double* f_prev;
+    double* s_prev;
     // Return status
     const char* return_status;
     // Number of iterations
     casadi_int iter;
+    // Number of Jacobian factorizations
+    casadi_int n_fact;
+    // Linear solver memory and Jacobian kept between calls, if reuse_jacobian
+    int mem_linsol;
+    std::vector<double> jac_fact;
+    bool has_fact;
+    // Broyden updates of the factorized Jacobian, inv(J) = prod_i (I + u_i s_i') inv(J_fact)
+    std::vector<double> broyden_u, broyden_s;
+    casadi_int n_broyden;
+    // Diagonal blocks, if block_triangular
+    std::vector<NewtonBlockMemory> blk;
   };
 
   /** \brief \pluginbrief{Rootfinder,newton}
@@ -103,7 +134,7 @@ namespace casadi {
     int init_mem(void* mem) const override;
 
     /** \brief Free memory block */
-    void free_mem(void *mem) const override { delete static_cast<NewtonMemory*>(mem);}
+    void free_mem(void *mem) const override;
 
     /** \brief Set the (persistent) work vectors */
     void set_work(void* mem, const double**& arg, double**& res,
@@ -145,6 +176,40 @@ namespace casadi {
 
     bool line_search_;
 
+    /// Simplified Newton: keep the factorized Jacobian between iterations and calls
+    bool reuse_jacobian_;
+
+    /// Refactorize when the residual decreases by less than this factor
+    double reuse_rate_;
+
+    /// Maximum number of Broyden updates of a reused Jacobian
+    casadi_int broyden_;
+
+    /// Apply the Broyden updates to J_fact^(-1) v
+    void broyden_apply(NewtonMemory* m, double* v) const;
+
+    /// Solve the diagonal blocks of the block triangular form separately
+    bool block_triangular_;
+
+    /// Unknowns and equations of each diagonal block
+    std::vector<std::vector<casadi_int>> blk_col_, blk_row_;
+
+    /// Diagonal blocks that can be solved concurrently, in order of solution
+    std::vector<std::vector<casadi_int>> blk_level_;
+
+    /// Residual and Jacobian of each diagonal block
+    std::vector<Function> blk_fcn_;
+
+    /// Linear solver for each diagonal block
+    std::vector<Linsol> blk_linsol_;
+
+    /// Create the block functions
+    template<typename XType>
+    void init_blocks(const std::string& linear_solver, const Dict& linear_solver_options);
+
+    /// Newton iterations on diagonal block b, with the other unknowns fixed
+    void solve_block(NewtonMemory* m, casadi_int b) const;
+
     /// Print iteration header
     void printIteration(std::ostream &stream) const;
 
@@ -0,0 +1,390 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "newton_cg.hpp"
+
+#include "casadi/core/casadi_misc.hpp"
+
+#include <cmath>
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_NLPSOL_NEWTON_CG_EXPORT
+      casadi_register_nlpsol_newton_cg(Nlpsol::Plugin* plugin) {
+    plugin->creator = NewtonCg::creator;
+    plugin->name = "newton_cg";
+    plugin->doc = NewtonCg::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &NewtonCg::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_NLPSOL_NEWTON_CG_EXPORT casadi_load_nlpsol_newton_cg() {
+    Nlpsol::registerPlugin(casadi_register_nlpsol_newton_cg);
+  }
+
+  NewtonCg::NewtonCg(const std::string& name, const Function& nlp)
+    : Nlpsol(name, nlp) {
+  }
+
+  NewtonCg::~NewtonCg() {
+    clear_mem();
+  }
+
+  const Options NewtonCg::options_
+  = {{&Nlpsol::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of Newton iterations"}},
+      {"max_iter_cg",
+       {OT_INT,
+        "Maximum number of conjugate gradient iterations per Newton iteration "
+        "[default: number of variables]"}},
+      {"max_iter_ls",
+       {OT_INT,
+        "Maximum number of linesearch iterations"}},
+      {"tol",
+       {OT_DOUBLE,
+        "Stopping criterion for the inf-norm of the projected gradient"}},
+      {"eta_max",
+       {OT_DOUBLE,
+        "Upper bound on the relative residual of the Newton system, "
+        "which is otherwise reduced as sqrt of the gradient norm"}},
+      {"c1",
+       {OT_DOUBLE,
+        "Armijo condition, coefficient of decrease in objective"}},
+      {"beta",
+       {OT_DOUBLE,
+        "Line-search parameter, restoration factor of stepsize"}},
+      {"min_step_size",
+       {OT_DOUBLE,
+        "The size (inf-norm) of the step size should not become smaller than this."}},
+      {"print_header",
+       {OT_BOOL,
+        "Print the header with problem statistics"}},
+      {"print_iteration",
+       {OT_BOOL,
+        "Print the iterations"}}
+     }
+  };
+
+  void NewtonCg::init(const Dict& opts) {
+    // Call the init method of the base class
+    Nlpsol::init(opts);
+
+    // Default options
+    max_iter_ = 100;
+    max_iter_cg_ = nx_;
+    max_iter_ls_ = 30;
+    tol_ = 1e-8;
+    eta_max_ = 0.5;
+    c1_ = 1e-4;
+    beta_ = 0.5;
+    min_step_size_ = 1e-14;
+    print_header_ = true;
+    print_iteration_ = true;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="max_iter_cg") {
+        max_iter_cg_ = op.second;
+      } else if (op.first=="max_iter_ls") {
+        max_iter_ls_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="eta_max") {
+        eta_max_ = op.second;
+      } else if (op.first=="c1") {
+        c1_ = op.second;
+      } else if (op.first=="beta") {
+        beta_ = op.second;
+      } else if (op.first=="min_step_size") {
+        min_step_size_ = op.second;
+      } else if (op.first=="print_header") {
+        print_header_ = op.second;
+      } else if (op.first=="print_iteration") {
+        print_iteration_ = op.second;
+      }
+    }
+
+    casadi_assert(ng_==0, "'newton_cg' only handles bounds on x, "
+      "but the problem has " + str(ng_) + " general constraints.");
+    casadi_assert(max_iter_ls_>=1, "'max_iter_ls' must be at least 1");
+
+    // Get/generate required functions
+    create_function("nlp_f", {"x", "p"}, {"f"});
+    create_function("nlp_grad_f", {"x", "p"}, {"f", "grad:f:x"});
+    // Hessian-vector products, the Hessian is never formed
+    create_hess_vec("nlp_hess_l_vec", {"x", "p", "lam:f", "lam:g"}, "gamma", "x",
+                    {{"gamma", {"f", "g"}}});
+
+    // Header
+    if (print_header_) {
+      print("-------------------------------------------\n");
+      print("This is casadi::NewtonCg.\n");
+      print("Using Hessian-vector products (forward-over-reverse)\n");
+      print("Number of variables:                       %9d\n", nx_);
+      print("\n");
+    }
+
+    // Gradient of the objective
+    alloc_w(nx_, true); // gf
+
+    // Search direction
+    alloc_w(nx_, true); // dx
+
+    // Conjugate gradients
+    alloc_w(nx_, true); // r
+    alloc_w(nx_, true); // p
+    alloc_w(nx_, true); // hp
+
+    // Candidate point
+    alloc_w(nx_, true); // x_cand
+  }
+
+  void NewtonCg::set_work(void* mem, const double**& arg, double**& res,
+                          casadi_int*& iw, double*& w) const {
+    auto m = static_cast<NewtonCgMemory*>(mem);
+
+    // Set work in base classes
+    Nlpsol::set_work(mem, arg, res, iw, w);
+
+    // Gradient of the objective
+    m->gf = w; w += nx_;
+
+    // Search direction
+    m->dx = w; w += nx_;
+
+    // Conjugate gradients
+    m->r = w; w += nx_;
+    m->p = w; w += nx_;
+    m->hp = w; w += nx_;
+
+    // Candidate point
+    m->x_cand = w; w += nx_;
+
+    m->iter_count = -1;
+  }
+
+  bool NewtonCg::is_fixed(const NewtonCgMemory* m, casadi_int i) const {
+    auto d_nlp = &m->d_nlp;
+    const double* x = d_nlp->z;
+    return d_nlp->lbz[i]==d_nlp->ubz[i]
+      || (x[i]<=d_nlp->lbz[i] && m->gf[i]>0)
+      || (x[i]>=d_nlp->ubz[i] && m->gf[i]<0);
+  }
+
+  int NewtonCg::hess_vec(NewtonCgMemory* m, const double* v, double* hv) const {
+    auto d_nlp = &m->d_nlp;
+    const double one = 1.;
+    m->arg[0] = d_nlp->z;
+    m->arg[1] = d_nlp->p;
+    m->arg[2] = &one;
+    m->arg[3] = nullptr;
+    m->arg[4] = v;
+    m->res[0] = hv;
+    if (calc_function(m, "nlp_hess_l_vec")) return 1;
+    for (casadi_int i=0; i<nx_; ++i) {
+      if (is_fixed(m, i)) hv[i] = 0;
+    }
+    return 0;
+  }
+
+  int NewtonCg::solve(void* mem) const {
+    auto m = static_cast<NewtonCgMemory*>(mem);
+    auto d_nlp = &m->d_nlp;
+    double* x = d_nlp->z;
+    const double *lbx = d_nlp->lbz, *ubx = d_nlp->ubz;
+
+    // Number of Newton and conjugate gradient iterations
+    m->iter_count = 0;
+    m->cg_count = 0;
+
+    // Iterations in the last Newton iteration
+    casadi_int cg_iter = 0, ls_iter = 0;
+
+    // Last linesearch successfull
+    bool ls_success = true;
+
+    // inf-norm of the last step
+    double dx_norminf = 0;
+
+    // Start from a point within the bounds
+    for (casadi_int i=0; i<nx_; ++i) x[i] = std::fmin(std::fmax(x[i], lbx[i]), ubx[i]);
+
+    // MAIN OPTIMIZATION LOOP
+    while (true) {
+      // Evaluate objective and gradient
+      m->arg[0] = x;
+      m->arg[1] = d_nlp->p;
+      m->res[0] = &d_nlp->objective;
+      m->res[1] = m->gf;
+      if (calc_function(m, "nlp_grad_f")) return 1;
+
+      // Multipliers of the active bounds, inf-norm of the projected gradient
+      double pg_inf = 0;
+      for (casadi_int i=0; i<nx_; ++i) {
+        d_nlp->lam[i] = is_fixed(m, i) ? -m->gf[i] : 0;
+        double x_pg = std::fmin(std::fmax(x[i] - m->gf[i], lbx[i]), ubx[i]);
+        pg_inf = std::fmax(pg_inf, std::fabs(x[i] - x_pg));
+      }
+
+      // Printing information about the actual iterate
+      if (print_iteration_) {
+        if (m->iter_count % 10 == 0) print_iteration();
+        print_iteration(m->iter_count, d_nlp->objective, pg_inf, dx_norminf,
+                        cg_iter, ls_iter, ls_success);
+      }
+
+      // Callback function
+      if (callback(m)) {
+        print("WARNING(newton_cg): Aborted by callback...\n");
+        m->return_status = "User_Requested_Stop";
+        break;
+      }
+
+      // Checking convergence criteria
+      if (pg_inf < tol_) {
+        print("MESSAGE(newton_cg): Convergence achieved after %d iterations\n", m->iter_count);
+        m->return_status = "Solve_Succeeded";
+        m->success = true;
+        break;
+      }
+
+      if (!ls_success) {
+        print("MESSAGE(newton_cg): Line-search failed.\n");
+        m->return_status = "Line_Search_Failed";
+        break;
+      }
+
+      if (m->iter_count >= max_iter_) {
+        print("MESSAGE(newton_cg): Maximum number of iterations reached.\n");
+        m->return_status = "Maximum_Iterations_Exceeded";
+        m->unified_return_status = SOLVER_RET_LIMITED;
+        break;
+      }
+
+      if (m->iter_count >= 1 && dx_norminf <= min_step_size_) {
+        print("MESSAGE(newton_cg): Search direction becomes too small without "
+              "convergence criteria being met.\n");
+        m->return_status = "Search_Direction_Becomes_Too_Small";
+        break;
+      }
+
+      // Increase counter
+      m->iter_count++;
+
+      // Truncated conjugate gradients for H*dx = -gf, free variables only
+      casadi_clear(m->dx, nx_);
+      for (casadi_int i=0; i<nx_; ++i) m->r[i] = is_fixed(m, i) ? 0 : -m->gf[i];
+      casadi_copy(m->r, nx_, m->p);
+      double rr = casadi_dot(nx_, m->r, m->r);
+      // Forcing sequence: required relative residual
+      double eta = std::fmin(eta_max_, std::sqrt(std::sqrt(rr)));
+      double rr_tol = eta * eta * rr;
+      for (cg_iter = 0; cg_iter < max_iter_cg_ && rr > rr_tol;) {
+        if (hess_vec(m, m->p, m->hp)) return 1;
+        cg_iter++;
+        double php = casadi_dot(nx_, m->p, m->hp);
+        if (php <= 1e-14 * casadi_dot(nx_, m->p, m->p)) {
+          // Nonpositive curvature: keep the current direction,
+          // which is the steepest descent direction in the first iteration
+          if (cg_iter==1) casadi_copy(m->p, nx_, m->dx);
+          break;
+        }
+        double alpha = rr / php;
+        casadi_axpy(nx_, alpha, m->p, m->dx);
+        casadi_axpy(nx_, -alpha, m->hp, m->r);
+        double rr_new = casadi_dot(nx_, m->r, m->r);
+        casadi_scal(nx_, rr_new / rr, m->p);
+        casadi_axpy(nx_, 1., m->r, m->p);
+        rr = rr_new;
+      }
+      m->cg_count += cg_iter;
+
+      // Backtracking line-search along the projected path
+      if (verbose_) print("Starting line-search\n");
+      double t = 1.;
+      double f_cand;
+      ls_iter = 0;
+      ls_success = false;
+      while (ls_iter < max_iter_ls_) {
+        ls_iter++;
+        for (casadi_int i=0; i<nx_; ++i) {
+          m->x_cand[i] = std::fmin(std::fmax(x[i] + t * m->dx[i], lbx[i]), ubx[i]);
+        }
+        m->arg[0] = m->x_cand;
+        m->arg[1] = d_nlp->p;
+        m->res[0] = &f_cand;
+        if (!calc_function(m, "nlp_f")) {
+          // Armijo condition
+          double df = 0;
+          for (casadi_int i=0; i<nx_; ++i) df += m->gf[i] * (m->x_cand[i] - x[i]);
+          if (f_cand <= d_nlp->objective + c1_ * df) {
+            ls_success = true;
+            break;
+          }
+        }
+        t *= beta_;
+      }
+
+      // Take step
+      if (ls_success) {
+        dx_norminf = 0;
+        for (casadi_int i=0; i<nx_; ++i) {
+          dx_norminf = std::fmax(dx_norminf, std::fabs(m->x_cand[i] - x[i]));
+        }
+        casadi_copy(m->x_cand, nx_, x);
+      }
+    }
+
+    return 0;
+  }
+
+  void NewtonCg::print_iteration() const {
+    print("%4s %14s %9s %9s %4s %2s\n", "iter", "objective", "inf_pg",
+          "||d||", "cg", "ls");
+  }
+
+  void NewtonCg::print_iteration(casadi_int iter, double obj, double pg_inf, double dx_norm,
+                                 casadi_int cg_iter, casadi_int ls_trials, bool ls_success) const {
+    print("%4d %14.6e %9.2e %9.2e %4d %2d", iter, obj, pg_inf, dx_norm, cg_iter, ls_trials);
+    if (!ls_success) print("F");
+    print("\n");
+  }
+
+  Dict NewtonCg::get_stats(void* mem) const {
+    Dict stats = Nlpsol::get_stats(mem);
+    auto m = static_cast<NewtonCgMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["iter_count"] = m->iter_count;
+    stats["cg_iter_count"] = m->cg_count;
+    return stats;
+  }
+} // namespace casadi
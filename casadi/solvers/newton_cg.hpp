@@ -0,0 +1,156 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_NEWTON_CG_HPP
+#define CASADI_NEWTON_CG_HPP
+
+#include "casadi/core/nlpsol_impl.hpp"
+#include <casadi/solvers/casadi_nlpsol_newton_cg_export.h>
+
+/** \defgroup plugin_Nlpsol_newton_cg Title
+    \par
+
+ A truncated Newton (Newton-CG) method for bound-constrained problems.
+ The Newton system is solved inexactly by conjugate gradients, using
+ Lagrangian Hessian-vector products from forward-over-reverse AD, so that
+ the Hessian is never formed. Bounds on x are handled by projection.
+ General constraints (ng>0) are not supported. */
+
+/** \pluginsection{Nlpsol,newton_cg} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_NLPSOL_NEWTON_CG_EXPORT NewtonCgMemory : public NlpsolMemory {
+    /// Gradient of the objective
+    double *gf;
+
+    /// Search direction
+    double *dx;
+
+    /// Conjugate gradient residual, direction and Hessian-direction product
+    double *r, *p, *hp;
+
+    /// Candidate point
+    double *x_cand;
+
+    /// Last return status
+    const char* return_status;
+
+    /// Iteration count, total number of conjugate gradient iterations
+    casadi_int iter_count, cg_count;
+  };
+
+  /** \brief  \pluginbrief{Nlpsol,newton_cg}
+  *  @copydoc NLPSolver_doc
+  *  @copydoc plugin_Nlpsol_newton_cg
+  */
+  class CASADI_NLPSOL_NEWTON_CG_EXPORT NewtonCg : public Nlpsol {
+  public:
+    explicit NewtonCg(const std::string& name, const Function& nlp);
+    ~NewtonCg() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "newton_cg";}
+
+    // Name of the class
+    std::string class_name() const override { return "NewtonCg";}
+
+    /** \brief  Create a new NLP Solver */
+    static Nlpsol* creator(const std::string& name, const Function& nlp) {
+      return new NewtonCg(name, nlp);
+    }
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new NewtonCgMemory();}
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<NewtonCgMemory*>(mem);}
+
+    /** \brief Set the (persistent) work vectors */
+    void set_work(void* mem, const double**& arg, double**& res,
+                          casadi_int*& iw, double*& w) const override;
+
+    // Solve the NLP
+    int solve(void* mem) const override;
+
+    /// Maximum number of Newton iterations
+    casadi_int max_iter_;
+
+    /// Maximum number of conjugate gradient iterations per Newton iteration
+    casadi_int max_iter_cg_;
+
+    /// Tolerance on the projected gradient
+    double tol_;
+
+    /// Upper bound on the relative residual of the Newton system
+    double eta_max_;
+
+    /// Minimum step size allowed
+    double min_step_size_;
+
+    /// Linesearch parameters
+    ///@{
+    double c1_;
+    double beta_;
+    casadi_int max_iter_ls_;
+    ///@}
+
+    // Print options
+    bool print_header_, print_iteration_;
+
+    /// Print iteration header
+    void print_iteration() const;
+
+    /// Print iteration
+    void print_iteration(casadi_int iter, double obj, double pg_inf, double dx_norm,
+                         casadi_int cg_iter, casadi_int ls_trials, bool ls_success) const;
+
+    // Hessian-vector product with the Lagrangian Hessian, fixed variables excluded
+    int hess_vec(NewtonCgMemory* m, const double* v, double* hv) const;
+
+    // Is a variable fixed at one of its bounds?
+    bool is_fixed(const NewtonCgMemory* m, casadi_int i) const;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_NEWTON_CG_HPP
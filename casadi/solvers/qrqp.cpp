@@ -79,7 +79,12 @@ namespace casadi {
         "Printed numbers are 0-based indices into the vector of [simple bounds;linear bounds]"}},
       {"min_lam",
        {OT_DOUBLE,
-        "Smallest multiplier treated as inactive for the initial active set [0]."}}
+        "Smallest multiplier treated as inactive for the initial active set [0]."}},
+      {"max_updates",
+       {OT_INT,
+        "Maximum number of active-set changes handled by low-rank updates of the "
+        "KKT factorization before refactorizing. When nonzero, the factorization "
+        "is also kept between calls with unchanged H and A [0]."}}
      }
   };
 
@@ -115,6 +120,8 @@ namespace casadi {
         p_.dual_inf_tol = op.second;
       } else if (op.first=="min_lam") {
         p_.min_lam = op.second;
+      } else if (op.first=="max_updates") {
+        p_.max_up = op.second;
       } else if (op.first=="print_iter") {
         print_iter_ = op.second;
       } else if (op.first=="print_header") {
@@ -177,6 +184,7 @@ namespace casadi {
     if (Conic::init_mem(mem)) return 1;
     auto m = static_cast<QrqpMemory*>(mem);
     m->return_status = "";
+    m->fact_n_up = -1;
     return 0;
   }
 
@@ -202,6 +210,18 @@ namespace casadi {
 
     // Reset solver
     if (casadi_qrqp_reset(&d)) return 1;
+    // Restore the factorization of the previous call if the matrices are unchanged
+    casadi_int nnz_f = sp_v_.nnz() + sp_r_.nnz() + nx_ + na_;
+    casadi_int sz_up = 2*(nx_ + na_)*p_.max_up + p_.max_up*(p_.max_up + 1);
+    if (p_.max_up > 0 && m->fact_n_up >= 0 && d_qp.h && d_qp.a
+        && std::equal(m->fact_h.begin(), m->fact_h.end(), d_qp.h)
+        && std::equal(m->fact_a.begin(), m->fact_a.end(), d_qp.a)) {
+      casadi_copy(get_ptr(m->fact_w), sp_v_.nnz() + sp_r_.nnz(), d.nz_v);
+      casadi_copy(get_ptr(m->fact_w) + sp_v_.nnz() + sp_r_.nnz(), nx_ + na_, d.beta);
+      casadi_copy(get_ptr(m->fact_w) + nnz_f, sz_up, d.up_w);
+      std::copy(m->fact_iw.begin(), m->fact_iw.end(), d.up_act);
+      d.n_up = m->fact_n_up;
+    }
     while (true) {
       // Prepare QP
       int flag = casadi_qrqp_prepare(&d);
@@ -231,6 +251,18 @@ namespace casadi {
       // User interrupt
       InterruptHandler::check();
     }
+    // Keep the factorization for the next call
+    m->fact_n_up = -1;
+    if (p_.max_up > 0 && d.n_up >= 0 && d_qp.h && d_qp.a) {
+      m->fact_h.assign(d_qp.h, d_qp.h + H_.nnz());
+      m->fact_a.assign(d_qp.a, d_qp.a + A_.nnz());
+      m->fact_w.resize(nnz_f + sz_up);
+      casadi_copy(d.nz_v, sp_v_.nnz() + sp_r_.nnz(), get_ptr(m->fact_w));
+      casadi_copy(d.beta, nx_ + na_, get_ptr(m->fact_w) + sp_v_.nnz() + sp_r_.nnz());
+      casadi_copy(d.up_w, sz_up, get_ptr(m->fact_w) + nnz_f);
+      m->fact_iw.assign(d.up_act, d.up_act + nx_ + na_ + 2*p_.max_up);
+      m->fact_n_up = d.n_up;
+    }
     // Check return flag
     switch (d.status) {
       case QP_SUCCESS:
@@ -284,6 +316,7 @@ namespace casadi {
     g << "p.min_lam = " << p_.min_lam << ";\n";
     g << "p.constr_viol_tol = " << p_.constr_viol_tol << ";\n";
     g << "p.dual_inf_tol = " << p_.dual_inf_tol << ";\n";
+    g << "p.max_up = " << p_.max_up << ";\n";
 
     // Setup data structure
     g << "d.prob = &p;\n";
@@ -348,11 +381,12 @@ namespace casadi {
     Dict stats = Conic::get_stats(mem);
     auto m = static_cast<QrqpMemory*>(mem);
     stats["return_status"] = m->return_status;
+    stats["n_fact"] = m->d.n_fact;
     return stats;
   }
 
   Qrqp::Qrqp(DeserializingStream& s) : Conic(s) {
-    s.version("Qrqp", 1);
+    int version = s.version("Qrqp", 1, 2);
     s.unpack("Qrqp::AT", AT_);
     s.unpack("Qrqp::kkt", kkt_);
     s.unpack("Qrqp::sp_v", sp_v_);
@@ -368,12 +402,13 @@ namespace casadi {
     s.unpack("Qrqp::min_lam", p_.min_lam);
     s.unpack("Qrqp::constr_viol_tol", p_.constr_viol_tol);
     s.unpack("Qrqp::dual_inf_tol", p_.dual_inf_tol);
+    if (version >= 2) s.unpack("Qrqp::max_up", p_.max_up);
   }
 
   void Qrqp::serialize_body(SerializingStream &s) const {
     Conic::serialize_body(s);
 
-    s.version("Qrqp", 1);
+    s.version("Qrqp", 2);
     s.pack("Qrqp::AT", AT_);
     s.pack("Qrqp::kkt", kkt_);
     s.pack("Qrqp::sp_v", sp_v_);
@@ -388,6 +423,7 @@ namespace casadi {
     s.pack("Qrqp::min_lam", p_.min_lam);
     s.pack("Qrqp::constr_viol_tol", p_.constr_viol_tol);
     s.pack("Qrqp::dual_inf_tol", p_.dual_inf_tol);
+    s.pack("Qrqp::max_up", p_.max_up);
   }
 
 } // namespace casadi
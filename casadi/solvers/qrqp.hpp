@@ -45,6 +45,10 @@ namespace casadi {
     // Problem data structure
     casadi_qrqp_data<double> d;
     const char* return_status;
+    // KKT factorization kept from the previous call, with the H and A it corresponds to
+    std::vector<double> fact_h, fact_a, fact_w;
+    std::vector<casadi_int> fact_iw;
+    casadi_int fact_n_up;
   };
 
   /** \brief \pluginbrief{Conic,qrqp}
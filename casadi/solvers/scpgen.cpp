@@ -110,7 +110,7 @@ namespace casadi {
         "Print the header with problem statistics"}},
       {"codegen",
        {OT_BOOL,
-        "C-code generation"}},
+        "Deprecated, equivalent to 'jit'"}},
       {"reg_threshold",
        {OT_DOUBLE,
         "Threshold for the regularization."}},
@@ -169,6 +169,7 @@ namespace casadi {
         regularize_ = op.second;
       } else if (op.first=="codegen") {
         codegen_ = op.second;
+        if (codegen_) casadi_warning("Option 'codegen' is deprecated, use 'jit' instead.");
       } else if (op.first=="reg_threshold") {
         reg_threshold_ = op.second;
       } else if (op.first=="tol_pr_step") {
@@ -192,6 +193,9 @@ namespace casadi {
       }
     }
 
+    // Code generation is handled by the standard just-in-time compilation
+    if (codegen_) jit_ = true;
+
     // Gauss-Newton Hessian?
     gauss_newton_ = hessian_approximation == "gauss-newton";
 
@@ -212,7 +216,6 @@ namespace casadi {
     Function vdef_fcn, vinit_fcn;
     fg.generate_lifted(vdef_fcn, vinit_fcn);
     vinit_fcn_ = vinit_fcn;
-    alloc(vinit_fcn_);
 
     // Extract the expressions
     std::vector<MX> vdef_in = vdef_fcn.mx_in();
@@ -524,48 +527,16 @@ namespace casadi {
            << std::endl;
     }
 
-    // Generate c code and load as DLL
-    if (codegen_) {
-      // Name of temporary file
-      std::string cname = temporary_file("tmp_casadi_scpgen", ".c");
-
-      // Codegen the functions
-      CodeGenerator gen(cname);
-      gen.add(res_fcn);
-      gen.add(mat_fcn);
-      gen.add(vec_fcn);
-      gen.add(exp_fcn);
-
-      // Generate code
-      if (verbose_) {
-        uout() << "Generating \"" << cname << "\""  << std::endl;
-      }
-      std::string name = cname.substr(0, cname.find_first_of('.'));
-      gen.generate();
-
-      // Complile and run
-      if (verbose_) {
-        uout() << "Starting compilation"  << std::endl;
-      }
-      time_t time1 = time(nullptr);
-      compiler_ = Importer(cname, compiler_plugin_, jit_options_);
-      time_t time2 = time(nullptr);
-      double comp_time = difftime(time2, time1);
-      if (verbose_) {
-        uout() << "Compilation completed after " << comp_time << " s."  << std::endl;
-      }
-
-      // Load the generated code
-      res_fcn_ = external("res_fcn", compiler_);
-      mat_fcn_ = external("mat_fcn", compiler_);
-      vec_fcn_ = external("vec_fcn", compiler_);
-      exp_fcn_ = external("exp_fcn", compiler_);
-    } else {
-      mat_fcn_ = mat_fcn;
-      res_fcn_ = res_fcn;
-      vec_fcn_ = vec_fcn;
-      exp_fcn_ = exp_fcn;
-    }
+    // Register the functions, compiled together if 'jit' is set
+    set_function(vinit_fcn_, "vinit_fcn", true);
+    set_function(res_fcn, "res_fcn", true);
+    set_function(mat_fcn, "mat_fcn", true);
+    set_function(vec_fcn, "vec_fcn", true);
+    set_function(exp_fcn, "exp_fcn", true);
+    mat_fcn_ = mat_fcn;
+    res_fcn_ = res_fcn;
+    vec_fcn_ = vec_fcn;
+    exp_fcn_ = exp_fcn;
 
     // Allocate a QP solver
     spL_ = mat_fcn_.sparsity_out(mat_hes_);
@@ -674,10 +645,6 @@ namespace casadi {
     alloc_w(merit_memsize_, true);
 
     // Temporary work vectors
-    alloc(mat_fcn_);
-    alloc(res_fcn_);
-    alloc(vec_fcn_);
-    alloc(exp_fcn_);
     if (gauss_newton_) {
       alloc_w(ngn_); // casadi_mul to get GN Hessian
     }
@@ -765,7 +732,7 @@ namespace casadi {
       for (casadi_int i=0; i<v_.size(); ++i) {
         m->res[i] = m->lifted_mem[i].x0;
       }
-      vinit_fcn_(m->arg, m->res, m->iw, m->w, 0);
+      calc_function(m, "vinit_fcn");
     }
     if (verbose_) {
       uout() << "Passed initial guess" << std::endl;
@@ -998,7 +965,7 @@ namespace casadi {
     m->res[mat_hes_] = gauss_newton_ ? m->qpL : m->qpH; // Condensed Hessian
 
     // Calculate condensed QP matrices
-    mat_fcn_(m->arg, m->res, m->iw, m->w, 0);
+    calc_function(m, "mat_fcn");
 
     if (gauss_newton_) {
       // Gauss-Newton Hessian
@@ -1052,7 +1019,7 @@ namespace casadi {
     m->res[res_p_d_] = d_nlp->lam_p; // Parameter sensitivities
 
     // Evaluate residual function
-    res_fcn_(m->arg, m->res, m->iw, m->w, 0);
+    calc_function(m, "res_fcn");
 
     double time2 = clock();
     m->t_eval_res += (time2-time1)/CLOCKS_PER_SEC;
@@ -1083,7 +1050,7 @@ namespace casadi {
     m->res[vec_g_] = m->qpB;
 
     // Calculate condensed QP vectors
-    vec_fcn_(m->arg, m->res, m->iw, m->w, 0);
+    calc_function(m, "vec_fcn");
 
     // Linear offset in the reduced QP
     casadi_scal(ng_, -1., m->qpB);
@@ -1297,7 +1264,7 @@ namespace casadi {
     }
 
     // Perform the step expansion
-    exp_fcn_(m->arg, m->res, m->iw, m->w, 0);
+    calc_function(m, "exp_fcn");
 
     double time2 = clock();
     m->t_eval_exp += (time2-time1)/CLOCKS_PER_SEC;
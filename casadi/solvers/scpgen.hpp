@@ -199,7 +199,7 @@ namespace casadi {
     double merit_start_;
     ///@}
 
-    /// Enable Code generation
+    /// Deprecated alias of the 'jit' option
     bool codegen_;
 
     /// Access qpsol
@@ -28,6 +28,8 @@
 #include "casadi/core/casadi_meta.hpp"
 #include "casadi/core/casadi_logger.hpp"
 #include <fstream>
+#include <iomanip>
+#include <sys/stat.h>
 
 // Set default object file suffix
 #ifndef OBJECT_FILE_SUFFIX
@@ -57,14 +59,28 @@ namespace casadi {
   ShellCompiler::ShellCompiler(const std::string& name) :
     ImporterInternal(name) {
       handle_ = nullptr;
+      cached_ = false;
+  }
+
+  // 64-bit FNV-1a hash, stable across processes and platforms
+  static uint64_t fnv1a(const std::string& s, uint64_t h = 14695981039346656037ULL) {
+    for (unsigned char c : s) {
+      h ^= c;
+      h *= 1099511628211ULL;
+    }
+    return h;
   }
 
   ShellCompiler::~ShellCompiler() {
     if (handle_) close_shared_library(handle_);
 
     if (cleanup_) {
-      if (remove(bin_name_.c_str())) casadi_warning("Failed to remove " + bin_name_);
-      if (remove(obj_name_.c_str())) casadi_warning("Failed to remove " + obj_name_);
+      if (!cached_ && remove(bin_name_.c_str())) {
+        casadi_warning("Failed to remove " + bin_name_);
+      }
+      if (remove(obj_name_.c_str()) && !cached_) {
+        casadi_warning("Failed to remove " + obj_name_);
+      }
       for (const std::string& s : extra_suffixes_) {
         std::string name = base_name_+s;
         remove(name.c_str());
@@ -125,6 +141,12 @@ namespace casadi {
         "This is desired for thread-safety. "
         "This behaviour may defeat caching compiler wrappers. "
         "Default: true"}},
+      {"cache_directory",
+       {OT_STRING,
+        "Directory of a cache of shared libraries, shared by processes. Must end with "
+        "a file separator. A library is identified by a hash of the source code and "
+        "the compiler and linker commands, and is reused if present. New libraries "
+        "are added with an atomic rename. Default: no caching"}},
      }
   };
 
@@ -138,6 +160,7 @@ namespace casadi {
     bool temp_suffix = true;
     std::string bare_name = "tmp_casadi_compiler_shell";
     std::string directory = "";
+    std::string cache_directory = "";
 
     std::vector<std::string> compiler_flags;
     std::vector<std::string> linker_flags;
@@ -188,9 +211,42 @@ namespace casadi {
         bare_name = op.second.to_string();
       } else if (op.first=="temp_suffix") {
         temp_suffix = op.second;
+      } else if (op.first=="cache_directory") {
+        cache_directory = op.second.to_string();
       }
     }
 
+    // Cached shared library, if any
+    std::string cache_name;
+    if (!cache_directory.empty()) {
+      // Identify by source code and commands, excluding the file names
+      std::ifstream src(name_, std::ios::binary);
+      casadi_assert(src.good(), "Cannot read " + name_ + " for caching.");
+      std::stringstream key;
+      key << src.rdbuf() << '\0' << CasadiMeta::version() << '\0' << compiler;
+      for (const std::string& f : compiler_flags) key << ' ' << f;
+      key << ' ' << compiler_setup << '\0' << linker;
+      for (const std::string& f : linker_flags) key << ' ' << f;
+      key << ' ' << linker_setup;
+      std::stringstream h;
+      h << std::hex << std::setw(16) << std::setfill('0') << fnv1a(key.str());
+      cache_name = cache_directory + "casadi_jit_" + h.str() + SHARED_LIBRARY_SUFFIX;
+      // Reuse the library if another process already built it
+      struct stat st;
+      if (stat(cache_name.c_str(), &st)==0) {
+        if (verbose_) casadi_message("Using cached \"" + cache_name + "\"");
+        cached_ = true;
+        cleanup_ = false;
+        bin_name_ = cache_name;
+        std::vector<std::string> search_paths = get_search_paths();
+        handle_ = open_shared_library(bin_name_, search_paths, "ShellCompiler::init");
+        return;
+      }
+      // Build in the cache directory, so that the rename is atomic
+      directory = cache_directory;
+      temp_suffix = true;
+    }
+
     // Name of temporary file
     if (temp_suffix) {
       obj_name_ = temporary_file(directory + bare_name, suffix);
@@ -250,6 +306,23 @@ namespace casadi {
       casadi_error("Linking failed. Tried \"" + ldcmd.str() + "\"");
     }
 
+    // Publish in the cache, a concurrent process may have done so already
+    if (!cache_name.empty()) {
+      if (rename(bin_name_.c_str(), cache_name.c_str())==0) {
+        cached_ = true;
+        bin_name_ = cache_name;
+      } else {
+        struct stat st;
+        if (stat(cache_name.c_str(), &st)==0) {
+          remove(bin_name_.c_str());
+          cached_ = true;
+          bin_name_ = cache_name;
+        } else {
+          casadi_warning("Failed to add " + bin_name_ + " to the cache as " + cache_name);
+        }
+      }
+    }
+
     std::vector<std::string> search_paths = get_search_paths();
     handle_ = open_shared_library(bin_name_, search_paths, "ShellCompiler::init");
 
@@ -103,6 +103,9 @@ namespace casadi {
     /// Cleanup temporary files when unloading
     bool cleanup_;
 
+    /// Shared library taken from or added to the cache, not to be removed
+    bool cached_;
+
     // Shared library handle
     handle_t handle_;
   };
@@ -29,6 +29,7 @@
 #include "casadi/core/conic.hpp"
 #include "casadi/core/conic_impl.hpp"
 #include "casadi/core/convexify.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 #include <ctime>
 #include <iomanip>
@@ -98,9 +99,22 @@ const Options Sqpmethod::options_
     {"merit_memory",
       {OT_INT,
       "Size of memory to store history of merit function values"}},
+    {"parallel_ls",
+      {OT_BOOL,
+      "Evaluate the merit function at several step lengths concurrently on the "
+      "thread pool and take the largest acceptable one [false]"}},
     {"lbfgs_memory",
       {OT_INT,
       "Size of L-BFGS memory."}},
+    {"lbfgs_compact",
+      {OT_BOOL,
+      "Rebuild the BFGS approximation in every iteration from the last lbfgs_memory "
+      "steps and gradient differences, instead of restarting it every lbfgs_memory "
+      "iterations [false]"}},
+    {"block_hess",
+      {OT_BOOL,
+      "Use a block-diagonal BFGS approximation following the blocks of the "
+      "Lagrangian Hessian sparsity pattern, updated block by block [false]"}},
     {"print_header",
       {OT_BOOL,
       "Print the header with problem statistics"}},
@@ -122,7 +136,7 @@ const Options Sqpmethod::options_
       "(autogenerated by default)"}},
     {"convexify_strategy",
       {OT_STRING,
-      "NONE|regularize|eigen-reflect|eigen-clip. "
+      "NONE|regularize|eigen-reflect|eigen-clip|inertia. "
       "Strategy to convexify the Lagrange Hessian before passing it to the solver."}},
     {"convexify_margin",
       {OT_DOUBLE,
@@ -131,6 +145,10 @@ const Options Sqpmethod::options_
     {"max_iter_eig",
       {OT_DOUBLE,
       "Maximum number of iterations to compute an eigenvalue decomposition (default: 50)."}},
+    {"convexify_parallel",
+      {OT_BOOL,
+      "For the eigen-* convexification strategies: convexify the independent diagonal "
+      "blocks of the Hessian concurrently on the thread pool (default: false)."}},
     {"elastic_mode",
       {OT_BOOL,
       "Enable the elastic mode which is used when the QP is infeasible (default: false)."}},
@@ -150,7 +168,16 @@ const Options Sqpmethod::options_
       "(default: false)."}},
     {"init_feasible",
       {OT_BOOL,
-      "Initialize the QP subproblems with a feasible initial value (default: false)."}}
+      "Initialize the QP subproblems with a feasible initial value (default: false)."}},
+    {"structure_detection",
+      {OT_STRING,
+      "NONE|auto. Detect the stage structure of an optimal control problem from the "
+      "sparsity of the QP. With 'auto' and an OCP structure, the structure is passed to "
+      "hpipm or fatrop, and hpipm is used if 'qpsol' is not set (default: none)."}},
+    {"rti",
+      {OT_BOOL,
+      "Create the real-time iteration functions 'rti_preparation' and 'rti_feedback', "
+      "available through get_function (default: false)."}}
     }
 };
 
@@ -165,7 +192,10 @@ void Sqpmethod::init(const Dict& opts) {
   c1_ = 1e-4;
   beta_ = 0.8;
   merit_memsize_ = 4;
+  parallel_ls_ = false;
   lbfgs_memory_ = 10;
+  lbfgs_compact_ = false;
+  bool block_hess = false;
   tol_pr_ = 1e-6;
   tol_du_ = 1e-6;
   std::string hessian_approximation = "exact";
@@ -181,10 +211,14 @@ void Sqpmethod::init(const Dict& opts) {
   gamma_1_min_ = 1e-5;
   so_corr_ = false;
   init_feasible_ = false;
+  bool rti = false;
+  bool qpsol_set = false;
+  std::string structure_detection = "none";
 
   std::string convexify_strategy = "none";
   double convexify_margin = 1e-7;
   casadi_int max_iter_eig = 200;
+  bool convexify_parallel = false;
 
   // Read user options
   for (auto&& op : opts) {
@@ -200,8 +234,14 @@ void Sqpmethod::init(const Dict& opts) {
       beta_ = op.second;
     } else if (op.first=="merit_memory") {
       merit_memsize_ = op.second;
+    } else if (op.first=="parallel_ls") {
+      parallel_ls_ = op.second;
     } else if (op.first=="lbfgs_memory") {
       lbfgs_memory_ = op.second;
+    } else if (op.first=="lbfgs_compact") {
+      lbfgs_compact_ = op.second;
+    } else if (op.first=="block_hess") {
+      block_hess = op.second;
     } else if (op.first=="tol_pr") {
       tol_pr_ = op.second;
     } else if (op.first=="tol_du") {
@@ -212,6 +252,7 @@ void Sqpmethod::init(const Dict& opts) {
       min_step_size_ = op.second;
     } else if (op.first=="qpsol") {
       qpsol_plugin = op.second.to_string();
+      qpsol_set = true;
     } else if (op.first=="qpsol_options") {
       qpsol_options = op.second;
     } else if (op.first=="print_header") {
@@ -236,6 +277,8 @@ void Sqpmethod::init(const Dict& opts) {
       convexify_margin = op.second;
     } else if (op.first=="max_iter_eig") {
       max_iter_eig = op.second;
+    } else if (op.first=="convexify_parallel") {
+      convexify_parallel = op.second;
     } else if (op.first=="elastic_mode") {
       elastic_mode_ = op.second;
     } else if (op.first=="gamma_0") {
@@ -248,6 +291,10 @@ void Sqpmethod::init(const Dict& opts) {
       so_corr_ = op.second;
     } else if (op.first=="init_feasible") {
       init_feasible_ = op.second;
+    } else if (op.first=="structure_detection") {
+      structure_detection = op.second.to_string();
+    } else if (op.first=="rti") {
+      rti = op.second;
     }
   }
 
@@ -268,6 +315,11 @@ void Sqpmethod::init(const Dict& opts) {
 
   // Get/generate required functions
   if (max_iter_ls_ || so_corr_) create_function("nlp_fg", {"x", "p"}, {"f", "g"});
+
+  // One thread local oracle memory per concurrently evaluated step length
+  if (parallel_ls_ && max_iter_ls_>1) {
+    max_num_threads_ = std::min(max_iter_ls_, ThreadPool::requested_size());
+  }
   // First order derivative information
 
   if (!has_function("nlp_jac_fg")) {
@@ -289,11 +341,71 @@ void Sqpmethod::init(const Dict& opts) {
       opts["strategy"] = convexify_strategy;
       opts["margin"] = convexify_margin;
       opts["max_iter_eig"] = max_iter_eig;
+      opts["parallel"] = convexify_parallel;
       opts["verbose"] = verbose_;
       Hsp_ = Convexify::setup(convexify_data_, Hsp_, opts);
     }
+  } else if (block_hess) {
+    // Sparsity pattern of the Hessian of the Lagrangian
+    Function grad_lag = oracle_.factory("grad_lag",
+                                        {"x", "p", "lam:f", "lam:g"}, {"grad:gamma:x"},
+                                        {{"gamma", {"f", "g"}}});
+    Sparsity Hsp = grad_lag.sparsity_jac("x", "grad_gamma_x", false, true);
+    Hsp = Hsp + Sparsity::diag(nx_);
+
+    // Find the diagonal blocks, assuming they are ordered
+    const casadi_int* colind = Hsp.colind();
+    const casadi_int* row = Hsp.row();
+    blocks_ = {0};
+    casadi_int ind = 0;
+    while (ind < nx_) {
+      casadi_int next=ind+1;
+      while (ind<next && ind<nx_) {
+        for (casadi_int k=colind[ind]; k<colind[ind+1]; ++k) next = std::max(next, 1+row[k]);
+        ind++;
+      }
+      blocks_.push_back(next);
+    }
+
+    // Dense blocks on the diagonal
+    std::vector<Sparsity> b;
+    for (casadi_int i=0; i+1<blocks_.size(); ++i) {
+      b.push_back(Sparsity::dense(blocks_[i+1]-blocks_[i], blocks_[i+1]-blocks_[i]));
+    }
+    Hsp_ = Sparsity::diagcat(b);
   } else {
     Hsp_ = Sparsity::dense(nx_, nx_);
+    blocks_ = {0, nx_};
+  }
+  if (!exact_hessian_) set_bfgs_blocks();
+
+  // Exploit the stage structure of optimal control problems
+  if (structure_detection=="auto") {
+    std::vector<int> nx, nu, ng;
+    std::vector<casadi_int> perm_x, perm_a;
+    casadi_int N = Conic::detect_ocp_permutation(Hsp_, Asp_, perm_x, perm_a, nx, nu, ng);
+    // Stages not in order: the QP solver repeats the detection and permutes the problem
+    bool permuted = perm_x!=range(nx_) || perm_a!=range(ng_);
+    if (N>1) {
+      if (!qpsol_set && Conic::has_plugin("hpipm")) qpsol_plugin = "hpipm";
+      if ((qpsol_plugin=="hpipm" || qpsol_plugin=="fatrop") && !permuted
+          && qpsol_options.find("N")==qpsol_options.end()) {
+        qpsol_options["N"] = N;
+        qpsol_options["nx"] = nx;
+        qpsol_options["nu"] = nu;
+        qpsol_options["ng"] = ng;
+      }
+      if (verbose_) {
+        casadi_message("Detected " + std::string(permuted ? "permuted " : "")
+          + "OCP structure: N " + str(N) + ", nx " + str(nx) + ", "
+          "nu " + str(nu) + ", ng " + str(ng) + ". Using " + qpsol_plugin + ".");
+      }
+    } else if (verbose_) {
+      casadi_message("No OCP structure detected");
+    }
+  } else {
+    casadi_assert(structure_detection=="none",
+      "Unknown structure_detection '" + structure_detection + "'. Choose from none, auto.");
   }
 
   casadi_assert(!qpsol_plugin.empty(), "'qpsol' option has not been set");
@@ -323,9 +435,13 @@ void Sqpmethod::init(const Dict& opts) {
   }
 
 
+  // Real-time iteration phases
+  if (rti) setup_rti();
+
   // BFGS?
   if (!exact_hessian_) {
     alloc_w(2*nx_); // casadi_bfgs
+    if (lbfgs_compact_) alloc_w(nx_); // zero gradient offset
   }
 
   // Header
@@ -336,6 +452,8 @@ void Sqpmethod::init(const Dict& opts) {
       print("Using exact Hessian\n");
     } else {
       print("Using limited memory BFGS Hessian approximation\n");
+      if (blocks_.size()>2) print("Number of BFGS blocks:                     %9d\n",
+        static_cast<casadi_int>(blocks_.size())-1);
     }
     print("Number of variables:                       %9d\n", nx_);
     print("Number of constraints:                     %9d\n", ng_);
@@ -357,6 +475,84 @@ void Sqpmethod::init(const Dict& opts) {
   }
 }
 
+void Sqpmethod::setup_rti() {
+  casadi_assert(exact_hessian_,
+    "Real-time iterations require an exact or user-supplied Hessian ('hess_lag')");
+  casadi_assert(!convexify_, "Real-time iterations do not support convexification");
+  casadi_assert(detect_simple_bounds_is_simple_.empty(),
+    "Real-time iterations do not support 'detect_simple_bounds'");
+
+  // Preparation phase: linearize at the current guess, before the new
+  // measurement is known
+  MX x = MX::sym("x", nx_), p = MX::sym("p", np_), lam_g = MX::sym("lam_g", ng_);
+  std::vector<MX> jac_fg = get_function("nlp_jac_fg")(std::vector<MX>{x, p});
+  MX hess_l = get_function("nlp_hess_l")(std::vector<MX>{x, p, 1, lam_g}).at(0);
+  Function prep("rti_preparation", {x, p, lam_g},
+    {x, jac_fg.at(1), jac_fg.at(2), jac_fg.at(3), hess_l},
+    {"x0", "p", "lam_g0"}, {"x_lin", "grad_f", "g", "jac_g", "hess_l"});
+  set_function(prep, prep.name());
+
+  // Feedback phase: one QP solve with the bounds containing the measurement
+  MX x_lin = MX::sym("x_lin", nx_);
+  MX grad_f = MX::sym("grad_f", prep.sparsity_out(1));
+  MX g = MX::sym("g", prep.sparsity_out(2));
+  MX jac_g = MX::sym("jac_g", Asp_);
+  MX H = MX::sym("hess_l", Hsp_);
+  MX lbx = MX::sym("lbx", nx_), ubx = MX::sym("ubx", nx_);
+  MX lbg = MX::sym("lbg", ng_), ubg = MX::sym("ubg", ng_);
+  MX lam_x0 = MX::sym("lam_x0", nx_), lam_g0 = MX::sym("lam_g0", ng_);
+  MXDict qp_res = qpsol_(MXDict{{"h", H}, {"g", grad_f}, {"a", jac_g},
+    {"lbx", lbx - x_lin}, {"ubx", ubx - x_lin}, {"lba", lbg - g}, {"uba", ubg - g},
+    {"lam_x0", lam_x0}, {"lam_a0", lam_g0}});
+  Function fb("rti_feedback",
+    {x_lin, grad_f, g, jac_g, H, lbx, ubx, lbg, ubg, lam_x0, lam_g0},
+    {x_lin + qp_res.at("x"), qp_res.at("lam_x"), qp_res.at("lam_a")},
+    {"x_lin", "grad_f", "g", "jac_g", "hess_l", "lbx", "ubx", "lbg", "ubg",
+     "lam_x0", "lam_g0"},
+    {"x", "lam_x", "lam_g"});
+  set_function(fb, fb.name());
+}
+
+void Sqpmethod::set_bfgs_blocks() {
+  block_sp_.clear();
+  for (casadi_int i=0; i+1<blocks_.size(); ++i) {
+    block_sp_.push_back(Sparsity::dense(blocks_[i+1]-blocks_[i], blocks_[i+1]-blocks_[i]));
+  }
+}
+
+void Sqpmethod::bfgs_update(double* Bk, const double* dx, const double* glag,
+    const double* glag_old, double* w) const {
+  // The nonzeros of each dense diagonal block are stored contiguously
+  for (casadi_int b=0; b<block_sp_.size(); ++b) {
+    casadi_int o = blocks_[b];
+    casadi_bfgs(block_sp_[b], Bk, dx + o, glag + o, glag_old + o, w);
+    Bk += block_sp_[b].nnz();
+  }
+}
+
+void Sqpmethod::lbfgs_rebuild(SqpmethodMemory* m, double* Bk, double* w) const {
+  casadi_int n_pairs = std::min(m->lbfgs_n, lbfgs_memory_);
+  const double* s_new = get_ptr(m->lbfgs_s) + ((m->lbfgs_n-1) % lbfgs_memory_) * nx_;
+  const double* y_new = get_ptr(m->lbfgs_y) + ((m->lbfgs_n-1) % lbfgs_memory_) * nx_;
+  double* zero = w; w += nx_;
+  casadi_clear(zero, nx_);
+  // Initial approximation: identity scaled per block with the newest pair
+  double* Bb = Bk;
+  for (casadi_int b=0; b<block_sp_.size(); ++b) {
+    casadi_int o = blocks_[b], nb = blocks_[b+1] - o;
+    double sy = casadi_dot(nb, s_new + o, y_new + o);
+    double yy = casadi_dot(nb, y_new + o, y_new + o);
+    casadi_fill(Bb, block_sp_[b].nnz(), sy>0 && yy>0 ? yy/sy : 1.);
+    casadi_bfgs_reset(block_sp_[b], Bb);
+    Bb += block_sp_[b].nnz();
+  }
+  // Apply the stored updates, oldest first
+  for (casadi_int j=m->lbfgs_n-n_pairs; j<m->lbfgs_n; ++j) {
+    casadi_int k = j % lbfgs_memory_;
+    bfgs_update(Bk, get_ptr(m->lbfgs_s) + k*nx_, get_ptr(m->lbfgs_y) + k*nx_, zero, w);
+  }
+}
+
 void Sqpmethod::set_sqpmethod_prob() {
   p_.sp_h = Hsp_;
   p_.sp_a = Asp_;
@@ -386,6 +582,18 @@ int Sqpmethod::init_mem(void* mem) const {
   m->add_stat("BFGS");
   m->add_stat("QP");
   m->add_stat("linesearch");
+
+  // Candidates of the parallel line-search
+  if (max_num_threads_>1) {
+    m->ls_z.resize(max_num_threads_*(nx_+ng_));
+    m->ls_f.resize(max_num_threads_);
+    m->ls_flag.resize(max_num_threads_);
+  }
+
+  // Diagonal Hessian blocks found positive definite, initially all
+  if (convexify_ && !convexify_data_.block_nz.empty()) {
+    m->cvx_pd.assign(convexify_data_.block_nz.size()-1, 1);
+  }
   return 0;
 }
 
@@ -397,6 +605,11 @@ int Sqpmethod::solve(void* mem) const {
   // Number of SQP iterations
   m->iter_count = 0;
 
+  // Iteration history
+  for (auto* v : {&m->inf_pr, &m->inf_du, &m->d_norm, &m->regularization_size, &m->obj}) {
+    v->clear();
+  }
+
   // Number of line-search iterations
   casadi_int ls_iter = 0;
 
@@ -463,6 +676,13 @@ int Sqpmethod::solve(void* mem) const {
     // inf-norm of step
     double dx_norminf = casadi_norm_inf(nx_, d->dx);
 
+    // Record the iterate
+    m->inf_pr.push_back(pr_inf);
+    m->inf_du.push_back(du_inf);
+    m->d_norm.push_back(dx_norminf);
+    m->regularization_size.push_back(m->reg);
+    m->obj.push_back(d_nlp->objective);
+
     // Printing information about the actual iterate
     if (print_iteration_) {
       if (m->iter_count % 10 == 0) print_iteration();
@@ -512,20 +732,45 @@ int Sqpmethod::solve(void* mem) const {
       m->res[0] = d->Bk;
       if (calc_function(m, "nlp_hess_l")) return 1;
       if (convexify_) {
-        ScopedTiming tic(m->fstats.at("convexify"));
-        if (convexify_eval(&convexify_data_.config, d->Bk, d->Bk, m->iw, m->w)) return 1;
+        ScopedTiming tic(m->fstats.at("convexify"), record_time_);
+        if (Convexify::eval_blocks(convexify_data_, d->Bk, d->Bk, m->iw, m->w,
+          get_ptr(m->cvx_pd))) return 1;
+      }
+    } else if (m->iter_count==0 && m->warm_start && !m->Bk_warm.empty() && Hsp_.is_dense()) {
+      ScopedTiming tic(m->fstats.at("BFGS"), record_time_);
+      // Continue with the (shifted) approximation of the previous call
+      for (casadi_int j=0; j<nx_; ++j) {
+        casadi_int kj = warm_start_index(j, nx_, warm_start_shift_x_);
+        for (casadi_int i=0; i<nx_; ++i) {
+          casadi_int ki = warm_start_index(i, nx_, warm_start_shift_x_);
+          d->Bk[i + j*nx_] = m->Bk_warm[ki + kj*nx_];
+        }
       }
     } else if (m->iter_count==0) {
-      ScopedTiming tic(m->fstats.at("BFGS"));
+      ScopedTiming tic(m->fstats.at("BFGS"), record_time_);
       // Initialize BFGS
       casadi_fill(d->Bk, Hsp_.nnz(), 1.);
       casadi_bfgs_reset(Hsp_, d->Bk);
+    } else if (lbfgs_compact_) {
+      ScopedTiming tic(m->fstats.at("BFGS"), record_time_);
+      // Store the latest pair, overwriting the oldest one
+      if (m->lbfgs_s.size() != lbfgs_memory_*nx_) {
+        m->lbfgs_s.resize(lbfgs_memory_*nx_);
+        m->lbfgs_y.resize(lbfgs_memory_*nx_);
+      }
+      if (m->iter_count==1) m->lbfgs_n = 0;
+      casadi_int k = m->lbfgs_n++ % lbfgs_memory_;
+      casadi_copy(d->dx, nx_, get_ptr(m->lbfgs_s) + k*nx_);
+      casadi_copy(d->gLag, nx_, get_ptr(m->lbfgs_y) + k*nx_);
+      casadi_axpy(nx_, -1., d->gLag_old, get_ptr(m->lbfgs_y) + k*nx_);
+      // Rebuild the Hessian approximation
+      lbfgs_rebuild(m, d->Bk, m->w);
     } else {
-      ScopedTiming tic(m->fstats.at("BFGS"));
+      ScopedTiming tic(m->fstats.at("BFGS"), record_time_);
       // Update BFGS
       if (m->iter_count % lbfgs_memory_ == 0) casadi_bfgs_reset(Hsp_, d->Bk);
       // Update the Hessian approximation
-      casadi_bfgs(Hsp_, d->Bk, d->dx, d->gLag, d->gLag_old, m->w);
+      bfgs_update(d->Bk, d->dx, d->gLag, d->gLag_old, m->w);
     }
 
     // Formulate the QP
@@ -708,7 +953,7 @@ int Sqpmethod::solve(void* mem) const {
     if (max_iter_ls_>0) { // max_iter_ls_== 0 disables line-search
       // Line-search
       if (verbose_) print("Starting line-search\n");
-      ScopedTiming tic(m->fstats.at("linesearch"));
+      ScopedTiming tic(m->fstats.at("linesearch"), record_time_);
 
       // Reset line-search counter, success marker
       ls_iter = 0;
@@ -728,48 +973,53 @@ int Sqpmethod::solve(void* mem) const {
       //double meritmax = casadi_vfmax(d->merit_mem+1,
       //  std::min(merit_memsize_, static_cast<casadi_int>(m->iter_count))-1, d->merit_mem[0]);
 
-      // Line-search loop
-      while (true) {
-        // Increase counter
-        ls_iter++;
-
-        // Candidate step
-        casadi_copy(d_nlp->z, nx_, d->z_cand);
-        casadi_axpy(nx_, t, d->dx, d->z_cand);
-
-        // Evaluating objective and constraints
-        if (!so_corr_ || !so_succes) {
-          m->arg[0] = d->z_cand;
-          m->arg[1] = d_nlp->p;
-          m->res[0] = &fk_cand;
-          m->res[1] = d->z_cand + nx_;
-          if (calc_function(m, "nlp_fg")) {
-            // Avoid infinite recursion
-            if (ls_iter == max_iter_ls_) {
-              ls_success = false;
-              l1_infeas = nan;
-              break;
+      // Evaluate several step lengths at once
+      if (max_num_threads_>1 && !(so_corr_ && so_succes)) {
+        if (parallel_linesearch(m, l1, tl1, t, ls_iter, ls_success)) l1_infeas = nan;
+      } else {
+        // Line-search loop
+        while (true) {
+          // Increase counter
+          ls_iter++;
+
+          // Candidate step
+          casadi_copy(d_nlp->z, nx_, d->z_cand);
+          casadi_axpy(nx_, t, d->dx, d->z_cand);
+
+          // Evaluating objective and constraints
+          if (!so_corr_ || !so_succes) {
+            m->arg[0] = d->z_cand;
+            m->arg[1] = d_nlp->p;
+            m->res[0] = &fk_cand;
+            m->res[1] = d->z_cand + nx_;
+            if (calc_function(m, "nlp_fg")) {
+              // Avoid infinite recursion
+              if (ls_iter == max_iter_ls_) {
+                ls_success = false;
+                l1_infeas = nan;
+                break;
+              }
+              // line-search failed, skip iteration
+              t = beta_ * t;
+              continue;
             }
-            // line-search failed, skip iteration
-            t = beta_ * t;
-            continue;
           }
-        }
 
-        // Calculating merit-function in candidate
-        l1_cand = fk_cand + m->sigma*casadi_sum_viol(nx_+ng_, d->z_cand, d_nlp->lbz, d_nlp->ubz);
-        if (l1_cand <= l1 + t * c1_ * tl1) {
-          break;
-        }
+          // Calculating merit-function in candidate
+          l1_cand = fk_cand + m->sigma*casadi_sum_viol(nx_+ng_, d->z_cand, d_nlp->lbz, d_nlp->ubz);
+          if (l1_cand <= l1 + t * c1_ * tl1) {
+            break;
+          }
 
-        // Line-search not successful, but we accept it.
-        if (ls_iter == max_iter_ls_) {
-          ls_success = false;
-          break;
-        }
+          // Line-search not successful, but we accept it.
+          if (ls_iter == max_iter_ls_) {
+            ls_success = false;
+            break;
+          }
 
-        // Backtracking
-        t = beta_ * t;
+          // Backtracking
+          t = beta_ * t;
+        }
       }
 
       // Candidate accepted, update dual variables
@@ -799,6 +1049,9 @@ int Sqpmethod::solve(void* mem) const {
     }
   }
 
+  // Keep the Hessian approximation for warm starting the next call
+  if (warm_start_ && !exact_hessian_) m->Bk_warm.assign(d->Bk, d->Bk + Hsp_.nnz());
+
   return 0;
 }
 
@@ -835,10 +1088,60 @@ void Sqpmethod::print_iteration(casadi_int iter, double obj,
   print("\n");
 }
 
+int Sqpmethod::parallel_linesearch(SqpmethodMemory* m, double l1, double tl1, double& t,
+    casadi_int& ls_iter, bool& ls_success) const {
+  auto d_nlp = &m->d_nlp;
+  auto d = &m->d;
+  casadi_int nz = nx_ + ng_;
+  while (true) {
+    // Step lengths t, beta*t, beta^2*t, ... tried in this round
+    casadi_int n = std::min(static_cast<casadi_int>(max_num_threads_), max_iter_ls_ - ls_iter);
+    std::vector<double> tk(n, t);
+    for (casadi_int k=1; k<n; ++k) tk[k] = beta_ * tk[k-1];
+
+    // Evaluate objective and constraints, each candidate with its own local memory
+    ThreadPool::instance().run(n, [&](casadi_int k) {
+      double* zk = get_ptr(m->ls_z) + k*nz;
+      casadi_copy(d_nlp->z, nx_, zk);
+      casadi_axpy(nx_, tk[k], d->dx, zk);
+      const double* arg[2] = {zk, d_nlp->p};
+      auto ml = m->thread_local_mem.at(k);
+      ml->res[0] = get_ptr(m->ls_f) + k;
+      ml->res[1] = zk + nx_;
+      m->ls_flag[k] = calc_function(m, "nlp_fg", arg, k);
+    });
+
+    // Take the largest step length satisfying the Armijo condition
+    for (casadi_int k=0; k<n; ++k) {
+      ls_iter++;
+      t = tk[k];
+      const double* zk = get_ptr(m->ls_z) + k*nz;
+      if (m->ls_flag[k]) {
+        // Evaluation failed, accept the last candidate anyway
+        if (ls_iter == max_iter_ls_) {
+          ls_success = false;
+          casadi_copy(zk, nz, d->z_cand);
+          return 1;
+        }
+        continue;
+      }
+      double l1_cand = m->ls_f[k] + m->sigma*casadi_sum_viol(nz, zk, d_nlp->lbz, d_nlp->ubz);
+      if (l1_cand <= l1 + t * c1_ * tl1 || ls_iter == max_iter_ls_) {
+        ls_success = l1_cand <= l1 + t * c1_ * tl1;
+        casadi_copy(zk, nz, d->z_cand);
+        return 0;
+      }
+    }
+
+    // Backtracking
+    t = beta_ * t;
+  }
+}
+
 int Sqpmethod::solve_QP(SqpmethodMemory* m, const double* H, const double* g,
     const double* lbdz, const double* ubdz, const double* A,
     double* x_opt, double* dlam, int mode) const {
-  ScopedTiming tic(m->fstats.at("QP"));
+  ScopedTiming tic(m->fstats.at("QP"), record_time_);
   // Inputs
   std::fill_n(m->arg, qpsol_.n_in(), nullptr);
   m->arg[CONIC_H] = H;
@@ -879,7 +1182,7 @@ int Sqpmethod::solve_QP(SqpmethodMemory* m, const double* H, const double* g,
 int Sqpmethod::solve_ela_QP(SqpmethodMemory* m, const double* H, const double* g,
                           const double* lbdz, const double* ubdz, const double* A,
                           double* x_opt, double* dlam) const {
-  ScopedTiming tic(m->fstats.at("QP"));
+  ScopedTiming tic(m->fstats.at("QP"), record_time_);
   // Inputs
   std::fill_n(m->arg, qpsol_ela_.n_in(), nullptr);
   m->arg[CONIC_H] = H;
@@ -1543,11 +1846,20 @@ Dict Sqpmethod::get_stats(void* mem) const {
   auto m = static_cast<SqpmethodMemory*>(mem);
   stats["return_status"] = m->return_status;
   stats["iter_count"] = m->iter_count;
+  if (!m->inf_pr.empty()) {
+    Dict iterations;
+    iterations["inf_pr"] = m->inf_pr;
+    iterations["inf_du"] = m->inf_du;
+    iterations["d_norm"] = m->d_norm;
+    iterations["regularization_size"] = m->regularization_size;
+    iterations["obj"] = m->obj;
+    stats["iterations"] = iterations;
+  }
   return stats;
 }
 
 Sqpmethod::Sqpmethod(DeserializingStream& s) : Nlpsol(s) {
-  int version = s.version("Sqpmethod", 1, 3);
+  int version = s.version("Sqpmethod", 1, 5);
   s.unpack("Sqpmethod::qpsol", qpsol_);
   if (version>=3) {
     s.unpack("Sqpmethod::qpsol_ela", qpsol_ela_);
@@ -1556,6 +1868,13 @@ Sqpmethod::Sqpmethod(DeserializingStream& s) : Nlpsol(s) {
   s.unpack("Sqpmethod::max_iter", max_iter_);
   s.unpack("Sqpmethod::min_iter", min_iter_);
   s.unpack("Sqpmethod::lbfgs_memory", lbfgs_memory_);
+  if (version>=4) {
+    s.unpack("Sqpmethod::lbfgs_compact", lbfgs_compact_);
+    s.unpack("Sqpmethod::blocks", blocks_);
+  } else {
+    lbfgs_compact_ = false;
+    blocks_ = {0, nx_};
+  }
   s.unpack("Sqpmethod::tol_pr_", tol_pr_);
   s.unpack("Sqpmethod::tol_du_", tol_du_);
   s.unpack("Sqpmethod::min_step_size_", min_step_size_);
@@ -1563,6 +1882,11 @@ Sqpmethod::Sqpmethod(DeserializingStream& s) : Nlpsol(s) {
   s.unpack("Sqpmethod::beta", beta_);
   s.unpack("Sqpmethod::max_iter_ls_", max_iter_ls_);
   s.unpack("Sqpmethod::merit_memsize_", merit_memsize_);
+  if (version>=5) {
+    s.unpack("Sqpmethod::parallel_ls", parallel_ls_);
+  } else {
+    parallel_ls_ = false;
+  }
   s.unpack("Sqpmethod::beta", beta_);
   s.unpack("Sqpmethod::print_header", print_header_);
   s.unpack("Sqpmethod::print_iteration", print_iteration_);
@@ -1616,18 +1940,21 @@ Sqpmethod::Sqpmethod(DeserializingStream& s) : Nlpsol(s) {
     s.unpack("Sqpmethod::convexify", convexify_);
     if (convexify_) Convexify::deserialize(s, "Sqpmethod::", convexify_data_);
   }
+  set_bfgs_blocks();
   set_sqpmethod_prob();
 }
 
 void Sqpmethod::serialize_body(SerializingStream &s) const {
   Nlpsol::serialize_body(s);
-  s.version("Sqpmethod", 3);
+  s.version("Sqpmethod", 5);
   s.pack("Sqpmethod::qpsol", qpsol_);
   s.pack("Sqpmethod::qpsol_ela", qpsol_ela_);
   s.pack("Sqpmethod::exact_hessian", exact_hessian_);
   s.pack("Sqpmethod::max_iter", max_iter_);
   s.pack("Sqpmethod::min_iter", min_iter_);
   s.pack("Sqpmethod::lbfgs_memory", lbfgs_memory_);
+  s.pack("Sqpmethod::lbfgs_compact", lbfgs_compact_);
+  s.pack("Sqpmethod::blocks", blocks_);
   s.pack("Sqpmethod::tol_pr_", tol_pr_);
   s.pack("Sqpmethod::tol_du_", tol_du_);
   s.pack("Sqpmethod::min_step_size_", min_step_size_);
@@ -1635,6 +1962,7 @@ void Sqpmethod::serialize_body(SerializingStream &s) const {
   s.pack("Sqpmethod::beta", beta_);
   s.pack("Sqpmethod::max_iter_ls_", max_iter_ls_);
   s.pack("Sqpmethod::merit_memsize_", merit_memsize_);
+  s.pack("Sqpmethod::parallel_ls", parallel_ls_);
   s.pack("Sqpmethod::beta", beta_);
   s.pack("Sqpmethod::print_header", print_header_);
   s.pack("Sqpmethod::print_iteration", print_iteration_);
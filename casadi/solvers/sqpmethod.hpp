@@ -56,6 +56,25 @@ namespace casadi {
 
     /// Iteration count
     int iter_count;
+
+    /// BFGS approximation at the end of the previous call, for warm starting
+    std::vector<double> Bk_warm;
+
+    /// Stored steps and gradient differences for the compact L-BFGS approximation
+    std::vector<double> lbfgs_s, lbfgs_y;
+
+    /// Number of stored pairs since the start of the solve
+    casadi_int lbfgs_n;
+
+    /// Primal-constraint vectors, objectives and return flags of parallel line-search candidates
+    std::vector<double> ls_z, ls_f;
+    std::vector<int> ls_flag;
+
+    /// Per diagonal Hessian block: no convexification needed in the previous iteration
+    std::vector<casadi_int> cvx_pd;
+
+    /// Iteration history, returned in the stats
+    std::vector<double> inf_pr, inf_du, d_norm, regularization_size, obj;
   };
 
   /** \brief  \pluginbrief{Nlpsol,sqpmethod}
@@ -127,6 +146,13 @@ namespace casadi {
     /// Memory size of L-BFGS method
     casadi_int lbfgs_memory_;
 
+    /// Rebuild the BFGS approximation from the last lbfgs_memory_ pairs
+    bool lbfgs_compact_;
+
+    /// Diagonal blocks of the BFGS approximation and their (dense) sparsity patterns
+    std::vector<casadi_int> blocks_;
+    std::vector<Sparsity> block_sp_;
+
     /// Tolerance of primal and dual infeasibility
     double tol_pr_, tol_du_;
 
@@ -148,6 +174,7 @@ namespace casadi {
     double beta_;
     casadi_int max_iter_ls_;
     casadi_int merit_memsize_;
+    bool parallel_ls_;
     ///@}
 
     // Print options
@@ -185,6 +212,16 @@ namespace casadi {
       double dx_norm, double rg, casadi_int ls_trials, bool ls_success,
       bool so_succes, std::string info) const;
 
+    /// Set up the diagonal blocks of the BFGS approximation
+    void set_bfgs_blocks();
+
+    /// BFGS update of each diagonal block
+    void bfgs_update(double* Bk, const double* dx, const double* glag,
+      const double* glag_old, double* w) const;
+
+    /// Rebuild the BFGS approximation from the stored pairs
+    void lbfgs_rebuild(SqpmethodMemory* m, double* Bk, double* w) const;
+
     // Solve the QP subproblem: mode 0 = normal, mode 1 = SOC
     virtual int solve_QP(SqpmethodMemory* m, const double* H, const double* g,
       const double* lbdz, const double* ubdz,
@@ -196,6 +233,14 @@ namespace casadi {
       const double* lbdz, const double* ubdz, const double* A,
       double* x_opt, double* dlam) const;
 
+    /** \brief Backtracking line-search, evaluating max_num_threads_ step lengths at once
+
+        The accepted step length and candidate are the ones of the serial line-search.
+        Returns 1 if the last candidate could not be evaluated.
+    */
+    int parallel_linesearch(SqpmethodMemory* m, double l1, double tl1, double& t,
+      casadi_int& ls_iter, bool& ls_success) const;
+
     // Execute elastic mode: mode 0 = normal, mode 1 = SOC
     virtual int solve_elastic_mode(SqpmethodMemory* m, casadi_int* ela_it, double gamma_1,
       casadi_int ls_iter, bool ls_success, bool so_succes, double pr_inf,
@@ -238,6 +283,9 @@ namespace casadi {
 
   private:
     void set_sqpmethod_prob();
+
+    // Create the real-time iteration preparation and feedback functions
+    void setup_rti();
   };
 
 } // namespace casadi
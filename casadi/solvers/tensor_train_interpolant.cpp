@@ -0,0 +1,387 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "tensor_train_interpolant.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTERPOLANT_TENSOR_TRAIN_EXPORT
+  casadi_register_interpolant_tensor_train(Interpolant::Plugin* plugin) {
+    plugin->creator = TensorTrainInterpolant::creator;
+    plugin->name = "tensor_train";
+    plugin->doc = TensorTrainInterpolant::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &TensorTrainInterpolant::options_;
+    plugin->deserialize = &TensorTrainInterpolant::deserialize;
+    plugin->exposed.do_inline = nullptr;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTERPOLANT_TENSOR_TRAIN_EXPORT casadi_load_interpolant_tensor_train() {
+    Interpolant::registerPlugin(casadi_register_interpolant_tensor_train);
+  }
+
+  const Options TensorTrainInterpolant::options_
+  = {{&Interpolant::options_},
+     {{"tol",
+       {OT_DOUBLE,
+        "Relative accuracy of the compressed table in the Frobenius norm. "
+        "Default value is 1e-10."}},
+      {"max_rank",
+       {OT_INT,
+        "Upper bound on the ranks of the tensor train (default: no bound)."}}
+     }
+  };
+
+  TensorTrainInterpolant::
+  TensorTrainInterpolant(const std::string& name,
+                         const std::vector<double>& grid,
+                         const std::vector<casadi_int>& offset,
+                         const std::vector<double>& values,
+                         casadi_int m)
+                         : Interpolant(name, grid, offset, values, m) {
+  }
+
+  TensorTrainInterpolant::~TensorTrainInterpolant() {
+    clear_mem();
+  }
+
+  TensorTrainInterpolantJac::~TensorTrainInterpolantJac() {
+    clear_mem();
+  }
+
+  /// Eigendecomposition of a symmetric matrix by cyclic Jacobi rotations, descending order
+  static void symm_eig(casadi_int n, std::vector<double>& A,
+                       std::vector<double>& eig, std::vector<double>& V) {
+    std::vector<double> Q(n*n, 0);
+    for (casadi_int i=0; i<n; ++i) Q[i+n*i] = 1;
+    for (casadi_int sweep=0; sweep<100; ++sweep) {
+      // Converged when the off-diagonal part is negligible
+      double off = 0, diag = 0;
+      for (casadi_int q=0; q<n; ++q) {
+        for (casadi_int p=0; p<q; ++p) off += A[p+n*q]*A[p+n*q];
+        diag += A[q+n*q]*A[q+n*q];
+      }
+      if (off<=1e-30*diag) break;
+      for (casadi_int q=0; q<n; ++q) {
+        for (casadi_int p=0; p<q; ++p) {
+          double apq = A[p+n*q];
+          if (apq==0) continue;
+          // Rotation annihilating A(p, q)
+          double theta = (A[q+n*q]-A[p+n*p])/(2*apq);
+          double t = (theta>=0 ? 1 : -1)/(std::fabs(theta)+std::sqrt(theta*theta+1));
+          double c = 1/std::sqrt(t*t+1), s = t*c;
+          for (casadi_int k=0; k<n; ++k) {
+            double akp = A[k+n*p], akq = A[k+n*q];
+            A[k+n*p] = c*akp - s*akq;
+            A[k+n*q] = s*akp + c*akq;
+          }
+          for (casadi_int k=0; k<n; ++k) {
+            double apk = A[p+n*k], aqk = A[q+n*k];
+            A[p+n*k] = c*apk - s*aqk;
+            A[q+n*k] = s*apk + c*aqk;
+          }
+          for (casadi_int k=0; k<n; ++k) {
+            double qkp = Q[k+n*p], qkq = Q[k+n*q];
+            Q[k+n*p] = c*qkp - s*qkq;
+            Q[k+n*q] = s*qkp + c*qkq;
+          }
+        }
+      }
+    }
+    // Sort by decreasing eigenvalue
+    std::vector<casadi_int> order = range(n);
+    std::stable_sort(order.begin(), order.end(),
+      [&](casadi_int a, casadi_int b) { return A[a+n*a]>A[b+n*b];});
+    eig.resize(n);
+    V.resize(n*n);
+    for (casadi_int i=0; i<n; ++i) {
+      eig[i] = A[order[i]+n*order[i]];
+      std::copy(Q.begin()+n*order[i], Q.begin()+n*(order[i]+1), V.begin()+n*i);
+    }
+  }
+
+  void TensorTrainInterpolant::compress(double tol, casadi_int max_rank) {
+    // Permitted squared error per truncation, relative to the table
+    double nrm2 = 0;
+    for (double v : values_) nrm2 += v*v;
+    double delta2 = tol*tol*nrm2/static_cast<double>(ndim_);
+
+    // Successive unfoldings of the table, with the outputs as leading mode
+    std::vector<double> M = values_, G, eig, V, W;
+    rank_.resize(ndim_+1);
+    core_offset_.resize(ndim_);
+    cores_.clear();
+    casadi_int r_prev = 1;
+    for (casadi_int k=0; k<=ndim_; ++k) {
+      casadi_int n = k==0 ? m_ : offset_[k]-offset_[k-1];
+      casadi_int nrow = r_prev*n, ncol = M.size()/nrow;
+      if (k>0) core_offset_[k-1] = cores_.size();
+      // The last core is what remains
+      if (k==ndim_) {
+        cores_.insert(cores_.end(), M.begin(), M.end());
+        rank_[ndim_] = 1;
+        break;
+      }
+      // Gram matrix of the unfolding
+      G.assign(nrow*nrow, 0);
+      for (casadi_int c=0; c<ncol; ++c) {
+        const double* Mc = get_ptr(M) + nrow*c;
+        for (casadi_int j=0; j<nrow; ++j) {
+          if (Mc[j]==0) continue;
+          for (casadi_int i=j; i<nrow; ++i) G[i+nrow*j] += Mc[i]*Mc[j];
+        }
+      }
+      for (casadi_int j=0; j<nrow; ++j) {
+        for (casadi_int i=j+1; i<nrow; ++i) G[j+nrow*i] = G[i+nrow*j];
+      }
+      // Dominant left singular vectors
+      symm_eig(nrow, G, eig, V);
+      casadi_int r = std::min(nrow, ncol);
+      double discarded = 0;
+      while (r>1 && discarded+std::max(eig[r-1], 0.)<=delta2) {
+        discarded += std::max(eig[r-1], 0.);
+        r--;
+      }
+      if (max_rank>0) r = std::min(r, max_rank);
+      cores_.insert(cores_.end(), V.begin(), V.begin()+nrow*r);
+      // Project the unfolding onto them
+      W.assign(r*ncol, 0);
+      for (casadi_int c=0; c<ncol; ++c) {
+        for (casadi_int b=0; b<r; ++b) {
+          double s = 0;
+          for (casadi_int i=0; i<nrow; ++i) s += V[i+nrow*b]*M[i+nrow*c];
+          W[b+r*c] = s;
+        }
+      }
+      M.swap(W);
+      rank_[k] = r_prev = r;
+    }
+  }
+
+  void TensorTrainInterpolant::init(const Dict& opts) {
+    double tol = 1e-10;
+    casadi_int max_rank = -1;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="tol") {
+        tol = op.second;
+      } else if (op.first=="max_rank") {
+        max_rank = op.second;
+      }
+    }
+
+    // Call the base class initializer
+    Interpolant::init(opts);
+
+    casadi_assert(!has_parametric_grid(), "Parametric grid not supported");
+    casadi_assert(!has_parametric_values(), "Parametric values not supported");
+
+    lookup_mode_ = Interpolant::interpret_lookup_mode(lookup_modes_, grid_, offset_);
+
+    compress(tol, max_rank);
+    if (verbose_) {
+      casadi_message("Tensor train ranks " + str(rank_) + ", " + str(cores_.size())
+        + " coefficients for a table of " + str(values_.size()) + " values.");
+    }
+
+    // The table lives on in the cores, keep a placeholder so it does not become parametric
+    values_.assign(1, 0.);
+
+    // Needed by casadi_interptt
+    alloc_w(2*(*std::max_element(rank_.begin(), rank_.end())), true);
+  }
+
+  int TensorTrainInterpolant::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    if (!res[0]) return 0;
+    for (casadi_int k=0; k<batch_x_; ++k) {
+      casadi_interptt(res[0] + k*m_, ndim_, get_ptr(grid_), get_ptr(offset_),
+        get_ptr(cores_), get_ptr(core_offset_), get_ptr(rank_),
+        arg[0] ? arg[0] + k*ndim_ : nullptr, get_ptr(lookup_mode_), m_, w);
+    }
+    return 0;
+  }
+
+  void TensorTrainInterpolant::codegen_body(CodeGenerator& g) const {
+    std::string grid = g.constant(grid_), offset = g.constant(offset_);
+    std::string cores = g.constant(cores_), core_offset = g.constant(core_offset_);
+    std::string rank = g.constant(rank_), lookup_mode = g.constant(lookup_mode_);
+    g << "  if (res[0]) {\n";
+    if (batch_x_==1) {
+      g << "    " << g.interptt("res[0]", ndim_, grid, offset, cores, core_offset, rank,
+        "arg[0]", lookup_mode, m_, "w") << "\n";
+    } else {
+      g.local("k", "casadi_int");
+      g << "    for (k=0; k<" << batch_x_ << "; ++k) {\n"
+        << "      " << g.interptt("res[0]+k*" + str(m_), ndim_, grid, offset, cores,
+          core_offset, rank, "arg[0] ? arg[0]+k*" + str(ndim_) + " : 0", lookup_mode, m_, "w")
+        << "\n"
+        << "    }\n";
+    }
+    g << "  }\n";
+  }
+
+  Function TensorTrainInterpolant::
+  get_jacobian(const std::string& name,
+                  const std::vector<std::string>& inames,
+                  const std::vector<std::string>& onames,
+                  const Dict& opts) const {
+    Function ret;
+    ret.own(new TensorTrainInterpolantJac(name));
+    ret->construct(opts);
+    return ret;
+  }
+
+  Function TensorTrainInterpolantJac::
+  get_jacobian(const std::string& name,
+                  const std::vector<std::string>& inames,
+                  const std::vector<std::string>& onames,
+                  const Dict& opts) const {
+    std::vector<MX> args = mx_in();
+    std::vector<MX> res(n_out_);
+    for (casadi_int i=0;i<n_out_;++i)
+      res[i] = DM(size1_out(i), size2_out(i));
+    Function f("f", args, res);
+
+    return f->get_jacobian(name, inames, onames, Dict());
+  }
+
+  void TensorTrainInterpolantJac::init(const Dict& opts) {
+    // Call the base class initializer
+    FunctionInternal::init(opts);
+
+    // Needed by casadi_interptt_grad
+    auto m = derivative_of_.get<TensorTrainInterpolant>();
+    casadi_int rmax = *std::max_element(m->rank_.begin(), m->rank_.end());
+    alloc_w(m->ndim_ + (m->ndim_+2)*rmax + 2*m->m_*rmax, true);
+    alloc_iw(m->ndim_, true);
+    // Gradient of a single point, scattered into the block diagonal
+    if (m->batch_x_>1) alloc_w(m->ndim_*m->m_, true);
+  }
+
+  int TensorTrainInterpolantJac::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = derivative_of_.get<TensorTrainInterpolant>();
+    if (!res[0]) return 0;
+    casadi_int ndim = m->ndim_, nm = m->m_, nb = m->batch_x_;
+    casadi_int rmax = *std::max_element(m->rank_.begin(), m->rank_.end());
+    if (nb==1) {
+      casadi_interptt_grad(res[0], ndim, get_ptr(m->grid_), get_ptr(m->offset_),
+        get_ptr(m->cores_), get_ptr(m->core_offset_), get_ptr(m->rank_), arg[0],
+        get_ptr(m->lookup_mode_), nm, iw, w);
+      return 0;
+    }
+
+    // Dense Jacobian of all points, nonzero only in diagonal blocks
+    double* grad = w + ndim + (ndim+2)*rmax + 2*nm*rmax;
+    casadi_clear(res[0], nnz_out(0));
+    for (casadi_int k=0; k<nb; ++k) {
+      casadi_interptt_grad(grad, ndim, get_ptr(m->grid_), get_ptr(m->offset_),
+        get_ptr(m->cores_), get_ptr(m->core_offset_), get_ptr(m->rank_),
+        arg[0] ? arg[0]+k*ndim : nullptr, get_ptr(m->lookup_mode_), nm, iw, w);
+      for (casadi_int i=0; i<ndim; ++i) {
+        casadi_copy(grad+i*nm, nm, res[0] + (k*ndim+i)*nm*nb + k*nm);
+      }
+    }
+    return 0;
+  }
+
+  void TensorTrainInterpolantJac::codegen_body(CodeGenerator& g) const {
+    auto m = derivative_of_.get<TensorTrainInterpolant>();
+    casadi_int ndim = m->ndim_, nm = m->m_, nb = m->batch_x_;
+    casadi_int rmax = *std::max_element(m->rank_.begin(), m->rank_.end());
+    std::string grid = g.constant(m->grid_), offset = g.constant(m->offset_);
+    std::string cores = g.constant(m->cores_), core_offset = g.constant(m->core_offset_);
+    std::string rank = g.constant(m->rank_), lookup_mode = g.constant(m->lookup_mode_);
+    if (nb==1) {
+      g << "  " << g.interptt_grad("res[0]", ndim, grid, offset, cores, core_offset, rank,
+        "arg[0]", lookup_mode, nm, "iw", "w") << "\n";
+      return;
+    }
+
+    // Dense Jacobian of all points, nonzero only in diagonal blocks
+    std::string grad = "w+" + str(ndim + (ndim+2)*rmax + 2*nm*rmax);
+    g.local("k", "casadi_int");
+    g.local("i", "casadi_int");
+    g << "  if (!res[0]) return 0;\n";
+    g << "  " << g.clear("res[0]", nnz_out(0)) << "\n";
+    g << "  for (k=0; k<" << nb << "; ++k) {\n";
+    g << "    " << g.interptt_grad(grad, ndim, grid, offset, cores, core_offset, rank,
+      "arg[0] ? arg[0]+k*" + str(ndim) + " : 0", lookup_mode, nm, "iw", "w") << "\n";
+    g << "    for (i=0; i<" << ndim << "; ++i) {\n";
+    g << "      " << g.copy(grad + "+i*" + str(nm), nm,
+      "res[0]+(k*" + str(ndim) + "+i)*" + str(nm*nb) + "+k*" + str(nm)) << "\n";
+    g << "    }\n";
+    g << "  }\n";
+  }
+
+  TensorTrainInterpolant::TensorTrainInterpolant(DeserializingStream& s) : Interpolant(s) {
+    s.version("TensorTrainInterpolant", 1);
+    s.unpack("TensorTrainInterpolant::lookup_mode", lookup_mode_);
+    s.unpack("TensorTrainInterpolant::rank", rank_);
+    s.unpack("TensorTrainInterpolant::core_offset", core_offset_);
+    s.unpack("TensorTrainInterpolant::cores", cores_);
+  }
+
+  ProtoFunction* TensorTrainInterpolant::deserialize(DeserializingStream& s) {
+    s.version("TensorTrainInterpolant", 1);
+    char type;
+    s.unpack("TensorTrainInterpolant::type", type);
+    switch (type) {
+      case 'f': return new TensorTrainInterpolant(s);
+      case 'j': return new TensorTrainInterpolantJac(s);
+      default:
+        casadi_error("TensorTrainInterpolant::deserialize error");
+    }
+  }
+
+  void TensorTrainInterpolant::serialize_body(SerializingStream &s) const {
+    Interpolant::serialize_body(s);
+    s.version("TensorTrainInterpolant", 1);
+    s.pack("TensorTrainInterpolant::lookup_mode", lookup_mode_);
+    s.pack("TensorTrainInterpolant::rank", rank_);
+    s.pack("TensorTrainInterpolant::core_offset", core_offset_);
+    s.pack("TensorTrainInterpolant::cores", cores_);
+  }
+
+  void TensorTrainInterpolant::serialize_type(SerializingStream &s) const {
+    Interpolant::serialize_type(s);
+    s.version("TensorTrainInterpolant", 1);
+    s.pack("TensorTrainInterpolant::type", 'f');
+  }
+
+  void TensorTrainInterpolantJac::serialize_type(SerializingStream &s) const {
+    FunctionInternal::serialize_type(s);
+    auto m = derivative_of_.get<TensorTrainInterpolant>();
+    m->PluginInterface<Interpolant>::serialize_type(s);
+    s.version("TensorTrainInterpolant", 1);
+    s.pack("TensorTrainInterpolant::type", 'j');
+  }
+
+} // namespace casadi
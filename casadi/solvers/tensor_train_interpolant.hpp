@@ -0,0 +1,184 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_TENSOR_TRAIN_INTERPOLANT_HPP
+#define CASADI_TENSOR_TRAIN_INTERPOLANT_HPP
+
+#include "casadi/core/interpolant_impl.hpp"
+#include <casadi/solvers/casadi_interpolant_tensor_train_export.h>
+
+/** \defgroup plugin_Interpolant_tensor_train Title
+    \par
+*/
+
+/** \pluginsection{Interpolant,tensor_train} */
+
+/// \cond INTERNAL
+
+namespace casadi {
+  /** \brief \pluginbrief{Interpolant,tensor_train}
+
+    Multilinear interpolant of a compressed table.
+
+    The tensor of values is approximated by a tensor train (TT-SVD) with
+    one core per grid dimension, truncated to a relative accuracy 'tol' in
+    the Frobenius norm. Interpolating each core in its own dimension and
+    contracting the train gives the multilinear interpolant of the
+    compressed table, at a cost linear in the number of dimensions.
+
+    @copydoc Interpolant_doc
+    @copydoc plugin_Interpolant_tensor_train
+  */
+  class CASADI_INTERPOLANT_TENSOR_TRAIN_EXPORT TensorTrainInterpolant : public Interpolant {
+  public:
+    // Constructor
+    TensorTrainInterpolant(const std::string& name,
+                           const std::vector<double>& grid,
+                           const std::vector<casadi_int>& offset,
+                           const std::vector<double>& values,
+                           casadi_int m);
+
+    // Destructor
+    ~TensorTrainInterpolant() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "tensor_train";}
+
+    // Name of the class
+    std::string class_name() const override { return "TensorTrainInterpolant";}
+
+    /** \brief  Create a new Interpolant */
+    static Interpolant* creator(const std::string& name,
+                                const std::vector<double>& grid,
+                                const std::vector<casadi_int>& offset,
+                                const std::vector<double>& values,
+                                casadi_int m) {
+      return new TensorTrainInterpolant(name, grid, offset, values, m);
+    }
+
+    // Initialize
+    void init(const Dict& opts) override;
+
+    /// Evaluate numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    ///@{
+    /** \brief Full Jacobian */
+    bool has_jacobian() const override { return true;}
+    Function get_jacobian(const std::string& name,
+                                      const std::vector<std::string>& inames,
+                                      const std::vector<std::string>& onames,
+                                      const Dict& opts) const override;
+    ///@}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+    /** \brief Serialize type information */
+    void serialize_type(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s);
+
+    /// Compress the table of values into a tensor train
+    void compress(double tol, casadi_int max_rank);
+
+    std::vector<casadi_int> lookup_mode_;
+
+    /// TT ranks, rank_[0] connects to the output core, rank_[ndim_]==1
+    std::vector<casadi_int> rank_;
+
+    /// Output core (m-by-rank_[0]) followed by one core per dimension
+    std::vector<double> cores_;
+
+    /// Offset of the core of each dimension in cores_
+    std::vector<casadi_int> core_offset_;
+
+  protected:
+     /** \brief Deserializing constructor */
+    explicit TensorTrainInterpolant(DeserializingStream& s);
+  };
+
+  /** First order derivatives */
+  class CASADI_INTERPOLANT_TENSOR_TRAIN_EXPORT TensorTrainInterpolantJac : public FunctionInternal {
+  public:
+    /// Constructor
+    TensorTrainInterpolantJac(const std::string& name) : FunctionInternal(name) {}
+
+    /// Destructor
+    ~TensorTrainInterpolantJac() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override { return "TensorTrainInterpolantJac";}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    // Initialize
+    void init(const Dict& opts) override;
+
+    /// Evaluate numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    ///@{
+    /** \brief Full Jacobian */
+    bool has_jacobian() const override { return true;}
+    Function get_jacobian(const std::string& name,
+                                      const std::vector<std::string>& inames,
+                                      const std::vector<std::string>& onames,
+                                      const Dict& opts) const override;
+    ///@}
+
+    /** \brief Serialize type information */
+    void serialize_type(SerializingStream &s) const override;
+
+    /** \brief String used to identify the immediate FunctionInternal subclass */
+    std::string serialize_base_function() const override { return "Interpolant"; }
+
+    /** \brief Deserializing constructor */
+    explicit TensorTrainInterpolantJac(DeserializingStream& s) : FunctionInternal(s) {}
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_TENSOR_TRAIN_INTERPOLANT_HPP
@@ -133,6 +133,19 @@ int usage_c(){
   printf("result (0): %g\n",res0);
   printf("result (1): [%g,%g;%g,%g]\n",res1[0],res1[1],res1[2],res1[3]);
 
+  /* Prepared call: bind buffers once, then evaluate repeatedly */
+  int handle = casadi_c_prepare_id(id);
+  if (handle<0) return 1;
+  casadi_c_prepared_set_arg(handle, 0, x_val);
+  casadi_c_prepared_set_arg(handle, 1, &y_val);
+  casadi_c_prepared_set_res(handle, 0, &res0);
+  casadi_c_prepared_set_res(handle, 1, res1);
+  for (i=0; i<3; ++i) {
+    if (casadi_c_prepared_eval(handle)) return 1;
+  }
+  casadi_c_prepared_release(handle);
+  printf("result (0), prepared call: %g\n",res0);
+
   /* Free memory (thread-safe) */
   casadi_c_decref_id(id);
 
@@ -57,9 +57,18 @@
 #ifdef SWIGPYTHON
 %{
   namespace casadi {
+    // Does the current thread hold the GIL? Not the case in a GIL-releasing evaluation
+    static bool python_has_gil() {
+#ifdef WITH_PYTHON3
+      return PyGILState_Check();
+#else
+      return true;
+#endif
+    }
+
     // Redirect printout
     static void pythonlogger(const char* s, std::streamsize num, bool error) {
-      if (!casadi::InterruptHandler::is_main_thread()) {
+      if (!casadi::InterruptHandler::is_main_thread() || !python_has_gil()) {
         casadi::Logger::writeDefault(s, num, error);
         return;
       }
@@ -76,7 +85,7 @@
     }
 
     static bool pythoncheckinterrupted() {
-      if (!casadi::InterruptHandler::is_main_thread()) return false;
+      if (!casadi::InterruptHandler::is_main_thread() || !python_has_gil()) return false;
       return PyErr_CheckSignals();
     }
 
@@ -3385,6 +3394,11 @@ DECL std::vector< M > casadi_substitute(const std::vector< M >& ex,
   return substitute(ex, v, vdef);
 }
 
+DECL Function casadi_substitute_plan(const std::vector< M >& ex,
+                                     const std::vector< M >& v) {
+  return M::substitute_plan(ex, v);
+}
+
 DECL void casadi_substitute_inplace(const std::vector< M >& v,
                                       std::vector< M >& INOUT1,
                                       std::vector< M >& INOUT2,
@@ -3654,6 +3668,22 @@ casadi_graph_substitute(const std::vector< M > &ex,
                  const std::vector< M > &vdef) {
   return graph_substitute(ex, v, vdef);
 }
+
+DECL Function casadi_graph_substitute_plan(const std::vector< M > &ex,
+                                           const std::vector< M > &v) {
+  return M::graph_substitute_plan(ex, v);
+}
+
+DECL std::vector< M >
+casadi_auto_map(const std::vector< M > &ex,
+                const std::string& parallelization="serial",
+                casadi_int min_calls=2) {
+  return auto_map(ex, parallelization, min_calls);
+}
+DECL std::vector< M >
+casadi_fuse_calls(const std::vector< M > &ex, casadi_int max_nodes=100) {
+  return fuse_calls(ex, max_nodes);
+}
 DECL M casadi_bspline(const M& x,
         const DM& coeffs,
         const std::vector< std::vector<double> >& knots,
@@ -4080,12 +4110,204 @@ namespace casadi{
       fb = FunctionBuffer(self)
       caller = functools.partial(_casadi._function_buffer_eval, fb._self())
       return (fb, caller)
+
+    def numpy_evaluator(self, release_gil=True, parallelization="thread"):
+      """
+      Create a NumpyEvaluator for repeated evaluation on numpy arrays
+
+      """
+      return NumpyEvaluator(self, release_gil, parallelization)
   %}
 
 
  }
 
 }
+
+%inline %{
+namespace casadi {
+  // Evaluate a FunctionBuffer with the global interpreter lock released
+  void _function_buffer_eval_nogil(void* raw) {
+    PyThreadState* state = PyEval_SaveThread();
+    try {
+      static_cast<FunctionBuffer*>(raw)->_eval();
+    } catch (...) {
+      PyEval_RestoreThread(state);
+      throw;
+    }
+    PyEval_RestoreThread(state);
+  }
+} // namespace casadi
+%}
+
+%pythoncode %{
+class NumpyEvaluator(object):
+  """
+  Evaluate a Function on numpy arrays with minimal overhead
+
+  Inputs are read directly from the memory of the numpy arrays and outputs are
+  written in place, without conversion to DM. An argument is either a dense array
+  of the input shape or the vector of structural nonzeros (column major).
+  Arrays with an additional leading dimension N are evaluated as a batch, using
+  a Function.map over N instances; inputs without the leading dimension are
+  shared by all instances.
+
+  Preallocated outputs are passed with the 'out' keyword. Otherwise, dense
+  arrays are returned, with shape (N, n) or (N, n, m) for batches.
+
+  With release_gil, the GIL is released during the numerical evaluation such that
+  Python threads can overlap. Functions calling back into Python, e.g. a Callback,
+  must be evaluated with release_gil=False. Buffers and work vectors are
+  allocated once per thread and per batch size.
+  """
+  def __init__(self, f, release_gil=True, parallelization="thread"):
+    import threading
+    self.f = f
+    self.release_gil = release_gil
+    self.parallelization = parallelization
+    self._local = threading.local()
+    self._sp_in = [f.sparsity_in(i) for i in range(f.n_in())]
+    self._sp_out = [f.sparsity_out(i) for i in range(f.n_out())]
+
+  def _buffer(self, n, shared):
+    # Function and FunctionBuffer for a batch size, cached per thread
+    buffers = getattr(self._local, "buffers", None)
+    if buffers is None:
+      buffers = self._local.buffers = {}
+    key = (n, shared)
+    if key not in buffers:
+      if n is None:
+        f = self.f
+      else:
+        f = self.f.map(self.f.name() + "_map", self.parallelization, n, list(shared), [])
+      buffers[key] = FunctionBuffer(f)
+    return buffers[key]
+
+  @staticmethod
+  def _nonzeros(sp, a):
+    # Structural nonzeros of one instance, without copying if possible
+    import numpy as np
+    if a.ndim==2 and a.shape==sp.shape:
+      a = a.ravel(order='F')
+      if not sp.is_dense(): a = a[np.array(sp.find(), dtype=int)]
+    else:
+      a = a.ravel()
+    if a.size!=sp.nnz():
+      raise ValueError("Expected %d nonzeros or shape %s, got %d" % (sp.nnz(), str(sp.shape), a.size))
+    return np.ascontiguousarray(a)
+
+  @staticmethod
+  def _batch_size(sp, a):
+    # Leading batch dimension of an argument, None if not batched
+    if a.ndim<=1 or a.shape==sp.shape: return None
+    if a.ndim==3 and a.shape[1:]==sp.shape: return a.shape[0]
+    if a.ndim==2 and a.shape[1] in (sp.nnz(), sp.size1() if sp.size2()==1 else -1):
+      return a.shape[0]
+    raise ValueError("Cannot interpret argument of shape %s for input of shape %s" % (str(a.shape), str(sp.shape)))
+
+  @staticmethod
+  def _batch_nonzeros(sp, a):
+    # Structural nonzeros of a batch, instance by instance
+    import numpy as np
+    n = a.shape[0]
+    if a.ndim==3:
+      a = a.transpose(0, 2, 1).reshape(n, -1)
+      if not sp.is_dense(): a = a[:, np.array(sp.find(), dtype=int)]
+    elif a.shape[1]!=sp.nnz():
+      a = a[:, np.array(sp.find(), dtype=int)]
+    return np.ascontiguousarray(a)
+
+  def __call__(self, *args, **kwargs):
+    import numpy as np
+    out = kwargs.pop("out", None)
+    if len(kwargs)>0: raise TypeError("Unexpected keyword arguments: " + str(list(kwargs.keys())))
+    if len(args)>len(self._sp_in): raise TypeError("Too many arguments")
+    args = [np.zeros(0) if a is None else np.asarray(a, dtype=np.float64) for a in args]
+    args += [np.zeros(sp.nnz()) for sp in self._sp_in[len(args):]]
+
+    # Batch size, shared inputs
+    n = None
+    shared = []
+    for i, (sp, a) in enumerate(zip(self._sp_in, args)):
+      if a.size==0 and sp.nnz()>0:
+        args[i] = a = np.zeros(sp.nnz())
+      n_i = self._batch_size(sp, a)
+      if n_i is None:
+        shared.append(i)
+      elif n is None or n==n_i:
+        n = n_i
+      else:
+        raise ValueError("Inconsistent batch sizes %d and %d" % (n, n_i))
+    fb = self._buffer(n, tuple(shared) if n is not None else ())
+
+    # Bind inputs
+    nz_in = []
+    for i, (sp, a) in enumerate(zip(self._sp_in, args)):
+      if n is None or i in shared:
+        nz = self._nonzeros(sp, a)
+      else:
+        nz = self._batch_nonzeros(sp, a)
+      nz_in.append(nz)
+      fb.set_arg(i, memoryview(nz))
+
+    # Bind outputs, written in place when the layout allows
+    if out is None:
+      out = []
+      for sp in self._sp_out:
+        if n is None:
+          out.append(np.zeros(sp.shape, order='F'))
+        elif sp.size2()==1:
+          out.append(np.zeros((n, sp.size1())))
+        else:
+          out.append(np.zeros((n, sp.size2(), sp.size1())).transpose(0, 2, 1))
+    else:
+      out = list(out)
+      if len(out)!=len(self._sp_out): raise ValueError("Expected %d outputs" % len(self._sp_out))
+    nz_out = []
+    for i, (sp, r) in enumerate(zip(self._sp_out, out)):
+      if n is None:
+        direct = r.flags.f_contiguous and r.size==sp.nnz()
+        nz = r.reshape(-1, order='F') if direct else np.empty(sp.nnz())
+      elif r.ndim==3:
+        direct = sp.is_dense() and r.transpose(0, 2, 1).flags.c_contiguous
+        nz = r.transpose(0, 2, 1).reshape(-1) if direct else np.empty(n*sp.nnz())
+      else:
+        direct = r.flags.c_contiguous and r.shape[1]==sp.nnz()
+        nz = r.reshape(-1) if direct else np.empty(n*sp.nnz())
+      nz_out.append(None if direct else nz)
+      fb.set_res(i, memoryview(nz))
+
+    # Evaluate
+    if self.release_gil:
+      _casadi._function_buffer_eval_nogil(fb._self())
+    else:
+      _casadi._function_buffer_eval(fb._self())
+    if fb.ret()!=0:
+      raise RuntimeError("Evaluation of '%s' failed" % self.f.name())
+
+    # Scatter outputs that could not be written in place
+    for sp, r, nz in zip(self._sp_out, out, nz_out):
+      if nz is None: continue
+      if n is None:
+        if r.size==sp.nnz():
+          r[...] = nz.reshape(r.shape, order='F')
+        else:
+          dense = np.zeros(sp.numel())
+          dense[np.array(sp.find(), dtype=int)] = nz
+          r[...] = dense.reshape(sp.shape, order='F')
+      else:
+        nz = nz.reshape(n, sp.nnz())
+        if r.ndim==3:
+          dense = np.zeros((n, sp.numel()))
+          dense[:, np.array(sp.find(), dtype=int)] = nz
+          r.transpose(0, 2, 1)[...] = dense.reshape(n, sp.size2(), sp.size1())
+        elif r.shape[1]==sp.nnz():
+          r[...] = nz
+        else:
+          r.fill(0)
+          r[:, np.array(sp.find(), dtype=int)] = nz
+    return out[0] if len(out)==1 else tuple(out)
+%}
 #endif // SWIGPYTHON
 
 #ifdef SWIGMATLAB
@@ -4417,6 +4639,7 @@ namespace casadi {
 %include <casadi/core/importer.hpp>
 %include <casadi/core/callback.hpp>
 %include <casadi/core/global_options.hpp>
+%include <casadi/core/profiler.hpp>
 %include <casadi/core/casadi_meta.hpp>
 %include <casadi/core/integration_tools.hpp>
 %include <casadi/core/nlp_tools.hpp>
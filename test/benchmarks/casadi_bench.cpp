@@ -0,0 +1,355 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+
+/** Regression benchmarks for core evaluation, algorithmic differentiation,
+    sparsity algorithms, linear solvers, QP and NLP solvers and integrators.
+
+    Usage: casadi_bench [--filter substring] [--min-time seconds] [--min-rep n]
+                        [--format json|csv] [--output file]
+
+    Each benchmark is repeated until both the minimum number of repetitions and the
+    minimum accumulated time are reached. Minimum, median and mean wall times are
+    reported in seconds, together with the CasADi version, so that results from
+    different releases can be compared.
+*/
+
+#include <casadi/casadi.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+using namespace casadi;
+
+namespace {
+
+  struct BenchOptions {
+    std::string filter;
+    double min_time = 0.2;
+    casadi_int min_rep = 3;
+    std::string format = "json";
+    std::string output;
+  };
+
+  struct BenchResult {
+    std::string name;
+    casadi_int n_rep;
+    double t_min, t_median, t_mean;
+  };
+
+  class Bench {
+  public:
+    explicit Bench(const BenchOptions& opts) : opts_(opts) {}
+
+    /// Is a benchmark selected by the filter?
+    bool selected(const std::string& name) const {
+      return opts_.filter.empty() || name.find(opts_.filter) != std::string::npos;
+    }
+
+    /// Time repeated calls to f
+    void run(const std::string& name, const std::function<void()>& f) {
+      if (!selected(name)) return;
+      std::vector<double> t;
+      double t_sum = 0;
+      while (static_cast<casadi_int>(t.size()) < opts_.min_rep || t_sum < opts_.min_time) {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        auto t1 = std::chrono::steady_clock::now();
+        t.push_back(std::chrono::duration<double>(t1 - t0).count());
+        t_sum += t.back();
+      }
+      std::sort(t.begin(), t.end());
+      BenchResult r{name, static_cast<casadi_int>(t.size()), t.front(), t[t.size() / 2],
+        t_sum / static_cast<double>(t.size())};
+      results_.push_back(r);
+      // Progress on stderr, results are written at the end
+      std::cerr << std::setw(40) << std::left << name << std::right << std::scientific
+        << std::setprecision(3) << r.t_min << " s (" << r.n_rep << " reps)" << std::endl;
+    }
+
+    /// Write the results
+    void write(std::ostream& s) const {
+      s << std::setprecision(9) << std::scientific;
+      if (opts_.format == "csv") {
+        s << "name,n_rep,t_min,t_median,t_mean\n";
+        for (auto&& r : results_) {
+          s << r.name << "," << r.n_rep << "," << r.t_min << "," << r.t_median << ","
+            << r.t_mean << "\n";
+        }
+      } else {
+        s << "{\n  \"casadi_version\": \"" << CasadiMeta::version() << "\",\n"
+          << "  \"git_revision\": \"" << CasadiMeta::git_revision() << "\",\n"
+          << "  \"benchmarks\": [";
+        for (size_t i = 0; i < results_.size(); ++i) {
+          const BenchResult& r = results_[i];
+          s << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << r.name << "\", \"n_rep\": "
+            << r.n_rep << ", \"t_min\": " << r.t_min << ", \"t_median\": " << r.t_median
+            << ", \"t_mean\": " << r.t_mean << "}";
+        }
+        s << "\n  ]\n}\n";
+      }
+    }
+
+  private:
+    BenchOptions opts_;
+    std::vector<BenchResult> results_;
+  };
+
+  /// Tridiagonal matrix with 4 on the diagonal and -1 off the diagonal
+  DM tridiag(casadi_int n) {
+    std::vector<casadi_int> row, col;
+    std::vector<double> val;
+    for (casadi_int i = 0; i < n; ++i) {
+      for (casadi_int j = std::max<casadi_int>(i - 1, 0); j <= std::min(i + 1, n - 1); ++j) {
+        row.push_back(i);
+        col.push_back(j);
+        val.push_back(i == j ? 4 : -1);
+      }
+    }
+    return DM::triplet(row, col, val, n, n);
+  }
+
+  /// Sparsity of the 5-point Laplacian on an m-by-m grid
+  Sparsity laplacian(casadi_int m) {
+    std::vector<casadi_int> row, col;
+    for (casadi_int i = 0; i < m; ++i) {
+      for (casadi_int j = 0; j < m; ++j) {
+        casadi_int k = i * m + j;
+        row.push_back(k);
+        col.push_back(k);
+        if (i > 0) row.push_back(k - m), col.push_back(k);
+        if (i < m - 1) row.push_back(k + m), col.push_back(k);
+        if (j > 0) row.push_back(k - 1), col.push_back(k);
+        if (j < m - 1) row.push_back(k + 1), col.push_back(k);
+      }
+    }
+    return Sparsity::triplet(m * m, m * m, row, col);
+  }
+
+  /// Nonlinear test expression: repeated y <- sin(y)*y + A*y with a sparse A
+  template<typename M>
+  M chain(const M& x, casadi_int n_layer) {
+    M A = tridiag(x.size1());
+    M y = x;
+    for (casadi_int k = 0; k < n_layer; ++k) y = sin(y) * y + mtimes(A, y);
+    return y;
+  }
+
+  /// Evaluation and algorithmic differentiation of SX and MX functions
+  template<typename M>
+  void bench_function(Bench& b, const std::string& type, casadi_int n) {
+    M x = M::sym("x", n);
+    M y = chain(x, 10);
+    std::string sfx = "/" + type + "_n" + str(n);
+    std::vector<DM> arg = {DM(std::vector<double>(n, 0.1))};
+    std::vector<DM> res;
+    Function f("f", {x}, {y, dot(y, y)});
+    b.run("eval" + sfx, [&]() { f.call(arg, res); });
+    Function fwd = f.forward(1);
+    std::vector<DM> fwd_arg = {arg[0], DM::zeros(n), 0, arg[0]};
+    b.run("ad_forward" + sfx, [&]() { fwd.call(fwd_arg, res); });
+    Function adj = f.reverse(1);
+    std::vector<DM> adj_arg = {arg[0], DM::zeros(n), 0, DM::zeros(n), 1};
+    b.run("ad_reverse" + sfx, [&]() { adj.call(adj_arg, res); });
+    b.run("jacobian_construct" + sfx, [&]() { Function("J", {x}, {jacobian(y, x)}); });
+    b.run("hessian_construct" + sfx, [&]() { Function("H", {x}, {hessian(dot(y, y), x)}); });
+    Function J("J", {x}, {jacobian(y, x)});
+    b.run("jacobian_eval" + sfx, [&]() { J.call(arg, res); });
+  }
+
+  /// Sparsity algorithms
+  void bench_sparsity(Bench& b, casadi_int m) {
+    Sparsity sp = laplacian(m);
+    std::string sfx = "/laplacian_" + str(m) + "x" + str(m);
+    b.run("sparsity_star_coloring" + sfx, [&]() { sp.star_coloring(); });
+    b.run("sparsity_uni_coloring" + sfx, [&]() { sp.uni_coloring(); });
+    b.run("sparsity_amd" + sfx, [&]() { sp.amd(); });
+    b.run("sparsity_etree" + sfx, [&]() { sp.etree(); });
+    b.run("sparsity_btf" + sfx, [&]() {
+      std::vector<casadi_int> rowperm, colperm, rowblock, colblock, crb, ccb;
+      sp.btf(rowperm, colperm, rowblock, colblock, crb, ccb);
+    });
+    b.run("sparsity_mtimes" + sfx, [&]() { Sparsity::mtimes(sp, sp); });
+  }
+
+  /// Builtin linear solvers
+  void bench_linsol(Bench& b, casadi_int m) {
+    // Symmetric positive definite system
+    Sparsity sp = laplacian(m);
+    DM A = DM(sp, -1);
+    for (casadi_int i = 0; i < sp.size1(); ++i) A(i, i) = 5;
+    DM B = DM::ones(sp.size1(), 1);
+    for (std::string plugin : {"qr", "ldl", "lsqr", "symbolicqr"}) {
+      std::string name = "linsol_" + plugin + "/laplacian_" + str(m) + "x" + str(m);
+      if (!b.selected(name) || !has_linsol(plugin)) continue;
+      Linsol linsol("linsol", plugin, sp);
+      linsol.sfact(A);
+      b.run(name, [&]() {
+        linsol.nfact(A);
+        linsol.solve(A, B);
+      });
+    }
+  }
+
+  /// QP solvers on HS035 and on a scalable banded QP
+  void bench_conic(Bench& b) {
+    Dict opts = {{"print_iter", false}, {"print_header", false}, {"print_info", false},
+      {"error_on_fail", false}};
+    // Hock-Schittkowski problem 35
+    SX x = SX::sym("x", 3);
+    SX x0 = x(0), x1 = x(1), x2 = x(2);
+    SX f = 9 - 8*x0 - 6*x1 - 4*x2 + 2*sq(x0) + 2*sq(x1) + sq(x2) + 2*x0*x1 + 2*x0*x2;
+    SX g = x0 + x1 + 2*x2;
+    DMDict arg = {{"x0", DM::vertcat({0.5, 0.5, 0.5})}, {"lbx", 0}, {"ubg", 3}};
+    // Banded QP: minimize 0.5 x'Ax - sum(x) s.t. 0 <= x <= 0.2, x[i]+x[i+1] <= 0.3
+    casadi_int n = 200;
+    SX y = SX::sym("y", n);
+    SX fy = 0.5 * dot(y, mtimes(SX(tridiag(n)), y)) - sum1(y);
+    SX gy = y(Slice(0, n - 1)) + y(Slice(1, n));
+    DMDict argy = {{"lbx", 0}, {"ubx", 0.2}, {"ubg", 0.3}};
+    for (std::string plugin : {"qrqp", "ipqp"}) {
+      if (!has_conic(plugin)) continue;
+      std::string name = "qpsol_" + plugin + "/hs035";
+      if (b.selected(name)) {
+        Function solver = qpsol("solver", plugin, {{"x", x}, {"f", f}, {"g", g}}, opts);
+        b.run(name, [&]() { solver(arg); });
+      }
+      name = "qpsol_" + plugin + "/banded_n" + str(n);
+      if (b.selected(name)) {
+        Function solver = qpsol("solver", plugin, {{"x", y}, {"f", fy}, {"g", gy}}, opts);
+        b.run(name, [&]() { solver(argy); });
+      }
+    }
+  }
+
+  /// SQP method on Hock-Schittkowski problems
+  void bench_nlpsol(Bench& b) {
+    if (!has_nlpsol("sqpmethod") || !has_conic("qrqp")) return;
+    Dict opts = {{"qpsol", "qrqp"}, {"print_header", false}, {"print_iteration", false},
+      {"print_status", false}, {"print_time", false}, {"error_on_fail", false},
+      {"qpsol_options", Dict{{"print_iter", false}, {"print_header", false},
+        {"print_info", false}, {"error_on_fail", false}}}};
+    // Hock-Schittkowski problem 71
+    SX x = SX::sym("x", 4);
+    SX f = x(0)*x(3)*(x(0) + x(1) + x(2)) + x(2);
+    SX g = vertcat(x(0)*x(1)*x(2)*x(3), dot(x, x));
+    DMDict arg = {{"x0", DM::vertcat({1, 5, 5, 1})}, {"lbx", 1}, {"ubx", 5},
+      {"lbg", DM::vertcat({25, 40})}, {"ubg", DM::vertcat({inf, 40})}};
+    if (b.selected("nlpsol_sqpmethod/hs071")) {
+      Function solver = nlpsol("solver", "sqpmethod", {{"x", x}, {"f", f}, {"g", g}}, opts);
+      b.run("nlpsol_sqpmethod/hs071", [&]() { solver(arg); });
+    }
+    // Hock-Schittkowski problem 6
+    SX z = SX::sym("z", 2);
+    SX z0 = z(0), z1 = z(1);
+    SX fz = sq(1 - z0);
+    SX gz = 10*(z1 - sq(z0));
+    DMDict argz = {{"x0", DM::vertcat({-1.2, 1})}, {"lbg", 0}, {"ubg", 0}};
+    if (b.selected("nlpsol_sqpmethod/hs006")) {
+      Function solver = nlpsol("solver", "sqpmethod", {{"x", z}, {"f", fz}, {"g", gz}}, opts);
+      b.run("nlpsol_sqpmethod/hs006", [&]() { solver(argz); });
+    }
+  }
+
+  /// Integrators on a chain of van der Pol oscillators
+  void bench_integrator(Bench& b, casadi_int n_osc) {
+    SX x = SX::sym("x", 2, n_osc);
+    SX p = SX::sym("p");
+    SX x1 = x(0, Slice()), x2 = x(1, Slice());
+    SX ode = vertcat(x2, p*(1 - sq(x1))*x2 - x1);
+    // Couple neighbouring oscillators
+    ode(1, Slice(1, n_osc)) += 0.1*(x1(Slice(0, n_osc - 1)) - x1(Slice(1, n_osc)));
+    SXDict dae = {{"x", vec(x)}, {"p", p}, {"ode", vec(ode)}};
+    std::vector<double> tout;
+    for (casadi_int k = 1; k <= 20; ++k) tout.push_back(0.1 * static_cast<double>(k));
+    DMDict arg = {{"x0", repmat(DM::vertcat({1, 0}), n_osc, 1)}, {"p", 0.5}};
+    std::vector<std::pair<std::string, Dict> > plugins = {
+      {"rk", Dict{{"number_of_finite_elements", 5}}},
+      {"collocation", Dict{{"number_of_finite_elements", 2}}},
+      {"cvodes", Dict()}, {"idas", Dict()}};
+    for (auto&& e : plugins) {
+      std::string name = "integrator_" + e.first + "/vdp_chain_" + str(n_osc);
+      if (!b.selected(name) || !has_integrator(e.first)) continue;
+      Function I = integrator("I", e.first, dae, 0, tout, e.second);
+      b.run(name, [&]() { I(arg); });
+      // Forward sensitivities with respect to the parameter
+      name = "integrator_" + e.first + "_fwd/vdp_chain_" + str(n_osc);
+      if (!b.selected(name)) continue;
+      MX xx0 = MX::sym("x0", 2 * n_osc), pp = MX::sym("p");
+      MX xf = I(MXDict{{"x0", xx0}, {"p", pp}}).at("xf");
+      Function S("S", {xx0, pp}, {jacobian(xf, pp)});
+      std::vector<DM> sarg = {arg.at("x0"), arg.at("p")};
+      std::vector<DM> sres;
+      b.run(name, [&]() { S.call(sarg, sres); });
+    }
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  BenchOptions opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (i + 1 < argc && a == "--filter") {
+      opts.filter = argv[++i];
+    } else if (i + 1 < argc && a == "--min-time") {
+      opts.min_time = std::stod(argv[++i]);
+    } else if (i + 1 < argc && a == "--min-rep") {
+      opts.min_rep = std::stoll(argv[++i]);
+    } else if (i + 1 < argc && a == "--format") {
+      opts.format = argv[++i];
+    } else if (i + 1 < argc && a == "--output") {
+      opts.output = argv[++i];
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--filter substring] [--min-time seconds]"
+        " [--min-rep n] [--format json|csv] [--output file]" << std::endl;
+      return 1;
+    }
+  }
+
+  Bench b(opts);
+  for (casadi_int n : {10, 100}) {
+    bench_function<SX>(b, "sx", n);
+    bench_function<MX>(b, "mx", n);
+  }
+  bench_sparsity(b, 50);
+  bench_linsol(b, 20);
+  bench_conic(b);
+  bench_nlpsol(b);
+  bench_integrator(b, 10);
+
+  if (opts.output.empty()) {
+    b.write(std::cout);
+  } else {
+    std::ofstream f(opts.output);
+    if (!f.good()) {
+      std::cerr << "Could not open " << opts.output << std::endl;
+      return 1;
+    }
+    b.write(f);
+  }
+  return 0;
+}
@@ -329,6 +329,20 @@ class ADtests(casadiTestCase):
             J = self.jacobians[inputtype][outputtype](*n)
             self.checkarray(array(J_out),J,"jacobian")
 
+  def test_jacobian_bidirectional(self):
+    # Dense rows and columns: neither forward nor adjoint compression alone is effective
+    n = 30
+    for X in [SX, MX]:
+      x = X.sym("x",n)
+      A = DM.rand(Sparsity.banded(n,1))
+      y = vertcat(mtimes(A,sin(x))*x[0]+x[1]*x, sum1(x**2), dot(cos(x),x))
+      J = [jacobian(y, x, opts) for opts in [{}, {"allow_reverse": False}, {"allow_forward": False}]]
+      f = Function('f', [x], J)
+      x0 = DM.rand(n)
+      J0 = f(x0)
+      for Ji in J0[1:]:
+        self.checkarray(J0[0], Ji, digits=12)
+
   def test_jacsparsity(self):
     n=array([1.2,2.3,7,4.6])
     for inputshape in ["column","row","matrix"]:
@@ -395,6 +409,27 @@ class ADtests(casadiTestCase):
     H(n)
     #H_out = H(H_in)
 
+  def test_hessian_edge_pushing(self):
+    x = SX.sym("x",5)
+    p = SX.sym("p")
+    e = sin(x[0]*x[1])+x[2]**2*p+exp(x[3])/x[4]+if_else(x[0]>0,x[1]**3,log(x[2])) \
+        + sqrt(x[0]**2+1)*x[2]+x[1]**x[4]+x[3]*x[3]+atan2(x[0],x[3])
+    H0 = Function("H0",[x,p],[hessian(e,x)[0]])
+    H1 = Function("H1",[x,p],[hessian(e,x,{"hessian_method":"edge_pushing"})[0]])
+    for s in [1,-1]:
+      x0 = DM([0.3*s,0.7,1.2,-0.4,1.5])
+      self.checkarray(H0(x0,2.5),H1(x0,2.5))
+    self.checkarray(H1.sparsity_out(0).is_symmetric(),True)
+
+    # Through the factory, as for nlp_hess_l
+    z = SX.sym("z",3)
+    nlp = Function("nlp",[z,p],[z[0]*z[1]*z[2]+sin(z[0]),z[0]**2+exp(z[2])],["x","p"],["f","g"])
+    h0 = nlp.factory("h",["x","p","lam:f","lam:g"],["hess:gamma:x:x"],{"gamma":["f","g"]})
+    h1 = nlp.factory("h",["x","p","lam:f","lam:g"],["hess:gamma:x:x"],{"gamma":["f","g"]},
+                     {"hessian_method":"edge_pushing"})
+    args = [DM([0.1,0.2,0.3]),1,2,3]
+    self.checkarray(h0(*args),h1(*args))
+
     #print array(JT_out[0])
     #print array(H_out[0])
 
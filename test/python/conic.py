@@ -947,7 +947,50 @@ class ConicTests(casadiTestCase):
         #with self.assertOutput(["last_tau","Converged"],[]): # Printing, but not captured by python stdout
         #    F()
     
-    
+  @requires_conic("qrqp")
+  def test_qrqp_updates(self):
+    n = 10
+    x = MX.sym("x",n)
+    p = MX.sym("p",n)
+    DM.rng(0)
+    Q = DM.rand(n,n)
+    qp = {"x":x,"p":p,"f":sumsqr(mtimes(Q,x))+dot(p,x),"g":vertcat(sum1(x),x[1:]-x[:-1])}
+    opts = {"print_header":False,"print_iter":False,"max_iter":100}
+    args = {"lbx":-0.3,"ubx":0.3,"lbg":vertcat(0.5,-0.1*DM.ones(n-1)),"ubg":vertcat(1,0.1*DM.ones(n-1))}
+    ref = qpsol("solver","qrqp",qp,opts)
+    solver = qpsol("solver","qrqp",qp,dict(opts,max_updates=5))
+    n_fact = n_fact_ref = 0
+    for k in range(3):
+      pk = DM.rand(n)-0.5
+      sol_ref = ref(p=pk,**args)
+      sol = solver(p=pk,**args)
+      self.assertTrue(solver.stats()["success"])
+      self.checkarray(sol["x"],sol_ref["x"],digits=8)
+      self.checkarray(sol["lam_a"],sol_ref["lam_a"],digits=6)
+      n_fact += solver.stats()["n_fact"]
+      n_fact_ref += ref.stats()["n_fact"]
+    self.assertTrue(n_fact<n_fact_ref)
+
+  @requires_conic("ipqp")
+  def test_ipqp_iterative_kkt(self):
+    n = 20
+    x = MX.sym("x",n)
+    DM.rng(1)
+    Q = DM.rand(n,n)
+    f = sumsqr(mtimes(Q,x)) + dot(DM.rand(n),x)
+    g = vertcat(sum1(x),x[:n//2]-x[n//2:])
+    qp = {"x":x,"f":f,"g":g}
+    opts = {"print_header":False,"print_iter":False}
+    args = {"lbx":-1,"ubx":1,"lbg":vertcat(1,-0.5*DM.ones(n//2)),"ubg":vertcat(1,0.5*DM.ones(n//2))}
+    ref = qpsol("solver","ipqp",qp,opts)
+    sol_ref = ref(**args)
+    solver = qpsol("solver","ipqp",qp,dict(opts,iterative_kkt=True))
+    sol = solver(**args)
+    self.assertTrue(solver.stats()["success"])
+    self.checkarray(sol["x"],sol_ref["x"],digits=6)
+    self.checkarray(sol["lam_a"],sol_ref["lam_a"],digits=5)
+    # The preconditioner is reused across interior point iterations
+    self.assertTrue(solver.stats()["n_fact"]<ref.stats()["n_fact"])
 
   @requires_conic("hpipm")
   @requires_conic("qpoases")
@@ -1062,6 +1105,38 @@ class ConicTests(casadiTestCase):
     self.checkarray(sol_ref["lam_x"], sol["lam_x"],digits=8)
     self.checkarray(sol_ref["f"], sol["f"],digits=8)
 
+  @requires_conic("hpipm")
+  @requires_conic("qpoases")
+  def test_hpipm_permuted(self):
+    # Stages not in order: all states first, then all controls, path constraints before gaps
+    N = 4
+    X = SX.sym("X", 2, N+1)
+    U = SX.sym("U", 1, N)
+    gaps = [X[:,k+1]-(vertcat(X[0,k]+0.1*X[1,k], X[1,k]-0.2*X[0,k])+vertcat(0,0.1)*U[k]) for k in range(N)]
+    path = [X[0,k]+U[k] for k in range(N)]
+    x = vertcat(vec(X), vec(U))
+    g = vertcat(*(path+gaps))
+    f = sumsqr(x)+X[0,0]*U[0]
+    H = hessian(f, x)[0]
+    A = jacobian(g, x)
+    H = evalf(substitute(H, x, DM.ones(x.shape)))
+    A = evalf(substitute(A, x, DM.ones(x.shape)))
+    G = DM(range(x.shape[0]))*0.1
+    lbx = vertcat(0.5, 0.2, -10*DM.ones(x.shape[0]-2))
+    ubx = vertcat(0.5, 0.2, 10*DM.ones(x.shape[0]-2))
+    lba = vertcat(-DM.ones(N), DM.zeros(2*N))
+    uba = vertcat(DM.ones(N), DM.zeros(2*N))
+
+    solver = conic('solver', 'hpipm', {"a": A.sparsity(), "h": H.sparsity()})
+    solver_ref = conic('solver', 'qpoases', {"a": A.sparsity(), "h": H.sparsity()})
+
+    sol = solver(a=A,h=H,g=G,lba=lba,uba=uba,lbx=lbx,ubx=ubx)
+    sol_ref = solver_ref(a=A,h=H,g=G,lba=lba,uba=uba,lbx=lbx,ubx=ubx)
+
+    self.checkarray(sol_ref["x"], sol["x"],digits=7)
+    self.checkarray(sol_ref["lam_a"], sol["lam_a"],digits=7)
+    self.checkarray(sol_ref["lam_x"], sol["lam_x"],digits=7)
+
   @requires_conic("hpipm")
   @requires_conic("qpoases")
   def test_hpipm_timevarying(self):
@@ -1326,5 +1401,132 @@ class ConicTests(casadiTestCase):
       with self.assertInException("process"):
         solver(x0=0,lbg=0,ubg=0,lbx=[-10,-10],ubx=[10,10])
 
+  def test_matrix_reuse(self):
+    H = DM([[2,1],[1,3]])
+    A = DM([[1,1]])
+    seq = [(H,A,[-1,-2]),(H,A,[1,-3]),(2*H,A,[1,-3]),(2*H,DM([[1,2]]),[1,-3])]
+    for conic, qp_options, aux_options in conics:
+      if not aux_options["quadratic"]: continue
+      print("test_matrix_reuse",conic,qp_options)
+      solver = casadi.conic("mysolver",conic,{'h':H.sparsity(),'a':A.sparsity()},qp_options)
+      for h,a,g in seq:
+        ref = casadi.conic("ref",conic,{'h':H.sparsity(),'a':A.sparsity()},qp_options)
+        args = dict(h=h,a=a,g=g,lbx=-10,ubx=10,lba=-1,uba=0.5)
+        self.checkarray(solver(**args)["x"],ref(**args)["x"],conic,digits=6)
+
+  def test_map_thread(self):
+    H = DM([[2,1],[1,3]])
+    A = DM([[1,1]])
+    n = 20
+    for conic, qp_options, aux_options in conics:
+      if not aux_options["quadratic"]: continue
+      print("test_map_thread",conic,qp_options)
+      opts = dict(qp_options)
+      opts["error_on_fail"] = False
+      solver = casadi.conic("mysolver",conic,{'h':H.sparsity(),'a':A.sparsity()},opts)
+      F = solver.map(n,"thread")
+      self.assertTrue(F.is_a("ConicMap"))
+      g = DM.rand(2,n)
+      uba = DM.rand(1,n)
+      uba[3] = -30
+      args = dict(h=repmat(H,1,n),a=repmat(A,1,n),g=g,lbx=-10,ubx=10,lba=-1,uba=uba)
+      ref = solver.map(n,"serial")(**args)
+      res = F(**args)
+      for i in range(n):
+        if i==3: continue
+        self.checkarray(res["x"][:,i],ref["x"][:,i],conic,digits=6)
+      success = F.stats()["success"]
+      self.assertEqual(len(success),n)
+      self.assertFalse(success[3])
+      self.assertTrue(all(success[:3]+success[4:]))
+
+  @requires_conic("qpoases")
+  def test_qpoases_hotstart(self):
+    # Sequence of QPs with varying H and A values, as in SQP iterations
+    N = 6
+    x = SX.sym("x", N)
+    p = SX.sym("p")
+    H = sparsify(DM(hessian(sumsqr(x)+x[0]*x[1]+0.5*sumsqr(x[1:]-x[:-1]), x)[0]))
+    A = sparsify(DM(jacobian(vertcat(x[0]+x[1], x[2]-x[3], x[4]+x[5]+x[0]), x)))
+    for opts in [{}, {"sparse": True}, {"sparse": True, "schur": True, "linsol_plugin": "ldl"}]:
+      print("test_qpoases_hotstart", opts)
+      opts = dict(opts)
+      opts["printLevel"] = "none"
+      solver = conic('solver', 'qpoases', {"a": A.sparsity(), "h": H.sparsity()}, opts)
+      opts["hotstart"] = False
+      ref = conic('solver', 'qpoases', {"a": A.sparsity(), "h": H.sparsity()}, opts)
+      for k in range(5):
+        args = dict(h=H*(1+0.1*k), a=A*(1-0.05*k), g=DM(range(N))-k, lbx=-1, ubx=1,
+                    lba=-0.5-0.1*k, uba=0.5)
+        sol = solver(**args)
+        sol_ref = ref(**args)
+        self.assertTrue(solver.stats()["success"])
+        # Without pivoting, ldl may fail on the Schur complement KKT system, forcing a cold start
+        if "schur" not in opts: self.assertEqual(solver.stats()["hotstart"], k>0)
+        self.assertFalse(ref.stats()["hotstart"])
+        self.checkarray(sol["x"], sol_ref["x"], digits=8)
+        self.checkarray(sol["lam_a"], sol_ref["lam_a"], digits=8)
+        self.checkarray(sol["lam_x"], sol_ref["lam_x"], digits=8)
+
+  @requires_conic("proxqp")
+  def test_proxqp_persistent(self):
+    # Sequence of QPs with varying data, solved with a ProxQP solver kept alive between calls
+    N = 4
+    H = sparsify(DM([[2,1,0,0],[1,2,0,0],[0,0,1,0],[0,0,0,1]]))
+    A = sparsify(DM([[1,1,0,0],[0,1,-1,0],[1,0,0,1]]))
+    for backend in ["sparse", "dense", "auto"]:
+      options = {"proxqp": {"eps_abs": 1e-11, "max_iter": 1e4, "backend": backend}}
+      ref = conic('solver', 'proxqp', {"a": A.sparsity(), "h": H.sparsity()}, options)
+      options["persistent"] = True
+      solver = conic('solver', 'proxqp', {"a": A.sparsity(), "h": H.sparsity()}, options)
+      for k in range(6):
+        # Matrices change every other call, the last constraint switches to an equality
+        args = dict(h=H*(1+0.1*(k//2)), a=A*(1-0.05*(k//2)), g=DM(range(N))-k, lbx=-3, ubx=3+k,
+                    lba=vertcat(-1-0.1*k, -inf, 0.5), uba=vertcat(1, 2, 0.5 if k>=4 else 1.5))
+        sol = solver(**args)
+        sol_ref = ref(**args)
+        self.assertTrue(solver.stats()["success"])
+        self.assertEqual(solver.stats()["updated"], 0<k<4 or k==5)
+        self.checkarray(sol["x"], sol_ref["x"], backend, digits=6)
+        self.checkarray(sol["lam_a"], sol_ref["lam_a"], backend, digits=6)
+        self.checkarray(sol["cost"], sol_ref["cost"], backend, digits=6)
+
+  def test_persistent(self):
+    # Sequence of MIQPs with varying data, solved with a model kept alive between calls
+    N = 4
+    H = sparsify(DM([[2,1,0,0],[1,2,0,0],[0,0,1,0],[0,0,0,1]]))
+    A = sparsify(DM([[1,1,0,0],[0,1,-1,0],[1,0,0,1]]))
+    for conic_name, qp_options, aux_options in conics:
+      if conic_name not in ["cplex", "gurobi"]: continue
+      print("test_persistent",conic_name,qp_options)
+      options = dict(qp_options)
+      options["discrete"] = [0,1,0,1]
+      ref = conic('solver', conic_name, {"a": A.sparsity(), "h": H.sparsity()}, options)
+      options["persistent"] = True
+      solver = conic('solver', conic_name, {"a": A.sparsity(), "h": H.sparsity()}, options)
+      for k in range(5):
+        # Last constraint switches from a range to an equality and back
+        args = dict(h=H*(1+0.1*k), a=A*(1-0.05*k), g=DM(range(N))-k, lbx=-3, ubx=3+k,
+                    lba=vertcat(-1-0.1*k, -inf, 0.5), uba=vertcat(1, 2, 0.5 if k%2 else 1.5))
+        sol = solver(**args)
+        sol_ref = ref(**args)
+        self.assertTrue(solver.stats()["success"])
+        self.checkarray(sol["x"], sol_ref["x"], conic_name, digits=5)
+        self.checkarray(sol["cost"], sol_ref["cost"], conic_name, digits=5)
+
+  def test_auto(self):
+    # Small dense problems go to a dense solver, large sparse ones to a sparse solver
+    for n, dense in [(5, True), (300, False)]:
+      H = sparsify(3*DM.eye(n)+0.5*DM.ones(n,n) if dense else 3*DM.eye(n))
+      A = DM.ones(2,n) if dense else sparsify(DM.eye(n))
+      opts = {"dense_plugins": ["qrqp"], "sparse_plugins": ["ipqp", "qrqp"]}
+      solver = conic('solver', 'auto', {"a": A.sparsity(), "h": H.sparsity()}, opts)
+      ref = conic('solver', 'qrqp', {"a": A.sparsity(), "h": H.sparsity()})
+      args = dict(h=H, a=A, g=DM.ones(n), lba=-1, uba=0.5, lbx=-2, ubx=2)
+      sol = solver(**args)
+      sol_ref = ref(**args)
+      self.assertEqual(solver.stats()["plugin"], "qrqp" if dense else "ipqp")
+      self.checkarray(sol["x"], sol_ref["x"], digits=6)
+
 if __name__ == '__main__':
     unittest.main()
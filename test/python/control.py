@@ -51,6 +51,9 @@ dplesolvers = []
 if has_dple("slicot"):
   dplesolvers.append(("slicot",{"linear_solver": "csparse"}))
 
+if has_dple("smith"):
+  dplesolvers.append(("smith",{}))
+
 def randstable(n,margin=0.8,minimal=0):
   r = margin
   A_ = tril(DM(numpy.random.random((n,n))))
@@ -476,6 +476,36 @@ class Functiontests(casadiTestCase):
     self.checkarray(res[0],mtimes(a*c,b))
     self.checkarray(res[1],c**2)
 
+  def test_callback_kernel(self):
+    import ctypes
+    c_double_pp = ctypes.POINTER(ctypes.POINTER(ctypes.c_double))
+    KERNEL = ctypes.CFUNCTYPE(ctypes.c_int, c_double_pp, c_double_pp,
+      ctypes.POINTER(ctypes.c_longlong), ctypes.POINTER(ctypes.c_double), ctypes.c_int)
+    def square(arg, res, iw, w, mem):
+      res[0][0] = arg[0][0]**2
+      return 0
+    kernel = KERNEL(square)
+
+    class mycallback(Callback):
+      def __init__(self, name, opts={}):
+        Callback.__init__(self)
+        self.construct(name, opts)
+      def eval(self, arg):
+        raise Exception("The kernel should be called instead")
+      def get_eval_kernel(self):
+        return ctypes.cast(kernel, ctypes.c_void_p).value
+
+    foo = mycallback("my_f")
+    self.checkarray(foo(5),25)
+
+    x = MX.sym('x')
+    f = Function("f",[x],[foo(x)])
+    self.checkarray(f(5),25)
+
+    # Thread map calls the kernel concurrently
+    fm = foo.map(10,"thread",4)
+    self.checkarray(fm(DM(range(10)).T),DM(range(10)).T**2)
+
   def test_callback_errors(self):
     class mycallback(Callback):
       def __init__(self, name, opts={}):
@@ -581,7 +611,7 @@ class Functiontests(casadiTestCase):
     Z = [MX.sym("z",2,2) for i in range(n)]
     V = [MX.sym("z",Sparsity.upper(3)) for i in range(n)]
 
-    for parallelization in ["serial","openmp","unroll","inline","thread"]:
+    for parallelization in ["serial","openmp","unroll","inline","thread","simd,"process"]:
         print(parallelization)
         res = fun.map(n, parallelization).call([horzcat(*x) for x in [X,Y,Z,V]])
 
@@ -627,6 +657,159 @@ class Functiontests(casadiTestCase):
     self.checkfunction_light(fun.map(4,"thread",2),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
     self.checkfunction_light(fun.map(4,"thread",5),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
 
+  def test_map_process(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    fun = Function("f",[x,p],[sin(x)*p,dot(x,x)])
+
+    np.random.seed(0)
+    inputs = [DM(np.random.random((2,5))),DM(np.random.random((1,5)))]
+    F = fun.map(5,"process")
+    self.assertTrue(F.is_a("ProcessMap"))
+    self.checkfunction(F,fun.map(5),inputs=inputs)
+
+    # Derivatives are mapped over processes as well
+    for df in [F.forward(1),F.reverse(1)]:
+      self.assertTrue(any(f.is_a("ProcessMap") for f in df.find_functions()))
+
+    # Serialization
+    self.checkfunction_light(Function.deserialize(F.serialize()),fun.map(5),inputs=inputs)
+
+  def test_map_simd(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    v = SX.sym("z",Sparsity.upper(3))
+    fun = Function("f",[x,y,v],[sin(y*x),x**2+fmax(y[0],y[1]),v/x])
+
+    for N in [1, 3, 8, 21]:
+      F = fun.map(N,"simd")
+      self.assertTrue(F.is_a("SimdMap") or N==1)
+      inputs = [DM.rand(1,N),DM.rand(2,N),DM(repmat(v.sparsity(),1,N),np.random.random(6*N))]
+      self.checkfunction_light(F,fun.map(N),inputs=inputs)
+      self.check_serialize(F,inputs=inputs)
+
+  def test_bytecode(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    v = SX.sym("z",Sparsity.upper(3))
+    e = y*x+3
+    outputs = [sin(e)-x*y[0], 2/x+fmax(y[0],y[1])*e, v/x-2*v+x, 4-x*y[1], x**2, 7]
+    for opts in [{}, {"live_variables": False}, {"cse": True}]:
+      opts_bc = dict(opts)
+      opts_bc["bytecode"] = True
+      f = Function("f",[x,y,v],outputs,opts)
+      F = Function("F",[x,y,v],outputs,opts_bc)
+      inputs = [1.3,DM([0.7,-2.1]),DM(v.sparsity(),[1.1,2.2,3.3,4.4,5.5,6.6])]
+      self.checkfunction_light(F,f,inputs=inputs)
+      self.check_serialize(F,inputs=inputs)
+
+  def test_short_circuit(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    h = sin(x*y[0])
+    for i in range(5): h = cos(h*y[1]+i)
+    inner = if_else(y[0]>0, exp(h)+y[1], h*y[0])
+    outputs = [if_else(x>0, inner*x, sqrt(y[1]**2+1)), y*x+if_else(x<-1, log(1+x**2)*h, 0)]
+    f = Function("f",[x,y],outputs)
+    F = Function("F",[x,y],outputs,{"short_circuit":True})
+    self.assertEqual(F.info()["n_branches"],5)
+    for xv, yv in [(1.3,[0.7,-2.1]), (1.3,[-0.7,2.1]), (-0.3,[0.7,2.1]), (-1.5,[0.7,-2.1])]:
+      inputs = [xv,DM(yv)]
+      self.checkfunction(F,f,inputs=inputs)
+      self.check_codegen(F,inputs=inputs)
+      self.check_serialize(F,inputs=inputs)
+
+  def test_memory_report(self):
+    x = SX.sym("x",3)
+    f = Function("f",[x],[sin(x)*dot(x,x)])
+    y = MX.sym("y",3)
+    g = Function("g",[y],[f(y)+f(2*y)])
+    r = g.memory_report()
+    for k in ["class","n_mem","sz_w","work_bytes","sparsity_bytes","instructions_bytes",
+              "self_bytes","total_bytes","dependencies","cache"]:
+      self.assertTrue(k in r)
+    self.assertEqual(r["class"],"MXFunction")
+    self.assertTrue("f" in r["dependencies"])
+    self.assertEqual(r["total_bytes"],r["self_bytes"]+r["dependencies"]["f"]["total_bytes"])
+    J = g.jacobian()
+    r2 = g.memory_report()
+    self.assertTrue(len(r2["cache"])>0)
+    self.assertTrue(r2["total_bytes"]>r["total_bytes"])
+
+  def test_instruction_order(self):
+    x = SX.sym("x",50)
+    y = SX.sym("y",2)
+    e = 0
+    for i in reversed(range(50)): e = sin(x[i])+e*cos(x[i])
+    outputs = [e, if_else(y[0]>0, e*y[1], y[0]**2), y*e]
+    f = Function("f",[x,y],outputs)
+    for opts in [{}, {"short_circuit":True}]:
+      opts["instruction_order"] = "sethi_ullman"
+      F = Function("F",[x,y],outputs,opts)
+      self.assertTrue(F.sz_w()<10)
+      self.assertTrue(f.sz_w()>50)
+      for yv in [[0.7,-2.1], [-0.7,2.1]]:
+        inputs = [DM(np.linspace(0,1,50)),DM(yv)]
+        self.checkfunction(F,f,inputs=inputs)
+        self.check_codegen(F,inputs=inputs)
+        self.check_serialize(F,inputs=inputs)
+
+  @requiresPlugin(Importer,"llvm")
+  def test_jit_llvm(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    v = SX.sym("z",Sparsity.upper(3))
+    outputs = [sin(y*x+3)-tan(x), fmin(y[0],y[1])*atan2(x,y[1]), if_else(x<y[0],v/x,x**v), floor(x)+erf(x)]
+    f = Function("f",[x,y,v],outputs)
+    inputs = [1.3,DM([0.7,-2.1]),DM(v.sparsity(),[1.1,2.2,3.3,4.4,5.5,6.6])]
+    for opt_level in [0, 2]:
+      F = Function("f",[x,y,v],outputs,{"jit":True,"compiler":"llvm","jit_options":{"opt_level":opt_level}})
+      self.checkfunction_light(F,f,inputs=inputs)
+      self.check_serialize(F,inputs=inputs)
+    with self.assertInException("cannot be just-in-time compiled"):
+      X = MX.sym("x")
+      Function("f",[X],[X**2],{"jit":True,"compiler":"llvm"})
+
+  def test_map_thread_chunks(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    fun = Function("f",[x,y],[sin(y*x),x**2])
+
+    N = 103
+    X_ = DM.rand(1,N)
+    Y_ = DM.rand(2,N)
+    n_threads = GlobalOptions.getMaxNumThreads()
+    try:
+      for n in [0, 1, 3, 200]:
+        GlobalOptions.setMaxNumThreads(n)
+        F = fun.map(N,"thread")
+        for k in range(3):
+          self.checkfunction_light(F,fun.map(N),inputs=[X_,Y_])
+        self.check_serialize(F,inputs=[X_,Y_])
+    finally:
+      GlobalOptions.setMaxNumThreads(n_threads)
+
+  def test_mapsum_thread_chunks(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    fun = Function("f",[x,y],[sin(y*x),x**2,y*x])
+
+    N = 103
+    X_ = DM.rand(1,N)
+    Y_ = DM.rand(2,1)
+    Fref = fun.map("map","serial",N,[1],[0,1])
+    n_threads = GlobalOptions.getMaxNumThreads()
+    try:
+      for n in [0, 1, 3, 4, 200]:
+        GlobalOptions.setMaxNumThreads(n)
+        F = fun.map("map","thread",N,[1],[0,1])
+        self.assertEqual(F.class_name(),"ThreadMapSum")
+        for k in range(3):
+          self.checkfunction_light(F,Fref,inputs=[X_,Y_])
+        self.check_serialize(F,inputs=[X_,Y_])
+    finally:
+      GlobalOptions.setMaxNumThreads(n_threads)
+
   @memory_heavy()
   def test_mapsum(self):
     x = SX.sym("x")
@@ -1114,6 +1297,60 @@ class Functiontests(casadiTestCase):
       self.assertTrue(same(F([-.6, 2.5]), 24.4))
       self.assertTrue(same(F([-.6, 3.5]), 34.4))
 
+  def test_interpolant_batch_x(self):
+    grid = [[0, 1, 2, 3, 4], [0, 1, 2, 3]]
+    values = list(np.sin(np.arange(40)))
+    # Sorted, unsorted and out-of-range query points
+    X = DM([[-0.5, 0.2, 0.4, 1.1, 2.7, 4.5, 0.3],
+            [0.1, 0.5, 1.5, 2.2, 2.9, 3.4, 0.0]])
+    for solver in ["linear", "bspline"]:
+      for lookup_mode in ["linear", "exact", "binary"]:
+        opts = {"lookup_mode": [lookup_mode]*2}
+        F = interpolant('F', solver, grid, values, opts)
+        opts["batch_x"] = X.shape[1]
+        Fb = interpolant('F', solver, grid, values, opts)
+        ref = horzcat(*[F(X[:,k]) for k in range(X.shape[1])])
+        self.checkarray(Fb(X), ref)
+        x = MX.sym("x", X.shape)
+        J = Function('J', [x], [jacobian(Fb(x), x)])
+        Jref = diagcat(*[jacobian(F(x[:,k]), x[:,k]) for k in range(X.shape[1])])
+        Jref = Function('Jref', [x], [Jref])
+        self.checkarray(J(X), Jref(X))
+        self.check_codegen(Fb, inputs=[X])
+        self.check_serialize(Fb, inputs=[X])
+
+  def test_interpolant_uniform_auto(self):
+    # Uniform grids default to direct index computation
+    grid = [list(np.linspace(0, 1, 11)), [0.0, 0.5, 2.0, 3.0]]
+    values = list(np.sin(np.arange(44)))
+    F = interpolant('F', 'linear', grid, values)
+    F_ref = interpolant('F', 'linear', grid, values, {"lookup_mode": ["linear", "linear"]})
+    for x in list(np.linspace(-0.2, 1.2, 15)) + grid[0]:
+      for y in [-1, 0.5, 0.7, 2.0, 3.5]:
+        self.checkarray(F([x, y]), F_ref([x, y]))
+    self.check_codegen(F, inputs=[[0.3, 0.7]])
+
+  def test_tensor_train_interpolant(self):
+    grid = [list(np.linspace(0, 1, 5)), [0, 0.3, 1, 2], list(np.linspace(-1, 1, 6))]
+    X = np.meshgrid(*grid, indexing='ij')
+    D = [np.sin(X[0])*np.cos(X[1])+X[2], np.exp(X[0]*X[1]*X[2])]
+    values = list(np.stack(D).ravel(order='F'))
+    F_ref = interpolant('F', 'linear', grid, values)
+    F = interpolant('F', 'tensor_train', grid, values, {"tol": 1e-12})
+    x = MX.sym("x", 3)
+    J_ref = Function('J', [x], [jacobian(F_ref(x), x)])
+    J = Function('J', [x], [jacobian(F(x), x)])
+    for p in [[0.1, 0.2, 0.3], [0.5, 1.5, -0.9], [-0.2, 2.5, 1.2], [1, 0, 0]]:
+      self.checkarray(F(p), F_ref(p), digits=10)
+      self.checkarray(J(p), J_ref(p), digits=10)
+    self.check_codegen(F, inputs=[[0.5, 1.5, -0.9]])
+    self.check_serialize(F, inputs=[[0.5, 1.5, -0.9]])
+    self.check_codegen(J, inputs=[[0.5, 1.5, -0.9]])
+
+    # Truncation trades accuracy for fewer coefficients
+    F = interpolant('F', 'tensor_train', grid, values, {"max_rank": 1})
+    self.assertTrue(float(norm_inf(F([0.5, 1.5, -0.9])-F_ref([0.5, 1.5, -0.9])))<2)
+
   @skip(not scipy_interpolate)
   def test_nd_linear(self):
 
@@ -1712,6 +1949,48 @@ class Functiontests(casadiTestCase):
       self.assertTrue(JA.nnz()==0)
       self.assertTrue(Jt.nnz()==n**2)
 
+  @requires_expm("pade")
+  def test_expm_pade(self):
+      np.random.seed(0)
+      n = 5
+
+      def expm_ref(A):
+        # Taylor series with scaling and squaring
+        M = A/2**6
+        R = DM.eye(n)+M
+        T = M
+        for k in range(2,20):
+          T = mtimes(T,M)/k
+          R = R + T
+        for k in range(6):
+          R = mtimes(R,R)
+        return R
+
+      A = MX.sym("A",n,n)
+      t = MX.sym("t")
+      E = MX.sym("E",n,n)
+      for Anum in [np.random.random((n,n))*1e-3, np.random.random((n,n))-0.5,
+                   np.random.random((n,n))*4]:
+        fr = Function('fr',[A,t],[expm_ref(A*t)])
+        f = Function('f',[A,t],[casadi.expm(A*t)])
+        self.checkfunction(fr,f,inputs=[Anum, 1.1],digits=9)
+
+        # Frechet derivative
+        F = expmsol('F','pade',Sparsity.dense(n,n),{"frechet":True})
+        Enum = np.random.random((n,n))
+        fr = Function('fr',[A,t,E],[expm_ref(A*t),jtimes(expm_ref(A*t),A,E)])
+        self.checkfunction(fr,F,inputs=[Anum, 1.1, Enum],digits=9,hessian=False)
+
+      # Rows without structural nonzeros, as in expm([A B;0 0])
+      Anum = np.random.random((n,n))
+      Anum[[1,3],:] = 0
+      Anum = sparsify(DM(Anum))
+      A = MX.sym("A",Anum.sparsity())
+      fr = Function('fr',[A,t],[expm_ref(A*t)])
+      f = Function('f',[A,t],[casadi.expm(A*t)])
+      self.checkfunction(fr,f,inputs=[Anum, 1.1],digits=9)
+      self.check_codegen(f,inputs=[Anum, 1.1])
+
   def test_conditional(self):
 
     np.random.seed(5)
@@ -1736,6 +2015,28 @@ class Functiontests(casadiTestCase):
       self.checkfunction(F,Fsx,inputs = [i,A,B])
       self.check_codegen(F,inputs=[i,A,B])
 
+  def test_conditional_lazy_derivatives(self):
+
+    np.random.seed(5)
+
+    x = MX.sym('x',2,2)
+
+    sp1 = MX.sym('y',Sparsity.lower(2))
+    sp2 = MX.sym('z',Sparsity.diag(2))
+
+    f1 = Function("f",[sp2,x],[x**2,x*sp2])
+    f2 = Function("f",[sp1,x],[2*x**2,sin(sp1)])
+    f3 = Function("f",[sp1,sp2],[sp1*sp2,sp1+sp2])
+
+    F = Function.conditional("test",[f1,f2], f3)
+    G = Function.conditional("test",[f1,f2], f3, {"lazy_derivatives": True})
+
+    A = np.random.random((2,2))
+    B = np.random.random((2,2))
+
+    for i in range(-1,3):
+      self.checkfunction(G,F,inputs = [i,A,B])
+
   def test_max_num_dir(self):
     x = MX.sym("x",10)
 
@@ -1778,7 +2079,87 @@ class Functiontests(casadiTestCase):
     code= c.dump()
 
     self.assertTrue("ffff_acc4_acc4_acc4" in code)
-    
+
+  def test_mapaccum_checkpoint(self):
+    x = MX.sym("x")
+    u = MX.sym("u")
+    f = Function("f",[x,u],[sin(x)*u+x,x**2])
+
+    N = 103
+    F = f.mapaccum("F",N,{"base":-1})
+    Fc = f.mapaccum("Fc",N,{"checkpoint":10})
+
+    x0 = 0.3
+    U = DM.rand(1,N)
+    for a,b in zip(F(x0,U),Fc(x0,U)):
+      self.checkarray(a,b)
+
+    X0 = MX.sym("x0")
+    US = MX.sym("U",1,N)
+    J = Function("J",[X0,US],[gradient(sum2(F(X0,US)[0]),X0)])
+    Jc = Function("Jc",[X0,US],[gradient(sum2(Fc(X0,US)[0]),X0)])
+    self.checkarray(J(x0,U),Jc(x0,U))
+
+    # Reverse sweep only stores segment boundaries
+    self.assertTrue(Jc.sz_w()<J.sz_w())
+
+  def test_mapaccum_scan(self):
+    for X in [SX, MX]:
+      x = X.sym("x",2)
+      P = X.sym("P",2,2)
+      u = X.sym("u",2)
+      A = vertcat(horzcat(cos(u[0]),u[1]),horzcat(-u[1],1))
+      f = Function("f",[x,P,u],[mtimes(A,x)+u,mtimes(mtimes(A,P),A.T)+DM.eye(2),sin(x[0])*u[1]])
+
+      for N in [1,2,7,37]:
+        F = f.mapaccum("F",N,2,{"base":-1})
+        Fs = f.mapaccum("Fs",N,2,{"scan":"parallel"})
+        args = [DM.rand(2),DM.eye(2),DM.rand(2,N)]
+        for a,b in zip(F(*args),Fs(*args)):
+          self.checkarray(a,b,digits=10)
+
+    # Nonlinear accumulators
+    x = MX.sym("x")
+    u = MX.sym("u")
+    f = Function("f",[x,u],[sin(x)+u])
+    with self.assertInException("affine"):
+      f.mapaccum("F",5,{"scan":"parallel"})
+    F = f.mapaccum("F",5,{"scan":"auto"})
+    self.assertEqual(F(0.3,DM.rand(1,5)).shape,(1,5))
+
+  def test_numeric_ad(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p",2)
+    e = vertcat(sin(x[0])*x[1]+p[0]*x[2]**2,if_else(x[0]>0,exp(x[1]),log(1+x[2]**2)),
+                sqrt(x[0]**2+p[1]),x[0]/x[1])
+    g = dot(e,e)+x[2]
+    f = Function("f",[x,p],[e,g])
+    ft = Function("f",[x,p],[e,g],{"numeric_ad":True})
+
+    self.assertEqual(ft.forward(3).class_name(),"SXTapeDerivative")
+    self.assertEqual(ft.reverse(2).class_name(),"SXTapeDerivative")
+
+    x0 = DM([0.3,-0.7,1.2])
+    p0 = DM([0.5,2])
+    for a,b in zip(f.jacobian()(x0,p0,0,0),ft.jacobian()(x0,p0,0,0)):
+      self.checkarray(a,b)
+    fseed = [DM.rand(3,4),DM.rand(2,4)]
+    for a,b in zip(f.forward(4)(x0,p0,0,0,*fseed),ft.forward(4)(x0,p0,0,0,*fseed)):
+      self.checkarray(a,b)
+    aseed = [DM.rand(4,3),DM.rand(1,3)]
+    for a,b in zip(f.reverse(3)(x0,p0,0,0,*aseed),ft.reverse(3)(x0,p0,0,0,*aseed)):
+      self.checkarray(a,b)
+
+    # Higher order derivatives through the symbolic derivative
+    X = MX.sym("X",3)
+    P = MX.sym("P",2)
+    H = Function("H",[X,P],[hessian(f(X,P)[1],X)[0]])
+    Ht = Function("Ht",[X,P],[hessian(ft(X,P)[1],X)[0]])
+    self.checkarray(H(x0,p0),Ht(x0,p0))
+
+    ft2 = Function.deserialize(ft.serialize())
+    self.assertEqual(ft2.reverse(1).class_name(),"SXTapeDerivative")
+
     
   def test_codegen_with_jac_sparsity(self):
   
@@ -1906,6 +2287,26 @@ class Functiontests(casadiTestCase):
     self.check_serialize(f,inputs=[0.2,0.333])
 
 
+  def test_4d_bspline_kron_fit(self):
+    np.random.seed(0)
+
+    d_knots = [list(np.linspace(0,1,5)),[0,0.1,0.5,0.6,1],list(np.linspace(-1,1,6)),list(np.linspace(0,2,4))]
+    r = np.meshgrid(*d_knots,indexing='ij')
+    xyz = np.vstack(list(e.ravel(order='F') for e in r))
+
+    data = np.random.random((2,xyz.shape[1]))
+    d_flat = data.ravel(order='F')
+
+    # Spline must interpolate the data on the grid
+    for values in [d_flat, None]:
+      if values is None:
+        LUT = casadi.interpolant('name','bspline',d_knots,2)
+        x = MX.sym("x",4)
+        LUT = Function('f',[x],[LUT(x,d_flat)])
+      else:
+        LUT = casadi.interpolant('name','bspline',d_knots,values)
+      self.checkarray(LUT.map(xyz.shape[1])(xyz),data,digits=10)
+
   def test_parametric_bspline(self):
     knots = [[0,0,0,0,0.2,0.5,0.8,1,1,1,1],[0,0,0,0.1,0.5,0.9,1,1,1]]
     x=MX.sym("x",2)
@@ -1922,6 +2323,28 @@ class Functiontests(casadiTestCase):
     self.check_serialize(F,inputs=[vertcat(0.3,0.4)])
 
 
+  def test_batch_bspline(self):
+    np.random.seed(0)
+    knots = [[0,0,0,0,0.2,0.5,0.8,1,1,1,1],[0,0,0,0.1,0.5,0.9,1,1,1]]
+    data = np.random.random((7,6,2)).ravel(order='F')
+    N = 21
+    X = MX.sym("X",2,N)
+    C = MX.sym("C",data.shape[0],1)
+    Xv = np.random.random((2,N))*1.2-0.1
+    Xv[0,:10] = np.linspace(0,1,10)
+    Xv[1,:10] = np.linspace(0.5,0.9,10)
+
+    for coeffs in [DM(data), C]:
+      y = bspline(X,coeffs,knots,[3,2],2)
+      y_ref = horzcat(*[bspline(X[:,i],coeffs,knots,[3,2],2) for i in range(N)])
+      f = Function('f',[X,C],[y,jacobian(y,X)])
+      f_ref = Function('f',[X,C],[y_ref,jacobian(y_ref,X)])
+      for r,r_ref in zip(f(Xv,data),f_ref(Xv,data)):
+        self.checkarray(r,r_ref,digits=12)
+      self.assertEqual(f.sparsity_out(1),f_ref.sparsity_out(1))
+      self.check_codegen(f,inputs=[Xv,data])
+      self.check_serialize(f,inputs=[Xv,data])
+
   def test_smooth_linear(self):
     np.random.seed(0)
 
@@ -1972,6 +2395,227 @@ class Functiontests(casadiTestCase):
     self.check_codegen(f,inputs=[np.random.random((3,3))])
     self.check_codegen(f,inputs=[np.random.random((3,3))], opts={"avoid_stack": True})
 
+  def test_codegen_static_work(self):
+    x = SX.sym("x",3,3)
+    f = Function('f',[x],[det(x)])
+    np.random.seed(0)
+    for align in [0, 16]:
+      self.check_codegen(f,inputs=[np.random.random((3,3))], opts={"static_work": True, "static_work_align": align})
+      cg = CodeGenerator("me",{"static_work": True, "static_work_align": align})
+      cg.add(f)
+      code = cg.dump()
+      self.assertTrue("f_work_t" in code)
+      self.assertTrue("f_static(" in code)
+      self.assertTrue(("casadi_align(16)" in code)==(align>0))
+
+  def test_codegen_unroll_sparse(self):
+    A = MX.sym("A",Sparsity.lower(4))
+    B = MX.sym("B",Sparsity.upper(4))
+    x = MX.sym("x",4)
+    e = vertcat(vec(mtimes(A,B)), mtimes(B,x)[[0,2,3]], vec(project(A,Sparsity.diag(4))))
+    f = Function('f',[A,B,x],[e])
+    inputs = [DM(Sparsity.lower(4),list(range(1,11))),DM(Sparsity.upper(4),list(range(2,12))),DM([1,2,3,4])]
+    for n in [0,10,1000]:
+      self.check_codegen(f,inputs=inputs,opts={"unroll_sparse":n})
+    cg = CodeGenerator("me",{"unroll_sparse":1000})
+    cg.add(f)
+    code = cg.dump()
+    self.assertFalse("casadi_mtimes(" in code)
+    self.assertFalse("casadi_project(" in code)
+
+  def test_codegen_int32(self):
+    A = MX.sym("A",Sparsity.lower(4))
+    x = MX.sym("x",4)
+    f = Function('f',[A,x],[mtimes(A,x),solve(A+DM.eye(4),x),project(A,Sparsity.diag(4))])
+    inputs = [DM(Sparsity.lower(4),list(range(1,11))),DM([1,2,3,4])]
+    self.check_codegen(f,inputs=inputs,opts={"casadi_int":"int"})
+    cg = CodeGenerator("me",{"casadi_int":"int"})
+    cg.add(f)
+    self.assertTrue("f_int_bytes" in cg.dump())
+
+  def test_codegen_dedup(self):
+    x = SX.sym("x",2)
+    F1 = Function('F1',[x],[sin(x)*x[0]])
+    F2 = Function('F2',[x],[sin(x)*x[0]])
+    F3 = Function('F3',[x],[cos(x)*x[0]])
+    y = MX.sym("y",2)
+    f = Function('f',[y],[F1(y)+F2(2*y)+F3(y)])
+    self.check_codegen(f,inputs=[DM([0.3,0.7])])
+    cg = CodeGenerator("me")
+    cg.add(f)
+    code = cg.dump()
+    self.assertEqual(code.count("sin("),1)
+    self.assertEqual(code.count("cos("),1)
+
+  def test_codegen_thread_backend(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    fun = Function("f",[x,y],[x*sin(y),x+y[0]])
+    N = 11
+    inputs = [DM.rand(1,N),DM.rand(2,N)]
+    n_threads = GlobalOptions.getMaxNumThreads()
+    try:
+      GlobalOptions.setMaxNumThreads(3)
+      F = fun.map(N,"thread")
+    finally:
+      GlobalOptions.setMaxNumThreads(n_threads)
+    for backend in ["serial","openmp","pthreads","callback"]:
+      self.check_codegen(F,inputs=inputs,opts={"thread_backend":backend},extralibs=["pthread"] if backend=="pthreads" else "")
+      cg = CodeGenerator("me",{"thread_backend":backend})
+      cg.add(F)
+      code = cg.dump()
+      self.assertEqual("casadi_parallel_for(" in code, backend!="serial")
+      self.assertEqual("me_set_dispatch(" in code, backend=="callback")
+
+  def test_codegen_profile(self):
+    x = MX.sym("x",2)
+    g = Function("g",[x],[sin(x)])
+    f = Function("f",[x],[g(x)+g(2*x)])
+    inputs = [DM([0.3,0.7])]
+    for profile in [False,True]:
+      for profile_calls in [False,True]:
+        opts = {"profile":profile,"profile_calls":profile_calls}
+        self.check_codegen(f,inputs=inputs,opts=opts)
+        cg = CodeGenerator("me",opts)
+        cg.add(f)
+        code = cg.dump()
+        self.assertEqual(code.count("CASADI_PROFILE_EXIT(0, \"f\""),int(profile))
+        self.assertEqual(code.count("CASADI_PROFILE_EXIT(1, \"g\""),2*int(profile_calls))
+
+  def test_codegen_cpp_template(self):
+    x = SX.sym("x",2)
+    y = SX.sym("y")
+    f = Function("f",[x,y],[sin(x)*y+2,mtimes(x,x.T)])
+    cg = CodeGenerator("tmpl_f",{"cpp_template":True})
+    cg.add(f)
+    code = cg.dump()
+    self.assertTrue("struct tmpl_f {" in code)
+    self.assertTrue("static constexpr casadi_int" in code)
+    self.assertFalse("extern \"C\"" in code)
+    if args.run_slow:
+      import subprocess
+      cg.generate()
+      with open("tmpl_f_main.cpp","w") as out:
+        out.write("""#include "tmpl_f.hpp"
+#include <cstdio>
+#include <vector>
+template<typename T> void run() {
+  typedef tmpl_f<T> F;
+  casadi_int sz_arg, sz_res, sz_iw, sz_w;
+  F::f_work(&sz_arg, &sz_res, &sz_iw, &sz_w);
+  std::vector<const T*> arg(sz_arg);
+  std::vector<T*> res(sz_res);
+  std::vector<casadi_int> iw(sz_iw);
+  std::vector<T> w(sz_w);
+  T x[2] = {T(0.3), T(0.7)}, y = T(2), r0[2], r1[4];
+  arg[0] = x; arg[1] = &y; res[0] = r0; res[1] = r1;
+  if (F::f(arg.data(), res.data(), iw.data(), w.data(), 0)) return;
+  for (T e : r0) printf("%.17g\\n", static_cast<double>(e));
+  for (T e : r1) printf("%.17g\\n", static_cast<double>(e));
+}
+int main() { run<double>(); run<float>(); return 0; }
+""")
+      self.assertEqual(subprocess.call("g++ -std=c++17 -Wall -Werror tmpl_f_main.cpp -o tmpl_f_main",shell=True),0)
+      out = [float(e) for e in subprocess.check_output("./tmpl_f_main").split()]
+      ref = vertcat(*[vec(e) for e in f(DM([0.3,0.7]),2)])
+      self.checkarray(DM(out[:6]),ref,digits=15)
+      self.checkarray(DM(out[6:]),ref,digits=6)
+
+  def test_codegen_float_math(self):
+    x = SX.sym("x",2)
+    y = SX.sym("y")
+    f = Function("f",[x,y],[vertcat(sin(x)*y+0.1*exp(x[1]),sqrt(y)/(1+x[0]**2)),2*x[0]/y],["x","y"],["r","q"])
+    cg = CodeGenerator("me",{"casadi_real":"float","float_math":True,"input_range":{"f":[[-1,2],[0.5,4]]}})
+    cg.add(f)
+    code = cg.dump()
+    for e in ["sinf(","expf(","sqrtf(","e-01f;"]:
+      self.assertTrue(e in code)
+    self.assertFalse("sin(" in code)
+    self.assertTrue("Range analysis" in code)
+    self.assertTrue("q: [-4.000e+00, 8.000e+00]" in code)
+    with self.assertInException("requires casadi_real float"):
+      CodeGenerator("me",{"float_math":True})
+    if args.run_slow:
+      import subprocess
+      cg.generate()
+      self.assertEqual(subprocess.call("gcc -std=c99 -Wall -Wdouble-promotion -Wno-unused-parameter -Werror -c me.c -o me.o",shell=True),0)
+
+  def test_codegen_simd(self):
+    A = MX.sym("A",7,5)
+    B = MX.sym("B",5,3)
+    v = MX.sym("v",7)
+    f = Function('f',[A,B,v],[mtimes(A,B),mtimes(A.T(),v),dot(v,v)])
+    np.random.seed(0)
+    inputs = [np.random.random((7,5)),np.random.random((5,3)),np.random.random((7,1))]
+    self.checkfunction_light(f,f.expand(),inputs=inputs)
+    self.check_codegen(f,inputs=inputs)
+    self.check_codegen(f,inputs=inputs, opts={"simd": True})
+
+  def test_codegen_blas(self):
+    A = MX.sym("A",40,40)
+    B = MX.sym("B",40,40)
+    v = MX.sym("v",1600)
+    f = Function('f',[A,B,v],[mtimes(A,B),dot(v,v)])
+    np.random.seed(0)
+    inputs = [np.random.random((40,40)),np.random.random((40,40)),np.random.random((1600,1))]
+    self.checkfunction_light(f,f.expand(),inputs=inputs)
+    self.check_codegen(f,inputs=inputs, opts={"blas": True},extralibs=["blas"])
+
+
+  def test_codegen_split(self):
+    x = SX.sym("x",3)
+    g = Function('g',[x],[sin(x)*dot(x,x)])
+    X = MX.sym("X",3)
+    Z = MX.sym("Z",3,4)
+    f = Function('f',[X,Z],[g(g(X)+1), g.map(4)(Z), mtimes(Z.T,X)])
+    inputs = [DM([0.1,0.2,0.3]),DM.rand(3,4)]
+    self.check_codegen(f,inputs=inputs,opts={"split":True})
+    self.check_codegen(f,inputs=inputs,opts={"split":True,"main":True,"with_header":True})
+
+    # Unchanged translation units are not rewritten
+    name = "codegen_split_unchanged"
+    def generate(f):
+      cg = CodeGenerator(name,{"split":True})
+      cg.add(f)
+      cg.generate()
+      return {fname: os.path.getmtime(fname) for fname in os.listdir(".") if fname.startswith(name)}
+    t0 = generate(f)
+    self.assertTrue(name+"_shared.h" in t0 and name+"_f0.c" in t0 and name+"_f1.c" in t0)
+    import time
+    time.sleep(0.1)
+    t1 = generate(Function('f',[X,Z],[g(g(X)+1), g.map(4)(Z), mtimes(Z.T,X)]))
+    self.assertEqual(t0,t1)
+
+  def test_codegen_batch(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p",2)
+    f = Function('f',[x,p],[sin(x)*dot(x,x)+p[0], sqrt(p[1]**2+x[0]), fmax(x[1],p[0])])
+    N = 5
+    X = DM.rand(3,N)
+    P = DM.rand(2,N)
+    ref = f.map(N)(X,P)
+    for avoid_stack in [False, True]:
+      _, libname = self.check_codegen(f,inputs=[X[:,0],P[:,0]],opts={"batch":N,"avoid_stack":avoid_stack})
+      # One row per instance
+      F = external("f_batch", libname)
+      self.assertEqual(F.size_in(0), (N,3))
+      self.assertEqual(F.size_out(1), (N,1))
+      out = F(X.T,P.T)
+      for i in range(3):
+        self.checkarray(out[i],ref[i].T,digits=15)
+
+  def test_codegen_cuda(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p",2)
+    f = Function('f',[x,p],[sin(x)*dot(x,x)+p[0], sqrt(p[1]**2+x[0]), fmax(x[1],p[0])])
+    # Host code is unaffected when not compiled with nvcc or hipcc
+    self.check_codegen(f,inputs=[DM.rand(3),DM.rand(2)],opts={"cuda":True})
+    cg = CodeGenerator("f_cuda_gen",{"cuda":True})
+    cg.add(f)
+    code = cg.dump()
+    self.assertTrue("__global__ void f_cuda_kernel(" in code)
+    self.assertTrue("int f_cuda(const casadi_real** arg, casadi_real** res, casadi_int n, void* stream)" in code)
+    self.assertTrue("casadi_fmax" not in code.split("__global__")[1])
 
   def test_serialize(self):
     for opts in [{"debug":True},{}]:
@@ -2046,6 +2690,128 @@ class Functiontests(casadiTestCase):
       fs = Function.deserialize(f.serialize(opts))
       self.checkfunction(f,fs,inputs=[1.1, vertcat(2.7,3)],hessian=False)
 
+  def test_serialize_interned(self):
+      x = MX.sym("x",10)
+      A = DM.rand(10,10)
+      y = x
+      for i in range(20):
+        y = sin(mtimes(DM(A),y))
+      f = Function("f",[x],[y])
+      for opts in [{"debug":True},{}]:
+        fs = Function.deserialize(f.serialize(opts))
+        self.checkfunction(f,fs,inputs=[DM.rand(10)],hessian=False)
+      # Repeated constants are stored once
+      g = Function("g",[x],[sin(mtimes(DM(A),x))])
+      self.assertTrue(len(f.serialize())<5*len(g.serialize()))
+
+  def test_serialize_compression(self):
+      x = MX.sym("x",3)
+      f = Function("f",[x],[sin(x)*x[0],jacobian(sin(x)*x[0],x)])
+      F = f.map(4)
+      for opts in [{"compression":"lz"},{"compression":"lz","binary":True},{"compression":"none"}]:
+        F.save("f_lz.casadi",opts)
+        Fs = Function.load("f_lz.casadi")
+        self.checkfunction(F,Fs,inputs=[DM.rand(3,4)],hessian=False)
+      F.save("f_lz.casadi",{"compression":"lz"})
+      size_compressed = os.path.getsize("f_lz.casadi")
+      F.save("f_lz.casadi")
+      self.assertTrue(size_compressed<os.path.getsize("f_lz.casadi"))
+      with self.assertInException("Unknown compression"):
+        F.save("f_lz.casadi",{"compression":"foo"})
+
+  def test_serialize_sx_tape(self):
+      x = SX.sym("x",2)
+      p = SX.sym("p")
+      y = vertcat(sin(x[0])*x[1]+3.5, x[0], 2, p*x[1])
+      f = Function("f",[x],[y,x[1]**2],{"allow_free":True})
+      fs = Function.deserialize(f.serialize())
+      self.assertEqual(fs.n_instructions(),f.n_instructions())
+      self.assertEqual(str(fs.sx_out()),str(f.sx_out()))
+      self.assertEqual(str(fs.free_sx()),str(f.free_sx()))
+
+      f = Function("f",[x],[y[:3],x[1]**2])
+      fs = Function.deserialize(f.serialize())
+      self.checkfunction(f,fs,inputs=[vertcat(1.1,2.7)],hessian=False)
+      # Symbolic manipulations on the regenerated graph
+      self.checkfunction(f.jacobian(),fs.jacobian(),inputs=[vertcat(1.1,2.7)]+[DM.zeros(3,1),0],hessian=False)
+
+  def test_profiler(self):
+      x = MX.sym("x",2)
+      f = Function("f",[x],[sin(x)])
+      F = Function("F",[x],[f.map(3)(repmat(x,1,3))])
+      Profiler.start()
+      self.assertTrue(Profiler.is_enabled())
+      F(DM([1,2]))
+      F(DM([1,2]))
+      Profiler.stop()
+      s = Profiler.stats()
+      self.assertEqual(s["F"]["n_call"],2)
+      self.assertEqual(s["F;map3_f;f"]["n_call"],6)
+      self.assertTrue(s["F"]["t_total"]>=s["F"]["t_self"])
+      Profiler.save_trace("profile.json")
+      import json
+      with open("profile.json") as fh:
+        trace = json.load(fh)
+      self.assertEqual(len(trace["traceEvents"]),10)
+      Profiler.save_folded("profile.folded")
+      with open("profile.folded") as fh:
+        self.assertTrue(any(l.startswith("F;map3_f;f ") for l in fh))
+      # Not recording when stopped
+      F(DM([1,2]))
+      self.assertEqual(Profiler.stats()["F"]["n_call"],2)
+      Profiler.clear()
+      self.assertEqual(len(Profiler.stats()),0)
+
+  def test_profiler_construct(self):
+      x = MX.sym("x",2)
+      Profiler.start()
+      g = Function("g",[x],[sin(x)])
+      Profiler.stop()
+      s = Profiler.stats()
+      for phase in ["options","init","finalize"]:
+        self.assertEqual(s["g:construct:"+phase]["n_call"],1)
+      Profiler.clear()
+
+  def test_profiler_instructions(self):
+      x = SX.sym("x",2)
+      f = Function("f",[x],[sin(x)*x[0]])
+      y = MX.sym("y",2)
+      F = Function("F",[y],[mtimes(DM.ones(2,2),f(y[[1,0]]))])
+      Profiler.start(True)
+      self.assertTrue(Profiler.is_instructions_enabled())
+      r = F(DM([1,2]))
+      Profiler.stop()
+      self.checkarray(r,mtimes(DM.ones(2,2),sin(DM([2,1]))*2))
+      s = Profiler.instruction_stats()
+      self.assertEqual(s["sin"]["n_call"],2)
+      self.assertEqual(s["call"]["n_call"],1)
+      self.assertTrue("mtimes" in s)
+      self.assertTrue("getnonzeros" in s)
+      report = Profiler.hot_nodes(100)
+      self.assertTrue("sin(@" in report)
+      self.assertTrue("f(" in report)
+      self.assertEqual(len(Profiler.hot_nodes(2).splitlines()),3)
+      # Function-level profiling only
+      Profiler.start()
+      F(DM([1,2]))
+      Profiler.stop()
+      self.assertEqual(len(Profiler.instruction_stats()),0)
+      self.assertEqual(Profiler.stats()["F;f"]["n_call"],1)
+
+  def test_serialize_binary(self):
+      x = MX.sym("x",3)
+      A = DM.rand(3,3)
+      f = Function("f",[x],[mtimes(A,x)+sin(x),jacobian(sin(x)*x[0],x)])
+      for opts in [{"binary":True},{"binary":True,"debug":True},{}]:
+        f.save("f_binary.casadi",opts)
+        fs = Function.load("f_binary.casadi")
+        self.checkfunction(f,fs,inputs=[vertcat(1.1,2.7,3)],hessian=False)
+      # Binary layout is more compact than the text layout
+      f.save("f_binary.casadi",{"binary":True})
+      size_binary = os.path.getsize("f_binary.casadi")
+      f.save("f_binary.casadi")
+      self.assertTrue(size_binary<os.path.getsize("f_binary.casadi"))
+
   @memory_heavy()
   def test_serialize_recursion_limit(self):
       for X in [SX,MX]:
@@ -2105,6 +2871,21 @@ class Functiontests(casadiTestCase):
       res = finv_par(numpy.ones(200), numpy.linspace(0, 10, 200))
       self.checkarray(norm_inf(res.T-sqrt(numpy.linspace(0, 10, 200))),0, digits=5)
 
+  def test_checkout(self):
+    x = SX.sym('x')
+    f = Function('f', [x], [sin(x)])
+    # Distinct memory objects while checked out
+    m = [f.checkout() for i in range(40)]
+    self.assertEqual(len(set(m)), 40)
+    for i in m: f.release(i)
+    # Released memory objects are reused
+    m2 = [f.checkout() for i in range(40)]
+    self.assertEqual(set(m2), set(m))
+    for i in m2: f.release(i)
+    # Concurrent checkout and release
+    F = f.map(400, 'thread', 8)
+    self.checkarray(F(DM(range(400)).T), sin(DM(range(400)).T))
+
   def test_mapped_eval(self):
       x = SX.sym('x')
       y = SX.sym('y', 2)
@@ -2152,6 +2933,63 @@ class Functiontests(casadiTestCase):
         self.assertTrue("-1e-07," in out[0] or "-1e-007," in out[0] )
         self.assertTrue("1e-07," in out[0] or "1e-007," in out[0] )
 
+  def test_fd_parallelization(self):
+      x = MX.sym("x",7)
+      x0 = DM.rand(7)
+      J_ref = jacobian(sin(x)*dot(x,x),x)
+      J_ref = Function("J",[x],[J_ref])(x0)
+      for fd_method in ["forward","central","smoothing"]:
+        for parallelization in ["serial","thread"]:
+          fd = Function("f",[x],[sin(x)*dot(x,x)],{"enable_fd":True,"enable_forward":False,"enable_reverse":False,
+            "fd_method":fd_method,"fd_options":{"parallelization":parallelization}})
+          J = fd.jacobian()(x0,0)
+          self.checkarray(J,J_ref,digits=5)
+
+  @requiresPlugin(Importer,"shell")
+  def test_jit_async(self):
+    x = SX.sym("x",2)
+    fref = Function('f',[x],[sin(x)*x[0]])
+    for jit_serialize in ["source","link"]:
+      f = Function('f',[x],[sin(x)*x[0]],{"jit":True,"compiler":"shell","jit_async":True,"jit_serialize":jit_serialize})
+      # Correct before and after the compiled code is ready
+      self.checkfunction_light(f,fref,inputs=[DM([1,2])])
+      self.checkfunction_light(Function.deserialize(f.serialize()),fref,inputs=[DM([1,2])])
+      self.checkfunction_light(f,fref,inputs=[DM([1,2])])
+
+  @requiresPlugin(Importer,"shell")
+  def test_jit_hot(self):
+    x = MX.sym("x",2)
+    fref = Function('f',[x],[sin(x)*x[0]])
+    for opts in [{"jit_hot_calls":3},{"jit_hot_calls":3,"jit_hot_expand":True},{"jit_hot_time":1e-9}]:
+      opts["compiler"] = "shell"
+      f = Function('f',[x],[sin(x)*x[0]],opts)
+      # Correct before, during and after the switch to compiled code
+      for i in range(10):
+        self.checkarray(f(DM([1,2])),fref(DM([1,2])))
+      self.checkfunction_light(Function.deserialize(f.serialize()),fref,inputs=[DM([1,2])])
+
+  @requiresPlugin(Importer,"shell")
+  def test_jit_cache(self):
+    import tempfile
+    x = MX.sym("x",2)
+    cache = tempfile.mkdtemp()+os.sep
+    opts = {"jit":True,"compiler":"shell","jit_options":{"cache_directory":cache,"verbose":True}}
+    f = Function('f',[x],[sin(x)*3],opts)
+    self.assertEqual(len(os.listdir(cache)),1)
+
+    # Identical source is reused, also under a different temporary name
+    with capture_stdout() as out:
+      g = Function('f',[x],[sin(x)*3],opts)
+    self.assertTrue("Using cached" in out[0])
+    self.checkarray(g(DM([1,2])),f(DM([1,2])))
+    self.assertEqual(len(os.listdir(cache)),1)
+
+    # Different source or flags
+    Function('f',[x],[sin(x)*2],opts)
+    opts["jit_options"]["flags"] = ["-O2"]
+    Function('f',[x],[sin(x)*3],opts)
+    self.assertEqual(len(os.listdir(cache)),3)
+
   @requires_nlpsol("ipopt")
   @requiresPlugin(Importer,"shell")
   def test_inherit_jit_options(self):
@@ -2233,6 +3071,22 @@ class Functiontests(casadiTestCase):
       self.checkarray(Xr,X)
       self.checkarray(Ar,A)
 
+    # Binary dump: all inputs (outputs) of a call in one file
+    f = Function("f",[x,y,z],[2*x,2*z],["x","y","z"],["a","c"],{"dump":True,"dump_in":True,"dump_out":True,"dump_format":"bin"})
+    ins = [sparsify(DM([[1,0,0],[2,4,0],[7,8,9]])),DM(),DM([[1,3],[4,5]])]
+    out = f(*ins)
+    F = Function.load("f.casadi")
+    ins2 = F.generate_in("f.000000.in.bin")
+    out2 = F.generate_out("f.000000.out.bin")
+    for i in range(3):
+      self.checkarray(ins2[i],ins[i])
+    for i in range(2):
+      self.checkarray(out2[i],out[i])
+    F.generate_in("test_in.bin", ins)
+    ins2 = F.generate_in("test_in.bin")
+    for i in range(3):
+      self.checkarray(ins2[i],ins[i])
+
   def test_eval_shapes(self):
     x = MX.sym("x",Sparsity.lower(3))
     y = MX.sym("y",3,1)
@@ -2618,6 +3472,55 @@ class Functiontests(casadiTestCase):
 
     self.assertEqual(buf.ret(), 0)
 
+  def test_numpy_evaluator(self):
+    x = MX.sym("x",2)
+    A = MX.sym("A",Sparsity.lower(2))
+    y = MX.sym("y",2,3)
+    f = Function("f",[x,A,y],[mtimes(A,x),y*x[0],A*2])
+
+    x_ = np.array([1.,2.])
+    A_ = np.array([[1.,0],[3,4]])
+    y_ = np.arange(6.).reshape(2,3)
+    ref = f(x_,A_,y_)
+
+    for release_gil in [True, False]:
+      ev = f.numpy_evaluator(release_gil=release_gil)
+      res = ev(x_,A_,y_)
+      for r, e in zip(res, ref):
+        self.assertEqual(r.shape, e.shape)
+        self.checkarray(r, e.full())
+
+      # Outputs written in place
+      out = [np.zeros((2,1),order='F'),np.zeros((2,3),order='F'),np.zeros((2,2))]
+      res = ev(x_,A_,y_,out=out)
+      for r, o, e in zip(res, out, ref):
+        self.assertTrue(r is o)
+        self.checkarray(o, e.full())
+
+    # Leading batch dimension, A and y shared
+    X = np.random.random((5,2))
+    r0, r1, r2 = ev(X,A_,y_)
+    self.assertEqual(r0.shape, (5,2))
+    self.assertEqual(r1.shape, (5,2,3))
+    self.assertEqual(r2.shape, (5,2,2))
+    for k in range(5):
+      e = f(X[k],A_,y_)
+      self.checkarray(r0[k], e[0].full().ravel())
+      self.checkarray(r1[k], e[1].full())
+      self.checkarray(r2[k], e[2].full())
+
+    # Concurrent evaluation from Python threads
+    import threading
+    Xs = [np.random.random((50,2)) for i in range(4)]
+    results = [None]*4
+    def work(i):
+      results[i] = ev(Xs[i],A_,y_)[0]
+    threads = [threading.Thread(target=work,args=(i,)) for i in range(4)]
+    for t in threads: t.start()
+    for t in threads: t.join()
+    for i in range(4):
+      self.checkarray(results[i], np.dot(Xs[i],A_.T))
+
   @requires_conic("osqp")
   @requiresPlugin(Importer,"shell")
   def test_jit_buffer_eval(self):
@@ -2775,6 +3678,19 @@ class Functiontests(casadiTestCase):
       with self.assertOutput([],["jit_tmp"]):
         g = Function.load('f.casadi')
 
+    # Libraries for other targets are carried along, unmatched ones are not loaded
+    with open('bogus.so', 'w') as f: f.write("not a library")
+    x = MX.sym("x")
+    for key in ["linux-aarch64", "osx-x86_64", "linux-x86_64+bogus"]:
+      opts = {"jit":True, "compiler": "shell", "jit_serialize": "embed", "jit_binaries": {key: "bogus.so"}}
+      f = Function('f',[x],[(x-3)**2],opts)
+      f.save('f.casadi')
+      g = Function.load('f.casadi')
+      self.checkfunction_light(f, g, inputs=[2])
+      g.save('f.casadi')
+      g = Function.load('f.casadi')
+      self.checkfunction_light(f, g, inputs=[2])
+
 
   def test_map_get_function(self):
     x = MX.sym("x")
@@ -2806,7 +3722,25 @@ class Functiontests(casadiTestCase):
     # Check that the option came through
     with self.assertOutput(["Input 0 (i0): 3"],[]):
       f(3)
-  
+
+  def test_expand_repeated_call(self):
+    x = MX.sym("x",2)
+    u = MX.sym("u")
+    g = Function("g",[x,u],[vertcat(x[1],sin(x[0])*u)])
+    xk = x
+    for i in range(3):
+      xk = xk + 0.1*g(xk,u)
+    step = Function("step",[x,u],[xk])
+    X = x
+    J = 0
+    for k in range(5):
+      X = step(X,u*k)
+      J += dot(X,X)
+    f = Function("f",[x,u],[J,X])
+    fsx = f.expand()
+    self.assertTrue(fsx.is_a("SXFunction"))
+    self.checkfunction_light(f,fsx,inputs=[vertcat(0.3,0.7),1.3])
+
   @requires_conic('osqp')
   def test_memful_main(self):
     c = conic("conic","osqp",{"a":Sparsity.dense(1,2),"h":Sparsity.dense(2,2)},{"print_problem":True,"osqp.verbose":False})
@@ -2849,6 +3783,163 @@ class Functiontests(casadiTestCase):
         self.assertTrue(f1.n_instructions()>3)
         self.assertTrue(f2.n_instructions()<=3)
 
+  def test_cse_commutative(self):
+    for X in [SX,MX]:
+        x = X.sym("x",2)
+        y = X.sym("y",2)
+        # Operands of commutative operations in either order
+        w = exp(sin(x)*cos(y)+x)-exp(x+cos(y)*sin(x))
+        self.assertFalse(w.is_zero())
+        self.assertTrue(cse(w).is_zero())
+        # Long chains with shared structure
+        a = x
+        b = x
+        for i in range(2000):
+          a = sin(a)+y
+          b = y+sin(b)
+        f = Function('f',[x,y],[a,b],{"cse":True})
+        [ac,bc] = cse([a,b])
+        self.assertTrue(is_equal(ac,bc))
+        self.checkarray(f(DM([1,2]),DM([3,4]))[0],f(DM([1,2]),DM([3,4]))[1])
+
+  def test_optimize(self):
+    x = SX.sym("x",2)
+    y = SX.sym("y")
+    e = vertcat(3*(2*x[0])/4, (x[1]-1)+2, constpow(x[0],2)*y, sin(x[0]*y)+sin(y*x[0]))
+    f = Function('f',[x,y],[e])
+    fo = Function('fo',[x,y],[e],{"optimize":True})
+    self.assertTrue(fo.info()["n_operations"]<f.info()["n_operations"])
+    for xv,yv in [([0.3,1.7],2.1),([-1.1,0.4],0.5)]:
+      self.checkarray(f(xv,yv),fo(xv,yv),digits=12)
+    # Derivatives are consistent
+    self.checkfunction(fo,f,inputs=[DM([0.3,1.7]),2.1])
+
+  def test_taylor(self):
+    x = SX.sym("x",2)
+    y = SX.sym("y")
+    e = vertcat(sin(x[0])*exp(y)/x[1], atan2(x[0],y)+sqrt(x[1])**3, fmax(x[0],y)*tanh(x[1]))
+    f = Function("f",[x,y],[e])
+    t = SX.sym("t")
+    vx = DM([0.3,-0.2])
+    vy = 0.7
+    x0 = DM([0.4,1.3])
+    y0 = 0.2
+    # Reference: derivatives of f(x0+t*vx, y0+t*vy) with respect to t
+    g = f(x0+t*vx,y0+t*vy)
+    order = 3
+    F = f.taylor(order)
+    self.assertEqual(F.n_in(),4)
+    self.assertEqual(F.n_out(),order+1)
+    c = F(x0,y0,vx,vy)
+    fact = 1
+    for d in range(order+1):
+      if d>0: fact *= d
+      ref = Function("ref",[t],[g])(0)
+      self.checkarray(c[d],ref/fact,digits=10)
+      g = jacobian(g,t)
+    self.check_codegen(F,inputs=[x0,y0,vx,vy])
+
+  def test_auto_map(self):
+    x = MX.sym("x",2)
+    p = MX.sym("p")
+    F = Function("F",[x,p],[sin(x)*p,dot(x,x)])
+    X = MX.sym("X",2,4)
+    q = MX.sym("q")
+    r = [F(X[:,i],q) for i in range(4)]
+    # Chained call, depends on the others
+    s = F(r[0][0]+r[3][0],q)
+    e = vertcat(*[vertcat(a,b) for a,b in r]+[s[0],s[1]])
+
+    def n_calls(f):
+      return sum(1 for k in range(f.n_instructions()) if f.instruction_MX(k).is_call())
+
+    f_ref = Function("f",[X,q],[e])
+    for par in ["serial","thread"]:
+      f = Function("f",[X,q],[e],{"auto_map":par})
+      self.assertEqual(n_calls(f_ref),5)
+      self.assertEqual(n_calls(f),2)
+      self.checkfunction(f,f_ref,inputs=[DM.rand(2,4),0.7])
+
+    [e2] = auto_map([e],"serial",5)
+    f = Function("f",[X,q],[e2])
+    self.assertEqual(n_calls(f),5)
+
+  def test_fuse_calls(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    F = Function("F",[x,p],[sin(x)*p,dot(x,x)])
+    G = Function("G",[x,p],[cos(x)+p,x[0]],{"never_inline":True})
+    X = MX.sym("X",2,4)
+    q = MX.sym("q")
+    r = [F(X[:,i],q) for i in range(4)]
+    # Chained call, depends on the others through an MX operation
+    s = F(r[0][0]+r[3][0],q)
+    t = G(r[1][0],q)
+    e = vertcat(*[vertcat(a,b) for a,b in r]+[s[0],s[1],t[0]])
+
+    def n_calls(f):
+      return sum(1 for k in range(f.n_instructions()) if f.instruction_MX(k).is_call())
+
+    f_ref = Function("f",[X,q],[e])
+    f = Function("f",[X,q],[e],{"fuse_calls":100})
+    self.assertEqual(n_calls(f_ref),6)
+    self.assertEqual(n_calls(f),3)
+    self.checkfunction(f,f_ref,inputs=[DM.rand(2,4),0.7])
+
+    # Functions above the size threshold are not fused
+    [e2] = fuse_calls([e],1)
+    f = Function("f",[X,q],[e2])
+    self.assertEqual(n_calls(f),6)
+
+  def test_partial_eval(self):
+    for X, opts in [(SX,{}), (SX,{"bytecode":True}), (MX,{})]:
+      x = X.sym("x",3)
+      y = sin(x)
+      # Outputs share y, each also has a private subgraph
+      f = Function("f",[x],[y*cos(x),dot(y,exp(x)),x[0]*y[1]],opts)
+      x0 = DM([0.1,0.7,-0.3])
+      ref = f(x0)
+      xm = MX.sym("x",3)
+      for i in range(3):
+        # The call node passes null for the unused outputs
+        g = Function("g",[xm],[f(xm)[i]])
+        self.checkarray(g(x0),ref[i])
+      g = Function("g",[xm],[f(xm)[0]+f(xm)[2]])
+      self.checkarray(g(x0),ref[0]+ref[2])
+
+  def test_parallel_eval(self):
+    x = MX.sym("x",2)
+    p = MX.sym("p")
+    F = Function("F",[x,p],[sin(x)*p,dot(x,x)])
+    X = MX.sym("X",2,4)
+    q = MX.sym("q")
+    r = [F(X[:,i],q) for i in range(4)]
+    # Chained call, depends on the others
+    s = F(r[0][0]+r[3][0],q)
+    e = vertcat(*[vertcat(a,b) for a,b in r]+[s[0],s[1]])
+    f_ref = Function("f",[X,q],[e,s[1]])
+    f = Function("f",[X,q],[e,s[1]],{"parallel":True})
+    self.checkfunction(f,f_ref,inputs=[DM.rand(2,4),0.7])
+    # Only the second output
+    Xm = MX.sym("X",2,4)
+    g = Function("g",[Xm,q],[f(Xm,q)[1]])
+    self.checkarray(g(DM.ones(2,4),0.7),f_ref(DM.ones(2,4),0.7)[1])
+
+  def test_work_reuse(self):
+    x = MX.sym("x",12)
+    # Intermediates of decreasing size, followed by in-place operations
+    y = x
+    for n in [10,8,6,4]:
+      y = sin(y[:n])*y[1:n+1]
+    z = MX.zeros(4)
+    z[1:3] = y[:2]
+    e = vertcat(reshape(reshape(z,2,2).T,4,1),y)
+    f_ref = Function("f",[x],[e],{"live_variables":False})
+    f = Function("f",[x],[e])
+    self.checkfunction(f,f_ref,inputs=[DM.rand(12)])
+    self.assertTrue(f.sz_w()<f_ref.sz_w())
+    self.check_codegen(f,inputs=[DM.rand(12)])
+
   @memory_heavy()
   def test_stop_diff(self):
     x = MX.sym("x")
@@ -3208,6 +4299,29 @@ class Functiontests(casadiTestCase):
     if not args.run_slow: return
     F,_ = self.check_codegen(f,inputs=[DM.rand(f.sparsity_in(i)) for i in range(f.n_in())],with_jac_sparsity=True,with_forward=True)
     mychecks(F,exempt=True)
+
+  def test_function_cache(self):
+    import tempfile, os, shutil
+    x = MX.sym("x",3)
+    f = Function('f',[x],[sin(x)*dot(x,x)])
+    GlobalOptions.setFunctionCacheSize(2)
+    try:
+      # Derivatives are kept alive between calls
+      h = f.jacobian().__hash__()
+      self.assertEqual(f.jacobian().__hash__(),h)
+    finally:
+      GlobalOptions.setFunctionCacheSize(0)
+    d = tempfile.mkdtemp()
+    try:
+      GlobalOptions.setFunctionCache(d)
+      J = f.jacobian()
+      self.assertTrue(len(os.listdir(d))>0)
+      # Equivalent function in a fresh state: loaded from disk
+      J2 = Function('f',[x],[sin(x)*dot(x,x)]).jacobian()
+      self.checkfunction(J2,J,inputs=[[1,2,3],0])
+    finally:
+      GlobalOptions.setFunctionCache("")
+      shutil.rmtree(d)
     
 if __name__ == '__main__':
     unittest.main()
@@ -203,6 +203,81 @@ class ImplicitFunctiontests(casadiTestCase):
       refsol = Function("refsol", [y,x],[vertcat(sin(x),sqrt(sin(x)))-y0]) # ,sin(x)**2])
       self.checkfunction(solver,refsol,inputs=[n,0],digits=4,sens_der=False,failmessage=message)
 
+  def test_newton_reuse_jacobian(self):
+    y = SX.sym("y",2)
+    q = SX.sym("q")
+    g = Function("g",[y,q],[vertcat(y[0]**2+y[1]-q,y[1]**3+y[0]-2)])
+    R = rootfinder("R","newton",g)
+    Rr = rootfinder("R","newton",g,{"reuse_jacobian":True})
+    for i,qv in enumerate([2,2.01,2.02]):
+      self.checkarray(Rr([0.9,1.1],qv),R([0.9,1.1],qv),digits=10)
+      # Factorization is kept between calls
+      self.assertEqual(Rr.stats()["n_fact"],1 if i==0 else 0)
+      self.assertTrue(R.stats()["n_fact"]>1)
+    self.checkfunction(Rr,R,inputs=[[0.9,1.1],2.01],digits=8,sens_der=False,evals=False)
+
+    x = SX.sym("x",2)
+    z = SX.sym("z")
+    p = SX.sym("p")
+    dae = {"x":x,"z":z,"p":p,"ode":vertcat(x[1],-p*sin(x[0])+z),"alg":z-0.1*x[1]**3-0.01*z**3}
+    opts = {"number_of_finite_elements":100}
+    I = integrator("I","collocation",dae,0,[1,2,5],opts)
+    opts["rootfinder_options"] = {"reuse_jacobian":True}
+    Ir = integrator("I","collocation",dae,0,[1,2,5],opts)
+    self.checkarray(Ir(x0=[0.3,0.1],p=2)["xf"],I(x0=[0.3,0.1],p=2)["xf"],digits=10)
+
+  def test_newton_broyden(self):
+    x = SX.sym("x",4)
+    p = SX.sym("p")
+    g = Function("g",[x,p],[vertcat(x[0]**2+x[1]-3*p,x[1]**3+x[0]-2+0.1*x[2],
+                                     sin(x[2])+x[3]*x[2]-0.5,exp(0.3*x[3])+x[0]*x[3]-2)])
+    x0 = [1.2,0.8,0.4,0.7]
+    R = rootfinder("R","newton",g)
+    Rb = rootfinder("R","newton",g,{"broyden":5})
+    self.checkarray(Rb(x0,1.1),R(x0,1.1),digits=10)
+    self.assertTrue(Rb.stats()["n_fact"]<R.stats()["n_fact"])
+    self.checkarray(Function.deserialize(Rb.serialize())(x0,1.1),R(x0,1.1),digits=10)
+
+    for opts in [{},{"reuse_jacobian":True}]:
+      Rf = rootfinder("R","fast_newton",g,opts)
+      self.checkarray(Rf(x0,1.1),R(x0,1.1),digits=10)
+      if opts: self.assertEqual(Rf.stats()["n_fact"],1)
+      self.check_codegen(Rf,inputs=[x0,1.1])
+
+  def test_newton_block_triangular(self):
+    for X in [SX,MX]:
+      x = X.sym("x",8)
+      p = X.sym("p")
+      r = []
+      for k in range(4):
+        a, b = x[2*k], x[2*k+1]
+        # Blocks 2 and 3 both depend on block 1 only
+        c = x[2] if k>=2 else 0
+        r += [a+0.1*a**3+0.5*b-p-0.3*c, b+0.1*b**3-0.5*a-0.2*sin(c)]
+      g = Function("g",[x,p],[vertcat(*r),sum1(x)])
+      R = rootfinder("R","newton",g)
+      Rb = rootfinder("R","newton",g,{"block_triangular":True})
+      self.checkarray(Rb(DM.ones(8),1.1)[0],R(DM.ones(8),1.1)[0],digits=12)
+      self.checkarray(Rb(DM.ones(8),1.1)[1],R(DM.ones(8),1.1)[1],digits=12)
+      self.checkfunction(Rb,R,inputs=[DM.ones(8),1.1],digits=8,sens_der=False,evals=False)
+      Rs = Function.deserialize(Rb.serialize())
+      self.checkarray(Rs(DM.ones(8),1.1)[0],R(DM.ones(8),1.1)[0],digits=12)
+
+  def test_kinsol_strategies(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p")
+    h = vertcat(0.3*cos(x[1])+p,0.2*sin(x[0]+x[2]),0.25*x[0]*x[1]/(1+x[0]**2))
+    f = Function("f",[x,p],[x-h])
+    R = rootfinder("R","newton",f)
+    for opts in [{"max_setup_calls":1},{"strategy":"fp"},{"strategy":"fp","anderson_depth":3},
+                 {"strategy":"picard"},{"strategy":"picard","anderson_depth":2},
+                 {"reuse_jacobian":True},
+                 {"reuse_jacobian":True,"linear_solver_type":"user_defined"}]:
+      opts["abstol"] = 1e-12
+      K = rootfinder("K","kinsol",f,opts)
+      for pv in [0.5,0.51,0.52]:
+        self.checkarray(K(0,pv),R(0,pv),digits=10)
+
   def testKINSol1c(self):
     self.message("Scalar KINSol problem, n=0, constraint")
     x=SX.sym("x")
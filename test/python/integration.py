@@ -56,6 +56,8 @@ integrators.append(("collocation",["dae","ode"],{"rootfinder":"newton","number_o
 
 integrators.append(("rk",["ode"],{"number_of_finite_elements": 1000}))
 
+integrators.append(("dopri",["ode"],{"abstol": 1e-13,"reltol": 1e-13}))
+
 integrators.append(("collocation",["dae","ode"],{"rootfinder":"newton","number_of_finite_elements": 18,"simplify":True,"rootfinder":"fast_newton"}))
 
 integrators.append(("rk",["ode"],{"number_of_finite_elements": 1000,"simplify":True}))
@@ -995,6 +997,223 @@ class Integrationtests(casadiTestCase):
 
     self.assertTrue(intg.nnz_out("zf")==0)
 
+  def test_dopri(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    ode = vertcat(x[1],-p*sin(x[0]))
+    I = integrator("I","dopri",{"x":x,"p":p,"ode":ode,"quad":x[0]**2}, 0.0, [0.5,1.0,3.0], {"abstol":1e-10,"reltol":1e-10})
+    x0 = DM([0.3,0.1])
+    sol = I(x0=x0, p=2)
+    Iref = integrator("I","rk",{"x":x,"p":p,"ode":ode,"quad":x[0]**2}, 0.0, [0.5,1.0,3.0], {"number_of_finite_elements":3000})
+    sol_ref = Iref(x0=x0, p=2)
+    self.checkarray(sol["xf"],sol_ref["xf"],digits=8)
+    self.checkarray(sol["qf"],sol_ref["qf"],digits=8)
+    stats = I.stats()
+    self.assertTrue(stats["nsteps"]<3000)
+
+    # Step size control
+    I = integrator("I","dopri",{"x":x,"p":p,"ode":ode}, 0.0, 3.0, {"max_step_size":0.01})
+    I(x0=x0, p=2)
+    self.assertTrue(I.stats()["nsteps"]>=300)
+    I = integrator("I","dopri",{"x":x,"p":p,"ode":ode}, 0.0, 3.0, {"max_num_steps":5})
+    with self.assertInException("Maximum number of steps"):
+      I(x0=x0, p=2)
+
+    # Code generation, with and without forward sensitivities
+    I = integrator("I","dopri",{"x":x,"p":p,"ode":ode,"quad":x[0]**2}, 0.0, [0.5,1.0,3.0])
+    self.check_codegen(I,inputs={"x0":x0,"p":2})
+    self.check_codegen(I.forward(1),inputs={"x0":x0,"p":2,"fwd_x0":DM([1,0]),"fwd_p":1})
+
+  @requires_integrator('multirate')
+  def test_multirate(self):
+    # Slow pendulum driving a fast first-order lag
+    x = SX.sym("x",3)
+    p = SX.sym("p")
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],-p*sin(x[0]),50*(x[0]-x[2])),"quad":x[2]**2}
+    x0 = DM([0.3,0.1,0])
+    I = integrator("I","multirate",dae,0.0,[0.5,1.0],
+                   {"fast_states":[2],"substeps":8,"number_of_finite_elements":20})
+    ref = integrator("I","rk",dae,0.0,[0.5,1.0],{"number_of_finite_elements":1000})
+    self.checkfunction_light(I,ref,inputs={"x0":x0,"p":2},digits=4)
+
+    # Without fast states, identical to rk
+    I = integrator("I","multirate",dae,0.0,[0.5,1.0],{"number_of_finite_elements":20})
+    ref = integrator("I","rk",dae,0.0,[0.5,1.0],{"number_of_finite_elements":20})
+    self.checkfunction_light(I,ref,inputs={"x0":x0,"p":2},digits=12)
+
+    # Forward and adjoint sensitivities through the step function
+    I = integrator("I","multirate",dae,0.0,1.0,
+                   {"fast_states":[2],"substeps":8,"number_of_finite_elements":20})
+    ref = integrator("I","rk",dae,0.0,1.0,{"number_of_finite_elements":1000})
+    self.checkfunction(I,ref,inputs={"x0":x0,"p":2},jacobian=False,gradient=False,
+                       hessian=False,sens_der=False,evals=False,digits=4)
+    with self.assertInException("even"):
+      integrator("I","multirate",dae,0.0,1.0,{"fast_states":[2],"substeps":3})
+
+  def test_checkpoints(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],-p*sin(x[0])),"quad":x[0]**2}
+    for plugin, opts in [("rk",{}),("collocation",{"rootfinder":"fast_newton"})]:
+      opts["number_of_finite_elements"] = 157
+      I = integrator("I",plugin,dae,0.0,[0.5,1.0,3.0],opts)
+      for checkpoints in [1,3,10]:
+        opts["checkpoints"] = checkpoints
+        Ic = integrator("I",plugin,dae,0.0,[0.5,1.0,3.0],opts)
+        adj = I.reverse(1)
+        adj_c = Ic.reverse(1)
+        inputs = {"x0":DM([0.3,0.1]),"p":2,"adj_xf":DM.ones(2,3),"adj_qf":DM([1,2,3]).T}
+        res = adj(**inputs)
+        res_c = adj_c(**inputs)
+        for k in ["adj_x0","adj_p"]:
+          self.checkarray(res[k],res_c[k],digits=12)
+
+  def test_batch(self):
+    x = SX.sym("x",2)
+    z = SX.sym("z")
+    p = SX.sym("p")
+    u = SX.sym("u")
+    ode = {"x":x,"p":p,"u":u,"ode":vertcat(x[1],-p*x[0]+u),"quad":x[0]**2}
+    dae = {"x":x,"z":z,"p":p,"u":u,"ode":vertcat(x[1],-p*x[0]+u+z),"alg":z-0.1*x[0]**2,"quad":x[0]**2}
+    for plugin, d in [("rk",ode),("collocation",dae)]:
+      I = integrator("I",plugin,d,0.0,[0.5,1.0])
+      B = integrator("B",plugin,d,0.0,[0.5,1.0],{"batch":3})
+      inputs = {"x0":DM([[0.3,0.1,-0.2],[0.1,0.5,0.2]]),"p":DM([[1,2,3]]),"u":DM([[0.1,0.2,0.3,0.4,0.5,0.6]])}
+      res = I.map(3)(**inputs)
+      res_b = B(**inputs)
+      for k in ["xf","qf"]:
+        self.checkarray(res[k],res_b[k],digits=12)
+      self.checkfunction_light(B,I.map(3),inputs=inputs,digits=10)
+
+  def test_sensitivity_parallelization(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p",3)
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],-p[0]*sin(x[0])+p[1]*x[1]),"quad":p[2]*x[0]**2}
+    for plugin in ["cvodes","idas"]:
+      if not has_integrator(plugin): continue
+      opts = {"abstol":1e-12,"reltol":1e-12}
+      I = integrator("I",plugin,dae,0.0,[0.5,1.0],opts)
+      opts["sensitivity_parallelization"] = "thread"
+      opts["sensitivity_max_num_threads"] = 2
+      Ip = integrator("I",plugin,dae,0.0,[0.5,1.0],opts)
+      for F, Fp in [(I.forward(5),Ip.forward(5)),(I.reverse(1).forward(3),Ip.reverse(1).forward(3))]:
+        inputs = [DM(F.sparsity_in(i),0.1*(i+1)) for i in range(F.n_in())]
+        self.checkfunction_light(Fp,F,inputs=inputs,digits=10)
+
+  def test_preconditioner(self):
+    N = 20
+    u = SX.sym("u",N)
+    v = SX.sym("v",N)
+    p = SX.sym("p")
+    lap = lambda x: vertcat(0,x[:-1])-2*x+vertcat(x[1:],0)
+    dae = {"x":vertcat(u,v),"p":p,"ode":vertcat(p*N**2*lap(u),p*N**2*lap(v)+u**2)}
+    x0 = vertcat(sin(pi*DM(range(1,N+1))/N),DM.zeros(N))
+    for plugin in ["cvodes","idas"]:
+      if not has_integrator(plugin): continue
+      opts = {"abstol":1e-10,"reltol":1e-10}
+      I = integrator("I",plugin,dae,0.0,1.0,opts)
+      ref = I(x0=x0,p=0.01)["xf"]
+      opts["newton_scheme"] = "gmres"
+      for pc in ["exact","block_jacobi","incomplete"]:
+        opts["preconditioner"] = pc
+        Ip = integrator("I",plugin,dae,0.0,1.0,opts)
+        self.checkarray(Ip(x0=x0,p=0.01)["xf"],ref,digits=8)
+      opts["newton_scheme"] = "direct"
+      with self.assertInException("requires an iterative Newton scheme"):
+        integrator("I",plugin,dae,0.0,1.0,opts)
+
+  def test_events(self):
+    # Bouncing ball
+    x = SX.sym("x",2)
+    t = SX.sym("t")
+    dae = {"x":x,"ode":vertcat(x[1],-9.81),"quad":x[0]}
+    e = Function("e",[t,x,SX(0,1),SX(0,1),SX(0,1)],[x[0]])
+    tr = Function("tr",[t,x,SX(0,1),SX(0,1),SX(0,1)],[vertcat(x[0],-0.8*x[1])])
+    # Analytic solution
+    t1 = sqrt(2/9.81)
+    v1 = 0.8*9.81*t1
+    t2 = t1+2*v1/9.81
+    def ref(T):
+      if T<t2:
+        s = T-t1
+        return [v1*s-9.81/2*s**2, v1-9.81*s]
+      s = T-t2
+      return [0.8*v1*s-9.81/2*s**2, 0.8*v1-9.81*s]
+    tgrid = [1.0,1.5]
+    for plugin, opts in [("cvodes",{"abstol":1e-12,"reltol":1e-12,"quad_err_con":True}),
+                         ("rk",{"number_of_finite_elements":30}),
+                         ("collocation",{"number_of_finite_elements":30})]:
+      if not has_integrator(plugin): continue
+      opts["event_indicator"] = e
+      opts["event_transition"] = tr
+      opts["event_direction"] = [-1]
+      I = integrator("I",plugin,dae,0.0,tgrid,opts)
+      res = I(x0=vertcat(1,0))
+      self.checkarray(res["xf"],horzcat(*[DM(ref(T)) for T in tgrid]),digits=6)
+      self.assertEqual(I.stats()["nevents"],2)
+    if has_integrator("idas"):
+      with self.assertInException("does not support events"):
+        integrator("I","idas",dae,0.0,tgrid,{"event_indicator":e})
+
+  def test_dense_output(self):
+    x = SX.sym("x",2)
+    z = SX.sym("z")
+    ode = {"x":x,"ode":vertcat(x[1],-x[0]),"quad":x[0]**2}
+    dae = {"x":x,"z":z,"ode":vertcat(x[1],z),"alg":z+x[0],"quad":x[0]**2}
+    tgrid = [0.1*i for i in range(1,101)]
+    t = DM(tgrid).T
+    for plugin, f in [("rk",ode),("collocation",dae)]:
+      if not has_integrator(plugin): continue
+      I = integrator("I",plugin,f,0.0,tgrid,{"number_of_finite_elements":40,"dense_output":True})
+      res = I(x0=vertcat(1,0))
+      self.checkarray(res["xf"],vertcat(cos(t),-sin(t)),digits=3)
+      self.checkarray(res["qf"],t/2+sin(2*t)/4,digits=3)
+      if plugin=="collocation":
+        self.checkarray(res["zf"],-cos(t),digits=3)
+      # The DAE is evaluated once per step, not per output time
+      self.assertEqual(I.stats()["n_call_dae"],41 if plugin=="rk" else 3*40)
+      # Output times on the step grid coincide with the end of the steps
+      I0 = integrator("I",plugin,f,0.0,tgrid[4::5],{"number_of_finite_elements":40})
+      self.checkarray(res["xf"][:,4::5],I0(x0=vertcat(1,0))["xf"],digits=10)
+      with self.assertInException("not supported"):
+        I.factory("F",["x0"],["jac:xf:x0"])(1)
+
+  def test_forwarded_oracle(self):
+    # An MX oracle that only calls a DAE function is bypassed
+    t = SX.sym("t")
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    f = Function("f",[t,x,SX(0,1),p,SX(0,1)],[vertcat(x[1],-p*x[0]),SX(0,1),SX(0,1)],
+                 ["t","x","z","p","u"],["ode","alg","quad"])
+    arg = f.mx_in()
+    w = Function("w",arg,f.call(arg),f.name_in(),f.name_out())
+    for plugin in ["rk","cvodes"]:
+      if not has_integrator(plugin): continue
+      I = integrator("I",plugin,w,0,[0.5,1])
+      self.assertEqual(I.get_function("daeF").class_name(),"SXFunction")
+      self.checkarray(I(x0=vertcat(1,0),p=2)["xf"],
+                      integrator("I",plugin,f,0,[0.5,1])(x0=vertcat(1,0),p=2)["xf"],digits=10)
+    # Modified arguments are not forwarded
+    w = Function("w",arg,f.call([arg[0],2*arg[1]]+arg[2:]),f.name_in(),f.name_out())
+    self.assertEqual(integrator("I","rk",w).get_function("daeF").class_name(),"MXFunction")
+
+  @requires_integrator('collocation')
+  def test_block_triangular(self):
+    # Cascade of two subsystems and a decoupled state
+    for X in [SX,MX]:
+      x = X.sym("x",3)
+      z = X.sym("z",2)
+      p = X.sym("p")
+      dae = {"x":x,"z":z,"p":p,"ode":vertcat(-x[0]+z[0],-p*x[1]+z[1]*x[0],-x[2]**2),
+             "alg":vertcat(z[0]-0.5*sin(x[0]),z[1]-x[1]**2),"quad":x[0]+x[1]}
+      ref = integrator("I","collocation",dae,0.0,[0.5,1.0])
+      I = integrator("I","collocation",dae,0.0,[0.5,1.0],{"block_triangular":True})
+      self.checkfunction_light(I,ref,inputs={"x0":vertcat(1,0.5,1),"p":0.3},digits=10)
+      F = I.factory("F",["x0","p"],["jac:xf:x0","jac:qf:p"])
+      Fref = ref.factory("F",["x0","p"],["jac:xf:x0","jac:qf:p"])
+      for a,b in zip(F(vertcat(1,0.5,1),0.3),Fref(vertcat(1,0.5,1),0.3)):
+        self.checkarray(a,b,digits=8)
+
   @requires_integrator('cvodes')
   def test_step_options_cvodes(self):
     x = SX.sym("x")
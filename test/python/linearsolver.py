@@ -66,6 +66,8 @@ except:
 try:
   load_linsol("lsqr")
   lsolvers.append(("lsqr",{},set()))
+  lsolvers.append(("lsqr",{"preconditioner":"ichol"},set()))
+  lsolvers.append(("lsqr",{"method":"lsmr","preconditioner":"diagonal"},set()))
 except:
   pass
 
@@ -75,9 +77,23 @@ try:
 except:
   pass
 
+try:
+  load_linsol("ma57")
+  lsolvers.append(("ma57",{},{"symmetry"}))
+  lsolvers.append(("ma57",{"static_pivoting":True,"static_tol":1e-14,"static_value":1e-14},{"symmetry"}))
+except:
+  pass
+
+try:
+  load_linsol("ma97")
+  lsolvers.append(("ma97",{},{"symmetry"}))
+except:
+  pass
+
 try:
   load_linsol("mumps")
   lsolvers.append(("mumps",{},{"symmetry"}))
+  lsolvers.append(("mumps",{"ordering":0,"blr":True},{"symmetry"}))
 except:
   pass
 
@@ -90,6 +106,7 @@ except:
 try:
   load_linsol("ldl")
   lsolvers.append(("ldl",{},{"posdef","symmetry"}))
+  lsolvers.append(("ldl",{"supernodal":True},{"posdef","symmetry"}))
 except:
   pass
 
@@ -467,6 +484,159 @@ class LinearSolverTests(casadiTestCase):
 
         self.checkarray(mtimes(A_,f_out),b,digits=digits)
 
+  def test_ldl_supernodal(self):
+    numpy.random.seed(1)
+    # Dense diagonal blocks coupled by a few sparse entries
+    H = diagcat(*[DM(numpy.random.random((6,6))) for i in range(4)])
+    H = H+H.T+12*DM.eye(24)
+    H[5,6] = H[6,5] = 0.1
+    A = sparsify(vertcat(horzcat(H,DM.ones(24,1)),horzcat(DM.ones(1,24),-DM.ones(1,1))))
+    b = self.randDM(25,2)
+    ref = solve(A,b,"ldl")
+    C = solve(A,b,"ldl",{"supernodal":True})
+    self.checkarray(ref,C)
+    self.checkarray(mtimes(A,C),b)
+
+    As = MX.sym("A",A.sparsity())
+    bs = MX.sym("B",b.sparsity())
+    f = Function("f", [As,bs],[solve(As,bs,"ldl",{"supernodal":True})])
+    self.checkfunction_light(f,Function("f", [As,bs],[solve(As,bs,"ldl")]),inputs=[A,b])
+    self.check_codegen(f,inputs=[A,b])
+    self.check_serialize(f,inputs=[A,b])
+
+  def test_tridiag(self):
+    numpy.random.seed(1)
+    for bs in [1,2,3]:
+      for nb in [1,2,5,8]:
+        n = bs*nb
+        # Dense blocks on the block tridiagonal band
+        band = DM([[1 if abs(i//bs-j//bs)<=1 else 0 for j in range(n)] for i in range(n)])
+        A = sparsify(band*DM(numpy.random.random((n,n)))+4*DM.eye(n))
+        b = self.randDM(n,3)
+        for algorithm in ["thomas","cyclic_reduction"]:
+          opts = {"block_size":bs,"algorithm":algorithm}
+          for tr in [False,True]:
+            As = MX.sym("A",A.sparsity())
+            Bs = MX.sym("B",b.sparsity())
+            f = Function("f", [As,Bs],[solve(As.T if tr else As,Bs,"tridiag",opts)])
+            self.checkarray(f(A,b),np.linalg.solve(A.T if tr else A,b))
+            self.check_codegen(f,inputs=[A,b])
+            self.check_serialize(f,inputs=[A,b])
+    with self.assertInException("outside the block tridiagonal band"):
+      solve(MX.sym("A",4,4),MX.sym("B",4),"tridiag")
+
+  def test_lsqr_preconditioned(self):
+    numpy.random.seed(1)
+    n = 30
+    A = self.randDM(n,n,sparsity=0.2)+10*DM.eye(n)
+    # Badly scaled columns
+    A = sparsify(mtimes(A,diag(DM([10**(i%5-2) for i in range(n)]))))
+    b = self.randDM(n,2)
+    As = MX.sym("A",A.sparsity())
+    Bs = MX.sym("B",b.sparsity())
+    P = Function("P",[As],[diag(1/diag(As))])
+    for method in ["lsqr","lsmr"]:
+      for prec in ["none","diagonal","ichol","function"]:
+        opts = {"method":method,"preconditioner":prec}
+        if prec=="function": opts["preconditioner_function"] = P
+        for tr in [False,True]:
+          f = Function("f", [As,Bs],[solve(As.T if tr else As,Bs,"lsqr",opts)])
+          self.checkarray(f(A,b),np.linalg.solve(A.T if tr else A,b),digits=7)
+          self.check_codegen(f,inputs=[A,b])
+          self.check_serialize(f,inputs=[A,b])
+
+    # Warm start from the previous solution
+    ls = Linsol("ls","lsqr",A.sparsity(),{"warm_start":True,"parallel":True})
+    x1 = ls.solve(A,b)
+    x2 = ls.solve(A,b)
+    self.checkarray(x2,np.linalg.solve(A,b),digits=10)
+
+  def test_multiple_rhs(self):
+    numpy.random.seed(1)
+    A = self.randDM(10,10,sparsity=0.4)
+    A = A+A.T+10*DM.eye(10)
+    for Solver in ["ldl","qr"]:
+      for nrhs in [1,3,8,11]:
+        b = self.randDM(10,nrhs)
+        for tr in [False,True] if Solver=="qr" else [False]:
+          As = MX.sym("A",A.sparsity())
+          bs = MX.sym("B",b.sparsity())
+          f = Function("f", [As,bs],[solve(As.T if tr else As,bs,Solver)])
+          self.checkarray(f(A,b),np.linalg.solve(A.T if tr else A,b))
+          self.check_codegen(f,inputs=[A,b])
+
+  def test_mixed_precision(self):
+    numpy.random.seed(1)
+    A = self.randDM(10,10,sparsity=0.4)
+    A = A+A.T+5*DM.eye(10)
+    b = self.randDM(10,3)
+    for Solver in ["ldl","qr"]:
+      for opts in [{"mixed_precision":True},{"refine":2}]:
+        for tr in [False,True] if Solver=="qr" else [False]:
+          As = MX.sym("A",A.sparsity())
+          bs = MX.sym("B",b.sparsity())
+          f = Function("f", [As,bs],[solve(As.T if tr else As,bs,Solver,opts)])
+          self.checkarray(f(A,b),np.linalg.solve(A.T if tr else A,b),digits=12)
+          self.check_serialize(f,inputs=[A,b])
+
+  def test_parallel_solve(self):
+    # 2D Laplacian, large enough for several subtrees
+    m = 40
+    s1 = Sparsity.banded(m,1)
+    A = DM(Sparsity.kron(s1,Sparsity.diag(m))+Sparsity.kron(Sparsity.diag(m),s1),-1)
+    A = A+5*DM.eye(m*m)
+    b = DM.rand(m*m,3)
+    ref = solve(A,b,"ldl")
+    n_threads = GlobalOptions.getMaxNumThreads()
+    try:
+      for n in [1, 4]:
+        GlobalOptions.setMaxNumThreads(n)
+        for opts in [{"parallel_solve":True},{"parallel_solve":True,"refine":1}]:
+          L = Linsol("L","ldl",A.sparsity(),opts)
+          self.checkarray(L.solve(A,b),ref,digits=12)
+    finally:
+      GlobalOptions.setMaxNumThreads(n_threads)
+
+  def test_ordering(self):
+    # 3D Laplacian, where nested dissection gives less fill than AMD
+    m = 12
+    s1 = Sparsity.banded(m,1)
+    d = Sparsity.diag(m)
+    sp = Sparsity.kron(Sparsity.kron(s1,d),d)+Sparsity.kron(Sparsity.kron(d,s1),d) \
+         +Sparsity.kron(Sparsity.kron(d,d),s1)
+    A = DM(sp,-1)+7*DM.eye(m**3)
+    b = DM.rand(m**3,2)
+    ref = solve(A,b,"ldl")
+    for p in [sp.amd(), sp.nd(), sp.nd(16)]:
+      self.assertEqual(sorted(p),list(range(m**3)))
+    nnz = {}
+    for o in ["amd","nd","natural"]:
+      P = sp.nd() if o=="nd" else sp.amd() if o=="amd" else list(range(m**3))
+      nnz[o] = sp.sub(P,P)[0].ldl(False)[0].nnz()
+      for Solver in ["ldl","qr"]:
+        L = Linsol("L",Solver,A.sparsity(),{"ordering":o})
+        self.checkarray(L.solve(A,b),ref,digits=12)
+    self.assertTrue(nnz["nd"]<nnz["amd"])
+    L = Linsol("L","ldl",A.sparsity(),{"preordering":False})
+    self.checkarray(L.solve(A,b),ref,digits=12)
+    with self.assertInException("Unknown ordering"):
+      Linsol("L","qr",A.sparsity(),{"ordering":"metis"})
+
+  def test_shared_symbolic(self):
+    numpy.random.seed(1)
+    A = self.randDM(8,8,sparsity=0.4)
+    A = A+A.T+8*DM.eye(8)
+    b = self.randDM(8,2)
+    for Solver in ["ldl","qr"]:
+      for opts in [{},{"incomplete":True}] if Solver=="ldl" else [{}]:
+        L = [Linsol("L%d" % i,Solver,A.sparsity(),opts) for i in range(3)]
+        ref = L[0].solve(A,b)
+        del L[0]
+        L.append(Linsol("L",Solver,A.sparsity(),opts))
+        for l in L:
+          self.checkarray(l.solve(A,b),ref)
+        self.checkarray(mtimes(A,ref),b)
+
   def test_dimmismatch(self):
     A = DM.eye(5)
     b = DM.ones((4,1))
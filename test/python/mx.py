@@ -1812,6 +1812,31 @@ class MXtests(casadiTestCase):
 
     self.checkarray(F_out,9*DM.ones(4,4))
 
+  def test_substitute_plan(self):
+    for X in [SX,MX]:
+      x = X.sym("x",2)
+      y = X.sym("y",2)
+      e = [sin(x)*y, dot(x,y)]
+      plan = substitute_plan(e,[x])
+      for k in range(3):
+        xdef = y+k
+        r = plan.call([xdef],True,False)
+        ref = substitute(e,[x],[xdef])
+        F = Function("F",[y],r)
+        F_ref = Function("F",[y],ref)
+        self.checkfunction(F,F_ref,inputs=[DM([0.3,0.7])])
+
+    x = MX.sym("x",2)
+    y = MX.sym("y",2)
+    c = x*y
+    e = [c+sin(y)]
+    plan = graph_substitute_plan(e,[c])
+    for k in range(3):
+      C = y+k
+      F = Function("F",[y],plan.call([C],True,False))
+      F_ref = Function("F",[y],graph_substitute(e,[c],[C]))
+      self.checkfunction(F,F_ref,inputs=[DM([0.3,0.7])])
+
 
   def test_matrix_expand(self):
     n = 2
@@ -2548,6 +2573,39 @@ class MXtests(casadiTestCase):
 
         einstein_tests([2,4,3], [2,5,3], [5, 4], [-1, -2, -3], [-1, -4, -3], [-4, -2])
 
+  def test_einstein_path(self):
+    np.random.seed(0)
+    X = np.random.random((2,3))
+    Y = np.random.random((3,4))
+    Z = np.random.random((4,5))
+    v = np.random.random((5,1))
+
+    for MT in [MX, SX]:
+      x = MT.sym("x",6)
+      y = MT.sym("y",12)
+      z = MT.sym("z",20)
+      w = MT.sym("w",5)
+
+      # Matrix chain, with the result transposed
+      out = einstein([x,y,z,w],[[2,3],[3,4],[4,5],[5]],[2],[[-1,-2],[-2,-3],[-3,-4],[-4]],[-1])
+      outT = einstein([y,z,x],[[3,4],[4,5],[2,3]],[5,2],[[-2,-3],[-3,-4],[-1,-2]],[-4,-1])
+      f = Function('f',[x,y,z,w],[out,outT])
+      r = f(vec(X),vec(Y),vec(Z),v)
+      self.checkarray(r[0],mtimes([X,Y,Z,v]))
+      self.checkarray(r[1],vec(mtimes([X,Y,Z]).T))
+      if MT is MX:
+        self.check_codegen(f,inputs=[vec(X),vec(Y),vec(Z),v])
+
+    # Single tensor: trace and transpose
+    M = DM(np.random.random((3,3)))
+    self.checkarray(einstein([vec(M)],[[3,3]],[],[[-1,-1]],[]),trace(M))
+    self.checkarray(einstein([vec(M)],[[3,3]],[3,3],[[-1,-2]],[-2,-1]),vec(M.T))
+
+    # Matrix products are recognized
+    A = MX.sym("A",6)
+    B = MX.sym("B",12)
+    self.assertTrue(einstein(A,B,[3,2],[3,4],[2,4],[-2,-1],[-2,-3],[-1,-3]).info()["gemm"])
+
   def test_sparsity_operation(self):
     L = [MX(Sparsity(1,1)),MX(Sparsity(2,1)), MX.sym("x",1,1), MX.sym("x", Sparsity(1,1)), DM(1), DM(Sparsity(1,1),1), DM(Sparsity(2,1),1), DM(Sparsity.dense(2,1),1)]
 
@@ -2730,6 +2788,21 @@ class MXtests(casadiTestCase):
           self.checkfunction(f,f.expand(),inputs=[ numpy.random.random((S.nnz(),1)), numpy.random.random((E.nnz(),1))])
           self.check_serialize(f,inputs=[ numpy.random.random((S.nnz(),1)), numpy.random.random((E.nnz(),1))])
 
+  def test_nonzeros_fusion(self):
+    import numpy
+    numpy.random.seed(42)
+    x = MX.sym("x",Sparsity.lower(4))
+    y = MX.sym("y",3,5)
+    c = MX.zeros(4,4)
+    c[0:2,0:2] = y[0:2,0:2]
+    c2 = densify(x)
+    c2[2:4,2:4] = y[1:3,2:4]
+    # Chains of nonzero mappings collapse into a single GetNonzeros node
+    for e, n in [(reshape(y[:,1:5],2,6).T,3), (x.T[1:3,:],3), (c[0:2,0:2],3), (c2[2:4,2:4],3), (c2[0:2,:],4)]:
+      self.assertEqual(n_nodes(e),n)
+      f = Function('f',[x,y],[e])
+      self.checkfunction(f,f.expand(),inputs=[ DM(x.sparsity(),numpy.random.random(10)), numpy.random.random((3,5))])
+
   def test_evalf(self):
     x = MX.sym("x")
 
@@ -3032,6 +3105,34 @@ class MXtests(casadiTestCase):
           Ac = evalf(convexify(A,{"strategy":"eigen-reflect"}))
           self.checkarray(A,Ac,digits=8)
 
+  def test_convexify_inertia(self):
+    A = diagcat(1,2,-1,blockcat([[1.2,1.3],[1.3,4]]),sparsify(blockcat([[0,1,0],[1,4,7],[0,7,9]])),DM(2,2))
+    np.random.seed(0)
+    p = np.random.permutation(A.shape[0])
+    As = MX.sym("As",A.sparsity())
+    for op in [lambda e: e, lambda e: e[p,p]]:
+      f = Function("f",[As],[convexify(op(A),{"strategy":"inertia"})])
+      Ac = f(A)
+      shift = Ac-op(A)
+      # Pure diagonal shift, never exceeding the Gershgorin bound
+      reg = float(shift[0,0])
+      self.checkarray(shift,reg*DM.eye(A.shape[0]),digits=12)
+      self.assertTrue(reg>0 and reg<=4+1e-7)
+      self.assertTrue(np.all(np.linalg.eigvalsh(np.array(Ac))>0))
+
+      self.check_serialize(f,inputs=[A])
+      self.check_codegen(f,inputs=[A])
+
+  def test_convexify_parallel(self):
+    A = diagcat(*[blockcat([[1,3+i],[3+i,4]]) if i%3==0 else DM([[2,0.5,0],[0.5,3,0.1],[0,0.1,5]]) for i in range(20)])
+    As = MX.sym("As",A.sparsity())
+    for strategy in ["eigen-clip","eigen-reflect"]:
+      f_ref = Function("f",[As],[convexify(As,{"strategy":strategy})])
+      f = Function("f",[As],[convexify(As,{"strategy":strategy,"parallel":True})])
+      self.checkarray(f(A),f_ref(A),digits=12)
+      self.check_serialize(f,inputs=[A])
+      self.check_codegen(f,inputs=[A])
+
 
   def test_logsumexp(self):
     x = MX.sym("x",3)
@@ -3098,6 +3199,28 @@ class MXtests(casadiTestCase):
     self.checkfunction(f,f.expand(), inputs=[vertcat(1.1,1.3,1.7)])
 
 
+  def test_kron(self):
+    A = MX.sym("A",3,2)
+    B = MX.sym("B",Sparsity.lower(4))
+    x = MX.sym("x",8)
+    Y = MX.sym("Y",8,2)
+    K = kron(A,B)
+    self.assertTrue("kron" in str(K))
+    # Products are taken with the factors, the Kronecker matrix is not formed
+    self.assertFalse("kron" in str(mtimes(K,x)))
+    self.assertFalse("kron" in str(mtimes(K,Y)))
+    f = Function('f',[A,B,x,Y],[K,mtimes(K,x),mtimes(K,Y),sin(K)])
+    inputs = [DM([[1,2],[3,4],[5,6]]),DM(Sparsity.lower(4),list(range(1,11))),
+              DM(list(range(8))),DM.ones(8,2)]
+    out = f.call(inputs)
+    Kd = c.kron(inputs[0],inputs[1])
+    self.checkarray(out[0],Kd)
+    self.checkarray(out[1],mtimes(Kd,inputs[2]))
+    self.checkarray(out[2],mtimes(Kd,inputs[3]))
+    self.checkfunction(f,f.expand(),inputs=inputs)
+    self.check_codegen(f,inputs=inputs)
+    self.check_serialize(f,inputs=inputs)
+
   def test_fractional_slicing(self):
 
     t = MX.sym("x")
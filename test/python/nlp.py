@@ -1373,6 +1373,69 @@ class NLPtests(casadiTestCase):
         solver(x0=0,lbg=0,ubg=0)
 
 
+  @requires_nlpsol("ipopt")
+  def test_ipopt_fused_oracle(self):
+    x=SX.sym("x")
+    y=SX.sym("y")
+    nlp = {'x':vertcat(x,y), 'f':(1-x)**2+100*(y-x**2)**2, 'g':x**2+y**2}
+    ref = nlpsol("solver","ipopt",nlp)
+    sol_ref = ref(x0=[0.5,0.5],ubg=1)
+    for opts in [{"fused_oracle":True},{"cache_evaluations":True},
+                 {"fused_oracle":True,"cache_evaluations":True}]:
+      solver = nlpsol("solver","ipopt",nlp,opts)
+      sol = solver(x0=[0.5,0.5],ubg=1)
+      self.checkarray(sol["x"],sol_ref["x"],digits=12)
+      self.checkarray(sol["lam_g"],sol_ref["lam_g"],digits=12)
+      self.assertEqual(solver.stats()["iter_count"],ref.stats()["iter_count"])
+      # Fewer calls to the user functions than callbacks
+      stats = solver.stats()
+      n_ref = sum(ref.stats()["n_call_"+f] for f in ["nlp_f","nlp_g","nlp_grad_f","nlp_jac_g"])
+      n = sum(stats.get("n_call_"+f,0) for f in ["nlp_f","nlp_g","nlp_grad_f","nlp_jac_g","nlp_fg"])
+      self.assertTrue(n<n_ref)
+
+  @requires_nlpsol("ipopt")
+  def test_ipopt_warm_start(self):
+    x=SX.sym("x",2)
+    p=SX.sym("p")
+    nlp = {'x':x, 'p':p, 'f':(p-x[0])**2+100*(x[1]-x[0]**2)**2, 'g':x[0]**2+x[1]**2}
+    opts = {"print_time":False,"ipopt.print_level":0,"ipopt.tol":1e-10}
+    ref = nlpsol("solver","ipopt",nlp,opts)
+    solver = nlpsol("solver","ipopt",nlp,dict(opts,warm_start=True))
+    sol = solver(x0=[0.5,0.5],p=1,lbx=[-1,0],ubx=[1,0.6],ubg=1)
+    n_cold = solver.stats()["iter_count"]
+    # Slightly perturbed problem, as in a receding horizon
+    args = dict(x0=sol["x"],p=1.01,lbx=[-1,0],ubx=[1,0.6],ubg=1)
+    sol_ref = ref(**args)
+    sol = solver(**args)
+    self.checkarray(sol["x"],sol_ref["x"],digits=8)
+    self.checkarray(sol["lam_x"],sol_ref["lam_x"],digits=6)
+    self.checkarray(sol["lam_g"],sol_ref["lam_g"],digits=6)
+    self.assertTrue(solver.stats()["iter_count"]<ref.stats()["iter_count"])
+    self.assertTrue(solver.stats()["iter_count"]<n_cold)
+
+  @requires_nlpsol("ipopt")
+  def test_nlpsol_predictor(self):
+    x=SX.sym("x",2)
+    p=SX.sym("p")
+    nlp = {'x':x, 'p':p, 'f':(x[0]-p)**2+(x[1]-p**2)**2, 'g':x[0]**2+x[1]**2}
+    solver = nlpsol("solver","ipopt",nlp,{"print_time":False,"ipopt.print_level":0,"ipopt.tol":1e-12})
+    bounds = dict(lbx=0,ubx=[1,0.8],ubg=1)
+    sol = solver(p=1,**bounds)
+    err = {}
+    for n_corrector in [0,1]:
+      pred = nlpsol_predictor("pred",solver,n_corrector)
+      for dp in [1e-1,1e-2]:
+        sol_ref = solver(p=1+dp,**bounds)
+        res = pred(x_ref=sol["x"],lam_x_ref=sol["lam_x"],lam_g_ref=sol["lam_g"],p_ref=1,p=1+dp,**bounds)
+        err[(n_corrector,dp)] = float(norm_inf(res["x"]-sol_ref["x"]))
+        self.checkarray(res["lam_g"],sol_ref["lam_g"],digits=2)
+    # Predictor error is second order in the parameter change
+    self.assertTrue(err[(0,1e-2)]<1e-4)
+    self.assertTrue(err[(0,1e-2)]<0.02*err[(0,1e-1)])
+    # The corrector improves on the predictor
+    self.assertTrue(err[(1,1e-1)]<0.01*err[(0,1e-1)])
+    self.assertTrue(err[(1,1e-2)]<1e-7)
+
   @requires_nlpsol("ipopt")
   def test_iteration_Callback(self):
 
@@ -1702,6 +1765,262 @@ class NLPtests(casadiTestCase):
     stats_reg = solver.stats()
     self.assertTrue(stats_reg["iter_count"]==9)
 
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_rti_sqpmethod(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    nlp = {"x":x,"p":p,"f":(x[0]-p)**2+(x[1]-x[0]**2)**2,"g":x[0]+x[1]}
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+            "print_iteration":False,"print_header":False,"print_status":False}
+    solver = nlpsol("solver","sqpmethod",nlp,dict(opts,rti=True))
+    prep = solver.get_function("rti_preparation")
+    feedback = solver.get_function("rti_feedback")
+    # Repeated real-time iterations with a fixed measurement converge to the solution
+    xk = DM([0.5,0.5])
+    lam_x = DM.zeros(2)
+    lam_g = DM.zeros(1)
+    for k in range(20):
+      lin = prep(x0=xk,p=0.8,lam_g0=lam_g)
+      res = feedback(x_lin=lin["x_lin"],grad_f=lin["grad_f"],g=lin["g"],jac_g=lin["jac_g"],
+                     hess_l=lin["hess_l"],lbx=0.6,ubx=inf,lbg=-inf,ubg=1.5,
+                     lam_x0=lam_x,lam_g0=lam_g)
+      xk, lam_x, lam_g = res["x"], res["lam_x"], res["lam_g"]
+    sol = solver(x0=[0.5,0.5],p=0.8,lbx=0.6,ubg=1.5)
+    self.checkarray(xk,sol["x"],digits=8)
+    self.checkarray(lam_g,sol["lam_g"],digits=8)
+    with self.assertInException("exact or user-supplied Hessian"):
+      nlpsol("solver","sqpmethod",nlp,dict(opts,rti=True,hessian_approximation="limited-memory"))
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_warm_start(self):
+    x = SX.sym("x",4)
+    p = SX.sym("p")
+    nlp = {"x":x,"p":p,"f":sumsqr(x-p)+sumsqr(x[1:]-x[:-1]**2),"g":x[0]+x[1]}
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+            "print_iteration":False,"print_header":False,"print_status":False}
+    for hessian_approximation in ["exact","limited-memory"]:
+      o = dict(opts,hessian_approximation=hessian_approximation)
+      cold = nlpsol("solver","sqpmethod",nlp,o)
+      warm = nlpsol("solver","sqpmethod",nlp,dict(o,warm_start=True))
+      warm(x0=0,p=0.5,ubg=0.8)
+      sol = warm(x0=0,p=0.51,ubg=0.8)
+      sol_ref = cold(x0=0,p=0.51,ubg=0.8)
+      self.checkarray(sol["x"],sol_ref["x"],digits=6)
+      self.assertTrue(warm.stats()["iter_count"]<cold.stats()["iter_count"])
+
+    # Shifted guess
+    solver = nlpsol("solver","sqpmethod",nlp,dict(opts,warm_start=True,warm_start_shift_x=1))
+    solver(x0=0,p=0.5,ubg=0.8)
+    sol = solver(x0=0,p=0.5,ubg=0.8,lbx=-inf,ubx=inf)
+    self.assertTrue(solver.stats()["success"])
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("hpipm")
+  @requires_conic("qrqp")
+  def test_structure_detection_sqpmethod(self):
+    # Multiple shooting for a double integrator
+    N = 10
+    X = [MX.sym("x%d" % k,2) for k in range(N+1)]
+    U = [MX.sym("u%d" % k) for k in range(N)]
+    w = []
+    g = []
+    f = 0
+    for k in range(N):
+      w += [X[k],U[k]]
+      xn = vertcat(X[k][0]+0.1*X[k][1],X[k][1]+0.1*U[k]-0.01*sin(X[k][0]))
+      g.append(xn-X[k+1])
+      f += sumsqr(X[k])+U[k]**2
+    w.append(X[N])
+    f += 10*sumsqr(X[N])
+    nlp = {"x":vcat(w),"f":f,"g":vcat(g)}
+    lbx = [-inf]*(3*N+2)
+    ubx = [inf]*(3*N+2)
+    lbx[0] = ubx[0] = 1
+    lbx[1] = ubx[1] = 0
+    opts = {"print_iteration":False,"print_header":False,"print_status":False}
+    ref = nlpsol("solver","sqpmethod",nlp,dict(opts,qpsol="qrqp",
+      qpsol_options={"print_iter":False,"print_header":False}))
+    sol_ref = ref(lbx=lbx,ubx=ubx,lbg=0,ubg=0)
+    solver = nlpsol("solver","sqpmethod",nlp,dict(opts,structure_detection="auto"))
+    sol = solver(lbx=lbx,ubx=ubx,lbg=0,ubg=0)
+    self.checkarray(sol["x"],sol_ref["x"],digits=6)
+
+  @requires_nlpsol("fatrop")
+  @requires_nlpsol("ipopt")
+  def test_fatrop_nlp(self):
+    # Multiple shooting for a double integrator
+    N = 10
+    for X in [SX,MX]:
+      x = [X.sym("x%d" % k,2) for k in range(N+1)]
+      u = [X.sym("u%d" % k) for k in range(N)]
+      w = []
+      g = []
+      f = 0
+      for k in range(N):
+        w += [x[k],u[k]]
+        xn = vertcat(x[k][0]+0.1*x[k][1],x[k][1]+0.1*u[k]-0.01*sin(x[k][0]))
+        g.append(xn-x[k+1])
+        g.append(x[k][0]+u[k])
+        f += sumsqr(x[k])+u[k]**2
+      w.append(x[N])
+      f += 10*sumsqr(x[N])
+      nlp = {"x":vcat(w),"f":f,"g":vcat(g)}
+      lbx = [-inf]*(3*N+2)
+      ubx = [inf]*(3*N+2)
+      lbx[0] = ubx[0] = 1
+      lbx[1] = ubx[1] = 0
+      lbg = [0,0,-inf]*N
+      ubg = [0,0,0.8]*N
+      ref = nlpsol("solver","ipopt",nlp,{"ipopt.print_level":0,"print_time":False})
+      sol_ref = ref(lbx=lbx,ubx=ubx,lbg=lbg,ubg=ubg)
+      solver = nlpsol("solver","fatrop",nlp,{"fatrop.print_level":0})
+      sol = solver(lbx=lbx,ubx=ubx,lbg=lbg,ubg=ubg)
+      self.assertTrue(solver.stats()["success"])
+      self.checkarray(sol["x"],sol_ref["x"],digits=6)
+      self.checkarray(sol["f"],sol_ref["f"],digits=6)
+      self.checkarray(sol["lam_g"],sol_ref["lam_g"],digits=4)
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_block_bfgs_sqpmethod(self):
+    # Partially separable objective with three coupled pairs
+    x = SX.sym("x",6)
+    f = 0
+    for i in range(0,6,2):
+      f += (1-x[i])**2 + 10*(x[i+1]-x[i]**2)**2
+    nlp = {"x":x,"f":f,"g":x[0]+x[2]+x[4]}
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+            "hessian_approximation":"limited-memory","max_iter":200,
+            "print_iteration":False,"print_header":False,"print_status":False}
+    ref = nlpsol("solver","sqpmethod",nlp,dict(opts,hessian_approximation="exact"))
+    sol_ref = ref(x0=0.5,lbg=-inf,ubg=2.5)
+    for o in [{"block_hess":True},{"lbfgs_compact":True},
+              {"block_hess":True,"lbfgs_compact":True,"lbfgs_memory":4}]:
+      solver = nlpsol("solver","sqpmethod",nlp,dict(opts,**o))
+      sol = solver(x0=0.5,lbg=-inf,ubg=2.5)
+      self.assertTrue(solver.stats()["success"])
+      self.checkarray(sol["x"],sol_ref["x"],digits=5)
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_parallel_ls_sqpmethod(self):
+    x = SX.sym("x",6)
+    f = 0
+    for i in range(5):
+      f += (1-x[i])**2 + 100*(x[i+1]-x[i]**2)**2
+    nlp = {"x":x,"f":f,"g":x[0]+x[1]}
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+            "max_iter_ls":6,"max_iter":100,
+            "print_iteration":False,"print_header":False,"print_status":False}
+    ref = nlpsol("solver","sqpmethod",nlp,opts)
+    sol_ref = ref(x0=-1.2,lbg=-inf,ubg=1.5)
+    solver = nlpsol("solver","sqpmethod",nlp,dict(opts,parallel_ls=True))
+    sol = solver(x0=-1.2,lbg=-inf,ubg=1.5)
+    # Same step lengths are accepted, so the iterates coincide
+    self.assertEqual(solver.stats()["iter_count"],ref.stats()["iter_count"])
+    self.checkarray(sol["x"],sol_ref["x"],digits=10)
+
+  @requires_nlpsol("blocksqp")
+  def test_block_eval_blocksqp(self):
+    try:
+      load_linsol("ma27")
+    except:
+      self.skipTest("ma27 not available")
+    for X in [SX,MX]:
+      x = X.sym("x",6)
+      f = 0
+      for i in range(0,6,2):
+        f += (1-x[i])**2 + 10*(x[i+1]-x[i]**2)**2
+      nlp = {"x":x,"f":f,"g":vertcat(x[0]*x[1],x[2]+x[3]**2)}
+      opts = {"print_header":False,"print_iteration":False,"print_time":False}
+      ref = nlpsol("solver","blocksqp",nlp,opts)
+      sol_ref = ref(x0=0.5,lbg=-inf,ubg=1)
+      solver = nlpsol("solver","blocksqp",nlp,dict(opts,block_eval=True))
+      sol = solver(x0=0.5,lbg=-inf,ubg=1)
+      self.checkarray(sol["x"],sol_ref["x"],digits=8)
+      self.checkarray(sol["lam_g"],sol_ref["lam_g"],digits=8)
+
+  @requires_nlpsol("newton_cg")
+  def test_newton_cg(self):
+    for X in [SX,MX]:
+      x = X.sym("x",8)
+      p = X.sym("p")
+      f = 0
+      for i in range(7):
+        f += (p-x[i])**2 + 10*(x[i+1]-x[i]**2)**2
+      nlp = {"x":x,"p":p,"f":f}
+      opts = {"print_iteration":False,"print_header":False,"print_time":False}
+      solver = nlpsol("solver","newton_cg",nlp,opts)
+      sol = solver(x0=0.5,p=1)
+      self.assertTrue(solver.stats()["success"])
+      self.checkarray(sol["x"],DM.ones(8),digits=6)
+      # Matrix-free Hessian-vector products
+      hv = solver.get_function("nlp_hess_l_vec")
+      H = hessian(f,x)[0]
+      v = DM.rand(8)
+      self.checkarray(hv(sol["x"],1,1,[],v),mtimes(evalf(substitute(H,vertcat(x,p),vertcat(sol["x"],1))),v))
+      # Active bounds
+      sol = solver(x0=0.5,p=1,lbx=-inf,ubx=0.8)
+      self.assertTrue(solver.stats()["success"])
+      ref = nlpsol("solver","ipopt",nlp,{"print_time":False,"ipopt.print_level":0,"ipopt.tol":1e-12}) if has_nlpsol("ipopt") else None
+      if ref is not None:
+        sol_ref = ref(x0=0.5,p=1,lbx=-inf,ubx=0.8)
+        self.checkarray(sol["x"],sol_ref["x"],digits=6)
+        self.checkarray(sol["lam_x"],sol_ref["lam_x"],digits=5)
+      self.assertTrue(float(mmax(sol["x"]))<=0.8)
+    with self.assertInException("general constraints"):
+      nlpsol("solver","newton_cg",{"x":x,"f":f,"g":x[0]},opts)
+
+  def test_presolve(self):
+    x = SX.sym("x",4)
+    p = SX.sym("p")
+    # x[3] and x[2] only appear linearly in a single constraint
+    nlp = {"x":x,"p":p,"f":(x[0]-1)**2+(x[1]-2)**2+p*x[0]*x[1],
+           "g":vertcat(x[0]+x[1]+2*x[3],x[0]**2+x[2])}
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+            "print_iteration":False,"print_header":False,"print_status":False}
+    ref = nlpsol("solver","sqpmethod",nlp,opts)
+    for X in [SX, MX]:
+      if X is MX:
+        x = MX.sym("x",4)
+        p = MX.sym("p")
+        nlp = {"x":x,"p":p,"f":(x[0]-1)**2+(x[1]-2)**2+p*x[0]*x[1],
+               "g":vertcat(x[0]+x[1]+2*x[3],x[0]**2+x[2])}
+      solver = nlpsol("solver","sqpmethod",nlp,dict(opts,presolve=True))
+      for lbx1, n_fixed in [(0.5,1),(-inf,0),(0.5,1)]:
+        args = dict(x0=0.5,p=2,lbx=vertcat(-inf,lbx1,0,-inf),ubx=vertcat(inf,0.5,0.5,2),
+                    lbg=vertcat(3,1),ubg=vertcat(3,1))
+        sol_ref = ref(**args)
+        sol = solver(**args)
+        self.assertTrue(solver.stats()["success"])
+        self.assertEqual(solver.stats()["n_fixed"],n_fixed)
+        self.assertEqual(solver.stats()["n_eliminated"],2)
+        for k in ["x","f","g","lam_x","lam_g","lam_p"]:
+          self.checkarray(sol[k],sol_ref[k],digits=6)
+
+  def test_nlpsol_multistart(self):
+    # Multimodal objective, local minima near x = -1.3 and x = 3.8
+    x = SX.sym("x")
+    nlp = {"x":x,"f":0.1*x**4-0.7*x**3+sin(3*x)}
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+            "print_iteration":False,"print_header":False,"print_status":False}
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    x0 = DM([-3,-1,0.5,2,4,6]).T
+    sols = [solver(x0=x0[i],lbx=-5,ubx=8) for i in range(x0.numel())]
+    f_ref = min(float(s["f"]) for s in sols)
+    for o in [{}, {"terminate_early":True,"terminate_min_iter":2}]:
+      ms = nlpsol_multistart("ms",solver,x0.numel(),o)
+      sol = ms(x0=x0,lbx=-5,ubx=8)
+      stats = ms.stats()
+      self.assertTrue(stats["success"])
+      self.checkarray(sol["f"],f_ref,digits=6)
+      self.assertEqual(len(stats["f_start"]),x0.numel())
+      if not o:
+        for i in range(x0.numel()):
+          self.checkarray(stats["f_start"][i],sols[i]["f"],digits=6)
+
   @requires_nlpsol("ipopt")
   def test_gauss_newton_ipopt(self):
     x = SX.sym("x",3)
@@ -2113,6 +2432,35 @@ class NLPtests(casadiTestCase):
       solver_in["ubg"]=[10]
       with self.assertInAnyOutput("Cuckoo"):
         solver_out = solver(**solver_in)
+
+  def test_jit_parallel(self):
+    if not args.run_slow: return
+    x = MX.sym("x",2)
+    nlp = {'x':x, 'f':(1-x[0])**2+100*(x[1]-x[0]**2)**2, 'g':x[0]+x[1]}
+    opts = {"qpsol":"qrqp","print_time":False,"jit":True,"compiler":"shell"}
+    ref = nlpsol("solver","sqpmethod",nlp,opts)
+    solver = nlpsol("solver","sqpmethod",nlp,dict(opts,jit_parallel=True))
+    solver_in = {"x0":[-1,1],"lbg":-10,"ubg":10}
+    self.checkarray(solver(**solver_in)["x"],ref(**solver_in)["x"],digits=8)
+    solver2 = Function.deserialize(solver.serialize())
+    self.checkarray(solver2(**solver_in)["x"],ref(**solver_in)["x"],digits=8)
+
+  def test_async_output(self):
+    x = MX.sym("x",2)
+    nlp = {'x':x, 'f':(1-x[0])**2+100*(x[1]-x[0]**2)**2}
+    solver = nlpsol("solver","sqpmethod",nlp,{"qpsol":"qrqp","print_time":False,
+      "qpsol_options":{"print_iter":False,"print_header":False}})
+    ref = solver(x0=[-1.2,1])
+    GlobalOptions.setAsyncOutput(True)
+    try:
+      sol = solver(x0=[-1.2,1])
+    finally:
+      GlobalOptions.setAsyncOutput(False)
+    self.assertFalse(GlobalOptions.getAsyncOutput())
+    self.checkarray(sol["x"],ref["x"],digits=12)
+    iterations = solver.stats()["iterations"]
+    self.assertEqual(len(iterations["obj"]),solver.stats()["iter_count"]+1)
+    self.checkarray(iterations["obj"][-1],sol["f"],digits=12)
             
 if __name__ == '__main__':
     unittest.main()
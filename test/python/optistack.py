@@ -199,6 +199,102 @@ class OptiStacktests(inherit_from):
       with self.assertInException("belonging to a different instance"):
         opti.to_function("F",[b],[vertcat(x,y,z)])
 
+    def test_subject_to_dynamics(self):
+      x = MX.sym("x",2)
+      u = MX.sym("u")
+      dt = MX.sym("dt")
+      F = Function("F",[x,u,dt],[x+dt*vertcat(x[1],u-x[0])])
+      N = 20
+      sols = []
+      for mapped in [False, True]:
+        opti = Opti()
+        X = opti.variable(2,N+1)
+        U = opti.variable(1,N)
+        T = opti.parameter()
+        opti.set_value(T,5)
+        if mapped:
+          opti.subject_to_dynamics(F,X,[U,T/N])
+        else:
+          for k in range(N):
+            opti.subject_to(X[:,k+1]==F(X[:,k],U[k],T/N))
+        opti.subject_to(X[:,0]==vertcat(1,0))
+        opti.subject_to(opti.bounded(-1,U,1))
+        opti.minimize(sumsqr(X)+sumsqr(U))
+        opti.solver("sqpmethod",{"qpsol":"qrqp",
+          "print_header":False,"print_iteration":False,"print_status":False,
+          "qpsol_options":{"print_iter":False,"print_header":False,"print_info":False}})
+        sol = opti.solve()
+        self.assertEqual(opti.ng,3*N+2)
+        sols.append(sol.value(X))
+      self.checkarray(sols[0],sols[1],digits=10)
+      with self.assertInException("state dimension 3"):
+        opti.subject_to_dynamics(F,opti.variable(3,N+1),[U,T/N])
+
+    def test_to_function_warm_start(self):
+      opti = Opti()
+      x = opti.variable()
+      y = opti.variable()
+      p = opti.parameter()
+
+      opti.minimize((x-p)**4+y**2)
+      opti.subject_to(x+y>=1)
+      opti.set_initial(x,3)
+
+      opti.solver("sqpmethod",{"qpsol":"qrqp","max_iter":1,"error_on_fail":False,
+        "print_header":False,"print_iteration":False,"print_status":False,
+        "qpsol_options":{"print_iter":False,"print_header":False,"print_info":False}})
+
+      F = opti.to_function("F",[p],[x,y])
+      G = opti.to_function("G",[p],[x,y],{"warm_start":True})
+      self.assertEqual(G.n_in(),1)
+      self.assertEqual(G.n_out(),2)
+
+      # First call starts from the initial guess of Opti
+      self.checkarray(G(2)[0],F(2)[0],digits=12)
+      # One iteration per call: a cold start repeats, a warm start progresses
+      self.checkarray(F(2)[0],F(2)[0],digits=12)
+      xs = [float(G(2)[0]) for i in range(10)]
+      self.assertTrue(abs(xs[-1]-2)<abs(xs[0]-2))
+
+      with self.assertInException("must be parameters"):
+        opti.to_function("H",[x,p],[x,y],{"warm_start":True})
+
+    def test_solver_reuse(self):
+      opti = Opti()
+      x = opti.variable()
+      y = opti.variable()
+
+      opti.minimize((x-1)**2+(y-2)**2)
+      c1 = x+y<=2
+      c2 = x-y>=0
+      opti.solver(nlpsolver,nlpsolver_options)
+
+      opti.subject_to(c1)
+      opti.subject_to(c2)
+      sol = opti.solve()
+      self.checkarray(sol.value(x),1,digits=6)
+      s12 = opti.debug.casadi_solver
+
+      # Screening: drop a constraint, then bring it back
+      opti.subject_to()
+      opti.subject_to(c1)
+      sol = opti.solve()
+      self.checkarray(sol.value(x),0.5,digits=6)
+      s1 = opti.debug.casadi_solver
+      self.assertNotEqual(hash(s1),hash(s12))
+
+      opti.subject_to()
+      opti.subject_to(c1)
+      opti.subject_to(c2)
+      sol = opti.solve()
+      self.checkarray(sol.value(x),1,digits=6)
+      self.assertEqual(hash(opti.debug.casadi_solver),hash(s12))
+
+      # Different options: new solver
+      opti.solver(nlpsolver,nlpsolver_options,{"max_iter":100})
+      opti.solve()
+      self.assertNotEqual(hash(opti.debug.casadi_solver),hash(s12))
+
     def test_dual(self):
       opti = Opti()
       x = opti.variable()
@@ -479,6 +479,48 @@ class Sparsitytests(casadiTestCase):
 
     self.assertTrue(DM(J.sparsity_out(0))[:X.nnz(),:].sparsity()==Sparsity.diag(100))
 
+  def test_jacsparsityThreads(self):
+    n = 2000
+    x = SX.sym("x",n)
+    y = vertcat(*[sin(x[i])+x[(i*7919)%n]*x[i-1] for i in range(n)])
+    f = dot(y,y)
+
+    n_threads = GlobalOptions.getMaxNumThreads()
+    ref = None
+    try:
+      for t in [1, 4]:
+        GlobalOptions.setMaxNumThreads(t)
+        for h in [True, False]:
+          GlobalOptions.setHierarchicalSparsity(h)
+          sp = [Function('J', [x],[y]).jac_sparsity(0,0),
+                Function('H', [x],[gradient(f,x)]).jac_sparsity(0,0)]
+          if ref is None: ref = sp
+          for a,b in zip(sp,ref): self.assertTrue(a==b)
+    finally:
+      GlobalOptions.setMaxNumThreads(n_threads)
+      GlobalOptions.setHierarchicalSparsity(True)
+    self.assertTrue(ref[0]==jacobian(y,x).sparsity())
+
+  def test_sparsity_cache(self):
+    import tempfile, os, shutil
+    d = tempfile.mkdtemp()
+    try:
+      GlobalOptions.setSparsityCache(d)
+      sp = []
+      for k in range(2):
+        x = SX.sym("x",1000)
+        y = sin(x)*x[::-1]+x[0]
+        f = Function('f',[x],[y])
+        J = f.jacobian()
+        sp.append([f.jac_sparsity(0,0), J.sparsity_out(0)])
+        if k==0: self.assertTrue(len(os.listdir(d))>0)
+      self.assertTrue(sp[0][0]==sp[1][0])
+      self.assertTrue(sp[0][1]==sp[1][1])
+      self.assertTrue(sp[1][0]==jacobian(y,x).sparsity())
+    finally:
+      GlobalOptions.setSparsityCache("")
+      shutil.rmtree(d)
+
   @memory_heavy()
   def test_jacsparsityHierarchicalSymm(self):
     GlobalOptions.setHierarchicalSparsity(False)
@@ -567,6 +609,53 @@ class Sparsitytests(casadiTestCase):
         self.assertTrue(L.is_subset(R))
         self.assertFalse(R.is_subset(L))
 
+  def test_pattern_cache(self):
+      sps = [Sparsity.lower(4), Sparsity.upper(4), Sparsity.diag(4), Sparsity.dense(4,4), Sparsity(4,4)]
+      # Repeat to exercise cached results
+      for rep in range(3):
+        for a in sps:
+          for b in sps:
+            A = DM(a,1)
+            B = DM(b,2)
+            self.checkarray(A+B,numpy.array(A)+numpy.array(B))
+            self.checkarray(A*B,numpy.array(A)*numpy.array(B))
+            self.checkarray(mtimes(A,B),numpy.dot(numpy.array(A),numpy.array(B)))
+            self.assertTrue(a.unite(b)==(a+b))
+            self.assertTrue(a.intersect(b)==(a*b))
+            self.assertTrue(a.unite(b)==b.unite(a))
+
+  def test_symbolic_cache(self):
+      numpy.random.seed(0)
+      A = self.randDM(6,6,sparsity=0.3)
+      sps = [(A+A.T+DM.eye(6)).sparsity(), Sparsity.diag(4), Sparsity.banded(5,1), Sparsity(3,3)]
+      for sp in sps:
+        ref = None
+        # Repeated calls return the cached results
+        for rep in range(3):
+          r = [sp.amd(), sp.nd(), sp.etree(), sp.etree(True), sp.ldl(), sp.ldl(False),
+               sp.qr_sparse(), sp.qr_sparse(False)]
+          if ref is None:
+            ref = r
+          else:
+            self.assertEqual(str(r),str(ref))
+
+  def test_structured(self):
+      sps = [Sparsity.diag(5), Sparsity.banded(6,2), Sparsity.lower(4), Sparsity.upper(4),
+             Sparsity.dense(4,4), Sparsity.kron(Sparsity.diag(3),Sparsity.dense(2,2)),
+             Sparsity.kron(Sparsity.diag(2),Sparsity.lower(2)), Sparsity.band(4,1)]
+      for sp in sps:
+        # Reference transpose via triplet format
+        ref, ref_mapping = Sparsity.triplet(sp.size2(),sp.size1(),sp.get_col(),sp.get_row(),False)
+        t, mapping = sp.transpose()
+        self.assertTrue(t==ref)
+        self.assertEqual(list(mapping),list(ref_mapping))
+        self.assertTrue(sp.T()==ref)
+        self.assertEqual(sp.is_symmetric(),sp==ref)
+        # Products against a numerical evaluation
+        for sp2 in sps:
+          if sp.size2()!=sp2.size1(): continue
+          self.assertTrue(Sparsity.mtimes(sp,sp2)==mtimes(DM.ones(sp),DM.ones(sp2)).sparsity())
+
 
 
 if __name__ == '__main__':
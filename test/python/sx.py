@@ -1539,6 +1539,30 @@ class SXtests(casadiTestCase):
 
     self.checkarray(logsumexp(vertcat(100,1000,10000)),f(vertcat(100,1000,10000)))
 
+  def test_hash_consing(self):
+    x = SX.sym("x")
+    y = SX.sym("y")
+    self.assertFalse(is_equal(sin(x*y),sin(x*y),0))
+    GlobalOptions.setHashConsing(True)
+    try:
+      a = sin(x*y)+cos(x+y)
+      b = sin(y*x)+cos(y+x)
+      self.assertTrue(is_equal(a,b,0))
+      e = 0
+      for i in range(10):
+        e += sin(x*y+i)*cos(x*y+i)
+      f = Function("f",[x,y],[e])
+    finally:
+      GlobalOptions.setHashConsing(False)
+    # Nodes created while enabled stay valid
+    self.assertFalse(is_equal(sin(x*y),a.dep(0),0))
+    e_ref = 0
+    for i in range(10):
+      e_ref += sin(x*y+i)*cos(x*y+i)
+    f_ref = Function("f_ref",[x,y],[e_ref])
+    self.assertTrue(f.n_nodes()<f_ref.n_nodes())
+    self.checkfunction(f,f_ref,inputs=[0.3,0.4])
+
 
 if __name__ == '__main__':
     unittest.main()